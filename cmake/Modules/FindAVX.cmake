@@ -99,6 +99,22 @@ SET(AVX512_BF16_CODE "
   }
 ")
 
+SET(AVX512_FP16_CODE "
+  #include <stdint.h>
+  #include <immintrin.h>
+
+  int main() {
+    // detect avx512_fp16
+    __m512h a = _mm512_set1_ph(1.0);
+    a = _mm512_fmadd_ph(a, a, a);
+
+    // detect avx512_bf16
+    __m512 src;
+    _mm512_cvtneps_pbh(src);
+    return 0;
+  }
+")
+
 SET(AMX_CODE "
   #include <stdint.h>
   #include <immintrin.h>
@@ -109,6 +125,21 @@ SET(AMX_CODE "
   }
 ")
 
+SET(AMX_FP16_CODE "
+  #include <stdint.h>
+  #include <immintrin.h>
+
+  int main() {
+    // detect amx_fp16
+    _tile_dpfp16ps (1, 2, 3);
+
+    // detect avx512_fp16
+    __m512h a = _mm512_set1_ph(1.0);
+    a = _mm512_fmadd_ph(a, a, a);
+    return 0;
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -158,9 +189,21 @@ CHECK_SSE(CXX "AVX512_VNNI" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx5
 CHECK_SSE(C "AVX512_BF16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mfma;/arch:AVX512")
 CHECK_SSE(CXX "AVX512_BF16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mfma;/arch:AVX512")
 
+# gcc start to support avx512fp16 from version 12.1
+# https://gcc.gnu.org/onlinedocs/gcc-12.1.0/gcc/x86-Options.html#x86-Options
+CHECK_SSE(C "AVX512_FP16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mavx512fp16 -mfma;/arch:AVX512")
+CHECK_SSE(CXX "AVX512_FP16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mavx512fp16 -mfma;/arch:AVX512")
+
 # gcc start to support amx from version 11.2
 # https://gcc.gnu.org/onlinedocs/gcc-11.2.0/gcc/x86-Options.html#x86-Options
 CHECK_SSE(C "AMX" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mfma\
  -mamx-tile -mamx-int8 -mamx-bf16;/arch:AVX512")
 CHECK_SSE(CXX "AMX" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mfma\
- -mamx-tile -mamx-int8 -mamx-bf16;/arch:AVX512")
\ No newline at end of file
+ -mamx-tile -mamx-int8 -mamx-bf16;/arch:AVX512")
+
+# gcc start to support amx_fp16 from version 13.1
+# https://gcc.gnu.org/onlinedocs/gcc-13.1.0/gcc/x86-Options.html#x86-Options
+CHECK_SSE(C "AMX_FP16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mavx512fp16 -mfma\
+ -mamx-tile -mamx-int8 -mamx-bf16 -mamx-fp16;/arch:AVX512")
+CHECK_SSE(CXX "AMX_FP16" " ;-mavx512f -mavx512dq -mavx512vl -mavx512bw -mavx512bf16 -mavx512fp16 -mfma\
+ -mamx-tile -mamx-int8 -mamx-bf16 -mamx-fp16;/arch:AVX512")
@@ -26,6 +26,28 @@ else(MSVC)
 list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -D__AVX__ -DCPU_CAPABILITY_AVX2 -mavx2 -mfma -mf16c ${CPU_NO_AVX256_SPLIT_FLAGS}")
 endif(MSVC)
 
+# The AMX level contains AVX512_FP16 as in oneDNN, whenever the compiler
+# supports it.
+if(CXX_AVX512_FP16_FOUND)
+  set(CPU_AVX512_FP16_FLAGS "-DCPU_CAPABILITY_AVX512_FP16 -mavx512fp16")
+endif(CXX_AVX512_FP16_FOUND)
+
+if(CXX_AMX_FP16_FOUND)
+  set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AMX_FP16_CPU_DEFINITION")
+  list(APPEND CPU_CAPABILITY_NAMES "AMX_FP16")
+  if(MSVC)
+    list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512") # TODO: CHECK HERE
+  else(MSVC)
+    list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -D__AVX512F__ -DCPU_CAPABILITY_AVX512 -DCPU_CAPABILITY_AVX512_VNNI \
+    -DCPU_CAPABILITY_AVX512_BF16 -DCPU_CAPABILITY_AMX -DCPU_CAPABILITY_AVX512_FP16 -mavx512f -mavx512bw -mavx512vl \
+    -mavx512dq -mavx512vnni -mavx512bf16 -mavx512fp16 -mfma -mamx-tile -mamx-int8 -mamx-bf16 -mamx-fp16")
+  endif(MSVC)
+else(CXX_AMX_FP16_FOUND)
+  if(CMAKE_COMPILER_IS_GNUCXX)
+    message(STATUS "WARNING! Please upgrade gcc version to 13.1+ to support CPU ISA AMX_FP16.")
+  endif(CMAKE_COMPILER_IS_GNUCXX)
+endif(CXX_AMX_FP16_FOUND)
+
 if(CXX_AMX_FOUND)
   set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AMX_CPU_DEFINITION")
   list(APPEND CPU_CAPABILITY_NAMES "AMX")
@@ -34,7 +56,7 @@ if(CXX_AMX_FOUND)
   else(MSVC)
     list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -D__AVX512F__ -DCPU_CAPABILITY_AVX512 -DCPU_CAPABILITY_AVX512_VNNI \
     -DCPU_CAPABILITY_AVX512_BF16 -mavx512f -mavx512bw -mavx512vl -mavx512dq -mavx512vnni -mavx512bf16 -mfma \
-    -mamx-tile -mamx-int8 -mamx-bf16")
+    -mamx-tile -mamx-int8 -mamx-bf16 ${CPU_AVX512_FP16_FLAGS}")
   endif(MSVC)
 else(CXX_AMX_FOUND)
   if(CMAKE_COMPILER_IS_GNUCXX)
@@ -42,6 +64,22 @@ else(CXX_AMX_FOUND)
   endif(CMAKE_COMPILER_IS_GNUCXX)
 endif(CXX_AMX_FOUND)
 
+if(CXX_AVX512_FP16_FOUND)
+  set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_FP16_CPU_DEFINITION")
+  list(APPEND CPU_CAPABILITY_NAMES "AVX512_FP16")
+  if(MSVC)
+    list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512") # TODO: CHECK HERE
+  else(MSVC)
+    list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -D__AVX512F__ -DCPU_CAPABILITY_AVX512 -DCPU_CAPABILITY_AVX512_VNNI \
+    -DCPU_CAPABILITY_AVX512_BF16 -mavx512f -mavx512bw -mavx512vl -mavx512dq -mavx512vnni -mavx512bf16 \
+    -mavx512fp16 -mfma")
+  endif(MSVC)
+else(CXX_AVX512_FP16_FOUND)
+  if(CMAKE_COMPILER_IS_GNUCXX)
+    message(STATUS "WARNING! Please upgrade gcc version to 12.1+ to support CPU ISA AVX512_FP16.")
+  endif(CMAKE_COMPILER_IS_GNUCXX)
+endif(CXX_AVX512_FP16_FOUND)
+
 if(CXX_AVX512_BF16_FOUND)
   set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_BF16_CPU_DEFINITION")
   list(APPEND CPU_CAPABILITY_NAMES "AVX512_BF16")
@@ -5,12 +5,16 @@
 
 #include "AddLayerNorm.h"
 
+#include <ATen/record_function.h>
+#include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(add_layer_norm_kernel_stub);
+DEFINE_DISPATCH(add_layer_norm_forward_kernel_stub);
+DEFINE_DISPATCH(add_layer_norm_backward_kernel_stub);
 
 at::Tensor AddLayerNorm(
     const at::Tensor& a,
@@ -19,15 +23,29 @@ at::Tensor AddLayerNorm(
     at::IntArrayRef normalized_shape,
     const c10::optional<at::Tensor>& weight_opt,
     const c10::optional<at::Tensor>& bias_opt,
-    float eps) {
+    float eps,
+    bool inplace) {
   /*
   pointer to add_layer_norm_kernel_impl(
-      a, b, alpha, normalized_shape, weight_opt, bias_opt, eps);
+      a, b, alpha, normalized_shape, weight_opt, bias_opt, eps, inplace);
   */
   return add_layer_norm_kernel_stub(
-      kCPU, a, b, alpha, normalized_shape, weight_opt, bias_opt, eps);
+      kCPU, a, b, alpha, normalized_shape, weight_opt, bias_opt, eps, inplace);
+}
+
+namespace {
+
+// the fused kernel supports the contiguous inputs of the same shape
+bool can_fuse_add_layernorm(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    int alpha) {
+  return a.sizes() == b.sizes() && a.is_contiguous() && b.is_contiguous() &&
+      alpha == 1.0f;
 }
 
+} // namespace
+
 at::Tensor dil_add_layernorm(
     const at::Tensor& a,
     const at::Tensor& b,
@@ -39,17 +57,7 @@ at::Tensor dil_add_layernorm(
     bool cuda_enable) {
   RECORD_FUNCTION("dil_add_layernorm", c10::ArrayRef<c10::IValue>({}));
 
-  // no broadcast
-  bool no_broadcast = true;
-  for (auto i = 0; i < a.ndimension(); i++) {
-    if (a.size(i) != b.size(i)) {
-      no_broadcast = false;
-      break;
-    }
-  }
-  // Only support contiguous tensor
-  bool is_contiguous = a.is_contiguous() && b.is_contiguous();
-  if (no_broadcast && is_contiguous && alpha == 1.0f) {
+  if (can_fuse_add_layernorm(a, b, alpha)) {
     return AddLayerNorm(
         a, b, alpha, normalized_shape, weight_opt, bias_opt, eps);
   } else {
@@ -57,5 +65,253 @@ at::Tensor dil_add_layernorm(
     return at::layer_norm(add_res, normalized_shape, weight_opt, bias_opt, eps);
   }
 }
+
+at::Tensor& dil_add_layernorm_(
+    at::Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    float eps,
+    bool cuda_enable) {
+  RECORD_FUNCTION("dil_add_layernorm_", c10::ArrayRef<c10::IValue>({}));
+
+  if (can_fuse_add_layernorm(a, b, alpha)) {
+    AddLayerNorm(
+        a, b, alpha, normalized_shape, weight_opt, bias_opt, eps, true);
+    return a;
+  }
+  auto add_res = at::add(a, b, alpha);
+  return a.copy_(
+      at::layer_norm(add_res, normalized_shape, weight_opt, bias_opt, eps));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_layernorm_forward(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::add_layernorm_forward", c10::ArrayRef<c10::IValue>({}));
+
+  const at::Tensor& weight =
+      c10::value_or_else(weight_opt, [] { return at::Tensor(); });
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+  auto M_N = _check_layer_norm_inputs(a, normalized_shape, weight, bias);
+  /*
+  pointer to add_layer_norm_forward_kernel_impl(
+      a, b, weight, bias, M, N, eps);
+  */
+  return add_layer_norm_forward_kernel_stub(
+      kCPU,
+      a.contiguous(),
+      b.contiguous(),
+      weight.defined() ? weight.contiguous() : weight,
+      bias.defined() ? bias.contiguous() : bias,
+      M_N.first,
+      M_N.second,
+      eps);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_layernorm_backward(
+    const at::Tensor& grad_output,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const c10::optional<at::Tensor>& weight_opt,
+    std::array<bool, 3> grad_input_mask) {
+  RECORD_FUNCTION(
+      "torch_ipex::add_layernorm_backward", c10::ArrayRef<c10::IValue>({}));
+
+  const at::Tensor& weight =
+      c10::value_or_else(weight_opt, [] { return at::Tensor(); });
+  auto M_N =
+      _check_layer_norm_inputs(a, normalized_shape, weight, at::Tensor());
+  at::Tensor grad_input, grad_weight, grad_bias;
+  /*
+  pointer to add_layer_norm_backward_kernel_impl(
+      grad_output, a, b, mean, rstd, weight, M, N, grad_input_mask);
+  */
+  std::tie(grad_input, grad_weight, grad_bias) =
+      add_layer_norm_backward_kernel_stub(
+          kCPU,
+          grad_output.contiguous(),
+          a.contiguous(),
+          b.contiguous(),
+          mean,
+          rstd,
+          weight.defined() ? weight.contiguous() : weight,
+          M_N.first,
+          M_N.second,
+          grad_input_mask);
+  // the grads of the weights are fp32, cast to the dtypes of the weights by
+  // the caller
+  if (grad_weight.defined()) {
+    grad_weight = grad_weight.view(normalized_shape);
+  }
+  if (grad_bias.defined()) {
+    grad_bias = grad_bias.view(normalized_shape);
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+at::Tensor IPEXAddLayerNormOp::forward(
+    torch::autograd::AutogradContext* ctx,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+  RECORD_FUNCTION(
+      "IPEXAddLayerNormOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+  const at::Tensor& weight =
+      c10::value_or_else(weight_opt, [] { return at::Tensor(); });
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+  ctx->saved_data["normalized_shape"] = normalized_shape;
+  ctx->saved_data["a_requires_grad"] = a.requires_grad();
+  ctx->saved_data["b_requires_grad"] = b.requires_grad();
+  ctx->saved_data["weight_requires_grad"] =
+      weight.defined() && weight.requires_grad();
+  ctx->saved_data["bias_requires_grad"] =
+      bias.defined() && bias.requires_grad();
+  if (weight.defined()) {
+    ctx->saved_data["weight_dtype"] = weight.scalar_type();
+  }
+  if (bias.defined()) {
+    ctx->saved_data["bias_dtype"] = bias.scalar_type();
+  }
+  at::Tensor output, mean, rstd;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::add_layernorm_forward", "")
+          .typed<decltype(add_layernorm_forward)>();
+  std::tie(output, mean, rstd) =
+      op.call(a, b, normalized_shape, weight_opt, bias_opt, eps);
+  ctx->save_for_backward({a, b, mean, rstd, weight});
+  return output;
+}
+
+torch::autograd::variable_list IPEXAddLayerNormOp::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::variable_list grad_outputs) {
+  RECORD_FUNCTION(
+      "IPEXAddLayerNormOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+  auto normalized_shape = ctx->saved_data["normalized_shape"].toIntVector();
+  bool a_requires_grad = ctx->saved_data["a_requires_grad"].toBool();
+  bool b_requires_grad = ctx->saved_data["b_requires_grad"].toBool();
+  std::array<bool, 3> output_mask;
+  output_mask[0] = a_requires_grad || b_requires_grad;
+  output_mask[1] = ctx->saved_data["weight_requires_grad"].toBool();
+  output_mask[2] = ctx->saved_data["bias_requires_grad"].toBool();
+  auto saved = ctx->get_saved_variables();
+  at::Tensor a = saved[0];
+  at::Tensor b = saved[1];
+  at::Tensor mean = saved[2];
+  at::Tensor rstd = saved[3];
+  at::Tensor weight = saved[4];
+  at::Tensor grad_input, grad_weight, grad_bias;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::add_layernorm_backward", "")
+          .typed<decltype(add_layernorm_backward)>();
+  std::tie(grad_input, grad_weight, grad_bias) = op.call(
+      grad_outputs[0],
+      a,
+      b,
+      normalized_shape,
+      mean,
+      rstd,
+      weight.defined() ? c10::optional<at::Tensor>(weight) : c10::nullopt,
+      output_mask);
+  if (grad_weight.defined()) {
+    grad_weight =
+        grad_weight.to(ctx->saved_data["weight_dtype"].toScalarType());
+  }
+  if (grad_bias.defined()) {
+    grad_bias = grad_bias.to(ctx->saved_data["bias_dtype"].toScalarType());
+  }
+  return {
+      a_requires_grad ? grad_input : at::Tensor(),
+      b_requires_grad ? grad_input : at::Tensor(),
+      at::Tensor(),
+      grad_weight,
+      grad_bias,
+      at::Tensor()};
+}
+
+namespace {
+
+// the autograd kernel supports the fp32 or bf16 inputs of the same shape and
+// dtype, whose weights are fp32 or of the dtype of the inputs
+bool can_fuse_add_layernorm_autograd(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt) {
+  auto dtype = a.scalar_type();
+  if (a.sizes() != b.sizes() || b.scalar_type() != dtype ||
+      (dtype != at::kFloat && dtype != at::kBFloat16)) {
+    return false;
+  }
+  for (const auto& w : {weight_opt, bias_opt}) {
+    if (w.has_value() && w->defined() && w->scalar_type() != dtype &&
+        w->scalar_type() != at::kFloat) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+at::Tensor add_layernorm(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+  RECORD_FUNCTION("torch_ipex::add_layernorm", c10::ArrayRef<c10::IValue>({}));
+
+  if (can_fuse_add_layernorm_autograd(a, b, weight_opt, bias_opt)) {
+    return IPEXAddLayerNormOp::apply(
+        a, b, normalized_shape, weight_opt, bias_opt, eps);
+  }
+  return at::layer_norm(
+      at::add(a, b), normalized_shape, weight_opt, bias_opt, eps);
+}
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "add_layernorm_forward(Tensor a, Tensor b, int[] normalized_shape, "
+      "Tensor? weight, Tensor? bias, float eps) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "add_layernorm_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::add_layernorm_forward);
+  m.def(
+      "add_layernorm_backward(Tensor grad_output, Tensor a, Tensor b, int[] "
+      "normalized_shape, Tensor mean, Tensor rstd, Tensor? weight, bool[3] "
+      "grad_input_mask) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "add_layernorm_backward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::add_layernorm_backward);
+  m.def(
+      "add_layernorm(Tensor a, Tensor b, int[] normalized_shape, Tensor? "
+      "weight=None, Tensor? bias=None, float eps=1e-05) -> Tensor",
+      torch_ipex::cpu::add_layernorm);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
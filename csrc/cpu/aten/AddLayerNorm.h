@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <dyndisp/DispatchStub.h>
+#include <torch/csrc/autograd/custom_function.h>
 
 namespace torch_ipex {
 namespace cpu {
@@ -60,7 +61,8 @@ C10_ALWAYS_INLINE std::pair<int64_t, int64_t> _check_layer_norm_inputs(
 }
 
 /**
- * This operator fuse add + layernorm
+ * This operator fuse add + layernorm, writing the output into a (contiguous)
+ * when inplace
  * */
 at::Tensor AddLayerNorm(
     const at::Tensor& a,
@@ -69,7 +71,8 @@ at::Tensor AddLayerNorm(
     at::IntArrayRef normalized_shape,
     const c10::optional<at::Tensor>& weight_opt,
     const c10::optional<at::Tensor>& bias_opt,
-    float eps);
+    float eps,
+    bool inplace = false);
 
 at::Tensor dil_add_layernorm(
     const at::Tensor& input,
@@ -81,8 +84,90 @@ at::Tensor dil_add_layernorm(
     float eps,
     bool cuda_enable);
 
+// dil_add_layernorm writing its output into a, a dead input of the output
+// shape
+at::Tensor& dil_add_layernorm_(
+    at::Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    float eps,
+    bool cuda_enable);
+
+// Fused add + layernorm of autograd: the output, mean and rstd of a + b, whose
+// backward computes the grad of a + b and the partial grads of the weights of
+// each thread in a single pass over the rows, a + b being recomputed rather
+// than saved
+class IPEXAddLayerNormOp
+    : public torch::autograd::Function<IPEXAddLayerNormOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& a,
+      const at::Tensor& b,
+      at::IntArrayRef normalized_shape,
+      const c10::optional<at::Tensor>& weight_opt,
+      const c10::optional<at::Tensor>& bias_opt,
+      double eps);
+
+  static torch::autograd::variable_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::variable_list grad_outputs);
+};
+
+// layer_norm(a + b), through IPEXAddLayerNormOp when the inputs are supported
+at::Tensor add_layernorm(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_layernorm_forward(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_layernorm_backward(
+    const at::Tensor& grad_output,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::IntArrayRef normalized_shape,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const c10::optional<at::Tensor>& weight_opt,
+    std::array<bool, 3> grad_input_mask);
+
 namespace {
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+add_layer_norm_forward_kernel_impl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t M,
+    int64_t N,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+add_layer_norm_backward_kernel_impl(
+    const at::Tensor& dY,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& weight,
+    int64_t M,
+    int64_t N,
+    std::array<bool, 3> grad_input_mask);
+
 at::Tensor add_layer_norm_kernel_impl(
     const at::Tensor& a,
     const at::Tensor& b,
@@ -90,7 +175,8 @@ at::Tensor add_layer_norm_kernel_impl(
     at::IntArrayRef normalized_shape,
     const c10::optional<at::Tensor>& weight_opt,
     const c10::optional<at::Tensor>& bias_opt,
-    float eps);
+    float eps,
+    bool inplace);
 }
 
 using add_layer_norm_kernel_fn = at::Tensor (*)(
@@ -100,8 +186,40 @@ using add_layer_norm_kernel_fn = at::Tensor (*)(
     at::IntArrayRef,
     const c10::optional<at::Tensor>&,
     const c10::optional<at::Tensor>&,
-    float);
+    float,
+    bool);
 DECLARE_DISPATCH(add_layer_norm_kernel_fn, add_layer_norm_kernel_stub);
 
+// Y, mean and rstd of the fp32 or bf16 inputs of the same shape
+using add_layer_norm_forward_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        int64_t,
+        int64_t,
+        double);
+DECLARE_DISPATCH(
+    add_layer_norm_forward_kernel_fn,
+    add_layer_norm_forward_kernel_stub);
+
+// The grads of a + b, the weight and the bias, for the outputs of the mask,
+// those of the weights being fp32 of [N]
+using add_layer_norm_backward_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        int64_t,
+        int64_t,
+        std::array<bool, 3>);
+DECLARE_DISPATCH(
+    add_layer_norm_backward_kernel_fn,
+    add_layer_norm_backward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
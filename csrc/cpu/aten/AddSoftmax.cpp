@@ -6,6 +6,7 @@ namespace cpu {
 
 DEFINE_DISPATCH(div_add_softmax_kernel_stub);
 DEFINE_DISPATCH(add_softmax_inplace_kernel_stub);
+DEFINE_DISPATCH(div_add_softmax_dropout_kernel_stub);
 
 at::Tensor DivAddSoftmax(
     at::Tensor& a,
@@ -16,6 +17,16 @@ at::Tensor DivAddSoftmax(
   return div_add_softmax_kernel_stub(kCPU, a, b, dim_per_head);
 }
 
+std::tuple<at::Tensor, at::Tensor> DivAddSoftmaxDropout(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    double dim_per_head,
+    double p) {
+  RECORD_FUNCTION("dil_addsoftmax_dropout", c10::ArrayRef<c10::IValue>({}));
+  // pointer to div_add_softmax_dropout_kernel_impl(a, b, dim_per_head, p);
+  return div_add_softmax_dropout_kernel_stub(kCPU, a, b, dim_per_head, p);
+}
+
 at::Tensor& AddSoftmax_(at::Tensor& a, const at::Tensor& b) {
   return add_softmax_inplace_kernel_stub(kCPU, a, b);
 }
@@ -31,6 +42,9 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       "add_softmax_(Tensor(a!) self, Tensor other) -> Tensor(a!)",
       torch_ipex::cpu::AddSoftmax_);
+  m.def(
+      "div_add_softmax_dropout(Tensor a, Tensor b, float dim_per_head, float p) -> (Tensor, Tensor)",
+      torch_ipex::cpu::DivAddSoftmaxDropout);
 }
 
 } // namespace
@@ -13,11 +13,25 @@ at::Tensor DivAddSoftmax(
     const at::Tensor& b,
     const float& dim_per_head);
 
+// softmax(a / dim_per_head + b) followed by dropout of probability p.
+// Returns (output, keep mask), the mask being a bool tensor of the shape of a.
+std::tuple<at::Tensor, at::Tensor> DivAddSoftmaxDropout(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    double dim_per_head,
+    double p);
+
 namespace {
 at::Tensor div_add_softmax_kernel_impl(
     at::Tensor& a,
     const at::Tensor& b,
     const float& dim_per_head);
+
+std::tuple<at::Tensor, at::Tensor> div_add_softmax_dropout_kernel_impl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const float& dim_per_head,
+    const float& p);
 }
 
 using div_add_softmax_kernel_fn =
@@ -25,9 +39,18 @@ using div_add_softmax_kernel_fn =
 using add_softmax_inplace_kernel_fn =
     at::Tensor& (*)(at::Tensor&, const at::Tensor&);
 DECLARE_DISPATCH(div_add_softmax_kernel_fn, div_add_softmax_kernel_stub);
+using div_add_softmax_dropout_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const float&,
+        const float&);
 DECLARE_DISPATCH(
     add_softmax_inplace_kernel_fn,
     add_softmax_inplace_kernel_stub);
+DECLARE_DISPATCH(
+    div_add_softmax_dropout_kernel_fn,
+    div_add_softmax_dropout_kernel_stub);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -10,7 +10,20 @@
 
 namespace torch_ipex {
 namespace cpu {
-DEFINE_DISPATCH(add_swish_kernel_stub);
+DEFINE_DISPATCH(add_eltwise_mul_kernel_stub);
+
+namespace {
+
+bool use_add_eltwise_mul_kernel(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& c) {
+  const auto dtype = a.scalar_type();
+  return (dtype == at::kFloat || dtype == at::kBFloat16) &&
+      b.scalar_type() == dtype && (!c.defined() || c.scalar_type() == dtype);
+}
+
+} // namespace
 
 // Currently we only support 1D tensor of bias(operand of add).
 at::Tensor AddSwish(
@@ -18,8 +31,92 @@ at::Tensor AddSwish(
     at::Tensor& mm_output,
     const at::Tensor& weight,
     const at::Tensor& bias) {
-  // pointer to add_swish_kernel_impl(x, mm_output, weight, bias);
-  return add_swish_kernel_stub(kCPU, x, mm_output, weight, bias);
+  if (use_add_eltwise_mul_kernel(mm_output, bias, at::Tensor())) {
+    // the swish of mm_output + bias, written in place
+    /*
+    pointer to add_eltwise_mul_kernel_impl(
+        mm_output, bias, at::Tensor(), AddMulEltwise::Sigmoid, mm_output);
+    */
+    add_eltwise_mul_kernel_stub(
+        kCPU, mm_output, bias, at::Tensor(), AddMulEltwise::Sigmoid, mm_output);
+    return mm_output;
+  }
+  auto lin_res = at::linear(x, weight, bias);
+  auto sigmoid_res = at::sigmoid(lin_res);
+  return at::mul(lin_res, sigmoid_res);
+}
+
+AddMulEltwise add_mul_eltwise_from_name(c10::string_view name) {
+  if (name == "none") {
+    return AddMulEltwise::Identity;
+  } else if (name == "relu") {
+    return AddMulEltwise::Relu;
+  } else if (name == "sigmoid") {
+    return AddMulEltwise::Sigmoid;
+  } else if (name == "hardsigmoid") {
+    return AddMulEltwise::Hardsigmoid;
+  } else if (name == "tanh") {
+    return AddMulEltwise::Tanh;
+  } else if (name == "silu") {
+    return AddMulEltwise::Silu;
+  } else if (name == "gelu") {
+    return AddMulEltwise::Gelu;
+  } else if (name == "gelu_tanh") {
+    return AddMulEltwise::GeluTanh;
+  }
+  TORCH_CHECK(false, "add_eltwise_mul: unsupported eltwise ", name);
+}
+
+at::Tensor add_eltwise_mul(
+    const at::Tensor& a,
+    const c10::optional<at::Tensor>& b,
+    const c10::optional<at::Tensor>& c,
+    c10::string_view eltwise) {
+  RECORD_FUNCTION("ipex::add_eltwise_mul", c10::ArrayRef<c10::IValue>({}));
+
+  auto op = add_mul_eltwise_from_name(eltwise);
+  // a missing b is a 0-dim zero broadcast by the kernel
+  const at::Tensor b_ =
+      b.has_value() ? b.value() : at::zeros({}, a.options());
+  const at::Tensor c_ = c.has_value() ? c.value() : at::Tensor();
+  if (use_add_eltwise_mul_kernel(a, b_, c_)) {
+    at::Tensor output;
+    /*
+    pointer to add_eltwise_mul_kernel_impl(a, b_, c_, op, output);
+    */
+    add_eltwise_mul_kernel_stub(kCPU, a, b_, c_, op, output);
+    return output;
+  }
+
+  auto sum = b.has_value() ? at::add(a, b_) : a;
+  at::Tensor act;
+  switch (op) {
+    case AddMulEltwise::Identity:
+      act = sum;
+      break;
+    case AddMulEltwise::Relu:
+      act = at::relu(sum);
+      break;
+    case AddMulEltwise::Sigmoid:
+      act = at::sigmoid(sum);
+      break;
+    case AddMulEltwise::Hardsigmoid:
+      act = at::hardsigmoid(sum);
+      break;
+    case AddMulEltwise::Tanh:
+      act = at::tanh(sum);
+      break;
+    case AddMulEltwise::Silu:
+      act = at::silu(sum);
+      break;
+    case AddMulEltwise::Gelu:
+      act = at::gelu(sum);
+      break;
+    case AddMulEltwise::GeluTanh:
+      act = at::gelu(sum, "tanh");
+      break;
+  }
+  return at::mul(act, c_.defined() ? c_ : sum);
 }
 
 } // namespace cpu
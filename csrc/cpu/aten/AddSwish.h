@@ -13,21 +13,59 @@ at::Tensor AddSwish(
     const at::Tensor& weight,
     const at::Tensor& bias);
 
+// The activations of add_eltwise_mul
+enum class AddMulEltwise {
+  Identity,
+  Relu,
+  Sigmoid,
+  Hardsigmoid,
+  Tanh,
+  Silu,
+  Gelu,
+  GeluTanh
+};
+
+// The activation of the eltwise name of the ipex::add_eltwise_mul op:
+// "none", "relu", "sigmoid", "hardsigmoid", "tanh", "silu", "gelu" or
+// "gelu_tanh"
+AddMulEltwise add_mul_eltwise_from_name(c10::string_view name);
+
+/**
+ * output = eltwise(a + b) * c in a single pass, the three operands being
+ * broadcast against each other and strided, e.g. the gate of a squeeze and
+ * excitation block (x * sigmoid(s + bias) of [N, C, H, W] and [N, C, 1, 1]
+ * operands) or of a gated activation. b is omitted for eltwise(a) * c, and c
+ * for eltwise(a + b) * (a + b), e.g. swish with sigmoid. The float and
+ * bfloat16 operands of a same dtype are computed in float by the fused
+ * kernel, other operands by the aten ops.
+ * */
+at::Tensor add_eltwise_mul(
+    const at::Tensor& a,
+    const c10::optional<at::Tensor>& b,
+    const c10::optional<at::Tensor>& c,
+    c10::string_view eltwise);
+
 namespace {
 
-at::Tensor add_swish_kernel_impl(
-    at::Tensor& x,
-    at::Tensor& a,
+void add_eltwise_mul_kernel_impl(
+    const at::Tensor& a,
     const at::Tensor& b,
-    const at::Tensor& c);
+    const at::Tensor& c,
+    AddMulEltwise eltwise,
+    at::Tensor& output);
 }
 
-using add_swish_kernel_fn = at::Tensor (*)(
-    at::Tensor&,
-    at::Tensor&,
+// output = eltwise(a + b) * c, or eltwise(a + b) * (a + b) if c is undefined,
+// of float or bfloat16 operands of a same dtype. An undefined output is
+// allocated in the broadcast shape, a defined one, e.g. a, is written in place
+// and must have the broadcast shape.
+using add_eltwise_mul_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
     const at::Tensor&,
-    const at::Tensor&);
-DECLARE_DISPATCH(add_swish_kernel_fn, add_swish_kernel_stub);
+    AddMulEltwise,
+    at::Tensor&);
+DECLARE_DISPATCH(add_eltwise_mul_kernel_fn, add_eltwise_mul_kernel_stub);
 
 } // namespace cpu
 } // namespace torch_ipex
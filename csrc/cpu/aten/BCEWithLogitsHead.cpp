@@ -0,0 +1,129 @@
+#include "BCEWithLogitsHead.h"
+
+#include <ATen/record_function.h>
+#include <torch/library.h>
+
+#include <tuple>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(bce_with_logits_head_forward_kernel_stub);
+DEFINE_DISPATCH(bce_with_logits_head_backward_kernel_stub);
+
+namespace {
+
+void check_bce_with_logits_head_inputs(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target) {
+  const auto dtype = input.scalar_type();
+  TORCH_CHECK(
+      input.dim() == 2 && weight.numel() == input.size(1),
+      "bce_with_logits_head expects a [B, K] input and a [1, K] weight");
+  TORCH_CHECK(
+      target.numel() == input.size(0),
+      "bce_with_logits_head expects a target of every row of the input");
+  TORCH_CHECK(
+      (dtype == at::kFloat || dtype == at::kBFloat16) &&
+          weight.scalar_type() == dtype,
+      "bce_with_logits_head only supports float or bfloat16 input and weight "
+      "of a same dtype");
+}
+
+} // anonymous namespace
+
+std::tuple<at::Tensor, at::Tensor> bce_with_logits_head_forward(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const at::Tensor& target) {
+  RECORD_FUNCTION(
+      "torch_ipex::bce_with_logits_head_forward",
+      c10::ArrayRef<c10::IValue>({}));
+
+  check_bce_with_logits_head_inputs(input, weight, target);
+  auto x = input.contiguous();
+  auto w = weight.reshape({-1}).contiguous();
+  auto y = target.reshape({-1}).to(at::kFloat).contiguous();
+  const float b = bias.has_value() && bias->defined()
+      ? bias->to(at::kFloat).item<float>()
+      : 0.f;
+  auto logits = at::empty({x.size(0)}, x.options().dtype(at::kFloat));
+  auto loss = at::empty({}, x.options().dtype(at::kFloat));
+  /*
+  pointer to bce_with_logits_head_forward_kernel_impl(x, w, b, y, logits,
+  loss);
+  */
+  bce_with_logits_head_forward_kernel_stub(kCPU, x, w, b, y, logits, loss);
+  return std::make_tuple(loss.to(input.scalar_type()), logits);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> bce_with_logits_head_backward(
+    const at::Tensor& grad,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target,
+    const at::Tensor& logits,
+    bool bias_defined) {
+  RECORD_FUNCTION(
+      "torch_ipex::bce_with_logits_head_backward",
+      c10::ArrayRef<c10::IValue>({}));
+
+  check_bce_with_logits_head_inputs(input, weight, target);
+  TORCH_CHECK(
+      grad.numel() == 1 && logits.numel() == input.size(0) &&
+          logits.scalar_type() == at::kFloat,
+      "bce_with_logits_head_backward expects the scalar gradient of the loss "
+      "and the logits of the forward");
+  auto x = input.contiguous();
+  auto w = weight.reshape({-1}).contiguous();
+  auto y = target.reshape({-1}).to(at::kFloat).contiguous();
+  auto z = logits.contiguous();
+  auto grad_input = at::empty_like(x);
+  auto grad_weight = at::empty({w.size(0)}, w.options());
+  auto grad_bias = at::empty({}, x.options().dtype(at::kFloat));
+  /*
+  pointer to bce_with_logits_head_backward_kernel_impl(grad, x, w, y, z,
+  grad_input, grad_weight, grad_bias);
+  */
+  bce_with_logits_head_backward_kernel_stub(
+      kCPU,
+      grad.to(at::kFloat).item<float>(),
+      x,
+      w,
+      y,
+      z,
+      grad_input,
+      grad_weight,
+      grad_bias);
+  return std::make_tuple(
+      grad_input,
+      grad_weight.view(weight.sizes()),
+      bias_defined ? grad_bias.to(weight.scalar_type()) : at::Tensor());
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "bce_with_logits_head_forward(Tensor input, Tensor weight, Tensor? bias, "
+      "Tensor target) -> (Tensor, Tensor)");
+  m.impl(
+      "bce_with_logits_head_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::bce_with_logits_head_forward);
+  m.def(
+      "bce_with_logits_head_backward(Tensor grad, Tensor input, Tensor weight, "
+      "Tensor target, Tensor logits, bool bias_defined) -> (Tensor, Tensor, "
+      "Tensor)");
+  m.impl(
+      "bce_with_logits_head_backward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::bce_with_logits_head_backward);
+}
+
+} // namespace
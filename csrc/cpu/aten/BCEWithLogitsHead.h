@@ -0,0 +1,89 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * The training head of DLRM: the mean binary cross entropy of the logits
+ * linear(input, weight, bias) of the [B, K] input and the [1, K] weight of
+ * the last top MLP layer against the [B] targets, computed as the stable
+ * max(z, 0) - z * y + log1p(exp(-|z|)) of every logit z. The GEMV, the loss
+ * and its mean are one parallel pass over the rows. Returns the loss, in the
+ * dtype of the input, and the [B] float logits saved for the backward.
+ * */
+std::tuple<at::Tensor, at::Tensor> bce_with_logits_head_forward(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const at::Tensor& target);
+
+/**
+ * The gradients of the input, the weight and the bias of
+ * bce_with_logits_head_forward from its logits. The gradient of every logit
+ * grad * (sigmoid(z) - y) / B is scattered into its input row and reduced
+ * into the partials of the weight and bias of the thread in the same pass
+ * over the rows, the partials being summed afterwards. grad_bias is
+ * undefined for an undefined bias.
+ * */
+std::tuple<at::Tensor, at::Tensor, at::Tensor> bce_with_logits_head_backward(
+    const at::Tensor& grad,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target,
+    const at::Tensor& logits,
+    bool bias_defined);
+
+namespace {
+
+void bce_with_logits_head_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    float bias,
+    const at::Tensor& target,
+    at::Tensor& logits,
+    at::Tensor& loss);
+
+void bce_with_logits_head_backward_kernel_impl(
+    float grad,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target,
+    const at::Tensor& logits,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias);
+} // namespace
+
+// logits [B] (float) and the scalar mean loss (float) of contiguous float or
+// bfloat16 input [B, K] and weight [K] of a same dtype, and float target [B]
+using bce_with_logits_head_forward_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    float,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    bce_with_logits_head_forward_kernel_fn,
+    bce_with_logits_head_forward_kernel_stub);
+
+// grad_input [B, K] and grad_weight [K] in the dtype of the input, and the
+// scalar float grad_bias, of the float logits of the forward
+using bce_with_logits_head_backward_kernel_fn = void (*)(
+    float,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    bce_with_logits_head_backward_kernel_fn,
+    bce_with_logits_head_backward_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -3,10 +3,46 @@
 #include "BatchNorm.h"
 #include "autocast/autocast_mode.h"
 #include "ideep/IDeepConversions.h"
+#include "utils/library.h"
+
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/cpu/mixed_data_type.h>
 
 namespace torch_ipex {
 namespace cpu {
 
+DEFINE_DISPATCH(batch_norm_channels_last_kernel_stub);
+DEFINE_DISPATCH(batch_norm_channels_last_backward_kernel_stub);
+
+namespace {
+
+// whether the Welford kernels support the training batch norm of input
+bool use_channels_last_batch_norm(const at::Tensor& input, bool train) {
+  if (!train || input.numel() == 0 ||
+      (input.scalar_type() != at::kFloat &&
+       input.scalar_type() != at::kBFloat16)) {
+    return false;
+  }
+  return (input.dim() == 4 &&
+          input.is_contiguous(at::MemoryFormat::ChannelsLast)) ||
+      (input.dim() == 5 &&
+       input.is_contiguous(at::MemoryFormat::ChannelsLast3d));
+}
+
+// the float [C] param, value when it is undefined
+at::Tensor batch_norm_float_param(
+    const c10::optional<at::Tensor>& param_opt,
+    int64_t C,
+    const at::Tensor& input,
+    float value) {
+  if (param_opt.has_value() && param_opt->defined()) {
+    return param_opt->to(at::kFloat).contiguous();
+  }
+  return at::full({C}, value, input.options().dtype(at::kFloat));
+}
+
+} // namespace
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor> batch_norm_forward(
     const at::Tensor& input,
     const at::Tensor& weight,
@@ -305,6 +341,136 @@ at::Tensor frozen_batch_norm(
       input, weight, bias, running_mean, running_var, false, 0, eps);
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_batch_norm(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    bool train,
+    double momentum,
+    double eps) {
+  if (!use_channels_last_batch_norm(input, train)) {
+    return at::native::batch_norm_cpu(
+        input,
+        weight_opt,
+        bias_opt,
+        running_mean_opt,
+        running_var_opt,
+        train,
+        momentum,
+        eps);
+  }
+  RECORD_FUNCTION("native_batch_norm", c10::ArrayRef<c10::IValue>({}));
+
+  int64_t C = input.size(1);
+  int64_t rows = input.numel() / C;
+  auto weight = batch_norm_float_param(weight_opt, C, input, 1.f);
+  auto bias = batch_norm_float_param(bias_opt, C, input, 0.f);
+  auto output = at::empty_like(input, input.suggest_memory_format());
+  auto mean = at::empty({C}, input.options().dtype(at::kFloat));
+  auto var = at::empty({C}, input.options().dtype(at::kFloat));
+  /*
+  pointer to batch_norm_channels_last_kernel_impl(
+      input, weight, bias, eps, output, mean, var);
+  */
+  batch_norm_channels_last_kernel_stub(
+      kCPU, input, weight, bias, eps, output, mean, var);
+
+  // the running variance is unbiased
+  if (running_mean_opt.has_value() && running_mean_opt->defined()) {
+    auto running_mean = running_mean_opt.value();
+    running_mean.mul_(1 - momentum)
+        .add_(mean.to(running_mean.dtype()), momentum);
+  }
+  if (running_var_opt.has_value() && running_var_opt->defined()) {
+    auto running_var = running_var_opt.value();
+    auto unbiased = rows > 1 ? var * (static_cast<double>(rows) / (rows - 1))
+                             : var;
+    running_var.mul_(1 - momentum)
+        .add_(unbiased.to(running_var.dtype()), momentum);
+  }
+  bool mixed_type = at::native::is_mixed_type(
+      input, weight_opt, bias_opt, running_mean_opt, running_var_opt);
+  auto param_type = at::native::param_scalar_type(input, mixed_type);
+  auto invstd = (var + eps).rsqrt_();
+  return std::make_tuple(output, mean.to(param_type), invstd.to(param_type));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_batch_norm_backward(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    const c10::optional<at::Tensor>& save_mean_opt,
+    const c10::optional<at::Tensor>& save_invstd_opt,
+    bool train,
+    double eps,
+    std::array<bool, 3> grad_input_mask) {
+  bool has_save_stats = save_mean_opt.has_value() &&
+      save_mean_opt->defined() && save_invstd_opt.has_value() &&
+      save_invstd_opt->defined();
+  if (!has_save_stats || !use_channels_last_batch_norm(input, train)) {
+    return at::native::batch_norm_backward_cpu(
+        grad_output,
+        input,
+        weight_opt,
+        running_mean_opt,
+        running_var_opt,
+        save_mean_opt,
+        save_invstd_opt,
+        train,
+        eps,
+        grad_input_mask);
+  }
+  RECORD_FUNCTION(
+      "native_batch_norm_backward", c10::ArrayRef<c10::IValue>({}));
+
+  int64_t C = input.size(1);
+  auto weight = batch_norm_float_param(weight_opt, C, input, 1.f);
+  auto mean = save_mean_opt->to(at::kFloat).contiguous();
+  auto invstd = save_invstd_opt->to(at::kFloat).contiguous();
+  auto grad_output_ = grad_output.to(input.scalar_type())
+                          .contiguous(input.suggest_memory_format());
+  at::Tensor grad_input;
+  if (grad_input_mask[0]) {
+    grad_input = at::empty_like(input, input.suggest_memory_format());
+  }
+  auto grad_weight = at::empty({C}, input.options().dtype(at::kFloat));
+  auto grad_bias = at::empty({C}, input.options().dtype(at::kFloat));
+  /*
+  pointer to batch_norm_channels_last_backward_kernel_impl(
+      grad_output_,
+      input,
+      weight,
+      mean,
+      invstd,
+      grad_input,
+      grad_weight,
+      grad_bias);
+  */
+  batch_norm_channels_last_backward_kernel_stub(
+      kCPU,
+      grad_output_,
+      input,
+      weight,
+      mean,
+      invstd,
+      grad_input,
+      grad_weight,
+      grad_bias);
+
+  // the param grads have the dtype of the weight
+  auto param_type = weight_opt.has_value() && weight_opt->defined()
+      ? weight_opt->scalar_type()
+      : input.scalar_type();
+  return std::make_tuple(
+      grad_input,
+      grad_input_mask[1] ? grad_weight.to(param_type) : at::Tensor(),
+      grad_input_mask[2] ? grad_bias.to(param_type) : at::Tensor());
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -365,4 +531,14 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       torch_ipex::cpu::batch_norm_backward);
 }
 
+
+IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::native_batch_norm"),
+      TORCH_FN((&torch_ipex::cpu::native_batch_norm)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::native_batch_norm_backward"),
+      TORCH_FN((&torch_ipex::cpu::native_batch_norm_backward)));
+}
+
 } // namespace
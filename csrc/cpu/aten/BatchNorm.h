@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
 #include <torch/csrc/autograd/custom_function.h>
 
 #include <ideep.hpp>
@@ -27,5 +28,81 @@ class IPEXBatchNormOp : public torch::autograd::Function<IPEXBatchNormOp> {
       torch::autograd::variable_list grad_outputs);
 };
 
+// aten::native_batch_norm and its backward. The training batch norms of
+// channels last 4D and 5D float and bfloat16 inputs run the single pass Welford
+// kernels below, the others the ATen kernels.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_batch_norm(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    bool train,
+    double momentum,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_batch_norm_backward(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    const c10::optional<at::Tensor>& save_mean_opt,
+    const c10::optional<at::Tensor>& save_invstd_opt,
+    bool train,
+    double eps,
+    std::array<bool, 3> grad_input_mask);
+
+namespace {
+
+void batch_norm_channels_last_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output,
+    at::Tensor& mean,
+    at::Tensor& var);
+
+void batch_norm_channels_last_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias);
+
+} // namespace
+
+// input and output [rows, C] channels last, the float weight, bias and the
+// batch mean and biased variance [C]
+using batch_norm_channels_last_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    batch_norm_channels_last_kernel_fn,
+    batch_norm_channels_last_kernel_stub);
+
+// grad_input is not computed when undefined
+using batch_norm_channels_last_backward_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    batch_norm_channels_last_backward_kernel_fn,
+    batch_norm_channels_last_backward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,77 @@
+#include "ConcatBnEltwise.h"
+
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(concat_bn_eltwise_kernel_stub);
+
+ConcatEltwise concat_eltwise_from_name(c10::string_view name) {
+  if (name == "none") {
+    return ConcatEltwise::Identity;
+  } else if (name == "relu") {
+    return ConcatEltwise::Relu;
+  } else if (name == "relu6") {
+    return ConcatEltwise::Relu6;
+  } else if (name == "silu") {
+    return ConcatEltwise::Silu;
+  } else if (name == "gelu") {
+    return ConcatEltwise::Gelu;
+  } else if (name == "gelu_tanh") {
+    return ConcatEltwise::GeluTanh;
+  }
+  TORCH_CHECK(false, "concat_bn_eltwise: unsupported eltwise ", name);
+}
+
+/**
+ * The inputs not supported by the kernel, e.g. of different layouts, are
+ * concatenated and transformed by the aten ops, in the dtype of the inputs.
+ **/
+at::Tensor concat_bn_eltwise(
+    const c10::List<at::Tensor>& a,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    int64_t dim,
+    c10::string_view eltwise) {
+  RECORD_FUNCTION("ipex::concat_bn_eltwise", c10::ArrayRef<c10::IValue>({}));
+
+  auto op = concat_eltwise_from_name(eltwise);
+  /*
+  pointer to concat_bn_eltwise_kernel_impl(a, scale, shift, dim, op);
+  */
+  auto output = concat_bn_eltwise_kernel_stub(kCPU, a, scale, shift, dim, op);
+  if (output.defined()) {
+    return output;
+  }
+
+  std::vector<at::Tensor> inputs(a.begin(), a.end());
+  auto cat = at::cat(inputs, dim);
+  std::vector<int64_t> channel_shape(cat.dim(), 1);
+  channel_shape[1] = cat.size(1);
+  auto bn = at::addcmul(
+      shift.view(channel_shape), cat, scale.view(channel_shape));
+  switch (op) {
+    case ConcatEltwise::Identity:
+      break;
+    case ConcatEltwise::Relu:
+      bn = at::relu(bn);
+      break;
+    case ConcatEltwise::Relu6:
+      bn = at::hardtanh(bn, 0, 6);
+      break;
+    case ConcatEltwise::Silu:
+      bn = at::silu(bn);
+      break;
+    case ConcatEltwise::Gelu:
+      bn = at::gelu(bn);
+      break;
+    case ConcatEltwise::GeluTanh:
+      bn = at::gelu(bn, "tanh");
+      break;
+  }
+  return bn.to(cat.scalar_type()).contiguous(cat.suggest_memory_format());
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The activations fused after the per channel affine of concat_bn_eltwise
+enum class ConcatEltwise { Identity, Relu, Relu6, Silu, Gelu, GeluTanh };
+
+// The activation of the eltwise name of the ipex::concat_bn_eltwise op:
+// "none", "relu", "relu6", "silu", "gelu" or "gelu_tanh"
+ConcatEltwise concat_eltwise_from_name(c10::string_view name);
+
+/**
+ * This operator fuses Concat + BN (inference) + an activation, e.g. the
+ * DenseNet or TransNetV2 blocks and the CSP blocks of the YOLO backbones,
+ * into a single pass writing the output: output = eltwise(scale[c] *
+ * cat(a, dim) + shift[c]) of the channel c (dim 1), scale and shift being the
+ * fp32 folded BN parameters. The inputs are concatenated along any dim, and
+ * are float or bfloat16 tensors of a same layout, contiguous or channels last
+ * (3d), other inputs falling back to the aten ops.
+ * */
+at::Tensor concat_bn_eltwise(
+    const c10::List<at::Tensor>& a,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    int64_t dim,
+    c10::string_view eltwise);
+
+namespace {
+
+at::Tensor concat_bn_eltwise_kernel_impl(
+    const c10::List<at::Tensor>& a,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    int64_t dim,
+    ConcatEltwise eltwise);
+}
+
+// The fused output of the inputs, in their memory format, or an undefined
+// tensor if the inputs are not supported by the kernel
+using concat_bn_eltwise_kernel_fn = at::Tensor (*)(
+    const c10::List<at::Tensor>&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    ConcatEltwise);
+DECLARE_DISPATCH(concat_bn_eltwise_kernel_fn, concat_bn_eltwise_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -18,26 +18,69 @@ namespace converter {
 
 using namespace torch_ipex::cpu;
 
-at::Tensor cat_bfloat16_float(
-    const at::Tensor top_half_,
-    const at::Tensor bottom_half_) {
+at::Tensor& cat_bfloat16_float_out(
+    const at::Tensor& top_half_,
+    const at::Tensor& bottom_half_,
+    at::Tensor& out) {
   TORCH_CHECK(
       top_half_.scalar_type() == at::kBFloat16 &&
           bottom_half_.scalar_type() == at::kBFloat16,
       "pack_bfloat16_float: expect both args to be at::BFloat16");
+  TORCH_CHECK(
+      top_half_.sizes() == bottom_half_.sizes(),
+      "cat_bfloat16_float: expect both halves to have the same sizes");
+  TORCH_CHECK(
+      out.scalar_type() == at::kFloat && out.sizes() == top_half_.sizes(),
+      "cat_bfloat16_float: expect out to be at::kFloat of the sizes of the "
+      "halves");
 
-  // pointer to cat_bfloat16_float_kernel_impl(top_half_, bottom_half_);
-  return cat_bfloat16_float_kernel_stub(kCPU, top_half_, bottom_half_);
+  // pointer to cat_bfloat16_float_kernel_impl(top_half_, bottom_half_, out);
+  cat_bfloat16_float_kernel_stub(kCPU, top_half_, bottom_half_, out);
+  return out;
 }
 
-std::tuple<at::Tensor, at::Tensor> split_float_bfloat16(
-    const at::Tensor tensor_) {
+at::Tensor cat_bfloat16_float(
+    const at::Tensor top_half_,
+    const at::Tensor bottom_half_) {
+  at::Tensor output = at::empty_strided(
+      top_half_.sizes(),
+      top_half_.strides(),
+      top_half_.options().dtype(at::kFloat));
+  cat_bfloat16_float_out(top_half_, bottom_half_, output);
+  return output;
+}
+
+std::tuple<at::Tensor&, at::Tensor&> split_float_bfloat16_out(
+    const at::Tensor& tensor_,
+    at::Tensor& top,
+    at::Tensor& bot) {
   TORCH_CHECK(
       tensor_.scalar_type() == at::kFloat,
       "pack_bfloat16_float: expect both tensor to be at::kFloat");
+  TORCH_CHECK(
+      top.scalar_type() == at::kBFloat16 &&
+          bot.scalar_type() == at::kBFloat16 &&
+          top.sizes() == tensor_.sizes() && bot.sizes() == tensor_.sizes(),
+      "split_float_bfloat16: expect top and bot to be at::BFloat16 of the "
+      "sizes of tensor");
 
-  // pointer to split_float_bfloat16_kernel_impl(tensor_);
-  return split_float_bfloat16_kernel_stub(kCPU, tensor_);
+  // pointer to split_float_bfloat16_kernel_impl(tensor_, top, bot);
+  split_float_bfloat16_kernel_stub(kCPU, tensor_, top, bot);
+  return std::forward_as_tuple(top, bot);
+}
+
+std::tuple<at::Tensor, at::Tensor> split_float_bfloat16(
+    const at::Tensor tensor_) {
+  auto top_half = at::empty_strided(
+      tensor_.sizes(),
+      tensor_.strides(),
+      tensor_.options().dtype(at::kBFloat16));
+  auto bottom_half = at::empty_strided(
+      tensor_.sizes(),
+      tensor_.strides(),
+      tensor_.options().dtype(at::kBFloat16));
+  split_float_bfloat16_out(tensor_, top_half, bottom_half);
+  return std::make_tuple(top_half, bottom_half);
 }
 
 } // namespace converter
@@ -54,6 +97,16 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       "cat_bfloat16_float(Tensor top_half, Tensor bot_half) -> Tensor",
       torch_ipex::cpu::bf16::converter::cat_bfloat16_float);
+  // the out variants convert into existing tensors, e.g. a parameter and its
+  // trail on loading, or the chunks of a checkpoint being written
+  m.def(
+      "split_float_bfloat16.out(Tensor tensor, *, Tensor(a!) top, "
+      "Tensor(b!) bot) -> (Tensor(a!), Tensor(b!))",
+      torch_ipex::cpu::bf16::converter::split_float_bfloat16_out);
+  m.def(
+      "cat_bfloat16_float.out(Tensor top_half, Tensor bot_half, *, "
+      "Tensor(a!) out) -> Tensor(a!)",
+      torch_ipex::cpu::bf16::converter::cat_bfloat16_float_out);
 }
 
 } // namespace
@@ -9,21 +9,27 @@ namespace {
 
 void bf16_to_fp32(void* dst, const void* src, int len);
 void fp32_to_bf16(void* dst, const void* src, int len);
-at::Tensor cat_bfloat16_float_kernel_impl(
-    const at::Tensor top_half,
-    const at::Tensor bottom_half);
+void cat_bfloat16_float_kernel_impl(
+    const at::Tensor& top_half,
+    const at::Tensor& bottom_half,
+    at::Tensor& output);
 
-std::tuple<at::Tensor, at::Tensor> split_float_bfloat16_kernel_impl(
-    const at::Tensor tensor);
+void split_float_bfloat16_kernel_impl(
+    const at::Tensor& tensor,
+    at::Tensor& top_half,
+    at::Tensor& bottom_half);
 
 } // namespace
 
+// The kernels write into the given outputs of the sizes of the inputs, which
+// may be strided, e.g. the master weight halves of a parameter or the views
+// of a checkpoint buffer
 using cat_bfloat16_float_kernel_fn =
-    at::Tensor (*)(const at::Tensor, const at::Tensor);
+    void (*)(const at::Tensor&, const at::Tensor&, at::Tensor&);
 DECLARE_DISPATCH(cat_bfloat16_float_kernel_fn, cat_bfloat16_float_kernel_stub);
 
 using split_float_bfloat16_kernel_fn =
-    std::tuple<at::Tensor, at::Tensor> (*)(const at::Tensor);
+    void (*)(const at::Tensor&, at::Tensor&, at::Tensor&);
 DECLARE_DISPATCH(
     split_float_bfloat16_kernel_fn,
     split_float_bfloat16_kernel_stub);
@@ -11,6 +11,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(cumsum_kernel_stub);
+DEFINE_DISPATCH(scan_kernel_stub);
 
 at::Tensor cumsum(
     const at::Tensor& self,
@@ -45,6 +46,38 @@ at::Tensor& cumsum_out(
   return result;
 }
 
+// The scans without a backward of their own, ATen running them when the
+// gradient is required
+at::Tensor cumprod(
+    const at::Tensor& self,
+    int64_t dim,
+    c10::optional<at::ScalarType> dtype) {
+  if (at::GradMode::is_enabled() && self.requires_grad()) {
+    return at::cumprod(self, dim, dtype);
+  }
+  auto casted_self = at::native::integer_upcast(self, dtype);
+  at::Tensor result = at::empty_like(casted_self, at::MemoryFormat::Contiguous);
+
+  // pointer to scan_kernel_impl(result, casted_self, dim, ScanOp::Prod);
+  if (scan_kernel_stub(kCPU, result, casted_self, dim, ScanOp::Prod)) {
+    return result;
+  }
+  return at::cumprod_out(result, casted_self, dim);
+}
+
+at::Tensor logcumsumexp(const at::Tensor& self, int64_t dim) {
+  if (at::GradMode::is_enabled() && self.requires_grad()) {
+    return at::logcumsumexp(self, dim);
+  }
+  at::Tensor result = at::empty_like(self, at::MemoryFormat::Contiguous);
+
+  // pointer to scan_kernel_impl(result, self, dim, ScanOp::LogSumExp);
+  if (scan_kernel_stub(kCPU, result, self, dim, ScanOp::LogSumExp)) {
+    return result;
+  }
+  return at::logcumsumexp_out(result, self, dim);
+}
+
 } // namespace cpu
 
 namespace {
@@ -61,6 +94,12 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "cumsum.out(Tensor self, int dim, *, ScalarType? dtype=None, "
       "Tensor(a!) out) -> Tensor(a!)",
       torch_ipex::cpu::cumsum_out);
+  m.def(
+      "cumprod(Tensor self, int dim, *, ScalarType? dtype=None) -> Tensor",
+      torch_ipex::cpu::cumprod);
+  m.def(
+      "logcumsumexp(Tensor self, int dim) -> Tensor",
+      torch_ipex::cpu::logcumsumexp);
 }
 
 } // namespace
@@ -5,6 +5,9 @@
 namespace torch_ipex {
 namespace cpu {
 
+// The associative op of a scan
+enum class ScanOp { Sum, Prod, LogSumExp };
+
 namespace {
 
 at::Tensor cumsum_kernel_impl(
@@ -13,6 +16,12 @@ at::Tensor cumsum_kernel_impl(
     int64_t dim,
     c10::optional<at::ScalarType> dtype);
 
+bool scan_kernel_impl(
+    at::Tensor& result,
+    const at::Tensor& self,
+    int64_t dim,
+    ScanOp op);
+
 }
 
 using cumsum_kernel_fn = at::Tensor (*)(
@@ -22,5 +31,12 @@ using cumsum_kernel_fn = at::Tensor (*)(
     c10::optional<at::ScalarType>);
 DECLARE_DISPATCH(cumsum_kernel_fn, cumsum_kernel_stub);
 
+// Scans "self" along "dim" into "result" of the same dtype, false if the scan
+// engine does not apply, for a non contiguous input or an unsupported dtype,
+// and the caller falls back to ATen.
+using scan_kernel_fn =
+    bool (*)(at::Tensor&, const at::Tensor&, int64_t, ScanOp);
+DECLARE_DISPATCH(scan_kernel_fn, scan_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
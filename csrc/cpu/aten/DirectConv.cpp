@@ -0,0 +1,99 @@
+#include "DirectConv.h"
+#include <torch/all.h>
+
+#include <atomic>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(direct_conv_kernel_stub);
+
+namespace {
+
+std::atomic<bool> direct_conv_enabled{true};
+
+} // anonymous namespace
+
+c10::optional<DirectConvWeight> pack_direct_conv_weight(
+    const at::Tensor& weight,
+    int64_t groups) {
+  auto dtype = weight.scalar_type();
+  if (!is_direct_conv_enabled() || weight.dim() != 4 ||
+      weight.numel() == 0 || (dtype != at::kFloat && dtype != at::kBFloat16)) {
+    return c10::nullopt;
+  }
+  int64_t OC = weight.size(0);
+  int64_t IC = weight.size(1) * groups;
+  int64_t KH = weight.size(2);
+  int64_t KW = weight.size(3);
+  auto weight_ = weight.contiguous();
+  if (groups > 1 && groups == IC && OC == IC) {
+    return DirectConvWeight{
+        DirectConvKind::DEPTHWISE,
+        weight_.view({OC, KH, KW}).permute({1, 2, 0}).contiguous(),
+        OC,
+        IC,
+        KH,
+        KW};
+  }
+  if (groups == 1 && IC <= direct_conv_max_in_channels) {
+    return DirectConvWeight{
+        DirectConvKind::SMALL_CHANNELS,
+        weight_.permute({2, 3, 1, 0}).contiguous(),
+        OC,
+        IC,
+        KH,
+        KW};
+  }
+  return c10::nullopt;
+}
+
+void direct_conv_kernel_output(
+    const at::Tensor& input,
+    const DirectConvWeight& weight,
+    const at::Tensor& bias,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    at::Tensor& output,
+    DirectConvPostOp post_op) {
+  RECORD_FUNCTION("direct_conv", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      input.dim() == 4 && input.size(1) == weight.in_channels &&
+          output.dim() == 4 && output.size(1) == weight.out_channels,
+      "direct_conv: the input or output does not match the weight");
+  TORCH_CHECK(
+      output.is_contiguous(at::MemoryFormat::ChannelsLast),
+      "direct_conv expects a channels last output");
+  auto input_ = input.contiguous(at::MemoryFormat::ChannelsLast);
+  // fp32 bias read by the kernels, zeros without bias
+  auto bias_ = bias.defined()
+      ? bias.to(at::kFloat).contiguous()
+      : at::zeros({weight.out_channels}, input.options().dtype(at::kFloat));
+  /*
+  pointer to direct_conv_kernel_impl(
+      input_, weight, bias_, stride, padding, dilation, output, post_op);
+  */
+  direct_conv_kernel_stub(
+      kCPU,
+      input_,
+      weight,
+      bias_,
+      stride,
+      padding,
+      dilation,
+      output,
+      post_op);
+}
+
+void set_direct_conv_enabled(bool enabled) {
+  direct_conv_enabled.store(enabled);
+}
+
+bool is_direct_conv_enabled() {
+  return direct_conv_enabled.load();
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// 2D convolutions that oneDNN runs far from peak at small batches, the
+// depthwise ones and the ones of at most direct_conv_max_in_channels input
+// channels (the first layer of image models), are also packed for direct
+// channels-last kernels by the convolution op contexts. Inputs of more than
+// direct_conv_max_batch images go to oneDNN, which amortizes its reorders
+// there.
+const int64_t direct_conv_max_in_channels = 4;
+const int64_t direct_conv_max_batch = 8;
+
+// Post-ops the direct kernels fuse, RELU6 being clamp(0, 6). Batch norms are
+// folded into the weight and bias by the frozen graph passes.
+enum class DirectConvPostOp { NONE = 0, RELU, RELU6 };
+
+enum class DirectConvKind { DEPTHWISE = 0, SMALL_CHANNELS };
+
+struct DirectConvWeight {
+  DirectConvKind kind;
+  // [KH, KW, C] for depthwise and [KH, KW, IC, OC] for small channels, in the
+  // weight dtype, so that the kernels read vectors of output channels
+  at::Tensor weight;
+  int64_t out_channels;
+  int64_t in_channels;
+  int64_t kernel_h;
+  int64_t kernel_w;
+};
+
+// Returns the direct packing of the [OC, IC / groups, KH, KW] weight, nullopt
+// if the direct kernels are disabled or do not support the convolution
+c10::optional<DirectConvWeight> pack_direct_conv_weight(
+    const at::Tensor& weight,
+    int64_t groups);
+
+// output = post_op(conv(input, weight) + bias) for a channels-last input and
+// output of the float or bfloat16 weight dtype
+void direct_conv_kernel_output(
+    const at::Tensor& input,
+    const DirectConvWeight& weight,
+    const at::Tensor& bias,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    at::Tensor& output,
+    DirectConvPostOp post_op);
+
+// Whether the op contexts created from now on pack direct weights, on by
+// default
+void set_direct_conv_enabled(bool enabled);
+bool is_direct_conv_enabled();
+
+namespace {
+
+void direct_conv_kernel_impl(
+    const at::Tensor& input,
+    const DirectConvWeight& weight,
+    const at::Tensor& bias,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    at::Tensor& output,
+    DirectConvPostOp post_op);
+
+} // namespace
+
+using direct_conv_kernel_fn = void (*)(
+    const at::Tensor&,
+    const DirectConvWeight&,
+    const at::Tensor&,
+    at::IntArrayRef,
+    at::IntArrayRef,
+    at::IntArrayRef,
+    at::Tensor&,
+    DirectConvPostOp);
+DECLARE_DISPATCH(direct_conv_kernel_fn, direct_conv_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
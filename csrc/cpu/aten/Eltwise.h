@@ -10,6 +10,9 @@ at::Tensor relu_use_dst_for_bwd(
 at::Tensor sigmoid_use_dst_for_bwd(
     const at::Tensor& grad_output,
     const at::Tensor& output);
+at::Tensor tanh_use_dst_for_bwd(
+    const at::Tensor& grad_output,
+    const at::Tensor& output);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -1,6 +1,7 @@
 #include "EmbeddingBag.h"
 #include "autocast/autocast_mode.h"
 #include "cpu/kernels/Embeddingbag.h"
+#include "utils/csr2csc.h"
 #include "utils/rw_lock.h"
 
 #include <ATen/Parallel.h>
@@ -18,15 +19,19 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(embedding_bag_kernel_stub);
+DEFINE_DISPATCH(embedding_bag_out_kernel_stub);
 DEFINE_DISPATCH(embedding_bag_backward_kernel_stub);
+DEFINE_DISPATCH(embedding_bag_per_sample_weights_backward_kernel_stub);
 DEFINE_DISPATCH(embedding_bag_int8_kernel_stub);
 
 class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
  public:
-  static at::Tensor _forward(
+  static std::tuple<at::Tensor, at::Tensor> _forward(
       const at::Tensor& weight,
       const at::Tensor& indices,
       const at::Tensor& offsets,
+      const at::Tensor& per_sample_weights,
+      int64_t mode,
       bool sparse,
       bool include_last_offset) {
     RECORD_FUNCTION(
@@ -34,10 +39,17 @@ class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
 
     /*
     pointer to embedding_bag_kernel_impl(
-        weight, indices, offsets, include_last_offset);
+        weight, indices, offsets, per_sample_weights, mode,
+        include_last_offset);
     */
     auto ret = embedding_bag_kernel_stub(
-        kCPU, weight, indices, offsets, include_last_offset);
+        kCPU,
+        weight,
+        indices,
+        offsets,
+        per_sample_weights,
+        mode,
+        include_last_offset);
 
     return ret;
   }
@@ -47,6 +59,8 @@ class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
       const at::Tensor& weight,
       const at::Tensor& indices,
       const at::Tensor& offsets,
+      const at::Tensor& per_sample_weights,
+      int64_t mode,
       bool sparse,
       bool include_last_offset) {
     RECORD_FUNCTION(
@@ -54,9 +68,19 @@ class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
 
     at::AutoDispatchBelowADInplaceOrView g;
     ctx->saved_data["sparse"] = sparse;
-    auto ret = _forward(weight, indices, offsets, sparse, include_last_offset);
-    ctx->save_for_backward({weight, indices, offsets});
-    return ret;
+    ctx->saved_data["mode"] = mode;
+    auto ret = _forward(
+        weight,
+        indices,
+        offsets,
+        per_sample_weights,
+        mode,
+        sparse,
+        include_last_offset);
+    // max_indices is only defined for MAX pooling
+    ctx->save_for_backward(
+        {weight, indices, offsets, per_sample_weights, std::get<1>(ret)});
+    return std::get<0>(ret);
   }
 
   static torch::autograd::tensor_list backward(
@@ -70,37 +94,91 @@ class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
     at::Tensor weight = saved[0];
     at::Tensor indices = saved[1];
     at::Tensor offsets = saved[2];
+    at::Tensor per_sample_weights = saved[3];
+    at::Tensor max_indices = saved[4];
 
     int64_t num_weights = weight.size(0);
     bool sparse = ctx->saved_data["sparse"].toBool();
+    int64_t mode = ctx->saved_data["mode"].toInt();
 
     at::Tensor grad = grad_outputs[0].contiguous();
 
-    /*
-    pointer to embedding_bag_backward_kernel_stub(
-            kCPU, grad, indices, offsets, num_weights, sparse);
-    */
+    at::Tensor grad_weight;
+    if (ctx->needs_input_grad(0)) {
+      /*
+      pointer to embedding_bag_backward_kernel_impl(
+          grad, indices, offsets, per_sample_weights, max_indices, mode,
+          num_weights, sparse);
+      */
+      grad_weight = embedding_bag_backward_kernel_stub(
+          kCPU,
+          grad,
+          indices,
+          offsets,
+          per_sample_weights,
+          max_indices,
+          mode,
+          num_weights,
+          sparse);
+    }
+    at::Tensor grad_per_sample_weights;
+    if (per_sample_weights.defined() && ctx->needs_input_grad(3)) {
+      /*
+      pointer to embedding_bag_per_sample_weights_backward_kernel_impl(
+          grad, weight, indices, offsets);
+      */
+      grad_per_sample_weights =
+          embedding_bag_per_sample_weights_backward_kernel_stub(
+              kCPU, grad, weight, indices, offsets);
+    }
     return {
-        embedding_bag_backward_kernel_stub(
-            kCPU, grad, indices, offsets, num_weights, sparse),
+        grad_weight,
         at::Tensor(),
         at::Tensor(),
+        grad_per_sample_weights,
+        at::Tensor(),
         at::Tensor(),
         at::Tensor()};
   }
 };
 
-at::Tensor _embedding_bag(
+at::Tensor _embedding_bag_pooling(
     const at::Tensor& weight,
     const at::Tensor& indices,
     const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    int64_t mode,
     bool sparse,
     bool include_last_offset) {
-  if (at::GradMode::is_enabled() && weight.requires_grad())
+  bool requires_grad = weight.requires_grad() ||
+      (per_sample_weights.defined() && per_sample_weights.requires_grad());
+  if (at::GradMode::is_enabled() && requires_grad)
     return NewEmbeddingBagOp::apply(
-        weight, indices, offsets, sparse, include_last_offset);
-  return NewEmbeddingBagOp::_forward(
-      weight, indices, offsets, sparse, include_last_offset);
+        weight,
+        indices,
+        offsets,
+        per_sample_weights,
+        mode,
+        sparse,
+        include_last_offset);
+  return std::get<0>(NewEmbeddingBagOp::_forward(
+      weight,
+      indices,
+      offsets,
+      per_sample_weights,
+      mode,
+      sparse,
+      include_last_offset));
+}
+
+at::Tensor _embedding_bag(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    bool sparse,
+    bool include_last_offset) {
+  return _embedding_bag_pooling(
+      weight, indices, offsets, at::Tensor(), SUM, sparse, include_last_offset);
 }
 
 at::Tensor dil_qembeddingbag(
@@ -114,10 +192,10 @@ at::Tensor dil_qembeddingbag(
     at::ScalarType o_dtype) {
   /*
   pointer to torch_ipex::cpu::embedding_bag_int8_kernel_impl(
-      weight, indices, offsets, include_last_offset);
+      weight, indices, offsets, include_last_offset, o_scale);
   */
   return torch_ipex::cpu::embedding_bag_int8_kernel_stub(
-      kCPU, weight, indices, offsets, include_last_offset);
+      kCPU, weight, indices, offsets, include_last_offset, o_scale);
 }
 
 } // namespace cpu
@@ -145,6 +223,49 @@ at::Tensor embedding_bag(
   return op.call(casted_weight, indices, offsets, sparse, include_last_offset);
 }
 
+at::Tensor embedding_bag_pooling(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    int64_t mode,
+    bool sparse,
+    bool include_last_offset) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::embedding_bag_pooling", "")
+          .typed<decltype(embedding_bag_pooling)>();
+  auto target_type = get_autocast_dtype();
+  // only have bf16 support now, keep fp32 for other target_type
+  bool cast_to_bfloat16 =
+      !at::GradMode::is_enabled() && at::kBFloat16 == target_type;
+  if (!cast_to_bfloat16) {
+    return op.call(
+        weight,
+        indices,
+        offsets,
+        per_sample_weights,
+        mode,
+        sparse,
+        include_last_offset);
+  }
+  // per_sample_weights should have the dtype of weight
+  c10::optional<at::Tensor> casted_per_sample_weights = per_sample_weights;
+  if (per_sample_weights.has_value()) {
+    casted_per_sample_weights =
+        cpu_cached_cast(at::kBFloat16, per_sample_weights.value());
+  }
+  return op.call(
+      cpu_cached_cast(at::kBFloat16, weight),
+      indices,
+      offsets,
+      casted_per_sample_weights,
+      mode,
+      sparse,
+      include_last_offset);
+}
+
 } // namespace autocast
 } // namespace torch_ipex
 
@@ -181,6 +302,74 @@ at::Tensor embedding_bag_meta(
   return output;
 }
 
+at::Tensor embedding_bag_out(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    bool sparse,
+    bool include_last_offset,
+    at::Tensor& out) {
+  RECORD_FUNCTION(
+      "torch_ipex::embedding_bag_out", c10::ArrayRef<c10::IValue>({}));
+
+  int64_t num_bags = offsets.numel() - (include_last_offset ? 1 : 0);
+  bool fits = !(at::GradMode::is_enabled() && weight.requires_grad()) &&
+      (weight.scalar_type() == at::kFloat ||
+       weight.scalar_type() == at::kBFloat16) &&
+      weight.dim() == 2 && weight.is_contiguous() && indices.dim() == 1 &&
+      indices.scalar_type() == at::kLong && offsets.dim() == 1 &&
+      offsets.scalar_type() == at::kLong && num_bags > 0 &&
+      out.scalar_type() == weight.scalar_type() && out.dim() == 2 &&
+      out.size(0) == num_bags && out.size(1) == weight.size(1) &&
+      out.stride(1) == 1;
+  if (!fits) {
+    return embedding_bag(weight, indices, offsets, sparse, include_last_offset);
+  }
+  /*
+  pointer to torch_ipex::cpu::embedding_bag_out_kernel_impl(
+      weight, indices, offsets, out);
+  */
+  cpu::embedding_bag_out_kernel_stub(kCPU, weight, indices, offsets, out);
+  return out;
+}
+
+at::Tensor embedding_bag_pooling(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    int64_t mode,
+    bool sparse,
+    bool include_last_offset) {
+  return cpu::_embedding_bag_pooling(
+      weight,
+      indices,
+      offsets,
+      per_sample_weights.value_or(at::Tensor()),
+      mode,
+      sparse,
+      include_last_offset);
+}
+
+at::Tensor embedding_bag_pooling_meta(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    int64_t mode,
+    bool sparse,
+    bool include_last_offset) {
+  auto num_bags = offsets.sym_size(0);
+  if (include_last_offset) {
+    num_bags -= 1;
+  }
+  c10::SymDimVector output_size(2);
+  output_size[0] = num_bags;
+  output_size[1] = weight.sym_size(1);
+  auto output = at::empty_symint(output_size, weight.options());
+  return output;
+}
+
 } // namespace torch_ipex
 
 namespace {
@@ -195,5 +384,28 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "embedding_bag",
       c10::DispatchKey::AutocastCPU,
       torch_ipex::autocast::embedding_bag);
+  m.def(
+      "embedding_bag_out(Tensor weight, Tensor indices, Tensor offsets, "
+      "bool sparse, bool include_last_offset, Tensor(a!) out) -> Tensor(a!)");
+  m.impl(
+      "embedding_bag_out",
+      c10::DispatchKey::CPU,
+      torch_ipex::embedding_bag_out);
+  m.def(
+      "embedding_bag_pooling(Tensor weight, Tensor indices, Tensor offsets, "
+      "Tensor? per_sample_weights, int mode, bool sparse, "
+      "bool include_last_offset) -> Tensor");
+  m.impl(
+      "embedding_bag_pooling",
+      c10::DispatchKey::CPU,
+      torch_ipex::embedding_bag_pooling);
+  m.impl(
+      "embedding_bag_pooling",
+      c10::DispatchKey::Meta,
+      torch_ipex::embedding_bag_pooling_meta);
+  m.impl(
+      "embedding_bag_pooling",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::embedding_bag_pooling);
 }
 } // namespace
@@ -18,6 +18,38 @@ at::Tensor embedding_bag_meta(
     bool sparse,
     bool include_last_offset);
 
+// embedding_bag writing the sums of the bags into out, e.g. its slice of a
+// cat planned by the JIT, whose rows may be strided. Returns out, or the
+// output of embedding_bag when out is not the [bags, dim] output of weight
+// with dense rows or when the gradient is required.
+at::Tensor embedding_bag_out(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    bool sparse,
+    bool include_last_offset,
+    at::Tensor& out);
+
+// embedding_bag with per_sample_weights (sum pooling) and max pooling,
+// mode follows PoolingMode: SUM = 0, MAX = 2.
+at::Tensor embedding_bag_pooling(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    int64_t mode,
+    bool sparse,
+    bool include_last_offset);
+
+at::Tensor embedding_bag_pooling_meta(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    int64_t mode,
+    bool sparse,
+    bool include_last_offset);
+
 } // namespace torch_ipex
 
 namespace torch_ipex {
@@ -25,49 +57,89 @@ namespace cpu {
 
 namespace {
 
-at::Tensor embedding_bag_kernel_impl(
+std::tuple<at::Tensor, at::Tensor> embedding_bag_kernel_impl(
     const at::Tensor& weight,
     const at::Tensor& indices,
     const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    int64_t mode,
     bool include_last_offset);
 
 at::Tensor embedding_bag_backward_kernel_impl(
     const at::Tensor& grad,
     const at::Tensor& indices,
     const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    const at::Tensor& max_indices,
+    int64_t mode,
     int64_t num_weights,
     bool sparse);
 
+void embedding_bag_out_kernel_impl(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    at::Tensor& output);
+
+at::Tensor embedding_bag_per_sample_weights_backward_kernel_impl(
+    const at::Tensor& grad,
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets);
+
 at::Tensor embedding_bag_int8_kernel_impl(
     const at::Tensor& qweight,
     const at::Tensor& indices,
     const at::Tensor& offsets,
-    bool include_last_offset);
+    bool include_last_offset,
+    double o_scale);
 
 } // namespace
 
-using embedding_bag_kernel_fn = at::Tensor (*)(
+using embedding_bag_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
     const at::Tensor&,
     const at::Tensor&,
     const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
     bool);
 DECLARE_DISPATCH(embedding_bag_kernel_fn, embedding_bag_kernel_stub);
 
+using embedding_bag_out_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(embedding_bag_out_kernel_fn, embedding_bag_out_kernel_stub);
+
 using embedding_bag_backward_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
     const at::Tensor&,
     const at::Tensor&,
     const at::Tensor&,
     int64_t,
+    int64_t,
     bool);
 DECLARE_DISPATCH(
     embedding_bag_backward_kernel_fn,
     embedding_bag_backward_kernel_stub);
 
+using embedding_bag_per_sample_weights_backward_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&);
+DECLARE_DISPATCH(
+    embedding_bag_per_sample_weights_backward_kernel_fn,
+    embedding_bag_per_sample_weights_backward_kernel_stub);
+
 using embedding_bag_int8_kernel_fn = at::Tensor (*)(
     const at::Tensor&,
     const at::Tensor&,
     const at::Tensor&,
-    bool);
+    bool,
+    double);
 DECLARE_DISPATCH(embedding_bag_int8_kernel_fn, embedding_bag_int8_kernel_stub);
 
 } // namespace cpu
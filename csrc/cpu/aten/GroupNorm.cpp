@@ -22,6 +22,8 @@ namespace cpu {
 
 DEFINE_DISPATCH(GroupNormKernel);
 DEFINE_DISPATCH(GroupNormBackwardKernel);
+DEFINE_DISPATCH(GroupNormTransposeKernel);
+DEFINE_DISPATCH(GroupNormSiLUKernel);
 
 void check_group_norm_inputs(
     const at::Tensor& input,
@@ -228,6 +230,128 @@ at::Tensor group_norm(
       at::native_group_norm(X, gamma, beta, N, C, HxW, num_groups, eps));
 }
 
+at::Tensor group_norm_transpose(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt /* optional */,
+    const c10::optional<at::Tensor>& bias_opt /* optional */,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::group_norm_transpose\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::group_norm_transpose", c10::ArrayRef<c10::IValue>({}));
+
+  // See [Note: hacky wrapper removal for optional tensor]
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+
+  TORCH_CHECK(
+      input.dim() >= 3,
+      "group_norm_transpose expects an input of at least 3 dims, got ",
+      input.sizes());
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  check_group_norm_inputs(input, weight, bias, C, num_groups);
+
+  const auto input_shape = input.sizes();
+  const int64_t HxW =
+      c10::multiply_integers(input_shape.cbegin() + 2, input_shape.cend());
+
+  // Both a contiguous and a channels last input are read in place, Y is
+  // written in the [N, HxW, C] order by the kernel
+  auto memory_format = input.suggest_memory_format();
+  const auto& X =
+      is_channels_last_1d(input) ? input : input.contiguous(memory_format);
+  const auto gamma = weight.defined() ? weight.contiguous() : weight;
+  const auto beta = bias.defined() ? bias.contiguous() : bias;
+  bool mixed_type = at::native::is_mixed_type(X, gamma, beta);
+  if (mixed_type) {
+    at::native::check_mixed_data_type(X, gamma, beta);
+  }
+
+  at::Tensor Y = at::empty({N, HxW, C}, X.options());
+  const auto dtype = at::native::param_scalar_type(X, mixed_type);
+  at::Tensor mean = at::empty({N, num_groups}, X.options().dtype(dtype));
+  at::Tensor rstd = at::empty({N, num_groups}, X.options().dtype(dtype));
+  GroupNormTransposeKernel(
+      kCPU, X, gamma, beta, N, C, HxW, num_groups, eps, Y, mean, rstd);
+  return Y;
+}
+
+at::Tensor group_norm_view_transpose(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt /* optional */,
+    const c10::optional<at::Tensor>& bias_opt /* optional */,
+    double eps,
+    at::IntArrayRef size) {
+  if (input.dim() >= 3) {
+    const auto input_shape = input.sizes();
+    const int64_t HxW =
+        c10::multiply_integers(input_shape.cbegin() + 2, input_shape.cend());
+    std::vector<int64_t> flatten_size = {input.size(0), input.size(1), HxW};
+    if (at::infer_size(size, input.numel()) == flatten_size) {
+      return group_norm_transpose(
+          input, num_groups, weight_opt, bias_opt, eps);
+    }
+  }
+  return at::group_norm(input, num_groups, weight_opt, bias_opt, eps)
+      .view(size)
+      .transpose(1, 2);
+}
+
+at::Tensor group_norm_silu(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt /* optional */,
+    const c10::optional<at::Tensor>& bias_opt /* optional */,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::group_norm_silu\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::group_norm_silu", c10::ArrayRef<c10::IValue>({}));
+
+  // See [Note: hacky wrapper removal for optional tensor]
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+
+  TORCH_CHECK(
+      input.dim() == 4,
+      "group_norm_silu expects a 4D input, got ",
+      input.sizes());
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  check_group_norm_inputs(input, weight, bias, C, num_groups);
+  const int64_t HxW = input.size(2) * input.size(3);
+
+  const auto X = input.contiguous(at::MemoryFormat::ChannelsLast);
+  const auto gamma = weight.defined() ? weight.contiguous() : weight;
+  const auto beta = bias.defined() ? bias.contiguous() : bias;
+  bool mixed_type = at::native::is_mixed_type(X, gamma, beta);
+  if (mixed_type) {
+    at::native::check_mixed_data_type(X, gamma, beta);
+  }
+
+  at::Tensor Y = at::empty_like(X, at::MemoryFormat::ChannelsLast);
+  if (X.numel() == 0) {
+    return Y;
+  }
+  const auto dtype = at::native::param_scalar_type(X, mixed_type);
+  at::Tensor mean = at::empty({N, num_groups}, X.options().dtype(dtype));
+  at::Tensor rstd = at::empty({N, num_groups}, X.options().dtype(dtype));
+  GroupNormSiLUKernel(
+      kCPU, X, gamma, beta, N, C, HxW, num_groups, eps, Y, mean, rstd);
+  return Y;
+}
+
 IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::group_norm"),
@@ -242,3 +366,16 @@ IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
 
 } // namespace cpu
 } // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "group_norm_transpose(Tensor input, int num_groups, Tensor? weight, Tensor? bias, float eps) -> Tensor",
+      torch_ipex::cpu::group_norm_transpose);
+  m.def(
+      "group_norm_silu(Tensor input, int num_groups, Tensor? weight, Tensor? bias, float eps) -> Tensor",
+      torch_ipex::cpu::group_norm_silu);
+}
+
+} // namespace
@@ -37,6 +37,40 @@ using backward_fn = void (*)(
 
 DECLARE_DISPATCH(forward_fn, GroupNormKernel);
 DECLARE_DISPATCH(backward_fn, GroupNormBackwardKernel);
+// Same as GroupNormKernel, but Y is always written as [N, HxW, C]
+DECLARE_DISPATCH(forward_fn, GroupNormTransposeKernel);
+// Same as GroupNormKernel followed by SiLU, for a channels last X and Y
+DECLARE_DISPATCH(forward_fn, GroupNormSiLUKernel);
+
+// Group norm whose output is the [N, HxW, C] contiguous tensor of
+// input.view(N, C, HxW).transpose(1, 2), as consumed by the QKV linear of
+// the Stable Diffusion attention blocks.
+at::Tensor group_norm_transpose(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
+// group_norm(input).view(size).transpose(1, 2), fused into
+// group_norm_transpose when size flattens the spatial dims of the input.
+at::Tensor group_norm_view_transpose(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps,
+    at::IntArrayRef size);
+
+// silu(group_norm(input)) of a 4D float or bfloat16 input, written once as a
+// channels last tensor, as consumed by the convolutions of the Stable
+// Diffusion UNet ResBlocks.
+at::Tensor group_norm_silu(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "GroupedLinear.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(grouped_linear_kernel_stub);
+
+std::vector<at::Tensor> grouped_linear(
+    at::TensorList inputs,
+    at::TensorList weights,
+    const c10::List<c10::optional<at::Tensor>>& biases) {
+  RECORD_FUNCTION("grouped_linear", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      inputs.size() == weights.size() && inputs.size() == biases.size(),
+      "grouped_linear expects the same number of inputs, weights and biases");
+  std::vector<at::Tensor> inputs_, weights_, biases_, outputs;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const auto& input = inputs[i];
+    const auto& weight = weights[i];
+    at::Tensor bias = biases.get(i).has_value() ? biases.get(i).value()
+                                                : at::Tensor();
+    auto dtype = input.scalar_type();
+    TORCH_CHECK(
+        dtype == at::kFloat || dtype == at::kBFloat16,
+        "grouped_linear only supports float and bfloat16");
+    TORCH_CHECK(
+        weight.dim() == 2 && input.dim() > 0 &&
+            input.size(-1) == weight.size(1),
+        "grouped_linear: the input of linear ",
+        i,
+        " does not match its weight");
+    TORCH_CHECK(
+        weight.scalar_type() == dtype &&
+            (!bias.defined() || bias.scalar_type() == dtype),
+        "grouped_linear expects the weight and bias of the input dtype");
+    auto output_size = input.sizes().vec();
+    output_size.back() = weight.size(0);
+    auto output = at::empty(output_size, input.options());
+    inputs_.push_back(input.contiguous().view({-1, weight.size(1)}));
+    weights_.push_back(weight.contiguous());
+    biases_.push_back(bias.defined() ? bias.contiguous() : bias);
+    outputs.push_back(output.view({-1, weight.size(0)}));
+  }
+  /*
+  pointer to grouped_linear_kernel_impl(inputs_, weights_, biases_, outputs);
+  */
+  grouped_linear_kernel_stub(kCPU, inputs_, weights_, biases_, outputs);
+  for (size_t i = 0; i < outputs.size(); i++) {
+    auto output_size = inputs[i].sizes().vec();
+    output_size.back() = weights[i].size(0);
+    outputs[i] = outputs[i].view(output_size);
+  }
+  return outputs;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "grouped_linear(Tensor[] inputs, Tensor[] weights, Tensor?[] biases) -> Tensor[]");
+  m.impl(
+      "grouped_linear",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::grouped_linear);
+}
+
+} // namespace
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * Runs the independent linears outputs[i] = linear(inputs[i], weights[i],
+ * biases[i]) in one parallel region, with a work partition over the tiles of
+ * all the GEMMs at once. It saves the OpenMP barrier per GEMM, which dominates
+ * when each GEMM is small, e.g. the towers of recommendation models. The
+ * weights are plain [out_features, in_features] of the input dtype, float or
+ * bfloat16, while the inputs may have different shapes.
+ * */
+std::vector<at::Tensor> grouped_linear(
+    at::TensorList inputs,
+    at::TensorList weights,
+    const c10::List<c10::optional<at::Tensor>>& biases);
+
+namespace {
+
+void grouped_linear_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& weights,
+    const std::vector<at::Tensor>& biases,
+    std::vector<at::Tensor>& outputs);
+
+} // namespace
+
+using grouped_linear_kernel_fn = void (*)(
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    std::vector<at::Tensor>&);
+DECLARE_DISPATCH(grouped_linear_kernel_fn, grouped_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,239 @@
+#include <ATen/ATen.h>
+#include <ATen/MemoryOverlap.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/Resize.h>
+#include <ATen/record_function.h>
+
+#include <limits>
+
+#include <utils/library.h>
+
+#include "IndexAdd.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(index_add_kernel_stub);
+
+namespace {
+
+// Whether the sorted index_add kernel applies to result.index_add_(dim, index,
+// source), the other cases falling back to the accumulating index_put_
+bool use_index_add_kernel(
+    const at::Tensor& result,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source) {
+  auto dtype = result.scalar_type();
+  if ((dtype != at::kFloat && dtype != at::kDouble &&
+       dtype != at::kBFloat16) ||
+      source.scalar_type() != dtype || !result.is_contiguous() ||
+      result.dim() == 0 || source.dim() != result.dim() || index.dim() > 1 ||
+      (index.scalar_type() != at::kLong && index.scalar_type() != at::kInt) ||
+      index.numel() == 0 || index.numel() != source.size(dim) ||
+      result.size(dim) > std::numeric_limits<int>::max() ||
+      index.numel() > std::numeric_limits<int>::max()) {
+    return false;
+  }
+  for (int64_t d = 0; d < result.dim(); d++) {
+    if (d != dim && source.size(d) != result.size(d)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+at::Tensor& index_add_impl(
+    at::Tensor& result,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    int64_t skip_index = -1) {
+  dim = at::maybe_wrap_dim(dim, result.dim());
+  if (use_index_add_kernel(result, dim, index, source)) {
+    at::assert_no_overlap(result, index);
+    at::assert_no_overlap(result, source);
+    auto index_contig = index.contiguous();
+    auto source_contig = source.contiguous();
+    /*
+    pointer to index_add_kernel_impl(
+        result, dim, index_contig, source_contig, alpha, skip_index);
+    */
+    index_add_kernel_stub(
+        kCPU, result, dim, index_contig, source_contig, alpha, skip_index);
+    return result;
+  }
+
+  TORCH_CHECK(
+      index.dim() <= 1, "index_add_(): Index is supposed to be a vector");
+  auto scaled = alpha.equal(1) ? source : source.mul(alpha);
+  if (result.dim() == 0) {
+    TORCH_CHECK_INDEX(
+        index.numel() == 1 && index.item<int64_t>() == 0,
+        "index_add_(): index out of range for a 0-dim tensor");
+    return result.add_(scaled.reshape({}));
+  }
+  // the index of dim selecting the slices of source, the other dims whole
+  c10::List<c10::optional<at::Tensor>> indices;
+  for (int64_t d = 0; d < dim; d++) {
+    indices.push_back(c10::nullopt);
+  }
+  indices.push_back(index.reshape({-1}).to(at::kLong));
+  return result.index_put_(indices, scaled, /*accumulate=*/true);
+}
+
+// The index vector of a scatter along dim whose index is expanded along the
+// other dims to the shape of src and of self, e.g. the index of the edges of
+// a GNN expanded to their features, or an undefined tensor
+at::Tensor scatter_index_vector(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+  if (index.dim() != self.dim() || src.dim() != self.dim() ||
+      index.sizes() != src.sizes()) {
+    return at::Tensor();
+  }
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d != dim &&
+        (index.size(d) != self.size(d) ||
+         (index.size(d) != 1 && index.stride(d) != 0))) {
+      return at::Tensor();
+    }
+  }
+  return index.as_strided({index.size(dim)}, {index.stride(dim)});
+}
+
+} // namespace
+
+at::Tensor& index_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    at::Tensor& result) {
+  RECORD_FUNCTION(
+      "torch_ipex::index_add_out_cpu_", c10::ArrayRef<c10::IValue>({}));
+  if (!result.is_same(self)) {
+    at::native::resize_output(result, self.sizes());
+    result.copy_(self);
+  }
+  return index_add_impl(result, dim, index, source, alpha);
+}
+
+at::Tensor& index_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+  RECORD_FUNCTION(
+      "torch_ipex::index_add_cpu__", c10::ArrayRef<c10::IValue>({}));
+  return index_add_impl(self, dim, index, source, alpha);
+}
+
+at::Tensor index_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+  RECORD_FUNCTION(
+      "torch_ipex::index_add_cpu_", c10::ArrayRef<c10::IValue>({}));
+  auto result = self.clone(at::MemoryFormat::Contiguous);
+  return index_add_impl(result, dim, index, source, alpha);
+}
+
+at::Tensor& scatter_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src,
+    at::Tensor& result) {
+  RECORD_FUNCTION(
+      "torch_ipex::scatter_add_out_cpu_", c10::ArrayRef<c10::IValue>({}));
+  if (!result.is_same(self)) {
+    at::native::resize_output(result, self.sizes());
+    result.copy_(self);
+  }
+  return scatter_add_cpu__(result, dim, index, src);
+}
+
+at::Tensor& scatter_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  auto index_vector = scatter_index_vector(self, dim, index, src);
+  if (index_vector.defined() &&
+      use_index_add_kernel(self, dim, index_vector, src)) {
+    return index_add_impl(self, dim, index_vector, src, 1);
+  }
+  return self.scatter_reduce_(dim, index, src, "sum", /*include_self=*/true);
+}
+
+at::Tensor scatter_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+  RECORD_FUNCTION(
+      "torch_ipex::scatter_add_cpu_", c10::ArrayRef<c10::IValue>({}));
+  auto result = self.clone(at::MemoryFormat::Contiguous);
+  return scatter_add_cpu__(result, dim, index, src);
+}
+
+at::Tensor embedding_dense_backward_cpu_(
+    const at::Tensor& grad_output,
+    const at::Tensor& indices,
+    int64_t num_weights,
+    int64_t padding_idx,
+    bool scale_grad_by_freq) {
+  RECORD_FUNCTION(
+      "torch_ipex::embedding_dense_backward_cpu_",
+      c10::ArrayRef<c10::IValue>({}));
+  auto dtype = grad_output.scalar_type();
+  if (scale_grad_by_freq ||
+      (dtype != at::kFloat && dtype != at::kDouble && dtype != at::kBFloat16) ||
+      indices.numel() == 0 || grad_output.numel() == 0) {
+    return at::native::embedding_dense_backward_cpu(
+        grad_output, indices, num_weights, padding_idx, scale_grad_by_freq);
+  }
+  auto num_indices = indices.numel();
+  auto grad = grad_output.reshape({num_indices, grad_output.size(-1)});
+  auto grad_weight =
+      at::zeros({num_weights, grad_output.size(-1)}, grad_output.options());
+  // the rows of the padding index get no gradient
+  return index_add_impl(
+      grad_weight, 0, indices.reshape({num_indices}), grad, 1, padding_idx);
+}
+
+IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add.out"),
+      TORCH_FN((&torch_ipex::cpu::index_add_out_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add_"),
+      TORCH_FN((&torch_ipex::cpu::index_add_cpu__)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add"),
+      TORCH_FN((&torch_ipex::cpu::index_add_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add.out"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_out_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add_"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_cpu__)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::embedding_dense_backward"),
+      TORCH_FN((&torch_ipex::cpu::embedding_dense_backward_cpu_)));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+at::Tensor& index_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    at::Tensor& result);
+
+at::Tensor& index_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
+at::Tensor index_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
+at::Tensor& scatter_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src,
+    at::Tensor& result);
+
+at::Tensor& scatter_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src);
+
+at::Tensor scatter_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src);
+
+at::Tensor embedding_dense_backward_cpu_(
+    const at::Tensor& grad_output,
+    const at::Tensor& indices,
+    int64_t num_weights,
+    int64_t padding_idx,
+    bool scale_grad_by_freq);
+
+namespace {
+
+void index_add_kernel_impl(
+    at::Tensor& result,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    int64_t skip_index);
+
+} // namespace
+
+// result.index_add_(dim, index, source, alpha=alpha) of a contiguous float,
+// double or bfloat16 result and source of its dtype: the positions of the
+// source slices are sorted by their index, and the slices of an index are
+// summed in their order by a single task, in fp32 for bfloat16, so that no
+// two tasks write the same slice of result and the sum is deterministic. The
+// slices of skip_index, e.g. the padding index of an embedding, are skipped.
+using index_add_kernel_fn = void (*)(
+    at::Tensor&,
+    int64_t,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Scalar&,
+    int64_t);
+DECLARE_DISPATCH(index_add_kernel_fn, index_add_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -2,6 +2,7 @@
 #include "Interaction.h"
 #include "autocast/autocast_mode.h"
 #include "ideep/IDeepConversions.h"
+#include "utils/op_stats.h"
 
 #include <ATen/Parallel.h>
 #include <ATen/quantized/Quantizer.h>
@@ -21,6 +22,11 @@ DEFINE_DISPATCH(interaction_backward_kernel_stub);
 DEFINE_DISPATCH(dil_qinteraction_kernel_stub);
 
 at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
+  // the dot products of the pairs of the features of each sample
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::interaction_forward",
+      utils::nbytes(input),
+      input[0].size(0) * input.size() * (input.size() - 1) * input[0].size(1));
   // pointer to interaction_forward_kernel_impl(input);
   return interaction_forward_kernel_stub(kCPU, input);
 }
@@ -28,6 +34,11 @@ at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
 std::vector<at::Tensor> _interaction_backward(
     const at::Tensor& grad_out,
     const std::vector<at::Tensor>& input) {
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::interaction_backward",
+      utils::nbytes(grad_out) + 2 * utils::nbytes(input),
+      2 * input[0].size(0) * input.size() * (input.size() - 1) *
+          input[0].size(1));
   // pointer to interaction_backward_kernel_impl(grad_out, input);
   return interaction_backward_kernel_stub(kCPU, grad_out, input);
 }
@@ -83,9 +94,15 @@ at::Tensor interaction_forward(const std::vector<at::Tensor>& input) {
                        .findSchemaOrThrow("torch_ipex::interaction_forward", "")
                        .typed<decltype(interaction_forward)>();
 
-  auto target_type = get_autocast_dtype();
-
   auto type = promote_type(get_autocast_dtype(), input);
+  // the kernel promotes the mixed fp32 and bf16 inputs to fp32 on load
+  bool fp32_or_bf16 = std::all_of(input.begin(), input.end(), [](auto& in) {
+    return in.scalar_type() == at::kFloat ||
+        in.scalar_type() == at::kBFloat16;
+  });
+  if (type == at::kFloat && fp32_or_bf16) {
+    return op.call(input);
+  }
   return op.call(cpu_cached_cast(type, input));
 }
 
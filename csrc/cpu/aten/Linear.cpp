@@ -2,6 +2,7 @@
 
 #include "Eltwise.h"
 #include "Linear.h"
+#include "LinearEpilogue.h"
 #include "WeightPack.h"
 #include "autocast/autocast_mode.h"
 #include "ideep/IDeepConversions.h"
@@ -9,7 +10,78 @@
 namespace torch_ipex {
 namespace cpu {
 
-enum EltwiseType { NotFused = 0, ReLU = 1, Sigmoid = 2 };
+DEFINE_DISPATCH(linear_small_m_kernel_stub);
+
+enum EltwiseType {
+  NotFused = 0,
+  ReLU = 1,
+  Sigmoid = 2,
+  Tanh = 3,
+  Swish = 4,
+  GeLUTanhApprox = 5
+};
+
+namespace {
+
+// ReLU, sigmoid and tanh are differentiated from their output, the input of
+// the next layer saved anyway. SiLU and GeLU(tanh) can't be inverted from
+// their output: the linear output is saved instead, and they and their
+// gradients are applied by the vectorized kernels of the linear epilogue.
+bool eltwise_use_src_for_bwd(int64_t eltwise) {
+  return eltwise == Swish || eltwise == GeLUTanhApprox;
+}
+
+// output = act(pre_act) of a src based eltwise, in place if output is pre_act
+void linear_eltwise_epilogue(
+    const at::Tensor& pre_act,
+    at::Tensor& output,
+    int64_t eltwise) {
+  int64_t N = pre_act.size(-1);
+  auto output_ = output.view({-1, N});
+  at::Tensor mask;
+  /*
+  pointer to linear_epilogue_kernel_impl(
+      pre_act, residual, output, mask, activation, p, seed);
+  */
+  linear_epilogue_kernel_stub(
+      kCPU,
+      pre_act.view({-1, N}),
+      at::Tensor(),
+      output_,
+      mask,
+      eltwise == Swish ? SiLU : GeLUTanh,
+      0.f,
+      0);
+}
+
+// The small M kernel only reads plain [out_features, in_features] weights of
+// the input dtype and has no post-op fusion.
+bool use_linear_small_m_kernel(
+    const at::Tensor& self,
+    const ideep::tensor& mkldnn_weight,
+    const at::Tensor& bias,
+    const at::Tensor& output,
+    const ideep::attr_t& attr) {
+  auto dtype = self.scalar_type();
+  if (dtype != at::kFloat && dtype != at::kBFloat16) {
+    return false;
+  }
+  int64_t K = self.size(self.dim() - 1);
+  if (self.numel() == 0 || self.numel() / K > linear_small_m) {
+    return false;
+  }
+  if (attr.has_post_op() || output.scalar_type() != dtype ||
+      !output.is_contiguous() ||
+      (bias.defined() && bias.scalar_type() != dtype) ||
+      mkldnn_weight.get_data_type() != get_mkldnn_dtype(dtype)) {
+    return false;
+  }
+  auto desc = mkldnn_weight.get_desc();
+  return desc.is_plain() && desc.get_strides() == ideep::dims({K, 1});
+}
+
+} // namespace
+
 /**
  * Linear inplace version with oneDNN kernel.
  * Inplace version will be used when user provides output tensor. eg: Linear+Add
@@ -28,6 +100,21 @@ void linear_kernel_output(
     const at::Tensor& bias,
     at::Tensor& output,
     const ideep::attr_t& attr) {
+  if (use_linear_small_m_kernel(self, mkldnn_weight, bias, output, attr)) {
+    int64_t K = self.size(self.dim() - 1);
+    auto weight = at::from_blob(
+        mkldnn_weight.get_data_handle(),
+        {mkldnn_weight.get_dim(0), K},
+        self.options());
+    auto output_ = output.view({-1, mkldnn_weight.get_dim(0)});
+    /*
+    pointer to linear_small_m_kernel_impl(
+        self.view({-1, K}), weight, bias, output_);
+    */
+    linear_small_m_kernel_stub(
+        kCPU, self.contiguous().view({-1, K}), weight, bias, output_);
+    return;
+  }
   auto self_ = self.is_contiguous() ? self : self.contiguous();
   const int64_t dim = self.dim();
   auto self_reshaped =
@@ -172,14 +259,23 @@ at::Tensor linear_eltwise_forward(
     const int64_t eltwise,
     const at::Tensor& op_context,
     const c10::optional<int64_t> out_features) {
+  auto linear_op_context =
+      reinterpret_cast<IpexLinearOpContext*>(op_context.data_ptr<int64_t>()[0]);
+  if (eltwise_use_src_for_bwd(eltwise)) {
+    auto output =
+        linear_op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode));
+    linear_eltwise_epilogue(output, output, eltwise);
+    return output;
+  }
   auto attr = ideep::attr_t();
   if (eltwise == ReLU)
     attr = ideep::attr_t::fuse_relu();
-  else
+  else if (eltwise == Sigmoid)
     attr = ideep::attr_t::fuse_sigmoid();
-  return reinterpret_cast<IpexLinearOpContext*>(
-             op_context.data_ptr<int64_t>()[0])
-      ->run(input, attr.set_fpmath_mode(torch_ipex::fpmath_mode));
+  else
+    attr = ideep::attr_t::fuse_tanh();
+  return linear_op_context->run(
+      input, attr.set_fpmath_mode(torch_ipex::fpmath_mode));
 }
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> linear_backward(
@@ -233,6 +329,15 @@ at::Tensor IPEXLinearOp::forward(
   ctx->saved_data["bias_requires_grad"] =
       bias.has_value() && bias.value().requires_grad() ? true : false;
   ctx->saved_data["eltwise"] = eltwise;
+  if (eltwise_use_src_for_bwd(eltwise)) {
+    // the linear output is saved for the backward of the activation
+    auto pre_act =
+        _forward(input, weight, bias, NotFused, op_context, out_features);
+    auto output = at::empty_like(pre_act);
+    linear_eltwise_epilogue(pre_act, output, eltwise);
+    ctx->save_for_backward({input, pre_act});
+    return output;
+  }
   auto output =
       _forward(input, weight, bias, eltwise, op_context, out_features);
   if (eltwise == NotFused)
@@ -259,11 +364,29 @@ torch::autograd::tensor_list IPEXLinearOp::backward(
   at::Tensor grad_output;
   if (eltwise == NotFused) {
     grad_output = grad_outputs[0];
+  } else if (eltwise_use_src_for_bwd(eltwise)) {
+    at::Tensor pre_act = saved[1];
+    int64_t N = pre_act.size(-1);
+    /*
+    pointer to linear_epilogue_backward_kernel_impl(
+        grad_output, pre_act, mask, activation, p);
+    */
+    grad_output = linear_epilogue_backward_kernel_stub(
+                      kCPU,
+                      grad_outputs[0].contiguous().view({-1, N}),
+                      pre_act.view({-1, N}),
+                      at::Tensor(),
+                      eltwise == Swish ? SiLU : GeLUTanh,
+                      0.f)
+                      .view(pre_act.sizes());
   } else {
     at::Tensor output = saved[1];
-    grad_output = eltwise == ReLU
-        ? relu_use_dst_for_bwd(grad_outputs[0], output)
-        : sigmoid_use_dst_for_bwd(grad_outputs[0], output);
+    if (eltwise == ReLU)
+      grad_output = relu_use_dst_for_bwd(grad_outputs[0], output);
+    else if (eltwise == Sigmoid)
+      grad_output = sigmoid_use_dst_for_bwd(grad_outputs[0], output);
+    else
+      grad_output = tanh_use_dst_for_bwd(grad_outputs[0], output);
   }
 
   at::Tensor grad_input, grad_weight, grad_bias;
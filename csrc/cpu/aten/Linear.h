@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
 #include <torch/csrc/autograd/custom_function.h>
 #include <vector>
 
@@ -10,6 +11,13 @@
 namespace torch_ipex {
 namespace cpu {
 
+// Inputs of at most linear_small_m rows (batch-1 / few-token decoding) go to
+// a GEMV-like kernel on the plain [out_features, in_features] weight instead
+// of a oneDNN primitive, whose creation overhead dominates in that regime.
+// Weights prepacked with a sample batch of at most linear_small_m rows are
+// kept plain for it.
+const int64_t linear_small_m = 8;
+
 void linear_kernel_output(
     const at::Tensor& self,
     const ideep::tensor& mkldnn_weight,
@@ -75,5 +83,22 @@ at::Tensor ipex_linear_eltwise(
     const at::Tensor& op_context,
     const c10::optional<int64_t> out_features);
 
+namespace {
+
+void linear_small_m_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output);
+
+} // namespace
+
+using linear_small_m_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(linear_small_m_kernel_fn, linear_small_m_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
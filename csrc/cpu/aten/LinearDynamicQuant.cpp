@@ -0,0 +1,106 @@
+#include "LinearDynamicQuant.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(dynamic_quant_linear_kernel_stub);
+
+std::tuple<at::Tensor, at::Tensor> dynamic_quant_linear_quantize_weight(
+    const at::Tensor& weight) {
+  TORCH_CHECK(weight.dim() == 2, "expect the 2-D weight of a linear");
+  auto w = weight.to(at::kFloat).contiguous();
+  auto scales = std::get<0>(w.abs().max(-1)) / 127.f;
+  scales.masked_fill_(scales == 0, 1.f);
+  auto qweight = at::clamp(at::round(w / scales.unsqueeze(-1)), -127, 127)
+                     .to(at::kChar);
+  return std::make_tuple(qweight, scales);
+}
+
+at::Tensor dynamic_quant_linear_pack_weight(const at::Tensor& qweight) {
+  TORCH_CHECK(
+      qweight.dim() == 2 && qweight.scalar_type() == at::kChar,
+      "expect the int8 quantized weight of [out_features, in_features]");
+  int64_t N = qweight.size(0);
+  int64_t K = qweight.size(1);
+  int64_t Np = (N + dq_block_n - 1) / dq_block_n * dq_block_n;
+  int64_t Kp = (K + dq_block_k - 1) / dq_block_k * dq_block_k;
+  auto padded = at::constant_pad_nd(qweight, {0, Kp - K, 0, Np - N}, 0);
+  // [Np / block_n, block_n, Kp / block_k, block_k]
+  //   -> [Np / block_n, Kp / block_k, block_n, block_k]
+  return padded
+      .view({Np / dq_block_n, dq_block_n, Kp / dq_block_k, dq_block_k})
+      .permute({0, 2, 1, 3})
+      .contiguous();
+}
+
+at::Tensor dynamic_quant_linear_unpack_weight(
+    const at::Tensor& packed_weight,
+    int64_t out_features,
+    int64_t in_features) {
+  int64_t Kp = packed_weight.size(1) * dq_block_k;
+  return packed_weight.permute({0, 2, 1, 3})
+      .reshape({-1, Kp})
+      .narrow(0, 0, out_features)
+      .narrow(1, 0, in_features)
+      .contiguous();
+}
+
+at::Tensor dynamic_quant_linear_compensation(const at::Tensor& packed_weight) {
+  return packed_weight.to(at::kInt)
+      .sum({1, 3}, /* keepdim */ false, at::kInt)
+      .view({-1})
+      .contiguous();
+}
+
+at::Tensor dynamic_quant_linear_kernel(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& compensation,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    int64_t out_features) {
+  auto input_size = input.sizes();
+  std::vector<int64_t> output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(out_features);
+  auto output = at::empty(output_size, input.options());
+  /*
+  pointer to dynamic_quant_linear_kernel_impl(
+      input, packed_weight, compensation, scales, bias, output);
+  */
+  dynamic_quant_linear_kernel_stub(
+      kCPU,
+      input.contiguous(),
+      packed_weight,
+      compensation,
+      scales,
+      bias,
+      output);
+  return output;
+}
+
+at::Tensor dynamic_quant_linear_forward(
+    const at::Tensor& input,
+    const at::Tensor& op_context) {
+  RECORD_FUNCTION(
+      "torch_ipex::ipex_dynamic_quant_linear", c10::ArrayRef<c10::IValue>({}));
+  return reinterpret_cast<IpexDynamicQuantLinearOpContext*>(
+             op_context.data_ptr<int64_t>()[0])
+      ->run(input);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "ipex_dynamic_quant_linear(Tensor input, Tensor W_prepack) -> Tensor");
+  m.impl(
+      "ipex_dynamic_quant_linear",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::dynamic_quant_linear_forward);
+}
+
+} // namespace
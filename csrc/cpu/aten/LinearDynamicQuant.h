@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <vector>
+#include "cpu/kernels/OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+// Dynamic quantized linear: the weight of [N, K] is quantized once to int8,
+// symmetric with one fp32 scale per output channel. Each row (token) of the
+// activation is quantized to uint8 with its own scale and zero point when the
+// op runs, the int8 GEMM accumulates in int32 and its epilogue dequantizes and
+// adds the bias:
+//   y[m][n] = sx[m] * sw[n] * (sum_k xq[m][k] * wq[n][k] - zx[m] * c[n]) + b[n]
+// with c[n] = sum_k wq[n][k] the compensation of the activation zero point.
+//
+// Packed weight layout, N padded to a multiple of dq_block_n and K to a
+// multiple of dq_block_k, for the u8 x s8 dot products of 4 bytes (VNNI):
+//   int8 [N / block_n, K / block_k, block_n, block_k]
+const int64_t dq_block_n = 16;
+const int64_t dq_block_k = 4;
+
+// Returns the (int8 weight, fp32 scales of [N]) of an fp32 weight, symmetric
+// per output channel
+std::tuple<at::Tensor, at::Tensor> dynamic_quant_linear_quantize_weight(
+    const at::Tensor& weight);
+
+at::Tensor dynamic_quant_linear_pack_weight(const at::Tensor& qweight);
+
+at::Tensor dynamic_quant_linear_unpack_weight(
+    const at::Tensor& packed_weight,
+    int64_t out_features,
+    int64_t in_features);
+
+// Returns the int32 compensation c[n] of the padded N of a packed weight
+at::Tensor dynamic_quant_linear_compensation(const at::Tensor& packed_weight);
+
+at::Tensor dynamic_quant_linear_kernel(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& compensation,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    int64_t out_features);
+
+at::Tensor dynamic_quant_linear_forward(
+    const at::Tensor& input,
+    const at::Tensor& op_context);
+
+namespace {
+
+void dynamic_quant_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& compensation,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    at::Tensor& output);
+
+} // namespace
+
+using dynamic_quant_linear_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    dynamic_quant_linear_kernel_fn,
+    dynamic_quant_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,298 @@
+#include "LinearEpilogue.h"
+#include <ATen/CPUGeneratorImpl.h>
+#include <torch/all.h>
+
+#include "autocast/autocast_mode.h"
+#include "cpu/kernels/OpContext.h"
+
+#include <mutex>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(linear_epilogue_kernel_stub);
+DEFINE_DISPATCH(linear_epilogue_backward_kernel_stub);
+DEFINE_DISPATCH(linear_gate_kernel_stub);
+
+namespace {
+
+IpexLinearOpContext* get_linear_op_context(const at::Tensor& op_context) {
+  return reinterpret_cast<IpexLinearOpContext*>(
+      op_context.data_ptr<int64_t>()[0]);
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> IPEXLinearEpilogueOp::_forward(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const bool save_for_backward) {
+  RECORD_FUNCTION(
+      "IPEXLinearEpilogueOp::_forward", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      activation >= NoAct && activation <= SiLU,
+      "ipex_linear_epilogue: unknown activation ",
+      activation);
+  TORCH_CHECK(p >= 0 && p <= 1, "dropout probability has to be in [0, 1]");
+  auto pre_act = get_linear_op_context(op_context)->run(
+      input, ideep::attr_t(torch_ipex::fpmath_mode));
+  int64_t N = pre_act.size(-1);
+  auto pre_act_ = pre_act.view({-1, N});
+  at::Tensor residual_;
+  if (residual.has_value()) {
+    TORCH_CHECK(
+        residual->sizes() == pre_act.sizes(),
+        "ipex_linear_epilogue: the residual must have the output shape");
+    residual_ =
+        residual->to(pre_act.scalar_type()).contiguous().view({-1, N});
+  }
+  // the output overwrites the linear output when it is not saved
+  auto output = save_for_backward ? at::empty_like(pre_act) : pre_act;
+  auto output_ = output.view({-1, N});
+  bool dropout = train && p > 0;
+  at::Tensor mask;
+  uint64_t seed = 0;
+  if (dropout) {
+    mask = at::empty({pre_act_.size(0), (N + 7) / 8}, at::kByte);
+    auto gen = at::get_generator_or_default<at::CPUGeneratorImpl>(
+        c10::nullopt, at::detail::getDefaultCPUGenerator());
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    seed = gen->random64();
+  }
+  /*
+  pointer to linear_epilogue_kernel_impl(
+      pre_act_, residual_, output_, mask, activation, p, seed);
+  */
+  linear_epilogue_kernel_stub(
+      kCPU, pre_act_, residual_, output_, mask, activation, p, seed);
+  if (!save_for_backward) {
+    return std::make_tuple(output, at::Tensor(), at::Tensor());
+  }
+  return std::make_tuple(output, pre_act, mask);
+}
+
+at::Tensor IPEXLinearEpilogueOp::forward(
+    torch::autograd::AutogradContext* ctx,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features) {
+  RECORD_FUNCTION(
+      "IPEXLinearEpilogueOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+  at::AutoDispatchBelowADInplaceOrView g;
+  ctx->saved_data["op_context"] = op_context;
+  ctx->saved_data["input_requires_grad"] = input.requires_grad();
+  ctx->saved_data["weight_requires_grad"] = weight.requires_grad();
+  ctx->saved_data["bias_requires_grad"] =
+      bias.has_value() && bias.value().requires_grad();
+  ctx->saved_data["residual_requires_grad"] =
+      residual.has_value() && residual.value().requires_grad();
+  ctx->saved_data["activation"] = activation;
+  ctx->saved_data["p"] = p;
+  at::Tensor output, pre_act, mask;
+  std::tie(output, pre_act, mask) =
+      _forward(input, residual, activation, p, train, op_context, true);
+  ctx->save_for_backward({input, pre_act, mask});
+  return output;
+}
+
+torch::autograd::tensor_list IPEXLinearEpilogueOp::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::tensor_list grad_outputs) {
+  RECORD_FUNCTION(
+      "IPEXLinearEpilogueOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+  auto saved = ctx->get_saved_variables();
+  at::Tensor input = saved[0];
+  at::Tensor pre_act = saved[1];
+  at::Tensor mask = saved[2];
+  auto op_context = ctx->saved_data["op_context"].toTensor();
+  std::array<bool, 3> output_mask;
+  output_mask[0] = ctx->saved_data["input_requires_grad"].toBool();
+  output_mask[1] = ctx->saved_data["weight_requires_grad"].toBool();
+  output_mask[2] = ctx->saved_data["bias_requires_grad"].toBool();
+  int64_t activation = ctx->saved_data["activation"].toInt();
+  double p = ctx->saved_data["p"].toDouble();
+
+  int64_t N = pre_act.size(-1);
+  auto grad_output = grad_outputs[0].contiguous();
+  /*
+  pointer to linear_epilogue_backward_kernel_impl(
+      grad_output, pre_act, mask, activation, p);
+  */
+  auto grad_pre_act = linear_epilogue_backward_kernel_stub(
+      kCPU,
+      grad_output.view({-1, N}),
+      pre_act.view({-1, N}),
+      mask,
+      activation,
+      p);
+
+  at::Tensor grad_input, grad_weight, grad_bias;
+  std::tie(grad_input, grad_weight, grad_bias) =
+      get_linear_op_context(op_context)->run_backward(
+          input, grad_pre_act.view(pre_act.sizes()), output_mask);
+  at::Tensor grad_residual =
+      ctx->saved_data["residual_requires_grad"].toBool() ? grad_outputs[0]
+                                                         : at::Tensor();
+  // must have save nums of output with inputs args
+  return {
+      grad_input,
+      grad_weight,
+      grad_bias,
+      grad_residual,
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor()};
+}
+
+at::Tensor linear_epilogue_forward(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features) {
+  at::AutoDispatchBelowADInplaceOrView g;
+  return std::get<0>(IPEXLinearEpilogueOp::_forward(
+      input, residual, activation, p, train, op_context, false));
+}
+
+at::Tensor ipex_linear_epilogue(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features) {
+  if (at::GradMode::is_enabled()) {
+    return IPEXLinearEpilogueOp::apply(
+        input,
+        weight,
+        bias,
+        residual,
+        activation,
+        p,
+        train,
+        op_context,
+        out_features);
+  }
+  return linear_epilogue_forward(
+      input,
+      weight,
+      bias,
+      residual,
+      activation,
+      p,
+      train,
+      op_context,
+      out_features);
+}
+
+at::Tensor linear_epilogue_forward_meta(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features) {
+  TORCH_CHECK(
+      out_features.has_value(),
+      "out_features must have value for linear_epilogue_forward_meta");
+  auto input_size = input.sym_sizes();
+  c10::SymDimVector output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(out_features.value());
+  return at::empty_symint(output_size, input.options());
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace torch_ipex {
+namespace autocast {
+
+at::Tensor ipex_linear_epilogue(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::ipex_linear_epilogue", "")
+          .typed<decltype(ipex_linear_epilogue)>();
+  auto target_type = get_autocast_dtype();
+  TORCH_CHECK(
+      weight.scalar_type() == at::kBFloat16 ||
+          weight.scalar_type() == at::kFloat,
+      "ipex_linear_epilogue only support bfloat16 and float autocast dtype");
+  // should not autocast weight/bias here since we are using it from op_context,
+  // The cast for weight/bias should be only handled in ipex.optimize
+  return op.call(
+      cpu_cached_cast(target_type, input),
+      weight,
+      bias,
+      residual,
+      activation,
+      p,
+      train,
+      op_context,
+      out_features);
+}
+
+} // namespace autocast
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "ipex_linear_epilogue(Tensor input, Tensor weight, Tensor? bias, "
+      "Tensor? residual, int activation, float p, bool train, "
+      "Tensor W_prepack, int? out_features) -> Tensor");
+  m.impl(
+      "ipex_linear_epilogue",
+      c10::DispatchKey::Autograd,
+      torch_ipex::cpu::ipex_linear_epilogue);
+  m.impl(
+      "ipex_linear_epilogue",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::ipex_linear_epilogue);
+  m.impl(
+      "ipex_linear_epilogue",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::linear_epilogue_forward);
+  m.impl(
+      "ipex_linear_epilogue",
+      c10::DispatchKey::Meta,
+      torch_ipex::cpu::linear_epilogue_forward_meta);
+}
+
+} // namespace
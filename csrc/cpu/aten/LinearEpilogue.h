@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/csrc/autograd/custom_function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+enum LinearEpilogueAct { NoAct = 0, GeLU = 1, GeLUTanh = 2, SiLU = 3 };
+
+/**
+ * output = dropout(act(linear(input)), p) + residual, the MLP block of
+ * transformers, with the linear of a prepacked op context. The epilogue runs
+ * in one pass over the linear output and, in training, only saves the linear
+ * output and a dropout bitmask of one bit per element for the fused backward,
+ * instead of the activation, the float mask and the dropout output.
+ * */
+at::Tensor ipex_linear_epilogue(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    const c10::optional<at::Tensor>& residual,
+    const int64_t activation,
+    const double p,
+    const bool train,
+    const at::Tensor& op_context,
+    const c10::optional<int64_t> out_features);
+
+class IPEXLinearEpilogueOp
+    : public torch::autograd::Function<IPEXLinearEpilogueOp> {
+ public:
+  // returns the output, the linear output and the dropout bitmask, the last
+  // two only when save_for_backward
+  static std::tuple<at::Tensor, at::Tensor, at::Tensor> _forward(
+      const at::Tensor& input,
+      const c10::optional<at::Tensor>& residual,
+      const int64_t activation,
+      const double p,
+      const bool train,
+      const at::Tensor& op_context,
+      const bool save_for_backward);
+
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& input,
+      const at::Tensor& weight,
+      const c10::optional<at::Tensor>& bias,
+      const c10::optional<at::Tensor>& residual,
+      const int64_t activation,
+      const double p,
+      const bool train,
+      const at::Tensor& op_context,
+      const c10::optional<int64_t> out_features);
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs);
+};
+
+namespace {
+
+// output[M, N] = dropout(act(pre_act[M, N])) + residual, mask[M, ceil(N / 8)]
+// gets the kept elements if defined, drawn from seed
+void linear_epilogue_kernel_impl(
+    const at::Tensor& pre_act,
+    const at::Tensor& residual,
+    at::Tensor& output,
+    at::Tensor& mask,
+    int64_t activation,
+    float p,
+    uint64_t seed);
+
+// Returns the gradient of the linear output from the one of the output
+at::Tensor linear_epilogue_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& pre_act,
+    const at::Tensor& mask,
+    int64_t activation,
+    float p);
+
+// output[M, N] = act(pre_act[M, :N]) * pre_act[M, N:], the gate of the gated
+// MLPs (SwiGLU, GeGLU) computed on the output of their concatenated linears
+void linear_gate_kernel_impl(
+    const at::Tensor& pre_act,
+    at::Tensor& output,
+    int64_t activation);
+
+} // namespace
+
+using linear_epilogue_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    int64_t,
+    float,
+    uint64_t);
+DECLARE_DISPATCH(linear_epilogue_kernel_fn, linear_epilogue_kernel_stub);
+
+using linear_epilogue_backward_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    float);
+DECLARE_DISPATCH(
+    linear_epilogue_backward_kernel_fn,
+    linear_epilogue_backward_kernel_stub);
+
+using linear_gate_kernel_fn =
+    void (*)(const at::Tensor&, at::Tensor&, int64_t);
+DECLARE_DISPATCH(linear_gate_kernel_fn, linear_gate_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,150 @@
+#include "LinearWoq.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(woq_linear_kernel_stub);
+
+namespace {
+
+// [N, C] -> [Np / block_n, C, block_n] with N zero padded to Np
+at::Tensor pack_by_block_n(const at::Tensor& t) {
+  int64_t N = t.size(0);
+  int64_t Np = (N + woq_block_n - 1) / woq_block_n * woq_block_n;
+  auto padded = Np == N ? t : at::constant_pad_nd(t, {0, 0, 0, Np - N}, 0);
+  return padded.view({Np / woq_block_n, woq_block_n, t.size(1)})
+      .permute({0, 2, 1})
+      .contiguous();
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> woq_linear_quantize_weight(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size) {
+  TORCH_CHECK(
+      bits == 4 || bits == 8, "weight-only quantization supports 4 or 8 bits");
+  TORCH_CHECK(weight.dim() == 2, "expect the 2-D weight of a linear");
+  int64_t N = weight.size(0);
+  int64_t K = weight.size(1);
+  if (group_size <= 0) {
+    group_size = K;
+  }
+  TORCH_CHECK(
+      K % group_size == 0,
+      "weight-only quantization expects in_features to be a multiple of group_size");
+  auto w = weight.to(at::kFloat).contiguous().view({N, K / group_size, -1});
+  float qmax = (1 << bits) - 1;
+  // keep 0 representable
+  auto w_min = at::clamp_max(std::get<0>(w.min(-1)), 0);
+  auto w_max = at::clamp_min(std::get<0>(w.max(-1)), 0);
+  auto scales = (w_max - w_min) / qmax;
+  scales.masked_fill_(scales == 0, 1.f);
+  auto zero_points = at::clamp(at::round(-w_min / scales), 0, qmax);
+  auto qweight =
+      at::clamp(at::round(w / scales.unsqueeze(-1)) + zero_points.unsqueeze(-1),
+                0,
+                qmax)
+          .to(at::kByte)
+          .view({N, K});
+  return std::make_tuple(qweight, scales, zero_points);
+}
+
+at::Tensor woq_linear_pack_weight(const at::Tensor& qweight, int64_t bits) {
+  TORCH_CHECK(
+      qweight.dim() == 2 && qweight.scalar_type() == at::kByte,
+      "expect the uint8 quantized weight of [out_features, in_features]");
+  auto packed = pack_by_block_n(qweight);
+  if (bits == 8) {
+    return packed;
+  }
+  TORCH_CHECK(bits == 4, "weight-only quantization supports 4 or 8 bits");
+  TORCH_CHECK(
+      qweight.max().item<uint8_t>() < 16, "expect 4 bits quantized weight");
+  auto low = packed.narrow(-1, 0, woq_block_n / 2);
+  auto high = packed.narrow(-1, woq_block_n / 2, woq_block_n / 2);
+  return at::bitwise_or(low, at::bitwise_left_shift(high, 4)).contiguous();
+}
+
+at::Tensor woq_linear_unpack_weight(
+    const at::Tensor& packed_weight,
+    int64_t bits,
+    int64_t out_features) {
+  auto packed = packed_weight;
+  if (bits == 4) {
+    auto low = at::bitwise_and(packed_weight, 0xF);
+    auto high = at::bitwise_right_shift(packed_weight, 4);
+    packed = at::cat({low, high}, -1);
+  }
+  int64_t K = packed.size(1);
+  return packed.permute({0, 2, 1})
+      .reshape({-1, K})
+      .narrow(0, 0, out_features)
+      .contiguous();
+}
+
+std::tuple<at::Tensor, at::Tensor> woq_linear_pack_group_params(
+    const at::Tensor& scales,
+    const at::Tensor& zero_points) {
+  auto scales_ = scales.to(at::kFloat);
+  auto zero_biases = -zero_points.to(at::kFloat) * scales_;
+  return std::make_tuple(
+      pack_by_block_n(scales_), pack_by_block_n(zero_biases));
+}
+
+at::Tensor woq_linear_kernel(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& packed_scales,
+    const at::Tensor& packed_zero_biases,
+    const at::Tensor& bias,
+    int64_t bits,
+    int64_t group_size,
+    int64_t out_features) {
+  auto input_size = input.sizes();
+  std::vector<int64_t> output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(out_features);
+  auto output = at::empty(output_size, input.options());
+  /*
+  pointer to woq_linear_kernel_impl(
+      input, packed_weight, packed_scales, packed_zero_biases, bias, bits,
+      group_size, output);
+  */
+  woq_linear_kernel_stub(
+      kCPU,
+      input.contiguous(),
+      packed_weight,
+      packed_scales,
+      packed_zero_biases,
+      bias,
+      bits,
+      group_size,
+      output);
+  return output;
+}
+
+at::Tensor woq_linear_forward(
+    const at::Tensor& input,
+    const at::Tensor& op_context) {
+  RECORD_FUNCTION("torch_ipex::ipex_woq_linear", c10::ArrayRef<c10::IValue>({}));
+  return reinterpret_cast<IpexWoqLinearOpContext*>(
+             op_context.data_ptr<int64_t>()[0])
+      ->run(input);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def("ipex_woq_linear(Tensor input, Tensor W_prepack) -> Tensor");
+  m.impl(
+      "ipex_woq_linear",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::woq_linear_forward);
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <vector>
+#include "cpu/kernels/OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+// Weight-only quantized linear: weight of [N, K] is quantized to "bits"
+// (4 or 8) unsigned ints with one fp32 scale and zero point per group of
+// "group_size" input channels, w = (q - zero_point) * scale. The activation
+// stays in fp32/bf16 and the weight is dequantized in the GEMM kernel.
+//
+// Packed weight layout, N padded to a multiple of woq_block_n:
+//   8 bits: uint8 [N / block_n, K, block_n]
+//   4 bits: uint8 [N / block_n, K, block_n / 2], byte j of a row holds
+//     column j in the low nibble and column j + block_n / 2 in the high one.
+// The group params are packed to fp32 [N / block_n, num_groups, block_n]
+// scales and zero biases (-zero_point * scale).
+const int64_t woq_block_n = 16;
+
+// Returns the (quantized uint8 weight, scales, zero points) of an fp32
+// weight, asymmetric per group, group_size <= 0 means per output channel.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> woq_linear_quantize_weight(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor woq_linear_pack_weight(const at::Tensor& qweight, int64_t bits);
+
+at::Tensor woq_linear_unpack_weight(
+    const at::Tensor& packed_weight,
+    int64_t bits,
+    int64_t out_features);
+
+std::tuple<at::Tensor, at::Tensor> woq_linear_pack_group_params(
+    const at::Tensor& scales,
+    const at::Tensor& zero_points);
+
+at::Tensor woq_linear_kernel(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& packed_scales,
+    const at::Tensor& packed_zero_biases,
+    const at::Tensor& bias,
+    int64_t bits,
+    int64_t group_size,
+    int64_t out_features);
+
+at::Tensor woq_linear_forward(
+    const at::Tensor& input,
+    const at::Tensor& op_context);
+
+namespace {
+
+void woq_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& packed_scales,
+    const at::Tensor& packed_zero_biases,
+    const at::Tensor& bias,
+    int64_t bits,
+    int64_t group_size,
+    at::Tensor& output);
+
+} // namespace
+
+using woq_linear_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    at::Tensor&);
+DECLARE_DISPATCH(woq_linear_kernel_fn, woq_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
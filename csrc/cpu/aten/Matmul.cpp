@@ -4,6 +4,7 @@
 #include <ideep.hpp>
 #include <torch/all.h>
 #include <torch/csrc/autograd/functions/utils.h>
+#include "SmallBmm.h"
 #include "ideep/IDeepConversions.h"
 #include "utils/fpmath_mode.h"
 #include "utils/library.h"
@@ -192,6 +193,10 @@ at::Tensor matmul_onednn(const at::Tensor& self, const at::Tensor& mat2) {
   }
   output_size[dim - 1] = mat2.size(dim - 1);
   auto output = at::empty(output_size, self.options());
+  if (small_bmm(tensor1_, tensor2_, output, 1.f)) {
+    handle_grad(self, mat2, output);
+    return output;
+  }
   ideep::tensor mkldnn_output = itensor_view_from_dense(output);
 
   ideep::matmul_forward::compute(
@@ -234,6 +239,9 @@ at::Tensor& matmul_onednn(
           output_size.begin() + 1)) {
     at::native::resize_output(out, output_size);
   }
+  if (out.is_contiguous() && small_bmm(tensor1_, tensor2_, out, 1.f)) {
+    return out;
+  }
   ideep::tensor mkldnn_output = itensor_view_from_dense(out);
 
   ideep::matmul_forward::compute(
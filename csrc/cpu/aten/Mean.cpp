@@ -3,10 +3,12 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec/vec.h>
+#include <ATen/native/ReduceOpsUtils.h>
 #include <ATen/native/cpu/utils.h>
 #include <ATen/record_function.h>
 
 #include "Mean.h"
+#include "Reduce.h"
 #include "utils/library.h"
 
 namespace torch_ipex {
@@ -17,6 +19,20 @@ at::Tensor mean_dim_impl(
     c10::OptionalIntArrayRef dim_opt,
     bool keepdim,
     c10::optional<c10::ScalarType> dtype) {
+  // the sums are scaled as they are stored, and a bfloat16 mean is rounded
+  // once
+  at::DimVector dims = at::native::make_dim_vector(dim_opt, input.dim());
+  at::maybe_wrap_dims(dims, input.dim());
+  auto output = reduce_with_engine(
+      input,
+      dims,
+      keepdim,
+      dtype.value_or(input.scalar_type()),
+      ReducePostOp::Mean);
+  if (output.defined()) {
+    return output;
+  }
+
   int64_t dim_prod = 1;
   if (dim_opt.has_value()) {
     auto dim = dim_opt.value();
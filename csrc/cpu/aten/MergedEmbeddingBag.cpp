@@ -3,17 +3,33 @@
 #include <ATen/Tensor.h>
 #include <torch/all.h>
 #include "autocast/autocast_mode.h"
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(merged_embeddingbag_forward_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_dedup_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_hot_row_cache_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_int8_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_mixed_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_interaction_forward_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_qinteraction_forward_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_forward_compositional_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_linearize_cpu_kernel_stub);
 
 std::vector<Tensor> merged_embeddingbag_forward_cpu(
     const Tensor& indices,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
     const std::vector<int64_t> pooling_modes) {
+  // the rows gathered and summed by each index, assuming tables of one dim
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::merged_embeddingbag_forward",
+      utils::nbytes(indices) + utils::nbytes(offsets) +
+          indices.numel() * weights[0].size(1) * weights[0].element_size(),
+      indices.numel() * weights[0].size(1));
   /*
   pointer to merged_embeddingbag_forward_cpu_kernel_impl(
       indices, offsets, weights, pooling_modes);
@@ -22,6 +38,165 @@ std::vector<Tensor> merged_embeddingbag_forward_cpu(
       kCPU, indices, offsets, weights, pooling_modes);
 }
 
+std::tuple<std::vector<Tensor>, std::vector<Tensor>>
+merged_embeddingbag_forward_dedup_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets) {
+  /*
+  pointer to merged_embeddingbag_forward_dedup_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, indices_with_row_offset,
+      row_offsets);
+  */
+  return merged_embeddingbag_forward_dedup_cpu_kernel_stub(
+      kCPU,
+      indices,
+      offsets,
+      weights,
+      pooling_modes,
+      indices_with_row_offset,
+      row_offsets);
+}
+
+std::vector<Tensor> merged_embeddingbag_forward_with_hot_row_cache_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& cache_rows,
+    const std::vector<Tensor>& cache_hash_index) {
+  /*
+  pointer to merged_embeddingbag_forward_hot_row_cache_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, cache_rows, cache_hash_index);
+  */
+  return merged_embeddingbag_forward_hot_row_cache_cpu_kernel_stub(
+      kCPU,
+      indices,
+      offsets,
+      weights,
+      pooling_modes,
+      cache_rows,
+      cache_hash_index);
+}
+
+std::vector<Tensor> merged_embeddingbag_forward_rowwise_quantized_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates) {
+  /*
+  pointer to merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, bit_rates);
+  */
+  return merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_stub(
+      kCPU, indices, offsets, weights, pooling_modes, bit_rates);
+}
+
+std::vector<Tensor> merged_embeddingbag_forward_int8_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<double> o_scales) {
+  /*
+  pointer to merged_embeddingbag_forward_int8_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, o_scales);
+  */
+  return merged_embeddingbag_forward_int8_cpu_kernel_stub(
+      kCPU, indices, offsets, weights, pooling_modes, o_scales);
+}
+
+std::vector<Tensor> merged_embeddingbag_forward_mixed_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates) {
+  /*
+  pointer to merged_embeddingbag_forward_mixed_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, bit_rates);
+  */
+  return merged_embeddingbag_forward_mixed_cpu_kernel_stub(
+      kCPU, indices, offsets, weights, pooling_modes, bit_rates);
+}
+
+Tensor merged_embeddingbag_interaction_forward_cpu(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes) {
+  /*
+  pointer to merged_embeddingbag_interaction_forward_cpu_kernel_impl(
+      dense, indices, offsets, weights, pooling_modes);
+  */
+  return merged_embeddingbag_interaction_forward_cpu_kernel_stub(
+      kCPU, dense, indices, offsets, weights, pooling_modes);
+}
+
+Tensor merged_embeddingbag_qinteraction_forward_cpu(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    double o_scale) {
+  /*
+  pointer to merged_embeddingbag_qinteraction_forward_cpu_kernel_impl(
+      dense, indices, offsets, weights, o_scale);
+  */
+  return merged_embeddingbag_qinteraction_forward_cpu_kernel_stub(
+      kCPU, dense, indices, offsets, weights, o_scale);
+}
+
+std::vector<Tensor> merged_embeddingbag_forward_compositional_cpu(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine) {
+  /*
+  pointer to merged_embeddingbag_forward_compositional_cpu_kernel_impl(
+      indices, offsets, weights, pooling_modes, num_components, mode, combine);
+  */
+  return merged_embeddingbag_forward_compositional_cpu_kernel_stub(
+      kCPU,
+      indices,
+      offsets,
+      weights,
+      pooling_modes,
+      num_components,
+      mode,
+      combine);
+}
+
+// The merged indices, offsets and indices with row offsets of the inputs of
+// the tables, e.g. preprocessed ahead of the step by the data loader
+std::tuple<Tensor, Tensor, Tensor> merged_embeddingbag_linearize_cpu(
+    const std::vector<Tensor>& indices,
+    const c10::List<c10::optional<Tensor>>& offsets,
+    const c10::List<bool>& include_last_offsets,
+    const Tensor& row_offsets) {
+  std::vector<Tensor> offsets_;
+  for (size_t i = 0; i < offsets.size(); i++) {
+    offsets_.emplace_back(
+        offsets.get(i).has_value() ? offsets.get(i).value() : Tensor());
+  }
+  std::vector<bool> include_last_offsets_(
+      include_last_offsets.begin(), include_last_offsets.end());
+  /*
+  pointer to merged_embeddingbag_linearize_cpu_kernel_impl(
+      indices, offsets_, include_last_offsets_, row_offsets);
+  */
+  return merged_embeddingbag_linearize_cpu_kernel_stub(
+      kCPU, indices, offsets_, include_last_offsets_, row_offsets);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -45,6 +220,32 @@ std::vector<Tensor> merged_embeddingbag_forward(
   return op.call(indices, offsets, casted_weights, pooling_modes);
 }
 
+std::tuple<std::vector<Tensor>, std::vector<Tensor>>
+merged_embeddingbag_forward_dedup(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::merged_embeddingbag_forward_dedup", "")
+          .typed<decltype(merged_embeddingbag_forward_dedup)>();
+  bool cast_to_bfloat16 =
+      !at::GradMode::is_enabled() && at::kBFloat16 == get_autocast_dtype();
+  auto casted_weights =
+      cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, weights) : weights;
+  return op.call(
+      indices,
+      offsets,
+      casted_weights,
+      pooling_modes,
+      indices_with_row_offset,
+      row_offsets);
+}
+
 } // namespace autocast
 } // namespace torch_ipex
 
@@ -61,6 +262,64 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "merged_embeddingbag_forward",
       c10::DispatchKey::AutocastCPU,
       torch_ipex::autocast::merged_embeddingbag_forward);
+  m.def(
+      "merged_embeddingbag_forward_dedup(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, Tensor indices_with_row_offset, Tensor row_offsets) -> (Tensor[], Tensor[])");
+  m.impl(
+      "merged_embeddingbag_forward_dedup",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_dedup_cpu);
+  m.impl(
+      "merged_embeddingbag_forward_dedup",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::merged_embeddingbag_forward_dedup);
+  m.def(
+      "merged_embeddingbag_forward_with_hot_row_cache(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, Tensor[] cache_rows, Tensor[] cache_hash_index) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_forward_with_hot_row_cache",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_with_hot_row_cache_cpu);
+  m.def(
+      "merged_embeddingbag_forward_mixed(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, int[] bit_rates) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_forward_mixed",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_mixed_cpu);
+  m.def(
+      "merged_embeddingbag_forward_rowwise_quantized(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, int[] bit_rates) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_forward_rowwise_quantized",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_rowwise_quantized_cpu);
+  m.def(
+      "merged_embeddingbag_forward_int8(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, float[] o_scales) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_forward_int8",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_int8_cpu);
+  m.def(
+      "merged_embeddingbag_interaction_forward(Tensor dense, Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes) -> Tensor");
+  m.impl(
+      "merged_embeddingbag_interaction_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_interaction_forward_cpu);
+  m.def(
+      "merged_embeddingbag_forward_compositional(Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, int[] num_components, int mode, int combine) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_forward_compositional",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_forward_compositional_cpu);
+  m.def(
+      "merged_embeddingbag_linearize(Tensor[] indices, Tensor?[] offsets, bool[] include_last_offsets, Tensor row_offsets) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "merged_embeddingbag_linearize",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_linearize_cpu);
+  m.def(
+      "merged_embeddingbag_qinteraction_forward(Tensor dense, Tensor indices, Tensor offsets, Tensor[] weight, float o_scale) -> Tensor");
+  m.impl(
+      "merged_embeddingbag_qinteraction_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_qinteraction_forward_cpu);
 }
 
 } // namespace
@@ -21,6 +21,85 @@ struct SGDArgs {
   float lr;
 };
 
+struct AdagradArgs {
+  AdagradArgs(
+      const std::vector<Tensor>& bf16_trail_,
+      const std::vector<Tensor>& hessian_,
+      float eps_,
+      float weight_decay_,
+      float lr_)
+      : bf16_trail(bf16_trail_),
+        hessian(hessian_),
+        eps(eps_),
+        weight_decay(weight_decay_),
+        lr(lr_) {}
+
+  std::vector<Tensor> bf16_trail;
+  // accumulated squared grads, same shape as the table
+  std::vector<Tensor> hessian;
+  float eps;
+  float weight_decay;
+  float lr;
+};
+
+struct RowWiseAdagradArgs {
+  RowWiseAdagradArgs(
+      const std::vector<Tensor>& bf16_trail_,
+      const std::vector<Tensor>& hessian_,
+      float eps_,
+      float weight_decay_,
+      float lr_)
+      : bf16_trail(bf16_trail_),
+        hessian(hessian_),
+        eps(eps_),
+        weight_decay(weight_decay_),
+        lr(lr_) {}
+
+  std::vector<Tensor> bf16_trail;
+  // accumulated mean of squared grads, one value per table row
+  std::vector<Tensor> hessian;
+  float eps;
+  float weight_decay;
+  float lr;
+};
+
+struct AdamArgs {
+  AdamArgs(
+      const std::vector<Tensor>& bf16_trail_,
+      const std::vector<Tensor>& exp_avg_,
+      const std::vector<Tensor>& exp_avg_sq_,
+      double step_,
+      float beta1_,
+      float beta2_,
+      float eps_,
+      float weight_decay_,
+      float lr_,
+      bool lamb_)
+      : bf16_trail(bf16_trail_),
+        exp_avg(exp_avg_),
+        exp_avg_sq(exp_avg_sq_),
+        step(step_),
+        beta1(beta1_),
+        beta2(beta2_),
+        eps(eps_),
+        weight_decay(weight_decay_),
+        lr(lr_),
+        lamb(lamb_) {}
+
+  std::vector<Tensor> bf16_trail;
+  // the moments, same shape as the table, only the looked up rows are updated
+  std::vector<Tensor> exp_avg;
+  std::vector<Tensor> exp_avg_sq;
+  double step;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  float lr;
+  // LAMB scales the Adam step of a row by the trust ratio of the row
+  bool lamb;
+};
+
 template <typename T, typename optimizer_args_t>
 class AccGradUpdate {};
 
@@ -38,19 +117,141 @@ class AccGradUpdate<T, SGDArgs> {
       const SGDArgs& args);
 };
 
+template <typename T>
+class AccGradUpdate<T, AdagradArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      const AdagradArgs& args);
+};
+
+template <typename T>
+class AccGradUpdate<T, RowWiseAdagradArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      const RowWiseAdagradArgs& args);
+};
+
+template <typename T>
+class AccGradUpdate<T, AdamArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      const AdamArgs& args);
+};
+
 std::vector<Tensor> merged_embeddingbag_forward_cpu_kernel_impl(
     const Tensor& indices,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
     const std::vector<int64_t> pooling_modes);
 
+std::tuple<std::vector<Tensor>, std::vector<Tensor>>
+merged_embeddingbag_forward_dedup_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets);
+
+std::vector<Tensor> merged_embeddingbag_forward_hot_row_cache_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& cache_rows,
+    const std::vector<Tensor>& cache_hash_index);
+
+std::vector<Tensor>
+merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates);
+
+std::vector<Tensor> merged_embeddingbag_forward_int8_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<double> o_scales);
+
+std::vector<Tensor> merged_embeddingbag_forward_mixed_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates);
+
+std::vector<Tensor> merged_embeddingbag_forward_compositional_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine);
+
+std::tuple<Tensor, Tensor, Tensor>
+merged_embeddingbag_linearize_cpu_kernel_impl(
+    const std::vector<Tensor>& indices,
+    const std::vector<Tensor>& offsets,
+    const std::vector<bool>& include_last_offsets,
+    const Tensor& row_offsets);
+
+Tensor merged_embeddingbag_interaction_forward_cpu_kernel_impl(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes);
+
+Tensor merged_embeddingbag_qinteraction_forward_cpu_kernel_impl(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    double o_scale);
+
 std::vector<Tensor> merged_embeddingbag_backward_cpu_kernel_impl(
     const std::vector<Tensor>& grad_outs_,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
     const Tensor& indices_with_row_offset,
     const Tensor& row_offsets,
-    const std::vector<int64_t> pooling_modes);
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& dedup_mapping);
+
+std::vector<Tensor> merged_embeddingbag_backward_compositional_cpu_kernel_impl(
+    const std::vector<Tensor>& grad_outs_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine);
 
 void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     const std::vector<Tensor>& grads_y_,
@@ -62,7 +263,58 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     std::vector<int64_t> pooling_modes,
     const std::vector<Tensor>& bf16_trail,
     double weight_decay,
-    double lr);
+    double lr,
+    const std::vector<Tensor>& dedup_mapping);
+
+Tensor interaction_backward_merged_embeddingbag_sgd_cpu_kernel_impl(
+    const Tensor& grad_out,
+    const std::vector<Tensor>& input,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    double weight_decay,
+    double lr,
+    const std::vector<Tensor>& dedup_mapping);
+
+void merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& hessian,
+    const std::vector<Tensor>& bf16_trail,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool rowwise,
+    const std::vector<Tensor>& dedup_mapping);
+
+void merged_embeddingbag_backward_adam_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    const std::vector<Tensor>& bf16_trail,
+    double step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool lamb,
+    const std::vector<Tensor>& dedup_mapping);
 
 } // namespace
 
@@ -75,17 +327,138 @@ DECLARE_DISPATCH(
     merged_embeddingbag_forward_cpu_kernel_fn,
     merged_embeddingbag_forward_cpu_kernel_stub);
 
+using merged_embeddingbag_forward_dedup_cpu_kernel_fn =
+    std::tuple<std::vector<Tensor>, std::vector<Tensor>> (*)(
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const Tensor&,
+        const Tensor&);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_dedup_cpu_kernel_fn,
+    merged_embeddingbag_forward_dedup_cpu_kernel_stub);
+
+using merged_embeddingbag_forward_hot_row_cache_cpu_kernel_fn =
+    std::vector<Tensor> (*)(
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const std::vector<Tensor>&,
+        const std::vector<Tensor>&);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_hot_row_cache_cpu_kernel_fn,
+    merged_embeddingbag_forward_hot_row_cache_cpu_kernel_stub);
+
+using merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_fn =
+    std::vector<Tensor> (*)(
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const std::vector<int64_t>);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_fn,
+    merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_stub);
+
+using merged_embeddingbag_forward_int8_cpu_kernel_fn = std::vector<Tensor> (*)(
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const std::vector<int64_t>,
+    const std::vector<double>);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_int8_cpu_kernel_fn,
+    merged_embeddingbag_forward_int8_cpu_kernel_stub);
+
+using merged_embeddingbag_forward_mixed_cpu_kernel_fn =
+    std::vector<Tensor> (*)(
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const std::vector<int64_t>);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_mixed_cpu_kernel_fn,
+    merged_embeddingbag_forward_mixed_cpu_kernel_stub);
+
+// Lookup over compositional tables (see CompositionalMode): "weights" holds
+// the component tables of all the logical tables, num_components[t] of them
+// for table t, and the indices are the indices of the logical tables. The
+// rows of the components are combined inside the pooling loop, so the rows of
+// the logical tables are never materialized.
+using merged_embeddingbag_forward_compositional_cpu_kernel_fn =
+    std::vector<Tensor> (*)(
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const std::vector<int64_t>,
+        int64_t,
+        int64_t);
+DECLARE_DISPATCH(
+    merged_embeddingbag_forward_compositional_cpu_kernel_fn,
+    merged_embeddingbag_forward_compositional_cpu_kernel_stub);
+
+using merged_embeddingbag_linearize_cpu_kernel_fn =
+    std::tuple<Tensor, Tensor, Tensor> (*)(
+        const std::vector<Tensor>&,
+        const std::vector<Tensor>&,
+        const std::vector<bool>&,
+        const Tensor&);
+DECLARE_DISPATCH(
+    merged_embeddingbag_linearize_cpu_kernel_fn,
+    merged_embeddingbag_linearize_cpu_kernel_stub);
+
+using merged_embeddingbag_interaction_forward_cpu_kernel_fn = Tensor (*)(
+    const Tensor&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const std::vector<int64_t>);
+DECLARE_DISPATCH(
+    merged_embeddingbag_interaction_forward_cpu_kernel_fn,
+    merged_embeddingbag_interaction_forward_cpu_kernel_stub);
+
+using merged_embeddingbag_qinteraction_forward_cpu_kernel_fn = Tensor (*)(
+    const Tensor&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    double);
+DECLARE_DISPATCH(
+    merged_embeddingbag_qinteraction_forward_cpu_kernel_fn,
+    merged_embeddingbag_qinteraction_forward_cpu_kernel_stub);
+
 using merged_embeddingbag_backward_cpu_kernel_fn = std::vector<Tensor> (*)(
     const std::vector<Tensor>&,
     const Tensor&,
     const std::vector<Tensor>&,
     const Tensor&,
     const Tensor&,
-    const std::vector<int64_t>);
+    const std::vector<int64_t>,
+    const std::vector<Tensor>&);
 DECLARE_DISPATCH(
     merged_embeddingbag_backward_cpu_kernel_fn,
     merged_embeddingbag_backward_cpu_kernel_stub);
 
+// The grads of the component tables of the compositional lookup, accumulated
+// over a CSC of the component rows read by the indices
+using merged_embeddingbag_backward_compositional_cpu_kernel_fn =
+    std::vector<Tensor> (*)(
+        const std::vector<Tensor>&,
+        const Tensor&,
+        const Tensor&,
+        const std::vector<Tensor>&,
+        const std::vector<int64_t>,
+        const std::vector<int64_t>,
+        int64_t,
+        int64_t);
+DECLARE_DISPATCH(
+    merged_embeddingbag_backward_compositional_cpu_kernel_fn,
+    merged_embeddingbag_backward_compositional_cpu_kernel_stub);
+
 using merged_embeddingbag_backward_sgd_cpu_kernel_fn = void (*)(
     const std::vector<Tensor>&,
     const Tensor&,
@@ -96,10 +469,72 @@ using merged_embeddingbag_backward_sgd_cpu_kernel_fn = void (*)(
     std::vector<int64_t>,
     const std::vector<Tensor>&,
     double,
-    double);
+    double,
+    const std::vector<Tensor>&);
 DECLARE_DISPATCH(
     merged_embeddingbag_backward_sgd_cpu_kernel_fn,
     merged_embeddingbag_backward_sgd_cpu_kernel_stub);
 
+// The backward of interaction_forward([dense] + the outputs of the tables)
+// fused with the SGD update of the tables, returns the grad of dense
+using interaction_backward_merged_embeddingbag_sgd_cpu_kernel_fn = Tensor (*)(
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    std::vector<int64_t>,
+    const std::vector<Tensor>&,
+    double,
+    double,
+    const std::vector<Tensor>&);
+DECLARE_DISPATCH(
+    interaction_backward_merged_embeddingbag_sgd_cpu_kernel_fn,
+    interaction_backward_merged_embeddingbag_sgd_cpu_kernel_stub);
+
+using merged_embeddingbag_backward_adagrad_cpu_kernel_fn = void (*)(
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    std::vector<int64_t>,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    double,
+    double,
+    double,
+    bool,
+    const std::vector<Tensor>&);
+DECLARE_DISPATCH(
+    merged_embeddingbag_backward_adagrad_cpu_kernel_fn,
+    merged_embeddingbag_backward_adagrad_cpu_kernel_stub);
+
+using merged_embeddingbag_backward_adam_cpu_kernel_fn = void (*)(
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    std::vector<int64_t>,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    double,
+    double,
+    double,
+    double,
+    double,
+    double,
+    bool,
+    const std::vector<Tensor>&);
+DECLARE_DISPATCH(
+    merged_embeddingbag_backward_adam_cpu_kernel_fn,
+    merged_embeddingbag_backward_adam_cpu_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
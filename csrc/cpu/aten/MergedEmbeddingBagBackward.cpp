@@ -5,6 +5,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(merged_embeddingbag_backward_cpu_kernel_stub);
+DEFINE_DISPATCH(merged_embeddingbag_backward_compositional_cpu_kernel_stub);
 
 std::vector<Tensor> merged_embeddingbag_backward_cpu(
     const std::vector<Tensor>& grad_outs_,
@@ -12,11 +13,12 @@ std::vector<Tensor> merged_embeddingbag_backward_cpu(
     const std::vector<Tensor>& weights,
     const Tensor& indices_with_row_offset,
     const Tensor& row_offsets,
-    const std::vector<int64_t> pooling_modes) {
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& dedup_mapping) {
   /*
    * pointer to merged_embeddingbag_backward_cpu_kernel_impl(
         grad_outs_, offsets, weights, indices_with_row_offset, row_offsets,
-   pooling_modes, same_dtype);
+   pooling_modes, dedup_mapping);
    */
   return merged_embeddingbag_backward_cpu_kernel_stub(
       kCPU,
@@ -25,7 +27,34 @@ std::vector<Tensor> merged_embeddingbag_backward_cpu(
       weights,
       indices_with_row_offset,
       row_offsets,
-      pooling_modes);
+      pooling_modes,
+      dedup_mapping);
+}
+
+std::vector<Tensor> merged_embeddingbag_backward_compositional_cpu(
+    const std::vector<Tensor>& grad_outs_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine) {
+  /*
+   * pointer to merged_embeddingbag_backward_compositional_cpu_kernel_impl(
+        grad_outs_, indices, offsets, weights, pooling_modes, num_components,
+   mode, combine);
+   */
+  return merged_embeddingbag_backward_compositional_cpu_kernel_stub(
+      kCPU,
+      grad_outs_,
+      indices,
+      offsets,
+      weights,
+      pooling_modes,
+      num_components,
+      mode,
+      combine);
 }
 
 } // namespace cpu
@@ -35,11 +64,17 @@ namespace {
 
 TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
-      "merged_embeddingbag_backward_cpu(Tensor[] grad, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes) -> Tensor[]");
+      "merged_embeddingbag_backward_cpu(Tensor[] grad, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes, Tensor[] dedup_mapping=[]) -> Tensor[]");
   m.impl(
       "merged_embeddingbag_backward_cpu",
       c10::DispatchKey::CPU,
       torch_ipex::cpu::merged_embeddingbag_backward_cpu);
+  m.def(
+      "merged_embeddingbag_backward_compositional(Tensor[] grad, Tensor indices, Tensor offsets, Tensor[] weight, int[] pooling_modes, int[] num_components, int mode, int combine) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_backward_compositional",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_backward_compositional_cpu);
 }
 
 } // namespace
@@ -0,0 +1,74 @@
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBag.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(merged_embeddingbag_backward_adagrad_cpu_kernel_stub);
+
+void merged_embeddingbag_backward_adagrad_cpu(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& hessian,
+    const std::vector<Tensor>& bf16_trail,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool rowwise,
+    const std::vector<Tensor>& dedup_mapping) {
+  /*
+  pointer to merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      hessian,
+      bf16_trail,
+      eps,
+      weight_decay,
+      lr,
+      rowwise,
+      dedup_mapping);
+  */
+  return merged_embeddingbag_backward_adagrad_cpu_kernel_stub(
+      kCPU,
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      hessian,
+      bf16_trail,
+      eps,
+      weight_decay,
+      lr,
+      rowwise,
+      dedup_mapping);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "merged_embeddingbag_backward_adagrad(Tensor[] grad, Tensor indices, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes, Tensor[] hessian, Tensor[] bf16_trail, float eps, float weight_decay, float lr, bool rowwise, Tensor[] dedup_mapping=[]) -> ()");
+  m.impl(
+      "merged_embeddingbag_backward_adagrad",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_backward_adagrad_cpu);
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBag.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(merged_embeddingbag_backward_adam_cpu_kernel_stub);
+
+void merged_embeddingbag_backward_adam_cpu(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    const std::vector<Tensor>& bf16_trail,
+    double step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool lamb,
+    const std::vector<Tensor>& dedup_mapping) {
+  /*
+  pointer to merged_embeddingbag_backward_adam_cpu_kernel_impl(
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      exp_avg,
+      exp_avg_sq,
+      bf16_trail,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      lamb,
+      dedup_mapping);
+  */
+  return merged_embeddingbag_backward_adam_cpu_kernel_stub(
+      kCPU,
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      exp_avg,
+      exp_avg_sq,
+      bf16_trail,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      lamb,
+      dedup_mapping);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "merged_embeddingbag_backward_adam(Tensor[] grad, Tensor indices, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes, Tensor[] exp_avg, Tensor[] exp_avg_sq, Tensor[] bf16_trail, float step, float beta1, float beta2, float eps, float weight_decay, float lr, bool lamb, Tensor[] dedup_mapping=[]) -> ()");
+  m.impl(
+      "merged_embeddingbag_backward_adam",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_backward_adam_cpu);
+}
+
+} // namespace
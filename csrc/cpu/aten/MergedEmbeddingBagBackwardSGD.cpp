@@ -6,6 +6,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(merged_embeddingbag_backward_sgd_cpu_kernel_stub);
+DEFINE_DISPATCH(interaction_backward_merged_embeddingbag_sgd_cpu_kernel_stub);
 
 void merged_embeddingbag_backward_sgd_cpu(
     const std::vector<Tensor>& grads_y_,
@@ -17,7 +18,8 @@ void merged_embeddingbag_backward_sgd_cpu(
     std::vector<int64_t> pooling_modes,
     const std::vector<Tensor>& bf16_trail,
     double weight_decay,
-    double lr) {
+    double lr,
+    const std::vector<Tensor>& dedup_mapping) {
   /*
   pointer to merged_embeddingbag_backward_sgd_cpu_kernel_impl(
       grads_y_,
@@ -29,7 +31,8 @@ void merged_embeddingbag_backward_sgd_cpu(
       pooling_modes,
       bf16_trail,
       weight_decay,
-      lr);
+      lr,
+      dedup_mapping);
   */
   return merged_embeddingbag_backward_sgd_cpu_kernel_stub(
       kCPU,
@@ -42,7 +45,52 @@ void merged_embeddingbag_backward_sgd_cpu(
       pooling_modes,
       bf16_trail,
       weight_decay,
-      lr);
+      lr,
+      dedup_mapping);
+}
+
+Tensor interaction_backward_merged_embeddingbag_sgd_cpu(
+    const Tensor& grad_out,
+    const std::vector<Tensor>& input,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    double weight_decay,
+    double lr,
+    const std::vector<Tensor>& dedup_mapping) {
+  /*
+  pointer to interaction_backward_merged_embeddingbag_sgd_cpu_kernel_impl(
+      grad_out,
+      input,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      weight_decay,
+      lr,
+      dedup_mapping);
+  */
+  return interaction_backward_merged_embeddingbag_sgd_cpu_kernel_stub(
+      kCPU,
+      grad_out,
+      input,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      weight_decay,
+      lr,
+      dedup_mapping);
 }
 
 } // namespace cpu
@@ -52,11 +100,17 @@ namespace {
 
 TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
-      "merged_embeddingbag_backward_sgd(Tensor[] grad, Tensor indices, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes, Tensor[] bf16_trail, float weight_decay, float lr) -> ()");
+      "merged_embeddingbag_backward_sgd(Tensor[] grad, Tensor indices, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset,  Tensor row_offsets, int[] pooling_modes, Tensor[] bf16_trail, float weight_decay, float lr, Tensor[] dedup_mapping=[]) -> ()");
   m.impl(
       "merged_embeddingbag_backward_sgd",
       c10::DispatchKey::CPU,
       torch_ipex::cpu::merged_embeddingbag_backward_sgd_cpu);
+  m.def(
+      "interaction_backward_merged_embeddingbag_sgd(Tensor grad_out, Tensor[] input, Tensor indices, Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset, Tensor row_offsets, int[] pooling_modes, Tensor[] bf16_trail, float weight_decay, float lr, Tensor[] dedup_mapping=[]) -> Tensor");
+  m.impl(
+      "interaction_backward_merged_embeddingbag_sgd",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::interaction_backward_merged_embeddingbag_sgd_cpu);
 }
 
 } // namespace
@@ -0,0 +1,79 @@
+#include "MoE.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(moe_linear_kernel_stub);
+
+at::Tensor moe_linear(
+    const at::Tensor& input,
+    const at::Tensor& topk_ids,
+    const at::Tensor& topk_weights,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias) {
+  RECORD_FUNCTION("moe_linear", c10::ArrayRef<c10::IValue>({}));
+
+  auto dtype = input.scalar_type();
+  TORCH_CHECK(
+      dtype == at::kFloat || dtype == at::kBFloat16,
+      "moe_linear only supports float and bfloat16");
+  TORCH_CHECK(
+      input.dim() > 0 && weight.dim() == 3 &&
+          input.size(-1) == weight.size(2) && weight.scalar_type() == dtype,
+      "moe_linear expects a [E, N, K] weight of the input dtype");
+  int64_t K = weight.size(2);
+  int64_t T = input.numel() / std::max(K, int64_t(1));
+  TORCH_CHECK(
+      topk_ids.dim() == 2 && topk_ids.size(0) == T &&
+          topk_weights.sizes() == topk_ids.sizes(),
+      "moe_linear expects topk_ids and topk_weights of [",
+      T,
+      ", k]");
+  at::Tensor bias_;
+  if (bias.has_value() && bias.value().defined()) {
+    bias_ = bias.value().contiguous();
+    TORCH_CHECK(
+        bias_.dim() == 2 && bias_.size(0) == weight.size(0) &&
+            bias_.size(1) == weight.size(1) && bias_.scalar_type() == dtype,
+        "moe_linear expects a [E, N] bias of the input dtype");
+  }
+  auto ids = topk_ids.to(at::kLong).contiguous();
+  if (ids.numel() > 0) {
+    TORCH_CHECK(
+        ids.min().item<int64_t>() >= 0 &&
+            ids.max().item<int64_t>() < weight.size(0),
+        "moe_linear: expert index out of range");
+  }
+
+  auto output_size = input.sizes().vec();
+  output_size.back() = weight.size(1);
+  auto output = at::empty(output_size, input.options());
+  auto output_ = output.view({T, weight.size(1)});
+  /*
+  pointer to moe_linear_kernel_impl(
+      input, topk_ids, topk_weights, weight, bias, output);
+  */
+  moe_linear_kernel_stub(
+      kCPU,
+      input.contiguous().view({T, K}),
+      ids,
+      topk_weights.to(at::kFloat).contiguous(),
+      weight.contiguous(),
+      bias_,
+      output_);
+  return output;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "moe_linear(Tensor input, Tensor topk_ids, Tensor topk_weights, Tensor weight, Tensor? bias) -> Tensor");
+  m.impl("moe_linear", c10::DispatchKey::CPU, torch_ipex::cpu::moe_linear);
+}
+
+} // namespace
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * Linear layer of a Mixture-of-Experts with top-k routing: for each token t,
+ *   output[t] = sum_j topk_weights[t, j] *
+ *       (input[t] * weight[topk_ids[t, j]]^T + bias[topk_ids[t, j]])
+ * The tokens are dispatched to expert-contiguous blocks, the GEMMs of all
+ * experts and the combine run in a single parallel region, whose threads take
+ * the tiles of the unevenly loaded experts from a shared queue.
+ *
+ * input: [*, K] of float or bfloat16
+ * topk_ids, topk_weights: [T, k], T being the number of tokens of input
+ * weight: plain [E, N, K] of the input dtype, bias: [E, N]
+ * */
+at::Tensor moe_linear(
+    const at::Tensor& input,
+    const at::Tensor& topk_ids,
+    const at::Tensor& topk_weights,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias);
+
+namespace {
+
+void moe_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& topk_ids,
+    const at::Tensor& topk_weights,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output);
+
+} // namespace
+
+using moe_linear_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(moe_linear_kernel_fn, moe_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,12 +1,20 @@
 #include "MultiHeadAttention.h"
 #include <torch/all.h>
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(bert_mha_kernel_stub);
+DEFINE_DISPATCH(bert_mha_int8_kernel_stub);
 DEFINE_DISPATCH(sd_mha_kernel_v1_stub);
 DEFINE_DISPATCH(sd_mha_kernel_v2_stub);
+DEFINE_DISPATCH(flash_mha_varlen_kernel_stub);
+DEFINE_DISPATCH(paged_attention_decode_kernel_stub);
+DEFINE_DISPATCH(beam_attention_decode_kernel_stub);
+DEFINE_DISPATCH(paged_attention_update_cache_kernel_stub);
+DEFINE_DISPATCH(flash_attention_forward_kernel_stub);
+DEFINE_DISPATCH(flash_attention_backward_kernel_stub);
 
 at::Tensor bert_flash_mha(
     const at::Tensor& qkv,
@@ -18,12 +26,41 @@ at::Tensor bert_flash_mha(
       kCPU, qkv, rel_kv, head_num, headSize, dim_per_head);
 }
 
+at::Tensor bert_flash_mha_int8(
+    const at::Tensor& qkv,
+    const at::Tensor& rel_kv,
+    int64_t head_num,
+    int64_t headSize,
+    double dim_per_head,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  RECORD_FUNCTION(
+      "torch_ipex::bert_flash_mha_int8", c10::ArrayRef<c10::IValue>({}));
+  /*
+  pointer to bert_mha_int8_kernel_impl(
+      qkv, rel_kv, head_num, headSize, dim_per_head, o_scale, o_zp, o_dtype);
+  */
+  return bert_mha_int8_kernel_stub(
+      kCPU,
+      qkv,
+      rel_kv,
+      head_num,
+      headSize,
+      dim_per_head,
+      o_scale,
+      o_zp,
+      o_dtype);
+}
+
 at::Tensor sd_flash_mha(
     const at::Tensor& qkv,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale) {
-  return sd_mha_kernel_v1_stub(kCPU, qkv, head_num, headSize, scale);
+    const double& scale,
+    const bool is_causal) {
+  return sd_mha_kernel_v1_stub(
+      kCPU, qkv, head_num, headSize, scale, is_causal);
 }
 
 at::Tensor sd_flash_mha(
@@ -32,10 +69,256 @@ at::Tensor sd_flash_mha(
     const at::Tensor& value,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale) {
+    const double& scale,
+    const bool is_causal) {
   return sd_mha_kernel_v2_stub(
-      kCPU, query, key, value, head_num, headSize, scale);
+      kCPU, query, key, value, head_num, headSize, scale, is_causal);
+}
+
+at::Tensor flash_mha_varlen(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& cu_seqlens_q,
+    const at::Tensor& cu_seqlens_kv,
+    int64_t head_num,
+    double scale,
+    bool is_causal) {
+  RECORD_FUNCTION(
+      "torch_ipex::flash_mha_varlen", c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      query.size(-1) % head_num == 0,
+      "flash_mha_varlen: hidden size should be a multiple of head_num");
+  int64_t headSize = query.size(-1) / head_num;
+  /*
+  pointer to flash_mha_varlen_kernel_impl(
+      query, key, value, cu_seqlens_q, cu_seqlens_kv, head_num, headSize,
+      scale, is_causal);
+  */
+  return flash_mha_varlen_kernel_stub(
+      kCPU,
+      query,
+      key,
+      value,
+      cu_seqlens_q,
+      cu_seqlens_kv,
+      head_num,
+      headSize,
+      scale,
+      is_causal);
+}
+
+at::Tensor paged_attention_decode(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& block_tables,
+    const at::Tensor& context_lens,
+    double scale) {
+  RECORD_FUNCTION(
+      "torch_ipex::paged_attention_decode", c10::ArrayRef<c10::IValue>({}));
+  /*
+  pointer to paged_attention_decode_kernel_impl(
+      query, key_cache, value_cache, block_tables, context_lens, scale);
+  */
+  return paged_attention_decode_kernel_stub(
+      kCPU, query, key_cache, value_cache, block_tables, context_lens, scale);
+}
+
+at::Tensor beam_attention_decode(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& beam_table,
+    int64_t seq_len,
+    double scale) {
+  RECORD_FUNCTION(
+      "torch_ipex::beam_attention_decode", c10::ArrayRef<c10::IValue>({}));
+  /*
+  pointer to beam_attention_decode_kernel_impl(
+      query, key_cache, value_cache, beam_table, seq_len, scale);
+  */
+  return beam_attention_decode_kernel_stub(
+      kCPU, query, key_cache, value_cache, beam_table, seq_len, scale);
+}
+
+void paged_attention_update_cache(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const at::Tensor& slot_mapping) {
+  RECORD_FUNCTION(
+      "torch_ipex::paged_attention_update_cache",
+      c10::ArrayRef<c10::IValue>({}));
+  /*
+  pointer to paged_attention_update_cache_kernel_impl(
+      key, value, key_cache, value_cache, slot_mapping);
+  */
+  paged_attention_update_cache_kernel_stub(
+      kCPU, key, value, key_cache, value_cache, slot_mapping);
+}
+
+std::tuple<at::Tensor, at::Tensor> flash_attention_forward(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal) {
+  RECORD_FUNCTION(
+      "torch_ipex::flash_attention_forward", c10::ArrayRef<c10::IValue>({}));
+  // query of [B, N, L, H], the two GEMMs of L * S * H of each head, halved
+  // by the causal mask
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::flash_attention_forward",
+      2 * utils::nbytes(query) + utils::nbytes(key) + utils::nbytes(value),
+      4 * query.numel() * key.size(2) / (is_causal ? 2 : 1));
+  /*
+  pointer to flash_attention_forward_kernel_impl(
+      query, key, value, scale, is_causal);
+  */
+  return flash_attention_forward_kernel_stub(
+      kCPU, query, key, value, scale, is_causal);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> flash_attention_backward(
+    const at::Tensor& grad_out,
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& out,
+    const at::Tensor& logsumexp,
+    double scale,
+    bool is_causal) {
+  RECORD_FUNCTION(
+      "torch_ipex::flash_attention_backward", c10::ArrayRef<c10::IValue>({}));
+  // the GEMMs of the recomputed scores and of the 4 gradients
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::flash_attention_backward",
+      3 * utils::nbytes(query) + 2 * utils::nbytes(key) +
+          2 * utils::nbytes(value),
+      10 * query.numel() * key.size(2) / (is_causal ? 2 : 1));
+  /*
+  pointer to flash_attention_backward_kernel_impl(
+      grad_out, query, key, value, out, logsumexp, scale, is_causal);
+  */
+  return flash_attention_backward_kernel_stub(
+      kCPU, grad_out, query, key, value, out, logsumexp, scale, is_causal);
+}
+
+at::Tensor IPEXFlashAttentionOp::_forward(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal) {
+  at::AutoDispatchBelowADInplaceOrView g;
+  RECORD_FUNCTION(
+      "IPEXFlashAttentionOp::_forward", c10::ArrayRef<c10::IValue>({}));
+  return std::get<0>(
+      flash_attention_forward(query, key, value, scale, is_causal));
+}
+
+at::Tensor IPEXFlashAttentionOp::forward(
+    torch::autograd::AutogradContext* ctx,
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal) {
+  RECORD_FUNCTION(
+      "IPEXFlashAttentionOp::forward", c10::ArrayRef<c10::IValue>({}));
+  at::AutoDispatchBelowADInplaceOrView g;
+  at::Tensor out, logsumexp;
+  std::tie(out, logsumexp) =
+      flash_attention_forward(query, key, value, scale, is_causal);
+  ctx->saved_data["scale"] = scale;
+  ctx->saved_data["is_causal"] = is_causal;
+  ctx->save_for_backward({query, key, value, out, logsumexp});
+  return out;
+}
+
+torch::autograd::variable_list IPEXFlashAttentionOp::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::variable_list grad_outputs) {
+  RECORD_FUNCTION(
+      "IPEXFlashAttentionOp::backward", c10::ArrayRef<c10::IValue>({}));
+  auto scale = ctx->saved_data["scale"].toDouble();
+  auto is_causal = ctx->saved_data["is_causal"].toBool();
+  auto saved = ctx->get_saved_variables();
+  at::Tensor grad_query, grad_key, grad_value;
+  std::tie(grad_query, grad_key, grad_value) = flash_attention_backward(
+      grad_outputs[0],
+      saved[0],
+      saved[1],
+      saved[2],
+      saved[3],
+      saved[4],
+      scale,
+      is_causal);
+  return {grad_query, grad_key, grad_value, at::Tensor(), at::Tensor()};
+}
+
+at::Tensor flash_attention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal) {
+  if (at::GradMode::is_enabled() &&
+      (query.requires_grad() || key.requires_grad() ||
+       value.requires_grad())) {
+    return IPEXFlashAttentionOp::apply(query, key, value, scale, is_causal);
+  }
+  return IPEXFlashAttentionOp::_forward(query, key, value, scale, is_causal);
 }
 
 } // namespace cpu
 } // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "bert_flash_mha_int8(Tensor qkv, Tensor rel_kv, int head_num, int head_size, float dim_per_head, float o_scale, int o_zp, ScalarType o_dtype) -> Tensor");
+  m.impl(
+      "bert_flash_mha_int8",
+      c10::DispatchKey::QuantizedCPU,
+      torch_ipex::cpu::bert_flash_mha_int8);
+  m.def(
+      "flash_mha_varlen(Tensor query, Tensor key, Tensor value, Tensor cu_seqlens_q, Tensor cu_seqlens_kv, int head_num, float scale, bool is_causal=False) -> Tensor");
+  m.impl(
+      "flash_mha_varlen",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::flash_mha_varlen);
+  m.def(
+      "paged_attention_decode(Tensor query, Tensor key_cache, Tensor value_cache, Tensor block_tables, Tensor context_lens, float scale) -> Tensor");
+  m.impl(
+      "paged_attention_decode",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::paged_attention_decode);
+  m.def(
+      "beam_attention_decode(Tensor query, Tensor key_cache, Tensor value_cache, Tensor beam_table, int seq_len, float scale) -> Tensor");
+  m.impl(
+      "beam_attention_decode",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::beam_attention_decode);
+  m.def(
+      "paged_attention_update_cache(Tensor key, Tensor value, Tensor(a!) key_cache, Tensor(b!) value_cache, Tensor slot_mapping) -> ()");
+  m.impl(
+      "paged_attention_update_cache",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::paged_attention_update_cache);
+  m.def(
+      "flash_attention(Tensor query, Tensor key, Tensor value, float scale, bool is_causal=False) -> Tensor");
+  m.impl(
+      "flash_attention",
+      c10::DispatchKey::AutogradCPU,
+      torch_ipex::cpu::flash_attention);
+  m.impl(
+      "flash_attention",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::IPEXFlashAttentionOp::_forward);
+}
+
+} // namespace
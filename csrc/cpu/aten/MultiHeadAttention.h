@@ -5,6 +5,7 @@
 #include <cpu/kernels/Mha.h>
 #include <cpu/kernels/Softmax.h>
 #include <dyndisp/DispatchStub.h>
+#include <torch/csrc/autograd/custom_function.h>
 #include "AddSoftmax.h"
 #include "DivSoftmax.h"
 
@@ -20,11 +21,31 @@ at::Tensor bert_flash_mha(
     const int64_t& headSize,
     const double& dim_per_head);
 
+// Int8 version of bert_flash_mha: qkv is a per tensor quantized (quint8 or
+// qint8) [batch, seq, 3 * hidden] tensor. QK^T is accumulated in int32, the
+// softmax runs in fp32 and its probs are quantized to u8 for the product with
+// V. The output [batch, seq, head_num, head_size] is quantized with o_scale,
+// o_zp and o_dtype.
+at::Tensor bert_flash_mha_int8(
+    const at::Tensor& qkv,
+    const at::Tensor& rel_kv,
+    int64_t head_num,
+    int64_t headSize,
+    double dim_per_head,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
+// With "is_causal", query row i attends the key rows j <= i + kvLen - qLen,
+// the fully masked key blocks are skipped. For separate query/key/value, the
+// number of kv heads is key.size(-1) / headSize and may be less than head_num
+// (GQA/MQA).
 at::Tensor sd_flash_mha(
     const at::Tensor& qkv,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale);
+    const double& scale,
+    const bool is_causal = false);
 
 at::Tensor sd_flash_mha(
     const at::Tensor& query,
@@ -32,7 +53,119 @@ at::Tensor sd_flash_mha(
     const at::Tensor& value,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale);
+    const double& scale,
+    const bool is_causal = false);
+
+// Flash MHA over packed variable length sequences: query [total_q, hidden]
+// and key/value [total_kv, hidden], sequence i owns the rows
+// [cu_seqlens[i], cu_seqlens[i + 1]), so no padding token is computed.
+// key/value may have less heads than query (GQA/MQA).
+at::Tensor flash_mha_varlen(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& cu_seqlens_q,
+    const at::Tensor& cu_seqlens_kv,
+    int64_t head_num,
+    double scale,
+    bool is_causal);
+
+// Decode step attention over a block-paged KV cache: one query token per
+// sequence against its cached tokens.
+//   query: [num_seqs, num_heads, head_size]
+//   key_cache/value_cache: [num_blocks, block_size, num_kv_heads, head_size],
+//     num_heads should be a multiple of num_kv_heads (MQA/GQA).
+//   block_tables: [num_seqs, max_blocks_per_seq], the cache blocks of every
+//     sequence in order.
+//   context_lens: [num_seqs], number of cached tokens of every sequence.
+// Returns [num_seqs, num_heads, head_size].
+at::Tensor paged_attention_decode(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& block_tables,
+    const at::Tensor& context_lens,
+    double scale);
+
+// Decode step attention over a contiguous KV cache of beam search, whose beams
+// are reordered through an indirection table instead of copying the cache.
+//   query: [num_seqs, num_heads, head_size]
+//   key_cache/value_cache: [max_len, num_rows, num_kv_heads, head_size], the
+//     key/value of the token of step t being written in the row of its
+//     sequence at step t, and never moved.
+//   beam_table: [max_len, num_seqs], the row of the cache holding the token t
+//     of sequence s, i.e. of the beam s descends from at step t.
+//   seq_len: the number of cached tokens of every sequence.
+// Returns [num_seqs, num_heads, head_size].
+at::Tensor beam_attention_decode(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& beam_table,
+    int64_t seq_len,
+    double scale);
+
+// Write key/value [num_tokens, num_kv_heads, head_size] of the new tokens into
+// the paged caches, slot_mapping[i] = block * block_size + offset of token i
+// (a negative slot skips the token, e.g. padding).
+void paged_attention_update_cache(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const at::Tensor& slot_mapping);
+
+// Memory-efficient attention for training, query [B, H, qSize, D] and
+// key/value [B, H, kvSize, D]. The forward keeps the log-sum-exp of every
+// query row ([B, H, qSize], float) instead of the attention probs, the
+// backward recomputes the probs tile by tile from it, so neither pass
+// materializes [B, H, qSize, kvSize].
+std::tuple<at::Tensor, at::Tensor> flash_attention_forward(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> flash_attention_backward(
+    const at::Tensor& grad_out,
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& out,
+    const at::Tensor& logsumexp,
+    double scale,
+    bool is_causal);
+
+class IPEXFlashAttentionOp
+    : public torch::autograd::Function<IPEXFlashAttentionOp> {
+ public:
+  static at::Tensor _forward(
+      const at::Tensor& query,
+      const at::Tensor& key,
+      const at::Tensor& value,
+      double scale,
+      bool is_causal);
+
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& query,
+      const at::Tensor& key,
+      const at::Tensor& value,
+      double scale,
+      bool is_causal);
+
+  static torch::autograd::variable_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::variable_list grad_outputs);
+};
+
+at::Tensor flash_attention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal);
 
 namespace {
 at::Tensor bert_mha_kernel_impl(
@@ -42,11 +175,22 @@ at::Tensor bert_mha_kernel_impl(
     const int64_t& headSize,
     const double& dim_per_head);
 
+at::Tensor bert_mha_int8_kernel_impl(
+    const at::Tensor& qkv,
+    const at::Tensor& rel_kv,
+    int64_t head_num,
+    int64_t headSize,
+    double dim_per_head,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
 at::Tensor sd_mha_kernel_v1_impl(
     const at::Tensor& qkv,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale);
+    const double& scale,
+    const bool is_causal);
 
 at::Tensor sd_mha_kernel_v2_impl(
     const at::Tensor& query,
@@ -54,7 +198,60 @@ at::Tensor sd_mha_kernel_v2_impl(
     const at::Tensor& value,
     const int64_t& head_num,
     const int64_t& headSize,
-    const double& scale);
+    const double& scale,
+    const bool is_causal);
+
+at::Tensor flash_mha_varlen_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& cu_seqlens_q,
+    const at::Tensor& cu_seqlens_kv,
+    const int64_t& head_num,
+    const int64_t& headSize,
+    const double& scale,
+    const bool is_causal);
+
+at::Tensor paged_attention_decode_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& block_tables,
+    const at::Tensor& context_lens,
+    double scale);
+
+at::Tensor beam_attention_decode_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& beam_table,
+    int64_t seq_len,
+    double scale);
+
+void paged_attention_update_cache_kernel_impl(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const at::Tensor& slot_mapping);
+
+std::tuple<at::Tensor, at::Tensor> flash_attention_forward_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+flash_attention_backward_kernel_impl(
+    const at::Tensor& grad_out,
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& out,
+    const at::Tensor& logsumexp,
+    double scale,
+    bool is_causal);
 } // namespace
 
 using bert_mha_kernel_fn = at::Tensor (*)(
@@ -64,11 +261,22 @@ using bert_mha_kernel_fn = at::Tensor (*)(
     const int64_t&,
     const double&);
 
+using bert_mha_int8_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    double,
+    double,
+    int64_t,
+    at::ScalarType);
+
 using sd_mha_kernel_v1_fn = at::Tensor (*)(
     const at::Tensor&,
     const int64_t&,
     const int64_t&,
-    const double&);
+    const double&,
+    const bool);
 
 using sd_mha_kernel_v2_fn = at::Tensor (*)(
     const at::Tensor&,
@@ -76,10 +284,81 @@ using sd_mha_kernel_v2_fn = at::Tensor (*)(
     const at::Tensor&,
     const int64_t&,
     const int64_t&,
-    const double&);
+    const double&,
+    const bool);
+
+using flash_mha_varlen_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const int64_t&,
+    const int64_t&,
+    const double&,
+    const bool);
+
+using paged_attention_decode_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double);
+
+using beam_attention_decode_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    double);
+
+using paged_attention_update_cache_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    const at::Tensor&);
+
+using flash_attention_forward_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        double,
+        bool);
+
+using flash_attention_backward_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        double,
+        bool);
 
 DECLARE_DISPATCH(bert_mha_kernel_fn, bert_mha_kernel_stub);
+DECLARE_DISPATCH(bert_mha_int8_kernel_fn, bert_mha_int8_kernel_stub);
 DECLARE_DISPATCH(sd_mha_kernel_v1_fn, sd_mha_kernel_v1_stub);
 DECLARE_DISPATCH(sd_mha_kernel_v2_fn, sd_mha_kernel_v2_stub);
+DECLARE_DISPATCH(flash_mha_varlen_kernel_fn, flash_mha_varlen_kernel_stub);
+DECLARE_DISPATCH(
+    paged_attention_decode_kernel_fn,
+    paged_attention_decode_kernel_stub);
+DECLARE_DISPATCH(
+    beam_attention_decode_kernel_fn,
+    beam_attention_decode_kernel_stub);
+DECLARE_DISPATCH(
+    paged_attention_update_cache_kernel_fn,
+    paged_attention_update_cache_kernel_stub);
+DECLARE_DISPATCH(
+    flash_attention_forward_kernel_fn,
+    flash_attention_forward_kernel_stub);
+DECLARE_DISPATCH(
+    flash_attention_backward_kernel_fn,
+    flash_attention_backward_kernel_stub);
 } // namespace cpu
 } // namespace torch_ipex
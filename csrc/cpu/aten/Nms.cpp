@@ -7,12 +7,14 @@
 #include <algorithm>
 #include "autocast/autocast_mode.h"
 #include "cpu/kernels/Softmax.h"
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(nms_cpu_kernel_stub);
 DEFINE_DISPATCH(batch_score_nms_cpu_kernel_stub);
+DEFINE_DISPATCH(detection_postprocess_cpu_kernel_stub);
 DEFINE_DISPATCH(rpn_nms_cpu_kernel_stub);
 DEFINE_DISPATCH(box_head_nms_cpu_kernel_stub);
 
@@ -30,6 +32,11 @@ at::Tensor nms(
   printf("IpexExternal::nms\n");
 #endif
   RECORD_FUNCTION("IpexExternal::nms", c10::ArrayRef<c10::IValue>({}));
+  // the IoU of each pair of boxes at worst
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::nms",
+      utils::nbytes(dets) + utils::nbytes(scores),
+      dets.size(0) * dets.size(0) * 10);
 
   TORCH_INTERNAL_ASSERT_DEBUG_ONLY(dets.layout() == c10::kStrided);
   TORCH_INTERNAL_ASSERT_DEBUG_ONLY(scores.layout() == c10::kStrided);
@@ -67,6 +74,76 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
   return result;
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double iou_threshold,
+    const int64_t max_candidates,
+    const int64_t max_output,
+    const bool use_sigmoid,
+    const int64_t background_label) {
+#if defined(IPEX_DISP_OP)
+  printf("IpexExternal::detection_postprocess\n");
+#endif
+  RECORD_FUNCTION(
+      "IpexExternal::detection_postprocess", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      bboxes_in.dim() == 3 && bboxes_in.size(2) == 4,
+      "detection_postprocess: bboxes_in should be [BS, number_boxes, 4]");
+  TORCH_CHECK(
+      scores_in.dim() == 3 && scores_in.size(0) == bboxes_in.size(0) &&
+          scores_in.size(1) == bboxes_in.size(1),
+      "detection_postprocess: scores_in should be [BS, number_boxes, ",
+      "class_number]");
+  TORCH_CHECK(
+      dboxes_xywh.numel() == bboxes_in.size(1) * 4,
+      "detection_postprocess: dboxes_xywh should be [1, number_boxes, 4]");
+  TORCH_CHECK(
+      scores_in.scalar_type() == bboxes_in.scalar_type(),
+      "detection_postprocess: scores_in should have the type of bboxes_in");
+  TORCH_CHECK(
+      max_candidates > 0 && max_output > 0,
+      "detection_postprocess: max_candidates and max_output should be ",
+      "positive");
+
+  /*
+  pointer to cpu::detection_postprocess_cpu_kernel_impl(
+      bboxes_in,
+      scores_in,
+      dboxes_xywh,
+      scale_xy,
+      scale_wh,
+      score_threshold,
+      iou_threshold,
+      max_candidates,
+      max_output,
+      use_sigmoid,
+      background_label);
+  */
+  auto&& result = cpu::detection_postprocess_cpu_kernel_stub(
+      kCPU,
+      bboxes_in,
+      scores_in,
+      dboxes_xywh,
+      scale_xy,
+      scale_wh,
+      score_threshold,
+      iou_threshold,
+      max_candidates,
+      max_output,
+      use_sigmoid,
+      background_label);
+
+  static_cast<void>(result); // Avoid warnings in case not used
+  return result;
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms(
     const at::Tensor& batch_dets,
     const at::Tensor& batch_scores,
@@ -259,6 +336,8 @@ static auto dispatch =
     torch::RegisterOperators()
         .op("torch_ipex::nms", &torch_ipex::nms)
         .op("torch_ipex::batch_score_nms", &torch_ipex::batch_score_nms)
+        .op("torch_ipex::detection_postprocess",
+            &torch_ipex::detection_postprocess)
         .op("torch_ipex::rpn_nms", &torch_ipex::rpn_nms)
         .op("torch_ipex::box_head_nms", &torch_ipex::box_head_nms)
         .op("torch_ipex::parallel_scale_back_batch",
@@ -299,6 +378,38 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
       max_output);
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double iou_threshold,
+    const int64_t max_candidates,
+    const int64_t max_output,
+    const bool use_sigmoid,
+    const int64_t background_label) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::detection_postprocess", "")
+          .typed<decltype(detection_postprocess)>();
+  return op.call(
+      cpu_cached_cast(at::kFloat, bboxes_in),
+      cpu_cached_cast(at::kFloat, scores_in),
+      cpu_cached_cast(at::kFloat, dboxes_xywh),
+      scale_xy,
+      scale_wh,
+      score_threshold,
+      iou_threshold,
+      max_candidates,
+      max_output,
+      use_sigmoid,
+      background_label);
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms(
     const at::Tensor& batch_dets,
     const at::Tensor& batch_scores,
@@ -367,6 +478,8 @@ std::tuple<at::Tensor, at::Tensor> parallel_scale_back_batch(
 TORCH_LIBRARY_IMPL(torch_ipex, AutocastCPU, m) {
   m.impl("nms", torch_ipex::autocast::nms);
   m.impl("batch_score_nms", torch_ipex::autocast::batch_score_nms);
+  m.impl(
+      "detection_postprocess", torch_ipex::autocast::detection_postprocess);
   m.impl("rpn_nms", torch_ipex::autocast::rpn_nms);
   m.impl("box_head_nms", torch_ipex::autocast::box_head_nms);
   m.impl(
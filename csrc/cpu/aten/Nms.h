@@ -20,6 +20,20 @@ batch_score_nms_cpu_kernel_impl(
     const float threshold,
     const int max_output);
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess_cpu_kernel_impl(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float iou_threshold,
+    const int max_candidates,
+    const int max_output,
+    const bool use_sigmoid,
+    const int background_label);
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>>
 rpn_nms_cpu_kernel_impl(
     const at::Tensor& batch_dets,
@@ -61,6 +75,23 @@ DECLARE_DISPATCH(
     batch_score_nms_cpu_kernel_fn,
     batch_score_nms_cpu_kernel_stub);
 
+using detection_postprocess_cpu_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const float,
+        const float,
+        const float,
+        const float,
+        const int,
+        const int,
+        const bool,
+        const int);
+DECLARE_DISPATCH(
+    detection_postprocess_cpu_kernel_fn,
+    detection_postprocess_cpu_kernel_stub);
+
 using rpn_nms_cpu_kernel_fn =
     std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> (*)(
         const at::Tensor&,
@@ -130,6 +161,43 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
     const double threshold,
     const int64_t max_output);
 
+/// \brief Fused SSD / RetinaNet detection post-processing: decode the boxes,
+/// compute the class probabilities, select the candidates above the score
+/// threshold and perform batch non-maximum suppression.
+///
+/// Equivalent to parallel_scale_back_batch followed by batch_score_nms when
+/// use_sigmoid is false, background_label is 0, score_threshold is 0.05 and
+/// max_candidates is max_output, without materializing the decoded boxes and
+/// the probabilities of all the anchors.
+///
+/// \param bboxes_in: predicted loc in xywh format, size [BS, number_boxes,
+/// 4]. \param scores_in: predicted logits, size [BS, number_boxes,
+/// class_number]. \param dboxes_xywh: the default boxes, size [1,
+/// number_boxes, 4]. \param scale_xy: scale factor(scalar) of xy dimention
+/// for bboxes_in. \param scale_wh: scale factor(scalar) of wh dimention for
+/// bboxes_in. \param score_threshold: the threshold of the probabilities.
+/// \param iou_threshold: IOU threshold(scalar) to suppress bboxs which has
+/// the IOU val larger than the threshold. \param max_candidates: the max
+/// number of candidates of a class per image. \param max_output: the max
+/// number of output bbox per image. \param use_sigmoid: sigmoid instead of
+/// softmax over the classes. \param background_label: the class skipped, -1
+/// for none.
+///
+/// \return result is the same as batch_score_nms.
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double iou_threshold,
+    const int64_t max_candidates,
+    const int64_t max_output,
+    const bool use_sigmoid,
+    const int64_t background_label);
+
 /// \brief Perform batch non-maximum suppression (NMS) for MaskRCNN RPN part.
 ///
 /// C++ version of batch NMS for MaskRCNN RPN part.
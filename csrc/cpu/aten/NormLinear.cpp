@@ -0,0 +1,9 @@
+#include "NormLinear.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(norm_rows_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The norms fused into the prologue of a prepacked linear
+enum NormLinearKind {
+  // LayerNorm(input + residual)
+  AddLayerNormKind = 0,
+  // RMSNorm(input)
+  RMSNormKind = 1,
+};
+
+namespace {
+
+// Normalizes the rows [begin, end) of input (plus residual for
+// AddLayerNormKind), both [M, K], into out [end - begin, K] of the input
+// dtype. It runs on the calling thread: the prologue of norm_linear_run calls
+// it on the M-block of rows of each thread.
+void norm_rows_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t norm,
+    double eps,
+    int64_t begin,
+    int64_t end,
+    at::Tensor& out);
+
+} // namespace
+
+using norm_rows_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    double,
+    int64_t,
+    int64_t,
+    at::Tensor&);
+DECLARE_DISPATCH(norm_rows_kernel_fn, norm_rows_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
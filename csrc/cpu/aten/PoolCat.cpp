@@ -0,0 +1,78 @@
+#include "PoolCat.h"
+#include <ATen/native/Pool.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(pool_cat_kernel_stub);
+
+at::Tensor pool_cat(
+    const c10::List<at::Tensor>& inputs,
+    at::IntArrayRef pool_params) {
+  RECORD_FUNCTION("ipex::pool_cat", c10::ArrayRef<c10::IValue>({}));
+
+  int64_t num_inputs = inputs.size();
+  TORCH_CHECK(num_inputs > 0, "pool_cat expects a non-empty list of inputs");
+  TORCH_CHECK(
+      static_cast<int64_t>(pool_params.size()) ==
+          num_inputs * pool_cat_num_params,
+      "pool_cat expects ",
+      pool_cat_num_params,
+      " pool parameters per input");
+  std::vector<at::Tensor> inputs_(num_inputs);
+  auto dtype = inputs.get(0).scalar_type();
+  TORCH_CHECK(
+      dtype == at::kFloat || dtype == at::kBFloat16,
+      "pool_cat only supports float and bfloat16");
+  int64_t N = -1, OH = -1, OW = -1, C = 0;
+  for (int64_t i = 0; i < num_inputs; i++) {
+    auto input = inputs.get(i);
+    TORCH_CHECK(
+        input.dim() == 4 && input.scalar_type() == dtype,
+        "pool_cat expects 4D inputs of the same dtype");
+    const int64_t* p = pool_params.data() + i * pool_cat_num_params;
+    auto kind = static_cast<PoolCatKind>(p[0]);
+    int64_t out_h = input.size(2);
+    int64_t out_w = input.size(3);
+    if (kind != PoolCatKind::COPY) {
+      TORCH_CHECK(
+          kind == PoolCatKind::MAX || kind == PoolCatKind::AVG,
+          "pool_cat: unknown pool kind ",
+          p[0]);
+      TORCH_CHECK(
+          p[1] > 0 && p[2] > 0 && p[3] > 0 && p[4] > 0 && p[7] > 0 &&
+              p[8] > 0,
+          "pool_cat: kernel, stride and dilation must be positive");
+      TORCH_CHECK(
+          p[5] >= 0 && p[6] >= 0 && p[5] <= p[1] / 2 && p[6] <= p[2] / 2,
+          "pool_cat: pad should be at most half of the kernel size");
+      out_h = at::native::pooling_output_shape<int64_t>(
+          input.size(2), p[1], p[5], p[3], p[7], p[9]);
+      out_w = at::native::pooling_output_shape<int64_t>(
+          input.size(3), p[2], p[6], p[4], p[8], p[9]);
+    }
+    if (i == 0) {
+      N = input.size(0);
+      OH = out_h;
+      OW = out_w;
+    }
+    TORCH_CHECK(
+        input.size(0) == N && out_h == OH && out_w == OW,
+        "pool_cat: the pooled inputs must have the same batch, height and "
+        "width");
+    C += input.size(1);
+    inputs_[i] = input.contiguous(at::MemoryFormat::ChannelsLast);
+  }
+  auto output = at::empty(
+      {N, C, OH, OW},
+      inputs.get(0).options().memory_format(at::MemoryFormat::ChannelsLast));
+  /*
+  pointer to pool_cat_kernel_impl(inputs_, pool_params, output);
+  */
+  pool_cat_kernel_stub(kCPU, inputs_, pool_params, output);
+  return output;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// How an input of pool_cat fills its channels of the output
+enum class PoolCatKind { COPY = 0, MAX, AVG };
+
+// The pool_cat parameters of an input, pool_cat_num_params ints per input:
+// kind, kernel (h, w), stride (h, w), padding (h, w), dilation (h, w),
+// ceil_mode, count_include_pad and relu. Dilation is 1 for AVG, the
+// parameters other than the kind are ignored for COPY.
+const int64_t pool_cat_num_params = 12;
+
+/**
+ * Concatenates the pooled 4D inputs along the channels: each max or average
+ * pooling (optionally followed by a ReLU) writes its output straight into its
+ * channel slice of the channels-last output, so that the pooled tensors and
+ * their copy by cat go away. The COPY inputs are copied into their slices.
+ * All the outputs of the pools and the COPY inputs must have the same batch,
+ * height and width and the same float or bfloat16 dtype.
+ * */
+at::Tensor pool_cat(
+    const c10::List<at::Tensor>& inputs,
+    at::IntArrayRef pool_params);
+
+namespace {
+
+void pool_cat_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    at::IntArrayRef pool_params,
+    at::Tensor& output);
+
+} // namespace
+
+using pool_cat_kernel_fn = void (*)(
+    const std::vector<at::Tensor>&,
+    at::IntArrayRef,
+    at::Tensor&);
+DECLARE_DISPATCH(pool_cat_kernel_fn, pool_cat_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
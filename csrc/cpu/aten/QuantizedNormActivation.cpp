@@ -0,0 +1,116 @@
+#include "QuantizedNormActivation.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(qlayer_norm_kernel_stub);
+DEFINE_DISPATCH(qsoftmax_kernel_stub);
+DEFINE_DISPATCH(qgelu_kernel_stub);
+
+namespace {
+
+bool is_per_tensor_int8(const at::Tensor& t) {
+  return (t.scalar_type() == at::kQUInt8 || t.scalar_type() == at::kQInt8) &&
+      t.qscheme() == at::kPerTensorAffine;
+}
+
+at::Tensor empty_quantized_like(
+    const at::Tensor& input,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  return at::_empty_affine_quantized(
+      input.sizes(),
+      input.options().dtype(o_dtype),
+      o_scale,
+      o_zp,
+      at::MemoryFormat::Contiguous);
+}
+
+} // namespace
+
+at::Tensor qlayer_norm(
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight,
+    const c10::optional<at::Tensor>& bias,
+    double eps,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  RECORD_FUNCTION("ipex::qlayer_norm", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      o_dtype == at::kQUInt8 || o_dtype == at::kQInt8,
+      "qlayer_norm only supports quint8 and qint8 output");
+  int64_t N = c10::multiply_integers(normalized_shape);
+  if (!is_per_tensor_int8(input) || N == 0 || input.numel() % N != 0) {
+    auto out =
+        at::layer_norm(input.dequantize(), normalized_shape, weight, bias, eps);
+    return at::quantize_per_tensor(out, o_scale, o_zp, o_dtype);
+  }
+  auto X = input.contiguous().view({-1, N});
+  auto to_float = [N](const c10::optional<at::Tensor>& t) {
+    return t.has_value() && t->defined()
+        ? t->to(at::kFloat).reshape({N}).contiguous()
+        : at::Tensor();
+  };
+  auto output = empty_quantized_like(X, o_scale, o_zp, o_dtype);
+  // pointer to qlayer_norm_kernel_impl(X, weight, bias, eps, output);
+  qlayer_norm_kernel_stub(
+      kCPU, X, to_float(weight), to_float(bias), eps, output);
+  return output.view(input.sizes());
+}
+
+at::Tensor qsoftmax(
+    const at::Tensor& input,
+    int64_t dim,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  RECORD_FUNCTION("ipex::qsoftmax", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      o_dtype == at::kQUInt8 || o_dtype == at::kQInt8,
+      "qsoftmax only supports quint8 and qint8 output");
+  if (!is_per_tensor_int8(input) || input.dim() == 0) {
+    auto out = at::softmax(input.dequantize(), dim);
+    return at::quantize_per_tensor(out, o_scale, o_zp, o_dtype);
+  }
+  dim = c10::maybe_wrap_dim(dim, input.dim());
+  // the kernel reduces along the contiguous last dim
+  auto X = input.transpose(dim, -1).contiguous();
+  auto output = empty_quantized_like(X, o_scale, o_zp, o_dtype);
+  // pointer to qsoftmax_kernel_impl(X, output);
+  qsoftmax_kernel_stub(kCPU, X, output);
+  return output.transpose(dim, -1);
+}
+
+at::Tensor qgelu(
+    const at::Tensor& input,
+    c10::string_view approximate,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  RECORD_FUNCTION("ipex::qgelu", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      o_dtype == at::kQUInt8 || o_dtype == at::kQInt8,
+      "qgelu only supports quint8 and qint8 output");
+  TORCH_CHECK(
+      approximate == "none" || approximate == "tanh",
+      "qgelu only supports the approximate of none and tanh");
+  if (!is_per_tensor_int8(input)) {
+    auto out = at::gelu(input.dequantize(), approximate);
+    return at::quantize_per_tensor(out, o_scale, o_zp, o_dtype);
+  }
+  auto X = input.contiguous();
+  auto output = empty_quantized_like(X, o_scale, o_zp, o_dtype);
+  // pointer to qgelu_kernel_impl(X, tanh, output);
+  qgelu_kernel_stub(kCPU, X, approximate == "tanh", output);
+  return output;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
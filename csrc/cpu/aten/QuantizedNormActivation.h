@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * Int8 LayerNorm, softmax and GeLU: the input is a per tensor affine quantized
+ * tensor (quint8 or qint8) and the output is quantized per tensor with
+ * o_scale, o_zp and o_dtype (quint8 or qint8), without the dequantize and
+ * quantize passes around the fp32 op:
+ *   - qlayer_norm accumulates the mean and the variance of a row in integers.
+ *   - qsoftmax looks up exp(scale * (q - max)) in a table of the 256 distances
+ *     to the max of the row, along the last dim.
+ *   - qgelu looks up the quantized output of each of the 256 input values.
+ * Other inputs fall back to dequantize, the fp32 op and quantize_per_tensor.
+ * */
+at::Tensor qlayer_norm(
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight,
+    const c10::optional<at::Tensor>& bias,
+    double eps,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
+at::Tensor qsoftmax(
+    const at::Tensor& input,
+    int64_t dim,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
+at::Tensor qgelu(
+    const at::Tensor& input,
+    c10::string_view approximate,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
+namespace {
+
+// input of [M, N], normalized over N, weight and bias fp32 of N or undefined
+void qlayer_norm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output);
+
+// softmax of the contiguous input along its last dim
+void qsoftmax_kernel_impl(const at::Tensor& input, at::Tensor& output);
+
+void qgelu_kernel_impl(const at::Tensor& input, bool tanh, at::Tensor& output);
+
+} // namespace
+
+using qlayer_norm_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    at::Tensor&);
+using qsoftmax_kernel_fn = void (*)(const at::Tensor&, at::Tensor&);
+using qgelu_kernel_fn = void (*)(const at::Tensor&, bool, at::Tensor&);
+
+DECLARE_DISPATCH(qlayer_norm_kernel_fn, qlayer_norm_kernel_stub);
+DECLARE_DISPATCH(qsoftmax_kernel_fn, qsoftmax_kernel_stub);
+DECLARE_DISPATCH(qgelu_kernel_fn, qgelu_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
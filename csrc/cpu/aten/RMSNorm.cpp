@@ -1,18 +1,131 @@
 #include "RMSNorm.h"
+#include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(rmsnorm_kernel_stub);
+DEFINE_DISPATCH(add_rmsnorm_kernel_stub);
 
 at::Tensor dil_RMSNorm(
     const at::Tensor& input,
     const at::Tensor& b,
     float eps) {
   RECORD_FUNCTION("dil_RMSNorm", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::rmsnorm",
+      2 * utils::nbytes(input) + utils::nbytes(b),
+      4 * input.numel());
 
-  return rmsnorm_kernel_stub(kCPU, input, b, eps);
+  return rmsnorm_kernel_stub(kCPU, input, b, eps, false);
 }
+
+at::Tensor& dil_RMSNorm_(at::Tensor& input, const at::Tensor& b, float eps) {
+  RECORD_FUNCTION("dil_RMSNorm_", c10::ArrayRef<c10::IValue>({}));
+
+  if (!input.is_contiguous()) {
+    return input.copy_(rmsnorm_kernel_stub(kCPU, input, b, eps, false));
+  }
+  rmsnorm_kernel_stub(kCPU, input, b, eps, true);
+  return input;
+}
+
+namespace {
+
+// the fused kernel only supports contiguous inputs of the same shape, of the
+// same dtype or fp32 and bf16
+bool can_fuse_add_RMSNorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight) {
+  auto is_fp32_or_bf16 = [](const at::Tensor& t) {
+    return t.scalar_type() == at::kFloat || t.scalar_type() == at::kBFloat16;
+  };
+  return input.sizes() == residual.sizes() &&
+      (input.scalar_type() == residual.scalar_type() ||
+       (is_fp32_or_bf16(input) && is_fp32_or_bf16(residual))) &&
+      input.is_contiguous() && residual.is_contiguous() && input.dim() > 0 &&
+      weight.numel() == input.size(-1);
+}
+
+std::tuple<at::Tensor, at::Tensor> add_RMSNorm_fallback(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps) {
+  auto residual_out = at::add(input, residual);
+  auto variance = at::mean(at::pow(residual_out, 2), -1, true);
+  auto out =
+      at::mul(weight, at::mul(residual_out, at::rsqrt(at::add(variance, eps))));
+  return std::make_tuple(residual_out, out.to(residual_out.scalar_type()));
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps) {
+  RECORD_FUNCTION("dil_add_RMSNorm", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::add_rmsnorm",
+      4 * utils::nbytes(input) + utils::nbytes(weight),
+      5 * input.numel());
+
+  if (!can_fuse_add_RMSNorm(input, residual, weight)) {
+    return add_RMSNorm_fallback(input, residual, weight, eps);
+  }
+  /*
+  pointer to add_rmsnorm_kernel_impl(
+      input, residual, weight, eps, scale, zero_point, qdtype);
+  */
+  return add_rmsnorm_kernel_stub(
+      kCPU, input, residual, weight, eps, 1.0, 0, c10::nullopt);
+}
+
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm_quantize(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps,
+    double scale,
+    int64_t zero_point,
+    at::ScalarType dtype) {
+  RECORD_FUNCTION("dil_add_RMSNorm_quantize", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      dtype == at::kQUInt8 || dtype == at::kQInt8,
+      "add_rmsnorm_quantize only supports quint8 and qint8 output");
+  if (!can_fuse_add_RMSNorm(input, residual, weight)) {
+    auto res = add_RMSNorm_fallback(input, residual, weight, eps);
+    return std::make_tuple(
+        std::get<0>(res),
+        at::quantize_per_tensor(
+            std::get<1>(res).to(at::kFloat), scale, zero_point, dtype));
+  }
+  return add_rmsnorm_kernel_stub(
+      kCPU, input, residual, weight, eps, scale, zero_point, dtype);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "add_rmsnorm(Tensor input, Tensor residual, Tensor weight, float eps) -> (Tensor, Tensor)");
+  m.impl(
+      "add_rmsnorm", c10::DispatchKey::CPU, torch_ipex::cpu::dil_add_RMSNorm);
+  m.def(
+      "add_rmsnorm_quantize(Tensor input, Tensor residual, Tensor weight, float eps, float scale, int zero_point, ScalarType dtype) -> (Tensor, Tensor)");
+  m.impl(
+      "add_rmsnorm_quantize",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::dil_add_RMSNorm_quantize);
+}
+
+} // namespace
@@ -8,18 +8,63 @@ namespace cpu {
 
 at::Tensor dil_RMSNorm(const at::Tensor& input, const at::Tensor& b, float eps);
 
+// dil_RMSNorm writing its output into input, a dead input
+at::Tensor& dil_RMSNorm_(at::Tensor& input, const at::Tensor& b, float eps);
+
+/**
+ * This operator fuses the residual add of a decoder layer and the RMSNorm
+ * after it: returns (input + residual, RMSNorm(input + residual) * weight).
+ * The quantize variant returns the normalized value as a per tensor affine
+ * quantized tensor of "dtype" (quint8 or qint8), for the int8 linear after
+ * it.
+ * */
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm_quantize(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps,
+    double scale,
+    int64_t zero_point,
+    at::ScalarType dtype);
+
 namespace {
 
 at::Tensor rmsnorm_kernel_impl(
     const at::Tensor& input,
     const at::Tensor& b,
-    float eps);
-}
+    float eps,
+    bool inplace);
+
+std::tuple<at::Tensor, at::Tensor> add_rmsnorm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    double scale,
+    int64_t zero_point,
+    c10::optional<at::ScalarType> qdtype);
+} // namespace
 
 using rms_norm_kernel_fn =
-    at::Tensor (*)(const at::Tensor&, const at::Tensor&, float);
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&, float, bool);
+
+using add_rms_norm_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    float,
+    double,
+    int64_t,
+    c10::optional<at::ScalarType>);
 
 DECLARE_DISPATCH(rms_norm_kernel_fn, rmsnorm_kernel_stub);
+DECLARE_DISPATCH(add_rms_norm_kernel_fn, add_rmsnorm_kernel_stub);
 
 } // namespace cpu
 } // namespace torch_ipex
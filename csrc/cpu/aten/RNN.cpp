@@ -9,7 +9,9 @@
 #include <ATen/record_function.h>
 #include <c10/util/Exception.h>
 #include <torch/all.h>
+#include <algorithm>
 #include "RNN.h"
+#include "RNNInference.h"
 #include "WeightPack.h"
 #include "autocast/autocast_mode.h"
 #include "ideep/IDeepConversions.h"
@@ -222,8 +224,10 @@ std::vector<float> get_mkldnn_weight_scales_of_lstm(
   at::Tensor weight_hh_scales_tensor =
       int8::utils::get_weight_scale_tensor(weight_hh);
   TORCH_CHECK(
-      weight_ih_scales_tensor.sizes() == weight_hh_scales_tensor.sizes() == 1,
-      "Expect scales of LSTM weight_ih and weight_hh to be of size 1");
+      weight_ih_scales_tensor.sizes() == weight_hh_scales_tensor.sizes(),
+      "Expect scales of LSTM weight_ih and weight_hh to be of the same size");
+  // weight_ih and weight_hh share the scales in oneDNN, the weight of the
+  // smaller scales is requantized to the larger ones when it is packed
 
   // PyTorch scale: (max - min) / (qmax - qmin)
   // oneDNN scale: (qmax - qmin) / (max - min)
@@ -1070,8 +1074,18 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> quantized_lstm(
   auto hx_ = hx.vec();
   auto weights_ = weights.vec();
 
+  // symmetric qint8 activations run as quint8 with the zero point of 128
+  auto u8_input = input.scalar_type() == at::kQInt8
+      ? int8::utils::qint8_to_quint8(input)
+      : input;
+  bool s8_output = static_cast<at::ScalarType>(dtype) == at::kQInt8;
+  if (s8_output) {
+    zp += 128;
+    dtype = static_cast<int64_t>(at::kQUInt8);
+  }
+
   auto result = mkldnn_impl(
-      input,
+      u8_input,
       std::make_tuple(hx_[0], hx_[1]),
       weights_,
       has_biases,
@@ -1084,13 +1098,189 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> quantized_lstm(
       scale,
       zp,
       dtype);
-  auto output = result.first;
+  auto output = s8_output ? int8::utils::quint8_to_qint8(result.first)
+                          : result.first;
   auto hy = std::get<0>(result.second);
   auto cy = std::get<1>(result.second);
 
   return std::make_tuple(output, hy, cy);
 }
 
+namespace {
+
+// The timesteps of the same batch size of a packed sequence, whose rows are
+// contiguous in the packed data
+struct PackedSegment {
+  int64_t offset;
+  int64_t seq_length;
+  int64_t batch;
+};
+
+std::vector<PackedSegment> get_packed_segments(const at::Tensor& batch_sizes) {
+  TORCH_CHECK(
+      batch_sizes.scalar_type() == at::kLong && batch_sizes.dim() == 1,
+      "ipex_lstm_packed: expected the batch_sizes of a PackedSequence");
+  auto batch_sizes_ = batch_sizes.contiguous();
+  auto sizes = batch_sizes_.data_ptr<int64_t>();
+  std::vector<PackedSegment> segments;
+  int64_t offset = 0;
+  for (int64_t t = 0; t < batch_sizes_.numel(); t++) {
+    TORCH_CHECK(
+        segments.empty() || sizes[t] <= segments.back().batch,
+        "ipex_lstm_packed: the batch sizes must not increase");
+    if (segments.empty() || sizes[t] != segments.back().batch) {
+      segments.push_back({offset, 0, sizes[t]});
+    }
+    segments.back().seq_length++;
+    offset += sizes[t];
+  }
+  return segments;
+}
+
+// One direction of a layer on the packed input [rows, input_size], returns
+// the packed output, hy and cy. The sequences being sorted by decreasing
+// lengths, the timesteps of each segment are run by one ipex_lstm_layer on
+// the batch of the sequences not finished yet, so that no padding is computed:
+// in the forward direction the batch shrinks as the sequences finish, whose
+// hy and cy are the states of the segment they finish in, and in the reverse
+// direction it grows as the sequences start from their hx and cx. The backward
+// of each ipex_lstm_layer runs on the same segments.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_packed_layer(
+    const at::Tensor& input,
+    const std::vector<PackedSegment>& segments,
+    at::TensorList weights,
+    const at::Tensor& hx,
+    const at::Tensor& cx,
+    bool reverse,
+    int64_t hidden_size,
+    int64_t num_layers,
+    bool has_biases,
+    bool bidirectional,
+    bool train) {
+  static auto op = torch::Dispatcher::singleton()
+                       .findSchemaOrThrow("torch_ipex::ipex_lstm_layer", "")
+                       .typed<decltype(ipex_lstm_layer)>();
+  auto bias_dtype = get_bias_dtype(input, weights[0]);
+  auto bias_ih = has_biases
+      ? weights[2]
+      : at::zeros(weights[0].sizes(), weights[0].options().dtype(bias_dtype));
+  auto bias_hh = has_biases
+      ? weights[3]
+      : at::zeros(weights[1].sizes(), weights[1].options().dtype(bias_dtype));
+
+  int64_t num_segments = segments.size();
+  std::vector<at::Tensor> outputs(num_segments);
+  // the states of the finished sequences, from the last rows
+  std::vector<at::Tensor> hy_rows, cy_rows;
+  at::Tensor h, c;
+  for (int64_t i = 0; i < num_segments; i++) {
+    int64_t index = reverse ? num_segments - 1 - i : i;
+    const auto& segment = segments[index];
+    int64_t batch = segment.batch;
+    if (!h.defined()) {
+      h = hx.narrow(0, 0, batch);
+      c = cx.narrow(0, 0, batch);
+    } else if (reverse) {
+      int64_t started = h.size(0);
+      h = at::cat({h, hx.narrow(0, started, batch - started)});
+      c = at::cat({c, cx.narrow(0, started, batch - started)});
+    } else {
+      int64_t finished = h.size(0) - batch;
+      hy_rows.push_back(h.narrow(0, batch, finished));
+      cy_rows.push_back(c.narrow(0, batch, finished));
+      h = h.narrow(0, 0, batch);
+      c = c.narrow(0, 0, batch);
+    }
+    auto segment_input =
+        input.narrow(0, segment.offset, segment.seq_length * batch)
+            .view({segment.seq_length, batch, input.size(1)});
+    auto result = op.call(
+        segment_input,
+        weights[0],
+        weights[1],
+        bias_ih,
+        bias_hh,
+        h,
+        c,
+        reverse,
+        /*batch_sizes*/ {},
+        static_cast<int64_t>(ideep::rnn_kind::LSTM),
+        hidden_size,
+        num_layers,
+        has_biases,
+        bidirectional,
+        /*batch_first*/ false,
+        train,
+        /*scale*/ -1.,
+        /*zp*/ -1,
+        /*dtype*/ -1);
+    outputs[index] = result[0].view({-1, hidden_size});
+    h = result[1];
+    c = result[2];
+  }
+  if (!reverse) {
+    hy_rows.push_back(h);
+    cy_rows.push_back(c);
+    std::reverse(hy_rows.begin(), hy_rows.end());
+    std::reverse(cy_rows.begin(), cy_rows.end());
+    h = at::cat(hy_rows);
+    c = at::cat(cy_rows);
+  }
+  return std::make_tuple(at::cat(outputs), h, c);
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_packed(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    const at::Tensor& hx_,
+    const at::Tensor& cx_,
+    at::TensorList params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional) {
+  auto segments = get_packed_segments(batch_sizes);
+  auto hx = hx_.contiguous();
+  auto cx = cx_.contiguous();
+  at::MatrixRef<at::Tensor> weights{
+      params, static_cast<size_t>(has_biases ? 4 : 2)};
+
+  auto num_directions = bidirectional ? 2 : 1;
+  auto layer_input = data.contiguous();
+  std::vector<at::Tensor> layer_output(num_directions);
+  std::vector<at::Tensor> layer_hy(num_layers * num_directions);
+  std::vector<at::Tensor> layer_cy(num_layers * num_directions);
+  for (int64_t layer = 0; layer < num_layers; layer++) {
+    for (int64_t direction = 0; direction < num_directions; direction++) {
+      auto index = layer * num_directions + direction;
+      std::tie(layer_output[direction], layer_hy[index], layer_cy[index]) =
+          lstm_packed_layer(
+              layer_input,
+              segments,
+              weights[index],
+              hx[index],
+              cx[index],
+              /*reverse*/ direction > 0,
+              hx.size(2),
+              num_layers,
+              has_biases,
+              bidirectional,
+              train);
+    }
+    layer_input = num_directions == 1
+        ? layer_output[0]
+        : at::cat(layer_output, /*output_channels*/ -1);
+    if (dropout_p != 0 && train && layer < num_layers - 1) {
+      layer_input = at::dropout(layer_input, dropout_p, /*train=*/true);
+    }
+  }
+  return std::make_tuple(
+      layer_input, at::stack(layer_hy, 0), at::stack(layer_cy, 0));
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -1110,6 +1300,22 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm(
 #if defined(IPEX_DISP_OP)
   printf("ipex_lstm\n");
 #endif
+  if (cpu::lstm_has_projections(hx)) {
+    if (train) {
+      return at::lstm(
+          input,
+          hx,
+          params,
+          has_biases,
+          num_layers,
+          dropout_p,
+          train,
+          bidirectional,
+          batch_first);
+    }
+    return cpu::lstm_projection_inference(
+        input, hx, params, has_biases, num_layers, bidirectional, batch_first);
+  }
   auto result = cpu::mkldnn_impl(
       input,
       std::make_tuple(hx[0], hx[1]),
@@ -1146,6 +1352,65 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_meta(
   auto cy = at::empty_symint(hx[1].sym_sizes(), hx[1].options());
   return std::make_tuple(output, hy, cy);
 }
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_packed(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    std::vector<at::Tensor> hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional) {
+  RECORD_FUNCTION("ipex_lstm_packed", c10::ArrayRef<c10::IValue>({}));
+
+#if defined(IPEX_DISP_OP)
+  printf("ipex_lstm_packed\n");
+#endif
+  if (cpu::lstm_has_projections(hx)) {
+    return at::lstm(
+        data,
+        batch_sizes,
+        hx,
+        params,
+        has_biases,
+        num_layers,
+        dropout_p,
+        train,
+        bidirectional);
+  }
+  return cpu::lstm_packed(
+      data,
+      batch_sizes,
+      hx[0],
+      hx[1],
+      params,
+      has_biases,
+      num_layers,
+      dropout_p,
+      train,
+      bidirectional);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_packed_meta(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    std::vector<at::Tensor> hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional) {
+  auto output = at::empty_symint(
+      {data.sym_size(0),
+       bidirectional ? hx[0].sym_size(2) * 2 : hx[0].sym_size(2)},
+      data.options());
+  auto hy = at::empty_symint(hx[0].sym_sizes(), hx[0].options());
+  auto cy = at::empty_symint(hx[1].sym_sizes(), hx[1].options());
+  return std::make_tuple(output, hy, cy);
+}
 } // namespace torch_ipex
 
 namespace torch_ipex {
@@ -1261,6 +1526,50 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm(
       batch_first);
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_packed(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    std::vector<at::Tensor> hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op = torch::Dispatcher::singleton()
+                       .findSchemaOrThrow("torch_ipex::ipex_lstm_packed", "")
+                       .typed<decltype(ipex_lstm_packed)>();
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::autocast::ipex_lstm_packed\n");
+#endif
+  auto target_type = get_autocast_dtype();
+  // only have bf16 support now, keep fp32 for other target_type
+  bool cast_to_bfloat16 = at::kBFloat16 == target_type;
+  auto casted_data =
+      cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, data) : data;
+  std::vector<at::Tensor> casted_hx, casted_params;
+  for (const auto i : c10::irange(hx.size())) {
+    casted_hx.emplace_back(
+        cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, hx[i]) : hx[i]);
+  }
+  for (const auto i : c10::irange(params.size())) {
+    casted_params.emplace_back(
+        cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, params[i])
+                         : params[i]);
+  }
+  return op.call(
+      casted_data,
+      batch_sizes,
+      casted_hx,
+      casted_params,
+      has_biases,
+      num_layers,
+      dropout_p,
+      train,
+      bidirectional);
+}
+
 } // namespace autocast
 } // namespace torch_ipex
 
@@ -1276,6 +1585,20 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       torch_ipex::autocast::ipex_lstm);
   m.impl("ipex_lstm", c10::DispatchKey::CPU, torch_ipex::ipex_lstm);
   m.impl("ipex_lstm", c10::DispatchKey::Meta, torch_ipex::ipex_lstm_meta);
+  m.def(
+      "ipex_lstm_packed(Tensor data, Tensor batch_sizes, Tensor[] hx, Tensor[] "
+      "params, bool has_biases, int num_layers, float dropout_p, bool train, "
+      "bool bidirectional) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "ipex_lstm_packed",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::ipex_lstm_packed);
+  m.impl(
+      "ipex_lstm_packed", c10::DispatchKey::CPU, torch_ipex::ipex_lstm_packed);
+  m.impl(
+      "ipex_lstm_packed",
+      c10::DispatchKey::Meta,
+      torch_ipex::ipex_lstm_packed_meta);
   m.def(
       "ipex_lstm_layer(Tensor input, Tensor weight0, Tensor weight1, Tensor "
       "weight2, Tensor weight3, Tensor hx_, Tensor cx_, bool reverse, int[] "
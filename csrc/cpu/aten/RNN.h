@@ -31,8 +31,41 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_meta(
     bool bidirectional,
     bool batch_first);
 
+// The LSTM of the data and the batch_sizes of a PackedSequence, which runs
+// each timestep on the sequences of at least its length only, see lstm_packed
+// in RNN.cpp
+std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_packed(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    std::vector<at::Tensor> hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm_packed_meta(
+    const at::Tensor& data,
+    const at::Tensor& batch_sizes,
+    std::vector<at::Tensor> hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional);
+
 namespace cpu {
 
+// The weight and the bias of the gates in the oneDNN order of the mode, see
+// RNN.cpp
+at::Tensor _shuffle_weight(const at::Tensor& weight, int64_t fn_mode);
+at::Tensor _shuffle_bias(
+    const at::Tensor& bias_ih,
+    const at::Tensor& bias_hh,
+    int64_t fn_mode);
+
 struct QuantizedLstmParams {
   const float scale;
   const int32_t zp;
@@ -0,0 +1,465 @@
+#include "RNNInference.h"
+#include <ATen/record_function.h>
+#include <torch/all.h>
+
+#include "RNN.h"
+#include "WeightPack.h"
+#include "autocast/autocast_mode.h"
+#include "ideep/IDeepConversions.h"
+
+#include <algorithm>
+
+/*
+ The GRUs and the LSTMs with projections run their inference with the oneDNN
+ lbr_gru and projection lstm primitives, a primitive per layer and direction
+ as the LSTMs of RNN.cpp. PyTorch GRUs apply the reset gate after the
+ recurrent matmul, which is the linear-before-reset GRU of oneDNN. The weights
+ are reordered once to the layouts of the primitives and cached with the
+ module weights, like the LSTM ones. Training and quantized inputs go to the
+ ATen RNNs.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using tag = ideep::format_tag;
+
+ideep::tensor::desc any_desc(
+    const ideep::tensor::dims& dims,
+    ideep::data_type dtype) {
+  return {dims, dtype, tag::any};
+}
+
+// The reordered weight of the expected desc, the aten weight being a
+// view of the dims in format plain_tag
+ideep::tensor packed_weight(
+    const at::Tensor& weight,
+    const at::Tensor& weight_src,
+    const ideep::tensor::dims& dims,
+    ideep::format_tag plain_tag,
+    const ideep::tensor::desc& expected_desc) {
+  auto src = itensor_view_from_dense(
+      weight_src, {dims, get_mkldnn_dtype(weight.scalar_type()), plain_tag});
+  return get_rnn_packed_weight(weight, src, expected_desc);
+}
+
+at::Tensor fp32_bias(
+    const std::vector<at::Tensor>& weights,
+    bool has_biases,
+    int64_t num_bias_gates,
+    int64_t hidden_size,
+    ideep::rnn_kind mode) {
+  if (!has_biases) {
+    return at::zeros(
+        {num_bias_gates * hidden_size},
+        weights[0].options().dtype(at::kFloat));
+  }
+  return _shuffle_bias(weights[2], weights[3], static_cast<int64_t>(mode))
+      .to(at::kFloat)
+      .contiguous();
+}
+
+// Runs the layers and directions of input, [T, N, C], run_layer(layer_input,
+// index, reverse) returning the [T, N, C'] output of a layer and direction
+template <typename F>
+at::Tensor run_layers(
+    const at::Tensor& input,
+    int64_t num_layers,
+    bool bidirectional,
+    F&& run_layer) {
+  int64_t num_directions = bidirectional ? 2 : 1;
+  auto layer_input = input;
+  std::vector<at::Tensor> layer_output(num_directions);
+  for (int64_t layer = 0; layer < num_layers; layer++) {
+    for (int64_t direction = 0; direction < num_directions; direction++) {
+      layer_output[direction] = run_layer(
+          layer_input, layer * num_directions + direction, direction > 0);
+    }
+    layer_input = num_directions == 1
+        ? layer_output[0]
+        : at::cat(layer_output, /*output_channels*/ -1);
+  }
+  return layer_input;
+}
+
+void execute(
+    const dnnl::primitive& primitive,
+    const dnnl::primitive_desc& pd,
+    std::unordered_map<int, dnnl::memory> args) {
+  ideep::tensor scratchpad(pd.scratchpad_desc());
+  args.insert({DNNL_ARG_SCRATCHPAD, scratchpad});
+  primitive.execute(ideep::stream::default_stream(), args);
+}
+
+dnnl::rnn_direction get_direction(bool reverse) {
+  return reverse ? dnnl::rnn_direction::unidirectional_right2left
+                 : dnnl::rnn_direction::unidirectional_left2right;
+}
+
+// weights: (w_ih, w_hh, b_ih, b_hh), hx: [N, H]
+at::Tensor gru_layer(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& weights,
+    bool has_biases,
+    const at::Tensor& hx,
+    bool reverse,
+    at::Tensor& hy) {
+  int64_t T = input.size(0);
+  int64_t N = input.size(1);
+  int64_t I = input.size(2);
+  int64_t H = hx.size(-1);
+  auto dtype = get_mkldnn_dtype(input.scalar_type());
+  auto mode = ideep::rnn_kind::GRU;
+  auto hx_ = hx.to(input.scalar_type()).contiguous();
+  auto bias = fp32_bias(weights, has_biases, 4, H, mode);
+  auto output = at::empty({T, N, H}, input.options());
+  auto hy_ = at::empty({N, H}, input.options());
+
+  auto x = itensor_view_from_dense(input, {{T, N, I}, dtype, tag::tnc});
+  auto h0 = itensor_view_from_dense(hx_, {{1, 1, N, H}, dtype, tag::ldnc});
+  auto b = itensor_view_from_dense(
+      bias, {{1, 1, 4, H}, ideep::data_type::f32, tag::ldgo});
+  auto y = itensor_view_from_dense(output, {{T, N, H}, dtype, tag::tnc});
+  auto h1 = itensor_view_from_dense(hy_, {{1, 1, N, H}, dtype, tag::ldnc});
+
+  auto pd = dnnl::lbr_gru_forward::primitive_desc(
+      ideep::engine::cpu_engine(),
+      dnnl::prop_kind::forward_inference,
+      get_direction(reverse),
+      x.get_desc(),
+      h0.get_desc(),
+      any_desc({1, 1, I, 3, H}, dtype),
+      any_desc({1, 1, H, 3, H}, dtype),
+      b.get_desc(),
+      y.get_desc(),
+      h1.get_desc(),
+      ideep::attr_t(torch_ipex::fpmath_mode));
+  auto w1 = packed_weight(
+      weights[0],
+      _shuffle_weight(weights[0], static_cast<int64_t>(mode)),
+      {1, 1, I, 3, H},
+      tag::ldgoi,
+      pd.weights_layer_desc());
+  auto w2 = packed_weight(
+      weights[1],
+      _shuffle_weight(weights[1], static_cast<int64_t>(mode)),
+      {1, 1, H, 3, H},
+      tag::ldgoi,
+      pd.weights_iter_desc());
+  execute(
+      dnnl::lbr_gru_forward(pd),
+      pd,
+      {{DNNL_ARG_SRC_LAYER, x},
+       {DNNL_ARG_SRC_ITER, h0},
+       {DNNL_ARG_WEIGHTS_LAYER, w1},
+       {DNNL_ARG_WEIGHTS_ITER, w2},
+       {DNNL_ARG_BIAS, b},
+       {DNNL_ARG_DST_LAYER, y},
+       {DNNL_ARG_DST_ITER, h1}});
+  hy = hy_.to(hx.scalar_type());
+  return output;
+}
+
+// weights: (w_ih, w_hh, b_ih, b_hh, w_hr) or (w_ih, w_hh, w_hr), hx: [N, P],
+// cx: [N, H]
+at::Tensor lstm_projection_layer(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& weights,
+    bool has_biases,
+    const at::Tensor& hx,
+    const at::Tensor& cx,
+    bool reverse,
+    at::Tensor& hy,
+    at::Tensor& cy) {
+  int64_t T = input.size(0);
+  int64_t N = input.size(1);
+  int64_t I = input.size(2);
+  int64_t P = hx.size(-1);
+  int64_t H = cx.size(-1);
+  auto dtype = get_mkldnn_dtype(input.scalar_type());
+  auto f32 = ideep::data_type::f32;
+  const auto& weight_hr = weights.back();
+  auto hx_ = hx.to(input.scalar_type()).contiguous();
+  // oneDNN keeps the cell states in fp32
+  auto cx_ = cx.to(at::kFloat).contiguous();
+  auto bias = fp32_bias(weights, has_biases, 4, H, ideep::rnn_kind::LSTM);
+  auto output = at::empty({T, N, P}, input.options());
+  auto hy_ = at::empty({N, P}, input.options());
+  auto cy_ = at::empty({N, H}, cx_.options());
+
+  auto x = itensor_view_from_dense(input, {{T, N, I}, dtype, tag::tnc});
+  auto h0 = itensor_view_from_dense(hx_, {{1, 1, N, P}, dtype, tag::ldnc});
+  auto c0 = itensor_view_from_dense(cx_, {{1, 1, N, H}, f32, tag::ldnc});
+  auto b = itensor_view_from_dense(bias, {{1, 1, 4, H}, f32, tag::ldgo});
+  auto y = itensor_view_from_dense(output, {{T, N, P}, dtype, tag::tnc});
+  auto h1 = itensor_view_from_dense(hy_, {{1, 1, N, P}, dtype, tag::ldnc});
+  auto c1 = itensor_view_from_dense(cy_, {{1, 1, N, H}, f32, tag::ldnc});
+
+  auto pd = dnnl::lstm_forward::primitive_desc(
+      ideep::engine::cpu_engine(),
+      dnnl::prop_kind::forward_inference,
+      get_direction(reverse),
+      x.get_desc(),
+      h0.get_desc(),
+      c0.get_desc(),
+      any_desc({1, 1, I, 4, H}, dtype),
+      any_desc({1, 1, P, 4, H}, dtype),
+      /* weights_peephole_desc */ dnnl::memory::desc(),
+      any_desc({1, 1, H, P}, dtype),
+      b.get_desc(),
+      y.get_desc(),
+      h1.get_desc(),
+      c1.get_desc(),
+      ideep::attr_t(torch_ipex::fpmath_mode));
+  auto w1 = packed_weight(
+      weights[0],
+      weights[0].contiguous(),
+      {1, 1, I, 4, H},
+      tag::ldgoi,
+      pd.weights_layer_desc());
+  auto w2 = packed_weight(
+      weights[1],
+      weights[1].contiguous(),
+      {1, 1, P, 4, H},
+      tag::ldgoi,
+      pd.weights_iter_desc());
+  // weight_hr is [P, H], i.e. the oi of the ldio projection weight
+  auto w3 = packed_weight(
+      weight_hr,
+      weight_hr.contiguous(),
+      {1, 1, H, P},
+      tag::ldoi,
+      pd.weights_projection_desc());
+  execute(
+      dnnl::lstm_forward(pd),
+      pd,
+      {{DNNL_ARG_SRC_LAYER, x},
+       {DNNL_ARG_SRC_ITER, h0},
+       {DNNL_ARG_SRC_ITER_C, c0},
+       {DNNL_ARG_WEIGHTS_LAYER, w1},
+       {DNNL_ARG_WEIGHTS_ITER, w2},
+       {DNNL_ARG_WEIGHTS_PROJECTION, w3},
+       {DNNL_ARG_BIAS, b},
+       {DNNL_ARG_DST_LAYER, y},
+       {DNNL_ARG_DST_ITER, h1},
+       {DNNL_ARG_DST_ITER_C, c1}});
+  hy = hy_.to(hx.scalar_type());
+  cy = cy_.to(cx.scalar_type());
+  return output;
+}
+
+bool use_onednn_rnn(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& params,
+    bool train) {
+  auto dtype = input.scalar_type();
+  return !train && (dtype == at::kFloat || dtype == at::kBFloat16) &&
+      std::all_of(params.begin(), params.end(), [&](const at::Tensor& p) {
+           return p.scalar_type() == dtype;
+         });
+}
+
+} // anonymous namespace
+
+bool lstm_has_projections(const std::vector<at::Tensor>& hx) {
+  return hx.size() == 2 && hx[0].size(-1) != hx[1].size(-1);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_projection_inference(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& hx,
+    const std::vector<at::Tensor>& params,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional,
+    bool batch_first) {
+  RECORD_FUNCTION("lstm_projection_inference", c10::ArrayRef<c10::IValue>({}));
+
+  if (!use_onednn_rnn(input, params, /* train */ false)) {
+    return at::lstm(
+        input,
+        hx,
+        params,
+        has_biases,
+        num_layers,
+        0.,
+        false,
+        bidirectional,
+        batch_first);
+  }
+  int64_t stride = has_biases ? 5 : 3;
+  int64_t num_directions = bidirectional ? 2 : 1;
+  TORCH_CHECK(
+      static_cast<int64_t>(params.size()) ==
+          num_layers * num_directions * stride,
+      "lstm_projection_inference: unexpected number of parameters");
+  auto input_ = batch_first ? input.transpose(0, 1) : input;
+  std::vector<at::Tensor> layer_hy(num_layers * num_directions);
+  std::vector<at::Tensor> layer_cy(num_layers * num_directions);
+  auto output = run_layers(
+      input_.contiguous(),
+      num_layers,
+      bidirectional,
+      [&](const at::Tensor& layer_input, int64_t index, bool reverse) {
+        std::vector<at::Tensor> weights(
+            params.begin() + index * stride,
+            params.begin() + (index + 1) * stride);
+        return lstm_projection_layer(
+            layer_input,
+            weights,
+            has_biases,
+            hx[0][index],
+            hx[1][index],
+            reverse,
+            layer_hy[index],
+            layer_cy[index]);
+      });
+  if (batch_first) {
+    output = output.transpose(0, 1);
+  }
+  return std::make_tuple(output, at::stack(layer_hy), at::stack(layer_cy));
+}
+
+} // namespace cpu
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first) {
+  RECORD_FUNCTION("ipex_gru", c10::ArrayRef<c10::IValue>({}));
+
+#if defined(IPEX_DISP_OP)
+  printf("ipex_gru\n");
+#endif
+  if (!cpu::use_onednn_rnn(input, params, train)) {
+    return at::gru(
+        input,
+        hx,
+        params,
+        has_biases,
+        num_layers,
+        dropout_p,
+        train,
+        bidirectional,
+        batch_first);
+  }
+  int64_t stride = has_biases ? 4 : 2;
+  int64_t num_directions = bidirectional ? 2 : 1;
+  TORCH_CHECK(
+      static_cast<int64_t>(params.size()) ==
+          num_layers * num_directions * stride,
+      "ipex_gru: unexpected number of parameters");
+  auto input_ = batch_first ? input.transpose(0, 1) : input;
+  std::vector<at::Tensor> layer_hy(num_layers * num_directions);
+  auto output = cpu::run_layers(
+      input_.contiguous(),
+      num_layers,
+      bidirectional,
+      [&](const at::Tensor& layer_input, int64_t index, bool reverse) {
+        std::vector<at::Tensor> weights(
+            params.begin() + index * stride,
+            params.begin() + (index + 1) * stride);
+        return cpu::gru_layer(
+            layer_input,
+            weights,
+            has_biases,
+            hx[index],
+            reverse,
+            layer_hy[index]);
+      });
+  if (batch_first) {
+    output = output.transpose(0, 1);
+  }
+  return std::make_tuple(output, at::stack(layer_hy));
+}
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru_meta(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first) {
+  auto input_size = input.sym_sizes();
+  c10::SymDimVector output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(bidirectional ? hx.sym_size(2) * 2 : hx.sym_size(2));
+  auto output = at::empty_symint(output_size, input.options());
+  auto hy = at::empty_symint(hx.sym_sizes(), hx.options());
+  return std::make_tuple(output, hy);
+}
+
+} // namespace torch_ipex
+
+namespace torch_ipex {
+namespace autocast {
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op = torch::Dispatcher::singleton()
+                       .findSchemaOrThrow("torch_ipex::ipex_gru", "")
+                       .typed<decltype(ipex_gru)>();
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::autocast::ipex_gru\n");
+#endif
+  auto target_type = get_autocast_dtype();
+  // only have bf16 support now, keep fp32 for other target_type
+  bool cast_to_bfloat16 = at::kBFloat16 == target_type;
+  auto casted_input =
+      cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, input) : input;
+  auto casted_hx = cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, hx) : hx;
+  std::vector<at::Tensor> casted_params;
+  for (const auto& param : params) {
+    casted_params.emplace_back(
+        cast_to_bfloat16 ? cpu_cached_cast(at::kBFloat16, param) : param);
+  }
+  return op.call(
+      casted_input,
+      casted_hx,
+      casted_params,
+      has_biases,
+      num_layers,
+      dropout_p,
+      train,
+      bidirectional,
+      batch_first);
+}
+
+} // namespace autocast
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "ipex_gru(Tensor input, Tensor hx, Tensor[] params, bool has_biases, "
+      "int num_layers, float dropout_p, bool train, bool bidirectional, "
+      "bool batch_first) -> (Tensor, Tensor)");
+  m.impl(
+      "ipex_gru",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::ipex_gru);
+  m.impl("ipex_gru", c10::DispatchKey::CPU, torch_ipex::ipex_gru);
+  m.impl("ipex_gru", c10::DispatchKey::Meta, torch_ipex::ipex_gru_meta);
+}
+
+} // namespace
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <vector>
+
+namespace torch_ipex {
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first);
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru_meta(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first);
+
+namespace cpu {
+
+// Whether the states of ipex_lstm are the ones of a LSTM with projections,
+// whose hidden state is smaller than its cell state
+bool lstm_has_projections(const std::vector<at::Tensor>& hx);
+
+// Inference of a LSTM with projections, params holding (w_ih, w_hh, b_ih,
+// b_hh, w_hr) or (w_ih, w_hh, w_hr) per layer and direction as in
+// torch.nn.LSTM
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_projection_inference(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& hx,
+    const std::vector<at::Tensor>& params,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional,
+    bool batch_first);
+
+} // namespace cpu
+} // namespace torch_ipex
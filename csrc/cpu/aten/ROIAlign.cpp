@@ -12,6 +12,8 @@ namespace cpu {
 
 DEFINE_DISPATCH(roi_align_forward_kernel_stub);
 DEFINE_DISPATCH(roi_align_backward_kernel_stub);
+DEFINE_DISPATCH(multi_level_roi_align_forward_kernel_stub);
+DEFINE_DISPATCH(multi_level_roi_align_backward_kernel_stub);
 
 at::Tensor ROIAlign_forward_impl(
     const at::Tensor& input,
@@ -214,6 +216,248 @@ at::Tensor ROIAlign_forward_meta(
       {num_rois, channels, pooled_height, pooled_width}, input.options());
 }
 
+at::Tensor MultiLevelROIAlign_forward_impl(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::MultiLevelROIAlign_forward\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::MultiLevelROIAlign_forward",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      !features.empty() && features.size() == spatial_scales.size(),
+      "MultiLevelROIAlign: expects one spatial scale per feature level");
+  TORCH_CHECK(
+      rois.dim() == 2 && rois.size(1) == 5,
+      "rois must have shape as Tensor[K, 5]");
+  for (const auto& feature : features) {
+    TORCH_CHECK(
+        feature.dim() == 4 && feature.size(0) == features[0].size(0) &&
+            feature.size(1) == features[0].size(1) &&
+            feature.scalar_type() == features[0].scalar_type(),
+        "MultiLevelROIAlign: the feature levels must be [N, C, H, W] tensors "
+        "of the same batch, channels and dtype");
+  }
+
+  /*
+  pointer to multi_level_roi_align_forward_kernel_impl(
+      features,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level);
+  */
+  return multi_level_roi_align_forward_kernel_stub(
+      kCPU,
+      features,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level);
+}
+
+std::vector<at::Tensor> MultiLevelROIAlign_backward(
+    const at::Tensor& grad,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t batch_size,
+    int64_t channels,
+    at::IntArrayRef heights,
+    at::IntArrayRef widths,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level,
+    bool is_channels_last) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::MultiLevelROIAlign_backward\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::MultiLevelROIAlign_backward",
+      c10::ArrayRef<c10::IValue>({}));
+
+  /*
+  pointer to multi_level_roi_align_backward_kernel_impl(
+      grad,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      batch_size,
+      channels,
+      heights,
+      widths,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level,
+      is_channels_last);
+  */
+  return multi_level_roi_align_backward_kernel_stub(
+      kCPU,
+      grad,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      batch_size,
+      channels,
+      heights,
+      widths,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level,
+      is_channels_last);
+}
+
+at::Tensor IPEXMultiLevelROIAlignOp::forward(
+    torch::autograd::AutogradContext* ctx,
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+  RECORD_FUNCTION(
+      "IPEXMultiLevelROIAlignOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+  std::vector<int64_t> heights, widths;
+  for (const auto& feature : features) {
+    heights.push_back(feature.size(2));
+    widths.push_back(feature.size(3));
+  }
+  ctx->saved_data["batch_size"] = features[0].size(0);
+  ctx->saved_data["channels"] = features[0].size(1);
+  ctx->saved_data["heights"] = heights;
+  ctx->saved_data["widths"] = widths;
+  ctx->saved_data["spatial_scales"] = spatial_scales.vec();
+  ctx->saved_data["pooled_height"] = pooled_height;
+  ctx->saved_data["pooled_width"] = pooled_width;
+  ctx->saved_data["sampling_ratio"] = sampling_ratio;
+  ctx->saved_data["aligned"] = aligned;
+  ctx->saved_data["canonical_scale"] = canonical_scale;
+  ctx->saved_data["canonical_level"] = canonical_level;
+  ctx->saved_data["is_channels_last"] =
+      features[0].is_contiguous(at::MemoryFormat::ChannelsLast);
+  ctx->save_for_backward({rois});
+
+  at::AutoDispatchBelowADInplaceOrView g;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::MultiLevelROIAlign_forward", "")
+          .typed<decltype(MultiLevelROIAlign_forward)>();
+  return op.call(
+      features,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level);
+}
+
+torch::autograd::variable_list IPEXMultiLevelROIAlignOp::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::variable_list grad_outputs) {
+  RECORD_FUNCTION(
+      "IPEXMultiLevelROIAlignOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+  auto heights = ctx->saved_data["heights"].toIntVector();
+  auto widths = ctx->saved_data["widths"].toIntVector();
+  auto spatial_scales = ctx->saved_data["spatial_scales"].toDoubleVector();
+  auto saved = ctx->get_saved_variables();
+  at::Tensor rois = saved[0];
+
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::MultiLevelROIAlign_backward", "")
+          .typed<decltype(MultiLevelROIAlign_backward)>();
+  auto grad_inputs = op.call(
+      grad_outputs[0],
+      rois,
+      spatial_scales,
+      ctx->saved_data["pooled_height"].toInt(),
+      ctx->saved_data["pooled_width"].toInt(),
+      ctx->saved_data["batch_size"].toInt(),
+      ctx->saved_data["channels"].toInt(),
+      heights,
+      widths,
+      ctx->saved_data["sampling_ratio"].toInt(),
+      ctx->saved_data["aligned"].toBool(),
+      ctx->saved_data["canonical_scale"].toInt(),
+      ctx->saved_data["canonical_level"].toInt(),
+      ctx->saved_data["is_channels_last"].toBool());
+
+  // one gradient per feature level, then none for rois and the other args
+  torch::autograd::variable_list grads(grad_inputs.begin(), grad_inputs.end());
+  grads.resize(grad_inputs.size() + 8);
+  return grads;
+}
+
+at::Tensor MultiLevelROIAlign_forward(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+  if (at::GradMode::is_enabled()) {
+    return IPEXMultiLevelROIAlignOp::apply(
+        features,
+        rois,
+        spatial_scales,
+        pooled_height,
+        pooled_width,
+        sampling_ratio,
+        aligned,
+        canonical_scale,
+        canonical_level);
+  }
+  at::AutoDispatchBelowADInplaceOrView g;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::MultiLevelROIAlign_forward", "")
+          .typed<decltype(MultiLevelROIAlign_forward)>();
+  return op.call(
+      features,
+      rois,
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -253,6 +497,36 @@ at::Tensor ROIAlign_forward(
   }
 }
 
+at::Tensor MultiLevelROIAlign_forward(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::MultiLevelROIAlign_forward", "")
+          .typed<decltype(torch_ipex::cpu::MultiLevelROIAlign_forward)>();
+  auto input_type = features.empty() ? at::kFloat : features[0].scalar_type();
+  return op.call(
+      features,
+      cpu_cached_cast(
+          input_type == at::ScalarType::BFloat16 ? at::kFloat : input_type,
+          rois),
+      spatial_scales,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      canonical_scale,
+      canonical_level);
+}
+
 } // namespace autocast
 } // namespace torch_ipex
 
@@ -284,6 +558,33 @@ IPEX_TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "ROIAlign_backward",
       c10::DispatchKey::CPU,
       torch_ipex::cpu::ROIAlign_backward);
+  m.def(
+      "MultiLevelROIAlign_forward(Tensor[] features, Tensor rois, "
+      "float[] spatial_scales, int pooled_height, int pooled_width, "
+      "int sampling_ratio, bool aligned, int canonical_scale, "
+      "int canonical_level) -> Tensor");
+  m.impl(
+      "MultiLevelROIAlign_forward",
+      c10::DispatchKey::AutogradCPU,
+      torch_ipex::cpu::MultiLevelROIAlign_forward);
+  m.impl(
+      "MultiLevelROIAlign_forward",
+      c10::DispatchKey::AutocastCPU,
+      torch_ipex::autocast::MultiLevelROIAlign_forward);
+  m.impl(
+      "MultiLevelROIAlign_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::MultiLevelROIAlign_forward_impl);
+  m.def(
+      "MultiLevelROIAlign_backward(Tensor grad, Tensor rois, "
+      "float[] spatial_scales, int pooled_height, int pooled_width, "
+      "int batch_size, int channels, int[] heights, int[] widths, "
+      "int sampling_ratio, bool aligned, int canonical_scale, "
+      "int canonical_level, bool is_channels_last) -> Tensor[]");
+  m.impl(
+      "MultiLevelROIAlign_backward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::MultiLevelROIAlign_backward);
 }
 
 IPEX_TORCH_LIBRARY_FRAGMENT(torchvision, m) {
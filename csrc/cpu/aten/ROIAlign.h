@@ -76,6 +76,71 @@ at::Tensor ROIAlign_forward_meta(
     int64_t sampling_ratio,
     bool aligned);
 
+// Multi-level ROIAlign pools each roi from the FPN level it is assigned to,
+// features[l] having the spatial scale spatial_scales[l] of the consecutive
+// levels, in one parallel region over the rois of all the levels. Its
+// backward accumulates the rois of an image of a level a block of
+// multi_level_roi_align_channel_block channels at a time.
+const int64_t multi_level_roi_align_channel_block = 64;
+
+at::Tensor MultiLevelROIAlign_forward_impl(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level);
+
+std::vector<at::Tensor> MultiLevelROIAlign_backward(
+    const at::Tensor& grad,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t batch_size,
+    int64_t channels,
+    at::IntArrayRef heights,
+    at::IntArrayRef widths,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level,
+    bool is_channels_last);
+
+class IPEXMultiLevelROIAlignOp
+    : public torch::autograd::Function<IPEXMultiLevelROIAlignOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      at::TensorList features,
+      const at::Tensor& rois,
+      c10::ArrayRef<double> spatial_scales,
+      int64_t pooled_height,
+      int64_t pooled_width,
+      int64_t sampling_ratio,
+      bool aligned,
+      int64_t canonical_scale,
+      int64_t canonical_level);
+
+  static torch::autograd::variable_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::variable_list grad_outputs);
+};
+
+at::Tensor MultiLevelROIAlign_forward(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level);
+
 namespace {
 
 template <typename T>
@@ -220,6 +285,33 @@ at::Tensor roi_align_backward_kernel_impl(
     bool aligned,
     bool is_channels_last);
 
+at::Tensor multi_level_roi_align_forward_kernel_impl(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level);
+
+std::vector<at::Tensor> multi_level_roi_align_backward_kernel_impl(
+    const at::Tensor& grad,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t batch_size,
+    int64_t channels,
+    at::IntArrayRef heights,
+    at::IntArrayRef widths,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level,
+    bool is_channels_last);
+
 } // namespace
 
 using roi_align_forward_kernel_fn = at::Tensor (*)(
@@ -247,5 +339,38 @@ using roi_align_backward_kernel_fn = at::Tensor (*)(
     bool);
 DECLARE_DISPATCH(roi_align_backward_kernel_fn, roi_align_backward_kernel_stub);
 
+using multi_level_roi_align_forward_kernel_fn = at::Tensor (*)(
+    at::TensorList,
+    const at::Tensor&,
+    c10::ArrayRef<double>,
+    int64_t,
+    int64_t,
+    int64_t,
+    bool,
+    int64_t,
+    int64_t);
+DECLARE_DISPATCH(
+    multi_level_roi_align_forward_kernel_fn,
+    multi_level_roi_align_forward_kernel_stub);
+
+using multi_level_roi_align_backward_kernel_fn = std::vector<at::Tensor> (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    c10::ArrayRef<double>,
+    int64_t,
+    int64_t,
+    int64_t,
+    int64_t,
+    at::IntArrayRef,
+    at::IntArrayRef,
+    int64_t,
+    bool,
+    int64_t,
+    int64_t,
+    bool);
+DECLARE_DISPATCH(
+    multi_level_roi_align_backward_kernel_fn,
+    multi_level_roi_align_backward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <ATen/ATen.h>
+
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/ReduceOpsUtils.h>
+#include <ATen/record_function.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Reduce.h"
+#include "utils/library.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(reduce_kernel_stub);
+
+bool plan_reduction(
+    const at::Tensor& input,
+    at::IntArrayRef dims,
+    ReducePlan& plan) {
+  std::vector<bool> reduced(input.dim(), false);
+  for (auto d : dims) {
+    // the duplicated dims are reported by ATen
+    if (reduced[d]) {
+      return false;
+    }
+    reduced[d] = true;
+  }
+
+  // the dims of more than one element in the memory order, which are dense
+  std::vector<int64_t> order;
+  for (int64_t d = 0; d < input.dim(); d++) {
+    if (input.size(d) != 1) {
+      order.push_back(d);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return input.stride(a) > input.stride(b);
+  });
+  int64_t expected_stride = 1;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    if (input.stride(*it) != expected_stride) {
+      return false;
+    }
+    expected_stride *= input.size(*it);
+  }
+
+  // [kept, reduced, kept], the kept dims in the logical order
+  plan = ReducePlan();
+  bool after_reduced = false;
+  int64_t last_kept = -1;
+  for (auto d : order) {
+    if (reduced[d]) {
+      if (after_reduced && plan.N > 1) {
+        return false;
+      }
+      after_reduced = true;
+      plan.R *= input.size(d);
+    } else {
+      if (d < last_kept) {
+        return false;
+      }
+      last_kept = d;
+      (after_reduced ? plan.N : plan.M) *= input.size(d);
+    }
+  }
+  return plan.R > 1;
+}
+
+at::Tensor reduce_with_engine(
+    const at::Tensor& input,
+    at::IntArrayRef dims,
+    bool keepdim,
+    at::ScalarType out_dtype,
+    ReducePostOp post_op,
+    double correction) {
+  auto in_dtype = input.scalar_type();
+  if ((in_dtype != at::kFloat && in_dtype != at::kBFloat16) ||
+      (out_dtype != in_dtype && out_dtype != at::kFloat) ||
+      input.dim() == 0 || input.numel() == 0 || input.has_names()) {
+    return at::Tensor();
+  }
+  ReducePlan plan;
+  if (!plan_reduction(input, dims, plan)) {
+    return at::Tensor();
+  }
+  // the variance of too few elements is nan or inf, as ATen reports it
+  if (post_op == ReducePostOp::Var && plan.R - correction <= 0) {
+    return at::Tensor();
+  }
+
+  auto shape = at::meta::get_reduction_shape(input, dims, keepdim);
+  at::Tensor output = at::empty(shape, input.options().dtype(out_dtype));
+  reduce_kernel_stub(kCPU, input, output, plan, post_op, correction);
+  return output;
+}
+
+at::Tensor var_correction_impl(
+    const at::Tensor& input,
+    at::OptionalIntArrayRef dim_opt,
+    const c10::optional<at::Scalar>& correction_opt,
+    bool keepdim) {
+  RECORD_FUNCTION(
+      "torch_ipex::var_correction_impl", c10::ArrayRef<c10::IValue>({}));
+
+  double correction =
+      correction_opt.has_value() ? correction_opt->toDouble() : 1;
+  at::DimVector dims = at::native::make_dim_vector(dim_opt, input.dim());
+  at::maybe_wrap_dims(dims, input.dim());
+  auto output = reduce_with_engine(
+      input,
+      dims,
+      keepdim,
+      input.scalar_type(),
+      ReducePostOp::Var,
+      correction);
+  if (output.defined()) {
+    return output;
+  }
+  return at::native::var(input, dim_opt, correction_opt, keepdim);
+}
+
+IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::var.correction"),
+      TORCH_FN((&torch_ipex::cpu::var_correction_impl)));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
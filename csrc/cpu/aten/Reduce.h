@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The post-op applied to the fp32 sums of the reduced elements
+enum class ReducePostOp { Sum, Mean, Var };
+
+// A dense input whose dims, in the memory order, coalesce to [M, R, N], the R
+// elements in the middle being reduced, e.g. the spatial dims of a
+// channels-last activation (M = batch, R = H * W, N = channels), or the last
+// dims of a contiguous one (N = 1).
+struct ReducePlan {
+  int64_t M = 1;
+  int64_t R = 1;
+  int64_t N = 1;
+};
+
+namespace {
+
+void reduce_kernel_impl(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const ReducePlan& plan,
+    ReducePostOp post_op,
+    double correction);
+
+}
+
+using reduce_kernel_fn = void (*)(
+    const at::Tensor&,
+    at::Tensor&,
+    const ReducePlan&,
+    ReducePostOp,
+    double);
+DECLARE_DISPATCH(reduce_kernel_fn, reduce_kernel_stub);
+
+// Plans the reduction of "dims" of "input", false if input is not dense, if
+// its reduced dims are not adjacent in memory or if its kept dims are not in
+// the memory order, the output being contiguous.
+bool plan_reduction(
+    const at::Tensor& input,
+    at::IntArrayRef dims,
+    ReducePlan& plan);
+
+// The reduction of "dims" of a float or bfloat16 input by the [M, R, N]
+// engine, accumulated in fp32, or an undefined tensor if the engine does not
+// apply and the caller falls back to ATen. "correction" is the one of the
+// variance.
+at::Tensor reduce_with_engine(
+    const at::Tensor& input,
+    at::IntArrayRef dims,
+    bool keepdim,
+    at::ScalarType out_dtype,
+    ReducePostOp post_op,
+    double correction = 0);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,168 @@
+#include "RnntGreedyDecode.h"
+#include <torch/all.h>
+
+#include "RnntEmbedding.h"
+#include "UpdateBatch.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+std::tuple<at::Tensor, at::Tensor> rnnt_greedy_decode(
+    const at::Tensor& x,
+    const at::Tensor& out_lens,
+    const at::Tensor& embedding_weight,
+    std::vector<at::Tensor> pred_lstm_params,
+    const at::Tensor& joint_enc_weight,
+    const c10::optional<at::Tensor>& joint_enc_bias,
+    const at::Tensor& joint_pred_weight,
+    const c10::optional<at::Tensor>& joint_pred_bias,
+    const at::Tensor& joint_fc_weight,
+    const c10::optional<at::Tensor>& joint_fc_bias,
+    int64_t blank_id,
+    int64_t max_symbols,
+    int64_t _SOS) {
+#if defined(IPEX_DISP_OP)
+  printf("IPEX::rnnt_greedy_decode\n");
+#endif
+  RECORD_FUNCTION("IPEX::rnnt_greedy_decode", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      x.dim() == 3, "rnnt_greedy_decode expects a [T, B, F] encoder output");
+  TORCH_CHECK(
+      !pred_lstm_params.empty() && pred_lstm_params.size() % 4 == 0,
+      "rnnt_greedy_decode expects (w_ih, w_hh, b_ih, b_hh) of each predictor "
+      "LSTM layer");
+  TORCH_CHECK(
+      embedding_weight.scalar_type() == at::kFloat ||
+          embedding_weight.scalar_type() == at::kBFloat16,
+      "rnnt_greedy_decode only supports float and bfloat16 predictors");
+  int64_t max_len = x.size(0);
+  int64_t batch_size = x.size(1);
+  int64_t num_layers = pred_lstm_params.size() / 4;
+  int64_t embedding_dim = embedding_weight.size(1);
+  int64_t pred_n_hidden = pred_lstm_params[1].size(1);
+  auto dtype = embedding_weight.scalar_type();
+  auto int_options = x.options().dtype(at::kInt);
+  auto long_options = x.options().dtype(at::kLong);
+
+  // The encoder projection of the joint only depends on the time step, it is
+  // computed for the whole sequence at once, time major as rnnt_update_batch
+  // fetches the features. x_ is its [B, T, J] view and f the features of the
+  // current time steps.
+  auto x_proj = at::linear(x.to(dtype), joint_enc_weight, joint_enc_bias)
+                    .contiguous();
+  auto x_ = x_proj.transpose(0, 1);
+  auto f = x_proj[0].clone();
+
+  auto out_lens_ = out_lens.to(at::kInt);
+  auto time_idxs = at::zeros({batch_size}, int_options);
+  auto label_col = at::zeros({batch_size}, int_options);
+  auto symbols_added = at::zeros({batch_size}, int_options);
+  auto blankness = at::zeros({batch_size}, int_options);
+  auto blank_vec = at::zeros({batch_size}, int_options);
+  auto not_blank = at::zeros({batch_size}, int_options);
+  auto label_to_put = at::zeros({batch_size}, long_options);
+  auto label_tensor =
+      at::full({batch_size, max_len * max_symbols}, _SOS, long_options);
+  auto label_for_next_loop = at::full({batch_size}, _SOS, long_options);
+  auto hidden_0 = at::zeros(
+      {num_layers, batch_size, pred_n_hidden}, x.options().dtype(dtype));
+  auto hidden_1 = at::zeros_like(hidden_0);
+  auto y = at::empty(
+      {batch_size, 1, embedding_dim}, x.options().dtype(dtype));
+
+  while (true) {
+    // the predictor step of the labels of the previous loop
+    /*
+    pointer to torch_ipex::cpu::rnnt_embedding_kernel_impl(
+        embedding_weight, label_for_next_loop, y, _SOS, batch_size,
+        embedding_dim);
+    */
+    rnnt_embedding_kernel_stub(
+        kCPU,
+        embedding_weight,
+        label_for_next_loop,
+        y,
+        _SOS,
+        batch_size,
+        embedding_dim);
+    auto g = y.view({batch_size, embedding_dim});
+    std::vector<at::Tensor> hy, cy;
+    for (int64_t l = 0; l < num_layers; l++) {
+      auto state = at::lstm_cell(
+          g,
+          {hidden_0[l], hidden_1[l]},
+          pred_lstm_params[4 * l],
+          pred_lstm_params[4 * l + 1],
+          pred_lstm_params[4 * l + 2],
+          pred_lstm_params[4 * l + 3]);
+      g = std::get<0>(state);
+      hy.push_back(g);
+      cy.push_back(std::get<1>(state));
+    }
+    auto hidden_prime_0 = at::stack(hy);
+    auto hidden_prime_1 = at::stack(cy);
+
+    // the joint step and the most likely symbol
+    auto joint = at::relu_(
+        f + at::linear(g, joint_pred_weight, joint_pred_bias));
+    auto k = at::linear(joint, joint_fc_weight, joint_fc_bias).argmax(-1);
+
+    /*
+    pointer to torch_ipex::cpu::rnnt_update_batch_kernel_impl(
+        k, out_lens_, label_col, symbols_added, time_idxs, blankness,
+        blank_vec, not_blank, label_to_put, label_tensor, label_for_next_loop,
+        hidden_0, hidden_1, hidden_prime_0, hidden_prime_1, x_, f,
+        max_symbols, blank_id, batch_size, _SOS, max_len);
+    */
+    bool finished = rnnt_update_batch_kernel_stub(
+        kCPU,
+        k,
+        out_lens_,
+        label_col,
+        symbols_added,
+        time_idxs,
+        blankness,
+        blank_vec,
+        not_blank,
+        label_to_put,
+        label_tensor,
+        label_for_next_loop,
+        hidden_0,
+        hidden_1,
+        hidden_prime_0,
+        hidden_prime_1,
+        x_,
+        f,
+        max_symbols,
+        blank_id,
+        batch_size,
+        _SOS,
+        max_len);
+    if (finished == BatchStatus::Finished) {
+      break;
+    }
+  }
+  return std::make_tuple(label_tensor, label_col);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "rnnt_greedy_decode(Tensor x, Tensor out_lens, Tensor embedding_weight, "
+      "Tensor[] pred_lstm_params, Tensor joint_enc_weight, "
+      "Tensor? joint_enc_bias, Tensor joint_pred_weight, "
+      "Tensor? joint_pred_bias, Tensor joint_fc_weight, "
+      "Tensor? joint_fc_bias, int blank_id, int max_symbols, int _SOS) -> "
+      "(Tensor, Tensor)");
+  m.impl(
+      "rnnt_greedy_decode",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::rnnt_greedy_decode);
+}
+
+} // namespace
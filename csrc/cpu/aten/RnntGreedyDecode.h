@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+/*
+  rnnt_greedy_decode: the batched greedy decoder of RNN-T, running the loop
+  over the time steps and the symbols of the batch in C++.
+
+  x: the encoder output, [max_len, batch_size, encoder_n_hidden]
+  out_lens: valid time steps of x, [batch_size]
+  embedding_weight: the predictor embedding, [vocab_size - 1, pred_n_hidden]
+  pred_lstm_params: (w_ih, w_hh, b_ih, b_hh) of each predictor LSTM layer
+  joint_enc_*, joint_pred_*: the projections of the encoder and predictor
+    outputs to the joint hidden size, summed and passed through a ReLU
+  joint_fc_*: the projection of the joint hidden to the vocab logits
+
+  Returns (label_tensor, label_col): the labels of sample i are
+  label_tensor[i, 1 : label_col[i] + 1].
+*/
+std::tuple<at::Tensor, at::Tensor> rnnt_greedy_decode(
+    const at::Tensor& x,
+    const at::Tensor& out_lens,
+    const at::Tensor& embedding_weight,
+    std::vector<at::Tensor> pred_lstm_params,
+    const at::Tensor& joint_enc_weight,
+    const c10::optional<at::Tensor>& joint_enc_bias,
+    const at::Tensor& joint_pred_weight,
+    const c10::optional<at::Tensor>& joint_pred_bias,
+    const at::Tensor& joint_fc_weight,
+    const c10::optional<at::Tensor>& joint_fc_bias,
+    int64_t blank_id,
+    int64_t max_symbols,
+    int64_t _SOS);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,173 @@
+#include "RotaryPositionEmbedding.h"
+#include <torch/all.h>
+
+#include <map>
+#include <mutex>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(rotary_embedding_qkv_kernel_stub);
+DEFINE_DISPATCH(apply_rotary_emb_kernel_stub);
+
+namespace {
+
+// cos/sin tables of [capacity, rotary_dim / 2] per (rotary_dim, base),
+// computed as the HF rotary embedding does (fp32 inv_freq and positions).
+// A table is only replaced by a larger one, the tensors handed out stay
+// valid while they are in use.
+class RotaryEmbeddingCache {
+ public:
+  static RotaryEmbeddingCache& get_instance() {
+    static RotaryEmbeddingCache cache;
+    return cache;
+  }
+
+  std::pair<at::Tensor, at::Tensor> get(
+      int64_t rotary_dim,
+      double base,
+      int64_t max_position) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& tables = tables_[std::make_pair(rotary_dim, base)];
+    if (!tables.first.defined() || tables.first.size(0) <= max_position) {
+      int64_t capacity = 2048;
+      while (capacity <= max_position) {
+        capacity *= 2;
+      }
+      auto inv_freq = at::reciprocal(at::pow(
+          base, at::arange(0, rotary_dim, 2, at::kFloat) / rotary_dim));
+      auto freqs = at::outer(at::arange(capacity, at::kFloat), inv_freq);
+      tables = std::make_pair(freqs.cos(), freqs.sin());
+    }
+    return tables;
+  }
+
+ private:
+  RotaryEmbeddingCache() = default;
+  std::mutex mutex_;
+  std::map<std::pair<int64_t, double>, std::pair<at::Tensor, at::Tensor>>
+      tables_;
+};
+
+// cos/sin of the dtype of x and broadcast to the shape of x, so the fused
+// op gives the shape and dtype of the composed ops
+bool rotary_table_fits(const at::Tensor& table, const at::Tensor& x) {
+  if (table.scalar_type() != x.scalar_type() || table.dim() > x.dim() ||
+      table.dim() == 0 || table.size(-1) != x.size(-1)) {
+    return false;
+  }
+  for (int64_t d = 1; d <= table.dim(); d++) {
+    if (table.size(-d) != 1 && table.size(-d) != x.size(-d)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+at::Tensor rotary_embedding_qkv(
+    at::Tensor& qkv,
+    const at::Tensor& position_ids,
+    int64_t num_heads,
+    int64_t num_kv_heads,
+    int64_t head_size,
+    int64_t rotary_dim,
+    double base) {
+  RECORD_FUNCTION(
+      "torch_ipex::rotary_embedding_qkv", c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      rotary_dim > 0 && rotary_dim <= head_size && rotary_dim % 2 == 0,
+      "rotary_embedding_qkv: expect an even rotary_dim <= head_size");
+  TORCH_CHECK(
+      qkv.size(-1) == (num_heads + 2 * num_kv_heads) * head_size,
+      "rotary_embedding_qkv: expect qkv of (num_heads + 2 * num_kv_heads) * head_size in the last dim");
+  TORCH_CHECK(
+      position_ids.numel() == qkv.numel() / qkv.size(-1),
+      "rotary_embedding_qkv: expect one position per token");
+  auto positions = position_ids.to(at::kLong).contiguous();
+  int64_t max_position =
+      positions.numel() > 0 ? positions.max().item<int64_t>() : 0;
+  TORCH_CHECK(
+      positions.numel() == 0 || positions.min().item<int64_t>() >= 0,
+      "rotary_embedding_qkv: expect non-negative positions");
+  auto tables = RotaryEmbeddingCache::get_instance().get(
+      rotary_dim, base, max_position);
+  /*
+  pointer to rotary_embedding_qkv_kernel_impl(
+      qkv, positions, cos_table, sin_table, num_heads, num_kv_heads,
+      head_size, rotary_dim);
+  */
+  rotary_embedding_qkv_kernel_stub(
+      kCPU,
+      qkv,
+      positions,
+      tables.first,
+      tables.second,
+      num_heads,
+      num_kv_heads,
+      head_size,
+      rotary_dim);
+  return qkv;
+}
+
+at::Tensor apply_rotary_emb(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin) {
+  RECORD_FUNCTION(
+      "torch_ipex::apply_rotary_emb", c10::ArrayRef<c10::IValue>({}));
+  /*
+  pointer to apply_rotary_emb_kernel_impl(x, cos, sin);
+  */
+  return apply_rotary_emb_kernel_stub(kCPU, x, cos, sin);
+}
+
+at::Tensor dil_apply_rotary_emb(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin,
+    int64_t dim,
+    int64_t cat_dim,
+    int64_t x1_end,
+    int64_t x2_start) {
+  RECORD_FUNCTION("dil_apply_rotary_emb", c10::ArrayRef<c10::IValue>({}));
+  int64_t last_dim = x.dim() - 1;
+  int64_t size = x.dim() > 0 ? x.size(-1) : 0;
+  if (dim < 0) {
+    dim += x.dim();
+  }
+  if (cat_dim < 0) {
+    cat_dim += x.dim();
+  }
+  if (dim == last_dim && cat_dim == last_dim && size % 2 == 0 &&
+      x1_end == size / 2 && x2_start == size / 2 &&
+      rotary_table_fits(cos, x) && rotary_table_fits(sin, x)) {
+    return apply_rotary_emb(x, cos, sin);
+  }
+  auto x1 = x.slice(dim, 0, x1_end);
+  auto x2 = x.slice(dim, x2_start);
+  auto rotated = at::cat({at::neg(x2), x1}, cat_dim);
+  return at::add(at::mul(x, cos), at::mul(rotated, sin));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "rotary_embedding_qkv(Tensor(a!) qkv, Tensor position_ids, int num_heads, int num_kv_heads, int head_size, int rotary_dim, float base=10000.) -> Tensor(a!)");
+  m.impl(
+      "rotary_embedding_qkv",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::rotary_embedding_qkv);
+  m.def("apply_rotary_emb(Tensor x, Tensor cos, Tensor sin) -> Tensor");
+  m.impl(
+      "apply_rotary_emb",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::apply_rotary_emb);
+}
+
+} // namespace
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Rotary position embedding (rotate-half / GPT-NeoX style) applied in place
+// on the packed QKV output of a linear:
+//   qkv: [..., (num_heads + 2 * num_kv_heads) * head_size], one token per
+//     row, the query heads first, then the key heads and the value heads.
+//   position_ids: one position per token (row).
+// The first rotary_dim elements of every query and key head are rotated,
+// the value heads are untouched. The cos/sin tables of (rotary_dim, base)
+// are cached and grown to the max position seen.
+at::Tensor rotary_embedding_qkv(
+    at::Tensor& qkv,
+    const at::Tensor& position_ids,
+    int64_t num_heads,
+    int64_t num_kv_heads,
+    int64_t head_size,
+    int64_t rotary_dim,
+    double base);
+
+// x * cos + rotate_half(x) * sin, rotate_half(x) = cat(-x2, x1) of the two
+// halves of the last dim. cos/sin are broadcast to x.
+at::Tensor apply_rotary_emb(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin);
+
+// The JIT fused op of the rotate-half pattern, the halves are checked at
+// runtime (the slice bounds of the pattern are not constants when traced),
+// other slicing falls back to the composed ops.
+at::Tensor dil_apply_rotary_emb(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin,
+    int64_t dim,
+    int64_t cat_dim,
+    int64_t x1_end,
+    int64_t x2_start);
+
+namespace {
+
+void rotary_embedding_qkv_kernel_impl(
+    at::Tensor& qkv,
+    const at::Tensor& position_ids,
+    const at::Tensor& cos_table,
+    const at::Tensor& sin_table,
+    int64_t num_heads,
+    int64_t num_kv_heads,
+    int64_t head_size,
+    int64_t rotary_dim);
+
+at::Tensor apply_rotary_emb_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin);
+} // namespace
+
+using rotary_embedding_qkv_kernel_fn = void (*)(
+    at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    int64_t,
+    int64_t);
+
+using apply_rotary_emb_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&, const at::Tensor&);
+
+DECLARE_DISPATCH(
+    rotary_embedding_qkv_kernel_fn,
+    rotary_embedding_qkv_kernel_stub);
+DECLARE_DISPATCH(apply_rotary_emb_kernel_fn, apply_rotary_emb_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
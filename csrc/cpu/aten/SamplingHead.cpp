@@ -0,0 +1,151 @@
+#include "SamplingHead.h"
+
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/core/DistributionsHelper.h>
+#include <ATen/record_function.h>
+#include <c10/util/irange.h>
+#include <torch/library.h>
+
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "Cumsum.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(sampling_head_topk_kernel_stub);
+
+namespace {
+
+// The largest top_k of the per thread heaps, beyond which the full vocab is
+// sorted
+constexpr int64_t kSamplingHeadMaxTopK = 1024;
+
+bool use_sampling_head_kernel(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    int64_t top_k) {
+  const auto dtype = hidden.scalar_type();
+  return top_k > 0 && top_k <= kSamplingHeadMaxTopK &&
+      top_k <= weight.size(0) && hidden.dim() == 2 && weight.dim() == 2 &&
+      hidden.size(1) == weight.size(1) && weight.scalar_type() == dtype &&
+      (dtype == at::kFloat || dtype == at::kBFloat16);
+}
+
+// Samples a token of every row of the [batch, n] logits sorted in descending
+// order, whose tokens are indices
+at::Tensor sample_sorted_logits(
+    const at::Tensor& values,
+    const at::Tensor& indices,
+    double temperature,
+    double top_p) {
+  const int64_t batch = values.size(0), n = values.size(1);
+  if (temperature <= 0 || n == 1) {
+    return indices.select(1, 0).contiguous();
+  }
+  auto probs = at::softmax(values / temperature, 1).contiguous();
+  if (top_p < 1) {
+    // the smallest prefix whose probability reaches top_p, the top token
+    // being always kept
+    at::Tensor cum = at::empty_like(probs);
+    /*
+    pointer to cumsum_kernel_impl(cum, probs, 1, c10::nullopt);
+    */
+    cumsum_kernel_stub(kCPU, cum, probs, 1, c10::nullopt);
+    probs.masked_fill_((cum - probs) >= top_p, 0);
+  }
+
+  std::vector<double> uniforms(batch);
+  {
+    auto gen = at::get_generator_or_default<at::CPUGeneratorImpl>(
+        c10::nullopt, at::detail::getDefaultCPUGenerator());
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    at::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (const auto r : c10::irange(batch)) {
+      uniforms[r] = uniform(gen);
+    }
+  }
+  auto tokens = at::empty({batch}, indices.options());
+  const float* probs_data = probs.data_ptr<float>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  int64_t* tokens_data = tokens.data_ptr<int64_t>();
+  for (const auto r : c10::irange(batch)) {
+    const float* p = probs_data + r * n;
+    double total = 0;
+    for (const auto i : c10::irange(n)) {
+      total += p[i];
+    }
+    const double u = uniforms[r] * total;
+    double acc = 0;
+    // the last kept token for the rounding of a u close to the total
+    int64_t pick = 0;
+    for (const auto i : c10::irange(n)) {
+      if (p[i] <= 0) {
+        continue;
+      }
+      pick = i;
+      acc += p[i];
+      if (u < acc) {
+        break;
+      }
+    }
+    tokens_data[r] = indices_data[r * n + pick];
+  }
+  return tokens;
+}
+
+} // anonymous namespace
+
+at::Tensor sampling_head(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    double temperature,
+    int64_t top_k,
+    double top_p) {
+  RECORD_FUNCTION("torch_ipex::sampling_head", c10::ArrayRef<c10::IValue>({}));
+
+  auto hidden_ = hidden.reshape({-1, hidden.size(-1)});
+  at::Tensor values, indices;
+  if (use_sampling_head_kernel(hidden_, weight, top_k)) {
+    auto h = hidden_.contiguous();
+    auto w = weight.contiguous();
+    auto b = bias.has_value() && bias->defined()
+        ? bias->to(at::kFloat).contiguous()
+        : at::Tensor();
+    values = at::empty({h.size(0), top_k}, h.options().dtype(at::kFloat));
+    indices = at::empty({h.size(0), top_k}, h.options().dtype(at::kLong));
+    /*
+    pointer to sampling_head_topk_kernel_impl(h, w, b, top_k, values,
+    indices);
+    */
+    sampling_head_topk_kernel_stub(kCPU, h, w, b, top_k, values, indices);
+  } else {
+    auto logits = at::linear(hidden_, weight, bias).to(at::kFloat);
+    const int64_t k = top_k > 0 ? std::min(top_k, logits.size(1))
+                                : logits.size(1);
+    std::tie(values, indices) = at::topk(logits, k, 1);
+    values = values.contiguous();
+    indices = indices.contiguous();
+  }
+  auto tokens = sample_sorted_logits(values, indices, temperature, top_p);
+  std::vector<int64_t> sizes(hidden.sizes().begin(), hidden.sizes().end() - 1);
+  return tokens.view(sizes);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "sampling_head(Tensor hidden, Tensor weight, Tensor? bias, float temperature=1.0, int top_k=0, float top_p=1.0) -> Tensor");
+  m.impl(
+      "sampling_head", c10::DispatchKey::CPU, torch_ipex::cpu::sampling_head);
+}
+
+} // namespace
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * The sampling head of a decode step: the next token of every row of hidden
+ * [batch, K], sampled from softmax(linear(hidden, weight, bias) / temperature)
+ * restricted to the top_k logits and then to the smallest set of them whose
+ * probability reaches top_p, or the top logit for a temperature of 0. The
+ * logits of the [vocab, K] weight are computed tile by tile by the threads,
+ * each keeping a running top_k heap per row, so that the [batch, vocab]
+ * logits are neither materialized nor sorted. A top_k of 0 (no top_k
+ * filtering) and the unsupported inputs fall back to the aten ops over the
+ * full vocab. Returns the [batch] int64 tokens, drawn from the default CPU
+ * generator.
+ * */
+at::Tensor sampling_head(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    double temperature,
+    int64_t top_k,
+    double top_p);
+
+namespace {
+
+void sampling_head_topk_kernel_impl(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t k,
+    at::Tensor& values,
+    at::Tensor& indices);
+}
+
+// values [batch, k] (float) and indices [batch, k] (int64) of the k largest
+// logits of every row of linear(hidden, weight, bias) in descending order, of
+// contiguous float or bfloat16 hidden [batch, K] and weight [vocab, K] of a
+// same dtype, and an undefined or float [vocab] bias
+using sampling_head_topk_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(sampling_head_topk_kernel_fn, sampling_head_topk_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
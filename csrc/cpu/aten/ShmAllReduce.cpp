@@ -0,0 +1,220 @@
+#include "ShmAllReduce.h"
+
+#include <ATen/record_function.h>
+#include <c10/util/irange.h>
+#include <torch/library.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__))
+#include "ATen/native/cpu/Intrinsics.h"
+#else
+#define _mm_pause()
+#endif
+
+#include "utils/op_stats.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(shm_reduce_kernel_stub);
+
+namespace {
+
+constexpr int64_t kShmMaxRanks = 64;
+// The bytes of the buffer of a rank, the larger tensors being reduced by
+// slices of it
+constexpr int64_t kShmSliceBytes = 1 << 20;
+
+// A flag of its own cache line, so that the spinning ranks don't bounce the
+// line written by another rank
+struct alignas(64) ShmFlag {
+  std::atomic<int64_t> value;
+};
+
+// ready[r] is the last slice copied into the buffer of rank r, done[r] the
+// last slice rank r has summed
+struct ShmHeader {
+  ShmFlag ready[kShmMaxRanks];
+  ShmFlag done[kShmMaxRanks];
+};
+
+struct ShmState {
+  std::mutex mutex;
+  void* base = nullptr;
+  size_t bytes = 0;
+  int64_t rank = 0;
+  int64_t world_size = 0;
+  // the slices reduced so far
+  int64_t step = 0;
+
+  ShmHeader* header() {
+    return static_cast<ShmHeader*>(base);
+  }
+
+  // the buffers follow the header, [2][world_size][kShmSliceBytes]
+  char* buffer(int64_t parity, int64_t r) {
+    return static_cast<char*>(base) + sizeof(ShmHeader) +
+        (parity * world_size + r) * kShmSliceBytes;
+  }
+};
+
+ShmState& shm_state() {
+  static ShmState state;
+  return state;
+}
+
+inline void spin_wait(const ShmFlag& flag, int64_t value) {
+  while (flag.value.load(std::memory_order_acquire) < value) {
+    _mm_pause();
+  }
+}
+
+inline std::string shm_path(const std::string& name) {
+  return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+} // anonymous namespace
+
+void shm_all_reduce_init(
+    const std::string& name,
+    int64_t rank,
+    int64_t world_size) {
+  TORCH_CHECK(
+      world_size >= 1 && world_size <= kShmMaxRanks,
+      "shm_all_reduce_init: world size of 1 to ",
+      kShmMaxRanks,
+      " ranks expected, got ",
+      world_size);
+  TORCH_CHECK(
+      rank >= 0 && rank < world_size,
+      "shm_all_reduce_init: rank ",
+      rank,
+      " out of the world size ",
+      world_size);
+  auto& state = shm_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.base != nullptr) {
+    munmap(state.base, state.bytes);
+    state.base = nullptr;
+  }
+
+  const auto path = shm_path(name);
+  const size_t bytes = sizeof(ShmHeader) + 2 * world_size * kShmSliceBytes;
+  int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0600);
+  TORCH_CHECK(
+      fd >= 0,
+      "shm_all_reduce_init: shm_open of ",
+      path,
+      " failed: ",
+      std::strerror(errno));
+  // the ranks size the segment alike, its new bytes being zero filled
+  if (ftruncate(fd, bytes) != 0) {
+    const int err = errno;
+    close(fd);
+    TORCH_CHECK(
+        false,
+        "shm_all_reduce_init: ftruncate of ",
+        path,
+        " failed: ",
+        std::strerror(err));
+  }
+  void* base =
+      mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  TORCH_CHECK(
+      base != MAP_FAILED,
+      "shm_all_reduce_init: mmap of ",
+      path,
+      " failed: ",
+      std::strerror(errno));
+
+  state.base = base;
+  state.bytes = bytes;
+  state.rank = rank;
+  state.world_size = world_size;
+  state.step = 0;
+}
+
+void shm_all_reduce_unlink(const std::string& name) {
+  shm_unlink(shm_path(name).c_str());
+}
+
+bool is_shm_all_reduce_initialized() {
+  auto& state = shm_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.base != nullptr;
+}
+
+at::Tensor& shm_all_reduce_(at::Tensor& self) {
+  RECORD_FUNCTION(
+      "torch_ipex::shm_all_reduce_", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::shm_all_reduce_", 2 * utils::nbytes(self), 0);
+
+  const auto dtype = self.scalar_type();
+  TORCH_CHECK(
+      self.is_contiguous() && (dtype == at::kFloat || dtype == at::kBFloat16),
+      "shm_all_reduce_: contiguous float or bfloat16 tensor expected");
+  auto& state = shm_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  TORCH_CHECK(
+      state.base != nullptr,
+      "shm_all_reduce_: shm_all_reduce_init has not been called");
+  if (state.world_size == 1) {
+    return self;
+  }
+
+  ShmHeader* header = state.header();
+  const int64_t element_size = self.element_size();
+  const int64_t slice_numel = kShmSliceBytes / element_size;
+  const int64_t numel = self.numel();
+  char* data = static_cast<char*>(self.data_ptr());
+  std::vector<const void*> inputs(state.world_size);
+  for (int64_t begin = 0; begin < numel; begin += slice_numel) {
+    const int64_t count = std::min(slice_numel, numel - begin);
+    char* slice = data + begin * element_size;
+    const int64_t step = ++state.step;
+    const int64_t parity = step % 2;
+    // the buffers of the parity were last read two slices ago
+    for (const auto r : c10::irange(state.world_size)) {
+      spin_wait(header->done[r], step - 2);
+    }
+    std::memcpy(state.buffer(parity, state.rank), slice, count * element_size);
+    header->ready[state.rank].value.store(step, std::memory_order_release);
+    for (const auto r : c10::irange(state.world_size)) {
+      spin_wait(header->ready[r], step);
+      inputs[r] = state.buffer(parity, r);
+    }
+    /*
+    pointer to shm_reduce_kernel_impl(inputs, slice, count, dtype);
+    */
+    shm_reduce_kernel_stub(kCPU, inputs, slice, count, dtype);
+    header->done[state.rank].value.store(step, std::memory_order_release);
+  }
+  return self;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def("shm_all_reduce_(Tensor(a!) self) -> Tensor(a!)");
+  m.impl(
+      "shm_all_reduce_",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::shm_all_reduce_);
+}
+
+} // namespace
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+#include <string>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * The intra-node allreduce of the ranks of a tensor parallel group through a
+ * POSIX shared memory segment, for the small allreduces of the decode steps
+ * whose latency is dominated by the oneCCL / gloo overheads. Each rank
+ * copies its slice into its own buffer of the segment, raises its ready flag
+ * and spins on the flags of the other ranks, then sums the buffers of all
+ * the ranks in the rank order, so that the ranks get the same bits. The
+ * buffers are double buffered, a rank waiting for the others to have read
+ * its buffer two slices ago before overwriting it.
+ *
+ * shm_all_reduce_init is called once by every rank of the group, with the
+ * same name and world size, before any shm_all_reduce_; the ranks must then
+ * call shm_all_reduce_ in the same order, as for any collective.
+ * */
+void shm_all_reduce_init(
+    const std::string& name,
+    int64_t rank,
+    int64_t world_size);
+
+// Removes the name of the segment, the mappings of the ranks staying valid
+void shm_all_reduce_unlink(const std::string& name);
+
+bool is_shm_all_reduce_initialized();
+
+// Sums the contiguous float or bfloat16 tensor over the ranks, in place
+at::Tensor& shm_all_reduce_(at::Tensor& self);
+
+namespace {
+
+void shm_reduce_kernel_impl(
+    const std::vector<const void*>& inputs,
+    void* output,
+    int64_t numel,
+    at::ScalarType dtype);
+}
+
+// output[i] = inputs[0][i] + ... + inputs[n - 1][i] of numel float or
+// bfloat16 elements, summed in float in the order of the inputs
+using shm_reduce_kernel_fn = void (*)(
+    const std::vector<const void*>&,
+    void*,
+    int64_t,
+    at::ScalarType);
+DECLARE_DISPATCH(shm_reduce_kernel_fn, shm_reduce_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
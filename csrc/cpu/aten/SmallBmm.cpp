@@ -0,0 +1,119 @@
+#include "SmallBmm.h"
+
+#include <ATen/Parallel.h>
+#include <ATen/record_function.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "tpp/xsmm_functors.h"
+#include "utils/parallel_stats.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The largest M, N and K of the matrices, whose blocks of A, B and C stay in
+// L1 and registers during a product
+constexpr int64_t kSmallBmmMaxDim = 64;
+// The fewest matrices a thread gets, below which the batch doesn't keep the
+// threads busy and the batched primitives are better
+constexpr int64_t kSmallBmmMinBatchPerThread = 4;
+
+// The leading dimension of the rows of a [rows, cols] matrix whose cols are
+// dense, which is cols for a single row whose stride is arbitrary
+inline int64_t leading_dim(int64_t row_stride, int64_t rows, int64_t cols) {
+  return rows == 1 ? cols : row_stride;
+}
+
+bool use_small_bmm(
+    const at::Tensor& batch1,
+    const at::Tensor& batch2,
+    const at::Tensor& out) {
+  const int64_t dim = out.dim();
+  if (dim < 3 || batch1.dim() != dim || batch2.dim() != dim ||
+      batch1.scalar_type() != at::kFloat ||
+      batch2.scalar_type() != at::kFloat || out.scalar_type() != at::kFloat ||
+      out.numel() == 0 || batch1.size(-1) == 0) {
+    return false;
+  }
+  for (int64_t d = 0; d < dim - 2; d++) {
+    if (batch1.size(d) != out.size(d) || batch2.size(d) != out.size(d)) {
+      return false;
+    }
+  }
+  const int64_t M = batch1.size(-2), K = batch1.size(-1), N = batch2.size(-1);
+  if (M > kSmallBmmMaxDim || N > kSmallBmmMaxDim || K > kSmallBmmMaxDim ||
+      out.size(-2) != M || out.size(-1) != N || batch2.size(-2) != K) {
+    return false;
+  }
+  const int64_t batch = out.numel() / (M * N);
+  if (batch < kSmallBmmMinBatchPerThread * at::get_num_threads()) {
+    return false;
+  }
+  // A is row-major or transposed, B and C are row-major
+  return (batch1.stride(-1) == 1 || batch1.stride(-2) == 1) &&
+      batch2.stride(-1) == 1 && out.stride(-1) == 1;
+}
+
+} // namespace
+
+bool small_bmm(
+    const at::Tensor& batch1,
+    const at::Tensor& batch2,
+    at::Tensor& out,
+    float scale) {
+  if (!use_small_bmm(batch1, batch2, out)) {
+    return false;
+  }
+  RECORD_FUNCTION("torch_ipex::small_bmm", c10::ArrayRef<c10::IValue>({}));
+  utils::ParallelStatsScope parallel_stats_scope("small_bmm");
+  const int64_t dim = out.dim();
+  const int64_t M = batch1.size(-2), K = batch1.size(-1), N = batch2.size(-1);
+  const int64_t batch = out.numel() / (M * N);
+  const bool a_trans = batch1.stride(-1) != 1;
+  const int64_t lda = a_trans ? leading_dim(batch1.stride(-1), K, M)
+                              : leading_dim(batch1.stride(-2), M, K);
+  const int64_t ldb = leading_dim(batch2.stride(-2), K, N);
+  const int64_t ldc = leading_dim(out.stride(-2), M, N);
+  // the kernel is JIT-ed by libxsmm for the shape, and cached
+  auto brgemm = tpp::BrgemmTPP<float, float>(
+      M, N, K, M * K, K * N, lda, ldb, ldc, 0.f, a_trans ? 1 : 0, 0);
+
+  float* a = batch1.data_ptr<float>();
+  float* b = batch2.data_ptr<float>();
+  float* c = out.data_ptr<float>();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / (M * N * K));
+  utils::parallel_for(0, batch, grain_size, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      // the offsets of the matrix i, the batch dims of the tensors being
+      // strided, e.g. the heads of a permuted QKV
+      int64_t a_offset = 0, b_offset = 0, c_offset = 0;
+      int64_t rest = i;
+      for (int64_t d = dim - 3; d >= 0; d--) {
+        const int64_t index = rest % out.size(d);
+        rest /= out.size(d);
+        a_offset += index * batch1.stride(d);
+        b_offset += index * batch2.stride(d);
+        c_offset += index * out.stride(d);
+      }
+      float* c_ptr = c + c_offset;
+      brgemm(a + a_offset, b + b_offset, c_ptr, 1, /*no_tile_cfg=*/true);
+      if (scale != 1.f) {
+        for (const auto m : c10::irange(M)) {
+#pragma omp simd
+          for (int64_t n = 0; n < N; n++) {
+            c_ptr[m * ldc + n] *= scale;
+          }
+        }
+      }
+    }
+  });
+  return true;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
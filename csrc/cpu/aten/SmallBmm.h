@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// out = scale * batch1 @ batch2 of many small fp32 matrices, e.g. the
+// per-head products of a short sequence or the per-node products of a GNN
+// layer, each matrix being a libxsmm BRGEMM call of a batch of one on a
+// thread, instead of a oneDNN or MKL batched primitive whose setup and
+// thread mapping outweigh the flops. batch1 and batch2 have the batch dims of
+// out, batch1 may be transposed in its last two dims, and batch2 and out are
+// dense in their last dim. Returns false, not touching out, if the shapes
+// are not the small, many-matrix ones of the kernel.
+bool small_bmm(
+    const at::Tensor& batch1,
+    const at::Tensor& batch2,
+    at::Tensor& out,
+    float scale);
+
+} // namespace cpu
+} // namespace torch_ipex
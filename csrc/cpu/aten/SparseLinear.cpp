@@ -0,0 +1,130 @@
+#include "SparseLinear.h"
+#include <ATen/Parallel.h>
+#include <torch/all.h>
+
+#include <atomic>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(sparse_linear_kernel_stub);
+
+namespace {
+
+std::atomic<bool> sparse_linear_enabled{true};
+
+const int64_t sparse_linear_mask_bits = 64;
+
+template <typename T>
+c10::optional<SparseLinearWeight> pack_sparse_linear_weight_impl(
+    const at::Tensor& weight) {
+  int64_t N = weight.size(0);
+  int64_t K = weight.size(1);
+  int64_t num_n_blocks =
+      (N + sparse_linear_block_n - 1) / sparse_linear_block_n;
+  int64_t num_words =
+      (K + sparse_linear_mask_bits - 1) / sparse_linear_mask_bits;
+  const T* w = weight.data_ptr<T>();
+
+  auto block_masks = at::zeros({num_n_blocks, num_words}, at::kLong);
+  auto masks = reinterpret_cast<uint64_t*>(block_masks.data_ptr<int64_t>());
+  std::vector<int64_t> counts(num_n_blocks, 0);
+  at::parallel_for(0, num_n_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t nb = begin; nb < end; nb++) {
+      int64_t n_end = std::min((nb + 1) * sparse_linear_block_n, N);
+      for (int64_t n = nb * sparse_linear_block_n; n < n_end; n++) {
+        for (int64_t k = 0; k < K; k++) {
+          if (w[n * K + k] != T(0)) {
+            masks[nb * num_words + k / sparse_linear_mask_bits] |= uint64_t(1)
+                << (k % sparse_linear_mask_bits);
+          }
+        }
+      }
+      for (int64_t i = 0; i < num_words; i++) {
+        counts[nb] += __builtin_popcountll(masks[nb * num_words + i]);
+      }
+    }
+  });
+
+  auto block_offsets = at::empty({num_n_blocks + 1}, at::kLong);
+  auto offsets = block_offsets.data_ptr<int64_t>();
+  offsets[0] = 0;
+  for (int64_t nb = 0; nb < num_n_blocks; nb++) {
+    offsets[nb + 1] = offsets[nb] + counts[nb];
+  }
+  int64_t num_blocks = offsets[num_n_blocks];
+  if (num_blocks > (1 - sparse_linear_min_sparsity) * num_n_blocks * K) {
+    return c10::nullopt;
+  }
+
+  auto values =
+      at::zeros({num_blocks, sparse_linear_block_n}, weight.options());
+  T* v = values.data_ptr<T>();
+  at::parallel_for(0, num_n_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t nb = begin; nb < end; nb++) {
+      int64_t n_begin = nb * sparse_linear_block_n;
+      int64_t n_end = std::min(n_begin + sparse_linear_block_n, N);
+      T* block = v + offsets[nb] * sparse_linear_block_n;
+      for (int64_t k = 0; k < K; k++) {
+        uint64_t word = masks[nb * num_words + k / sparse_linear_mask_bits];
+        if (!((word >> (k % sparse_linear_mask_bits)) & 1)) {
+          continue;
+        }
+        for (int64_t n = n_begin; n < n_end; n++) {
+          block[n - n_begin] = w[n * K + k];
+        }
+        block += sparse_linear_block_n;
+      }
+    }
+  });
+  return SparseLinearWeight{block_masks, block_offsets, values, N, K};
+}
+
+} // anonymous namespace
+
+c10::optional<SparseLinearWeight> pack_sparse_linear_weight(
+    const at::Tensor& weight) {
+  auto dtype = weight.scalar_type();
+  if (!is_sparse_linear_enabled() || weight.dim() != 2 ||
+      weight.numel() == 0 || (dtype != at::kFloat && dtype != at::kBFloat16)) {
+    return c10::nullopt;
+  }
+  auto weight_ = weight.contiguous();
+  if (dtype == at::kFloat) {
+    return pack_sparse_linear_weight_impl<float>(weight_);
+  }
+  return pack_sparse_linear_weight_impl<at::BFloat16>(weight_);
+}
+
+void sparse_linear_kernel_output(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output,
+    SparseLinearPostOp post_op) {
+  RECORD_FUNCTION("sparse_linear", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      input.size(-1) == weight.in_features &&
+          output.size(-1) == weight.out_features && output.is_contiguous(),
+      "sparse_linear: the input or output does not match the weight");
+  auto input_ = input.contiguous().view({-1, weight.in_features});
+  auto output_ = output.view({-1, weight.out_features});
+  auto bias_ = bias.defined() ? bias.contiguous() : bias;
+  /*
+  pointer to sparse_linear_kernel_impl(
+      input_, weight, bias_, output_, post_op);
+  */
+  sparse_linear_kernel_stub(kCPU, input_, weight, bias_, output_, post_op);
+}
+
+void set_sparse_linear_enabled(bool enabled) {
+  sparse_linear_enabled.store(enabled);
+}
+
+bool is_sparse_linear_enabled() {
+  return sparse_linear_enabled.load();
+}
+
+} // namespace cpu
+} // namespace torch_ipex
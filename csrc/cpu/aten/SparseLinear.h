@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Linear weights (pruned models) with at least sparse_linear_min_sparsity of
+// their blocks all zero are also packed block-sparse by the linear op
+// contexts, for a kernel skipping the zero blocks. A block is made of
+// sparse_linear_block_n consecutive output features of one input feature,
+// i.e. one AVX512 fp32 vector.
+const int64_t sparse_linear_block_n = 16;
+const double sparse_linear_min_sparsity = 0.5;
+
+// Post-ops the sparse kernel fuses, the other ones run with oneDNN
+enum class SparseLinearPostOp { NONE = 0, RELU, SIGMOID };
+
+struct SparseLinearWeight {
+  // [num_n_blocks, ceil(in_features / 64)], bit k % 64 of word k / 64 of a
+  // block row is set if the block of input feature k is stored
+  at::Tensor block_masks;
+  // [num_n_blocks + 1], index of the first stored block of each block row
+  at::Tensor block_offsets;
+  // [num_blocks, sparse_linear_block_n] in the weight dtype, the stored blocks
+  // by block row then input feature, zero padded past out_features
+  at::Tensor values;
+  int64_t out_features;
+  int64_t in_features;
+};
+
+// Returns the block-sparse packing of the [out_features, in_features] weight,
+// nullopt if the sparse kernel is disabled or the weight is not sparse enough
+c10::optional<SparseLinearWeight> pack_sparse_linear_weight(
+    const at::Tensor& weight);
+
+// output = post_op(input * weight^T + bias), for input, bias and weight of
+// the same float or bfloat16 dtype and a contiguous output
+void sparse_linear_kernel_output(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output,
+    SparseLinearPostOp post_op);
+
+// Whether the op contexts created from now on pack sparse weights, on by
+// default
+void set_sparse_linear_enabled(bool enabled);
+bool is_sparse_linear_enabled();
+
+namespace {
+
+void sparse_linear_kernel_impl(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output,
+    SparseLinearPostOp post_op);
+
+} // namespace
+
+using sparse_linear_kernel_fn = void (*)(
+    const at::Tensor&,
+    const SparseLinearWeight&,
+    const at::Tensor&,
+    at::Tensor&,
+    SparseLinearPostOp);
+DECLARE_DISPATCH(sparse_linear_kernel_fn, sparse_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
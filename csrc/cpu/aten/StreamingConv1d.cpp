@@ -0,0 +1,81 @@
+#include "StreamingConv1d.h"
+#include <torch/all.h>
+#include "cpu/kernels/OpContext.h"
+#include "ideep/IDeepConversions.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+std::tuple<at::Tensor, at::Tensor> streaming_conv1d(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& state,
+    const at::Tensor& op_context,
+    at::IntArrayRef weight_size) {
+  RECORD_FUNCTION("streaming_conv1d", c10::ArrayRef<c10::IValue>({}));
+
+  auto conv_op_context = reinterpret_cast<IpexConvolutionOpContext*>(
+      op_context.data_ptr<int64_t>()[0]);
+  const auto& context = conv_op_context->get_context();
+  TORCH_CHECK(
+      input.dim() == 3 && weight_size.size() == 3,
+      "streaming_conv1d expects a [B, C, T] input of a conv1d");
+  TORCH_CHECK(
+      context.padding_.size() == 1 && context.padding_[0] == 0,
+      "streaming_conv1d expects a convolution prepacked without padding");
+  int64_t B = input.size(0);
+  int64_t C = input.size(1);
+  int64_t T = input.size(2);
+  int64_t stride = context.stride_[0];
+  int64_t receptive_field = (weight_size[2] - 1) * context.dilation_[0] + 1;
+  int64_t S = receptive_field - 1;
+  if (state.has_value()) {
+    TORCH_CHECK(
+        state->dim() == 3 && state->size(0) == B && state->size(1) == C,
+        "streaming_conv1d: the state does not match the input");
+    S = state->size(2);
+  }
+
+  // the state and the chunk are one channels last buffer read by the
+  // convolution, from which the frames of the next windows are kept
+  int64_t frames = S + T;
+  auto buffer = at::empty({B, frames, C}, input.options()).transpose(1, 2);
+  if (state.has_value()) {
+    buffer.narrow(2, 0, S).copy_(*state);
+  } else {
+    buffer.narrow(2, 0, S).zero_();
+  }
+  buffer.narrow(2, S, T).copy_(input);
+
+  int64_t num_outputs =
+      frames < receptive_field ? 0 : (frames - receptive_field) / stride + 1;
+  at::Tensor output;
+  if (num_outputs > 0) {
+    // the frames after the last window, if any, are read by the next chunk
+    int64_t read = (num_outputs - 1) * stride + receptive_field;
+    output = conv_op_context->run(
+        read == frames ? buffer : buffer.narrow(2, 0, read),
+        ideep::attr_t(torch_ipex::fpmath_mode));
+  } else {
+    output = at::empty({B, weight_size[0], 0}, input.options());
+  }
+  int64_t consumed = num_outputs * stride;
+  return std::make_tuple(
+      output, buffer.narrow(2, consumed, frames - consumed));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "streaming_conv1d(Tensor input, Tensor? state, Tensor op_context, "
+      "int[] weight_size) -> (Tensor, Tensor)");
+  m.impl(
+      "streaming_conv1d",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::streaming_conv1d);
+}
+
+} // namespace
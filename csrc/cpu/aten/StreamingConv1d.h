@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Runs the causal conv1d of the prepacked convolution context, prepacked
+// without padding, on the [B, C, T] chunk of a stream. state holds the last
+// frames of the stream the next outputs still read, at most
+// (kernel_size - 1) * dilation of them for a stride of 1, or is undefined at
+// the start of the stream, which is left padded with zeros. Returns the
+// outputs of the windows ending in the chunk only and the state for the next
+// chunk, so that the overlap of the chunks is neither fed again by the caller
+// nor computed twice.
+std::tuple<at::Tensor, at::Tensor> streaming_conv1d(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& state,
+    const at::Tensor& op_context,
+    at::IntArrayRef weight_size);
+
+} // namespace cpu
+} // namespace torch_ipex
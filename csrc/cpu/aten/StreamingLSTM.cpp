@@ -0,0 +1,103 @@
+#include "StreamingLSTM.h"
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(streaming_lstm_kernel_stub);
+
+at::Tensor streaming_lstm_pack(const at::Tensor& weight_hh) {
+  RECORD_FUNCTION("streaming_lstm_pack", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      weight_hh.dim() == 2 && weight_hh.size(0) == 4 * weight_hh.size(1),
+      "streaming_lstm_pack expects a [4 * hidden_size, hidden_size] weight");
+  int64_t H = weight_hh.size(1);
+  int64_t NB = (H + streaming_lstm_block - 1) / streaming_lstm_block;
+  int64_t padded = NB * streaming_lstm_block;
+  // [4, H, H] -> [4, padded, H] -> [4, NB, block, H] -> [NB, H, 4, block]
+  auto weight = weight_hh.view({4, H, H});
+  if (padded != H) {
+    weight = at::constant_pad_nd(weight, {0, 0, 0, padded - H});
+  }
+  return weight.view({4, NB, streaming_lstm_block, H})
+      .permute({1, 3, 0, 2})
+      .contiguous();
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> streaming_lstm_layer(
+    const at::Tensor& input,
+    const at::Tensor& weight_ih,
+    const c10::optional<at::Tensor>& bias,
+    const at::Tensor& packed_weight_hh,
+    const at::Tensor& hx,
+    const at::Tensor& cx) {
+  RECORD_FUNCTION("streaming_lstm_layer", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      input.dim() == 3, "streaming_lstm_layer expects a [T, B, I] input");
+  int64_t T = input.size(0);
+  int64_t B = input.size(1);
+  int64_t H = hx.size(-1);
+  TORCH_CHECK(
+      weight_ih.dim() == 2 && weight_ih.size(0) == 4 * H &&
+          weight_ih.size(1) == input.size(2),
+      "streaming_lstm_layer: weight_ih does not match the input");
+  TORCH_CHECK(
+      packed_weight_hh.dim() == 4 && packed_weight_hh.size(1) == H &&
+          packed_weight_hh.size(3) == streaming_lstm_block,
+      "streaming_lstm_layer: packed_weight_hh is not packed by "
+      "streaming_lstm_pack");
+  TORCH_CHECK(
+      hx.numel() == B * H && cx.numel() == B * H,
+      "streaming_lstm_layer expects [B, hidden_size] states");
+  auto dtype = input.scalar_type();
+  TORCH_CHECK(
+      (dtype == at::kFloat || dtype == at::kBFloat16) &&
+          weight_ih.scalar_type() == dtype &&
+          packed_weight_hh.scalar_type() == dtype,
+      "streaming_lstm_layer only supports float and bfloat16 of the same "
+      "dtype for the input and the weights");
+
+  // [T * B, 4 * H] projection of the whole chunk, the recurrent kernel
+  // accumulates on it in fp32
+  auto gates_x = at::linear(
+      input.contiguous().view({T * B, input.size(2)}), weight_ih, bias);
+  // fp32 states of the kernel, in the [B, H] layout of hx and cx
+  auto h = hx.reshape({B, H}).to(at::kFloat).contiguous();
+  auto c = cx.reshape({B, H}).to(at::kFloat).contiguous();
+  auto output = at::empty({T, B, H}, input.options());
+  /*
+  pointer to streaming_lstm_kernel_impl(
+      gates_x, packed_weight_hh, h, c, output);
+  */
+  streaming_lstm_kernel_stub(
+      kCPU, gates_x, packed_weight_hh.contiguous(), h, c, output);
+  return std::make_tuple(
+      output,
+      h.to(hx.scalar_type()).view(hx.sizes()),
+      c.to(cx.scalar_type()).view(cx.sizes()));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def("streaming_lstm_pack(Tensor weight_hh) -> Tensor");
+  m.impl(
+      "streaming_lstm_pack",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::streaming_lstm_pack);
+  m.def(
+      "streaming_lstm_layer(Tensor input, Tensor weight_ih, Tensor? bias, "
+      "Tensor packed_weight_hh, Tensor hx, Tensor cx) -> "
+      "(Tensor, Tensor, Tensor)");
+  m.impl(
+      "streaming_lstm_layer",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::streaming_lstm_layer);
+}
+
+} // namespace
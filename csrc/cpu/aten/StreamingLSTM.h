@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Hidden units whose 4 gates are computed in registers together by the
+// recurrent kernel. The packed recurrent weight is
+// [ceil(H / streaming_lstm_block), H, 4, streaming_lstm_block], zero padded,
+// and each thread of the kernel keeps the same blocks in its cache along the
+// sequence.
+const int64_t streaming_lstm_block = 16;
+
+// Packs the [4 * H, H] weight_hh of a LSTM layer, gates in the i, f, g, o
+// order of torch.nn.LSTM, for streaming_lstm_layer
+at::Tensor streaming_lstm_pack(const at::Tensor& weight_hh);
+
+// Runs a unidirectional LSTM layer on the [T, B, I] input from the [B, H]
+// states hx and cx, returning the [T, B, H] output and the last states. The
+// input projection of the T steps is one GEMM, the T recurrent steps then run
+// in one parallel region, so that small batches of short chunks do not pay a
+// primitive execution and a state reorder per call.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> streaming_lstm_layer(
+    const at::Tensor& input,
+    const at::Tensor& weight_ih,
+    const c10::optional<at::Tensor>& bias,
+    const at::Tensor& packed_weight_hh,
+    const at::Tensor& hx,
+    const at::Tensor& cx);
+
+namespace {
+
+void streaming_lstm_kernel_impl(
+    const at::Tensor& gates_x,
+    const at::Tensor& packed_weight_hh,
+    at::Tensor& h,
+    at::Tensor& c,
+    at::Tensor& output);
+
+} // namespace
+
+using streaming_lstm_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(streaming_lstm_kernel_fn, streaming_lstm_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -7,6 +7,7 @@
 #include <ATen/record_function.h>
 #include <c10/util/irange.h>
 
+#include "Reduce.h"
 #include "Sum.h"
 #include "utils/library.h"
 
@@ -36,6 +37,15 @@ at::Tensor sum_out_cpu(
 
   at::DimVector dims_ = at::native::make_dim_vector(opt_dims, input.dim());
   at::maybe_wrap_dims(dims_, input.dim());
+
+  // the float and bfloat16 reductions of the dense inputs, channels last
+  // included, run on the [M, R, N] engine
+  auto engine_output = reduce_with_engine(
+      input, dims_, keepdim, dtype.value(), ReducePostOp::Sum);
+  if (engine_output.defined()) {
+    return engine_output;
+  }
+
   auto shape = at::meta::get_reduction_shape(input, dims_, keepdim);
   at::Tensor output = at::empty(shape, input.options().dtype(dtype));
 
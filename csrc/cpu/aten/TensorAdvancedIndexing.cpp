@@ -29,6 +29,34 @@ namespace cpu {
 DEFINE_DISPATCH(index_select_contig_stub);
 DEFINE_DISPATCH(copy_stub);
 
+namespace {
+
+// Whether self is viewed as [outer_size, dim_size, inner_size] with dense inner
+// slices and its outer dims collapsing into one stride, which the kernel
+// gathers from without a contiguous copy, e.g. a table sliced along its columns
+bool is_gather_view(const at::Tensor& self, int64_t dim) {
+  int64_t inner_stride = 1;
+  for (int64_t d = self.dim() - 1; d > dim; d--) {
+    if (self.size(d) != 1 && self.stride(d) != inner_stride) {
+      return false;
+    }
+    inner_stride *= self.size(d);
+  }
+  int64_t outer_stride = -1;
+  for (int64_t d = dim - 1; d >= 0; d--) {
+    if (self.size(d) == 1) {
+      continue;
+    }
+    if (outer_stride != -1 && self.stride(d) != outer_stride) {
+      return false;
+    }
+    outer_stride = self.stride(d) * self.size(d);
+  }
+  return true;
+}
+
+} // namespace
+
 at::Tensor& index_select_out_cpu_(
     const at::Tensor& self,
     int64_t dim,
@@ -68,8 +96,10 @@ at::Tensor& index_select_out_cpu_(
 
     const auto st = self.scalar_type();
     if (result.is_contiguous() &&
-        (st == at::kFloat || st == at::kDouble || st == at::kBFloat16)) {
-      auto self_contig = self.contiguous();
+        (at::isIntegralType(st, /*includeBool=*/true) || st == at::kFloat ||
+         st == at::kDouble || st == at::kBFloat16 || st == at::kHalf)) {
+      auto self_contig =
+          is_gather_view(self, dim) ? self : self.contiguous();
       index_select_contig_stub(kCPU, result, self_contig, dim, index_contig);
       return result;
     }
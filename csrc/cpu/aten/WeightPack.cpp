@@ -1,7 +1,8 @@
 #include <torch/all.h>
 
 #include "WeightPack.h"
-#include "utils/rw_lock.h"
+#include "quantization/utils/utils.h"
+#include "utils/rcu.h"
 #include "utils/utils.h"
 
 namespace torch_ipex {
@@ -12,30 +13,40 @@ namespace {
 using weakref_type =
     c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
 using val_blocked = std::tuple<weakref_type, ideep::tensor>;
-std::unordered_map<c10::TensorImpl*, val_blocked> cached_weights;
-
-using map_iter =
-    std::unordered_map<c10::TensorImpl*, val_blocked>::const_iterator;
-
-torch_ipex::ReadWriteMutex rwmutex;
+// Looked up by every call of the ops of the packed weights, from all the
+// inference threads, and written once per weight
+torch_ipex::utils::RcuMap<c10::TensorImpl*, val_blocked> cached_weights;
 
 ideep::tensor read_cached_weights(const at::Tensor& weight) {
-  torch_ipex::UniqueReadLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  ideep::tensor cached_weight;
-  auto it = cached_weights.find(weight.unsafeGetTensorImpl());
-  if (it != cached_weights.end()) {
-    cached_weight = std::get<1>(it->second);
+  val_blocked cached;
+  if (!cached_weights.find(weight.unsafeGetTensorImpl(), cached)) {
+    return ideep::tensor();
   }
-  return cached_weight;
+  return std::get<1>(cached);
 }
 
 void write_cached_weights(const at::Tensor& weight, ideep::tensor& result) {
-  torch_ipex::UniqueWriteLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  cached_weights.emplace(
+  cached_weights.insert(
       weight.unsafeGetTensorImpl(),
       val_blocked{weakref_type(weight.getIntrusivePtr()), result});
 }
 
+// Requantizes the int8 weight to the scales shared by weight_ih and weight_hh,
+// given as the oneDNN scales of 1 / scale.
+at::Tensor requantize_lstm_weight(
+    const at::Tensor& weight,
+    const std::vector<float>& mkldnn_scales) {
+  auto ratio = int8::utils::get_weight_scale_tensor(weight).to(at::kFloat) *
+      at::tensor(mkldnn_scales, at::kFloat);
+  if (ratio.sub(1.f).abs().max().item<float>() < 1e-6f) {
+    return weight;
+  }
+  auto data = at::round(weight.int_repr().to(at::kFloat) * ratio.unsqueeze(1))
+                  .clamp(-128, 127)
+                  .to(at::kChar);
+  return at::_make_per_tensor_quantized_tensor(data, 1., 0);
+}
+
 } // namespace
 
 bool is_packed(const at::Tensor& weight) {
@@ -93,13 +104,15 @@ void LstmInferenceWeightDesc<LstmDtype::Float>::set_expected_weights_desc() {
 }
 
 void LstmInferenceWeightDesc<LstmDtype::Quantized>::initialize_weight_src() {
+  auto weight_ih = requantize_lstm_weight(weight_ih_, weights_scales_);
+  auto weight_hh = requantize_lstm_weight(weight_hh_, weights_scales_);
   auto w1 = itensor_view_from_dense(
-      weight_ih_,
+      weight_ih,
       {{1, 1, input_size_, num_gates_, hidden_size_},
        get_mkldnn_dtype(weight_ih_.scalar_type()),
        ideep::format_tag::ldgoi});
   auto w2 = itensor_view_from_dense(
-      weight_hh_,
+      weight_hh,
       {{1, 1, hidden_size_, num_gates_, hidden_size_},
        get_mkldnn_dtype(weight_hh_.scalar_type()),
        ideep::format_tag::ldgoi});
@@ -246,6 +259,21 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
   }
 }
 
+ideep::tensor get_rnn_packed_weight(
+    const at::Tensor& weight,
+    const ideep::tensor& src,
+    const ideep::tensor::desc& expected_desc) {
+  auto cached_weight = read_cached_weights(weight);
+  if (!cached_weight.is_empty()) {
+    return cached_weight.reorder_if_differ_in(expected_desc);
+  }
+  auto packed_weight = src.reorder_if_differ_in(expected_desc);
+  if (!expected_desc.is_rnn_packed()) {
+    write_cached_weights(weight, packed_weight);
+  }
+  return packed_weight;
+}
+
 ideep::tensor::desc get_conv_transpose_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
     ideep::tensor::data_type w_dtype,
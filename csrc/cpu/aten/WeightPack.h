@@ -203,6 +203,15 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
 
 bool is_packed(const at::Tensor& weight);
 
+// Returns src, the ideep view of weight, reordered to the expected desc of an
+// inference RNN primitive. The reordered weight is cached with weight, unless
+// it is of rnn_packed format, which changes with the input sizes. src is only
+// read if weight is not cached yet.
+ideep::tensor get_rnn_packed_weight(
+    const at::Tensor& weight,
+    const ideep::tensor& src,
+    const ideep::tensor::desc& expected_desc);
+
 // Get the conv_transpose's expected ideep weight tensor desc.
 ideep::tensor::desc get_conv_transpose_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
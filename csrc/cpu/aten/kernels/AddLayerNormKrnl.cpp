@@ -5,7 +5,10 @@
 
 #include <aten/AddLayerNorm.h>
 
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
 #include <torch/csrc/autograd/function.h>
+#include "aten/utils/scratch_arena.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -14,7 +17,9 @@ namespace cpu {
 namespace {
 
 #if defined(CPU_CAPABILITY_AVX512)
-template <typename T, typename T1>
+// a of T, b of Tb and the output of Tout, converted from and to fp32 on load
+// and store
+template <typename T, typename T1, typename Tb = T, typename Tout = T>
 void AddLayerNormKernelImpl(
     const at::Tensor& a,
     const at::Tensor& b,
@@ -23,16 +28,16 @@ void AddLayerNormKernelImpl(
     const at::Tensor& beta,
     int64_t M,
     int64_t N,
-    T eps,
+    float eps,
     at::Tensor& Y) {
   DCHECK(a.numel() == M * N);
   DCHECK(!gamma.defined() || gamma.numel() == N);
   DCHECK(!beta.defined() || beta.numel() == N);
   const T* a_data = a.data_ptr<T>();
-  const T* b_data = b.data_ptr<T>();
+  const Tb* b_data = b.data_ptr<Tb>();
   const T1* gamma_data = gamma.defined() ? gamma.data_ptr<T1>() : nullptr;
   const T1* beta_data = beta.defined() ? beta.data_ptr<T1>() : nullptr;
-  T* Y_data = Y.data_ptr<T>();
+  Tout* Y_data = Y.data_ptr<Tout>();
   const float c = float(1) / static_cast<float>(N);
   const bool gamma_null = gamma_data == nullptr;
   const bool beta_null = beta_data == nullptr;
@@ -41,21 +46,53 @@ void AddLayerNormKernelImpl(
       at::Tensor tmp_out = at::empty({N});
       float* tmp_out_ptr = tmp_out.data_ptr<float>();
       const T* a_ptr = a_data + i * N;
-      const T* b_ptr = b_data + i * N;
-      T* Y_ptr = Y_data + i * N;
+      const Tb* b_ptr = b_data + i * N;
+      Tout* Y_ptr = Y_data + i * N;
       float mean_val;
       float rstd_val;
       std::tie(mean_val, rstd_val) =
-          kernel::_add_and_compute_mean_var<T>(a_ptr, b_ptr, N, tmp_out_ptr);
+          kernel::_add_and_compute_mean_var(a_ptr, b_ptr, N, tmp_out_ptr);
       rstd_val = std::max(rstd_val * c - mean_val * mean_val, float(0));
       rstd_val = float(1.0) / std::sqrt(rstd_val + eps);
       float scale = rstd_val;
       float bias = -rstd_val * mean_val;
-      kernel::_normalize_kernel<T, T1>(
+      kernel::_normalize_kernel<Tout, T1>(
           Y_ptr, tmp_out_ptr, N, scale, bias, gamma_data, beta_data);
     }
   });
 }
+
+// Picks the dtypes of the weights and of the output
+template <typename T, typename Tb>
+void AddLayerNormMixedKernelImpl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t M,
+    int64_t N,
+    float eps,
+    at::Tensor& Y) {
+  bool bf16_gamma = gamma.defined() && gamma.scalar_type() == at::kBFloat16;
+  if (Y.scalar_type() == at::kFloat) {
+    if (bf16_gamma) {
+      AddLayerNormKernelImpl<T, at::BFloat16, Tb, float>(
+          a, b, alpha, gamma, beta, M, N, eps, Y);
+    } else {
+      AddLayerNormKernelImpl<T, float, Tb, float>(
+          a, b, alpha, gamma, beta, M, N, eps, Y);
+    }
+  } else {
+    if (bf16_gamma) {
+      AddLayerNormKernelImpl<T, at::BFloat16, Tb, at::BFloat16>(
+          a, b, alpha, gamma, beta, M, N, eps, Y);
+    } else {
+      AddLayerNormKernelImpl<T, float, Tb, at::BFloat16>(
+          a, b, alpha, gamma, beta, M, N, eps, Y);
+    }
+  }
+}
 #endif
 
 at::Tensor add_layer_norm_kernel_impl(
@@ -65,7 +102,8 @@ at::Tensor add_layer_norm_kernel_impl(
     at::IntArrayRef normalized_shape,
     const c10::optional<at::Tensor>& weight_opt,
     const c10::optional<at::Tensor>& bias_opt,
-    float eps) {
+    float eps,
+    bool inplace) {
 #if defined(CPU_CAPABILITY_AVX512)
   c10::MaybeOwned<Tensor> weight_maybe_owned =
       at::borrow_from_optional_tensor(weight_opt);
@@ -81,13 +119,17 @@ at::Tensor add_layer_norm_kernel_impl(
   auto gamma = weight.expect_contiguous();
   auto beta = bias.expect_contiguous();
 
-  at::Tensor Y = at::native::empty_like(
-      X,
-      c10::nullopt /* dtype */,
-      c10::nullopt /* layout */,
-      c10::nullopt /* device */,
-      c10::nullopt /* pin_memory */,
-      at::MemoryFormat::Contiguous);
+  // a row of the sum is computed before its normalized row is written, the
+  // output can overwrite a. Otherwise the output is of the dtype of
+  // at::add(a, b), the fp32 and bf16 inputs are mixed without casts.
+  at::Tensor Y = inplace ? X
+                         : at::native::empty_like(
+                               X,
+                               at::result_type(a, b),
+                               c10::nullopt /* layout */,
+                               c10::nullopt /* device */,
+                               c10::nullopt /* pin_memory */,
+                               at::MemoryFormat::Contiguous);
   if (a.scalar_type() == at::kFloat && b.scalar_type() == at::kFloat) {
     AddLayerNormKernelImpl<float, float>(
         X, b, alpha, weight, bias, M, N, eps, Y);
@@ -100,17 +142,302 @@ at::Tensor add_layer_norm_kernel_impl(
       AddLayerNormKernelImpl<at::BFloat16, float>(
           X, b, alpha, weight, bias, M, N, eps, Y);
     }
+  } else if (
+      a.scalar_type() == at::kBFloat16 && b.scalar_type() == at::kFloat) {
+    AddLayerNormMixedKernelImpl<at::BFloat16, float>(
+        X, b, alpha, weight, bias, M, N, eps, Y);
+  } else if (
+      a.scalar_type() == at::kFloat && b.scalar_type() == at::kBFloat16) {
+    AddLayerNormMixedKernelImpl<float, at::BFloat16>(
+        X, b, alpha, weight, bias, M, N, eps, Y);
+  } else {
+    Y.copy_(at::layer_norm(
+        at::add(a, b, alpha), normalized_shape, weight_opt, bias_opt, eps));
   }
   return Y;
 #else
-  return at::layer_norm(
+  auto Y = at::layer_norm(
       at::add(a, b, alpha), normalized_shape, weight_opt, bias_opt, eps);
+  return inplace ? a.copy_(Y) : Y;
 #endif
 }
 
+// The weight in fp32, value if it is undefined
+void weight_to_float(
+    const at::Tensor& weight,
+    float* out,
+    int64_t N,
+    float value) {
+  if (!weight.defined()) {
+    std::fill_n(out, N, value);
+  } else if (weight.scalar_type() == at::kBFloat16) {
+    at::vec::convert(weight.data_ptr<at::BFloat16>(), out, N);
+  } else {
+    at::vec::convert(weight.data_ptr<float>(), out, N);
+  }
+}
+
+// A row of a + b in fp32
+template <typename T>
+void add_row(const T* a_ptr, const T* b_ptr, float* x, float* tmp, int64_t N) {
+  using Vec = at::vec::Vectorized<float>;
+  at::vec::convert(a_ptr, x, N);
+  at::vec::convert(b_ptr, tmp, N);
+  at::vec::map2<float>(
+      [](Vec x, Vec y) { return x + y; }, x, x, tmp, N);
+}
+
+template <typename T>
+void add_layer_norm_forward_kernel(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  using Vec = at::vec::Vectorized<float>;
+  const T* a_data = a.data_ptr<T>();
+  const T* b_data = b.data_ptr<T>();
+  T* Y_data = Y.data_ptr<T>();
+  float* mean_data = mean.data_ptr<float>();
+  float* rstd_data = rstd.data_ptr<float>();
+
+  ScratchScope scratch;
+  float* gamma_data = scratch.allocate<float>(N);
+  float* beta_data = scratch.allocate<float>(N);
+  weight_to_float(gamma, gamma_data, N, 1.0f);
+  weight_to_float(beta, beta_data, N, 0.0f);
+
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    ScratchScope thread_scratch;
+    float* x = thread_scratch.allocate<float>(N);
+    float* tmp = thread_scratch.allocate<float>(N);
+    for (int64_t i = begin; i < end; i++) {
+      add_row(a_data + i * N, b_data + i * N, x, tmp, N);
+      float mean_val = at::vec::reduce_all<float>(
+                           [](Vec& x, Vec& y) { return x + y; }, x, N) /
+          N;
+      float var_val = at::vec::map_reduce_all<float>(
+                          [mean_val](Vec x) {
+                            Vec d = x - Vec(mean_val);
+                            return d * d;
+                          },
+                          [](Vec& x, Vec& y) { return x + y; },
+                          x,
+                          N) /
+          N;
+      float rstd_val = 1.0f / std::sqrt(var_val + float(eps));
+      at::vec::map3<float>(
+          [mean_val, rstd_val](Vec x, Vec g, Vec b) {
+            return (x - Vec(mean_val)) * Vec(rstd_val) * g + b;
+          },
+          tmp,
+          x,
+          gamma_data,
+          beta_data,
+          N);
+      at::vec::convert(tmp, Y_data + i * N, N);
+      mean_data[i] = mean_val;
+      rstd_data[i] = rstd_val;
+    }
+  });
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+add_layer_norm_forward_kernel_impl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t M,
+    int64_t N,
+    double eps) {
+  auto Y = at::empty_like(a, at::MemoryFormat::Contiguous);
+  auto mean = at::empty({M}, a.options().dtype(at::kFloat));
+  auto rstd = at::empty({M}, a.options().dtype(at::kFloat));
+  if (a.scalar_type() == at::kBFloat16) {
+    add_layer_norm_forward_kernel<at::BFloat16>(
+        a, b, weight, bias, M, N, eps, Y, mean, rstd);
+  } else {
+    add_layer_norm_forward_kernel<float>(
+        a, b, weight, bias, M, N, eps, Y, mean, rstd);
+  }
+  return std::make_tuple(Y, mean, rstd);
+}
+
+// A pass over the rows computes the grads of the inputs and accumulates the
+// grads of the weights in the rows of the thread, reduced after it. x_hat is
+// computed again from a + b, which is not kept by the forward.
+template <typename T>
+void add_layer_norm_backward_kernel(
+    const at::Tensor& dY,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    at::Tensor& dX,
+    float* dgamma_acc,
+    float* dbeta_acc) {
+  using Vec = at::vec::Vectorized<float>;
+  const T* dY_data = dY.data_ptr<T>();
+  const T* a_data = a.data_ptr<T>();
+  const T* b_data = b.data_ptr<T>();
+  const float* mean_data = mean.data_ptr<float>();
+  const float* rstd_data = rstd.data_ptr<float>();
+  T* dX_data = dX.defined() ? dX.data_ptr<T>() : nullptr;
+
+  ScratchScope scratch;
+  float* gamma_data = scratch.allocate<float>(N);
+  weight_to_float(gamma, gamma_data, N, 1.0f);
+
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    int tid = at::get_thread_num();
+    float* dgamma_ptr = dgamma_acc ? dgamma_acc + tid * N : nullptr;
+    float* dbeta_ptr = dbeta_acc ? dbeta_acc + tid * N : nullptr;
+    ScratchScope thread_scratch;
+    float* x_hat = thread_scratch.allocate<float>(N);
+    float* dy = thread_scratch.allocate<float>(N);
+    float* tmp = thread_scratch.allocate<float>(N);
+    for (int64_t i = begin; i < end; i++) {
+      float mean_val = mean_data[i];
+      float rstd_val = rstd_data[i];
+      add_row(a_data + i * N, b_data + i * N, x_hat, tmp, N);
+      at::vec::map<float>(
+          [mean_val, rstd_val](Vec x) {
+            return (x - Vec(mean_val)) * Vec(rstd_val);
+          },
+          x_hat,
+          x_hat,
+          N);
+      at::vec::convert(dY_data + i * N, dy, N);
+      if (dgamma_ptr) {
+        at::vec::map3<float>(
+            [](Vec acc, Vec dy, Vec x_hat) { return acc + dy * x_hat; },
+            dgamma_ptr,
+            dgamma_ptr,
+            dy,
+            x_hat,
+            N);
+      }
+      if (dbeta_ptr) {
+        at::vec::map2<float>(
+            [](Vec acc, Vec dy) { return acc + dy; },
+            dbeta_ptr,
+            dbeta_ptr,
+            dy,
+            N);
+      }
+      if (dX_data) {
+        // dx = rstd * (g - mean(g) - x_hat * mean(g * x_hat)), g = dy * gamma
+        at::vec::map2<float>(
+            [](Vec dy, Vec gamma) { return dy * gamma; },
+            tmp,
+            dy,
+            gamma_data,
+            N);
+        float c1 = at::vec::reduce_all<float>(
+                       [](Vec& x, Vec& y) { return x + y; }, tmp, N) /
+            N;
+        float c2 = at::vec::map2_reduce_all<float>(
+                       [](Vec g, Vec x_hat) { return g * x_hat; },
+                       [](Vec& x, Vec& y) { return x + y; },
+                       tmp,
+                       x_hat,
+                       N) /
+            N;
+        at::vec::map2<float>(
+            [c1, c2, rstd_val](Vec g, Vec x_hat) {
+              return (g - Vec(c1) - x_hat * Vec(c2)) * Vec(rstd_val);
+            },
+            tmp,
+            tmp,
+            x_hat,
+            N);
+        at::vec::convert(tmp, dX_data + i * N, N);
+      }
+    }
+  });
+}
+
+// Sums the rows of the threads into the fp32 grad of a weight
+at::Tensor reduce_weight_grad(
+    const float* acc,
+    int num_threads,
+    int64_t N,
+    const at::Tensor& a) {
+  auto grad = at::empty({N}, a.options().dtype(at::kFloat));
+  float* grad_data = grad.data_ptr<float>();
+  at::parallel_for(0, N, 1024, [&](int64_t begin, int64_t end) {
+    for (int64_t j = begin; j < end; j++) {
+      float sum = 0;
+      for (int t = 0; t < num_threads; t++) {
+        sum += acc[t * N + j];
+      }
+      grad_data[j] = sum;
+    }
+  });
+  return grad;
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+add_layer_norm_backward_kernel_impl(
+    const at::Tensor& dY,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& weight,
+    int64_t M,
+    int64_t N,
+    std::array<bool, 3> grad_input_mask) {
+  at::Tensor dX = grad_input_mask[0]
+      ? at::empty_like(a, at::MemoryFormat::Contiguous)
+      : at::Tensor();
+  // the partial sums of each thread, allocated before the parallel region
+  int num_threads = at::get_num_threads();
+  ScratchScope scratch;
+  float* dgamma_acc = nullptr;
+  float* dbeta_acc = nullptr;
+  if (grad_input_mask[1]) {
+    dgamma_acc = scratch.allocate<float>(num_threads * N);
+    std::fill_n(dgamma_acc, num_threads * N, 0.0f);
+  }
+  if (grad_input_mask[2]) {
+    dbeta_acc = scratch.allocate<float>(num_threads * N);
+    std::fill_n(dbeta_acc, num_threads * N, 0.0f);
+  }
+  if (a.scalar_type() == at::kBFloat16) {
+    add_layer_norm_backward_kernel<at::BFloat16>(
+        dY, a, b, mean, rstd, weight, M, N, dX, dgamma_acc, dbeta_acc);
+  } else {
+    add_layer_norm_backward_kernel<float>(
+        dY, a, b, mean, rstd, weight, M, N, dX, dgamma_acc, dbeta_acc);
+  }
+  at::Tensor dgamma = dgamma_acc
+      ? reduce_weight_grad(dgamma_acc, num_threads, N, a)
+      : at::Tensor();
+  at::Tensor dbeta = dbeta_acc
+      ? reduce_weight_grad(dbeta_acc, num_threads, N, a)
+      : at::Tensor();
+  return std::make_tuple(dX, dgamma, dbeta);
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(add_layer_norm_kernel_stub, &add_layer_norm_kernel_impl);
+REGISTER_DISPATCH(
+    add_layer_norm_forward_kernel_stub,
+    &add_layer_norm_forward_kernel_impl);
+REGISTER_DISPATCH(
+    add_layer_norm_backward_kernel_stub,
+    &add_layer_norm_backward_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -64,19 +64,31 @@ inline std::vector<int64_t> _adjust_strides(
  * - The input tensors are contiguous
  * - The number of the input tensor dimension should be >=2
  * - Only the second input tensor is brodcastable
- * - The datatype for inpusts(a,b) and output are same.
+ * - The inputs (a,b) are fp32 or bf16, converted to fp32 on load. The output
+ *   is of the dtype of at::add(a, b), a bf16 score with a fp32 mask needs no
+ *   cast of the score.
+ *
+ * Rows of at least online_softmax_min_dim elements use the online softmax
+ * kernels, which do not go through a temporary row.
  *
  * @param[in] a a contiguous tensor to be added
  * @param[in] b a tensor to be added while it should be broadcastable
+ * @param[in] keep optional contiguous dropout mask of the shape of a, the
+ * dropped elements are zeroed and the others scaled by keep_scale
  * @return The tensor stores the result of @code softmax(a + b) @endcode
  */
-template <typename scalar_t>
+template <
+    typename scalar_t,
+    typename mask_t = scalar_t,
+    typename out_t = scalar_t>
 at::Tensor dil_div_add_softmax(
     const at::Tensor& a,
     const at::Tensor& b,
-    const float& dim_per_head) {
+    const float& dim_per_head,
+    const bool* keep = nullptr,
+    const float& keep_scale = 1.f) {
   scalar_t* a_data_base = a.data_ptr<scalar_t>();
-  scalar_t* b_data_base = b.data_ptr<scalar_t>();
+  mask_t* b_data_base = b.data_ptr<mask_t>();
 
   // Check if the tensor needs to be broadcasted
   auto infered_size = a.sizes().vec();
@@ -84,9 +96,10 @@ at::Tensor dil_div_add_softmax(
   if (need_broadcast) {
     infered_size = at::infer_size(a.sizes(), b.sizes());
   }
-  at::Tensor output = at::empty_like(a);
   // Create an new tensor to store the output
-  scalar_t* output_data_base = output.data_ptr<scalar_t>();
+  at::Tensor output =
+      at::empty_like(a, a.options().dtype(c10::CppTypeToScalarType<out_t>()));
+  out_t* output_data_base = output.data_ptr<out_t>();
 
   // Calculate the strides for the input tensor
   std::vector<int64_t> b_adjusted_strides = _adjust_strides(b, infered_size);
@@ -110,11 +123,13 @@ at::Tensor dil_div_add_softmax(
     grain_size = 1;
 
   int64_t outer_dims_num = outer_size_per_dim.size();
+  bool online = dim_size >= online_softmax_min_dim;
+  auto r_dim_per_head = _mm512_set1_ps(1.0 / dim_per_head);
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
     float val = 0.0;
     int64_t b_offset = 0;
-    at::Tensor tmp_out = at::empty({dim_size});
-    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    at::Tensor tmp_out = online ? at::Tensor() : at::empty({dim_size});
+    float* tmp_out_ptr = online ? nullptr : tmp_out.data_ptr<float>();
     for (int64_t i = begin; i < end; i++) {
       if (need_broadcast) {
         b_offset =
@@ -122,10 +137,32 @@ at::Tensor dil_div_add_softmax(
       } else {
         b_offset = i * dim_size;
       }
+      const bool* row_keep = keep ? keep + i * dim_size : nullptr;
+      if (online) {
+        const scalar_t* a_row = a_data_base + i * dim_size;
+        const mask_t* b_row = b_data_base + b_offset;
+        auto logits = [&](int j, __mmask16 mask) {
+          return _mm512_fmadd_ps(
+              _maskz_loadu(a_row + j, mask),
+              r_dim_per_head,
+              _maskz_loadu(b_row + j, mask));
+        };
+        float max = 0.f;
+        _dil_online_max_sum_kernel(logits, dim_size, max, val);
+        _dil_online_normalization_kernel<out_t>(
+            logits,
+            max,
+            val,
+            dim_size,
+            output_data_base + i * dim_size,
+            row_keep,
+            keep_scale);
+        continue;
+      }
       // Add a and b and get the maximum value:
       //    output_data = a + b
       //    val = max(output_data)
-      _dil_div_add_reduce_max_fusion_kernel<scalar_t>(
+      _dil_div_add_reduce_max_fusion_kernel<scalar_t, mask_t>(
           a_data_base + i * dim_size,
           b_data_base + b_offset,
           dim_per_head,
@@ -140,13 +177,44 @@ at::Tensor dil_div_add_softmax(
           tmp_out_ptr, dim_size, tmp_out_ptr, val);
       // Calculat the normalization [e^x / sum(e^x)]:
       //    output_data = output_data / sum(output_data)
-      _dil_normalization_kernel<scalar_t>(
-          tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+      if (row_keep) {
+        _dil_normalization_dropout_kernel<out_t>(
+            tmp_out_ptr,
+            val,
+            dim_size,
+            row_keep,
+            keep_scale,
+            output_data_base + i * dim_size);
+      } else {
+        _dil_normalization_kernel<out_t>(
+            tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+      }
     }
   });
   return output;
 } // dil_add_softmax
 
+using div_add_softmax_fn = decltype(&dil_div_add_softmax<float>);
+
+// The instance of dil_div_add_softmax for the dtypes of a and b, nullptr if
+// one of them is neither fp32 nor bf16
+inline div_add_softmax_fn dispatch_div_add_softmax(
+    const at::Tensor& a,
+    const at::Tensor& b) {
+  auto a_type = a.scalar_type();
+  auto b_type = b.scalar_type();
+  if (a_type == at::kFloat && b_type == at::kFloat) {
+    return &dil_div_add_softmax<float>;
+  } else if (a_type == at::kBFloat16 && b_type == at::kBFloat16) {
+    return &dil_div_add_softmax<at::BFloat16>;
+  } else if (a_type == at::kBFloat16 && b_type == at::kFloat) {
+    return &dil_div_add_softmax<at::BFloat16, float, float>;
+  } else if (a_type == at::kFloat && b_type == at::kBFloat16) {
+    return &dil_div_add_softmax<float, at::BFloat16, float>;
+  }
+  return nullptr;
+}
+
 /**
  * @brief Fuse the add operator and softmax
  * operator. softmax(a + b)
@@ -198,6 +266,7 @@ at::Tensor& dil_add_softmax_(at::Tensor& a, const at::Tensor& b) {
     grain_size = 1;
 
   int64_t outer_dims_num = outer_size_per_dim.size();
+  bool online = dim_size >= online_softmax_min_dim;
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
     float val = 0.0;
     int64_t b_offset = 0;
@@ -208,6 +277,20 @@ at::Tensor& dil_add_softmax_(at::Tensor& a, const at::Tensor& b) {
       } else {
         b_offset = i * dim_size;
       }
+      if (online) {
+        float* a_row = a_data_base + i * dim_size;
+        const float* b_row = b_data_base + b_offset;
+        auto logits = [&](int j, __mmask16 mask) {
+          return _mm512_add_ps(
+              _maskz_loadu(a_row + j, mask), _maskz_loadu(b_row + j, mask));
+        };
+        float max = 0.f;
+        _dil_online_max_sum_kernel(logits, dim_size, max, val);
+        // in place, each chunk of a is read before it is overwritten
+        _dil_online_normalization_kernel<float>(
+            logits, max, val, dim_size, a_row);
+        continue;
+      }
       // Add a and b and get the maximum value:
       //    output_data = a + b
       //    val = max(output_data)
@@ -246,11 +329,9 @@ at::Tensor div_add_softmax_kernel_impl(
     const at::Tensor& b,
     const float& dim_per_head) {
 #if defined(CPU_CAPABILITY_AVX512)
-  if (a.scalar_type() == at::kFloat && b.scalar_type() == at::kFloat) {
-    return dil_div_add_softmax<float>(a, b, dim_per_head);
-  } else if (
-      a.scalar_type() == at::kBFloat16 && b.scalar_type() == at::kBFloat16) {
-    return dil_div_add_softmax<at::BFloat16>(a, b, dim_per_head);
+  auto softmax = dispatch_div_add_softmax(a, b);
+  if (softmax) {
+    return softmax(a, b, dim_per_head, nullptr, 1.f);
   }
 #endif
   a = at::div(a, dim_per_head);
@@ -269,12 +350,35 @@ at::Tensor& add_softmax_inplace_kernel_impl(
   return a;
 }
 
+std::tuple<at::Tensor, at::Tensor> div_add_softmax_dropout_kernel_impl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const float& dim_per_head,
+    const float& p) {
+  TORCH_CHECK(p >= 0 && p <= 1, "dropout probability has to be in [0, 1]");
+  auto keep = at::empty(a.sizes(), a.options().dtype(at::kBool));
+  keep.bernoulli_(1 - p);
+  float keep_scale = p < 1 ? 1 / (1 - p) : 0.f;
+#if defined(CPU_CAPABILITY_AVX512)
+  auto softmax = dispatch_div_add_softmax(a, b);
+  if (softmax && a.is_contiguous() && b.stride(-1) == 1) {
+    return std::make_tuple(
+        softmax(a, b, dim_per_head, keep.data_ptr<bool>(), keep_scale), keep);
+  }
+#endif
+  auto output = at::softmax(at::add(at::div(a, dim_per_head), b), -1);
+  return std::make_tuple(output * keep * keep_scale, keep);
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(div_add_softmax_kernel_stub, &div_add_softmax_kernel_impl);
 REGISTER_DISPATCH(
     add_softmax_inplace_kernel_stub,
     &add_softmax_inplace_kernel_impl);
+REGISTER_DISPATCH(
+    div_add_softmax_dropout_kernel_stub,
+    &div_add_softmax_dropout_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
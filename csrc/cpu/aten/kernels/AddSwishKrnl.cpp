@@ -1,65 +1,194 @@
 #include <aten/AddSwish.h>
 
-#include "vec/vec.h"
+#include <ATen/TensorIterator.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <ATen/native/cpu/Loops.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace torch_ipex {
 namespace cpu {
 
 namespace {
 
-#if defined(CPU_CAPABILITY_AVX512)
-
-template <typename scalar_t>
-at::Tensor dil_add_swish(const at::Tensor& mm_output, const at::Tensor& bias) {
-  scalar_t* mm_output_data_base = mm_output.data_ptr<scalar_t>();
-  scalar_t* bias_data_base = bias.data_ptr<scalar_t>();
-
-  auto infered_size = mm_output.sizes().vec();
-  int64_t dim_size = infered_size[infered_size.size() - 1];
-  int64_t outer_size = 1;
-  // The last dim is the loop unit. We need to minus 2 to exclude the last dim.
-  // infered_size.size() - 2 is the -2th dimension.
-  for (int64_t i = infered_size.size() - 2; i >= 0; i--) {
-    // Calculate outer loop number;
-    outer_size *= infered_size[i];
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+template <AddMulEltwise op>
+inline float eltwise(float x) {
+  if constexpr (op == AddMulEltwise::Relu) {
+    return std::max(x, 0.f);
+  } else if constexpr (op == AddMulEltwise::Sigmoid) {
+    return 1.f / (1.f + std::exp(-x));
+  } else if constexpr (op == AddMulEltwise::Hardsigmoid) {
+    return std::min(std::max(x + 3.f, 0.f), 6.f) / 6.f;
+  } else if constexpr (op == AddMulEltwise::Tanh) {
+    return std::tanh(x);
+  } else if constexpr (op == AddMulEltwise::Silu) {
+    return x / (1.f + std::exp(-x));
+  } else if constexpr (op == AddMulEltwise::Gelu) {
+    return x * 0.5f * (1.f + std::erf(x * static_cast<float>(M_SQRT1_2)));
+  } else if constexpr (op == AddMulEltwise::GeluTanh) {
+    const float beta = M_SQRT2 * M_2_SQRTPI * 0.5;
+    const float kappa = 0.044715f;
+    return x * 0.5f * (1.f + std::tanh(beta * (x + kappa * x * x * x)));
+  } else {
+    return x;
+  }
+}
+
+template <AddMulEltwise op>
+inline fVec eltwise(const fVec& x) {
+  const fVec zero(0.f), one(1.f), half(0.5f);
+  if constexpr (op == AddMulEltwise::Relu) {
+    return at::vec::maximum(x, zero);
+  } else if constexpr (op == AddMulEltwise::Sigmoid) {
+    return one / (one + x.neg().exp());
+  } else if constexpr (op == AddMulEltwise::Hardsigmoid) {
+    const fVec three(3.f), six(6.f);
+    return at::vec::minimum(at::vec::maximum(x + three, zero), six) / six;
+  } else if constexpr (op == AddMulEltwise::Tanh) {
+    return x.tanh();
+  } else if constexpr (op == AddMulEltwise::Silu) {
+    return x / (one + x.neg().exp());
+  } else if constexpr (op == AddMulEltwise::Gelu) {
+    return x * half * (one + (x * fVec(M_SQRT1_2)).erf());
+  } else if constexpr (op == AddMulEltwise::GeluTanh) {
+    const fVec beta(M_SQRT2 * M_2_SQRTPI * 0.5);
+    const fVec kappa(0.044715f);
+    auto inner = beta * (x + kappa * x * x * x);
+    return x * half * (one + inner.tanh());
+  } else {
+    return x;
   }
+}
+
+// eltwise(a + b) * c, or eltwise(a + b) * (a + b) without c
+template <AddMulEltwise op>
+inline float add_eltwise_mul(float a, float b, float c) {
+  return eltwise<op>(a + b) * c;
+}
+
+template <AddMulEltwise op>
+inline float add_eltwise_mul(float a, float b) {
+  const float sum = a + b;
+  return eltwise<op>(sum) * sum;
+}
 
-  int64_t grain_size = at::internal::GRAIN_SIZE / (16 * dim_size);
-  if (grain_size < 1)
-    grain_size = 1;
+template <AddMulEltwise op>
+inline fVec add_eltwise_mul(const fVec& a, const fVec& b, const fVec& c) {
+  return eltwise<op>(a + b) * c;
+}
+
+template <AddMulEltwise op>
+inline fVec add_eltwise_mul(const fVec& a, const fVec& b) {
+  const fVec sum = a + b;
+  return eltwise<op>(sum) * sum;
+}
 
-  at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
-    for (int64_t i = begin; i < end; i++) {
-      kernel::_dil_add_swish_fusion_kernel<scalar_t>(
-          mm_output_data_base + i * dim_size, bias_data_base, dim_size);
+// The elements of the iterator, a loop over the broadcast and strided
+// operands, the bfloat16 vectors being computed as two float vectors
+template <typename T, AddMulEltwise op>
+void add_eltwise_mul_loop(at::TensorIterator& iter, bool with_c) {
+  if constexpr (std::is_same<T, float>::value) {
+    if (with_c) {
+      at::native::cpu_kernel_vec(
+          iter,
+          [](float a, float b, float c) -> float {
+            return add_eltwise_mul<op>(a, b, c);
+          },
+          [](fVec a, fVec b, fVec c) -> fVec {
+            return add_eltwise_mul<op>(a, b, c);
+          });
+    } else {
+      at::native::cpu_kernel_vec(
+          iter,
+          [](float a, float b) -> float { return add_eltwise_mul<op>(a, b); },
+          [](fVec a, fVec b) -> fVec { return add_eltwise_mul<op>(a, b); });
     }
-  });
+  } else {
+    if (with_c) {
+      at::native::cpu_kernel_vec(
+          iter,
+          [](at::BFloat16 a, at::BFloat16 b, at::BFloat16 c) -> at::BFloat16 {
+            return add_eltwise_mul<op>(float(a), float(b), float(c));
+          },
+          [](bVec a, bVec b, bVec c) -> bVec {
+            fVec a0, a1, b0, b1, c0, c1;
+            std::tie(a0, a1) = at::vec::convert_bfloat16_float(a);
+            std::tie(b0, b1) = at::vec::convert_bfloat16_float(b);
+            std::tie(c0, c1) = at::vec::convert_bfloat16_float(c);
+            return at::vec::convert_float_bfloat16(
+                add_eltwise_mul<op>(a0, b0, c0),
+                add_eltwise_mul<op>(a1, b1, c1));
+          });
+    } else {
+      at::native::cpu_kernel_vec(
+          iter,
+          [](at::BFloat16 a, at::BFloat16 b) -> at::BFloat16 {
+            return add_eltwise_mul<op>(float(a), float(b));
+          },
+          [](bVec a, bVec b) -> bVec {
+            fVec a0, a1, b0, b1;
+            std::tie(a0, a1) = at::vec::convert_bfloat16_float(a);
+            std::tie(b0, b1) = at::vec::convert_bfloat16_float(b);
+            return at::vec::convert_float_bfloat16(
+                add_eltwise_mul<op>(a0, b0), add_eltwise_mul<op>(a1, b1));
+          });
+    }
+  }
+}
 
-  return mm_output;
-} // dil_add_swish
-#endif
+template <typename T>
+void add_eltwise_mul_dispatch(
+    at::TensorIterator& iter,
+    bool with_c,
+    AddMulEltwise op) {
+#define ADD_ELTWISE_MUL_CASE(OP)                              \
+  case AddMulEltwise::OP:                                     \
+    add_eltwise_mul_loop<T, AddMulEltwise::OP>(iter, with_c); \
+    break;
+  switch (op) {
+    ADD_ELTWISE_MUL_CASE(Identity)
+    ADD_ELTWISE_MUL_CASE(Relu)
+    ADD_ELTWISE_MUL_CASE(Sigmoid)
+    ADD_ELTWISE_MUL_CASE(Hardsigmoid)
+    ADD_ELTWISE_MUL_CASE(Tanh)
+    ADD_ELTWISE_MUL_CASE(Silu)
+    ADD_ELTWISE_MUL_CASE(Gelu)
+    ADD_ELTWISE_MUL_CASE(GeluTanh)
+  }
+#undef ADD_ELTWISE_MUL_CASE
+}
 
-at::Tensor add_swish_kernel_impl(
-    at::Tensor& x,
-    at::Tensor& a,
+void add_eltwise_mul_kernel_impl(
+    const at::Tensor& a,
     const at::Tensor& b,
-    const at::Tensor& c) {
-#if defined(CPU_CAPABILITY_AVX512)
-  if (a.scalar_type() == at::kFloat && c.scalar_type() == at::kFloat) {
-    return dil_add_swish<float>(a, c);
-  } else if (
-      a.scalar_type() == at::kBFloat16 && c.scalar_type() == at::kBFloat16) {
-    return dil_add_swish<at::BFloat16>(a, c);
+    const at::Tensor& c,
+    AddMulEltwise eltwise,
+    at::Tensor& output) {
+  const bool with_c = c.defined();
+  auto config = at::TensorIteratorConfig();
+  config.add_output(output).add_input(a).add_input(b);
+  if (with_c) {
+    config.add_input(c);
+  }
+  auto iter = config.build();
+  if (iter.dtype() == at::kBFloat16) {
+    add_eltwise_mul_dispatch<at::BFloat16>(iter, with_c, eltwise);
+  } else {
+    add_eltwise_mul_dispatch<float>(iter, with_c, eltwise);
+  }
+  if (!output.defined()) {
+    output = iter.output();
   }
-#endif
-  auto lin_res = at::linear(x, b, c);
-  auto sigmoid_res = at::sigmoid(lin_res);
-  return at::mul(lin_res, sigmoid_res);
 }
 
 } // anonymous namespace
 
-REGISTER_DISPATCH(add_swish_kernel_stub, &add_swish_kernel_impl);
+REGISTER_DISPATCH(add_eltwise_mul_kernel_stub, &add_eltwise_mul_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,212 @@
+#include <aten/BCEWithLogitsHead.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "WelfordKrnl.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+template <typename T>
+inline float dot_ker(const T* x, const T* w, int64_t len) {
+  fVec acc(0.f);
+  int64_t d = 0;
+  for (; d < len - (len % fVec::size()); d += fVec::size()) {
+    acc = at::vec::fmadd(
+        load_fvec(x + d, fVec::size()), load_fvec(w + d, fVec::size()), acc);
+  }
+  float sum = at::vec::vec_reduce_all<float>(
+      [](fVec& a, fVec& b) { return a + b; }, acc);
+  for (; d < len; d++) {
+    sum += float(x[d]) * float(w[d]);
+  }
+  return sum;
+}
+
+// out[d] = scale * w[d]
+template <typename T>
+inline void scale_ker(T* out, const T* w, float scale, int64_t len) {
+  const fVec s(scale);
+  for (int64_t d = 0; d < len; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), len - d);
+    store_fvec(out + d, load_fvec(w + d, count) * s, count);
+  }
+}
+
+// acc[d] += scale * x[d]
+template <typename T>
+inline void axpy_ker(float* acc, const T* x, float scale, int64_t len) {
+  const fVec s(scale);
+  for (int64_t d = 0; d < len; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), len - d);
+    auto a = at::vec::fmadd(
+        load_fvec(x + d, count), s, fVec::loadu(acc + d, count));
+    a.store(acc + d, count);
+  }
+}
+
+template <typename T>
+void bce_with_logits_head_forward_kernel(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    float bias,
+    const at::Tensor& target,
+    at::Tensor& logits,
+    at::Tensor& loss) {
+  const int64_t B = input.size(0), K = input.size(1);
+  const T* x = input.data_ptr<T>();
+  const T* w = weight.data_ptr<T>();
+  const float* y = target.data_ptr<float>();
+  float* z = logits.data_ptr<float>();
+
+  // the loss of the rows of a thread is summed in double, the partials of
+  // the threads in a fixed order
+  std::vector<double> partials(at::get_num_threads(), 0.0);
+  at::parallel_for(0, B, 16, [&](int64_t begin, int64_t end) {
+    double sum = 0.0;
+    for (const auto r : c10::irange(begin, end)) {
+      const float logit = dot_ker(x + r * K, w, K) + bias;
+      z[r] = logit;
+      sum += std::max(logit, 0.f) - logit * y[r] +
+          std::log1p(std::exp(-std::abs(logit)));
+    }
+    partials[at::get_thread_num()] += sum;
+  });
+  double total = 0.0;
+  for (const auto partial : partials) {
+    total += partial;
+  }
+  *loss.data_ptr<float>() = static_cast<float>(total / std::max(B, int64_t(1)));
+}
+
+template <typename T>
+void bce_with_logits_head_backward_kernel(
+    float grad,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target,
+    const at::Tensor& logits,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  const int64_t B = input.size(0), K = input.size(1);
+  const T* x = input.data_ptr<T>();
+  const T* w = weight.data_ptr<T>();
+  const float* y = target.data_ptr<float>();
+  const float* z = logits.data_ptr<float>();
+  T* gx = grad_input.data_ptr<T>();
+  const float scale = grad / static_cast<float>(std::max(B, int64_t(1)));
+
+  // a [K] float partial of grad_weight and a partial of grad_bias per thread,
+  // filled in the pass over the rows that writes grad_input
+  const int64_t num_threads = at::get_num_threads();
+  std::vector<float> gw_partials(num_threads * K, 0.f);
+  std::vector<double> gb_partials(num_threads, 0.0);
+  std::vector<char> used(num_threads, 0);
+  at::parallel_for(0, B, 16, [&](int64_t begin, int64_t end) {
+    const int64_t tid = at::get_thread_num();
+    float* gw = gw_partials.data() + tid * K;
+    double gb = 0.0;
+    for (const auto r : c10::irange(begin, end)) {
+      const float dz = scale * (1.f / (1.f + std::exp(-z[r])) - y[r]);
+      scale_ker(gx + r * K, w, dz, K);
+      axpy_ker(gw, x + r * K, dz, K);
+      gb += dz;
+    }
+    gb_partials[tid] += gb;
+    used[tid] = 1;
+  });
+
+  // the partials of the threads are summed over blocks of K
+  T* gw_out = grad_weight.data_ptr<T>();
+  at::parallel_for(0, K, 256, [&](int64_t begin, int64_t end) {
+    const int64_t len = end - begin;
+    std::vector<float> acc(len, 0.f);
+    for (const auto t : c10::irange(num_threads)) {
+      if (!used[t]) {
+        continue;
+      }
+      const float* gw = gw_partials.data() + t * K + begin;
+      for (const auto d : c10::irange(len)) {
+        acc[d] += gw[d];
+      }
+    }
+    for (const auto d : c10::irange(len)) {
+      gw_out[begin + d] = static_cast<T>(acc[d]);
+    }
+  });
+  double gb = 0.0;
+  for (const auto partial : gb_partials) {
+    gb += partial;
+  }
+  *grad_bias.data_ptr<float>() = static_cast<float>(gb);
+}
+
+void bce_with_logits_head_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    float bias,
+    const at::Tensor& target,
+    at::Tensor& logits,
+    at::Tensor& loss) {
+  if (input.scalar_type() == at::kBFloat16) {
+    bce_with_logits_head_forward_kernel<at::BFloat16>(
+        input, weight, bias, target, logits, loss);
+  } else {
+    bce_with_logits_head_forward_kernel<float>(
+        input, weight, bias, target, logits, loss);
+  }
+}
+
+void bce_with_logits_head_backward_kernel_impl(
+    float grad,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& target,
+    const at::Tensor& logits,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  if (input.scalar_type() == at::kBFloat16) {
+    bce_with_logits_head_backward_kernel<at::BFloat16>(
+        grad,
+        input,
+        weight,
+        target,
+        logits,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  } else {
+    bce_with_logits_head_backward_kernel<float>(
+        grad,
+        input,
+        weight,
+        target,
+        logits,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    bce_with_logits_head_forward_kernel_stub,
+    &bce_with_logits_head_forward_kernel_impl);
+REGISTER_DISPATCH(
+    bce_with_logits_head_backward_kernel_stub,
+    &bce_with_logits_head_backward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
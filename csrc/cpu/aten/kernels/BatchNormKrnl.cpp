@@ -0,0 +1,219 @@
+#include <aten/BatchNorm.h>
+
+#include "WelfordKrnl.h"
+
+/*
+ Training batch norm of a channels-last input, seen as [rows, C]. The rows are
+ split in one block per thread: the forward computes the Welford moments of
+ each block in a single read of the input and merges them pairwise, the
+ backward sums dy and dy * (x - mean) of each block the same way, then both
+ apply the per channel scale and shift in a second read.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// rows of a block below which the input is not split further
+const int64_t batch_norm_min_block_rows = 256;
+
+inline int64_t batch_norm_block_rows(int64_t rows) {
+  int64_t blocks = std::min(
+      (rows + batch_norm_min_block_rows - 1) / batch_norm_min_block_rows,
+      static_cast<int64_t>(at::get_num_threads()));
+  blocks = std::max(blocks, static_cast<int64_t>(1));
+  return (rows + blocks - 1) / blocks;
+}
+
+template <typename T>
+void batch_norm_channels_last_kernel(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output,
+    at::Tensor& mean,
+    at::Tensor& var) {
+  int64_t C = input.size(1);
+  int64_t rows = input.numel() / C;
+  int64_t block_rows = batch_norm_block_rows(rows);
+  int64_t blocks = (rows + block_rows - 1) / block_rows;
+  const T* in = input.data_ptr<T>();
+  T* out = output.data_ptr<T>();
+  const float* w = weight.data_ptr<float>();
+  const float* b = bias.data_ptr<float>();
+
+  auto partials = at::empty({blocks, 2, C}, input.options().dtype(at::kFloat));
+  float* p = partials.data_ptr<float>();
+  std::vector<int64_t> counts(blocks);
+  at::parallel_for(0, blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t r0 = i * block_rows;
+      counts[i] = std::min(block_rows, rows - r0);
+      welford_channels_last(
+          in + r0 * C, counts[i], C, p + i * 2 * C, p + i * 2 * C + C);
+    }
+  });
+  welford_merge_partials(p, counts, 1, blocks, C);
+
+  float* mean_data = mean.data_ptr<float>();
+  float* var_data = var.data_ptr<float>();
+  std::vector<float> scale(C), shift(C);
+  for (int64_t c = 0; c < C; c++) {
+    mean_data[c] = p[c];
+    var_data[c] = p[C + c] / rows;
+    float invstd = 1.f / std::sqrt(var_data[c] + static_cast<float>(eps));
+    scale[c] = invstd * w[c];
+    shift[c] = b[c] - mean_data[c] * scale[c];
+  }
+
+  at::parallel_for(0, rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      for (int64_t c = 0; c < C; c += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+        auto y = load_fvec(in + r * C + c, count) *
+                fVec::loadu(scale.data() + c, count) +
+            fVec::loadu(shift.data() + c, count);
+        store_fvec(out + r * C + c, y, count);
+      }
+    }
+  });
+}
+
+template <typename T>
+void batch_norm_channels_last_backward_kernel(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  int64_t C = input.size(1);
+  int64_t rows = input.numel() / C;
+  int64_t block_rows = batch_norm_block_rows(rows);
+  int64_t blocks = (rows + block_rows - 1) / block_rows;
+  const T* dy = grad_output.data_ptr<T>();
+  const T* in = input.data_ptr<T>();
+  const float* w = weight.data_ptr<float>();
+  const float* mean_data = mean.data_ptr<float>();
+  const float* invstd_data = invstd.data_ptr<float>();
+
+  // sum of dy then sum of dy * (x - mean) of each block
+  auto partials = at::zeros({blocks, 2, C}, input.options().dtype(at::kFloat));
+  float* p = partials.data_ptr<float>();
+  at::parallel_for(0, blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t r0 = i * block_rows;
+      int64_t r1 = std::min(r0 + block_rows, rows);
+      float* sum_dy = p + i * 2 * C;
+      float* sum_dy_xmu = sum_dy + C;
+      for (int64_t r = r0; r < r1; r++) {
+        for (int64_t c = 0; c < C; c += fVec::size()) {
+          int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+          auto g = load_fvec(dy + r * C + c, count);
+          auto xmu = load_fvec(in + r * C + c, count) -
+              fVec::loadu(mean_data + c, count);
+          (fVec::loadu(sum_dy + c, count) + g).store(sum_dy + c, count);
+          (fVec::loadu(sum_dy_xmu + c, count) + g * xmu)
+              .store(sum_dy_xmu + c, count);
+        }
+      }
+    }
+  });
+  sum_merge_partials(p, 1, blocks, 2 * C);
+
+  float* grad_weight_data = grad_weight.data_ptr<float>();
+  float* grad_bias_data = grad_bias.data_ptr<float>();
+  // dx = (dy - mean(dy) - (x - mean) * invstd^2 * mean(dy * (x - mean)))
+  //     * invstd * w
+  std::vector<float> k_dy(C), k_mean(C), k_xmu(C);
+  for (int64_t c = 0; c < C; c++) {
+    grad_bias_data[c] = p[c];
+    grad_weight_data[c] = p[C + c] * invstd_data[c];
+    k_dy[c] = invstd_data[c] * w[c];
+    k_mean[c] = p[c] / rows;
+    k_xmu[c] = invstd_data[c] * invstd_data[c] * p[C + c] / rows;
+  }
+  if (!grad_input.defined()) {
+    return;
+  }
+  T* dx = grad_input.data_ptr<T>();
+  at::parallel_for(0, rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      for (int64_t c = 0; c < C; c += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+        auto xmu = load_fvec(in + r * C + c, count) -
+            fVec::loadu(mean_data + c, count);
+        auto g = load_fvec(dy + r * C + c, count) -
+            fVec::loadu(k_mean.data() + c, count) -
+            xmu * fVec::loadu(k_xmu.data() + c, count);
+        store_fvec(
+            dx + r * C + c, g * fVec::loadu(k_dy.data() + c, count), count);
+      }
+    }
+  });
+}
+
+void batch_norm_channels_last_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output,
+    at::Tensor& mean,
+    at::Tensor& var) {
+  if (input.scalar_type() == at::kFloat) {
+    batch_norm_channels_last_kernel<float>(
+        input, weight, bias, eps, output, mean, var);
+  } else {
+    batch_norm_channels_last_kernel<at::BFloat16>(
+        input, weight, bias, eps, output, mean, var);
+  }
+}
+
+void batch_norm_channels_last_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  if (input.scalar_type() == at::kFloat) {
+    batch_norm_channels_last_backward_kernel<float>(
+        grad_output,
+        input,
+        weight,
+        mean,
+        invstd,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  } else {
+    batch_norm_channels_last_backward_kernel<at::BFloat16>(
+        grad_output,
+        input,
+        weight,
+        mean,
+        invstd,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    batch_norm_channels_last_kernel_stub,
+    &batch_norm_channels_last_kernel_impl);
+REGISTER_DISPATCH(
+    batch_norm_channels_last_backward_kernel_stub,
+    &batch_norm_channels_last_backward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
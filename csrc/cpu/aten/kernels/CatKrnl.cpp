@@ -12,6 +12,8 @@
 #include <utils/library.h>
 
 #include <aten/TensorShape.h>
+#include <aten/utils/streaming_store.h>
+#include "vec/vec.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -29,19 +31,20 @@ struct InputMeta {
       : data_ptr(data_ptr), slice_size(slice_size) {}
 };
 
+// the slices shorter than a page are copied through the caches, the fences of
+// the streaming copies would cost more than they save
+constexpr int64_t min_streaming_copy_bytes = 4096;
+
 template <typename scalar_t>
-static inline void copy_stub(scalar_t* result, scalar_t* self, int64_t size) {
-  using Vec = at::vec::Vectorized<scalar_t>;
-  int64_t d = 0;
-  for (; d < size - (size % Vec::size()); d += Vec::size()) {
-    Vec data_vec = Vec::loadu(self + d);
-    data_vec.store(result + d);
-  }
-#if !defined(_MSC_VER) && !defined(COMPILING_FOR_MIN_SIZE)
-#pragma unroll
-#endif
-  for (; d < size; ++d) {
-    result[d] = self[d];
+static inline void copy_stub(
+    scalar_t* result,
+    scalar_t* self,
+    int64_t size,
+    bool streaming) {
+  if (streaming && size * sizeof(scalar_t) >= min_streaming_copy_bytes) {
+    kernel::stream_copy_ker(result, self, size);
+  } else {
+    kernel::copy_ker(result, self, size);
   }
 }
 
@@ -52,7 +55,8 @@ void cat_contig_firstdim_impl(
     int64_t dim,
     int64_t dim_size,
     int64_t inner_size,
-    bool all_same_sizes_and_stride) {
+    bool all_same_sizes_and_stride,
+    bool streaming) {
   scalar_t* result_data = result.data_ptr<scalar_t>();
   int64_t ninputs = static_cast<int64_t>(tensors.size());
 
@@ -84,7 +88,7 @@ void cat_contig_firstdim_impl(
               scalar_t* result_ptr = result_data + ii * inner_size;
               scalar_t* input_ptr =
                   (scalar_t*)(inputs[n].data_ptr) + i * inner_size;
-              copy_stub(result_ptr, input_ptr, inner_size);
+              copy_stub(result_ptr, input_ptr, inner_size, streaming);
               at::native::data_index_step(n, ninputs, i, input_dim_size);
             }
           });
@@ -106,7 +110,7 @@ void cat_contig_firstdim_impl(
               scalar_t* result_ptr = result_data + n * input_slice_size;
               const at::Tensor& input = tensors[n];
               scalar_t* input_data = input.data_ptr<scalar_t>();
-              copy_stub(result_ptr, input_data, input_slice_size);
+              copy_stub(result_ptr, input_data, input_slice_size, streaming);
             }
           });
     }
@@ -120,7 +124,7 @@ void cat_contig_firstdim_impl(
       for (const at::Tensor& tensor : tensors) {
         scalar_t* input_data = tensor.data_ptr<scalar_t>();
         int64_t input_slice_size = tensor.numel();
-        copy_stub(result_ptr, input_data, input_slice_size);
+        copy_stub(result_ptr, input_data, input_slice_size, streaming);
         result_ptr += input_slice_size;
       }
     } else if (ninputs < 64) {
@@ -143,7 +147,7 @@ void cat_contig_firstdim_impl(
             for (const auto i : c10::irange(begin, end)) {
               scalar_t* result_ptr = result_data + i * inner_size;
               scalar_t* input_ptr = (scalar_t*)(inputs[i].data_ptr);
-              copy_stub(result_ptr, input_ptr, inner_size);
+              copy_stub(result_ptr, input_ptr, inner_size, streaming);
             }
           });
     } else {
@@ -169,7 +173,7 @@ void cat_contig_firstdim_impl(
               scalar_t* result_ptr = result_data + input_offset;
               const at::Tensor& input = tensors[n];
               scalar_t* input_data = input.data_ptr<scalar_t>();
-              copy_stub(result_ptr, input_data, input_slice_size);
+              copy_stub(result_ptr, input_data, input_slice_size, streaming);
             }
           });
     }
@@ -281,7 +285,8 @@ void cat_contig_non_firstdim_impl(
     int64_t outer_size,
     int64_t dim_size,
     int64_t inner_size,
-    bool all_same_sizes_and_stride) {
+    bool all_same_sizes_and_stride,
+    bool streaming) {
   scalar_t* result_data = result.data_ptr<scalar_t>();
   int64_t ninputs = static_cast<int64_t>(tensors.size());
   std::vector<InputMeta> inputs;
@@ -315,7 +320,7 @@ void cat_contig_non_firstdim_impl(
               int64_t input_slice_size = inputs[j].slice_size;
               scalar_t* input_ptr =
                   (scalar_t*)(inputs[j].data_ptr) + i * input_slice_size;
-              copy_stub(result_ptr, input_ptr, input_slice_size);
+              copy_stub(result_ptr, input_ptr, input_slice_size, streaming);
               result_ptr += input_slice_size;
             }
           }
@@ -373,9 +378,19 @@ void cpu_cat_contig_dispatch(
   //   b. for generic cases, simply parallel on outer_size and copy the input
   //   slice one by one.
   //
+  //  The copies write the result with non-temporal stores when it is bigger
+  //  than the streaming store threshold.
+  //
+  bool streaming = use_streaming_store(result.nbytes());
   if (outer_size == 1) {
     cat_contig_firstdim_impl<scalar_t>(
-        result, tensors, dim, dim_size, inner_size, all_same_sizes_and_stride);
+        result,
+        tensors,
+        dim,
+        dim_size,
+        inner_size,
+        all_same_sizes_and_stride,
+        streaming);
   } else {
     cat_contig_non_firstdim_impl<scalar_t>(
         result,
@@ -384,7 +399,8 @@ void cpu_cat_contig_dispatch(
         outer_size,
         dim_size,
         inner_size,
-        all_same_sizes_and_stride);
+        all_same_sizes_and_stride,
+        streaming);
   }
 }
 
@@ -393,8 +409,13 @@ void cat_contig_kernel(
     const at::MaterializedITensorListRef& tensors,
     int64_t dim,
     bool all_same_sizes_and_stride) {
-  AT_DISPATCH_FLOATING_TYPES_AND(
-      ScalarType::BFloat16, result.scalar_type(), "cat_contig_kernel", [&]() {
+  AT_DISPATCH_ALL_TYPES_AND3(
+      ScalarType::Half,
+      ScalarType::BFloat16,
+      ScalarType::Bool,
+      result.scalar_type(),
+      "cat_contig_kernel",
+      [&]() {
         cpu_cat_contig_dispatch<scalar_t>(
             result, tensors, dim, all_same_sizes_and_stride);
       });
@@ -0,0 +1,269 @@
+#include <aten/ConcatBnEltwise.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/accumulate.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "WelfordKrnl.h"
+#include "utils/parallel_stats.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The elements of the block of an input transformed by a task
+constexpr int64_t kBlock = 4096;
+
+template <ConcatEltwise op>
+inline fVec eltwise(const fVec& x) {
+  const fVec zero(0.f), one(1.f), half(0.5f);
+  if constexpr (op == ConcatEltwise::Relu) {
+    return at::vec::maximum(x, zero);
+  } else if constexpr (op == ConcatEltwise::Relu6) {
+    return at::vec::minimum(at::vec::maximum(x, zero), fVec(6.f));
+  } else if constexpr (op == ConcatEltwise::Silu) {
+    return x / (one + x.neg().exp());
+  } else if constexpr (op == ConcatEltwise::Gelu) {
+    return x * half * (one + (x * fVec(M_SQRT1_2)).erf());
+  } else if constexpr (op == ConcatEltwise::GeluTanh) {
+    const fVec beta(M_SQRT2 * M_2_SQRTPI * 0.5);
+    const fVec kappa(0.044715f);
+    auto inner = beta * (x + kappa * x * x * x);
+    return x * half * (one + inner.tanh());
+  } else {
+    return x;
+  }
+}
+
+// out[i] = eltwise(scale[i] * in[i] + shift[i]), the channel varying with i
+template <typename T, ConcatEltwise op>
+inline void affine_eltwise_channels(
+    const T* in,
+    T* out,
+    const float* scale,
+    const float* shift,
+    int64_t len) {
+  for (int64_t i = 0; i < len; i += fVec::size()) {
+    const int64_t count = std::min<int64_t>(fVec::size(), len - i);
+    auto x = at::vec::fmadd(
+        load_fvec(in + i, count),
+        fVec::loadu(scale + i, count),
+        fVec::loadu(shift + i, count));
+    store_fvec(out + i, eltwise<op>(x), count);
+  }
+}
+
+// out[i] = eltwise(scale * in[i] + shift) of a single channel
+template <typename T, ConcatEltwise op>
+inline void affine_eltwise_channel(
+    const T* in,
+    T* out,
+    float scale,
+    float shift,
+    int64_t len) {
+  const fVec vscale(scale), vshift(shift);
+  for (int64_t i = 0; i < len; i += fVec::size()) {
+    const int64_t count = std::min<int64_t>(fVec::size(), len - i);
+    auto x = at::vec::fmadd(load_fvec(in + i, count), vscale, vshift);
+    store_fvec(out + i, eltwise<op>(x), count);
+  }
+}
+
+// The output in its memory order is [outer, D, inner] of the concat dim of D
+// elements, input j being the block [outer, D_j, inner] at the offset
+// offsets[j] of D. The channel of the output element g is g / channel_stride
+// % channels, the channel dim being after, at or before the concat dim.
+struct ConcatPlan {
+  int64_t outer;
+  int64_t inner;
+  int64_t concat_size;
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> sizes;
+  int64_t channels;
+  int64_t channel_stride;
+};
+
+template <typename T, ConcatEltwise op>
+void concat_bn_eltwise_kernel(
+    const std::vector<const T*>& inputs,
+    T* output,
+    const float* scale,
+    const float* shift,
+    const ConcatPlan& plan) {
+  const int64_t num_inputs = inputs.size();
+  const int64_t inner = plan.inner, C = plan.channels;
+  const int64_t channel_stride = plan.channel_stride;
+  // a task is a block of kBlock elements of an input and an outer index
+  std::vector<int64_t> block_begin(num_inputs + 1, 0);
+  for (const auto j : c10::irange(num_inputs)) {
+    block_begin[j + 1] =
+        block_begin[j] + at::divup(plan.sizes[j] * inner, kBlock);
+  }
+  const int64_t num_blocks = block_begin[num_inputs];
+  const int64_t block_size = plan.concat_size * inner / num_blocks;
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, block_size));
+  utils::parallel_for(
+      0, plan.outer * num_blocks, grain_size, [&](int64_t begin, int64_t end) {
+        for (const auto t : c10::irange(begin, end)) {
+          const int64_t o = t / num_blocks, b = t % num_blocks;
+          const int64_t j =
+              std::upper_bound(block_begin.begin(), block_begin.end(), b) -
+              block_begin.begin() - 1;
+          const int64_t len = plan.sizes[j] * inner;
+          const int64_t e0 = (b - block_begin[j]) * kBlock;
+          const int64_t e1 = std::min(len, e0 + kBlock);
+          const int64_t base = (o * plan.concat_size + plan.offsets[j]) * inner;
+          const T* in = inputs[j] + o * len;
+          T* out = output + base;
+          // the runs of the elements of consecutive channels (channels last)
+          // or of a channel
+          for (int64_t e = e0; e < e1;) {
+            const int64_t g = base + e;
+            const int64_t c = g / channel_stride % C;
+            int64_t run;
+            if (channel_stride == 1) {
+              run = std::min(e1 - e, C - c);
+              affine_eltwise_channels<T, op>(
+                  in + e, out + e, scale + c, shift + c, run);
+            } else {
+              run = std::min(e1 - e, channel_stride - g % channel_stride);
+              affine_eltwise_channel<T, op>(
+                  in + e, out + e, scale[c], shift[c], run);
+            }
+            e += run;
+          }
+        }
+      });
+}
+
+template <typename T>
+void concat_bn_eltwise_dispatch(
+    const c10::List<at::Tensor>& a,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    ConcatEltwise op,
+    const ConcatPlan& plan,
+    at::Tensor& output) {
+  std::vector<const T*> inputs;
+  for (const at::Tensor& t : a) {
+    inputs.push_back(t.data_ptr<T>());
+  }
+  const float* scale_data = scale.data_ptr<float>();
+  const float* shift_data = shift.data_ptr<float>();
+  T* out = output.data_ptr<T>();
+#define CONCAT_BN_ELTWISE_CASE(OP)                  \
+  case ConcatEltwise::OP:                           \
+    concat_bn_eltwise_kernel<T, ConcatEltwise::OP>( \
+        inputs, out, scale_data, shift_data, plan); \
+    break;
+  switch (op) {
+    CONCAT_BN_ELTWISE_CASE(Identity)
+    CONCAT_BN_ELTWISE_CASE(Relu)
+    CONCAT_BN_ELTWISE_CASE(Relu6)
+    CONCAT_BN_ELTWISE_CASE(Silu)
+    CONCAT_BN_ELTWISE_CASE(Gelu)
+    CONCAT_BN_ELTWISE_CASE(GeluTanh)
+  }
+#undef CONCAT_BN_ELTWISE_CASE
+}
+
+at::Tensor concat_bn_eltwise_kernel_impl(
+    const c10::List<at::Tensor>& a,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    int64_t dim,
+    ConcatEltwise op) {
+  if (a.size() == 0) {
+    return at::Tensor();
+  }
+  const at::Tensor first = a.get(0);
+  const int64_t ndim = first.dim();
+  const auto dtype = first.scalar_type();
+  if (ndim < 2 || (dtype != at::kFloat && dtype != at::kBFloat16)) {
+    return at::Tensor();
+  }
+  dim = at::maybe_wrap_dim(dim, ndim);
+  // the inputs share a layout, dense in it, and the sizes but at dim
+  const auto format = first.suggest_memory_format();
+  std::vector<int64_t> output_sizes = first.sizes().vec();
+  output_sizes[dim] = 0;
+  ConcatPlan plan;
+  for (const at::Tensor& t : a) {
+    if (t.dim() != ndim || t.scalar_type() != dtype ||
+        !t.is_contiguous(format)) {
+      return at::Tensor();
+    }
+    for (const auto d : c10::irange(ndim)) {
+      if (d != dim && t.size(d) != first.size(d)) {
+        return at::Tensor();
+      }
+    }
+    plan.offsets.push_back(output_sizes[dim]);
+    plan.sizes.push_back(t.size(dim));
+    output_sizes[dim] += t.size(dim);
+  }
+  const int64_t channels = output_sizes[1];
+  if (scale.scalar_type() != at::kFloat || shift.scalar_type() != at::kFloat ||
+      !scale.is_contiguous() || !shift.is_contiguous() ||
+      scale.numel() != channels || shift.numel() != channels ||
+      c10::multiply_integers(output_sizes) == 0) {
+    return at::Tensor();
+  }
+
+  // the dims in the memory order, the channels innermost for channels last
+  std::vector<int64_t> order(ndim);
+  std::iota(order.begin(), order.end(), 0);
+  if (format == at::MemoryFormat::ChannelsLast ||
+      format == at::MemoryFormat::ChannelsLast3d) {
+    order.erase(order.begin() + 1);
+    order.push_back(1);
+  }
+  const int64_t dim_pos =
+      std::find(order.begin(), order.end(), dim) - order.begin();
+  const int64_t channel_pos =
+      std::find(order.begin(), order.end(), 1) - order.begin();
+  plan.outer = 1;
+  plan.inner = 1;
+  plan.channel_stride = 1;
+  for (const auto k : c10::irange(ndim)) {
+    const int64_t size = output_sizes[order[k]];
+    if (k < dim_pos) {
+      plan.outer *= size;
+    } else if (k > dim_pos) {
+      plan.inner *= size;
+    }
+    if (k > channel_pos) {
+      plan.channel_stride *= size;
+    }
+  }
+  plan.concat_size = output_sizes[dim];
+  plan.channels = channels;
+
+  auto output = at::empty(output_sizes, first.options().memory_format(format));
+  utils::ParallelStatsScope parallel_stats_scope("concat_bn_eltwise");
+  if (dtype == at::kBFloat16) {
+    concat_bn_eltwise_dispatch<at::BFloat16>(
+        a, scale, shift, op, plan, output);
+  } else {
+    concat_bn_eltwise_dispatch<float>(a, scale, shift, op, plan, output);
+  }
+  return output;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    concat_bn_eltwise_kernel_stub,
+    &concat_bn_eltwise_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,4 +1,5 @@
 #include <aten/Converter.h>
+#include <aten/utils/streaming_store.h>
 #include "vec/vec.h"
 
 #include <torch/all.h>
@@ -20,24 +21,34 @@ void fp32_to_bf16(void* dst, const void* src, int len) {
   FP32_2_BF16((at::BFloat16*)dst, (float*)src, len);
 }
 
-at::Tensor cat_bfloat16_float_kernel_impl(
-    const at::Tensor top_half_,
-    const at::Tensor bottom_half_) {
+void cat_bfloat16_float_kernel_impl(
+    const at::Tensor& top_half_,
+    const at::Tensor& bottom_half_,
+    at::Tensor& output) {
   at::Tensor top_half = top_half_.contiguous();
   at::Tensor bottom_half = bottom_half_.contiguous();
-  at::Tensor output = at::empty_strided(
-      top_half_.sizes(),
-      top_half_.strides(),
-      top_half_.options().dtype(at::kFloat));
-  at::Tensor output_contiguous = output.contiguous();
+  // a strided output, e.g. a view of a checkpoint buffer, is written through a
+  // contiguous temporary
+  at::Tensor output_contiguous = output.is_contiguous()
+      ? output
+      : at::empty(output.sizes(), output.options());
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
   at::BFloat16* top_half_data = top_half.data_ptr<at::BFloat16>();
   at::BFloat16* bottom_half_data = bottom_half.data_ptr<at::BFloat16>();
   float* output_data = output_contiguous.data_ptr<float>();
+  int64_t numel = top_half.numel();
+  bool streaming = use_streaming_store(output_contiguous.nbytes());
   int64_t grain_size = 512;
   at::parallel_for(
-      0, top_half.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      0, numel, grain_size, [&](int64_t begin, int64_t end) {
+        if (streaming) {
+          // align the output chunk of each thread for the streaming stores
+          begin = begin == 0
+              ? 0
+              : kernel::align_chunk_bound(output_data, begin, numel);
+          end = kernel::align_chunk_bound(output_data, end, numel);
+        }
         // local pointers
         at::BFloat16* top_half_ptr = top_half_data + begin;
         at::BFloat16* bottom_half_ptr = bottom_half_data + begin;
@@ -50,42 +61,54 @@ at::Tensor cat_bfloat16_float_kernel_impl(
           fVec fvec, fvec2;
           std::tie(fvec, fvec2) =
               pack_bfloat16_float(top_half_bvec, bottom_half_bvec);
-          fvec.store(output_ptr + d);
-          fvec2.store(output_ptr + d + fVec::size());
+          kernel::store_vec(output_ptr + d, fvec, streaming);
+          kernel::store_vec(output_ptr + d + fVec::size(), fvec2, streaming);
         }
         for (; d < size; d++) {
           output_ptr[d] =
               at::vec::pack_bfloat16_float(top_half_ptr[d], bottom_half_ptr[d]);
         }
+        if (streaming) {
+          _mm_sfence();
+        }
       });
   if (!output.is_contiguous()) {
     output.copy_(output_contiguous);
   }
-  return output;
 }
 
-std::tuple<at::Tensor, at::Tensor> split_float_bfloat16_kernel_impl(
-    const at::Tensor tensor_) {
+void split_float_bfloat16_kernel_impl(
+    const at::Tensor& tensor_,
+    at::Tensor& top_half,
+    at::Tensor& bottom_half) {
   auto tensor = tensor_.contiguous();
-  auto top_half = at::empty_strided(
-      tensor_.sizes(),
-      tensor_.strides(),
-      tensor_.options().dtype(at::kBFloat16));
-  auto top_half_contiguous = top_half.contiguous();
-  auto bottom_half = at::empty_strided(
-      tensor_.sizes(),
-      tensor_.strides(),
-      tensor_.options().dtype(at::kBFloat16));
-  auto bottom_half_contiguous = bottom_half.contiguous();
+  auto top_half_contiguous = top_half.is_contiguous()
+      ? top_half
+      : at::empty(top_half.sizes(), top_half.options());
+  auto bottom_half_contiguous = bottom_half.is_contiguous()
+      ? bottom_half
+      : at::empty(bottom_half.sizes(), bottom_half.options());
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
   at::BFloat16* top_half_data = top_half_contiguous.data_ptr<at::BFloat16>();
   at::BFloat16* bottom_half_data =
       bottom_half_contiguous.data_ptr<at::BFloat16>();
   float* tensor_data = tensor.data_ptr<float>();
+  int64_t numel = top_half.numel();
+  bool streaming = use_streaming_store(
+      top_half_contiguous.nbytes() + bottom_half_contiguous.nbytes());
   int64_t grain_size = 512;
   at::parallel_for(
-      0, top_half.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      0, numel, grain_size, [&](int64_t begin, int64_t end) {
+        if (streaming) {
+          // align the output chunks of each thread for the streaming stores
+          // on top_half, bottom_half being stored normally if it isn't
+          // aligned as top_half, e.g. the views of a parameter and its trail
+          begin = begin == 0
+              ? 0
+              : kernel::align_chunk_bound(top_half_data, begin, numel);
+          end = kernel::align_chunk_bound(top_half_data, end, numel);
+        }
         // local pointers
         at::BFloat16* top_half_ptr = top_half_data + begin;
         at::BFloat16* bottom_half_ptr = bottom_half_data + begin;
@@ -98,8 +121,8 @@ std::tuple<at::Tensor, at::Tensor> split_float_bfloat16_kernel_impl(
           bVec top_half_bvec, bottom_half_bvec;
           std::tie(top_half_bvec, bottom_half_bvec) =
               unpack_float_bfloat16(fvec, fvec2);
-          top_half_bvec.store(top_half_ptr + d);
-          bottom_half_bvec.store(bottom_half_ptr + d);
+          kernel::store_vec(top_half_ptr + d, top_half_bvec, streaming);
+          kernel::store_vec(bottom_half_ptr + d, bottom_half_bvec, streaming);
         }
         for (; d < size; d++) {
           at::BFloat16 top_half_val;
@@ -109,12 +132,16 @@ std::tuple<at::Tensor, at::Tensor> split_float_bfloat16_kernel_impl(
           top_half_ptr[d] = top_half_val;
           bottom_half_ptr[d] = bottom_half_val;
         }
+        if (streaming) {
+          _mm_sfence();
+        }
       });
   if (!top_half.is_contiguous()) {
     top_half.copy_(top_half_contiguous);
+  }
+  if (!bottom_half.is_contiguous()) {
     bottom_half.copy_(bottom_half_contiguous);
   }
-  return std::tie(top_half, bottom_half);
 }
 
 } // anonymous namespace
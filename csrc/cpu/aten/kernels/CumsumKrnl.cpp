@@ -1,4 +1,6 @@
+#include <ATen/Dispatch.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/OpMathType.h>
 #include <ATen/WrapDimUtils.h>
 #include <ATen/cpu/vec/functional.h>
 #include <ATen/cpu/vec/vec.h>
@@ -8,6 +10,10 @@
 #include <aten/Cumsum.h>
 
 #include <immintrin.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -22,129 +28,293 @@ inline int64_t divup(int64_t x, int64_t y) {
   return (x + y - 1) / y;
 }
 
-template <typename scalar_t>
-static inline void cumsum_lastdim_kernel(
-    at::Tensor& result,
-    const at::Tensor& self,
-    int64_t dim) {
-  const auto input_ndim = self.dim();
-  TORCH_CHECK(
-      dim == input_ndim - 1,
-      "cumsum_lastdim_kernel: expect dim to be ",
-      input_ndim - 1,
-      " got ",
-      dim);
-  TORCH_CHECK(
-      self.scalar_type() == result.scalar_type(),
-      "cumsum_lastdim_kernel: expect same data type for self and result");
-
-  if (result.sizes() != self.sizes()) {
-    result.resize_as_(self);
-  }
-  if (self.numel() == 0) {
-    return;
+// The bytes of the columns of a block kept in L2 between the up-sweep and
+// the down-sweep, per core
+constexpr int64_t kL2BytesPerCore = 256 * 1024;
+// The minimal elements of a chunk of the scanned dim
+constexpr int64_t kMinScanChunk = 4096;
+// The inner elements scanned together by a task
+constexpr int64_t kBlockK = 256;
+
+template <typename T>
+inline T log_add_exp(T x, T y) {
+  // std::min and std::max return their first argument if one of them is nan
+  T min = std::isnan(y) ? y : std::min(x, y);
+  T max = std::isnan(y) ? y : std::max(x, y);
+  if (min != max || std::isfinite(min)) {
+    return max + std::log1p(std::exp(min - max));
   }
-  if (input_ndim == 0) {
-    result.fill_(self);
-    return;
-  }
-
-  int64_t N = self.size(dim);
-  int64_t M = self.numel() / N;
-  const scalar_t* self_data = self.data_ptr<scalar_t>();
-  scalar_t* result_data = result.data_ptr<scalar_t>();
-
-  int64_t T = at::get_num_threads();
+  // both -inf or both inf
+  return x;
+}
 
-  // bytes per core for each chunk, set to 256KB (L2 cache reside)
-  constexpr int64_t CHUNK_SIZE_PER_CORE = 256 * 1024 / sizeof(scalar_t);
-  int64_t CHUNK_SIZE = std::max(int64_t(1), CHUNK_SIZE_PER_CORE / M * T);
-  int64_t K = divup(N, CHUNK_SIZE);
+struct SumOp {
+  template <typename T>
+  static T identity() {
+    return T(0);
+  }
+  template <typename T>
+  static T combine(T a, T b) {
+    return a + b;
+  }
+};
 
-  // offset value per chunk
-  std::vector<scalar_t> outer_offsets(M, scalar_t(0));
+struct ProdOp {
+  template <typename T>
+  static T identity() {
+    return T(1);
+  }
+  template <typename T>
+  static T combine(T a, T b) {
+    return a * b;
+  }
+};
 
-  // offset value per thread
-  std::vector<scalar_t> inner_offsets(M * T, scalar_t(0));
+struct LogSumExpOp {
+  template <typename T>
+  static T identity() {
+    return -std::numeric_limits<T>::infinity();
+  }
+  template <typename T>
+  static T combine(T a, T b) {
+    return log_add_exp(a, b);
+  }
+};
 
-  for (int64_t k = 0; k < K; k++) {
-    int64_t k_begin = k * CHUNK_SIZE;
-    int64_t k_end = std::min(k_begin + CHUNK_SIZE, N);
+// The local scan of the rows [n0, n1) of the columns [k0, k1) of "in", of K
+// elements a row, from "init" (the identity if null), its last row being
+// stored in "total".
+template <typename scalar_t, typename Op>
+void scan_chunk(
+    const scalar_t* in,
+    scalar_t* out,
+    int64_t n0,
+    int64_t n1,
+    int64_t K,
+    int64_t k0,
+    int64_t k1,
+    const at::opmath_type<scalar_t>* init,
+    at::opmath_type<scalar_t>* total) {
+  using acc_t = at::opmath_type<scalar_t>;
+  if (K == 1) {
+    acc_t run = init ? init[0] : Op::template identity<acc_t>();
+    if constexpr (
+        std::is_same<Op, SumOp>::value &&
+        std::is_same<scalar_t, acc_t>::value) {
+      // the vectorized prefix sum
+      prefix_sum<scalar_t>(in + n0, out + n0, run, n1 - n0);
+      run = n1 > n0 ? out[n1 - 1] : run;
+    } else {
+      for (int64_t n = n0; n < n1; n++) {
+        run = Op::combine(run, static_cast<acc_t>(in[n]));
+        out[n] = static_cast<scalar_t>(run);
+      }
+    }
+    total[0] = run;
+    return;
+  }
+  std::array<acc_t, kBlockK> run;
+  for (int64_t k = k0; k < k1; k++) {
+    run[k - k0] = init ? init[k] : Op::template identity<acc_t>();
+  }
+  for (int64_t n = n0; n < n1; n++) {
+    const scalar_t* in_row = in + n * K;
+    scalar_t* out_row = out + n * K;
+    for (int64_t k = k0; k < k1; k++) {
+      run[k - k0] = Op::combine(run[k - k0], static_cast<acc_t>(in_row[k]));
+      out_row[k] = static_cast<scalar_t>(run[k - k0]);
+    }
+  }
+  for (int64_t k = k0; k < k1; k++) {
+    total[k] = run[k - k0];
+  }
+}
 
-    // Parallel Path I: accumulate locally per thread
-    at::parallel_for(k_begin, k_end, 1, [&](int64_t begin, int64_t end) {
-      int64_t tid = at::get_thread_num();
-      for (int64_t m = 0; m < M; m++) {
-        const scalar_t* self_ptr = self_data + m * N + begin;
-        scalar_t* result_ptr = result_data + m * N + begin;
-        int64_t len = end - begin;
+// out[n, k] = offset[k] op out[n, k] for the rows [n0, n1) and the columns
+// [k0, k1)
+template <typename scalar_t, typename Op>
+void apply_offset(
+    scalar_t* out,
+    int64_t n0,
+    int64_t n1,
+    int64_t K,
+    int64_t k0,
+    int64_t k1,
+    const at::opmath_type<scalar_t>* offset) {
+  using acc_t = at::opmath_type<scalar_t>;
+  if constexpr (
+      std::is_same<Op, SumOp>::value && std::is_same<scalar_t, acc_t>::value) {
+    if (K == 1) {
+      const scalar_t value = offset[0];
+      at::vec::map(
+          [=](Vectorized<scalar_t> x) {
+            return x + Vectorized<scalar_t>(value);
+          },
+          out + n0,
+          out + n0,
+          n1 - n0);
+      return;
+    }
+  }
+  for (int64_t n = n0; n < n1; n++) {
+    scalar_t* out_row = out + n * K;
+    for (int64_t k = k0; k < k1; k++) {
+      out_row[k] = static_cast<scalar_t>(
+          Op::combine(offset[k], static_cast<acc_t>(out_row[k])));
+    }
+  }
+}
 
-        prefix_sum<scalar_t>(self_ptr, result_ptr, scalar_t(0), len);
-        inner_offsets[m * T + tid] = result_ptr[len - 1];
-      }
+// The scan of the contiguous [M, N, K] input along N. The M * K columns are
+// scanned by the tasks of a row of M and kBlockK columns. When they don't keep
+// the threads busy, e.g. a few rows of 1M elements, N is cut into chunks
+// scanned locally from the identity (up-sweep), whose totals are scanned in
+// turn and applied as the offsets of the next chunks (down-sweep), block by
+// block of N so that the output of a block is still in L2 when offset.
+template <typename scalar_t, typename Op>
+void scan_kernel(
+    at::Tensor& result,
+    const at::Tensor& self,
+    int64_t M,
+    int64_t N,
+    int64_t K) {
+  using acc_t = at::opmath_type<scalar_t>;
+  const scalar_t* in = self.data_ptr<scalar_t>();
+  scalar_t* out = result.data_ptr<scalar_t>();
+
+  const int64_t T = at::get_num_threads();
+  const int64_t KB = divup(K, kBlockK);
+  const int64_t tasks = M * KB;
+  const int64_t C = tasks >= T
+      ? 1
+      : std::max(int64_t(1), std::min(divup(T, tasks), N / kMinScanChunk));
+  const int64_t block = C == 1
+      ? N
+      : std::max(
+            C * kMinScanChunk,
+            kL2BytesPerCore / int64_t(sizeof(scalar_t)) * T / (M * K));
+
+  // the scan of the columns up to the current block
+  std::vector<acc_t> carry(M * K, Op::template identity<acc_t>());
+  // the totals [M, C, K] of the chunks, then their offsets
+  std::vector<acc_t> totals(M * C * K);
+  for (int64_t n_begin = 0; n_begin < N; n_begin += block) {
+    const int64_t len = std::min(block, N - n_begin);
+    // task t is the chunk c of the columns [k0, k1) of the row m
+    auto for_each_chunk = [&](const auto& f) {
+      at::parallel_for(0, tasks * C, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t t = begin; t < end; t++) {
+          const int64_t c = t % C, m = t / C / KB;
+          const int64_t k0 = t / C % KB * kBlockK;
+          f(m,
+            c,
+            k0,
+            std::min(K, k0 + kBlockK),
+            n_begin + len * c / C,
+            n_begin + len * (c + 1) / C);
+        }
+      });
+    };
+
+    // up-sweep, the first chunk from the carry
+    for_each_chunk([&](int64_t m,
+                       int64_t c,
+                       int64_t k0,
+                       int64_t k1,
+                       int64_t n0,
+                       int64_t n1) {
+      scan_chunk<scalar_t, Op>(
+          in + m * N * K,
+          out + m * N * K,
+          n0,
+          n1,
+          K,
+          k0,
+          k1,
+          c == 0 ? carry.data() + m * K : nullptr,
+          totals.data() + (m * C + c) * K);
     });
+    if (C == 1) {
+      carry = totals;
+      continue;
+    }
 
-    // update offset value for each thread
+    // the exclusive scan of the totals of each column
     for (int64_t m = 0; m < M; m++) {
-      for (int64_t t = T - 1; t >= 0; t--) {
-        scalar_t offset = scalar_t(0);
-        for (int64_t i = t - 1; i >= 0; i--) {
-          offset += inner_offsets[m * T + i];
+      for (int64_t k = 0; k < K; k++) {
+        acc_t run = totals[m * C * K + k];
+        for (int64_t c = 1; c < C; c++) {
+          acc_t total = totals[(m * C + c) * K + k];
+          totals[(m * C + c) * K + k] = run;
+          run = Op::combine(run, total);
         }
-        inner_offsets[m * T + t] = offset;
+        carry[m * K + k] = run;
       }
     }
 
-    // Parallel Path II: apply offset (result should be in L2)
-    at::parallel_for(k_begin, k_end, 1, [&](int64_t begin, int64_t end) {
-      int64_t tid = at::get_thread_num();
-      for (int64_t m = 0; m < M; m++) {
-        scalar_t* result_ptr = result_data + m * N + begin;
-        int64_t len = end - begin;
-
-        scalar_t offset = outer_offsets[m] + inner_offsets[m * T + tid];
-        at::vec::map(
-            [=](Vectorized<scalar_t> x) {
-              return x + Vectorized<scalar_t>(offset);
-            },
-            result_ptr,
-            result_ptr,
-            len);
+    // down-sweep of the chunks after the first one
+    for_each_chunk([&](int64_t m,
+                       int64_t c,
+                       int64_t k0,
+                       int64_t k1,
+                       int64_t n0,
+                       int64_t n1) {
+      if (c > 0) {
+        apply_offset<scalar_t, Op>(
+            out + m * N * K,
+            n0,
+            n1,
+            K,
+            k0,
+            k1,
+            totals.data() + (m * C + c) * K);
       }
     });
-
-    // reinit inner offset value
-    std::fill(inner_offsets.begin(), inner_offsets.end(), scalar_t(0));
-
-    // update outer offset value
-    for (int64_t m = 0; m < M; m++) {
-      outer_offsets[m] = result_data[m * N + k_end - 1];
-    }
   }
 }
 
-bool cumsum_fast_path(
+bool scan_kernel_impl(
+    at::Tensor& result,
     const at::Tensor& self,
-    const at::Tensor& result,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype) {
-  // check contiguous
-  bool is_contig = self.is_contiguous() && (result.is_contiguous());
-  if (!is_contig)
-    return false;
-  // check dim
-  auto wrap_dim = at::maybe_wrap_dim(dim, self.dim());
-  if (wrap_dim != self.dim() - 1)
+    ScanOp op) {
+  if (!self.is_contiguous() || !result.is_contiguous() ||
+      self.scalar_type() != result.scalar_type() ||
+      result.sizes() != self.sizes() || self.dim() == 0 ||
+      self.numel() == 0) {
     return false;
-  // check dtype matched
-  auto out_dtype = result.scalar_type();
-  if (dtype.has_value() && out_dtype != dtype.value())
-    return false;
-  // check dtype enabled
-  bool is_dtype_enabled = out_dtype == at::ScalarType::Double ||
-      out_dtype == at::ScalarType::Float || out_dtype == at::ScalarType::Long;
-  if (!is_dtype_enabled)
+  }
+  auto dtype = self.scalar_type();
+  bool is_floating = dtype == at::kFloat || dtype == at::kDouble ||
+      dtype == at::kBFloat16;
+  if (!is_floating && (op == ScanOp::LogSumExp || dtype != at::kLong)) {
     return false;
+  }
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  const int64_t N = self.size(dim);
+  const int64_t K = self.stride(dim);
+  const int64_t M = self.numel() / (N * K);
+  switch (op) {
+    case ScanOp::Sum:
+      AT_DISPATCH_FLOATING_TYPES_AND2(
+          at::kLong, at::kBFloat16, dtype, "cumsum_cpu", [&] {
+            scan_kernel<scalar_t, SumOp>(result, self, M, N, K);
+          });
+      break;
+    case ScanOp::Prod:
+      AT_DISPATCH_FLOATING_TYPES_AND2(
+          at::kLong, at::kBFloat16, dtype, "cumprod_cpu", [&] {
+            scan_kernel<scalar_t, ProdOp>(result, self, M, N, K);
+          });
+      break;
+    case ScanOp::LogSumExp:
+      AT_DISPATCH_FLOATING_TYPES_AND(
+          at::kBFloat16, dtype, "logcumsumexp_cpu", [&] {
+            scan_kernel<scalar_t, LogSumExpOp>(result, self, M, N, K);
+          });
+      break;
+  }
   return true;
 }
 
@@ -160,11 +330,8 @@ class NewCumSumOp : public torch::autograd::Function<NewCumSumOp> {
     if (result.sizes() != self.sizes()) {
       at::native::resize_output(result, self.sizes());
     }
-    if (cumsum_fast_path(result, self, dim, dtype)) {
-      AT_DISPATCH_FLOATING_TYPES_AND(
-          at::ScalarType::Long, self.scalar_type(), "cumsum_lastdim_cpu", [&] {
-            cumsum_lastdim_kernel<scalar_t>(result, self, dim);
-          });
+    if ((!dtype.has_value() || result.scalar_type() == dtype.value()) &&
+        scan_kernel_impl(result, self, dim, ScanOp::Sum)) {
       return result;
     }
     return at::cumsum_out(result, self, dim, dtype);
@@ -215,6 +382,7 @@ at::Tensor cumsum_kernel_impl(
 } // anonymous namespace
 
 REGISTER_DISPATCH(cumsum_kernel_stub, &cumsum_kernel_impl);
+REGISTER_DISPATCH(scan_kernel_stub, &scan_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,268 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/DirectConv.h>
+
+/*
+ Direct channels-last convolutions, vectorized over the output channels: the
+ input of an output pixel is a contiguous vector of channels, so neither the
+ input nor the output is reordered. A task computes one output row of one
+ image. Depthwise convolutions multiply the input channels with the same
+ channels of the [KH, KW, C] weight. Convolutions of few input channels
+ broadcast each input channel and multiply it with a vector of output channels
+ of the [KH, KW, IC, OC] weight, direct_conv_block_w output pixels at a time to
+ reuse the weight vectors.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+const int64_t direct_conv_block_w = 4;
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+inline fVec apply_post_op(const fVec& v, DirectConvPostOp post_op) {
+  if (post_op == DirectConvPostOp::RELU) {
+    return at::vec::maximum(v, fVec(0.f));
+  } else if (post_op == DirectConvPostOp::RELU6) {
+    return at::vec::minimum(at::vec::maximum(v, fVec(0.f)), fVec(6.f));
+  }
+  return v;
+}
+
+struct DirectConvShape {
+  int64_t H, W, IC, OH, OW, OC, KH, KW;
+  int64_t stride_h, stride_w, pad_h, pad_w, dilation_h, dilation_w;
+
+  // the range [begin, end) of the kernel index whose input is in [0, size)
+  static void valid_range(
+      int64_t o,
+      int64_t stride,
+      int64_t pad,
+      int64_t dilation,
+      int64_t kernel,
+      int64_t size,
+      int64_t& begin,
+      int64_t& end) {
+    int64_t i0 = o * stride - pad;
+    begin = i0 < 0 ? (-i0 + dilation - 1) / dilation : 0;
+    end = size - i0 <= 0 ? 0 : (size - i0 + dilation - 1) / dilation;
+    end = std::min(end, kernel);
+    begin = std::min(begin, end);
+  }
+};
+
+// out[ow][C] for the output row of in, the NHWC rows of one image
+template <typename T>
+void depthwise_conv_row(
+    const T* in,
+    const T* w,
+    const float* bias,
+    T* out,
+    int64_t oh,
+    const DirectConvShape& s,
+    DirectConvPostOp post_op) {
+  int64_t C = s.OC;
+  int64_t kh_begin, kh_end;
+  DirectConvShape::valid_range(
+      oh, s.stride_h, s.pad_h, s.dilation_h, s.KH, s.H, kh_begin, kh_end);
+  for (int64_t ow = 0; ow < s.OW; ow++) {
+    int64_t kw_begin, kw_end;
+    DirectConvShape::valid_range(
+        ow, s.stride_w, s.pad_w, s.dilation_w, s.KW, s.W, kw_begin, kw_end);
+    int64_t ih0 = oh * s.stride_h - s.pad_h;
+    int64_t iw0 = ow * s.stride_w - s.pad_w;
+    for (int64_t c = 0; c < C; c += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+      auto acc = fVec::loadu(bias + c, count);
+      for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+        int64_t ih = ih0 + kh * s.dilation_h;
+        for (int64_t kw = kw_begin; kw < kw_end; kw++) {
+          int64_t iw = iw0 + kw * s.dilation_w;
+          acc = at::vec::fmadd(
+              load_fvec(in + (ih * s.W + iw) * C + c, count),
+              load_fvec(w + (kh * s.KW + kw) * C + c, count),
+              acc);
+        }
+      }
+      store_fvec(out + ow * C + c, apply_post_op(acc, post_op), count);
+    }
+  }
+}
+
+// out[ow, ow + BW)[OC] for the output row of in, the NHWC rows of one image,
+// the output pixels having the same valid kernel columns
+template <typename T, int64_t BW>
+void small_channels_conv_block(
+    const T* in,
+    const T* w,
+    const float* bias,
+    T* out,
+    int64_t oh,
+    int64_t ow,
+    int64_t kw_begin,
+    int64_t kw_end,
+    const DirectConvShape& s,
+    DirectConvPostOp post_op) {
+  int64_t IC = s.IC;
+  int64_t OC = s.OC;
+  int64_t kh_begin, kh_end;
+  DirectConvShape::valid_range(
+      oh, s.stride_h, s.pad_h, s.dilation_h, s.KH, s.H, kh_begin, kh_end);
+  int64_t ih0 = oh * s.stride_h - s.pad_h;
+  for (int64_t oc = 0; oc < OC; oc += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), OC - oc);
+    fVec acc[BW];
+    for (int64_t b = 0; b < BW; b++) {
+      acc[b] = fVec::loadu(bias + oc, count);
+    }
+    for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+      int64_t ih = ih0 + kh * s.dilation_h;
+      for (int64_t kw = kw_begin; kw < kw_end; kw++) {
+        const T* w_ptr = w + (kh * s.KW + kw) * IC * OC + oc;
+        for (int64_t ic = 0; ic < IC; ic++) {
+          auto wv = load_fvec(w_ptr + ic * OC, count);
+          for (int64_t b = 0; b < BW; b++) {
+            int64_t iw = (ow + b) * s.stride_w - s.pad_w + kw * s.dilation_w;
+            auto xv = fVec(static_cast<float>(in[(ih * s.W + iw) * IC + ic]));
+            acc[b] = at::vec::fmadd(xv, wv, acc[b]);
+          }
+        }
+      }
+    }
+    for (int64_t b = 0; b < BW; b++) {
+      store_fvec(
+          out + (ow + b) * OC + oc, apply_post_op(acc[b], post_op), count);
+    }
+  }
+}
+
+template <typename T>
+void small_channels_conv_row(
+    const T* in,
+    const T* w,
+    const float* bias,
+    T* out,
+    int64_t oh,
+    const DirectConvShape& s,
+    DirectConvPostOp post_op) {
+  int64_t ow = 0;
+  while (ow < s.OW) {
+    int64_t kw_begin, kw_end;
+    DirectConvShape::valid_range(
+        ow, s.stride_w, s.pad_w, s.dilation_w, s.KW, s.W, kw_begin, kw_end);
+    // a block of pixels away from the left and right paddings
+    bool interior = kw_begin == 0 && kw_end == s.KW &&
+        ow + direct_conv_block_w <= s.OW &&
+        (ow + direct_conv_block_w - 1) * s.stride_w - s.pad_w +
+                (s.KW - 1) * s.dilation_w <
+            s.W;
+    if (interior) {
+      small_channels_conv_block<T, direct_conv_block_w>(
+          in, w, bias, out, oh, ow, kw_begin, kw_end, s, post_op);
+      ow += direct_conv_block_w;
+    } else {
+      small_channels_conv_block<T, 1>(
+          in, w, bias, out, oh, ow, kw_begin, kw_end, s, post_op);
+      ow++;
+    }
+  }
+}
+
+template <typename T>
+void direct_conv_kernel(
+    const at::Tensor& input,
+    const DirectConvWeight& weight,
+    const at::Tensor& bias,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    at::Tensor& output,
+    DirectConvPostOp post_op) {
+  int64_t N = input.size(0);
+  DirectConvShape s{
+      input.size(2),
+      input.size(3),
+      weight.in_channels,
+      output.size(2),
+      output.size(3),
+      weight.out_channels,
+      weight.kernel_h,
+      weight.kernel_w,
+      stride[0],
+      stride[1],
+      padding[0],
+      padding[1],
+      dilation[0],
+      dilation[1]};
+  const T* in = input.data_ptr<T>();
+  const T* w = weight.weight.data_ptr<T>();
+  const float* b = bias.data_ptr<float>();
+  T* out = output.data_ptr<T>();
+  bool depthwise = weight.kind == DirectConvKind::DEPTHWISE;
+
+  at::parallel_for(0, N * s.OH, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t n = i / s.OH;
+      int64_t oh = i % s.OH;
+      const T* in_n = in + n * s.H * s.W * s.IC;
+      T* out_row = out + (n * s.OH + oh) * s.OW * s.OC;
+      if (depthwise) {
+        depthwise_conv_row(in_n, w, b, out_row, oh, s, post_op);
+      } else {
+        small_channels_conv_row(in_n, w, b, out_row, oh, s, post_op);
+      }
+    }
+  });
+}
+
+void direct_conv_kernel_impl(
+    const at::Tensor& input,
+    const DirectConvWeight& weight,
+    const at::Tensor& bias,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    at::Tensor& output,
+    DirectConvPostOp post_op) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (input.scalar_type() == at::kFloat) {
+    direct_conv_kernel<float>(
+        input, weight, bias, stride, padding, dilation, output, post_op);
+  } else {
+    TORCH_CHECK(
+        input.scalar_type() == at::kBFloat16,
+        "direct_conv only supports float and bfloat16");
+    direct_conv_kernel<at::BFloat16>(
+        input, weight, bias, stride, padding, dilation, output, post_op);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(direct_conv_kernel_stub, &direct_conv_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
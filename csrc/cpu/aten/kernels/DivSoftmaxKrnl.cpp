@@ -94,6 +94,8 @@ inline std::vector<int64_t> _adjust_strides(
  * - The mask b has the same dimension as a, or it can be expand_as a with (bs
  * :: seq_length), i.e., 2D tensor expands from mid dims
  * - The datatype for inpust a and output are same.
+ * Rows of at least online_softmax_min_dim elements use the online softmax
+ * kernels, which do not go through a temporary row.
  *
  * @param[in] a a contiguous tensor to do div and softmax
  * @param[in] b a mask tensor to be masked_fill into tensor a after div and
@@ -145,11 +147,15 @@ at::Tensor dil_div_maskfill_softmax(
   if (grain_size < 1)
     grain_size = 1;
   int64_t outer_dims_num = outer_size_per_dim.size();
+  bool online = dim_size >= online_softmax_min_dim;
+  auto vec_fill = _mm512_set1_ps(fill_value);
+  auto vec_dim_per_head = _mm512_set1_ps(dim_per_head);
+  auto vec_one = _mm512_set1_ps(1.0);
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
     float val = 0.0;
     int64_t b_offset = 0;
-    at::Tensor tmp_out = at::empty({dim_size});
-    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    at::Tensor tmp_out = online ? at::Tensor() : at::empty({dim_size});
+    float* tmp_out_ptr = online ? nullptr : tmp_out.data_ptr<float>();
     for (int64_t i = begin; i < end; i++) {
       if (need_broadcast) {
         b_offset =
@@ -162,6 +168,25 @@ at::Tensor dil_div_maskfill_softmax(
         b_offset = i * dim_size;
       }
 
+      if (online) {
+        const scalar_t* a_row = a_data_base + i * dim_size;
+        const float* b_row = b_data_base + b_offset;
+        auto logits = [&](int j, __mmask16 mask) {
+          auto fill_mask = _mm512_cmp_ps_mask(
+              _mm512_maskz_loadu_ps(mask, b_row + j), vec_one, 12);
+          return _mm512_mask_div_ps(
+              vec_fill,
+              fill_mask,
+              _maskz_loadu(a_row + j, mask),
+              vec_dim_per_head);
+        };
+        float max = 0.f;
+        _dil_online_max_sum_kernel(logits, dim_size, max, val);
+        _dil_online_normalization_kernel<scalar_t>(
+            logits, max, val, dim_size, output_data_base + i * dim_size);
+        continue;
+      }
+
       // mask fill and do div on a and get the maximum value:
       //    output_data = mask? a/dim_per_head : fill value
       //    val = max(output_data)
@@ -11,8 +11,10 @@
 #include <torch/script.h>
 #include <algorithm>
 #include "aten/utils/csr2csc.h"
+#include "aten/utils/embedding_lookup.h"
 #include "autocast/autocast_mode.h"
 #include "cpu/kernels/Embeddingbag.h"
+#include "utils/parallel_stats.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -42,31 +44,58 @@ static inline bool is_bfloat16_tensor(const at::Tensor tensor_) {
   return false;
 }
 
+// out += in * scale, accumulate in the dtype of out
+template <typename dst_type, typename src_type>
+inline __attribute__((always_inline)) void add_scale_ker(
+    dst_type* inout,
+    const src_type* in,
+    float scale,
+    int64_t len) {
+#pragma omp simd
+  for (int64_t i = 0; i < len; i++) {
+    inout[i] += in[i] * scale;
+  }
+}
+
+// SUM pooling into the [bags, ddim] output, whose rows may be strided, e.g.
+// the slice of a planned cat. Each row is scaled by its per_sample_weights
+// when per_sample_weights_data is not null.
 template <typename T>
-static inline at::Tensor _embedding_bag_index_add_select_fast(
+static inline void _embedding_bag_index_add_select_fast(
     const at::Tensor indices,
     const at::Tensor src,
     const at::Tensor offsets,
-    bool include_last_offset) {
+    const T* per_sample_weights_data,
+    at::Tensor& output) {
   int64_t ddim = src.size(1);
   T* src_data = src.data_ptr<T>();
-  int64_t output_size = offsets.numel();
-  if (include_last_offset) {
-    output_size -= 1;
-  }
+  int64_t output_size = output.size(0);
+  int64_t output_stride = output.stride(0);
   int64_t* offsets_data = offsets.data_ptr<int64_t>();
   auto indices_accessor = indices.accessor<int64_t, 1>();
   int64_t last_index = indices.numel();
   int64_t last_offset = output_size - 1;
 
-  at::Tensor output = at::empty({output_size, src.size(1)}, src.options());
   auto* output_data = output.data_ptr<T>();
-  at::parallel_for(0, output_size, 16, [&](int64_t start, int64_t end) {
+  const int64_t prefetch_distance = get_embedding_prefetch_distance();
+  utils::parallel_for(0, output_size, 16, [&](int64_t start, int64_t end) {
+    // prefetch rows "prefetch_distance" indices ahead within this chunk
+    const int64_t prefetch_end =
+        end > last_offset ? last_index : offsets_data[end];
+    auto prefetch = [&](int64_t s) {
+      if (prefetch_distance > 0 && s + prefetch_distance < prefetch_end) {
+        prefetch_row(
+            &src_data[indices_accessor[s + prefetch_distance] * ddim],
+            ddim * sizeof(T));
+      }
+    };
     for (int64_t i = start; i < end; i++) {
-      auto* out_data_ptr = &output_data[i * ddim];
+      auto* out_data_ptr = &output_data[i * output_stride];
       auto inputs_start = offsets_data[i];
       auto inputs_end = i == last_offset ? last_index : offsets_data[i + 1];
-      if (inputs_end - inputs_start == 1) {
+      if (inputs_end - inputs_start == 1 &&
+          per_sample_weights_data == nullptr) {
+        prefetch(inputs_start);
         T* select_data_ptr = &src_data[indices_accessor[inputs_start] * ddim];
         move_ker(out_data_ptr, select_data_ptr, ddim);
       } else {
@@ -74,34 +103,184 @@ static inline at::Tensor _embedding_bag_index_add_select_fast(
         acc_t temp_out[ddim];
         zero_ker(temp_out, ddim);
         for (int64_t s = inputs_start; s < inputs_end; s++) {
+          prefetch(s);
           T* select_data_ptr = &src_data[indices_accessor[s] * ddim];
-          add_ker(temp_out, select_data_ptr, ddim);
+          if (per_sample_weights_data == nullptr) {
+            add_ker(temp_out, select_data_ptr, ddim);
+          } else {
+            add_scale_ker(
+                temp_out,
+                select_data_ptr,
+                float(per_sample_weights_data[s]),
+                ddim);
+          }
         }
         move_ker(out_data_ptr, temp_out, ddim);
       }
     }
   });
+}
 
-  return output;
+// MAX pooling, also returns the row picked for each element of the output
+// (-1 for empty bags) which routes the grads in backward.
+template <typename T>
+static inline std::tuple<at::Tensor, at::Tensor> _embedding_bag_max_fast(
+    const at::Tensor indices,
+    const at::Tensor src,
+    const at::Tensor offsets,
+    bool include_last_offset) {
+  int64_t ddim = src.size(1);
+  T* src_data = src.data_ptr<T>();
+  int64_t output_size = offsets.numel();
+  if (include_last_offset) {
+    output_size -= 1;
+  }
+  int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  auto indices_accessor = indices.accessor<int64_t, 1>();
+  int64_t last_index = indices.numel();
+  int64_t last_offset = output_size - 1;
+
+  at::Tensor output = at::empty({output_size, ddim}, src.options());
+  at::Tensor max_indices =
+      at::empty({output_size, ddim}, indices.options().dtype(at::kLong));
+  auto* output_data = output.data_ptr<T>();
+  auto* max_indices_data = max_indices.data_ptr<int64_t>();
+  const int64_t prefetch_distance = get_embedding_prefetch_distance();
+  utils::parallel_for(0, output_size, 16, [&](int64_t start, int64_t end) {
+    const int64_t prefetch_end =
+        end > last_offset ? last_index : offsets_data[end];
+    for (int64_t i = start; i < end; i++) {
+      auto* out_data_ptr = &output_data[i * ddim];
+      auto* max_indices_ptr = &max_indices_data[i * ddim];
+      auto inputs_start = offsets_data[i];
+      auto inputs_end = i == last_offset ? last_index : offsets_data[i + 1];
+      if (inputs_start >= inputs_end) {
+        zero_ker(out_data_ptr, ddim);
+        std::fill_n(max_indices_ptr, ddim, -1);
+        continue;
+      }
+      // T compares exactly, no need of an accumulate buffer
+      int64_t first = indices_accessor[inputs_start];
+      move_ker(out_data_ptr, &src_data[first * ddim], ddim);
+      std::fill_n(max_indices_ptr, ddim, first);
+      for (int64_t s = inputs_start + 1; s < inputs_end; s++) {
+        if (prefetch_distance > 0 && s + prefetch_distance < prefetch_end) {
+          prefetch_row(
+              &src_data[indices_accessor[s + prefetch_distance] * ddim],
+              ddim * sizeof(T));
+        }
+        int64_t index = indices_accessor[s];
+        T* select_data_ptr = &src_data[index * ddim];
+#pragma omp simd
+        for (int64_t d = 0; d < ddim; d++) {
+          // keep the first max like aten
+          bool greater = float(select_data_ptr[d]) > float(out_data_ptr[d]);
+          out_data_ptr[d] = greater ? select_data_ptr[d] : out_data_ptr[d];
+          max_indices_ptr[d] = greater ? index : max_indices_ptr[d];
+        }
+      }
+    }
+  });
+
+  return std::make_tuple(output, max_indices);
 }
 
-at::Tensor embedding_bag_kernel_impl(
+template <typename T>
+static inline std::tuple<at::Tensor, at::Tensor> embedding_bag_fast(
     const at::Tensor& weight,
     const at::Tensor& indices,
     const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    int64_t mode,
     bool include_last_offset) {
+  if (mode == MAX) {
+    return _embedding_bag_max_fast<T>(
+        indices, weight, offsets, include_last_offset);
+  }
+  const T* per_sample_weights_data = per_sample_weights.defined()
+      ? per_sample_weights.data_ptr<T>()
+      : nullptr;
+  int64_t output_size = offsets.numel();
+  if (include_last_offset) {
+    output_size -= 1;
+  }
+  auto output = at::empty({output_size, weight.size(1)}, weight.options());
+  _embedding_bag_index_add_select_fast<T>(
+      indices, weight, offsets, per_sample_weights_data, output);
+  return std::make_tuple(output, at::Tensor());
+}
+
+static inline void check_embedding_bag_inputs(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& per_sample_weights,
+    int64_t mode) {
+  TORCH_CHECK(
+      mode == SUM || mode == MAX,
+      "torch_ipex::embedding_bag only supports sum and max pooling");
+  if (per_sample_weights.defined()) {
+    TORCH_CHECK(
+        mode == SUM,
+        "torch_ipex::embedding_bag: per_sample_weights is only supported for sum pooling");
+    TORCH_CHECK(
+        per_sample_weights.scalar_type() == weight.scalar_type(),
+        "torch_ipex::embedding_bag: expect per_sample_weights has the dtype of weight");
+    TORCH_CHECK(
+        per_sample_weights.dim() == 1 &&
+            per_sample_weights.numel() == indices.numel(),
+        "torch_ipex::embedding_bag: expect 1 per_sample_weights for each index");
+  }
+}
+
+std::tuple<at::Tensor, at::Tensor> embedding_bag_kernel_impl(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    int64_t mode,
+    bool include_last_offset) {
+  utils::ParallelStatsScope parallel_stats_scope("embedding_bag");
+  check_embedding_bag_inputs(weight, indices, per_sample_weights, mode);
   at::Tensor offsets_ =
       offsets.is_contiguous() ? offsets : offsets.contiguous();
+  at::Tensor per_sample_weights_ = per_sample_weights.defined()
+      ? per_sample_weights.contiguous()
+      : per_sample_weights;
 
-  at::Tensor output;
   if (is_bfloat16_tensor(weight)) {
-    output = _embedding_bag_index_add_select_fast<at::BFloat16>(
-        indices, weight, offsets_, include_last_offset);
+    return embedding_bag_fast<at::BFloat16>(
+        weight,
+        indices,
+        offsets_,
+        per_sample_weights_,
+        mode,
+        include_last_offset);
   } else {
-    output = _embedding_bag_index_add_select_fast<float>(
-        indices, weight, offsets_, include_last_offset);
+    return embedding_bag_fast<float>(
+        weight,
+        indices,
+        offsets_,
+        per_sample_weights_,
+        mode,
+        include_last_offset);
+  }
+}
+
+void embedding_bag_out_kernel_impl(
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    at::Tensor& output) {
+  utils::ParallelStatsScope parallel_stats_scope("embedding_bag");
+  at::Tensor offsets_ =
+      offsets.is_contiguous() ? offsets : offsets.contiguous();
+  if (is_bfloat16_tensor(weight)) {
+    _embedding_bag_index_add_select_fast<at::BFloat16>(
+        indices, weight, offsets_, nullptr, output);
+  } else {
+    _embedding_bag_index_add_select_fast<float>(
+        indices, weight, offsets_, nullptr, output);
   }
-  return output;
 }
 
 static inline at::Tensor expand_values_if_needed(const at::Tensor& values) {
@@ -139,6 +318,7 @@ static inline at::Tensor embedding_bag_sparse_backward_sum_fast(
     const at::Tensor grad,
     const at::Tensor indices,
     const at::Tensor offsets,
+    const T* per_sample_weights_data,
     int num_weights) {
   assert(grad.stride(1) == 1);
 
@@ -152,14 +332,23 @@ static inline at::Tensor embedding_bag_sparse_backward_sum_fast(
 
   T* gradout_data = index_grad.data_ptr<T>();
   T* grad_data = grad.data_ptr<T>();
-  at::parallel_for(0, offset_numel, 16, [&](int64_t start, int64_t end) {
+  utils::parallel_for(0, offset_numel, 16, [&](int64_t start, int64_t end) {
     for (auto mb = start; mb < end; mb++) {
       int64_t select_off_start = offsets_accessor[mb];
       int64_t select_off_end =
           (mb < (offset_numel - 1) ? offsets_accessor[mb + 1] : indices_size0);
       auto grad_block = grad_data + grad_stride0 * mb;
       for (int64_t s = select_off_start; s < select_off_end; s++) {
-        move_ker((T*)(gradout_data + ddim * s), (T*)grad_block, ddim);
+        if (per_sample_weights_data == nullptr) {
+          move_ker((T*)(gradout_data + ddim * s), (T*)grad_block, ddim);
+        } else {
+          T* gradout_ptr = gradout_data + ddim * s;
+          float scale = per_sample_weights_data[s];
+#pragma omp simd
+          for (int64_t d = 0; d < ddim; d++) {
+            gradout_ptr[d] = grad_block[d] * scale;
+          }
+        }
       }
     }
   });
@@ -204,6 +393,7 @@ static inline at::Tensor embedding_bag_dense_backward_sum_fast(
     const at::Tensor grad,
     const at::Tensor indices,
     const at::Tensor offsets,
+    const T* per_sample_weights_data,
     int num_weights) {
   int64_t indices_numel = indices.numel();
   assert(grad.stride(1) == 1 && indices_numel > 0);
@@ -254,7 +444,7 @@ static inline at::Tensor embedding_bag_dense_backward_sum_fast(
 
   auto offset2bag_accessor = offset2bag_.accessor<int64_t, 1>();
   T* grad_data = grad.data_ptr<T>();
-  at::parallel_for(0, max_threads, 0, [&](int64_t start, int64_t end) {
+  utils::parallel_for(0, max_threads, 0, [&](int64_t start, int64_t end) {
     for (int k = start; k < end; k++) {
       int64_t chunk_start = chuck_sum_size[k];
       int64_t chunk_end = chuck_sum_size[k + 1];
@@ -263,10 +453,18 @@ static inline at::Tensor embedding_bag_dense_backward_sum_fast(
         int64_t index = indices_to_index[indices_num];
         if (index >= chunk_start && index < chunk_end) {
           auto s = offset2bag_accessor[mb];
-          add_ker(
-              (float*)(temp_output + index * ddim),
-              (T*)(grad_data + s * ddim),
-              ddim);
+          if (per_sample_weights_data == nullptr) {
+            add_ker(
+                (float*)(temp_output + index * ddim),
+                (T*)(grad_data + s * ddim),
+                ddim);
+          } else {
+            add_scale_ker(
+                (float*)(temp_output + index * ddim),
+                (T*)(grad_data + s * ddim),
+                float(per_sample_weights_data[mb]),
+                ddim);
+          }
         }
       }
       for (int64_t index = chunk_start; index < chunk_end; index++) {
@@ -282,28 +480,152 @@ static inline at::Tensor embedding_bag_dense_backward_sum_fast(
   return index_grad_weight;
 }
 
-at::Tensor embedding_bag_backward_kernel_impl(
+// MAX pooling backward, the grad of each output element goes to the row
+// recorded in max_indices. Every thread owns a range of rows, so there is no
+// write conflict between threads.
+template <typename T>
+static inline at::Tensor embedding_bag_dense_backward_max_fast(
+    const at::Tensor grad,
+    const at::Tensor max_indices,
+    int64_t num_weights) {
+  int64_t num_bags = grad.size(0);
+  int64_t ddim = grad.size(1);
+  at::Tensor grad_weight =
+      at::zeros({num_weights, ddim}, grad.options().dtype(at::kFloat));
+  float* grad_weight_data = grad_weight.data_ptr<float>();
+  T* grad_data = grad.data_ptr<T>();
+  int64_t* max_indices_data = max_indices.data_ptr<int64_t>();
+  utils::parallel_for(0, num_weights, 0, [&](int64_t start, int64_t end) {
+    for (int64_t i = 0; i < num_bags * ddim; i++) {
+      int64_t index = max_indices_data[i];
+      if (index >= start && index < end) {
+        grad_weight_data[index * ddim + i % ddim] += float(grad_data[i]);
+      }
+    }
+  });
+  if (grad.scalar_type() != at::kFloat) {
+    return grad_weight.to(grad.scalar_type());
+  }
+  return grad_weight;
+}
+
+template <typename T>
+static inline at::Tensor embedding_bag_backward_fast(
     const at::Tensor& grad,
     const at::Tensor& indices,
     const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    const at::Tensor& max_indices,
+    int64_t mode,
     int64_t num_weights,
     bool sparse) {
+  if (mode == MAX) {
+    TORCH_CHECK(
+        !sparse,
+        "torch_ipex::embedding_bag: max pooling does not support sparse grad");
+    return embedding_bag_dense_backward_max_fast<T>(
+        grad, max_indices, num_weights);
+  }
+  const T* per_sample_weights_data = per_sample_weights.defined()
+      ? per_sample_weights.data_ptr<T>()
+      : nullptr;
   if (sparse) {
-    if (is_bfloat16_tensor(grad)) {
-      return embedding_bag_sparse_backward_sum_fast<at::BFloat16>(
-          grad, indices, offsets, num_weights);
-    } else {
-      return embedding_bag_sparse_backward_sum_fast<float>(
-          grad, indices, offsets, num_weights);
-    }
+    return embedding_bag_sparse_backward_sum_fast<T>(
+        grad, indices, offsets, per_sample_weights_data, num_weights);
+  } else {
+    return embedding_bag_dense_backward_sum_fast<T>(
+        grad, indices, offsets, per_sample_weights_data, num_weights);
+  }
+}
+
+at::Tensor embedding_bag_backward_kernel_impl(
+    const at::Tensor& grad,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const at::Tensor& per_sample_weights,
+    const at::Tensor& max_indices,
+    int64_t mode,
+    int64_t num_weights,
+    bool sparse) {
+  utils::ParallelStatsScope parallel_stats_scope("embedding_bag_backward");
+  at::Tensor per_sample_weights_ = per_sample_weights.defined()
+      ? per_sample_weights.contiguous()
+      : per_sample_weights;
+  if (is_bfloat16_tensor(grad)) {
+    return embedding_bag_backward_fast<at::BFloat16>(
+        grad,
+        indices,
+        offsets,
+        per_sample_weights_,
+        max_indices,
+        mode,
+        num_weights,
+        sparse);
   } else {
-    if (is_bfloat16_tensor(grad)) {
-      return embedding_bag_dense_backward_sum_fast<at::BFloat16>(
-          grad, indices, offsets, num_weights);
-    } else {
-      return embedding_bag_dense_backward_sum_fast<float>(
-          grad, indices, offsets, num_weights);
+    return embedding_bag_backward_fast<float>(
+        grad,
+        indices,
+        offsets,
+        per_sample_weights_,
+        max_indices,
+        mode,
+        num_weights,
+        sparse);
+  }
+}
+
+// grad of per_sample_weights[s] is dot(grad[bag of s], weight[indices[s]])
+template <typename T>
+static inline at::Tensor embedding_bag_per_sample_weights_backward_fast(
+    const at::Tensor grad,
+    const at::Tensor weight,
+    const at::Tensor indices,
+    const at::Tensor offsets) {
+  int64_t num_bags = grad.size(0);
+  int64_t ddim = grad.size(1);
+  int64_t indices_numel = indices.numel();
+  auto offsets_accessor = offsets.accessor<int64_t, 1>();
+  auto offset_numel = offsets.numel();
+  auto indices_accessor = indices.accessor<int64_t, 1>();
+  at::Tensor grad_per_sample_weights =
+      at::empty({indices_numel}, grad.options());
+  T* out_data = grad_per_sample_weights.data_ptr<T>();
+  T* grad_data = grad.data_ptr<T>();
+  T* weight_data = weight.data_ptr<T>();
+  utils::parallel_for(0, num_bags, 16, [&](int64_t start, int64_t end) {
+    for (int64_t mb = start; mb < end; mb++) {
+      int64_t select_off_start = offsets_accessor[mb];
+      int64_t select_off_end =
+          (mb < (offset_numel - 1) ? offsets_accessor[mb + 1] : indices_numel);
+      T* grad_block = grad_data + ddim * mb;
+      for (int64_t s = select_off_start; s < select_off_end; s++) {
+        T* weight_block = weight_data + ddim * indices_accessor[s];
+        float acc = 0;
+#pragma omp simd reduction(+ : acc)
+        for (int64_t d = 0; d < ddim; d++) {
+          acc += float(grad_block[d]) * float(weight_block[d]);
+        }
+        out_data[s] = acc;
+      }
     }
+  });
+  return grad_per_sample_weights;
+}
+
+at::Tensor embedding_bag_per_sample_weights_backward_kernel_impl(
+    const at::Tensor& grad,
+    const at::Tensor& weight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets) {
+  utils::ParallelStatsScope parallel_stats_scope(
+      "embedding_bag_per_sample_weights_backward");
+  at::Tensor weight_ = weight.contiguous();
+  if (is_bfloat16_tensor(grad)) {
+    return embedding_bag_per_sample_weights_backward_fast<at::BFloat16>(
+        grad, weight_, indices, offsets);
+  } else {
+    return embedding_bag_per_sample_weights_backward_fast<float>(
+        grad, weight_, indices, offsets);
   }
 }
 
@@ -311,7 +633,9 @@ at::Tensor embedding_bag_int8_kernel_impl(
     const at::Tensor& qweight,
     const at::Tensor& indices,
     const at::Tensor& offsets,
-    bool include_last_offset) {
+    bool include_last_offset,
+    double o_scale) {
+  utils::ParallelStatsScope parallel_stats_scope("embedding_bag_int8");
   int64_t ddim = qweight.size(1);
   double scale = at::native::q_scale_quant(qweight);
   int8_t* qweight_data =
@@ -321,34 +645,44 @@ at::Tensor embedding_bag_int8_kernel_impl(
     output_size -= 1;
   }
   int64_t* offsets_data = offsets.data_ptr<int64_t>();
-  auto indices_accessor = indices.accessor<int64_t, 1>();
+  auto indices_contig = indices.contiguous();
+  const int64_t* indices_data = indices_contig.data_ptr<int64_t>();
   int64_t last_index = indices.numel();
   int64_t last_offset = output_size - 1;
+  // the pooled sums are requantized to the scale of the output, the rows
+  // of the bags of 1 are copied when the scales match
+  float requant_scale = scale / o_scale;
+  bool same_scale = std::abs(requant_scale - 1.f) < 1e-6;
 
   // init output tensor
   at::QuantizerPtr output_quantizer =
-      at::make_per_tensor_affine_quantizer(scale, /*zp=*/0, at::kQInt8);
+      at::make_per_tensor_affine_quantizer(o_scale, /*zp=*/0, at::kQInt8);
   at::Tensor output = at::new_qtensor(
       /*sizes=*/{output_size, qweight.size(1)},
       qweight.options(),
       output_quantizer);
   int8_t* output_data = reinterpret_cast<int8_t*>(output.data_ptr<at::qint8>());
 
-  at::parallel_for(0, output_size, 16, [&](int64_t start, int64_t end) {
+  utils::parallel_for(0, output_size, 16, [&](int64_t start, int64_t end) {
     for (int64_t i = start; i < end; i++) {
       int8_t* out_data_ptr = &output_data[i * ddim];
       auto inputs_start = offsets_data[i];
       auto inputs_end = i == last_offset ? last_index : offsets_data[i + 1];
       if (inputs_start >= inputs_end) {
         zero_ker(out_data_ptr, ddim);
-      } else {
+      } else if (inputs_end - inputs_start == 1 && same_scale) {
         int8_t* select_data_ptr =
-            &qweight_data[indices_accessor[inputs_start] * ddim];
+            &qweight_data[indices_data[inputs_start] * ddim];
         move_ker(out_data_ptr, select_data_ptr, ddim);
-      }
-      for (int64_t s = (inputs_start + 1); s < inputs_end; s++) {
-        int8_t* select_data_ptr = &qweight_data[indices_accessor[s] * ddim];
-        add_ker(out_data_ptr, select_data_ptr, ddim);
+      } else {
+        qemb_pooling_ker(
+            out_data_ptr,
+            qweight_data,
+            indices_data,
+            inputs_start,
+            inputs_end,
+            ddim,
+            requant_scale);
       }
     }
   });
@@ -359,9 +693,15 @@ at::Tensor embedding_bag_int8_kernel_impl(
 } // anonymous namespace
 
 REGISTER_DISPATCH(embedding_bag_kernel_stub, &embedding_bag_kernel_impl);
+REGISTER_DISPATCH(
+    embedding_bag_out_kernel_stub,
+    &embedding_bag_out_kernel_impl);
 REGISTER_DISPATCH(
     embedding_bag_backward_kernel_stub,
     &embedding_bag_backward_kernel_impl);
+REGISTER_DISPATCH(
+    embedding_bag_per_sample_weights_backward_kernel_stub,
+    &embedding_bag_per_sample_weights_backward_kernel_impl);
 REGISTER_DISPATCH(
     embedding_bag_int8_kernel_stub,
     &embedding_bag_int8_kernel_impl);
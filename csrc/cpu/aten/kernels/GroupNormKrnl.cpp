@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <array>
 #include <numeric>
+#include <vector>
 
 #include <aten/GroupNorm.h>
 
@@ -21,7 +22,10 @@
 #include <ATen/ops/empty.h>
 #endif
 
+#include "WelfordKrnl.h"
+#include "aten/utils/scratch_arena.h"
 #include "aten/utils/utils.h"
+#include "utils/parallel_stats.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -59,7 +63,7 @@ void GroupNormKernelImplInternal(
 
   using T_ACC = at::opmath_type<T>;
 
-  at::parallel_for(0, N * G, 1, [&](int64_t start, int64_t end) {
+  utils::parallel_for(0, N * G, 1, [&](int64_t start, int64_t end) {
     for (const auto i : c10::irange(start, end)) {
       const T* X_ptr = X_data + i * inner_size;
       T_ACC mean_val;
@@ -348,12 +352,12 @@ void GroupNormKernelImplChannelsLastInternal(
     // impl-1: parallel on N * G.
     //
     // for each plain of HxW, scale and bias is calculated only once
-    at::Tensor buffer = at::empty(
-        {N * G, 2 * D},
-        X.options().dtype(c10::CppTypeToScalarType<T_ACC>::value));
+    ScratchScope scratch;
+    at::Tensor buffer = scratch.empty(
+        {N * G, 2 * D}, c10::CppTypeToScalarType<T_ACC>::value);
     T_ACC* buffer_data = buffer.data_ptr<T_ACC>();
 
-    at::parallel_for(0, N * G, 1, [&](int64_t begin, int64_t end) {
+    utils::parallel_for(0, N * G, 1, [&](int64_t begin, int64_t end) {
       int64_t n{0}, g{0};
       at::native::data_index_init(begin, n, N, g, G);
       for (const auto i : c10::irange(begin, end)) {
@@ -400,14 +404,15 @@ void GroupNormKernelImplChannelsLastInternal(
     //
     // temp buffer holding x and x2
     int num_threads = at::get_num_threads();
+    ScratchScope scratch;
     at::Tensor buffer =
-        at::empty(
-            {num_threads, N, 2 * C},
-            X.options().dtype(c10::CppTypeToScalarType<T_ACC>::value))
+        scratch
+            .empty(
+                {num_threads, N, 2 * C}, c10::CppTypeToScalarType<T_ACC>::value)
             .zero_();
     T_ACC* buffer_data = buffer.data_ptr<T_ACC>();
-    at::Tensor tmp_buffer = at::empty(
-        {N, 2 * G}, X.options().dtype(c10::CppTypeToScalarType<T_ACC>::value));
+    at::Tensor tmp_buffer =
+        scratch.empty({N, 2 * G}, c10::CppTypeToScalarType<T_ACC>::value);
     T_ACC* tmp_buffer_data = tmp_buffer.data_ptr<T_ACC>();
     // step-1: accumulate on dimension of C
     //
@@ -422,7 +427,7 @@ void GroupNormKernelImplChannelsLastInternal(
     // To avoid thread conflict, we make use of a temp buffer of {T, N, 2C},
     //   firstly, reduce from {N, HxW, C} to {T, N, 2C}
     //
-    at::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
+    utils::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
       int tid = at::get_thread_num();
       T_ACC* buffer_ptr = buffer_data + tid * N * 2 * C;
 
@@ -491,7 +496,7 @@ void GroupNormKernelImplChannelsLastInternal(
     // Parallel on on the all the outer dimensions of N and HxW
     // and vectorize on C.
     //
-    at::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
+    utils::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
       int64_t n{0}, m{0};
       at::native::data_index_init(begin, n, N, m, HxW);
       for (const auto i : c10::irange(begin, end)) {
@@ -518,6 +523,7 @@ void GroupNormKernelImpl(
     at::Tensor& Y,
     at::Tensor& mean,
     at::Tensor& rstd) {
+  utils::ParallelStatsScope parallel_stats_scope("group_norm");
   const bool mixed_type = at::native::is_mixed_type(X, gamma, beta);
   switch (X.suggest_memory_format()) {
     case at::MemoryFormat::Contiguous: {
@@ -570,89 +576,470 @@ void GroupNormKernelImpl(
   }
 }
 
+// Pixels of a sample below which the Welford moments are not split in
+// partials over the pixels
+constexpr int64_t kGroupNormSiLUMinChunk = 256;
+
+inline at::vec::Vectorized<float> LoadAsFloat(const float* ptr, int64_t n) {
+  return at::vec::Vectorized<float>::loadu(ptr, n);
+}
+
+inline at::vec::Vectorized<float> LoadAsFloat(const BFloat16* ptr, int64_t n) {
+  using fVec = at::vec::Vectorized<float>;
+  using bVec = at::vec::Vectorized<BFloat16>;
+  fVec lo, hi;
+  std::tie(lo, hi) = convert_bfloat16_float(bVec::loadu(ptr, n));
+  return lo;
+}
+
+inline void StoreFromFloat(
+    float* ptr,
+    const at::vec::Vectorized<float>& v,
+    int64_t n) {
+  v.store(ptr, n);
+}
+
+inline void StoreFromFloat(
+    BFloat16* ptr,
+    const at::vec::Vectorized<float>& v,
+    int64_t n) {
+  convert_float_bfloat16(v, at::vec::Vectorized<float>(0.f)).store(ptr, n);
+}
+
+// Welford mean and m2 of each channel over the pixels [m0, m1) of the
+// channels last sample X_ptr. All the channels see the same count, so the
+// update of a pixel costs a single reciprocal.
+template <typename T>
+inline void WelfordMomentsChannelsLast(
+    const T* X_ptr,
+    int64_t m0,
+    int64_t m1,
+    int64_t C,
+    float* mean_ptr,
+    float* m2_ptr) {
+  using fVec = at::vec::Vectorized<float>;
+  std::fill_n(mean_ptr, C, 0.f);
+  std::fill_n(m2_ptr, C, 0.f);
+  for (int64_t m = m0; m < m1; m++) {
+    const fVec r(1.f / static_cast<float>(m - m0 + 1));
+    const T* x_ptr = X_ptr + m * C;
+    for (int64_t c = 0; c < C; c += fVec::size()) {
+      const int64_t n = std::min(static_cast<int64_t>(fVec::size()), C - c);
+      fVec x = LoadAsFloat(x_ptr + c, n);
+      fVec mean = fVec::loadu(mean_ptr + c, n);
+      fVec m2 = fVec::loadu(m2_ptr + c, n);
+      fVec delta = x - mean;
+      mean = mean + delta * r;
+      m2 = m2 + delta * (x - mean);
+      mean.store(mean_ptr + c, n);
+      m2.store(m2_ptr + c, n);
+    }
+  }
+}
+
+// Group norm followed by SiLU of the channels last X into the channels last
+// Y. The moments are computed in a single Welford pass over X, parallel on
+// the chunks of pixels of each sample, whose partials are merged per group.
+// Y = silu(X * scale + bias) is then written once.
 template <typename T, typename PT>
-void ComputeInternalGradients(
+void GroupNormSiLUKernelImplInternal(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
     int64_t N,
     int64_t C,
     int64_t HxW,
-    const T* dY,
-    const T* X,
-    PT* ds,
-    PT* db) {
-  at::parallel_for(0, N * C, 1, [=](int64_t start, int64_t end) {
-    constexpr int64_t K = at::vec::Vectorized<T>::size();
-    const int64_t inner_size = HxW / K * K;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    std::array<PT, K> ds_arr;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    std::array<PT, K> db_arr;
-    for (const auto i : c10::irange(start, end)) {
-      const T* dY_ptr = dY + i * HxW;
-      const T* X_ptr = X + i * HxW;
-      at::vec::Vectorized<PT> ds_vec(0);
-      at::vec::Vectorized<PT> db_vec(0);
-      for (int64_t j = 0; j < inner_size; j += K) {
-        const at::vec::Vectorized<T> dy_vec =
-            at::vec::Vectorized<T>::loadu(dY_ptr + j);
-        const at::vec::Vectorized<T> x_vec =
-            at::vec::Vectorized<T>::loadu(X_ptr + j);
-        ds_vec = ds_vec + dy_vec * x_vec;
-        db_vec = db_vec + dy_vec;
+    int64_t group,
+    double eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  TORCH_CHECK(X.numel() == N * C * HxW);
+  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
+  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  using fVec = at::vec::Vectorized<float>;
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const T* X_data = X.data_ptr<T>();
+  const PT* gamma_data = gamma.defined() ? gamma.data_ptr<PT>() : nullptr;
+  const PT* beta_data = beta.defined() ? beta.data_ptr<PT>() : nullptr;
+  T* Y_data = Y.data_ptr<T>();
+  PT* mean_data = mean.data_ptr<PT>();
+  PT* rstd_data = rstd.data_ptr<PT>();
+
+  // enough chunks for all the threads when N is small
+  const int64_t max_chunks =
+      (HxW + kGroupNormSiLUMinChunk - 1) / kGroupNormSiLUMinChunk;
+  const int64_t wanted_chunks = (at::get_num_threads() + N - 1) / N;
+  int64_t num_chunks = std::max(
+      std::min(max_chunks, wanted_chunks), static_cast<int64_t>(1));
+  const int64_t chunk_size = (HxW + num_chunks - 1) / num_chunks;
+  num_chunks = (HxW + chunk_size - 1) / chunk_size;
+
+  // step-1: mean and m2 of each channel of each chunk
+  ScratchScope scratch;
+  at::Tensor partials = scratch.empty({N, num_chunks, 2, C}, at::kFloat);
+  float* partials_data = partials.data_ptr<float>();
+  utils::parallel_for(0, N * num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      const int64_t n = i / num_chunks;
+      const int64_t m0 = (i % num_chunks) * chunk_size;
+      const int64_t m1 = std::min(m0 + chunk_size, HxW);
+      float* mean_ptr = partials_data + i * 2 * C;
+      WelfordMomentsChannelsLast(
+          X_data + n * HxW * C, m0, m1, C, mean_ptr, mean_ptr + C);
+    }
+  });
+
+  // step-2: merge the partials of each group, then scale and bias of its
+  // channels
+  at::Tensor buffer = scratch.empty({N, 2 * C}, at::kFloat);
+  float* buffer_data = buffer.data_ptr<float>();
+  utils::parallel_for(0, N * G, 1, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      const int64_t n = i / G;
+      const int64_t g = i % G;
+      double count = 0, mean_val = 0, m2_val = 0;
+      for (const auto j : c10::irange(num_chunks)) {
+        const float* mean_ptr = partials_data + (n * num_chunks + j) * 2 * C;
+        const float* m2_ptr = mean_ptr + C;
+        const double chunk_count = static_cast<double>(
+            std::min((j + 1) * chunk_size, HxW) - j * chunk_size);
+        for (const auto d : c10::irange(D)) {
+          const int64_t c = g * D + d;
+          const double new_count = count + chunk_count;
+          const double delta = mean_ptr[c] - mean_val;
+          mean_val += delta * chunk_count / new_count;
+          m2_val += m2_ptr[c] + delta * delta * count * chunk_count / new_count;
+          count = new_count;
+        }
       }
-      ds_vec.store(ds_arr.data());
-      db_vec.store(db_arr.data());
-      PT ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), PT(0));
-      PT db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), PT(0));
-      for (const auto j : c10::irange(inner_size, HxW)) {
-        ds_val += dY_ptr[j] * X_ptr[j];
-        db_val += dY_ptr[j];
+      const float var = std::max(m2_val / count, 0.0);
+      const float rstd_val = 1.f / std::sqrt(var + static_cast<float>(eps));
+      mean_data[i] = static_cast<PT>(mean_val);
+      rstd_data[i] = static_cast<PT>(rstd_val);
+      float* scale_ptr = buffer_data + n * 2 * C;
+      float* bias_ptr = scale_ptr + C;
+      for (const auto d : c10::irange(D)) {
+        const int64_t c = g * D + d;
+        scale_ptr[c] =
+            rstd_val * (gamma_data ? static_cast<float>(gamma_data[c]) : 1.f);
+        bias_ptr[c] = -scale_ptr[c] * static_cast<float>(mean_val) +
+            (beta_data ? static_cast<float>(beta_data[c]) : 0.f);
+      }
+    }
+  });
+
+  // step-3: apply scale, bias and SiLU, parallel on N * HxW and vectorized on
+  // C
+  utils::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      const int64_t n = i / HxW;
+      const T* X_ptr = X_data + i * C;
+      T* Y_ptr = Y_data + i * C;
+      const float* scale_ptr = buffer_data + n * 2 * C;
+      const float* bias_ptr = scale_ptr + C;
+      for (int64_t c = 0; c < C; c += fVec::size()) {
+        const int64_t len =
+            std::min(static_cast<int64_t>(fVec::size()), C - c);
+        fVec y = LoadAsFloat(X_ptr + c, len) * fVec::loadu(scale_ptr + c, len) +
+            fVec::loadu(bias_ptr + c, len);
+        y = y * kernel::vec_sigmoid(y);
+        StoreFromFloat(Y_ptr + c, y, len);
       }
-      ds[i] = ds_val;
-      db[i] = db_val;
     }
   });
 }
 
-template <>
-void ComputeInternalGradients(
+void GroupNormSiLUKernelImpl(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  utils::ParallelStatsScope parallel_stats_scope("group_norm_silu");
+  const bool mixed_type = at::native::is_mixed_type(X, gamma, beta);
+  if (X.scalar_type() == at::kFloat) {
+    GroupNormSiLUKernelImplInternal<float, float>(
+        X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+  } else {
+    TORCH_CHECK(
+        X.scalar_type() == at::kBFloat16,
+        "group_norm_silu only supports float and bfloat16");
+    if (mixed_type) {
+      GroupNormSiLUKernelImplInternal<BFloat16, float>(
+          X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+    } else {
+      GroupNormSiLUKernelImplInternal<BFloat16, BFloat16>(
+          X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+    }
+  }
+}
+
+// Block of the [C, HxW] -> [HxW, C] transpose of a sample: one cache line of
+// Y per written row
+constexpr int64_t kTransposeBlockSize = 32;
+
+// Group norm of the contiguous X written as Y[N, HxW, C]. The moments are
+// computed on the contiguous groups of X, then scale and bias are applied by
+// kTransposeBlockSize x kTransposeBlockSize tiles, so that the reads of X and
+// the transposed writes of Y both stay in cache.
+template <typename T, typename PT>
+void GroupNormTransposeKernelImplInternal(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
     int64_t N,
     int64_t C,
     int64_t HxW,
-    const BFloat16* dY,
-    const BFloat16* X,
-    float* ds,
-    float* db) {
+    int64_t group,
+    double eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  TORCH_CHECK(X.numel() == N * C * HxW);
+  TORCH_CHECK(Y.numel() == N * C * HxW && Y.is_contiguous());
+  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
+  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const T* X_data = X.data_ptr<T>();
+  const PT* gamma_data = gamma.defined() ? gamma.data_ptr<PT>() : nullptr;
+  const PT* beta_data = beta.defined() ? beta.data_ptr<PT>() : nullptr;
+  T* Y_data = Y.data_ptr<T>();
+  PT* mean_data = mean.data_ptr<PT>();
+  PT* rstd_data = rstd.data_ptr<PT>();
+  const bool gamma_null = (gamma_data == nullptr);
+  const bool beta_null = beta_data == nullptr;
+  const int64_t inner_size = D * HxW;
+
+  using T_ACC = at::opmath_type<T>;
+
+  // scale and bias of each channel of each sample
+  ScratchScope scratch;
+  at::Tensor buffer =
+      scratch.empty({N, 2 * C}, c10::CppTypeToScalarType<T_ACC>::value);
+  T_ACC* buffer_data = buffer.data_ptr<T_ACC>();
+
+  utils::parallel_for(0, N * G, 1, [&](int64_t start, int64_t end) {
+    for (const auto i : c10::irange(start, end)) {
+      const T* X_ptr = X_data + i * inner_size;
+      T_ACC mean_val;
+      T_ACC rstd_val;
+      std::tie(mean_val, rstd_val) =
+          at::native::RowwiseMoments(X_ptr, inner_size);
+      rstd_val = T_ACC(1) / std::sqrt(std::max(rstd_val, T_ACC(0)) + eps);
+      const int64_t n = i / G;
+      const int64_t g = i % G;
+      T_ACC* scale_ptr = buffer_data + n * 2 * C;
+      T_ACC* bias_ptr = scale_ptr + C;
+      for (const auto j : c10::irange(D)) {
+        const int64_t c = g * D + j;
+        scale_ptr[c] =
+            rstd_val * (gamma_null ? T_ACC(1) : T_ACC(gamma_data[c]));
+        bias_ptr[c] = -scale_ptr[c] * mean_val +
+            (beta_null ? T_ACC(0) : T_ACC(beta_data[c]));
+      }
+      mean_data[i] = mean_val;
+      rstd_data[i] = rstd_val;
+    }
+  });
+
+  const int64_t hw_blocks =
+      (HxW + kTransposeBlockSize - 1) / kTransposeBlockSize;
+  const int64_t c_blocks = (C + kTransposeBlockSize - 1) / kTransposeBlockSize;
+  utils::parallel_for(
+      0, N * hw_blocks * c_blocks, 1, [&](int64_t begin, int64_t end) {
+        int64_t n{0}, hb{0}, cb{0};
+        at::native::data_index_init(
+            begin, n, N, hb, hw_blocks, cb, c_blocks);
+        for (int64_t i = begin; i < end; i++) {
+          const T_ACC* scale_ptr = buffer_data + n * 2 * C;
+          const T_ACC* bias_ptr = scale_ptr + C;
+          const int64_t hw0 = hb * kTransposeBlockSize;
+          const int64_t hw1 = std::min(hw0 + kTransposeBlockSize, HxW);
+          const int64_t c0 = cb * kTransposeBlockSize;
+          const int64_t c1 = std::min(c0 + kTransposeBlockSize, C);
+          T* Y_ptr = Y_data + n * HxW * C;
+          for (int64_t c = c0; c < c1; c++) {
+            const T* X_ptr = X_data + (n * C + c) * HxW;
+            const T_ACC scale = scale_ptr[c];
+            const T_ACC bias = bias_ptr[c];
+            for (int64_t hw = hw0; hw < hw1; hw++) {
+              Y_ptr[hw * C + c] = scale * T_ACC(X_ptr[hw]) + bias;
+            }
+          }
+          at::native::data_index_step(n, N, hb, hw_blocks, cb, c_blocks);
+        }
+      });
+}
+
+void GroupNormTransposeKernelImpl(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  utils::ParallelStatsScope parallel_stats_scope("group_norm_transpose");
+  const bool mixed_type = at::native::is_mixed_type(X, gamma, beta);
+  // A channels last X is already in the order of Y
+  const bool channels_last =
+      X.suggest_memory_format() != at::MemoryFormat::Contiguous ||
+      is_channels_last_1d(X);
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      X.scalar_type(),
+      "GroupNormTransposeKernelImpl",
+      [&]() {
+        if (channels_last) {
+          if (mixed_type) {
+            GroupNormKernelImplChannelsLastInternal<BFloat16, float>(
+                X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+          } else {
+            GroupNormKernelImplChannelsLastInternal<scalar_t, scalar_t>(
+                X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+          }
+        } else {
+          if (mixed_type) {
+            GroupNormTransposeKernelImplInternal<BFloat16, float>(
+                X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+          } else {
+            GroupNormTransposeKernelImplInternal<scalar_t, scalar_t>(
+                X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+          }
+        }
+      });
+}
+
+template <typename T, typename PT>
+inline void RowwiseInternalGradients(
+    const T* dY_ptr,
+    const T* X_ptr,
+    int64_t len,
+    PT& ds,
+    PT& db) {
+  constexpr int64_t K = at::vec::Vectorized<T>::size();
+  const int64_t inner_size = len / K * K;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+  std::array<PT, K> ds_arr;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+  std::array<PT, K> db_arr;
+  at::vec::Vectorized<PT> ds_vec(0);
+  at::vec::Vectorized<PT> db_vec(0);
+  for (int64_t j = 0; j < inner_size; j += K) {
+    const at::vec::Vectorized<T> dy_vec =
+        at::vec::Vectorized<T>::loadu(dY_ptr + j);
+    const at::vec::Vectorized<T> x_vec =
+        at::vec::Vectorized<T>::loadu(X_ptr + j);
+    ds_vec = ds_vec + dy_vec * x_vec;
+    db_vec = db_vec + dy_vec;
+  }
+  ds_vec.store(ds_arr.data());
+  db_vec.store(db_arr.data());
+  PT ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), PT(0));
+  PT db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), PT(0));
+  for (const auto j : c10::irange(inner_size, len)) {
+    ds_val += dY_ptr[j] * X_ptr[j];
+    db_val += dY_ptr[j];
+  }
+  ds = ds_val;
+  db = db_val;
+}
+
+template <>
+inline void RowwiseInternalGradients(
+    const BFloat16* dY_ptr,
+    const BFloat16* X_ptr,
+    int64_t len,
+    float& ds,
+    float& db) {
   using bVec = at::vec::Vectorized<BFloat16>;
   using fVec = at::vec::Vectorized<float>;
-  at::parallel_for(0, N * C, 1, [=](int64_t start, int64_t end) {
-    constexpr int64_t K = bVec::size();
-    const int64_t inner_size = HxW / K * K;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    std::array<float, K / 2> ds_arr;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    std::array<float, K / 2> db_arr;
-    for (const auto i : c10::irange(start, end)) {
-      const BFloat16* dY_ptr = dY + i * HxW;
-      const BFloat16* X_ptr = X + i * HxW;
-      fVec ds_vec(0);
-      fVec db_vec(0);
-      for (int64_t j = 0; j < inner_size; j += K) {
-        const bVec dy_bvec = bVec::loadu(dY_ptr + j);
-        const bVec x_bvec = bVec::loadu(X_ptr + j);
-        fVec x_fvec0, x_fvec1, dy_fvec0, dy_fvec1;
-        std::tie(x_fvec0, x_fvec1) = convert_bfloat16_float(x_bvec);
-        std::tie(dy_fvec0, dy_fvec1) = convert_bfloat16_float(dy_bvec);
-        ds_vec = ds_vec + dy_fvec0 * x_fvec0;
-        ds_vec = ds_vec + dy_fvec1 * x_fvec1;
-        db_vec = db_vec + dy_fvec0 + dy_fvec1;
+  constexpr int64_t K = bVec::size();
+  const int64_t inner_size = len / K * K;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+  std::array<float, K / 2> ds_arr;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+  std::array<float, K / 2> db_arr;
+  fVec ds_vec(0);
+  fVec db_vec(0);
+  for (int64_t j = 0; j < inner_size; j += K) {
+    const bVec dy_bvec = bVec::loadu(dY_ptr + j);
+    const bVec x_bvec = bVec::loadu(X_ptr + j);
+    fVec x_fvec0, x_fvec1, dy_fvec0, dy_fvec1;
+    std::tie(x_fvec0, x_fvec1) = convert_bfloat16_float(x_bvec);
+    std::tie(dy_fvec0, dy_fvec1) = convert_bfloat16_float(dy_bvec);
+    ds_vec = ds_vec + dy_fvec0 * x_fvec0;
+    ds_vec = ds_vec + dy_fvec1 * x_fvec1;
+    db_vec = db_vec + dy_fvec0 + dy_fvec1;
+  }
+  ds_vec.store(ds_arr.data());
+  db_vec.store(db_arr.data());
+  float ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), float(0));
+  float db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), float(0));
+  for (const auto j : c10::irange(inner_size, len)) {
+    ds_val += float(dY_ptr[j]) * float(X_ptr[j]);
+    db_val += float(dY_ptr[j]);
+  }
+  ds = ds_val;
+  db = db_val;
+}
+
+// ds and db of the N * C rows of HxW. At the small batch sizes the rows are
+// split into spatial blocks as well, the partials of the blocks of a row
+// being summed in a second pass.
+template <typename T, typename PT>
+void ComputeInternalGradients(
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    const T* dY,
+    const T* X,
+    PT* ds,
+    PT* db) {
+  const int64_t block_size = spatial_block_size(N * C, HxW);
+  const int64_t blocks = at::divup(HxW, block_size);
+  if (blocks == 1) {
+    utils::parallel_for(0, N * C, 1, [=](int64_t start, int64_t end) {
+      for (const auto i : c10::irange(start, end)) {
+        RowwiseInternalGradients<T, PT>(
+            dY + i * HxW, X + i * HxW, HxW, ds[i], db[i]);
       }
-      ds_vec.store(ds_arr.data());
-      db_vec.store(db_arr.data());
-      float ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), float(0));
-      float db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), float(0));
-      for (const auto j : c10::irange(inner_size, HxW)) {
-        ds_val += float(dY_ptr[j]) * float(X_ptr[j]);
-        db_val += float(dY_ptr[j]);
+    });
+    return;
+  }
+  std::vector<PT> partials(N * C * blocks * 2);
+  PT* partials_data = partials.data();
+  utils::parallel_for(0, N * C * blocks, 1, [=](int64_t start, int64_t end) {
+    for (const auto i : c10::irange(start, end)) {
+      const int64_t offset = (i / blocks) * HxW + (i % blocks) * block_size;
+      const int64_t len = std::min(block_size, HxW - (i % blocks) * block_size);
+      RowwiseInternalGradients<T, PT>(
+          dY + offset,
+          X + offset,
+          len,
+          partials_data[2 * i],
+          partials_data[2 * i + 1]);
+    }
+  });
+  utils::parallel_for(0, N * C, 1, [=](int64_t start, int64_t end) {
+    for (const auto i : c10::irange(start, end)) {
+      PT ds_val{0}, db_val{0};
+      for (const auto b : c10::irange(blocks)) {
+        ds_val += partials_data[2 * (i * blocks + b)];
+        db_val += partials_data[2 * (i * blocks + b) + 1];
       }
       ds[i] = ds_val;
       db[i] = db_val;
@@ -701,7 +1088,10 @@ void GroupNormInputBackward(
   const int64_t D = C / G;
   const PT s = PT(1) / static_cast<PT>(D * HxW);
   const bool gamma_null = (gamma == nullptr);
-  at::parallel_for(0, N * G, 1, [=](int64_t start, int64_t end) {
+  // c2 and c3 of every group
+  std::vector<PT> coeffs(N * G * 2);
+  PT* coeffs_data = coeffs.data();
+  utils::parallel_for(0, N * G, 1, [=](int64_t start, int64_t end) {
     constexpr int64_t K = at::vec::Vectorized<PT>::size();
     const int64_t d = D / K * K;
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
@@ -732,16 +1122,30 @@ void GroupNormInputBackward(
       const PT c2 = (db_val * PT(mean[i]) - ds_val) * PT(rstd[i]) *
           PT(rstd[i]) * PT(rstd[i]) * s;
       const PT c3 = -c2 * PT(mean[i]) - db_val * PT(rstd[i]) * s;
+      coeffs_data[2 * i] = c2;
+      coeffs_data[2 * i + 1] = c3;
+    }
+  });
 
-      for (const auto j : c10::irange(D)) {
-        const int64_t c = g * D + j;
-        const T* dY_ptr = dY + (i * D + j) * HxW;
-        const T* X_ptr = X + (i * D + j) * HxW;
-        T* dX_ptr = dX + (i * D + j) * HxW;
-        const PT c1 = PT(rstd[i]) * (gamma_null ? PT(1) : PT(gamma[c]));
-        for (const auto k : c10::irange(HxW)) {
-          dX_ptr[k] = c1 * PT(dY_ptr[k]) + c2 * PT(X_ptr[k]) + c3;
-        }
+  // dX of the N * C rows of HxW, split into spatial blocks at the small batch
+  // sizes
+  const int64_t block_size = spatial_block_size(N * C, HxW);
+  const int64_t blocks = at::divup(HxW, block_size);
+  utils::parallel_for(0, N * C * blocks, 1, [=](int64_t start, int64_t end) {
+    for (const auto i : c10::irange(start, end)) {
+      const int64_t row = i / blocks;
+      const int64_t c = row % C;
+      const int64_t ng = row / D;
+      const int64_t k0 = (i % blocks) * block_size;
+      const int64_t k1 = std::min(HxW, k0 + block_size);
+      const T* dY_ptr = dY + row * HxW;
+      const T* X_ptr = X + row * HxW;
+      T* dX_ptr = dX + row * HxW;
+      const PT c1 = PT(rstd[ng]) * (gamma_null ? PT(1) : PT(gamma[c]));
+      const PT c2 = coeffs_data[2 * ng];
+      const PT c3 = coeffs_data[2 * ng + 1];
+      for (const auto k : c10::irange(k0, k1)) {
+        dX_ptr[k] = c1 * PT(dY_ptr[k]) + c2 * PT(X_ptr[k]) + c3;
       }
     }
   });
@@ -760,7 +1164,7 @@ void GammaBackward(
   const int64_t G = group;
   const int64_t D = C / G;
   constexpr int64_t K = at::vec::Vectorized<T>::size();
-  at::parallel_for(0, D, K, [=](int64_t start, int64_t end) {
+  utils::parallel_for(0, D, K, [=](int64_t start, int64_t end) {
     for (const auto i : c10::irange(G)) {
       std::memset(dgamma + i * D + start, 0, (end - start) * sizeof(T));
     }
@@ -780,7 +1184,7 @@ void GammaBackward(
 template <typename T>
 void BetaBackward(int64_t N, int64_t C, const T* db, T* dbeta) {
   constexpr int64_t K = at::vec::Vectorized<T>::size();
-  at::parallel_for(0, C, K, [=](int64_t start, int64_t end) {
+  utils::parallel_for(0, C, K, [=](int64_t start, int64_t end) {
     std::memset(dbeta + start, 0, (end - start) * sizeof(T));
     for (const auto i : c10::irange(N)) {
       const T* db_ptr = db + i * C;
@@ -818,10 +1222,9 @@ void GroupNormBackwardKernelImplInternal(
   T* dX_data = dX.defined() ? dX.data_ptr<T>() : nullptr;
   PT* dgamma_data = dgamma.defined() ? dgamma.data_ptr<PT>() : nullptr;
   PT* dbeta_data = dbeta.defined() ? dbeta.data_ptr<PT>() : nullptr;
-  at::Tensor ds =
-      at::empty({N, C}, X.options().dtype(c10::CppTypeToScalarType<PT>::value));
-  at::Tensor db =
-      at::empty({N, C}, X.options().dtype(c10::CppTypeToScalarType<PT>::value));
+  ScratchScope scratch;
+  at::Tensor ds = scratch.empty({N, C}, c10::CppTypeToScalarType<PT>::value);
+  at::Tensor db = scratch.empty({N, C}, c10::CppTypeToScalarType<PT>::value);
   PT* ds_data = ds.data_ptr<PT>();
   PT* db_data = db.data_ptr<PT>();
   ComputeInternalGradients<T, PT>(N, C, HxW, dY_data, X_data, ds_data, db_data);
@@ -1296,10 +1699,9 @@ void GroupNormBackwardKernelImplChannelsLastInternal(
   PT* dgamma_data = dgamma.defined() ? dgamma.data_ptr<PT>() : nullptr;
   PT* dbeta_data = dbeta.defined() ? dbeta.data_ptr<PT>() : nullptr;
   const bool gamma_null = (gamma_data == nullptr);
-  at::Tensor ds =
-      at::empty({N, C}, X.options().dtype(c10::CppTypeToScalarType<PT>::value));
-  at::Tensor db =
-      at::empty({N, C}, X.options().dtype(c10::CppTypeToScalarType<PT>::value));
+  ScratchScope scratch;
+  at::Tensor ds = scratch.empty({N, C}, c10::CppTypeToScalarType<PT>::value);
+  at::Tensor db = scratch.empty({N, C}, c10::CppTypeToScalarType<PT>::value);
   PT* ds_data = ds.data_ptr<PT>();
   PT* db_data = db.data_ptr<PT>();
   const PT s = PT(1) / static_cast<PT>(D * HxW);
@@ -1313,11 +1715,12 @@ void GroupNormBackwardKernelImplChannelsLastInternal(
 
   // Generally impl-2 has better performance when HxW is large enough, so that
   //   data per thread {NHWC / T} is much larger then temp buffer per thread
-  //   {2NC}
+  //   {2NC}, and when N * G is too small to keep all the threads busy.
   constexpr int64_t feature_map_threshold = 2048;
-  if (HxW < feature_map_threshold) {
+  int num_threads = at::get_num_threads();
+  if (HxW < feature_map_threshold && N * G >= num_threads) {
     // impl-1: parallel on N * G.
-    at::parallel_for(0, N * G, 1, [=](int64_t begin, int64_t end) {
+    utils::parallel_for(0, N * G, 1, [=](int64_t begin, int64_t end) {
       int64_t n{0}, g{0};
       at::native::data_index_init(begin, n, N, g, G);
       for (const auto i : c10::irange(begin, end)) {
@@ -1345,7 +1748,6 @@ void GroupNormBackwardKernelImplChannelsLastInternal(
 
   } else {
     // impl-2: parallel on N * HxW.
-    int num_threads = at::get_num_threads();
     at::Tensor buffer =
         at::empty(
             {num_threads, N, 2 * C},
@@ -1358,7 +1760,7 @@ void GroupNormBackwardKernelImplChannelsLastInternal(
     PT* tmp_buffer_data = tmp_buffer.data_ptr<PT>();
 
     // Step 1. Each thread compute their own internal gradients to the buffer.
-    at::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
+    utils::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
       int tid = at::get_thread_num();
       PT* buffer_ptr = buffer_data + tid * N * 2 * C;
       int64_t n{0}, m{0};
@@ -1376,34 +1778,37 @@ void GroupNormBackwardKernelImplChannelsLastInternal(
 
     // Step 2. Collect internal gradients from each thread and
     // get the final internal gradients to ds, db, and tmp_buffer.
-    for (const auto n : c10::irange(N)) {
-      for (const auto g : c10::irange(G)) {
+    // The partials of the threads are summed over blocks of channels first,
+    // then the gamma weighted sums of every group.
+    utils::parallel_for(0, N * C, 1024, [&](int64_t begin, int64_t end) {
+      std::fill(ds_data + begin, ds_data + end, PT(0));
+      std::fill(db_data + begin, db_data + end, PT(0));
+      for (const auto t : c10::irange(num_threads)) {
+        const PT* buffer_ptr = buffer_data + t * N * 2 * C;
+        for (const auto i : c10::irange(begin, end)) {
+          const int64_t offset = i + (i / C) * C;
+          ds_data[i] += buffer_ptr[offset];
+          db_data[i] += buffer_ptr[offset + C];
+        }
+      }
+    });
+    utils::parallel_for(0, N * G, 1, [&](int64_t begin, int64_t end) {
+      for (const auto i : c10::irange(begin, end)) {
+        const int64_t g = i % G;
         PT ds_gamma{0}, db_gamma{0};
         for (const auto d : c10::irange(D)) {
-          PT ds_val{0}, db_val{0};
-          for (const auto t : c10::irange(num_threads)) {
-            PT* buffer_ptr = buffer_data + t * N * 2 * C + n * 2 * C;
-            if (gamma_null) {
-              ds_gamma += buffer_ptr[g * D + d];
-              db_gamma += buffer_ptr[g * D + d + C];
-            } else {
-              ds_gamma += buffer_ptr[g * D + d] * gamma_data[g * D + d];
-              db_gamma += buffer_ptr[g * D + d + C] * gamma_data[g * D + d];
-            }
-            ds_val += buffer_ptr[g * D + d];
-            db_val += buffer_ptr[g * D + d + C];
-          }
-          ds_data[n * C + g * D + d] = ds_val;
-          db_data[n * C + g * D + d] = db_val;
+          const PT gamma_v = gamma_null ? PT(1) : gamma_data[g * D + d];
+          ds_gamma += ds_data[i * D + d] * gamma_v;
+          db_gamma += db_data[i * D + d] * gamma_v;
         }
-        tmp_buffer_data[n * 2 * G + 2 * g] = ds_gamma;
-        tmp_buffer_data[n * 2 * G + 2 * g + 1] = db_gamma;
+        tmp_buffer_data[2 * i] = ds_gamma;
+        tmp_buffer_data[2 * i + 1] = db_gamma;
       }
-    }
+    });
 
     // Step 3. Compute dx.
     if (dX_data != nullptr) {
-      at::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
+      utils::parallel_for(0, N * HxW, 1, [&](int64_t begin, int64_t end) {
         int64_t n{0}, m{0};
         at::native::data_index_init(begin, n, N, m, HxW);
         for (const auto i : c10::irange(begin, end)) {
@@ -1454,6 +1859,7 @@ void GroupNormBackwardKernelImpl(
     at::Tensor& dX,
     at::Tensor& dgamma,
     at::Tensor& dbeta) {
+  utils::ParallelStatsScope parallel_stats_scope("group_norm_backward");
   // In training, using Amp to enable BFloat16 is recommended.
   // It will keep module parameters in acc dtype i.e. float
   // while input/output will be in BFloat16.
@@ -1554,6 +1960,8 @@ void GroupNormBackwardKernelImpl(
 
 REGISTER_DISPATCH(GroupNormKernel, &GroupNormKernelImpl);
 REGISTER_DISPATCH(GroupNormBackwardKernel, &GroupNormBackwardKernelImpl);
+REGISTER_DISPATCH(GroupNormTransposeKernel, &GroupNormTransposeKernelImpl);
+REGISTER_DISPATCH(GroupNormSiLUKernel, &GroupNormSiLUKernelImpl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
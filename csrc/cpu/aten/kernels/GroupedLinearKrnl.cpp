@@ -0,0 +1,204 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/GroupedLinear.h>
+
+/*
+ The GEMMs of a grouped linear are cut into tasks of grouped_linear_block_n
+ weight rows or more, sized so that all tasks have about the same number of
+ multiply-adds whatever the shapes of their GEMM. The tasks of all the GEMMs
+ are then split over the threads by a single parallel_for. Each task streams
+ its weight rows once per grouped_linear_block_m input rows, which stay in L1
+ for the small GEMMs this op is meant for.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+const int64_t grouped_linear_block_m = 4;
+const int64_t grouped_linear_block_n = 4;
+// tasks per thread, to balance the tails of the GEMMs
+const int64_t grouped_linear_tasks_per_thread = 4;
+
+inline void load_fvec2(const float* ptr, fVec& a, fVec& b) {
+  a = fVec::loadu(ptr);
+  b = fVec::loadu(ptr + fVec::size());
+}
+
+inline void load_fvec2(const at::BFloat16* ptr, fVec& a, fVec& b) {
+  std::tie(a, b) = at::vec::convert_bfloat16_float(bVec::loadu(ptr));
+}
+
+inline float reduce_add(const fVec& v) {
+  float buf[fVec::size()];
+  v.store(buf);
+  float sum = 0.f;
+  for (int64_t i = 0; i < fVec::size(); i++) {
+    sum += buf[i];
+  }
+  return sum;
+}
+
+// out[MB, nb] = x[MB, K] * w[nb, K]^T + bias, nb <= grouped_linear_block_n
+template <typename T, int64_t MB>
+void grouped_linear_block(
+    const T* x,
+    const T* w,
+    const T* bias,
+    T* out,
+    int64_t nb,
+    int64_t N,
+    int64_t K) {
+  constexpr int64_t NB = grouped_linear_block_n;
+  constexpr int64_t step = 2 * fVec::size();
+  fVec acc[MB][NB];
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t n = 0; n < NB; n++) {
+      acc[m][n] = fVec(0.f);
+    }
+  }
+  int64_t k = 0;
+  for (; k < K - (K % step); k += step) {
+    fVec x0[MB], x1[MB];
+    for (int64_t m = 0; m < MB; m++) {
+      load_fvec2(x + m * K + k, x0[m], x1[m]);
+    }
+    for (int64_t n = 0; n < nb; n++) {
+      fVec w0, w1;
+      load_fvec2(w + n * K + k, w0, w1);
+      for (int64_t m = 0; m < MB; m++) {
+        acc[m][n] = at::vec::fmadd(x0[m], w0, acc[m][n]);
+        acc[m][n] = at::vec::fmadd(x1[m], w1, acc[m][n]);
+      }
+    }
+  }
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t n = 0; n < nb; n++) {
+      float sum = reduce_add(acc[m][n]);
+      for (int64_t kk = k; kk < K; kk++) {
+        sum += float(x[m * K + kk]) * float(w[n * K + kk]);
+      }
+      if (bias) {
+        sum += float(bias[n]);
+      }
+      out[m * N + n] = T(sum);
+    }
+  }
+}
+
+template <typename T>
+using grouped_linear_block_fn = decltype(&grouped_linear_block<T, 1>);
+
+template <typename T>
+grouped_linear_block_fn<T> get_grouped_linear_block(int64_t MB) {
+  static const grouped_linear_block_fn<T> fns[grouped_linear_block_m] = {
+      grouped_linear_block<T, 1>,
+      grouped_linear_block<T, 2>,
+      grouped_linear_block<T, 3>,
+      grouped_linear_block<T, 4>};
+  return fns[MB - 1];
+}
+
+struct GroupedLinearTask {
+  int64_t gemm;
+  int64_t n_begin;
+  int64_t n_end;
+};
+
+template <typename T>
+void grouped_linear_kernel(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& weights,
+    const std::vector<at::Tensor>& biases,
+    std::vector<at::Tensor>& outputs) {
+  int64_t total_cost = 0;
+  for (size_t g = 0; g < inputs.size(); g++) {
+    total_cost += inputs[g].numel() * weights[g].size(0);
+  }
+  int64_t task_cost = std::max(
+      total_cost / (at::get_num_threads() * grouped_linear_tasks_per_thread),
+      int64_t(1));
+
+  std::vector<GroupedLinearTask> tasks;
+  for (size_t g = 0; g < inputs.size(); g++) {
+    int64_t M = inputs[g].size(0);
+    int64_t N = weights[g].size(0);
+    int64_t K = weights[g].size(1);
+    if (M == 0 || N == 0) {
+      continue;
+    }
+    // the weight rows of a task, a multiple of grouped_linear_block_n
+    int64_t rows =
+        std::max(task_cost / std::max(M * K, int64_t(1)), int64_t(1));
+    rows = (rows + grouped_linear_block_n - 1) / grouped_linear_block_n *
+        grouped_linear_block_n;
+    for (int64_t n = 0; n < N; n += rows) {
+      tasks.push_back({static_cast<int64_t>(g), n, std::min(n + rows, N)});
+    }
+  }
+
+  int64_t num_tasks = tasks.size();
+  at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const auto& task = tasks[i];
+      const auto& input = inputs[task.gemm];
+      const auto& weight = weights[task.gemm];
+      const auto& bias = biases[task.gemm];
+      int64_t M = input.size(0);
+      int64_t N = weight.size(0);
+      int64_t K = weight.size(1);
+      const T* x = input.data_ptr<T>();
+      const T* w = weight.data_ptr<T>();
+      const T* b = bias.defined() ? bias.data_ptr<T>() : nullptr;
+      T* out = outputs[task.gemm].data_ptr<T>();
+      for (int64_t n = task.n_begin; n < task.n_end;
+           n += grouped_linear_block_n) {
+        int64_t nb = std::min(grouped_linear_block_n, task.n_end - n);
+        for (int64_t m = 0; m < M; m += grouped_linear_block_m) {
+          int64_t mb = std::min(grouped_linear_block_m, M - m);
+          get_grouped_linear_block<T>(mb)(
+              x + m * K,
+              w + n * K,
+              b ? b + n : nullptr,
+              out + m * N + n,
+              nb,
+              N,
+              K);
+        }
+      }
+    }
+  });
+}
+
+void grouped_linear_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& weights,
+    const std::vector<at::Tensor>& biases,
+    std::vector<at::Tensor>& outputs) {
+  if (inputs.empty()) {
+    return;
+  }
+  // the op checks that all the tensors of a linear have the same dtype
+  auto dtype = inputs[0].scalar_type();
+  for (const auto& input : inputs) {
+    TORCH_CHECK(
+        input.scalar_type() == dtype,
+        "grouped_linear expects all the inputs to have the same dtype");
+  }
+  if (dtype == at::kFloat) {
+    grouped_linear_kernel<float>(inputs, weights, biases, outputs);
+  } else {
+    grouped_linear_kernel<at::BFloat16>(inputs, weights, biases, outputs);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(grouped_linear_kernel_stub, &grouped_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,158 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/OpMathType.h>
+#include <ATen/Parallel.h>
+#include <ATen/record_function.h>
+#include <c10/util/irange.h>
+
+#include <aten/IndexAdd.h>
+#include <aten/utils/radix_sort.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/parallel_stats.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The elements of a slice summed by a task, whose accumulators stay in L1
+constexpr int64_t kBlockInner = 1024;
+// The indices checked and paired by a task
+constexpr int64_t kGrainSize = 4096;
+
+// dst[0, len) += alpha * src[0, len), accumulated in acc_t
+template <typename acc_t, typename scalar_t>
+inline void add_scale_ker(
+    acc_t* dst,
+    const scalar_t* src,
+    acc_t alpha,
+    int64_t len) {
+#pragma omp simd
+  for (int64_t k = 0; k < len; k++) {
+    dst[k] += alpha * static_cast<acc_t>(src[k]);
+  }
+}
+
+template <typename scalar_t, typename index_t>
+void index_add_sorted(
+    at::Tensor& result,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    int64_t skip_index) {
+  using acc_t = at::opmath_type<scalar_t>;
+  const int64_t outer_size = c10::size_to_dim_(dim, result.sizes());
+  const int64_t dim_size = result.size(dim);
+  const int64_t inner_size = c10::size_from_dim_(dim + 1, result.sizes());
+  const int64_t index_size = index.numel();
+  const index_t* index_data = index.data_ptr<index_t>();
+  const scalar_t* source_data = source.data_ptr<scalar_t>();
+  scalar_t* result_data = result.data_ptr<scalar_t>();
+  const acc_t alpha_ = alpha.to<acc_t>();
+
+  // the (index, position) pairs of the source slices, sorted by index by the
+  // stable radix sort so that the slices of an index keep their order
+  std::vector<Key_Value_Weight_Tuple<int>> pairs(index_size);
+  std::vector<Key_Value_Weight_Tuple<int>> tmp(index_size);
+  at::parallel_for(0, index_size, kGrainSize, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      index_t idx = index_data[i];
+      TORCH_CHECK_INDEX(
+          idx >= 0 && idx < dim_size,
+          "index_add_(): index ",
+          idx,
+          " is out of bounds for dimension ",
+          dim,
+          " with size ",
+          dim_size);
+      pairs[i] = Key_Value_Weight_Tuple<int>(idx, i, 1.f);
+    }
+  });
+  auto* sorted = radix_sort_parallel<int>(
+      pairs.data(), tmp.data(), index_size, dim_size - 1);
+
+  // the segments of the positions of an index
+  std::vector<int64_t> segments;
+  for (const auto i : c10::irange(index_size)) {
+    if (i == 0 || std::get<0>(sorted[i]) != std::get<0>(sorted[i - 1])) {
+      segments.push_back(i);
+    }
+  }
+  segments.push_back(index_size);
+  const int64_t num_segments = segments.size() - 1;
+
+  // a task sums the slices of a segment, for an outer index and a block of
+  // the inner elements
+  const int64_t num_blocks = at::divup(inner_size, kBlockInner);
+  const int64_t task_size =
+      index_size / num_segments * std::min(inner_size, kBlockInner);
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / task_size);
+  at::parallel_for(
+      0,
+      outer_size * num_segments * num_blocks,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        acc_t acc[kBlockInner];
+        for (const auto t : c10::irange(begin, end)) {
+          const int64_t b = t % num_blocks;
+          const int64_t s = t / num_blocks % num_segments;
+          const int64_t o = t / num_blocks / num_segments;
+          const int64_t idx = std::get<0>(sorted[segments[s]]);
+          if (idx == skip_index) {
+            continue;
+          }
+          const int64_t k0 = b * kBlockInner;
+          const int64_t len = std::min(kBlockInner, inner_size - k0);
+          scalar_t* dst = result_data + (o * dim_size + idx) * inner_size + k0;
+          const scalar_t* src = source_data + o * index_size * inner_size + k0;
+          for (const auto k : c10::irange(len)) {
+            acc[k] = static_cast<acc_t>(dst[k]);
+          }
+          for (int64_t p = segments[s]; p < segments[s + 1]; p++) {
+#ifdef __GNUC__
+            if (p + 1 < segments[s + 1]) {
+              __builtin_prefetch(
+                  src + std::get<1>(sorted[p + 1]) * inner_size, 0, 1);
+            }
+#endif // __GNUC__
+            add_scale_ker(
+                acc, src + std::get<1>(sorted[p]) * inner_size, alpha_, len);
+          }
+          for (const auto k : c10::irange(len)) {
+            dst[k] = static_cast<scalar_t>(acc[k]);
+          }
+        }
+      });
+}
+
+void index_add_kernel_impl(
+    at::Tensor& result,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    int64_t skip_index) {
+  RECORD_FUNCTION("index_add_kernel_impl", c10::ArrayRef<c10::IValue>({}));
+  utils::ParallelStatsScope parallel_stats_scope("index_add");
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::kBFloat16, result.scalar_type(), "index_add_sorted", [&] {
+        AT_DISPATCH_INDEX_TYPES(
+            index.scalar_type(), "index_add_sorted_index", [&] {
+              index_add_sorted<scalar_t, index_t>(
+                  result, dim, index, source, alpha, skip_index);
+            });
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(index_add_kernel_stub, &index_add_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
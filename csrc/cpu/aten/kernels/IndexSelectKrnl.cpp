@@ -15,6 +15,8 @@
 #include <utils/library.h>
 
 #include <aten/TensorAdvancedIndexing.h>
+#include <aten/utils/streaming_store.h>
+#include "vec/vec.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -39,19 +41,20 @@ static inline void check_indexarray_range(
   }
 }
 
+// the slices shorter than a page are copied through the caches, the fences of
+// the streaming copies would cost more than they save
+constexpr int64_t min_streaming_copy_bytes = 4096;
+
 template <typename scalar_t>
-static inline void copy_stub(scalar_t* result, scalar_t* self, int64_t size) {
-  using Vec = at::vec::Vectorized<scalar_t>;
-  int64_t d = 0;
-  for (; d < size - (size % Vec::size()); d += Vec::size()) {
-    Vec data_vec = Vec::loadu(self + d);
-    data_vec.store(result + d);
-  }
-#if !defined(_MSC_VER) && !defined(COMPILING_FOR_MIN_SIZE)
-#pragma unroll
-#endif
-  for (; d < size; ++d) {
-    result[d] = self[d];
+static inline void copy_stub(
+    scalar_t* result,
+    scalar_t* self,
+    int64_t size,
+    bool streaming) {
+  if (streaming && size * sizeof(scalar_t) >= min_streaming_copy_bytes) {
+    kernel::stream_copy_ker(result, self, size);
+  } else {
+    kernel::copy_ker(result, self, size);
   }
 }
 
@@ -61,7 +64,9 @@ static void index_select_firstdim_impl(
     scalar_t* self_data,
     index_t* index_data,
     int64_t index_size,
-    int64_t inner_size) {
+    int64_t inner_size,
+    int64_t dim_stride,
+    bool streaming) {
   constexpr int64_t grain_size = at::internal::GRAIN_SIZE / 2;
   if (inner_size > grain_size) {
     constexpr int64_t block_size = 2048;
@@ -79,10 +84,10 @@ static void index_select_firstdim_impl(
 
             index_t offset = index_data[j];
             scalar_t* self_ptr =
-                self_data + offset * inner_size + inner_idx_begin;
+                self_data + offset * dim_stride + inner_idx_begin;
             scalar_t* result_ptr =
                 result_data + j * inner_size + inner_idx_begin;
-            copy_stub(result_ptr, self_ptr, size);
+            copy_stub(result_ptr, self_ptr, size, streaming);
           }
         });
   } else {
@@ -96,12 +101,12 @@ static void index_select_firstdim_impl(
 #ifdef __GNUC__
             if (j + 1 < index_size) {
               __builtin_prefetch(
-                  self_data + index_data[j + 1] * inner_size, 0, 1);
+                  self_data + index_data[j + 1] * dim_stride, 0, 1);
             }
 #endif // __GNUC__
-            scalar_t* self_ptr = self_data + offset * inner_size;
+            scalar_t* self_ptr = self_data + offset * dim_stride;
             scalar_t* result_ptr = result_data + j * inner_size;
-            copy_stub(result_ptr, self_ptr, inner_size);
+            copy_stub(result_ptr, self_ptr, inner_size, streaming);
           }
         });
   }
@@ -113,9 +118,11 @@ static void index_select_non_firstdim_impl(
     scalar_t* self_data,
     index_t* index_data,
     int64_t outer_size,
-    int64_t dim_size,
     int64_t index_size,
-    int64_t inner_size) {
+    int64_t inner_size,
+    int64_t outer_stride,
+    int64_t dim_stride,
+    bool streaming) {
   constexpr int64_t grain_size = at::internal::GRAIN_SIZE / 2;
   at::parallel_for(
       0,
@@ -128,9 +135,9 @@ static void index_select_non_firstdim_impl(
         for (const auto ii : c10::irange(begin, end)) {
           index_t offset = index_data[j];
           scalar_t* self_ptr =
-              self_data + i * dim_size * inner_size + offset * inner_size;
+              self_data + i * outer_stride + offset * dim_stride;
           scalar_t* result_ptr = result_data + ii * inner_size;
-          copy_stub(result_ptr, self_ptr, inner_size);
+          copy_stub(result_ptr, self_ptr, inner_size, streaming);
           // move on to next index in {outer_size, index_size}
           at::native::data_index_step(i, outer_size, j, index_size);
         }
@@ -143,8 +150,9 @@ static void index_select_gather_impl(
     scalar_t* self_data,
     index_t* index_data,
     int64_t outer_size,
-    int64_t dim_size,
-    int64_t index_size) {
+    int64_t index_size,
+    int64_t outer_stride,
+    int64_t dim_stride) {
   using Vec = at::vec::Vectorized<scalar_t>;
   using integer_t = at::vec::int_same_size_t<scalar_t>;
   using iVec = at::vec::Vectorized<integer_t>;
@@ -163,11 +171,11 @@ static void index_select_gather_impl(
         for (const auto j : c10::irange(index_size)) {
           for (const auto k : c10::irange(inner_size)) {
             index_buffer[j * inner_size + k] =
-                integer_t(index_data[j] * inner_size + k);
+                integer_t(index_data[j] * dim_stride + k);
           }
         }
         for (const auto i : c10::irange(begin, end)) {
-          scalar_t* self_ptr = self_data + i * dim_size * inner_size;
+          scalar_t* self_ptr = self_data + i * outer_stride;
           scalar_t* result_ptr = result_data + i * index_size * inner_size;
 
           // `gather` data chunk of Vec::size() by inner_size each step
@@ -207,6 +215,16 @@ void cpu_index_select_dispatch(
   //   self: [outer_size, dim_size, inner_size]
   //   result: [outer_size, index_size, inner_size]
   //
+  // the inner slices of self are dense, its outer dims collapse into one
+  // stride, e.g. the rows of a table sliced along its columns
+  int64_t outer_stride = dim_size * inner_size;
+  for (int64_t d = dim - 1; d >= 0; d--) {
+    if (self_sizes[d] != 1) {
+      outer_stride = self.stride(d);
+      break;
+    }
+  }
+  int64_t dim_stride = dim_size == 1 ? inner_size : self.stride(dim);
   scalar_t* result_data = result.data_ptr<scalar_t>();
   scalar_t* self_data = self.data_ptr<scalar_t>();
   index_t* index_data = index.data_ptr<index_t>();
@@ -229,31 +247,56 @@ void cpu_index_select_dispatch(
   //   The kernel parallels on {outer_size, index_size} and do vectorized copy
   //   on {inner_size}
   //
+  // The copies of 2. and 3. write the result with non-temporal stores when it
+  // is bigger than the streaming store threshold.
+  //
   // Lower the default grain size by half since index_select is indirect memory
   // access.
   //
   int64_t max_value = std::numeric_limits<int32_t>::max();
-  bool can_use_32bit_indexing = (dim_size * inner_size) < max_value;
+  bool can_use_32bit_indexing = (dim_size * dim_stride) < max_value;
+
+  bool streaming = use_streaming_store(result.nbytes());
 
   const auto st = result.scalar_type();
   if (st == at::kFloat && can_use_32bit_indexing && inner_size == 1) {
     index_select_gather_impl<scalar_t, index_t, 1>(
-        result_data, self_data, index_data, outer_size, dim_size, index_size);
+        result_data,
+        self_data,
+        index_data,
+        outer_size,
+        index_size,
+        outer_stride,
+        dim_stride);
   } else if (st == at::kFloat && can_use_32bit_indexing && inner_size == 2) {
     index_select_gather_impl<scalar_t, index_t, 2>(
-        result_data, self_data, index_data, outer_size, dim_size, index_size);
+        result_data,
+        self_data,
+        index_data,
+        outer_size,
+        index_size,
+        outer_stride,
+        dim_stride);
   } else if (outer_size == 1) {
     index_select_firstdim_impl<scalar_t, index_t>(
-        result_data, self_data, index_data, index_size, inner_size);
+        result_data,
+        self_data,
+        index_data,
+        index_size,
+        inner_size,
+        dim_stride,
+        streaming);
   } else {
     index_select_non_firstdim_impl<scalar_t, index_t>(
         result_data,
         self_data,
         index_data,
         outer_size,
-        dim_size,
         index_size,
-        inner_size);
+        inner_size,
+        outer_stride,
+        dim_stride,
+        streaming);
   }
 }
 
@@ -262,8 +305,10 @@ void index_select_contig_kernel(
     const at::Tensor& self,
     int64_t dim,
     const at::Tensor& index) {
-  AT_DISPATCH_FLOATING_TYPES_AND(
+  AT_DISPATCH_ALL_TYPES_AND3(
+      at::ScalarType::Half,
       at::ScalarType::BFloat16,
+      at::ScalarType::Bool,
       result.scalar_type(),
       "index_select_contig",
       [&result, &self, &dim, &index] {
@@ -2,6 +2,7 @@
 #include <aten/InstanceNorm.h>
 
 #include <torch/csrc/autograd/function.h>
+#include "WelfordKrnl.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -190,40 +191,36 @@ std::vector<at::Tensor> instancenorm_forward_channels_first(
 #endif
 
 #if defined(CPU_CAPABILITY_AVX512)
+// The partials of dw and db of the block [len] of a row
 template <typename T>
-void channels_first_backward(
+void channels_first_dwdb(
     T* dout,
     T* in,
-    float& weight,
     float& m,
     float& v,
-    T* dx,
     float& dw,
     float& db,
-    int64_t channel,
-    int64_t rl) {
+    int64_t len) {
   int64_t d;
   auto dgamma_sum = _mm512_setzero_ps();
   auto dbias_sum = _mm512_setzero_ps();
 
   auto* pin = in;
   auto* pdout = dout;
-  auto* pdx = dx;
 
-  auto vweight = _mm512_set1_ps(weight);
   auto vmean = _mm512_set1_ps(m);
   auto vvar = _mm512_set1_ps(v);
   auto veps = _mm512_set1_ps(1e-5);
   auto r_var = 1. / _mm512_sqrt_ps(vvar + veps);
 
-  for (d = 0; d < rl / 16 * 16; d += 16) {
+  for (d = 0; d < len / 16 * 16; d += 16) {
     auto fin = _mm512_loadu_data_ps<T>(&pin[d]);
     auto fdout = _mm512_loadu_data_ps<T>(&pdout[d]);
     dbias_sum += fdout;
     dgamma_sum += fdout * (fin - vmean);
   }
-  if (d < rl) {
-    auto rem = rl - d;
+  if (d < len) {
+    auto rem = len - d;
     __mmask16 k = (1 << rem) - 1;
     auto fin = _mm512_mask_loadu_data_ps<T>(k, &pin[d]);
     auto fdout = _mm512_mask_loadu_data_ps<T>(k, &pdout[d]);
@@ -237,19 +234,44 @@ void channels_first_backward(
 
   dw = gamma_sum[0];
   db = bias_sum[0];
+}
+
+// dx of the block [len] of a row of rl elements, of the dw and db of the row
+template <typename T>
+void channels_first_dx(
+    T* dout,
+    T* in,
+    float& weight,
+    float& m,
+    float& v,
+    T* dx,
+    float& dw,
+    float& db,
+    int64_t len,
+    int64_t rl) {
+  int64_t d;
+  auto* pin = in;
+  auto* pdout = dout;
+  auto* pdx = dx;
+
+  auto vweight = _mm512_set1_ps(weight);
+  auto vmean = _mm512_set1_ps(m);
+  auto vvar = _mm512_set1_ps(v);
+  auto veps = _mm512_set1_ps(1e-5);
+  auto r_var = 1. / _mm512_sqrt_ps(vvar + veps);
 
   auto cdb = _mm512_set1_ps(db / rl);
   auto cdw = _mm512_set1_ps(dw / rl) * r_var;
 
-  for (d = 0; d < rl / 16 * 16; d += 16) {
+  for (d = 0; d < len / 16 * 16; d += 16) {
     auto f = _mm512_loadu_data_ps<T>(&pin[d]);
     auto fo = _mm512_loadu_data_ps<T>(&pdout[d]);
     fo -= cdb + (f - vmean) * cdw;
     fo *= vweight * r_var;
     _mm512_storeu_data_ps<T>(&pdx[d], fo);
   }
-  if (d < rl) {
-    auto rem = rl - d;
+  if (d < len) {
+    auto rem = len - d;
     __mmask16 k = (1 << rem) - 1;
     auto f = _mm512_mask_loadu_data_ps<T>(k, &pin[d]);
     auto fo = _mm512_mask_loadu_data_ps<T>(k, &pdout[d]);
@@ -275,12 +297,17 @@ std::vector<at::Tensor> instancenorm_backward_channels_first(
     reduce_l = in_sz[2] * in_sz[3] * in_sz[4];
   auto batch = in_sz[0] * in_sz[1];
 
+  // At the small batch sizes the rows are also split into spatial blocks,
+  // whose dw and db partials are summed before dx
+  auto block_len = spatial_block_size(batch, reduce_l);
+  auto block_num = at::divup(reduce_l, block_len);
+
   auto grad_weight = at::empty(
-      batch,
+      {batch, block_num},
       at::TensorOptions().dtype<float>().memory_format(
           c10::MemoryFormat::Contiguous));
   auto grad_bias = at::empty(
-      batch,
+      {batch, block_num},
       at::TensorOptions().dtype<float>().memory_format(
           c10::MemoryFormat::Contiguous));
   auto grad_input = at::empty(
@@ -298,82 +325,62 @@ std::vector<at::Tensor> instancenorm_backward_channels_first(
   auto* db_ptr = grad_bias.data_ptr();
 
 #pragma omp parallel for
-  for (auto i = 0; i < batch; ++i) {
+  for (auto i = 0; i < batch * block_num; ++i) {
     auto* dout = reinterpret_cast<T(*)[reduce_l]>(dout_ptr);
     auto* bin = reinterpret_cast<T(*)[reduce_l]>(in_ptr);
-    auto* w = reinterpret_cast<float(*)>(w_ptr);
     auto* m = reinterpret_cast<float(*)>(m_ptr);
     auto* v = reinterpret_cast<float(*)>(v_ptr);
-    auto* dx = reinterpret_cast<T(*)[reduce_l]>(dx_ptr);
     auto* dw = reinterpret_cast<float(*)>(dw_ptr);
     auto* db = reinterpret_cast<float(*)>(db_ptr);
-    channels_first_backward<T>(
-        dout[i],
-        bin[i],
-        w[i % channel],
-        m[i],
-        v[i],
-        dx[i],
+    auto row = i / block_num;
+    auto offset = (i % block_num) * block_len;
+    channels_first_dwdb<T>(
+        dout[row] + offset,
+        bin[row] + offset,
+        m[row],
+        v[row],
         dw[i],
         db[i],
-        channel,
+        std::min(block_len, reduce_l - offset));
+  }
+
+  // the block partials are summed pairwise per row
+  sum_merge_partials(grad_weight.data_ptr<float>(), batch, block_num, 1);
+  sum_merge_partials(grad_bias.data_ptr<float>(), batch, block_num, 1);
+
+#pragma omp parallel for
+  for (auto i = 0; i < batch * block_num; ++i) {
+    auto* dout = reinterpret_cast<T(*)[reduce_l]>(dout_ptr);
+    auto* bin = reinterpret_cast<T(*)[reduce_l]>(in_ptr);
+    auto* w = reinterpret_cast<float(*)>(w_ptr);
+    auto* m = reinterpret_cast<float(*)>(m_ptr);
+    auto* v = reinterpret_cast<float(*)>(v_ptr);
+    auto* dx = reinterpret_cast<T(*)[reduce_l]>(dx_ptr);
+    auto* dw = reinterpret_cast<float(*)>(dw_ptr);
+    auto* db = reinterpret_cast<float(*)>(db_ptr);
+    auto row = i / block_num;
+    auto offset = (i % block_num) * block_len;
+    channels_first_dx<T>(
+        dout[row] + offset,
+        bin[row] + offset,
+        w[row % channel],
+        m[row],
+        v[row],
+        dx[row] + offset,
+        dw[row * block_num],
+        db[row * block_num],
+        std::min(block_len, reduce_l - offset),
         reduce_l);
   }
 
-  grad_weight = grad_weight.reshape({in_sz[0], in_sz[1]});
-  grad_bias = grad_bias.reshape({in_sz[0], in_sz[1]});
+  grad_weight = grad_weight.select(1, 0).reshape({in_sz[0], in_sz[1]});
+  grad_bias = grad_bias.select(1, 0).reshape({in_sz[0], in_sz[1]});
   grad_weight = at::sum(grad_weight, 0);
   grad_bias = at::sum(grad_bias, 0);
   return {grad_input, grad_weight, grad_bias};
 }
 #endif
 
-#if defined(CPU_CAPABILITY_AVX512)
-template <typename T>
-void channels_last_mean_var(T* in, float* m, float* v, int64_t c, int64_t bl) {
-  auto vnum = c / 16;
-  auto vrem = c % 16;
-  auto vnum_total = vnum;
-  if (vrem > 0)
-    vnum_total += 1;
-
-  __m512 sm[vnum_total];
-  __m512 smm[vnum_total];
-  for (int i = 0; i < vnum_total; ++i) {
-    sm[i] = _mm512_setzero_ps();
-    smm[i] = _mm512_setzero_ps();
-  }
-
-  auto* pin = in;
-  auto rbl = _mm512_set1_ps(1.0 / bl);
-  for (auto i = 0; i < bl; ++i) {
-    int64_t j;
-    for (j = 0; j < vnum; ++j) {
-      auto f = _mm512_loadu_data_ps<T>(&pin[(i * c + j * 16)]);
-      sm[j] += f;
-      smm[j] += f * f;
-    }
-    if (vrem > 0) {
-      __mmask16 k = (1 << vrem) - 1;
-      auto f = _mm512_mask_loadu_data_ps<T>(k, &pin[(i * c + j * 16)]);
-      sm[j] += f;
-      smm[j] += f * f;
-    }
-  }
-
-  int64_t i;
-  for (i = 0; i < vnum; ++i) {
-    _mm512_storeu_data_ps<float>(&m[i * 16], sm[i] * rbl);
-    _mm512_storeu_data_ps<float>(&v[i * 16], smm[i] * rbl);
-  }
-  if (vrem > 0) {
-    __mmask16 k = (1 << vrem) - 1;
-    _mm512_mask_storeu_data_ps<float>(&m[i * 16], k, sm[i] * rbl);
-    _mm512_mask_storeu_data_ps<float>(&v[i * 16], k, smm[i] * rbl);
-  }
-}
-#endif
-
 #if defined(CPU_CAPABILITY_AVX512)
 template <typename T>
 void channels_last_norm(
@@ -461,12 +468,9 @@ std::vector<at::Tensor> instancenorm_forward_channels_last(
     reduce_l = in_sz[2] * in_sz[3] * in_sz[4];
   auto block_num = reduce_l / block_len;
 
-  auto mean_t = at::empty(
-      {batch, block_num, channel},
-      at::TensorOptions().dtype<float>().memory_format(
-          c10::MemoryFormat::Contiguous));
-  auto var_t = at::empty(
-      {batch, block_num, channel},
+  // Welford moments of each block, merged per sample
+  auto partials = at::empty(
+      {batch, block_num, 2, channel},
       at::TensorOptions().dtype<float>().memory_format(
           c10::MemoryFormat::Contiguous));
   auto output = at::empty(
@@ -476,20 +480,25 @@ std::vector<at::Tensor> instancenorm_forward_channels_last(
   auto* out_ptr = output.data_ptr();
   auto* w_ptr = weight.data_ptr();
   auto* b_ptr = bias.data_ptr();
-  auto* m_ptr = mean_t.data_ptr();
-  auto* v_ptr = var_t.data_ptr();
-
-#pragma omp parallel for
-  for (auto i = 0; i < batch * block_num; ++i) {
-    auto* bin = reinterpret_cast<T(*)[block_len * channel]>(in_ptr);
-    auto* m = reinterpret_cast<float(*)[channel]>(m_ptr);
-    auto* v = reinterpret_cast<float(*)[channel]>(v_ptr);
-    channels_last_mean_var<T>(bin[i], m[i], v[i], channel, block_len);
-  }
+  auto* p_ptr = partials.data_ptr<float>();
+
+  at::parallel_for(0, batch * block_num, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      float* mean = p_ptr + i * 2 * channel;
+      welford_channels_last<T>(
+          static_cast<T*>(in_ptr) + i * block_len * channel,
+          block_len,
+          channel,
+          mean,
+          mean + channel);
+    }
+  });
+  std::vector<int64_t> counts(batch * block_num, block_len);
+  welford_merge_partials(p_ptr, counts, batch, block_num, channel);
 
-  auto mt = at::mean(mean_t, 1).reshape(batch * channel);
-  auto mt2 = at::mean(var_t, 1).reshape(batch * channel);
-  auto vt = mt2 - mt * mt;
+  auto merged = partials.select(1, 0);
+  auto mt = merged.select(1, 0).contiguous().reshape(batch * channel);
+  auto vt = (merged.select(1, 1) / reduce_l).reshape(batch * channel);
   auto* mt_ptr = mt.data_ptr();
   auto* vt_ptr = vt.data_ptr();
 
@@ -730,8 +739,11 @@ std::vector<at::Tensor> instancenorm_backward_channels_last(
         block_len);
   }
 
-  auto grad_w = at::sum(grad_weight, 1);
-  auto grad_b = at::sum(grad_bias, 1);
+  // the block partials are summed pairwise per sample
+  sum_merge_partials(grad_weight.data_ptr<float>(), batch, block_num, channel);
+  sum_merge_partials(grad_bias.data_ptr<float>(), batch, block_num, channel);
+  auto grad_w = grad_weight.select(1, 0).contiguous();
+  auto grad_b = grad_bias.select(1, 0).contiguous();
   dw_ptr = grad_w.data_ptr();
   db_ptr = grad_b.data_ptr();
 
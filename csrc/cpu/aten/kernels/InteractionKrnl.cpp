@@ -1,5 +1,6 @@
 // Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
 #include "aten/Interaction.h"
+#include "aten/utils/amx_tile.h"
 #include "autocast/autocast_mode.h"
 #include "cpu/kernels/Interaction.h"
 #include "ideep/IDeepConversions.h"
@@ -36,6 +37,26 @@ static inline void cat(
   }
 }
 
+// cat of the inputs, those with a bf16 pointer instead are converted on load
+template <typename T>
+static inline void cat(
+    T* out,
+    const std::vector<T*>& in_ptr,
+    const std::vector<at::BFloat16*>& bf16_in_ptr,
+    int feature_size,
+    int out_stride) {
+  size_t offset = 0;
+  auto feature_nums = in_ptr.size();
+  for (int j = 0; j < feature_nums; j++) {
+    if (bf16_in_ptr[j] != nullptr) {
+      at::vec::convert(bf16_in_ptr[j], &out[offset], feature_size);
+    } else {
+      move_ker(&out[offset], in_ptr[j], feature_size);
+    }
+    offset += out_stride;
+  }
+}
+
 template <typename Tout, typename Tin>
 static inline void cat_backward(
     const Tin* in,
@@ -104,21 +125,31 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
   int64_t batch_size = input[0].sizes()[0];
   uint32_t feature_size = input[0].sizes()[1];
   uint32_t feature_nums = input.size();
-  std::vector<T*> input_data(feature_nums);
+  std::vector<T*> input_data(feature_nums, nullptr);
+  // the bf16 inputs of the fp32 interaction, converted on load instead of
+  // cast by autocast
+  std::vector<at::BFloat16*> bf16_input_data(feature_nums, nullptr);
   for (int i = 0; i < feature_nums; i++) {
     TORCH_INTERNAL_ASSERT_DEBUG_ONLY(input[i].is_contiguous());
     TORCH_INTERNAL_ASSERT_DEBUG_ONLY(input[i].dim() == 2);
     TORCH_CHECK(
         input[i].sizes()[1] == feature_size,
         "expect all inputs have same feature size");
-    input_data[i] = input[i].data_ptr<T>();
+    if (std::is_same<T, float>::value &&
+        input[i].scalar_type() == at::kBFloat16) {
+      bf16_input_data[i] = input[i].data_ptr<at::BFloat16>();
+    } else {
+      input_data[i] = input[i].data_ptr<T>();
+    }
   }
   auto interact_feature_size = feature_nums * (feature_nums - 1) / 2;
   auto out_data_line_len = interact_feature_size + feature_size;
-  auto out = at::empty({batch_size, out_data_line_len}, input[0].options());
+  auto out = at::empty(
+      {batch_size, out_data_line_len},
+      input[0].options().dtype(c10::CppTypeToScalarType<T>()));
   auto out_data = out.data_ptr<T>();
 
-  auto mkldnn_dtype = cpu::get_mkldnn_dtype(input[0].scalar_type());
+  auto mkldnn_dtype = cpu::get_mkldnn_dtype(out.scalar_type());
   std::vector<int64_t> lhs_shape({feature_nums, feature_size});
   std::vector<int64_t> lhs_stride({feature_size, 1});
   std::vector<int64_t> rhs_shape({feature_size, feature_nums});
@@ -134,6 +165,9 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
 
   auto op_attr = dnnl::primitive_attr();
   op_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+  // the fp32 matmuls run in bf16 in the BF32 fpmath mode
+  op_attr.set_fpmath_mode(
+      static_cast<dnnl::fpmath_mode>(torch_ipex::fpmath_mode));
 
   auto pd = ideep::matmul_forward::primitive_desc(
       ideep::engine::cpu_engine(), lhs_desc, rhs_desc, res_desc, op_attr);
@@ -141,9 +175,14 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
   at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
     T cat_buf[feature_nums * feature_size] __attribute__((aligned(64)));
     T mm_buf[feature_nums * feature_nums] __attribute__((aligned(64)));
-    std::vector<T*> input_ptr(feature_nums);
+    std::vector<T*> input_ptr(feature_nums, nullptr);
+    std::vector<at::BFloat16*> bf16_input_ptr(feature_nums, nullptr);
     for (uint32_t n = 0; n < feature_nums; n++) {
-      input_ptr[n] = &input_data[n][start * feature_size];
+      if (bf16_input_data[n] != nullptr) {
+        bf16_input_ptr[n] = &bf16_input_data[n][start * feature_size];
+      } else {
+        input_ptr[n] = &input_data[n][start * feature_size];
+      }
     }
     ideep::tensor lhs({lhs_desc, cat_buf});
     ideep::tensor rhs({lhs_desc, cat_buf});
@@ -151,8 +190,9 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
     ideep::tensor scratchpad(pd.scratchpad_desc());
     auto p = dnnl::matmul(pd);
     for (int64_t i = start; i < end; i++) {
-      move_ker(&out_data[i * out_data_line_len], input_ptr[0], feature_size);
-      cat<T>(cat_buf, input_ptr, feature_size, feature_size);
+      // the first input is also the first part of the output row
+      cat(cat_buf, input_ptr, bf16_input_ptr, feature_size, feature_size);
+      move_ker(&out_data[i * out_data_line_len], cat_buf, feature_size);
       p.execute(
           ideep::stream::default_stream(),
           {{DNNL_ARG_SRC, lhs},
@@ -162,7 +202,11 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
       T* flat_buf = (T*)(&out_data[i * out_data_line_len] + feature_size);
       flat_triangle<T>(mm_buf, flat_buf, feature_nums);
       for (uint32_t n = 0; n < feature_nums; n++) {
-        input_ptr[n] += feature_size;
+        if (bf16_input_ptr[n] != nullptr) {
+          bf16_input_ptr[n] += feature_size;
+        } else {
+          input_ptr[n] += feature_size;
+        }
       }
     }
   });
@@ -208,6 +252,9 @@ inline std::vector<at::Tensor> _interaction_backward(
 
   auto op_attr = dnnl::primitive_attr();
   op_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+  // the fp32 matmuls run in bf16 in the BF32 fpmath mode
+  op_attr.set_fpmath_mode(
+      static_cast<dnnl::fpmath_mode>(torch_ipex::fpmath_mode));
 
   auto pd = ideep::matmul_forward::primitive_desc(
       ideep::engine::cpu_engine(), lhs_desc, rhs_desc, res_desc, op_attr);
@@ -275,28 +322,20 @@ inline std::vector<at::Tensor> _interaction_backward(
 }
 
 #if defined(CPU_CAPABILITY_AMX)
-typedef struct tileconfig_t {
-  uint8_t palette_id;
-  uint8_t startRow;
-  uint8_t reserved[14];
-  uint16_t colb[16];
-  uint8_t rows[16];
-} tileconfig_t;
-
 const uint8_t TILE_M = 16;
 const uint8_t TILE_N = 16;
 const uint8_t TILE_IK = 64;
 const uint8_t TILE_BK = 32;
 
-static tileconfig_t tc = {0};
 template <typename res_type, typename src_type>
-inline void set_tile_config(
+inline AMXTileConfig get_tile_config(
     const uint8_t TILE_M,
     const uint8_t TILE_N,
     const uint8_t TILE_K,
     const uint8_t KPACK) {
+  AMXTileConfig tc = {0};
   tc.palette_id = 1;
-  // tc.startRow = 0;
+  // tc.start_row = 0;
   // Configure C tiles
   for (int t = 0; t < 4; ++t) {
     tc.rows[t] = (uint8_t)TILE_M;
@@ -312,6 +351,7 @@ inline void set_tile_config(
     tc.rows[t] = (uint8_t)(TILE_K / KPACK);
     tc.colb[t] = (uint16_t)(TILE_N * KPACK * sizeof(src_type));
   }
+  return tc;
 }
 
 template <>
@@ -337,7 +377,8 @@ inline at::Tensor _interaction_forward<at::BFloat16>(
   auto out = at::empty({batch_size, out_data_line_len}, input[0].options());
   auto out_data = out.data_ptr<at::BFloat16>();
 
-  set_tile_config<float, at::BFloat16>(TILE_M, TILE_N, TILE_BK, 2);
+  const AMXTileConfig tc =
+      get_tile_config<float, at::BFloat16>(TILE_M, TILE_N, TILE_BK, 2);
 
   int32_t _AM = ((feature_nums + 31) >> 5) << 5;
   int32_t _AK = ((feature_size + 63) >> 6) << 6; // align to 64
@@ -352,7 +393,7 @@ inline at::Tensor _interaction_forward<at::BFloat16>(
     zero_ker(&Amem[0][0], _AM * _AK);
     at::BFloat16 Bmem[_AK >> 1][_AM][2] __attribute__((aligned(64)));
 
-    _tile_loadconfig((const void*)&tc);
+    amx_tile_configure(tc);
 
     std::vector<at::BFloat16*> input_ptr(feature_nums);
     for (uint32_t n = 0; n < feature_nums; n++) {
@@ -434,6 +475,7 @@ inline at::Tensor _interaction_forward<at::BFloat16>(
         offset += i;
       }
     }
+    amx_tile_release();
   });
   return out;
 }
@@ -467,6 +509,8 @@ inline std::vector<at::Tensor> _interaction_backward<at::BFloat16>(
   int32_t A_Stride = _AK * sizeof(at::BFloat16);
   int32_t B_Stride = _AN * sizeof(at::BFloat16) * 2;
   int32_t C_Stride = _AN * sizeof(float);
+  const AMXTileConfig tc =
+      get_tile_config<float, at::BFloat16>(TILE_M, TILE_N, TILE_BK, 2);
   at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
     const int32_t vector_len = feature_size * sizeof(at::BFloat16);
     auto mm_elems = feature_nums * feature_nums;
@@ -479,7 +523,7 @@ inline std::vector<at::Tensor> _interaction_backward<at::BFloat16>(
     at::BFloat16 Bmem[_AK / 2][_AN][2] __attribute__((aligned(64)));
     float Cmem[_AM][_AN] __attribute__((aligned(64)));
 
-    _tile_loadconfig((const void*)&tc);
+    amx_tile_configure(tc);
 
     std::vector<at::BFloat16*> input_ptr(feature_nums);
     std::vector<at::BFloat16*> output_ptr(feature_nums);
@@ -591,6 +635,7 @@ inline std::vector<at::Tensor> _interaction_backward<at::BFloat16>(
         output_ptr[n] += feature_size;
       }
     }
+    amx_tile_release();
   });
   return output;
 }
@@ -598,16 +643,17 @@ inline std::vector<at::Tensor> _interaction_backward<at::BFloat16>(
 
 at::Tensor interaction_forward_kernel_impl(
     const std::vector<at::Tensor>& input) {
-  if (input[0].scalar_type() == at::kFloat) {
-    for (auto& in : input) {
-      TORCH_INTERNAL_ASSERT_DEBUG_ONLY(in.scalar_type() == at::kFloat);
-    }
+  // fp32 and bf16 inputs are mixed in fp32, as at::cat would promote them
+  bool all_bf16 = true;
+  for (const auto& in : input) {
+    TORCH_CHECK(
+        in.scalar_type() == at::kFloat || in.scalar_type() == at::kBFloat16,
+        "interaction_forward only supports float and bfloat16 inputs");
+    all_bf16 = all_bf16 && in.scalar_type() == at::kBFloat16;
+  }
+  if (!all_bf16) {
     return _interaction_forward<float>(input);
   } else {
-    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(input[0].scalar_type() == at::kBFloat16);
-    for (const auto& in : input) {
-      TORCH_INTERNAL_ASSERT_DEBUG_ONLY(in.scalar_type() == at::kBFloat16);
-    }
     return _interaction_forward<at::BFloat16>(input);
   }
 }
@@ -657,9 +703,9 @@ void interaction_int8_128_27_amx(
   const size_t ROW = _K + flat_nums; // 128 + 27 * 26/2
   TORCH_INTERNAL_ASSERT(input_data.size() == _S1);
   TORCH_INTERNAL_ASSERT(output.size(1) == ROW);
-  tileconfig_t tc = {0};
+  AMXTileConfig tc = {0};
   tc.palette_id = 1;
-  // tc.startRow = 0;
+  // tc.start_row = 0;
   //  Configure C tiles
   for (int t = 0; t < 4; ++t) {
     tc.rows[t] = (uint8_t)TILE_M;
@@ -684,7 +730,7 @@ void interaction_int8_128_27_amx(
     int32_t flat_buf[351] __attribute__((aligned(64)));
     int8_t Amem[_M][_K] __attribute__((aligned(64)));
     int8_t Bmem[_K / 4][_M][4] __attribute__((aligned(64)));
-    _tile_loadconfig((const void*)&tc);
+    amx_tile_configure(tc);
     int8_t* local_input_data[_S1];
     int64_t bs_offset = start << LOG2_K;
     for (int i = 0; i < _S1; i++) {
@@ -786,6 +832,7 @@ void interaction_int8_128_27_amx(
       }
       output0_ptr += ROW;
     }
+    amx_tile_release();
   });
   return;
 }
@@ -0,0 +1,251 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/LinearDynamicQuant.h>
+#include <algorithm>
+#include <cmath>
+#include "vec/vec.h"
+
+/*
+ Dynamic quantized linear (see LinearDynamicQuant.h), in two parallel passes
+ instead of the min/max, quantize, int8 GEMM and dequantize ops of
+ torch.ops.quantized.linear_dynamic:
+   - prologue: each row of the activation is read once, its min/max taken and
+     quantized to uint8 with its own scale and zero point (per token).
+   - GEMM: blocks of up to dq_m_block rows and dq_block_n output channels are
+     accumulated in int32 with u8 x s8 dot products of 4 bytes (VNNI on
+     AVX512_VNNI and above), and the epilogue dequantizes, adds the bias and
+     stores in the dtype of the input.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+const int64_t dq_m_block = 4;
+
+// Quantize a row of K elements to uint8, asymmetric, the K padding of the
+// packed weight being zeroed
+template <typename T>
+inline void quantize_row(
+    const T* x,
+    int64_t K,
+    int64_t Kp,
+    float* buf,
+    uint8_t* xq,
+    float& scale,
+    int32_t& zero_point) {
+  using Vec = at::vec::Vectorized<float>;
+  const float* xf = buf;
+  if (std::is_same<T, float>::value) {
+    xf = reinterpret_cast<const float*>(x);
+  } else {
+    at::vec::convert(x, buf, K);
+  }
+  float min = at::vec::reduce_all<float>(
+      [](Vec& a, Vec& b) { return at::vec::minimum(a, b); }, xf, K);
+  float max = at::vec::reduce_all<float>(
+      [](Vec& a, Vec& b) { return at::vec::maximum(a, b); }, xf, K);
+  // keep 0 representable
+  min = std::min(min, 0.f);
+  max = std::max(max, 0.f);
+  scale = (max - min) / 255.f;
+  if (scale == 0.f) {
+    scale = 1.f;
+  }
+  zero_point = std::min(
+      std::max(static_cast<int32_t>(std::nearbyint(-min / scale)), 0), 255);
+  const float inv_scale = 1.f / scale;
+  const float zp = zero_point;
+#pragma omp simd
+  for (int64_t k = 0; k < K; k++) {
+    float q = std::nearbyint(xf[k] * inv_scale) + zp;
+    xq[k] = static_cast<uint8_t>(std::min(std::max(q, 0.f), 255.f));
+  }
+  for (int64_t k = K; k < Kp; k++) {
+    xq[k] = 0;
+  }
+}
+
+// out[MB, dq_block_n] = dequant(xq[MB, Kp] * w[Kp, dq_block_n]) + bias
+template <int64_t MB, typename T>
+inline void dq_gemm_block(
+    const uint8_t* xq,
+    int64_t ldx,
+    const float* x_scales,
+    const int32_t* x_zero_points,
+    const int8_t* w,
+    const int32_t* comp,
+    const float* w_scales,
+    const float* bias,
+    int64_t Kp,
+    T* out,
+    int64_t ldo,
+    int64_t n_valid) {
+#if defined(CPU_CAPABILITY_AVX512_VNNI)
+  __m512i acc[MB];
+  for (int64_t m = 0; m < MB; m++) {
+    acc[m] = _mm512_setzero_si512();
+  }
+  for (int64_t k = 0; k < Kp; k += dq_block_k) {
+    auto vw = _mm512_loadu_si512(w + k * dq_block_n);
+    for (int64_t m = 0; m < MB; m++) {
+      auto vx = _mm512_set1_epi32(
+          *reinterpret_cast<const int32_t*>(xq + m * ldx + k));
+      acc[m] = _mm512_dpbusd_epi32(acc[m], vx, vw);
+    }
+  }
+  __mmask16 mask = (1 << n_valid) - 1;
+  auto vcomp = _mm512_loadu_si512(comp);
+  auto vw_scale = _mm512_loadu_ps(w_scales);
+  auto vbias = bias ? _mm512_maskz_loadu_ps(mask, bias) : _mm512_setzero_ps();
+  for (int64_t m = 0; m < MB; m++) {
+    auto vacc = _mm512_sub_epi32(
+        acc[m], _mm512_mullo_epi32(_mm512_set1_epi32(x_zero_points[m]), vcomp));
+    auto vscale = _mm512_mul_ps(_mm512_set1_ps(x_scales[m]), vw_scale);
+    auto vres = _mm512_fmadd_ps(_mm512_cvtepi32_ps(vacc), vscale, vbias);
+    kernel::_mask_storeu(out + m * ldo, vres, mask);
+  }
+#else
+  int32_t acc[MB][dq_block_n] = {};
+  for (int64_t k = 0; k < Kp; k += dq_block_k) {
+    const int8_t* wk = w + k * dq_block_n;
+    for (int64_t m = 0; m < MB; m++) {
+      const uint8_t* xk = xq + m * ldx + k;
+#pragma omp simd
+      for (int64_t j = 0; j < dq_block_n; j++) {
+        for (int64_t kk = 0; kk < dq_block_k; kk++) {
+          acc[m][j] += static_cast<int32_t>(xk[kk]) * wk[j * dq_block_k + kk];
+        }
+      }
+    }
+  }
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t j = 0; j < n_valid; j++) {
+      float res = (acc[m][j] - x_zero_points[m] * comp[j]) * x_scales[m] *
+          w_scales[j];
+      out[m * ldo + j] = static_cast<T>(bias ? res + bias[j] : res);
+    }
+  }
+#endif
+}
+
+template <typename T>
+void dynamic_quant_linear(
+    const T* x,
+    const int8_t* w,
+    const int32_t* comp,
+    const float* w_scales,
+    const float* bias,
+    int64_t M,
+    int64_t N,
+    int64_t K,
+    int64_t Kp,
+    T* out) {
+  // prologue: the per token quantized activation, 1/4 of the fp32 size
+  std::vector<uint8_t> xq(M * Kp);
+  std::vector<float> x_scales(M);
+  std::vector<int32_t> x_zero_points(M);
+  at::parallel_for(0, M, 0, [&](int64_t begin, int64_t end) {
+    std::vector<float> buf(std::is_same<T, float>::value ? 0 : K);
+    for (int64_t m = begin; m < end; m++) {
+      quantize_row(
+          x + m * K,
+          K,
+          Kp,
+          buf.data(),
+          xq.data() + m * Kp,
+          x_scales[m],
+          x_zero_points[m]);
+    }
+  });
+
+  using dq_gemm_block_fn = decltype(&dq_gemm_block<1, T>);
+  const dq_gemm_block_fn block_fns[dq_m_block] = {
+      dq_gemm_block<1, T>,
+      dq_gemm_block<2, T>,
+      dq_gemm_block<3, T>,
+      dq_gemm_block<4, T>};
+  const int64_t w_block = Kp * dq_block_n;
+  const int64_t n_blocks = (N + dq_block_n - 1) / dq_block_n;
+  const int64_t m_blocks = (M + dq_m_block - 1) / dq_m_block;
+  at::parallel_for(
+      0, n_blocks * m_blocks, 0, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          // neighbouring tasks share the block of weight
+          int64_t nb = i / m_blocks;
+          int64_t m0 = (i % m_blocks) * dq_m_block;
+          int64_t mb = std::min(dq_m_block, M - m0);
+          int64_t n0 = nb * dq_block_n;
+          block_fns[mb - 1](
+              xq.data() + m0 * Kp,
+              Kp,
+              x_scales.data() + m0,
+              x_zero_points.data() + m0,
+              w + nb * w_block,
+              comp + n0,
+              w_scales + n0,
+              bias ? bias + n0 : nullptr,
+              Kp,
+              out + m0 * N + n0,
+              N,
+              std::min(dq_block_n, N - n0));
+        }
+      });
+}
+
+void dynamic_quant_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& compensation,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat ||
+          input.scalar_type() == at::kBFloat16,
+      "ipex_dynamic_quant_linear only supports float and bfloat16 input");
+  int64_t K = input.size(-1);
+  int64_t M = input.numel() / K;
+  int64_t N = output.size(-1);
+  int64_t Kp = packed_weight.size(1) * dq_block_k;
+  if (M == 0) {
+    return;
+  }
+  const float* bias_data = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  if (input.scalar_type() == at::kFloat) {
+    dynamic_quant_linear<float>(
+        input.data_ptr<float>(),
+        packed_weight.data_ptr<int8_t>(),
+        compensation.data_ptr<int32_t>(),
+        scales.data_ptr<float>(),
+        bias_data,
+        M,
+        N,
+        K,
+        Kp,
+        output.data_ptr<float>());
+  } else {
+    dynamic_quant_linear<at::BFloat16>(
+        input.data_ptr<at::BFloat16>(),
+        packed_weight.data_ptr<int8_t>(),
+        compensation.data_ptr<int32_t>(),
+        scales.data_ptr<float>(),
+        bias_data,
+        M,
+        N,
+        K,
+        Kp,
+        output.data_ptr<at::BFloat16>());
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    dynamic_quant_linear_kernel_stub,
+    &dynamic_quant_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,274 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/LinearEpilogue.h>
+
+#include <cmath>
+#include "vec/vec.h"
+
+/*
+ The epilogue reads each element of the linear output once and writes the
+ output once: act, dropout and the residual add are applied in registers. The
+ dropout keeps an element with a counter based hash of the seed and its index,
+ so the rows are drawn in parallel and the same seed gives the same mask
+ whatever the number of threads. Bit n % 8 of byte n / 8 of a mask row is set
+ for the kept elements, the only dropout state saved for backward.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+// bits of the hash compared with the dropout probability
+const int64_t linear_epilogue_rand_bits = 24;
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+inline uint64_t splitmix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// 1 / sqrt(2), 1 / sqrt(2 * pi) and sqrt(2 / pi)
+const float kAlpha = M_SQRT1_2;
+const float kBeta = M_2_SQRTPI * M_SQRT1_2 * 0.5;
+const float kTanhScale = M_2_SQRTPI * M_SQRT1_2;
+const float kKappa = 0.044715;
+
+inline fVec apply_act(const fVec& x, int64_t activation) {
+  if (activation == GeLU) {
+    return x * fVec(0.5f) * (fVec(1.f) + kernel::vec_erf(x * fVec(kAlpha)));
+  } else if (activation == GeLUTanh) {
+    auto inner = fVec(kTanhScale) * (x + fVec(kKappa) * x * x * x);
+    return x * fVec(0.5f) * (fVec(1.f) + kernel::vec_tanh(inner));
+  } else if (activation == SiLU) {
+    return x * kernel::vec_sigmoid(x);
+  }
+  return x;
+}
+
+// d act(x) / dx
+inline fVec act_grad(const fVec& x, int64_t activation) {
+  if (activation == GeLU) {
+    auto cdf = fVec(0.5f) * (fVec(1.f) + kernel::vec_erf(x * fVec(kAlpha)));
+    auto pdf = kernel::vec_exp(x * x * fVec(-0.5f)) * fVec(kBeta);
+    return cdf + x * pdf;
+  } else if (activation == GeLUTanh) {
+    auto x_sq = x * x;
+    auto inner = fVec(kTanhScale) * (x + fVec(kKappa) * x_sq * x);
+    auto t = kernel::vec_tanh(inner);
+    auto d_inner =
+        fVec(kTanhScale) * (fVec(1.f) + fVec(3.f * kKappa) * x_sq);
+    return fVec(0.5f) * (fVec(1.f) + t) +
+        fVec(0.5f) * x * (fVec(1.f) - t * t) * d_inner;
+  } else if (activation == SiLU) {
+    auto s = kernel::vec_sigmoid(x);
+    return s * (fVec(1.f) + x * (fVec(1.f) - s));
+  }
+  return fVec(1.f);
+}
+
+template <typename T>
+void linear_epilogue_kernel(
+    const at::Tensor& pre_act,
+    const at::Tensor& residual,
+    at::Tensor& output,
+    at::Tensor& mask,
+    int64_t activation,
+    float p,
+    uint64_t seed) {
+  int64_t M = pre_act.size(0);
+  int64_t N = pre_act.size(1);
+  int64_t mask_row = (N + 7) / 8;
+  const T* z = pre_act.data_ptr<T>();
+  const T* res = residual.defined() ? residual.data_ptr<T>() : nullptr;
+  T* out = output.data_ptr<T>();
+  uint8_t* bits = mask.defined() ? mask.data_ptr<uint8_t>() : nullptr;
+  // keep if the hash is at least the threshold
+  uint64_t threshold = static_cast<uint64_t>(
+      static_cast<double>(p) * (uint64_t(1) << linear_epilogue_rand_bits));
+  float keep_scale = p < 1 ? 1 / (1 - p) : 0.f;
+
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    float scale[fVec::size()];
+    for (int64_t m = begin; m < end; m++) {
+      for (int64_t n = 0; n < N; n += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), N - n);
+        auto v = apply_act(load_fvec(z + m * N + n, count), activation);
+        if (bits) {
+          // fVec::size() is a multiple of 8, a chunk has whole mask bytes
+          uint8_t* chunk_bits = bits + m * mask_row + n / 8;
+          for (int64_t j = 0; j < count; j += 8) {
+            chunk_bits[j / 8] = 0;
+          }
+          for (int64_t j = 0; j < count; j++) {
+            uint64_t index = m * N + n + j;
+            uint64_t r = splitmix64(seed ^ index);
+            bool keep = (r >> (64 - linear_epilogue_rand_bits)) >= threshold;
+            chunk_bits[j / 8] |= uint8_t(keep) << (j % 8);
+            scale[j] = keep ? keep_scale : 0.f;
+          }
+          v = v * fVec::loadu(scale, count);
+        }
+        if (res) {
+          v = v + load_fvec(res + m * N + n, count);
+        }
+        store_fvec(out + m * N + n, v, count);
+      }
+    }
+  });
+}
+
+template <typename T>
+at::Tensor linear_epilogue_backward_kernel(
+    const at::Tensor& grad_output,
+    const at::Tensor& pre_act,
+    const at::Tensor& mask,
+    int64_t activation,
+    float p) {
+  int64_t M = pre_act.size(0);
+  int64_t N = pre_act.size(1);
+  int64_t mask_row = (N + 7) / 8;
+  auto grad_pre_act = at::empty_like(pre_act);
+  const T* grad = grad_output.data_ptr<T>();
+  const T* z = pre_act.data_ptr<T>();
+  const uint8_t* bits = mask.defined() ? mask.data_ptr<uint8_t>() : nullptr;
+  T* grad_z = grad_pre_act.data_ptr<T>();
+  float keep_scale = p < 1 ? 1 / (1 - p) : 0.f;
+
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    float scale[fVec::size()];
+    for (int64_t m = begin; m < end; m++) {
+      for (int64_t n = 0; n < N; n += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), N - n);
+        auto g = load_fvec(grad + m * N + n, count);
+        if (bits) {
+          const uint8_t* chunk_bits = bits + m * mask_row + n / 8;
+          for (int64_t j = 0; j < count; j++) {
+            scale[j] = (chunk_bits[j / 8] >> (j % 8)) & 1 ? keep_scale : 0.f;
+          }
+          g = g * fVec::loadu(scale, count);
+        }
+        if (activation != NoAct) {
+          g = g * act_grad(load_fvec(z + m * N + n, count), activation);
+        }
+        store_fvec(grad_z + m * N + n, g, count);
+      }
+    }
+  });
+  return grad_pre_act;
+}
+
+void linear_epilogue_kernel_impl(
+    const at::Tensor& pre_act,
+    const at::Tensor& residual,
+    at::Tensor& output,
+    at::Tensor& mask,
+    int64_t activation,
+    float p,
+    uint64_t seed) {
+  if (pre_act.numel() == 0) {
+    return;
+  }
+  if (pre_act.scalar_type() == at::kFloat) {
+    linear_epilogue_kernel<float>(
+        pre_act, residual, output, mask, activation, p, seed);
+  } else {
+    TORCH_CHECK(
+        pre_act.scalar_type() == at::kBFloat16,
+        "ipex_linear_epilogue only supports float and bfloat16");
+    linear_epilogue_kernel<at::BFloat16>(
+        pre_act, residual, output, mask, activation, p, seed);
+  }
+}
+
+at::Tensor linear_epilogue_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& pre_act,
+    const at::Tensor& mask,
+    int64_t activation,
+    float p) {
+  auto grad_output_ = grad_output.to(pre_act.scalar_type());
+  if (pre_act.numel() == 0) {
+    return at::empty_like(pre_act);
+  }
+  if (pre_act.scalar_type() == at::kFloat) {
+    return linear_epilogue_backward_kernel<float>(
+        grad_output_, pre_act, mask, activation, p);
+  }
+  return linear_epilogue_backward_kernel<at::BFloat16>(
+      grad_output_, pre_act, mask, activation, p);
+}
+
+template <typename T>
+void linear_gate_kernel(
+    const at::Tensor& pre_act,
+    at::Tensor& output,
+    int64_t activation) {
+  int64_t M = output.size(0);
+  int64_t N = output.size(1);
+  const T* z = pre_act.data_ptr<T>();
+  T* out = output.data_ptr<T>();
+
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; m++) {
+      const T* gate = z + m * 2 * N;
+      const T* up = gate + N;
+      for (int64_t n = 0; n < N; n += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), N - n);
+        auto v = apply_act(load_fvec(gate + n, count), activation) *
+            load_fvec(up + n, count);
+        store_fvec(out + m * N + n, v, count);
+      }
+    }
+  });
+}
+
+void linear_gate_kernel_impl(
+    const at::Tensor& pre_act,
+    at::Tensor& output,
+    int64_t activation) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (pre_act.scalar_type() == at::kFloat) {
+    linear_gate_kernel<float>(pre_act, output, activation);
+  } else {
+    TORCH_CHECK(
+        pre_act.scalar_type() == at::kBFloat16,
+        "linear_gate_run only supports float and bfloat16");
+    linear_gate_kernel<at::BFloat16>(pre_act, output, activation);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(linear_epilogue_kernel_stub, &linear_epilogue_kernel_impl);
+REGISTER_DISPATCH(
+    linear_epilogue_backward_kernel_stub,
+    &linear_epilogue_backward_kernel_impl);
+REGISTER_DISPATCH(linear_gate_kernel_stub, &linear_gate_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,179 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/Linear.h>
+
+/*
+ GEMM of at most linear_small_m input rows on the plain [N, K] weight. It is
+ memory bound on the weight, so each task streams linear_small_m_block_n
+ weight rows once, computes their dot products with all the M input rows and
+ prefetches the weight a fixed distance ahead, which runs into the next
+ block of the task at the end of a block. Tasks are split over N only, the
+ inputs being small enough to stay in L1.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+const int64_t linear_small_m_block_n = 4;
+// bytes ahead of the current position to prefetch the weight rows
+const int64_t linear_small_m_prefetch_distance = 1024;
+
+// load 2 x fVec::size() elements as float
+inline void load_fvec2(const float* ptr, fVec& a, fVec& b) {
+  a = fVec::loadu(ptr);
+  b = fVec::loadu(ptr + fVec::size());
+}
+
+inline void load_fvec2(const at::BFloat16* ptr, fVec& a, fVec& b) {
+  std::tie(a, b) = at::vec::convert_bfloat16_float(bVec::loadu(ptr));
+}
+
+inline float reduce_add(const fVec& v) {
+  float buf[fVec::size()];
+  v.store(buf);
+  float sum = 0.f;
+  for (int64_t i = 0; i < fVec::size(); i++) {
+    sum += buf[i];
+  }
+  return sum;
+}
+
+// out[M, nb] = x[M, K] * w[nb, K]^T + bias, nb <= linear_small_m_block_n
+template <typename T, int64_t M>
+void linear_small_m_block(
+    const T* x,
+    const T* w,
+    const T* bias,
+    T* out,
+    int64_t nb,
+    int64_t N,
+    int64_t K) {
+  constexpr int64_t NB = linear_small_m_block_n;
+  constexpr int64_t step = 2 * fVec::size();
+  fVec acc[M][NB];
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t n = 0; n < NB; n++) {
+      acc[m][n] = fVec(0.f);
+    }
+  }
+  const char* w_bytes = reinterpret_cast<const char*>(w);
+  int64_t k = 0;
+  for (; k < K - (K % step); k += step) {
+    // the rows of the block are contiguous, prefetching past the last one
+    // brings in the next block of the task
+    for (int64_t n = 0; n < nb; n++) {
+      auto ptr = w_bytes + (n * K + k) * sizeof(T) +
+          linear_small_m_prefetch_distance;
+      for (int64_t offset = 0; offset < step * sizeof(T); offset += 64) {
+        __builtin_prefetch(ptr + offset, 0 /* read */, 3);
+      }
+    }
+    fVec x0[M], x1[M];
+    for (int64_t m = 0; m < M; m++) {
+      load_fvec2(x + m * K + k, x0[m], x1[m]);
+    }
+    for (int64_t n = 0; n < nb; n++) {
+      fVec w0, w1;
+      load_fvec2(w + n * K + k, w0, w1);
+      for (int64_t m = 0; m < M; m++) {
+        acc[m][n] = at::vec::fmadd(x0[m], w0, acc[m][n]);
+        acc[m][n] = at::vec::fmadd(x1[m], w1, acc[m][n]);
+      }
+    }
+  }
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t n = 0; n < nb; n++) {
+      float sum = reduce_add(acc[m][n]);
+      for (int64_t kk = k; kk < K; kk++) {
+        sum += float(x[m * K + kk]) * float(w[n * K + kk]);
+      }
+      if (bias) {
+        sum += float(bias[n]);
+      }
+      out[m * N + n] = T(sum);
+    }
+  }
+}
+
+template <typename T>
+using linear_small_m_block_fn = decltype(&linear_small_m_block<T, 1>);
+
+template <typename T>
+linear_small_m_block_fn<T> get_linear_small_m_block(int64_t M) {
+  static const linear_small_m_block_fn<T> fns[linear_small_m] = {
+      linear_small_m_block<T, 1>,
+      linear_small_m_block<T, 2>,
+      linear_small_m_block<T, 3>,
+      linear_small_m_block<T, 4>,
+      linear_small_m_block<T, 5>,
+      linear_small_m_block<T, 6>,
+      linear_small_m_block<T, 7>,
+      linear_small_m_block<T, 8>};
+  return fns[M - 1];
+}
+
+template <typename T>
+void linear_small_m_kernel(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  int64_t M = input.size(0);
+  int64_t K = input.size(1);
+  int64_t N = weight.size(0);
+  const T* x = input.data_ptr<T>();
+  const T* w = weight.data_ptr<T>();
+  const T* b = bias.defined() ? bias.data_ptr<T>() : nullptr;
+  T* out = output.data_ptr<T>();
+  auto block_fn = get_linear_small_m_block<T>(M);
+  int64_t n_blocks =
+      (N + linear_small_m_block_n - 1) / linear_small_m_block_n;
+  at::parallel_for(0, n_blocks, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t n0 = i * linear_small_m_block_n;
+      int64_t nb = std::min(linear_small_m_block_n, N - n0);
+      block_fn(
+          x,
+          w + n0 * K,
+          b ? b + n0 : nullptr,
+          out + n0,
+          nb,
+          N,
+          K);
+    }
+  });
+}
+
+void linear_small_m_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  TORCH_CHECK(
+      input.dim() == 2 && input.size(0) <= linear_small_m &&
+          input.size(0) > 0,
+      "linear_small_m_kernel expects 2-D input of at most ",
+      linear_small_m,
+      " rows");
+  auto bias_ = bias.defined() ? bias.contiguous() : bias;
+  if (input.scalar_type() == at::kFloat) {
+    linear_small_m_kernel<float>(input, weight, bias_, output);
+  } else {
+    TORCH_CHECK(
+        input.scalar_type() == at::kBFloat16,
+        "linear_small_m_kernel only supports float and bfloat16");
+    linear_small_m_kernel<at::BFloat16>(input, weight, bias_, output);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(linear_small_m_kernel_stub, &linear_small_m_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,285 @@
+#include <ATen/Parallel.h>
+#include <aten/LinearWoq.h>
+#include <algorithm>
+#include "mkl.h"
+#include "vec/vec.h"
+
+/*
+ Weight-only quantized linear. The weight stays in its packed int4/int8
+ layout (see LinearWoq.h) and each block of woq_block_n output channels is
+ dequantized in registers, w = q * scale + zero_bias, right before it is
+ multiplied with the fp32 activation:
+   - small M (decoding): for each k, the 16 weights of a block are
+     dequantized once and FMA-ed into the accumulators of up to
+     woq_small_m_block rows, so no dequantized weight is ever written out.
+   - large M: the weight of woq_large_n_block columns is dequantized to a
+     small fp32 buffer per thread and multiplied with cblas_sgemm, the
+     dequantize cost being amortized over the M rows.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+const int64_t woq_small_m = 16;
+const int64_t woq_small_m_block = 4;
+const int64_t woq_large_n_block = 64;
+
+// Dequantize row k of a block of woq_block_n output channels
+inline void dequant_block_row(
+    const uint8_t* qw,
+    const float* scale,
+    const float* zero_bias,
+    int64_t bits,
+    float* out) {
+  if (bits == 8) {
+#pragma omp simd
+    for (int64_t j = 0; j < woq_block_n; j++) {
+      out[j] = qw[j] * scale[j] + zero_bias[j];
+    }
+    return;
+  }
+  const int64_t half = woq_block_n / 2;
+#pragma omp simd
+  for (int64_t j = 0; j < half; j++) {
+    out[j] = (qw[j] & 0xF) * scale[j] + zero_bias[j];
+    out[j + half] = (qw[j] >> 4) * scale[j + half] + zero_bias[j + half];
+  }
+}
+
+#if defined(CPU_CAPABILITY_AVX512)
+inline __m512 dequant_block_row(
+    const uint8_t* qw,
+    __m512 scale,
+    __m512 zero_bias,
+    int64_t bits) {
+  __m128i q;
+  if (bits == 8) {
+    q = _mm_loadu_si128((const __m128i*)qw);
+  } else {
+    // 8 bytes of 2 nibbles -> 16 bytes, low nibbles first
+    auto packed = _mm_loadl_epi64((const __m128i*)qw);
+    auto mask = _mm_set1_epi8(0xF);
+    auto low = _mm_and_si128(packed, mask);
+    auto high = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+    q = _mm_unpacklo_epi64(low, high);
+  }
+  auto w = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(q));
+  return _mm512_fmadd_ps(w, scale, zero_bias);
+}
+#endif
+
+// out[MB, woq_block_n] = x[MB, K] * dequant(w[K, woq_block_n])
+template <int64_t MB>
+inline void woq_gemm_small_m_block(
+    const float* x,
+    int64_t ldx,
+    const uint8_t* qw,
+    const float* scales,
+    const float* zero_biases,
+    int64_t K,
+    int64_t bits,
+    int64_t group_size,
+    float* out,
+    int64_t ldo,
+    int64_t n_valid) {
+  const int64_t w_row = bits == 8 ? woq_block_n : woq_block_n / 2;
+#if defined(CPU_CAPABILITY_AVX512)
+  __m512 acc[MB];
+  for (int64_t m = 0; m < MB; m++) {
+    acc[m] = _mm512_setzero_ps();
+  }
+  for (int64_t k0 = 0, g = 0; k0 < K; k0 += group_size, g++) {
+    auto scale = _mm512_loadu_ps(scales + g * woq_block_n);
+    auto zero_bias = _mm512_loadu_ps(zero_biases + g * woq_block_n);
+    for (int64_t k = k0; k < k0 + group_size; k++) {
+      auto w = dequant_block_row(qw + k * w_row, scale, zero_bias, bits);
+      for (int64_t m = 0; m < MB; m++) {
+        acc[m] = _mm512_fmadd_ps(_mm512_set1_ps(x[m * ldx + k]), w, acc[m]);
+      }
+    }
+  }
+  __mmask16 mask = (1 << n_valid) - 1;
+  for (int64_t m = 0; m < MB; m++) {
+    _mm512_mask_storeu_ps(out + m * ldo, mask, acc[m]);
+  }
+#else
+  float acc[MB][woq_block_n] = {};
+  float w[woq_block_n];
+  for (int64_t k0 = 0, g = 0; k0 < K; k0 += group_size, g++) {
+    for (int64_t k = k0; k < k0 + group_size; k++) {
+      dequant_block_row(
+          qw + k * w_row,
+          scales + g * woq_block_n,
+          zero_biases + g * woq_block_n,
+          bits,
+          w);
+      for (int64_t m = 0; m < MB; m++) {
+        float xv = x[m * ldx + k];
+#pragma omp simd
+        for (int64_t j = 0; j < woq_block_n; j++) {
+          acc[m][j] += xv * w[j];
+        }
+      }
+    }
+  }
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t j = 0; j < n_valid; j++) {
+      out[m * ldo + j] = acc[m][j];
+    }
+  }
+#endif
+}
+
+using woq_gemm_small_m_block_fn = decltype(&woq_gemm_small_m_block<1>);
+const woq_gemm_small_m_block_fn small_m_block_fns[woq_small_m_block] = {
+    woq_gemm_small_m_block<1>,
+    woq_gemm_small_m_block<2>,
+    woq_gemm_small_m_block<3>,
+    woq_gemm_small_m_block<4>};
+
+void woq_gemm_small_m(
+    const float* x,
+    const uint8_t* qw,
+    const float* scales,
+    const float* zero_biases,
+    int64_t M,
+    int64_t N,
+    int64_t K,
+    int64_t bits,
+    int64_t group_size,
+    float* out) {
+  const int64_t num_groups = K / group_size;
+  const int64_t w_block = bits == 8 ? K * woq_block_n : K * woq_block_n / 2;
+  const int64_t n_blocks = (N + woq_block_n - 1) / woq_block_n;
+  const int64_t m_blocks = (M + woq_small_m_block - 1) / woq_small_m_block;
+  at::parallel_for(
+      0, n_blocks * m_blocks, 0, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          // neighbouring tasks share the block of weight
+          int64_t nb = i / m_blocks;
+          int64_t m0 = (i % m_blocks) * woq_small_m_block;
+          int64_t mb = std::min(woq_small_m_block, M - m0);
+          int64_t n0 = nb * woq_block_n;
+          auto n_valid = std::min(woq_block_n, N - n0);
+          small_m_block_fns[mb - 1](
+              x + m0 * K,
+              K,
+              qw + nb * w_block,
+              scales + nb * num_groups * woq_block_n,
+              zero_biases + nb * num_groups * woq_block_n,
+              K,
+              bits,
+              group_size,
+              out + m0 * N + n0,
+              N,
+              n_valid);
+        }
+      });
+}
+
+void woq_gemm_large_m(
+    const float* x,
+    const uint8_t* qw,
+    const float* scales,
+    const float* zero_biases,
+    int64_t M,
+    int64_t N,
+    int64_t K,
+    int64_t bits,
+    int64_t group_size,
+    float* out) {
+  const int64_t num_groups = K / group_size;
+  const int64_t w_block = bits == 8 ? K * woq_block_n : K * woq_block_n / 2;
+  const int64_t w_row = bits == 8 ? woq_block_n : woq_block_n / 2;
+  const int64_t n_chunks = (N + woq_large_n_block - 1) / woq_large_n_block;
+  at::parallel_for(0, n_chunks, 0, [&](int64_t begin, int64_t end) {
+    std::vector<float> w_buf(K * woq_large_n_block);
+    for (int64_t c = begin; c < end; c++) {
+      int64_t n0 = c * woq_large_n_block;
+      int64_t n_cols = std::min(woq_large_n_block, N - n0);
+      int64_t nb_end = (n0 + n_cols + woq_block_n - 1) / woq_block_n;
+      for (int64_t nb = n0 / woq_block_n; nb < nb_end; nb++) {
+        auto qw_block = qw + nb * w_block;
+        auto j0 = nb * woq_block_n - n0;
+        auto scale = scales + nb * num_groups * woq_block_n;
+        auto zero_bias = zero_biases + nb * num_groups * woq_block_n;
+        for (int64_t k = 0; k < K; k++) {
+          auto g = k / group_size;
+          dequant_block_row(
+              qw_block + k * w_row,
+              scale + g * woq_block_n,
+              zero_bias + g * woq_block_n,
+              bits,
+              &w_buf[k * woq_large_n_block + j0]);
+        }
+      }
+      cblas_sgemm(
+          CblasRowMajor,
+          CblasNoTrans,
+          CblasNoTrans,
+          M,
+          n_cols,
+          K,
+          1.f,
+          x,
+          K,
+          w_buf.data(),
+          woq_large_n_block,
+          0.f,
+          out + n0,
+          N);
+    }
+  });
+}
+
+void woq_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& packed_weight,
+    const at::Tensor& packed_scales,
+    const at::Tensor& packed_zero_biases,
+    const at::Tensor& bias,
+    int64_t bits,
+    int64_t group_size,
+    at::Tensor& output) {
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat ||
+          input.scalar_type() == at::kBFloat16,
+      "ipex_woq_linear only supports float and bfloat16 input");
+  int64_t K = input.size(-1);
+  int64_t M = input.numel() / K;
+  int64_t N = output.size(-1);
+  if (M == 0) {
+    return;
+  }
+  auto x = input.to(at::kFloat).contiguous();
+  auto out = output.scalar_type() == at::kFloat
+      ? output
+      : at::empty(output.sizes(), output.options().dtype(at::kFloat));
+  auto gemm = M <= woq_small_m ? woq_gemm_small_m : woq_gemm_large_m;
+  gemm(
+      x.data_ptr<float>(),
+      packed_weight.data_ptr<uint8_t>(),
+      packed_scales.data_ptr<float>(),
+      packed_zero_biases.data_ptr<float>(),
+      M,
+      N,
+      K,
+      bits,
+      group_size,
+      out.data_ptr<float>());
+  if (bias.defined()) {
+    out.view({M, N}).add_(bias);
+  }
+  if (!out.is_same(output)) {
+    output.copy_(out);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(woq_linear_kernel_stub, &woq_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,277 @@
+#include <aten/MergedEmbeddingBag.h>
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBagUpdateKrnl.h"
+#include "vec/vec.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+using namespace torch_ipex::cpu::kernel;
+
+template <typename param_t, typename acc_t>
+inline void adagrad_update(
+    param_t* param_ptr,
+    at::BFloat16* trail_ptr,
+    acc_t* grad_ptr,
+    acc_t* hessian_ptr,
+    float eps,
+    float weight_decay,
+    float lr,
+    int size) {
+  using Vec = at::vec::Vectorized<param_t>;
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec = Vec::loadu(param_ptr + d);
+    Vec grad_vec =
+        Vec::loadu(grad_ptr + d) + param_vec * Vec(param_t(weight_decay));
+    Vec hessian_vec = Vec::loadu(hessian_ptr + d) + grad_vec * grad_vec;
+    hessian_vec.store(hessian_ptr + d);
+
+    Vec std_vec = hessian_vec.sqrt() + Vec(param_t(eps));
+    param_vec -= grad_vec / std_vec * Vec(param_t(lr));
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    param_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay;
+    hessian_ptr[d] += grad_val * grad_val;
+    param_t std_val = std::sqrt(hessian_ptr[d]) + eps;
+    param_ptr[d] -= grad_val / std_val * lr;
+  }
+}
+
+template <>
+inline void adagrad_update<at::BFloat16, float>(
+    at::BFloat16* param_ptr,
+    at::BFloat16* trail_ptr,
+    float* grad_ptr,
+    float* hessian_ptr,
+    float eps,
+    float weight_decay,
+    float lr,
+    int size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec param_bvec = bVec::loadu(param_ptr + d);
+    bVec trail_bvec = bVec::loadu(trail_ptr + d);
+    fVec param_fvec, param_fvec2;
+    std::tie(param_fvec, param_fvec2) =
+        at::vec::pack_bfloat16_float(param_bvec, trail_bvec);
+
+    fVec grad_fvec = fVec::loadu(grad_ptr + d);
+    fVec grad_fvec2 = fVec::loadu(grad_ptr + d + fVec::size());
+    grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
+    grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
+
+    fVec hessian_fvec = fVec::loadu(hessian_ptr + d) + grad_fvec * grad_fvec;
+    fVec hessian_fvec2 =
+        fVec::loadu(hessian_ptr + d + fVec::size()) + grad_fvec2 * grad_fvec2;
+    hessian_fvec.store(hessian_ptr + d);
+    hessian_fvec2.store(hessian_ptr + d + fVec::size());
+
+    param_fvec -= grad_fvec / (hessian_fvec.sqrt() + fVec(eps)) * fVec(lr);
+    param_fvec2 -= grad_fvec2 / (hessian_fvec2.sqrt() + fVec(eps)) * fVec(lr);
+
+    std::tie(param_bvec, trail_bvec) =
+        at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
+    param_bvec.store(param_ptr + d);
+    trail_bvec.store(trail_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], trail_ptr[d]);
+    float grad_val = grad_ptr[d] + param_val * weight_decay;
+    hessian_ptr[d] += grad_val * grad_val;
+    param_val -= grad_val / (std::sqrt(hessian_ptr[d]) + eps) * lr;
+    std::tie(param_ptr[d], trail_ptr[d]) =
+        at::vec::unpack_float_bfloat16(param_val);
+  }
+}
+
+template <typename param_t>
+inline float param_value(param_t* param_ptr, at::BFloat16* trail_ptr, int d) {
+  return param_ptr[d];
+}
+
+template <>
+inline float param_value<at::BFloat16>(
+    at::BFloat16* param_ptr,
+    at::BFloat16* trail_ptr,
+    int d) {
+  return at::vec::pack_bfloat16_float(param_ptr[d], trail_ptr[d]);
+}
+
+// Row-wise Adagrad keeps one accumulator per row: the mean of the squared
+// grads over the row, then applies the same step size to the whole row.
+template <typename param_t, typename acc_t>
+inline void rowwise_adagrad_update(
+    param_t* param_ptr,
+    at::BFloat16* trail_ptr,
+    acc_t* grad_ptr,
+    acc_t* hessian_ptr,
+    float eps,
+    float weight_decay,
+    float lr,
+    int size) {
+  if (weight_decay != 0) {
+    for (int d = 0; d < size; d++) {
+      grad_ptr[d] += param_value(param_ptr, trail_ptr, d) * weight_decay;
+    }
+  }
+  acc_t square_sum = 0;
+#pragma omp simd reduction(+ : square_sum)
+  for (int d = 0; d < size; d++) {
+    square_sum += grad_ptr[d] * grad_ptr[d];
+  }
+  acc_t hessian = *hessian_ptr + square_sum / size;
+  *hessian_ptr = hessian;
+  float clr = lr / (std::sqrt(hessian) + eps);
+  // weight decay is already applied
+  sgd_update<param_t, acc_t>(param_ptr, trail_ptr, grad_ptr, 0, clr, size);
+}
+
+template <typename T>
+inline void AccGradUpdate<T, AdagradArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    const AdagradArgs& args) {
+  // grad accumulate
+  using acc_t = acc_type<T, true>;
+  acc_t grad_acc_buffer[vector_size];
+  csc_grad_accumulate(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  // adagrad update
+  T* weight_ptr = &weight[weight_offsets];
+  acc_t* hessian_ptr =
+      args.hessian[table_id].data_ptr<acc_t>() + weight_offsets;
+  BFloat16* bf16_trail_ptr = nullptr;
+  if (std::is_same<T, BFloat16>::value) {
+    bf16_trail_ptr =
+        args.bf16_trail[table_id].data_ptr<BFloat16>() + weight_offsets;
+  }
+  adagrad_update<T, acc_t>(
+      weight_ptr,
+      bf16_trail_ptr,
+      grad_acc_buffer,
+      hessian_ptr,
+      args.eps,
+      args.weight_decay,
+      args.lr,
+      vector_size);
+}
+
+template <typename T>
+inline void AccGradUpdate<T, RowWiseAdagradArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    const RowWiseAdagradArgs& args) {
+  // grad accumulate
+  using acc_t = acc_type<T, true>;
+  acc_t grad_acc_buffer[vector_size];
+  csc_grad_accumulate(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  // row-wise adagrad update
+  T* weight_ptr = &weight[weight_offsets];
+  acc_t* hessian_ptr =
+      args.hessian[table_id].data_ptr<acc_t>() + weight_offsets / vector_size;
+  BFloat16* bf16_trail_ptr = nullptr;
+  if (std::is_same<T, BFloat16>::value) {
+    bf16_trail_ptr =
+        args.bf16_trail[table_id].data_ptr<BFloat16>() + weight_offsets;
+  }
+  rowwise_adagrad_update<T, acc_t>(
+      weight_ptr,
+      bf16_trail_ptr,
+      grad_acc_buffer,
+      hessian_ptr,
+      args.eps,
+      args.weight_decay,
+      args.lr,
+      vector_size);
+}
+
+void merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& hessian,
+    const std::vector<Tensor>& bf16_trail,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool rowwise,
+    const std::vector<Tensor>& dedup_mapping) {
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables == grads_y_.size());
+  TORCH_CHECK(n_tables == hessian.size());
+  auto grads_y = grads_y_;
+  for (auto i = 0; i < n_tables; i++) {
+    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
+    grads_y[i] = grads_y_[i].contiguous();
+    auto acc_dtype =
+        weights[i].scalar_type() == ScalarType::Double ? kDouble : kFloat;
+    TORCH_CHECK(
+        hessian[i].is_contiguous() && hessian[i].scalar_type() == acc_dtype,
+        "merged_embeddingbag_backward_adagrad: expect contiguous hessian in the accumulate dtype of the table");
+    TORCH_CHECK(
+        rowwise ? hessian[i].numel() == weights[i].size(0)
+                : hessian[i].numel() == weights[i].numel(),
+        "merged_embeddingbag_backward_adagrad: expect hessian of ",
+        rowwise ? "1 value per row" : "the same shape as the table");
+  }
+  if (rowwise) {
+    RowWiseAdagradArgs args =
+        RowWiseAdagradArgs(bf16_trail, hessian, eps, weight_decay, lr);
+    merged_embeddingbag_backward_cpu_kernel<RowWiseAdagradArgs>(
+        grads_y,
+        indices,
+        offsets,
+        weights,
+        indices_with_row_offset,
+        row_offsets,
+        pooling_modes,
+        dedup_mapping,
+        args);
+  } else {
+    AdagradArgs args = AdagradArgs(bf16_trail, hessian, eps, weight_decay, lr);
+    merged_embeddingbag_backward_cpu_kernel<AdagradArgs>(
+        grads_y,
+        indices,
+        offsets,
+        weights,
+        indices_with_row_offset,
+        row_offsets,
+        pooling_modes,
+        dedup_mapping,
+        args);
+  }
+
+  return;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_backward_adagrad_cpu_kernel_stub,
+    &merged_embeddingbag_backward_adagrad_cpu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
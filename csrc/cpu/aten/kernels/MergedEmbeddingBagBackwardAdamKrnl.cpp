@@ -0,0 +1,261 @@
+#include <ATen/cpu/vec/functional.h>
+#include <aten/MergedEmbeddingBag.h>
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBagUpdateKrnl.h"
+#include "vec/vec.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+using namespace torch_ipex::cpu::kernel;
+
+// The row of the table in the accumulate dtype, the bf16 rows being packed
+// with their trail
+template <typename param_t, typename acc_t>
+inline void load_row(
+    const param_t* param_ptr,
+    const at::BFloat16* trail_ptr,
+    acc_t* row,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    row[d] = param_ptr[d];
+  }
+}
+
+template <>
+inline void load_row<at::BFloat16, float>(
+    const at::BFloat16* param_ptr,
+    const at::BFloat16* trail_ptr,
+    float* row,
+    int size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec row_fvec, row_fvec2;
+    std::tie(row_fvec, row_fvec2) = at::vec::pack_bfloat16_float(
+        bVec::loadu(param_ptr + d), bVec::loadu(trail_ptr + d));
+    row_fvec.store(row + d);
+    row_fvec2.store(row + d + fVec::size());
+  }
+  for (; d < size; d++) {
+    row[d] = at::vec::pack_bfloat16_float(param_ptr[d], trail_ptr[d]);
+  }
+}
+
+template <typename param_t, typename acc_t>
+inline void store_row(
+    param_t* param_ptr,
+    at::BFloat16* trail_ptr,
+    const acc_t* row,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    param_ptr[d] = row[d];
+  }
+}
+
+template <>
+inline void store_row<at::BFloat16, float>(
+    at::BFloat16* param_ptr,
+    at::BFloat16* trail_ptr,
+    const float* row,
+    int size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec param_bvec, trail_bvec;
+    std::tie(param_bvec, trail_bvec) = at::vec::unpack_float_bfloat16(
+        fVec::loadu(row + d), fVec::loadu(row + d + fVec::size()));
+    param_bvec.store(param_ptr + d);
+    trail_bvec.store(trail_ptr + d);
+  }
+  for (; d < size; d++) {
+    std::tie(param_ptr[d], trail_ptr[d]) =
+        at::vec::unpack_float_bfloat16(row[d]);
+  }
+}
+
+// Adam, or LAMB, update of a looked up row, its moments and the grad buffer
+// being updated in place. The LAMB trust ratio is the one of the row, the
+// norms of the whole table would need all the rows updated first.
+template <typename acc_t>
+inline void adam_row_update(
+    acc_t* param_ptr,
+    acc_t* grad_ptr,
+    acc_t* exp_avg_ptr,
+    acc_t* exp_avg_sq_ptr,
+    const AdamArgs& args,
+    int size) {
+  using Vec = at::vec::Vectorized<acc_t>;
+  acc_t beta1 = args.beta1;
+  acc_t beta2 = args.beta2;
+  acc_t bias_correction1 = 1 - std::pow(beta1, acc_t(args.step));
+  acc_t bias_correction2 = 1 - std::pow(beta2, acc_t(args.step));
+  acc_t eps = args.eps;
+  // Adam decays the grad and LAMB the step
+  acc_t grad_decay = args.lamb ? 0 : args.weight_decay;
+  acc_t step_decay = args.lamb ? args.weight_decay : 0;
+
+  Vec param_norm_vec(acc_t(0));
+  Vec step_norm_vec(acc_t(0));
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec = Vec::loadu(param_ptr + d);
+    Vec grad_vec = Vec::loadu(grad_ptr + d) + param_vec * Vec(grad_decay);
+    Vec exp_avg_vec = Vec::loadu(exp_avg_ptr + d) * Vec(beta1) +
+        grad_vec * Vec(1 - beta1);
+    Vec exp_avg_sq_vec = Vec::loadu(exp_avg_sq_ptr + d) * Vec(beta2) +
+        grad_vec * grad_vec * Vec(1 - beta2);
+    exp_avg_vec.store(exp_avg_ptr + d);
+    exp_avg_sq_vec.store(exp_avg_sq_ptr + d);
+
+    Vec step_vec = exp_avg_vec / Vec(bias_correction1) /
+            ((exp_avg_sq_vec / Vec(bias_correction2)).sqrt() + Vec(eps)) +
+        param_vec * Vec(step_decay);
+    step_vec.store(grad_ptr + d);
+    param_norm_vec += param_vec * param_vec;
+    step_norm_vec += step_vec * step_vec;
+  }
+  acc_t param_norm = at::vec::vec_reduce_all(
+      [](Vec& x, Vec& y) { return x + y; }, param_norm_vec);
+  acc_t step_norm = at::vec::vec_reduce_all(
+      [](Vec& x, Vec& y) { return x + y; }, step_norm_vec);
+  for (; d < size; d++) {
+    acc_t grad_val = grad_ptr[d] + param_ptr[d] * grad_decay;
+    exp_avg_ptr[d] = exp_avg_ptr[d] * beta1 + grad_val * (1 - beta1);
+    exp_avg_sq_ptr[d] =
+        exp_avg_sq_ptr[d] * beta2 + grad_val * grad_val * (1 - beta2);
+    acc_t step_val = exp_avg_ptr[d] / bias_correction1 /
+            (std::sqrt(exp_avg_sq_ptr[d] / bias_correction2) + eps) +
+        param_ptr[d] * step_decay;
+    grad_ptr[d] = step_val;
+    param_norm += param_ptr[d] * param_ptr[d];
+    step_norm += step_val * step_val;
+  }
+
+  acc_t lr = args.lr;
+  if (args.lamb && param_norm > 0 && step_norm > 0) {
+    lr *= std::sqrt(param_norm) / std::sqrt(step_norm);
+  }
+  d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec =
+        Vec::loadu(param_ptr + d) - Vec::loadu(grad_ptr + d) * Vec(lr);
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    param_ptr[d] -= grad_ptr[d] * lr;
+  }
+}
+
+template <typename T>
+inline void AccGradUpdate<T, AdamArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    const AdamArgs& args) {
+  // grad accumulate
+  using acc_t = acc_type<T, true>;
+  acc_t grad_acc_buffer[vector_size];
+  csc_grad_accumulate(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  // adam update of the row and its moments
+  T* weight_ptr = &weight[weight_offsets];
+  acc_t* exp_avg_ptr =
+      args.exp_avg[table_id].data_ptr<acc_t>() + weight_offsets;
+  acc_t* exp_avg_sq_ptr =
+      args.exp_avg_sq[table_id].data_ptr<acc_t>() + weight_offsets;
+  BFloat16* bf16_trail_ptr = nullptr;
+  if (std::is_same<T, BFloat16>::value) {
+    bf16_trail_ptr =
+        args.bf16_trail[table_id].data_ptr<BFloat16>() + weight_offsets;
+  }
+  acc_t param_buffer[vector_size];
+  load_row<T, acc_t>(weight_ptr, bf16_trail_ptr, param_buffer, vector_size);
+  adam_row_update<acc_t>(
+      param_buffer,
+      grad_acc_buffer,
+      exp_avg_ptr,
+      exp_avg_sq_ptr,
+      args,
+      vector_size);
+  store_row<T, acc_t>(weight_ptr, bf16_trail_ptr, param_buffer, vector_size);
+}
+
+void merged_embeddingbag_backward_adam_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    const std::vector<Tensor>& bf16_trail,
+    double step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool lamb,
+    const std::vector<Tensor>& dedup_mapping) {
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables == grads_y_.size());
+  TORCH_CHECK(n_tables == exp_avg.size() && n_tables == exp_avg_sq.size());
+  auto grads_y = grads_y_;
+  for (auto i = 0; i < n_tables; i++) {
+    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
+    grads_y[i] = grads_y_[i].contiguous();
+    auto acc_dtype =
+        weights[i].scalar_type() == ScalarType::Double ? kDouble : kFloat;
+    for (const auto& state : {exp_avg[i], exp_avg_sq[i]}) {
+      TORCH_CHECK(
+          state.is_contiguous() && state.scalar_type() == acc_dtype &&
+              state.numel() == weights[i].numel(),
+          "merged_embeddingbag_backward_adam: expect contiguous moments of the same shape as the table in its accumulate dtype");
+    }
+  }
+  AdamArgs args = AdamArgs(
+      bf16_trail,
+      exp_avg,
+      exp_avg_sq,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      lamb);
+  merged_embeddingbag_backward_cpu_kernel<AdamArgs>(
+      grads_y,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      dedup_mapping,
+      args);
+
+  return;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_backward_adam_cpu_kernel_stub,
+    &merged_embeddingbag_backward_adam_cpu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
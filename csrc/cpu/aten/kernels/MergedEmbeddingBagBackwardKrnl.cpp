@@ -1,6 +1,9 @@
 #include <aten/MergedEmbeddingBag.h>
 #include <c10/core/CPUAllocator.h>
+#include <limits>
 #include <omp.h>
+#include "aten/utils/embedding_lookup.h"
+#include "aten/utils/radix_sort.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -49,18 +52,20 @@ std::vector<Tensor> merged_embeddingbag_backward_cpu_kernel_impl(
     const std::vector<Tensor>& weights,
     const Tensor& indices_with_row_offset,
     const Tensor& row_offsets,
-    const std::vector<int64_t> pooling_modes) {
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& dedup_mapping) {
   int64_t n_tables = weights.size();
   int64_t bs = (offsets.numel() - 1) / n_tables;
   int64_t* row_offset_data = row_offsets.data_ptr<int64_t>();
   BatchedHyperCompressedSparseColumn batched_csc;
-  sort_based_batched_csr2csc_opt(
+  batched_csr2csc(
       batched_csc,
       bs,
       offsets,
       indices_with_row_offset,
       pooling_modes,
-      row_offset_data[n_tables]);
+      row_offset_data[n_tables],
+      dedup_mapping);
   RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
 
   std::vector<int> vector_sizes;
@@ -124,11 +129,265 @@ std::vector<Tensor> merged_embeddingbag_backward_cpu_kernel_impl(
   return grad_weights;
 }
 
+// The grad of one row of component k of a compositional table, over its CSC
+// segment [entry_begin, entry_end) of the sorted (component row, entry)
+// pairs. Entry e of the table is component k of the index at position
+// index_begin + e / n_components, read by bag bags[p] with scale scales[p].
+// For COMBINE_MUL the grad of the bag is also multiplied by the rows of the
+// other components for that index.
+template <typename T>
+inline void compositional_grad_accumulate(
+    T* grad_w_row,
+    T* grad_out,
+    T* const* components,
+    const int64_t* component_rows,
+    const int64_t* divisors,
+    int64_t n_components,
+    int64_t k,
+    int64_t mode,
+    int64_t combine,
+    const Key_Value_Weight_Tuple<int>* sorted,
+    int64_t entry_begin,
+    int64_t entry_end,
+    int64_t table_entry_begin,
+    int64_t index_begin,
+    const int64_t* indices_data,
+    const int64_t* bags,
+    const float* scales,
+    int vector_size) {
+  using acc_t = acc_type<T, true>;
+  acc_t grad_acc_buffer[vector_size] __attribute__((aligned(64)));
+  acc_t temp_row[vector_size];
+  zero_ker(grad_acc_buffer, vector_size);
+  for (int64_t r = entry_begin; r < entry_end; r++) {
+    int64_t e = std::get<1>(sorted[r]) - table_entry_begin;
+    int64_t p = index_begin + e / n_components;
+    T* grad_out_ptr = &grad_out[bags[p] * vector_size];
+    if (combine == COMBINE_ADD || n_components == 1) {
+      madd_ker(grad_acc_buffer, grad_out_ptr, vector_size, scales[p]);
+      continue;
+    }
+    zero_ker(temp_row, vector_size);
+    madd_ker(temp_row, grad_out_ptr, vector_size, scales[p]);
+    for (int64_t j = 0; j < n_components; j++) {
+      if (j == k) {
+        continue;
+      }
+      int64_t row = compositional_row(
+          indices_data[p], mode, j, component_rows[j], divisors[j]);
+      const T* component_ptr = &components[j][row * vector_size];
+#pragma omp simd
+      for (int d = 0; d < vector_size; ++d) {
+        temp_row[d] *= acc_t(component_ptr[d]);
+      }
+    }
+    add_ker(grad_acc_buffer, temp_row, vector_size);
+  }
+  move_ker(grad_w_row, grad_acc_buffer, vector_size);
+}
+
+// The CSC here is built over the rows of the components rather than over the
+// indices: every index contributes one (component row, entry) pair per
+// component, the pairs are radix sorted by component row and each segment is
+// the grad of one component row, so the threads write disjoint rows. The
+// logical tables may have many more rows than the int keys of the sort hold,
+// their components do not.
+std::vector<Tensor> merged_embeddingbag_backward_compositional_cpu_kernel_impl(
+    const std::vector<Tensor>& grad_outs_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine) {
+  RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
+  int64_t n_tables = num_components.size();
+  TORCH_CHECK(n_tables > 0 && grad_outs_.size() == n_tables);
+  TORCH_CHECK(
+      combine == COMBINE_MUL || combine == COMBINE_ADD,
+      "merged_embeddingbag_backward_compositional only support mul or add combine");
+  auto components = get_compositional_components(weights, num_components, mode);
+  int64_t n_components_all = weights.size();
+  int64_t B = (offsets.numel() - 1) / n_tables;
+  TORCH_CHECK(indices.is_contiguous() && offsets.is_contiguous());
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  int64_t n_indices = indices.numel();
+
+  // the components of all the tables are one key space for the sort
+  std::vector<int64_t> component_row_offsets(n_components_all + 1, 0);
+  std::vector<int64_t> component_table(n_components_all);
+  for (int64_t t = 0; t < n_tables; t++) {
+    for (int64_t c = components.begin[t]; c < components.begin[t + 1]; c++) {
+      component_row_offsets[c + 1] =
+          component_row_offsets[c] + components.rows[c];
+      component_table[c] = t;
+    }
+  }
+  TORCH_CHECK(
+      component_row_offsets[n_components_all] <=
+          std::numeric_limits<int>::max(),
+      "merged_embeddingbag_backward_compositional: too many component rows");
+
+  // table t owns the indices [index_begin[t], index_begin[t + 1]) and the
+  // entries [entry_begin[t], entry_begin[t + 1])
+  std::vector<int64_t> index_begin(n_tables + 1);
+  std::vector<int64_t> entry_begin(n_tables + 1, 0);
+  for (int64_t t = 0; t <= n_tables; t++) {
+    index_begin[t] = offsets_data[t * B];
+  }
+  for (int64_t t = 0; t < n_tables; t++) {
+    entry_begin[t + 1] = entry_begin[t] +
+        (index_begin[t + 1] - index_begin[t]) * num_components[t];
+  }
+  int64_t n_entries = entry_begin[n_tables];
+  TORCH_CHECK(
+      n_entries <= std::numeric_limits<int>::max(),
+      "merged_embeddingbag_backward_compositional: too many indices");
+
+  // the bag of every index and its scale
+  auto long_options = indices.options().dtype(kLong);
+  Tensor bags = at::empty({n_indices}, long_options);
+  Tensor scales = at::empty({n_indices}, indices.options().dtype(kFloat));
+  int64_t* bags_data = bags.data_ptr<int64_t>();
+  float* scales_data = scales.data_ptr<float>();
+  at::parallel_for(0, n_tables * B, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      int64_t pool_begin = offsets_data[n];
+      int64_t pool_end = offsets_data[n + 1];
+      float scale = pooling_modes[n / B] == MEAN && pool_end > pool_begin
+          ? 1.f / (pool_end - pool_begin)
+          : 1.f;
+      for (int64_t p = pool_begin; p < pool_end; p++) {
+        bags_data[p] = n % B;
+        scales_data[p] = scale;
+      }
+    }
+  });
+
+  CSR2CSCWorkspace& workspace = get_csr2csc_workspace();
+  auto* sort_buf = workspace.get<Key_Value_Weight_Tuple<int>>(
+      CSR2CSCWorkspace::SORT_BUFFER0, n_entries);
+  auto* sort_tmp_buf = workspace.get<Key_Value_Weight_Tuple<int>>(
+      CSR2CSCWorkspace::SORT_BUFFER1, n_entries);
+  at::parallel_for(0, n_entries, 0, [&](int64_t begin, int64_t end) {
+    int64_t t = std::upper_bound(
+                    entry_begin.begin(), entry_begin.end(), begin) -
+        entry_begin.begin() - 1;
+    for (int64_t e = begin; e < end; e++) {
+      while (e >= entry_begin[t + 1]) {
+        t++;
+      }
+      int64_t local = e - entry_begin[t];
+      int64_t k = local % num_components[t];
+      int64_t c = components.begin[t] + k;
+      int64_t row = compositional_row(
+          indices_data[index_begin[t] + local / num_components[t]],
+          mode,
+          k,
+          components.rows[c],
+          components.divisors[c]);
+      sort_buf[e] = Key_Value_Weight_Tuple<int>(
+          component_row_offsets[c] + row, e, 1.f);
+    }
+  });
+  auto* sorted = radix_sort_parallel<int>(
+      sort_buf,
+      sort_tmp_buf,
+      n_entries,
+      component_row_offsets[n_components_all]);
+
+  // the start of the segment of every unique component row
+  Tensor ranks = at::empty({n_entries}, long_options);
+  int64_t* ranks_data = ranks.data_ptr<int64_t>();
+  at::parallel_for(0, n_entries, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      ranks_data[r] =
+          r == 0 || std::get<0>(sorted[r]) != std::get<0>(sorted[r - 1]);
+    }
+  });
+  ranks = ranks.cumsum(0);
+  ranks_data = ranks.data_ptr<int64_t>();
+  int64_t n_segments = n_entries > 0 ? ranks_data[n_entries - 1] : 0;
+  std::vector<int64_t> segment_ptr(n_segments + 1);
+  at::parallel_for(0, n_entries, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      if (r == 0 || ranks_data[r - 1] != ranks_data[r]) {
+        segment_ptr[ranks_data[r] - 1] = r;
+      }
+    }
+  });
+  segment_ptr[n_segments] = n_entries;
+
+  std::vector<Tensor> grad_outs;
+  std::vector<void*> grad_outs_ptr;
+  for (int64_t t = 0; t < n_tables; t++) {
+    grad_outs.emplace_back(grad_outs_[t].contiguous());
+    grad_outs_ptr.emplace_back(grad_outs[t].data_ptr());
+  }
+  std::vector<Tensor> grad_weights;
+  std::vector<void*> components_ptr;
+  std::vector<void*> grad_weights_ptr;
+  for (int64_t c = 0; c < n_components_all; c++) {
+    auto& grad_out = grad_outs[component_table[c]];
+    grad_weights.emplace_back(at::zeros(
+        {weights[c].size(0), grad_out.size(-1)}, grad_out.options()));
+    grad_weights_ptr.emplace_back(grad_weights[c].data_ptr());
+    components_ptr.emplace_back(weights[c].data_ptr());
+  }
+
+  at::parallel_for(0, n_segments, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; s++) {
+      int64_t key = std::get<0>(sorted[segment_ptr[s]]);
+      int64_t c = std::upper_bound(
+                      component_row_offsets.begin(),
+                      component_row_offsets.end(),
+                      key) -
+          component_row_offsets.begin() - 1;
+      int64_t t = component_table[c];
+      int64_t c_begin = components.begin[t];
+      int vector_size = weights[c].size(1);
+      int64_t row = key - component_row_offsets[c];
+      AT_DISPATCH_FLOATING_TYPES_AND(
+          at::ScalarType::BFloat16,
+          grad_weights[c].scalar_type(),
+          "compositional_grad_accumulate",
+          [&] {
+            compositional_grad_accumulate<scalar_t>(
+                &((scalar_t*)grad_weights_ptr[c])[row * vector_size],
+                (scalar_t*)grad_outs_ptr[t],
+                reinterpret_cast<scalar_t* const*>(&components_ptr[c_begin]),
+                &components.rows[c_begin],
+                &components.divisors[c_begin],
+                num_components[t],
+                c - c_begin,
+                mode,
+                combine,
+                sorted,
+                segment_ptr[s],
+                segment_ptr[s + 1],
+                entry_begin[t],
+                index_begin[t],
+                indices_data,
+                bags_data,
+                scales_data,
+                vector_size);
+          });
+    }
+  });
+  return grad_weights;
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
     merged_embeddingbag_backward_cpu_kernel_stub,
     &merged_embeddingbag_backward_cpu_kernel_impl);
 
+REGISTER_DISPATCH(
+    merged_embeddingbag_backward_compositional_cpu_kernel_stub,
+    &merged_embeddingbag_backward_compositional_cpu_kernel_impl);
+
 } // namespace cpu
 } // namespace torch_ipex
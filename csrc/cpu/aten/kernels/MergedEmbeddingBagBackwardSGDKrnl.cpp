@@ -1,6 +1,10 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
 #include <aten/MergedEmbeddingBag.h>
 #include <c10/core/CPUAllocator.h>
 #include <omp.h>
+#include "MergedEmbeddingBagUpdateKrnl.h"
+#include "aten/utils/scratch_arena.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -11,71 +15,6 @@ namespace {
 using namespace at;
 using namespace torch_ipex::cpu::kernel;
 
-template <typename param_t, typename acc_t>
-inline void sgd_update(
-    param_t* param_ptr,
-    at::BFloat16* trail_ptr,
-    acc_t* grad_ptr,
-    float weight_decay,
-    float lr,
-    int size) {
-  using Vec = at::vec::Vectorized<param_t>;
-  int64_t d = 0;
-  for (; d < size - (size % Vec::size()); d += Vec::size()) {
-    Vec param_vec = Vec::loadu(param_ptr + d);
-    Vec grad_vec =
-        Vec::loadu(grad_ptr + d) + param_vec * Vec(param_t(weight_decay));
-
-    param_vec -= grad_vec * Vec(param_t(lr));
-    param_vec.store(param_ptr + d);
-  }
-  for (; d < size; d++) {
-    param_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay;
-    param_ptr[d] -= grad_val * lr;
-  }
-}
-
-template <>
-inline void sgd_update<at::BFloat16, float>(
-    at::BFloat16* param_ptr,
-    at::BFloat16* trail_ptr,
-    float* grad_ptr,
-    float weight_decay,
-    float lr,
-    int size) {
-  using bVec = at::vec::Vectorized<at::BFloat16>;
-  using fVec = at::vec::Vectorized<float>;
-  int64_t d = 0;
-  for (; d < size - (size % bVec::size()); d += bVec::size()) {
-    bVec param_bvec = bVec::loadu(param_ptr + d);
-    bVec trail_bvec = bVec::loadu(trail_ptr + d);
-    fVec param_fvec, param_fvec2;
-    std::tie(param_fvec, param_fvec2) =
-        at::vec::pack_bfloat16_float(param_bvec, trail_bvec);
-
-    fVec grad_fvec = fVec::loadu(grad_ptr + d);
-    fVec grad_fvec2 = fVec::loadu(grad_ptr + d + fVec::size());
-
-    grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
-    grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
-
-    param_fvec -= grad_fvec * fVec(lr);
-    param_fvec2 -= grad_fvec2 * fVec(lr);
-
-    std::tie(param_bvec, trail_bvec) =
-        at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-    param_bvec.store(param_ptr + d);
-    trail_bvec.store(trail_ptr + d);
-  }
-  for (; d < size; d++) {
-    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], trail_ptr[d]);
-    float grad_val = grad_ptr[d] + param_val * weight_decay;
-    param_val -= grad_val * lr;
-    std::tie(param_ptr[d], trail_ptr[d]) =
-        at::vec::unpack_float_bfloat16(param_val);
-  }
-}
-
 template <typename T>
 inline void AccGradUpdate<T, SGDArgs>::update(
     T* weight,
@@ -89,17 +28,8 @@ inline void AccGradUpdate<T, SGDArgs>::update(
   // grad accumulate
   using acc_t = acc_type<T, true>;
   acc_t grad_acc_buffer[vector_size];
-  zero_ker(grad_acc_buffer, vector_size);
-  for (int r = batched_csc.segment_ptr[uniq_index_id];
-       r < batched_csc.segment_ptr[uniq_index_id + 1];
-       ++r) {
-    T* grad_ptr = &grad[batched_csc.output_row_indices[r] * vector_size];
-    if (batched_csc.weights && batched_csc.weights[r] != 1) {
-      madd_ker(grad_acc_buffer, grad_ptr, vector_size, batched_csc.weights[r]);
-    } else {
-      add_ker(grad_acc_buffer, grad_ptr, vector_size);
-    }
-  }
+  csc_grad_accumulate(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
   // sgd update
   T* weight_ptr = &weight[weight_offsets];
   BFloat16* bf16_trail_ptr = nullptr;
@@ -116,99 +46,75 @@ inline void AccGradUpdate<T, SGDArgs>::update(
       vector_size);
 }
 
-template <typename optimizer_arg_t>
-void merged_embeddingbag_backward_cpu_kernel(
-    const std::vector<Tensor>& grads_y,
+void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
     const Tensor& indices,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
     const Tensor& indices_with_row_offset,
     const Tensor& row_offsets,
     std::vector<int64_t> pooling_modes,
-    const optimizer_arg_t& args) {
+    const std::vector<Tensor>& bf16_trail,
+    double weight_decay,
+    double lr,
+    const std::vector<Tensor>& dedup_mapping) {
   int64_t n_tables = weights.size();
-  int64_t bs = (offsets.numel() - 1) / n_tables;
-  int64_t* row_offset_data = row_offsets.data_ptr<int64_t>();
-  int64_t max_embeddings = row_offset_data[n_tables];
-  BatchedHyperCompressedSparseColumn batched_csc;
-  sort_based_batched_csr2csc_opt(
-      batched_csc,
-      bs,
+  TORCH_CHECK(n_tables == grads_y_.size());
+  auto grads_y = grads_y_;
+  for (auto i = 0; i < n_tables; i++) {
+    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
+    grads_y[i] = grads_y_[i].contiguous();
+  }
+  SGDArgs args = SGDArgs(bf16_trail, weight_decay, lr);
+  merged_embeddingbag_backward_cpu_kernel<SGDArgs>(
+      grads_y,
+      indices,
       offsets,
+      weights,
       indices_with_row_offset,
+      row_offsets,
       pooling_modes,
-      max_embeddings);
-  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
-
-  auto get_table_id = [&](int index) {
-    int table_id = 0;
-    while (index >= row_offset_data[table_id + 1]) {
-      table_id++;
-    }
-    return table_id;
-  };
-
-  int uniq_indice = batched_csc.uniq_indices;
+      dedup_mapping,
+      args);
 
-  std::vector<void*> weights_ptr;
-  std::vector<int64_t> weights_max_offsets;
-  std::vector<void*> grads_ptr;
-  std::vector<ScalarType> dtypes;
+  return;
+}
 
-  for (int i = 0; i < n_tables; i++) {
-    weights_ptr.emplace_back(weights[i].data_ptr());
-    grads_ptr.emplace_back(grads_y[i].data_ptr());
-    dtypes.emplace_back(weights[i].scalar_type());
-    weights_max_offsets.emplace_back(weights[i].size(0) * weights[i].size(1));
+inline void load_float_row(
+    float* out,
+    const Tensor& in,
+    int64_t row,
+    int64_t len) {
+  if (in.scalar_type() == kBFloat16) {
+    at::vec::convert(in.data_ptr<BFloat16>() + row * len, out, len);
+  } else {
+    move_ker(out, in.data_ptr<float>() + row * len, len);
   }
+}
 
-#pragma omp parallel for schedule(static, 1)
-  for (int c = 0; c < uniq_indice; ++c) {
-    int row_index = batched_csc.segment_indices[c];
-    int table_id = get_table_id(row_index);
-    int vector_size = weights[table_id].size(1);
-    int64_t weight_offsets =
-        (row_index - row_offset_data[table_id]) * vector_size;
-    TORCH_CHECK(
-        weight_offsets >= 0 && weight_offsets < weights_max_offsets[table_id]);
-    if (dtypes[table_id] == ScalarType::BFloat16) {
-      AccGradUpdate<BFloat16, optimizer_arg_t>::update(
-          (BFloat16*)weights_ptr[table_id],
-          (BFloat16*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    } else if (dtypes[table_id] == ScalarType::Float) {
-      AccGradUpdate<float, optimizer_arg_t>::update(
-          (float*)weights_ptr[table_id],
-          (float*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    } else {
-      AccGradUpdate<double, optimizer_arg_t>::update(
-          (double*)weights_ptr[table_id],
-          (double*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    }
+inline void store_float_row(
+    Tensor& out,
+    const float* in,
+    int64_t row,
+    int64_t len) {
+  if (out.scalar_type() == kBFloat16) {
+    at::vec::convert(in, out.data_ptr<BFloat16>() + row * len, len);
+  } else {
+    move_ker(out.data_ptr<float>() + row * len, in, len);
   }
-
-  return;
 }
 
-void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
-    const std::vector<Tensor>& grads_y_,
+// The backward of the "dot" interaction of [dense, pooled embeddings] fused
+// with the SGD update of the tables. The grads of the inputs of a sample are
+// computed in fp32 on a tile of its rows: with S the symmetric grads of the
+// pairs, the grad of the feature i is sum_j S_ij x_j, plus the dense part of
+// the output for the dense feature. The grads of the embeddings are written
+// into workspaces of the scratch arena in the layout the CSC traversal reads,
+// instead of the tensors of autograd read back by the update, and only the
+// grad of the dense feature is returned.
+Tensor interaction_backward_merged_embeddingbag_sgd_cpu_kernel_impl(
+    const Tensor& grad_out_,
+    const std::vector<Tensor>& input,
     const Tensor& indices,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
@@ -217,14 +123,99 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     std::vector<int64_t> pooling_modes,
     const std::vector<Tensor>& bf16_trail,
     double weight_decay,
-    double lr) {
+    double lr,
+    const std::vector<Tensor>& dedup_mapping) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
   int64_t n_tables = weights.size();
-  TORCH_CHECK(n_tables == grads_y_.size());
-  auto grads_y = grads_y_;
-  for (auto i = 0; i < n_tables; i++) {
-    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
-    grads_y[i] = grads_y_[i].contiguous();
+  int64_t feature_nums = n_tables + 1;
+  TORCH_CHECK(
+      input.size() == feature_nums,
+      "interaction_backward_merged_embeddingbag_sgd: expect the dense input "
+      "and the outputs of the tables");
+  int64_t batch_size = input[0].size(0);
+  int64_t feature_size = input[0].size(1);
+  auto grad_out = grad_out_.contiguous();
+  auto interact_feature_size = feature_nums * (feature_nums - 1) / 2;
+  auto line_len = interact_feature_size + feature_size;
+  TORCH_CHECK(
+      grad_out.dim() == 2 && grad_out.size(0) == batch_size &&
+      grad_out.size(1) == line_len);
+  std::vector<Tensor> inputs(feature_nums);
+  for (int64_t n = 0; n < feature_nums; n++) {
+    inputs[n] = input[n].contiguous();
+    TORCH_CHECK(
+        inputs[n].scalar_type() == kFloat ||
+            inputs[n].scalar_type() == kBFloat16,
+        "interaction_backward_merged_embeddingbag_sgd only support float and "
+        "bfloat16");
+    TORCH_CHECK(
+        inputs[n].dim() == 2 && inputs[n].size(0) == batch_size &&
+            inputs[n].size(1) == feature_size,
+        "interaction_backward_merged_embeddingbag_sgd: expect all inputs "
+        "have same feature size");
+  }
+  for (int64_t t = 0; t < n_tables; t++) {
+    TORCH_CHECK(weights[t].scalar_type() == inputs[t + 1].scalar_type());
   }
+  TORCH_CHECK(
+      grad_out.scalar_type() == kFloat || grad_out.scalar_type() == kBFloat16);
+
+  auto grad_dense = at::empty_like(inputs[0]);
+  // the workspaces outlive the parallel region, so they are allocated by the
+  // calling thread
+  ScratchScope scratch;
+  std::vector<Tensor> grads_y(n_tables);
+  for (int64_t t = 0; t < n_tables; t++) {
+    grads_y[t] =
+        scratch.empty({batch_size, feature_size}, weights[t].scalar_type());
+  }
+
+  at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
+    using Vec = at::vec::Vectorized<float>;
+    ScratchScope thread_scratch;
+    float* rows = thread_scratch.allocate<float>(feature_nums * feature_size);
+    float* grad_line = thread_scratch.allocate<float>(line_len);
+    float* pair_grads =
+        thread_scratch.allocate<float>(feature_nums * feature_nums);
+    float* grad_row = thread_scratch.allocate<float>(feature_size);
+    for (int64_t b = start; b < end; b++) {
+      for (int64_t n = 0; n < feature_nums; n++) {
+        load_float_row(&rows[n * feature_size], inputs[n], b, feature_size);
+      }
+      load_float_row(grad_line, grad_out, b, line_len);
+      const float* flat = grad_line + feature_size;
+      int64_t k = 0;
+      for (int64_t i = 0; i < feature_nums; i++) {
+        pair_grads[i * feature_nums + i] = 0.f;
+        for (int64_t j = 0; j < i; j++, k++) {
+          pair_grads[i * feature_nums + j] = flat[k];
+          pair_grads[j * feature_nums + i] = flat[k];
+        }
+      }
+      for (int64_t i = 0; i < feature_nums; i++) {
+        if (i == 0) {
+          move_ker(grad_row, grad_line, feature_size);
+        } else {
+          zero_ker(grad_row, feature_size);
+        }
+        for (int64_t j = 0; j < feature_nums; j++) {
+          float s = pair_grads[i * feature_nums + j];
+          if (s == 0.f) {
+            continue;
+          }
+          at::vec::map2<float>(
+              [s](Vec acc, Vec x) { return acc + x * Vec(s); },
+              grad_row,
+              grad_row,
+              &rows[j * feature_size],
+              feature_size);
+        }
+        store_float_row(
+            i == 0 ? grad_dense : grads_y[i - 1], grad_row, b, feature_size);
+      }
+    }
+  });
+
   SGDArgs args = SGDArgs(bf16_trail, weight_decay, lr);
   merged_embeddingbag_backward_cpu_kernel<SGDArgs>(
       grads_y,
@@ -234,9 +225,9 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
       indices_with_row_offset,
       row_offsets,
       pooling_modes,
+      dedup_mapping,
       args);
-
-  return;
+  return grad_dense;
 }
 
 } // anonymous namespace
@@ -244,6 +235,9 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
 REGISTER_DISPATCH(
     merged_embeddingbag_backward_sgd_cpu_kernel_stub,
     &merged_embeddingbag_backward_sgd_cpu_kernel_impl);
+REGISTER_DISPATCH(
+    interaction_backward_merged_embeddingbag_sgd_cpu_kernel_stub,
+    &interaction_backward_merged_embeddingbag_sgd_cpu_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
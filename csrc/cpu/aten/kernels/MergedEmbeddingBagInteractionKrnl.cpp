@@ -0,0 +1,272 @@
+#include <ATen/Parallel.h>
+#include <ATen/Tensor.h>
+#include <ATen/cpu/vec/vec.h>
+#include <ATen/quantized/Quantizer.h>
+#include <aten/MergedEmbeddingBag.h>
+#include <torch/all.h>
+#include "aten/utils/embedding_lookup.h"
+#include "vec/vec.h"
+
+/*
+ Fused MergedEmbeddingBag forward + DLRM "dot" interaction for inference.
+ Each sample pools its embeddings into a small tile ([num_tables + 1, D],
+ the dense feature being row 0) and the triangular dot products are computed
+ on that tile, so the pooled [batch, num_tables, D] activations are never
+ written to memory. The output layout is the same as interaction_forward:
+ [dense, flat lower triangle of tile x tile^T].
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+using namespace torch_ipex::cpu::kernel;
+
+inline float dot_ker(const float* a, const float* b, int64_t len) {
+  using Vec = at::vec::Vectorized<float>;
+  Vec acc_vec(0.f);
+  int64_t d = 0;
+  for (; d < len - (len % Vec::size()); d += Vec::size()) {
+    acc_vec = at::vec::fmadd(Vec::loadu(a + d), Vec::loadu(b + d), acc_vec);
+  }
+  float acc_buf[Vec::size()];
+  acc_vec.store(acc_buf);
+  float acc = 0.f;
+  for (int i = 0; i < Vec::size(); i++) {
+    acc += acc_buf[i];
+  }
+  for (; d < len; d++) {
+    acc += a[d] * b[d];
+  }
+  return acc;
+}
+
+void check_interaction_inputs(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights) {
+  TORCH_CHECK(!weights.empty());
+  TORCH_CHECK(dense.dim() == 2 && dense.is_contiguous());
+  TORCH_CHECK(indices.is_contiguous() && offsets.is_contiguous());
+  TORCH_CHECK(
+      offsets.numel() == weights.size() * dense.size(0) + 1,
+      "merged_embeddingbag_interaction: expect offsets of num_tables x batch_size + 1");
+  for (auto& w : weights) {
+    TORCH_CHECK(w.is_contiguous());
+    TORCH_CHECK(
+        w.scalar_type() == dense.scalar_type(),
+        "merged_embeddingbag_interaction: expect tables have the dtype of dense");
+    TORCH_CHECK(
+        w.size(1) == dense.size(1),
+        "merged_embeddingbag_interaction: expect all inputs have same feature size");
+  }
+}
+
+template <typename T>
+Tensor merged_embeddingbag_interaction_forward_ker(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t>& pooling_modes) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = weights.size();
+  int64_t batch_size = dense.size(0);
+  int64_t feature_size = dense.size(1);
+  int64_t feature_nums = n_tables + 1;
+  auto interact_feature_size = feature_nums * (feature_nums - 1) / 2;
+  auto out_data_line_len = interact_feature_size + feature_size;
+  auto out = at::empty({batch_size, out_data_line_len}, dense.options());
+
+  T* out_data = out.data_ptr<T>();
+  T* dense_data = dense.data_ptr<T>();
+  std::vector<T*> weights_data(n_tables);
+  for (int t = 0; t < n_tables; t++) {
+    weights_data[t] = weights[t].data_ptr<T>();
+  }
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  const bool do_prefetch = get_embedding_prefetch_distance() > 0;
+
+  at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
+    float tile[feature_nums * feature_size] __attribute__((aligned(64)));
+    std::vector<const float*> rows(feature_nums);
+    for (int64_t b = start; b < end; b++) {
+      // prefetch the rows of the next sample while pooling this one, the
+      // prefetch distance setting only switches it on or off here
+      if (do_prefetch && b + 1 < end) {
+        for (int t = 0; t < n_tables; t++) {
+          auto n = t * batch_size + b + 1;
+          for (auto p = offsets_data[n]; p < offsets_data[n + 1]; p++) {
+            prefetch_row(
+                &weights_data[t][indices_data[p] * feature_size],
+                feature_size * sizeof(T));
+          }
+        }
+      }
+      T* dense_row = &dense_data[b * feature_size];
+      if (std::is_same<T, float>::value) {
+        rows[0] = (const float*)dense_row;
+      } else {
+        move_ker(tile, dense_row, feature_size);
+        rows[0] = tile;
+      }
+      for (int t = 0; t < n_tables; t++) {
+        auto n = t * batch_size + b;
+        auto pool_begin = offsets_data[n];
+        auto pool_end = offsets_data[n + 1];
+        T* table = weights_data[t];
+        if (std::is_same<T, float>::value && pool_end - pool_begin == 1) {
+          // single index bag, use the table row in place
+          auto row = &table[indices_data[pool_begin] * feature_size];
+          rows[t + 1] = (const float*)row;
+          continue;
+        }
+        float* pooled = &tile[(t + 1) * feature_size];
+        zero_ker(pooled, feature_size);
+        for (auto p = pool_begin; p < pool_end; p++) {
+          add_ker(pooled, &table[indices_data[p] * feature_size], feature_size);
+        }
+        if (pooling_modes[t] == MEAN && pool_end - pool_begin > 1) {
+          const float scale_factor = 1.0 / (pool_end - pool_begin);
+#pragma omp simd
+          for (int64_t d = 0; d < feature_size; d++) {
+            pooled[d] *= scale_factor;
+          }
+        }
+        rows[t + 1] = pooled;
+      }
+
+      T* out_row = &out_data[b * out_data_line_len];
+      move_ker(out_row, dense_row, feature_size);
+      T* flat_buf = out_row + feature_size;
+      int64_t offset = 0;
+      for (int i = 1; i < feature_nums; i++) {
+        for (int j = 0; j < i; j++) {
+          flat_buf[offset++] = T(dot_ker(rows[i], rows[j], feature_size));
+        }
+      }
+    }
+  });
+  return out;
+}
+
+Tensor merged_embeddingbag_interaction_forward_cpu_kernel_impl(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes) {
+  check_interaction_inputs(dense, indices, offsets, weights);
+  TORCH_CHECK(pooling_modes.size() == weights.size());
+  if (dense.scalar_type() == kFloat) {
+    return merged_embeddingbag_interaction_forward_ker<float>(
+        dense, indices, offsets, weights, pooling_modes);
+  }
+  TORCH_CHECK(
+      dense.scalar_type() == kBFloat16,
+      "merged_embeddingbag_interaction_forward only support float and bfloat16");
+  return merged_embeddingbag_interaction_forward_ker<BFloat16>(
+      dense, indices, offsets, weights, pooling_modes);
+}
+
+// int8 version of the fused op, the composition of dil_qembeddingbag (sum
+// pooling, output in the scale of the table) and dil_qinteraction.
+Tensor merged_embeddingbag_qinteraction_forward_cpu_kernel_impl(
+    const Tensor& dense,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    double o_scale) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  check_interaction_inputs(dense, indices, offsets, weights);
+  TORCH_CHECK(
+      dense.scalar_type() == kQInt8,
+      "merged_embeddingbag_qinteraction_forward expects qint8 inputs");
+  int64_t n_tables = weights.size();
+  int64_t batch_size = dense.size(0);
+  int64_t feature_size = dense.size(1);
+  int64_t feature_nums = n_tables + 1;
+
+  std::vector<float> in_scales(feature_nums);
+  std::vector<int8_t*> input_data(feature_nums);
+  in_scales[0] = at::native::q_scale_quant(dense);
+  input_data[0] = reinterpret_cast<int8_t*>(dense.data_ptr<at::qint8>());
+  for (int t = 0; t < n_tables; t++) {
+    in_scales[t + 1] = at::native::q_scale_quant(weights[t]);
+    input_data[t + 1] =
+        reinterpret_cast<int8_t*>(weights[t].data_ptr<at::qint8>());
+  }
+
+  auto interact_feature_size = feature_nums * (feature_nums - 1) / 2;
+  auto out_data_line_len = interact_feature_size + feature_size;
+  at::QuantizerPtr output_quantizer =
+      at::make_per_tensor_affine_quantizer(o_scale, /*zp=*/0, at::kQInt8);
+  at::Tensor output = at::new_qtensor(
+      /*sizes=*/{batch_size, out_data_line_len},
+      dense.options(),
+      output_quantizer);
+  int8_t* out_data = reinterpret_cast<int8_t*>(output.data_ptr<at::qint8>());
+
+  std::vector<float> out_in_scales(interact_feature_size);
+  int64_t offset = 0;
+  for (int i = 1; i < feature_nums; i++) {
+    for (int j = 0; j < i; j++) {
+      out_in_scales[offset++] = in_scales[i] * in_scales[j] / o_scale;
+    }
+  }
+  float dense_scale = in_scales[0] / o_scale;
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
+    int8_t tile[feature_nums * feature_size] __attribute__((aligned(64)));
+    std::vector<const int8_t*> rows(feature_nums);
+    for (int64_t b = start; b < end; b++) {
+      rows[0] = &input_data[0][b * feature_size];
+      for (int t = 0; t < n_tables; t++) {
+        auto n = t * batch_size + b;
+        auto pool_begin = offsets_data[n];
+        auto pool_end = offsets_data[n + 1];
+        int8_t* table = input_data[t + 1];
+        if (pool_end - pool_begin == 1) {
+          rows[t + 1] = &table[indices_data[pool_begin] * feature_size];
+          continue;
+        }
+        int8_t* pooled = &tile[(t + 1) * feature_size];
+        zero_ker(pooled, feature_size);
+        for (auto p = pool_begin; p < pool_end; p++) {
+          add_ker(pooled, &table[indices_data[p] * feature_size], feature_size);
+        }
+        rows[t + 1] = pooled;
+      }
+
+      int8_t* out_row = &out_data[b * out_data_line_len];
+      scale_and_move_ker(out_row, rows[0], dense_scale, feature_size);
+      int8_t* flat_buf = out_row + feature_size;
+      int64_t k = 0;
+      for (int i = 1; i < feature_nums; i++) {
+        for (int j = 0; j < i; j++, k++) {
+          flat_buf[k] = _dot_s8s8_scale_s32s8(
+              rows[i], rows[j], feature_size, out_in_scales[k]);
+        }
+      }
+    }
+  });
+  return output;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_interaction_forward_cpu_kernel_stub,
+    &merged_embeddingbag_interaction_forward_cpu_kernel_impl);
+REGISTER_DISPATCH(
+    merged_embeddingbag_qinteraction_forward_cpu_kernel_stub,
+    &merged_embeddingbag_qinteraction_forward_cpu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,7 +1,11 @@
 #include <ATen/AccumulateType.h>
 #include <ATen/Tensor.h>
+#include <ATen/quantized/Quantizer.h>
 #include <aten/MergedEmbeddingBag.h>
+#include <omp.h>
 #include <torch/all.h>
+#include "aten/utils/embedding_lookup.h"
+#include "aten/utils/radix_sort.h"
 #include "autocast/autocast_mode.h"
 #include "vec/vec.h"
 
@@ -22,10 +26,23 @@ inline void emb_pooling_ker(
     size_t vector_size,
     int64_t* indices_data,
     int64_t* offsets_data,
-    int64_t pooling_mode) {
+    int64_t pooling_mode,
+    const HotRowCache& cache,
+    int64_t prefetch_distance,
+    int64_t prefetch_end) {
+  // prefetch the row "prefetch_distance" indices ahead; the prefetch target may
+  // belong to a following bag of the same table
+  auto prefetch = [&](int64_t p) {
+    if (prefetch_distance > 0 && p + prefetch_distance < prefetch_end) {
+      prefetch_row(
+          cache.row(in, indices_data[p + prefetch_distance], vector_size),
+          vector_size * sizeof(T));
+    }
+  };
   auto idx = indices_data[pool_begin];
-  auto weight_ptr = &in[idx * vector_size];
+  auto weight_ptr = cache.row(in, idx, vector_size);
   if (pool_end - pool_begin == 1) {
+    prefetch(pool_begin);
     move_ker(out, weight_ptr, vector_size);
   } else {
     using acc_t = acc_type<T, true>;
@@ -34,8 +51,9 @@ inline void emb_pooling_ker(
     acc_t temp_out[vector_size];
     zero_ker(temp_out, vector_size);
     for (auto p = pool_begin; p < pool_end; ++p) {
+      prefetch(p);
       idx = indices_data[p];
-      weight_ptr = &in[idx * vector_size];
+      weight_ptr = cache.row(in, idx, vector_size);
       add_ker(temp_out, weight_ptr, vector_size);
     }
     if (pooling_mode == MEAN) {
@@ -50,11 +68,178 @@ inline void emb_pooling_ker(
   }
 }
 
+// Pool a bag of a compositional table: the row of every index is combined
+// from the rows of the components in an acc_t buffer and added to the bag.
+template <typename T>
+inline void compositional_emb_pooling_ker(
+    T* out,
+    T* const* components,
+    const int64_t* component_rows,
+    const int64_t* divisors,
+    int64_t n_components,
+    int64_t mode,
+    int64_t combine,
+    size_t pool_begin,
+    size_t pool_end,
+    size_t vector_size,
+    int64_t* indices_data,
+    int64_t pooling_mode) {
+  using acc_t = acc_type<T, true>;
+  acc_t temp_out[vector_size];
+  acc_t temp_row[vector_size];
+  zero_ker(temp_out, vector_size);
+  for (auto p = pool_begin; p < pool_end; ++p) {
+    auto idx = indices_data[p];
+    if (combine == COMBINE_ADD) {
+      for (int64_t k = 0; k < n_components; k++) {
+        auto row = compositional_row(
+            idx, mode, k, component_rows[k], divisors[k]);
+        add_ker(temp_out, &components[k][row * vector_size], vector_size);
+      }
+      continue;
+    }
+    auto row = compositional_row(idx, mode, 0, component_rows[0], divisors[0]);
+    zero_ker(temp_row, vector_size);
+    add_ker(temp_row, &components[0][row * vector_size], vector_size);
+    for (int64_t k = 1; k < n_components; k++) {
+      row = compositional_row(idx, mode, k, component_rows[k], divisors[k]);
+      const T* component_ptr = &components[k][row * vector_size];
+#pragma omp simd
+      for (int d = 0; d < vector_size; ++d) {
+        temp_row[d] *= acc_t(component_ptr[d]);
+      }
+    }
+    add_ker(temp_out, temp_row, vector_size);
+  }
+  if (pooling_mode == MEAN && pool_end - pool_begin > 1) {
+    auto L = pool_end - pool_begin;
+    const double scale_factor = 1.0 / L;
+#pragma omp simd
+    for (int d = 0; d < vector_size; ++d) {
+      temp_out[d] = scale_factor * temp_out[d];
+    }
+  }
+  move_ker(out, temp_out, vector_size);
+}
+
+// Row-wise quantized table layout: every row stores its quantized elements
+// followed by a fp32 scale and a fp32 bias, i.e.
+// [q_0, q_1, ..., q_{D-1}, scale(4 bytes), bias(4 bytes)]. For int4 two
+// elements share one byte. The dequantized value is q * scale + bias.
+constexpr int64_t kRowwiseQuantizedTrailBytes = 2 * sizeof(float);
+
+template <int64_t bit_rate>
+inline void emb_pooling_rowwise_quantized_ker(
+    float* out,
+    const uint8_t* in,
+    size_t pool_begin,
+    size_t pool_end,
+    size_t vector_size,
+    int64_t row_bytes,
+    int64_t* indices_data,
+    int64_t pooling_mode) {
+  const int64_t data_bytes = row_bytes - kRowwiseQuantizedTrailBytes;
+  zero_ker(out, vector_size);
+  for (auto p = pool_begin; p < pool_end; ++p) {
+    const uint8_t* row_ptr = &in[indices_data[p] * row_bytes];
+    float scale_bias[2];
+    std::memcpy(scale_bias, row_ptr + data_bytes, sizeof(scale_bias));
+    if (bit_rate == 8) {
+      rowwise_dequant_int8_add_ker(
+          out, row_ptr, scale_bias[0], scale_bias[1], vector_size);
+    } else {
+      rowwise_dequant_int4_add_ker(
+          out, row_ptr, scale_bias[0], scale_bias[1], vector_size);
+    }
+  }
+  if (pooling_mode == MEAN && pool_end - pool_begin > 1) {
+    auto L = pool_end - pool_begin;
+    const float scale_factor = 1.0 / L;
+#pragma omp simd
+    for (int d = 0; d < vector_size; ++d) {
+      out[d] = scale_factor * out[d];
+    }
+  }
+}
+
+void merged_embeddingbag_forward_rowwise_quantized_cpu_kernel(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates,
+    std::vector<Tensor>& outputs) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables > 0);
+  // offsets.numel = [T x B  + 1]
+  int64_t B = (offsets.size(0) - 1) / n_tables;
+  TORCH_CHECK(B >= 0);
+  TORCH_CHECK(indices.is_contiguous());
+  TORCH_CHECK(offsets.is_contiguous());
+
+  std::vector<uint8_t*> weights_ptr;
+  std::vector<int64_t> row_bytes;
+  for (auto& w : weights) {
+    TORCH_CHECK(w.is_contiguous());
+    weights_ptr.emplace_back(w.data_ptr<uint8_t>());
+    row_bytes.emplace_back(w.size(1));
+  }
+
+  std::vector<float*> outs_ptr;
+  for (auto& o : outputs) {
+    outs_ptr.emplace_back(o.data_ptr<float>());
+  }
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+
+  int64_t n_offsets = offsets.numel() - 1;
+  parallel_for(0, n_offsets, 0, [&](int64_t offset_begin, int64_t offset_end) {
+    for (int n = offset_begin; n < offset_end; ++n) {
+      int table_id = 0;
+      int64_t temp_n = n;
+      while (temp_n >= B) {
+        temp_n -= B;
+        table_id += 1;
+      }
+      const auto pool_begin = offsets_data[n];
+      const auto pool_end = offsets_data[n + 1];
+      auto feature_size = outputs[table_id].size(1);
+      float* out_ptr = &outs_ptr[table_id][temp_n * feature_size];
+      if (bit_rates[table_id] == 8) {
+        emb_pooling_rowwise_quantized_ker<8>(
+            out_ptr,
+            weights_ptr[table_id],
+            pool_begin,
+            pool_end,
+            feature_size,
+            row_bytes[table_id],
+            indices_data,
+            pooling_modes[table_id]);
+      } else {
+        emb_pooling_rowwise_quantized_ker<4>(
+            out_ptr,
+            weights_ptr[table_id],
+            pool_begin,
+            pool_end,
+            feature_size,
+            row_bytes[table_id],
+            indices_data,
+            pooling_modes[table_id]);
+      }
+    }
+  });
+  return;
+}
+
 void merged_embeddingbag_forward_cpu_kernel(
     const Tensor& indices,
     const Tensor& offsets,
     const std::vector<Tensor>& weights,
     const std::vector<int64_t> pooling_modes,
+    const std::vector<HotRowCache>& caches,
     std::vector<Tensor>& outputs) {
   RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
 
@@ -84,6 +269,8 @@ void merged_embeddingbag_forward_cpu_kernel(
   const auto offsets_data = offsets.data_ptr<int64_t>();
 
   int64_t n_offsets = offsets.numel() - 1;
+  const int64_t prefetch_distance = get_embedding_prefetch_distance();
+  const HotRowCache no_cache;
   parallel_for(0, n_offsets, 0, [&](int64_t offset_begin, int64_t offset_end) {
     for (int n = offset_begin; n < offset_end; ++n) {
       int table_id = 0;
@@ -95,6 +282,10 @@ void merged_embeddingbag_forward_cpu_kernel(
       const auto pool_begin = offsets_data[n];
       const auto pool_end = offsets_data[n + 1];
       auto feature_size = weights[table_id].size(1);
+      // only prefetch rows of the same table and within this thread's range
+      const int64_t prefetch_end =
+          offsets_data[std::min<int64_t>((table_id + 1) * B, offset_end)];
+      const HotRowCache& cache = caches.empty() ? no_cache : caches[table_id];
       if (dtypes[table_id] == ScalarType::BFloat16) {
         BFloat16* out_ptr =
             &(((BFloat16*)outs_ptr[table_id])[temp_n * feature_size]);
@@ -106,7 +297,10 @@ void merged_embeddingbag_forward_cpu_kernel(
             feature_size,
             indices_data,
             offsets_data,
-            pooling_modes[table_id]);
+            pooling_modes[table_id],
+            cache,
+            prefetch_distance,
+            prefetch_end);
       } else if (dtypes[table_id] == ScalarType::Float) {
         float* out_ptr = &(((float*)outs_ptr[table_id])[temp_n * feature_size]);
         emb_pooling_ker<float>(
@@ -117,7 +311,10 @@ void merged_embeddingbag_forward_cpu_kernel(
             feature_size,
             indices_data,
             offsets_data,
-            pooling_modes[table_id]);
+            pooling_modes[table_id],
+            cache,
+            prefetch_distance,
+            prefetch_end);
       } else {
         double* out_ptr =
             &(((double*)outs_ptr[table_id])[temp_n * feature_size]);
@@ -129,7 +326,10 @@ void merged_embeddingbag_forward_cpu_kernel(
             feature_size,
             indices_data,
             offsets_data,
-            pooling_modes[table_id]);
+            pooling_modes[table_id],
+            cache,
+            prefetch_distance,
+            prefetch_end);
       }
     }
   });
@@ -154,16 +354,707 @@ std::vector<Tensor> merged_embeddingbag_forward_cpu_kernel_impl(
     outputs.emplace_back(empty({bs, feature_size}, w.options()));
   }
   merged_embeddingbag_forward_cpu_kernel(
-      indices, offsets, weights, pooling_modes, outputs);
+      indices, offsets, weights, pooling_modes, {}, outputs);
+
+  return outputs;
+}
+
+// Lookup with deduplicated indices: the rows read by each table are gathered
+// once into a compact buffer (in the order of the sorted unique indices) and
+// the bags are pooled from that buffer. The unique/inverse mapping is also
+// returned in CSC order (see mapping_based_batched_csr2csc), so the backward
+// can build its CSC without sorting the indices again.
+std::tuple<std::vector<Tensor>, std::vector<Tensor>>
+merged_embeddingbag_forward_dedup_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables > 0);
+  int64_t bs = (offsets.numel() - 1) / n_tables;
+  int64_t n_indices = indices.numel();
+  TORCH_CHECK(
+      indices_with_row_offset.is_contiguous() &&
+          indices_with_row_offset.numel() == n_indices,
+      "merged_embeddingbag_forward_dedup: expect contiguous indices_with_row_offset of the same size as indices");
+  TORCH_CHECK(row_offsets.numel() == n_tables + 1);
+  const int64_t* row_offset_data = row_offsets.data_ptr<int64_t>();
+  const int64_t* keys = indices_with_row_offset.data_ptr<int64_t>();
+
+  // sort (index with row offset, position) pairs, the radix sort is stable so
+  // positions stay ascending inside each group
+  CSR2CSCWorkspace& workspace = get_csr2csc_workspace();
+  auto* sort_buf = workspace.get<Key_Value_Weight_Tuple<int>>(
+      CSR2CSCWorkspace::SORT_BUFFER0, n_indices);
+  auto* sort_tmp_buf = workspace.get<Key_Value_Weight_Tuple<int>>(
+      CSR2CSCWorkspace::SORT_BUFFER1, n_indices);
+  at::parallel_for(0, n_indices, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      sort_buf[p] = Key_Value_Weight_Tuple<int>(keys[p], p, 1.f);
+    }
+  });
+  auto* sorted = radix_sort_parallel<int>(
+      sort_buf, sort_tmp_buf, n_indices, row_offset_data[n_tables]);
+
+  // rank of every sorted element among the unique indices
+  Tensor ranks = at::empty({n_indices}, indices.options().dtype(kLong));
+  int64_t* ranks_data = ranks.data_ptr<int64_t>();
+  at::parallel_for(0, n_indices, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      ranks_data[i] =
+          i == 0 || std::get<0>(sorted[i]) != std::get<0>(sorted[i - 1]);
+    }
+  });
+  ranks = ranks.cumsum(0);
+  ranks_data = ranks.data_ptr<int64_t>();
+  int64_t U = n_indices > 0 ? ranks_data[n_indices - 1] : 0;
+
+  auto long_options = indices.options().dtype(kLong);
+  Tensor unique_indices = at::empty({U}, long_options);
+  Tensor segment_ptr = at::empty({U + 1}, long_options);
+  Tensor sorted_positions = at::empty({n_indices}, long_options);
+  int64_t* unique_data = unique_indices.data_ptr<int64_t>();
+  int64_t* segment_ptr_data = segment_ptr.data_ptr<int64_t>();
+  int64_t* sorted_positions_data = sorted_positions.data_ptr<int64_t>();
+  at::parallel_for(0, n_indices, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t r = ranks_data[i] - 1;
+      sorted_positions_data[i] = std::get<1>(sorted[i]);
+      if (i == 0 || ranks_data[i - 1] != ranks_data[i]) {
+        unique_data[r] = std::get<0>(sorted[i]);
+        segment_ptr_data[r] = i;
+      }
+    }
+  });
+  segment_ptr_data[U] = n_indices;
+
+  // the unique indices of a table are contiguous, table t owns
+  // [unique_begin[t], unique_begin[t + 1])
+  std::vector<int64_t> unique_begin(n_tables + 1);
+  for (int t = 0; t <= n_tables; t++) {
+    unique_begin[t] =
+        std::lower_bound(unique_data, unique_data + U, row_offset_data[t]) -
+        unique_data;
+  }
+  auto get_table_id = [&](int64_t c) {
+    return std::upper_bound(unique_begin.begin(), unique_begin.end(), c) -
+        unique_begin.begin() - 1;
+  };
+
+  std::vector<Tensor> compact_weights;
+  std::vector<char*> compact_ptr;
+  std::vector<char*> weights_ptr;
+  std::vector<int64_t> row_bytes;
+  for (int t = 0; t < n_tables; t++) {
+    auto& w = weights[t];
+    auto dtype = w.scalar_type();
+    TORCH_CHECK(
+        kBFloat16 == dtype || kFloat == dtype || kDouble == dtype,
+        "merged_embeddingbag_forward_dedup only support weight dtype in bfloat16, float, double");
+    TORCH_CHECK(w.is_contiguous());
+    int64_t n_unique = unique_begin[t + 1] - unique_begin[t];
+    compact_weights.emplace_back(at::empty({n_unique, w.size(1)}, w.options()));
+    compact_ptr.emplace_back((char*)compact_weights[t].data_ptr());
+    weights_ptr.emplace_back((char*)w.data_ptr());
+    row_bytes.emplace_back(w.size(1) * w.element_size());
+  }
+  // gather every unique row once
+  at::parallel_for(0, U, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      auto t = get_table_id(c);
+      std::memcpy(
+          compact_ptr[t] + (c - unique_begin[t]) * row_bytes[t],
+          weights_ptr[t] + (unique_data[c] - row_offset_data[t]) * row_bytes[t],
+          row_bytes[t]);
+    }
+  });
+  // indices into the compact buffers
+  Tensor compact_indices = at::empty({n_indices}, long_options);
+  int64_t* compact_indices_data = compact_indices.data_ptr<int64_t>();
+  at::parallel_for(0, n_indices, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t r = ranks_data[i] - 1;
+      compact_indices_data[sorted_positions_data[i]] =
+          r - unique_begin[get_table_id(r)];
+    }
+  });
+
+  std::vector<Tensor> outputs;
+  for (auto& w : weights) {
+    outputs.emplace_back(empty({bs, w.size(1)}, w.options()));
+  }
+  merged_embeddingbag_forward_cpu_kernel(
+      compact_indices, offsets, compact_weights, pooling_modes, {}, outputs);
+
+  std::vector<Tensor> dedup_mapping = {
+      unique_indices, segment_ptr, sorted_positions};
+  return std::make_tuple(outputs, dedup_mapping);
+}
+
+std::vector<Tensor>
+merged_embeddingbag_forward_hot_row_cache_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& cache_rows,
+    const std::vector<Tensor>& cache_hash_index) {
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(
+      cache_rows.size() == n_tables && cache_hash_index.size() == n_tables,
+      "merged_embeddingbag_forward_with_hot_row_cache: expect one cache per table");
+  int64_t bs = (offsets.numel() - 1) / n_tables;
+
+  std::vector<Tensor> outputs;
+  std::vector<HotRowCache> caches;
+  for (int i = 0; i < n_tables; i++) {
+    auto& w = weights[i];
+    auto dtype = w.scalar_type();
+    TORCH_CHECK(
+        kBFloat16 == dtype || kFloat == dtype || kDouble == dtype,
+        "merged_embeddingbag_forward_cpu only support weight dtype in bfloat16, float, double");
+    TORCH_CHECK(
+        cache_rows[i].numel() == 0 ||
+            (cache_rows[i].scalar_type() == dtype &&
+             cache_rows[i].size(1) == w.size(1)),
+        "merged_embeddingbag_forward_with_hot_row_cache: cache rows should have the same dtype and feature size as the table");
+    int64_t feature_size = w.size(1);
+    outputs.emplace_back(empty({bs, feature_size}, w.options()));
+    caches.emplace_back(cache_rows[i], cache_hash_index[i]);
+  }
+  merged_embeddingbag_forward_cpu_kernel(
+      indices, offsets, weights, pooling_modes, caches, outputs);
 
   return outputs;
 }
 
+std::vector<Tensor>
+merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates) {
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(
+      bit_rates.size() == n_tables,
+      "merged_embeddingbag_forward_rowwise_quantized: expect one bit rate per table");
+  int64_t bs = (offsets.numel() - 1) / n_tables;
+
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < n_tables; i++) {
+    auto& w = weights[i];
+    TORCH_CHECK(
+        kByte == w.scalar_type() && w.dim() == 2,
+        "merged_embeddingbag_forward_rowwise_quantized only support 2-D uint8 row-wise quantized weight");
+    TORCH_CHECK(
+        bit_rates[i] == 8 || bit_rates[i] == 4,
+        "merged_embeddingbag_forward_rowwise_quantized only support bit rate 8 or 4");
+    int64_t data_bytes = w.size(1) - kRowwiseQuantizedTrailBytes;
+    TORCH_CHECK(
+        data_bytes > 0,
+        "merged_embeddingbag_forward_rowwise_quantized: row is too short to hold scale and bias");
+    int64_t feature_size = data_bytes * (8 / bit_rates[i]);
+    outputs.emplace_back(empty({bs, feature_size}, w.options().dtype(kFloat)));
+  }
+  merged_embeddingbag_forward_rowwise_quantized_cpu_kernel(
+      indices, offsets, weights, pooling_modes, bit_rates, outputs);
+
+  return outputs;
+}
+
+// Lookup over per tensor quantized qint8 tables with qint8 outputs: the rows
+// of a bag are summed in int32 and requantized to the scale of the output of
+// the table (o_scales[t]), so the pooled rows can feed the int8 interaction
+// without going through fp32.
+std::vector<Tensor> merged_embeddingbag_forward_int8_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<double> o_scales) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables > 0);
+  TORCH_CHECK(
+      o_scales.size() == n_tables && pooling_modes.size() == n_tables,
+      "merged_embeddingbag_forward_int8: expect one output scale and one pooling mode per table");
+  int64_t B = (offsets.numel() - 1) / n_tables;
+  TORCH_CHECK(B >= 0);
+  TORCH_CHECK(indices.is_contiguous());
+  TORCH_CHECK(offsets.is_contiguous());
+
+  std::vector<Tensor> outputs;
+  std::vector<const int8_t*> weights_ptr;
+  std::vector<int8_t*> outs_ptr;
+  std::vector<float> w_scales;
+  for (int t = 0; t < n_tables; t++) {
+    auto& w = weights[t];
+    TORCH_CHECK(
+        w.scalar_type() == kQInt8 && w.qscheme() == kPerTensorAffine &&
+            w.dim() == 2 && w.is_contiguous(),
+        "merged_embeddingbag_forward_int8 only support 2-D per tensor quantized qint8 weight");
+    TORCH_CHECK(
+        pooling_modes[t] == SUM || pooling_modes[t] == MEAN,
+        "merged_embeddingbag_forward_int8 only support sum and mean pooling");
+    at::QuantizerPtr output_quantizer =
+        at::make_per_tensor_affine_quantizer(o_scales[t], /*zp=*/0, kQInt8);
+    outputs.emplace_back(
+        at::new_qtensor({B, w.size(1)}, w.options(), output_quantizer));
+    weights_ptr.emplace_back(
+        reinterpret_cast<const int8_t*>(w.data_ptr<at::qint8>()));
+    outs_ptr.emplace_back(
+        reinterpret_cast<int8_t*>(outputs[t].data_ptr<at::qint8>()));
+    w_scales.emplace_back(at::native::q_scale_quant(w) / o_scales[t]);
+  }
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  int64_t n_offsets = offsets.numel() - 1;
+  parallel_for(0, n_offsets, 0, [&](int64_t offset_begin, int64_t offset_end) {
+    for (int64_t n = offset_begin; n < offset_end; ++n) {
+      int64_t table_id = n / B;
+      int64_t b = n % B;
+      const auto pool_begin = offsets_data[n];
+      const auto pool_end = offsets_data[n + 1];
+      auto feature_size = outputs[table_id].size(1);
+      int8_t* out_ptr = &outs_ptr[table_id][b * feature_size];
+      if (pool_begin >= pool_end) {
+        zero_ker(out_ptr, feature_size);
+        continue;
+      }
+      float scale = w_scales[table_id];
+      if (pooling_modes[table_id] == MEAN) {
+        scale /= pool_end - pool_begin;
+      }
+      if (pool_end - pool_begin == 1 && std::abs(scale - 1.f) < 1e-6) {
+        move_ker(
+            out_ptr,
+            &weights_ptr[table_id][indices_data[pool_begin] * feature_size],
+            feature_size);
+      } else {
+        qemb_pooling_ker(
+            out_ptr,
+            weights_ptr[table_id],
+            indices_data,
+            pool_begin,
+            pool_end,
+            feature_size,
+            scale);
+      }
+    }
+  });
+  return outputs;
+}
+
+// One lookup over tables of different feature sizes and dtypes: bit_rates[t]
+// is 0 for a bfloat16/float/double table and 8/4 for a row-wise quantized
+// uint8 table (fp32 output). Instead of splitting the bags evenly, every bag
+// costs rows x dim and each thread of a single parallel region takes a
+// contiguous range of bags of about the same total cost.
+std::vector<Tensor> merged_embeddingbag_forward_mixed_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> bit_rates) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables > 0);
+  TORCH_CHECK(
+      bit_rates.size() == n_tables && pooling_modes.size() == n_tables,
+      "merged_embeddingbag_forward_mixed: expect one pooling mode and bit rate per table");
+  TORCH_CHECK(indices.is_contiguous());
+  TORCH_CHECK(offsets.is_contiguous());
+  int64_t B = (offsets.numel() - 1) / n_tables;
+
+  std::vector<Tensor> outputs;
+  std::vector<void*> weights_ptr;
+  std::vector<void*> outs_ptr;
+  std::vector<int64_t> feature_sizes;
+  for (int t = 0; t < n_tables; t++) {
+    auto& w = weights[t];
+    TORCH_CHECK(w.is_contiguous() && w.dim() == 2);
+    int64_t feature_size = w.size(1);
+    auto out_dtype = w.scalar_type();
+    if (bit_rates[t] == 0) {
+      TORCH_CHECK(
+          kBFloat16 == out_dtype || kFloat == out_dtype || kDouble == out_dtype,
+          "merged_embeddingbag_forward_mixed only support bfloat16, float, double or row-wise quantized uint8 tables");
+    } else {
+      TORCH_CHECK(
+          kByte == w.scalar_type() && (bit_rates[t] == 8 || bit_rates[t] == 4),
+          "merged_embeddingbag_forward_mixed: quantized tables should be uint8 with bit rate 8 or 4");
+      int64_t data_bytes = w.size(1) - kRowwiseQuantizedTrailBytes;
+      TORCH_CHECK(
+          data_bytes > 0,
+          "merged_embeddingbag_forward_mixed: row is too short to hold scale and bias");
+      feature_size = data_bytes * (8 / bit_rates[t]);
+      out_dtype = kFloat;
+    }
+    outputs.emplace_back(
+        empty({B, feature_size}, w.options().dtype(out_dtype)));
+    weights_ptr.emplace_back(w.data_ptr());
+    outs_ptr.emplace_back(outputs[t].data_ptr());
+    feature_sizes.emplace_back(feature_size);
+  }
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  int64_t n_offsets = offsets.numel() - 1;
+
+  // inclusive prefix sum of the bag costs, an empty bag still costs 1 row
+  std::vector<int64_t> cost_ps(n_offsets + 1);
+  cost_ps[0] = 0;
+  for (int64_t n = 0; n < n_offsets; n++) {
+    int64_t rows =
+        std::max<int64_t>(offsets_data[n + 1] - offsets_data[n], 1);
+    cost_ps[n + 1] = cost_ps[n] + rows * feature_sizes[n / B];
+  }
+  const int64_t total_cost = cost_ps[n_offsets];
+  const int64_t prefetch_distance = get_embedding_prefetch_distance();
+  const HotRowCache no_cache;
+
+#pragma omp parallel
+  {
+    int64_t tid = omp_get_thread_num();
+    int64_t num_threads = omp_get_num_threads();
+    auto bag_begin = [&](int64_t k) {
+      return std::lower_bound(
+                 cost_ps.begin(),
+                 cost_ps.begin() + n_offsets,
+                 total_cost * k / num_threads) -
+          cost_ps.begin();
+    };
+    int64_t offset_begin = tid == 0 ? 0 : bag_begin(tid);
+    int64_t offset_end =
+        tid == num_threads - 1 ? n_offsets : bag_begin(tid + 1);
+    for (int64_t n = offset_begin; n < offset_end; ++n) {
+      int64_t table_id = n / B;
+      int64_t temp_n = n % B;
+      const auto pool_begin = offsets_data[n];
+      const auto pool_end = offsets_data[n + 1];
+      auto feature_size = feature_sizes[table_id];
+      auto pooling_mode = pooling_modes[table_id];
+      const int64_t prefetch_end =
+          offsets_data[std::min<int64_t>((table_id + 1) * B, offset_end)];
+      if (bit_rates[table_id] != 0) {
+        float* out_ptr = &((float*)outs_ptr[table_id])[temp_n * feature_size];
+        auto qweight = (uint8_t*)weights_ptr[table_id];
+        auto row_bytes = weights[table_id].size(1);
+        if (bit_rates[table_id] == 8) {
+          emb_pooling_rowwise_quantized_ker<8>(
+              out_ptr,
+              qweight,
+              pool_begin,
+              pool_end,
+              feature_size,
+              row_bytes,
+              indices_data,
+              pooling_mode);
+        } else {
+          emb_pooling_rowwise_quantized_ker<4>(
+              out_ptr,
+              qweight,
+              pool_begin,
+              pool_end,
+              feature_size,
+              row_bytes,
+              indices_data,
+              pooling_mode);
+        }
+      } else if (weights[table_id].scalar_type() == ScalarType::BFloat16) {
+        emb_pooling_ker<BFloat16>(
+            &((BFloat16*)outs_ptr[table_id])[temp_n * feature_size],
+            (BFloat16*)weights_ptr[table_id],
+            pool_begin,
+            pool_end,
+            feature_size,
+            indices_data,
+            offsets_data,
+            pooling_mode,
+            no_cache,
+            prefetch_distance,
+            prefetch_end);
+      } else if (weights[table_id].scalar_type() == ScalarType::Float) {
+        emb_pooling_ker<float>(
+            &((float*)outs_ptr[table_id])[temp_n * feature_size],
+            (float*)weights_ptr[table_id],
+            pool_begin,
+            pool_end,
+            feature_size,
+            indices_data,
+            offsets_data,
+            pooling_mode,
+            no_cache,
+            prefetch_distance,
+            prefetch_end);
+      } else {
+        emb_pooling_ker<double>(
+            &((double*)outs_ptr[table_id])[temp_n * feature_size],
+            (double*)weights_ptr[table_id],
+            pool_begin,
+            pool_end,
+            feature_size,
+            indices_data,
+            offsets_data,
+            pooling_mode,
+            no_cache,
+            prefetch_distance,
+            prefetch_end);
+      }
+    }
+  }
+
+  return outputs;
+}
+
+// Lookup over compositional tables, the bags are split between the threads
+// like merged_embeddingbag_forward_cpu_kernel and every bag reads one row of
+// each component per index.
+std::vector<Tensor> merged_embeddingbag_forward_compositional_cpu_kernel_impl(
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t> pooling_modes,
+    const std::vector<int64_t> num_components,
+    int64_t mode,
+    int64_t combine) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = num_components.size();
+  TORCH_CHECK(n_tables > 0);
+  TORCH_CHECK(
+      pooling_modes.size() == n_tables,
+      "merged_embeddingbag_forward_compositional: expect one pooling mode per table");
+  TORCH_CHECK(
+      combine == COMBINE_MUL || combine == COMBINE_ADD,
+      "merged_embeddingbag_forward_compositional only support mul or add combine");
+  auto components = get_compositional_components(weights, num_components, mode);
+  int64_t B = (offsets.numel() - 1) / n_tables;
+  TORCH_CHECK(B >= 0);
+  TORCH_CHECK(indices.is_contiguous());
+  TORCH_CHECK(offsets.is_contiguous());
+
+  std::vector<Tensor> outputs;
+  std::vector<void*> components_ptr;
+  for (auto& w : weights) {
+    components_ptr.emplace_back(w.data_ptr());
+  }
+  for (int t = 0; t < n_tables; t++) {
+    auto& w = weights[components.begin[t]];
+    auto dtype = w.scalar_type();
+    TORCH_CHECK(
+        kBFloat16 == dtype || kFloat == dtype || kDouble == dtype,
+        "merged_embeddingbag_forward_compositional only support weight dtype in bfloat16, float, double");
+    TORCH_CHECK(
+        pooling_modes[t] == SUM || pooling_modes[t] == MEAN,
+        "merged_embeddingbag_forward_compositional only support sum and mean pooling");
+    outputs.emplace_back(empty({B, w.size(1)}, w.options()));
+  }
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  int64_t n_offsets = offsets.numel() - 1;
+  parallel_for(0, n_offsets, 0, [&](int64_t offset_begin, int64_t offset_end) {
+    for (int64_t n = offset_begin; n < offset_end; ++n) {
+      int64_t table_id = n / B;
+      int64_t b = n % B;
+      const auto pool_begin = offsets_data[n];
+      const auto pool_end = offsets_data[n + 1];
+      int64_t c = components.begin[table_id];
+      auto& output = outputs[table_id];
+      int64_t feature_size = output.size(1);
+      AT_DISPATCH_FLOATING_TYPES_AND(
+          at::ScalarType::BFloat16,
+          output.scalar_type(),
+          "compositional_emb_pooling",
+          [&] {
+            compositional_emb_pooling_ker<scalar_t>(
+                &output.data_ptr<scalar_t>()[b * feature_size],
+                reinterpret_cast<scalar_t* const*>(&components_ptr[c]),
+                &components.rows[c],
+                &components.divisors[c],
+                num_components[table_id],
+                mode,
+                combine,
+                pool_begin,
+                pool_end,
+                feature_size,
+                indices_data,
+                pooling_modes[table_id]);
+          });
+    }
+  });
+
+  return outputs;
+}
+
+template <typename index_t>
+inline void linearize_indices_ker(
+    const index_t* src,
+    int64_t n,
+    int64_t row_offset,
+    int64_t* indices,
+    int64_t* indices_with_row_offsets) {
+  for (int64_t i = 0; i < n; i++) {
+    int64_t index = src[i];
+    indices[i] = index;
+    indices_with_row_offsets[i] = index + row_offset;
+  }
+}
+
+// Concatenates the indices and offsets of the tables into the inputs of the
+// merged lookup in a pass over the indices, split evenly between the threads
+// across the tables, and a pass over the bags: the indices of table t move
+// by the indices of the tables before it, into indices_with_row_offsets also
+// by its first row in the merged table, and its bags follow those of the
+// tables before it.
+std::tuple<Tensor, Tensor, Tensor>
+merged_embeddingbag_linearize_cpu_kernel_impl(
+    const std::vector<Tensor>& indices,
+    const std::vector<Tensor>& offsets,
+    const std::vector<bool>& include_last_offsets,
+    const Tensor& row_offsets) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  int64_t n_tables = indices.size();
+  TORCH_CHECK(n_tables > 0);
+  TORCH_CHECK(
+      offsets.size() == n_tables && include_last_offsets.size() == n_tables &&
+          row_offsets.numel() >= n_tables,
+      "merged_embeddingbag_linearize: expect indices, offsets and include_last_offsets per table");
+  auto row_offsets_ = row_offsets.to(kLong).contiguous();
+  const auto row_offsets_data = row_offsets_.data_ptr<int64_t>();
+
+  std::vector<Tensor> indices_(n_tables), offsets_(n_tables);
+  // the first index and bag of each table in the merged inputs
+  std::vector<int64_t> index_begin(n_tables + 1, 0);
+  int64_t B = -1;
+  for (int64_t t = 0; t < n_tables; t++) {
+    indices_[t] = indices[t].contiguous();
+    TORCH_CHECK(
+        indices_[t].scalar_type() == kLong || indices_[t].scalar_type() == kInt,
+        "merged_embeddingbag_linearize: expect int64 or int32 indices");
+    int64_t batch_size;
+    if (indices_[t].dim() == 2) {
+      TORCH_CHECK(
+          !offsets[t].defined(),
+          "merged_embeddingbag_linearize: offsets should be None for 2-D indices");
+      batch_size = indices_[t].size(0);
+    } else {
+      TORCH_CHECK(
+          indices_[t].dim() == 1 && offsets[t].defined(),
+          "merged_embeddingbag_linearize: expect 1-D indices with offsets or 2-D indices");
+      offsets_[t] = offsets[t].contiguous();
+      TORCH_CHECK(
+          offsets_[t].scalar_type() == kLong ||
+              offsets_[t].scalar_type() == kInt,
+          "merged_embeddingbag_linearize: expect int64 or int32 offsets");
+      batch_size = offsets_[t].numel() - (include_last_offsets[t] ? 1 : 0);
+    }
+    TORCH_CHECK(
+        B == -1 || B == batch_size,
+        "merged_embeddingbag_linearize: only support input with same batch size");
+    B = batch_size;
+    index_begin[t + 1] = index_begin[t] + indices_[t].numel();
+  }
+  const int64_t n_indices = index_begin[n_tables];
+  const int64_t n_offsets = B * n_tables;
+
+  auto merged_indices = empty({n_indices}, indices_[0].options().dtype(kLong));
+  auto merged_indices_with_row_offsets = empty_like(merged_indices);
+  auto merged_offsets = empty({n_offsets + 1}, merged_indices.options());
+  auto indices_data = merged_indices.data_ptr<int64_t>();
+  auto indices_with_row_offsets_data =
+      merged_indices_with_row_offsets.data_ptr<int64_t>();
+  auto offsets_data = merged_offsets.data_ptr<int64_t>();
+
+  at::parallel_for(0, n_indices, 0, [&](int64_t begin, int64_t end) {
+    int64_t t = std::upper_bound(
+                    index_begin.begin(), index_begin.end() - 1, begin) -
+        index_begin.begin() - 1;
+    for (int64_t i = begin; i < end; t++) {
+      int64_t table_end = std::min(end, index_begin[t + 1]);
+      if (table_end == i) {
+        continue;
+      }
+      AT_DISPATCH_INDEX_TYPES(
+          indices_[t].scalar_type(), "linearize_indices", [&] {
+            linearize_indices_ker<index_t>(
+                indices_[t].data_ptr<index_t>() + i - index_begin[t],
+                table_end - i,
+                row_offsets_data[t],
+                indices_data + i,
+                indices_with_row_offsets_data + i);
+          });
+      i = table_end;
+    }
+  });
+
+  at::parallel_for(0, n_offsets, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end;) {
+      int64_t t = n / B;
+      int64_t bag_begin = n % B;
+      int64_t bag_end = std::min(end - t * B, B);
+      if (!offsets_[t].defined()) {
+        int64_t bag_size = indices_[t].size(1);
+        for (int64_t b = bag_begin; b < bag_end; b++) {
+          offsets_data[t * B + b] = index_begin[t] + b * bag_size;
+        }
+      } else {
+        AT_DISPATCH_INDEX_TYPES(
+            offsets_[t].scalar_type(), "linearize_offsets", [&] {
+              const auto src = offsets_[t].data_ptr<index_t>();
+              for (int64_t b = bag_begin; b < bag_end; b++) {
+                offsets_data[t * B + b] = index_begin[t] + src[b];
+              }
+            });
+      }
+      n = t * B + bag_end;
+    }
+  });
+  offsets_data[n_offsets] = n_indices;
+
+  return std::make_tuple(
+      merged_indices, merged_offsets, merged_indices_with_row_offsets);
+}
+
 } // anonymous namespace
 
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_mixed_cpu_kernel_stub,
+    &merged_embeddingbag_forward_mixed_cpu_kernel_impl);
+
 REGISTER_DISPATCH(
     merged_embeddingbag_forward_cpu_kernel_stub,
     &merged_embeddingbag_forward_cpu_kernel_impl);
 
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_dedup_cpu_kernel_stub,
+    &merged_embeddingbag_forward_dedup_cpu_kernel_impl);
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_hot_row_cache_cpu_kernel_stub,
+    &merged_embeddingbag_forward_hot_row_cache_cpu_kernel_impl);
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_stub,
+    &merged_embeddingbag_forward_rowwise_quantized_cpu_kernel_impl);
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_int8_cpu_kernel_stub,
+    &merged_embeddingbag_forward_int8_cpu_kernel_impl);
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_forward_compositional_cpu_kernel_stub,
+    &merged_embeddingbag_forward_compositional_cpu_kernel_impl);
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_linearize_cpu_kernel_stub,
+    &merged_embeddingbag_linearize_cpu_kernel_impl);
+
 } // namespace cpu
 } // namespace torch_ipex
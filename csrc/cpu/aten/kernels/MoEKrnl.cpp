@@ -0,0 +1,298 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/MoE.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+
+/*
+ The T x k (token, expert) assignments, called slots, are sorted by expert so
+ that the tokens of an expert form a contiguous block of rows, read in place
+ from the input through their row index. The GEMM of each expert is cut into
+ tiles of moe_block_m slots x moe_block_n weight rows, taken by the threads
+ from a shared atomic queue, largest experts first, so that the unevenly
+ loaded experts are balanced without a static partition. A tile writes the
+ fp32 results of its slots to a [T * k, N] buffer, and the thread completing
+ the last of the k slots of a token for a block of n combines them into the
+ output, so the dispatch, GEMMs and combine need no barrier in between.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+// rows of the micro kernel
+const int64_t moe_kernel_m = 4;
+const int64_t moe_kernel_n = 4;
+// tile of a task
+const int64_t moe_block_m = 32;
+const int64_t moe_block_n = 64;
+
+inline void load_fvec2(const float* ptr, fVec& a, fVec& b) {
+  a = fVec::loadu(ptr);
+  b = fVec::loadu(ptr + fVec::size());
+}
+
+inline void load_fvec2(const at::BFloat16* ptr, fVec& a, fVec& b) {
+  std::tie(a, b) = at::vec::convert_bfloat16_float(bVec::loadu(ptr));
+}
+
+inline void store_fvec(float* ptr, const fVec& v) {
+  v.store(ptr);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v) {
+  float buf[fVec::size()];
+  v.store(buf);
+  for (int64_t i = 0; i < fVec::size(); i++) {
+    ptr[i] = at::BFloat16(buf[i]);
+  }
+}
+
+inline float reduce_add(const fVec& v) {
+  float buf[fVec::size()];
+  v.store(buf);
+  float sum = 0.f;
+  for (int64_t i = 0; i < fVec::size(); i++) {
+    sum += buf[i];
+  }
+  return sum;
+}
+
+// out[m][0, nb) = x[m] * w[nb, K]^T + bias for the MB rows x[m] / out[m]
+template <typename T, int64_t MB>
+void moe_linear_block(
+    const T* const* x,
+    const T* w,
+    const T* bias,
+    float* const* out,
+    int64_t nb,
+    int64_t K) {
+  constexpr int64_t NB = moe_kernel_n;
+  constexpr int64_t step = 2 * fVec::size();
+  fVec acc[MB][NB];
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t n = 0; n < NB; n++) {
+      acc[m][n] = fVec(0.f);
+    }
+  }
+  int64_t k = 0;
+  for (; k < K - (K % step); k += step) {
+    fVec x0[MB], x1[MB];
+    for (int64_t m = 0; m < MB; m++) {
+      load_fvec2(x[m] + k, x0[m], x1[m]);
+    }
+    for (int64_t n = 0; n < nb; n++) {
+      fVec w0, w1;
+      load_fvec2(w + n * K + k, w0, w1);
+      for (int64_t m = 0; m < MB; m++) {
+        acc[m][n] = at::vec::fmadd(x0[m], w0, acc[m][n]);
+        acc[m][n] = at::vec::fmadd(x1[m], w1, acc[m][n]);
+      }
+    }
+  }
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t n = 0; n < nb; n++) {
+      float sum = reduce_add(acc[m][n]);
+      for (int64_t kk = k; kk < K; kk++) {
+        sum += float(x[m][kk]) * float(w[n * K + kk]);
+      }
+      if (bias) {
+        sum += float(bias[n]);
+      }
+      out[m][n] = sum;
+    }
+  }
+}
+
+template <typename T>
+using moe_linear_block_fn = decltype(&moe_linear_block<T, 1>);
+
+template <typename T>
+moe_linear_block_fn<T> get_moe_linear_block(int64_t MB) {
+  static const moe_linear_block_fn<T> fns[moe_kernel_m] = {
+      moe_linear_block<T, 1>,
+      moe_linear_block<T, 2>,
+      moe_linear_block<T, 3>,
+      moe_linear_block<T, 4>};
+  return fns[MB - 1];
+}
+
+struct MoETask {
+  int64_t expert;
+  // range of the sorted slots
+  int64_t m_begin;
+  int64_t m_end;
+  int64_t n_block;
+};
+
+template <typename T>
+void moe_linear_kernel(
+    const at::Tensor& input,
+    const at::Tensor& topk_ids,
+    const at::Tensor& topk_weights,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  int64_t num_tokens = topk_ids.size(0);
+  int64_t topk = topk_ids.size(1);
+  int64_t E = weight.size(0);
+  int64_t N = weight.size(1);
+  int64_t K = weight.size(2);
+  int64_t num_slots = num_tokens * topk;
+  int64_t num_n_blocks = (N + moe_block_n - 1) / moe_block_n;
+  const int64_t* ids = topk_ids.data_ptr<int64_t>();
+  const float* gates = topk_weights.data_ptr<float>();
+  const T* x = input.data_ptr<T>();
+  const T* w = weight.data_ptr<T>();
+  const T* b = bias.defined() ? bias.data_ptr<T>() : nullptr;
+  T* out = output.data_ptr<T>();
+
+  // dispatch: counting sort of the slots by expert
+  std::vector<int64_t> expert_offsets(E + 1, 0);
+  for (int64_t s = 0; s < num_slots; s++) {
+    expert_offsets[ids[s] + 1]++;
+  }
+  for (int64_t e = 0; e < E; e++) {
+    expert_offsets[e + 1] += expert_offsets[e];
+  }
+  std::vector<int64_t> sorted_slots(num_slots);
+  {
+    std::vector<int64_t> positions(
+        expert_offsets.begin(), expert_offsets.end() - 1);
+    for (int64_t s = 0; s < num_slots; s++) {
+      sorted_slots[positions[ids[s]]++] = s;
+    }
+  }
+
+  std::vector<int64_t> experts(E);
+  std::iota(experts.begin(), experts.end(), 0);
+  std::stable_sort(experts.begin(), experts.end(), [&](int64_t e1, int64_t e2) {
+    return expert_offsets[e1 + 1] - expert_offsets[e1] >
+        expert_offsets[e2 + 1] - expert_offsets[e2];
+  });
+  std::vector<MoETask> tasks;
+  for (auto e : experts) {
+    for (int64_t m = expert_offsets[e]; m < expert_offsets[e + 1];
+         m += moe_block_m) {
+      for (int64_t nb = 0; nb < num_n_blocks; nb++) {
+        tasks.push_back(
+            {e, m, std::min(m + moe_block_m, expert_offsets[e + 1]), nb});
+      }
+    }
+  }
+
+  auto slot_output =
+      at::empty({num_slots, N}, input.options().dtype(at::kFloat));
+  float* slot_out = slot_output.data_ptr<float>();
+  // the number of slots of (token, n block) computed so far
+  std::unique_ptr<std::atomic<int64_t>[]> done(
+      new std::atomic<int64_t>[num_tokens * num_n_blocks]);
+  for (int64_t i = 0; i < num_tokens * num_n_blocks; i++) {
+    done[i].store(0, std::memory_order_relaxed);
+  }
+  std::atomic<int64_t> next_task{0};
+  int64_t num_tasks = tasks.size();
+
+  auto combine = [&](int64_t token, int64_t n_begin, int64_t n_end) {
+    T* out_ptr = out + token * N;
+    int64_t n = n_begin;
+    for (; n < n_end - (n_end - n_begin) % fVec::size(); n += fVec::size()) {
+      fVec sum(0.f);
+      for (int64_t j = 0; j < topk; j++) {
+        sum = at::vec::fmadd(
+            fVec(gates[token * topk + j]),
+            fVec::loadu(slot_out + (token * topk + j) * N + n),
+            sum);
+      }
+      store_fvec(out_ptr + n, sum);
+    }
+    for (; n < n_end; n++) {
+      float sum = 0.f;
+      for (int64_t j = 0; j < topk; j++) {
+        sum += gates[token * topk + j] * slot_out[(token * topk + j) * N + n];
+      }
+      out_ptr[n] = T(sum);
+    }
+  };
+
+  at::parallel_for(
+      0, at::get_num_threads(), 1, [&](int64_t begin, int64_t end) {
+        for (auto thread = begin; thread < end; thread++) {
+          int64_t i;
+          while ((i = next_task.fetch_add(1, std::memory_order_relaxed)) <
+                 num_tasks) {
+            const auto& task = tasks[i];
+            int64_t n_begin = task.n_block * moe_block_n;
+            int64_t n_end = std::min(n_begin + moe_block_n, N);
+            const T* w_expert = w + task.expert * N * K;
+            const T* b_expert = b ? b + task.expert * N : nullptr;
+            for (int64_t n = n_begin; n < n_end; n += moe_kernel_n) {
+              int64_t nb = std::min(moe_kernel_n, n_end - n);
+              for (int64_t m = task.m_begin; m < task.m_end;
+                   m += moe_kernel_m) {
+                int64_t mb = std::min(moe_kernel_m, task.m_end - m);
+                const T* x_rows[moe_kernel_m];
+                float* out_rows[moe_kernel_m];
+                for (int64_t r = 0; r < mb; r++) {
+                  int64_t slot = sorted_slots[m + r];
+                  x_rows[r] = x + slot / topk * K;
+                  out_rows[r] = slot_out + slot * N + n;
+                }
+                get_moe_linear_block<T>(mb)(
+                    x_rows,
+                    w_expert + n * K,
+                    b_expert ? b_expert + n : nullptr,
+                    out_rows,
+                    nb,
+                    K);
+              }
+            }
+            // combine the (token, n block) whose last slot was computed here
+            for (int64_t m = task.m_begin; m < task.m_end; m++) {
+              int64_t token = sorted_slots[m] / topk;
+              if (done[token * num_n_blocks + task.n_block].fetch_add(
+                      1, std::memory_order_acq_rel) == topk - 1) {
+                combine(token, n_begin, n_end);
+              }
+            }
+          }
+        }
+      });
+}
+
+void moe_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& topk_ids,
+    const at::Tensor& topk_weights,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (topk_ids.size(1) == 0) {
+    output.zero_();
+    return;
+  }
+  if (input.scalar_type() == at::kFloat) {
+    moe_linear_kernel<float>(
+        input, topk_ids, topk_weights, weight, bias, output);
+  } else {
+    moe_linear_kernel<at::BFloat16>(
+        input, topk_ids, topk_weights, weight, bias, output);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(moe_linear_kernel_stub, &moe_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
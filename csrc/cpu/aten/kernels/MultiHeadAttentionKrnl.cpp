@@ -1,5 +1,11 @@
 #include <aten/MultiHeadAttention.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "aten/utils/bf32_gemm.h"
+#include "aten/utils/scratch_arena.h"
 #include "mkl.h"
+#include "runtime/ParallelContext.h"
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -10,6 +16,51 @@ namespace {
 const std::vector<int64_t> qsplit_range{767, 191, 31};
 const std::vector<int64_t> qsplit_size{256, 64, 32};
 const int64_t kvsplit_size = 512;
+// additive attention mask values at or below it mask the key out
+const float kMaskedValue = -10000.f;
+
+// Under a small team, e.g. a stream of MultiStreamModule, there are many more
+// q blocks than threads: larger q blocks read every K/V block fewer times, as
+// long as there are still 2 blocks per thread and the scratch of a thread,
+// qk in fp32 and bf16 and the fp32 output rows, stays in its L2.
+inline int64_t adapt_q_split_size(
+    int64_t qSplitSize,
+    int64_t qMaxSize,
+    int64_t num_q_blocks_per_slice,
+    int64_t kvSplitSize,
+    int64_t out_row_bytes) {
+  auto parallel_context = torch_ipex::runtime::get_parallel_context();
+  if (!parallel_context.is_small_team()) {
+    return qSplitSize;
+  }
+  auto fits = [&](int64_t size) {
+    int64_t qSlice = (qMaxSize - 1) / size + 1;
+    return size <= qMaxSize &&
+        num_q_blocks_per_slice * qSlice >= 2 * parallel_context.num_threads &&
+        size * (kvSplitSize * 6 + out_row_bytes) <= parallel_context.l2_bytes;
+  };
+  while (fits(qSplitSize * 2)) {
+    qSplitSize *= 2;
+  }
+  return qSplitSize;
+}
+
+// start rows of the sequences of a padded [batchSize, seqSize, ...] input
+inline std::vector<int64_t> dense_seq_starts(
+    const int64_t& batchSize,
+    const int64_t& seqSize) {
+  std::vector<int64_t> starts(batchSize + 1);
+  for (int64_t i = 0; i <= batchSize; ++i) {
+    starts[i] = i * seqSize;
+  }
+  return starts;
+}
+
+// [qSize, kvSize] bool mask of the keys a causal query row cannot see, the
+// query rows are aligned to the last key rows
+inline at::Tensor causal_mask(const int64_t& qSize, const int64_t& kvSize) {
+  return at::ones({qSize, kvSize}, at::kBool).triu(kvSize - qSize + 1);
+}
 
 #if defined(CPU_CAPABILITY_AVX512)
 using namespace torch_ipex::cpu::kernel;
@@ -106,6 +157,14 @@ void _mha_mul_softmax_bf16_kernel(
   }
 }
 
+// Key/value carry num_kv_head heads, shared by num_head / num_kv_head query
+// heads each (GQA/MQA, num_kv_head == num_head for MHA).
+// Sequence i of the batch is rows [qStart[i], qStart[i + 1]) of query and
+// rows [kvStart[i], kvStart[i + 1]) of key/value, so padded batches
+// (qStart[i] = i * qSize) and packed varlen inputs share the kernel. The
+// output is [total query rows, hiddenSize]. With "is_causal", query row r
+// attends key rows c <= r + kvLen - qLen; the key blocks above the diagonal
+// are skipped and only the diagonal blocks are masked.
 at::Tensor sd_mha_base_kernel(
     at::BFloat16* query,
     at::BFloat16* key,
@@ -113,105 +172,183 @@ at::Tensor sd_mha_base_kernel(
     const int64_t& qStride,
     const int64_t& kStride,
     const int64_t& vStride,
-    const int64_t& batchSize,
-    const int64_t& qSize,
-    const int64_t& kvSize,
+    const std::vector<int64_t>& qStart,
+    const std::vector<int64_t>& kvStart,
     const int64_t& num_head,
+    const int64_t& num_kv_head,
     const int64_t& headSize,
     const int64_t& hiddenSize,
-    const double& scale) {
-  at::Tensor output = at::empty({batchSize, qSize, hiddenSize}, at::kBFloat16);
+    const double& scale,
+    const bool is_causal) {
+  TORCH_CHECK(
+      num_kv_head > 0 && num_head % num_kv_head == 0,
+      "flash MHA expects the number of query heads to be a multiple of the kv heads");
+  // query heads sharing one kv head (GQA/MQA)
+  int64_t group_size = num_head / num_kv_head;
+  int64_t batchSize = qStart.size() - 1;
+  int64_t qMaxSize = 0, kvMaxSize = 0;
+  for (int i = 0; i < batchSize; ++i) {
+    qMaxSize = std::max(qMaxSize, qStart[i + 1] - qStart[i]);
+    kvMaxSize = std::max(kvMaxSize, kvStart[i + 1] - kvStart[i]);
+    TORCH_CHECK(
+        !is_causal || kvStart[i + 1] - kvStart[i] >= qStart[i + 1] - qStart[i],
+        "causal flash MHA expects no less key than query tokens per sequence");
+  }
+  at::Tensor output =
+      at::empty({qStart[batchSize], hiddenSize}, at::kBFloat16);
+  if (qMaxSize == 0) {
+    return output;
+  }
 
-  int64_t qSplitSize = qSize;
+  int64_t qSplitSize = qMaxSize;
   for (int i = 0; i < qsplit_range.size(); ++i) {
-    if (qSize > qsplit_range[i]) {
+    if (qMaxSize > qsplit_range[i]) {
       qSplitSize = qsplit_size[i];
       break;
     }
   }
-  int64_t kvSplitSize = kvSize >= kvsplit_size ? kvsplit_size : kvSize;
+  int64_t kvSplitSize = kvMaxSize >= kvsplit_size
+      ? kvsplit_size
+      : std::max<int64_t>(kvMaxSize, 1);
+  qSplitSize = adapt_q_split_size(
+      qSplitSize,
+      qMaxSize,
+      batchSize * num_kv_head,
+      kvSplitSize,
+      group_size * headSize * sizeof(float));
 
-  int64_t qSlice = (qSize - 1) / qSplitSize + 1;
-  int64_t qTail = (qSize - 1) % qSplitSize + 1;
-  int64_t kvSlice = (kvSize - 1) / kvSplitSize + 1;
-  int64_t kvTail = (kvSize - 1) % kvSplitSize + 1;
+  int64_t qSlice = (qMaxSize - 1) / qSplitSize + 1;
 
   int64_t num_thread = omp_get_max_threads();
 
+  ScratchScope scratch;
   at::Tensor qk_fp32 =
-      at::empty({num_thread, qSplitSize, kvSplitSize}, at::kFloat);
+      scratch.empty({num_thread, qSplitSize, kvSplitSize}, at::kFloat);
   at::Tensor qk_bf16 =
-      at::empty({num_thread, qSplitSize, kvSplitSize}, at::kBFloat16);
-  at::Tensor qk_max = at::empty({num_thread, qSplitSize}, at::kFloat);
-  at::Tensor qk_sum = at::empty({num_thread, qSplitSize}, at::kFloat);
-  at::Tensor dst_fp32 =
-      at::empty({num_thread, qSplitSize, headSize}, at::kFloat);
+      scratch.empty({num_thread, qSplitSize, kvSplitSize}, at::kBFloat16);
+  at::Tensor qk_max =
+      scratch.empty({num_thread, group_size, qSplitSize}, at::kFloat);
+  at::Tensor qk_sum =
+      scratch.empty({num_thread, group_size, qSplitSize}, at::kFloat);
+  at::Tensor dst_fp32 = scratch.empty(
+      {num_thread, group_size, qSplitSize, headSize}, at::kFloat);
 
+  // The heads of a group are computed together, key block by key block, so
+  // every K/V block is streamed from memory once for the whole group.
 #pragma omp parallel for collapse(3)
   for (int i = 0; i < batchSize; ++i) {
-    for (int j = 0; j < num_head; ++j) {
+    for (int h = 0; h < num_kv_head; ++h) {
       for (int k = 0; k < qSlice; ++k) {
-        int qBlockSize = (k == qSlice - 1) ? qTail : qSplitSize;
+        int64_t qSize = qStart[i + 1] - qStart[i];
+        int64_t kvSize = kvStart[i + 1] - kvStart[i];
+        if (k * qSplitSize >= qSize) {
+          continue;
+        }
+        int qBlockSize = std::min(qSplitSize, qSize - k * qSplitSize);
         int ompIdx = omp_get_thread_num();
-        _init_mha_buffer_kernel(
-            qk_max.data_ptr<float>() + ompIdx * qSplitSize,
-            qk_sum.data_ptr<float>() + ompIdx * qSplitSize,
-            qBlockSize);
+        if (kvSize == 0) {
+          for (int r = 0; r < qBlockSize; ++r) {
+            std::fill_n(
+                output.data_ptr<at::BFloat16>() +
+                    (qStart[i] + k * qSplitSize + r) * hiddenSize +
+                    headSize * h * group_size,
+                headSize * group_size,
+                at::BFloat16(0));
+          }
+          continue;
+        }
+        float* max_data =
+            qk_max.data_ptr<float>() + ompIdx * group_size * qSplitSize;
+        float* sum_data =
+            qk_sum.data_ptr<float>() + ompIdx * group_size * qSplitSize;
+        float* dst_data = dst_fp32.data_ptr<float>() +
+            ompIdx * group_size * qSplitSize * headSize;
+        float* qk_data =
+            qk_fp32.data_ptr<float>() + ompIdx * qSplitSize * kvSplitSize;
+        at::BFloat16* qk_bf16_data = qk_bf16.data_ptr<at::BFloat16>() +
+            ompIdx * qSplitSize * kvSplitSize;
+        _init_mha_buffer_kernel(max_data, sum_data, group_size * qBlockSize);
 
+        int64_t kvSlice = (kvSize - 1) / kvSplitSize + 1;
+        // last key row visible to the last query row of the block
+        int64_t causalEnd = k * qSplitSize + qBlockSize - 1 + kvSize - qSize;
         for (int l = 0; l < kvSlice; ++l) {
-          int kvBlockSize = (l == kvSlice - 1) ? kvTail : kvSplitSize;
-          cblas_gemm_bf16bf16f32(
-              CblasRowMajor,
-              CblasNoTrans,
-              CblasTrans,
-              qBlockSize,
-              kvBlockSize,
-              headSize,
-              1.f,
-              (const MKL_BF16*)(query + i * qSize * qStride + headSize * j + k * qSplitSize * qStride),
-              qStride,
-              (const MKL_BF16*)(key + i * kvSize * kStride + headSize * j + l * kvSplitSize * kStride),
-              kStride,
-              0.f,
-              qk_fp32.data_ptr<float>() + ompIdx * qSplitSize * kvSplitSize,
-              kvBlockSize);
+          if (is_causal && l * kvSplitSize > causalEnd) {
+            // fully masked, so are the following blocks
+            break;
+          }
+          int kvBlockSize = std::min(kvSplitSize, kvSize - l * kvSplitSize);
+          for (int g = 0; g < group_size; ++g) {
+            int64_t j = h * group_size + g;
+            cblas_gemm_bf16bf16f32(
+                CblasRowMajor,
+                CblasNoTrans,
+                CblasTrans,
+                qBlockSize,
+                kvBlockSize,
+                headSize,
+                1.f,
+                (const MKL_BF16*)(query + qStart[i] * qStride + headSize * j + k * qSplitSize * qStride),
+                qStride,
+                (const MKL_BF16*)(key + kvStart[i] * kStride + headSize * h + l * kvSplitSize * kStride),
+                kStride,
+                0.f,
+                qk_data,
+                kvBlockSize);
+            if (is_causal &&
+                l * kvSplitSize + kvBlockSize - 1 >
+                    k * qSplitSize + kvSize - qSize) {
+              // diagonal block
+              for (int r = 0; r < qBlockSize; ++r) {
+                int64_t last = k * qSplitSize + r + kvSize - qSize -
+                    l * kvSplitSize;
+                for (int64_t c = std::max<int64_t>(last + 1, 0);
+                     c < kvBlockSize;
+                     ++c) {
+                  qk_data[r * kvBlockSize + c] =
+                      -std::numeric_limits<float>::infinity();
+                }
+              }
+            }
 
-          _mha_mul_softmax_bf16_kernel<at::BFloat16>(
-              qk_fp32.data_ptr<float>() + ompIdx * qSplitSize * kvSplitSize,
-              qk_bf16.data_ptr<at::BFloat16>() +
-                  ompIdx * qSplitSize * kvSplitSize,
-              dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
-              qk_max.data_ptr<float>() + ompIdx * qSplitSize,
-              qk_sum.data_ptr<float>() + ompIdx * qSplitSize,
-              scale,
-              qBlockSize,
-              kvBlockSize,
-              headSize,
-              l);
+            _mha_mul_softmax_bf16_kernel<at::BFloat16>(
+                qk_data,
+                qk_bf16_data,
+                dst_data + g * qSplitSize * headSize,
+                max_data + g * qBlockSize,
+                sum_data + g * qBlockSize,
+                scale,
+                qBlockSize,
+                kvBlockSize,
+                headSize,
+                l);
 
-          cblas_gemm_bf16bf16f32(
-              CblasRowMajor,
-              CblasNoTrans,
-              CblasNoTrans,
+            cblas_gemm_bf16bf16f32(
+                CblasRowMajor,
+                CblasNoTrans,
+                CblasNoTrans,
+                qBlockSize,
+                headSize,
+                kvBlockSize,
+                1.f,
+                (const MKL_BF16*)(qk_bf16_data),
+                kvBlockSize,
+                (const MKL_BF16*)(value + kvStart[i] * vStride + headSize * h + l * kvSplitSize * vStride),
+                vStride,
+                l == 0 ? 0.f : 1.f,
+                dst_data + g * qSplitSize * headSize,
+                headSize);
+          }
+        }
+        for (int g = 0; g < group_size; ++g) {
+          _reorder_mha_output_kernel<at::BFloat16>(
+              dst_data + g * qSplitSize * headSize,
+              output.data_ptr<at::BFloat16>() + qStart[i] * hiddenSize +
+                  headSize * (h * group_size + g) + k * qSplitSize * hiddenSize,
               qBlockSize,
               headSize,
-              kvBlockSize,
-              1.f,
-              (const MKL_BF16*)(qk_bf16.data_ptr<at::BFloat16>() + ompIdx * qSplitSize * kvSplitSize),
-              kvBlockSize,
-              (const MKL_BF16*)(value + i * kvSize * vStride + headSize * j + l * kvSplitSize * vStride),
-              vStride,
-              l == 0 ? 0.f : 1.f,
-              dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
-              headSize);
+              hiddenSize);
         }
-        _reorder_mha_output_kernel<at::BFloat16>(
-            dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
-            output.data_ptr<at::BFloat16>() + i * qSize * hiddenSize +
-                headSize * j + k * qSplitSize * hiddenSize,
-            qBlockSize,
-            headSize,
-            hiddenSize);
       }
     }
   }
@@ -246,6 +383,12 @@ at::Tensor bert_mha_kernel_impl(
   }
   int64_t kvSplitSize =
       sequenceSize >= kvsplit_size ? kvsplit_size : sequenceSize;
+  qSplitSize = adapt_q_split_size(
+      qSplitSize,
+      sequenceSize,
+      batchSize * num_head,
+      kvSplitSize,
+      headSize * sizeof(float));
 
   int64_t qSlice = (sequenceSize - 1) / qSplitSize + 1;
   int64_t qTail = (sequenceSize - 1) % qSplitSize + 1;
@@ -254,14 +397,35 @@ at::Tensor bert_mha_kernel_impl(
 
   int64_t num_thread = omp_get_max_threads();
 
+  ScratchScope scratch;
   at::Tensor qk_fp32 =
-      at::empty({num_thread, qSplitSize, kvSplitSize}, at::kFloat);
+      scratch.empty({num_thread, qSplitSize, kvSplitSize}, at::kFloat);
   at::Tensor qk_bf16 =
-      at::empty({num_thread, qSplitSize, kvSplitSize}, at::kBFloat16);
-  at::Tensor qk_max = at::empty({num_thread, qSplitSize}, at::kFloat);
-  at::Tensor qk_sum = at::empty({num_thread, qSplitSize}, at::kFloat);
+      scratch.empty({num_thread, qSplitSize, kvSplitSize}, at::kBFloat16);
+  at::Tensor qk_max = scratch.empty({num_thread, qSplitSize}, at::kFloat);
+  at::Tensor qk_sum = scratch.empty({num_thread, qSplitSize}, at::kFloat);
   at::Tensor dst_fp32 =
-      at::empty({num_thread, qSplitSize, headSize}, at::kFloat);
+      scratch.empty({num_thread, qSplitSize, headSize}, at::kFloat);
+
+  // key blocks whose additive mask is fully masked (e.g. padding) are
+  // skipped, unless all the key blocks of the sequence are masked
+  std::vector<char> kv_block_masked(batchSize * kvSlice, 0);
+  auto rel_kv_data = rel_kv.data_ptr<at::BFloat16>();
+  for (int i = 0; i < batchSize; ++i) {
+    bool all_masked = true;
+    for (int l = 0; l < kvSlice; ++l) {
+      int kvBlockSize = (l == kvSlice - 1) ? kvTail : kvSplitSize;
+      auto mask = rel_kv_data + i * sequenceSize + l * kvSplitSize;
+      kv_block_masked[i * kvSlice + l] = std::all_of(
+          mask, mask + kvBlockSize, [](const at::BFloat16& m) {
+            return float(m) <= kMaskedValue;
+          });
+      all_masked = all_masked && kv_block_masked[i * kvSlice + l];
+    }
+    if (all_masked) {
+      std::fill_n(kv_block_masked.begin() + i * kvSlice, kvSlice, 0);
+    }
+  }
 
 #pragma omp parallel for collapse(3)
   for (int i = 0; i < batchSize; ++i) {
@@ -274,7 +438,12 @@ at::Tensor bert_mha_kernel_impl(
             qk_sum.data_ptr<float>() + ompIdx * qSplitSize,
             qBlockSize);
 
+        // index of the key block among the ones not skipped
+        int idx = 0;
         for (int l = 0; l < kvSlice; ++l) {
+          if (kv_block_masked[i * kvSlice + l]) {
+            continue;
+          }
           int kvBlockSize = (l == kvSlice - 1) ? kvTail : kvSplitSize;
           cblas_gemm_bf16bf16f32(
               CblasRowMajor,
@@ -297,15 +466,14 @@ at::Tensor bert_mha_kernel_impl(
               qk_bf16.data_ptr<at::BFloat16>() +
                   ompIdx * qSplitSize * kvSplitSize,
               dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
-              rel_kv.data_ptr<at::BFloat16>() + i * sequenceSize +
-                  l * qSplitSize,
+              rel_kv_data + i * sequenceSize + l * kvSplitSize,
               qk_max.data_ptr<float>() + ompIdx * qSplitSize,
               qk_sum.data_ptr<float>() + ompIdx * qSplitSize,
               dim_per_head,
               qBlockSize,
               kvBlockSize,
               headSize,
-              l);
+              idx);
 
           cblas_gemm_bf16bf16f32(
               CblasRowMajor,
@@ -319,9 +487,10 @@ at::Tensor bert_mha_kernel_impl(
               kvBlockSize,
               (const MKL_BF16*)(qkv.data_ptr<at::BFloat16>() + i * sequenceSize * qkvColSize + hiddenSize * 2 + headSize * j + l * kvSplitSize * qkvColSize),
               qkvColSize,
-              l == 0 ? 0.f : 1.f,
+              idx == 0 ? 0.f : 1.f,
               dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
               headSize);
+          idx++;
         }
         _reorder_mha_output_kernel<at::BFloat16>(
             dst_fp32.data_ptr<float>() + ompIdx * qSplitSize * headSize,
@@ -358,7 +527,8 @@ at::Tensor sd_mha_kernel_v1_impl(
     const at::Tensor& qkv,
     const int64_t& num_head,
     const int64_t& headSize,
-    const double& scale) {
+    const double& scale,
+    const bool is_causal) {
   TORCH_CHECK(
       qkv.dtype() == at::kBFloat16,
       "Currently the Stable-Diffusion MHA fusion only supports BF16 data type.");
@@ -376,13 +546,15 @@ at::Tensor sd_mha_kernel_v1_impl(
       qkvStride,
       qkvStride,
       qkvStride,
-      batchSize,
-      sequenceSize,
-      sequenceSize,
+      dense_seq_starts(batchSize, sequenceSize),
+      dense_seq_starts(batchSize, sequenceSize),
+      num_head,
       num_head,
       headSize,
       hiddenSize,
-      scale);
+      scale,
+      is_causal)
+      .view({batchSize, sequenceSize, hiddenSize});
 #endif
   auto qkv_mat = dil_mat_split<at::BFloat16>(
       qkv, at::IntArrayRef({hiddenSize, hiddenSize, hiddenSize}));
@@ -395,8 +567,13 @@ at::Tensor sd_mha_kernel_v1_impl(
       .transpose_(2, 3);
   value.resize_({batchSize, sequenceSize, num_head, headSize}).transpose_(1, 2);
 
-  auto qk = at::matmul(query, key);
-  qk = at::softmax(at::mul(qk, scale), -1);
+  auto qk = at::mul(at::matmul(query, key), scale);
+  if (is_causal) {
+    qk.masked_fill_(
+        causal_mask(sequenceSize, sequenceSize),
+        -std::numeric_limits<float>::infinity());
+  }
+  qk = at::softmax(qk, -1);
   auto output = at::matmul(qk, value);
 
   output = output.transpose_(1, 2).contiguous().resize_(
@@ -410,7 +587,8 @@ at::Tensor sd_mha_kernel_v2_impl(
     const at::Tensor& value,
     const int64_t& num_head,
     const int64_t& headSize,
-    const double& scale) {
+    const double& scale,
+    const bool is_causal) {
   TORCH_CHECK(
       (query.dtype() == at::kBFloat16 && key.dtype() == at::kBFloat16 &&
        value.dtype() == at::kBFloat16),
@@ -423,6 +601,13 @@ at::Tensor sd_mha_kernel_v2_impl(
   int64_t qSize = query.size(1);
   int64_t kvSize = value.size(1);
   int64_t hiddenSize = num_head * headSize;
+  // key/value may have less heads than query (GQA/MQA)
+  int64_t num_kv_head = key.size(-1) / headSize;
+  TORCH_CHECK(
+      key.size(-1) == num_kv_head * headSize &&
+          value.size(-1) == key.size(-1) && num_kv_head > 0 &&
+          num_head % num_kv_head == 0,
+      "Stable-Diffusion MHA fusion expects key/value of num_kv_head x headSize where num_head is a multiple of num_kv_head");
 #if defined(CPU_CAPABILITY_AVX512)
   return sd_mha_base_kernel(
       query.data_ptr<at::BFloat16>(),
@@ -431,34 +616,1086 @@ at::Tensor sd_mha_kernel_v2_impl(
       qStride,
       kStride,
       vStride,
-      batchSize,
-      qSize,
-      kvSize,
+      dense_seq_starts(batchSize, qSize),
+      dense_seq_starts(batchSize, kvSize),
       num_head,
+      num_kv_head,
       headSize,
       hiddenSize,
-      scale);
+      scale,
+      is_causal)
+      .view({batchSize, qSize, hiddenSize});
 #endif
   query.resize_({batchSize, qSize, num_head, headSize}).transpose_(1, 2);
-  key.resize_({batchSize, kvSize, num_head, headSize})
+  key.resize_({batchSize, kvSize, num_kv_head, headSize})
       .transpose_(1, 2)
       .transpose_(2, 3);
-  value.resize_({batchSize, kvSize, num_head, headSize}).transpose_(1, 2);
+  value.resize_({batchSize, kvSize, num_kv_head, headSize}).transpose_(1, 2);
 
-  auto qk = at::matmul(query, key);
-  qk = at::softmax(at::mul(qk, scale), -1);
-  auto output = at::matmul(qk, value);
+  auto qk = at::mul(
+      at::matmul(query, key.repeat_interleave(num_head / num_kv_head, 1)),
+      scale);
+  if (is_causal) {
+    qk.masked_fill_(
+        causal_mask(qSize, kvSize), -std::numeric_limits<float>::infinity());
+  }
+  qk = at::softmax(qk, -1);
+  auto output =
+      at::matmul(qk, value.repeat_interleave(num_head / num_kv_head, 1));
 
   output = output.transpose_(1, 2).contiguous().resize_(
       {batchSize, qSize, hiddenSize});
   return output;
 }
 
+at::Tensor flash_mha_varlen_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& cu_seqlens_q,
+    const at::Tensor& cu_seqlens_kv,
+    const int64_t& num_head,
+    const int64_t& headSize,
+    const double& scale,
+    const bool is_causal) {
+  TORCH_CHECK(
+      (query.dtype() == at::kBFloat16 && key.dtype() == at::kBFloat16 &&
+       value.dtype() == at::kBFloat16),
+      "Currently the varlen flash MHA only supports BF16 data type.");
+  TORCH_CHECK(
+      query.dim() == 2 && key.dim() == 2 && value.dim() == 2 &&
+          query.stride(-1) == 1 && key.stride(-1) == 1 &&
+          value.stride(-1) == 1,
+      "varlen flash MHA expects packed [total_tokens, hidden] inputs");
+  TORCH_CHECK(
+      cu_seqlens_q.numel() == cu_seqlens_kv.numel() && cu_seqlens_q.numel() > 0,
+      "varlen flash MHA expects cu_seqlens_q and cu_seqlens_kv of batch + 1");
+  auto cu_q = cu_seqlens_q.to(at::kLong).contiguous();
+  auto cu_kv = cu_seqlens_kv.to(at::kLong).contiguous();
+  std::vector<int64_t> qStart(
+      cu_q.data_ptr<int64_t>(), cu_q.data_ptr<int64_t>() + cu_q.numel());
+  std::vector<int64_t> kvStart(
+      cu_kv.data_ptr<int64_t>(), cu_kv.data_ptr<int64_t>() + cu_kv.numel());
+  TORCH_CHECK(
+      qStart.back() == query.size(0) && kvStart.back() == key.size(0) &&
+          key.size(0) == value.size(0),
+      "varlen flash MHA expects cu_seqlens to end with the number of tokens");
+  int64_t hiddenSize = num_head * headSize;
+  int64_t num_kv_head = key.size(-1) / headSize;
+  TORCH_CHECK(
+      key.size(-1) == num_kv_head * headSize &&
+          value.size(-1) == key.size(-1) && num_kv_head > 0 &&
+          num_head % num_kv_head == 0,
+      "varlen flash MHA expects key/value of num_kv_head x head_size where head_num is a multiple of num_kv_head");
+#if defined(CPU_CAPABILITY_AVX512)
+  return sd_mha_base_kernel(
+      query.data_ptr<at::BFloat16>(),
+      key.data_ptr<at::BFloat16>(),
+      value.data_ptr<at::BFloat16>(),
+      query.stride(0),
+      key.stride(0),
+      value.stride(0),
+      qStart,
+      kvStart,
+      num_head,
+      num_kv_head,
+      headSize,
+      hiddenSize,
+      scale,
+      is_causal);
+#endif
+  auto output = at::empty({query.size(0), hiddenSize}, query.options());
+  for (int64_t i = 0; i + 1 < qStart.size(); ++i) {
+    int64_t qSize = qStart[i + 1] - qStart[i];
+    int64_t kvSize = kvStart[i + 1] - kvStart[i];
+    auto q = query.narrow(0, qStart[i], qSize)
+                 .view({qSize, num_head, headSize})
+                 .transpose(0, 1);
+    auto k = key.narrow(0, kvStart[i], kvSize)
+                 .view({kvSize, num_kv_head, headSize})
+                 .permute({1, 2, 0})
+                 .repeat_interleave(num_head / num_kv_head, 0);
+    auto v = value.narrow(0, kvStart[i], kvSize)
+                 .view({kvSize, num_kv_head, headSize})
+                 .transpose(0, 1)
+                 .repeat_interleave(num_head / num_kv_head, 0);
+    auto qk = at::mul(at::matmul(q, k), scale);
+    if (is_causal) {
+      qk.masked_fill_(
+          causal_mask(qSize, kvSize), -std::numeric_limits<float>::infinity());
+    }
+    output.narrow(0, qStart[i], qSize)
+        .copy_(at::matmul(at::softmax(qk, -1), v)
+                   .transpose(0, 1)
+                   .reshape({qSize, hiddenSize}));
+  }
+  return output;
+}
+
+// Paged KV cache decode attention. The cached tokens of a sequence are split
+// into partitions of kv_partition_size tokens (split-K), every (sequence,
+// kv head, partition) task computes the partial softmax(q * K^T) * V of all
+// the query heads sharing the kv head, so every cached K/V row is read once
+// per group. The partial results are merged with their max and exp sum.
+const int64_t kv_partition_size = 512;
+const int64_t kv_partition_max_size = 8192;
+
+// The partitions only make the tasks of few sequences and kv heads spread
+// over the team. A small team is busy with larger partitions, up to one per
+// sequence, which save the partial results and their merge.
+inline int64_t get_kv_partition_size(
+    int64_t num_seq_heads,
+    int64_t max_context_len) {
+  auto parallel_context = torch_ipex::runtime::get_parallel_context();
+  int64_t wanted_partitions = std::max<int64_t>(
+      (2 * parallel_context.num_threads + num_seq_heads - 1) / num_seq_heads,
+      1);
+  int64_t partition_size =
+      (max_context_len + wanted_partitions - 1) / wanted_partitions;
+  partition_size = (partition_size + kv_partition_size - 1) /
+      kv_partition_size * kv_partition_size;
+  return std::min(
+      std::max(partition_size, kv_partition_size), kv_partition_max_size);
+}
+
+template <typename T>
+inline at::vec::Vectorized<float> load_as_float_vec(const T* ptr) {
+  return at::vec::Vectorized<float>::loadu(ptr);
+}
+
+template <>
+inline at::vec::Vectorized<float> load_as_float_vec<at::BFloat16>(
+    const at::BFloat16* ptr) {
+  using fVec = at::vec::Vectorized<float>;
+  auto bvec = at::vec::Vectorized<at::BFloat16>::loadu(ptr, fVec::size());
+  return std::get<0>(at::vec::convert_bfloat16_float(bvec));
+}
+
+template <typename T>
+inline float qk_dot_ker(const float* q, const T* k, int64_t len) {
+  using fVec = at::vec::Vectorized<float>;
+  fVec acc_vec(0.f);
+  int64_t d = 0;
+  for (; d < len - (len % fVec::size()); d += fVec::size()) {
+    acc_vec =
+        at::vec::fmadd(fVec::loadu(q + d), load_as_float_vec(k + d), acc_vec);
+  }
+  float acc_buf[fVec::size()];
+  acc_vec.store(acc_buf);
+  float acc = 0.f;
+  for (int i = 0; i < fVec::size(); i++) {
+    acc += acc_buf[i];
+  }
+  for (; d < len; d++) {
+    acc += q[d] * float(k[d]);
+  }
+  return acc;
+}
+
+// out += p * v
+template <typename T>
+inline void pv_fmadd_ker(float* out, float p, const T* v, int64_t len) {
+  using fVec = at::vec::Vectorized<float>;
+  fVec p_vec(p);
+  int64_t d = 0;
+  for (; d < len - (len % fVec::size()); d += fVec::size()) {
+    auto out_vec =
+        at::vec::fmadd(p_vec, load_as_float_vec(v + d), fVec::loadu(out + d));
+    out_vec.store(out + d);
+  }
+  for (; d < len; d++) {
+    out[d] += p * float(v[d]);
+  }
+}
+
+// The decode attention of one query token per sequence against its cached
+// tokens, the key/value of token t of sequence s (head kv_h) being at
+// token_offset(s, t) + kv_h * head_size of the caches, e.g. in the blocks of
+// a paged cache or in the beam rows of a contiguous one.
+template <typename T, typename TokenOffset>
+at::Tensor decode_attention_kernel(
+    const at::Tensor& query,
+    T* k_data,
+    T* v_data,
+    const int64_t* context_lens_data,
+    int64_t num_kv_heads,
+    double scale,
+    const TokenOffset& token_offset) {
+  int64_t num_seqs = query.size(0);
+  int64_t num_heads = query.size(1);
+  int64_t head_size = query.size(2);
+  int64_t group_size = num_heads / num_kv_heads;
+
+  auto output = at::empty_like(query);
+  int64_t max_context_len = 0;
+  for (int64_t s = 0; s < num_seqs; s++) {
+    max_context_len = std::max(max_context_len, context_lens_data[s]);
+  }
+  if (max_context_len == 0) {
+    return output.zero_();
+  }
+  int64_t partition_size =
+      get_kv_partition_size(num_seqs * num_kv_heads, max_context_len);
+  int64_t max_partitions =
+      (max_context_len + partition_size - 1) / partition_size;
+
+  // [num_seqs, num_heads, max_partitions], partial max and exp sum
+  auto part_max = at::empty(
+      {num_seqs, num_heads, max_partitions}, query.options().dtype(at::kFloat));
+  auto part_sum = at::empty_like(part_max);
+  // [num_seqs, num_heads, max_partitions, head_size], unnormalized output
+  auto part_out = at::empty(
+      {num_seqs, num_heads, max_partitions, head_size},
+      query.options().dtype(at::kFloat));
+
+  T* q_data = query.data_ptr<T>();
+  T* out_data = output.data_ptr<T>();
+  float* part_max_data = part_max.data_ptr<float>();
+  float* part_sum_data = part_sum.data_ptr<float>();
+  float* part_out_data = part_out.data_ptr<float>();
+
+  at::parallel_for(
+      0,
+      num_seqs * num_kv_heads * max_partitions,
+      0,
+      [&](int64_t begin, int64_t end) {
+        float q_buf[group_size * head_size];
+        ScratchScope scratch;
+        float* logits = scratch.allocate<float>(group_size * partition_size);
+        for (int64_t task = begin; task < end; task++) {
+          int64_t p = task % max_partitions;
+          int64_t kv_h = task / max_partitions % num_kv_heads;
+          int64_t s = task / max_partitions / num_kv_heads;
+          int64_t context_len = context_lens_data[s];
+          int64_t token_begin = p * partition_size;
+          int64_t token_end =
+              std::min(token_begin + partition_size, context_len);
+          int64_t part_idx =
+              (s * num_heads + kv_h * group_size) * max_partitions + p;
+          if (token_begin >= context_len) {
+            for (int64_t g = 0; g < group_size; g++) {
+              part_max_data[part_idx + g * max_partitions] =
+                  -std::numeric_limits<float>::infinity();
+              part_sum_data[part_idx + g * max_partitions] = 0.f;
+            }
+            continue;
+          }
+          int64_t n_tokens = token_end - token_begin;
+          for (int64_t g = 0; g < group_size; g++) {
+            T* q = q_data + (s * num_heads + kv_h * group_size + g) * head_size;
+            for (int64_t d = 0; d < head_size; d++) {
+              q_buf[g * head_size + d] = float(q[d]) * scale;
+            }
+          }
+          auto kv_offset = [&](int64_t t) {
+            return token_offset(s, t) + kv_h * head_size;
+          };
+
+          // q * K^T, every key row is shared by the heads of the group
+          for (int64_t t = token_begin; t < token_end; t++) {
+            T* k = k_data + kv_offset(t);
+            for (int64_t g = 0; g < group_size; g++) {
+              logits[g * partition_size + t - token_begin] =
+                  qk_dot_ker(q_buf + g * head_size, k, head_size);
+            }
+          }
+          for (int64_t g = 0; g < group_size; g++) {
+            float* l = logits + g * partition_size;
+            float max_val = -std::numeric_limits<float>::infinity();
+            for (int64_t i = 0; i < n_tokens; i++) {
+              max_val = std::max(max_val, l[i]);
+            }
+            float sum_val = 0.f;
+            for (int64_t i = 0; i < n_tokens; i++) {
+              l[i] = std::exp(l[i] - max_val);
+              sum_val += l[i];
+            }
+            part_max_data[part_idx + g * max_partitions] = max_val;
+            part_sum_data[part_idx + g * max_partitions] = sum_val;
+            float* out = part_out_data +
+                (part_idx + g * max_partitions) * head_size;
+            std::fill_n(out, head_size, 0.f);
+          }
+          // exp(q * K^T - max) * V
+          for (int64_t t = token_begin; t < token_end; t++) {
+            T* v = v_data + kv_offset(t);
+            for (int64_t g = 0; g < group_size; g++) {
+              float* out = part_out_data +
+                  (part_idx + g * max_partitions) * head_size;
+              pv_fmadd_ker(
+                  out,
+                  logits[g * partition_size + t - token_begin],
+                  v,
+                  head_size);
+            }
+          }
+        }
+      });
+
+  // merge the partitions
+  at::parallel_for(0, num_seqs * num_heads, 0, [&](int64_t begin, int64_t end) {
+    float acc[head_size];
+    for (int64_t idx = begin; idx < end; idx++) {
+      int64_t s = idx / num_heads;
+      T* out = out_data + idx * head_size;
+      int64_t n_parts =
+          (context_lens_data[s] + partition_size - 1) / partition_size;
+      if (n_parts == 0) {
+        std::fill_n(out, head_size, T(0));
+        continue;
+      }
+      float* m = part_max_data + idx * max_partitions;
+      float* l = part_sum_data + idx * max_partitions;
+      float global_max = *std::max_element(m, m + n_parts);
+      float global_sum = 0.f;
+      std::fill_n(acc, head_size, 0.f);
+      for (int64_t p = 0; p < n_parts; p++) {
+        float factor = std::exp(m[p] - global_max);
+        global_sum += l[p] * factor;
+        pv_fmadd_ker(
+            acc,
+            factor,
+            part_out_data + (idx * max_partitions + p) * head_size,
+            head_size);
+      }
+      float inv_sum = 1.f / global_sum;
+      for (int64_t d = 0; d < head_size; d++) {
+        out[d] = T(acc[d] * inv_sum);
+      }
+    }
+  });
+  return output;
+}
+
+template <typename T>
+at::Tensor paged_attention_decode_kernel(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& block_tables,
+    const at::Tensor& context_lens,
+    double scale) {
+  int64_t num_seqs = query.size(0);
+  int64_t block_size = key_cache.size(1);
+  int64_t num_kv_heads = key_cache.size(2);
+  int64_t max_blocks_per_seq = block_tables.size(1);
+  int64_t token_stride = num_kv_heads * query.size(2);
+  int64_t block_stride = block_size * token_stride;
+  auto context_lens_data = context_lens.data_ptr<int64_t>();
+  for (int64_t s = 0; s < num_seqs; s++) {
+    TORCH_CHECK(
+        context_lens_data[s] >= 0 &&
+            context_lens_data[s] <= max_blocks_per_seq * block_size,
+        "paged_attention_decode: context length exceeds the block table");
+  }
+  auto block_tables_data = block_tables.data_ptr<int64_t>();
+  auto token_offset = [&](int64_t s, int64_t t) {
+    int64_t* block_table = block_tables_data + s * max_blocks_per_seq;
+    return block_table[t / block_size] * block_stride +
+        t % block_size * token_stride;
+  };
+  return decode_attention_kernel<T>(
+      query,
+      key_cache.data_ptr<T>(),
+      value_cache.data_ptr<T>(),
+      context_lens_data,
+      num_kv_heads,
+      scale,
+      token_offset);
+}
+
+// Token t of sequence s is in the row beam_table[t][s] of the step t of the
+// [max_len, num_rows, num_kv_heads, head_size] caches
+template <typename T>
+at::Tensor beam_attention_decode_kernel(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& beam_table,
+    int64_t seq_len,
+    double scale) {
+  int64_t num_seqs = query.size(0);
+  int64_t num_rows = key_cache.size(1);
+  int64_t num_kv_heads = key_cache.size(2);
+  int64_t token_stride = num_kv_heads * query.size(2);
+  auto beam_table_data = beam_table.data_ptr<int64_t>();
+  for (int64_t i = 0; i < seq_len * num_seqs; i++) {
+    TORCH_CHECK(
+        beam_table_data[i] >= 0 && beam_table_data[i] < num_rows,
+        "beam_attention_decode: beam index out of the cache rows");
+  }
+  std::vector<int64_t> context_lens(num_seqs, seq_len);
+  auto token_offset = [&](int64_t s, int64_t t) {
+    return (t * num_rows + beam_table_data[t * num_seqs + s]) * token_stride;
+  };
+  return decode_attention_kernel<T>(
+      query,
+      key_cache.data_ptr<T>(),
+      value_cache.data_ptr<T>(),
+      context_lens.data(),
+      num_kv_heads,
+      scale,
+      token_offset);
+}
+
+at::Tensor paged_attention_decode_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& block_tables,
+    const at::Tensor& context_lens,
+    double scale) {
+  TORCH_CHECK(
+      query.dim() == 3 && key_cache.dim() == 4,
+      "paged_attention_decode: expect query of [num_seqs, num_heads, head_size] and caches of [num_blocks, block_size, num_kv_heads, head_size]");
+  TORCH_CHECK(
+      key_cache.sizes() == value_cache.sizes(),
+      "paged_attention_decode: expect key and value caches of the same shape");
+  TORCH_CHECK(
+      key_cache.size(3) == query.size(2) &&
+          query.size(1) % key_cache.size(2) == 0,
+      "paged_attention_decode: expect num_heads to be a multiple of num_kv_heads and the same head_size");
+  TORCH_CHECK(
+      query.scalar_type() == key_cache.scalar_type() &&
+          query.scalar_type() == value_cache.scalar_type(),
+      "paged_attention_decode: expect query and caches of the same dtype");
+  TORCH_CHECK(
+      block_tables.dim() == 2 && block_tables.size(0) == query.size(0) &&
+          context_lens.numel() == query.size(0),
+      "paged_attention_decode: expect one block table and context length per sequence");
+  auto q = query.contiguous();
+  auto k = key_cache.contiguous();
+  auto v = value_cache.contiguous();
+  auto tables = block_tables.to(at::kLong).contiguous();
+  auto lens = context_lens.to(at::kLong).contiguous();
+  if (query.scalar_type() == at::kFloat) {
+    return paged_attention_decode_kernel<float>(q, k, v, tables, lens, scale);
+  }
+  TORCH_CHECK(
+      query.scalar_type() == at::kBFloat16,
+      "paged_attention_decode only supports float and bfloat16");
+  return paged_attention_decode_kernel<at::BFloat16>(
+      q, k, v, tables, lens, scale);
+}
+
+at::Tensor beam_attention_decode_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& beam_table,
+    int64_t seq_len,
+    double scale) {
+  TORCH_CHECK(
+      query.dim() == 3 && key_cache.dim() == 4,
+      "beam_attention_decode: expect query of [num_seqs, num_heads, head_size] and caches of [max_len, num_rows, num_kv_heads, head_size]");
+  TORCH_CHECK(
+      key_cache.sizes() == value_cache.sizes() && key_cache.is_contiguous() &&
+          value_cache.is_contiguous(),
+      "beam_attention_decode: expect contiguous key and value caches of the same shape");
+  TORCH_CHECK(
+      key_cache.size(3) == query.size(2) &&
+          query.size(1) % key_cache.size(2) == 0,
+      "beam_attention_decode: expect num_heads to be a multiple of num_kv_heads and the same head_size");
+  TORCH_CHECK(
+      query.scalar_type() == key_cache.scalar_type() &&
+          query.scalar_type() == value_cache.scalar_type(),
+      "beam_attention_decode: expect query and caches of the same dtype");
+  TORCH_CHECK(
+      beam_table.dim() == 2 && beam_table.size(0) == key_cache.size(0) &&
+          beam_table.size(1) == query.size(0),
+      "beam_attention_decode: expect a beam table of [max_len, num_seqs]");
+  TORCH_CHECK(
+      seq_len >= 0 && seq_len <= key_cache.size(0),
+      "beam_attention_decode: sequence length exceeds the caches");
+  auto q = query.contiguous();
+  auto table = beam_table.to(at::kLong).contiguous();
+  if (query.scalar_type() == at::kFloat) {
+    return beam_attention_decode_kernel<float>(
+        q, key_cache, value_cache, table, seq_len, scale);
+  }
+  TORCH_CHECK(
+      query.scalar_type() == at::kBFloat16,
+      "beam_attention_decode only supports float and bfloat16");
+  return beam_attention_decode_kernel<at::BFloat16>(
+      q, key_cache, value_cache, table, seq_len, scale);
+}
+
+void paged_attention_update_cache_kernel_impl(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const at::Tensor& slot_mapping) {
+  TORCH_CHECK(
+      key_cache.is_contiguous() && value_cache.is_contiguous(),
+      "paged_attention_update_cache: expect contiguous caches");
+  TORCH_CHECK(
+      key.dim() == 3 && key.sizes() == value.sizes() &&
+          key.size(1) == key_cache.size(2) && key.size(2) == key_cache.size(3),
+      "paged_attention_update_cache: expect key/value of [num_tokens, num_kv_heads, head_size]");
+  TORCH_CHECK(
+      slot_mapping.numel() == key.size(0),
+      "paged_attention_update_cache: expect one slot per token");
+  auto k = key.to(key_cache.scalar_type()).contiguous();
+  auto v = value.to(value_cache.scalar_type()).contiguous();
+  auto slots = slot_mapping.to(at::kLong).contiguous();
+  auto slots_data = slots.data_ptr<int64_t>();
+  int64_t num_tokens = key.size(0);
+  int64_t num_slots = key_cache.size(0) * key_cache.size(1);
+  int64_t token_bytes = key.size(1) * key.size(2) * key_cache.element_size();
+  auto k_src = static_cast<char*>(k.data_ptr());
+  auto v_src = static_cast<char*>(v.data_ptr());
+  auto k_dst = static_cast<char*>(key_cache.data_ptr());
+  auto v_dst = static_cast<char*>(value_cache.data_ptr());
+  at::parallel_for(0, num_tokens, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t slot = slots_data[i];
+      if (slot < 0) {
+        continue;
+      }
+      TORCH_CHECK(
+          slot < num_slots,
+          "paged_attention_update_cache: slot out of range");
+      std::memcpy(
+          k_dst + slot * token_bytes, k_src + i * token_bytes, token_bytes);
+      std::memcpy(
+          v_dst + slot * token_bytes, v_src + i * token_bytes, token_bytes);
+    }
+  });
+}
+
+// Flash attention for training. Every (batch, head) is computed in fp32 over
+// [fa_q_block, fa_kv_block] tiles: the forward runs the online softmax and
+// saves lse = max + log(sum) of every query row, the backward recomputes
+// P = exp(q * k^T * scale - lse) per tile and walks the key blocks in the
+// outer loop, so dK/dV of a key block are finished before the next one and
+// dQ is accumulated in place.
+const int64_t fa_q_block = 64;
+const int64_t fa_kv_block = 128;
+
+inline void check_flash_attention_inputs(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    bool is_causal) {
+  TORCH_CHECK(
+      query.dim() == 4 && key.dim() == 4 && value.dim() == 4,
+      "flash_attention: expect query/key/value of [batch, heads, seq, head_size]");
+  TORCH_CHECK(
+      key.sizes() == value.sizes() && query.size(0) == key.size(0) &&
+          query.size(1) == key.size(1) && query.size(3) == key.size(3),
+      "flash_attention: expect query/key/value of the same batch, heads and head_size");
+  TORCH_CHECK(
+      query.scalar_type() == key.scalar_type() &&
+          query.scalar_type() == value.scalar_type() &&
+          (query.scalar_type() == at::kFloat ||
+           query.scalar_type() == at::kBFloat16),
+      "flash_attention only supports float and bfloat16 inputs of the same dtype");
+  TORCH_CHECK(
+      !is_causal || key.size(2) >= query.size(2),
+      "flash_attention: causal attention expects kv length >= q length");
+}
+
+// number of the keys the query rows [0, row_end) can see
+inline int64_t causal_kv_end(
+    int64_t row_end,
+    int64_t qSize,
+    int64_t kvSize,
+    bool is_causal) {
+  return is_causal ? std::min(kvSize, row_end + kvSize - qSize) : kvSize;
+}
+
+template <typename T>
+inline T quantize_val(float x, float inv_scale, int32_t zp) {
+  float q = std::nearbyint(x * inv_scale) + zp;
+  q = std::min(
+      std::max(q, static_cast<float>(std::numeric_limits<T>::min())),
+      static_cast<float>(std::numeric_limits<T>::max()));
+  return static_cast<T>(q);
+}
+
+// Flash MHA of the int8 fused qkv, one query row at a time against key
+// blocks of fa_kv_block: the scores (q - zp) . (k - zp) are exact in int32,
+// the online softmax runs in fp32 and the probs exp(s - max) of (0, 1] are
+// quantized with the scale of 1 / 255, so P . (v - zp) is accumulated in
+// int32 too before being scaled into the fp32 output row.
+template <typename T, typename To>
+void bert_mha_int8_kernel(
+    const T* qkv,
+    const float* mask,
+    int64_t batchSize,
+    int64_t seqSize,
+    int64_t num_head,
+    int64_t headSize,
+    float qkv_scale,
+    int32_t qkv_zp,
+    float dim_per_head,
+    float o_scale,
+    int32_t o_zp,
+    To* out) {
+  const int64_t hiddenSize = num_head * headSize;
+  const int64_t qkvColSize = hiddenSize * 3;
+  const float qk_scale = qkv_scale * qkv_scale / dim_per_head;
+  const float pv_scale = qkv_scale / 255.f;
+  const float inv_o_scale = 1.f / o_scale;
+  const int64_t qBlocks = (seqSize + fa_q_block - 1) / fa_q_block;
+
+  at::parallel_for(
+      0, batchSize * num_head * qBlocks, 0, [&](int64_t begin, int64_t end) {
+        std::vector<float> qk(fa_kv_block);
+        std::vector<int32_t> pv(headSize);
+        std::vector<float> dst(headSize);
+        for (int64_t task = begin; task < end; task++) {
+          int64_t i = task / (num_head * qBlocks);
+          int64_t j = task / qBlocks % num_head;
+          int64_t m = task % qBlocks * fa_q_block;
+          int64_t qBlockSize = std::min(fa_q_block, seqSize - m);
+          const T* k_base =
+              qkv + i * seqSize * qkvColSize + hiddenSize + j * headSize;
+          const T* v_base = k_base + hiddenSize;
+          const float* mask_row = mask + i * seqSize;
+          for (int64_t r = m; r < m + qBlockSize; r++) {
+            const T* q_row = qkv + (i * seqSize + r) * qkvColSize +
+                j * headSize;
+            float row_max = -std::numeric_limits<float>::infinity();
+            float row_sum = 0.f;
+            std::fill(dst.begin(), dst.end(), 0.f);
+            for (int64_t n = 0; n < seqSize; n += fa_kv_block) {
+              int64_t kvBlockSize = std::min(fa_kv_block, seqSize - n);
+              float blk_max = row_max;
+              for (int64_t c = 0; c < kvBlockSize; c++) {
+                const T* k_row = k_base + (n + c) * qkvColSize;
+                int32_t acc = 0;
+#pragma omp simd reduction(+ : acc)
+                for (int64_t d = 0; d < headSize; d++) {
+                  acc += (static_cast<int32_t>(q_row[d]) - qkv_zp) *
+                      (static_cast<int32_t>(k_row[d]) - qkv_zp);
+                }
+                qk[c] = acc * qk_scale + mask_row[n + c];
+                blk_max = std::max(blk_max, qk[c]);
+              }
+              float factor = std::exp(row_max - blk_max);
+              int32_t p_sum = 0;
+              std::fill(pv.begin(), pv.end(), 0);
+              for (int64_t c = 0; c < kvBlockSize; c++) {
+                int32_t p = static_cast<int32_t>(
+                    std::nearbyint(std::exp(qk[c] - blk_max) * 255.f));
+                if (p == 0) {
+                  continue;
+                }
+                p_sum += p;
+                const T* v_row = v_base + (n + c) * qkvColSize;
+#pragma omp simd
+                for (int64_t d = 0; d < headSize; d++) {
+                  pv[d] += p * (static_cast<int32_t>(v_row[d]) - qkv_zp);
+                }
+              }
+              row_sum = row_sum * factor + p_sum / 255.f;
+#pragma omp simd
+              for (int64_t d = 0; d < headSize; d++) {
+                dst[d] = dst[d] * factor + pv[d] * pv_scale;
+              }
+              row_max = blk_max;
+            }
+            // the max of the row is quantized to 255, so row_sum >= 1
+            float inv_sum = 1.f / row_sum;
+            To* out_row = out + (i * seqSize + r) * hiddenSize + j * headSize;
+            for (int64_t d = 0; d < headSize; d++) {
+              out_row[d] =
+                  quantize_val<To>(dst[d] * inv_sum, inv_o_scale, o_zp);
+            }
+          }
+        }
+      });
+}
+
+template <typename T, typename To>
+void bert_mha_int8_dispatch(
+    const at::Tensor& qkv,
+    const at::Tensor& mask,
+    int64_t num_head,
+    int64_t headSize,
+    double dim_per_head,
+    at::Tensor& output) {
+  bert_mha_int8_kernel<T, To>(
+      reinterpret_cast<const T*>(qkv.data_ptr()),
+      mask.data_ptr<float>(),
+      qkv.size(0),
+      qkv.size(1),
+      num_head,
+      headSize,
+      qkv.q_scale(),
+      qkv.q_zero_point(),
+      dim_per_head,
+      output.q_scale(),
+      output.q_zero_point(),
+      reinterpret_cast<To*>(output.data_ptr()));
+}
+
+at::Tensor bert_mha_int8_kernel_impl(
+    const at::Tensor& qkv,
+    const at::Tensor& rel_kv,
+    int64_t num_head,
+    int64_t headSize,
+    double dim_per_head,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  TORCH_CHECK(
+      (qkv.scalar_type() == at::kQUInt8 || qkv.scalar_type() == at::kQInt8) &&
+          qkv.qscheme() == at::kPerTensorAffine,
+      "bert_flash_mha_int8 expects a per tensor quantized qkv");
+  TORCH_CHECK(
+      o_dtype == at::kQUInt8 || o_dtype == at::kQInt8,
+      "bert_flash_mha_int8 only supports quint8 and qint8 output");
+  TORCH_CHECK(
+      qkv.size(-1) == num_head * headSize * 3,
+      "bert_flash_mha_int8 expects qkv of [batch, seq, 3 * head_num * head_size]");
+  auto qkv_ = qkv.dim() > 2 ? qkv.contiguous() : qkv.unsqueeze(0).contiguous();
+  int64_t batchSize = qkv_.size(0);
+  int64_t sequenceSize = qkv_.size(1);
+  auto mask = rel_kv.to(at::kFloat).contiguous();
+  TORCH_CHECK(
+      mask.numel() == batchSize * sequenceSize,
+      "bert_flash_mha_int8 expects an additive mask of [batch, seq]");
+  auto output = at::_empty_affine_quantized(
+      {batchSize, sequenceSize, num_head, headSize},
+      qkv_.options().dtype(o_dtype),
+      o_scale,
+      o_zp);
+  bool u8_in = qkv_.scalar_type() == at::kQUInt8;
+  bool u8_out = o_dtype == at::kQUInt8;
+  if (u8_in && u8_out) {
+    bert_mha_int8_dispatch<uint8_t, uint8_t>(
+        qkv_, mask, num_head, headSize, dim_per_head, output);
+  } else if (u8_in) {
+    bert_mha_int8_dispatch<uint8_t, int8_t>(
+        qkv_, mask, num_head, headSize, dim_per_head, output);
+  } else if (u8_out) {
+    bert_mha_int8_dispatch<int8_t, uint8_t>(
+        qkv_, mask, num_head, headSize, dim_per_head, output);
+  } else {
+    bert_mha_int8_dispatch<int8_t, int8_t>(
+        qkv_, mask, num_head, headSize, dim_per_head, output);
+  }
+  return output;
+}
+
+std::tuple<at::Tensor, at::Tensor> flash_attention_forward_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double scale,
+    bool is_causal) {
+  check_flash_attention_inputs(query, key, value, is_causal);
+  int64_t batchSize = query.size(0);
+  int64_t num_head = query.size(1);
+  int64_t qSize = query.size(2);
+  int64_t kvSize = key.size(2);
+  int64_t headSize = query.size(3);
+  auto q = query.to(at::kFloat).contiguous();
+  auto k = key.to(at::kFloat).contiguous();
+  auto v = value.to(at::kFloat).contiguous();
+  auto out = at::empty({batchSize, num_head, qSize, headSize}, q.options());
+  auto lse = at::empty({batchSize, num_head, qSize}, q.options());
+  float* q_data = q.data_ptr<float>();
+  float* k_data = k.data_ptr<float>();
+  float* v_data = v.data_ptr<float>();
+  float* out_data = out.data_ptr<float>();
+  float* lse_data = lse.data_ptr<float>();
+  const float neg_inf = -std::numeric_limits<float>::infinity();
+  int64_t qBlocks = (qSize + fa_q_block - 1) / fa_q_block;
+
+  at::parallel_for(
+      0, batchSize * num_head * qBlocks, 0, [&](int64_t begin, int64_t end) {
+        ScratchScope scratch;
+        float* qk = scratch.allocate<float>(fa_q_block * fa_kv_block);
+        float* qk_max = scratch.allocate<float>(fa_q_block);
+        float* qk_sum = scratch.allocate<float>(fa_q_block);
+        for (int64_t task = begin; task < end; task++) {
+          int64_t bh = task / qBlocks;
+          int64_t m = (task % qBlocks) * fa_q_block;
+          int64_t qBlockSize = std::min(fa_q_block, qSize - m);
+          float* q_ptr = q_data + (bh * qSize + m) * headSize;
+          float* k_ptr = k_data + bh * kvSize * headSize;
+          float* v_ptr = v_data + bh * kvSize * headSize;
+          float* dst = out_data + (bh * qSize + m) * headSize;
+          std::fill_n(dst, qBlockSize * headSize, 0.f);
+          std::fill_n(qk_max, qBlockSize, neg_inf);
+          std::fill_n(qk_sum, qBlockSize, 0.f);
+          int64_t kvEnd =
+              causal_kv_end(m + qBlockSize, qSize, kvSize, is_causal);
+          for (int64_t n = 0; n < kvEnd; n += fa_kv_block) {
+            int64_t kvBlockSize = std::min(fa_kv_block, kvEnd - n);
+            bf32_sgemm(
+                CblasNoTrans,
+                CblasTrans,
+                qBlockSize,
+                kvBlockSize,
+                headSize,
+                scale,
+                q_ptr,
+                headSize,
+                k_ptr + n * headSize,
+                headSize,
+                0.f,
+                qk,
+                kvBlockSize);
+            for (int64_t r = 0; r < qBlockSize; r++) {
+              float* row = qk + r * kvBlockSize;
+              int64_t valid = kvBlockSize;
+              if (is_causal) {
+                valid = std::max<int64_t>(
+                    std::min(kvBlockSize, m + r + kvSize - qSize + 1 - n), 0);
+              }
+              float row_max = qk_max[r];
+              for (int64_t c = 0; c < valid; c++) {
+                row_max = std::max(row_max, row[c]);
+              }
+              // a row has no visible key in the block only after its first
+              // visible one, so row_max is finite here
+              float factor = std::exp(qk_max[r] - row_max);
+              float row_sum = 0.f;
+              for (int64_t c = 0; c < valid; c++) {
+                row[c] = std::exp(row[c] - row_max);
+                row_sum += row[c];
+              }
+              std::fill(row + valid, row + kvBlockSize, 0.f);
+              qk_max[r] = row_max;
+              qk_sum[r] = qk_sum[r] * factor + row_sum;
+              float* dst_row = dst + r * headSize;
+#pragma omp simd
+              for (int64_t d = 0; d < headSize; d++) {
+                dst_row[d] *= factor;
+              }
+            }
+            bf32_sgemm(
+                CblasNoTrans,
+                CblasNoTrans,
+                qBlockSize,
+                headSize,
+                kvBlockSize,
+                1.f,
+                qk,
+                kvBlockSize,
+                v_ptr + n * headSize,
+                headSize,
+                1.f,
+                dst,
+                headSize);
+          }
+          for (int64_t r = 0; r < qBlockSize; r++) {
+            float inv_sum = 1.f / qk_sum[r];
+            float* dst_row = dst + r * headSize;
+#pragma omp simd
+            for (int64_t d = 0; d < headSize; d++) {
+              dst_row[d] *= inv_sum;
+            }
+            lse_data[bh * qSize + m + r] = qk_max[r] + std::log(qk_sum[r]);
+          }
+        }
+      });
+  return std::make_tuple(out.to(query.scalar_type()), lse);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+flash_attention_backward_kernel_impl(
+    const at::Tensor& grad_out,
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& out,
+    const at::Tensor& logsumexp,
+    double scale,
+    bool is_causal) {
+  check_flash_attention_inputs(query, key, value, is_causal);
+  TORCH_CHECK(
+      grad_out.sizes() == query.sizes() && out.sizes() == query.sizes(),
+      "flash_attention_backward: expect grad_out and out of the query shape");
+  TORCH_CHECK(
+      logsumexp.scalar_type() == at::kFloat &&
+          logsumexp.sizes() == query.sizes().slice(0, 3),
+      "flash_attention_backward: expect float logsumexp of [batch, heads, seq]");
+  int64_t batchSize = query.size(0);
+  int64_t num_head = query.size(1);
+  int64_t qSize = query.size(2);
+  int64_t kvSize = key.size(2);
+  int64_t headSize = query.size(3);
+  auto q = query.to(at::kFloat).contiguous();
+  auto k = key.to(at::kFloat).contiguous();
+  auto v = value.to(at::kFloat).contiguous();
+  auto dout = grad_out.to(at::kFloat).contiguous();
+  auto lse = logsumexp.contiguous();
+  // rowsum(dO * O), the softmax backward term shared by the row
+  auto delta = at::sum(dout * out.to(at::kFloat), -1).contiguous();
+  auto grad_q = at::zeros_like(q);
+  auto grad_k = at::zeros_like(k);
+  auto grad_v = at::zeros_like(v);
+  float* q_data = q.data_ptr<float>();
+  float* k_data = k.data_ptr<float>();
+  float* v_data = v.data_ptr<float>();
+  float* dout_data = dout.data_ptr<float>();
+  float* lse_data = lse.data_ptr<float>();
+  float* delta_data = delta.data_ptr<float>();
+  float* grad_q_data = grad_q.data_ptr<float>();
+  float* grad_k_data = grad_k.data_ptr<float>();
+  float* grad_v_data = grad_v.data_ptr<float>();
+
+  // dQ of a head is updated by all of its key blocks, so a task is a head
+  at::parallel_for(
+      0, batchSize * num_head, 0, [&](int64_t begin, int64_t end) {
+        ScratchScope scratch;
+        float* p = scratch.allocate<float>(fa_q_block * fa_kv_block);
+        float* dp = scratch.allocate<float>(fa_q_block * fa_kv_block);
+        for (int64_t bh = begin; bh < end; bh++) {
+          int64_t q_offset = bh * qSize * headSize;
+          int64_t kv_offset = bh * kvSize * headSize;
+          for (int64_t n = 0; n < kvSize; n += fa_kv_block) {
+            int64_t kvBlockSize = std::min(fa_kv_block, kvSize - n);
+            float* k_ptr = k_data + kv_offset + n * headSize;
+            float* v_ptr = v_data + kv_offset + n * headSize;
+            float* dk_ptr = grad_k_data + kv_offset + n * headSize;
+            float* dv_ptr = grad_v_data + kv_offset + n * headSize;
+            // the first query block seeing key n under the causal mask
+            int64_t qBegin = is_causal
+                ? std::max<int64_t>(n - (kvSize - qSize), 0) / fa_q_block *
+                    fa_q_block
+                : 0;
+            for (int64_t m = qBegin; m < qSize; m += fa_q_block) {
+              int64_t qBlockSize = std::min(fa_q_block, qSize - m);
+              float* q_ptr = q_data + q_offset + m * headSize;
+              float* do_ptr = dout_data + q_offset + m * headSize;
+              float* dq_ptr = grad_q_data + q_offset + m * headSize;
+              bf32_sgemm(
+                  CblasNoTrans,
+                  CblasTrans,
+                  qBlockSize,
+                  kvBlockSize,
+                  headSize,
+                  scale,
+                  q_ptr,
+                  headSize,
+                  k_ptr,
+                  headSize,
+                  0.f,
+                  p,
+                  kvBlockSize);
+              for (int64_t r = 0; r < qBlockSize; r++) {
+                float* row = p + r * kvBlockSize;
+                float row_lse = lse_data[bh * qSize + m + r];
+                int64_t valid = kvBlockSize;
+                if (is_causal) {
+                  valid = std::max<int64_t>(
+                      std::min(kvBlockSize, m + r + kvSize - qSize + 1 - n),
+                      0);
+                }
+                for (int64_t c = 0; c < valid; c++) {
+                  row[c] = std::exp(row[c] - row_lse);
+                }
+                std::fill(row + valid, row + kvBlockSize, 0.f);
+              }
+              // dV += P^T * dO
+              bf32_sgemm(
+                  CblasTrans,
+                  CblasNoTrans,
+                  kvBlockSize,
+                  headSize,
+                  qBlockSize,
+                  1.f,
+                  p,
+                  kvBlockSize,
+                  do_ptr,
+                  headSize,
+                  1.f,
+                  dv_ptr,
+                  headSize);
+              // dP = dO * V^T
+              bf32_sgemm(
+                  CblasNoTrans,
+                  CblasTrans,
+                  qBlockSize,
+                  kvBlockSize,
+                  headSize,
+                  1.f,
+                  do_ptr,
+                  headSize,
+                  v_ptr,
+                  headSize,
+                  0.f,
+                  dp,
+                  kvBlockSize);
+              // dS = P * (dP - delta), stored in dp
+              for (int64_t r = 0; r < qBlockSize; r++) {
+                float row_delta = delta_data[bh * qSize + m + r];
+                float* p_row = p + r * kvBlockSize;
+                float* ds_row = dp + r * kvBlockSize;
+#pragma omp simd
+                for (int64_t c = 0; c < kvBlockSize; c++) {
+                  ds_row[c] = p_row[c] * (ds_row[c] - row_delta);
+                }
+              }
+              // dK += scale * dS^T * Q
+              bf32_sgemm(
+                  CblasTrans,
+                  CblasNoTrans,
+                  kvBlockSize,
+                  headSize,
+                  qBlockSize,
+                  scale,
+                  dp,
+                  kvBlockSize,
+                  q_ptr,
+                  headSize,
+                  1.f,
+                  dk_ptr,
+                  headSize);
+              // dQ += scale * dS * K
+              bf32_sgemm(
+                  CblasNoTrans,
+                  CblasNoTrans,
+                  qBlockSize,
+                  headSize,
+                  kvBlockSize,
+                  scale,
+                  dp,
+                  kvBlockSize,
+                  k_ptr,
+                  headSize,
+                  1.f,
+                  dq_ptr,
+                  headSize);
+            }
+          }
+        }
+      });
+  return std::make_tuple(
+      grad_q.to(query.scalar_type()),
+      grad_k.to(key.scalar_type()),
+      grad_v.to(value.scalar_type()));
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(bert_mha_kernel_stub, &bert_mha_kernel_impl);
+REGISTER_DISPATCH(bert_mha_int8_kernel_stub, &bert_mha_int8_kernel_impl);
 REGISTER_DISPATCH(sd_mha_kernel_v1_stub, &sd_mha_kernel_v1_impl);
 REGISTER_DISPATCH(sd_mha_kernel_v2_stub, &sd_mha_kernel_v2_impl);
+REGISTER_DISPATCH(flash_mha_varlen_kernel_stub, &flash_mha_varlen_kernel_impl);
+REGISTER_DISPATCH(
+    paged_attention_decode_kernel_stub,
+    &paged_attention_decode_kernel_impl);
+REGISTER_DISPATCH(
+    beam_attention_decode_kernel_stub,
+    &beam_attention_decode_kernel_impl);
+REGISTER_DISPATCH(
+    paged_attention_update_cache_kernel_stub,
+    &paged_attention_update_cache_kernel_impl);
+REGISTER_DISPATCH(
+    flash_attention_forward_kernel_stub,
+    &flash_attention_forward_kernel_impl);
+REGISTER_DISPATCH(
+    flash_attention_backward_kernel_stub,
+    &flash_attention_backward_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -1,9 +1,11 @@
 // Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
 #include <c10/util/Exception.h>
 #include <immintrin.h>
 #include <torch/csrc/autograd/function.h>
 #include <algorithm>
+#include <functional>
 #include "autocast/autocast_mode.h"
 #include "cpu/kernels/Softmax.h"
 
@@ -380,6 +382,179 @@ std::vector<at::Tensor> remove_empty(
   return valid_candidate;
 }
 
+// Classes of at least nms_bitmask_large_class candidates are run one after
+// the other after the other classes, the rows of their suppression bitmask
+// being computed in parallel.
+const int64_t nms_bitmask_large_class = 1024;
+// The suppression bitmask takes n * n / 8 bytes, larger inputs go to the
+// greedy kernel.
+const int64_t nms_bitmask_max_boxes = 16384;
+
+/*
+ Blocked bitmask NMS of boxes sorted in descending score order: bit j % 64 of
+ word j / 64 of row i is set if box j > i overlaps box i by at least the
+ threshold. The IoUs of a box with the following ones are computed a vector at
+ a time, the rows being independent, and the serial reduction walks the rows
+ of the kept boxes, or-ing them into the removed bits. This keeps the same
+ boxes as the greedy nms_cpu_kernel.
+*/
+template <typename scalar_t>
+at::Tensor nms_bitmask_kernel(
+    const at::Tensor& dets,
+    const float threshold,
+    float bias) {
+  using Vec = at::vec::Vectorized<scalar_t>;
+  int64_t n = dets.size(0);
+  if (n == 0) {
+    return at::empty({0}, dets.options().dtype(at::kLong));
+  }
+  auto coords = dets.t().contiguous();
+  auto areas_t = ((coords[2] - coords[0] + bias) *
+                  (coords[3] - coords[1] + bias))
+                     .contiguous();
+  const scalar_t* x1 = coords.data_ptr<scalar_t>();
+  const scalar_t* y1 = x1 + n;
+  const scalar_t* x2 = y1 + n;
+  const scalar_t* y2 = x2 + n;
+  const scalar_t* areas = areas_t.data_ptr<scalar_t>();
+  int64_t words = (n + 63) / 64;
+  std::vector<uint64_t> mask(n * words, 0);
+
+  const Vec zero(static_cast<scalar_t>(0));
+  const Vec bias_vec(static_cast<scalar_t>(bias));
+  const Vec threshold_vec(static_cast<scalar_t>(threshold));
+  at::parallel_for(0, n, 16, [&](int64_t begin, int64_t end) {
+    scalar_t over[Vec::size()];
+    for (int64_t i = begin; i < end; i++) {
+      uint64_t* row = mask.data() + i * words;
+      Vec ix1(x1[i]), iy1(y1[i]), ix2(x2[i]), iy2(y2[i]), iarea(areas[i]);
+      for (int64_t j = i + 1; j < n; j += Vec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(Vec::size()), n - j);
+        auto w = at::vec::maximum(
+            zero,
+            at::vec::minimum(ix2, Vec::loadu(x2 + j, count)) -
+                at::vec::maximum(ix1, Vec::loadu(x1 + j, count)) + bias_vec);
+        auto h = at::vec::maximum(
+            zero,
+            at::vec::minimum(iy2, Vec::loadu(y2 + j, count)) -
+                at::vec::maximum(iy1, Vec::loadu(y1 + j, count)) + bias_vec);
+        auto inter = w * h;
+        auto ovr = inter / (iarea + Vec::loadu(areas + j, count) - inter);
+        ovr.ge(threshold_vec).store(over, count);
+        for (int64_t k = 0; k < count; k++) {
+          if (over[k] != 0) {
+            row[(j + k) / 64] |= uint64_t(1) << ((j + k) % 64);
+          }
+        }
+      }
+    }
+  });
+
+  std::vector<uint64_t> removed(words, 0);
+  std::vector<int64_t> keep;
+  for (int64_t i = 0; i < n; i++) {
+    if ((removed[i / 64] >> (i % 64)) & 1) {
+      continue;
+    }
+    keep.push_back(i);
+    const uint64_t* row = mask.data() + i * words;
+    for (int64_t w = i / 64; w < words; w++) {
+      removed[w] |= row[w];
+    }
+  }
+  auto keep_t = at::empty(
+      {static_cast<int64_t>(keep.size())}, dets.options().dtype(at::kLong));
+  std::copy(keep.begin(), keep.end(), keep_t.data_ptr<int64_t>());
+  return keep_t;
+}
+
+// Suppresses the candidates of a class sorted in descending score order into
+// the outputs of the index-th (image, class)
+template <typename scalar_t>
+void suppress_class(
+    int64_t index,
+    int64_t label,
+    const at::Tensor& bboxes_sliced,
+    const at::Tensor& score_sliced,
+    const float threshold,
+    std::vector<at::Tensor>& bboxes_out,
+    std::vector<at::Tensor>& scores_out,
+    std::vector<at::Tensor>& labels_out) {
+  at::Tensor keep = bboxes_sliced.size(0) <= nms_bitmask_max_boxes
+      ? nms_bitmask_kernel<scalar_t>(bboxes_sliced, threshold, /*bias*/ 0)
+      : nms_cpu_kernel<scalar_t, /*sorted*/ true>(
+            bboxes_sliced, score_sliced, threshold, /*bias*/ 0);
+  bboxes_out[index] = at::index_select(bboxes_sliced, /*dim*/ 0, keep);
+  scores_out[index] = at::index_select(score_sliced, /*dim*/ 0, keep);
+  // TODO optimize the fill_
+  labels_out[index] = at::empty({keep.sizes()}).fill_(label);
+}
+
+// Concatenates the detections of the classes of each image, keeping the
+// max_output highest scores
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+merge_image_detections(
+    std::vector<at::Tensor>& bboxes_out,
+    std::vector<at::Tensor>& scores_out,
+    std::vector<at::Tensor>& labels_out,
+    int64_t nbatch,
+    int64_t nscore,
+    int64_t max_output,
+    const at::TensorOptions& options) {
+  std::vector<at::Tensor> output_bboxes_(nbatch);
+  std::vector<at::Tensor> output_labels_(nbatch);
+  std::vector<at::Tensor> output_scores_(nbatch);
+  std::vector<at::Tensor> output_length_(nbatch);
+#ifdef _OPENMP
+#if (_OPENMP >= 201307)
+#pragma omp parallel for simd schedule( \
+    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#else
+#pragma omp parallel for schedule( \
+    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#endif
+#endif
+  for (int bs = 0; bs < nbatch; bs++) {
+    // Post process the tensors to get the top max_output(number) for each
+    // Batchsize
+    std::vector<at::Tensor> valid_bboxes_out =
+        remove_empty(bboxes_out, bs * nscore, (bs + 1) * nscore);
+    std::vector<at::Tensor> valid_scores_out =
+        remove_empty(scores_out, bs * nscore, (bs + 1) * nscore);
+    std::vector<at::Tensor> valid_labels_out =
+        remove_empty(labels_out, bs * nscore, (bs + 1) * nscore);
+    if (valid_bboxes_out.empty()) {
+      // no candidate above the score threshold in this image
+      output_bboxes_[bs] = at::empty({0, 4}, options);
+      output_labels_[bs] = at::empty({0});
+      output_scores_[bs] = at::empty({0}, options);
+      output_length_[bs] = torch::tensor(0, {torch::kInt32});
+      continue;
+    }
+
+    at::Tensor bboxes_out_ = at::cat(valid_bboxes_out, 0);
+    at::Tensor labels_out_ = at::cat(valid_labels_out, 0);
+    at::Tensor scores_out_ = at::cat(valid_scores_out, 0);
+
+    std::tuple<at::Tensor, at::Tensor> sort_result = scores_out_.sort(0);
+    at::Tensor max_ids = std::get<1>(sort_result);
+    max_ids = max_ids.slice(
+        /*dim*/ 0,
+        /*start*/
+        std::max(max_ids.size(0) - max_output, static_cast<int64_t>(0)),
+        /*end*/ max_ids.size(0));
+    output_bboxes_[bs] = bboxes_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
+    output_labels_[bs] = labels_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
+    output_scores_[bs] = scores_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
+    output_length_[bs] = torch::tensor(max_ids.size(0), {torch::kInt32});
+  }
+  return std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>(
+      at::cat(output_bboxes_),
+      at::cat(output_labels_),
+      at::cat(output_scores_),
+      at::stack(output_length_));
+}
+
 template <typename scalar_t>
 std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
 batch_score_nms_kernel(
@@ -401,6 +576,9 @@ batch_score_nms_kernel(
   std::vector<at::Tensor> bboxes_out(nbatch_x_nscore);
   std::vector<at::Tensor> scores_out(nbatch_x_nscore);
   std::vector<at::Tensor> labels_out(nbatch_x_nscore);
+  // the candidates of the large classes, suppressed after the others
+  std::vector<at::Tensor> large_bboxes(nbatch_x_nscore);
+  std::vector<at::Tensor> large_scores(nbatch_x_nscore);
 
 #ifdef _OPENMP
 #if (_OPENMP >= 201307)
@@ -447,59 +625,219 @@ batch_score_nms_kernel(
     at::Tensor bboxes_sliced =
         at::index_select(bboxes, /*dim*/ 0, score_idx_sorted);
 
-    at::Tensor keep = nms_cpu_kernel<scalar_t, /*sorted*/ true>(
-        bboxes_sliced, score_sliced, threshold, /*bias*/ 0);
+    if (score_sliced.size(0) >= nms_bitmask_large_class) {
+      large_bboxes[index] = bboxes_sliced;
+      large_scores[index] = score_sliced;
+    } else {
+      suppress_class<scalar_t>(
+          index,
+          i,
+          bboxes_sliced,
+          score_sliced,
+          threshold,
+          bboxes_out,
+          scores_out,
+          labels_out);
+    }
+  }
 
-    bboxes_out[index] = at::index_select(bboxes_sliced, /*dim*/ 0, keep);
-    scores_out[index] = at::index_select(score_sliced, /*dim*/ 0, keep);
-    // TODO optimize the fill_
-    labels_out[index] = at::empty({keep.sizes()}).fill_(i);
+  // outside of the parallel region, a large class is split across threads
+  for (int index = 0; index < nbatch_x_nscore; index++) {
+    if (large_bboxes[index].defined()) {
+      suppress_class<scalar_t>(
+          index,
+          index % nscore,
+          large_bboxes[index],
+          large_scores[index],
+          threshold,
+          bboxes_out,
+          scores_out,
+          labels_out);
+    }
   }
 
-  std::vector<at::Tensor> output_bboxes_(nbatch);
-  std::vector<at::Tensor> output_labels_(nbatch);
-  std::vector<at::Tensor> output_scores_(nbatch);
-  std::vector<at::Tensor> output_length_(nbatch);
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int bs = 0; bs < nbatch; bs++) {
-    // Post process the tensors to get the top max_output(number) for each
-    // Batchsize
-    std::vector<at::Tensor> valid_bboxes_out =
-        remove_empty(bboxes_out, bs * nscore, (bs + 1) * nscore);
-    std::vector<at::Tensor> valid_scores_out =
-        remove_empty(scores_out, bs * nscore, (bs + 1) * nscore);
-    std::vector<at::Tensor> valid_labels_out =
-        remove_empty(labels_out, bs * nscore, (bs + 1) * nscore);
+  return merge_image_detections(
+      bboxes_out,
+      scores_out,
+      labels_out,
+      nbatch,
+      nscore,
+      max_output,
+      batch_dets.options());
+}
 
-    at::Tensor bboxes_out_ = at::cat(valid_bboxes_out, 0);
-    at::Tensor labels_out_ = at::cat(valid_labels_out, 0);
-    at::Tensor scores_out_ = at::cat(valid_scores_out, 0);
+// number of classes whose candidates a task of detection_postprocess selects
+// in the same pass over the anchors
+const int64_t detection_class_block = 16;
 
-    std::tuple<at::Tensor, at::Tensor> sort_result = scores_out_.sort(0);
-    at::Tensor max_ids = std::get<1>(sort_result);
-    max_ids = max_ids.slice(
-        /*dim*/ 0,
-        /*start*/
-        std::max(max_ids.size(0) - max_output, static_cast<int64_t>(0)),
-        /*end*/ max_ids.size(0));
-    output_bboxes_[bs] = bboxes_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_labels_[bs] = labels_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_scores_[bs] = scores_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_length_[bs] = torch::tensor(max_ids.size(0), {torch::kInt32});
+/*
+ Fused SSD / RetinaNet post-processing. The class probabilities are computed
+ on the fly from the logits, with a softmax over the classes of an anchor or a
+ sigmoid, and a task streams the anchors of an image for a block of classes,
+ keeping the max_candidates highest probabilities above the threshold of each
+ class in a min heap. Only the boxes of the candidates are decoded, the same
+ way as parallel_scale_back_batch, before they are suppressed, so neither the
+ decoded boxes nor the probabilities of all the anchors are materialized.
+*/
+template <typename scalar_t>
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess_kernel(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float iou_threshold,
+    const int max_candidates,
+    const int max_output,
+    const bool use_sigmoid,
+    const int background_label) {
+  using Candidate = std::pair<scalar_t, int64_t>;
+  int64_t nbatch = scores_in.size(0);
+  int64_t nanchors = scores_in.size(1);
+  int64_t nscore = scores_in.size(2);
+  auto loc_t = bboxes_in.contiguous();
+  auto logits_t = scores_in.contiguous();
+  auto dboxes_t = dboxes_xywh.to(at::kDouble).contiguous();
+  const scalar_t* loc = loc_t.data_ptr<scalar_t>();
+  const scalar_t* logits = logits_t.data_ptr<scalar_t>();
+  const double* dboxes = dboxes_t.data_ptr<double>();
+
+  // the max logit of each anchor and the sum of exp(logit - max)
+  std::vector<scalar_t> row_max;
+  std::vector<scalar_t> row_sum;
+  if (!use_sigmoid) {
+    row_max.resize(nbatch * nanchors);
+    row_sum.resize(nbatch * nanchors);
+    at::parallel_for(0, nbatch * nanchors, 64, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; r++) {
+        const scalar_t* x = logits + r * nscore;
+        scalar_t m = *std::max_element(x, x + nscore);
+        scalar_t sum = 0;
+        for (int64_t c = 0; c < nscore; c++) {
+          sum += std::exp(x[c] - m);
+        }
+        row_max[r] = m;
+        row_sum[r] = sum;
+      }
+    });
   }
-  return std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>(
-      at::cat(output_bboxes_),
-      at::cat(output_labels_),
-      at::cat(output_scores_),
-      at::stack(output_length_));
+
+  // Step1: select the candidates of each (image, class)
+  int64_t nblocks =
+      (nscore + detection_class_block - 1) / detection_class_block;
+  int64_t nbatch_x_nscore = nbatch * nscore;
+  std::vector<std::vector<Candidate>> candidates(nbatch_x_nscore);
+  auto heap_greater = std::greater<Candidate>();
+  at::parallel_for(0, nbatch * nblocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; task++) {
+      int64_t bs = task / nblocks;
+      int64_t c_begin = task % nblocks * detection_class_block;
+      int64_t c_end = std::min(c_begin + detection_class_block, nscore);
+      for (int64_t j = 0; j < nanchors; j++) {
+        int64_t r = bs * nanchors + j;
+        const scalar_t* x = logits + r * nscore;
+        for (int64_t c = c_begin; c < c_end; c++) {
+          if (c == background_label) {
+            continue;
+          }
+          scalar_t p = use_sigmoid ? 1 / (1 + std::exp(-x[c]))
+                                   : std::exp(x[c] - row_max[r]) / row_sum[r];
+          if (!(p > score_threshold)) {
+            continue;
+          }
+          auto& heap = candidates[bs * nscore + c];
+          if (heap.size() < static_cast<size_t>(max_candidates)) {
+            heap.emplace_back(p, j);
+            std::push_heap(heap.begin(), heap.end(), heap_greater);
+          } else if (p > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), heap_greater);
+            heap.back() = Candidate(p, j);
+            std::push_heap(heap.begin(), heap.end(), heap_greater);
+          }
+        }
+      }
+    }
+  });
+
+  // Step2: decode the boxes of the candidates and suppress them
+  std::vector<at::Tensor> bboxes_out(nbatch_x_nscore);
+  std::vector<at::Tensor> scores_out(nbatch_x_nscore);
+  std::vector<at::Tensor> labels_out(nbatch_x_nscore);
+  std::vector<at::Tensor> large_bboxes(nbatch_x_nscore);
+  std::vector<at::Tensor> large_scores(nbatch_x_nscore);
+  at::parallel_for(0, nbatch_x_nscore, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; index++) {
+      auto& cand = candidates[index];
+      if (cand.empty()) {
+        continue;
+      }
+      int64_t bs = index / nscore;
+      int64_t k = cand.size();
+      std::sort(cand.begin(), cand.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+      });
+      auto bboxes_sliced = at::empty({k, 4}, loc_t.options());
+      auto score_sliced = at::empty({k}, loc_t.options());
+      scalar_t* box = bboxes_sliced.data_ptr<scalar_t>();
+      scalar_t* score = score_sliced.data_ptr<scalar_t>();
+      for (int64_t i = 0; i < k; i++) {
+        int64_t j = cand[i].second;
+        const scalar_t* in = loc + (bs * nanchors + j) * 4;
+        const double* d = dboxes + j * 4;
+        scalar_t x = in[0] * scale_xy;
+        scalar_t y = in[1] * scale_xy;
+        scalar_t w = in[2] * scale_wh;
+        scalar_t h = in[3] * scale_wh;
+        x = x * d[2] + d[0];
+        y = y * d[3] + d[1];
+        w = std::exp(w) * d[2];
+        h = std::exp(h) * d[3];
+        box[i * 4] = x - 0.5 * w;
+        box[i * 4 + 1] = y - 0.5 * h;
+        box[i * 4 + 2] = x + 0.5 * w;
+        box[i * 4 + 3] = y + 0.5 * h;
+        score[i] = cand[i].first;
+      }
+      if (k >= nms_bitmask_large_class) {
+        large_bboxes[index] = bboxes_sliced;
+        large_scores[index] = score_sliced;
+      } else {
+        suppress_class<scalar_t>(
+            index,
+            index % nscore,
+            bboxes_sliced,
+            score_sliced,
+            iou_threshold,
+            bboxes_out,
+            scores_out,
+            labels_out);
+      }
+    }
+  });
+  for (int64_t index = 0; index < nbatch_x_nscore; index++) {
+    if (large_bboxes[index].defined()) {
+      suppress_class<scalar_t>(
+          index,
+          index % nscore,
+          large_bboxes[index],
+          large_scores[index],
+          iou_threshold,
+          bboxes_out,
+          scores_out,
+          labels_out);
+    }
+  }
+
+  return merge_image_detections(
+      bboxes_out,
+      scores_out,
+      labels_out,
+      nbatch,
+      nscore,
+      max_output,
+      loc_t.options());
 }
 
 template <typename scalar_t>
@@ -697,6 +1035,38 @@ batch_score_nms_cpu_kernel_impl(
   return result;
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+detection_postprocess_cpu_kernel_impl(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float iou_threshold,
+    const int max_candidates,
+    const int max_output,
+    const bool use_sigmoid,
+    const int background_label) {
+  std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> result;
+  AT_DISPATCH_FLOATING_TYPES(
+      bboxes_in.scalar_type(), "detection_postprocess", [&] {
+        result = detection_postprocess_kernel<scalar_t>(
+            bboxes_in,
+            scores_in,
+            dboxes_xywh,
+            scale_xy,
+            scale_wh,
+            score_threshold,
+            iou_threshold,
+            max_candidates,
+            max_output,
+            use_sigmoid,
+            background_label);
+      });
+  return result;
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>>
 rpn_nms_cpu_kernel_impl(
     const at::Tensor& batch_dets,
@@ -757,6 +1127,9 @@ REGISTER_DISPATCH(
     batch_score_nms_cpu_kernel_stub,
     &batch_score_nms_cpu_kernel_impl);
 
+REGISTER_DISPATCH(
+    detection_postprocess_cpu_kernel_stub,
+    &detection_postprocess_cpu_kernel_impl);
 REGISTER_DISPATCH(rpn_nms_cpu_kernel_stub, &rpn_nms_cpu_kernel_impl);
 
 REGISTER_DISPATCH(box_head_nms_cpu_kernel_stub, &box_head_nms_cpu_kernel_impl);
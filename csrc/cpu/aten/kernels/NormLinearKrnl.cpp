@@ -0,0 +1,144 @@
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/NormLinear.h>
+
+#include <cmath>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+inline float reduce_add(const fVec& v) {
+  return at::vec::vec_reduce_all<float>(
+      [](fVec& a, fVec& b) { return a + b; }, v, fVec::size());
+}
+
+// The tails are loaded zero filled, so they do not change the sums
+template <typename T, typename T1>
+void norm_rows_kernel(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t norm,
+    float eps,
+    int64_t begin,
+    int64_t end,
+    at::Tensor& out) {
+  int64_t K = input.size(1);
+  const T* x_data = input.data_ptr<T>();
+  const T* r_data = residual.defined() ? residual.data_ptr<T>() : nullptr;
+  const T1* gamma_data = gamma.defined() ? gamma.data_ptr<T1>() : nullptr;
+  const T1* beta_data = beta.defined() ? beta.data_ptr<T1>() : nullptr;
+  T* out_data = out.data_ptr<T>();
+  // the sum of a row, normalized from float as add_layernorm does
+  std::vector<float> sum(norm == AddLayerNormKind ? K : 0);
+
+  for (int64_t m = begin; m < end; m++) {
+    const T* x = x_data + m * K;
+    T* y = out_data + (m - begin) * K;
+    if (norm == RMSNormKind) {
+      fVec acc_pow(0.f);
+      for (int64_t k = 0; k < K; k += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), K - k);
+        auto v = load_fvec(x + k, count);
+        acc_pow = at::vec::fmadd(v, v, acc_pow);
+      }
+      float rstd = 1.f / std::sqrt(reduce_add(acc_pow) / K + eps);
+      for (int64_t k = 0; k < K; k += fVec::size()) {
+        int64_t count = std::min(static_cast<int64_t>(fVec::size()), K - k);
+        auto v = load_fvec(x + k, count) * fVec(rstd);
+        if (gamma_data) {
+          v = v * load_fvec(gamma_data + k, count);
+        }
+        store_fvec(y + k, v, count);
+      }
+      continue;
+    }
+    const T* r = r_data + m * K;
+    fVec acc_mean(0.f), acc_pow(0.f);
+    for (int64_t k = 0; k < K; k += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), K - k);
+      auto v = load_fvec(x + k, count) + load_fvec(r + k, count);
+      v.store(sum.data() + k, count);
+      acc_mean = acc_mean + v;
+      acc_pow = at::vec::fmadd(v, v, acc_pow);
+    }
+    float mean = reduce_add(acc_mean) / K;
+    float var = std::max(reduce_add(acc_pow) / K - mean * mean, 0.f);
+    float rstd = 1.f / std::sqrt(var + eps);
+    for (int64_t k = 0; k < K; k += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), K - k);
+      auto v = (fVec::loadu(sum.data() + k, count) - fVec(mean)) * fVec(rstd);
+      if (gamma_data) {
+        v = v * load_fvec(gamma_data + k, count);
+      }
+      if (beta_data) {
+        v = v + load_fvec(beta_data + k, count);
+      }
+      store_fvec(y + k, v, count);
+    }
+  }
+}
+
+void norm_rows_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t norm,
+    double eps,
+    int64_t begin,
+    int64_t end,
+    at::Tensor& out) {
+  if (begin >= end || input.size(1) == 0) {
+    return;
+  }
+  // gamma and beta are of the same dtype
+  bool gamma_bf16 = gamma.defined() && gamma.scalar_type() == at::kBFloat16;
+  if (input.scalar_type() == at::kFloat) {
+    norm_rows_kernel<float, float>(
+        input, residual, gamma, beta, norm, eps, begin, end, out);
+  } else {
+    TORCH_CHECK(
+        input.scalar_type() == at::kBFloat16,
+        "norm_linear_run only supports float and bfloat16");
+    if (gamma_bf16) {
+      norm_rows_kernel<at::BFloat16, at::BFloat16>(
+          input, residual, gamma, beta, norm, eps, begin, end, out);
+    } else {
+      norm_rows_kernel<at::BFloat16, float>(
+          input, residual, gamma, beta, norm, eps, begin, end, out);
+    }
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(norm_rows_kernel_stub, &norm_rows_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,6 +1,7 @@
 #include <ATen/Parallel.h>
 #include <torch/csrc/autograd/function.h>
 #include "aten/LinearMKL.h"
+#include "aten/utils/bf32_gemm.h"
 #include "aten/utils/utils.h"
 #include "vec/vec.h"
 
@@ -83,8 +84,7 @@ void mkl_sgemm_base_kernel_impl(
         out_ptr,
         N);
   } else {
-    cblas_sgemm(
-        CblasRowMajor,
+    bf32_sgemm(
         CblasNoTrans,
         CblasTrans,
         M,
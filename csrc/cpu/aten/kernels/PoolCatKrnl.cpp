@@ -0,0 +1,245 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/PoolCat.h>
+
+#include <cstring>
+#include <limits>
+
+/*
+ The pooling of each input is vectorized over its channels, which are
+ contiguous in the channels-last input and in its slice of the output pixel,
+ the output row stride being the total number of channels. A task computes one
+ output row of one image for all the inputs, so that the pixels of the output
+ are written at once.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+struct PoolCatInput {
+  PoolCatKind kind;
+  int64_t C, H, W, c_offset;
+  int64_t kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w;
+  int64_t dilation_h, dilation_w;
+  bool count_include_pad, relu;
+};
+
+// the range [begin, end) of the kernel index whose input is in [0, size)
+inline void pool_valid_range(
+    int64_t o,
+    int64_t stride,
+    int64_t pad,
+    int64_t dilation,
+    int64_t kernel,
+    int64_t size,
+    int64_t& begin,
+    int64_t& end) {
+  int64_t i0 = o * stride - pad;
+  begin = i0 < 0 ? (-i0 + dilation - 1) / dilation : 0;
+  end = size - i0 <= 0 ? 0 : (size - i0 + dilation - 1) / dilation;
+  end = std::min(end, kernel);
+  begin = std::min(begin, end);
+}
+
+// out[ow][c_offset, c_offset + C) for the output row oh of in, the NHWC rows
+// of one image, out_C being the channels of the output
+template <typename T>
+void max_pool_cat_row(
+    const T* in,
+    T* out,
+    int64_t oh,
+    int64_t OW,
+    int64_t out_C,
+    const PoolCatInput& s) {
+  int64_t kh_begin, kh_end;
+  pool_valid_range(
+      oh, s.stride_h, s.pad_h, s.dilation_h, s.kernel_h, s.H, kh_begin, kh_end);
+  int64_t ih0 = oh * s.stride_h - s.pad_h;
+  for (int64_t ow = 0; ow < OW; ow++) {
+    int64_t kw_begin, kw_end;
+    pool_valid_range(
+        ow,
+        s.stride_w,
+        s.pad_w,
+        s.dilation_w,
+        s.kernel_w,
+        s.W,
+        kw_begin,
+        kw_end);
+    int64_t iw0 = ow * s.stride_w - s.pad_w;
+    T* out_ptr = out + ow * out_C + s.c_offset;
+    for (int64_t c = 0; c < s.C; c += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), s.C - c);
+      auto acc = fVec(-std::numeric_limits<float>::infinity());
+      for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+        int64_t ih = ih0 + kh * s.dilation_h;
+        for (int64_t kw = kw_begin; kw < kw_end; kw++) {
+          int64_t iw = iw0 + kw * s.dilation_w;
+          // maximum propagates NaN as max_pool2d does
+          acc = at::vec::maximum(
+              acc, load_fvec(in + (ih * s.W + iw) * s.C + c, count));
+        }
+      }
+      if (s.relu) {
+        acc = at::vec::maximum(acc, fVec(0.f));
+      }
+      store_fvec(out_ptr + c, acc, count);
+    }
+  }
+}
+
+// The divisor follows avg_pool2d: the window clipped to the padded input when
+// count_include_pad, the window clipped to the input otherwise.
+template <typename T>
+void avg_pool_cat_row(
+    const T* in,
+    T* out,
+    int64_t oh,
+    int64_t OW,
+    int64_t out_C,
+    const PoolCatInput& s) {
+  int64_t ih0 = oh * s.stride_h - s.pad_h;
+  int64_t ih1 = std::min(ih0 + s.kernel_h, s.H + s.pad_h);
+  int64_t pool_h = ih1 - ih0;
+  ih0 = std::max(ih0, int64_t(0));
+  ih1 = std::min(ih1, s.H);
+  for (int64_t ow = 0; ow < OW; ow++) {
+    int64_t iw0 = ow * s.stride_w - s.pad_w;
+    int64_t iw1 = std::min(iw0 + s.kernel_w, s.W + s.pad_w);
+    int64_t pool_size = pool_h * (iw1 - iw0);
+    iw0 = std::max(iw0, int64_t(0));
+    iw1 = std::min(iw1, s.W);
+    int64_t divisor =
+        s.count_include_pad ? pool_size : (ih1 - ih0) * (iw1 - iw0);
+    auto scale = fVec(divisor > 0 ? 1.f / divisor : 0.f);
+    T* out_ptr = out + ow * out_C + s.c_offset;
+    for (int64_t c = 0; c < s.C; c += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), s.C - c);
+      auto acc = fVec(0.f);
+      for (int64_t ih = ih0; ih < ih1; ih++) {
+        for (int64_t iw = iw0; iw < iw1; iw++) {
+          acc = acc + load_fvec(in + (ih * s.W + iw) * s.C + c, count);
+        }
+      }
+      acc = acc * scale;
+      if (s.relu) {
+        acc = at::vec::maximum(acc, fVec(0.f));
+      }
+      store_fvec(out_ptr + c, acc, count);
+    }
+  }
+}
+
+template <typename T>
+void copy_cat_row(
+    const T* in,
+    T* out,
+    int64_t oh,
+    int64_t OW,
+    int64_t out_C,
+    const PoolCatInput& s) {
+  const T* in_row = in + oh * s.W * s.C;
+  for (int64_t ow = 0; ow < OW; ow++) {
+    std::memcpy(
+        out + ow * out_C + s.c_offset, in_row + ow * s.C, s.C * sizeof(T));
+  }
+}
+
+template <typename T>
+void pool_cat_kernel(
+    const std::vector<at::Tensor>& inputs,
+    at::IntArrayRef pool_params,
+    at::Tensor& output) {
+  int64_t N = output.size(0);
+  int64_t out_C = output.size(1);
+  int64_t OH = output.size(2);
+  int64_t OW = output.size(3);
+  std::vector<PoolCatInput> shapes;
+  std::vector<const T*> in_ptrs;
+  int64_t c_offset = 0;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const int64_t* p = pool_params.data() + i * pool_cat_num_params;
+    shapes.push_back(PoolCatInput{
+        static_cast<PoolCatKind>(p[0]),
+        inputs[i].size(1),
+        inputs[i].size(2),
+        inputs[i].size(3),
+        c_offset,
+        p[1],
+        p[2],
+        p[3],
+        p[4],
+        p[5],
+        p[6],
+        p[7],
+        p[8],
+        p[10] != 0,
+        p[11] != 0});
+    in_ptrs.push_back(inputs[i].data_ptr<T>());
+    c_offset += inputs[i].size(1);
+  }
+  T* out = output.data_ptr<T>();
+
+  at::parallel_for(0, N * OH, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      int64_t n = r / OH;
+      int64_t oh = r % OH;
+      T* out_row = out + (n * OH + oh) * OW * out_C;
+      for (size_t i = 0; i < shapes.size(); i++) {
+        const auto& s = shapes[i];
+        const T* in_n = in_ptrs[i] + n * s.H * s.W * s.C;
+        if (s.kind == PoolCatKind::MAX) {
+          max_pool_cat_row(in_n, out_row, oh, OW, out_C, s);
+        } else if (s.kind == PoolCatKind::AVG) {
+          avg_pool_cat_row(in_n, out_row, oh, OW, out_C, s);
+        } else {
+          copy_cat_row(in_n, out_row, oh, OW, out_C, s);
+        }
+      }
+    }
+  });
+}
+
+void pool_cat_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    at::IntArrayRef pool_params,
+    at::Tensor& output) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (output.scalar_type() == at::kFloat) {
+    pool_cat_kernel<float>(inputs, pool_params, output);
+  } else {
+    pool_cat_kernel<at::BFloat16>(inputs, pool_params, output);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(pool_cat_kernel_stub, &pool_cat_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
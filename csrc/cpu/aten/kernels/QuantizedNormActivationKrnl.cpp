@@ -0,0 +1,243 @@
+#include <ATen/Parallel.h>
+#include <aten/QuantizedNormActivation.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The quantized values are read and written through their underlying int8_t
+// or uint8_t, a table of 256 entries being indexed by the uint8_t bits.
+template <typename T>
+inline uint8_t lut_idx(T q) {
+  return static_cast<uint8_t>(q);
+}
+
+template <typename T>
+inline T quantize_val(float x, float inv_scale, int32_t zp) {
+  float q = std::nearbyint(x * inv_scale) + zp;
+  q = std::min(
+      std::max(q, static_cast<float>(std::numeric_limits<T>::min())),
+      static_cast<float>(std::numeric_limits<T>::max()));
+  return static_cast<T>(q);
+}
+
+template <typename Tin, typename Tout>
+void qlayer_norm_kernel(
+    const Tin* input,
+    const float* gamma,
+    const float* beta,
+    int64_t M,
+    int64_t N,
+    float i_scale,
+    float eps,
+    float o_scale,
+    int32_t o_zp,
+    Tout* output) {
+  const float inv_o_scale = 1.f / o_scale;
+  at::parallel_for(0, M, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; m++) {
+      const Tin* x = input + m * N;
+      Tout* y = output + m * N;
+      // the zero point cancels out of x - mean, sums of the quantized values
+      // are exact in integers
+      int64_t sum = 0;
+      int64_t sum_sq = 0;
+#pragma omp simd reduction(+ : sum, sum_sq)
+      for (int64_t n = 0; n < N; n++) {
+        int32_t q = x[n];
+        sum += q;
+        sum_sq += q * q;
+      }
+      double mean = static_cast<double>(sum) / N;
+      double var = std::max(static_cast<double>(sum_sq) / N - mean * mean, 0.);
+      float rstd = 1.f / std::sqrt(var * i_scale * i_scale + eps);
+      // y = (q - mean) * scale * rstd * gamma + beta
+      float a = i_scale * rstd;
+      float b = -static_cast<float>(mean) * a;
+#pragma omp simd
+      for (int64_t n = 0; n < N; n++) {
+        float v = x[n] * a + b;
+        if (gamma) {
+          v *= gamma[n];
+        }
+        if (beta) {
+          v += beta[n];
+        }
+        y[n] = quantize_val<Tout>(v, inv_o_scale, o_zp);
+      }
+    }
+  });
+}
+
+template <typename Tin, typename Tout>
+void qsoftmax_kernel(
+    const Tin* input,
+    int64_t M,
+    int64_t N,
+    float i_scale,
+    float o_scale,
+    int32_t o_zp,
+    Tout* output) {
+  // exp(scale * (q - max)) of the 256 distances to the max of a row
+  float exp_lut[256];
+  for (int d = 0; d < 256; d++) {
+    exp_lut[d] = std::exp(-i_scale * d);
+  }
+  at::parallel_for(0, M, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; m++) {
+      const Tin* x = input + m * N;
+      Tout* y = output + m * N;
+      int32_t max = std::numeric_limits<Tin>::min();
+#pragma omp simd reduction(max : max)
+      for (int64_t n = 0; n < N; n++) {
+        max = std::max(max, static_cast<int32_t>(x[n]));
+      }
+      float sum = 0.f;
+      for (int64_t n = 0; n < N; n++) {
+        sum += exp_lut[max - x[n]];
+      }
+      float inv = 1.f / (sum * o_scale);
+      for (int64_t n = 0; n < N; n++) {
+        y[n] = quantize_val<Tout>(exp_lut[max - x[n]], inv, o_zp);
+      }
+    }
+  });
+}
+
+template <typename Tin, typename Tout>
+void qgelu_kernel(
+    const Tin* input,
+    int64_t numel,
+    float i_scale,
+    int32_t i_zp,
+    bool tanh,
+    float o_scale,
+    int32_t o_zp,
+    Tout* output) {
+  // the quantized GeLU of each of the 256 input values
+  Tout lut[256];
+  const float inv_o_scale = 1.f / o_scale;
+  for (int32_t v = std::numeric_limits<Tin>::min();
+       v <= std::numeric_limits<Tin>::max();
+       v++) {
+    float x = (v - i_zp) * i_scale;
+    float y = tanh
+        ? 0.5f * x *
+            (1.f + std::tanh(0.7978845608f * (x + 0.044715f * x * x * x)))
+        : 0.5f * x * (1.f + std::erf(x * 0.7071067811f));
+    lut[lut_idx(static_cast<Tin>(v))] =
+        quantize_val<Tout>(y, inv_o_scale, o_zp);
+  }
+  at::parallel_for(0, numel, 4096, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      output[i] = lut[lut_idx(input[i])];
+    }
+  });
+}
+
+template <typename Tin, typename Tout>
+void qlayer_norm_dispatch(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output) {
+  int64_t N = input.size(-1);
+  qlayer_norm_kernel<Tin, Tout>(
+      reinterpret_cast<const Tin*>(input.data_ptr()),
+      weight.defined() ? weight.data_ptr<float>() : nullptr,
+      bias.defined() ? bias.data_ptr<float>() : nullptr,
+      input.size(0),
+      N,
+      input.q_scale(),
+      eps,
+      output.q_scale(),
+      output.q_zero_point(),
+      reinterpret_cast<Tout*>(output.data_ptr()));
+}
+
+void qlayer_norm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    double eps,
+    at::Tensor& output) {
+  bool u8_in = input.scalar_type() == at::kQUInt8;
+  bool u8_out = output.scalar_type() == at::kQUInt8;
+  if (u8_in && u8_out) {
+    qlayer_norm_dispatch<uint8_t, uint8_t>(input, weight, bias, eps, output);
+  } else if (u8_in) {
+    qlayer_norm_dispatch<uint8_t, int8_t>(input, weight, bias, eps, output);
+  } else if (u8_out) {
+    qlayer_norm_dispatch<int8_t, uint8_t>(input, weight, bias, eps, output);
+  } else {
+    qlayer_norm_dispatch<int8_t, int8_t>(input, weight, bias, eps, output);
+  }
+}
+
+template <typename Tin, typename Tout>
+void qsoftmax_dispatch(const at::Tensor& input, at::Tensor& output) {
+  int64_t N = input.size(-1);
+  qsoftmax_kernel<Tin, Tout>(
+      reinterpret_cast<const Tin*>(input.data_ptr()),
+      N == 0 ? 0 : input.numel() / N,
+      N,
+      input.q_scale(),
+      output.q_scale(),
+      output.q_zero_point(),
+      reinterpret_cast<Tout*>(output.data_ptr()));
+}
+
+void qsoftmax_kernel_impl(const at::Tensor& input, at::Tensor& output) {
+  bool u8_in = input.scalar_type() == at::kQUInt8;
+  bool u8_out = output.scalar_type() == at::kQUInt8;
+  if (u8_in && u8_out) {
+    qsoftmax_dispatch<uint8_t, uint8_t>(input, output);
+  } else if (u8_in) {
+    qsoftmax_dispatch<uint8_t, int8_t>(input, output);
+  } else if (u8_out) {
+    qsoftmax_dispatch<int8_t, uint8_t>(input, output);
+  } else {
+    qsoftmax_dispatch<int8_t, int8_t>(input, output);
+  }
+}
+
+template <typename Tin, typename Tout>
+void qgelu_dispatch(const at::Tensor& input, bool tanh, at::Tensor& output) {
+  qgelu_kernel<Tin, Tout>(
+      reinterpret_cast<const Tin*>(input.data_ptr()),
+      input.numel(),
+      input.q_scale(),
+      input.q_zero_point(),
+      tanh,
+      output.q_scale(),
+      output.q_zero_point(),
+      reinterpret_cast<Tout*>(output.data_ptr()));
+}
+
+void qgelu_kernel_impl(const at::Tensor& input, bool tanh, at::Tensor& output) {
+  bool u8_in = input.scalar_type() == at::kQUInt8;
+  bool u8_out = output.scalar_type() == at::kQUInt8;
+  if (u8_in && u8_out) {
+    qgelu_dispatch<uint8_t, uint8_t>(input, tanh, output);
+  } else if (u8_in) {
+    qgelu_dispatch<uint8_t, int8_t>(input, tanh, output);
+  } else if (u8_out) {
+    qgelu_dispatch<int8_t, uint8_t>(input, tanh, output);
+  } else {
+    qgelu_dispatch<int8_t, int8_t>(input, tanh, output);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(qlayer_norm_kernel_stub, &qlayer_norm_kernel_impl);
+REGISTER_DISPATCH(qsoftmax_kernel_stub, &qsoftmax_kernel_impl);
+REGISTER_DISPATCH(qgelu_kernel_stub, &qgelu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -8,6 +8,62 @@ namespace cpu {
 
 namespace {
 
+#if defined(CPU_CAPABILITY_AVX512_FP16)
+// residual_out = a + b in fp16 arithmetic, 32 lanes a vector. The mean of
+// residual_out^2 is still accumulated in fp32.
+float _add_and_compute_mean_pow_fp16(
+    const at::Half* a_ptr,
+    const at::Half* b_ptr,
+    const int& size,
+    at::Half* residual_out_ptr) {
+  auto vec_acc_pow = _mm512_set1_ps(0.0);
+  int i;
+  for (i = 0; i < size; i += 32) {
+    __mmask32 mask = size - i >= 32 ? __mmask32(0xFFFFFFFF)
+                                    : __mmask32((1u << (size - i)) - 1);
+    auto vec_add = _mm512_add_ph(
+        _mm512_castsi512_ph(_mm512_maskz_loadu_epi16(mask, a_ptr + i)),
+        _mm512_castsi512_ph(_mm512_maskz_loadu_epi16(mask, b_ptr + i)));
+    auto vec_bits = _mm512_castph_si512(vec_add);
+    _mm512_mask_storeu_epi16(residual_out_ptr + i, mask, vec_bits);
+    auto vec_lo = _mm512_cvtph_ps(_mm512_castsi512_si256(vec_bits));
+    auto vec_hi = _mm512_cvtph_ps(_mm512_extracti64x4_epi64(vec_bits, 1));
+    vec_acc_pow = _mm512_fmadd_ps(vec_lo, vec_lo, vec_acc_pow);
+    vec_acc_pow = _mm512_fmadd_ps(vec_hi, vec_hi, vec_acc_pow);
+  }
+  return _mm512_reduce_add_ps(vec_acc_pow) / static_cast<float>(size);
+}
+
+// out = a_ptr * rstd * gamma in fp16 arithmetic
+void _rmsnorm_scale_kernel_fp16(
+    const at::Half* a_ptr,
+    const int& size,
+    float rstd,
+    const at::Half* gamma_ptr,
+    at::Half* out_ptr) {
+  auto vec_scale = _mm512_set1_ph(static_cast<_Float16>(rstd));
+  int i;
+  for (i = 0; i < size; i += 32) {
+    __mmask32 mask = size - i >= 32 ? __mmask32(0xFFFFFFFF)
+                                    : __mmask32((1u << (size - i)) - 1);
+    auto vec_res = _mm512_mul_ph(
+        _mm512_castsi512_ph(_mm512_maskz_loadu_epi16(mask, a_ptr + i)),
+        vec_scale);
+    if (gamma_ptr) {
+      vec_res = _mm512_mul_ph(
+          vec_res,
+          _mm512_castsi512_ph(_mm512_maskz_loadu_epi16(mask, gamma_ptr + i)));
+    }
+    _mm512_mask_storeu_epi16(out_ptr + i, mask, _mm512_castph_si512(vec_res));
+  }
+}
+
+// rstd is rounded to fp16 for the fp16 arithmetic, as long as it is normal
+inline bool _is_fp16_normal(float rstd) {
+  return rstd >= 6.104e-5f && rstd <= 65504.0f;
+}
+#endif
+
 #if defined(CPU_CAPABILITY_AVX512)
 template <typename T, typename T1>
 void RMSNormKernelImpl(
@@ -30,12 +86,132 @@ void RMSNormKernelImpl(
     }
   });
 }
+
+// a of T, b of Tb, residual_out and the unquantized output of Tout
+template <typename T, typename T1, typename Tb = T, typename Tout = T>
+void AddRMSNormKernelImpl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    float eps,
+    double scale,
+    int64_t zero_point,
+    c10::optional<at::ScalarType> qdtype,
+    at::Tensor& residual_out,
+    at::Tensor& Y) {
+  DCHECK(a.numel() == M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  const T* a_data = a.data_ptr<T>();
+  const Tb* b_data = b.data_ptr<Tb>();
+  const T1* gamma_data = gamma.defined() ? gamma.data_ptr<T1>() : nullptr;
+  Tout* residual_data = residual_out.data_ptr<Tout>();
+  // the normalized row is written once, in the output dtype
+  void* Y_data = Y.data_ptr();
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (const auto i : c10::irange(start, end)) {
+      Tout* residual_ptr = residual_data + i * N;
+      float mean_pow;
+#if defined(CPU_CAPABILITY_AVX512_FP16)
+      // native fp16 arithmetic instead of the fp32 up-conversion
+      if constexpr (
+          std::is_same<T, at::Half>::value && std::is_same<Tb, T>::value &&
+          std::is_same<Tout, T>::value) {
+        mean_pow = _add_and_compute_mean_pow_fp16(
+            a_data + i * N, b_data + i * N, N, residual_ptr);
+      } else
+#endif
+      {
+        mean_pow = kernel::_add_and_compute_mean_pow(
+            a_data + i * N, b_data + i * N, N, residual_ptr);
+      }
+      float rstd = float(1.0) / std::sqrt(mean_pow + eps);
+#if defined(CPU_CAPABILITY_AVX512_FP16)
+      if constexpr (
+          std::is_same<Tout, at::Half>::value &&
+          std::is_same<T1, at::Half>::value) {
+        if (!qdtype.has_value() && _is_fp16_normal(rstd)) {
+          _rmsnorm_scale_kernel_fp16(
+              residual_ptr,
+              N,
+              rstd,
+              gamma_data,
+              static_cast<Tout*>(Y_data) + i * N);
+          continue;
+        }
+      }
+#endif
+      if (!qdtype.has_value()) {
+        kernel::_rmsnorm_scale_kernel<Tout, T1>(
+            residual_ptr,
+            N,
+            rstd,
+            gamma_data,
+            static_cast<Tout*>(Y_data) + i * N);
+      } else if (qdtype.value() == at::kQUInt8) {
+        kernel::_rmsnorm_quantize_kernel<Tout, T1, uint8_t>(
+            residual_ptr,
+            N,
+            rstd,
+            gamma_data,
+            scale,
+            zero_point,
+            static_cast<uint8_t*>(Y_data) + i * N);
+      } else {
+        kernel::_rmsnorm_quantize_kernel<Tout, T1, int8_t>(
+            residual_ptr,
+            N,
+            rstd,
+            gamma_data,
+            scale,
+            zero_point,
+            static_cast<int8_t*>(Y_data) + i * N);
+      }
+    }
+  });
+}
+
+// fp32 and bf16 input and residual of different dtypes, added in fp32 into
+// the fp32 residual_out
+template <typename T, typename Tb>
+void AddRMSNormMixedKernelImpl(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    float eps,
+    double scale,
+    int64_t zero_point,
+    c10::optional<at::ScalarType> qdtype,
+    at::Tensor& residual_out,
+    at::Tensor& Y) {
+  if (gamma.scalar_type() == at::kBFloat16) {
+    AddRMSNormKernelImpl<T, at::BFloat16, Tb, float>(
+        a, b, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+  } else {
+    AddRMSNormKernelImpl<T, float, Tb, float>(
+        a,
+        b,
+        gamma.to(at::kFloat),
+        M,
+        N,
+        eps,
+        scale,
+        zero_point,
+        qdtype,
+        residual_out,
+        Y);
+  }
+}
 #endif
 
 at::Tensor rmsnorm_kernel_impl(
     const at::Tensor& input,
     const at::Tensor& b,
-    float eps) {
+    float eps,
+    bool inplace) {
 #if defined(CPU_CAPABILITY_AVX512)
   const auto input_shape = input.sizes();
   const auto input_ndim = input.dim();
@@ -45,24 +221,136 @@ at::Tensor rmsnorm_kernel_impl(
   const int64_t N =
       c10::multiply_integers(input_shape.cbegin() + axis, input_shape.cend());
   auto X = input.contiguous();
-  at::Tensor Y = at::native::empty_like(
-      X,
-      c10::nullopt /* dtype */,
-      c10::nullopt /* layout */,
-      c10::nullopt /* device */,
-      c10::nullopt /* pin_memory */,
-      at::MemoryFormat::Contiguous);
+  // a row is reduced before its normalized row is written, the output can
+  // overwrite the input
+  at::Tensor Y = inplace ? X
+                         : at::native::empty_like(
+                               X,
+                               c10::nullopt /* dtype */,
+                               c10::nullopt /* layout */,
+                               c10::nullopt /* device */,
+                               c10::nullopt /* pin_memory */,
+                               at::MemoryFormat::Contiguous);
   RMSNormKernelImpl<float, float>(X, b, M, N, eps, Y);
   return Y;
 #else
   auto variance = at::mean(at::pow(input, 2), -1, true);
   auto hidden_states = at::rsqrt(at::add(variance, eps));
-  return at::mul(b, at::mul(input, hidden_states));
+  auto Y = at::mul(b, at::mul(input, hidden_states));
+  return inplace ? input.copy_(Y) : Y;
+#endif
+}
+
+std::tuple<at::Tensor, at::Tensor> add_rmsnorm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    double scale,
+    int64_t zero_point,
+    c10::optional<at::ScalarType> qdtype) {
+  // fp32 and bf16 input and residual may be mixed, residual_out is of the
+  // dtype of at::add(input, residual)
+  auto out_type = at::result_type(input, residual);
+  TORCH_CHECK(
+      input.sizes() == residual.sizes() &&
+          (input.scalar_type() == residual.scalar_type() ||
+           out_type == at::kFloat),
+      "add_rmsnorm: expect input and residual of the same shape and dtype, or "
+      "of float and bfloat16");
+  TORCH_CHECK(
+      weight.numel() == input.size(-1),
+      "add_rmsnorm: expect weight of the normalized size");
+#if defined(CPU_CAPABILITY_AVX512)
+  const int64_t N = input.size(-1);
+  const int64_t M = input.numel() / N;
+  auto X = input.contiguous();
+  auto R = residual.contiguous();
+  auto gamma = weight.contiguous();
+  at::Tensor residual_out = at::empty_like(X, X.options().dtype(out_type));
+  at::Tensor Y = qdtype.has_value()
+      ? at::_empty_affine_quantized(
+            X.sizes(),
+            X.options().dtype(qdtype.value()),
+            scale,
+            zero_point,
+            at::MemoryFormat::Contiguous)
+      : at::empty_like(residual_out);
+  if (X.scalar_type() != R.scalar_type()) {
+    TORCH_CHECK(
+        (X.scalar_type() == at::kBFloat16 || X.scalar_type() == at::kFloat) &&
+            (R.scalar_type() == at::kBFloat16 ||
+             R.scalar_type() == at::kFloat),
+        "add_rmsnorm only mixes float and bfloat16 inputs");
+    if (X.scalar_type() == at::kBFloat16) {
+      AddRMSNormMixedKernelImpl<at::BFloat16, float>(
+          X, R, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+    } else {
+      AddRMSNormMixedKernelImpl<float, at::BFloat16>(
+          X, R, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+    }
+  } else if (X.scalar_type() == at::kFloat) {
+    AddRMSNormKernelImpl<float, float>(
+        X, R, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+  } else if (X.scalar_type() == at::kHalf) {
+    if (gamma.scalar_type() == at::kHalf) {
+      AddRMSNormKernelImpl<at::Half, at::Half>(
+          X, R, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+    } else {
+      AddRMSNormKernelImpl<at::Half, float>(
+          X,
+          R,
+          gamma.to(at::kFloat),
+          M,
+          N,
+          eps,
+          scale,
+          zero_point,
+          qdtype,
+          residual_out,
+          Y);
+    }
+  } else {
+    TORCH_CHECK(
+        X.scalar_type() == at::kBFloat16,
+        "add_rmsnorm only supports float, bfloat16 and float16 inputs");
+    if (gamma.scalar_type() == at::kBFloat16) {
+      AddRMSNormKernelImpl<at::BFloat16, at::BFloat16>(
+          X, R, gamma, M, N, eps, scale, zero_point, qdtype, residual_out, Y);
+    } else {
+      AddRMSNormKernelImpl<at::BFloat16, float>(
+          X,
+          R,
+          gamma.to(at::kFloat),
+          M,
+          N,
+          eps,
+          scale,
+          zero_point,
+          qdtype,
+          residual_out,
+          Y);
+    }
+  }
+  return std::make_tuple(residual_out, Y);
+#else
+  auto residual_out = at::add(input, residual);
+  auto variance = at::mean(at::pow(residual_out, 2), -1, true);
+  auto out = at::mul(
+      weight, at::mul(residual_out, at::rsqrt(at::add(variance, eps))));
+  if (qdtype.has_value()) {
+    return std::make_tuple(
+        residual_out,
+        at::quantize_per_tensor(
+            out.to(at::kFloat), scale, zero_point, qdtype.value()));
+  }
+  return std::make_tuple(residual_out, out.to(residual_out.scalar_type()));
 #endif
 }
 
 } // namespace
 
 REGISTER_DISPATCH(rmsnorm_kernel_stub, &rmsnorm_kernel_impl);
+REGISTER_DISPATCH(add_rmsnorm_kernel_stub, &add_rmsnorm_kernel_impl);
 } // namespace cpu
 } // namespace torch_ipex
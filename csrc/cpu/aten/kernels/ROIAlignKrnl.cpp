@@ -127,6 +127,68 @@ void pre_calc_for_bilinear_interpolate(
   }
 }
 
+// Computes the sampling grid of a roi of [batch_index, x1, y1, x2, y2] and the
+// interpolation weights of its samples, returning the number of samples of a
+// bin.
+template <typename ACC_T>
+int64_t roi_align_pre_calc(
+    const ACC_T* offset_rois,
+    const ACC_T& spatial_scale,
+    int64_t height,
+    int64_t width,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t& roi_bin_grid_h,
+    int64_t& roi_bin_grid_w,
+    std::vector<PreCalc<ACC_T>>& pre_calc) {
+  // Do not using rounding; this implementation detail is critical
+  ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
+  ACC_T roi_start_w = offset_rois[1] * spatial_scale - offset;
+  ACC_T roi_start_h = offset_rois[2] * spatial_scale - offset;
+  ACC_T roi_end_w = offset_rois[3] * spatial_scale - offset;
+  ACC_T roi_end_h = offset_rois[4] * spatial_scale - offset;
+
+  ACC_T roi_width = roi_end_w - roi_start_w;
+  ACC_T roi_height = roi_end_h - roi_start_h;
+  if (!aligned) {
+    // Force malformed ROIs to be 1x1
+    roi_width = std::max(roi_width, (ACC_T)1.);
+    roi_height = std::max(roi_height, (ACC_T)1.);
+  }
+
+  ACC_T bin_size_h =
+      static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
+  ACC_T bin_size_w =
+      static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
+
+  // We use roi_bin_grid to sample the grid and mimic integral
+  roi_bin_grid_h = (sampling_ratio > 0)
+      ? sampling_ratio
+      : ceil(roi_height / pooled_height); // e.g., = 2
+  roi_bin_grid_w =
+      (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+
+  // we want to precalculate indices and weights shared by all channels,
+  // this is the key point of optimization
+  pre_calc.resize(
+      roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
+  pre_calc_for_bilinear_interpolate(
+      height,
+      width,
+      pooled_height,
+      pooled_width,
+      roi_start_h,
+      roi_start_w,
+      bin_size_h,
+      bin_size_w,
+      roi_bin_grid_h,
+      roi_bin_grid_w,
+      pre_calc);
+  return roi_bin_grid_h * roi_bin_grid_w;
+}
+
 template <typename T, typename ACC_T>
 inline void roi_align_single_framework_forward(
     const T* input,
@@ -374,55 +436,23 @@ void roi_align_forward_kernel_body(
       const ACC_T* offset_rois = rois + n * 5;
       int64_t roi_batch_ind = offset_rois[0];
 
-      // Do not using rounding; this implementation detail is critical
-      ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
-      ACC_T roi_start_w = offset_rois[1] * spatial_scale - offset;
-      ACC_T roi_start_h = offset_rois[2] * spatial_scale - offset;
-      ACC_T roi_end_w = offset_rois[3] * spatial_scale - offset;
-      ACC_T roi_end_h = offset_rois[4] * spatial_scale - offset;
-
-      ACC_T roi_width = roi_end_w - roi_start_w;
-      ACC_T roi_height = roi_end_h - roi_start_h;
-      if (!aligned) {
-        // Force malformed ROIs to be 1x1
-        roi_width = std::max(roi_width, (ACC_T)1.);
-        roi_height = std::max(roi_height, (ACC_T)1.);
-      }
-
-      ACC_T bin_size_h =
-          static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
-      ACC_T bin_size_w =
-          static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
-
-      // We use roi_bin_grid to sample the grid and mimic integral
-      int64_t roi_bin_grid_h = (sampling_ratio > 0)
-          ? sampling_ratio
-          : ceil(roi_height / pooled_height); // e.g., = 2
-      int64_t roi_bin_grid_w = (sampling_ratio > 0)
-          ? sampling_ratio
-          : ceil(roi_width / pooled_width);
-
-      // We do average (integral) pooling inside a bin
-      // When the grid is empty, output zeros.
-      const ACC_T count =
-          std::max(roi_bin_grid_h * roi_bin_grid_w, (int64_t)1); // e.g. = 4
-
-      // we want to precalculate indices and weights shared by all channels,
-      // this is the key point of optimization
-      std::vector<PreCalc<ACC_T>> pre_calc(
-          roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
-      pre_calc_for_bilinear_interpolate(
+      int64_t roi_bin_grid_h, roi_bin_grid_w;
+      std::vector<PreCalc<ACC_T>> pre_calc;
+      int64_t samples = roi_align_pre_calc(
+          offset_rois,
+          spatial_scale,
           height,
           width,
           pooled_height,
           pooled_width,
-          roi_start_h,
-          roi_start_w,
-          bin_size_h,
-          bin_size_w,
+          sampling_ratio,
+          aligned,
           roi_bin_grid_h,
           roi_bin_grid_w,
           pre_calc);
+      // We do average (integral) pooling inside a bin
+      // When the grid is empty, output zeros.
+      const ACC_T count = std::max(samples, (int64_t)1); // e.g. = 4
 
       if (is_channels_last) {
         roi_align_single_framework_channels_last_forward<T, ACC_T>(
@@ -504,13 +534,15 @@ inline void roi_align_single_framework_backward(
   } // c
 }
 
+// Accumulates the gradients of the channels [c_begin, c_end) of a roi, the
+// tasks of disjoint channels writing disjoint gradients
 template <typename T, typename ACC_T>
-inline void roi_align_single_framework_channels_last_backward(
+inline void roi_align_channels_last_backward_block(
     const T* grad_output,
     const ACC_T count,
     int64_t channels,
-    int64_t height,
-    int64_t width,
+    int64_t c_begin,
+    int64_t c_end,
     int64_t pooled_height,
     int64_t pooled_width,
     int64_t roi_bin_grid_h,
@@ -521,6 +553,7 @@ inline void roi_align_single_framework_channels_last_backward(
   // otherwise consider blocking on channels.
   using Vec = at::vec::Vectorized<T>;
 
+  int64_t vec_end = c_begin + (c_end - c_begin) / Vec::size() * Vec::size();
   int64_t pre_calc_index = 0;
   for (int64_t ph = 0; ph < pooled_height; ph++) {
     for (int64_t pw = 0; pw < pooled_width; pw++) {
@@ -538,8 +571,8 @@ inline void roi_align_single_framework_channels_last_backward(
           Vec w2_vec = Vec(static_cast<T>(pc.w2 / count));
           Vec w3_vec = Vec(static_cast<T>(pc.w3 / count));
           Vec w4_vec = Vec(static_cast<T>(pc.w4 / count));
-          int64_t d2 = 0;
-          for (; d2 < channels - (channels % Vec::size()); d2 += Vec::size()) {
+          int64_t d2 = c_begin;
+          for (; d2 < vec_end; d2 += Vec::size()) {
             Vec g_in1_vec =
                 Vec::loadu(g_in1 + d2) + Vec::loadu(g_out + d2) * w1_vec;
             g_in1_vec.store(g_in1 + d2);
@@ -553,7 +586,7 @@ inline void roi_align_single_framework_channels_last_backward(
                 Vec::loadu(g_in4 + d2) + Vec::loadu(g_out + d2) * w4_vec;
             g_in4_vec.store(g_in4 + d2);
           }
-          for (; d2 < channels; d2++) {
+          for (; d2 < c_end; d2++) {
             g_in1[d2] += g_out[d2] * pc.w1 / count;
             g_in2[d2] += g_out[d2] * pc.w2 / count;
             g_in3[d2] += g_out[d2] * pc.w3 / count;
@@ -566,6 +599,33 @@ inline void roi_align_single_framework_channels_last_backward(
   } // ph
 }
 
+template <typename T, typename ACC_T>
+inline void roi_align_single_framework_channels_last_backward(
+    const T* grad_output,
+    const ACC_T count,
+    int64_t channels,
+    int64_t height,
+    int64_t width,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t roi_bin_grid_h,
+    int64_t roi_bin_grid_w,
+    const std::vector<PreCalc<ACC_T>>& pre_calc,
+    T* grad_input) {
+  roi_align_channels_last_backward_block<T, ACC_T>(
+      grad_output,
+      count,
+      channels,
+      0,
+      channels,
+      pooled_height,
+      pooled_width,
+      roi_bin_grid_h,
+      roi_bin_grid_w,
+      pre_calc,
+      grad_input);
+}
+
 template <typename T, typename ACC_T>
 void roi_align_backward_kernel_body(
     int64_t n_rois,
@@ -588,52 +648,21 @@ void roi_align_backward_kernel_body(
     const ACC_T* offset_rois = rois + n * 5;
     int64_t roi_batch_ind = offset_rois[0];
 
-    // Do not using rounding; this implementation detail is critical
-    ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
-    ACC_T roi_start_w = offset_rois[1] * spatial_scale - offset;
-    ACC_T roi_start_h = offset_rois[2] * spatial_scale - offset;
-    ACC_T roi_end_w = offset_rois[3] * spatial_scale - offset;
-    ACC_T roi_end_h = offset_rois[4] * spatial_scale - offset;
-
-    ACC_T roi_width = roi_end_w - roi_start_w;
-    ACC_T roi_height = roi_end_h - roi_start_h;
-    if (!aligned) {
-      // Force malformed ROIs to be 1x1
-      roi_width = std::max(roi_width, (ACC_T)1.);
-      roi_height = std::max(roi_height, (ACC_T)1.);
-    }
-
-    ACC_T bin_size_h =
-        static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
-    ACC_T bin_size_w =
-        static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
-
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int64_t roi_bin_grid_h = (sampling_ratio > 0)
-        ? sampling_ratio
-        : ceil(roi_height / pooled_height); // e.g., = 2
-    int64_t roi_bin_grid_w =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
-
+    int64_t roi_bin_grid_h, roi_bin_grid_w;
+    std::vector<PreCalc<ACC_T>> pre_calc;
     // We do average (integral) pooling inside a bin
-    const ACC_T count = roi_bin_grid_h * roi_bin_grid_w; // e.g. = 4
-
-    // we want to precalculate indices and weights shared by all channels,
-    // this is the key point of optimization
-    std::vector<PreCalc<ACC_T>> pre_calc(
-        roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
-    pre_calc_for_bilinear_interpolate(
+    const ACC_T count = roi_align_pre_calc(
+        offset_rois,
+        spatial_scale,
         height,
         width,
         pooled_height,
         pooled_width,
-        roi_start_h,
-        roi_start_w,
-        bin_size_h,
-        bin_size_w,
+        sampling_ratio,
+        aligned,
         roi_bin_grid_h,
         roi_bin_grid_w,
-        pre_calc);
+        pre_calc); // e.g. = 4
 
     if (is_channels_last) {
       roi_align_single_framework_channels_last_backward<T, ACC_T>(
@@ -666,6 +695,200 @@ void roi_align_backward_kernel_body(
   // });
 }
 
+// The FPN level of each roi, eq. 1 of the feature pyramid networks paper as
+// in torchvision's LevelMapper: floor(canonical_level + log2(sqrt(area) /
+// canonical_scale) + 1e-6), clamped to the levels of the features, minus the
+// first level.
+template <typename ACC_T>
+std::vector<int64_t> map_roi_levels(
+    int64_t n_rois,
+    const ACC_T* rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+  double k_min = std::round(-std::log2(spatial_scales.front()));
+  double k_max = std::round(-std::log2(spatial_scales.back()));
+  std::vector<int64_t> levels(n_rois);
+  at::parallel_for(0, n_rois, 256, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      const ACC_T* offset_rois = rois + n * 5;
+      double area = static_cast<double>(offset_rois[3] - offset_rois[1]) *
+          static_cast<double>(offset_rois[4] - offset_rois[2]);
+      double k = std::floor(
+          canonical_level + std::log2(std::sqrt(area) / canonical_scale) +
+          1e-6);
+      // a degenerate roi, of a nan level, goes to the first level
+      k = std::isnan(k) ? k_min : std::min(std::max(k, k_min), k_max);
+      levels[n] = static_cast<int64_t>(k - k_min);
+    }
+  });
+  return levels;
+}
+
+template <typename T, typename ACC_T>
+void multi_level_roi_align_forward_kernel_body(
+    int64_t n_rois,
+    const std::vector<const T*>& inputs,
+    const std::vector<int64_t>& heights,
+    const std::vector<int64_t>& widths,
+    c10::ArrayRef<double> spatial_scales,
+    const std::vector<int64_t>& levels,
+    int64_t channels,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    const ACC_T* rois,
+    T* output,
+    bool is_channels_last) {
+  // one parallel region over the rois of all the levels
+  at::parallel_for(0, n_rois, 1, [&](int64_t begin, int64_t end) {
+    std::vector<PreCalc<ACC_T>> pre_calc;
+    for (int64_t n = begin; n < end; n++) {
+      const ACC_T* offset_rois = rois + n * 5;
+      int64_t roi_batch_ind = offset_rois[0];
+      int64_t l = levels[n];
+      int64_t height = heights[l];
+      int64_t width = widths[l];
+
+      int64_t roi_bin_grid_h, roi_bin_grid_w;
+      int64_t samples = roi_align_pre_calc(
+          offset_rois,
+          static_cast<ACC_T>(spatial_scales[l]),
+          height,
+          width,
+          pooled_height,
+          pooled_width,
+          sampling_ratio,
+          aligned,
+          roi_bin_grid_h,
+          roi_bin_grid_w,
+          pre_calc);
+      // When the grid is empty, output zeros.
+      const ACC_T count = std::max(samples, (int64_t)1);
+
+      const T* input = inputs[l] + roi_batch_ind * channels * height * width;
+      T* offset_output = output + n * channels * pooled_height * pooled_width;
+      if (is_channels_last) {
+        roi_align_single_framework_channels_last_forward<T, ACC_T>(
+            input,
+            count,
+            channels,
+            height,
+            width,
+            pooled_height,
+            pooled_width,
+            roi_bin_grid_h,
+            roi_bin_grid_w,
+            pre_calc,
+            offset_output);
+      } else {
+        roi_align_single_framework_forward<T, ACC_T>(
+            input,
+            count,
+            channels,
+            height,
+            width,
+            pooled_height,
+            pooled_width,
+            roi_bin_grid_h,
+            roi_bin_grid_w,
+            pre_calc,
+            offset_output);
+      }
+    } // for n
+  });
+}
+
+template <typename T, typename ACC_T>
+void multi_level_roi_align_backward_kernel_body(
+    int64_t n_rois,
+    const T* grad_output,
+    const std::vector<T*>& grad_inputs,
+    const std::vector<int64_t>& heights,
+    const std::vector<int64_t>& widths,
+    c10::ArrayRef<double> spatial_scales,
+    const std::vector<int64_t>& levels,
+    int64_t batch_size,
+    int64_t channels,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    const ACC_T* rois,
+    bool is_channels_last) {
+  // The rois of an image of a level accumulate into the same gradient, a task
+  // runs them one after the other for a block of channels, so that the tasks
+  // write disjoint gradients in one parallel region.
+  int64_t num_levels = heights.size();
+  std::vector<std::vector<int64_t>> buckets(num_levels * batch_size);
+  for (int64_t n = 0; n < n_rois; n++) {
+    int64_t roi_batch_ind = rois[n * 5];
+    buckets[levels[n] * batch_size + roi_batch_ind].push_back(n);
+  }
+  int64_t nblocks = (channels + multi_level_roi_align_channel_block - 1) /
+      multi_level_roi_align_channel_block;
+  int64_t ntasks = num_levels * batch_size * nblocks;
+  at::parallel_for(0, ntasks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<PreCalc<ACC_T>> pre_calc;
+    for (int64_t task = begin; task < end; task++) {
+      int64_t bucket = task / nblocks;
+      int64_t c_begin = task % nblocks * multi_level_roi_align_channel_block;
+      int64_t c_end =
+          std::min(c_begin + multi_level_roi_align_channel_block, channels);
+      int64_t l = bucket / batch_size;
+      int64_t height = heights[l];
+      int64_t width = widths[l];
+      T* grad_input =
+          grad_inputs[l] + bucket % batch_size * channels * height * width;
+      for (int64_t n : buckets[bucket]) {
+        int64_t roi_bin_grid_h, roi_bin_grid_w;
+        const ACC_T count = roi_align_pre_calc(
+            rois + n * 5,
+            static_cast<ACC_T>(spatial_scales[l]),
+            height,
+            width,
+            pooled_height,
+            pooled_width,
+            sampling_ratio,
+            aligned,
+            roi_bin_grid_h,
+            roi_bin_grid_w,
+            pre_calc);
+        const T* offset_grad_output =
+            grad_output + n * channels * pooled_height * pooled_width;
+        if (is_channels_last) {
+          roi_align_channels_last_backward_block<T, ACC_T>(
+              offset_grad_output,
+              count,
+              channels,
+              c_begin,
+              c_end,
+              pooled_height,
+              pooled_width,
+              roi_bin_grid_h,
+              roi_bin_grid_w,
+              pre_calc,
+              grad_input);
+        } else {
+          roi_align_single_framework_backward<T, ACC_T>(
+              offset_grad_output + c_begin * pooled_height * pooled_width,
+              count,
+              c_end - c_begin,
+              height,
+              width,
+              pooled_height,
+              pooled_width,
+              roi_bin_grid_h,
+              roi_bin_grid_w,
+              pre_calc,
+              grad_input + c_begin * height * width);
+        }
+      }
+    }
+  });
+}
+
 at::Tensor roi_align_forward_kernel_impl(
     const at::Tensor& input,
     const at::Tensor& rois,
@@ -784,6 +1007,140 @@ at::Tensor roi_align_backward_kernel_impl(
   return grad_input;
 }
 
+at::Tensor multi_level_roi_align_forward_kernel_impl(
+    at::TensorList features,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level) {
+  auto num_rois = rois.size(0);
+  auto channels = features[0].size(1);
+  auto memory_format = features[0].suggest_memory_format();
+  bool is_channels_last = memory_format == at::MemoryFormat::ChannelsLast;
+  at::Tensor output = at::empty(
+      {num_rois, channels, pooled_height, pooled_width},
+      features[0].options().memory_format(memory_format));
+
+  if (output.numel() == 0)
+    return output;
+
+  std::vector<at::Tensor> features_;
+  std::vector<int64_t> heights, widths;
+  for (const auto& feature : features) {
+    features_.push_back(feature.contiguous(memory_format));
+    heights.push_back(feature.size(2));
+    widths.push_back(feature.size(3));
+  }
+  auto rois_ = rois.contiguous();
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      features[0].scalar_type(),
+      "multi_level_roi_align_forward_kernel_impl",
+      [&] {
+        using accscalar_t = typename AccType<scalar_t>::type;
+        const accscalar_t* rois_data = rois_.data_ptr<accscalar_t>();
+        std::vector<const scalar_t*> inputs;
+        for (const auto& feature : features_) {
+          inputs.push_back(feature.data_ptr<scalar_t>());
+        }
+        multi_level_roi_align_forward_kernel_body<scalar_t, accscalar_t>(
+            num_rois,
+            inputs,
+            heights,
+            widths,
+            spatial_scales,
+            map_roi_levels(
+                num_rois,
+                rois_data,
+                spatial_scales,
+                canonical_scale,
+                canonical_level),
+            channels,
+            pooled_height,
+            pooled_width,
+            sampling_ratio,
+            aligned,
+            rois_data,
+            output.data_ptr<scalar_t>(),
+            is_channels_last);
+      });
+  return output;
+}
+
+std::vector<at::Tensor> multi_level_roi_align_backward_kernel_impl(
+    const at::Tensor& grad,
+    const at::Tensor& rois,
+    c10::ArrayRef<double> spatial_scales,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t batch_size,
+    int64_t channels,
+    at::IntArrayRef heights,
+    at::IntArrayRef widths,
+    int64_t sampling_ratio,
+    bool aligned,
+    int64_t canonical_scale,
+    int64_t canonical_level,
+    bool is_channels_last) {
+  auto memory_format = is_channels_last ? at::MemoryFormat::ChannelsLast
+                                        : at::MemoryFormat::Contiguous;
+  std::vector<at::Tensor> grad_inputs;
+  for (size_t l = 0; l < heights.size(); l++) {
+    grad_inputs.push_back(
+        at::empty(
+            {batch_size, channels, heights[l], widths[l]},
+            grad.options().memory_format(memory_format))
+            .zero_());
+  }
+
+  // handle possibly empty gradients
+  if (grad.numel() == 0) {
+    return grad_inputs;
+  }
+
+  auto grad_ = grad.contiguous(memory_format), rois_ = rois.contiguous();
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      grad.scalar_type(),
+      "multi_level_roi_align_backward_kernel_impl",
+      [&] {
+        using accscalar_t = typename AccType<scalar_t>::type;
+        const accscalar_t* rois_data = rois_.data_ptr<accscalar_t>();
+        std::vector<scalar_t*> grad_input_data;
+        for (auto& grad_input : grad_inputs) {
+          grad_input_data.push_back(grad_input.data_ptr<scalar_t>());
+        }
+        multi_level_roi_align_backward_kernel_body<scalar_t, accscalar_t>(
+            grad_.size(0),
+            grad_.data_ptr<scalar_t>(),
+            grad_input_data,
+            heights.vec(),
+            widths.vec(),
+            spatial_scales,
+            map_roi_levels(
+                grad_.size(0),
+                rois_data,
+                spatial_scales,
+                canonical_scale,
+                canonical_level),
+            batch_size,
+            channels,
+            pooled_height,
+            pooled_width,
+            sampling_ratio,
+            aligned,
+            rois_data,
+            is_channels_last);
+      });
+  return grad_inputs;
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
@@ -792,6 +1149,12 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     roi_align_backward_kernel_stub,
     &roi_align_backward_kernel_impl);
+REGISTER_DISPATCH(
+    multi_level_roi_align_forward_kernel_stub,
+    &multi_level_roi_align_forward_kernel_impl);
+REGISTER_DISPATCH(
+    multi_level_roi_align_backward_kernel_stub,
+    &multi_level_roi_align_backward_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,217 @@
+#include <aten/Reduce.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+
+#include "WelfordKrnl.h"
+#include "utils/parallel_stats.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The fp32 accumulators of a task, which stay in L1
+constexpr int64_t kBlockN = 256;
+// The rows summed into a block before going to the running sums, which bounds
+// the rounding of the fp32 accumulation over a large R
+constexpr int64_t kBlockR = 64;
+// The minimal rows of a chunk when R is split among the threads
+constexpr int64_t kMinChunkR = 256;
+
+// The sum of the "len" contiguous elements of "in" less "center", squared if
+// "squared", for the reductions of the last dims (N = 1).
+template <typename T, bool squared>
+float reduce_contiguous(const T* in, int64_t len, float center) {
+  const fVec vcenter(center);
+  fVec total(0.f);
+  const int64_t block = kBlockR * fVec::size();
+  for (int64_t i = 0; i < len; i += block) {
+    const int64_t end = std::min(len, i + block);
+    fVec acc(0.f);
+    for (int64_t j = i; j < end; j += fVec::size()) {
+      const int64_t count = std::min<int64_t>(fVec::size(), end - j);
+      // the lanes past the tail are 0, not -center
+      auto x = fVec::set(fVec(0.f), load_fvec(in + j, count) - vcenter, count);
+      acc = squared ? at::vec::fmadd(x, x, acc) : acc + x;
+    }
+    total = total + acc;
+  }
+  alignas(64) std::array<float, fVec::size()> lanes;
+  total.store(lanes.data());
+  return std::accumulate(lanes.begin(), lanes.end(), 0.f);
+}
+
+// acc[0, count) = the sums over the rows [r0, r1) of the "count" columns of
+// "in", of N elements a row, less "center" and squared if "squared".
+template <typename T, bool squared>
+void reduce_rows(
+    const T* in,
+    int64_t N,
+    int64_t r0,
+    int64_t r1,
+    int64_t count,
+    const float* center,
+    float* acc) {
+  alignas(64) std::array<float, kBlockN> block;
+  std::fill_n(acc, count, 0.f);
+  for (int64_t r = r0; r < r1; r += kBlockR) {
+    const int64_t rend = std::min(r1, r + kBlockR);
+    std::fill_n(block.data(), count, 0.f);
+    for (int64_t i = r; i < rend; i++) {
+      const T* row = in + i * N;
+      for (int64_t n = 0; n < count; n += fVec::size()) {
+        const int64_t len = std::min<int64_t>(fVec::size(), count - n);
+        auto x = load_fvec(row + n, len);
+        if (squared) {
+          x = x - fVec::loadu(center + n, len);
+        }
+        auto b = fVec::loadu(block.data() + n, len);
+        b = squared ? at::vec::fmadd(x, x, b) : b + x;
+        b.store(block.data() + n, len);
+      }
+    }
+    for (int64_t n = 0; n < count; n += fVec::size()) {
+      const int64_t len = std::min<int64_t>(fVec::size(), count - n);
+      auto a = fVec::loadu(acc + n, len) + fVec::loadu(block.data() + n, len);
+      a.store(acc + n, len);
+    }
+  }
+}
+
+// The fp32 sums [chunks, M, N] of the "chunks" chunks of R, a task being a
+// row of M and a block of kBlockN columns, or a row of M if N = 1.
+template <typename T, bool squared>
+void reduce_pass(
+    const T* in,
+    const ReducePlan& plan,
+    int64_t chunks,
+    const float* center,
+    float* partials) {
+  const int64_t M = plan.M, R = plan.R, N = plan.N;
+  const int64_t blocks = N == 1 ? 1 : at::divup(N, kBlockN);
+  utils::parallel_for(
+      0, M * blocks * chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t t = begin; t < end; t++) {
+          const int64_t c = t % chunks, task = t / chunks;
+          const int64_t m = task / blocks, b = task % blocks;
+          const int64_t r0 = R * c / chunks, r1 = R * (c + 1) / chunks;
+          const T* in_m = in + m * R * N;
+          float* out = partials + c * M * N + m * N;
+          if (N == 1) {
+            *out = reduce_contiguous<T, squared>(
+                in_m + r0, r1 - r0, squared ? center[m] : 0.f);
+          } else {
+            const int64_t n0 = b * kBlockN;
+            reduce_rows<T, squared>(
+                in_m + n0,
+                N,
+                r0,
+                r1,
+                std::min(kBlockN, N - n0),
+                squared ? center + m * N + n0 : nullptr,
+                out + n0);
+          }
+        }
+      });
+}
+
+// Sums the partials [chunks, MN] pairwise, in log2(chunks) rounds, into the
+// first chunk, and stores post(sum) in "out".
+template <typename out_t, typename F>
+void merge_partials(
+    float* partials,
+    int64_t chunks,
+    int64_t MN,
+    out_t* out,
+    const F& post) {
+  utils::parallel_for(0, MN, kBlockN, [&](int64_t begin, int64_t end) {
+    for (int64_t stride = 1; stride < chunks; stride *= 2) {
+      for (int64_t c = 0; c + stride < chunks; c += 2 * stride) {
+        float* dst = partials + c * MN;
+        const float* src = partials + (c + stride) * MN;
+        for (int64_t i = begin; i < end; i++) {
+          dst[i] += src[i];
+        }
+      }
+    }
+    for (int64_t i = begin; i < end; i++) {
+      out[i] = static_cast<out_t>(post(partials[i]));
+    }
+  });
+}
+
+template <typename T, typename out_t>
+void reduce_kernel(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const ReducePlan& plan,
+    ReducePostOp post_op,
+    double correction) {
+  const int64_t M = plan.M, R = plan.R, N = plan.N;
+  const int64_t tasks = M * (N == 1 ? 1 : at::divup(N, kBlockN));
+  // R is split among the threads when the tasks don't keep them busy, e.g.
+  // the pooling heads of a small batch, each thread summing its chunk
+  const int64_t num_threads = at::get_num_threads();
+  const int64_t chunks = tasks >= num_threads
+      ? 1
+      : std::max<int64_t>(
+            1, std::min(at::divup(num_threads, tasks), R / kMinChunkR));
+
+  // the input is dense, its data in the memory order of the plan
+  const T* in = input.data_ptr<T>();
+  out_t* out = output.data_ptr<out_t>();
+  std::vector<float> partials(chunks * M * N);
+  reduce_pass<T, false>(in, plan, chunks, nullptr, partials.data());
+  if (post_op != ReducePostOp::Var) {
+    const float scale = post_op == ReducePostOp::Mean ? 1.f / R : 1.f;
+    merge_partials(partials.data(), chunks, M * N, out, [=](float s) {
+      return s * scale;
+    });
+    return;
+  }
+
+  // the variance of the deviations to the mean, in a second pass
+  std::vector<float> mean(M * N);
+  const float rcp = 1.f / R;
+  merge_partials(partials.data(), chunks, M * N, mean.data(), [=](float s) {
+    return s * rcp;
+  });
+  reduce_pass<T, true>(in, plan, chunks, mean.data(), partials.data());
+  const float scale = 1.f / static_cast<float>(R - correction);
+  merge_partials(partials.data(), chunks, M * N, out, [=](float s) {
+    return s * scale;
+  });
+}
+
+void reduce_kernel_impl(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const ReducePlan& plan,
+    ReducePostOp post_op,
+    double correction) {
+  utils::ParallelStatsScope parallel_stats_scope("reduce");
+  if (input.scalar_type() == at::kFloat) {
+    reduce_kernel<float, float>(input, output, plan, post_op, correction);
+  } else if (output.scalar_type() == at::kFloat) {
+    reduce_kernel<at::BFloat16, float>(
+        input, output, plan, post_op, correction);
+  } else {
+    reduce_kernel<at::BFloat16, at::BFloat16>(
+        input, output, plan, post_op, correction);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(reduce_kernel_stub, &reduce_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,210 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/RotaryPositionEmbedding.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+
+template <typename T>
+inline fVec load_float_vec(const T* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+template <>
+inline fVec load_float_vec<at::BFloat16>(
+    const at::BFloat16* ptr,
+    int64_t count) {
+  auto bvec = at::vec::Vectorized<at::BFloat16>::loadu(ptr, count);
+  return std::get<0>(at::vec::convert_bfloat16_float(bvec));
+}
+
+template <typename T>
+inline void store_float_vec(T* ptr, fVec v, int64_t count) {
+  v.store(ptr, count);
+}
+
+template <>
+inline void store_float_vec<at::BFloat16>(
+    at::BFloat16* ptr,
+    fVec v,
+    int64_t count) {
+  at::vec::convert_float_bfloat16(v, v).store(ptr, count);
+}
+
+// out[i] = x[i] * cos1[i] - x[half + i] * sin1[i]
+// out[half + i] = x[half + i] * cos2[i] + x[i] * sin2[i]
+// both halves are loaded before the stores, so out may be x.
+template <typename T>
+inline void rotate_half_ker(
+    const T* x,
+    T* out,
+    const float* cos1,
+    const float* sin1,
+    const float* cos2,
+    const float* sin2,
+    int64_t half) {
+  for (int64_t i = 0; i < half; i += fVec::size()) {
+    int64_t count = std::min<int64_t>(fVec::size(), half - i);
+    auto x1 = load_float_vec(x + i, count);
+    auto x2 = load_float_vec(x + half + i, count);
+    auto out1 = x1 * fVec::loadu(cos1 + i, count) -
+        x2 * fVec::loadu(sin1 + i, count);
+    auto out2 = at::vec::fmadd(
+        x1, fVec::loadu(sin2 + i, count), x2 * fVec::loadu(cos2 + i, count));
+    store_float_vec(out + i, out1, count);
+    store_float_vec(out + half + i, out2, count);
+  }
+}
+
+template <typename T>
+void rotary_embedding_qkv_kernel(
+    at::Tensor& qkv,
+    const at::Tensor& position_ids,
+    const at::Tensor& cos_table,
+    const at::Tensor& sin_table,
+    int64_t num_heads,
+    int64_t num_kv_heads,
+    int64_t head_size,
+    int64_t rotary_dim) {
+  int64_t num_tokens = position_ids.numel();
+  int64_t row_stride = qkv.size(-1);
+  T* qkv_data = qkv.data_ptr<T>();
+  const int64_t* pos_data = position_ids.data_ptr<int64_t>();
+  const float* cos_data = cos_table.data_ptr<float>();
+  const float* sin_data = sin_table.data_ptr<float>();
+  int64_t half = rotary_dim / 2;
+  // only the query and key heads are rotated
+  int64_t rotated_heads = num_heads + num_kv_heads;
+  at::parallel_for(
+      0, num_tokens * rotated_heads, 0, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; idx++) {
+          int64_t t = idx / rotated_heads;
+          int64_t h = idx % rotated_heads;
+          T* head = qkv_data + t * row_stride + h * head_size;
+          const float* cos_row = cos_data + pos_data[t] * half;
+          const float* sin_row = sin_data + pos_data[t] * half;
+          rotate_half_ker(head, head, cos_row, sin_row, cos_row, sin_row, half);
+        }
+      });
+}
+
+void rotary_embedding_qkv_kernel_impl(
+    at::Tensor& qkv,
+    const at::Tensor& position_ids,
+    const at::Tensor& cos_table,
+    const at::Tensor& sin_table,
+    int64_t num_heads,
+    int64_t num_kv_heads,
+    int64_t head_size,
+    int64_t rotary_dim) {
+  TORCH_CHECK(
+      qkv.is_contiguous(), "rotary_embedding_qkv: expect contiguous qkv");
+  if (qkv.scalar_type() == at::kFloat) {
+    rotary_embedding_qkv_kernel<float>(
+        qkv,
+        position_ids,
+        cos_table,
+        sin_table,
+        num_heads,
+        num_kv_heads,
+        head_size,
+        rotary_dim);
+    return;
+  }
+  TORCH_CHECK(
+      qkv.scalar_type() == at::kBFloat16,
+      "rotary_embedding_qkv only supports float and bfloat16");
+  rotary_embedding_qkv_kernel<at::BFloat16>(
+      qkv,
+      position_ids,
+      cos_table,
+      sin_table,
+      num_heads,
+      num_kv_heads,
+      head_size,
+      rotary_dim);
+}
+
+template <typename T>
+at::Tensor apply_rotary_emb_kernel(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin) {
+  int64_t size = x.size(-1);
+  int64_t half = size / 2;
+  int64_t rows = x.numel() / size;
+  auto out = at::empty_like(x, at::MemoryFormat::Contiguous);
+  // cos/sin rows are indexed through the broadcast (0 stride) outer dims
+  auto cos_e = cos.expand(x.sizes());
+  auto sin_e = sin.expand(x.sizes());
+  const T* x_data = x.data_ptr<T>();
+  T* out_data = out.data_ptr<T>();
+  const float* cos_data = cos_e.data_ptr<float>();
+  const float* sin_data = sin_e.data_ptr<float>();
+  int64_t outer_dims = x.dim() - 1;
+  std::vector<int64_t> sizes(x.sizes().begin(), x.sizes().end() - 1);
+  std::vector<int64_t> cos_strides(
+      cos_e.strides().begin(), cos_e.strides().end() - 1);
+  std::vector<int64_t> sin_strides(
+      sin_e.strides().begin(), sin_e.strides().end() - 1);
+  at::parallel_for(0, rows, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      int64_t cos_offset = 0, sin_offset = 0;
+      for (int64_t d = outer_dims - 1, rem = r; d >= 0; d--) {
+        int64_t i = rem % sizes[d];
+        rem /= sizes[d];
+        cos_offset += i * cos_strides[d];
+        sin_offset += i * sin_strides[d];
+      }
+      const float* cos_row = cos_data + cos_offset;
+      const float* sin_row = sin_data + sin_offset;
+      rotate_half_ker(
+          x_data + r * size,
+          out_data + r * size,
+          cos_row,
+          sin_row,
+          cos_row + half,
+          sin_row + half,
+          half);
+    }
+  });
+  return out;
+}
+
+at::Tensor apply_rotary_emb_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& cos,
+    const at::Tensor& sin) {
+  TORCH_CHECK(
+      x.dim() > 0 && x.size(-1) % 2 == 0,
+      "apply_rotary_emb: expect an even size of the last dim");
+  TORCH_CHECK(
+      cos.size(-1) == x.size(-1) && sin.size(-1) == x.size(-1),
+      "apply_rotary_emb: expect cos/sin of the last dim of x");
+  auto x_ = x.contiguous();
+  // cos/sin are small, their last dim should be dense for the kernel
+  auto cos_ = cos.to(at::kFloat).contiguous();
+  auto sin_ = sin.to(at::kFloat).contiguous();
+  if (x.scalar_type() == at::kFloat) {
+    return apply_rotary_emb_kernel<float>(x_, cos_, sin_);
+  }
+  TORCH_CHECK(
+      x.scalar_type() == at::kBFloat16,
+      "apply_rotary_emb only supports float and bfloat16");
+  return apply_rotary_emb_kernel<at::BFloat16>(x_, cos_, sin_);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    rotary_embedding_qkv_kernel_stub,
+    &rotary_embedding_qkv_kernel_impl);
+REGISTER_DISPATCH(apply_rotary_emb_kernel_stub, &apply_rotary_emb_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,139 @@
+#include <aten/SamplingHead.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "WelfordKrnl.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The vocab rows of the weight whose logits a task computes, a tile of the
+// weight being read once for all the rows of hidden
+constexpr int64_t kVocabTile = 256;
+
+using Candidate = std::pair<float, int64_t>;
+
+// The larger logit first, the smaller index first for ties
+inline bool candidate_before(const Candidate& a, const Candidate& b) {
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+template <typename T>
+inline float dot_ker(const float* x, const T* w, int64_t len) {
+  fVec acc(0.f);
+  int64_t d = 0;
+  for (; d < len - (len % fVec::size()); d += fVec::size()) {
+    acc = at::vec::fmadd(
+        fVec::loadu(x + d), load_fvec(w + d, fVec::size()), acc);
+  }
+  float sum = at::vec::vec_reduce_all<float>(
+      [](fVec& a, fVec& b) { return a + b; }, acc);
+  for (; d < len; d++) {
+    sum += x[d] * float(w[d]);
+  }
+  return sum;
+}
+
+// Keeps the k best candidates of a heap whose top is the worst one
+inline void push_candidate(
+    std::vector<Candidate>& heap,
+    int64_t k,
+    Candidate c) {
+  if (static_cast<int64_t>(heap.size()) < k) {
+    heap.push_back(c);
+    std::push_heap(heap.begin(), heap.end(), candidate_before);
+  } else if (candidate_before(c, heap.front())) {
+    std::pop_heap(heap.begin(), heap.end(), candidate_before);
+    heap.back() = c;
+    std::push_heap(heap.begin(), heap.end(), candidate_before);
+  }
+}
+
+template <typename T>
+void sampling_head_topk_kernel(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t k,
+    at::Tensor& values,
+    at::Tensor& indices) {
+  const int64_t batch = hidden.size(0), K = hidden.size(1);
+  const int64_t vocab = weight.size(0);
+  auto hidden_f = hidden.to(at::kFloat).contiguous();
+  const float* x = hidden_f.data_ptr<float>();
+  const T* w = weight.data_ptr<T>();
+  const float* b = bias.defined() ? bias.data_ptr<float>() : nullptr;
+
+  // a heap per thread and row
+  const int64_t num_threads = at::get_num_threads();
+  std::vector<std::vector<Candidate>> heaps(num_threads * batch);
+  const int64_t num_tiles = at::divup(vocab, kVocabTile);
+  at::parallel_for(0, num_tiles, 1, [&](int64_t begin, int64_t end) {
+    auto* thread_heaps = &heaps[at::get_thread_num() * batch];
+    for (const auto tile : c10::irange(begin, end)) {
+      const int64_t v0 = tile * kVocabTile;
+      const int64_t v1 = std::min(vocab, v0 + kVocabTile);
+      for (const auto v : c10::irange(v0, v1)) {
+        const T* w_row = w + v * K;
+        const float bias_v = b ? b[v] : 0.f;
+        for (const auto r : c10::irange(batch)) {
+          const float logit = dot_ker(x + r * K, w_row, K) + bias_v;
+          push_candidate(thread_heaps[r], k, {logit, v});
+        }
+      }
+    }
+  });
+
+  // merge the heaps of the threads
+  float* values_data = values.data_ptr<float>();
+  int64_t* indices_data = indices.data_ptr<int64_t>();
+  at::parallel_for(0, batch, 1, [&](int64_t begin, int64_t end) {
+    std::vector<Candidate> merged;
+    for (const auto r : c10::irange(begin, end)) {
+      merged.clear();
+      for (const auto t : c10::irange(num_threads)) {
+        const auto& heap = heaps[t * batch + r];
+        merged.insert(merged.end(), heap.begin(), heap.end());
+      }
+      std::partial_sort(
+          merged.begin(), merged.begin() + k, merged.end(), candidate_before);
+      for (const auto i : c10::irange(k)) {
+        values_data[r * k + i] = merged[i].first;
+        indices_data[r * k + i] = merged[i].second;
+      }
+    }
+  });
+}
+
+void sampling_head_topk_kernel_impl(
+    const at::Tensor& hidden,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t k,
+    at::Tensor& values,
+    at::Tensor& indices) {
+  if (hidden.scalar_type() == at::kBFloat16) {
+    sampling_head_topk_kernel<at::BFloat16>(
+        hidden, weight, bias, k, values, indices);
+  } else {
+    sampling_head_topk_kernel<float>(hidden, weight, bias, k, values, indices);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    sampling_head_topk_kernel_stub,
+    &sampling_head_topk_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
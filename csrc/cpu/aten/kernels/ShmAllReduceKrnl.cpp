@@ -0,0 +1,70 @@
+#include <aten/ShmAllReduce.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "WelfordKrnl.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The elements summed by a task, a few pages of each input
+constexpr int64_t kBlock = 4096;
+
+template <typename T>
+void shm_reduce_kernel(
+    const std::vector<const T*>& inputs,
+    T* output,
+    int64_t numel) {
+  const int64_t num_inputs = inputs.size();
+  at::parallel_for(0, numel, kBlock, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i += fVec::size()) {
+      const int64_t count = std::min<int64_t>(fVec::size(), end - i);
+      auto sum = load_fvec(inputs[0] + i, count);
+      for (int64_t r = 1; r < num_inputs; r++) {
+        sum = sum + load_fvec(inputs[r] + i, count);
+      }
+      store_fvec(output + i, sum, count);
+    }
+  });
+}
+
+template <typename T>
+void shm_reduce_dispatch(
+    const std::vector<const void*>& inputs,
+    void* output,
+    int64_t numel) {
+  std::vector<const T*> typed_inputs;
+  for (const void* input : inputs) {
+    typed_inputs.push_back(static_cast<const T*>(input));
+  }
+  shm_reduce_kernel<T>(typed_inputs, static_cast<T*>(output), numel);
+}
+
+void shm_reduce_kernel_impl(
+    const std::vector<const void*>& inputs,
+    void* output,
+    int64_t numel,
+    at::ScalarType dtype) {
+  if (inputs.empty() || numel == 0) {
+    return;
+  }
+  if (dtype == at::kBFloat16) {
+    shm_reduce_dispatch<at::BFloat16>(inputs, output, numel);
+  } else {
+    shm_reduce_dispatch<float>(inputs, output, numel);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(shm_reduce_kernel_stub, &shm_reduce_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
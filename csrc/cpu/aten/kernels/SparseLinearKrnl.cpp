@@ -0,0 +1,199 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/SparseLinear.h>
+#include "vec/vec.h"
+
+/*
+ GEMM on a weight of sparse_linear_block_n x 1 blocks, stored by block row
+ with a bitmask of their input features. A task computes one block row for a
+ chunk of sparse_linear_chunk_m input rows, sparse_linear_block_m rows at a
+ time: each stored block is loaded once per sparse_linear_block_m rows and
+ multiplied with their broadcast input feature, the zero blocks are never
+ read. The values of a block row stay in cache across the rows of the chunk.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+const int64_t sparse_linear_block_m = 4;
+const int64_t sparse_linear_chunk_m = 64;
+const int64_t sparse_linear_mask_bits = 64;
+// fp32 vectors of a block, 1 with AVX512 and 2 with AVX2
+constexpr int64_t sparse_linear_block_vecs =
+    sparse_linear_block_n / fVec::size();
+
+inline void load_block(const float* ptr, fVec* v) {
+  for (int64_t i = 0; i < sparse_linear_block_vecs; i++) {
+    v[i] = fVec::loadu(ptr + i * fVec::size());
+  }
+}
+
+inline void load_block(const at::BFloat16* ptr, fVec* v) {
+  // a bVec holds 2 fVec, the block is half of it with AVX512
+  fVec lo, hi;
+  for (int64_t i = 0; i < sparse_linear_block_vecs; i += 2) {
+    int64_t count = std::min(
+        static_cast<int64_t>(bVec::size()),
+        sparse_linear_block_n - i * fVec::size());
+    std::tie(lo, hi) = at::vec::convert_bfloat16_float(
+        bVec::loadu(ptr + i * fVec::size(), count));
+    v[i] = lo;
+    if (i + 1 < sparse_linear_block_vecs) {
+      v[i + 1] = hi;
+    }
+  }
+}
+
+inline fVec apply_post_op(const fVec& v, SparseLinearPostOp post_op) {
+  if (post_op == SparseLinearPostOp::RELU) {
+    return at::vec::maximum(v, fVec(0.f));
+  } else if (post_op == SparseLinearPostOp::SIGMOID) {
+    return kernel::vec_sigmoid(v);
+  }
+  return v;
+}
+
+// out[m][0, nb) = post_op(x[m] * w^T + bias) for MB rows of x and out and the
+// block row of w given by its masks and stored blocks
+template <typename T, int64_t MB>
+void sparse_linear_block(
+    const T* x,
+    const uint64_t* masks,
+    const T* blocks,
+    const float* bias,
+    T* out,
+    int64_t nb,
+    int64_t N,
+    int64_t K,
+    SparseLinearPostOp post_op) {
+  constexpr int64_t VB = sparse_linear_block_vecs;
+  fVec acc[MB][VB];
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t v = 0; v < VB; v++) {
+      acc[m][v] = fVec::loadu(bias + v * fVec::size());
+    }
+  }
+  int64_t num_words =
+      (K + sparse_linear_mask_bits - 1) / sparse_linear_mask_bits;
+  for (int64_t i = 0; i < num_words; i++) {
+    for (uint64_t word = masks[i]; word; word &= word - 1) {
+      int64_t k = i * sparse_linear_mask_bits + __builtin_ctzll(word);
+      fVec w[VB];
+      load_block(blocks, w);
+      blocks += sparse_linear_block_n;
+      for (int64_t m = 0; m < MB; m++) {
+        fVec xv(static_cast<float>(x[m * K + k]));
+        for (int64_t v = 0; v < VB; v++) {
+          acc[m][v] = at::vec::fmadd(xv, w[v], acc[m][v]);
+        }
+      }
+    }
+  }
+  float buf[sparse_linear_block_n];
+  for (int64_t m = 0; m < MB; m++) {
+    for (int64_t v = 0; v < VB; v++) {
+      apply_post_op(acc[m][v], post_op).store(buf + v * fVec::size());
+    }
+    for (int64_t n = 0; n < nb; n++) {
+      out[m * N + n] = static_cast<T>(buf[n]);
+    }
+  }
+}
+
+template <typename T>
+using sparse_linear_block_fn = decltype(&sparse_linear_block<T, 1>);
+
+template <typename T>
+sparse_linear_block_fn<T> get_sparse_linear_block(int64_t MB) {
+  static const sparse_linear_block_fn<T> fns[sparse_linear_block_m] = {
+      sparse_linear_block<T, 1>,
+      sparse_linear_block<T, 2>,
+      sparse_linear_block<T, 3>,
+      sparse_linear_block<T, 4>};
+  return fns[MB - 1];
+}
+
+template <typename T>
+void sparse_linear_kernel(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output,
+    SparseLinearPostOp post_op) {
+  int64_t M = input.size(0);
+  int64_t N = weight.out_features;
+  int64_t K = weight.in_features;
+  int64_t num_n_blocks =
+      (N + sparse_linear_block_n - 1) / sparse_linear_block_n;
+  int64_t num_words =
+      (K + sparse_linear_mask_bits - 1) / sparse_linear_mask_bits;
+  int64_t num_m_chunks =
+      (M + sparse_linear_chunk_m - 1) / sparse_linear_chunk_m;
+  const T* x = input.data_ptr<T>();
+  const auto masks =
+      reinterpret_cast<const uint64_t*>(weight.block_masks.data_ptr<int64_t>());
+  const int64_t* offsets = weight.block_offsets.data_ptr<int64_t>();
+  const T* values = weight.values.data_ptr<T>();
+  const T* b = bias.defined() ? bias.data_ptr<T>() : nullptr;
+  T* out = output.data_ptr<T>();
+
+  // consecutive tasks share the block row
+  at::parallel_for(
+      0, num_n_blocks * num_m_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t n_block = i / num_m_chunks;
+          int64_t m_begin = i % num_m_chunks * sparse_linear_chunk_m;
+          int64_t m_end = std::min(m_begin + sparse_linear_chunk_m, M);
+          int64_t n0 = n_block * sparse_linear_block_n;
+          int64_t nb = std::min(sparse_linear_block_n, N - n0);
+          float bias_block[sparse_linear_block_n] = {0.f};
+          for (int64_t n = 0; b && n < nb; n++) {
+            bias_block[n] = static_cast<float>(b[n0 + n]);
+          }
+          for (int64_t m = m_begin; m < m_end; m += sparse_linear_block_m) {
+            int64_t mb = std::min(sparse_linear_block_m, m_end - m);
+            get_sparse_linear_block<T>(mb)(
+                x + m * K,
+                masks + n_block * num_words,
+                values + offsets[n_block] * sparse_linear_block_n,
+                bias_block,
+                out + m * N + n0,
+                nb,
+                N,
+                K,
+                post_op);
+          }
+        }
+      });
+}
+
+void sparse_linear_kernel_impl(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output,
+    SparseLinearPostOp post_op) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (input.scalar_type() == at::kFloat) {
+    sparse_linear_kernel<float>(input, weight, bias, output, post_op);
+  } else {
+    TORCH_CHECK(
+        input.scalar_type() == at::kBFloat16,
+        "sparse_linear_kernel only supports float and bfloat16");
+    sparse_linear_kernel<at::BFloat16>(input, weight, bias, output, post_op);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(sparse_linear_kernel_stub, &sparse_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,207 @@
+#include <ATen/cpu/vec/vec.h>
+#include <aten/StreamingLSTM.h>
+#include <omp.h>
+#include "vec/vec.h"
+
+/*
+ The recurrent steps of a chunk run in one parallel region. The blocks of
+ hidden units are split statically between the threads, so that a thread reads
+ the same packed weight blocks at every step and they stay in its cache, and
+ the steps are separated by a barrier. For a block of hidden units and up to
+ streaming_lstm_max_rows batch rows, the 4 gates are accumulated in registers
+ from the input projection and h[t - 1] * weight_hh, then the activations and
+ the c and h updates are applied before anything is stored. h is double
+ buffered between the steps, c is updated in place by its only owner.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+// batch rows sharing the weight vectors loaded for a hidden unit
+const int64_t streaming_lstm_max_rows = 4;
+
+static_assert(
+    streaming_lstm_block % fVec::size() == 0,
+    "streaming_lstm_block must be a multiple of the vector size");
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+inline fVec sigmoid(const fVec& x) {
+  return kernel::vec_sigmoid(x);
+}
+
+// One step of the hidden units [hb, hb + count) of the batch rows
+// [b0, b0 + BB), w pointing to the lanes of hb in the packed weight block
+template <typename T, int64_t BB>
+void lstm_cell_block(
+    const T* gates_x,
+    const T* w,
+    const float* h_prev,
+    float* h_next,
+    float* c,
+    T* out,
+    int64_t b0,
+    int64_t hb,
+    int64_t count,
+    int64_t H) {
+  const int64_t V = fVec::size();
+  fVec acc[BB][4];
+  for (int64_t b = 0; b < BB; b++) {
+    for (int64_t g = 0; g < 4; g++) {
+      acc[b][g] =
+          load_fvec(gates_x + (b0 + b) * 4 * H + g * H + hb, count);
+    }
+  }
+  for (int64_t k = 0; k < H; k++) {
+    const T* w_k = w + k * 4 * streaming_lstm_block;
+    fVec wv[4];
+    for (int64_t g = 0; g < 4; g++) {
+      // the padding lanes are zeros
+      wv[g] = load_fvec(w_k + g * streaming_lstm_block, V);
+    }
+    for (int64_t b = 0; b < BB; b++) {
+      auto hv = fVec(h_prev[(b0 + b) * H + k]);
+      for (int64_t g = 0; g < 4; g++) {
+        acc[b][g] = at::vec::fmadd(hv, wv[g], acc[b][g]);
+      }
+    }
+  }
+  for (int64_t b = 0; b < BB; b++) {
+    int64_t offset = (b0 + b) * H + hb;
+    auto i = sigmoid(acc[b][0]);
+    auto f = sigmoid(acc[b][1]);
+    auto g = kernel::vec_tanh(acc[b][2]);
+    auto o = sigmoid(acc[b][3]);
+    auto cv = f * fVec::loadu(c + offset, count) + i * g;
+    auto hv = o * kernel::vec_tanh(cv);
+    cv.store(c + offset, count);
+    hv.store(h_next + offset, count);
+    store_fvec(out + offset, hv, count);
+  }
+}
+
+template <typename T>
+void lstm_cell_rows(
+    const T* gates_x,
+    const T* w,
+    const float* h_prev,
+    float* h_next,
+    float* c,
+    T* out,
+    int64_t B,
+    int64_t hb,
+    int64_t count,
+    int64_t H) {
+  int64_t b0 = 0;
+  for (; b0 + streaming_lstm_max_rows <= B; b0 += streaming_lstm_max_rows) {
+    lstm_cell_block<T, streaming_lstm_max_rows>(
+        gates_x, w, h_prev, h_next, c, out, b0, hb, count, H);
+  }
+  for (; b0 < B; b0++) {
+    lstm_cell_block<T, 1>(
+        gates_x, w, h_prev, h_next, c, out, b0, hb, count, H);
+  }
+}
+
+template <typename T>
+void streaming_lstm_kernel(
+    const at::Tensor& gates_x,
+    const at::Tensor& packed_weight_hh,
+    at::Tensor& h,
+    at::Tensor& c,
+    at::Tensor& output) {
+  int64_t steps = output.size(0);
+  int64_t B = output.size(1);
+  int64_t H = output.size(2);
+  int64_t NB = packed_weight_hh.size(0);
+  const int64_t V = fVec::size();
+  // h[t - 1] and h[t] of the step
+  auto h_buffer = at::empty({2, B, H}, h.options());
+  h_buffer[0].copy_(h);
+  const T* gx = gates_x.data_ptr<T>();
+  const T* w = packed_weight_hh.data_ptr<T>();
+  float* h_ptr = h_buffer.data_ptr<float>();
+  float* c_ptr = c.data_ptr<float>();
+  T* out = output.data_ptr<T>();
+  int num_threads = std::min<int64_t>(omp_get_max_threads(), NB);
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    int64_t nthr = omp_get_num_threads();
+    int64_t tid = omp_get_thread_num();
+    int64_t chunk = (NB + nthr - 1) / nthr;
+    int64_t nb_begin = std::min(tid * chunk, NB);
+    int64_t nb_end = std::min(nb_begin + chunk, NB);
+    for (int64_t t = 0; t < steps; t++) {
+      const float* h_prev = h_ptr + (t % 2) * B * H;
+      float* h_next = h_ptr + ((t + 1) % 2) * B * H;
+      for (int64_t nb = nb_begin; nb < nb_end; nb++) {
+        for (int64_t j = 0; j < streaming_lstm_block; j += V) {
+          int64_t hb = nb * streaming_lstm_block + j;
+          if (hb >= H) {
+            break;
+          }
+          lstm_cell_rows(
+              gx + t * B * 4 * H,
+              w + nb * H * 4 * streaming_lstm_block + j,
+              h_prev,
+              h_next,
+              c_ptr,
+              out + t * B * H,
+              B,
+              hb,
+              std::min(V, H - hb),
+              H);
+        }
+      }
+      // h[t] is complete before the next step reads it
+#pragma omp barrier
+    }
+  }
+  h.copy_(h_buffer[steps % 2]);
+}
+
+void streaming_lstm_kernel_impl(
+    const at::Tensor& gates_x,
+    const at::Tensor& packed_weight_hh,
+    at::Tensor& h,
+    at::Tensor& c,
+    at::Tensor& output) {
+  if (output.numel() == 0) {
+    return;
+  }
+  if (gates_x.scalar_type() == at::kFloat) {
+    streaming_lstm_kernel<float>(gates_x, packed_weight_hh, h, c, output);
+  } else {
+    streaming_lstm_kernel<at::BFloat16>(
+        gates_x, packed_weight_hh, h, c, output);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(streaming_lstm_kernel_stub, &streaming_lstm_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <algorithm>
+#include <vector>
+
+// Shared pieces of the channels-last normalization kernels. The per channel
+// moments of the [rows, C] blocks of a channels-last input are computed by a
+// single Welford pass per block, one partial per task, and the partials are
+// merged pairwise in log2(blocks) parallel rounds (Chan et al.). Unlike the
+// sum of squares, the merged variance does not cancel catastrophically for
+// the large volumes of 3D segmentation models.
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+inline fVec load_fvec(const float* ptr, int64_t count) {
+  return fVec::loadu(ptr, count);
+}
+
+inline fVec load_fvec(const at::BFloat16* ptr, int64_t count) {
+  fVec lo, hi;
+  std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(ptr, count));
+  return lo;
+}
+
+inline void store_fvec(float* ptr, const fVec& v, int64_t count) {
+  v.store(ptr, count);
+}
+
+inline void store_fvec(at::BFloat16* ptr, const fVec& v, int64_t count) {
+  at::vec::convert_float_bfloat16(v, fVec(0.f)).store(ptr, count);
+}
+
+// mean[c] and m2[c] of the rows of the [rows, C] block "in". All the channels
+// see the same count, so the update of a row costs a single reciprocal.
+template <typename T>
+inline void welford_channels_last(
+    const T* in,
+    int64_t rows,
+    int64_t C,
+    float* mean,
+    float* m2) {
+  std::fill_n(mean, C, 0.f);
+  std::fill_n(m2, C, 0.f);
+  for (int64_t r = 0; r < rows; r++) {
+    const fVec rcp(1.f / static_cast<float>(r + 1));
+    const T* row = in + r * C;
+    for (int64_t c = 0; c < C; c += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+      auto x = load_fvec(row + c, count);
+      auto m = fVec::loadu(mean + c, count);
+      auto delta = x - m;
+      m = m + delta * rcp;
+      auto s = fVec::loadu(m2 + c, count) + delta * (x - m);
+      m.store(mean + c, count);
+      s.store(m2 + c, count);
+    }
+  }
+}
+
+// Merges the Welford partials [groups, blocks, 2, C] (mean then m2 of each
+// block, counts[groups * blocks] rows) into the first block of each group,
+// whose count becomes the count of the group.
+inline void welford_merge_partials(
+    float* partials,
+    std::vector<int64_t>& counts,
+    int64_t groups,
+    int64_t blocks,
+    int64_t C) {
+  for (int64_t stride = 1; stride < blocks; stride *= 2) {
+    const int64_t pairs = (blocks + 2 * stride - 1) / (2 * stride);
+    at::parallel_for(0, groups * pairs, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const int64_t a = (p / pairs) * blocks + (p % pairs) * 2 * stride;
+        const int64_t b = a + stride;
+        if ((p % pairs) * 2 * stride + stride >= blocks || counts[b] == 0) {
+          continue;
+        }
+        const float na = counts[a];
+        const float nb = counts[b];
+        const fVec wb(nb / (na + nb));
+        const fVec wab(na * nb / (na + nb));
+        float* mean_a = partials + a * 2 * C;
+        const float* mean_b = partials + b * 2 * C;
+        for (int64_t c = 0; c < C; c += fVec::size()) {
+          int64_t count = std::min(static_cast<int64_t>(fVec::size()), C - c);
+          auto ma = fVec::loadu(mean_a + c, count);
+          auto delta = fVec::loadu(mean_b + c, count) - ma;
+          auto sa = fVec::loadu(mean_a + C + c, count) +
+              fVec::loadu(mean_b + C + c, count) + delta * delta * wab;
+          (ma + delta * wb).store(mean_a + c, count);
+          sa.store(mean_a + C + c, count);
+        }
+        counts[a] += counts[b];
+      }
+    });
+  }
+}
+
+// Sums the partials [groups, blocks, width] pairwise into the first block of
+// each group
+inline void sum_merge_partials(
+    float* partials,
+    int64_t groups,
+    int64_t blocks,
+    int64_t width) {
+  for (int64_t stride = 1; stride < blocks; stride *= 2) {
+    const int64_t pairs = (blocks + 2 * stride - 1) / (2 * stride);
+    at::parallel_for(0, groups * pairs, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const int64_t j = (p % pairs) * 2 * stride;
+        if (j + stride >= blocks) {
+          continue;
+        }
+        float* a = partials + ((p / pairs) * blocks + j) * width;
+        const float* b = a + stride * width;
+        at::vec::map2<float>(
+            [](fVec x, fVec y) { return x + y; }, a, a, b, width);
+      }
+    });
+  }
+}
+
+// The smallest spatial block of a row the backward of the normalizations
+// splits the rows into, below which the partials cost more than they save
+constexpr int64_t kMinSpatialBlock = 4096;
+
+// The length of the blocks the rows [rows, len] are split into, so that the
+// rows * blocks tasks keep all the threads busy at the small batch sizes where
+// the rows alone do not. The blocks are whole vectors of the row, and the
+// rows are not split when they are enough on their own.
+inline int64_t spatial_block_size(int64_t rows, int64_t len) {
+  const int64_t num_threads = at::get_num_threads();
+  if (rows >= num_threads || len <= kMinSpatialBlock) {
+    return len;
+  }
+  const int64_t blocks = std::min(
+      at::divup(num_threads, rows), at::divup(len, kMinSpatialBlock));
+  const int64_t align = 4 * fVec::size();
+  return std::min(len, at::divup(at::divup(len, blocks), align) * align);
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
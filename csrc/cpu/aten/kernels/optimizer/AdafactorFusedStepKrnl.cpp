@@ -0,0 +1,390 @@
+#include <aten/optimizer/optimizer.h>
+#include "FusedStepBlockKrnl.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+#include <cmath>
+
+/*
+ The param is viewed as [B, R, C], with the factored second moments in
+ exp_avg_sq_row [B, R] and exp_avg_sq_col [B, C], or as a single row with the
+ second moments in exp_avg_sq if it is not factored. The work is cut in tasks
+ of a block of fused_step_block_size elements of a row. The update is needed
+ twice, for its RMS, which clips it, and to update the param, so it is
+ recomputed from the grad in the last pass instead of being kept in a buffer
+ of the size of the param:
+ 1. the row sums of grad^2 + eps1 and the sum of param^2 (or exp_avg_sq and
+    the sums of param^2 and update^2 if not factored),
+ 2. the column sums of grad^2 + eps1 by column blocks,
+ 3. the sum of update^2, with update = grad * rsqrt(row / mean(row) * col),
+ 4. the update of the param and of exp_avg.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+
+struct AdafactorCoefficients {
+  float learning_rate, beta1, beta2, eps1, eps2, clip_threshold, weight_decay;
+  bool scale_parameter;
+};
+
+inline float sum_all(const fVec& acc_vec) {
+  return at::vec::vec_reduce_all(
+      [](fVec& x, fVec& y) { return x + y; }, acc_vec);
+}
+
+template <typename param_t, typename grad_t>
+void adafactor_fused_step_kernel(
+    const at::Tensor& param,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_sq_row,
+    const at::Tensor& exp_avg_sq_col,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& grad,
+    const at::Tensor& param2,
+    const AdafactorCoefficients& c,
+    uint64_t seed) {
+  param_t* param_data = param.data_ptr<param_t>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
+  const grad_t* grad_data = grad.data_ptr<grad_t>();
+  float* exp_avg_data = exp_avg.numel() ? exp_avg.data_ptr<float>() : nullptr;
+  int64_t numel = param.numel();
+  bool factored = exp_avg_sq_row.numel() > 0;
+  float* row_data = factored ? exp_avg_sq_row.data_ptr<float>() : nullptr;
+  float* col_data = factored ? exp_avg_sq_col.data_ptr<float>() : nullptr;
+  float* exp_avg_sq_data = factored ? nullptr : exp_avg_sq.data_ptr<float>();
+
+  int64_t num_cols = factored ? exp_avg_sq_col.size(-1) : numel;
+  int64_t num_rows = factored ? exp_avg_sq_row.numel() : 1;
+  int64_t rows_per_batch = factored ? exp_avg_sq_row.size(-1) : 1;
+  int64_t blocks_per_row =
+      (num_cols + fused_step_block_size - 1) / fused_step_block_size;
+  int64_t num_tasks = num_rows * blocks_per_row;
+  float beta2 = c.beta2;
+  float eps1 = c.eps1;
+
+  auto task_range = [&](int64_t t, int64_t& row, int64_t& col, int64_t& n) {
+    row = t / blocks_per_row;
+    col = (t % blocks_per_row) * fused_step_block_size;
+    n = std::min(fused_step_block_size, num_cols - col);
+  };
+
+  // 1. the sums of the tasks, summed in order afterwards so that they do not
+  // depend on the number of threads
+  std::vector<double> param_sq_acc(num_tasks);
+  std::vector<double> update_sq_acc(num_tasks);
+  std::vector<double> row_acc(factored ? num_tasks : 0);
+  at::parallel_for(0, num_tasks, 16, [&](int64_t begin, int64_t end) {
+    float p[fused_step_block_size];
+    float g[fused_step_block_size];
+    for (int64_t t = begin; t < end; t++) {
+      int64_t row, col, n;
+      task_range(t, row, col, n);
+      int64_t offset = row * num_cols + col;
+      load_param_block(
+          param_data + offset,
+          param2_data ? param2_data + offset : nullptr,
+          p,
+          n);
+      load_grad_block(grad_data + offset, g, n);
+      param_sq_acc[t] = sum_of_squares(p, n);
+      if (factored) {
+        row_acc[t] = sum_of_squares(g, n) + eps1 * n;
+        continue;
+      }
+      float* v_ptr = exp_avg_sq_data + offset;
+      fVec update_sq_vec(0.f);
+      int64_t d = 0;
+      for (; d < n - (n % fVec::size()); d += fVec::size()) {
+        fVec grad_vec = fVec::loadu(g + d);
+        fVec v_vec = fVec::loadu(v_ptr + d) * fVec(beta2) +
+            (grad_vec * grad_vec + fVec(eps1)) * fVec(1 - beta2);
+        v_vec.store(v_ptr + d);
+        fVec update_vec = grad_vec * v_vec.rsqrt();
+        update_sq_vec += update_vec * update_vec;
+      }
+      float update_sq = sum_all(update_sq_vec);
+      for (; d < n; d++) {
+        v_ptr[d] = v_ptr[d] * beta2 + (g[d] * g[d] + eps1) * (1 - beta2);
+        float update = g[d] / std::sqrt(v_ptr[d]);
+        update_sq += update * update;
+      }
+      update_sq_acc[t] = update_sq;
+    }
+  });
+
+  // the row and column factors of the update
+  std::vector<float> row_factor(factored ? num_rows : 0);
+  std::vector<float> col_factor(factored ? num_rows / rows_per_batch * num_cols
+                                         : 0);
+  if (factored) {
+    at::parallel_for(0, num_rows, 64, [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; row++) {
+        double sum = 0;
+        for (int64_t b = 0; b < blocks_per_row; b++) {
+          sum += row_acc[row * blocks_per_row + b];
+        }
+        row_data[row] =
+            row_data[row] * beta2 + float(sum / num_cols) * (1 - beta2);
+      }
+    });
+    int64_t num_batches = num_rows / rows_per_batch;
+    for (int64_t b = 0; b < num_batches; b++) {
+      double mean = 0;
+      for (int64_t r = 0; r < rows_per_batch; r++) {
+        mean += row_data[b * rows_per_batch + r];
+      }
+      mean /= rows_per_batch;
+      for (int64_t r = 0; r < rows_per_batch; r++) {
+        int64_t row = b * rows_per_batch + r;
+        row_factor[row] = 1 / std::sqrt(float(row_data[row] / mean));
+      }
+    }
+
+    // 2. the column sums, a task summing a block of the columns of a batch
+    at::parallel_for(
+        0, num_batches * blocks_per_row, 1, [&](int64_t begin, int64_t end) {
+          float g[fused_step_block_size];
+          float acc[fused_step_block_size];
+          for (int64_t t = begin; t < end; t++) {
+            int64_t batch, col, n;
+            task_range(t, batch, col, n);
+            std::fill(acc, acc + n, 0.f);
+            for (int64_t r = 0; r < rows_per_batch; r++) {
+              int64_t offset =
+                  (batch * rows_per_batch + r) * num_cols + col;
+              load_grad_block(grad_data + offset, g, n);
+              int64_t d = 0;
+              for (; d < n - (n % fVec::size()); d += fVec::size()) {
+                fVec grad_vec = fVec::loadu(g + d);
+                (fVec::loadu(acc + d) + grad_vec * grad_vec + fVec(eps1))
+                    .store(acc + d);
+              }
+              for (; d < n; d++) {
+                acc[d] += g[d] * g[d] + eps1;
+              }
+            }
+            float* col_ptr = col_data + batch * num_cols + col;
+            float* col_factor_ptr = col_factor.data() + batch * num_cols + col;
+            for (int64_t d = 0; d < n; d++) {
+              col_ptr[d] = col_ptr[d] * beta2 +
+                  acc[d] / rows_per_batch * (1 - beta2);
+              col_factor_ptr[d] = 1 / std::sqrt(col_ptr[d]);
+            }
+          }
+        });
+
+    // 3. the sums of update^2
+    at::parallel_for(0, num_tasks, 16, [&](int64_t begin, int64_t end) {
+      float g[fused_step_block_size];
+      for (int64_t t = begin; t < end; t++) {
+        int64_t row, col, n;
+        task_range(t, row, col, n);
+        load_grad_block(grad_data + row * num_cols + col, g, n);
+        const float* col_factor_ptr =
+            col_factor.data() + row / rows_per_batch * num_cols + col;
+        fVec row_factor_vec(row_factor[row]);
+        fVec update_sq_vec(0.f);
+        int64_t d = 0;
+        for (; d < n - (n % fVec::size()); d += fVec::size()) {
+          fVec update_vec = fVec::loadu(g + d) * row_factor_vec *
+              fVec::loadu(col_factor_ptr + d);
+          update_sq_vec += update_vec * update_vec;
+        }
+        float update_sq = sum_all(update_sq_vec);
+        for (; d < n; d++) {
+          float update = g[d] * row_factor[row] * col_factor_ptr[d];
+          update_sq += update * update;
+        }
+        update_sq_acc[t] = update_sq;
+      }
+    });
+  }
+
+  double param_sq = 0, update_sq = 0;
+  for (int64_t t = 0; t < num_tasks; t++) {
+    param_sq += param_sq_acc[t];
+    update_sq += update_sq_acc[t];
+  }
+  float alpha = c.learning_rate;
+  if (c.scale_parameter) {
+    alpha *= std::max(c.eps2, float(std::sqrt(param_sq / numel)));
+  }
+  float update_rms = std::sqrt(update_sq / numel);
+  float update_scale = alpha / std::max(1.f, update_rms / c.clip_threshold);
+  float param_decay = 1 - c.weight_decay * alpha;
+  float beta1 = c.beta1;
+
+  // 4. the update
+  at::parallel_for(0, num_tasks, 16, [&](int64_t begin, int64_t end) {
+    float p[fused_step_block_size];
+    float g[fused_step_block_size];
+    float u[fused_step_block_size];
+    for (int64_t t = begin; t < end; t++) {
+      int64_t row, col, n;
+      task_range(t, row, col, n);
+      int64_t offset = row * num_cols + col;
+      at::BFloat16* param2_ptr = param2_data ? param2_data + offset : nullptr;
+      load_param_block(param_data + offset, param2_ptr, p, n);
+      load_grad_block(grad_data + offset, g, n);
+      // the scaled update, u = update_scale * grad * factor
+      int64_t d = 0;
+      if (factored) {
+        const float* col_factor_ptr =
+            col_factor.data() + row / rows_per_batch * num_cols + col;
+        fVec scale_vec(row_factor[row] * update_scale);
+        for (; d < n - (n % fVec::size()); d += fVec::size()) {
+          (fVec::loadu(g + d) * scale_vec * fVec::loadu(col_factor_ptr + d))
+              .store(u + d);
+        }
+        for (; d < n; d++) {
+          u[d] = g[d] * row_factor[row] * update_scale * col_factor_ptr[d];
+        }
+      } else {
+        const float* v_ptr = exp_avg_sq_data + offset;
+        for (; d < n - (n % fVec::size()); d += fVec::size()) {
+          (fVec::loadu(g + d) * fVec::loadu(v_ptr + d).rsqrt() *
+           fVec(update_scale))
+              .store(u + d);
+        }
+        for (; d < n; d++) {
+          u[d] = g[d] / std::sqrt(v_ptr[d]) * update_scale;
+        }
+      }
+      float* m_ptr = exp_avg_data ? exp_avg_data + offset : nullptr;
+      d = 0;
+      for (; d < n - (n % fVec::size()); d += fVec::size()) {
+        fVec update_vec = fVec::loadu(u + d);
+        if (m_ptr) {
+          update_vec = fVec::loadu(m_ptr + d) * fVec(beta1) +
+              update_vec * fVec(1 - beta1);
+          update_vec.store(m_ptr + d);
+        }
+        (fVec::loadu(p + d) * fVec(param_decay) - update_vec).store(p + d);
+      }
+      for (; d < n; d++) {
+        float update = u[d];
+        if (m_ptr) {
+          m_ptr[d] = m_ptr[d] * beta1 + update * (1 - beta1);
+          update = m_ptr[d];
+        }
+        p[d] = p[d] * param_decay - update;
+      }
+      store_param_block(param_data + offset, param2_ptr, p, n, seed, offset);
+    }
+  });
+}
+
+void adafactor_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_row_,
+    const at::Tensor& exp_avg_sq_col_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double learning_rate,
+    double beta1,
+    double beta2,
+    double eps1,
+    double eps2,
+    double clip_threshold,
+    double weight_decay,
+    bool scale_parameter) {
+  auto param = param_.contiguous();
+  auto exp_avg = exp_avg_.contiguous();
+  auto exp_avg_sq_row = exp_avg_sq_row_.contiguous();
+  auto exp_avg_sq_col = exp_avg_sq_col_.contiguous();
+  auto exp_avg_sq = exp_avg_sq_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+  uint64_t seed = stochastic_rounding_seed(param, param2);
+
+  AdafactorCoefficients c;
+  c.learning_rate = float(learning_rate);
+  c.beta1 = float(beta1);
+  c.beta2 = float(beta2);
+  c.eps1 = float(eps1);
+  c.eps2 = float(eps2);
+  c.clip_threshold = float(clip_threshold);
+  c.weight_decay = float(weight_decay);
+  c.scale_parameter = scale_parameter;
+
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
+  if (at::ScalarType::Float == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    adafactor_fused_step_kernel<float, float>(
+        param,
+        exp_avg,
+        exp_avg_sq_row,
+        exp_avg_sq_col,
+        exp_avg_sq,
+        grad,
+        param2,
+        c,
+        seed);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::BFloat16 == param_dtype) {
+    adafactor_fused_step_kernel<at::BFloat16, at::BFloat16>(
+        param,
+        exp_avg,
+        exp_avg_sq_row,
+        exp_avg_sq_col,
+        exp_avg_sq,
+        grad,
+        param2,
+        c,
+        seed);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    adafactor_fused_step_kernel<float, at::BFloat16>(
+        param,
+        exp_avg,
+        exp_avg_sq_row,
+        exp_avg_sq_col,
+        exp_avg_sq,
+        grad,
+        param2,
+        c,
+        seed);
+  } else {
+    TORCH_CHECK(false, "adafactor_fused_step: expect bfloat16 or float param");
+  }
+
+  if (!param_.is_contiguous()) {
+    param_.copy_(param);
+  }
+  if (!exp_avg_.is_contiguous()) {
+    exp_avg_.copy_(exp_avg);
+  }
+  if (!exp_avg_sq_row_.is_contiguous()) {
+    exp_avg_sq_row_.copy_(exp_avg_sq_row);
+  }
+  if (!exp_avg_sq_col_.is_contiguous()) {
+    exp_avg_sq_col_.copy_(exp_avg_sq_col);
+  }
+  if (!exp_avg_sq_.is_contiguous()) {
+    exp_avg_sq_.copy_(exp_avg_sq);
+  }
+  if (!param2_.is_contiguous()) {
+    param2_.copy_(param2);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    adafactor_fused_step_kernel_stub,
+    &adafactor_fused_step_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
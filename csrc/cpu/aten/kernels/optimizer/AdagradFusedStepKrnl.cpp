@@ -1,4 +1,6 @@
 #include <aten/optimizer/optimizer.h>
+#include "MultiTensorKrnl.h"
+#include "StochasticRoundingKrnl.h"
 #include "vec/vec.h"
 
 #include <torch/all.h>
@@ -20,7 +22,10 @@ void adagrad_fused_step_kernel(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* grad_data = grad.data_ptr<scalar_t>();
   scalar_t* state_sum_data = state_sum.data_ptr<scalar_t>();
@@ -34,7 +39,7 @@ void adagrad_fused_step_kernel(
 
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         scalar_t* param_ptr = param_data + begin;
         scalar_t* grad_ptr = grad_data + begin;
@@ -75,7 +80,10 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "adagrad_fused_step_kernel: expect param to be at::BFloat16");
@@ -86,13 +94,14 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
       state_sum.scalar_type() == at::kFloat,
       "adagrad_fused_step_kernel: expect stats_sum to be float32");
   TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
+      param2.numel() == 0 || param2.scalar_type() == at::kBFloat16,
       "adagrad_fused_step_kernel: expect param2 to be at::BFloat16");
 
   at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
   at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
   float* state_sum_data = state_sum.data_ptr<float>();
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
 
   // update learning rate
   double clr = learning_rate / (1 + (step - 1) * lr_decay);
@@ -104,22 +113,20 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
 
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         at::BFloat16* param_ptr = param_data + begin;
         at::BFloat16* grad_ptr = grad_data + begin;
         float* state_sum_ptr = state_sum_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
+        at::BFloat16* param2_ptr = param2_data ? param2_data + begin : nullptr;
 
         const int64_t size = end - begin;
 
         int64_t d = 0;
         for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
           fVec param_fvec, param_fvec2;
           std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+              load_bf16_param_vec(param_ptr, param2_ptr, d);
 
           bVec grad_bvec = bVec::loadu(grad_ptr + d);
           fVec grad_fvec, grad_fvec2;
@@ -140,21 +147,24 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
           param_fvec = param_fvec - grad_fvec / std_fvec * fVec(float(clr));
           param_fvec2 = param_fvec2 - grad_fvec2 / std_fvec2 * fVec(float(clr));
 
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
+          store_bf16_param_vec(
+              param_ptr,
+              param2_ptr,
+              d,
+              param_fvec,
+              param_fvec2,
+              seed,
+              begin + d);
         }
         for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+          float param_val = load_bf16_param(param_ptr, param2_ptr, d);
           float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
           state_sum_ptr[d] += grad_val * grad_val;
 
           float std_val = std::sqrt(state_sum_ptr[d]) + eps;
           param_val -= grad_val / std_val * clr;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
+          store_bf16_param(
+              param_ptr, param2_ptr, d, param_val, seed, begin + d);
         }
       });
 }
@@ -169,7 +179,10 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "adagrad_fused_step_kernel: expect param to be float32");
@@ -198,7 +211,7 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
 
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         float* param_ptr = param_data + begin;
         at::BFloat16* grad_ptr = grad_data + begin;
@@ -251,23 +264,22 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
       });
 }
 
-std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
-    const at::Tensor& param_,
-    const at::Tensor& grad_,
-    const at::Tensor& state_sum_,
-    const at::Tensor& param2_,
+// runs the [range_begin, range_end) elements of the contiguous tensors
+void adagrad_fused_step_range(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
     double step,
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
-  auto param = param_.contiguous();
-  auto grad = grad_.contiguous();
-  auto state_sum = state_sum_.contiguous();
-  auto param2 = param2_.contiguous();
-
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+    double eps,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
     adagrad_fused_step_kernel<float, float>(
         param,
@@ -278,7 +290,10 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        seed,
+        range_begin,
+        range_end);
   } else if (at::ScalarType::Double == grad_dtype) {
     adagrad_fused_step_kernel<double, double>(
         param,
@@ -289,7 +304,10 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -302,7 +320,10 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -315,10 +336,44 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        seed,
+        range_begin,
+        range_end);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
+}
+
+std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& grad_,
+    const at::Tensor& state_sum_,
+    const at::Tensor& param2_,
+    double step,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  auto param = param_.contiguous();
+  auto grad = grad_.contiguous();
+  auto state_sum = state_sum_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  uint64_t seed = stochastic_rounding_seed(param, param2);
+  adagrad_fused_step_range(
+      param,
+      grad,
+      state_sum,
+      param2,
+      step,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps,
+      seed,
+      0,
+      param.numel());
 
   if (!param_.is_contiguous()) {
     param_.copy_(param);
@@ -333,11 +388,51 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
   return std::make_tuple(param_, state_sum_);
 }
 
+void adagrad_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  auto params = multi_tensor_contiguous(params_);
+  auto grads = multi_tensor_contiguous(grads_);
+  auto state_sums = multi_tensor_contiguous(state_sums_);
+  auto params2 = multi_tensor_contiguous(params2_);
+
+  uint64_t seed = stochastic_rounding_seed(params, params2);
+  multi_tensor_apply(params, [&](int64_t i, int64_t begin, int64_t end) {
+    adagrad_fused_step_range(
+        params[i],
+        grads[i],
+        state_sums[i],
+        params2[i],
+        steps[i],
+        learning_rate,
+        weight_decay,
+        lr_decay,
+        eps,
+        stochastic_rounding_seed(seed, i),
+        begin,
+        end);
+  });
+
+  multi_tensor_copy_back(params_, params);
+  multi_tensor_copy_back(state_sums_, state_sums);
+  multi_tensor_copy_back(params2_, params2);
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
     adagrad_fused_step_kernel_stub,
     &adagrad_fused_step_kernel_impl);
+REGISTER_DISPATCH(
+    adagrad_fused_step_foreach_kernel_stub,
+    &adagrad_fused_step_foreach_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include <aten/optimizer/optimizer.h>
+#include "vec/vec.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+#include <cmath>
+#include <cstring>
+
+/*
+ The Adam moments of a block of adam_8bit_block_size elements are stored in 8
+ bits with one fp32 scale, the max of the block. The codes are companded so that
+ the small moments of a block keep their precision, a moment rounded to zero
+ while the other is not would blow the update up: exp_avg is stored as
+ round(127 * sign(m) * sqrt(|m| / scale)) in int8 and exp_avg_sq as
+ round(255 * (v / scale)^(1/4)) in uint8. A task dequantizes the moments of a
+ block in fp32 buffers, runs the update there and requantizes them with the new
+ block maxima, so the moments are read and written once per step.
+*/
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+using bVec = at::vec::Vectorized<at::BFloat16>;
+
+struct Adam8bitCoefficients {
+  float beta1, beta2, exp_avg_grad_coefficient, exp_avg_sq_grad_coefficient;
+  float step_size, bias_correction2, eps;
+  // the grad term, or the decay factor 1 - lr * weight_decay for AdamW
+  float weight_decay, param_decay;
+  bool decoupled_weight_decay;
+};
+
+inline void load_block(const float* src, float* dst, int64_t n) {
+  std::memcpy(dst, src, n * sizeof(float));
+}
+
+inline void load_block(const at::BFloat16* src, float* dst, int64_t n) {
+  for (int64_t d = 0; d < n; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), n - d);
+    fVec lo, hi;
+    std::tie(lo, hi) =
+        at::vec::convert_bfloat16_float(bVec::loadu(src + d, count));
+    lo.store(dst + d, count);
+  }
+}
+
+// the fp32 params of a block, param2 being the bf16 copy of fp32 params (or
+// nullptr) and the trail of split bf16 params
+inline void load_param(
+    const float* param,
+    const at::BFloat16* param2,
+    float* dst,
+    int64_t n) {
+  load_block(param, dst, n);
+}
+
+inline void load_param(
+    const at::BFloat16* param,
+    const at::BFloat16* param2,
+    float* dst,
+    int64_t n) {
+  for (int64_t d = 0; d < n; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), n - d);
+    fVec lo, hi;
+    std::tie(lo, hi) = at::vec::pack_bfloat16_float(
+        bVec::loadu(param + d, count), bVec::loadu(param2 + d, count));
+    lo.store(dst + d, count);
+  }
+}
+
+inline void store_param(
+    float* param,
+    at::BFloat16* param2,
+    const float* src,
+    int64_t n) {
+  std::memcpy(param, src, n * sizeof(float));
+  if (param2) {
+    for (int64_t d = 0; d < n; d += fVec::size()) {
+      int64_t count = std::min(static_cast<int64_t>(fVec::size()), n - d);
+      at::vec::convert_float_bfloat16(fVec::loadu(src + d, count), fVec(0.f))
+          .store(param2 + d, count);
+    }
+  }
+}
+
+inline void store_param(
+    at::BFloat16* param,
+    at::BFloat16* param2,
+    const float* src,
+    int64_t n) {
+  for (int64_t d = 0; d < n; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), n - d);
+    bVec top, trail;
+    std::tie(top, trail) = at::vec::unpack_float_bfloat16(
+        fVec::loadu(src + d, count), fVec(0.f));
+    top.store(param + d, count);
+    trail.store(param2 + d, count);
+  }
+}
+
+template <typename param_t, typename grad_t>
+void adam_8bit_block(
+    param_t* param,
+    at::BFloat16* param2,
+    const grad_t* grad,
+    int8_t* exp_avg_q,
+    float* exp_avg_scale,
+    uint8_t* exp_avg_sq_q,
+    float* exp_avg_sq_scale,
+    int64_t n,
+    const Adam8bitCoefficients& c) {
+  float p[adam_8bit_block_size];
+  float g[adam_8bit_block_size];
+  float m[adam_8bit_block_size];
+  float v[adam_8bit_block_size];
+  load_param(param, param2, p, n);
+  load_block(grad, g, n);
+
+  // dequantize
+  float m_scale = *exp_avg_scale;
+  float v_scale = *exp_avg_sq_scale;
+  for (int64_t d = 0; d < n; d++) {
+    float x = exp_avg_q[d] * (1.f / 127);
+    float y = exp_avg_sq_q[d] * (1.f / 255);
+    y = y * y;
+    m[d] = x * std::abs(x) * m_scale;
+    v[d] = y * y * v_scale;
+  }
+
+  for (int64_t d = 0; d < n; d += fVec::size()) {
+    int64_t count = std::min(static_cast<int64_t>(fVec::size()), n - d);
+    fVec param_vec = fVec::loadu(p + d, count);
+    fVec grad_vec = fVec::loadu(g + d, count);
+    if (c.decoupled_weight_decay) {
+      param_vec = param_vec * fVec(c.param_decay);
+    } else {
+      grad_vec = grad_vec + param_vec * fVec(c.weight_decay);
+    }
+    fVec exp_avg_vec = fVec::loadu(m + d, count) * fVec(c.beta1) +
+        grad_vec * fVec(c.exp_avg_grad_coefficient);
+    fVec exp_avg_sq_vec = fVec::loadu(v + d, count) * fVec(c.beta2) +
+        grad_vec * grad_vec * fVec(c.exp_avg_sq_grad_coefficient);
+    fVec denom_vec =
+        (exp_avg_sq_vec / fVec(c.bias_correction2)).sqrt() + fVec(c.eps);
+    param_vec = param_vec - fVec(c.step_size) * exp_avg_vec / denom_vec;
+    param_vec.store(p + d, count);
+    exp_avg_vec.store(m + d, count);
+    exp_avg_sq_vec.store(v + d, count);
+  }
+  store_param(param, param2, p, n);
+
+  // requantize with the new maxima
+  m_scale = 0.f;
+  v_scale = 0.f;
+  for (int64_t d = 0; d < n; d++) {
+    m_scale = std::max(m_scale, std::abs(m[d]));
+    v_scale = std::max(v_scale, v[d]);
+  }
+  *exp_avg_scale = m_scale;
+  *exp_avg_sq_scale = v_scale;
+  float m_inv = m_scale > 0 ? 1 / m_scale : 0.f;
+  float v_inv = v_scale > 0 ? 1 / v_scale : 0.f;
+  for (int64_t d = 0; d < n; d++) {
+    float x = std::sqrt(std::abs(m[d]) * m_inv);
+    float y = std::sqrt(std::sqrt(v[d] * v_inv));
+    exp_avg_q[d] =
+        static_cast<int8_t>(std::nearbyint(127 * std::copysign(x, m[d])));
+    exp_avg_sq_q[d] = static_cast<uint8_t>(std::nearbyint(255 * y));
+  }
+}
+
+template <typename param_t, typename grad_t>
+void adam_fused_step_8bit_kernel(
+    const at::Tensor& param,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_scale,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& exp_avg_sq_scale,
+    const at::Tensor& grad,
+    const at::Tensor& param2,
+    const Adam8bitCoefficients& c) {
+  param_t* param_data = param.data_ptr<param_t>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
+  const grad_t* grad_data = grad.data_ptr<grad_t>();
+  int8_t* exp_avg_data = exp_avg.data_ptr<int8_t>();
+  float* exp_avg_scale_data = exp_avg_scale.data_ptr<float>();
+  uint8_t* exp_avg_sq_data = exp_avg_sq.data_ptr<uint8_t>();
+  float* exp_avg_sq_scale_data = exp_avg_sq_scale.data_ptr<float>();
+  int64_t numel = param.numel();
+  int64_t num_blocks = exp_avg_scale.numel();
+
+  at::parallel_for(0, num_blocks, 16, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      int64_t offset = b * adam_8bit_block_size;
+      adam_8bit_block(
+          param_data + offset,
+          param2_data ? param2_data + offset : nullptr,
+          grad_data + offset,
+          exp_avg_data + offset,
+          exp_avg_scale_data + b,
+          exp_avg_sq_data + offset,
+          exp_avg_sq_scale_data + b,
+          std::min(adam_8bit_block_size, numel - offset),
+          c);
+    }
+  });
+}
+
+void adam_fused_step_8bit_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_scale,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& exp_avg_sq_scale,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    bool decoupled_weight_decay) {
+  auto param = param_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  Adam8bitCoefficients c;
+  c.beta1 = float(beta1);
+  c.beta2 = float(beta2);
+  c.exp_avg_grad_coefficient = float(1 - beta1);
+  c.exp_avg_sq_grad_coefficient = float(1 - beta2);
+  c.step_size = learning_rate / (1 - std::pow(beta1, step));
+  c.bias_correction2 = 1 - std::pow(beta2, step);
+  c.eps = float(eps);
+  c.weight_decay = float(weight_decay);
+  c.param_decay = float(1 - learning_rate * weight_decay);
+  c.decoupled_weight_decay = decoupled_weight_decay;
+
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
+  if (at::ScalarType::Float == grad_dtype) {
+    adam_fused_step_8bit_kernel<float, float>(
+        param,
+        exp_avg,
+        exp_avg_scale,
+        exp_avg_sq,
+        exp_avg_sq_scale,
+        grad,
+        param2,
+        c);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::BFloat16 == param_dtype) {
+    TORCH_CHECK(
+        param2.numel() == param.numel(),
+        "adam_fused_step_8bit: expect the trail of the bfloat16 param");
+    adam_fused_step_8bit_kernel<at::BFloat16, at::BFloat16>(
+        param,
+        exp_avg,
+        exp_avg_scale,
+        exp_avg_sq,
+        exp_avg_sq_scale,
+        grad,
+        param2,
+        c);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    adam_fused_step_8bit_kernel<float, at::BFloat16>(
+        param,
+        exp_avg,
+        exp_avg_scale,
+        exp_avg_sq,
+        exp_avg_sq_scale,
+        grad,
+        param2,
+        c);
+  } else {
+    TORCH_CHECK(false, "adam_fused_step_8bit: expect bfloat16 or float param");
+  }
+
+  if (!param_.is_contiguous()) {
+    param_.copy_(param);
+  }
+  if (!param2_.is_contiguous()) {
+    param2_.copy_(param2);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    adam_fused_step_8bit_kernel_stub,
+    &adam_fused_step_8bit_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,6 +1,10 @@
 #include <aten/optimizer/optimizer.h>
+#include "MultiTensorKrnl.h"
+#include "StochasticRoundingKrnl.h"
 #include "vec/vec.h"
 
+#include <aten/utils/streaming_store.h>
+
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
 namespace torch_ipex {
@@ -24,7 +28,11 @@ void adam_fused_step_kernel(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
-    double eps_double) {
+    double eps_double,
+    double inv_grad_scale_double,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* exp_avg_data = exp_avg.data_ptr<scalar_t>();
   scalar_t* exp_avg_sq_data = exp_avg_sq.data_ptr<scalar_t>();
@@ -43,14 +51,25 @@ void adam_fused_step_kernel(
   scalar_t learning_rate = scalar_t(learning_rate_double);
   scalar_t weight_decay = scalar_t(weight_decay_double);
   scalar_t eps = scalar_t(eps_double);
+  scalar_t inv_grad_scale = scalar_t(inv_grad_scale_double);
 
   using Vec = at::vec::Vectorized<scalar_t>;
   int64_t grain_size = 512;
+  // the step writes back the param and its moments, the chunks of a multi
+  // tensor step stream the stores of a large param too
+  bool streaming = use_streaming_store(param.nbytes() * (amsgrad ? 4 : 3));
 
   // update momentum vt and mt
   // also accumulate sum of param_norm and rtw_norm
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
+        if (streaming) {
+          // align the chunk of each thread for the streaming stores
+          begin = begin == range_begin
+              ? begin
+              : kernel::align_chunk_bound(param_data, begin, range_end);
+          end = kernel::align_chunk_bound(param_data, end, range_end);
+        }
         // local pointers
         scalar_t* param_ptr = param_data + begin;
         scalar_t* exp_avg_ptr = exp_avg_data + begin;
@@ -63,20 +82,21 @@ void adam_fused_step_kernel(
         int64_t d = 0;
         for (; d < size - (size % Vec::size()); d += Vec::size()) {
           Vec param_vec = Vec::loadu(param_ptr + d);
-          Vec grad_vec =
-              Vec::loadu(grad_ptr + d) + param_vec * Vec(weight_decay);
+          Vec grad_vec = Vec::loadu(grad_ptr + d) * Vec(inv_grad_scale) +
+              param_vec * Vec(weight_decay);
           Vec exp_avg_vec = Vec::loadu(exp_avg_ptr + d) * Vec(beta1) +
               grad_vec * Vec(exp_avg_grad_coefficient);
           Vec exp_avg_sq_vec = Vec::loadu(exp_avg_sq_ptr + d) * Vec(beta2) +
               grad_vec * grad_vec * Vec(exp_avg_sq_grad_coefficient);
-          exp_avg_vec.store(exp_avg_ptr + d);
-          exp_avg_sq_vec.store(exp_avg_sq_ptr + d);
+          kernel::store_vec(exp_avg_ptr + d, exp_avg_vec, streaming);
+          kernel::store_vec(exp_avg_sq_ptr + d, exp_avg_sq_vec, streaming);
 
           Vec denom_vec;
           if (amsgrad) {
             Vec max_exp_avg_sq_vec =
                 maximum(Vec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_vec);
-            max_exp_avg_sq_vec.store(max_exp_avg_sq_ptr + d);
+            kernel::store_vec(
+                max_exp_avg_sq_ptr + d, max_exp_avg_sq_vec, streaming);
             denom_vec =
                 (max_exp_avg_sq_vec / Vec(bias_correction2)).sqrt() + Vec(eps);
           } else {
@@ -85,10 +105,11 @@ void adam_fused_step_kernel(
           }
 
           param_vec = param_vec - Vec(step_size) * exp_avg_vec / denom_vec;
-          param_vec.store(param_ptr + d);
+          kernel::store_vec(param_ptr + d, param_vec, streaming);
         }
         for (; d < size; d++) {
-          scalar_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay;
+          scalar_t grad_val =
+              grad_ptr[d] * inv_grad_scale + param_ptr[d] * weight_decay;
           exp_avg_ptr[d] =
               exp_avg_ptr[d] * beta1 + grad_val * exp_avg_grad_coefficient;
           exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
@@ -104,6 +125,9 @@ void adam_fused_step_kernel(
           }
           param_ptr[d] = param_ptr[d] - step_size * exp_avg_ptr[d] / demon_val;
         }
+        if (streaming) {
+          _mm_sfence();
+        }
       });
 }
 
@@ -121,7 +145,11 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
-    double eps_double) {
+    double eps_double,
+    double inv_grad_scale_double,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "adam_fused_step_kernel: expect param to be at::BFloat16");
@@ -138,7 +166,7 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
       max_exp_avg_sq.scalar_type() == at::kFloat,
       "adam_fused_step_kernel: expect max_exp_avg_sq to be float32");
   TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
+      param2.numel() == 0 || param2.scalar_type() == at::kBFloat16,
       "adam_fused_step_kernel: expect param2 to be at::BFloat16");
 
   at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
@@ -146,7 +174,8 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
   float* exp_avg_sq_data = exp_avg_sq.data_ptr<float>();
   float* max_exp_avg_sq_data = max_exp_avg_sq.data_ptr<float>();
   at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
 
   float bias_correction1 = 1 - std::pow(beta1_double, step);
   float step_size = learning_rate_double / bias_correction1;
@@ -160,6 +189,7 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
   float learning_rate = float(learning_rate_double);
   float weight_decay = float(weight_decay_double);
   float eps = float(eps_double);
+  float inv_grad_scale = float(inv_grad_scale_double);
 
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
@@ -167,14 +197,14 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
   int64_t grain_size = 512;
 
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         at::BFloat16* param_ptr = param_data + begin;
         float* exp_avg_ptr = exp_avg_data + begin;
         float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
         float* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
         at::BFloat16* grad_ptr = grad_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
+        at::BFloat16* param2_ptr = param2_data ? param2_data + begin : nullptr;
 
         const int64_t size = end - begin;
 
@@ -184,12 +214,13 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
           bVec grad_bvec = bVec::loadu(grad_ptr + d);
           fVec grad_fvec, grad_fvec2;
           std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+          // unscale
+          grad_fvec = grad_fvec * fVec(inv_grad_scale);
+          grad_fvec2 = grad_fvec2 * fVec(inv_grad_scale);
           // load param vec
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
           fVec param_fvec, param_fvec2;
           std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+              load_bf16_param_vec(param_ptr, param2_ptr, d);
           // weight decay
           grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
           grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
@@ -233,15 +264,19 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
           param_fvec = param_fvec - fVec(step_size) * exp_avg_fvec / denom_fvec;
           param_fvec2 =
               param_fvec2 - fVec(step_size) * exp_avg_fvec2 / denom_fvec2;
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
+          store_bf16_param_vec(
+              param_ptr,
+              param2_ptr,
+              d,
+              param_fvec,
+              param_fvec2,
+              seed,
+              begin + d);
         }
         for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
+          float param_val = load_bf16_param(param_ptr, param2_ptr, d);
+          float grad_val =
+              float(grad_ptr[d]) * inv_grad_scale + param_val * weight_decay;
           exp_avg_ptr[d] =
               exp_avg_ptr[d] * beta1 + grad_val * exp_avg_grad_coefficient;
           exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
@@ -256,8 +291,8 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
             demon_val = std::sqrt(exp_avg_sq_ptr[d] / bias_correction2) + eps;
           }
           param_val = param_val - step_size * exp_avg_ptr[d] / demon_val;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
+          store_bf16_param(
+              param_ptr, param2_ptr, d, param_val, seed, begin + d);
         }
       });
 }
@@ -276,7 +311,11 @@ void adam_fused_step_kernel<float, at::BFloat16>(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
-    double eps_double) {
+    double eps_double,
+    double inv_grad_scale_double,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "adam_fused_step_kernel: expect param to be at::Float");
@@ -315,6 +354,7 @@ void adam_fused_step_kernel<float, at::BFloat16>(
   float learning_rate = float(learning_rate_double);
   float weight_decay = float(weight_decay_double);
   float eps = float(eps_double);
+  float inv_grad_scale = float(inv_grad_scale_double);
 
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
@@ -322,7 +362,7 @@ void adam_fused_step_kernel<float, at::BFloat16>(
   int64_t grain_size = 512;
 
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         float* param_ptr = param_data + begin;
         float* exp_avg_ptr = exp_avg_data + begin;
@@ -339,6 +379,9 @@ void adam_fused_step_kernel<float, at::BFloat16>(
           bVec grad_bvec = bVec::loadu(grad_ptr + d);
           fVec grad_fvec, grad_fvec2;
           std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+          // unscale
+          grad_fvec = grad_fvec * fVec(inv_grad_scale);
+          grad_fvec2 = grad_fvec2 * fVec(inv_grad_scale);
           // load param vec
           fVec param_fvec = fVec::loadu(param_ptr + d);
           fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
@@ -392,7 +435,8 @@ void adam_fused_step_kernel<float, at::BFloat16>(
           param2_bvec.store(param2_ptr + d);
         }
         for (; d < size; d++) {
-          float grad_val = float(grad_ptr[d]) + param_ptr[d] * weight_decay;
+          float grad_val =
+              float(grad_ptr[d]) * inv_grad_scale + param_ptr[d] * weight_decay;
           exp_avg_ptr[d] =
               exp_avg_ptr[d] * beta1 + grad_val * exp_avg_grad_coefficient;
           exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
@@ -412,29 +456,27 @@ void adam_fused_step_kernel<float, at::BFloat16>(
       });
 }
 
-void adam_fused_step_kernel_impl(
-    const at::Tensor& param_,
-    const at::Tensor& exp_avg_,
-    const at::Tensor& exp_avg_sq_,
-    const at::Tensor& max_exp_avg_sq_,
-    const at::Tensor& grad_,
-    const at::Tensor& param2_,
+// runs the [range_begin, range_end) elements of the contiguous tensors
+void adam_fused_step_range(
+    const at::Tensor& param,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& max_exp_avg_sq,
+    const at::Tensor& grad,
+    const at::Tensor& param2,
     bool amsgrad,
     double step,
     double beta1,
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
-  auto param = param_.contiguous();
-  auto exp_avg = exp_avg_.contiguous();
-  auto exp_avg_sq = exp_avg_sq_.contiguous();
-  auto max_exp_avg_sq = max_exp_avg_sq_.contiguous();
-  auto grad = grad_.contiguous();
-  auto param2 = param2_.contiguous();
-
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+    double eps,
+    double inv_grad_scale,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
     adam_fused_step_kernel<float, float>(
         param,
@@ -449,7 +491,11 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (at::ScalarType::Double == grad_dtype) {
     adam_fused_step_kernel<double, double>(
         param,
@@ -464,7 +510,11 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -481,7 +531,11 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -498,10 +552,57 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
+}
+
+void adam_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    double inv_grad_scale) {
+  auto param = param_.contiguous();
+  auto exp_avg = exp_avg_.contiguous();
+  auto exp_avg_sq = exp_avg_sq_.contiguous();
+  auto max_exp_avg_sq = max_exp_avg_sq_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  uint64_t seed = stochastic_rounding_seed(param, param2);
+  adam_fused_step_range(
+      param,
+      exp_avg,
+      exp_avg_sq,
+      max_exp_avg_sq,
+      grad,
+      param2,
+      amsgrad,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps,
+      inv_grad_scale,
+      seed,
+      0,
+      param.numel());
 
   if (!param_.is_contiguous()) {
     param_.copy_(param);
@@ -520,9 +621,63 @@ void adam_fused_step_kernel_impl(
   }
 }
 
+void adam_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    double inv_grad_scale) {
+  auto params = multi_tensor_contiguous(params_);
+  auto exp_avgs = multi_tensor_contiguous(exp_avgs_);
+  auto exp_avg_sqs = multi_tensor_contiguous(exp_avg_sqs_);
+  auto max_exp_avg_sqs = multi_tensor_contiguous(max_exp_avg_sqs_);
+  auto grads = multi_tensor_contiguous(grads_);
+  auto params2 = multi_tensor_contiguous(params2_);
+
+  uint64_t seed = stochastic_rounding_seed(params, params2);
+  multi_tensor_apply(params, [&](int64_t i, int64_t begin, int64_t end) {
+    adam_fused_step_range(
+        params[i],
+        exp_avgs[i],
+        exp_avg_sqs[i],
+        max_exp_avg_sqs[i],
+        grads[i],
+        params2[i],
+        amsgrad,
+        steps[i],
+        beta1,
+        beta2,
+        learning_rate,
+        weight_decay,
+        eps,
+        inv_grad_scale,
+        stochastic_rounding_seed(seed, i),
+        begin,
+        end);
+  });
+
+  multi_tensor_copy_back(params_, params);
+  multi_tensor_copy_back(exp_avgs_, exp_avgs);
+  multi_tensor_copy_back(exp_avg_sqs_, exp_avg_sqs);
+  multi_tensor_copy_back(max_exp_avg_sqs_, max_exp_avg_sqs);
+  multi_tensor_copy_back(params2_, params2);
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(adam_fused_step_kernel_stub, &adam_fused_step_kernel_impl);
+REGISTER_DISPATCH(
+    adam_fused_step_foreach_kernel_stub,
+    &adam_fused_step_foreach_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "StochasticRoundingKrnl.h"
+
+#include <cstring>
+
+// The fused steps which need several passes over a param, for its norms or its
+// factored moments, load the params and the grads of a block of
+// fused_step_block_size elements in fp32 buffers, update the block there and
+// store it back, whatever the dtypes of the param and of the grad.
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+constexpr int64_t fused_step_block_size = 1024;
+
+// the fp32 params of a block, param2 being the bf16 copy of fp32 params (or
+// nullptr), the trail of split bf16 params or nullptr for pure bf16 params
+inline void load_param_block(
+    const float* param,
+    const at::BFloat16* param2,
+    float* dst,
+    int64_t n) {
+  std::memcpy(dst, param, n * sizeof(float));
+}
+
+inline void load_param_block(
+    const at::BFloat16* param,
+    const at::BFloat16* param2,
+    float* dst,
+    int64_t n) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < n - (n % bVec::size()); d += bVec::size()) {
+    fVec lo, hi;
+    std::tie(lo, hi) = load_bf16_param_vec(param, param2, d);
+    lo.store(dst + d);
+    hi.store(dst + d + fVec::size());
+  }
+  for (; d < n; d++) {
+    dst[d] = load_bf16_param(param, param2, d);
+  }
+}
+
+inline void load_grad_block(const float* grad, float* dst, int64_t n) {
+  std::memcpy(dst, grad, n * sizeof(float));
+}
+
+inline void load_grad_block(const at::BFloat16* grad, float* dst, int64_t n) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < n - (n % bVec::size()); d += bVec::size()) {
+    fVec lo, hi;
+    std::tie(lo, hi) = at::vec::convert_bfloat16_float(bVec::loadu(grad + d));
+    lo.store(dst + d);
+    hi.store(dst + d + fVec::size());
+  }
+  for (; d < n; d++) {
+    dst[d] = static_cast<float>(grad[d]);
+  }
+}
+
+// Stores the fp32 params of the block at the element index of the param, the
+// index giving the noise of the stochastic rounding of pure bf16 params
+inline void store_param_block(
+    float* param,
+    at::BFloat16* param2,
+    const float* src,
+    int64_t n,
+    uint64_t seed,
+    int64_t index) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  std::memcpy(param, src, n * sizeof(float));
+  if (param2) {
+    int64_t d = 0;
+    for (; d < n - (n % bVec::size()); d += bVec::size()) {
+      at::vec::convert_float_bfloat16(
+          fVec::loadu(src + d), fVec::loadu(src + d + fVec::size()))
+          .store(param2 + d);
+    }
+    for (; d < n; d++) {
+      param2[d] = at::BFloat16(src[d]);
+    }
+  }
+}
+
+inline void store_param_block(
+    at::BFloat16* param,
+    at::BFloat16* param2,
+    const float* src,
+    int64_t n,
+    uint64_t seed,
+    int64_t index) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < n - (n % bVec::size()); d += bVec::size()) {
+    store_bf16_param_vec(
+        param,
+        param2,
+        d,
+        fVec::loadu(src + d),
+        fVec::loadu(src + d + fVec::size()),
+        seed,
+        index + d);
+  }
+  for (; d < n; d++) {
+    store_bf16_param(param, param2, d, src[d], seed, index + d);
+  }
+}
+
+inline float sum_of_squares(const float* src, int64_t n) {
+  using fVec = at::vec::Vectorized<float>;
+  fVec acc_vec(0.f);
+  int64_t d = 0;
+  for (; d < n - (n % fVec::size()); d += fVec::size()) {
+    fVec x = fVec::loadu(src + d);
+    acc_vec += x * x;
+  }
+  float acc = at::vec::vec_reduce_all(
+      [](fVec& x, fVec& y) { return x + y; }, acc_vec);
+  for (; d < n; d++) {
+    acc += src[d] * src[d];
+  }
+  return acc;
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,4 +1,5 @@
 #include <aten/optimizer/optimizer.h>
+#include "StochasticRoundingKrnl.h"
 #include "vec/vec.h"
 
 #include <torch/all.h>
@@ -30,7 +31,9 @@ void lamb_fused_step_kernel(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale,
+    uint64_t seed) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* exp_avg_data = exp_avg.data_ptr<scalar_t>();
   scalar_t* exp_avg_sq_data = exp_avg_sq.data_ptr<scalar_t>();
@@ -71,7 +74,8 @@ void lamb_fused_step_kernel(
 
         int64_t d = 0;
         for (; d < size - (size % Vec::size()); d += Vec::size()) {
-          Vec grad_vec = Vec::loadu(grad_ptr + d);
+          Vec grad_vec =
+              Vec::loadu(grad_ptr + d) * Vec(scalar_t(inv_grad_scale));
           Vec exp_avg_vec = Vec::loadu(exp_avg_ptr + d) * Vec(scalar_t(beta1)) +
               grad_vec * Vec(scalar_t(1 - beta1));
           Vec exp_avg_sq_vec =
@@ -94,9 +98,10 @@ void lamb_fused_step_kernel(
           sum2_vec = sum2_vec + adam_step_vec * adam_step_vec;
         }
         for (; d < size; d++) {
-          exp_avg_ptr[d] = exp_avg_ptr[d] * beta1 + grad_ptr[d] * (1 - beta1);
-          exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
-              grad_ptr[d] * grad_ptr[d] * (1 - beta2);
+          scalar_t grad_val = grad_ptr[d] * scalar_t(inv_grad_scale);
+          exp_avg_ptr[d] = exp_avg_ptr[d] * beta1 + grad_val * (1 - beta1);
+          exp_avg_sq_ptr[d] =
+              exp_avg_sq_ptr[d] * beta2 + grad_val * grad_val * (1 - beta2);
           scalar_t adam_step_val = (exp_avg_ptr[d] / bias_correction1) /
               (std::sqrt(exp_avg_sq_ptr[d] / bias_correction2) + eps);
 
@@ -164,7 +169,9 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale,
+    uint64_t seed) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "lamb_fused_step_kernel: expect param to be at::BFloat16");
@@ -178,14 +185,15 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
       exp_avg_sq.scalar_type() == at::kFloat,
       "lamb_fused_step_kernel: expect exp_avg_sq to be float32");
   TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
+      param2.numel() == 0 || param2.scalar_type() == at::kBFloat16,
       "lamb_fused_step_kernel: expect param2 to be at::BFloat16");
 
   at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
   float* exp_avg_data = exp_avg.data_ptr<float>();
   float* exp_avg_sq_data = exp_avg_sq.data_ptr<float>();
   at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
 
   double bias_correction1 = 1 - std::pow(beta1, step);
   double bias_correction2 = 1 - std::pow(beta2, step);
@@ -216,7 +224,7 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
     float* exp_avg_ptr = exp_avg_data + begin;
     float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
     at::BFloat16* grad_ptr = grad_data + begin;
-    at::BFloat16* param2_ptr = param2_data + begin;
+    at::BFloat16* param2_ptr = param2_data ? param2_data + begin : nullptr;
     float* workspace_ptr = workspace_data + begin;
 
     const int64_t size = end - begin;
@@ -232,6 +240,9 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
       bVec grad_bvec = bVec::loadu(grad_ptr + d);
       fVec grad_fvec, grad_fvec2;
       std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+      // unscale
+      grad_fvec = grad_fvec * fVec(float(inv_grad_scale));
+      grad_fvec2 = grad_fvec2 * fVec(float(inv_grad_scale));
 
       fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d) * fVec(float(beta1)) +
           grad_fvec * fVec(float(1 - beta1));
@@ -257,11 +268,9 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
       exp_avg_sq_fvec.store(exp_avg_sq_ptr + d);
       exp_avg_sq_fvec2.store(exp_avg_sq_ptr + d + fVec::size());
 
-      bVec param_bvec = bVec::loadu(param_ptr + d);
-      bVec param2_bvec = bVec::loadu(param2_ptr + d);
       fVec param_fvec, param_fvec2;
       std::tie(param_fvec, param_fvec2) =
-          at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+          load_bf16_param_vec(param_ptr, param2_ptr, d);
 
       adam_step_fvec = adam_step_fvec + param_fvec * fVec(float(weight_decay));
       adam_step_fvec2 =
@@ -275,15 +284,14 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
       sum2_fvec += adam_step_fvec2 * adam_step_fvec2;
     }
     for (; d < size; d++) {
-      float grad_val = float(grad_ptr[d]);
+      float grad_val = float(grad_ptr[d]) * float(inv_grad_scale);
       exp_avg_ptr[d] = exp_avg_ptr[d] * beta1 + grad_val * (1 - beta1);
       exp_avg_sq_ptr[d] =
           exp_avg_sq_ptr[d] * beta2 + grad_val * grad_val * (1 - beta2);
       float adam_step_val = (exp_avg_ptr[d] / bias_correction1) /
           (std::sqrt(exp_avg_sq_ptr[d] / bias_correction2) + eps);
 
-      float param_val =
-          at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+      float param_val = load_bf16_param(param_ptr, param2_ptr, d);
       adam_step_val += param_val * weight_decay;
       workspace_ptr[d] = adam_step_val;
 
@@ -309,35 +317,29 @@ void lamb_fused_step_kernel<at::BFloat16, at::BFloat16>(
   at::parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
     // local pointers
     at::BFloat16* param_ptr = param_data + begin;
-    at::BFloat16* param2_ptr = param2_data + begin;
+    at::BFloat16* param2_ptr = param2_data ? param2_data + begin : nullptr;
     float* workspace_ptr = workspace_data + begin;
 
     const int64_t size = end - begin;
 
     int64_t d = 0;
     for (; d < size - (size % bVec::size()); d += bVec::size()) {
-      bVec param_bvec = bVec::loadu(param_ptr + d);
-      bVec param2_bvec = bVec::loadu(param2_ptr + d);
       fVec param_fvec, param_fvec2;
       std::tie(param_fvec, param_fvec2) =
-          at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+          load_bf16_param_vec(param_ptr, param2_ptr, d);
 
       param_fvec -= fVec::loadu(workspace_ptr + d) *
           fVec(float(learning_rate * true_ratio));
       param_fvec2 -= fVec::loadu(workspace_ptr + d + fVec::size()) *
           fVec(float(learning_rate * true_ratio));
 
-      std::tie(param_bvec, param2_bvec) =
-          at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-      param_bvec.store(param_ptr + d);
-      param2_bvec.store(param2_ptr + d);
+      store_bf16_param_vec(
+          param_ptr, param2_ptr, d, param_fvec, param_fvec2, seed, begin + d);
     }
     for (; d < size; d++) {
-      float param_val =
-          at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+      float param_val = load_bf16_param(param_ptr, param2_ptr, d);
       param_val -= workspace_ptr[d] * learning_rate * true_ratio;
-      std::tie(param_ptr[d], param2_ptr[d]) =
-          at::vec::unpack_float_bfloat16(param_val);
+      store_bf16_param(param_ptr, param2_ptr, d, param_val, seed, begin + d);
     }
   });
 }
@@ -354,7 +356,9 @@ void lamb_fused_step_kernel<float, at::BFloat16>(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale,
+    uint64_t seed) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "lamb_fused_step_kernel: expect param to be at::Float");
@@ -421,6 +425,9 @@ void lamb_fused_step_kernel<float, at::BFloat16>(
       bVec grad_bvec = bVec::loadu(grad_ptr + d);
       fVec grad_fvec, grad_fvec2;
       std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+      // unscale
+      grad_fvec = grad_fvec * fVec(float(inv_grad_scale));
+      grad_fvec2 = grad_fvec2 * fVec(float(inv_grad_scale));
 
       fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d) * fVec(float(beta1)) +
           grad_fvec * fVec(float(1 - beta1));
@@ -461,7 +468,7 @@ void lamb_fused_step_kernel<float, at::BFloat16>(
       sum2_fvec += adam_step_fvec2 * adam_step_fvec2;
     }
     for (; d < size; d++) {
-      float grad_val = float(grad_ptr[d]);
+      float grad_val = float(grad_ptr[d]) * float(inv_grad_scale);
       exp_avg_ptr[d] = exp_avg_ptr[d] * beta1 + grad_val * (1 - beta1);
       exp_avg_sq_ptr[d] =
           exp_avg_sq_ptr[d] * beta2 + grad_val * grad_val * (1 - beta2);
@@ -535,13 +542,15 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale) {
   auto param = param_.contiguous();
   auto exp_avg = exp_avg_.contiguous();
   auto exp_avg_sq = exp_avg_sq_.contiguous();
   auto grad = grad_.contiguous();
   auto param2 = param2_.contiguous();
 
+  uint64_t seed = stochastic_rounding_seed(param, param2);
   auto grad_dtype = grad_.scalar_type();
   auto param_dtype = param_.scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
@@ -556,7 +565,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed);
   } else if (at::ScalarType::Double == grad_dtype) {
     lamb_fused_step_kernel<double, double>(
         param,
@@ -569,7 +580,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -584,7 +597,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -599,7 +614,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
-        eps);
+        eps,
+        inv_grad_scale,
+        seed);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
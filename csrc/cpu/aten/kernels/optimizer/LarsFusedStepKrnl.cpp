@@ -0,0 +1,190 @@
+#include <aten/optimizer/optimizer.h>
+#include "FusedStepBlockKrnl.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+#include <cmath>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+
+template <typename param_t, typename grad_t>
+void lars_fused_step_kernel(
+    const at::Tensor& param,
+    const at::Tensor& momentum_buf,
+    const at::Tensor& grad,
+    const at::Tensor& param2,
+    float momentum,
+    float learning_rate,
+    float weight_decay,
+    float trust_coefficient,
+    float eps,
+    bool adaptation,
+    uint64_t seed) {
+  param_t* param_data = param.data_ptr<param_t>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
+  const grad_t* grad_data = grad.data_ptr<grad_t>();
+  float* momentum_buf_data = momentum_buf.data_ptr<float>();
+  int64_t numel = param.numel();
+  int64_t num_blocks =
+      (numel + fused_step_block_size - 1) / fused_step_block_size;
+
+  // the norms, summed per block so that they do not depend on the number of
+  // threads
+  float trust_ratio = 1.f;
+  if (adaptation) {
+    std::vector<double> param_norm_acc(num_blocks);
+    std::vector<double> grad_norm_acc(num_blocks);
+    at::parallel_for(0, num_blocks, 16, [&](int64_t begin, int64_t end) {
+      float p[fused_step_block_size];
+      float g[fused_step_block_size];
+      for (int64_t b = begin; b < end; b++) {
+        int64_t offset = b * fused_step_block_size;
+        int64_t n = std::min(fused_step_block_size, numel - offset);
+        load_param_block(
+            param_data + offset,
+            param2_data ? param2_data + offset : nullptr,
+            p,
+            n);
+        load_grad_block(grad_data + offset, g, n);
+        param_norm_acc[b] = sum_of_squares(p, n);
+        grad_norm_acc[b] = sum_of_squares(g, n);
+      }
+    });
+    double param_norm = 0, grad_norm = 0;
+    for (int64_t b = 0; b < num_blocks; b++) {
+      param_norm += param_norm_acc[b];
+      grad_norm += grad_norm_acc[b];
+    }
+    param_norm = std::sqrt(param_norm);
+    grad_norm = std::sqrt(grad_norm);
+    if (param_norm > 0 && grad_norm > 0) {
+      trust_ratio = trust_coefficient * param_norm /
+          (grad_norm + weight_decay * param_norm + eps);
+    }
+  }
+
+  float scaled_lr = learning_rate * trust_ratio;
+  at::parallel_for(0, num_blocks, 16, [&](int64_t begin, int64_t end) {
+    float p[fused_step_block_size];
+    float g[fused_step_block_size];
+    for (int64_t b = begin; b < end; b++) {
+      int64_t offset = b * fused_step_block_size;
+      int64_t n = std::min(fused_step_block_size, numel - offset);
+      at::BFloat16* param2_ptr = param2_data ? param2_data + offset : nullptr;
+      float* buf_ptr = momentum_buf_data + offset;
+      load_param_block(param_data + offset, param2_ptr, p, n);
+      load_grad_block(grad_data + offset, g, n);
+      int64_t d = 0;
+      for (; d < n - (n % fVec::size()); d += fVec::size()) {
+        fVec param_vec = fVec::loadu(p + d);
+        fVec grad_vec =
+            fVec::loadu(g + d) + param_vec * fVec(weight_decay);
+        fVec buf_vec = fVec::loadu(buf_ptr + d) * fVec(momentum) +
+            grad_vec * fVec(scaled_lr);
+        buf_vec.store(buf_ptr + d);
+        (param_vec - buf_vec).store(p + d);
+      }
+      for (; d < n; d++) {
+        float grad_val = g[d] + p[d] * weight_decay;
+        buf_ptr[d] = buf_ptr[d] * momentum + grad_val * scaled_lr;
+        p[d] -= buf_ptr[d];
+      }
+      store_param_block(param_data + offset, param2_ptr, p, n, seed, offset);
+    }
+  });
+}
+
+void lars_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& momentum_buf_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double trust_coefficient,
+    double eps,
+    bool adaptation) {
+  auto param = param_.contiguous();
+  auto momentum_buf = momentum_buf_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+  uint64_t seed = stochastic_rounding_seed(param, param2);
+
+  TORCH_CHECK(
+      momentum_buf.scalar_type() == at::kFloat,
+      "lars_fused_step: expect a float momentum_buf");
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
+  if (at::ScalarType::Float == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    lars_fused_step_kernel<float, float>(
+        param,
+        momentum_buf,
+        grad,
+        param2,
+        momentum,
+        learning_rate,
+        weight_decay,
+        trust_coefficient,
+        eps,
+        adaptation,
+        seed);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::BFloat16 == param_dtype) {
+    lars_fused_step_kernel<at::BFloat16, at::BFloat16>(
+        param,
+        momentum_buf,
+        grad,
+        param2,
+        momentum,
+        learning_rate,
+        weight_decay,
+        trust_coefficient,
+        eps,
+        adaptation,
+        seed);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    lars_fused_step_kernel<float, at::BFloat16>(
+        param,
+        momentum_buf,
+        grad,
+        param2,
+        momentum,
+        learning_rate,
+        weight_decay,
+        trust_coefficient,
+        eps,
+        adaptation,
+        seed);
+  } else {
+    TORCH_CHECK(false, "lars_fused_step: expect bfloat16 or float param");
+  }
+
+  if (!param_.is_contiguous()) {
+    param_.copy_(param);
+  }
+  if (!momentum_buf_.is_contiguous()) {
+    momentum_buf_.copy_(momentum_buf);
+  }
+  if (!param2_.is_contiguous()) {
+    param2_.copy_(param2);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lars_fused_step_kernel_stub, &lars_fused_step_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
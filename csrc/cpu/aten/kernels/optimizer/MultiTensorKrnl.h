@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+#include <ATen/Tensor.h>
+
+#include <vector>
+
+// Multi-tensor optimizer steps. The elements of all the parameters of a step
+// are cut in chunks of at most multi_tensor_chunk_size elements, and the
+// chunks of all the tensors are spread over the threads of one parallel
+// region, so that the thousands of small tensors of a model neither pay a
+// fork/join each nor leave threads idle. A chunk runs the [begin, end) range of
+// the per tensor kernel, whose own parallel_for runs inline in the region.
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+const int64_t multi_tensor_chunk_size = 16384;
+
+struct MultiTensorChunk {
+  int64_t tensor;
+  int64_t begin;
+  int64_t end;
+};
+
+inline std::vector<MultiTensorChunk> multi_tensor_chunks(
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<MultiTensorChunk> chunks;
+  for (int64_t i = 0; i < tensors.size(); i++) {
+    int64_t numel = tensors[i].numel();
+    for (int64_t begin = 0; begin < numel; begin += multi_tensor_chunk_size) {
+      chunks.push_back(
+          {i, begin, std::min(begin + multi_tensor_chunk_size, numel)});
+    }
+  }
+  return chunks;
+}
+
+// f(i, begin, end) for the chunks of the tensors, in one parallel region
+template <typename F>
+inline void multi_tensor_apply(
+    const std::vector<at::Tensor>& tensors,
+    const F& f) {
+  auto chunks = multi_tensor_chunks(tensors);
+  at::parallel_for(0, chunks.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      f(chunks[c].tensor, chunks[c].begin, chunks[c].end);
+    }
+  });
+}
+
+// The contiguous tensors the kernels run on
+inline std::vector<at::Tensor> multi_tensor_contiguous(at::TensorList tensors) {
+  std::vector<at::Tensor> result;
+  result.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    result.push_back(t.contiguous());
+  }
+  return result;
+}
+
+// Copies back the results of the non contiguous tensors
+inline void multi_tensor_copy_back(
+    at::TensorList tensors,
+    const std::vector<at::Tensor>& contiguous) {
+  for (int64_t i = 0; i < tensors.size(); i++) {
+    if (!tensors[i].is_contiguous()) {
+      tensors[i].copy_(contiguous[i]);
+    }
+  }
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
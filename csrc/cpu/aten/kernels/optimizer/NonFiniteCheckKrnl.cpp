@@ -0,0 +1,104 @@
+#include <aten/optimizer/optimizer.h>
+#include "MultiTensorKrnl.h"
+#include "vec/vec.h"
+
+#include <torch/all.h>
+
+#include <atomic>
+#include <cmath>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at::vec;
+
+// x * 0 is 0 for a finite x and NaN for an inf or a NaN, so the sum of the
+// products of the range is NaN iff one of its elements is not finite. The
+// products are summed without a branch, the range being read once.
+template <typename scalar_t>
+bool non_finite_range(const at::Tensor& tensor, int64_t begin, int64_t end) {
+  using Vec = at::vec::Vectorized<scalar_t>;
+  const scalar_t* ptr = tensor.data_ptr<scalar_t>() + begin;
+  const int64_t size = end - begin;
+
+  Vec acc_vec = Vec(scalar_t(0));
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    acc_vec = acc_vec + Vec::loadu(ptr + d) * Vec(scalar_t(0));
+  }
+  scalar_t acc = scalar_t(0);
+  for (; d < size; d++) {
+    acc += ptr[d] * scalar_t(0);
+  }
+  scalar_t acc_arr[Vec::size()];
+  acc_vec.store(acc_arr);
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    acc += acc_arr[i];
+  }
+  return std::isnan(acc);
+}
+
+template <>
+bool non_finite_range<at::BFloat16>(
+    const at::Tensor& tensor,
+    int64_t begin,
+    int64_t end) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  const at::BFloat16* ptr = tensor.data_ptr<at::BFloat16>() + begin;
+  const int64_t size = end - begin;
+
+  fVec acc_fvec = fVec(float(0));
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec fvec, fvec2;
+    std::tie(fvec, fvec2) = convert_bfloat16_float(bVec::loadu(ptr + d));
+    acc_fvec = acc_fvec + fvec * fVec(float(0)) + fvec2 * fVec(float(0));
+  }
+  float acc = float(0);
+  for (; d < size; d++) {
+    acc += float(ptr[d]) * float(0);
+  }
+  float acc_arr[fVec::size()];
+  acc_fvec.store(acc_arr);
+  for (int64_t i = 0; i < fVec::size(); i++) {
+    acc += acc_arr[i];
+  }
+  return std::isnan(acc);
+}
+
+bool non_finite_check_foreach_kernel_impl(at::TensorList tensors_) {
+  auto tensors = multi_tensor_contiguous(tensors_);
+
+  // set by the first chunk found, after which the chunks are skipped
+  std::atomic<bool> found{false};
+  multi_tensor_apply(tensors, [&](int64_t i, int64_t begin, int64_t end) {
+    if (found.load(std::memory_order_relaxed)) {
+      return;
+    }
+    bool non_finite;
+    auto dtype = tensors[i].scalar_type();
+    if (at::ScalarType::Float == dtype) {
+      non_finite = non_finite_range<float>(tensors[i], begin, end);
+    } else if (at::ScalarType::Double == dtype) {
+      non_finite = non_finite_range<double>(tensors[i], begin, end);
+    } else {
+      non_finite = non_finite_range<at::BFloat16>(tensors[i], begin, end);
+    }
+    if (non_finite) {
+      found.store(true, std::memory_order_relaxed);
+    }
+  });
+  return found.load();
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    non_finite_check_foreach_kernel_stub,
+    &non_finite_check_foreach_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,6 +1,10 @@
 #include <aten/optimizer/optimizer.h>
+#include "MultiTensorKrnl.h"
+#include "StochasticRoundingKrnl.h"
 #include "vec/vec.h"
 
+#include <aten/utils/streaming_store.h>
+
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
 
@@ -22,7 +26,11 @@ void sgd_fused_step_kernel(
     double weight_decay,
     double dampening,
     bool nesterov,
-    bool momentum_buf_initialized) {
+    bool momentum_buf_initialized,
+    double inv_grad_scale,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* grad_data = grad.data_ptr<scalar_t>();
   scalar_t* momentum_buf_data =
@@ -35,9 +43,21 @@ void sgd_fused_step_kernel(
   scalar_t weight_decay_val = scalar_t(weight_decay);
   scalar_t momentum_val = scalar_t(momentum);
   scalar_t learning_rate_val = scalar_t(learning_rate);
+  scalar_t inv_grad_scale_val = scalar_t(inv_grad_scale);
+  // the step writes back the param and its momentum buffer, the chunks of a
+  // multi tensor step stream the stores of a large param too
+  bool streaming =
+      use_streaming_store(param.nbytes() * (momentum != 0 ? 2 : 1));
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
+        if (streaming) {
+          // align the chunk of each thread for the streaming stores
+          begin = begin == range_begin
+              ? begin
+              : kernel::align_chunk_bound(param_data, begin, range_end);
+          end = kernel::align_chunk_bound(param_data, end, range_end);
+        }
         // local pointers
         scalar_t* param_ptr = param_data + begin;
         scalar_t* grad_ptr = grad_data + begin;
@@ -47,8 +67,8 @@ void sgd_fused_step_kernel(
         int64_t d = 0;
         for (; d < size - (size % Vec::size()); d += Vec::size()) {
           Vec param_vec = Vec::loadu(param_ptr + d);
-          Vec grad_vec =
-              Vec::loadu(grad_ptr + d) + param_vec * Vec(weight_decay_val);
+          Vec grad_vec = Vec::loadu(grad_ptr + d) * Vec(inv_grad_scale_val) +
+              param_vec * Vec(weight_decay_val);
 
           if (momentum != 0) {
             Vec momentum_vec;
@@ -59,7 +79,7 @@ void sgd_fused_step_kernel(
                   Vec::loadu(momentum_buf_ptr + d) * Vec(momentum_val) +
                   grad_vec * Vec(grad_decay_val);
             }
-            momentum_vec.store(momentum_buf_ptr + d);
+            kernel::store_vec(momentum_buf_ptr + d, momentum_vec, streaming);
             if (nesterov) {
               grad_vec += momentum_vec * Vec(momentum_val);
             } else {
@@ -67,10 +87,11 @@ void sgd_fused_step_kernel(
             }
           }
           param_vec -= grad_vec * Vec(learning_rate_val);
-          param_vec.store(param_ptr + d);
+          kernel::store_vec(param_ptr + d, param_vec, streaming);
         }
         for (; d < size; d++) {
-          scalar_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay_val;
+          scalar_t grad_val = grad_ptr[d] * inv_grad_scale_val +
+              param_ptr[d] * weight_decay_val;
           if (momentum != 0) {
             if (!momentum_buf_initialized) {
               momentum_buf_ptr[d] = grad_val;
@@ -86,6 +107,9 @@ void sgd_fused_step_kernel(
           }
           param_ptr[d] -= grad_val * learning_rate_val;
         }
+        if (streaming) {
+          _mm_sfence();
+        }
       });
 }
 
@@ -100,7 +124,11 @@ void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double weight_decay,
     double dampening,
     bool nesterov,
-    bool momentum_buf_initialized) {
+    bool momentum_buf_initialized,
+    double inv_grad_scale,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "sgd_fused_step_kernel: expect param to be at::BFloat16");
@@ -111,14 +139,15 @@ void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
       !momentum_buf.defined() || momentum_buf.scalar_type() == at::kFloat,
       "sgd_fused_step_kernel: expect momentum_buf to be float32");
   TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
+      param2.numel() == 0 || param2.scalar_type() == at::kBFloat16,
       "sgd_fused_step_kernel: expect param2 to be at::BFloat16");
 
   at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
   at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
   float* momentum_buf_data =
       momentum_buf.defined() ? momentum_buf.data_ptr<float>() : nullptr;
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  at::BFloat16* param2_data =
+      param2.numel() ? param2.data_ptr<at::BFloat16>() : nullptr;
 
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
@@ -128,27 +157,29 @@ void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
   float weight_decay_val = float(weight_decay);
   float momentum_val = float(momentum);
   float learning_rate_val = float(learning_rate);
+  float inv_grad_scale_val = float(inv_grad_scale);
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         at::BFloat16* param_ptr = param_data + begin;
         at::BFloat16* grad_ptr = grad_data + begin;
         float* momentum_buf_ptr = momentum_buf_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
+        at::BFloat16* param2_ptr = param2_data ? param2_data + begin : nullptr;
 
         const int64_t size = end - begin;
         int64_t d = 0;
         for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
           fVec param_fvec, param_fvec2;
           std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+              load_bf16_param_vec(param_ptr, param2_ptr, d);
 
           bVec grad_bvec = bVec::loadu(grad_ptr + d);
           fVec grad_fvec, grad_fvec2;
           std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+          // unscale
+          grad_fvec = grad_fvec * fVec(inv_grad_scale_val);
+          grad_fvec2 = grad_fvec2 * fVec(inv_grad_scale_val);
 
           grad_fvec = grad_fvec + param_fvec * fVec(weight_decay_val);
           grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay_val);
@@ -180,15 +211,19 @@ void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
           param_fvec -= grad_fvec * fVec(learning_rate_val);
           param_fvec2 -= grad_fvec2 * fVec(learning_rate_val);
 
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
+          store_bf16_param_vec(
+              param_ptr,
+              param2_ptr,
+              d,
+              param_fvec,
+              param_fvec2,
+              seed,
+              begin + d);
         }
         for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = float(grad_ptr[d]) + param_val * weight_decay_val;
+          float param_val = load_bf16_param(param_ptr, param2_ptr, d);
+          float grad_val = float(grad_ptr[d]) * inv_grad_scale_val +
+              param_val * weight_decay_val;
           if (momentum != 0) {
             if (!momentum_buf_initialized) {
               momentum_buf_ptr[d] = grad_val;
@@ -203,8 +238,8 @@ void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
             }
           }
           param_val -= grad_val * learning_rate_val;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
+          store_bf16_param(
+              param_ptr, param2_ptr, d, param_val, seed, begin + d);
         }
       });
 }
@@ -220,7 +255,11 @@ void sgd_fused_step_kernel<float, at::BFloat16>(
     double weight_decay,
     double dampening,
     bool nesterov,
-    bool momentum_buf_initialized) {
+    bool momentum_buf_initialized,
+    double inv_grad_scale,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "sgd_fused_step_kernel: expect param to be at::kFloat");
@@ -248,9 +287,10 @@ void sgd_fused_step_kernel<float, at::BFloat16>(
   float weight_decay_val = float(weight_decay);
   float momentum_val = float(momentum);
   float learning_rate_val = float(learning_rate);
+  float inv_grad_scale_val = float(inv_grad_scale);
   // purely element-wise operations
   at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      range_begin, range_end, grain_size, [&](int64_t begin, int64_t end) {
         // local pointers
         float* param_ptr = param_data + begin;
         at::BFloat16* grad_ptr = grad_data + begin;
@@ -265,6 +305,9 @@ void sgd_fused_step_kernel<float, at::BFloat16>(
           bVec grad_bvec = bVec::loadu(grad_ptr + d);
           fVec grad_fvec, grad_fvec2;
           std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+          // unscale
+          grad_fvec = grad_fvec * fVec(inv_grad_scale_val);
+          grad_fvec2 = grad_fvec2 * fVec(inv_grad_scale_val);
 
           grad_fvec = grad_fvec + param_fvec * fVec(weight_decay_val);
           grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay_val);
@@ -304,7 +347,8 @@ void sgd_fused_step_kernel<float, at::BFloat16>(
         }
         for (; d < size; d++) {
           float param_val = param_ptr[d];
-          float grad_val = float(grad_ptr[d]) + param_val * weight_decay_val;
+          float grad_val = float(grad_ptr[d]) * inv_grad_scale_val +
+              param_val * weight_decay_val;
           if (momentum != 0) {
             if (!momentum_buf_initialized) {
               momentum_buf_ptr[d] = grad_val;
@@ -325,36 +369,24 @@ void sgd_fused_step_kernel<float, at::BFloat16>(
       });
 }
 
-c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
-    at::Tensor& param_,
-    const at::Tensor& grad_,
-    const c10::optional<at::Tensor>& momentum_buf_,
-    at::Tensor& param2_,
+// runs the [range_begin, range_end) elements of the contiguous tensors
+void sgd_fused_step_range(
+    at::Tensor& param,
+    const at::Tensor& grad,
+    at::Tensor& momentum_buf,
+    at::Tensor& param2,
     double momentum,
     double learning_rate,
     double weight_decay,
     double dampening,
-    bool nesterov) {
-  auto param = param_.contiguous();
-  auto grad = grad_.contiguous();
-  auto param2 = param2_.contiguous();
-
-  at::Tensor momentum_buf;
-  bool momentum_buf_initialized;
-  if (momentum != 0) {
-    if (!momentum_buf_.has_value()) {
-      auto acc_dtype =
-          param.scalar_type() == at::kDouble ? at::kDouble : at::kFloat;
-      momentum_buf = at::empty_like(param, acc_dtype);
-      momentum_buf_initialized = false;
-    } else {
-      momentum_buf = momentum_buf_.value().contiguous();
-      momentum_buf_initialized = true;
-    }
-  }
-
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+    bool nesterov,
+    bool momentum_buf_initialized,
+    double inv_grad_scale,
+    uint64_t seed,
+    int64_t range_begin,
+    int64_t range_end) {
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
     sgd_fused_step_kernel<float, float>(
         param,
@@ -366,7 +398,11 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
         weight_decay,
         dampening,
         nesterov,
-        momentum_buf_initialized);
+        momentum_buf_initialized,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (at::ScalarType::Double == grad_dtype) {
     sgd_fused_step_kernel<double, double>(
         param,
@@ -378,7 +414,11 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
         weight_decay,
         dampening,
         nesterov,
-        momentum_buf_initialized);
+        momentum_buf_initialized,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -392,7 +432,11 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
         weight_decay,
         dampening,
         nesterov,
-        momentum_buf_initialized);
+        momentum_buf_initialized,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -406,10 +450,70 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
         weight_decay,
         dampening,
         nesterov,
-        momentum_buf_initialized);
+        momentum_buf_initialized,
+        inv_grad_scale,
+        seed,
+        range_begin,
+        range_end);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
+}
+
+// the momentum buffer of param, created uninitialized on the first step
+at::Tensor sgd_momentum_buf(
+    const at::Tensor& param,
+    const c10::optional<at::Tensor>& momentum_buf_,
+    double momentum,
+    bool& momentum_buf_initialized) {
+  momentum_buf_initialized = false;
+  if (momentum == 0) {
+    return at::Tensor();
+  }
+  if (!momentum_buf_.has_value()) {
+    auto acc_dtype =
+        param.scalar_type() == at::kDouble ? at::kDouble : at::kFloat;
+    return at::empty_like(param, acc_dtype);
+  }
+  momentum_buf_initialized = true;
+  return momentum_buf_.value().contiguous();
+}
+
+c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
+    at::Tensor& param_,
+    const at::Tensor& grad_,
+    const c10::optional<at::Tensor>& momentum_buf_,
+    at::Tensor& param2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov,
+    double inv_grad_scale) {
+  auto param = param_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  bool momentum_buf_initialized;
+  at::Tensor momentum_buf = sgd_momentum_buf(
+      param, momentum_buf_, momentum, momentum_buf_initialized);
+
+  uint64_t seed = stochastic_rounding_seed(param, param2);
+  sgd_fused_step_range(
+      param,
+      grad,
+      momentum_buf,
+      param2,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov,
+      momentum_buf_initialized,
+      inv_grad_scale,
+      seed,
+      0,
+      param.numel());
   if (!param_.is_contiguous()) {
     param_.copy_(param);
   }
@@ -428,9 +532,72 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
     return momentum_buf;
 }
 
+c10::List<c10::optional<at::Tensor>> sgd_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    const c10::List<c10::optional<at::Tensor>>& momentum_bufs_,
+    at::TensorList params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov,
+    double inv_grad_scale) {
+  auto params = multi_tensor_contiguous(params_);
+  auto grads = multi_tensor_contiguous(grads_);
+  auto params2 = multi_tensor_contiguous(params2_);
+  std::vector<at::Tensor> momentum_bufs(params.size());
+  // vector<bool> is not safe to read from several threads
+  std::vector<uint8_t> momentum_bufs_initialized(params.size());
+  for (int64_t i = 0; i < params.size(); i++) {
+    bool initialized;
+    momentum_bufs[i] =
+        sgd_momentum_buf(params[i], momentum_bufs_[i], momentum, initialized);
+    momentum_bufs_initialized[i] = initialized;
+  }
+
+  uint64_t seed = stochastic_rounding_seed(params, params2);
+  multi_tensor_apply(params, [&](int64_t i, int64_t begin, int64_t end) {
+    sgd_fused_step_range(
+        params[i],
+        grads[i],
+        momentum_bufs[i],
+        params2[i],
+        momentum,
+        learning_rate,
+        weight_decay,
+        dampening,
+        nesterov,
+        momentum_bufs_initialized[i],
+        inv_grad_scale,
+        stochastic_rounding_seed(seed, i),
+        begin,
+        end);
+  });
+
+  multi_tensor_copy_back(params_, params);
+  multi_tensor_copy_back(params2_, params2);
+  c10::List<c10::optional<at::Tensor>> result;
+  for (int64_t i = 0; i < params.size(); i++) {
+    c10::optional<at::Tensor> buf = momentum_bufs_[i];
+    if (buf.has_value() && !buf->is_contiguous()) {
+      buf->copy_(momentum_bufs[i]);
+    }
+    if (momentum == 0) {
+      result.push_back(c10::nullopt);
+    } else {
+      result.push_back(buf.has_value() ? *buf : momentum_bufs[i]);
+    }
+  }
+  return result;
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(sgd_fused_step_kernel_stub, &sgd_fused_step_kernel_impl);
+REGISTER_DISPATCH(
+    sgd_fused_step_foreach_kernel_stub,
+    &sgd_fused_step_foreach_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
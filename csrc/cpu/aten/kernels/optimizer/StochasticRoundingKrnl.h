@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Tensor.h>
+#include "vec/vec.h"
+
+#include <mutex>
+#include <vector>
+
+// Pure bf16 params, which the fused steps get without a trail, are updated in
+// fp32 and rounded back to bf16 stochastically, see
+// stochastic_round_float_bfloat16, so that the updates smaller than half a bf16
+// ulp are kept on average instead of being rounded away, without the memory
+// and traffic of the trails. The noise of an element is a counter based hash of
+// the seed of the step and the index of the element, so the same seed gives
+// the same params whatever the number of threads.
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+inline uint64_t stochastic_rounding_mix(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// Whether param is a pure bf16 param, without trail
+inline bool is_stochastic_rounding_param(
+    const at::Tensor& param,
+    const at::Tensor& param2) {
+  return param.scalar_type() == at::kBFloat16 && param2.numel() == 0;
+}
+
+inline uint64_t draw_stochastic_rounding_seed() {
+  auto gen = at::get_generator_or_default<at::CPUGeneratorImpl>(
+      c10::nullopt, at::detail::getDefaultCPUGenerator());
+  std::lock_guard<std::mutex> lock(gen->mutex_);
+  return gen->random64();
+}
+
+// The seed of a step, drawn from the default CPU generator for pure bf16
+// params only, so that the other steps leave the generator alone
+inline uint64_t stochastic_rounding_seed(
+    const at::Tensor& param,
+    const at::Tensor& param2) {
+  return is_stochastic_rounding_param(param, param2)
+      ? draw_stochastic_rounding_seed()
+      : 0;
+}
+
+inline uint64_t stochastic_rounding_seed(
+    const std::vector<at::Tensor>& params,
+    const std::vector<at::Tensor>& params2) {
+  for (int64_t i = 0; i < params.size(); i++) {
+    if (is_stochastic_rounding_param(params[i], params2[i])) {
+      return draw_stochastic_rounding_seed();
+    }
+  }
+  return 0;
+}
+
+// The seed of the i-th tensor of a multi-tensor step
+inline uint64_t stochastic_rounding_seed(uint64_t seed, int64_t i) {
+  return stochastic_rounding_mix(seed ^ static_cast<uint64_t>(i));
+}
+
+// 16 random bits for the element index
+inline uint32_t stochastic_rounding_noise(uint64_t seed, int64_t index) {
+  return static_cast<uint32_t>(
+      stochastic_rounding_mix(seed ^ static_cast<uint64_t>(index)) >> 48);
+}
+
+// The fp32 params of the bVec::size() elements at param + d, the top halves
+// of split params whose trails are at param2, or pure bf16 params if param2 is
+// nullptr
+inline std::tuple<at::vec::Vectorized<float>, at::vec::Vectorized<float>>
+load_bf16_param_vec(
+    const at::BFloat16* param,
+    const at::BFloat16* param2,
+    int64_t d) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  if (param2) {
+    return at::vec::pack_bfloat16_float(
+        bVec::loadu(param + d), bVec::loadu(param2 + d));
+  }
+  return at::vec::convert_bfloat16_float(bVec::loadu(param + d));
+}
+
+inline float load_bf16_param(
+    const at::BFloat16* param,
+    const at::BFloat16* param2,
+    int64_t d) {
+  return param2 ? at::vec::pack_bfloat16_float(param[d], param2[d])
+                : static_cast<float>(param[d]);
+}
+
+// Stores the fp32 params at param + d, split in param and param2 or rounded
+// stochastically with the noise of the element index if param2 is nullptr
+inline void store_bf16_param_vec(
+    at::BFloat16* param,
+    at::BFloat16* param2,
+    int64_t d,
+    const at::vec::Vectorized<float>& a,
+    const at::vec::Vectorized<float>& b,
+    uint64_t seed,
+    int64_t index) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  using iVec = at::vec::Vectorized<int32_t>;
+  if (param2) {
+    bVec param_bvec, param2_bvec;
+    std::tie(param_bvec, param2_bvec) = at::vec::unpack_float_bfloat16(a, b);
+    param_bvec.store(param + d);
+    param2_bvec.store(param2 + d);
+    return;
+  }
+  int32_t noise[bVec::size()];
+  for (int64_t j = 0; j < bVec::size(); j++) {
+    noise[j] = stochastic_rounding_noise(seed, index + j);
+  }
+  at::vec::stochastic_round_float_bfloat16(
+      a, b, iVec::loadu(noise), iVec::loadu(noise + fVec::size()))
+      .store(param + d);
+}
+
+inline void store_bf16_param(
+    at::BFloat16* param,
+    at::BFloat16* param2,
+    int64_t d,
+    float value,
+    uint64_t seed,
+    int64_t index) {
+  if (param2) {
+    std::tie(param[d], param2[d]) = at::vec::unpack_float_bfloat16(value);
+  } else {
+    param[d] = at::vec::stochastic_round_float_bfloat16(
+        value, stochastic_rounding_noise(seed, index));
+  }
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -16,6 +16,15 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
   RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
 
   Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+  CSR2CSCWorkspace* workspace = batched_csc.workspace;
+  // borrow from the workspace if there is one, otherwise batched_csc owns
+  // the buffers
+  auto alloc = [&](CSR2CSCWorkspace::Buffer buffer, int64_t bytes) -> void* {
+    if (workspace) {
+      return workspace->get<char>(buffer, bytes);
+    }
+    return allocator->raw_allocate(bytes);
+  };
   TensorAccessor<int64_t, 1> offsets_data = offsets.accessor<int64_t, 1>();
   TensorAccessor<int64_t, 1> batched_csr_indices =
       indices.accessor<int64_t, 1>();
@@ -25,20 +34,20 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
   int64_t n_offsets = offsets.numel() - 1;
   for (auto pooling_mode : pooling_modes) {
     if (pooling_mode == MEAN) {
-      batched_csc.weights =
-          (float*)allocator->raw_allocate(n_indices * sizeof(float));
+      batched_csc.weights = (float*)alloc(
+          CSR2CSCWorkspace::WEIGHTS, n_indices * sizeof(float));
       break;
     }
   }
 
   auto get_table_id = [&](int n) { return n / B; };
 
-  Key_Value_Weight_Tuple<int>* tmpBuf =
-      (Key_Value_Weight_Tuple<int>*)allocator->raw_allocate(
-          (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
-  Key_Value_Weight_Tuple<int>* tmpBuf1 =
-      (Key_Value_Weight_Tuple<int>*)allocator->raw_allocate(
-          (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
+  Key_Value_Weight_Tuple<int>* tmpBuf = (Key_Value_Weight_Tuple<int>*)alloc(
+      CSR2CSCWorkspace::SORT_BUFFER0,
+      (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
+  Key_Value_Weight_Tuple<int>* tmpBuf1 = (Key_Value_Weight_Tuple<int>*)alloc(
+      CSR2CSCWorkspace::SORT_BUFFER1,
+      (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
 #pragma omp parallel for
   for (int n = 0; n < n_offsets; ++n) {
     int64_t pool_begin = offsets_data[n];
@@ -78,10 +87,11 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
   int U = num_uniq[max_thds - 1][0];
 
   batched_csc.segment_ptr =
-      (int*)allocator->raw_allocate((U + 1) * sizeof(int));
-  batched_csc.segment_indices = (int*)allocator->raw_allocate(U * sizeof(int));
-  batched_csc.output_row_indices =
-      (int*)allocator->raw_allocate(n_indices * sizeof(int));
+      (int*)alloc(CSR2CSCWorkspace::SEGMENT_PTR, (U + 1) * sizeof(int));
+  batched_csc.segment_indices =
+      (int*)alloc(CSR2CSCWorkspace::SEGMENT_INDICES, U * sizeof(int));
+  batched_csc.output_row_indices = (int*)alloc(
+      CSR2CSCWorkspace::OUTPUT_ROW_INDICES, n_indices * sizeof(int));
 
   batched_csc.segment_ptr[0] = 0;
   batched_csc.output_row_indices[0] =
@@ -118,8 +128,100 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
   }
   batched_csc.uniq_indices += U;
   batched_csc.segment_ptr[U] = n_indices;
-  allocator->raw_deallocate(tmpBuf);
-  allocator->raw_deallocate(tmpBuf1);
+  if (!workspace) {
+    allocator->raw_deallocate(tmpBuf);
+    allocator->raw_deallocate(tmpBuf1);
+  }
+}
+
+void mapping_based_batched_csr2csc_kernel_impl(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const std::vector<Tensor>& dedup_mapping,
+    std::vector<int64_t> pooling_modes) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      dedup_mapping.size() == 3,
+      "expect dedup mapping of [unique_indices, segment_ptr, sorted_positions]");
+
+  Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+  CSR2CSCWorkspace* workspace = batched_csc.workspace;
+  auto alloc = [&](CSR2CSCWorkspace::Buffer buffer, int64_t bytes) -> void* {
+    if (workspace) {
+      return workspace->get<char>(buffer, bytes);
+    }
+    return allocator->raw_allocate(bytes);
+  };
+  TensorAccessor<int64_t, 1> offsets_data = offsets.accessor<int64_t, 1>();
+  const int64_t* unique_indices = dedup_mapping[0].data_ptr<int64_t>();
+  const int64_t* segment_ptr = dedup_mapping[1].data_ptr<int64_t>();
+  const int64_t* sorted_positions = dedup_mapping[2].data_ptr<int64_t>();
+  int U = dedup_mapping[0].numel();
+  int64_t n_indices = dedup_mapping[2].numel();
+  int64_t n_offsets = offsets.numel() - 1;
+  int num_tables = pooling_modes.size();
+  batched_csc.num_tables = num_tables;
+  for (auto pooling_mode : pooling_modes) {
+    if (pooling_mode == MEAN) {
+      batched_csc.weights = (float*)alloc(
+          CSR2CSCWorkspace::WEIGHTS, n_indices * sizeof(float));
+      break;
+    }
+  }
+
+  // output row and weight of each position, the sort buffers are not used
+  // on this path
+  int* position_rows =
+      (int*)alloc(CSR2CSCWorkspace::SORT_BUFFER0, n_indices * sizeof(int));
+  float* position_weights = batched_csc.weights
+      ? (float*)alloc(
+            CSR2CSCWorkspace::SORT_BUFFER1, n_indices * sizeof(float))
+      : nullptr;
+#pragma omp parallel for
+  for (int n = 0; n < n_offsets; ++n) {
+    int64_t pool_begin = offsets_data[n];
+    int64_t pool_end = offsets_data[n + 1];
+    float scale_factor =
+        pooling_modes[n / B] == MEAN ? 1.0 / (pool_end - pool_begin) : 1;
+    for (int64_t p = pool_begin; p < pool_end; ++p) {
+      position_rows[p] = n % B;
+      if (position_weights) {
+        position_weights[p] = scale_factor;
+      }
+    }
+  }
+
+  batched_csc.segment_ptr =
+      (int*)alloc(CSR2CSCWorkspace::SEGMENT_PTR, (U + 1) * sizeof(int));
+  batched_csc.segment_indices =
+      (int*)alloc(CSR2CSCWorkspace::SEGMENT_INDICES, U * sizeof(int));
+  batched_csc.output_row_indices = (int*)alloc(
+      CSR2CSCWorkspace::OUTPUT_ROW_INDICES, n_indices * sizeof(int));
+#pragma omp parallel
+  {
+#pragma omp for schedule(static) nowait
+    for (int c = 0; c < U; c++) {
+      batched_csc.segment_indices[c] = unique_indices[c];
+      batched_csc.segment_ptr[c] = segment_ptr[c];
+    }
+#pragma omp for schedule(static)
+    for (int64_t i = 0; i < n_indices; i++) {
+      int64_t p = sorted_positions[i];
+      batched_csc.output_row_indices[i] = position_rows[p];
+      if (position_weights) {
+        batched_csc.weights[i] = position_weights[p];
+      }
+    }
+  }
+  batched_csc.segment_ptr[U] = n_indices;
+  batched_csc.uniq_indices += U;
+  if (!workspace) {
+    allocator->raw_deallocate(position_rows);
+    if (position_weights) {
+      allocator->raw_deallocate(position_weights);
+    }
+  }
 }
 
 } // anonymous namespace
@@ -128,5 +230,9 @@ REGISTER_DISPATCH(
     sort_based_batched_csr2csc_opt_kernel_stub,
     &sort_based_batched_csr2csc_opt_kernel_impl);
 
+REGISTER_DISPATCH(
+    mapping_based_batched_csr2csc_kernel_stub,
+    &mapping_based_batched_csr2csc_kernel_impl);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,137 @@
+#include "optimizer.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(adafactor_fused_step_kernel_stub);
+
+void adafactor_fused_step(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_row_,
+    const at::Tensor& exp_avg_sq_col_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double learning_rate,
+    double beta1,
+    double beta2,
+    double eps1,
+    double eps2,
+    double clip_threshold,
+    double weight_decay,
+    bool scale_parameter) {
+  RECORD_FUNCTION(
+      "torch_ipex::adafactor_fused_step", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(eps1 > 0, "Expect eps1 > 0.0, got ", eps1);
+  TORCH_CHECK(eps2 >= 0, "Expect eps2 >= 0.0, got ", eps2);
+  TORCH_CHECK(
+      clip_threshold > 0, "Expect clip_threshold > 0.0, got ", clip_threshold);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  TORCH_CHECK(
+      param_.sizes() == grad_.sizes(),
+      "Expect param and grad have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; grad sizes: ",
+      grad_.sizes());
+  TORCH_CHECK(
+      exp_avg_.numel() == 0 || param_.sizes() == exp_avg_.sizes(),
+      "Expect param and exp_avg have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; exp_avg sizes: ",
+      exp_avg_.sizes());
+  TORCH_CHECK(
+      param2_.numel() == 0 || param_.sizes() == param2_.sizes(),
+      "Expect param and param2_ have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; param2_ sizes: ",
+      param2_.sizes());
+  if (exp_avg_sq_row_.numel()) {
+    // factored over the last two dims
+    TORCH_CHECK(
+        param_.dim() >= 2,
+        "adafactor_fused_step: expect a param of at least 2 dims to factor");
+    auto sizes = param_.sizes();
+    std::vector<int64_t> col_sizes(sizes.begin(), sizes.end() - 2);
+    col_sizes.push_back(sizes.back());
+    TORCH_CHECK(
+        exp_avg_sq_row_.sizes() == sizes.slice(0, sizes.size() - 1) &&
+            exp_avg_sq_col_.sizes() == at::IntArrayRef(col_sizes),
+        "adafactor_fused_step: expect exp_avg_sq_row of the param sizes[:-1] "
+        "and exp_avg_sq_col of the param sizes[:-2] + sizes[-1:], param "
+        "sizes: ",
+        sizes);
+  } else {
+    TORCH_CHECK(
+        param_.sizes() == exp_avg_sq_.sizes(),
+        "Expect param and exp_avg_sq have the same sizes, param sizes: ",
+        param_.sizes(),
+        "; exp_avg_sq sizes: ",
+        exp_avg_sq_.sizes());
+  }
+
+  /*
+  pointer to adafactor_fused_step_kernel_impl(
+      param_,
+      exp_avg_,
+      exp_avg_sq_row_,
+      exp_avg_sq_col_,
+      exp_avg_sq_,
+      grad_,
+      param2_,
+      learning_rate,
+      beta1,
+      beta2,
+      eps1,
+      eps2,
+      clip_threshold,
+      weight_decay,
+      scale_parameter);
+  */
+  adafactor_fused_step_kernel_stub(
+      kCPU,
+      param_,
+      exp_avg_,
+      exp_avg_sq_row_,
+      exp_avg_sq_col_,
+      exp_avg_sq_,
+      grad_,
+      param2_,
+      learning_rate,
+      beta1,
+      beta2,
+      eps1,
+      eps2,
+      clip_threshold,
+      weight_decay,
+      scale_parameter);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "adafactor_fused_step(Tensor(a!) param, Tensor(b!) exp_avg, Tensor(c!) "
+      "exp_avg_sq_row, Tensor(d!) exp_avg_sq_col, Tensor(e!) exp_avg_sq, "
+      "Tensor grad, Tensor(f!) trail, float lr, float beta1, float beta2, "
+      "float eps1, float eps2, float clip_threshold, float weight_decay, "
+      "bool scale_parameter) -> ()",
+      torch_ipex::cpu::adafactor_fused_step);
+}
+
+} // namespace
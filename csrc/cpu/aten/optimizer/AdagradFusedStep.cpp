@@ -2,11 +2,13 @@
 
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(adagrad_fused_step_kernel_stub);
+DEFINE_DISPATCH(adagrad_fused_step_foreach_kernel_stub);
 
 std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
     const at::Tensor& param_,
@@ -20,6 +22,11 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
     double eps) {
   RECORD_FUNCTION(
       "torch_ipex::adagrad_fused_step", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::adagrad_fused_step",
+      2 * utils::nbytes(param_) + 2 * utils::nbytes(state_sum_) +
+          utils::nbytes(grad_) + 2 * utils::nbytes(param2_),
+      7 * param_.numel());
 
   TORCH_CHECK(
       learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
@@ -59,7 +66,7 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
       lr_decay,
       eps);
   */
-  return adagrad_fused_step_kernel_stub(
+  auto result = adagrad_fused_step_kernel_stub(
       kCPU,
       param_,
       grad_,
@@ -70,6 +77,75 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
       weight_decay,
       lr_decay,
       eps);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+  return result;
+}
+
+void adagrad_fused_step_foreach(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adagrad_fused_step_foreach",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(lr_decay >= 0, "Expect lr_decay >=0.0 , got ", lr_decay);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n = params_.size();
+  TORCH_CHECK(
+      grads_.size() == n && state_sums_.size() == n && params2_.size() == n &&
+          steps.size() == n,
+      "adagrad_fused_step_foreach: expect lists of ",
+      n,
+      " tensors and steps");
+  for (int64_t i = 0; i < n; i++) {
+    auto sizes = params_[i].sizes();
+    TORCH_CHECK(
+        grads_[i].sizes() == sizes && state_sums_[i].sizes() == sizes &&
+            (params2_[i].numel() == 0 || params2_[i].sizes() == sizes),
+        "adagrad_fused_step_foreach: expect the tensors of param ",
+        i,
+        " to have the param sizes ",
+        sizes);
+  }
+
+  /*
+  pointer to adagrad_fused_step_foreach_kernel_impl(
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+  */
+  adagrad_fused_step_foreach_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+  bump_param_version(params_);
+  bump_param_version(params2_);
 }
 
 } // namespace cpu
@@ -83,6 +159,11 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "state_sum, Tensor trail, float step, float lr, float weight_decay, "
       "float lr_decay, float eps) -> (Tensor(a!), Tensor(b!))",
       torch_ipex::cpu::adagrad_fused_step);
+  m.def(
+      "adagrad_fused_step_foreach(Tensor(a!)[] params, Tensor[] grads, "
+      "Tensor(b!)[] state_sums, Tensor(c!)[] trails, float[] steps, float lr, "
+      "float weight_decay, float lr_decay, float eps) -> ()",
+      torch_ipex::cpu::adagrad_fused_step_foreach);
 }
 
 } // namespace
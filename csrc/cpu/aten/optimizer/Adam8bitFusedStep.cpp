@@ -0,0 +1,128 @@
+#include "optimizer.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(adam_fused_step_8bit_kernel_stub);
+
+void adam_fused_step_8bit(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_scale_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& exp_avg_sq_scale_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    bool decoupled_weight_decay) {
+  RECORD_FUNCTION(
+      "torch_ipex::adam_fused_step_8bit", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  TORCH_CHECK(
+      param_.sizes() == grad_.sizes(),
+      "Expect param and grad have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; grad sizes: ",
+      grad_.sizes());
+  TORCH_CHECK(
+      param2_.numel() == 0 || param_.sizes() == param2_.sizes(),
+      "Expect param and param2_ have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; param2_ sizes: ",
+      param2_.sizes());
+  // the states are created by the optimizer, the kernel writes them in place
+  int64_t numel = param_.numel();
+  int64_t num_blocks =
+      (numel + adam_8bit_block_size - 1) / adam_8bit_block_size;
+  TORCH_CHECK(
+      exp_avg_.scalar_type() == at::kChar && exp_avg_.numel() == numel &&
+          exp_avg_.is_contiguous(),
+      "adam_fused_step_8bit: expect a contiguous int8 exp_avg of ",
+      numel,
+      " elements");
+  TORCH_CHECK(
+      exp_avg_sq_.scalar_type() == at::kByte && exp_avg_sq_.numel() == numel &&
+          exp_avg_sq_.is_contiguous(),
+      "adam_fused_step_8bit: expect a contiguous uint8 exp_avg_sq of ",
+      numel,
+      " elements");
+  TORCH_CHECK(
+      exp_avg_scale_.scalar_type() == at::kFloat &&
+          exp_avg_scale_.numel() == num_blocks &&
+          exp_avg_scale_.is_contiguous() &&
+          exp_avg_sq_scale_.scalar_type() == at::kFloat &&
+          exp_avg_sq_scale_.numel() == num_blocks &&
+          exp_avg_sq_scale_.is_contiguous(),
+      "adam_fused_step_8bit: expect contiguous float scales of ",
+      num_blocks,
+      " blocks");
+
+  /*
+  pointer to adam_fused_step_8bit_kernel_impl(
+      param_,
+      exp_avg_,
+      exp_avg_scale_,
+      exp_avg_sq_,
+      exp_avg_sq_scale_,
+      grad_,
+      param2_,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps,
+      decoupled_weight_decay);
+  */
+  adam_fused_step_8bit_kernel_stub(
+      kCPU,
+      param_,
+      exp_avg_,
+      exp_avg_scale_,
+      exp_avg_sq_,
+      exp_avg_sq_scale_,
+      grad_,
+      param2_,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps,
+      decoupled_weight_decay);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "adam_fused_step_8bit(Tensor(a!) param, Tensor(b!) exp_avg, Tensor(c!) "
+      "exp_avg_scale, Tensor(d!) exp_avg_sq, Tensor(e!) exp_avg_sq_scale, "
+      "Tensor grad, Tensor(f!) trail, float step, float beta1, float beta2, "
+      "float lr, float weight_decay, float eps, bool decoupled_weight_decay) "
+      "-> ()",
+      torch_ipex::cpu::adam_fused_step_8bit);
+}
+
+} // namespace
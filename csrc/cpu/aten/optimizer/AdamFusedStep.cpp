@@ -2,11 +2,13 @@
 
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(adam_fused_step_kernel_stub);
+DEFINE_DISPATCH(adam_fused_step_foreach_kernel_stub);
 
 void adam_fused_step(
     const at::Tensor& param_,
@@ -21,9 +23,17 @@ void adam_fused_step(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale) {
   RECORD_FUNCTION(
       "torch_ipex::adam_fused_step", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::adam_fused_step",
+      2 * utils::nbytes(param_) + 2 * utils::nbytes(exp_avg_) +
+          2 * utils::nbytes(exp_avg_sq_) + utils::nbytes(grad_) +
+          2 * utils::nbytes(param2_) +
+          (amsgrad ? 2 * utils::nbytes(max_exp_avg_sq_) : 0),
+      12 * param_.numel());
 
   TORCH_CHECK(
       learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
@@ -80,7 +90,8 @@ void adam_fused_step(
       beta2,
       learning_rate,
       weight_decay,
-      eps);
+      eps,
+      inv_grad_scale);
   */
   adam_fused_step_kernel_stub(
       kCPU,
@@ -96,7 +107,94 @@ void adam_fused_step(
       beta2,
       learning_rate,
       weight_decay,
-      eps);
+      eps,
+      inv_grad_scale);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+}
+
+void adam_fused_step_foreach(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    double inv_grad_scale) {
+  RECORD_FUNCTION(
+      "torch_ipex::adam_fused_step_foreach", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n = params_.size();
+  TORCH_CHECK(
+      exp_avgs_.size() == n && exp_avg_sqs_.size() == n &&
+          max_exp_avg_sqs_.size() == n && grads_.size() == n &&
+          params2_.size() == n && steps.size() == n,
+      "adam_fused_step_foreach: expect lists of ",
+      n,
+      " tensors and steps");
+  for (int64_t i = 0; i < n; i++) {
+    auto sizes = params_[i].sizes();
+    TORCH_CHECK(
+        grads_[i].sizes() == sizes && exp_avgs_[i].sizes() == sizes &&
+            exp_avg_sqs_[i].sizes() == sizes &&
+            (!amsgrad || max_exp_avg_sqs_[i].sizes() == sizes) &&
+            (params2_[i].numel() == 0 || params2_[i].sizes() == sizes),
+        "adam_fused_step_foreach: expect the tensors of param ",
+        i,
+        " to have the param sizes ",
+        sizes);
+  }
+
+  /*
+  pointer to adam_fused_step_foreach_kernel_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps,
+      inv_grad_scale);
+  */
+  adam_fused_step_foreach_kernel_stub(
+      kCPU,
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps,
+      inv_grad_scale);
+  bump_param_version(params_);
+  bump_param_version(params2_);
 }
 
 } // namespace cpu
@@ -109,8 +207,16 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "adam_fused_step(Tensor(a!) param, Tensor(b!) exp_avg, Tensor(c!) "
       "exp_avg_sq, Tensor(d!) max_exp_avg_sq, Tensor grad, Tensor trail, "
       "bool amsgrad, float step, float beta1, float "
-      "beta2, float lr, float weight_decay, float eps) -> ()",
+      "beta2, float lr, float weight_decay, float eps, float "
+      "inv_grad_scale=1.0) -> ()",
       torch_ipex::cpu::adam_fused_step);
+  m.def(
+      "adam_fused_step_foreach(Tensor(a!)[] params, Tensor(b!)[] exp_avgs, "
+      "Tensor(c!)[] exp_avg_sqs, Tensor(d!)[] max_exp_avg_sqs, Tensor[] "
+      "grads, Tensor(e!)[] trails, bool amsgrad, float[] steps, float beta1, "
+      "float beta2, float lr, float weight_decay, float eps, float "
+      "inv_grad_scale=1.0) -> ()",
+      torch_ipex::cpu::adam_fused_step_foreach);
 }
 
 } // namespace
@@ -2,6 +2,7 @@
 
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -19,9 +20,17 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
+    double eps,
+    double inv_grad_scale) {
   RECORD_FUNCTION(
       "torch_ipex::lamb_fused_step", c10::ArrayRef<c10::IValue>({}));
+  // the update is computed in a pass, then scaled by the trust ratio
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::lamb_fused_step",
+      3 * utils::nbytes(param_) + 2 * utils::nbytes(exp_avg_) +
+          2 * utils::nbytes(exp_avg_sq_) + utils::nbytes(grad_) +
+          2 * utils::nbytes(param2_),
+      16 * param_.numel());
 
   TORCH_CHECK(
       learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
@@ -68,9 +77,10 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
       beta2,
       learning_rate,
       weight_decay,
-      eps);
+      eps,
+      inv_grad_scale);
   */
-  return lamb_fused_step_kernel_stub(
+  auto result = lamb_fused_step_kernel_stub(
       kCPU,
       param_,
       exp_avg_,
@@ -82,7 +92,11 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
       beta2,
       learning_rate,
       weight_decay,
-      eps);
+      eps,
+      inv_grad_scale);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+  return result;
 }
 
 } // namespace cpu
@@ -94,8 +108,8 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       "lamb_fused_step(Tensor(a!) param, Tensor(b!) exp_avg, Tensor(c!) "
       "exp_avg_sq, Tensor grad, Tensor trail, int step, float beta1, float "
-      "beta2, float lr, float weight_decay, float eps) -> (Tensor(a!), "
-      "Tensor(b!), Tensor(c!))",
+      "beta2, float lr, float weight_decay, float eps, float "
+      "inv_grad_scale=1.0) -> (Tensor(a!), Tensor(b!), Tensor(c!))",
       torch_ipex::cpu::lamb_fused_step);
 }
 
@@ -0,0 +1,97 @@
+#include "optimizer.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(lars_fused_step_kernel_stub);
+
+void lars_fused_step(
+    const at::Tensor& param_,
+    const at::Tensor& momentum_buf_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double trust_coefficient,
+    double eps,
+    bool adaptation) {
+  RECORD_FUNCTION(
+      "torch_ipex::lars_fused_step", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(momentum >= 0, "Expect momentum >= 0.0, got ", momentum);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+  TORCH_CHECK(
+      trust_coefficient >= 0,
+      "Expect trust_coefficient >= 0.0, got ",
+      trust_coefficient);
+
+  TORCH_CHECK(
+      param_.sizes() == grad_.sizes(),
+      "Expect param and grad have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; grad sizes: ",
+      grad_.sizes());
+  TORCH_CHECK(
+      param_.sizes() == momentum_buf_.sizes(),
+      "Expect param and momentum_buf have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; momentum_buf sizes: ",
+      momentum_buf_.sizes());
+  TORCH_CHECK(
+      param2_.numel() == 0 || param_.sizes() == param2_.sizes(),
+      "Expect param and param2_ have the same sizes, param sizes: ",
+      param_.sizes(),
+      "; param2_ sizes: ",
+      param2_.sizes());
+
+  /*
+  pointer to lars_fused_step_kernel_impl(
+      param_,
+      momentum_buf_,
+      grad_,
+      param2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      trust_coefficient,
+      eps,
+      adaptation);
+  */
+  lars_fused_step_kernel_stub(
+      kCPU,
+      param_,
+      momentum_buf_,
+      grad_,
+      param2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      trust_coefficient,
+      eps,
+      adaptation);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "lars_fused_step(Tensor(a!) param, Tensor(b!) momentum_buf, Tensor "
+      "grad, Tensor(c!) trail, float momentum, float lr, float weight_decay, "
+      "float trust_coefficient, float eps, bool adaptation) -> ()",
+      torch_ipex::cpu::lars_fused_step);
+}
+
+} // namespace
@@ -0,0 +1,46 @@
+#include "optimizer.h"
+
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(non_finite_check_foreach_kernel_stub);
+
+/**
+ * Whether one of the tensors has an inf or a NaN, e.g. the scaled grads of a
+ * step of a GradScaler. The tensors are read in one parallel region and are
+ * not written, the fused steps unscaling the grads themselves.
+ */
+bool non_finite_check_foreach(at::TensorList tensors) {
+  RECORD_FUNCTION(
+      "torch_ipex::non_finite_check_foreach", c10::ArrayRef<c10::IValue>({}));
+
+  for (const auto& t : tensors) {
+    auto dtype = t.scalar_type();
+    TORCH_CHECK(
+        dtype == at::kFloat || dtype == at::kDouble || dtype == at::kBFloat16,
+        "non_finite_check_foreach: expect bfloat16 or float or double "
+        "tensors, got ",
+        dtype);
+  }
+
+  /*
+  pointer to non_finite_check_foreach_kernel_impl(tensors);
+  */
+  return non_finite_check_foreach_kernel_stub(kCPU, tensors);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "non_finite_check_foreach(Tensor[] tensors) -> bool",
+      torch_ipex::cpu::non_finite_check_foreach);
+}
+
+} // namespace
@@ -2,12 +2,13 @@
 
 #include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
-#include "csrc/utils/CustomOperatorRegistration.h"
+#include "utils/op_stats.h"
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(sgd_fused_step_kernel_stub);
+DEFINE_DISPATCH(sgd_fused_step_foreach_kernel_stub);
 
 /**
  * SGD fused update kernel.
@@ -23,6 +24,8 @@ DEFINE_DISPATCH(sgd_fused_step_kernel_stub);
  *@param weight_decay Args for regularization to avoid over-fit.
  *@param dampening Attribute for momentum.
  *@param nesterov Attribute for momentum.
+ *@param inv_grad_scale Scale of grad, the inverse of the loss scale of a
+ *GradScaler to unscale grad in the update, 1.0 otherwise.
  */
 c10::optional<at::Tensor> sgd_fused_step(
     at::Tensor& param_,
@@ -33,8 +36,15 @@ c10::optional<at::Tensor> sgd_fused_step(
     double learning_rate,
     double weight_decay,
     double dampening,
-    bool nesterov) {
+    bool nesterov,
+    double inv_grad_scale) {
   RECORD_FUNCTION("torch_ipex::sgd_fused_step", c10::ArrayRef<c10::IValue>({}));
+  IPEX_RECORD_OP_STATS(
+      "torch_ipex::sgd_fused_step",
+      2 * utils::nbytes(param_) + utils::nbytes(grad_) +
+          2 * utils::nbytes(param2_) +
+          (momentum_buf_.has_value() ? 2 * utils::nbytes(*momentum_buf_) : 0),
+      5 * param_.numel());
 
   TORCH_CHECK(
       weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
@@ -69,9 +79,10 @@ c10::optional<at::Tensor> sgd_fused_step(
       learning_rate,
       weight_decay,
       dampening,
-      nesterov);
+      nesterov,
+      inv_grad_scale);
   */
-  return sgd_fused_step_kernel_stub(
+  auto result = sgd_fused_step_kernel_stub(
       kCPU,
       param_,
       grad_,
@@ -81,15 +92,109 @@ c10::optional<at::Tensor> sgd_fused_step(
       learning_rate,
       weight_decay,
       dampening,
-      nesterov);
+      nesterov,
+      inv_grad_scale);
+  bump_param_version(param_);
+  bump_param_version(param2_);
+  return result;
+}
+
+/**
+ * Multi-tensor SGD fused update kernel, sgd_fused_step of each param of the
+ * lists in a single parallel region. Returns the momentum buffers.
+ */
+c10::List<c10::optional<at::Tensor>> sgd_fused_step_foreach(
+    at::TensorList params_,
+    at::TensorList grads_,
+    const c10::List<c10::optional<at::Tensor>>& momentum_bufs_,
+    at::TensorList params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov,
+    double inv_grad_scale) {
+  RECORD_FUNCTION(
+      "torch_ipex::sgd_fused_step_foreach", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n = params_.size();
+  TORCH_CHECK(
+      grads_.size() == n && momentum_bufs_.size() == n && params2_.size() == n,
+      "sgd_fused_step_foreach: expect lists of ",
+      n,
+      " tensors");
+  for (int64_t i = 0; i < n; i++) {
+    auto sizes = params_[i].sizes();
+    c10::optional<at::Tensor> buf = momentum_bufs_[i];
+    TORCH_CHECK(
+        grads_[i].sizes() == sizes &&
+            (!buf.has_value() || buf->sizes() == sizes) &&
+            (params2_[i].numel() == 0 || params2_[i].sizes() == sizes),
+        "sgd_fused_step_foreach: expect the tensors of param ",
+        i,
+        " to have the param sizes ",
+        sizes);
+  }
+
+  /*
+  pointer to sgd_fused_step_foreach_kernel_impl(
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov,
+      inv_grad_scale);
+  */
+  auto result = sgd_fused_step_foreach_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov,
+      inv_grad_scale);
+  bump_param_version(params_);
+  bump_param_version(params2_);
+  return result;
 }
 
 } // namespace cpu
 } // namespace torch_ipex
 
 namespace {
-IPEX_LIBRARY_FRAGMENT() {
-  IPEX_OP_REGISTER_DISPATCH(
-      "sgd_fused_step", torch_ipex::cpu::sgd_fused_step, at::DispatchKey::CPU);
+// the schemas are written out for the default of inv_grad_scale, with the
+// conservative alias analysis of the inferred ones
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(torch::schema(
+      "torch_ipex::sgd_fused_step(Tensor param, Tensor grad, Tensor? "
+      "momentum_buf, Tensor param2, float momentum, float learning_rate, "
+      "float weight_decay, float dampening, bool nesterov, float "
+      "inv_grad_scale=1.0) -> Tensor?",
+      c10::AliasAnalysisKind::CONSERVATIVE));
+  m.impl(
+      "sgd_fused_step",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::sgd_fused_step);
+  m.def(torch::schema(
+      "torch_ipex::sgd_fused_step_foreach(Tensor[] params, Tensor[] grads, "
+      "Tensor?[] momentum_bufs, Tensor[] params2, float momentum, float "
+      "learning_rate, float weight_decay, float dampening, bool nesterov, "
+      "float inv_grad_scale=1.0) -> Tensor?[]",
+      c10::AliasAnalysisKind::CONSERVATIVE));
+  m.impl(
+      "sgd_fused_step_foreach",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::sgd_fused_step_foreach);
 }
 } // namespace
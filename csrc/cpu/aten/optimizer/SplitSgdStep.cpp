@@ -16,7 +16,11 @@ at::Tensor packed_add(
     const at::Tensor& grad_,
     double alpha) {
   // pointer to packed_add_kernel_impl(top_half_, bot_half_, grad_, alpha);
-  return packed_add_kernel_stub(kCPU, top_half_, bot_half_, grad_, alpha);
+  auto result =
+      packed_add_kernel_stub(kCPU, top_half_, bot_half_, grad_, alpha);
+  bump_param_version(top_half_);
+  bump_param_version(bot_half_);
+  return result;
 }
 
 } // namespace cpu
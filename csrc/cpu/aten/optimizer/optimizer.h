@@ -5,8 +5,31 @@
 namespace torch_ipex {
 namespace cpu {
 
+// Elements of a block of the 8-bit Adam moments, which share one scale
+const int64_t adam_8bit_block_size = 256;
+
+// The fused steps write the params through their data pointers, which doesn't
+// bump the version counters as the in-place ATen ops do. They bump them
+// themselves, for the caches keyed by the version of a param (the autocast
+// weight casts, the shared packed weights) to drop the stale copies.
+inline void bump_param_version(const at::Tensor& param) {
+  if (param.defined() && !param.is_inference()) {
+    param.unsafeGetTensorImpl()->bump_version();
+  }
+}
+
+inline void bump_param_version(at::TensorList params) {
+  for (const auto& param : params) {
+    bump_param_version(param);
+  }
+}
+
 namespace {
 
+// The Adam, SGD and Lamb steps multiply the grads by inv_grad_scale as they
+// read them, so that the scaled grads of a GradScaler step are unscaled in the
+// update instead of in a pass of their own
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
     const at::Tensor& param_,
     const at::Tensor& exp_avg_,
@@ -18,7 +41,8 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps);
+    double eps,
+    double inv_grad_scale);
 
 std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
     const at::Tensor& param_,
@@ -40,7 +64,8 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
     double learning_rate,
     double weight_decay,
     double dampening,
-    bool nesterov);
+    bool nesterov,
+    double inv_grad_scale);
 
 at::Tensor packed_add_kernel_impl(
     at::Tensor& top_half,
@@ -61,8 +86,107 @@ void adam_fused_step_kernel_impl(
     double beta2,
     double learning_rate,
     double weight_decay,
+    double eps,
+    double inv_grad_scale);
+
+// Multi-tensor steps: the tensors of the lists are updated as their single
+// tensor step, in one parallel region over all their elements
+void adam_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    double inv_grad_scale);
+
+c10::List<c10::optional<at::Tensor>> sgd_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    const c10::List<c10::optional<at::Tensor>>& momentum_bufs_,
+    at::TensorList params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov,
+    double inv_grad_scale);
+
+void adagrad_fused_step_foreach_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
     double eps);
 
+// Adam, or AdamW with decoupled_weight_decay, with the moments stored in the
+// 8-bit codes of blocks of adam_8bit_block_size elements and the fp32 scale of
+// each block
+void adam_fused_step_8bit_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_scale,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& exp_avg_sq_scale,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps,
+    bool decoupled_weight_decay);
+
+// LARS with the momentum applied to the update scaled by the layer-wise trust
+// ratio, which adaptation disables
+void lars_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& momentum_buf_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double trust_coefficient,
+    double eps,
+    bool adaptation);
+
+// Adafactor with the given relative step size lr and decay beta2 of the step.
+// The second moments are factored in exp_avg_sq_row and exp_avg_sq_col over
+// the last two dims of params of at least 2 dims, kept in exp_avg_sq
+// otherwise, and the first moments are only kept if exp_avg is not empty
+void adafactor_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_row_,
+    const at::Tensor& exp_avg_sq_col_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    double learning_rate,
+    double beta1,
+    double beta2,
+    double eps1,
+    double eps2,
+    double clip_threshold,
+    double weight_decay,
+    bool scale_parameter);
+
+// Whether one of the tensors has an inf or a NaN, read in one parallel region
+bool non_finite_check_foreach_kernel_impl(at::TensorList tensors_);
+
 } // namespace
 
 using adagrad_fused_step_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
@@ -89,6 +213,7 @@ using lamb_fused_step_kernel_fn =
         double,
         double,
         double,
+        double,
         double);
 DECLARE_DISPATCH(lamb_fused_step_kernel_fn, lamb_fused_step_kernel_stub);
 
@@ -101,7 +226,8 @@ using sgd_fused_step_kernel_fn = c10::optional<at::Tensor> (*)(
     double,
     double,
     double,
-    bool);
+    bool,
+    double);
 DECLARE_DISPATCH(sgd_fused_step_kernel_fn, sgd_fused_step_kernel_stub);
 
 using packed_add_kernel_fn =
@@ -121,8 +247,115 @@ using adam_fused_step_kernel_fn = void (*)(
     double,
     double,
     double,
+    double,
     double);
 DECLARE_DISPATCH(adam_fused_step_kernel_fn, adam_fused_step_kernel_stub);
 
+using adam_fused_step_foreach_kernel_fn = void (*)(
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    bool,
+    at::ArrayRef<double>,
+    double,
+    double,
+    double,
+    double,
+    double,
+    double);
+DECLARE_DISPATCH(
+    adam_fused_step_foreach_kernel_fn,
+    adam_fused_step_foreach_kernel_stub);
+
+using sgd_fused_step_foreach_kernel_fn =
+    c10::List<c10::optional<at::Tensor>> (*)(
+        at::TensorList,
+        at::TensorList,
+        const c10::List<c10::optional<at::Tensor>>&,
+        at::TensorList,
+        double,
+        double,
+        double,
+        double,
+        bool,
+        double);
+DECLARE_DISPATCH(
+    sgd_fused_step_foreach_kernel_fn,
+    sgd_fused_step_foreach_kernel_stub);
+
+using adagrad_fused_step_foreach_kernel_fn = void (*)(
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::ArrayRef<double>,
+    double,
+    double,
+    double,
+    double);
+DECLARE_DISPATCH(
+    adagrad_fused_step_foreach_kernel_fn,
+    adagrad_fused_step_foreach_kernel_stub);
+
+using adam_fused_step_8bit_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    double,
+    double,
+    double,
+    double,
+    double,
+    bool);
+DECLARE_DISPATCH(
+    adam_fused_step_8bit_kernel_fn,
+    adam_fused_step_8bit_kernel_stub);
+
+using lars_fused_step_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    double,
+    double,
+    double,
+    double,
+    bool);
+DECLARE_DISPATCH(lars_fused_step_kernel_fn, lars_fused_step_kernel_stub);
+
+using adafactor_fused_step_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    double,
+    double,
+    double,
+    double,
+    double,
+    double,
+    bool);
+DECLARE_DISPATCH(
+    adafactor_fused_step_kernel_fn,
+    adafactor_fused_step_kernel_stub);
+
+using non_finite_check_foreach_kernel_fn = bool (*)(at::TensorList);
+DECLARE_DISPATCH(
+    non_finite_check_foreach_kernel_fn,
+    non_finite_check_foreach_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
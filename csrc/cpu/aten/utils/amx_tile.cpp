@@ -0,0 +1,138 @@
+#include "amx_tile.h"
+#include "isa/cpu_feature.hpp"
+
+#include <immintrin.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+// The tile instructions are compiled for AMX whatever the flags of the build,
+// only to run when amx_usable()
+#define AMX_TILE_TARGET __attribute__((target("amx-tile")))
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+std::atomic<bool> amx_tile_lazy_release = []() {
+  bool lazy = true;
+  static char* val = getenv("IPEX_AMX_TILE_LAZY_RELEASE");
+  if (val != NULL) {
+    std::string lazy_str = val;
+    if (!lazy_str.empty()) {
+      lazy = std::stoi(lazy_str) != 0;
+    }
+  }
+  return lazy;
+}();
+
+struct AMXTileState {
+  // the configurations loaded by the configuration kernels, by kernel
+  std::unordered_map<const void*, AMXTileConfig> kernel_configs;
+  int64_t requests = 0;
+  int64_t loads = 0;
+};
+
+thread_local AMXTileState amx_tile_state;
+
+// The permission of the process to use the tile data is requested along
+inline bool amx_usable() {
+  static bool usable = CPUFeature::get_instance().isa_level_amx();
+  return usable;
+}
+
+AMX_TILE_TARGET inline void store_tile_config(AMXTileConfig* cfg) {
+  _tile_storeconfig(cfg);
+}
+
+AMX_TILE_TARGET inline void load_tile_config(const AMXTileConfig& cfg) {
+  _tile_loadconfig(&cfg);
+}
+
+AMX_TILE_TARGET inline void release_tiles() {
+  _tile_release();
+}
+
+inline bool same_tile_config(const AMXTileConfig& a, const AMXTileConfig& b) {
+  return std::memcmp(&a, &b, sizeof(AMXTileConfig)) == 0;
+}
+
+} // namespace
+
+bool amx_tile_configure(const AMXTileConfig& cfg) {
+  if (!amx_usable()) {
+    return false;
+  }
+  auto& state = amx_tile_state;
+  state.requests++;
+  AMXTileConfig loaded;
+  store_tile_config(&loaded);
+  if (same_tile_config(loaded, cfg)) {
+    return false;
+  }
+  load_tile_config(cfg);
+  state.loads++;
+  return true;
+}
+
+bool amx_tile_configure(const void* key, void (*config)(const void*)) {
+  if (key == nullptr) {
+    return false;
+  }
+  if (!amx_usable()) {
+    config(key);
+    return true;
+  }
+  auto& state = amx_tile_state;
+  state.requests++;
+  auto it = state.kernel_configs.find(key);
+  if (it != state.kernel_configs.end()) {
+    AMXTileConfig loaded;
+    store_tile_config(&loaded);
+    if (same_tile_config(loaded, it->second)) {
+      return false;
+    }
+  }
+  config(key);
+  state.loads++;
+  store_tile_config(&state.kernel_configs[key]);
+  return true;
+}
+
+void amx_tile_release(const void* key, void (*release)(const void*)) {
+  if (release != nullptr) {
+    if (key != nullptr && (!amx_usable() || !get_amx_tile_lazy_release())) {
+      release(key);
+    }
+  } else if (amx_usable() && !get_amx_tile_lazy_release()) {
+    release_tiles();
+  }
+}
+
+bool get_amx_tile_lazy_release() {
+  return amx_tile_lazy_release.load(std::memory_order_relaxed);
+}
+
+void set_amx_tile_lazy_release(bool lazy) {
+  amx_tile_lazy_release.store(lazy, std::memory_order_relaxed);
+}
+
+int64_t get_amx_tile_config_requests() {
+  return amx_tile_state.requests;
+}
+
+int64_t get_amx_tile_config_loads() {
+  return amx_tile_state.loads;
+}
+
+void reset_amx_tile_config_counters() {
+  amx_tile_state.requests = 0;
+  amx_tile_state.loads = 0;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
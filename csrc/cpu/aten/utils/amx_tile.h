@@ -0,0 +1,66 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The 64 bytes of an AMX tile configuration, as LDTILECFG reads them and
+// STTILECFG writes them
+struct alignas(64) AMXTileConfig {
+  uint8_t palette_id;
+  uint8_t start_row;
+  uint8_t reserved[14];
+  uint16_t colb[16];
+  uint8_t rows[16];
+};
+
+// Per thread manager of the AMX tiles, shared by the AMX kernels of IPEX (the
+// interaction, and the TPP BRGEMMs behind the fused MHA and dense ops).
+//
+// LDTILECFG also zeros the tiles and TILERELEASE returns them to their init
+// state, which costs the small shape kernels called thousands of times per
+// second. The tiles are configured only when the loaded configuration differs
+// from the requested one. The loaded configuration is read back with
+// STTILECFG, much cheaper than LDTILECFG, rather than tracked, so that the
+// configurations loaded by oneDNN or libxsmm behind the back of the manager
+// are taken into account.
+//
+// On the CPUs without a usable AMX, the configuration and release kernels are
+// always called and the other functions are no-ops.
+
+// Loads cfg into the tiles of the calling thread, unless it is already loaded.
+// Returns whether LDTILECFG was issued.
+TORCH_API bool amx_tile_configure(const AMXTileConfig& cfg);
+
+// Configures the tiles of the calling thread with the configuration kernel
+// key, e.g. the tile config kernel of a libxsmm BRGEMM, unless the last
+// configuration it loaded on this thread is still loaded. The configuration a
+// kernel loads is recorded the first time it runs on a thread. Returns whether
+// the kernel was called.
+TORCH_API bool amx_tile_configure(const void* key, void (*config)(const void*));
+
+// Releases the tiles of the calling thread with release(key), or with
+// TILERELEASE when release is null, unless the release is lazy. A lazy release
+// keeps the configuration loaded for the next kernel to configure the tiles
+// the same way, the kernel idle path of Linux releasing the tiles of the idle
+// cores anyway.
+TORCH_API void amx_tile_release(
+    const void* key = nullptr,
+    void (*release)(const void*) = nullptr);
+
+// The release of the tiles is lazy by default, env
+// "IPEX_AMX_TILE_LAZY_RELEASE=0" releases them at the end of each kernel.
+TORCH_API bool get_amx_tile_lazy_release();
+TORCH_API void set_amx_tile_lazy_release(bool lazy);
+
+// The numbers of tile configurations requested and actually loaded by the
+// calling thread since the last reset, to check the hit rate of the manager
+TORCH_API int64_t get_amx_tile_config_requests();
+TORCH_API int64_t get_amx_tile_config_loads();
+TORCH_API void reset_amx_tile_config_counters();
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <vector>
+
+#include "isa/cpu_feature.hpp"
+#include "mkl.h"
+#include "utils/fpmath_mode.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+// Whether the fp32 GEMMs of the IPEX kernels (the MKL linear, the flash
+// attention) round their inputs to bf16 and accumulate in fp32, as the oneDNN
+// primitives do in the BF32 fpmath mode. Only on the CPUs with native bf16 dot
+// products (AVX512_BF16, AMX), on which MKL runs the bf16 GEMMs faster.
+inline bool use_bf32_gemm() {
+  static bool bf16_native = CPUFeature::get_instance().isa_level_avx512_bf16();
+  return bf16_native && getFP32MathModeCpu() == FP32MathMode::BF32;
+}
+
+// Row major cblas_sgemm, run by cblas_gemm_bf16bf16f32 on the inputs rounded
+// to bf16 when use_bf32_gemm(). Static for the kernels of each CPU_CAPABILITY
+// to convert with their own vector width.
+static inline void bf32_sgemm(
+    const CBLAS_TRANSPOSE transa,
+    const CBLAS_TRANSPOSE transb,
+    const int64_t M,
+    const int64_t N,
+    const int64_t K,
+    const float alpha,
+    const float* A,
+    const int64_t lda,
+    const float* B,
+    const int64_t ldb,
+    const float beta,
+    float* C,
+    const int64_t ldc) {
+  if (!use_bf32_gemm()) {
+    cblas_sgemm(
+        CblasRowMajor,
+        transa,
+        transb,
+        M,
+        N,
+        K,
+        alpha,
+        A,
+        lda,
+        B,
+        ldb,
+        beta,
+        C,
+        ldc);
+    return;
+  }
+  // the bf16 copies keep the leading dimensions of A and B
+  auto to_bf16 = [](std::vector<at::BFloat16>& buf,
+                    const float* src,
+                    int64_t rows,
+                    int64_t cols,
+                    int64_t ld) {
+    buf.resize(rows * ld);
+    for (int64_t r = 0; r < rows; r++) {
+      at::vec::convert(src + r * ld, buf.data() + r * ld, cols);
+    }
+    return (const MKL_BF16*)buf.data();
+  };
+  thread_local std::vector<at::BFloat16> a_buf, b_buf;
+  bool a_trans = transa != CblasNoTrans;
+  bool b_trans = transb != CblasNoTrans;
+  auto a16 = to_bf16(a_buf, A, a_trans ? K : M, a_trans ? M : K, lda);
+  auto b16 = to_bf16(b_buf, B, b_trans ? N : K, b_trans ? K : N, ldb);
+  cblas_gemm_bf16bf16f32(
+      CblasRowMajor,
+      transa,
+      transb,
+      M,
+      N,
+      K,
+      alpha,
+      a16,
+      lda,
+      b16,
+      ldb,
+      beta,
+      C,
+      ldc);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -5,6 +5,12 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(sort_based_batched_csr2csc_opt_kernel_stub);
+DEFINE_DISPATCH(mapping_based_batched_csr2csc_kernel_stub);
+
+CSR2CSCWorkspace& get_csr2csc_workspace() {
+  static thread_local CSR2CSCWorkspace workspace;
+  return workspace;
+}
 
 void sort_based_batched_csr2csc_opt(
     BatchedHyperCompressedSparseColumn& batched_csc,
@@ -13,6 +19,7 @@ void sort_based_batched_csr2csc_opt(
     const Tensor& indices,
     std::vector<int64_t> pooling_modes,
     int64_t max_embeddings) {
+  batched_csc.workspace = &get_csr2csc_workspace();
   /*
   pointer to sort_based_batched_csr2csc_opt_kernel_impl(
       batched_csc, B, offsets, indices, pooling_modes, max_embeddings);
@@ -21,5 +28,37 @@ void sort_based_batched_csr2csc_opt(
       kCPU, batched_csc, B, offsets, indices, pooling_modes, max_embeddings);
 }
 
+void mapping_based_batched_csr2csc(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const std::vector<Tensor>& dedup_mapping,
+    std::vector<int64_t> pooling_modes) {
+  batched_csc.workspace = &get_csr2csc_workspace();
+  /*
+  pointer to mapping_based_batched_csr2csc_kernel_impl(
+      batched_csc, B, offsets, dedup_mapping, pooling_modes);
+  */
+  mapping_based_batched_csr2csc_kernel_stub(
+      kCPU, batched_csc, B, offsets, dedup_mapping, pooling_modes);
+}
+
+void batched_csr2csc(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const Tensor& indices,
+    std::vector<int64_t> pooling_modes,
+    int64_t max_embeddings,
+    const std::vector<Tensor>& dedup_mapping) {
+  if (dedup_mapping.empty()) {
+    sort_based_batched_csr2csc_opt(
+        batched_csc, B, offsets, indices, pooling_modes, max_embeddings);
+  } else {
+    mapping_based_batched_csr2csc(
+        batched_csc, B, offsets, dedup_mapping, pooling_modes);
+  }
+}
+
 } // namespace cpu
 } // namespace torch_ipex
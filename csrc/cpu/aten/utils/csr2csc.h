@@ -5,13 +5,74 @@
 #include <dyndisp/DispatchStub.h>
 #include <omp.h>
 #include <torch/all.h>
+#include <algorithm>
 
 namespace torch_ipex {
 namespace cpu {
 
 using namespace at;
 
-enum PoolingMode { SUM = 0, MEAN = 1 };
+enum PoolingMode { SUM = 0, MEAN = 1, MAX = 2 };
+
+// Arena for the buffers of BatchedHyperCompressedSparseColumn and the radix
+// sort. It lives across iterations and only grows, so the steady state of a
+// training loop does not allocate inside csr2csc. Each thread calling
+// sort_based_batched_csr2csc_opt owns one workspace.
+class CSR2CSCWorkspace {
+ public:
+  enum Buffer {
+    SEGMENT_PTR = 0,
+    SEGMENT_INDICES,
+    OUTPUT_ROW_INDICES,
+    WEIGHTS,
+    SORT_BUFFER0,
+    SORT_BUFFER1,
+    NUM_BUFFERS
+  };
+
+  CSR2CSCWorkspace() = default;
+  CSR2CSCWorkspace(const CSR2CSCWorkspace&) = delete;
+  CSR2CSCWorkspace& operator=(const CSR2CSCWorkspace&) = delete;
+  ~CSR2CSCWorkspace() {
+    release();
+  }
+
+  // Return a buffer holding at least numel elements of T, the content is
+  // not preserved when the buffer has to grow.
+  template <typename T>
+  T* get(Buffer buffer, int64_t numel) {
+    size_t bytes = std::max<int64_t>(numel, 1) * sizeof(T);
+    if (bytes > capacity_[buffer]) {
+      Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+      if (buffers_[buffer]) {
+        allocator->raw_deallocate(buffers_[buffer]);
+      }
+      // grow by 1.5x to avoid re-allocating when the batch slowly grows
+      size_t capacity = std::max(bytes, capacity_[buffer] * 3 / 2);
+      buffers_[buffer] = allocator->raw_allocate(capacity);
+      capacity_[buffer] = capacity;
+    }
+    return static_cast<T*>(buffers_[buffer]);
+  }
+
+  void release() {
+    Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+      if (buffers_[i]) {
+        allocator->raw_deallocate(buffers_[i]);
+        buffers_[i] = nullptr;
+        capacity_[i] = 0;
+      }
+    }
+  }
+
+ private:
+  void* buffers_[NUM_BUFFERS] = {};
+  size_t capacity_[NUM_BUFFERS] = {};
+};
+
+// The workspace of the calling thread, released when the thread exits.
+CSR2CSCWorkspace& get_csr2csc_workspace();
 
 struct BatchedHyperCompressedSparseColumn {
   // A data structure to describe how sparse grads got by MergeEmbedingBag
@@ -56,7 +117,14 @@ struct BatchedHyperCompressedSparseColumn {
   // [0.5, 0.5, 0.33, 0.5, 0.5, 0.33, 0.33]
   float* weights = nullptr; // length column_ptr[table_ptr[T]]
 
+  // When set, the buffers above are borrowed from the workspace and must not
+  // be freed here.
+  CSR2CSCWorkspace* workspace = nullptr;
+
   ~BatchedHyperCompressedSparseColumn() {
+    if (workspace) {
+      return;
+    }
     Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
     if (segment_ptr) {
       allocator->raw_deallocate(segment_ptr);
@@ -77,6 +145,32 @@ void sort_based_batched_csr2csc_opt(
     std::vector<int64_t> pooling_modes,
     int64_t max_embeddings);
 
+// The dedup mapping returned by merged_embeddingbag_forward_dedup, it is the
+// unique/inverse mapping of indices_with_row_offset in CSC order:
+//   dedup_mapping[0]: unique_indices [U], sorted unique indices_with_row_offset
+//   dedup_mapping[1]: segment_ptr [U + 1], start of each unique index in
+//     sorted_positions
+//   dedup_mapping[2]: sorted_positions [n_indices], positions in indices
+//     grouped by unique index, ascending inside a group
+// batched_csc is built from it directly, without sorting the indices again.
+void mapping_based_batched_csr2csc(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const std::vector<Tensor>& dedup_mapping,
+    std::vector<int64_t> pooling_modes);
+
+// Build batched_csc from dedup_mapping if it is not empty, otherwise sort
+// the indices.
+void batched_csr2csc(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const Tensor& indices,
+    std::vector<int64_t> pooling_modes,
+    int64_t max_embeddings,
+    const std::vector<Tensor>& dedup_mapping);
+
 namespace {
 
 void sort_based_batched_csr2csc_opt_kernel_impl(
@@ -87,6 +181,13 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
     std::vector<int64_t> pooling_modes,
     int64_t max_embeddings);
 
+void mapping_based_batched_csr2csc_kernel_impl(
+    BatchedHyperCompressedSparseColumn& batched_csc,
+    int B,
+    const Tensor& offsets,
+    const std::vector<Tensor>& dedup_mapping,
+    std::vector<int64_t> pooling_modes);
+
 }
 
 using sort_based_batched_csr2csc_opt_kernel_fn = void (*)(
@@ -100,5 +201,15 @@ DECLARE_DISPATCH(
     sort_based_batched_csr2csc_opt_kernel_fn,
     sort_based_batched_csr2csc_opt_kernel_stub);
 
+using mapping_based_batched_csr2csc_kernel_fn = void (*)(
+    BatchedHyperCompressedSparseColumn&,
+    int,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    std::vector<int64_t>);
+DECLARE_DISPATCH(
+    mapping_based_batched_csr2csc_kernel_fn,
+    mapping_based_batched_csr2csc_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,88 @@
+#include "embedding_lookup.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+std::atomic<int64_t> embedding_prefetch_distance = []() {
+  int64_t distance = 16;
+  static char* val = getenv("IPEX_EMBEDDING_PREFETCH_DISTANCE");
+  if (val != NULL) {
+    std::string distance_str = val;
+    if (!distance_str.empty()) {
+      distance = std::max<int64_t>(std::stoll(distance_str), 0);
+    }
+  }
+  return distance;
+}();
+
+} // namespace
+
+int64_t get_embedding_prefetch_distance() {
+  return embedding_prefetch_distance.load(std::memory_order_relaxed);
+}
+
+void set_embedding_prefetch_distance(int64_t distance) {
+  TORCH_CHECK(distance >= 0, "embedding prefetch distance should be >= 0");
+  embedding_prefetch_distance.store(distance, std::memory_order_relaxed);
+}
+
+std::tuple<Tensor, Tensor> build_embedding_hot_row_cache(
+    const Tensor& weight,
+    const Tensor& hot_indices) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      weight.dim() == 2, "build_embedding_hot_row_cache expects 2-D weight");
+  TORCH_CHECK(hot_indices.dim() == 1 && hot_indices.scalar_type() == kLong);
+  auto indices = hot_indices.contiguous();
+  int64_t n_hot = indices.numel();
+  int64_t capacity = 1;
+  while (capacity < 2 * n_hot) {
+    capacity <<= 1;
+  }
+  auto hash_index = at::full({2, capacity}, -1, indices.options());
+  // copy with the calling thread to keep the buffer local to its NUMA node
+  auto rows = at::empty({n_hot, weight.size(1)}, weight.options());
+  if (n_hot == 0) {
+    return std::make_tuple(rows, hash_index);
+  }
+  rows.copy_(weight.index_select(0, indices));
+
+  auto indices_data = indices.data_ptr<int64_t>();
+  auto keys = hash_index.data_ptr<int64_t>();
+  auto slots = keys + capacity;
+  for (int64_t i = 0; i < n_hot; i++) {
+    auto key = indices_data[i];
+    TORCH_CHECK(
+        key >= 0 && key < weight.size(0),
+        "build_embedding_hot_row_cache: hot index out of range");
+    int64_t pos = HotRowCache::hash(key, capacity);
+    while (keys[pos] != -1 && keys[pos] != key) {
+      pos = (pos + 1) & (capacity - 1);
+    }
+    keys[pos] = key;
+    slots[pos] = i;
+  }
+  return std::make_tuple(rows, hash_index);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "build_embedding_hot_row_cache(Tensor weight, Tensor hot_indices) -> (Tensor, Tensor)");
+  m.impl(
+      "build_embedding_hot_row_cache",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::build_embedding_hot_row_cache);
+}
+
+} // namespace
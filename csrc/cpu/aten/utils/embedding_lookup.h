@@ -0,0 +1,209 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/util/Exception.h>
+#include <torch/all.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+using namespace at;
+
+// How many indices ahead the embedding pooling loops prefetch weight rows.
+// 0 disables software prefetching. The default can be overridden by env
+// "IPEX_EMBEDDING_PREFETCH_DISTANCE".
+TORCH_API int64_t get_embedding_prefetch_distance();
+TORCH_API void set_embedding_prefetch_distance(int64_t distance);
+
+// Prefetch a whole embedding row (all of its cache lines) into L1.
+inline __attribute__((always_inline)) void prefetch_row(
+    const void* row,
+    int64_t bytes) {
+  const char* ptr = static_cast<const char*>(row);
+  for (int64_t offset = 0; offset < bytes; offset += 64) {
+    __builtin_prefetch(ptr + offset, 0 /* read */, 3 /* keep in all levels */);
+  }
+}
+
+// Build a hot-row cache for an embedding table.
+// Returns (rows, hash_index):
+//   rows: [num_hot_rows, feature_size] compact copy of weight[hot_indices],
+//     allocated and filled by the calling thread so that it lands on the
+//     calling thread's NUMA node.
+//   hash_index: int64 open-addressing hash table of shape [2, capacity],
+//     row 0 holds the keys (-1 marks an empty slot) and row 1 the slot in
+//     "rows". capacity is a power of 2 and at least 2x num_hot_rows.
+std::tuple<Tensor, Tensor> build_embedding_hot_row_cache(
+    const Tensor& weight,
+    const Tensor& hot_indices);
+
+// Read-only view over the tensors built by build_embedding_hot_row_cache,
+// used inside pooling loops. An empty view always falls back to the table.
+class HotRowCache {
+ public:
+  HotRowCache() = default;
+  HotRowCache(const Tensor& rows, const Tensor& hash_index) {
+    if (!rows.defined() || rows.numel() == 0) {
+      return;
+    }
+    TORCH_CHECK(rows.is_contiguous() && hash_index.is_contiguous());
+    TORCH_CHECK(hash_index.scalar_type() == kLong && hash_index.dim() == 2);
+    rows_ = rows.data_ptr();
+    keys_ = hash_index.data_ptr<int64_t>();
+    capacity_ = hash_index.size(1);
+    slots_ = keys_ + capacity_;
+    TORCH_CHECK(
+        (capacity_ & (capacity_ - 1)) == 0,
+        "hot-row cache capacity must be a power of 2");
+  }
+
+  static inline int64_t hash(int64_t key, int64_t capacity) {
+    // fibonacci hashing, capacity is a power of 2
+    return (int64_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32) &
+        (capacity - 1);
+  }
+
+  inline int64_t find(int64_t key) const {
+    int64_t pos = hash(key, capacity_);
+    while (keys_[pos] != -1) {
+      if (keys_[pos] == key) {
+        return slots_[pos];
+      }
+      pos = (pos + 1) & (capacity_ - 1);
+    }
+    return -1;
+  }
+
+  // Return the row for "index", served from the compact buffer if cached.
+  template <typename T>
+  inline T* row(T* weight, int64_t index, int64_t vector_size) const {
+    if (capacity_ > 0) {
+      int64_t slot = find(index);
+      if (slot >= 0) {
+        return &static_cast<T*>(rows_)[slot * vector_size];
+      }
+    }
+    return &weight[index * vector_size];
+  }
+
+ private:
+  void* rows_ = nullptr;
+  int64_t* keys_ = nullptr;
+  int64_t* slots_ = nullptr;
+  int64_t capacity_ = 0;
+};
+
+// Compositional embeddings: a row of a logical table is combined, element-wise
+// by COMBINE_MUL or COMBINE_ADD, from one row of each of its component tables,
+// so a table of N rows is stored in much fewer rows than N.
+//   QUOTIENT_REMAINDER: the components are the digits of the index in the
+//     mixed radix of the component sizes, e.g. for 2 components of m_0 and m_1
+//     rows, index / m_1 and index % m_1. divisor is the product of the sizes
+//     of the following components.
+//   HASHED: component k reads row hash_k(index) % rows.
+enum CompositionalMode { QUOTIENT_REMAINDER = 0, HASHED = 1 };
+enum CompositionalCombine { COMBINE_MUL = 0, COMBINE_ADD = 1 };
+
+inline int64_t compositional_row(
+    int64_t index,
+    int64_t mode,
+    int64_t component,
+    int64_t rows,
+    int64_t divisor) {
+  if (mode == QUOTIENT_REMAINDER) {
+    return (index / divisor) % rows;
+  }
+  uint64_t seed = (uint64_t)component * 0x9E3779B97F4A7C15ull;
+  uint64_t h = ((uint64_t)index ^ seed) * 0xBF58476D1CE4E5B9ull;
+  h ^= h >> 31;
+  return (int64_t)(h % (uint64_t)rows);
+}
+
+// The component tables of the logical tables, flattened in "weights": table
+// t owns components [begin[t], begin[t + 1]), which share its dtype and
+// feature size.
+struct CompositionalComponents {
+  std::vector<int64_t> begin;
+  std::vector<int64_t> rows;
+  std::vector<int64_t> divisors;
+};
+
+inline CompositionalComponents get_compositional_components(
+    const std::vector<Tensor>& weights,
+    const std::vector<int64_t>& num_components,
+    int64_t mode) {
+  TORCH_CHECK(
+      mode == QUOTIENT_REMAINDER || mode == HASHED,
+      "compositional embedding mode should be quotient-remainder or hashed");
+  CompositionalComponents components;
+  components.begin.emplace_back(0);
+  for (auto n : num_components) {
+    TORCH_CHECK(n > 0, "a compositional table needs at least one component");
+    components.begin.emplace_back(components.begin.back() + n);
+  }
+  TORCH_CHECK(
+      components.begin.back() == weights.size(),
+      "expect ",
+      components.begin.back(),
+      " component tables but got ",
+      weights.size());
+  for (int64_t t = 0; t < num_components.size(); t++) {
+    const auto& first = weights[components.begin[t]];
+    for (int64_t c = components.begin[t]; c < components.begin[t + 1]; c++) {
+      const auto& w = weights[c];
+      TORCH_CHECK(
+          w.dim() == 2 && w.is_contiguous() && w.size(0) > 0 &&
+              w.scalar_type() == first.scalar_type() &&
+              w.size(1) == first.size(1),
+          "the components of a compositional table should be contiguous 2-D tables of the same dtype and feature size");
+      components.rows.emplace_back(w.size(0));
+    }
+    // the divisor of a quotient-remainder digit is the product of the sizes
+    // of the following components
+    int64_t divisor = 1;
+    components.divisors.resize(components.begin[t + 1]);
+    for (int64_t c = components.begin[t + 1] - 1; c >= components.begin[t];
+         c--) {
+      components.divisors[c] = divisor;
+      divisor *= components.rows[c];
+    }
+  }
+  return components;
+}
+
+// Pool the rows of a bag of a per tensor quantized int8 table and requantize
+// the int32 sum to the output: out = saturate(round(sum * scale)), scale being
+// the scale of the table over the scale of the output (and over the bag size
+// for a mean). The sum is not saturated to int8 between the rows.
+inline void qemb_pooling_ker(
+    int8_t* out,
+    const int8_t* table,
+    const int64_t* indices,
+    int64_t pool_begin,
+    int64_t pool_end,
+    int64_t vector_size,
+    float scale) {
+  int32_t acc[vector_size];
+#pragma omp simd
+  for (int64_t d = 0; d < vector_size; d++) {
+    acc[d] = 0;
+  }
+  for (auto p = pool_begin; p < pool_end; p++) {
+    const int8_t* row = &table[indices[p] * vector_size];
+#pragma omp simd
+    for (int64_t d = 0; d < vector_size; d++) {
+      acc[d] += row[d];
+    }
+  }
+#pragma omp simd
+  for (int64_t d = 0; d < vector_size; d++) {
+    float q = std::nearbyint(acc[d] * scale);
+    out[d] = static_cast<int8_t>(std::min(std::max(q, -128.f), 127.f));
+  }
+}
+
+} // namespace cpu
+} // namespace torch_ipex
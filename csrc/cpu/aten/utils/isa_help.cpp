@@ -2,6 +2,8 @@
 
 #include <dnnl.hpp>
 
+#include <sstream>
+
 namespace torch_ipex {
 namespace cpu {
 
@@ -27,6 +29,24 @@ std::string get_highest_binary_support_isa_level() {
   return CPUCapabilityToString(level);
 }
 
+std::string get_dispatch_stub_coverage_report() {
+  std::stringstream ss;
+  for (const auto& name : get_dispatch_stub_names()) {
+    ss << name << ":";
+    for (auto isa : get_dispatch_stub_binary_isa_levels(name)) {
+      ss << " " << CPUCapabilityToString(isa);
+    }
+    auto isa = get_dispatch_stub_isa_level(name);
+    auto kernel_isa = get_dispatch_stub_kernel_isa_level(name);
+    ss << " -> " << CPUCapabilityToString(kernel_isa);
+    if (kernel_isa != isa) {
+      ss << " (missing " << CPUCapabilityToString(isa) << ")";
+    }
+    ss << "\n";
+  }
+  return ss.str();
+}
+
 const char* OneDNNIsaLevelToString(cpu_isa isa) {
   // convert dnnl::cpu_isa to string
   switch (isa) {
@@ -40,8 +60,12 @@ const char* OneDNNIsaLevelToString(cpu_isa isa) {
       return "AVX512_VNNI";
     case cpu_isa::avx512_core_bf16:
       return "AVX512_BF16";
+    case cpu_isa::avx512_core_fp16:
+      return "AVX512_FP16";
     case cpu_isa::avx512_core_amx:
       return "AMX";
+    case cpu_isa::avx512_core_amx_fp16:
+      return "AMX_FP16";
 
     default:
       return "WrongLevel";
@@ -13,6 +13,10 @@ std::string get_current_onednn_isa_level();
 std::string get_current_isa_level();
 std::string get_highest_cpu_support_isa_level();
 std::string get_highest_binary_support_isa_level();
+// One line per dispatch stub: the ISA levels the binary has a kernel of, and
+// the one it runs on this CPU, flagged when it falls back below the ISA level
+// of the CPU for a missing kernel
+std::string get_dispatch_stub_coverage_report();
 
 namespace {
 
@@ -3,6 +3,7 @@
 
 #include <omp.h>
 #include <cstdint>
+#include <tuple>
 #include <utility>
 
 namespace torch_ipex {
@@ -13,6 +14,9 @@ using Key_Value_Weight_Tuple = std::tuple<T, T, float>;
 // histogram size per thread
 const int HIST_SIZE = 256;
 
+// below this many elements the sort runs on the calling thread only
+const int64_t RADIX_SORT_PARALLEL_THRESHOLD = 4096;
+
 template <typename T>
 Key_Value_Weight_Tuple<T>* radix_sort_parallel(
     Key_Value_Weight_Tuple<T>* inp_buf,
@@ -21,21 +25,26 @@ Key_Value_Weight_Tuple<T>* radix_sort_parallel(
     int64_t max_value) {
   RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
   int maxthreads = omp_get_max_threads();
-  alignas(64) int histogram[HIST_SIZE * maxthreads],
-      histogram_ps[HIST_SIZE * maxthreads + 1];
+  alignas(64) int64_t histogram[HIST_SIZE * maxthreads],
+      histogram_ps[HIST_SIZE * maxthreads];
+  alignas(64) int64_t bin_start[HIST_SIZE];
   if (max_value == 0)
     return inp_buf;
-  int num_bits = sizeof(T) * 8 - __builtin_clz(max_value);
+  int num_bits = 64 - __builtin_clzll((uint64_t)max_value);
   int num_passes = (num_bits + 7) / 8;
+  Key_Value_Weight_Tuple<T>* sorted = inp_buf;
+  // a pass is skipped if all keys fall into one bin, which is common for the
+  // high digits when tables are much smaller than the 8-bit digit range
+  bool skip_pass = false;
 
-#pragma omp parallel
+#pragma omp parallel if (elements_count >= RADIX_SORT_PARALLEL_THRESHOLD)
   {
     int tid = omp_get_thread_num();
     int nthreads = omp_get_num_threads();
 
-    int* local_histogram = &histogram[HIST_SIZE * tid];
-    int* local_histogram_ps = &histogram_ps[HIST_SIZE * tid];
-    int elements_count_4 = elements_count / 4 * 4;
+    int64_t* local_histogram = &histogram[HIST_SIZE * tid];
+    int64_t* local_histogram_ps = &histogram_ps[HIST_SIZE * tid];
+    int64_t elements_count_4 = elements_count / 4 * 4;
     Key_Value_Weight_Tuple<T>* input = inp_buf;
     Key_Value_Weight_Tuple<T>* output = tmp_buf;
 
@@ -64,21 +73,35 @@ Key_Value_Weight_Tuple<T>* radix_sort_parallel(
         }
       }
 #pragma omp barrier
-      /* Step 2: prefix sum */
-      if (tid == 0) {
-        int sum = 0, prev_sum = 0;
-        for (int bins = 0; bins < HIST_SIZE; bins++)
-          for (int t = 0; t < nthreads; t++) {
-            sum += histogram[t * HIST_SIZE + bins];
-            histogram_ps[t * HIST_SIZE + bins] = prev_sum;
-            prev_sum = sum;
-          }
-        histogram_ps[HIST_SIZE * nthreads] = prev_sum;
-        if (prev_sum != elements_count) {
-          /* printf("Error1!\n"); exit(123); */
+      /* Step 2: prefix sum, bins are split among threads */
+#pragma omp for schedule(static)
+      for (int bins = 0; bins < HIST_SIZE; bins++) {
+        int64_t sum = 0;
+        for (int t = 0; t < nthreads; t++)
+          sum += histogram[t * HIST_SIZE + bins];
+        bin_start[bins] = sum;
+      }
+#pragma omp single
+      {
+        int64_t prev_sum = 0;
+        skip_pass = false;
+        for (int bins = 0; bins < HIST_SIZE; bins++) {
+          int64_t sum = bin_start[bins];
+          skip_pass |= (sum == elements_count);
+          bin_start[bins] = prev_sum;
+          prev_sum += sum;
+        }
+      }
+      if (skip_pass)
+        continue;
+#pragma omp for schedule(static)
+      for (int bins = 0; bins < HIST_SIZE; bins++) {
+        int64_t prev_sum = bin_start[bins];
+        for (int t = 0; t < nthreads; t++) {
+          histogram_ps[t * HIST_SIZE + bins] = prev_sum;
+          prev_sum += histogram[t * HIST_SIZE + bins];
         }
       }
-#pragma omp barrier
 
       /* Step 3: scatter */
 #pragma omp for schedule(static)
@@ -91,7 +114,7 @@ Key_Value_Weight_Tuple<T>* radix_sort_parallel(
         T bin_2 = (val_2 >> (pass * 8)) & 0xFF;
         T bin_3 = (val_3 >> (pass * 8)) & 0xFF;
         T bin_4 = (val_4 >> (pass * 8)) & 0xFF;
-        int pos;
+        int64_t pos;
         pos = local_histogram_ps[bin_1]++;
         output[pos] = input[i];
         pos = local_histogram_ps[bin_2]++;
@@ -104,7 +127,7 @@ Key_Value_Weight_Tuple<T>* radix_sort_parallel(
       if (tid == (nthreads - 1)) {
         for (int64_t i = elements_count_4; i < elements_count; i++) {
           T val = std::get<0>(input[i]);
-          int pos = local_histogram_ps[(val >> (pass * 8)) & 0xFF]++;
+          int64_t pos = local_histogram_ps[(val >> (pass * 8)) & 0xFF]++;
           output[pos] = input[i];
         }
       }
@@ -114,8 +137,10 @@ Key_Value_Weight_Tuple<T>* radix_sort_parallel(
       output = temp;
 #pragma omp barrier
     }
+    if (tid == 0)
+      sorted = input;
   }
-  return (num_passes % 2 == 0 ? inp_buf : tmp_buf);
+  return sorted;
 }
 
 } // namespace cpu
@@ -0,0 +1,96 @@
+#include "scratch_arena.h"
+
+#include <ATen/ATen.h>
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <map>
+
+#include "runtime/NumaAllocator.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+ScratchArena::~ScratchArena() {
+  release();
+}
+
+void* ScratchArena::allocate(size_t nbytes) {
+  nbytes = (nbytes + kAlignment - 1) / kAlignment * kAlignment;
+  while (current_ < blocks_.size()) {
+    if (offset_ + nbytes <= blocks_[current_].capacity) {
+      void* ptr = static_cast<char*>(blocks_[current_].data) + offset_;
+      offset_ += nbytes;
+      return ptr;
+    }
+    if (current_ + 1 == blocks_.size()) {
+      break;
+    }
+    current_++;
+    offset_ = 0;
+  }
+  // chain a new block, twice the last one, the allocations of the previous
+  // blocks staying in place
+  size_t capacity = std::max(nbytes, kMinBlockBytes);
+  if (!blocks_.empty()) {
+    capacity = std::max(capacity, blocks_.back().capacity * 2);
+  }
+  void* data = c10::GetAllocator(c10::DeviceType::CPU)->raw_allocate(capacity);
+  TORCH_CHECK(data, "ScratchArena: failed to allocate ", capacity, " bytes");
+  blocks_.push_back({data, capacity});
+  current_ = blocks_.size() - 1;
+  offset_ = nbytes;
+  return data;
+}
+
+at::Tensor ScratchArena::empty(c10::IntArrayRef sizes, at::ScalarType dtype) {
+  int64_t numel = 1;
+  for (auto size : sizes) {
+    numel *= size;
+  }
+  void* data = allocate(numel * c10::elementSize(dtype));
+  return at::from_blob(data, sizes, at::TensorOptions().dtype(dtype));
+}
+
+void ScratchArena::reset(const Mark& mark) {
+  current_ = mark.block;
+  offset_ = mark.offset;
+  if (current_ == 0 && offset_ == 0 && blocks_.size() > 1) {
+    // the arena is empty: a single block of the peak size, which the next
+    // calls bump into without chaining
+    size_t capacity = this->capacity();
+    release();
+    blocks_.push_back(
+        {c10::GetAllocator(c10::DeviceType::CPU)->raw_allocate(capacity),
+         capacity});
+  }
+}
+
+size_t ScratchArena::capacity() const {
+  size_t capacity = 0;
+  for (const auto& block : blocks_) {
+    capacity += block.capacity;
+  }
+  return capacity;
+}
+
+void ScratchArena::release() {
+  c10::Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+  for (const auto& block : blocks_) {
+    allocator->raw_deallocate(block.data);
+  }
+  blocks_.clear();
+  current_ = 0;
+  offset_ = 0;
+}
+
+ScratchArena& get_scratch_arena() {
+  // the node ids of the memory policy of the pool key the arenas, whose
+  // blocks are on the nodes of the pool; a map keeps them in place
+  static thread_local std::map<std::vector<int32_t>, ScratchArena> arenas;
+  return arenas[torch_ipex::runtime::get_thread_numa_node_ids()];
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/core/ScalarType.h>
+#include <c10/macros/Macros.h>
+#include <c10/util/ArrayRef.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Bump pointer arena of the short lived workspaces of the kernels, e.g. the
+// per thread blocks of the flash attention or the partial sums of GroupNorm.
+// An allocation is a pointer increment into a block kept across the calls,
+// so the steady state of a kernel neither calls the allocator nor faults the
+// pages of its workspaces in again. The blocks are chained when the arena
+// runs out, allocations being never moved, and merged into a single block
+// when the arena is empty again. Each thread owns an arena per memory policy
+// of the CPUPool it is pinned to, whose blocks are allocated by the CPU
+// allocator, i.e. on the NUMA nodes of the pool.
+class ScratchArena {
+ public:
+  struct Mark {
+    size_t block;
+    size_t offset;
+  };
+
+  static constexpr size_t kAlignment = 64;
+  // The smallest block, so that the small workspaces share a block
+  static constexpr size_t kMinBlockBytes = 64 << 10;
+
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+  ~ScratchArena();
+
+  void* allocate(size_t nbytes);
+
+  template <typename T>
+  T* allocate(int64_t numel) {
+    return static_cast<T*>(allocate(numel * sizeof(T)));
+  }
+
+  // A contiguous tensor of the arena, which must not outlive the scope it is
+  // allocated in
+  at::Tensor empty(c10::IntArrayRef sizes, at::ScalarType dtype);
+
+  Mark mark() const {
+    return {current_, offset_};
+  }
+  // Frees the allocations after the mark
+  void reset(const Mark& mark);
+
+  size_t capacity() const;
+
+ private:
+  struct Block {
+    void* data;
+    size_t capacity;
+  };
+
+  void release();
+
+  std::vector<Block> blocks_;
+  size_t current_ = 0;
+  size_t offset_ = 0;
+};
+
+// The arena of the calling thread, for the memory policy of its CPUPool
+TORCH_API ScratchArena& get_scratch_arena();
+
+// Frees the allocations of the scope from the arena of the calling thread
+// when it ends. Scopes are nested like the calls, and an arena is only used
+// by the thread that owns it: the workspaces shared by the threads of a
+// parallel region are allocated before it by the calling thread, and the
+// private ones of a thread in a scope of its own inside the region.
+class ScratchScope {
+ public:
+  ScratchScope() : arena_(get_scratch_arena()), mark_(arena_.mark()) {}
+  ScratchScope(const ScratchScope&) = delete;
+  ScratchScope& operator=(const ScratchScope&) = delete;
+  ~ScratchScope() {
+    arena_.reset(mark_);
+  }
+
+  template <typename T>
+  T* allocate(int64_t numel) {
+    return arena_.allocate<T>(numel);
+  }
+
+  at::Tensor empty(c10::IntArrayRef sizes, at::ScalarType dtype) {
+    return arena_.empty(sizes, dtype);
+  }
+
+ private:
+  ScratchArena& arena_;
+  ScratchArena::Mark mark_;
+};
+
+} // namespace cpu
+} // namespace torch_ipex
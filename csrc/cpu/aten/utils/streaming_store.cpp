@@ -0,0 +1,41 @@
+#include "streaming_store.h"
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// Several times the LLC share of a core, so that only the outputs which can't
+// stay in the caches until they are read are streamed
+std::atomic<int64_t> streaming_store_threshold = []() {
+  int64_t threshold = 16 << 20;
+  static char* val = getenv("IPEX_STREAMING_STORE_THRESHOLD");
+  if (val != NULL) {
+    std::string threshold_str = val;
+    if (!threshold_str.empty()) {
+      threshold = std::max<int64_t>(std::stoll(threshold_str), 0);
+    }
+  }
+  return threshold;
+}();
+
+} // namespace
+
+int64_t get_streaming_store_threshold() {
+  return streaming_store_threshold.load(std::memory_order_relaxed);
+}
+
+void set_streaming_store_threshold(int64_t bytes) {
+  TORCH_CHECK(bytes >= 0, "streaming store threshold should be >= 0");
+  streaming_store_threshold.store(bytes, std::memory_order_relaxed);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The memory bound kernels (cat, index_select, the bf16/fp32 converters and
+// the fused optimizer steps) write an output of at least this many bytes with
+// non-temporal stores, which bypass the caches instead of evicting the working
+// set for data that won't be read again soon. 0 disables the streaming stores.
+// The default can be overridden by env "IPEX_STREAMING_STORE_THRESHOLD".
+TORCH_API int64_t get_streaming_store_threshold();
+TORCH_API void set_streaming_store_threshold(int64_t bytes);
+
+inline bool use_streaming_store(int64_t bytes) {
+  int64_t threshold = get_streaming_store_threshold();
+  return threshold > 0 && bytes >= threshold;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,9 +1,13 @@
 #include "autocast_mode.h"
 
 #include "library.h"
+#include "utils/onednn_utils.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <string>
 
 namespace torch_ipex {
 namespace autocast {
@@ -12,10 +16,33 @@ namespace {
 
 using weakref_type =
     c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
-using val_type = std::tuple<weakref_type, at::Tensor>;
+// the weak reference keeps the TensorImpl of the weight allocated, so that
+// its address isn't reused by another tensor while the entry lives. The cast
+// is valid as long as the weight has the version it was cast from.
+using val_type = std::tuple<weakref_type, int64_t, at::Tensor>;
 thread_local std::unordered_map<c10::TensorImpl*, val_type> cached_casts;
 
+std::atomic<bool> autocast_cache_persistent = []() {
+  bool persistent = false;
+  static char* val = getenv("IPEX_AUTOCAST_CACHE_PERSISTENT");
+  if (val != NULL) {
+    std::string persistent_str = val;
+    if (!persistent_str.empty()) {
+      persistent = std::stoi(persistent_str) != 0;
+    }
+  }
+  return persistent;
+}();
+
 thread_local at::ScalarType current_target_dtype = at::kBFloat16;
+
+// Whether oneDNN runs the ops of the user_defined_dtype_if_supported policy
+// natively in dtype on this CPU. Without it, fp16 convolutions and GEMMs are
+// emulated and run slower than in fp32.
+bool is_dtype_natively_supported(at::ScalarType dtype) {
+  static bool fp16_supported = utils::onednn_has_fp16_type_support();
+  return dtype != at::kHalf || fp16_supported;
+}
 } // namespace
 
 at::ScalarType get_autocast_dtype() {
@@ -30,6 +57,24 @@ void clear_autocast_cache() {
   cached_casts.clear();
 }
 
+void prune_autocast_cache() {
+  for (auto it = cached_casts.begin(); it != cached_casts.end();) {
+    if (std::get<0>(it->second).expired()) {
+      it = cached_casts.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool is_autocast_cache_persistent() {
+  return autocast_cache_persistent.load(std::memory_order_relaxed);
+}
+
+void set_autocast_cache_persistent(bool persistent) {
+  autocast_cache_persistent.store(persistent, std::memory_order_relaxed);
+}
+
 Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
   if (is_eligible_cpu(arg) && (arg.scalar_type() != to_type)) {
     bool can_try_cache =
@@ -39,8 +84,12 @@ Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
 
     if (can_try_cache) {
       auto it = cached_casts.find(arg.unsafeGetTensorImpl());
-      if (it != cached_casts.end()) {
-        return std::get<1>(it->second);
+      // the weight wasn't written since its cast, e.g. by the optimizer, and
+      // the cast has the autocast dtype, which a persistent cache outlives
+      if (it != cached_casts.end() &&
+          std::get<1>(it->second) == arg._version() &&
+          std::get<2>(it->second).scalar_type() == to_type) {
+        return std::get<2>(it->second);
       }
     }
     auto casted_arg = arg;
@@ -55,9 +104,10 @@ Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
       // casted_arg = arg.to_dense(at::kFloat);
     }
     if (can_try_cache) {
-      cached_casts.emplace(
+      cached_casts.insert_or_assign(
           arg.unsafeGetTensorImpl(),
-          val_type{weakref_type(arg.getIntrusivePtr()), casted_arg});
+          val_type{
+              weakref_type(arg.getIntrusivePtr()), arg._version(), casted_arg});
     }
     return casted_arg;
   } else {
@@ -123,6 +173,10 @@ struct CPU_WrapFunction_<
     switch (policy) {
       case DtypeCastPolicy::user_defined_dtype:
         return (*F)(cpu_cached_cast(set_type, args)...);
+      case DtypeCastPolicy::user_defined_dtype_if_supported:
+        return (*F)(cpu_cached_cast(
+            is_dtype_natively_supported(set_type) ? set_type : at::kFloat,
+            args)...);
       case DtypeCastPolicy::fp32:
         return (*F)(cpu_cached_cast(at::kFloat, args)...);
       case DtypeCastPolicy::promote:
@@ -152,7 +206,8 @@ struct CPU_WrapFunction_<
           &FUNC>::type::call);
 
 IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
-  // low precision policy for bf16 and fp32 cast policy for fp16
+  // low precision policy for bf16 and fp16, fp16 falls back to fp32 on CPUs
+  // without native fp16 support
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv1d),
       "conv1d",
@@ -165,7 +220,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           IntArrayRef,
           int64_t),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv2d),
       "conv2d",
@@ -178,7 +233,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           IntArrayRef,
           int64_t),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv3d),
       "conv3d",
@@ -191,19 +246,19 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           IntArrayRef,
           int64_t),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(bmm),
       "bmm",
       Tensor(const Tensor&, const Tensor&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(mm),
       "mm",
       Tensor(const Tensor&, const Tensor&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(baddbmm),
       "baddbmm",
@@ -214,7 +269,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           const Scalar&,
           const Scalar&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(addmm),
       "addmm",
@@ -225,7 +280,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           const Scalar&,
           const Scalar&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(addbmm),
       "addbmm",
@@ -236,13 +291,13 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           const Scalar&,
           const Scalar&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(linear),
       "linear",
       Tensor(const Tensor&, const Tensor&, const c10::optional<Tensor>&),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(_convolution),
       "_convolution.deprecated",
@@ -260,19 +315,13 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           bool,
           bool),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(matmul),
       "matmul",
       Tensor(const Tensor&, const Tensor&),
       user_defined_dtype,
-      fp32)
-  MAKE_REGISTER_FUNC_TWO_POLICIES(
-      ADD_NS(conv_tbc),
-      "conv_tbc",
-      Tensor(const Tensor&, const Tensor&, const Tensor&, int64_t),
-      user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv_transpose1d),
       "conv_transpose1d",
@@ -286,7 +335,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           int64_t,
           IntArrayRef),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv_transpose2d),
       "conv_transpose2d.input",
@@ -300,7 +349,7 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           int64_t,
           IntArrayRef),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(conv_transpose3d),
       "conv_transpose3d.input",
@@ -314,8 +363,15 @@ IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
           int64_t,
           IntArrayRef),
       user_defined_dtype,
-      fp32)
+      user_defined_dtype_if_supported)
 
+  // low precision policy for bf16 and fp32 cast policy for fp16
+  MAKE_REGISTER_FUNC_TWO_POLICIES(
+      ADD_NS(conv_tbc),
+      "conv_tbc",
+      Tensor(const Tensor&, const Tensor&, const Tensor&, int64_t),
+      user_defined_dtype,
+      fp32)
   MAKE_REGISTER_FUNC_TWO_POLICIES(
       ADD_NS(group_norm),
       "group_norm",
@@ -18,6 +18,10 @@ using namespace c10;
 
 enum class TORCH_API DtypeCastPolicy : uint8_t {
   user_defined_dtype = 0,
+  user_defined_dtype_if_supported, // Run in the user defined dtype if oneDNN
+                                   // has native kernels for it on this CPU,
+                                   // e.g. fp16 on AVX512-FP16 / AMX-FP16,
+                                   // otherwise cast all inputs to at::kFloat.
   fp32, // Cast all inputs to at::kFloat before running the op.
   fp32_set_opt_dtype, // Treats functions (like softmax) that
                       //   1. we'd like to run in fp32 and
@@ -41,6 +45,13 @@ enum class TORCH_API DtypeCastPolicy : uint8_t {
 TORCH_API at::ScalarType get_autocast_dtype();
 TORCH_API void set_autocast_dtype(at::ScalarType dtype);
 TORCH_API void clear_autocast_cache();
+// Drops the casts of the weights which were freed
+TORCH_API void prune_autocast_cache();
+// Whether the casts of the weights outlive the autocast regions, to be reused
+// by the next iterations until the weights are written. Off by default, env
+// "IPEX_AUTOCAST_CACHE_PERSISTENT=1" turns it on.
+TORCH_API bool is_autocast_cache_persistent();
+TORCH_API void set_autocast_cache_persistent(bool persistent);
 
 Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg);
 
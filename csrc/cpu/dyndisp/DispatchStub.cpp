@@ -9,6 +9,9 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
 
 namespace torch_ipex {
 namespace cpu {
@@ -29,8 +32,12 @@ const char* CPUCapabilityToString(CPUCapability isa) {
       return "AVX512_VNNI";
     case CPUCapability::AVX512_BF16:
       return "AVX512_BF16";
+    case CPUCapability::AVX512_FP16:
+      return "AVX512_FP16";
     case CPUCapability::AMX:
       return "AMX";
+    case CPUCapability::AMX_FP16:
+      return "AMX_FP16";
     case CPUCapability::NUM_OPTIONS:
       return "OutOfBoundaryLevel";
 
@@ -39,12 +46,35 @@ const char* CPUCapabilityToString(CPUCapability isa) {
   }
 }
 
+bool CPUCapabilityFromString(const std::string& str, CPUCapability& isa) {
+  static const std::map<std::string, CPUCapability> isa_names = {
+      {"amx_fp16", CPUCapability::AMX_FP16},
+      {"amx", CPUCapability::AMX},
+      {"avx512_fp16", CPUCapability::AVX512_FP16},
+      {"avx512_bf16", CPUCapability::AVX512_BF16},
+      {"avx512_vnni", CPUCapability::AVX512_VNNI},
+      {"avx512", CPUCapability::AVX512},
+      {"avx2_vnni", CPUCapability::AVX2_VNNI},
+      {"avx2", CPUCapability::AVX2},
+      {"default", CPUCapability::DEFAULT}};
+  auto it = isa_names.find(str);
+  if (it == isa_names.end()) {
+    return false;
+  }
+  isa = it->second;
+  return true;
+}
+
 CPUCapability _get_highest_cpu_support_isa_level() {
   /*
   reference to FindAVX.cmake
   */
-  if (CPUFeature::get_instance().isa_level_amx()) {
+  if (CPUFeature::get_instance().isa_level_amx_fp16()) {
+    return CPUCapability::AMX_FP16;
+  } else if (CPUFeature::get_instance().isa_level_amx()) {
     return CPUCapability::AMX;
+  } else if (CPUFeature::get_instance().isa_level_avx512_fp16()) {
+    return CPUCapability::AVX512_FP16;
   } else if (CPUFeature::get_instance().isa_level_avx512_bf16()) {
     return CPUCapability::AVX512_BF16;
   } else if (CPUFeature::get_instance().isa_level_avx512_vnni()) {
@@ -62,9 +92,15 @@ CPUCapability _get_highest_cpu_support_isa_level() {
 }
 
 CPUCapability _get_highest_binary_support_isa_level() {
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+  return CPUCapability::AMX_FP16;
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
   return CPUCapability::AMX;
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+  return CPUCapability::AVX512_FP16;
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
   return CPUCapability::AVX512_BF16;
 #endif
@@ -122,8 +158,12 @@ cpu_isa ipex_isa_to_onednn_isa(CPUCapability ipex_isa) {
       return cpu_isa::avx512_core_vnni;
     case CPUCapability::AVX512_BF16:
       return cpu_isa::avx512_core_bf16;
+    case CPUCapability::AVX512_FP16:
+      return cpu_isa::avx512_core_fp16;
     case CPUCapability::AMX:
       return cpu_isa::avx512_core_amx;
+    case CPUCapability::AMX_FP16:
+      return cpu_isa::avx512_core_amx_fp16;
     case CPUCapability::NUM_OPTIONS:
       TORCH_WARN("DispatchStub: OutOfBoundaryISALevel for IPEX");
       return cpu_isa::isa_default;
@@ -154,21 +194,7 @@ static CPUCapability compute_cpu_capability() {
   */
   auto envar = std::getenv("ATEN_CPU_CAPABILITY");
   if (envar) {
-    if (strcmp(envar, "amx") == 0) {
-      manual_setup_isa_level = CPUCapability::AMX;
-    } else if (strcmp(envar, "avx512_bf16") == 0) {
-      manual_setup_isa_level = CPUCapability::AVX512_BF16;
-    } else if (strcmp(envar, "avx512_vnni") == 0) {
-      manual_setup_isa_level = CPUCapability::AVX512_VNNI;
-    } else if (strcmp(envar, "avx512") == 0) {
-      manual_setup_isa_level = CPUCapability::AVX512;
-    } else if (strcmp(envar, "avx2_vnni") == 0) {
-      manual_setup_isa_level = CPUCapability::AVX2_VNNI;
-    } else if (strcmp(envar, "avx2") == 0) {
-      manual_setup_isa_level = CPUCapability::AVX2;
-    } else if (strcmp(envar, "default") == 0) {
-      manual_setup_isa_level = CPUCapability::DEFAULT;
-    } else {
+    if (!CPUCapabilityFromString(envar, manual_setup_isa_level)) {
       TORCH_WARN("ignoring invalid value for ATEN_CPU_CAPABILITY: ", envar);
       b_manual_setup = false;
     }
@@ -198,13 +224,208 @@ CPUCapability get_cpu_capability() {
   return g_cpu_capability;
 }
 
+void DispatchStubImpl::set_cpu_capability(CPUCapability isa) {
+  cpu_capability_override.store(
+      static_cast<int>(isa) + 1, std::memory_order_relaxed);
+  cpu_dispatch_ptr.store(nullptr, std::memory_order_relaxed);
+}
+
+void DispatchStubImpl::reset_cpu_capability() {
+  cpu_capability_override.store(0, std::memory_order_relaxed);
+  cpu_dispatch_ptr.store(nullptr, std::memory_order_relaxed);
+}
+
+bool DispatchStubImpl::has_cpu_capability_override() const {
+  return cpu_capability_override.load(std::memory_order_relaxed) > 0;
+}
+
+CPUCapability DispatchStubImpl::cpu_capability() const {
+  int isa_override = cpu_capability_override.load(std::memory_order_relaxed);
+  return isa_override > 0 ? static_cast<CPUCapability>(isa_override - 1)
+                          : get_cpu_capability();
+}
+
+namespace {
+struct DispatchStubEntry {
+  DispatchStubImpl* impl;
+  get_cpu_impl_fn get_cpu_impl;
+};
+
+std::mutex& dispatch_stub_registry_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// A name may be defined in several namespaces, the stubs share the override
+std::map<std::string, std::vector<DispatchStubEntry>>&
+dispatch_stub_registry() {
+  static std::map<std::string, std::vector<DispatchStubEntry>> registry;
+  return registry;
+}
+
+// The overrides of IPEX_DISPATCH_STUB_ISA, e.g. "stub_a=avx512,stub_b=avx2"
+std::map<std::string, CPUCapability> load_dispatch_stub_isa_setting() {
+  std::map<std::string, CPUCapability> isa_setting;
+  auto envar = std::getenv("IPEX_DISPATCH_STUB_ISA");
+  if (!envar) {
+    return isa_setting;
+  }
+  std::stringstream ss(envar);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto pos = item.find('=');
+    CPUCapability isa;
+    if (pos == std::string::npos ||
+        !CPUCapabilityFromString(item.substr(pos + 1), isa)) {
+      TORCH_WARN("ignoring invalid value for IPEX_DISPATCH_STUB_ISA: ", item);
+      continue;
+    }
+    isa_setting[item.substr(0, pos)] = isa;
+  }
+  return isa_setting;
+}
+
+CPUCapability get_max_support_isa_level() {
+  return std::min(
+      _get_highest_cpu_support_isa_level(),
+      _get_highest_binary_support_isa_level());
+}
+
+std::vector<DispatchStubEntry>& get_dispatch_stub_entries(
+    const std::string& name) {
+  auto& registry = dispatch_stub_registry();
+  auto it = registry.find(name);
+  TORCH_CHECK(it != registry.end(), "DispatchStub: unknown stub ", name);
+  return it->second;
+}
+
+bool has_cpu_impl(
+    const std::vector<DispatchStubEntry>& entries,
+    CPUCapability isa) {
+  return std::all_of(entries.begin(), entries.end(), [&](const auto& entry) {
+    return entry.get_cpu_impl(isa) != nullptr;
+  });
+}
+} // namespace
+
+void register_dispatch_stub(
+    const char* name,
+    DispatchStubImpl* impl,
+    get_cpu_impl_fn get_cpu_impl) {
+  static const std::map<std::string, CPUCapability> isa_setting =
+      load_dispatch_stub_isa_setting();
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  dispatch_stub_registry()[name].push_back({impl, get_cpu_impl});
+  impl->name = name;
+  auto it = isa_setting.find(name);
+  if (it != isa_setting.end()) {
+    // the kernels may not be registered yet, a missing one falls back to
+    // AVX2 when the stub is called, like for the global ISA level
+    impl->set_cpu_capability(std::min(it->second, get_max_support_isa_level()));
+  }
+}
+
+std::vector<std::string> get_dispatch_stub_names() {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  std::vector<std::string> names;
+  for (const auto& it : dispatch_stub_registry()) {
+    names.push_back(it.first);
+  }
+  return names;
+}
+
+std::vector<CPUCapability> get_dispatch_stub_isa_levels(
+    const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  const auto& entries = get_dispatch_stub_entries(name);
+  std::vector<CPUCapability> isa_levels;
+  for (int isa = 0; isa <= static_cast<int>(get_max_support_isa_level());
+       isa++) {
+    if (has_cpu_impl(entries, static_cast<CPUCapability>(isa))) {
+      isa_levels.push_back(static_cast<CPUCapability>(isa));
+    }
+  }
+  return isa_levels;
+}
+
+CPUCapability get_dispatch_stub_isa_level(const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  return get_dispatch_stub_entries(name)[0].impl->cpu_capability();
+}
+
+std::vector<CPUCapability> get_dispatch_stub_binary_isa_levels(
+    const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  const auto& entries = get_dispatch_stub_entries(name);
+  std::vector<CPUCapability> isa_levels;
+  for (int isa = 0; isa < static_cast<int>(CPUCapability::NUM_OPTIONS);
+       isa++) {
+    if (has_cpu_impl(entries, static_cast<CPUCapability>(isa))) {
+      isa_levels.push_back(static_cast<CPUCapability>(isa));
+    }
+  }
+  return isa_levels;
+}
+
+CPUCapability get_dispatch_stub_kernel_isa_level(const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  const auto& entries = get_dispatch_stub_entries(name);
+  auto isa = entries[0].impl->cpu_capability();
+  // as choose_cpu_impl, the levels above AVX2_VNNI fall back to AVX2
+  if (isa > CPUCapability::AVX2_VNNI && !has_cpu_impl(entries, isa)) {
+    return CPUCapability::AVX2;
+  }
+  return isa;
+}
+
+bool is_dispatch_stub_isa_level_set(const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  return get_dispatch_stub_entries(name)[0]
+      .impl->has_cpu_capability_override();
+}
+
+void set_dispatch_stub_isa_level(const std::string& name, CPUCapability isa) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  auto& entries = get_dispatch_stub_entries(name);
+  TORCH_CHECK(
+      isa <= get_max_support_isa_level(),
+      "DispatchStub: ",
+      CPUCapabilityToString(isa),
+      " is not supported by the CPU or the binary");
+  TORCH_CHECK(
+      has_cpu_impl(entries, isa),
+      "DispatchStub: ",
+      name,
+      " has no ",
+      CPUCapabilityToString(isa),
+      " kernel");
+  for (auto& entry : entries) {
+    entry.impl->set_cpu_capability(isa);
+  }
+}
+
+void reset_dispatch_stub_isa_level(const std::string& name) {
+  std::lock_guard<std::mutex> lock(dispatch_stub_registry_mutex());
+  for (auto& entry : get_dispatch_stub_entries(name)) {
+    entry.impl->reset_cpu_capability();
+  }
+}
+
 void* DispatchStubImpl::get_call_ptr(
     DeviceType device_type,
     void* DEFAULT
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+    ,
+    void* AMX_FP16
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
     ,
     void* AMX
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+    ,
+    void* AVX512_FP16
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
     ,
     void* AVX512_BF16
@@ -234,10 +455,18 @@ void* DispatchStubImpl::get_call_ptr(
       if (!fptr) {
         fptr = choose_cpu_impl(
             DEFAULT
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+            ,
+            AMX_FP16
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
             ,
             AMX
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+            ,
+            AVX512_FP16
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
             ,
             AVX512_BF16
@@ -276,12 +505,34 @@ void* DispatchStubImpl::get_call_ptr(
   }
 }
 
+namespace {
+// The stubs falling back to AVX2 are warned about once, when their kernel is
+// chosen, since they may run much slower than the other kernels of the ISA
+// level of the CPU
+void warn_missing_cpu_kernel(const char* name, CPUCapability isa) {
+  TORCH_WARN(
+      "DispatchStub: ",
+      name ? name : "unregistered stub",
+      " has no ",
+      CPUCapabilityToString(isa),
+      " kernel, running its AVX2 kernel instead");
+}
+} // namespace
+
 void* DispatchStubImpl::choose_cpu_impl(
     void* DEFAULT
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+    ,
+    void* AMX_FP16
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
     ,
     void* AMX
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+    ,
+    void* AVX512_FP16
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
     ,
     void* AVX512_BF16
@@ -303,8 +554,20 @@ void* DispatchStubImpl::choose_cpu_impl(
     void* AVX2
 #endif
 ) {
-  auto capability = static_cast<int>(get_cpu_capability());
+  auto capability = static_cast<int>(cpu_capability());
   (void)capability;
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+  if (capability >= static_cast<int>(CPUCapability::AMX_FP16)) {
+    if (C10_UNLIKELY(!AMX_FP16)) {
+      // dispatch to AVX2, since the AMX_FP16 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AMX_FP16);
+      TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
+      return AVX2;
+    } else {
+      return AMX_FP16;
+    }
+  }
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
   if (capability >= static_cast<int>(CPUCapability::AMX)) {
     // Quantization kernels have also been disabled on Windows
@@ -312,6 +575,7 @@ void* DispatchStubImpl::choose_cpu_impl(
     // Ideally, we should have AVX512 kernels for all kernels.
     if (C10_UNLIKELY(!AMX)) {
       // dispatch to AVX2, since the AVX512 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AMX);
       TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
       return AVX2;
     } else {
@@ -319,6 +583,21 @@ void* DispatchStubImpl::choose_cpu_impl(
     }
   }
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+  if (capability >= static_cast<int>(CPUCapability::AVX512_FP16)) {
+    // Quantization kernels have also been disabled on Windows
+    // for AVX512 because some of their tests are flaky on Windows.
+    // Ideally, we should have AVX512 kernels for all kernels.
+    if (C10_UNLIKELY(!AVX512_FP16)) {
+      // dispatch to AVX2, since the AVX512 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AVX512_FP16);
+      TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
+      return AVX2;
+    } else {
+      return AVX512_FP16;
+    }
+  }
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
   if (capability >= static_cast<int>(CPUCapability::AVX512_BF16)) {
     // Quantization kernels have also been disabled on Windows
@@ -326,6 +605,7 @@ void* DispatchStubImpl::choose_cpu_impl(
     // Ideally, we should have AVX512 kernels for all kernels.
     if (C10_UNLIKELY(!AVX512_BF16)) {
       // dispatch to AVX2, since the AVX512 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AVX512_BF16);
       TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
       return AVX2;
     } else {
@@ -340,6 +620,7 @@ void* DispatchStubImpl::choose_cpu_impl(
     // Ideally, we should have AVX512 kernels for all kernels.
     if (C10_UNLIKELY(!AVX512_VNNI)) {
       // dispatch to AVX2, since the AVX512 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AVX512_VNNI);
       TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
       return AVX2;
     } else {
@@ -354,6 +635,7 @@ void* DispatchStubImpl::choose_cpu_impl(
     // Ideally, we should have AVX512 kernels for all kernels.
     if (C10_UNLIKELY(!AVX512)) {
       // dispatch to AVX2, since the AVX512 kernel is missing
+      warn_missing_cpu_kernel(name, CPUCapability::AVX512);
       TORCH_INTERNAL_ASSERT(AVX2, "DispatchStub: missing AVX2 kernel");
       return AVX2;
     } else {
@@ -5,7 +5,9 @@
 #include <c10/util/Exception.h>
 
 #include <atomic>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 using namespace c10;
 
@@ -55,11 +57,15 @@ enum class CPUCapability {
   AVX512 = 3,
   AVX512_VNNI = 4,
   AVX512_BF16 = 5,
-  AMX = 6,
+  AVX512_FP16 = 6,
+  AMX = 7,
+  AMX_FP16 = 8,
   NUM_OPTIONS
 };
 
 const char* CPUCapabilityToString(CPUCapability isa);
+// Parses the lower case names of ATEN_CPU_CAPABILITY, e.g. "avx512_vnni"
+bool CPUCapabilityFromString(const std::string& str, CPUCapability& isa);
 CPUCapability _get_highest_cpu_support_isa_level();
 CPUCapability _get_highest_binary_support_isa_level();
 
@@ -80,10 +86,18 @@ struct TORCH_API DispatchStubImpl {
   void* get_call_ptr(
       DeviceType device_type,
       void* DEFAULT
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+      ,
+      void* AMX_FP16
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
       ,
       void* AMX
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+      ,
+      void* AVX512_FP16
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
       ,
       void* AVX512_BF16
@@ -113,10 +127,18 @@ struct TORCH_API DispatchStubImpl {
    */
   void* choose_cpu_impl(
       void* DEFAULT
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+      ,
+      void* AMX_FP16
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
       ,
       void* AMX
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+      ,
+      void* AVX512_FP16
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
       ,
       void* AVX512_BF16
@@ -139,17 +161,64 @@ struct TORCH_API DispatchStubImpl {
 #endif
   );
 
+  /**
+   * Chooses the kernel of isa instead of get_cpu_capability() from the next
+   * call on, it is not meant to be changed while the stub is being called.
+   */
+  void set_cpu_capability(CPUCapability isa);
+  void reset_cpu_capability();
+  bool has_cpu_capability_override() const;
+  CPUCapability cpu_capability() const;
+
 // Fixing dispatch error in Windows debug builds.
 // See https://github.com/pytorch/pytorch/issues/22681 for more details.
 #if defined(_MSC_VER) && defined(_DEBUG)
   std::atomic<void*> cpu_dispatch_ptr;
   void* xpu_dispatch_ptr;
+  // the overriding CPUCapability + 1, 0 without override
+  std::atomic<int> cpu_capability_override;
+  const char* name;
 #else
   std::atomic<void*> cpu_dispatch_ptr{nullptr};
   void* xpu_dispatch_ptr = nullptr;
+  std::atomic<int> cpu_capability_override{0};
+  // set by register_dispatch_stub, to name the stub in the warnings
+  const char* name = nullptr;
 #endif
 };
 
+using get_cpu_impl_fn = void* (*)(CPUCapability);
+
+/**
+ * The stubs are registered by name by DEFINE_DISPATCH, so that the kernel of
+ * a stub can be chosen apart from the others, e.g. AVX512 for a kernel whose
+ * AMX version is slower for small shapes. IPEX_DISPATCH_STUB_ISA sets them at
+ * load time, e.g. "merged_embeddingbag_forward_cpu_kernel_stub=avx512".
+ */
+TORCH_API void register_dispatch_stub(
+    const char* name,
+    DispatchStubImpl* impl,
+    get_cpu_impl_fn get_cpu_impl);
+TORCH_API std::vector<std::string> get_dispatch_stub_names();
+// The ISA levels up to the CPU and the binary support the stub has a kernel of
+TORCH_API std::vector<CPUCapability> get_dispatch_stub_isa_levels(
+    const std::string& name);
+TORCH_API CPUCapability get_dispatch_stub_isa_level(const std::string& name);
+// The ISA levels the binary has a kernel of the stub for, whatever the CPU
+TORCH_API std::vector<CPUCapability> get_dispatch_stub_binary_isa_levels(
+    const std::string& name);
+// The ISA level of the kernel the stub actually runs, below
+// get_dispatch_stub_isa_level when the kernel of that level is missing and
+// the stub falls back to its AVX2 kernel
+TORCH_API CPUCapability get_dispatch_stub_kernel_isa_level(
+    const std::string& name);
+// Whether the ISA level of the stub is set apart from the others
+TORCH_API bool is_dispatch_stub_isa_level_set(const std::string& name);
+TORCH_API void set_dispatch_stub_isa_level(
+    const std::string& name,
+    CPUCapability isa);
+TORCH_API void reset_dispatch_stub_isa_level(const std::string& name);
+
 template <typename rT, typename T, typename... Args>
 struct DispatchStub<rT (*)(Args...), T> {
   using FnPtr = rT (*)(Args...);
@@ -163,10 +232,18 @@ struct DispatchStub<rT (*)(Args...), T> {
     return reinterpret_cast<FnPtr>(impl.get_call_ptr(
         device_type,
         reinterpret_cast<void*>(DEFAULT)
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+            ,
+        reinterpret_cast<void*>(AMX_FP16)
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
             ,
         reinterpret_cast<void*>(AMX)
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+            ,
+        reinterpret_cast<void*>(AVX512_FP16)
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
             ,
         reinterpret_cast<void*>(AVX512_BF16)
@@ -201,10 +278,62 @@ struct DispatchStub<rT (*)(Args...), T> {
     impl.xpu_dispatch_ptr = reinterpret_cast<void*>(fn_ptr);
   }
 
+  void register_stub(const char* name) {
+    register_dispatch_stub(name, &impl, &get_cpu_impl);
+  }
+
+  // The kernel registered for exactly isa, nullptr if it isn't built
+  static void* get_cpu_impl(CPUCapability isa) {
+    switch (isa) {
+      case CPUCapability::DEFAULT:
+        return reinterpret_cast<void*>(DEFAULT);
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+      case CPUCapability::AMX_FP16:
+        return reinterpret_cast<void*>(AMX_FP16);
+#endif
+#ifdef HAVE_AMX_CPU_DEFINITION
+      case CPUCapability::AMX:
+        return reinterpret_cast<void*>(AMX);
+#endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+      case CPUCapability::AVX512_FP16:
+        return reinterpret_cast<void*>(AVX512_FP16);
+#endif
+#ifdef HAVE_AVX512_BF16_CPU_DEFINITION
+      case CPUCapability::AVX512_BF16:
+        return reinterpret_cast<void*>(AVX512_BF16);
+#endif
+#ifdef HAVE_AVX512_VNNI_CPU_DEFINITION
+      case CPUCapability::AVX512_VNNI:
+        return reinterpret_cast<void*>(AVX512_VNNI);
+#endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+      case CPUCapability::AVX512:
+        return reinterpret_cast<void*>(AVX512);
+#endif
+#ifdef HAVE_AVX2_VNNI_CPU_DEFINITION
+      case CPUCapability::AVX2_VNNI:
+        return reinterpret_cast<void*>(AVX2_VNNI);
+#endif
+#ifdef HAVE_AVX2_CPU_DEFINITION
+      case CPUCapability::AVX2:
+        return reinterpret_cast<void*>(AVX2);
+#endif
+      default:
+        return nullptr;
+    }
+  }
+
   static FnPtr DEFAULT;
+#ifdef HAVE_AMX_FP16_CPU_DEFINITION
+  static FnPtr AMX_FP16;
+#endif
 #ifdef HAVE_AMX_CPU_DEFINITION
   static FnPtr AMX;
 #endif
+#ifdef HAVE_AVX512_FP16_CPU_DEFINITION
+  static FnPtr AVX512_FP16;
+#endif
 #ifdef HAVE_AVX512_BF16_CPU_DEFINITION
   static FnPtr AVX512_BF16;
 #endif
@@ -226,6 +355,13 @@ struct DispatchStub<rT (*)(Args...), T> {
 };
 
 namespace {
+template <typename T>
+struct RegisterDispatchStub {
+  RegisterDispatchStub(const char* name, T& stub) {
+    stub.register_stub(name);
+  }
+};
+
 template <typename FnPtr, typename T>
 struct RegisterCUDADispatch {
   RegisterCUDADispatch(DispatchStub<FnPtr, T>& stub, FnPtr value) {
@@ -255,7 +391,10 @@ struct RegisterHIPDispatch {
   };                                       \
   extern TORCH_API struct name name
 
-#define DEFINE_DISPATCH(name) struct name name
+#define DEFINE_DISPATCH(name)                                   \
+  struct name name;                                             \
+  static ::torch_ipex::cpu::RegisterDispatchStub<struct name>   \
+      name##__register(#name, name)
 
 #define REGISTER_ARCH_DISPATCH(name, arch, fn) \
   template <>                                  \
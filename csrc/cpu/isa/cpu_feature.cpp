@@ -104,9 +104,27 @@ void CPUFeature::detect_intel_cpu_feature() {
 
       MICRO_CLASS_MEMBER(avx_vnni) = check_reg_bit(eax, 4);
       MICRO_CLASS_MEMBER(avx512_bf16) = check_reg_bit(eax, 5);
+      MICRO_CLASS_MEMBER(amx_fp16) = check_reg_bit(eax, 21);
+
+      MICRO_CLASS_MEMBER(amx_complex) = check_reg_bit(edx, 8);
+      MICRO_CLASS_MEMBER(avx10) = check_reg_bit(edx, 19);
     }
   }
 
+  /*
+  Intel® Advanced Vector Extensions 10
+  Architecture Specification
+  ----------------------------------------------------
+  Leaf 24H, sub-leaf 0: EBX[7:0] is the AVX10 version, EBX[18] the support of
+  the 512-bit vector length.
+  */
+  if (MICRO_CLASS_MEMBER(avx10) && max_basic_id >= 0x00000024) {
+    read_cpuidex(0x00000024, 0, &eax, &ebx, &ecx, &edx);
+
+    m_avx10_version = BIT_M_TO_N(ebx, 0, 7);
+    MICRO_CLASS_MEMBER(avx10_512) = check_reg_bit(ebx, 18);
+  }
+
   if (max_extend_id >= 0x80000001) {
     read_cpuidex(0x80000001, 0, &eax, &ebx, &ecx, &edx);
 
@@ -355,8 +373,26 @@ bool CPUFeature::isa_level_avx512_bf16() {
   return b_is_support;
 }
 
+bool CPUFeature::isa_level_avx512_fp16() {
+  // AVX10.1/512 enumerates the AVX512_FP16 instructions by its version only
+  static bool b_is_support =
+      (isa_level_avx512_bf16() && cpuid_avx512_fp16()) || isa_level_avx10_1();
+  return b_is_support;
+}
+
+bool CPUFeature::isa_level_avx10_1() {
+  static bool b_is_support = os_avx2() && os_avx512() && cpuid_avx10() &&
+      cpuid_avx10_512() && cpuid_avx10_version() >= 1;
+  return b_is_support;
+}
+
+bool CPUFeature::isa_level_avx10_2() {
+  static bool b_is_support = isa_level_avx10_1() && cpuid_avx10_version() >= 2;
+  return b_is_support;
+}
+
 bool CPUFeature::_do_check_and_init_amx() {
-  bool b_is_support = isa_level_avx512_bf16() && os_amx() && cpuid_amx_bf16() &&
+  bool b_is_support = isa_level_avx512_fp16() && os_amx() && cpuid_amx_bf16() &&
       cpuid_amx_int8() && cpuid_amx_tile();
   if (b_is_support) {
     b_is_support = init_amx();
@@ -371,6 +407,12 @@ bool CPUFeature::isa_level_amx() {
   return b_is_support;
 }
 
+bool CPUFeature::isa_level_amx_fp16() {
+  static bool b_is_support =
+      isa_level_amx() && cpuid_avx512_fp16() && cpuid_amx_fp16();
+  return b_is_support;
+}
+
 __forceinline void print_bool_status(const char* p_name, bool b_status) {
   printf("%s:\t\t\t%s\n", p_name, (b_status ? "true" : "false"));
 }
@@ -416,9 +458,15 @@ void CPUFeature::show_features() {
   MICRO_CLASS_PRINT_BOOL_STATUS(avx512_bf16);
   MICRO_CLASS_PRINT_BOOL_STATUS(avx512_vp2intersect);
 
+  MICRO_CLASS_PRINT_BOOL_STATUS(avx10);
+  MICRO_CLASS_PRINT_BOOL_STATUS(avx10_512);
+  printf("avx10_version:\t\t\t%u\n", m_avx10_version);
+
   MICRO_CLASS_PRINT_BOOL_STATUS(amx_bf16);
   MICRO_CLASS_PRINT_BOOL_STATUS(amx_tile);
   MICRO_CLASS_PRINT_BOOL_STATUS(amx_int8);
+  MICRO_CLASS_PRINT_BOOL_STATUS(amx_fp16);
+  MICRO_CLASS_PRINT_BOOL_STATUS(amx_complex);
 
   MICRO_CLASS_PRINT_BOOL_STATUS(prefetchw);
   MICRO_CLASS_PRINT_BOOL_STATUS(prefetchwt1);
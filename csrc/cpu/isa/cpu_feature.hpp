@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #define MICRO_CLASS_MEMBER_DECL(feature_name) bool m_##feature_name = false
 #define MICRO_CLASS_MEMBER(feature_name) m_##feature_name
 #define MICRO_CLASS_CHECK_FUNC(feature_name) \
@@ -108,11 +110,27 @@ class CPUFeature {
   MICRO_CLASS_CHECK_FUNC(avx512_bf16);
   MICRO_CLASS_CHECK_FUNC(avx512_vp2intersect);
 
+  // AVX10, the converged AVX512 of the P-cores and E-cores, enumerated by its
+  // version and the vector lengths it supports
+ private:
+  MICRO_CLASS_MEMBER_DECL(avx10);
+  MICRO_CLASS_MEMBER_DECL(avx10_512);
+  uint32_t m_avx10_version = 0;
+
+ public:
+  MICRO_CLASS_CHECK_FUNC(avx10);
+  MICRO_CLASS_CHECK_FUNC(avx10_512);
+  uint32_t cpuid_avx10_version() {
+    return m_avx10_version;
+  }
+
   // AMX
  private:
   MICRO_CLASS_MEMBER_DECL(amx_bf16);
   MICRO_CLASS_MEMBER_DECL(amx_tile);
   MICRO_CLASS_MEMBER_DECL(amx_int8);
+  MICRO_CLASS_MEMBER_DECL(amx_fp16);
+  MICRO_CLASS_MEMBER_DECL(amx_complex);
   bool init_amx();
   bool _do_check_and_init_amx();
 
@@ -120,6 +138,8 @@ class CPUFeature {
   MICRO_CLASS_CHECK_FUNC(amx_bf16);
   MICRO_CLASS_CHECK_FUNC(amx_tile);
   MICRO_CLASS_CHECK_FUNC(amx_int8);
+  MICRO_CLASS_CHECK_FUNC(amx_fp16);
+  MICRO_CLASS_CHECK_FUNC(amx_complex);
 
   // prefetch
  private:
@@ -136,8 +156,10 @@ class CPUFeature {
   ------------------------------------------------------------------------------------
   The ISAs are partially ordered:
   SSE41 < AVX < AVX2,
-  AVX2 < AVX512_CORE < AVX512_CORE_VNNI < AVX512_CORE_BF16 < AVX512_CORE_AMX,
+  AVX2 < AVX512_CORE < AVX512_CORE_VNNI < AVX512_CORE_BF16 < AVX512_CORE_FP16 <
+  AVX512_CORE_AMX < AVX512_CORE_AMX_FP16,
   AVX2 < AVX2_VNNI.
+  AVX10.1/512 contains AVX512_CORE_FP16, AVX10.2/512 contains AVX10.1/512.
   Link:
   https://oneapi-src.github.io/oneDNN/dev_guide_cpu_dispatcher_control.html
   */
@@ -147,8 +169,13 @@ class CPUFeature {
   bool isa_level_avx512_core();
   bool isa_level_avx512_vnni();
   bool isa_level_avx512_bf16();
+  bool isa_level_avx512_fp16();
+
+  bool isa_level_avx10_1();
+  bool isa_level_avx10_2();
 
   bool isa_level_amx();
+  bool isa_level_amx_fp16();
 };
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
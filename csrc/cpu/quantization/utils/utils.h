@@ -22,10 +22,29 @@ inline std::tuple<double, int64_t> get_mkldnn_input_scale_zp(
   return std::make_tuple(mkldnn_scale, zp);
 }
 
+// Returns the scales of each output channel of the LSTM weight, a per tensor
+// scale being repeated for all the channels. The weight of oneDNN is symmetric.
 inline at::Tensor get_weight_scale_tensor(const at::Tensor& weight) {
   TORCH_CHECK(
-      weight.qscheme() == c10::QScheme::PER_CHANNEL_AFFINE,
-      "should use per_channel_affine quantization for weight of LSTM");
+      weight.scalar_type() == at::kQInt8,
+      "should use qint8 quantization for weight of LSTM");
+  auto qscheme = weight.qscheme();
+  if (qscheme == c10::QScheme::PER_TENSOR_AFFINE ||
+      qscheme == c10::QScheme::PER_TENSOR_SYMMETRIC) {
+    TORCH_CHECK(
+        weight.q_zero_point() == 0,
+        "should use zero point 0 for weight of LSTM");
+    return at::full({weight.size(0)}, weight.q_scale(), at::kDouble);
+  }
+  TORCH_CHECK(
+      (qscheme == c10::QScheme::PER_CHANNEL_AFFINE ||
+       qscheme == c10::QScheme::PER_CHANNEL_SYMMETRIC) &&
+          weight.q_per_channel_axis() == 0,
+      "should use per_tensor or per_channel quantization along the output "
+      "channels for weight of LSTM");
+  TORCH_CHECK(
+      weight.q_per_channel_zero_points().eq(0).all().item<bool>(),
+      "should use zero point 0 for weight of LSTM");
   at::Tensor weight_scales_tensor = weight.q_per_channel_scales();
   TORCH_CHECK(
       weight_scales_tensor.dim() == 1,
@@ -34,6 +53,20 @@ inline at::Tensor get_weight_scale_tensor(const at::Tensor& weight) {
   return weight_scales_tensor;
 }
 
+// The int8 LSTM of oneDNN reads and writes u8 data. Flipping the sign bit maps
+// a qint8 value v to the quint8 value v + 128, with a zero point of zp + 128.
+inline at::Tensor qint8_to_quint8(const at::Tensor& input) {
+  auto data = at::bitwise_xor(input.int_repr().view(at::kByte), 0x80);
+  return at::_make_per_tensor_quantized_tensor(
+      data, input.q_scale(), input.q_zero_point() + 128);
+}
+
+inline at::Tensor quint8_to_qint8(const at::Tensor& input) {
+  auto data = at::bitwise_xor(input.int_repr(), 0x80).view(at::kChar);
+  return at::_make_per_tensor_quantized_tensor(
+      data, input.q_scale(), input.q_zero_point() - 128);
+}
+
 } // namespace utils
 } // namespace int8
 } // namespace torch_ipex
\ No newline at end of file
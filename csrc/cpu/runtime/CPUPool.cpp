@@ -193,6 +193,13 @@ void _pin_cpu_cores(const torch_ipex::runtime::CPUPool& cpu_pool) {
   }
   // Cache the cpu_core_list for query.
   current_cpu_core_list = cpu_core_list;
+  // Bind the memory allocated by this thread to the NUMA nodes of the pool.
+  // A pool covering all the nodes keeps the first-touch placement.
+  const std::vector<int32_t>& numa_node_ids = cpu_pool.get_numa_node_ids();
+  set_thread_numa_node_ids(
+      static_cast<int32_t>(numa_node_ids.size()) < get_num_numa_nodes()
+          ? numa_node_ids
+          : std::vector<int32_t>());
   return;
 }
 
@@ -200,6 +207,10 @@ bool is_same_core_affinity_setting(const std::vector<int32_t>& cpu_core_list) {
   return current_cpu_core_list == cpu_core_list;
 }
 
+std::vector<int32_t> get_current_cpu_core_list() {
+  return current_cpu_core_list;
+}
+
 CPUPool get_cpu_pool_from_mask_affinity() {
   if (!is_runtime_ext_enabled()) {
     throw std::runtime_error(
@@ -216,7 +227,7 @@ CPUPool get_cpu_pool_from_mask_affinity() {
     kmp_get_affinity_ext(&mask);
     threads_mask[thread_id] = mask;
   }
-  return CPUPool(std::move(threads_mask));
+  return CPUPool(std::move(threads_mask), get_thread_numa_node_ids());
 }
 
 void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool) {
@@ -234,14 +245,30 @@ void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool) {
     kmp_affinity_mask_t mask = threads_mask[thread_id];
     kmp_set_affinity_ext(&mask);
   }
+  set_thread_numa_node_ids(cpu_pool.get_numa_node_ids());
 }
 
 CPUPool::CPUPool(const std::vector<int32_t>& cpu_core_list) {
   this->cpu_core_list = filter_cores_by_thread_affinity(cpu_core_list);
   this->cpu_core_list_initialized_ = true;
+  this->numa_node_ids = get_numa_node_ids_of_cores(this->cpu_core_list);
 }
 
-CPUPool::CPUPool(std::vector<kmp_affinity_mask_t>&& cpu_core_mask) {
+CPUPool::CPUPool(
+    const std::vector<int32_t>& cpu_core_list,
+    CoreType core_type,
+    bool physical_cores_only,
+    int32_t llc_id)
+    : CPUPool(filter_cores_by_topology(
+          filter_cores_by_thread_affinity(cpu_core_list),
+          core_type,
+          physical_cores_only,
+          llc_id)) {}
+
+CPUPool::CPUPool(
+    std::vector<kmp_affinity_mask_t>&& cpu_core_mask,
+    std::vector<int32_t> numa_node_ids)
+    : numa_node_ids(std::move(numa_node_ids)) {
   // Notice: We shouldn't load iomp symbol in sub_thread, otherwise race
   // condition happens.
   if (!is_runtime_ext_enabled()) {
@@ -258,6 +285,7 @@ CPUPool::CPUPool(CPUPool&& source_cpu_pool) {
     throw std::runtime_error(
         "Fail to CPUPool move construct. Neither cpu_core_list_initialized_ and cpu_affinity_mask_initialized_ init.");
   }
+  this->numa_node_ids = std::move(source_cpu_pool.numa_node_ids);
   if (source_cpu_pool.is_cpu_core_list_initialized()) {
     this->cpu_core_list = std::move(
         const_cast<std::vector<int32_t>&>(source_cpu_pool.get_cpu_core_list()));
@@ -286,6 +314,10 @@ const std::vector<kmp_affinity_mask_t>& CPUPool::get_cpu_affinity_mask() const {
   return this->cpu_affinity_mask;
 }
 
+const std::vector<int32_t>& CPUPool::get_numa_node_ids() const {
+  return this->numa_node_ids;
+}
+
 bool CPUPool::is_cpu_core_list_initialized() const {
   return this->cpu_core_list_initialized_;
 }
@@ -9,6 +9,9 @@
 
 #include <torch/csrc/jit/api/module.h>
 
+#include "CPUTopology.h"
+#include "NumaAllocator.h"
+
 namespace torch_ipex {
 namespace runtime {
 
@@ -23,11 +26,20 @@ typedef int (*kmp_get_affinity_max_proc_p)();
 class TORCH_API CPUPool {
  public:
   explicit CPUPool(const std::vector<int32_t>& cpu_core_list);
-  explicit CPUPool(std::vector<kmp_affinity_mask_t>&& cpu_core_mask);
+  // The cores of cpu_core_list selected by filter_cores_by_topology
+  explicit CPUPool(
+      const std::vector<int32_t>& cpu_core_list,
+      CoreType core_type,
+      bool physical_cores_only,
+      int32_t llc_id = -1);
+  explicit CPUPool(
+      std::vector<kmp_affinity_mask_t>&& cpu_core_mask,
+      std::vector<int32_t> numa_node_ids = {});
   CPUPool(CPUPool&& source_cpu_pool);
 
   const std::vector<int32_t>& get_cpu_core_list() const;
   const std::vector<kmp_affinity_mask_t>& get_cpu_affinity_mask() const;
+  const std::vector<int32_t>& get_numa_node_ids() const;
   bool is_cpu_core_list_initialized() const;
   bool is_cpu_affinity_mask_initialized() const;
   ~CPUPool();
@@ -40,6 +52,9 @@ class TORCH_API CPUPool {
   bool cpu_core_list_initialized_{false};
   std::vector<kmp_affinity_mask_t> cpu_affinity_mask;
   bool cpu_affinity_mask_initialized_{false};
+  // The NUMA nodes of the cores of cpu_core_list, or the memory policy of the
+  // thread the cpu_affinity_mask comes from
+  std::vector<int32_t> numa_node_ids;
 
   // Put deleted function into private.
   CPUPool() = delete;
@@ -60,6 +75,8 @@ TORCH_API void init_runtime_ext();
 TORCH_API void _pin_cpu_cores(const torch_ipex::runtime::CPUPool& cpu_pool);
 TORCH_API bool is_same_core_affinity_setting(
     const std::vector<int32_t>& cpu_core_list);
+// The cores the calling thread is pinned to by _pin_cpu_cores, {-1} if none
+TORCH_API std::vector<int32_t> get_current_cpu_core_list();
 TORCH_API CPUPool get_cpu_pool_from_mask_affinity();
 TORCH_API void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool);
 
@@ -0,0 +1,118 @@
+#include "CPUTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+const std::string kSysCpuPath = "/sys/devices/system/cpu/cpu";
+// The cores of each type of an Intel hybrid CPU
+const std::string kPerformanceCoresPath = "/sys/devices/cpu_core/cpus";
+const std::string kEfficientCoresPath = "/sys/devices/cpu_atom/cpus";
+// The cache levels of a core are listed by cache/indexN
+const int kMaxCacheIndex = 8;
+
+int32_t get_llc_id(int32_t core_id) {
+  int32_t llc_id = -1;
+  int llc_level = 0;
+  for (int i = 0; i < kMaxCacheIndex; i++) {
+    std::string cache_path =
+        kSysCpuPath + std::to_string(core_id) + "/cache/index" +
+        std::to_string(i);
+    std::string level = read_sysfs_line(cache_path + "/level");
+    if (level.empty()) {
+      break;
+    }
+    if (std::stoi(level) >= llc_level) {
+      llc_level = std::stoi(level);
+      std::string id = read_sysfs_line(cache_path + "/id");
+      if (!id.empty()) {
+        llc_id = std::stoi(id);
+      } else {
+        // kernels without cache ids: the first core sharing the cache
+        std::vector<int32_t> shared_cpu_list =
+            parse_cpu_list(read_sysfs_line(cache_path + "/shared_cpu_list"));
+        llc_id = shared_cpu_list.empty() ? -1 : shared_cpu_list[0];
+      }
+    }
+  }
+  return llc_id;
+}
+} // namespace
+
+std::string read_sysfs_line(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+std::vector<int32_t> parse_cpu_list(const std::string& cpu_list) {
+  std::vector<int32_t> core_ids;
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int32_t first = std::stoi(range.substr(0, dash));
+    int32_t last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int32_t core_id = first; core_id <= last; core_id++) {
+      core_ids.emplace_back(core_id);
+    }
+  }
+  return core_ids;
+}
+
+std::vector<CoreTopology> get_cores_topology(
+    const std::vector<int32_t>& cpu_core_list) {
+  std::vector<int32_t> efficient_cores =
+      parse_cpu_list(read_sysfs_line(kEfficientCoresPath));
+  std::vector<CoreTopology> cores_topology;
+  for (int32_t core_id : cpu_core_list) {
+    CoreTopology core_topology;
+    core_topology.core_id = core_id;
+    std::vector<int32_t> thread_siblings = parse_cpu_list(read_sysfs_line(
+        kSysCpuPath + std::to_string(core_id) +
+        "/topology/thread_siblings_list"));
+    core_topology.physical_core_id =
+        thread_siblings.empty() ? core_id : thread_siblings[0];
+    core_topology.core_type =
+        std::find(efficient_cores.begin(), efficient_cores.end(), core_id) !=
+            efficient_cores.end()
+        ? CoreType::Efficient
+        : CoreType::Performance;
+    core_topology.llc_id = get_llc_id(core_id);
+    cores_topology.emplace_back(core_topology);
+  }
+  return cores_topology;
+}
+
+std::vector<int32_t> filter_cores_by_topology(
+    const std::vector<int32_t>& cpu_core_list,
+    CoreType core_type,
+    bool physical_cores_only,
+    int32_t llc_id) {
+  std::vector<int32_t> filter_cpu_core_list;
+  for (const auto& core_topology : get_cores_topology(cpu_core_list)) {
+    if ((core_type == CoreType::Any || core_topology.core_type == core_type) &&
+        (!physical_cores_only || core_topology.is_physical_core()) &&
+        (llc_id == -1 || core_topology.llc_id == llc_id)) {
+      filter_cpu_core_list.emplace_back(core_topology.core_id);
+    }
+  }
+  if (filter_cpu_core_list.size() == 0) {
+    throw std::runtime_error(
+        "Can't find core id of the core type, SMT and LLC selection in the core ids of CPUPool construction.");
+  }
+  return filter_cpu_core_list;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace runtime {
+
+// The performance cores of a hybrid CPU, and all the cores of the other CPUs,
+// are CoreType::Performance
+enum class CoreType { Any = 0, Performance = 1, Efficient = 2 };
+
+/*
+ The topology of a logical core read from sysfs. The physical core of a
+ logical core is the first of its SMT siblings, and its LLC domain is the id
+ of its last level cache, which tells the sub-NUMA clusters apart.
+*/
+struct TORCH_API CoreTopology {
+  int32_t core_id;
+  int32_t physical_core_id;
+  CoreType core_type;
+  int32_t llc_id;
+
+  bool is_physical_core() const {
+    return this->core_id == this->physical_core_id;
+  }
+};
+
+TORCH_API std::vector<CoreTopology> get_cores_topology(
+    const std::vector<int32_t>& cpu_core_list);
+
+// Keeps the cores of cpu_core_list of core_type, the first SMT thread of each
+// physical core only when physical_cores_only, and of the LLC domain llc_id
+// unless it is -1. Throws when no core is left, like
+// filter_cores_by_thread_affinity.
+TORCH_API std::vector<int32_t> filter_cores_by_topology(
+    const std::vector<int32_t>& cpu_core_list,
+    CoreType core_type,
+    bool physical_cores_only,
+    int32_t llc_id = -1);
+
+// Parses a sysfs cpu list, e.g. "0-3,8,10-11"
+std::vector<int32_t> parse_cpu_list(const std::string& cpu_list);
+// The first line of a sysfs file, empty when it doesn't exist
+std::string read_sysfs_line(const std::string& path);
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,130 @@
+#include "InferenceSession.h"
+
+#include <torch/csrc/autograd/grad_mode.h>
+#include <torch/script.h>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+
+torch::jit::Module prepare_for_inference(
+    torch::jit::Module module,
+    const InferenceOptions& options) {
+  // the frozen modules have no training attribute left
+  if (module.hasattr("training")) {
+    module.eval();
+    if (options.freeze) {
+      module = torch::jit::freeze(module);
+    }
+  }
+  return module;
+}
+
+} // namespace
+
+torch::jit::Module load_for_inference(
+    const std::string& path,
+    const InferenceOptions& options) {
+  return prepare_for_inference(torch::jit::load(path), options);
+}
+
+InferenceSession::InferenceSession(
+    const std::string& path,
+    const InferenceOptions& options)
+    : InferenceSession(torch::jit::load(path), options) {}
+
+InferenceSession::InferenceSession(
+    torch::jit::Module module,
+    const InferenceOptions& options)
+    : module_(prepare_for_inference(std::move(module), options)) {
+  init_streams(options);
+  warmup(options);
+}
+
+InferenceSession::~InferenceSession() = default;
+
+void InferenceSession::init_streams(const InferenceOptions& options) {
+  TORCH_CHECK(
+      options.num_streams >= 1,
+      "InferenceSession: num_streams must be >= 1, got ",
+      options.num_streams);
+  if (options.num_streams == 1 && !is_runtime_ext_enabled()) {
+    return;
+  }
+  TORCH_CHECK(
+      is_runtime_ext_enabled(),
+      "InferenceSession: the streams need the runtime extension, "
+      "preload IOMP before using them.");
+  std::vector<int32_t> cores = options.cpu_core_list.empty()
+      ? get_process_available_cores()
+      : options.cpu_core_list;
+  int64_t num_cores = cores.size();
+  TORCH_CHECK(
+      num_cores >= options.num_streams,
+      "InferenceSession: ",
+      options.num_streams,
+      " streams need as many cores at least, got ",
+      num_cores);
+  for (int64_t i = 0; i < options.num_streams; i++) {
+    int64_t begin = i * num_cores / options.num_streams;
+    int64_t end = (i + 1) * num_cores / options.num_streams;
+    this->cpu_pools.emplace_back(std::make_unique<CPUPool>(
+        std::vector<int32_t>(cores.begin() + begin, cores.begin() + end)));
+    this->streams.emplace_back(std::make_unique<ScriptModuleTask>(
+        this->module_, *this->cpu_pools.back()));
+  }
+}
+
+void InferenceSession::warmup(const InferenceOptions& options) {
+  torch::NoGradGuard no_grad;
+  for (auto& inputs : options.warmup_inputs) {
+    for (int64_t run = 0; run < options.warmup_runs; run++) {
+      if (this->streams.empty()) {
+        this->module_.forward(inputs);
+        continue;
+      }
+      // every stream, for the OpenMP threads of its cores to be created
+      std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+      for (auto& stream : this->streams) {
+        futures.push_back(stream->run_async(inputs));
+      }
+      for (auto& future : futures) {
+        future->waitAndThrow();
+      }
+    }
+  }
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> InferenceSession::submit(
+    std::vector<c10::IValue> inputs) {
+  torch::NoGradGuard no_grad;
+  if (this->streams.empty()) {
+    auto future = c10::make_intrusive<c10::ivalue::Future>(c10::AnyType::get());
+    try {
+      future->markCompleted(this->module_.forward(std::move(inputs)));
+    } catch (...) {
+      future->setError(std::current_exception());
+    }
+    return future;
+  }
+  size_t stream = this->next_stream.fetch_add(1) % this->streams.size();
+  return this->streams[stream]->run_async(std::move(inputs));
+}
+
+c10::IValue InferenceSession::run(std::vector<c10::IValue> inputs) {
+  auto future = this->submit(std::move(inputs));
+  future->waitAndThrow();
+  return future->value();
+}
+
+int64_t InferenceSession::num_streams() const {
+  return this->streams.empty() ? 1 : this->streams.size();
+}
+
+const torch::jit::Module& InferenceSession::module() const {
+  return this->module_;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
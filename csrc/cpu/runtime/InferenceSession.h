@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ATen/core/ivalue.h>
+#include <ATen/core/ivalue_inl.h>
+#include <torch/csrc/jit/api/module.h>
+#include "CPUPool.h"
+#include "ScriptModuleTask.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+struct TORCH_API InferenceOptions {
+  // Freeze the module, so that the IPEX fusion pass folds its weights into
+  // prepacked constants. A module already frozen is kept as is.
+  bool freeze = true;
+  // The example inputs of each shape to serve, run warmup_runs times on each
+  // stream before the first request: the profiling graph executor runs the
+  // IPEX fusion pass on the second run of forward
+  std::vector<std::vector<c10::IValue>> warmup_inputs;
+  int64_t warmup_runs = 2;
+  // The streams serving the requests, each on its own cores of cpu_core_list
+  // (the cores available to the process if empty), split evenly. A single
+  // stream without the runtime extension, i.e. IOMP not preloaded, runs the
+  // requests on the calling thread.
+  int64_t num_streams = 1;
+  std::vector<int32_t> cpu_core_list;
+};
+
+// Loads a TorchScript module saved by torch.jit.save or torch::jit::save for
+// inference: eval mode and frozen, unless options.freeze is false
+TORCH_API torch::jit::Module load_for_inference(
+    const std::string& path,
+    const InferenceOptions& options = InferenceOptions());
+
+/*
+ InferenceSession serves the forward of a TorchScript module without Python,
+ as ipex.optimize and torch.jit.freeze do from Python: the module is frozen,
+ optimized by the IPEX fusion pass on the warmup inputs and run by
+ options.num_streams ScriptModuleTasks on their own CPUPools. The requests are
+ run without gradients and spread over the streams round robin.
+
+   InferenceOptions options;
+   options.warmup_inputs = {{torch::rand({1, 3, 224, 224})}};
+   options.num_streams = 4;
+   InferenceSession session("resnet50.pt", options);
+   auto future = session.submit({torch::rand({1, 3, 224, 224})});
+   future->waitAndThrow();
+   at::Tensor output = future->value().toTensor();
+*/
+class TORCH_API InferenceSession {
+ public:
+  explicit InferenceSession(
+      const std::string& path,
+      const InferenceOptions& options = InferenceOptions());
+  explicit InferenceSession(
+      torch::jit::Module module,
+      const InferenceOptions& options = InferenceOptions());
+  InferenceSession(const InferenceSession& session) = delete;
+  InferenceSession& operator=(const InferenceSession& session) = delete;
+  // Runs the requests submitted before
+  ~InferenceSession();
+
+  c10::intrusive_ptr<c10::ivalue::Future> submit(
+      std::vector<c10::IValue> inputs);
+  c10::IValue run(std::vector<c10::IValue> inputs);
+
+  int64_t num_streams() const;
+  const torch::jit::Module& module() const;
+
+ private:
+  void init_streams(const InferenceOptions& options);
+  void warmup(const InferenceOptions& options);
+
+  torch::jit::Module module_;
+  // the CPUPools outlive the workers of their streams
+  std::vector<std::unique_ptr<CPUPool>> cpu_pools;
+  std::vector<std::unique_ptr<ScriptModuleTask>> streams;
+  std::atomic<size_t> next_stream{0};
+};
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,147 @@
+#include "NumaAllocator.h"
+
+#include <c10/core/CPUAllocator.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// The memory policy modes and flags of mbind, from linux/mempolicy.h, so that
+// the runtime doesn't depend on the headers of libnuma
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolInterleave = 3;
+constexpr unsigned kMpolMfMove = 1 << 1;
+
+constexpr size_t kBitsPerMaskWord = sizeof(unsigned long) * CHAR_BIT;
+
+struct ThreadNumaPolicy {
+  std::vector<int32_t> node_ids;
+  int mode = 0;
+  std::vector<unsigned long> node_mask;
+};
+
+thread_local ThreadNumaPolicy thread_numa_policy;
+
+std::once_flag numa_allocator_install_call_once_flag;
+
+// Find the nodeN entries of a sysfs directory
+std::vector<int32_t> get_node_entries_of_dir(const std::string& path) {
+  std::vector<int32_t> node_ids;
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return node_ids;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    const char* name = entry->d_name;
+    if (std::strncmp(name, "node", 4) == 0 && name[4] >= '0' &&
+        name[4] <= '9') {
+      node_ids.emplace_back(std::atoi(name + 4));
+    }
+  }
+  closedir(dir);
+  return node_ids;
+}
+
+void install_numa_allocator() {
+  // The NumaAllocator forwards to the CPU allocator set at this point
+  static NumaAllocator numa_allocator(c10::GetCPUAllocator());
+  c10::SetCPUAllocator(&numa_allocator, /* priority */ 1);
+}
+
+void bind_pages(void* ptr, size_t nbytes) {
+  // mbind works on whole pages: bind the pages inside the allocation only, the
+  // pages it shares with its neighbours keep their policy
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page_size - 1) &
+      ~(page_size - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + nbytes) &
+      ~(page_size - 1);
+  if (end <= begin) {
+    return;
+  }
+  // The pages reused from the free lists of the allocator are migrated by
+  // MPOL_MF_MOVE. The binding is an optimization only: errors, e.g. of a
+  // sandbox without mbind, leave the first-touch placement.
+  syscall(
+      SYS_mbind,
+      begin,
+      end - begin,
+      thread_numa_policy.mode,
+      thread_numa_policy.node_mask.data(),
+      thread_numa_policy.node_mask.size() * kBitsPerMaskWord + 1,
+      kMpolMfMove);
+}
+} // namespace
+
+std::vector<int32_t> get_numa_node_ids_of_cores(
+    const std::vector<int32_t>& cpu_core_list) {
+  std::vector<int32_t> node_ids;
+  for (int32_t core_id : cpu_core_list) {
+    // Each /sys/devices/system/cpu/cpuN has a link to its node
+    std::vector<int32_t> core_node_ids = get_node_entries_of_dir(
+        "/sys/devices/system/cpu/cpu" + std::to_string(core_id));
+    node_ids.insert(node_ids.end(), core_node_ids.begin(), core_node_ids.end());
+  }
+  std::sort(node_ids.begin(), node_ids.end());
+  node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
+  return node_ids;
+}
+
+int32_t get_num_numa_nodes() {
+  static const int32_t num_numa_nodes =
+      get_node_entries_of_dir("/sys/devices/system/node").size();
+  return num_numa_nodes;
+}
+
+void set_thread_numa_node_ids(const std::vector<int32_t>& node_ids) {
+  if (node_ids == thread_numa_policy.node_ids) {
+    return;
+  }
+  thread_numa_policy.node_ids = node_ids;
+  thread_numa_policy.node_mask.clear();
+  if (node_ids.empty()) {
+    return;
+  }
+  std::call_once(numa_allocator_install_call_once_flag, install_numa_allocator);
+  thread_numa_policy.mode =
+      node_ids.size() == 1 ? kMpolPreferred : kMpolInterleave;
+  thread_numa_policy.node_mask.resize(
+      *std::max_element(node_ids.begin(), node_ids.end()) / kBitsPerMaskWord +
+      1);
+  for (int32_t node_id : node_ids) {
+    thread_numa_policy.node_mask[node_id / kBitsPerMaskWord] |= 1UL
+        << (node_id % kBitsPerMaskWord);
+  }
+}
+
+const std::vector<int32_t>& get_thread_numa_node_ids() {
+  return thread_numa_policy.node_ids;
+}
+
+NumaAllocator::NumaAllocator(c10::Allocator* base_allocator)
+    : base_allocator(base_allocator) {}
+
+c10::DataPtr NumaAllocator::allocate(size_t nbytes) const {
+  c10::DataPtr data_ptr = this->base_allocator->allocate(nbytes);
+  if (nbytes >= kNumaBindMinBytes && !thread_numa_policy.node_mask.empty()) {
+    bind_pages(data_ptr.get(), nbytes);
+  }
+  return data_ptr;
+}
+
+c10::DeleterFnPtr NumaAllocator::raw_deleter() const {
+  return this->base_allocator->raw_deleter();
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace torch_ipex {
+namespace runtime {
+
+/*
+ The CPU allocations of a thread pinned to a CPUPool land on the NUMA nodes of
+ the pool rather than on the node of whichever thread touches them first. The
+ NumaAllocator wraps the CPU allocator of PyTorch, so the tensors of the IPEX
+ ops and the prepacked weights created while the pool is pinned follow the
+ memory policy of the pool.
+
+ The memory policy of a thread is the list of nodes set by
+ set_thread_numa_node_ids: an empty list keeps the first-touch placement, a
+ single node is preferred and several nodes are interleaved. The policy is
+ applied with mbind to the pages of the allocations of at least
+ kNumaBindMinBytes.
+*/
+constexpr size_t kNumaBindMinBytes = 1 << 20;
+
+// The NUMA node of each core of cpu_core_list, sorted and without duplicates.
+// Returns an empty list when the system doesn't expose its NUMA topology.
+TORCH_API std::vector<int32_t> get_numa_node_ids_of_cores(
+    const std::vector<int32_t>& cpu_core_list);
+TORCH_API int32_t get_num_numa_nodes();
+
+// Set the memory policy of the calling thread. The NumaAllocator is installed
+// as the CPU allocator the first time a thread sets a non-empty policy.
+TORCH_API void set_thread_numa_node_ids(const std::vector<int32_t>& node_ids);
+TORCH_API const std::vector<int32_t>& get_thread_numa_node_ids();
+
+class NumaAllocator final : public c10::Allocator {
+ public:
+  explicit NumaAllocator(c10::Allocator* base_allocator);
+
+  c10::DataPtr allocate(size_t nbytes) const override;
+  c10::DeleterFnPtr raw_deleter() const override;
+
+ private:
+  c10::Allocator* base_allocator;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,93 @@
+#include "ParallelContext.h"
+
+#include <omp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "CPUTopology.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// The caches assumed when sysfs doesn't list them
+const int64_t kDefaultL2Bytes = 1024 * 1024;
+const int64_t kDefaultLLCBytesPerCore = 1536 * 1024;
+const int kMaxCacheIndex = 8;
+
+struct CacheSizes {
+  int64_t l2_bytes = kDefaultL2Bytes;
+  int64_t llc_bytes_per_core = kDefaultLLCBytesPerCore;
+};
+
+// Parses a sysfs cache size, e.g. "2048K"
+int64_t parse_cache_size(const std::string& size) {
+  if (size.empty()) {
+    return 0;
+  }
+  int64_t bytes = std::stoll(size);
+  switch (size.back()) {
+    case 'K':
+      return bytes * 1024;
+    case 'M':
+      return bytes * 1024 * 1024;
+    default:
+      return bytes;
+  }
+}
+
+// The caches of the first core, the cores of a socket have the same ones
+CacheSizes read_cache_sizes() {
+  CacheSizes cache_sizes;
+  int llc_level = 0;
+  for (int i = 0; i < kMaxCacheIndex; i++) {
+    std::string cache_path =
+        "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i);
+    std::string level = read_sysfs_line(cache_path + "/level");
+    if (level.empty()) {
+      break;
+    }
+    if (read_sysfs_line(cache_path + "/type") == "Instruction") {
+      continue;
+    }
+    int64_t bytes = parse_cache_size(read_sysfs_line(cache_path + "/size"));
+    if (bytes <= 0) {
+      continue;
+    }
+    if (std::stoi(level) == 2) {
+      cache_sizes.l2_bytes = bytes;
+    }
+    if (std::stoi(level) > llc_level) {
+      llc_level = std::stoi(level);
+      int64_t num_sharing_cores = std::max<int64_t>(
+          parse_cpu_list(read_sysfs_line(cache_path + "/shared_cpu_list"))
+              .size(),
+          1);
+      cache_sizes.llc_bytes_per_core = bytes / num_sharing_cores;
+    }
+  }
+  return cache_sizes;
+}
+
+int64_t read_small_team_threads() {
+  const char* env = std::getenv("IPEX_SMALL_TEAM_THREADS");
+  return env == nullptr ? kSmallTeamThreads : std::atoll(env);
+}
+} // namespace
+
+ParallelContext get_parallel_context() {
+  static const CacheSizes cache_sizes = read_cache_sizes();
+  static const int64_t small_team_threads = read_small_team_threads();
+  ParallelContext parallel_context;
+  // _pin_cpu_cores sets the OMP team of the thread to the cores of its pool
+  parallel_context.num_threads = omp_in_parallel() ? 1 : omp_get_max_threads();
+  parallel_context.l2_bytes = cache_sizes.l2_bytes;
+  parallel_context.llc_bytes =
+      cache_sizes.llc_bytes_per_core * parallel_context.num_threads;
+  parallel_context.small_team_threads = small_team_threads;
+  return parallel_context;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
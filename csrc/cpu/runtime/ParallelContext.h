@@ -0,0 +1,38 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace runtime {
+
+// The teams up to kSmallTeamThreads threads, e.g. the streams of
+// MultiStreamModule, are partitioned for few threads by the kernels. The
+// environment variable IPEX_SMALL_TEAM_THREADS overrides it, 0 keeps the
+// partitioning of the full socket for all the teams.
+constexpr int64_t kSmallTeamThreads = 8;
+
+/*
+ The threads and the caches available to the kernels called by the current
+ thread. Pinned to a CPUPool, e.g. in a Task or a stream of
+ MultiStreamModule, the OMP team of the thread is the pool, and the kernels
+ size their partitioning and blocking for it rather than for the socket.
+*/
+struct TORCH_API ParallelContext {
+  int64_t num_threads;
+  // The L2 cache of a core
+  int64_t l2_bytes;
+  // The share of the last level cache of the cores of the team
+  int64_t llc_bytes;
+  int64_t small_team_threads;
+
+  bool is_small_team() const {
+    return this->num_threads <= this->small_team_threads;
+  }
+};
+
+TORCH_API ParallelContext get_parallel_context();
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,66 @@
+#include "ScriptModuleTask.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+ScriptModuleTask::ScriptModuleTask(
+    const torch::jit::Module& script_module,
+    const torch_ipex::runtime::CPUPool& cpu_pool)
+    : script_module_(script_module),
+      forward(&script_module_.get_method("forward").function()) {
+  this->task_executor = std::make_shared<TaskExecutor>(cpu_pool);
+}
+
+ScriptModuleTask::~ScriptModuleTask() {
+  this->task_executor->stop_executor();
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> ScriptModuleTask::run_async(
+    std::vector<c10::IValue> inputs,
+    const torch::jit::Kwargs& kwargs) {
+  // the same stack as torch::jit::Method, checked on the calling thread
+  inputs.insert(inputs.begin(), this->script_module_._ivalue());
+  this->forward->getSchema().checkAndNormalizeInputs(inputs, kwargs);
+  return this->run_stack_async(std::move(inputs));
+}
+
+c10::IValue ScriptModuleTask::run_sync(
+    std::vector<c10::IValue> inputs,
+    const torch::jit::Kwargs& kwargs) {
+  auto future = this->run_async(std::move(inputs), kwargs);
+  future->waitAndThrow();
+  return future->value();
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> ScriptModuleTask::run_stack_async(
+    std::vector<c10::IValue> stack) {
+  const auto& returns = this->forward->getSchema().returns();
+  auto future = c10::make_intrusive<c10::ivalue::Future>(
+      returns.size() == 1 ? returns[0].type() : c10::AnyType::get());
+  auto grad_mode = at::GradMode::is_enabled();
+  this->task_executor->submit(
+      [forward = this->forward,
+       future,
+       stack = std::move(stack),
+       grad_mode]() mutable {
+        // set the thread local status, such as the grad mode before
+        // execuating the status
+        at::GradMode::set_enabled(grad_mode);
+        c10::IValue output;
+        try {
+          output = (*forward)(std::move(stack));
+        } catch (...) {
+          future->setError(std::current_exception());
+          return;
+        }
+        future->markCompleted(std::move(output));
+      });
+  return future;
+}
+
+std::shared_ptr<TaskExecutor> ScriptModuleTask::get_task_executor() const {
+  return this->task_executor;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <ATen/core/ivalue.h>
+#include <ATen/core/ivalue_inl.h>
+#include <torch/csrc/jit/api/module.h>
+#include "TaskExecutor.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+/*
+ ScriptModuleTask runs the forward of a TorchScript module asynchronously on
+ the TaskExecutor of a CPUPool, for C++ callers without Python. run_async
+ checks the inputs against the schema of forward on the calling thread and
+ returns a c10::ivalue::Future, completed with the output or the exception of
+ the call. The callbacks added to the future run on the worker thread of the
+ TaskExecutor, right after the call, unless the future is already completed.
+*/
+class TORCH_API ScriptModuleTask {
+ public:
+  explicit ScriptModuleTask(
+      const torch::jit::Module& script_module,
+      const torch_ipex::runtime::CPUPool& cpu_pool);
+  ScriptModuleTask(const ScriptModuleTask& task) = delete;
+  ScriptModuleTask(ScriptModuleTask&& task) = delete;
+  ScriptModuleTask& operator=(const ScriptModuleTask& task) = delete;
+  ScriptModuleTask& operator=(ScriptModuleTask&& task) = delete;
+  // Runs the calls submitted before
+  ~ScriptModuleTask();
+
+  c10::intrusive_ptr<c10::ivalue::Future> run_async(
+      std::vector<c10::IValue> inputs,
+      const torch::jit::Kwargs& kwargs = torch::jit::Kwargs());
+  c10::IValue run_sync(
+      std::vector<c10::IValue> inputs,
+      const torch::jit::Kwargs& kwargs = torch::jit::Kwargs());
+  // Runs a stack of forward already checked against its schema, including the
+  // module as its first element
+  c10::intrusive_ptr<c10::ivalue::Future> run_stack_async(
+      std::vector<c10::IValue> stack);
+
+  std::shared_ptr<TaskExecutor> get_task_executor() const;
+
+ private:
+  torch::jit::Module script_module_;
+  torch::jit::Function* forward;
+  std::shared_ptr<TaskExecutor> task_executor;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
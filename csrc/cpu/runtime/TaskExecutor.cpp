@@ -1,9 +1,23 @@
 #include "TaskExecutor.h"
 
+#include <immintrin.h>
+
 namespace torch_ipex {
 namespace runtime {
 
-TaskExecutor::TaskExecutor(const torch_ipex::runtime::CPUPool& cpu_pool) {
+namespace {
+
+// The bounds of the spins of the worker on an empty queue before it parks, in
+// polls of the queue
+const int64_t kMinSpins = 64;
+const int64_t kMaxSpins = 16384;
+
+} // namespace
+
+TaskExecutor::TaskExecutor(
+    const torch_ipex::runtime::CPUPool& cpu_pool,
+    size_t queue_capacity)
+    : tasks(queue_capacity) {
   // Notice: We shouldn't load iomp symbol in sub_thread, otherwise race
   // condition happens.
   if (!is_runtime_ext_enabled()) {
@@ -11,57 +25,109 @@ TaskExecutor::TaskExecutor(const torch_ipex::runtime::CPUPool& cpu_pool) {
         "Fail to init TaskExecutor. Didn't preload IOMP "
         "before using the runtime API.");
   }
-  this->stop = false;
+  if (cpu_pool.is_cpu_core_list_initialized()) {
+    this->cpu_core_list = cpu_pool.get_cpu_core_list();
+  }
 
   this->worker = std::make_shared<std::thread>([&, this] {
     _pin_cpu_cores(cpu_pool);
-    while (true) {
-      std::function<void()> task;
-      {
-        std::unique_lock<std::mutex> lock(this->worker_mutex);
-        this->worker_condition.wait(
-            lock, [this] { return this->stop || !this->tasks.empty(); });
-
-        if (this->stop && this->tasks.empty())
-          return;
-
-        task = std::move(this->tasks.front());
-        this->tasks.pop();
+    this->run_worker();
+  });
+}
+
+void TaskExecutor::run_worker() {
+  int64_t spins = kMinSpins;
+  while (true) {
+    if (this->tasks.pop()) {
+      this->num_pending_tasks.fetch_sub(1);
+      continue;
+    }
+    // spin on the empty queue, longer after the spins which found a task
+    bool found = false;
+    for (int64_t i = 0; i < spins; i++) {
+      if (!this->tasks.empty()) {
+        found = true;
+        break;
       }
-      task();
+      _mm_pause();
     }
-  });
+    if (found) {
+      spins = std::min(spins * 2, kMaxSpins);
+      continue;
+    }
+    spins = std::max(spins / 2, kMinSpins);
+
+    std::unique_lock<std::mutex> lock(this->worker_mutex);
+    this->parked.store(true);
+    // a submit after the store sees parked, the ones before are seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto has_work = [this] {
+      // a submit counted out has published its task
+      bool drained = this->stop.load() && this->submitting.load() == 0;
+      return drained || !this->tasks.empty();
+    };
+    this->worker_condition.wait(lock, has_work);
+    this->parked.store(false);
+    if (this->tasks.empty()) {
+      // stopped and drained: no submit is in progress and the later ones
+      // throw
+      return;
+    }
+  }
 }
 
-std::mutex& TaskExecutor::get_mutex() {
-  return this->worker_mutex;
+void TaskExecutor::wake_worker() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->parked.load()) {
+    // the worker checks its condition under the lock, taking it here makes
+    // sure it is waiting or will see the task
+    { std::lock_guard<std::mutex> lock(this->worker_mutex); }
+    this->worker_condition.notify_one();
+  }
 }
 
-std::condition_variable& TaskExecutor::get_condition() {
-  return this->worker_condition;
+std::future<void> TaskExecutor::resize(
+    const torch_ipex::runtime::CPUPool& cpu_pool) {
+  auto cpu_core_list =
+      std::make_shared<std::vector<int32_t>>(cpu_pool.get_cpu_core_list());
+  auto resized = std::make_shared<std::promise<void>>();
+  std::future<void> future = resized->get_future();
+  {
+    std::lock_guard<std::mutex> lock(this->cpu_core_list_mutex);
+    this->cpu_core_list = *cpu_core_list;
+  }
+  // The tasks run in order, the ones submitted after run on the new cores
+  this->submit([cpu_core_list, resized]() {
+    try {
+      _pin_cpu_cores(CPUPool(*cpu_core_list));
+      resized->set_value();
+    } catch (...) {
+      resized->set_exception(std::current_exception());
+    }
+  });
+  return future;
 }
 
-bool TaskExecutor::is_stop() {
-  return this->stop;
+std::vector<int32_t> TaskExecutor::get_cpu_core_list() {
+  std::lock_guard<std::mutex> lock(this->cpu_core_list_mutex);
+  return this->cpu_core_list;
 }
 
-std::queue<std::function<void()>>& TaskExecutor::get_tasks() {
-  return this->tasks;
+int64_t TaskExecutor::get_num_pending_tasks() const {
+  return this->num_pending_tasks.load();
+}
+
+bool TaskExecutor::is_stop() {
+  return this->stop.load();
 }
 
 void TaskExecutor::stop_executor() {
-  bool should_wait_worker_join = false;
-  {
-    std::unique_lock<std::mutex> lock(this->worker_mutex);
-    if (this->stop == false) {
-      should_wait_worker_join = true;
-      this->stop = true;
-    }
-  }
-  if (should_wait_worker_join) {
-    this->worker_condition.notify_all();
-    this->worker->join();
+  if (this->stop.exchange(true)) {
+    return;
   }
+  { std::lock_guard<std::mutex> lock(this->worker_mutex); }
+  this->worker_condition.notify_one();
+  this->worker->join();
   return;
 }
 
@@ -2,6 +2,7 @@
 
 #include <dlfcn.h>
 #include <omp.h>
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
 #include <functional>
@@ -9,7 +10,6 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
 #include <thread>
 #include <vector>
@@ -18,29 +18,63 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/jit/api/module.h>
 #include "CPUPool.h"
+#include "TaskQueue.h"
 
 namespace torch_ipex {
 namespace runtime {
 
+/*
+ TaskExecutor runs the submitted tasks in order on one worker thread pinned to
+ its CPUPool. The tasks go through a lock-free TaskQueue: the submitting
+ threads do not take a lock and the tasks are not heap allocated. The worker
+ spins for a while when the queue is empty before parking on a condition
+ variable, and it spins longer after the spins which found a task, so a
+ stream of requests does not pay for the wake-ups.
+*/
 class TORCH_API TaskExecutor {
  public:
-  explicit TaskExecutor(const torch_ipex::runtime::CPUPool& cpu_pool);
-  std::mutex& get_mutex();
-  std::condition_variable& get_condition();
+  explicit TaskExecutor(
+      const torch_ipex::runtime::CPUPool& cpu_pool,
+      size_t queue_capacity = kDefaultQueueCapacity);
+  // Submits the task f, a callable of at most TaskQueue::kTaskStorageSize
+  // bytes. It waits for a free slot when the queue is full, and throws when
+  // the executor is stopped.
+  template <class F>
+  void submit(F&& f);
+  // Re-pins the worker, and so the OMP team size of the tasks, to the cores
+  // of cpu_pool at the boundary after the tasks submitted before. The future
+  // is ready once the worker runs on the new cores.
+  std::future<void> resize(const torch_ipex::runtime::CPUPool& cpu_pool);
+  // The cores of the last resize, or of the construction
+  std::vector<int32_t> get_cpu_core_list();
+  // The tasks submitted and not finished yet
+  int64_t get_num_pending_tasks() const;
   bool is_stop();
-  std::queue<std::function<void()>>& get_tasks();
   void stop_executor();
   ~TaskExecutor();
 
+  static constexpr size_t kDefaultQueueCapacity = 1024;
+
  private:
-  std::queue<std::function<void()>> tasks;
+  void run_worker();
+  void wake_worker();
+
+  TaskQueue tasks;
   std::shared_ptr<std::thread> worker;
 
   // Synchronization
-  bool stop;
+  std::atomic<bool> stop{false};
+  // the submits in progress, which the worker drains before it exits
+  std::atomic<int64_t> submitting{0};
+  // whether the worker is parked or about to be
+  std::atomic<bool> parked{false};
   std::mutex worker_mutex;
   std::condition_variable worker_condition;
 
+  std::atomic<int64_t> num_pending_tasks{0};
+  std::mutex cpu_core_list_mutex;
+  std::vector<int32_t> cpu_core_list;
+
   // Put the deleted function in the private.
   TaskExecutor(const TaskExecutor& task_executor) =
       delete; // Not support copy or move construtor.
@@ -52,5 +86,23 @@ class TORCH_API TaskExecutor {
       delete; // Not support copy or move construtor.
 };
 
+template <class F>
+void TaskExecutor::submit(F&& f) {
+  // stop is read after the submit is counted, so the worker either sees the
+  // submit in progress or this thread sees stop
+  this->submitting.fetch_add(1);
+  if (this->stop.load()) {
+    this->submitting.fetch_sub(1);
+    // submit task to a stopping the pool is not allowed
+    throw std::runtime_error("Task submit on stopped TaskExecutor");
+  }
+  this->num_pending_tasks.fetch_add(1);
+  while (!this->tasks.try_push(std::forward<F>(f))) {
+    std::this_thread::yield();
+  }
+  this->submitting.fetch_sub(1);
+  this->wake_worker();
+}
+
 } // namespace runtime
 } // namespace torch_ipex
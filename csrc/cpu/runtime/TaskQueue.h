@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace torch_ipex {
+namespace runtime {
+
+// refer to
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+/*
+ TaskQueue is a bounded lock-free multi-producer single-consumer ring of
+ preallocated task slots. A producer claims a slot with a CAS on the enqueue
+ position and constructs its callable in place in the slot storage, so a push
+ does not allocate. The slot sequence publishes the slot to the consumer,
+ which runs and destroys the callable in place before releasing the slot to
+ the producers of the next lap.
+*/
+class TaskQueue {
+ public:
+  // The callables are stored inline, e.g. the lambdas of Task and TaskModule
+  // holding a shared_ptr to their packaged_task and the grad mode
+  static constexpr size_t kTaskStorageSize = 64;
+
+  explicit TaskQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    this->mask = size - 1;
+    this->slots.reset(new TaskSlot[size]);
+    for (size_t i = 0; i < size; i++) {
+      this->slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  TaskQueue(const TaskQueue& task_queue) = delete;
+  TaskQueue& operator=(const TaskQueue& task_queue) = delete;
+
+  ~TaskQueue() {
+    // the tasks left in the queue are destroyed without running
+    while (this->pop(false)) {
+    }
+  }
+
+  size_t capacity() const {
+    return this->mask + 1;
+  }
+
+  // Returns false when the queue is full
+  template <class F>
+  bool try_push(F&& f) {
+    using Fn = typename std::decay<F>::type;
+    static_assert(
+        sizeof(Fn) <= kTaskStorageSize &&
+            alignof(Fn) <= alignof(std::max_align_t),
+        "the task does not fit in a TaskQueue slot");
+    TaskSlot* slot;
+    size_t pos = this->enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      slot = &this->slots[pos & this->mask];
+      size_t seq = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (this->enqueue_pos.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // the consumer has not released the slot of the previous lap
+        return false;
+      } else {
+        pos = this->enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    new (slot->storage) Fn(std::forward<F>(f));
+    slot->consume = &consume_task<Fn>;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Runs (when run is true) and destroys the task at the head of the queue,
+  // returns false when the queue is empty. Only the consumer calls it.
+  bool pop(bool run = true) {
+    TaskSlot* slot = &this->slots[this->dequeue_pos & this->mask];
+    if (slot->sequence.load(std::memory_order_acquire) !=
+        this->dequeue_pos + 1) {
+      return false;
+    }
+    // the slot is released even if the task throws
+    struct SlotRelease {
+      TaskQueue* queue;
+      TaskSlot* slot;
+      ~SlotRelease() {
+        slot->sequence.store(
+            queue->dequeue_pos + queue->mask + 1, std::memory_order_release);
+        queue->dequeue_pos++;
+      }
+    } release{this, slot};
+    slot->consume(slot->storage, run);
+    return true;
+  }
+
+  // Whether a task is published at the head of the queue, for the consumer
+  bool empty() const {
+    const TaskSlot* slot = &this->slots[this->dequeue_pos & this->mask];
+    return slot->sequence.load(std::memory_order_acquire) !=
+        this->dequeue_pos + 1;
+  }
+
+ private:
+  struct TaskSlot {
+    std::atomic<size_t> sequence;
+    void (*consume)(void*, bool);
+    alignas(std::max_align_t) unsigned char storage[kTaskStorageSize];
+  };
+
+  template <class Fn>
+  static void consume_task(void* storage, bool run) {
+    struct Destroy {
+      Fn* fn;
+      ~Destroy() {
+        fn->~Fn();
+      }
+    } destroy{static_cast<Fn*>(storage)};
+    if (run) {
+      (*destroy.fn)();
+    }
+  }
+
+  std::unique_ptr<TaskSlot[]> slots;
+  size_t mask;
+  // the producers and the consumer positions on their own cache lines
+  alignas(64) std::atomic<size_t> enqueue_pos{0};
+  alignas(64) size_t dequeue_pos{0};
+};
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -1,5 +1,7 @@
 #include "sklearn.h"
 #include <ATen/Dispatch.h>
+#include <c10/util/Exception.h>
+#include <omp.h>
 #include <parallel/algorithm>
 
 namespace toolkit {
@@ -12,19 +14,19 @@ template <typename T>
 std::vector<double> roc_auc_score_(
     at::Tensor self,
     at::Tensor other,
-    int size,
+    int64_t size,
     bool only_score = true) {
   T* actual = self.data_ptr<T>();
   T* prediction = other.data_ptr<T>();
   std::vector<T> predictedRank(size, 0.0);
-  int nPos = 0, nNeg = 0;
+  int64_t nPos = 0, nNeg = 0;
 #pragma omp parallel for reduction(+ : nPos)
-  for (int i = 0; i < size; i++)
-    nPos += (int)actual[i];
+  for (int64_t i = 0; i < size; i++)
+    nPos += (int64_t)actual[i];
 
   nNeg = size - nPos;
 
-  std::vector<std::pair<T, int>> v_sort(size);
+  std::vector<std::pair<T, int64_t>> v_sort(size);
 #pragma omp parallel for
   for (size_t i = 0; i < size; ++i) {
     v_sort[i] = std::make_pair(prediction[i], i);
@@ -35,8 +37,8 @@ std::vector<double> roc_auc_score_(
         return left.first < right.first;
       });
 
-  int r = 1;
-  int n = 1;
+  int64_t r = 1;
+  int64_t n = 1;
   size_t i = 0;
   while (i < size) {
     size_t j = i;
@@ -46,7 +48,7 @@ std::vector<double> roc_auc_score_(
     }
     n = j - i + 1;
     for (size_t j = 0; j < n; ++j) {
-      int idx = v_sort[i + j].second;
+      int64_t idx = v_sort[i + j].second;
       predictedRank[idx] = r + ((n - 1) * 0.5);
     }
     r += n;
@@ -68,7 +70,7 @@ std::vector<double> roc_auc_score_(
     double acc = 0.0;
     double loss = 0.0;
 #pragma omp parallel for reduction(+ : acc, loss)
-    for (int i = 0; i < size; i++) {
+    for (int64_t i = 0; i < size; i++) {
       auto rpred = std::roundf(prediction[i]);
       if (actual[i] == rpred)
         acc += 1;
@@ -105,4 +107,169 @@ std::vector<double> roc_auc_score_all(at::Tensor self, at::Tensor other) {
       });
 }
 
+RocAucAccumulator::RocAucAccumulator(int64_t num_bins) : num_bins_(num_bins) {
+  TORCH_CHECK(num_bins >= 0, "RocAucAccumulator: num_bins should be >= 0");
+  reset();
+}
+
+void RocAucAccumulator::reset() {
+  pos_hist_.assign(num_bins_, 0);
+  neg_hist_.assign(num_bins_, 0);
+  runs_.clear();
+  count_ = 0;
+  correct_ = 0;
+  loss_ = 0;
+}
+
+template <typename T>
+void RocAucAccumulator::update_(
+    const T* actual,
+    const T* prediction,
+    int64_t size) {
+  double acc = 0.0;
+  double loss = 0.0;
+#pragma omp parallel for reduction(+ : acc, loss)
+  for (int64_t i = 0; i < size; i++) {
+    auto rpred = std::roundf(prediction[i]);
+    if (actual[i] == rpred)
+      acc += 1;
+    loss += (actual[i] * std::log(prediction[i])) +
+        ((1 - actual[i]) * std::log(1 - prediction[i]));
+  }
+  count_ += size;
+  correct_ += acc;
+  loss_ += loss;
+
+  if (num_bins_ > 0) {
+    int nthreads = omp_get_max_threads();
+    std::vector<int64_t> hist(2 * num_bins_ * nthreads, 0);
+#pragma omp parallel
+    {
+      int64_t* local_pos = &hist[2 * num_bins_ * omp_get_thread_num()];
+      int64_t* local_neg = local_pos + num_bins_;
+#pragma omp for schedule(static)
+      for (int64_t i = 0; i < size; i++) {
+        int64_t bin = (int64_t)(prediction[i] * num_bins_);
+        bin = std::min(std::max<int64_t>(bin, 0), num_bins_ - 1);
+        if (actual[i] == 1) {
+          local_pos[bin]++;
+        } else {
+          local_neg[bin]++;
+        }
+      }
+    }
+#pragma omp parallel for
+    for (int64_t bin = 0; bin < num_bins_; bin++) {
+      for (int t = 0; t < nthreads; t++) {
+        pos_hist_[bin] += hist[2 * num_bins_ * t + bin];
+        neg_hist_[bin] += hist[2 * num_bins_ * t + num_bins_ + bin];
+      }
+    }
+    return;
+  }
+
+  std::vector<std::pair<T, bool>> v_sort(size);
+#pragma omp parallel for
+  for (int64_t i = 0; i < size; ++i) {
+    v_sort[i] = std::make_pair(prediction[i], actual[i] == 1);
+  }
+  __gnu_parallel::sort(
+      v_sort.begin(), v_sort.end(), [](auto& left, auto& right) {
+        return left.first < right.first;
+      });
+  std::vector<Group> run;
+  for (int64_t i = 0; i < size; i++) {
+    if (run.empty() || run.back().value != v_sort[i].first) {
+      run.push_back({(double)v_sort[i].first, 0, 0});
+    }
+    if (v_sort[i].second) {
+      run.back().pos++;
+    } else {
+      run.back().neg++;
+    }
+  }
+  v_sort.clear();
+  v_sort.shrink_to_fit();
+  runs_.emplace_back(std::move(run));
+  // bound the number of pending runs so duplicated predictions across chunks
+  // are folded together early
+  merge_runs(2 * omp_get_max_threads());
+}
+
+static std::vector<RocAucAccumulator::Group> merge_two_runs(
+    const std::vector<RocAucAccumulator::Group>& a,
+    const std::vector<RocAucAccumulator::Group>& b) {
+  std::vector<RocAucAccumulator::Group> out;
+  out.reserve(a.size() + b.size());
+  size_t i = 0, j = 0;
+  while (i < a.size() || j < b.size()) {
+    if (j == b.size() || (i < a.size() && a[i].value < b[j].value)) {
+      out.push_back(a[i++]);
+    } else if (i == a.size() || b[j].value < a[i].value) {
+      out.push_back(b[j++]);
+    } else {
+      out.push_back({a[i].value, a[i].pos + b[j].pos, a[i].neg + b[j].neg});
+      i++;
+      j++;
+    }
+  }
+  return out;
+}
+
+void RocAucAccumulator::merge_runs(size_t max_runs) {
+  // merge neighbouring runs pairwise, the pairs of one round in parallel
+  while (runs_.size() > max_runs && runs_.size() > 1) {
+    size_t n_pairs = runs_.size() / 2;
+    std::vector<std::vector<Group>> merged((runs_.size() + 1) / 2);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t p = 0; p < n_pairs; p++) {
+      merged[p] = merge_two_runs(runs_[2 * p], runs_[2 * p + 1]);
+    }
+    if (runs_.size() % 2 == 1) {
+      merged.back() = std::move(runs_.back());
+    }
+    runs_ = std::move(merged);
+  }
+}
+
+void RocAucAccumulator::update(at::Tensor actual, at::Tensor predict) {
+  TORCH_CHECK(actual.dim() == 1 && predict.dim() == 1);
+  TORCH_CHECK(actual.scalar_type() == predict.scalar_type());
+  TORCH_CHECK(actual.numel() == predict.numel());
+  auto actual_ = actual.contiguous();
+  auto predict_ = predict.contiguous();
+  AT_DISPATCH_FLOATING_TYPES(
+      actual_.scalar_type(), "RocAucAccumulator::update", [&]() {
+        update_<scalar_t>(
+            actual_.data_ptr<scalar_t>(),
+            predict_.data_ptr<scalar_t>(),
+            actual_.numel());
+      });
+}
+
+std::vector<double> RocAucAccumulator::compute() {
+  // walk the groups in ascending prediction order, a positive ranks above
+  // all negatives of lower groups and half of the negatives of its own group
+  double nPos = 0, nNeg = 0, pairs = 0;
+  auto accumulate = [&](double pos, double neg) {
+    pairs += pos * (nNeg + 0.5 * neg);
+    nPos += pos;
+    nNeg += neg;
+  };
+  if (num_bins_ > 0) {
+    for (int64_t bin = 0; bin < num_bins_; bin++) {
+      accumulate(pos_hist_[bin], neg_hist_[bin]);
+    }
+  } else {
+    merge_runs(1);
+    if (!runs_.empty()) {
+      for (auto& group : runs_[0]) {
+        accumulate(group.pos, group.neg);
+      }
+    }
+  }
+  double score = pairs / (nPos * nNeg);
+  return {score, -loss_ / count_, correct_ / count_};
+}
+
 } // namespace toolkit
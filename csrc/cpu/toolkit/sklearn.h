@@ -5,4 +5,43 @@
 namespace toolkit {
 std::vector<double> roc_auc_score(at::Tensor actual, at::Tensor predict);
 std::vector<double> roc_auc_score_all(at::Tensor actual, at::Tensor predict);
+
+// Streaming version of roc_auc_score_all for eval sets that do not fit in
+// memory: predictions are fed chunk by chunk with update() and compute()
+// returns {auc, log_loss, accuracy} over everything seen so far.
+//
+// num_bins > 0: predictions (expected in [0, 1]) are counted into num_bins
+//   equal-width bins with per-thread histograms, memory is O(num_bins) and
+//   predictions of the same bin are treated as ties.
+// num_bins == 0: exact mode, every chunk is sorted in parallel and
+//   compressed into (prediction, #pos, #neg) runs which are merged, memory
+//   is O(#distinct predictions).
+class RocAucAccumulator {
+ public:
+  struct Group {
+    double value;
+    int64_t pos;
+    int64_t neg;
+  };
+
+  explicit RocAucAccumulator(int64_t num_bins = 0);
+
+  void update(at::Tensor actual, at::Tensor predict);
+  std::vector<double> compute();
+  void reset();
+
+ private:
+  template <typename T>
+  void update_(const T* actual, const T* prediction, int64_t size);
+  void merge_runs(size_t max_runs);
+
+  int64_t num_bins_;
+  std::vector<int64_t> pos_hist_;
+  std::vector<int64_t> neg_hist_;
+  // sorted runs of unique predictions, exact mode only
+  std::vector<std::vector<Group>> runs_;
+  int64_t count_ = 0;
+  double correct_ = 0;
+  double loss_ = 0;
+};
 } // namespace toolkit
@@ -5,10 +5,12 @@
 
 #include <dyndisp/DispatchStub.h>
 #include <torch/all.h>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include "ext_tpp.h"
 //#include "init.h"
+#include "sparse_update.h"
 #include "tensor_helper.h"
 #include "threaded_loops.h"
 #include "timing.h"
@@ -47,33 +49,13 @@ REGISTER_LOCAL_SCOPE(dqkv_bias, "dqkv_bias");
 REGISTER_LOCAL_SCOPE(di_bias, "di_bias");
 REGISTER_LOCAL_SCOPE(do_bias, "do_bias");
 
-template <typename T>
-inline void omp_reduce_buf(
-    int num_threads,
-    int N,
-    float** ptrs,
-    T* buf,
-    bool accumulate = false) {
-  ScopedTimer _t(EW_RED);
-#pragma omp for
-  for (int i = 0; i < N; i++) {
-    float sum = 0.0;
-    for (int j = 0; j < num_threads; j++) {
-      sum += ptrs[j][i];
-    }
-    if (accumulate) {
-      buf[i] += sum;
-    } else {
-      buf[i] = sum;
-    }
-  }
-}
-
 static std::vector<at::Tensor> fused_self_attention_fwd_unpad(
     double p,
     std::vector<at::Tensor> inputs,
     bool training) {
   GlobalPass _gp(FWD);
+  // the encoder attention is not causal
+  const bool causal = false;
   if (inputs[6].dtype() == at::kFloat) {
     typedef float T;
 #include "fused_self_attention_fwd_tmpl.h"
@@ -100,13 +82,26 @@ static std::vector<at::Tensor> fused_dense_dropout_layernorm_fwd_unpad(
     double p,
     double eps,
     std::vector<at::Tensor> inputs,
-    bool training) {
+    bool training,
+    double wt_scale) {
   GlobalPass _gp(FWD);
+  // fp8 weights (TW) are dequantized with wt_scale, with bf16 activations only
+  auto wt_dtype = inputs[2].dtype();
   if (inputs[0].dtype() == at::kFloat) {
     typedef float T;
+    typedef float TW;
+#include "fused_dense_dropout_layernorm_fwd_tmpl.h"
+  } else if (wt_dtype == at::kFloat8_e4m3fn) {
+    typedef bfloat16 T;
+    typedef hfloat8 TW;
+#include "fused_dense_dropout_layernorm_fwd_tmpl.h"
+  } else if (wt_dtype == at::kFloat8_e5m2) {
+    typedef bfloat16 T;
+    typedef bfloat8 TW;
 #include "fused_dense_dropout_layernorm_fwd_tmpl.h"
   } else {
     typedef bfloat16 T;
+    typedef bfloat16 TW;
 #include "fused_dense_dropout_layernorm_fwd_tmpl.h"
   }
 }
@@ -128,13 +123,25 @@ static std::vector<at::Tensor> fused_dense_gelu_fwd_unpad(
     at::Tensor t_in,
     at::Tensor t_wt,
     at::Tensor t_bias,
-    bool training) {
+    bool training,
+    double wt_scale) {
   GlobalPass _gp(FWD);
+  // fp8 weights (TW) are dequantized with wt_scale, with bf16 activations only
   if (t_in.dtype() == at::kFloat) {
     typedef float T;
+    typedef float TW;
+#include "fused_dense_gelu_fwd_tmpl.h"
+  } else if (t_wt.dtype() == at::kFloat8_e4m3fn) {
+    typedef bfloat16 T;
+    typedef hfloat8 TW;
+#include "fused_dense_gelu_fwd_tmpl.h"
+  } else if (t_wt.dtype() == at::kFloat8_e5m2) {
+    typedef bfloat16 T;
+    typedef bfloat8 TW;
 #include "fused_dense_gelu_fwd_tmpl.h"
   } else {
     typedef bfloat16 T;
+    typedef bfloat16 TW;
 #include "fused_dense_gelu_fwd_tmpl.h"
   }
 }
@@ -187,6 +194,52 @@ static std::vector<at::Tensor> fused_embedding_layernorm_dropout_fwd_unpad(
   }
 }
 
+// The inference forward: no dropout and no saved statistics, the output in
+// bf16 when bf16_out, else in the dtype of gamma. The position and token type
+// embeddings may be empty, for the encoders without them.
+static at::Tensor fused_embedding_layernorm_fwd_infer(
+    double eps,
+    long H,
+    long pad_id,
+    std::vector<at::Tensor> inputs,
+    bool bf16_out) {
+  GlobalPass _gp(FWD);
+  bool fp32 = inputs[4].dtype() == at::kFloat;
+  bool emb_fp32 = inputs[6].dtype() == at::kFloat;
+  auto out_dtype = bf16_out ? at::kBFloat16 : inputs[4].scalar_type();
+  if (fp32 && emb_fp32 && !bf16_out) {
+    typedef float T;
+    typedef float ET;
+    typedef float TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  } else if (fp32 && emb_fp32 && bf16_out) {
+    typedef float T;
+    typedef float ET;
+    typedef bfloat16 TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  } else if (fp32 && !emb_fp32 && !bf16_out) {
+    typedef float T;
+    typedef bfloat16 ET;
+    typedef float TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  } else if (fp32 && !emb_fp32 && bf16_out) {
+    typedef float T;
+    typedef bfloat16 ET;
+    typedef bfloat16 TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  } else if (!fp32 && emb_fp32) {
+    typedef bfloat16 T;
+    typedef float ET;
+    typedef bfloat16 TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+    typedef bfloat16 ET;
+    typedef bfloat16 TO;
+#include "fused_embedding_layernorm_fwd_infer_tmpl.h"
+  }
+}
+
 static std::vector<at::Tensor> fused_embedding_layernorm_dropout_bwd_unpad(
     double p,
     long pad_id,
@@ -234,7 +287,7 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
 
   m.def(
       torch::schema(
-          "torch_ipex::fused_dense_dropout_layernorm_fwd_unpad(float p, float eps, Tensor[] inputs, bool training) -> Tensor[]",
+          "torch_ipex::fused_dense_dropout_layernorm_fwd_unpad(float p, float eps, Tensor[] inputs, bool training, float wt_scale=1.0) -> Tensor[]",
           c10::AliasAnalysisKind::PURE_FUNCTION),
       torch_ipex::tpp::fused_dense_dropout_layernorm_fwd_unpad);
 
@@ -247,7 +300,7 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       torch::schema(
           "torch_ipex::fused_dense_gelu_fwd_unpad(Tensor t_in,  Tensor t_wt,  Tensor "
-          "t_bias, bool training)->Tensor[] ",
+          "t_bias, bool training, float wt_scale=1.0)->Tensor[] ",
           c10::AliasAnalysisKind::PURE_FUNCTION),
       torch_ipex::tpp::fused_dense_gelu_fwd_unpad);
 
@@ -266,6 +319,13 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
           c10::AliasAnalysisKind::PURE_FUNCTION),
       torch_ipex::tpp::fused_embedding_layernorm_dropout_fwd_unpad);
 
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_embedding_layernorm_fwd_infer(float eps, int H, "
+          "int pad_id, Tensor[] inputs, bool bf16_out=False) -> Tensor",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_embedding_layernorm_fwd_infer);
+
   m.def(
       torch::schema(
           "torch_ipex::fused_embedding_layernorm_dropout_bwd_unpad(float p, int "
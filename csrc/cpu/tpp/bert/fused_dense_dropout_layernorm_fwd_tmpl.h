@@ -1,7 +1,7 @@
 RECORD_FUNCTION("bert_fwd", std::vector<c10::IValue>());
 int i = 0;
 auto t_in = inputs[i++]; // [S1][Nc][S2][Hc]
-auto t_in2 = inputs[i++]; // [S1][Nk][S2][Hk]
+auto t_in2 = inputs[i++]; // [S1][Nk][S2][Hk], empty without residual
 auto t_wt = inputs[i++]; // [Nk][Nc][Hc][Hk]
 auto t_bias = inputs[i++]; // [Nk][Hk]
 auto t_gamma = inputs[i++]; // [Nk][Hk]
@@ -17,6 +17,7 @@ auto Nk = wt_sizes[0];
 auto Hk = wt_sizes[3];
 
 auto t_wt_V = wt_tensor_for_fwd(Nk, Hk, Nc, Hc, t_wt);
+bool residual = t_in2.numel() > 0;
 
 auto t_dout = t_in.new_empty({S1, Nk, S2, Hk});
 auto t_out = t_dout;
@@ -35,7 +36,7 @@ if (p > 0)
 DECL_VLA_PTR_PT(T, in, [Nc][S2][Hc], t_in);
 DECL_VLA_PTR_PT(T, in2, [Nk][S2][Hk], t_in2);
 // DECL_VLA_PTR_PT(T, wt_V, [Nc][Hc / 2][Hk][2], t_wt_V);
-DECL_VLA_PTR_PT(T, wt_V, [Nc][Hc * Hk], t_wt_V);
+DECL_VLA_PTR_PT(TW, wt_V, [Nc][Hc * Hk], t_wt_V);
 DECL_VLA_PTR_PT(T, bias, [Hk], t_bias);
 DECL_VLA_PTR_PT(T, gamma, [Hk], t_gamma);
 DECL_VLA_PTR_PT(T, beta, [Hk], t_beta);
@@ -49,8 +50,15 @@ auto Ncb = Nc;
 if (Nc > Nk && Nc % Nk == 0) {
   Ncb = Nk;
 }
+// fp8 weights are dequantized to T in a per-thread buffer before the gemm
+constexpr bool fp8_wt = !std::is_same<TW, T>::value;
+auto t_wt_buf = at::Tensor();
+if (fp8_wt) {
+  t_wt_buf = t_in.new_empty({omp_get_max_threads(), Ncb, Hc * Hk});
+}
 // Create TPPs
 auto copy_bias_tpp = SCOPEIT(CpyBiasTPP<T>(S2, Hk), BIAS);
+auto dequant_tpp = SCOPEIT((ScaledConvertTPP<TW, T>(Hc * Hk)), EW_SCL);
 auto brgemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
     S2,
     Hk,
@@ -151,7 +159,7 @@ auto layer_norm_fwd_tpp =
         DECL_VLA_PTR_PT(T, dout, [Nk][S2 * Hk], t_dout);
         DECL_VLA_PTR_PT(T, in, [Nc][S2 * Hc], t_in);
         DECL_VLA_PTR_PT(T, in2, [Nk][S2 * Hk], t_in2);
-        DECL_VLA_PTR_PT(T, wt_V, [Nc][Hc * Hk], t_wt_V);
+        DECL_VLA_PTR_PT(TW, wt_V, [Nc][Hc * Hk], t_wt_V);
         DECL_VLA_PTR_PT(short, dp_mask, [Nk][(S2 * Hk + 15) / 16], t_dp_mask);
         DECL_VLA_PTR_PT(T, gamma, [Hk], t_gamma);
         DECL_VLA_PTR_PT(T, beta, [Hk], t_beta);
@@ -161,7 +169,16 @@ auto layer_norm_fwd_tpp =
         if (nc == 0) {
           copy_bias_tpp(bias[nk], dout[s1][nk]);
         }
-        brgemm_tpp(in[s1][nc], wt_V[nk][nc], dout[s1][nk], Ncb, true);
+        T* wt_ptr = (T*)wt_V[nk][nc];
+        if (fp8_wt) {
+          DECL_VLA_PTR_PT(T, wt_buf, [Ncb][Hc * Hk], t_wt_buf);
+          int tid = omp_get_thread_num();
+          for (int c = 0; c < Ncb; c++) {
+            dequant_tpp(wt_V[nk][nc + c], wt_buf[tid][c], wt_scale);
+          }
+          wt_ptr = wt_buf[tid][0];
+        }
+        brgemm_tpp(in[s1][nc], wt_ptr, dout[s1][nk], Ncb, true);
         if (!(nc + Ncb < Nc)) { // last nc iter
           // if (nc == Nc - Ncb) { // last nc iter
           if (p > 0) {
@@ -171,7 +188,9 @@ auto layer_norm_fwd_tpp =
                 dout[s1][nk],
                 dp_mask[s1][nk]);
           }
-          add_tpp(dout[s1][nk], in2[s1][nk], dout[s1][nk]);
+          if (residual) {
+            add_tpp(dout[s1][nk], in2[s1][nk], dout[s1][nk]);
+          }
           if (!parallelized_on_nk && nk == Nk - 1) {
             layer_norm_fwd_tpp(
                 dout[s1][0], gamma[0], beta[0], mean[s1], var[s1], out[s1][0]);
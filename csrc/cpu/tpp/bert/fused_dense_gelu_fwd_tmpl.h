@@ -21,8 +21,15 @@ auto Ncb = Nc;
 if (Nc > Nk && Nc % Nk == 0) {
   Ncb = Nk;
 }
+// fp8 weights are dequantized to T in a per-thread buffer before the gemm
+constexpr bool fp8_wt = !std::is_same<TW, T>::value;
+auto t_wt_buf = at::Tensor();
+if (fp8_wt) {
+  t_wt_buf = t_in.new_empty({omp_get_max_threads(), Ncb, Hc * Hk});
+}
 // Create TPPs
 auto copy_bias_tpp = SCOPEIT(CpyBiasTPP<T>(S2, Hk), BIAS);
+auto dequant_tpp = SCOPEIT((ScaledConvertTPP<TW, T>(Hc * Hk)), EW_SCL);
 auto brgemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
     S2,
     Hk,
@@ -59,13 +66,21 @@ DECL_VLA_PTR_PT(T, gelu_out, [Nk][S2 * Hk], t_gelu_out);
     }
   }
 #else
-  auto gemm_loop = ThreadedLoop<3>(
-      {LoopSpecs{0, Nc, Ncb, false}, LoopSpecs{S1}, LoopSpecs{Nk}}, "acB");
+  // the schedules for the loop autotuning, the last one blocking nk
+  long Nkb = Nk % 4 == 0 ? 4 : 1;
+  auto gemm_loop = TunedThreadedLoop<3>(
+      "fused_dense_gelu_fwd",
+      {{"acB", {LoopSpecs{0, Nc, Ncb, false}, LoopSpecs{S1}, LoopSpecs{Nk}}},
+       {"aBC", {LoopSpecs{0, Nc, Ncb, false}, LoopSpecs{S1}, LoopSpecs{Nk}}},
+       {"aCBc",
+        {LoopSpecs{0, Nc, Ncb, false},
+         LoopSpecs{S1},
+         LoopSpecs{0L, Nk, 1L, {Nkb}}}}});
   gemm_loop(
       [&](int* ind) {
         int nc = ind[0], s1 = ind[1], nk = ind[2];
         DECL_VLA_PTR_PT(T, in, [Nc][S2 * Hc], t_in);
-        DECL_VLA_PTR_PT(T, wt_V, [Nc][Hc * Hk], t_wt_V);
+        DECL_VLA_PTR_PT(TW, wt_V, [Nc][Hc * Hk], t_wt_V);
         DECL_VLA_PTR_PT(T, bias, [Hk], t_bias);
         DECL_VLA_PTR_PT(T, out, [Nk][S2 * Hk], t_out);
         DECL_VLA_PTR_PT(T, gelu_out, [Nk][S2 * Hk], t_gelu_out);
@@ -73,7 +88,16 @@ DECL_VLA_PTR_PT(T, gelu_out, [Nk][S2 * Hk], t_gelu_out);
         if (nc == 0) {
           copy_bias_tpp(bias[nk], out[s1][nk]);
         }
-        brgemm_tpp(in[s1][nc], wt_V[nk][nc], out[s1][nk], Ncb, true);
+        T* wt_ptr = (T*)wt_V[nk][nc];
+        if (fp8_wt) {
+          DECL_VLA_PTR_PT(T, wt_buf, [Ncb][Hc * Hk], t_wt_buf);
+          int tid = omp_get_thread_num();
+          for (int c = 0; c < Ncb; c++) {
+            dequant_tpp(wt_V[nk][nc + c], wt_buf[tid][c], wt_scale);
+          }
+          wt_ptr = wt_buf[tid][0];
+        }
+        brgemm_tpp(in[s1][nc], wt_ptr, out[s1][nk], Ncb, true);
         if (nc == Nc - Ncb) { // last iter
           gelu_fwd_tpp(out[s1][nk], gelu_out[s1][nk]);
         }
@@ -118,32 +118,71 @@ auto set_zero_tpp = SCOPEIT(SetZeroTPP<float>(N * H), EW_ZERO);
 
   t_grad_pos_emb.zero_();
   t_grad_tt_emb.zero_();
+  long NT = B * S1 * S2;
+  std::vector<long> w_rows(NT, -1), pos_rows(NT), tt_rows(NT, 0);
   for (int b = 0; b < B; b++) {
     for (int s1 = 0; s1 < S1; s1++) {
       for (int s2 = 0; s2 < S2; s2++) {
-        long w_id = -1, pos_id = s1 * S2 + s2, tt_id = 0;
-        if (in_emb_null)
-          w_id = in_ids[b][s1][s2];
-        if (!pos_ids_null)
-          pos_id = pos_ids[b][s1][s2];
+        long i = (b * S1 + s1) * S2 + s2;
+        if (in_emb_null && in_ids[b][s1][s2] != pad_id)
+          w_rows[i] = in_ids[b][s1][s2];
+        pos_rows[i] = pos_ids_null ? s1 * S2 + s2 : pos_ids[b][s1][s2];
         if (!tt_ids_null)
-          tt_id = tt_ids[b][s1][s2];
+          tt_rows[i] = tt_ids[b][s1][s2];
+      }
+    }
+  }
+  // the rows of the tables are updated by many tokens (all of them for the
+  // token types), scatter_add_rows resolves the conflicts
+  auto emb_upd = [&](long i, auto* row) {
+    long b = i / (S1 * S2), s1 = i / S2 % S1, s2 = i % S2;
+    for (int n = 0; n < N; n++) {
+      for (int h = 0; h < H; h++) {
+        row[n * H + h] += grad_emb_out[b][s1][n][s2][h];
+      }
+    }
+  };
+  if (in_emb_null) {
+    static ScatterAddState word_state;
+    scatter_add_rows(
+        word_state,
+        grad_word_emb[0][0],
+        t_word_emb.size(0),
+        N * H,
+        NT,
+        w_rows.data(),
+        emb_upd);
+  } else {
+#pragma omp parallel for collapse(2)
+    for (int b = 0; b < B; b++) {
+      for (int s1 = 0; s1 < S1; s1++) {
         for (int n = 0; n < N; n++) {
-          for (int h = 0; h < H; h++) {
-            float grad = grad_emb_out[b][s1][n][s2][h];
-            if (in_emb_null) {
-              if (w_id != pad_id)
-                grad_word_emb[w_id][n][h] += grad;
-            } else {
-              grad_in_emb[b][s1][n][s2][h] = grad;
+          for (int s2 = 0; s2 < S2; s2++) {
+            for (int h = 0; h < H; h++) {
+              grad_in_emb[b][s1][n][s2][h] = grad_emb_out[b][s1][n][s2][h];
             }
-            grad_pos_emb[pos_id][n][h] += grad;
-            grad_tt_emb[tt_id][n][h] += grad;
           }
         }
       }
     }
   }
+  static ScatterAddState pos_state, tt_state;
+  scatter_add_rows(
+      pos_state,
+      grad_pos_emb[0][0],
+      t_pos_emb.size(0),
+      N * H,
+      NT,
+      pos_rows.data(),
+      emb_upd);
+  scatter_add_rows(
+      tt_state,
+      grad_tt_emb[0][0],
+      t_tt_emb.size(0),
+      N * H,
+      NT,
+      tt_rows.data(),
+      emb_upd);
 }
 return std::vector<at::Tensor>(
     {t_grad_in_emb,
@@ -16,6 +16,9 @@ auto t_APD_T = inputs[i++];
 auto t_APD_mask = inputs[i++];
 auto t_offs = inputs[i++]; // [B+1]
 auto t_offs2 = inputs[i++]; // [B+1]
+// Optional, the rotary embedding of the query and key of decoders
+auto t_cos = (size_t)i < inputs.size() ? inputs[i++] : at::Tensor();
+auto t_sin = (size_t)i < inputs.size() ? inputs[i++] : at::Tensor();
 
 long B = t_offs.sizes()[0] - 1;
 long SS1 = t_offs2[B].item().to<long>();
@@ -27,6 +30,7 @@ long H = sizes[3];
 // long NH = N*H;
 float one_by_sqrt_H = 1.0 / sqrt(H);
 const bool S2_eq_H = (S2 == H);
+bool rope = t_cos.defined() && t_cos.numel() != 0;
 constexpr long BS = 8;
 bool dt_bf16 = (t_dCL.dtype() == at::kBFloat16);
 
@@ -147,6 +151,7 @@ auto t_Wv_TV = wt_tensor_for_bwd_compact(N, H, N, H, t_Wv);
   auto scale_tpp = SCOPEIT((ScaleTPP<float, T>(S2 * S2)), EW_SCL);
   auto a_n2v_tpp =
       SCOPEIT(XformExtTPP<T>(S2, S2, XformTPP::XFORM_N2V_TPP, true), VNNI);
+  auto rope_bwd_tpp = SCOPEIT(RotaryEmbeddingTPP<T>(S2, H, true), EW_MUL);
   auto ai_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
       S2, H, S2, S2 * S2, N * S2 * H, 0.0, XformTPP::XFORM_NONE_TPP, 0, S1)));
   auto aw_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
@@ -337,6 +342,11 @@ auto t_Wv_TV = wt_tensor_for_bwd_compact(N, H, N, H, t_Wv);
             // dQL = dADP * KL_V
             ai_gemm_tpp(
                 dtAPD_bf[0][0], KL_V[start][n], dQL[s11][n], len, S2_eq_H);
+            if (rope) {
+              DECL_VLA_PTR_PT(float, cos, [S2 * H], t_cos);
+              DECL_VLA_PTR_PT(float, sin, [S2 * H], t_sin);
+              rope_bwd_tpp(dQL[s11][n], cos[s11], sin[s11]);
+            }
             if (dt_bf16)
               cw_n2v_tpp(dQL[s11][n], dQL_V[atrans_blk(s11, n)]);
           }
@@ -350,6 +360,11 @@ auto t_Wv_TV = wt_tensor_for_bwd_compact(N, H, N, H, t_Wv);
                 dKL[s21][n],
                 len,
                 true);
+            if (rope) {
+              DECL_VLA_PTR_PT(float, cos, [S2 * H], t_cos);
+              DECL_VLA_PTR_PT(float, sin, [S2 * H], t_sin);
+              rope_bwd_tpp(dKL[s21][n], cos[s21], sin[s21]);
+            }
             if (dt_bf16)
               cw_n2v_tpp(dKL[s21][n], dKL_V[atrans_blk(s21, n)]);
           }
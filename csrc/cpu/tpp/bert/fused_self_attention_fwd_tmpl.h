@@ -16,6 +16,10 @@ auto t_EHS = inputs[9]; // [B][S][HS] --> [B][S1][N][S2][H]
 auto t_EAM = inputs[10]; // Optional [B][S]
 auto t_offs = inputs[11]; // [B+1]
 auto t_offs2 = inputs[12]; // [B+1]
+// Optional, the rotary embedding of the query and key of decoders
+auto t_cos = inputs.size() > 13 ? inputs[13] : at::Tensor(); // [S1][S2][H]
+auto t_sin = inputs.size() > 14 ? inputs[14] : at::Tensor(); // [S1][S2][H]
+// causal: set by the caller, masks the keys after each query
 
 long B = t_offs.sizes()[0] - 1;
 long SS1 = t_offs2[B].item().to<long>();
@@ -26,6 +30,7 @@ long S2 = sizes[2];
 long H = sizes[3];
 // long NH = N*H;
 float one_by_sqrt_H = 1.0 / sqrt(H);
+bool rope = t_cos.defined() && t_cos.numel() != 0;
 bool null_EHS = false;
 bool dt_bf16 = (t_HS.dtype() == at::kBFloat16);
 bool bf16_training = (training && dt_bf16);
@@ -130,6 +135,7 @@ if (training) {
       SCOPEIT(XformExtTPP<T>(S2, H, XformTPP::XFORM_XPOSE_N2V_TPP, true), VNNI);
   auto v_xpose_tpp_1 =
       SCOPEIT(XformExtTPP<T>(S2, H, XformTPP::XFORM_N2V_TPP, true), VNNI);
+  auto rope_tpp = SCOPEIT(RotaryEmbeddingTPP<T>(S2, H, false), EW_MUL);
   auto a_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, float>(
       S2, S2, H, S2 * H, H * S2, 0.0, XformTPP::XFORM_NONE_TPP, 0, 1)));
   auto scale_tpp = SCOPEIT((ScaleTPP<float, float>(S2 * S2)), EW_SCL);
@@ -185,9 +191,15 @@ if (training) {
             if (bn == 0)
               copy_bias_tpp(Bq[nk], QL[s1][nk]);
             qkv_gemm_tpp(HS[s1][bn], Wq_V[nk][bn], QL[s1][nk], BN, true);
-            if (bf16_training)
-              if (bn == N - BN)
+            if (bn == N - BN) {
+              if (rope) {
+                DECL_VLA_PTR_PT(float, cos, [S2 * H], t_cos);
+                DECL_VLA_PTR_PT(float, sin, [S2 * H], t_sin);
+                rope_tpp(QL[s1][nk], cos[s1], sin[s1]);
+              }
+              if (bf16_training)
                 xpose_tpp(QL[s1][nk], QL_T[nk][s1]);
+            }
           },
           [&]() { qkv_gemm_tpp.config(); },
           [&]() { qkv_gemm_tpp.release(); });
@@ -238,6 +250,11 @@ if (training) {
               xpose_tpp(N, S2 * H, S1 * S2 * H, EHS[s1][0], EHS_T[0][s1]);
             copy_bias_tpp(Bk[nk], tmpp);
             qkv_gemm_tpp(EHS[s1][0], Wk_V[nk][0], tmpp, N);
+            if (rope) {
+              DECL_VLA_PTR_PT(float, cos, [S2 * H], t_cos);
+              DECL_VLA_PTR_PT(float, sin, [S2 * H], t_sin);
+              rope_tpp(tmpp, cos[s1], sin[s1]);
+            }
             k_xpose_tpp_1(tmpp, KL_V[s1][nk]); // KL_V = KL_VT if not training
             if (training)
               kv_xpose_tpp_2(tmpp, KL_TV[s1][nk]);
@@ -312,8 +329,18 @@ if (training) {
             float AS[len][S2][S2];
             for (int s21 = start; s21 < end; s21++) {
               long ls21 = s21 - start;
+              if (causal && s21 > s11) {
+                // the blocks of keys after the queries get a zero probability
+                std::fill_n(AS[ls21][0], S2 * S2, -10000.0f);
+                continue;
+              }
               a_gemm_tpp(QL[s11][n], KL_TV[s21][n], AS[ls21][0], 1);
               scale_tpp(AS[ls21][0], AS[ls21][0], one_by_sqrt_H);
+              if (causal && s21 == s11) {
+                for (int i = 0; i < S2; i++)
+                  for (int j = i + 1; j < S2; j++)
+                    AS[ls21][i][j] = -10000.0f;
+              }
               if (t_AM.numel() != 0)
                 add_mask_tpp(AM[s21], AS[ls21][0]);
             }
@@ -340,7 +367,12 @@ if (training) {
               a_xpose_tpp(
                   len, S2 * S2, len * S2 * S2, APD[n][ss1], APD_T[n][ss + l]);
             }
-            c_gemm_tpp(APD[n][ss1], VL_V[start][n], CL[s11][n], len);
+            // the probabilities of the keys after the queries are zero
+            c_gemm_tpp(
+                APD[n][ss1],
+                VL_V[start][n],
+                CL[s11][n],
+                causal ? s11 - start + 1 : len);
           }
         }
       }
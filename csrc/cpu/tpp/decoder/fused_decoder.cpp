@@ -0,0 +1,190 @@
+#include <ATen/record_function.h>
+
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "ext_tpp.h"
+#include "tensor_helper.h"
+#include "threaded_loops.h"
+#include "timing.h"
+#include "xsmm_functors.h"
+
+namespace torch_ipex {
+namespace tpp {
+
+// The decoder-only (GPT / LLaMA style) blocks on the blocked and unpadded
+// layout of the BERT ops: [S1][N][S2][H] activations and [Nk][Nc][Hc][Hk]
+// weights. The causal self-attention reuses the BERT self-attention
+// templates, its backward being the BERT one.
+
+REGISTER_LOCAL_SCOPE(q_gemm, "q_gemm");
+REGISTER_LOCAL_SCOPE(k_gemm, "k_gemm");
+REGISTER_LOCAL_SCOPE(v_gemm, "v_gemm");
+REGISTER_LOCAL_SCOPE(ac_gemm, "ac_gemm");
+REGISTER_LOCAL_SCOPE(rms_norm, "rms_norm");
+REGISTER_LOCAL_SCOPE(gu_gemm, "gu_gemm");
+REGISTER_LOCAL_SCOPE(r_gemm, "r_gemm");
+
+REGISTER_LOCAL_SCOPE(drms_norm, "drms_norm");
+REGISTER_LOCAL_SCOPE(dgu_act, "dgu_act");
+REGISTER_LOCAL_SCOPE(dgu_gemm, "dgu_gemm");
+REGISTER_LOCAL_SCOPE(dwgu_gemm, "dwgu_gemm");
+REGISTER_LOCAL_SCOPE(dir_gemm, "dir_gemm");
+REGISTER_LOCAL_SCOPE(dwr_gemm, "dwr_gemm");
+
+static std::vector<at::Tensor> fused_causal_self_attention_fwd_unpad(
+    double p,
+    std::vector<at::Tensor> inputs,
+    bool training) {
+  GlobalPass _gp(FWD);
+  const bool causal = true;
+  if (inputs[6].dtype() == at::kFloat) {
+    typedef float T;
+#include "../bert/fused_self_attention_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "../bert/fused_self_attention_fwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_rmsnorm_fwd_unpad(
+    double eps,
+    at::Tensor t_in,
+    at::Tensor t_gamma) {
+  GlobalPass _gp(FWD);
+  if (t_in.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_rmsnorm_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_rmsnorm_fwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_rmsnorm_bwd_unpad(
+    at::Tensor t_grad_out,
+    at::Tensor t_in,
+    at::Tensor t_gamma,
+    at::Tensor t_rstd) {
+  GlobalPass _gp(BWD);
+  if (t_grad_out.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_rmsnorm_bwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_rmsnorm_bwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_dense_swiglu_fwd_unpad(
+    at::Tensor t_in,
+    at::Tensor t_wt_gate,
+    at::Tensor t_wt_up) {
+  GlobalPass _gp(FWD);
+  if (t_in.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_dense_swiglu_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_dense_swiglu_fwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_dense_swiglu_bwd_unpad(
+    at::Tensor t_grad_out,
+    at::Tensor t_gate,
+    at::Tensor t_up,
+    at::Tensor t_in,
+    at::Tensor t_wt_gate,
+    at::Tensor t_wt_up) {
+  GlobalPass _gp(BWD);
+  if (t_grad_out.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_dense_swiglu_bwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_dense_swiglu_bwd_tmpl.h"
+  }
+}
+
+static at::Tensor fused_dense_residual_fwd_unpad(
+    at::Tensor t_in,
+    at::Tensor t_in2,
+    at::Tensor t_wt) {
+  GlobalPass _gp(FWD);
+  if (t_in.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_dense_residual_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_dense_residual_fwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_dense_residual_bwd_unpad(
+    at::Tensor t_grad_out,
+    at::Tensor t_in,
+    at::Tensor t_wt) {
+  GlobalPass _gp(BWD);
+  if (t_grad_out.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_dense_residual_bwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_dense_residual_bwd_tmpl.h"
+  }
+}
+} // namespace tpp
+} // namespace torch_ipex
+namespace {
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_causal_self_attention_fwd_unpad(float p, Tensor[] inputs, bool training) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_causal_self_attention_fwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_rmsnorm_fwd_unpad(float eps, Tensor t_in, Tensor t_gamma) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_rmsnorm_fwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_rmsnorm_bwd_unpad(Tensor t_grad_out, Tensor t_in, "
+          "Tensor t_gamma, Tensor t_rstd) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_rmsnorm_bwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_dense_swiglu_fwd_unpad(Tensor t_in, Tensor t_wt_gate, "
+          "Tensor t_wt_up) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_dense_swiglu_fwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_dense_swiglu_bwd_unpad(Tensor t_grad_out, Tensor t_gate, "
+          "Tensor t_up, Tensor t_in, Tensor t_wt_gate, Tensor t_wt_up) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_dense_swiglu_bwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_dense_residual_fwd_unpad(Tensor t_in, Tensor t_in2, "
+          "Tensor t_wt) -> Tensor",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_dense_residual_fwd_unpad);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_dense_residual_bwd_unpad(Tensor t_grad_out, Tensor t_in, "
+          "Tensor t_wt) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_dense_residual_bwd_unpad);
+}
+} // namespace
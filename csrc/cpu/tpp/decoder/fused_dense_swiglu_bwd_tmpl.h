@@ -0,0 +1,186 @@
+RECORD_FUNCTION("decoder_bwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes();
+auto wt_sizes = t_wt_gate.sizes();
+auto S1 = in_sizes[0];
+auto Nc = in_sizes[1];
+auto S2 = in_sizes[2];
+auto Hc = in_sizes[3];
+
+auto Nk = wt_sizes[0];
+auto Hk = wt_sizes[3];
+
+const auto grad_wt_flag =
+    (t_wt_gate.dim() == 5 ? XformTPP::XFORM_N2V_TPP : XformTPP::XFORM_NONE_TPP);
+const auto input_trans_flag =
+    (t_in.dtype() == at::kFloat ? XformTPP::XFORM_XPOSE_TPP
+                                : XformTPP::XFORM_NONE_TPP);
+auto t_wt_gate_TV = wt_tensor_for_bwd_compact(Nk, Hk, Nc, Hc, t_wt_gate);
+auto t_wt_up_TV = wt_tensor_for_bwd_compact(Nk, Hk, Nc, Hc, t_wt_up);
+
+auto t_in_T = t_in;
+if (input_trans_flag == XformTPP::XFORM_NONE_TPP) {
+  t_in_T = act_tensor_trans_compact(S1, Nc, S2, Hc, t_in);
+}
+auto in_blk = LToPBlockAccessMapper<T>(S1, Nc);
+
+auto t_grad_in = at::empty_like(t_in);
+auto t_grad_gate = at::empty_like(t_grad_out);
+auto t_grad_up = at::empty_like(t_grad_out);
+auto t_grad_wt_gate = at::empty_like(t_wt_gate);
+auto t_grad_wt_up = at::empty_like(t_wt_up);
+auto t_grad_gate_V = t_grad_gate;
+auto t_grad_up_V = t_grad_up;
+if (t_grad_gate.dtype() == at::kBFloat16) {
+  t_grad_gate_V = t_grad_out.new_empty({Nk, S1, S2 / 2, Hk, 2});
+  t_grad_up_V = t_grad_out.new_empty({Nk, S1, S2 / 2, Hk, 2});
+}
+auto gdout_blk = LToPBlockAccessMapper<T>(S1, Nk);
+
+DECL_VLA_PTR_PT(T, grad_out, [Nk][S2 * Hk], t_grad_out);
+DECL_VLA_PTR_PT(T, gate, [Nk][S2 * Hk], t_gate);
+DECL_VLA_PTR_PT(T, up, [Nk][S2 * Hk], t_up);
+DECL_VLA_PTR_PT(T, grad_gate, [Nk][S2 * Hk], t_grad_gate);
+DECL_VLA_PTR_PT(T, grad_up, [Nk][S2 * Hk], t_grad_up);
+DECL_VLA_PTR_PT(T, grad_gate_V, [S2 * Hk], t_grad_gate_V);
+DECL_VLA_PTR_PT(T, grad_up_V, [S2 * Hk], t_grad_up_V);
+
+constexpr long BS = 8;
+auto Nkb = Nk;
+if (Nk > Nc && Nk % Nc == 0) {
+  Nkb = Nc;
+}
+
+auto swiglu_bwd_tpp = SCOPEIT(SwiGLUBwdTPP<T>(S2 * Hk), ACT);
+auto n2v_tpp =
+    SCOPEIT(XformExtTPP<T>(S2, Hk, XformTPP::XFORM_N2V_TPP, true), VNNI);
+auto di_gemm_b0_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    S2,
+    Hc,
+    Hk,
+    S2* Hk,
+    Hk* Hc,
+    0.0,
+    XformTPP::XFORM_NONE_TPP,
+    0,
+    Nkb)));
+auto di_gemm_b1_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    S2,
+    Hc,
+    Hk,
+    S2* Hk,
+    Hk* Hc,
+    1.0,
+    XformTPP::XFORM_NONE_TPP,
+    0,
+    Nkb)));
+auto dw_set_zero_tpp = SCOPEIT(SetZeroTPP<T>(Hk * Hc), EW_ZERO);
+auto dw_cpy_tpp = SCOPEIT(CpyTPP<T>(Hk * Hc), VNNI);
+auto dw_n2v_tpp =
+    SCOPEIT(XformExtTPP<T>(Hc, Hk, XformTPP::XFORM_N2V_TPP, true), VNNI);
+auto dw_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    Hc,
+    Hk,
+    S2,
+    input_trans_flag == XformTPP::XFORM_NONE_TPP ? S2 * Hc : Nc * S2 * Hc,
+    input_trans_flag == XformTPP::XFORM_NONE_TPP ? S2 * Hk : Nk * S2 * Hk,
+    1.0,
+    XformTPP::XFORM_NONE_TPP, //(XformTPP::XFORM_TYPE)grad_wt_flag,
+    input_trans_flag,
+    BS)));
+{
+  RECORD_SCOPE(dgu_act, {t_grad_out, t_gate, t_up});
+  {
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for collapse(2)
+    for (int s1 = 0; s1 < S1; s1++) {
+      for (int nk = 0; nk < Nk; nk++) {
+        swiglu_bwd_tpp(
+            grad_out[s1][nk],
+            gate[s1][nk],
+            up[s1][nk],
+            grad_gate[s1][nk],
+            grad_up[s1][nk]);
+        n2v_tpp(grad_gate[s1][nk], grad_gate_V[gdout_blk(s1, nk)]);
+        n2v_tpp(grad_up[s1][nk], grad_up_V[gdout_blk(s1, nk)]);
+      }
+    }
+  }
+}
+{
+  RECORD_SCOPE(dgu_gemm, {t_grad_gate, t_grad_up, t_wt_gate_TV, t_wt_up_TV});
+  // grad_in = grad_gate * wt_gate_T + grad_up * wt_up_T
+  auto di_loop = ThreadedLoop<3>(
+      {LoopSpecs{0, Nk, Nkb, false}, LoopSpecs{S1}, LoopSpecs{Nc}}, "acB");
+  di_loop(
+      [&](int* ind) {
+        int nk = ind[0], s1 = ind[1], nc = ind[2];
+        DECL_VLA_PTR_PT(T, grad_gate, [Nk][S2 * Hk], t_grad_gate);
+        DECL_VLA_PTR_PT(T, grad_up, [Nk][S2 * Hk], t_grad_up);
+        DECL_VLA_PTR_PT(T, wt_gate_TV, [Nk][Hk * Hc], t_wt_gate_TV);
+        DECL_VLA_PTR_PT(T, wt_up_TV, [Nk][Hk * Hc], t_wt_up_TV);
+        DECL_VLA_PTR_PT(T, grad_in, [Nc][S2 * Hc], t_grad_in);
+        if (nk == 0)
+          di_gemm_b0_tpp(
+              grad_gate[s1][nk],
+              wt_gate_TV[nc][nk],
+              grad_in[s1][nc],
+              Nkb,
+              true);
+        else
+          di_gemm_b1_tpp(
+              grad_gate[s1][nk],
+              wt_gate_TV[nc][nk],
+              grad_in[s1][nc],
+              Nkb,
+              true);
+        di_gemm_b1_tpp(
+            grad_up[s1][nk], wt_up_TV[nc][nk], grad_in[s1][nc], Nkb, true);
+      },
+      [&]() { di_gemm_b0_tpp.config(); },
+      [&]() { di_gemm_b0_tpp.release(); });
+}
+{
+  RECORD_SCOPE(dwgu_gemm, {t_in_T, t_grad_gate_V, t_grad_up_V});
+  auto dw_loop = ThreadedLoop<3>(
+      {LoopSpecs{0, S1, BS}, LoopSpecs{Nk}, LoopSpecs{Nc}}, "aBC");
+  dw_loop(
+      [&](int* ind) {
+        int s1 = ind[0], nk = ind[1], nc = ind[2];
+        int count = (s1 + BS <= S1 ? BS : S1 - s1);
+        bool is_last_iter = !(s1 + BS < S1);
+        DECL_VLA_PTR_PT(T, grad_wt_gate, [Nc][Hc * Hk], t_grad_wt_gate);
+        DECL_VLA_PTR_PT(T, grad_wt_up, [Nc][Hc * Hk], t_grad_wt_up);
+        DECL_VLA_PTR_PT(T, in_T, [Hc * S2], t_in_T);
+        DECL_VLA_PTR_PT(T, grad_gate_V, [S2 * Hk], t_grad_gate_V);
+        DECL_VLA_PTR_PT(T, grad_up_V, [S2 * Hk], t_grad_up_V);
+        if (s1 == 0) {
+          dw_set_zero_tpp(grad_wt_gate[nk][nc]);
+          dw_set_zero_tpp(grad_wt_up[nk][nc]);
+        }
+        dw_gemm_tpp(
+            in_T[in_blk(s1, nc)],
+            grad_gate_V[gdout_blk(s1, nk)],
+            grad_wt_gate[nk][nc],
+            count,
+            true);
+        if (grad_wt_flag != XformTPP::XFORM_NONE_TPP && is_last_iter) {
+          T tmp[Hc * Hk];
+          dw_cpy_tpp(grad_wt_gate[nk][nc], tmp);
+          dw_n2v_tpp(tmp, grad_wt_gate[nk][nc]);
+        }
+        dw_gemm_tpp(
+            in_T[in_blk(s1, nc)],
+            grad_up_V[gdout_blk(s1, nk)],
+            grad_wt_up[nk][nc],
+            count,
+            true);
+        if (grad_wt_flag != XformTPP::XFORM_NONE_TPP && is_last_iter) {
+          T tmp[Hc * Hk];
+          dw_cpy_tpp(grad_wt_up[nk][nc], tmp);
+          dw_n2v_tpp(tmp, grad_wt_up[nk][nc]);
+        }
+      },
+      [&]() { dw_gemm_tpp.config(); },
+      [&]() { dw_gemm_tpp.release(); });
+}
+return std::vector<at::Tensor>({t_grad_in, t_grad_wt_gate, t_grad_wt_up});
@@ -0,0 +1,73 @@
+RECORD_FUNCTION("decoder_fwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes();
+auto wt_sizes = t_wt_gate.sizes();
+auto S1 = in_sizes[0];
+auto Nc = in_sizes[1];
+auto S2 = in_sizes[2];
+auto Hc = in_sizes[3];
+
+auto Nk = wt_sizes[0];
+auto Hk = wt_sizes[3];
+
+auto t_wt_gate_V = wt_tensor_for_fwd(Nk, Hk, Nc, Hc, t_wt_gate);
+auto t_wt_up_V = wt_tensor_for_fwd(Nk, Hk, Nc, Hc, t_wt_up);
+
+// gate and up are saved for the backward
+auto t_gate = t_in.new_empty({S1, Nk, S2, Hk});
+auto t_up = t_in.new_empty({S1, Nk, S2, Hk});
+auto t_out = t_in.new_empty({S1, Nk, S2, Hk});
+
+auto Ncb = Nc;
+if (Nc > Nk && Nc % Nk == 0) {
+  Ncb = Nk;
+}
+// Create TPPs
+auto set_zero_tpp = SCOPEIT(SetZeroTPP<T>(S2 * Hk), EW_ZERO);
+auto brgemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    S2,
+    Hk,
+    Hc,
+    S2* Hc,
+    Hk* Hc,
+    1.0,
+    XformTPP::XFORM_NONE_TPP,
+    0,
+    Ncb)));
+auto swiglu_fwd_tpp = SCOPEIT(SwiGLUFwdTPP<T>(S2 * Hk), ACT);
+
+{
+  RECORD_SCOPE(gu_gemm, {t_in, t_wt_gate_V, t_wt_up_V});
+  // the schedules for the loop autotuning, the last one blocking nk
+  long Nkb = Nk % 4 == 0 ? 4 : 1;
+  auto gemm_loop = TunedThreadedLoop<3>(
+      "fused_dense_swiglu_fwd",
+      {{"acB", {LoopSpecs{0, Nc, Ncb, false}, LoopSpecs{S1}, LoopSpecs{Nk}}},
+       {"aBC", {LoopSpecs{0, Nc, Ncb, false}, LoopSpecs{S1}, LoopSpecs{Nk}}},
+       {"aCBc",
+        {LoopSpecs{0, Nc, Ncb, false},
+         LoopSpecs{S1},
+         LoopSpecs{0L, Nk, 1L, {Nkb}}}}});
+  gemm_loop(
+      [&](int* ind) {
+        int nc = ind[0], s1 = ind[1], nk = ind[2];
+        DECL_VLA_PTR_PT(T, in, [Nc][S2 * Hc], t_in);
+        DECL_VLA_PTR_PT(T, wt_gate_V, [Nc][Hc * Hk], t_wt_gate_V);
+        DECL_VLA_PTR_PT(T, wt_up_V, [Nc][Hc * Hk], t_wt_up_V);
+        DECL_VLA_PTR_PT(T, gate, [Nk][S2 * Hk], t_gate);
+        DECL_VLA_PTR_PT(T, up, [Nk][S2 * Hk], t_up);
+        DECL_VLA_PTR_PT(T, out, [Nk][S2 * Hk], t_out);
+
+        if (nc == 0) {
+          set_zero_tpp(gate[s1][nk]);
+          set_zero_tpp(up[s1][nk]);
+        }
+        brgemm_tpp(in[s1][nc], wt_gate_V[nk][nc], gate[s1][nk], Ncb, true);
+        brgemm_tpp(in[s1][nc], wt_up_V[nk][nc], up[s1][nk], Ncb, true);
+        if (nc == Nc - Ncb) { // last iter
+          swiglu_fwd_tpp(gate[s1][nk], up[s1][nk], out[s1][nk]);
+        }
+      },
+      [&]() { brgemm_tpp.config(); },
+      [&]() { brgemm_tpp.release(); });
+}
+return std::vector<at::Tensor>({t_out, t_gate, t_up});
@@ -0,0 +1,46 @@
+RECORD_FUNCTION("decoder_bwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes();
+auto S1 = in_sizes[0];
+auto N = in_sizes[1];
+auto S2 = in_sizes[2];
+auto H = in_sizes[3];
+
+auto t_grad_in = at::empty_like(t_in);
+auto t_grad_gamma = at::empty_like(t_gamma); // [N][H]
+
+auto set_zero_tpp = SCOPEIT(SetZeroTPP<float>(N * H), EW_ZERO);
+auto rms_norm_bwd_tpp = SCOPEIT(RMSNormBwdTPP<T>(N, S2, H), LAYER_NORM);
+
+{
+  RECORD_SCOPE(drms_norm, {t_grad_out, t_in});
+  DECL_VLA_PTR_PT(T, grad_out, [N][S2 * H], t_grad_out);
+  DECL_VLA_PTR_PT(T, in, [N][S2 * H], t_in);
+  DECL_VLA_PTR_PT(T, gamma, [H], t_gamma);
+  DECL_VLA_PTR_PT(float, rstd, [S2], t_rstd);
+  DECL_VLA_PTR_PT(T, grad_in, [N][S2 * H], t_grad_in);
+  DECL_VLA_PTR_PT(T, grad_gamma, [H], t_grad_gamma);
+  int num_threads = omp_get_max_threads();
+  float* gamma_ptrs[num_threads];
+  {
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel
+    {
+      int tid = omp_get_thread_num();
+      float prv_grad_gamma[N][H];
+      gamma_ptrs[tid] = prv_grad_gamma[0];
+      set_zero_tpp(prv_grad_gamma[0]);
+#pragma omp for
+      for (int s1 = 0; s1 < S1; s1++) {
+        rms_norm_bwd_tpp(
+            grad_out[s1][0],
+            in[s1][0],
+            rstd[s1],
+            gamma[0],
+            grad_in[s1][0],
+            prv_grad_gamma[0]);
+      }
+      omp_reduce_buf(num_threads, N * H, gamma_ptrs, grad_gamma[0]);
+    }
+  }
+}
+return std::vector<at::Tensor>({t_grad_in, t_grad_gamma});
@@ -0,0 +1,27 @@
+RECORD_FUNCTION("decoder_fwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes();
+auto S1 = in_sizes[0];
+auto N = in_sizes[1];
+auto S2 = in_sizes[2];
+auto H = in_sizes[3];
+
+auto t_out = at::empty_like(t_in);
+auto t_rstd = at::empty({S1, S2}, at::kFloat);
+
+auto rms_norm_fwd_tpp = SCOPEIT(RMSNormFwdTPP<T>(N, S2, H, eps), LAYER_NORM);
+
+{
+  RECORD_SCOPE(rms_norm, {t_in, t_gamma});
+  DECL_VLA_PTR_PT(T, in, [N][S2 * H], t_in);
+  DECL_VLA_PTR_PT(T, gamma, [H], t_gamma);
+  DECL_VLA_PTR_PT(float, rstd, [S2], t_rstd);
+  DECL_VLA_PTR_PT(T, out, [N][S2 * H], t_out);
+  {
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for
+    for (int s1 = 0; s1 < S1; s1++) {
+      rms_norm_fwd_tpp(in[s1][0], gamma[0], rstd[s1], out[s1][0]);
+    }
+  }
+}
+return std::vector<at::Tensor>({t_out, t_rstd});
@@ -56,13 +56,14 @@ class BrgemmExtTPP {
       Tout* C,
       long count,
       bool no_tile_cfg = false) {
+    TPPRecordFunction _rf(BRGEMM);
     if (c_trans == XformTPP::XFORM_NONE_TPP) {
-      ScopedTimer _t(BRGEMM, 2 * M * N * K * count);
+      ScopedTimer _t(BRGEMM, 2 * M * N * K * count, brgemm.bytes(count));
       brgemm(A, B, C, count, no_tile_cfg);
     } else {
       Tout tmp_C[M * N];
       {
-        ScopedTimer _t(BRGEMM, 2 * M * N * K * count);
+        ScopedTimer _t(BRGEMM, 2 * M * N * K * count, brgemm.bytes(count));
         brgemm(A, B, tmp_C, count, no_tile_cfg);
       }
       if (beta == 0.0) {
@@ -137,7 +138,8 @@ class ScopedTPP<BrgemmTPP<Tin, Tout>, impl> {
       Tout* C,
       long count,
       bool no_tile_cfg = false) {
-    ScopedTimer _t(BRGEMM, func.flops() * count);
+    TPPRecordFunction _rf(BRGEMM);
+    ScopedTimer _t(BRGEMM, func.flops() * count, func.bytes(count));
     if (impl == 0) {
       func(A, B, C, count, no_tile_cfg);
     } else if (impl == 1) {
@@ -191,6 +193,29 @@ class ScopedTPP<BrgemmExtTPP<Tin, Tout>, impl> {
  private:
   BrgemmExtTPP<Tin, Tout> func;
 };
+
+// Sums the per-thread buffers of N elements in buf, inside a parallel region
+template <typename T>
+inline void omp_reduce_buf(
+    int num_threads,
+    int N,
+    float** ptrs,
+    T* buf,
+    bool accumulate = false) {
+  ScopedTimer _t(EW_RED);
+#pragma omp for
+  for (int i = 0; i < N; i++) {
+    float sum = 0.0;
+    for (int j = 0; j < num_threads; j++) {
+      sum += ptrs[j][i];
+    }
+    if (accumulate) {
+      buf[i] += sum;
+    } else {
+      buf[i] = sum;
+    }
+  }
+}
 } // namespace tpp
 } // namespace torch_ipex
 
@@ -4,6 +4,9 @@
 
 #include <libxsmm.h>
 #include <libxsmm_intrinsics_x86.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
 //#include "init.h"
 #include "timing.h"
 #include "utils.h"
@@ -28,6 +31,7 @@ REGISTER_SCOPE(pad_act, "pad_act");
 REGISTER_SCOPE(unpad_act, "unpad_act");
 
 int globalScope = 0;
+bool tpp_profiler_events = false;
 
 thread_local unsigned int* rng_state = NULL;
 thread_local struct drand48_data drng_state; // For non AVX512 version
@@ -74,6 +78,64 @@ void init_libxsmm() {
   xsmm_manual_seed(0);
 }
 
+void set_tpp_profiler_events(bool enabled) {
+  tpp_profiler_events = enabled;
+}
+
+// The seconds of a unit of getTime(), which counts the TSC ticks scaled by
+// ifreq, calibrated against the steady clock on the first use
+static double seconds_per_time_unit() {
+  static double seconds = [] {
+    auto start = std::chrono::steady_clock::now();
+    auto s = rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto e = rdtsc();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ((e - s) * ifreq);
+  }();
+  return seconds;
+}
+
+std::vector<std::string> get_debug_timer_names() {
+  std::vector<std::string> names;
+  for (int t = 0; t < LAST_TIMER; t++)
+    names.push_back(DebugTimerName(t));
+  return names;
+}
+
+std::vector<ScopeTimers> get_debug_timers(bool passes) {
+  auto scale = seconds_per_time_unit();
+  int nThreads = omp_get_max_threads();
+  std::vector<ScopeTimers> timers;
+  for (auto& scope : passes ? get_pass_list() : get_scope_list()) {
+    std::vector<std::vector<double>> times(nThreads);
+    std::vector<std::vector<double>> bytes(nThreads);
+    std::vector<double> flops(nThreads);
+    for (int tid = 0; tid < nThreads; tid++) {
+      for (int t = 0; t < LAST_TIMER; t++) {
+        times[tid].push_back(scope.detailed_timers[tid][t] * scale);
+        bytes[tid].push_back(scope.bytes[tid][t]);
+      }
+      flops[tid] = scope.flops[tid][0];
+    }
+    timers.emplace_back(
+        scope.name, scope.master_timer * scale, times, flops, bytes);
+  }
+  return timers;
+}
+
+void reset_debug_timers() {
+  for (auto* list : {&get_pass_list(), &get_scope_list()}) {
+    for (auto& scope : *list) {
+      scope.master_timer = 0;
+      memset(scope.detailed_timers, 0, sizeof(scope.detailed_timers));
+      memset(scope.flops, 0, sizeof(scope.flops));
+      memset(scope.bytes, 0, sizeof(scope.bytes));
+    }
+  }
+}
+
 } // namespace tpp
 } // namespace torch_ipex
 
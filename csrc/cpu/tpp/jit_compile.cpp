@@ -1,12 +1,103 @@
 #include "jit_compile.h"
 #include <dlfcn.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include "version.h"
 
 namespace torch_ipex {
 namespace tpp {
+
+// The compiled shared objects are cached in TPP_JIT_CACHE_DIR
+// (~/.cache/ipex_tpp_jit by default, TPP_JIT_CACHE=0 to disable), named by
+// the hash of the compiler (TPP_JIT_CXX, g++ by default) and its version, the
+// IPEX build, the flags and the source, so that the next processes dlopen
+// them directly. The source is hashed without the headers it includes, the
+// libxsmm and TPP headers of which come with the IPEX build.
+namespace {
+
+std::string jit_compiler() {
+  const char* cxx = getenv("TPP_JIT_CXX");
+  return cxx != NULL && cxx[0] != '\0' ? cxx : "g++";
+}
+
+// the compiler and its version, for the key of the cache
+std::string jit_compiler_id() {
+  static std::string id = [] {
+    auto cxx = jit_compiler();
+    std::string version;
+    FILE* pipe = popen((cxx + " --version 2>/dev/null").c_str(), "r");
+    if (pipe != NULL) {
+      char line[256];
+      if (fgets(line, sizeof(line), pipe) != NULL)
+        version = line;
+      pclose(pipe);
+    }
+    return cxx + " " + version;
+  }();
+  return id;
+}
+
+// empty when the cache is disabled
+std::string jit_cache_dir() {
+  const char* enabled = getenv("TPP_JIT_CACHE");
+  if (enabled != NULL && atoi(enabled) == 0)
+    return "";
+  const char* dir = getenv("TPP_JIT_CACHE_DIR");
+  if (dir != NULL && dir[0] != '\0')
+    return dir;
+  const char* home = getenv("HOME");
+  if (home == NULL)
+    return "";
+  std::string cache = std::string(home) + "/.cache";
+  mkdir(cache.c_str(), 0755);
+  return cache + "/ipex_tpp_jit";
+}
+
+// the version and the commit of the IPEX build, whose headers the sources
+// include
+std::string jit_build_id() {
+  return torch_ipex::__version__() + " " + torch_ipex::__gitrev__();
+}
+
+// FNV-1a, stable across processes and builds
+std::string content_hash(const std::string& str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+  return buf;
+}
+
+bool compile(
+    const std::string& filename,
+    const std::string& flags,
+    const std::string& output) {
+  auto cmd = jit_compiler() + " -shared -fPIC -x c++ " + flags;
+  cmd = cmd + " -o " + output + " " + filename;
+  printf("JIT COMPILE: %s\n", cmd.c_str());
+  return system(cmd.c_str()) == 0;
+}
+
+void* load(const std::string& libname) {
+  auto handle = dlopen(libname.c_str(), RTLD_LAZY | RTLD_NODELETE);
+  if (!handle) {
+    fputs(dlerror(), stderr);
+    return NULL;
+  }
+  return handle;
+}
+
+} // namespace
+
 void* jit_compile_and_load(
     const std::string filename,
     const std::string flags) {
@@ -15,25 +106,44 @@ void* jit_compile_and_load(
   unlink(libname);
   char fdname[50];
   sprintf(fdname, "/proc/self/fd/%d", fd);
-  auto cmd = std::string("g++ -shared -fPIC -x c++ ") + flags;
-  cmd = cmd + " -o " + fdname + " " + filename;
-  printf("JIT COMPILE: %s\n", cmd.c_str());
-  int ret = system(cmd.c_str());
-  if (ret != 0)
-    return NULL;
-  auto handle = dlopen(fdname, RTLD_LAZY | RTLD_NODELETE);
-  if (!handle) {
-    fputs(dlerror(), stderr);
+  if (!compile(filename, flags, fdname))
     return NULL;
+  return load(fdname);
+}
+
+// Loads the cached shared object of src, else compiles filename (the file of
+// src) into the cache. The object is written to a temporary file and renamed,
+// so that concurrent processes never load a partial one.
+void* jit_compile_and_load_cached(
+    const std::string& src,
+    const std::string& filename,
+    const std::string& flags) {
+  auto dir = jit_cache_dir();
+  if (dir.empty())
+    return jit_compile_and_load(filename, flags);
+  auto key = jit_compiler_id() + "\n" + jit_build_id() + "\n" + flags + "\n" +
+      src;
+  auto libname = dir + "/" + content_hash(key) + ".so";
+  if (access(libname.c_str(), R_OK) == 0) {
+    auto handle = load(libname);
+    if (handle)
+      return handle;
   }
-  return handle;
+  mkdir(dir.c_str(), 0755);
+  auto tmpname = libname + ".XXXXXX";
+  int fd = mkstemp(&tmpname[0]);
+  if (fd < 0)
+    return jit_compile_and_load(filename, flags);
+  close(fd);
+  if (!compile(filename, flags, tmpname) ||
+      rename(tmpname.c_str(), libname.c_str()) != 0) {
+    unlink(tmpname.c_str());
+    return jit_compile_and_load(filename, flags);
+  }
+  return load(libname);
 }
 
-void* jit_from_file(
-    const std::string filename,
-    const std::string flags,
-    const std::string func_name) {
-  void* handle = jit_compile_and_load(filename, flags);
+void* jit_symbol(void* handle, const std::string func_name) {
   if (handle == NULL)
     return NULL;
   void* func = dlsym(handle, func_name.c_str());
@@ -44,6 +154,17 @@ void* jit_from_file(
   return func;
 }
 
+void* jit_from_file(
+    const std::string filename,
+    const std::string flags,
+    const std::string func_name) {
+  std::ifstream ifs(filename);
+  std::stringstream src;
+  src << ifs.rdbuf();
+  return jit_symbol(
+      jit_compile_and_load_cached(src.str(), filename, flags), func_name);
+}
+
 void* jit_from_str(
     const std::string src,
     const std::string flags,
@@ -54,7 +175,9 @@ void* jit_from_str(
   char fdname[50];
   sprintf(fdname, "/proc/self/fd/%d", fd);
   write(fd, src.c_str(), src.length());
-  return jit_from_file(fdname, flags, func_name);
+  auto handle = jit_compile_and_load_cached(src, fdname, flags);
+  close(fd);
+  return jit_symbol(handle, func_name);
 }
 } // namespace tpp
-} // namespace torch_ipex
\ No newline at end of file
+} // namespace torch_ipex
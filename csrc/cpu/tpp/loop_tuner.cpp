@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "threaded_loops.h"
+#include "utils.h"
+
+namespace torch_ipex {
+namespace tpp {
+
+namespace {
+
+std::mutex tuner_mutex;
+bool cache_loaded = false;
+// key -> index of the schedule, the keys of the CPU model of this process
+std::unordered_map<std::string, int> schedule_cache;
+
+std::string cpu_model() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      auto pos = line.find(':');
+      if (pos != std::string::npos)
+        return line.substr(line.find_first_not_of(" \t", pos + 1));
+    }
+  }
+  return "unknown";
+}
+
+std::string cache_file() {
+  const char* path = getenv("TPP_LOOP_CACHE");
+  if (path != NULL)
+    return path;
+  const char* home = getenv("HOME");
+  return std::string(home != NULL ? home : ".") +
+      "/.cache/ipex_tpp_loops.txt";
+}
+
+// The lines of the cache are "<cpu model>\t<key>@<threads>\t<index>", the
+// last line of a key winning
+void load_cache() {
+  if (cache_loaded)
+    return;
+  cache_loaded = true;
+  auto model = cpu_model();
+  std::ifstream ifs(cache_file());
+  std::string line;
+  while (std::getline(ifs, line)) {
+    auto t1 = line.find('\t');
+    auto t2 = line.rfind('\t');
+    if (t1 == std::string::npos || t1 == t2 || line.substr(0, t1) != model)
+      continue;
+    schedule_cache[line.substr(t1 + 1, t2 - t1 - 1)] =
+        atoi(line.c_str() + t2 + 1);
+  }
+}
+
+std::string thread_key(const std::string& key) {
+  return key + "@" + std::to_string(omp_get_max_threads());
+}
+
+} // namespace
+
+bool loop_autotune_enabled() {
+  static bool enabled = [] {
+    const char* str = getenv("TPP_LOOP_AUTOTUNE");
+    return str != NULL && atoi(str) > 0;
+  }();
+  return enabled;
+}
+
+int loop_autotune_reps() {
+  static int reps = [] {
+    const char* str = getenv("TPP_LOOP_AUTOTUNE_REPS");
+    int r = str != NULL ? atoi(str) : 0;
+    return r > 0 ? r : 3;
+  }();
+  return reps;
+}
+
+int lookup_loop_schedule(const std::string& key) {
+  std::lock_guard<std::mutex> guard(tuner_mutex);
+  load_cache();
+  auto search = schedule_cache.find(thread_key(key));
+  if (search == schedule_cache.end())
+    return -1;
+  return search->second;
+}
+
+void store_loop_schedule(const std::string& key, int index) {
+  std::lock_guard<std::mutex> guard(tuner_mutex);
+  load_cache();
+  auto tkey = thread_key(key);
+  schedule_cache[tkey] = index;
+  // only the first rank writes, the ranks of a node sharing the file
+  if (guess_mpi_rank() != 0)
+    return;
+  auto path = cache_file();
+  auto dir = path.rfind('/');
+  if (dir != std::string::npos && dir > 0)
+    mkdir(path.substr(0, dir).c_str(), 0755);
+  std::ofstream ofs(path, std::ofstream::app);
+  if (!ofs) {
+    printf("TPP loop autotune: unable to write %s\n", path.c_str());
+    return;
+  }
+  ofs << cpu_model() + "\t" + tkey + "\t" + std::to_string(index) + "\n";
+}
+
+} // namespace tpp
+} // namespace torch_ipex
@@ -1,7 +1,6 @@
 //#include "init.h"
-#ifdef ENABLE_RTM
 #include "rtm.h"
-#endif
+#include "sparse_update.h"
 #include "timing.h"
 #include "xsmm_functors.h"
 
@@ -13,6 +12,8 @@
 
 #include <atomic>
 
+int rtm_stats[1000][16];
+
 namespace torch_ipex {
 namespace tpp {
 
@@ -76,15 +77,43 @@ REGISTER_SCOPE(splt_adamw, "splt_adamw");
 REGISTER_SCOPE(splt_lamb, "splt_lamb");
 REGISTER_SCOPE(grad_norm, "grad_norm");
 
+std::vector<long> get_rtm_stats() {
+  std::vector<long> total(NUM_RTM_STATS, 0);
+  int rtm_max_threads = omp_get_max_threads();
+  for (int i = 0; i < rtm_max_threads; i++) {
+    for (int j = 0; j < NUM_RTM_STATS; j++) {
+      total[j] += rtm_stats[i][j];
+    }
+  }
+  return total;
+}
+
+void reset_rtm_stats() {
+  clear_rtm_stats();
+}
+
+bool sparse_update_use_rtm(ScatterAddState& state) {
+  static bool enabled = [] {
+    char* str = getenv("TPP_SPARSE_UPDATE_RTM");
+    return rtm_available() && (str == NULL || atoi(str) > 0);
+  }();
+  static double max_abort_rate = [] {
+    char* str = getenv("TPP_RTM_MAX_ABORT_RATE");
+    return str != NULL ? atof(str) : 0.3;
+  }();
+  if (!enabled)
+    return false;
+  if (state.abort_rate <= max_abort_rate)
+    return true;
+  // retry RTM every 64 calls, the conflicts of the updates may have changed
+  return ++state.calls % 64 == 0;
+}
+
 static int sparse_add_use_lock_free() {
   static int lock_free = -1;
   if (lock_free != -1)
     return lock_free;
-#ifdef ENABLE_RTM
-  char* str = getenv("PCL_USE_RTM_UPDATE");
-#else
-  char* str = NULL;
-#endif
+  char* str = rtm_available() ? getenv("PCL_USE_RTM_UPDATE") : NULL;
   if (str && atoi(str) > 0) {
     lock_free = 0;
     printf("PCL_SPARSE_ADD: Using RTM Based Update\n");
@@ -117,44 +146,10 @@ void dense_sparse_add_tmpl(
 
   auto embbag_upd = ScaleAddTPP<scalar_t, scalar_t>(E);
 
-  int max_thr = omp_get_max_threads();
-  int use_lock_free = sparse_add_use_lock_free();
-  if (use_lock_free) {
-    int nthr = max_thr;
-    if (M < nthr)
-      nthr = M;
-#pragma omp parallel num_threads(nthr)
-    {
-      int tid = omp_get_thread_num();
-      long j_begin = (tid * M) / nthr;
-      long j_end = ((tid + 1) * M) / nthr;
-      for (long i = 0; i < NS; i++) {
-        auto ind = indices[i];
-        if (ind >= j_begin && ind < j_end) {
-          auto wa = &dense[ind * E];
-          auto va = &values[i * E];
-          embbag_upd(va, wa, lr);
-        }
-      }
-    }
-  } else {
-#ifdef ENABLE_RTM
-    SimpleSpinLock fallBackLock;
-#pragma omp parallel for
-    for (int i = 0; i < NS; i++) {
-      auto ind = indices[i];
-      auto wa = &dense[ind * E];
-      auto va = &values[i * E];
-      {
-        TransactionScope guard(fallBackLock, 100);
-        embbag_upd(va, wa, lr);
-      }
-    }
-#else
-    printf("Please compile with ENABLE_RTM set\n");
-    exit(1);
-#endif
-  }
+  static ScatterAddState state;
+  scatter_add_rows(state, dense, M, E, NS, indices, [&](long i, auto* row) {
+    embbag_upd(&values[i * E], row, lr);
+  });
 }
 
 void dense_sparse_add_(
@@ -218,23 +213,22 @@ void bf16_split_add_(
         }
       }
     } else {
-#ifdef ENABLE_RTM
       SimpleSpinLock fallBackLock;
-#pragma omp parallel for
-      for (long i = 0; i < NS; i++) {
-        auto ind = indices_data[i];
-        auto ha = &hi_data[ind * E];
-        auto la = &lo_data[ind * E];
-        auto va = &values_data[i * E];
-        {
-          TransactionScope guard(fallBackLock, 100);
-          split_sgd_kernel((at::BFloat16*)ha, (at::BFloat16*)la, va, lr);
+#pragma omp parallel
+      {
+        int tid = omp_get_thread_num();
+#pragma omp for
+        for (long i = 0; i < NS; i++) {
+          auto ind = indices_data[i];
+          auto ha = &hi_data[ind * E];
+          auto la = &lo_data[ind * E];
+          auto va = &values_data[i * E];
+          {
+            TransactionScope guard(fallBackLock, 100, tid);
+            split_sgd_kernel((at::BFloat16*)ha, (at::BFloat16*)la, va, lr);
+          }
         }
       }
-#else
-      printf("Please compile with ENABLE_RTM set\n");
-      exit(1);
-#endif
     }
   } else {
     RECORD_SCOPE(split_sgd_dense, {hi_bits});
@@ -274,7 +268,8 @@ void fused_adamw(
     float step_size,
     float lr,
     float weight_decay,
-    float eps) {
+    float eps,
+    float grad_scale) {
   GlobalPass _gp(UPD);
   RECORD_SCOPE(fused_adamw, {t_data});
   typedef float T;
@@ -291,12 +286,26 @@ void fused_adamw(
   long i;
 #pragma omp parallel for lastprivate(i)
   for (i = 0; i < ALIGNDOWN(sz, BS); i += BS) {
-    adamw_tpp(&data[i], &grad[i], &exp_avg[i], &exp_avg_sq[i], step_size, lr);
+    adamw_tpp(
+        &data[i],
+        &grad[i],
+        &exp_avg[i],
+        &exp_avg_sq[i],
+        step_size,
+        lr,
+        grad_scale);
   }
   if (i < sz) {
     auto adamw_tpp = SCOPEIT(
         FusedAdamWTPP<T>(sz - i, beta1, beta2, weight_decay, eps), OPTIM);
-    adamw_tpp(&data[i], &grad[i], &exp_avg[i], &exp_avg_sq[i], step_size, lr);
+    adamw_tpp(
+        &data[i],
+        &grad[i],
+        &exp_avg[i],
+        &exp_avg_sq[i],
+        step_size,
+        lr,
+        grad_scale);
   }
 }
 
@@ -311,7 +320,8 @@ void fused_split_adamw(
     float step_size,
     float lr,
     float weight_decay,
-    float eps) {
+    float eps,
+    float grad_scale) {
   GlobalPass _gp(UPD);
   RECORD_SCOPE(splt_adamw, {t_data_hi});
   typedef bfloat16 T;
@@ -336,7 +346,8 @@ void fused_split_adamw(
         &exp_avg[i],
         &exp_avg_sq[i],
         step_size,
-        lr);
+        lr,
+        grad_scale);
   }
   if (i < sz) {
     auto split_adamw_tpp = SCOPEIT(
@@ -348,7 +359,8 @@ void fused_split_adamw(
         &exp_avg[i],
         &exp_avg_sq[i],
         step_size,
-        lr);
+        lr,
+        grad_scale);
   }
 }
 
@@ -384,7 +396,7 @@ void tensor_scale(T* ptr, long N, float scale) {
   }
 }
 
-double clip_grad_norm(std::vector<at::Tensor>& grads, double max_norm) {
+double grad_norm(std::vector<at::Tensor>& grads) {
   GlobalPass _gp(UPD);
   RECORD_SCOPE(grad_norm);
   double total_norm = 0.0;
@@ -399,8 +411,13 @@ double clip_grad_norm(std::vector<at::Tensor>& grads, double max_norm) {
       PCL_ASSERT(0, "Unsupported data type");
     }
   }
+  return sqrt(total_norm);
+}
 
-  total_norm = sqrt(total_norm);
+double clip_grad_norm(std::vector<at::Tensor>& grads, double max_norm) {
+  double total_norm = grad_norm(grads);
+  GlobalPass _gp(UPD);
+  int N = grads.size();
   float clip_coef = max_norm / (total_norm + 1e-6);
   if (clip_coef < 1.0) {
     for (int i = 0; i < N; i++) {
@@ -527,7 +544,8 @@ void fused_lamb_v2_impl(
     float eps,
     int block_size,
     int step,
-    bool fused_param_norm) {
+    bool fused_param_norm,
+    float grad_scale) {
   const int BS = block_size;
   auto num_blocks = t_data.numel() / block_size;
   DECL_VLA_PTR_PT(T, d, [BS], t_data);
@@ -566,7 +584,8 @@ void fused_lamb_v2_impl(
     float wd = weight_decay;
     bool use_wd = (wd > 0.0);
     if (use_wd) {
-      adam_step_wwd_tpp(d[i], g[i], m[i], v[i], u[i], wd, b1_scale, b2_scale);
+      adam_step_wwd_tpp(
+          d[i], g[i], m[i], v[i], u[i], wd, b1_scale, b2_scale, grad_scale);
       norm_tpp(d[i], &wt_norm);
       norm_tpp(u[i], &adam_norm);
       if (!fused_param_norm) {
@@ -576,7 +595,8 @@ void fused_lamb_v2_impl(
       fused_adam_norm += adam_norm;
       fused_weight_norm += wt_norm;
     } else {
-      adam_step_nwd_tpp(d[i], g[i], m[i], v[i], u[i], wd, b1_scale, b2_scale);
+      adam_step_nwd_tpp(
+          d[i], g[i], m[i], v[i], u[i], wd, b1_scale, b2_scale, grad_scale);
     }
   }
   if (weight_decay > 0.0) {
@@ -635,7 +655,8 @@ void fused_lamb_v2(
     float eps,
     int block_size,
     int step,
-    bool fused_param_norm) {
+    bool fused_param_norm,
+    float grad_scale) {
   GlobalPass _gp(UPD);
   RECORD_SCOPE(fused_lamb, {t_data});
 
@@ -660,7 +681,8 @@ void fused_lamb_v2(
           eps,
           block_size,
           step,
-          fused_param_norm);
+          fused_param_norm,
+          grad_scale);
     } else if (t_data.dtype() == at::kBFloat16) {
       fused_lamb_v2_impl<bfloat16, float>(
           t_data,
@@ -681,7 +703,8 @@ void fused_lamb_v2(
           eps,
           block_size,
           step,
-          fused_param_norm);
+          fused_param_norm,
+          grad_scale);
     } else {
       PCL_ASSERT(0, "Should not come here\n");
     }
@@ -706,7 +729,8 @@ void fused_lamb_v2(
           eps,
           block_size,
           step,
-          fused_param_norm);
+          fused_param_norm,
+          grad_scale);
     } else if (t_data.dtype() == at::kBFloat16) {
       fused_lamb_v2_impl<bfloat16, double>(
           t_data,
@@ -727,7 +751,8 @@ void fused_lamb_v2(
           eps,
           block_size,
           step,
-          fused_param_norm);
+          fused_param_norm,
+          grad_scale);
     } else {
       PCL_ASSERT(0, "Should not come here\n");
     }
@@ -25,7 +25,8 @@ void fused_adamw(
     float step_size,
     float lr,
     float weight_decay,
-    float eps);
+    float eps,
+    float grad_scale);
 
 void fused_split_adamw(
     at::Tensor& t_data_hi,
@@ -38,7 +39,11 @@ void fused_split_adamw(
     float step_size,
     float lr,
     float weight_decay,
-    float eps);
+    float eps,
+    float grad_scale);
+
+// The 2-norm of the grads, as if they were concatenated
+double grad_norm(std::vector<at::Tensor>& grads);
 
 double clip_grad_norm(std::vector<at::Tensor>& grads, double max_norm);
 
@@ -73,7 +78,14 @@ void fused_lamb_v2(
     float eps,
     int block_size,
     int step,
-    bool fused_param_norm);
+    bool fused_param_norm,
+    float grad_scale);
+
+// The sums over the threads of the RTM counters of rtm.h (attempts, aborts,
+// fall back locks, ...) of the sparse updates
+std::vector<long> get_rtm_stats();
+
+void reset_rtm_stats();
 
 } // namespace tpp
 
@@ -1,10 +1,17 @@
+#ifndef _TPP_RTM_H_
+#define _TPP_RTM_H_
+
+#include <cpuid.h>
 #include <immintrin.h>
 #include <stdio.h>
 #include <iostream>
 
-#ifdef RTM_DEBUG
+// The transactions are compiled for RTM whatever the flags of the build, only
+// to run when rtm_available()
+#define RTM_TARGET __attribute__((target("rtm")))
+
+// per thread, the counters below
 extern int rtm_stats[1000][16];
-#endif
 #define ATTEMPTS 0
 #define ABORTS 1
 #define LOCKS 2
@@ -14,20 +21,30 @@ extern int rtm_stats[1000][16];
 #define ABORTS_TIMEOUT 6
 #define ABORTS_EXPLICIT 7
 #define ABORTS_ZERO 8
+#define NUM_RTM_STATS 9
+
+// CPUID reports RTM, and the microcode doesn't abort all the transactions
+inline bool rtm_available() {
+  static bool available = [] {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+      return false;
+    // ebx[11]: RTM, edx[11]: RTM_ALWAYS_ABORT
+    return (ebx & (1 << 11)) != 0 && (edx & (1 << 11)) == 0;
+  }();
+  return available;
+}
 
 inline void clear_rtm_stats() {
-#ifdef RTM_DEBUG
   int rtm_max_threads = omp_get_max_threads();
   for (int i = 0; i < rtm_max_threads; i++) {
     for (int j = 0; j < 16; j++) {
       rtm_stats[i][j] = 0;
     }
   }
-#endif
 }
 
 inline void print_rtm_stats() {
-#ifdef RTM_DEBUG
   int rtm_max_threads = omp_get_max_threads();
   int total[16] = {0};
   for (int i = 0; i < rtm_max_threads; i++) {
@@ -64,7 +81,6 @@ inline void print_rtm_stats() {
       total[ABORTS_RETRY],
       total[ABORTS_NORETRY],
       total[ABORTS_TIMEOUT]);
-#endif
 }
 
 class SimpleSpinLock {
@@ -87,18 +103,14 @@ class SimpleSpinLock {
     return state == Busy;
   }
 };
-#ifdef RTM_DEBUG
 #define INC_RTM_DEBUG_COUNT(tid, x) rtm_stats[tid][x]++
-#else
-#define INC_RTM_DEBUG_COUNT(tid, x)
-#endif
 
 class TransactionScope {
   SimpleSpinLock& fallBackLock;
 
   TransactionScope(); // forbidden
  public:
-  TransactionScope(
+  RTM_TARGET TransactionScope(
       SimpleSpinLock& fallBackLock_,
       int max_retries = 10,
       int tid = 0)
@@ -141,7 +153,7 @@ class TransactionScope {
     INC_RTM_DEBUG_COUNT(tid, LOCKS);
   }
 
-  ~TransactionScope() {
+  RTM_TARGET ~TransactionScope() {
     if (fallBackLock.isLocked()) {
       fallBackLock.unlock();
     } else {
@@ -151,3 +163,5 @@ class TransactionScope {
 };
 
 #undef INC_RTM_DEBUG_COUNT
+
+#endif // _TPP_RTM_H_
@@ -0,0 +1,110 @@
+#ifndef _TPP_SPARSE_UPDATE_H_
+#define _TPP_SPARSE_UPDATE_H_
+
+#include <omp.h>
+#include <unordered_map>
+#include <vector>
+#include "timing.h"
+#include "optim.h"
+#include "rtm.h"
+
+namespace torch_ipex {
+namespace tpp {
+
+// The abort rate of the last RTM scatter-add of a call site, and the calls
+// since, to retry RTM every so often after falling back to the privatized
+// buffers
+struct ScatterAddState {
+  double abort_rate = 0.0;
+  long calls = 0;
+};
+
+// Uses RTM for the next scatter-add of state: when available (and not
+// disabled by TPP_SPARSE_UPDATE_RTM=0), while the abort rate stays below
+// TPP_RTM_MAX_ABORT_RATE (0.3 by default)
+bool sparse_update_use_rtm(ScatterAddState& state);
+
+// Runs upd(i, row) for the n updates i of the rows[i] (skipped when negative)
+// of a dense [M][E] table, row pointing either to the row of the table or,
+// when upd accumulates into a zeroed row, to a float partial row, so that upd
+// is generic over T and float. The updates from all the threads run within
+// RTM transactions, with a spin lock fall back, else (no RTM or too many
+// aborts) into per-thread partial rows of the rows they touch, which the
+// owner threads of the rows then add into the table.
+template <typename T, typename F>
+void scatter_add_rows(
+    ScatterAddState& state,
+    T* dense,
+    long M,
+    long E,
+    long n,
+    const long* rows,
+    const F& upd) {
+  if (n == 0)
+    return;
+  if (sparse_update_use_rtm(state)) {
+    auto before = get_rtm_stats();
+    SimpleSpinLock fallBackLock;
+#pragma omp parallel
+    {
+      int tid = omp_get_thread_num();
+#pragma omp for
+      for (long i = 0; i < n; i++) {
+        if (rows[i] < 0)
+          continue;
+        TransactionScope guard(fallBackLock, 100, tid);
+        upd(i, dense + rows[i] * E);
+      }
+    }
+    auto after = get_rtm_stats();
+    long attempts = after[ATTEMPTS] - before[ATTEMPTS];
+    long aborts = after[ABORTS] - before[ABORTS];
+    state.abort_rate = attempts > 0 ? (double)aborts / attempts : 0.0;
+    return;
+  }
+  int max_threads = omp_get_max_threads();
+  std::vector<std::vector<long>> prv_rows(max_threads);
+  std::vector<std::vector<float>> prv_bufs(max_threads);
+#pragma omp parallel
+  {
+    int tid = omp_get_thread_num();
+    int nthr = omp_get_num_threads();
+    auto& my_rows = prv_rows[tid];
+    auto& my_buf = prv_bufs[tid];
+    std::unordered_map<long, long> slots;
+    for (long i = n * tid / nthr; i < n * (tid + 1) / nthr; i++) {
+      if (rows[i] < 0)
+        continue;
+      long slot = my_rows.size();
+      auto search = slots.find(rows[i]);
+      if (search == slots.end()) {
+        slots[rows[i]] = slot;
+        my_rows.push_back(rows[i]);
+        my_buf.resize((slot + 1) * E, 0.0f);
+      } else {
+        slot = search->second;
+      }
+      upd(i, my_buf.data() + slot * E);
+    }
+#pragma omp barrier
+    ScopedTimer _t(EW_RED);
+    long j_begin = M * tid / nthr;
+    long j_end = M * (tid + 1) / nthr;
+    for (int t = 0; t < nthr; t++) {
+      for (size_t slot = 0; slot < prv_rows[t].size(); slot++) {
+        auto row = prv_rows[t][slot];
+        if (row < j_begin || row >= j_end)
+          continue;
+        auto src = prv_bufs[t].data() + slot * E;
+        auto dst = dense + row * E;
+        for (long e = 0; e < E; e++)
+          dst[e] = (float)dst[e] + src[e];
+      }
+    }
+  }
+}
+
+} // namespace tpp
+} // namespace torch_ipex
+
+#endif // _TPP_SPARSE_UPDATE_H_
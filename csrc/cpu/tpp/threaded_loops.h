@@ -4,12 +4,14 @@
 #include <stdio.h>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "jit_compile.h"
 #include "par_loop_generator.h"
 
@@ -279,6 +281,95 @@ class ThreadedLoop {
   std::string scheme;
   LoopingScheme* loopScheme;
 };
+// A candidate schedule of a TunedThreadedLoop, the loop order of the scheme
+// and the blockings of the bounds
+template <int N>
+struct LoopSchedule {
+  std::string scheme;
+  std::array<LoopSpecs, N> bounds;
+};
+
+// The loop autotuning (TPP_LOOP_AUTOTUNE=1) picks the fastest schedule of a
+// tuned loop for its shape and number of threads on its first call, and keeps
+// it in the TPP_LOOP_CACHE file (~/.cache/ipex_tpp_loops.txt by default) per
+// CPU model, for the next processes.
+bool loop_autotune_enabled();
+int loop_autotune_reps();
+// The index of the cached schedule of the key, -1 when not tuned yet
+int lookup_loop_schedule(const std::string& key);
+void store_loop_schedule(const std::string& key, int index);
+
+template <int N>
+class TunedThreadedLoop {
+ public:
+  // The schedules must be equivalent for the body, and the body must give the
+  // same results when run again, as the tuning runs it with each of them. The
+  // first schedule is the one used without autotuning.
+  TunedThreadedLoop(std::string name, std::vector<LoopSchedule<N>> schedules)
+      : schedules(schedules), key(name), selected(0) {
+    assert(schedules.size() > 0);
+    for (auto& schedule : schedules) {
+      key += ":" + schedule.scheme;
+    }
+    for (auto& b : schedules[0].bounds) {
+      key += ":" + std::to_string(b.start) + "," + std::to_string(b.end) +
+          "," + std::to_string(b.step);
+    }
+    if (schedules.size() > 1 && loop_autotune_enabled()) {
+      selected = lookup_loop_schedule(key);
+      if (selected >= (int)schedules.size())
+        selected = -1;
+    }
+  }
+
+  template <class T>
+  void operator()(T func) {
+    run(func, NULL, NULL);
+  }
+  template <class T, class Ti, class Tf>
+  void operator()(T func, Ti init, Tf fini) {
+    run(func, init, fini);
+  }
+
+ private:
+  void run(loop_func func, init_func init, fini_func fini) {
+    if (selected >= 0) {
+      call(selected, func, init, fini);
+      return;
+    }
+    int best = 0;
+    double best_time = 0.0;
+    for (int i = 0; i < (int)schedules.size(); i++) {
+      // the first run compiles the scheme and warms up the caches
+      call(i, func, init, fini);
+      double t = 0.0;
+      for (int r = 0; r < loop_autotune_reps(); r++) {
+        auto start = std::chrono::steady_clock::now();
+        call(i, func, init, fini);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < t)
+          t = elapsed.count();
+      }
+      if (i == 0 || t < best_time) {
+        best = i;
+        best_time = t;
+      }
+    }
+    selected = best;
+    store_loop_schedule(key, best);
+  }
+
+  void call(int i, loop_func func, init_func init, fini_func fini) {
+    auto& schedule = schedules[i];
+    getLoopingScheme(schedule.scheme)
+        ->call(schedule.bounds.data(), func, init, fini);
+  }
+
+  std::vector<LoopSchedule<N>> schedules;
+  std::string key;
+  int selected;
+};
 } // namespace tpp
 } // namespace torch_ipex
 
@@ -2,6 +2,7 @@
 #define _BERT_TIMING_H_
 
 #include "utils.h"
+#include "utils/memory_tracker.h"
 namespace torch_ipex {
 namespace tpp {
 enum DebugTimer {
@@ -55,12 +56,17 @@ extern int globalScope;
 constexpr int NUM_TIMERS = ((LAST_TIMER + 7) / 8) * 8;
 extern double pass_timers[MAX_THREADS][3][NUM_TIMERS];
 extern double master_pass_timers[3];
+// set from python, the TPPs are then recorded as PyTorch profiler events
+extern bool tpp_profiler_events;
 struct Scope {
-  Scope(std::string const& name) : name(name) {}
+  Scope(std::string const& name)
+      : name(name), master_timer(0), detailed_timers{}, flops{}, bytes{} {}
   const std::string name;
   double master_timer;
   double detailed_timers[MAX_THREADS][NUM_TIMERS];
   double flops[MAX_THREADS][8];
+  // the operand bytes of the TPPs which report them
+  double bytes[MAX_THREADS][NUM_TIMERS];
 };
 
 inline std::vector<Scope>& get_scope_list() {
@@ -88,7 +94,8 @@ inline int register_scope(std::string name) {
 
 class ScopedTimer {
  public:
-  ScopedTimer(DebugTimer t, long f = 0) : type(t), flops(f), start(getTime()) {}
+  ScopedTimer(DebugTimer t, long f = 0, long b = 0)
+      : type(t), flops(f), bytes(b), start(getTime()) {}
   ~ScopedTimer() {
     auto time = getTime() - start;
     int tid = omp_get_thread_num();
@@ -96,6 +103,7 @@ class ScopedTimer {
     pass.detailed_timers[tid][type] += time;
     if (type == BRGEMM)
       pass.flops[tid][0] += flops;
+    pass.bytes[tid][type] += bytes;
     if (globalPass == 0 && tid == 0)
       pass.master_timer += time;
 
@@ -103,11 +111,13 @@ class ScopedTimer {
     scope.detailed_timers[tid][type] += time;
     if (type == BRGEMM)
       scope.flops[tid][0] += flops;
+    scope.bytes[tid][type] += bytes;
     if (globalScope == 0 && tid == 0)
       scope.master_timer += time;
   }
   DebugTimer type;
   long flops;
+  long bytes;
   double start;
 };
 
@@ -151,13 +161,38 @@ class GlobalPass {
   double start;
 };
 
+// The bytes of a TPP call, for the TPPs which have a bytes() method
+template <typename T>
+inline auto tpp_bytes(T& func, int) -> decltype(func.bytes()) {
+  return func.bytes();
+}
+template <typename T>
+inline long tpp_bytes(T& func, long) {
+  return 0;
+}
+
+// A profiler event of a TPP call, when tpp_profiler_events is set and the
+// profiler records on this thread
+class TPPRecordFunction {
+ public:
+  TPPRecordFunction(DebugTimer t) {
+    if (tpp_profiler_events) {
+      rf.emplace(at::RecordScope::USER_SCOPE);
+      if (rf->isActive())
+        rf->before(DebugTimerName(t));
+    }
+  }
+  c10::optional<at::RecordFunction> rf;
+};
+
 template <typename T, int impl = 0>
 class ScopedTPP {
  public:
   ScopedTPP(T func, DebugTimer t) : func(std::move(func)), t(t) {}
   template <typename... Types>
   void operator()(Types... vars) {
-    ScopedTimer _t(t);
+    TPPRecordFunction _rf(t);
+    ScopedTimer _t(t, 0, tpp_bytes(func, 0));
     if (impl == 0) {
       func(vars...);
     } else if (impl == 1) {
@@ -184,8 +219,9 @@ class ScopedTPP {
 #define SCOPEIT(f, t) f
 #endif
 
-#define RECORD_SCOPE(scope, ...) \
-  GlobalScope gs_(sc_##scope);   \
+#define RECORD_SCOPE(scope, ...)                                \
+  GlobalScope gs_(sc_##scope);                                  \
+  torch_ipex::utils::MemoryScope memory_scope_("tpp::" #scope); \
   RECORD_FUNCTION(#scope, std::vector<c10::IValue>(__VA_ARGS__))
 
 } // namespace tpp
@@ -6,6 +6,8 @@
 //#include <torch/extension.h>
 
 #include <iostream>
+#include <string>
+#include <tuple>
 #include <vector>
 #ifdef _OPENMP
 #include <omp.h>
@@ -45,6 +47,21 @@ unsigned int* get_rng_state();
 void init_libxsmm();
 void xsmm_manual_seed(unsigned int seed);
 
+// The TPP timers of a scope (or pass): its name, its time in seconds, the
+// per-thread seconds [threads][timers], the per-thread BRGEMM flops and the
+// per-thread operand bytes [threads][timers]
+typedef std::tuple<
+    std::string,
+    double,
+    std::vector<std::vector<double>>,
+    std::vector<double>,
+    std::vector<std::vector<double>>>
+    ScopeTimers;
+std::vector<std::string> get_debug_timer_names();
+std::vector<ScopeTimers> get_debug_timers(bool passes);
+void reset_debug_timers();
+void set_tpp_profiler_events(bool enabled);
+
 #ifdef __x86_64__
 static __inline__ unsigned long long rdtsc(void) {
   unsigned hi, lo;
@@ -15,6 +15,8 @@
 #include <string>
 #include <unordered_map>
 
+#include "aten/utils/amx_tile.h"
+
 namespace torch_ipex {
 namespace tpp {
 
@@ -31,6 +33,9 @@ namespace tpp {
 
 typedef at::BFloat16 bfloat16;
 typedef at::Half half;
+// fp8 in the names of libxsmm, bf8 is E5M2 and hf8 is E4M3
+typedef at::Float8_e5m2 bfloat8;
+typedef at::Float8_e4m3fn hfloat8;
 inline float upconvert_to_float(float val) {
   return val;
 }
@@ -40,6 +45,12 @@ inline float upconvert_to_float(bfloat16 val) {
 inline float upconvert_to_float(half val) {
   return (float)val;
 }
+inline float upconvert_to_float(bfloat8 val) {
+  return (float)val;
+}
+inline float upconvert_to_float(hfloat8 val) {
+  return (float)val;
+}
 template <typename T>
 inline libxsmm_datatype XsmmDtype();
 template <>
@@ -62,6 +73,14 @@ template <>
 inline libxsmm_datatype XsmmDtype<half>() {
   return LIBXSMM_DATATYPE_F16;
 }
+template <>
+inline libxsmm_datatype XsmmDtype<bfloat8>() {
+  return LIBXSMM_DATATYPE_BF8;
+}
+template <>
+inline libxsmm_datatype XsmmDtype<hfloat8>() {
+  return LIBXSMM_DATATYPE_HF8;
+}
 
 #ifdef __AVX512F__
 inline __m512 _mm512_loadu_ps_auto(float const* mem_addr) {
@@ -514,6 +533,10 @@ class SetZeroTPP {
     }
   }
 
+  long bytes() {
+    return (long)rows * cols * sizeof(T);
+  }
+
  private:
   int rows = 0;
   int cols = 0;
@@ -560,6 +583,10 @@ class ConvertTPP {
     return init_done;
   }
 
+  long bytes() {
+    return (long)rows * cols * (sizeof(Tin) + sizeof(Tout));
+  }
+
  private:
   int rows = 0;
   int cols = 0;
@@ -599,6 +626,10 @@ class CpyTPP {
     }
   }
 
+  long bytes() {
+    return 2L * rows * cols * sizeof(T);
+  }
+
  private:
   int rows = 0;
   int cols = 0;
@@ -638,6 +669,10 @@ class CpyBiasTPP {
     }
   }
 
+  long bytes() {
+    return (long)cols * sizeof(Tin) + (long)rows * cols * sizeof(Tout);
+  }
+
  private:
   int rows = 0;
   int cols = 0;
@@ -762,6 +797,10 @@ class AddTPP {
     }
   }
 
+  long bytes() {
+    return (long)rows * cols * (2 * sizeof(Tin) + sizeof(Tout));
+  }
+
  private:
   int rows = 0;
   int cols = 0;
@@ -978,11 +1017,56 @@ class ScaleTPP {
     }
   }
 
+  long bytes() {
+    return (long)N * (sizeof(Tin) + sizeof(Tout));
+  }
+
  private:
   int N = 0;
   BinaryTPP kernel;
 };
 
+// Converts with a per-tensor scale, out = in * scale, to dequantize the fp8
+// weights and activations (or to quantize them with the reciprocal scale)
+template <typename Tin, typename Tout>
+class ScaledConvertTPP {
+ public:
+  ScaledConvertTPP() {}
+  ScaledConvertTPP(int N) : ScaledConvertTPP(1, N) {}
+  ScaledConvertTPP(int rows, int cols)
+      : rows(rows),
+        cols(cols),
+        kernel(
+            rows,
+            cols,
+            cols,
+            cols,
+            cols,
+            LIBXSMM_DATATYPE_F32,
+            XsmmDtype<Tin>(),
+            XsmmDtype<Tout>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_BINARY_BCAST_SCALAR_IN_0,
+            LIBXSMM_MELTW_TYPE_BINARY_MUL) {}
+  void operator()(Tin* in, Tout* out, float scale) {
+    kernel((void*)&scale, (void*)in, (void*)out);
+  }
+  void ref(Tin* in, Tout* out, float scale) {
+    for (int i = 0; i < rows * cols; i++) {
+      out[i] = (Tout)(upconvert_to_float(in[i]) * scale);
+    }
+  }
+
+  long bytes() {
+    return (long)rows * cols * (sizeof(Tin) + sizeof(Tout));
+  }
+
+ private:
+  int rows = 0;
+  int cols = 0;
+  BinaryTPP kernel;
+};
+
 template <typename T, typename TN = float>
 class Norm2TPP {
  public:
@@ -1547,11 +1631,13 @@ class BrgemmTPP {
         k_cfg(this, 1),
         k_rls(this, 2),
         k_gemm_no_tc(this, 3) {}
+  // The tiles are configured only when the configuration of this BRGEMM
+  // isn't already loaded, and released lazily, by the AMX tile manager
   void config() {
-    k_cfg(NULL);
+    torch_ipex::cpu::amx_tile_configure(k_cfg.handle(), BrgemmKernel::call);
   }
   void release() {
-    k_rls(NULL);
+    torch_ipex::cpu::amx_tile_release(k_rls.handle(), BrgemmKernel::call);
   }
   void operator()(
       Tin* A,
@@ -1617,6 +1703,12 @@ class BrgemmTPP {
     return 2L * M * N * K;
   }
 
+  // the bytes of the A and B blocks and of C, read and written with beta != 0
+  long bytes(long count) {
+    return (M * K + K * N) * count * (long)sizeof(Tin) +
+        M * N * (long)sizeof(Tout) * (beta == 0.0 ? 1 : 2);
+  }
+
   class BrgemmKernel : public BaseTPP {
    public:
     BrgemmKernel() {}
@@ -1644,6 +1736,15 @@ class BrgemmTPP {
         return;
       kernel.gemm(gemm_param);
     }
+    // The JIT-ed kernel, which identifies the tile configuration of the config
+    // kernels since libxsmm dispatches one kernel per descriptor
+    const void* handle() const {
+      return initialized ? (const void*)kernel.gemm : nullptr;
+    }
+    // Calls the tile config or release kernel handle
+    static void call(const void* handle) {
+      ((libxsmm_gemmfunction)handle)(NULL);
+    }
 
    protected:
     std::string hash_str() override {
@@ -2255,6 +2356,87 @@ class SiLUBwdTPP : public BaseTPP {
   libxsmm_matrix_eqn_function kernel = NULL;
 };
 
+template <typename T>
+class SwiGLUFwdTPP {
+ public:
+  SwiGLUFwdTPP() {}
+  SwiGLUFwdTPP(int N) : N(N) {}
+  // out = silu(gate) * up
+  void operator()(T* gate, T* up, T* out) {
+    ref(gate, up, out);
+  }
+  void ref(T* gate, T* up, T* out) {
+    for (int i = 0; i < N; i++) {
+      float g = gate[i];
+      out[i] = g / (1.f + expf(-g)) * (float)up[i];
+    }
+  }
+
+ private:
+  int N = 0;
+};
+
+template <typename T>
+class SwiGLUBwdTPP {
+ public:
+  SwiGLUBwdTPP() {}
+  SwiGLUBwdTPP(int N) : N(N) {}
+  void operator()(T* grad_out, T* gate, T* up, T* grad_gate, T* grad_up) {
+    ref(grad_out, gate, up, grad_gate, grad_up);
+  }
+  void ref(T* grad_out, T* gate, T* up, T* grad_gate, T* grad_up) {
+    for (int i = 0; i < N; i++) {
+      float g = gate[i];
+      float go = grad_out[i];
+      float sig = 1.f / (1.f + expf(-g));
+      float silu = g * sig;
+      grad_up[i] = go * silu;
+      grad_gate[i] = go * (float)up[i] * (sig + silu * (1.f - sig));
+    }
+  }
+
+ private:
+  int N = 0;
+};
+
+// Rotates the halves of the rows of a [rows][H] block by the angles of their
+// positions, the cos and sin of the rows being given as [rows][H] as in
+// HuggingFace LLaMA. The backward applies the inverse rotation to the grads.
+template <typename T>
+class RotaryEmbeddingTPP {
+ public:
+  RotaryEmbeddingTPP() {}
+  RotaryEmbeddingTPP(int rows, int H, bool backward)
+      : rows(rows), H(H), backward(backward) {}
+  void operator()(T* inout, float* cos, float* sin) {
+    ref(inout, cos, sin);
+  }
+  void ref(T* inout, float* cos, float* sin) {
+    int H2 = H / 2;
+    for (int r = 0; r < rows; r++) {
+      T* x = &inout[r * H];
+      float* c = &cos[r * H];
+      float* s = &sin[r * H];
+      for (int i = 0; i < H2; i++) {
+        float x1 = x[i];
+        float x2 = x[i + H2];
+        if (!backward) {
+          x[i] = x1 * c[i] - x2 * s[i];
+          x[i + H2] = x2 * c[i + H2] + x1 * s[i + H2];
+        } else {
+          x[i] = x1 * c[i] + x2 * s[i + H2];
+          x[i + H2] = x2 * c[i + H2] - x1 * s[i];
+        }
+      }
+    }
+  }
+
+ private:
+  int rows = 0;
+  int H = 0;
+  bool backward = false;
+};
+
 template <typename Tin, typename Tout = Tin>
 class DropOutFwdTPP {
  public:
@@ -3168,7 +3350,8 @@ class VarSoftMaxBwdTPP {
   Eqn eqn0, eqn1;
 };
 
-template <typename T>
+// The output of type Tout, e.g. bf16 from fp32 inputs
+template <typename T, typename Tout = T>
 class LayerNormFwdTPP {
  public:
   LayerNormFwdTPP() {}
@@ -3198,7 +3381,13 @@ class LayerNormFwdTPP {
             LIBXSMM_MELTW_FLAG_UNARY_REDUCE_ROWS,
             LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X_OP_ADD),
         eqn(S1, S2, S3) {}
-  void operator()(T* inp, T* gamma, T* beta, float* mean, float* var, T* out) {
+  void operator()(
+      T* inp,
+      T* gamma,
+      T* beta,
+      float* mean,
+      float* var,
+      Tout* out) {
     LIBXSMM_ALIGNED(float tmp[2 * S3], 64);
     const float c = 1.0 / ((float)S1 * S3);
     float m, v, s, b;
@@ -3226,10 +3415,16 @@ class LayerNormFwdTPP {
       eqn(&eqn_param);
     }
   }
-  void ref(T* pinp, T* pgamma, T* pbeta, float* mean, float* var, T* pout) {
+  void ref(
+      T* pinp,
+      T* pgamma,
+      T* pbeta,
+      float* mean,
+      float* var,
+      Tout* pout) {
     int s1, s2, s3;
     LIBXSMM_VLA_DECL(3, T, inp, pinp, S2, S3);
-    LIBXSMM_VLA_DECL(3, T, out, pout, S2, S3);
+    LIBXSMM_VLA_DECL(3, Tout, out, pout, S2, S3);
     LIBXSMM_VLA_DECL(2, T, gamma, pgamma, S3);
     LIBXSMM_VLA_DECL(2, T, beta, pbeta, S3);
     for (s2 = 0; s2 < S2; s2++) {
@@ -3280,8 +3475,9 @@ class LayerNormFwdTPP {
       snprintf(
           hash,
           200,
-          "layernorm_fwd_eqn_t%d_S1%d_S2%d_S3%d",
+          "layernorm_fwd_eqn_t%d_to%d_S1%d_S2%d_S3%d",
           XsmmDtype<T>(),
+          XsmmDtype<Tout>(),
           S1,
           S2,
           S3);
@@ -3289,7 +3485,7 @@ class LayerNormFwdTPP {
     }
     void* build_kernel() override {
       auto in_dt = XsmmDtype<T>();
-      auto out_dt = XsmmDtype<T>();
+      auto out_dt = XsmmDtype<Tout>();
       libxsmm_blasint tmp_ld = 1;
       libxsmm_blasint tmp_ld2 = S3;
       libxsmm_blasint ld = S2 * S3;
@@ -3556,6 +3752,140 @@ class LayerNormBwdTPP {
   Eqn dgamma_func, dbeta_func, db_func, ds_func, din_func;
 };
 
+template <typename T>
+class RMSNormFwdTPP {
+ public:
+  RMSNormFwdTPP() {}
+  RMSNormFwdTPP(int S1, int S2, int S3, float eps)
+      : S1(S1),
+        S2(S2),
+        S3(S3),
+        eps(eps),
+        reduce_cols_kernel(
+            S1,
+            S3,
+            S2 * S3,
+            S3,
+            XsmmDtype<T>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_COLS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X2_OP_ADD),
+        reduce_rows_kernel(
+            1,
+            S3,
+            S3,
+            1,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_ROWS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X_OP_ADD) {}
+  void operator()(T* inp, T* gamma, float* rstd, T* out) {
+    LIBXSMM_ALIGNED(float tmp[S3], 64);
+    const float c = 1.0 / ((float)S1 * S3);
+    for (int s2 = 0; s2 < S2; s2++) {
+      float v;
+      reduce_cols_kernel((void*)&inp[s2 * S3], (void*)tmp);
+      reduce_rows_kernel((void*)tmp, (void*)&v);
+      rstd[s2] = 1.0f / ((float)sqrt(v * c + eps));
+      scale(inp, gamma, rstd[s2], out, s2);
+    }
+  }
+  void ref(T* pinp, T* pgamma, float* rstd, T* pout) {
+    int s1, s2, s3;
+    LIBXSMM_VLA_DECL(3, T, inp, pinp, S2, S3);
+    for (s2 = 0; s2 < S2; s2++) {
+      float v = 0;
+      float c = 1.0 / (S1 * S3);
+      for (s1 = 0; s1 < S1; s1++) {
+        for (s3 = 0; s3 < S3; s3++) {
+          float x = LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3);
+          v += x * x;
+        }
+      }
+      rstd[s2] = 1.0f / ((float)sqrt(v * c + eps));
+      scale(pinp, pgamma, rstd[s2], pout, s2);
+    }
+  }
+
+ private:
+  // out = inp * rstd * gamma for the row s2
+  void scale(T* pinp, T* pgamma, float rstd, T* pout, int s2) {
+    LIBXSMM_VLA_DECL(3, T, inp, pinp, S2, S3);
+    LIBXSMM_VLA_DECL(3, T, out, pout, S2, S3);
+    LIBXSMM_VLA_DECL(2, T, gamma, pgamma, S3);
+    for (int s1 = 0; s1 < S1; s1++) {
+      for (int s3 = 0; s3 < S3; s3++) {
+        LIBXSMM_VLA_ACCESS(3, out, s1, s2, s3, S2, S3) =
+            (float)LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3) * rstd *
+            (float)LIBXSMM_VLA_ACCESS(2, gamma, s1, s3, S3);
+      }
+    }
+  }
+
+  int S1, S2, S3;
+  float eps;
+  UnaryTPP reduce_cols_kernel;
+  UnaryTPP reduce_rows_kernel;
+};
+
+template <typename T>
+class RMSNormBwdTPP {
+ public:
+  RMSNormBwdTPP() {}
+  RMSNormBwdTPP(int S1, int S2, int S3) : S1(S1), S2(S2), S3(S3) {}
+  void operator()(
+      T* dout,
+      T* inp,
+      float* rstd,
+      T* gamma,
+      T* din,
+      float* dgamma) {
+    ref(dout, inp, rstd, gamma, din, dgamma);
+  }
+  void ref(
+      T* pdout,
+      T* pinp,
+      float* rstd,
+      T* pgamma,
+      T* pdin,
+      float* pdgamma) {
+    int s1, s2, s3;
+    LIBXSMM_VLA_DECL(3, T, din, pdin, S2, S3);
+    LIBXSMM_VLA_DECL(3, T, inp, pinp, S2, S3);
+    LIBXSMM_VLA_DECL(3, T, dout, pdout, S2, S3);
+    LIBXSMM_VLA_DECL(2, T, gamma, pgamma, S3);
+    LIBXSMM_VLA_DECL(2, float, dgamma, pdgamma, S3);
+    const float scale = 1.0f / ((float)S1 * S3);
+    for (s2 = 0; s2 < S2; s2++) {
+      float a = rstd[s2];
+      float ds = 0.0f;
+      for (s1 = 0; s1 < S1; s1++) {
+        for (s3 = 0; s3 < S3; s3++) {
+          float x = LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3);
+          float dy = LIBXSMM_VLA_ACCESS(3, dout, s1, s2, s3, S2, S3);
+          LIBXSMM_VLA_ACCESS(2, dgamma, s1, s3, S3) += a * x * dy;
+          ds += dy * (float)LIBXSMM_VLA_ACCESS(2, gamma, s1, s3, S3) * x;
+        }
+      }
+      // d(x * rstd) / dx = rstd - x * x * rstd^3 / (S1 * S3)
+      float b = -ds * a * a * a * scale;
+      for (s1 = 0; s1 < S1; s1++) {
+        for (s3 = 0; s3 < S3; s3++) {
+          LIBXSMM_VLA_ACCESS(3, din, s1, s2, s3, S2, S3) =
+              (float)LIBXSMM_VLA_ACCESS(3, dout, s1, s2, s3, S2, S3) * a *
+                  (float)LIBXSMM_VLA_ACCESS(2, gamma, s1, s3, S3) +
+              b * (float)LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3);
+        }
+      }
+    }
+  }
+
+ private:
+  int S1, S2, S3;
+};
+
 template <typename T>
 class GroupNormFwdTPP {
  public:
@@ -4129,9 +4459,12 @@ class FusedAdamWTPP {
       T* exp_avg,
       T* exp_avg_sq,
       float step_size,
-      float lr) {
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+      float lr,
+      float grad_scale = 1.0) {
+    // grad_scale (the clip coefficient) is folded in the coefficients of
+    // grad and grad^2
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
     float lrwd_1 = 1.0f - lr * weight_decay;
     libxsmm_matrix_eqn_param eqn_param;
     libxsmm_matrix_arg arg_array[6];
@@ -4166,10 +4499,11 @@ class FusedAdamWTPP {
       T* exp_avg,
       T* exp_avg_sq,
       float step_size,
-      float lr) {
+      float lr,
+      float grad_scale = 1.0) {
     long sz = N;
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
 #ifndef __AVX512F__
     for (long i = 0; i < sz; i++) {
       auto avg_i = exp_avg[i];
@@ -4382,9 +4716,12 @@ class FusedSplitAdamWTPP {
       T* exp_avg,
       T* exp_avg_sq,
       float step_size,
-      float lr) {
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+      float lr,
+      float grad_scale = 1.0) {
+    // grad_scale (the clip coefficient) is folded in the coefficients of
+    // grad and grad^2
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
     float lrwd_1 = 1.0f - lr * weight_decay;
     libxsmm_matrix_eqn_param eqn_param;
     libxsmm_matrix_arg arg_array[7];
@@ -4423,10 +4760,11 @@ class FusedSplitAdamWTPP {
       T* exp_avg,
       T* exp_avg_sq,
       float step_size,
-      float lr) {
+      float lr,
+      float grad_scale = 1.0) {
     long sz = N;
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
 #ifndef __AVX512F__
     for (long i = 0; i < sz; i++) {
       union libxsmm_bfloat16_hp data_hp;
@@ -4654,9 +4992,12 @@ class FusedAdamStepTPP {
       T* adam_step,
       float weight_decay = 0.0,
       float exp_avg_scale = 1.0,
-      float exp_avg_sq_scale = 1.0) {
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+      float exp_avg_sq_scale = 1.0,
+      float grad_scale = 1.0) {
+    // grad_scale (the clip coefficient) is folded in the coefficients of
+    // grad and grad^2
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
     libxsmm_matrix_eqn_param eqn_param;
     libxsmm_matrix_arg arg_array[7];
     arg_array[0].primary = (void*)grad;
@@ -4693,10 +5034,11 @@ class FusedAdamStepTPP {
       T* adam_step,
       float weight_decay = 0.0,
       float exp_avg_scale = 1.0,
-      float exp_avg_sq_scale = 1.0) {
+      float exp_avg_sq_scale = 1.0,
+      float grad_scale = 1.0) {
     long sz = N;
-    float beta1_1 = 1.0f - beta1;
-    float beta2_1 = 1.0f - beta2;
+    float beta1_1 = (1.0f - beta1) * grad_scale;
+    float beta2_1 = (1.0f - beta2) * grad_scale * grad_scale;
 #ifndef __AVX512F__
     for (long i = 0; i < sz; i++) {
       float avg_i = exp_avg[i];
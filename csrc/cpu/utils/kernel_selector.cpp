@@ -0,0 +1,182 @@
+#include "kernel_selector.h"
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "rcu.h"
+
+namespace torch_ipex {
+namespace utils {
+
+namespace {
+
+// The trials of the candidates of a key not locked in yet
+struct KernelTrials {
+  uint64_t available = 0;
+  std::vector<int64_t> runs;
+  std::vector<double> best;
+};
+
+struct KernelSelector {
+  std::atomic<bool> enabled{false};
+  std::atomic<int64_t> trials{3};
+  // read by every call of the selected ops
+  RcuMap<std::string, int64_t> locked;
+  std::mutex trials_mutex;
+  std::unordered_map<std::string, KernelTrials> pending;
+
+  static KernelSelector& get() {
+    static KernelSelector selector;
+    return selector;
+  }
+};
+
+bool is_available(uint64_t available, int64_t candidate) {
+  return candidate >= 64 || (available >> candidate) & 1;
+}
+
+} // namespace
+
+bool is_kernel_selection_enabled() {
+  return KernelSelector::get().enabled.load(std::memory_order_relaxed);
+}
+
+void set_kernel_selection_enabled(bool enabled) {
+  KernelSelector::get().enabled.store(enabled);
+}
+
+int64_t get_kernel_selection_trials() {
+  return KernelSelector::get().trials.load();
+}
+
+void set_kernel_selection_trials(int64_t trials) {
+  TORCH_CHECK(trials > 0, "the kernel selection needs at least one trial");
+  KernelSelector::get().trials.store(trials);
+}
+
+std::string kernel_selection_key(
+    const char* op,
+    std::initializer_list<int64_t> dims) {
+  std::ostringstream key;
+  key << op << ":";
+  const char* separator = "";
+  for (auto dim : dims) {
+    key << separator << dim;
+    separator = ",";
+  }
+  key << ":" << at::get_num_threads();
+  return key.str();
+}
+
+std::vector<std::pair<std::string, int64_t>> get_kernel_selection_table() {
+  std::vector<std::pair<std::string, int64_t>> table;
+  KernelSelector::get().locked.for_each(
+      [&](const std::string& key, int64_t kernel) {
+        table.emplace_back(key, kernel);
+      });
+  return table;
+}
+
+void load_kernel_selection_table(
+    const std::vector<std::pair<std::string, int64_t>>& table) {
+  auto& selector = KernelSelector::get();
+  {
+    std::lock_guard<std::mutex> lock(selector.trials_mutex);
+    for (const auto& entry : table) {
+      selector.pending.erase(entry.first);
+    }
+  }
+  selector.locked.update([&](auto& map) {
+    for (const auto& entry : table) {
+      map[entry.first] = entry.second;
+    }
+  });
+}
+
+void reset_kernel_selection() {
+  auto& selector = KernelSelector::get();
+  {
+    std::lock_guard<std::mutex> lock(selector.trials_mutex);
+    selector.pending.clear();
+  }
+  selector.locked.clear();
+}
+
+KernelSelection::KernelSelection(
+    std::string key,
+    int64_t num_candidates,
+    uint64_t available)
+    : key_(std::move(key)) {
+  auto& selector = KernelSelector::get();
+  if (selector.locked.find(key_, kernel_)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(selector.trials_mutex);
+  auto it = selector.pending.find(key_);
+  if (it == selector.pending.end()) {
+    KernelTrials trials;
+    trials.available = available;
+    trials.runs.assign(num_candidates, 0);
+    trials.best.assign(num_candidates, std::numeric_limits<double>::max());
+    it = selector.pending.emplace(key_, std::move(trials)).first;
+  }
+  // the candidates are timed in turn, the one of the fewest runs first
+  auto& trials = it->second;
+  int64_t candidate = -1;
+  for (int64_t i = 0; i < num_candidates; i++) {
+    if (is_available(trials.available, i) &&
+        (candidate < 0 || trials.runs[i] < trials.runs[candidate])) {
+      candidate = i;
+    }
+  }
+  TORCH_CHECK(candidate >= 0, "no kernel is available for ", key_);
+  kernel_ = candidate;
+  timed_ = true;
+  start_ = std::chrono::steady_clock::now();
+}
+
+KernelSelection::~KernelSelection() {
+  if (!timed_ || std::uncaught_exceptions() > 0) {
+    return;
+  }
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start_)
+                  .count();
+  auto& selector = KernelSelector::get();
+  int64_t fastest = -1;
+  {
+    std::lock_guard<std::mutex> lock(selector.trials_mutex);
+    auto it = selector.pending.find(key_);
+    if (it == selector.pending.end()) {
+      // locked in by another call or a loaded table meanwhile
+      return;
+    }
+    auto& trials = it->second;
+    trials.runs[kernel_]++;
+    trials.best[kernel_] = std::min(trials.best[kernel_], ms);
+    int64_t num_candidates = trials.runs.size();
+    for (int64_t i = 0; i < num_candidates; i++) {
+      if (!is_available(trials.available, i)) {
+        continue;
+      }
+      if (trials.runs[i] < selector.trials.load()) {
+        return;
+      }
+      if (fastest < 0 || trials.best[i] < trials.best[fastest]) {
+        fastest = i;
+      }
+    }
+    selector.pending.erase(it);
+  }
+  selector.locked.insert(key_, fastest);
+}
+
+} // namespace utils
+} // namespace torch_ipex
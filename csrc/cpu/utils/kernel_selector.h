@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch_ipex {
+namespace utils {
+
+// The runtime selection of the kernel of an op among its candidates, e.g. the
+// MKL packed, MKL and oneDNN kernels of the fp32 linear (disabled by default).
+// The first trials runs of each candidate for a new key, the shape of the
+// call and the OpenMP threads it runs with, are timed, and the fastest one is
+// locked in for the key. The table of the locked in kernels is read without a
+// lock, and may be exported and imported, so that a deployment runs the
+// kernels tuned by another one without timing them again.
+TORCH_API bool is_kernel_selection_enabled();
+
+TORCH_API void set_kernel_selection_enabled(bool enabled);
+
+TORCH_API int64_t get_kernel_selection_trials();
+
+TORCH_API void set_kernel_selection_trials(int64_t trials);
+
+// The key of the calls of op with the dims and the current OpenMP threads
+TORCH_API std::string kernel_selection_key(
+    const char* op,
+    std::initializer_list<int64_t> dims);
+
+// The locked in kernels of the keys
+TORCH_API std::vector<std::pair<std::string, int64_t>>
+get_kernel_selection_table();
+
+// Locks in the kernels of the table, over those of the same keys
+TORCH_API void load_kernel_selection_table(
+    const std::vector<std::pair<std::string, int64_t>>& table);
+
+TORCH_API void reset_kernel_selection();
+
+class TORCH_API KernelSelection {
+ public:
+  // Selects the kernel of the call among num_candidates, those whose bit is
+  // not set in available being skipped
+  KernelSelection(
+      std::string key,
+      int64_t num_candidates,
+      uint64_t available = ~0ull);
+  KernelSelection(const KernelSelection&) = delete;
+  KernelSelection& operator=(const KernelSelection&) = delete;
+
+  // Records the time of the candidate when it is timed
+  ~KernelSelection();
+
+  int64_t kernel() const {
+    return kernel_;
+  }
+
+  bool timed() const {
+    return timed_;
+  }
+
+ private:
+  std::string key_;
+  int64_t kernel_ = 0;
+  bool timed_ = false;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,156 @@
+#include "memory_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace utils {
+
+namespace {
+
+constexpr const char* kUntagged = "untagged";
+
+std::atomic<bool> memory_tracking_enabled{false};
+thread_local const char* thread_memory_tag = nullptr;
+
+struct TrackedAllocation {
+  size_t nbytes;
+  const char* tag;
+};
+
+std::mutex memory_tracker_mutex;
+std::unordered_map<void*, TrackedAllocation> tracked_allocations;
+// the number of the live tracked allocations, so that the frees skip the
+// lookup when there are none
+std::atomic<int64_t> num_tracked_allocations{0};
+std::map<std::string, MemoryTagStats> tag_stats;
+int64_t total_current_bytes = 0;
+int64_t total_peak_bytes = 0;
+// the tags set from Python
+std::set<std::string> interned_tags;
+
+c10::DeleterFnPtr base_raw_deleter = nullptr;
+std::once_flag memory_tracker_install_call_once_flag;
+
+void track_delete(void* ptr) {
+  if (num_tracked_allocations > 0) {
+    std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+    auto it = tracked_allocations.find(ptr);
+    if (it != tracked_allocations.end()) {
+      int64_t nbytes = it->second.nbytes;
+      tag_stats[it->second.tag].current_bytes -= nbytes;
+      total_current_bytes -= nbytes;
+      tracked_allocations.erase(it);
+      num_tracked_allocations--;
+    }
+  }
+  base_raw_deleter(ptr);
+}
+
+void install_memory_tracker() {
+  // The tracker forwards to the CPU allocator set at this point
+  static MemoryTrackingAllocator tracking_allocator(c10::GetCPUAllocator());
+  c10::SetCPUAllocator(&tracking_allocator, /* priority */ 1);
+}
+
+} // namespace
+
+void set_memory_tracking_enabled(bool enabled) {
+  if (enabled) {
+    std::call_once(
+        memory_tracker_install_call_once_flag, install_memory_tracker);
+  }
+  memory_tracking_enabled = enabled;
+}
+
+bool is_memory_tracking_enabled() {
+  return memory_tracking_enabled;
+}
+
+std::vector<MemoryTagStats> get_memory_tag_stats() {
+  std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+  std::vector<MemoryTagStats> stats;
+  for (auto& entry : tag_stats) {
+    stats.push_back(entry.second);
+    stats.back().tag = entry.first;
+  }
+  return stats;
+}
+
+std::pair<int64_t, int64_t> get_memory_totals() {
+  std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+  return {total_current_bytes, total_peak_bytes};
+}
+
+void reset_memory_stats() {
+  std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+  for (auto& entry : tag_stats) {
+    entry.second.peak_bytes = entry.second.current_bytes;
+    entry.second.allocated_bytes = 0;
+    entry.second.allocations = 0;
+  }
+  total_peak_bytes = total_current_bytes;
+}
+
+std::string set_thread_memory_tag(const std::string& tag) {
+  std::string prev = thread_memory_tag ? thread_memory_tag : "";
+  if (tag.empty()) {
+    thread_memory_tag = nullptr;
+  } else {
+    std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+    thread_memory_tag = interned_tags.insert(tag).first->c_str();
+  }
+  return prev;
+}
+
+MemoryScope::MemoryScope(const char* tag) : prev_tag_(thread_memory_tag) {
+  thread_memory_tag = tag;
+}
+
+MemoryScope::~MemoryScope() {
+  thread_memory_tag = prev_tag_;
+}
+
+MemoryTrackingAllocator::MemoryTrackingAllocator(
+    c10::Allocator* base_allocator)
+    : base_allocator(base_allocator) {
+  base_raw_deleter = base_allocator->raw_deleter();
+}
+
+c10::DataPtr MemoryTrackingAllocator::allocate(size_t nbytes) const {
+  c10::DataPtr data_ptr = this->base_allocator->allocate(nbytes);
+  void* ptr = data_ptr.get();
+  // only the allocations freed by the raw deleter of the base allocator can
+  // be freed by track_delete
+  if (!is_memory_tracking_enabled() || ptr == nullptr ||
+      base_raw_deleter == nullptr || ptr != data_ptr.get_context() ||
+      data_ptr.get_deleter() != base_raw_deleter) {
+    return data_ptr;
+  }
+  const char* tag = thread_memory_tag ? thread_memory_tag : kUntagged;
+  {
+    std::lock_guard<std::mutex> guard(memory_tracker_mutex);
+    tracked_allocations[ptr] = {nbytes, tag};
+    num_tracked_allocations++;
+    auto& stats = tag_stats[tag];
+    stats.current_bytes += nbytes;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.current_bytes);
+    stats.allocated_bytes += nbytes;
+    stats.allocations++;
+    total_current_bytes += nbytes;
+    total_peak_bytes = std::max(total_peak_bytes, total_current_bytes);
+  }
+  data_ptr.release_context();
+  return c10::DataPtr(ptr, ptr, &track_delete, data_ptr.device());
+}
+
+c10::DeleterFnPtr MemoryTrackingAllocator::raw_deleter() const {
+  return base_raw_deleter ? &track_delete : nullptr;
+}
+
+} // namespace utils
+} // namespace torch_ipex
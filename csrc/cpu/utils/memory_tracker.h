@@ -0,0 +1,69 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace utils {
+
+/*
+ The memory tracker accounts the CPU allocations by tag, e.g. the packed
+ weights, the shared LLGA constants, the TPP ops and the optimizer trails, to
+ report their current and peak bytes. While enabled, the allocations are
+ tagged with the MemoryScope of their thread ("untagged" out of any scope)
+ until they are freed, even after the tracking is disabled.
+
+ The tracker wraps the CPU allocator of PyTorch, installed the first time the
+ tracking is enabled, so the allocations of oneDNN through the raw interface
+ of the allocator are tracked as well. The allocations made while disabled
+ are not accounted and cost nothing.
+*/
+TORCH_API void set_memory_tracking_enabled(bool enabled);
+TORCH_API bool is_memory_tracking_enabled();
+
+struct MemoryTagStats {
+  std::string tag;
+  int64_t current_bytes = 0;
+  int64_t peak_bytes = 0;
+  // since the last reset
+  int64_t allocated_bytes = 0;
+  int64_t allocations = 0;
+};
+
+TORCH_API std::vector<MemoryTagStats> get_memory_tag_stats();
+// The current and peak bytes of all the tracked allocations
+TORCH_API std::pair<int64_t, int64_t> get_memory_totals();
+// Reset the peaks to the current bytes and clear the allocation counts
+TORCH_API void reset_memory_stats();
+
+// The tag of the calling thread, returning the previous one, for Python
+TORCH_API std::string set_thread_memory_tag(const std::string& tag);
+
+// Tags the allocations of the calling thread in its scope, tag being a
+// string literal or an interned string
+class TORCH_API MemoryScope {
+ public:
+  explicit MemoryScope(const char* tag);
+  ~MemoryScope();
+
+ private:
+  const char* prev_tag_;
+};
+
+class MemoryTrackingAllocator final : public c10::Allocator {
+ public:
+  explicit MemoryTrackingAllocator(c10::Allocator* base_allocator);
+
+  c10::DataPtr allocate(size_t nbytes) const override;
+  c10::DeleterFnPtr raw_deleter() const override;
+
+ private:
+  c10::Allocator* base_allocator;
+};
+
+} // namespace utils
+} // namespace torch_ipex
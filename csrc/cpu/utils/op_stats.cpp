@@ -0,0 +1,63 @@
+#include "op_stats.h"
+
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace torch_ipex {
+namespace utils {
+
+std::atomic<int64_t> op_stats_sample_rate{0};
+
+namespace {
+
+std::mutex op_stats_mutex;
+// by op name
+std::map<std::string, OpStats> op_stats;
+
+} // namespace
+
+int64_t get_op_stats_sample_rate() {
+  return op_stats_sample_rate;
+}
+
+void set_op_stats_sample_rate(int64_t sample_rate) {
+  TORCH_CHECK(sample_rate >= 0, "the sample rate of the op stats must be >= 0");
+  op_stats_sample_rate = sample_rate;
+}
+
+std::vector<OpStats> get_op_stats() {
+  std::lock_guard<std::mutex> guard(op_stats_mutex);
+  std::vector<OpStats> stats;
+  for (auto& entry : op_stats)
+    stats.push_back(entry.second);
+  return stats;
+}
+
+void reset_op_stats() {
+  std::lock_guard<std::mutex> guard(op_stats_mutex);
+  op_stats.clear();
+}
+
+RecordOpStats::~RecordOpStats() {
+  if (!active())
+    return;
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start_)
+                  .count();
+  int64_t threads = at::get_num_threads();
+  std::lock_guard<std::mutex> guard(op_stats_mutex);
+  auto& stats = op_stats[name_];
+  if (stats.name.empty())
+    stats.name = name_;
+  stats.calls += rate_;
+  stats.samples++;
+  stats.sampled_ms += ms;
+  stats.sampled_bytes += bytes_;
+  stats.sampled_flops += flops_;
+  stats.max_threads = std::max(stats.max_threads, threads);
+}
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace utils {
+
+// The runtime stats of the IPEX ops: one call of every sample_rate calls of
+// each op and thread is timed, with the bytes it moves and the FLOPs it
+// computes (disabled by default, sample_rate 0). The other calls only bump a
+// thread local counter, so a sample_rate of 100 or more costs well under 1%.
+TORCH_API int64_t get_op_stats_sample_rate();
+
+TORCH_API void set_op_stats_sample_rate(int64_t sample_rate);
+
+struct OpStats {
+  std::string name;
+  // the estimated calls: each sample counts for sample_rate calls
+  int64_t calls = 0;
+  int64_t samples = 0;
+  double sampled_ms = 0;
+  // the bytes read and written and the FLOPs of the sampled calls
+  int64_t sampled_bytes = 0;
+  int64_t sampled_flops = 0;
+  // the most OpenMP threads a sampled call ran with
+  int64_t max_threads = 0;
+};
+
+TORCH_API std::vector<OpStats> get_op_stats();
+
+TORCH_API void reset_op_stats();
+
+extern std::atomic<int64_t> op_stats_sample_rate;
+
+class TORCH_API RecordOpStats {
+ public:
+  // calls is the thread local counter of the calls of the op
+  RecordOpStats(const char* name, int64_t& calls) : name_(name) {
+    int64_t rate = op_stats_sample_rate.load(std::memory_order_relaxed);
+    if (rate > 0 && calls++ % rate == 0) {
+      rate_ = rate;
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~RecordOpStats();
+
+  bool active() const {
+    return rate_ > 0;
+  }
+
+  void set_work(int64_t bytes, int64_t flops) {
+    bytes_ = bytes;
+    flops_ = flops;
+  }
+
+ private:
+  const char* name_;
+  int64_t rate_ = 0;
+  int64_t bytes_ = 0;
+  int64_t flops_ = 0;
+  std::chrono::steady_clock::time_point start_;
+};
+
+inline int64_t nbytes(const at::Tensor& t) {
+  return t.defined() ? t.numel() * t.element_size() : 0;
+}
+
+inline int64_t nbytes(at::TensorList tensors) {
+  int64_t bytes = 0;
+  for (auto& t : tensors)
+    bytes += nbytes(t);
+  return bytes;
+}
+
+} // namespace utils
+} // namespace torch_ipex
+
+// Records the stats of the enclosing scope as the op name. The bytes and flops
+// expressions are only evaluated by the sampled calls.
+#define IPEX_RECORD_OP_STATS(name, bytes, flops)        \
+  static thread_local int64_t _ipex_op_stats_calls = 0; \
+  torch_ipex::utils::RecordOpStats _ipex_op_stats(      \
+      name, _ipex_op_stats_calls);                      \
+  if (_ipex_op_stats.active()) {                        \
+    _ipex_op_stats.set_work(bytes, flops);              \
+  }
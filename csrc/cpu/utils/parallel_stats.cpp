@@ -0,0 +1,107 @@
+#include "parallel_stats.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include "runtime/CPUPool.h"
+
+namespace torch_ipex {
+namespace utils {
+
+std::atomic<bool> parallel_stats_enabled{false};
+
+namespace {
+
+thread_local const char* parallel_stats_op = "other";
+
+std::mutex parallel_stats_mutex;
+// by op and CPUPool
+std::map<std::pair<std::string, std::string>, ParallelStats> parallel_stats;
+
+// The cores of the pool of the calling thread, e.g. "0-13" or "0,2,4"
+std::string current_cpu_pool() {
+  auto cores = torch_ipex::runtime::get_current_cpu_core_list();
+  if (cores.empty() || cores[0] < 0)
+    return "default";
+  std::ostringstream ss;
+  for (size_t i = 0; i < cores.size();) {
+    size_t j = i;
+    while (j + 1 < cores.size() && cores[j + 1] == cores[j] + 1)
+      j++;
+    ss << (i ? "," : "") << cores[i];
+    if (j > i)
+      ss << "-" << cores[j];
+    i = j + 1;
+  }
+  return ss.str();
+}
+
+} // namespace
+
+bool is_parallel_stats_enabled() {
+  return parallel_stats_enabled;
+}
+
+void set_parallel_stats_enabled(bool enabled) {
+  parallel_stats_enabled = enabled;
+}
+
+std::vector<ParallelStats> get_parallel_stats() {
+  std::lock_guard<std::mutex> guard(parallel_stats_mutex);
+  std::vector<ParallelStats> stats;
+  for (auto& entry : parallel_stats)
+    stats.push_back(entry.second);
+  return stats;
+}
+
+void reset_parallel_stats() {
+  std::lock_guard<std::mutex> guard(parallel_stats_mutex);
+  parallel_stats.clear();
+}
+
+ParallelStatsScope::ParallelStatsScope(const char* op)
+    : prev_op_(parallel_stats_op) {
+  parallel_stats_op = op;
+}
+
+ParallelStatsScope::~ParallelStatsScope() {
+  parallel_stats_op = prev_op_;
+}
+
+void record_parallel_region(
+    double wall_ms,
+    const std::vector<double>& busy_ms) {
+  int64_t threads = 0;
+  double busy = 0, max_busy = 0;
+  for (double ms : busy_ms) {
+    if (ms > 0) {
+      threads++;
+      busy += ms;
+      max_busy = std::max(max_busy, ms);
+    }
+  }
+  if (threads == 0)
+    return;
+  // each thread waits for the slowest one at the end of the region
+  double barrier_wait = max_busy * threads - busy;
+  double imbalance = max_busy * threads / busy;
+  std::string cpu_pool = current_cpu_pool();
+  std::lock_guard<std::mutex> guard(parallel_stats_mutex);
+  auto& stats = parallel_stats[{parallel_stats_op, cpu_pool}];
+  if (stats.op.empty()) {
+    stats.op = parallel_stats_op;
+    stats.cpu_pool = cpu_pool;
+  }
+  stats.regions++;
+  stats.max_threads = std::max(stats.max_threads, threads);
+  stats.wall_ms += wall_ms;
+  stats.busy_ms += busy;
+  stats.max_busy_ms += max_busy;
+  stats.barrier_wait_ms += barrier_wait;
+  stats.worst_imbalance = std::max(stats.worst_imbalance, imbalance);
+}
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace utils {
+
+// The thread imbalance of the parallel regions of the IPEX kernels: while
+// enabled (disabled by default), the busy time of each thread in the regions
+// run through utils::parallel_for is measured, to find the ops whose static
+// partitioning leaves threads waiting at the barrier on the stragglers, e.g.
+// on SMT siblings or noisy neighbors. The regions are accounted by the op of
+// the enclosing ParallelStatsScope and by the CPUPool the calling thread is
+// pinned to, so the streams of the runtime extension are told apart.
+TORCH_API bool is_parallel_stats_enabled();
+
+TORCH_API void set_parallel_stats_enabled(bool enabled);
+
+struct ParallelStats {
+  std::string op;
+  // the cores of the CPUPool of the calling thread, "default" if unpinned
+  std::string cpu_pool;
+  int64_t regions = 0;
+  // the most threads a region ran on
+  int64_t max_threads = 0;
+  double wall_ms = 0;
+  // the busy time of all the threads and of the slowest one of each region
+  double busy_ms = 0;
+  double max_busy_ms = 0;
+  // the time the threads waited for the slowest one of each region
+  double barrier_wait_ms = 0;
+  // the largest slowest / mean busy time ratio of a region
+  double worst_imbalance = 0;
+};
+
+TORCH_API std::vector<ParallelStats> get_parallel_stats();
+
+TORCH_API void reset_parallel_stats();
+
+// busy_ms has the busy time of each thread of the region, 0 for the threads
+// which got no work
+TORCH_API void record_parallel_region(
+    double wall_ms,
+    const std::vector<double>& busy_ms);
+
+extern std::atomic<bool> parallel_stats_enabled;
+
+// Names the op of the parallel regions of the calling thread in its scope,
+// "other" out of any scope
+class TORCH_API ParallelStatsScope {
+ public:
+  explicit ParallelStatsScope(const char* op);
+  ~ParallelStatsScope();
+
+ private:
+  const char* prev_op_;
+};
+
+// at::parallel_for, measuring the busy time of each thread while the
+// parallel stats are enabled. The nested regions run inline and are not
+// accounted.
+template <class F>
+inline void parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const F& f) {
+  if (!parallel_stats_enabled.load(std::memory_order_relaxed) ||
+      at::in_parallel_region()) {
+    at::parallel_for(begin, end, grain_size, f);
+    return;
+  }
+  using clock = std::chrono::steady_clock;
+  std::vector<double> busy_ms(at::get_num_threads(), 0);
+  auto start = clock::now();
+  at::parallel_for(begin, end, grain_size, [&](int64_t b, int64_t e) {
+    auto thread_start = clock::now();
+    f(b, e);
+    int tid = at::get_thread_num();
+    if (tid < static_cast<int>(busy_ms.size())) {
+      busy_ms[tid] += std::chrono::duration<double, std::milli>(
+                          clock::now() - thread_start)
+                          .count();
+    }
+  });
+  double wall_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  record_parallel_region(wall_ms, busy_ms);
+}
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,123 @@
+#include "rcu.h"
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace torch_ipex {
+namespace utils {
+
+namespace {
+
+// The slot of the calling thread, given back when it exits
+struct ThreadSlot {
+  std::atomic<uint64_t>* epoch = nullptr;
+  std::atomic<bool>* owned = nullptr;
+  // the nesting of the read guards of the thread
+  int depth = 0;
+
+  ~ThreadSlot() {
+    if (owned) {
+      owned->store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadSlot thread_slot;
+
+} // namespace
+
+EpochDomain& EpochDomain::global() {
+  // never deleted, for the threads exiting after the static destructors
+  static EpochDomain* domain = new EpochDomain();
+  return *domain;
+}
+
+std::atomic<uint64_t>* EpochDomain::acquire_slot() {
+  for (auto& slot : slots_) {
+    bool owned = false;
+    if (!slot.owned.load(std::memory_order_relaxed) &&
+        slot.owned.compare_exchange_strong(owned, true)) {
+      thread_slot.epoch = &slot.epoch;
+      thread_slot.owned = &slot.owned;
+      return thread_slot.epoch;
+    }
+  }
+  TORCH_CHECK(
+      false,
+      "EpochDomain: more than ",
+      kMaxSlots,
+      " threads read the lock free caches");
+}
+
+EpochDomain::ReadGuard::ReadGuard() {
+  if (thread_slot.depth++ > 0) {
+    return;
+  }
+  auto& domain = EpochDomain::global();
+  slot_ = thread_slot.epoch;
+  if (!slot_) {
+    try {
+      slot_ = domain.acquire_slot();
+    } catch (...) {
+      thread_slot.depth--;
+      throw;
+    }
+  }
+  // sequentially consistent, so that a writer scanning the slots after
+  // unlinking a snapshot either sees this epoch or the reads after it see
+  // the new snapshot
+  slot_->store(domain.epoch_.load(), std::memory_order_seq_cst);
+}
+
+EpochDomain::ReadGuard::~ReadGuard() {
+  thread_slot.depth--;
+  if (slot_) {
+    slot_->store(0, std::memory_order_release);
+  }
+}
+
+uint64_t EpochDomain::min_reading_epoch() const {
+  uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+  for (const auto& slot : slots_) {
+    uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0) {
+      min_epoch = std::min(min_epoch, epoch);
+    }
+  }
+  return min_epoch;
+}
+
+void EpochDomain::retire(std::function<void()> deleter) {
+  // the readers of the epochs up to this one may have read the snapshot,
+  // those after it read the one published before the retire
+  uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_.emplace_back(epoch, std::move(deleter));
+  }
+  reclaim();
+}
+
+void EpochDomain::reclaim() {
+  std::vector<std::function<void()>> deleters;
+  {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    uint64_t min_epoch = min_reading_epoch();
+    auto it = std::partition(
+        retired_.begin(), retired_.end(), [&](const auto& retired) {
+          return retired.first >= min_epoch;
+        });
+    for (auto free_it = it; free_it != retired_.end(); ++free_it) {
+      deleters.push_back(std::move(free_it->second));
+    }
+    retired_.erase(it, retired_.end());
+  }
+  for (auto& deleter : deleters) {
+    deleter();
+  }
+}
+
+} // namespace utils
+} // namespace torch_ipex
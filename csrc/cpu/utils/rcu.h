@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+
+Usage:
+
+torch_ipex::utils::RcuMap<Key, Value> cache;
+
+void read_function() {
+    Value value;
+    if (cache.find(key, value)) {
+      // hit, without a lock or a write to a shared cache line
+    }
+}
+
+void write_function() {
+    cache.insert(key, value);
+}
+*/
+
+namespace torch_ipex {
+namespace utils {
+
+// Epoch based reclamation of the snapshots of the read mostly data, e.g. the
+// caches looked up by every call of the inference threads. A reader publishes
+// the global epoch in a slot of its own thread for the time of its read, which
+// is a store to a cache line no other thread writes, and a writer retires the
+// snapshot it replaced at the epoch it bumps to. A snapshot is deleted once no
+// reader is in an epoch it could have been read in, i.e. every published
+// epoch is newer than the one it was retired at.
+class TORCH_API EpochDomain {
+ public:
+  // The threads which may read, a slot being owned by a thread until it exits
+  static constexpr size_t kMaxSlots = 1024;
+
+  static EpochDomain& global();
+
+  // The read side critical section of the calling thread, which may be nested
+  class ReadGuard {
+   public:
+    ReadGuard();
+    ~ReadGuard();
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+   private:
+    std::atomic<uint64_t>* slot_ = nullptr;
+  };
+
+  // Deletes the unlinked snapshot once the readers which may still see it
+  // are done, on a later retire or reclaim
+  void retire(std::function<void()> deleter);
+  // Deletes the retired snapshots no reader can see
+  void reclaim();
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> owned{false};
+  };
+
+  EpochDomain() = default;
+  std::atomic<uint64_t>* acquire_slot();
+  uint64_t min_reading_epoch() const;
+
+  Slot slots_[kMaxSlots];
+  std::atomic<uint64_t> epoch_{1};
+  std::mutex retired_mutex_;
+  std::vector<std::pair<uint64_t, std::function<void()>>> retired_;
+};
+
+// A hash map of lock free reads and copy on write updates: a reader looks up
+// the current snapshot under an epoch guard, a writer copies it, updates the
+// copy and publishes it, the writers being serialized by a mutex. For the
+// caches of few writes, e.g. of the packed weights or the compiled plans, each
+// write costing a copy of the map.
+template <
+    typename Key,
+    typename Value,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>>
+class RcuMap {
+ public:
+  using Map = std::unordered_map<Key, Value, Hash, KeyEqual>;
+
+  RcuMap() : map_(new Map()) {}
+  RcuMap(const RcuMap&) = delete;
+  RcuMap& operator=(const RcuMap&) = delete;
+  ~RcuMap() {
+    delete map_.load(std::memory_order_relaxed);
+  }
+
+  // Copies the value of the key into value, returns whether it is found
+  bool find(const Key& key, Value& value) const {
+    EpochDomain::ReadGuard guard;
+    const Map* map = map_.load(std::memory_order_seq_cst);
+    auto it = map->find(key);
+    if (it == map->end()) {
+      return false;
+    }
+    value = it->second;
+    return true;
+  }
+
+  size_t size() const {
+    EpochDomain::ReadGuard guard;
+    return map_.load(std::memory_order_seq_cst)->size();
+  }
+
+  // Applies f to the key and the value of each entry of the current snapshot
+  template <typename F>
+  void for_each(F&& f) const {
+    EpochDomain::ReadGuard guard;
+    for (const auto& entry : *map_.load(std::memory_order_seq_cst)) {
+      f(entry.first, entry.second);
+    }
+  }
+
+  // Applies f to a copy of the map and publishes the copy
+  template <typename F>
+  void update(F&& f) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const Map* old_map = map_.load(std::memory_order_relaxed);
+    std::unique_ptr<Map> new_map(new Map(*old_map));
+    f(*new_map);
+    map_.store(new_map.release(), std::memory_order_seq_cst);
+    EpochDomain::global().retire([old_map]() { delete old_map; });
+  }
+
+  // Inserts the value unless the key is found, returns the value of the map
+  Value insert(const Key& key, const Value& value) {
+    Value result;
+    if (find(key, result)) {
+      return result;
+    }
+    update([&](Map& map) { result = map.emplace(key, value).first->second; });
+    return result;
+  }
+
+  void erase(const Key& key) {
+    update([&](Map& map) { map.erase(key); });
+  }
+
+  void clear() {
+    update([](Map& map) { map.clear(); });
+  }
+
+ private:
+  std::atomic<const Map*> map_;
+  std::mutex write_mutex_;
+};
+
+} // namespace utils
+} // namespace torch_ipex
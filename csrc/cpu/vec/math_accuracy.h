@@ -0,0 +1,23 @@
+#pragma once
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// Accuracy of the vectorized transcendental functions of vec512_math.h and
+// vec256_math.h (exp, log, tanh, erf, sigmoid), shared by the IPEX kernels in
+// place of their own approximations.
+//
+// Accurate: within 2.5 ULP of the correctly rounded result over the whole
+//   float range (about 1 ULP for exp, log and erf), with the special values
+//   (NaN, +-inf, 0, the denormals) of libm.
+// Fast: shorter polynomials and no special value handling beyond NaN
+//   propagation, within 6 ULP for the normal inputs and the results from
+//   2 * FLT_MIN (erf within 6e-7 absolute); exp flushes its results below
+//   about 1.4 * FLT_MIN to 0. Enough for the kernels rounding their results
+//   to bf16 or fp16 anyway.
+enum class MathAccuracy { Fast, Accurate };
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,3 +1,5 @@
 #include "vec256_bfloat16.h"
+#include "vec256_copy_ker.h"
 #include "vec256_int8.h"
+#include "vec256_math.h"
 #include "vec256_prefix_sum_ker.h"
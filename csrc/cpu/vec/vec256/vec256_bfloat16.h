@@ -4,6 +4,33 @@
 
 using namespace at::vec;
 
+// Conversion from BF16 to FP32
+inline __m256 cvt_bf16_to_fp32(const __m128i src) {
+  auto y = _mm256_cvtepu16_epi32(src);
+  return _mm256_castsi256_ps(_mm256_slli_epi32(y, 16));
+}
+
+// Conversion from FP32 to BF16, rounding to nearest even
+inline __m128i cvt_fp32_to_bf16(const __m256 src) {
+  __m256i value = _mm256_castps_si256(src);
+  __m256i nan = _mm256_set1_epi32(0xffff);
+  auto mask_value = _mm256_castps_si256(_mm256_cmp_ps(src, src, _CMP_ORD_Q));
+  __m256i ones = _mm256_set1_epi32(0x1);
+  __m256i vec_bias = _mm256_set1_epi32(0x7fff);
+  // uint32_t lsb = (input >> 16) & 1;
+  auto t_value = _mm256_and_si256(_mm256_srli_epi32(value, 16), ones);
+  // uint32_t rounding_bias = 0x7fff + lsb;
+  t_value = _mm256_add_epi32(t_value, vec_bias);
+  // input += rounding_bias;
+  t_value = _mm256_add_epi32(t_value, value);
+  // input = input >> 16;
+  t_value = _mm256_srli_epi32(t_value, 16);
+  // Check NaN before converting back to bf16
+  t_value = _mm256_blendv_epi8(nan, t_value, mask_value);
+  t_value = _mm256_packus_epi32(t_value, t_value);
+  return _mm256_castsi256_si128(_mm256_permute4x64_epi64(t_value, 0xd8));
+}
+
 inline void cvt_bf16_to_fp32(float* dst, const at::BFloat16* src, int len) {
   for (int j = 0; j < len; j++) {
     *(dst + j) = *(src + j);
@@ -77,6 +104,38 @@ unpack_float_bfloat16(const Vectorized<float>& a, const Vectorized<float>& b) {
   y1 = _mm256_permute4x64_epi64(y1, 0xd8);
   return std::make_tuple(y0, y1);
 }
+
+// Rounds a to bf16 stochastically: the 16 random bits of noise are added to
+// the fp32 bits before the low half is dropped, so a is rounded up with the
+// probability of its distance to the bf16 below it. NaNs are kept.
+inline at::BFloat16 stochastic_round_float_bfloat16(float a, uint32_t noise) {
+  if (std::isnan(a)) {
+    return at::BFloat16(a);
+  }
+  uint32_t* ap = reinterpret_cast<uint32_t*>(&a);
+  return at::BFloat16(
+      static_cast<uint16_t>((*ap + (noise & 0xffff)) >> 16),
+      at::BFloat16::from_bits());
+}
+
+// a and b rounded to bf16 stochastically, noise_a and noise_b holding 16
+// random bits per lane. The rounded fp32 values are bf16 values, so their
+// conversion is exact.
+inline Vectorized<at::BFloat16> stochastic_round_float_bfloat16(
+    const Vectorized<float>& a,
+    const Vectorized<float>& b,
+    const Vectorized<int32_t>& noise_a,
+    const Vectorized<int32_t>& noise_b) {
+  __m256i mask = _mm256_set1_epi32(static_cast<int>(0xffff0000));
+  auto round = [&](const __m256& x, const __m256i& noise) {
+    __m256i y = _mm256_add_epi32(_mm256_castps_si256(x), noise);
+    __m256 rounded = _mm256_castsi256_ps(_mm256_and_si256(y, mask));
+    __m256 ordered = _mm256_cmp_ps(x, x, _CMP_ORD_Q);
+    return Vectorized<float>(_mm256_blendv_ps(x, rounded, ordered));
+  };
+  return convert_float_bfloat16(
+      round(__m256(a), __m256i(noise_a)), round(__m256(b), __m256i(noise_b)));
+}
 } // namespace CPU_CAPABILITY
 } // namespace vec
 } // namespace at
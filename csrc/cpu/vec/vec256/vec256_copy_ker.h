@@ -0,0 +1,99 @@
+#pragma once
+#include <ATen/cpu/vec/vec.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// Dtype agnostic copy of len elements of T, 32 bytes per step.
+template <typename T>
+inline __attribute__((always_inline)) void copy_ker(
+    T* out,
+    const T* in,
+    int64_t len) {
+  auto dst = reinterpret_cast<char*>(out);
+  auto src = reinterpret_cast<const char*>(in);
+  int64_t size = len * sizeof(T);
+  int64_t i = 0;
+#pragma unroll(4)
+  for (; i < size - 31; i += 32) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dst + i),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+  }
+  std::memcpy(dst + i, src + i, size - i);
+}
+
+// copy_ker with non-temporal stores, for the outputs much bigger than the LLC
+// which are not read again soon. The head aligns out to 32 bytes.
+template <typename T>
+inline __attribute__((always_inline)) void stream_copy_ker(
+    T* out,
+    const T* in,
+    int64_t len) {
+  auto dst = reinterpret_cast<char*>(out);
+  auto src = reinterpret_cast<const char*>(in);
+  int64_t size = len * sizeof(T);
+  int64_t i = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+  i = std::min(i, size);
+  std::memcpy(dst, src, i);
+  for (; i < size - 31; i += 32) {
+    _mm256_stream_si256(
+        reinterpret_cast<__m256i*>(dst + i),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+  }
+  std::memcpy(dst + i, src + i, size - i);
+  _mm_sfence();
+}
+
+// Stores the vector with a non-temporal store when dst is 32 bytes aligned.
+// The caller issues _mm_sfence() after its last streaming store.
+template <typename T>
+inline __attribute__((always_inline)) void stream_storeu(
+    T* dst,
+    const at::vec::Vectorized<T>& v) {
+  static_assert(
+      sizeof(at::vec::Vectorized<T>) == 32, "expect a 256 bit vector");
+  if ((reinterpret_cast<uintptr_t>(dst) & 31) == 0) {
+    _mm256_stream_si256(
+        reinterpret_cast<__m256i*>(dst),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v)));
+  } else {
+    v.store(dst);
+  }
+}
+
+// Stores the vector with stream_storeu when streaming, else with a regular
+// store
+template <typename T>
+inline __attribute__((always_inline)) void store_vec(
+    T* dst,
+    const at::vec::Vectorized<T>& v,
+    bool streaming) {
+  if (streaming) {
+    stream_storeu(dst, v);
+  } else {
+    v.store(dst);
+  }
+}
+
+// Rounds the bound of the chunk of a parallel loop over data up to the next
+// element at a 32 bytes aligned address, within end, so that the streaming
+// stores of every thread are aligned. The chunks stay adjacent as long as
+// each bound is rounded the same way by the two threads sharing it.
+template <typename T>
+inline int64_t align_chunk_bound(const T* data, int64_t index, int64_t end) {
+  auto addr = reinterpret_cast<uintptr_t>(data + index);
+  int64_t offset = ((32 - (addr & 31)) & 31) / sizeof(T);
+  return std::min(index + offset, end);
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,5 +1,8 @@
 #pragma once
 #include <cstdlib>
+#include <cstring>
+
+#include <immintrin.h>
 
 namespace torch_ipex {
 namespace cpu {
@@ -60,6 +63,66 @@ static inline __attribute__((always_inline)) int8_t _dot_s8s8_scale_s32s8(
   return (int8_t)c;
 }
 
+/**
+ * dequantize one row-wise quantized uint8 row and accumulate it into "inout"
+ * inout[i] += in[i] * scale + bias
+ */
+static inline __attribute__((always_inline)) void rowwise_dequant_int8_add_ker(
+    float* inout,
+    const uint8_t* in,
+    float scale,
+    float bias,
+    int64_t len) {
+  auto vscale = _mm256_set1_ps(scale);
+  auto vbias = _mm256_set1_ps(bias);
+  int64_t i = 0;
+  for (i = 0; i < len - 7; i += 8) {
+    auto q = _mm256_cvtepi32_ps(
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i*)(in + i))));
+    auto out = _mm256_loadu_ps(inout + i);
+    out = _mm256_add_ps(out, _mm256_fmadd_ps(q, vscale, vbias));
+    _mm256_storeu_ps(inout + i, out);
+  }
+
+  for (; i < len; i++) {
+    inout[i] += in[i] * scale + bias;
+  }
+}
+
+/**
+ * dequantize one row-wise quantized int4 row (2 elements per byte, element 2k
+ * in the low nibble and element 2k + 1 in the high nibble) and accumulate it
+ * into "inout"
+ */
+static inline __attribute__((always_inline)) void rowwise_dequant_int4_add_ker(
+    float* inout,
+    const uint8_t* in,
+    float scale,
+    float bias,
+    int64_t len) {
+  auto vscale = _mm256_set1_ps(scale);
+  auto vbias = _mm256_set1_ps(bias);
+  auto low_mask = _mm_set1_epi8(0x0f);
+  int64_t i = 0;
+  for (i = 0; i < len - 7; i += 8) {
+    // 8 int4 elements are packed into 4 bytes
+    int32_t packed_bits;
+    std::memcpy(&packed_bits, in + i / 2, sizeof(int32_t));
+    auto packed = _mm_cvtsi32_si128(packed_bits);
+    auto lo = _mm_and_si128(packed, low_mask);
+    auto hi = _mm_and_si128(_mm_srli_epi16(packed, 4), low_mask);
+    auto q = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_unpacklo_epi8(lo, hi)));
+    auto out = _mm256_loadu_ps(inout + i);
+    out = _mm256_add_ps(out, _mm256_fmadd_ps(q, vscale, vbias));
+    _mm256_storeu_ps(inout + i, out);
+  }
+
+  for (; i < len; i++) {
+    uint8_t q = (in[i / 2] >> ((i % 2) * 4)) & 0x0f;
+    inout[i] += q * scale + bias;
+  }
+}
+
 } // namespace kernel
 } // namespace cpu
 } // namespace torch_ipex
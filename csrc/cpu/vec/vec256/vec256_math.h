@@ -0,0 +1,373 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "../math_accuracy.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// The AVX2 versions of the functions of vec512_math.h, with the same
+// algorithms and accuracy
+
+inline __m256 _abs_ps(__m256 x) {
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.f), x);
+}
+
+inline __m256 _sign_ps(__m256 x) {
+  return _mm256_and_ps(x, _mm256_set1_ps(-0.f));
+}
+
+// 2^n of the integer n in [-126, 127]
+inline __m256 _pow2_ps(__m256i n) {
+  return _mm256_castsi256_ps(
+      _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+}
+
+// exp(x) = 2^n * exp(r), n = round(x / ln2), |r| <= ln2 / 2
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m256 _exp_ps(__m256 x);
+
+template <>
+inline __m256 _exp_ps<MathAccuracy::Fast>(__m256 x) {
+  const __m256 vec_ln_flt_min = _mm256_set1_ps(-87.3365479f);
+  const __m256 vec_ln_flt_max = _mm256_set1_ps(88.7228394f);
+  auto less_ln_flt_min_mask = _mm256_cmp_ps(x, vec_ln_flt_min, _CMP_LT_OS);
+  x = _mm256_min_ps(vec_ln_flt_max, x);
+  x = _mm256_max_ps(vec_ln_flt_min, x);
+
+  // fx = floorf(x * log2ef + 0.5)
+  auto vec_fx = _mm256_floor_ps(_mm256_fmadd_ps(
+      x, _mm256_set1_ps(1.44269502f), _mm256_set1_ps(0.5f)));
+  auto vec_r = _mm256_fnmadd_ps(vec_fx, _mm256_set1_ps(0.693147182f), x);
+
+  auto vec_res = _mm256_fmadd_ps(
+      vec_r, _mm256_set1_ps(0.00828929059f), _mm256_set1_ps(0.0418978221f));
+  vec_res = _mm256_fmadd_ps(vec_r, vec_res, _mm256_set1_ps(0.166676521f));
+  vec_res = _mm256_fmadd_ps(vec_r, vec_res, _mm256_set1_ps(0.499991506f));
+  vec_res = _mm256_fmadd_ps(vec_r, vec_res, _mm256_set1_ps(0.999999701f));
+  vec_res = _mm256_fmadd_ps(vec_r, vec_res, _mm256_set1_ps(1.f));
+
+  // 2^(n-1) * 2, 2^n overflowing for x close to ln(FLT_MAX)
+  auto vec_two_pow_n = _pow2_ps(_mm256_sub_epi32(
+      _mm256_cvtps_epi32(vec_fx), _mm256_set1_epi32(1)));
+  vec_two_pow_n = _mm256_blendv_ps(
+      vec_two_pow_n, _mm256_setzero_ps(), less_ln_flt_min_mask);
+
+  vec_res = _mm256_mul_ps(vec_res, vec_two_pow_n);
+  return _mm256_mul_ps(vec_res, _mm256_set1_ps(2.f));
+}
+
+template <>
+inline __m256 _exp_ps<MathAccuracy::Accurate>(__m256 x) {
+  x = _mm256_min_ps(_mm256_set1_ps(89.f), x);
+  x = _mm256_max_ps(_mm256_set1_ps(-104.f), x);
+
+  auto n = _mm256_round_ps(
+      _mm256_mul_ps(x, _mm256_set1_ps(1.44269502f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  auto r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+
+  auto p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.f));
+
+  // n in [-150, 129] scales in two steps to reach the denormals and inf
+  auto n_i = _mm256_cvtps_epi32(n);
+  auto n1 = _mm256_srai_epi32(n_i, 1);
+  auto n2 = _mm256_sub_epi32(n_i, n1);
+  return _mm256_mul_ps(_mm256_mul_ps(p, _pow2_ps(n1)), _pow2_ps(n2));
+}
+
+// log(x) = e * ln2 + log(m), x = m * 2^e, sqrt(1/2) <= m < sqrt(2)
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m256 _log_ps(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  auto xn = x;
+  auto e = _mm256_setzero_ps();
+  if (acc == MathAccuracy::Accurate) {
+    // the denormals are normalized first
+    auto denormal = _mm256_cmp_ps(
+        x, _mm256_set1_ps(std::numeric_limits<float>::min()), _CMP_LT_OQ);
+    xn = _mm256_blendv_ps(
+        x, _mm256_mul_ps(x, _mm256_set1_ps(8388608.f)), denormal);
+    e = _mm256_and_ps(denormal, _mm256_set1_ps(-23.f));
+  }
+  auto bits = _mm256_castps_si256(xn);
+  e = _mm256_add_ps(
+      e,
+      _mm256_cvtepi32_ps(_mm256_sub_epi32(
+          _mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127))));
+  auto m = _mm256_castsi256_ps(_mm256_or_si256(
+      _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+      _mm256_set1_epi32(0x3f800000)));
+  auto above_sqrt2 = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+  m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), above_sqrt2);
+  e = _mm256_add_ps(e, _mm256_and_ps(above_sqrt2, one));
+
+  auto f = _mm256_sub_ps(m, one);
+  auto z = _mm256_mul_ps(f, f);
+  auto p = _mm256_set1_ps(7.0376836292e-2f);
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(3.3333331174e-1f));
+  auto y = _mm256_mul_ps(_mm256_mul_ps(p, f), z);
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  auto res = _mm256_add_ps(f, y);
+  res = _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), res);
+
+  const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+  if (acc == MathAccuracy::Accurate) {
+    // log(+-0) = -inf, log(x < 0) = NaN, log(inf) = inf
+    const __m256 zero = _mm256_setzero_ps();
+    res = _mm256_blendv_ps(
+        res, _mm256_sub_ps(zero, inf), _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+    res = _mm256_blendv_ps(
+        res,
+        _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN()),
+        _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+    res = _mm256_blendv_ps(res, inf, _mm256_cmp_ps(x, inf, _CMP_EQ_OQ));
+  }
+  // NaN propagates, its exponent bits reading as 128
+  return _mm256_blendv_ps(res, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m256 _tanh_ps(__m256 x);
+
+template <>
+inline __m256 _tanh_ps<MathAccuracy::Fast>(__m256 x) {
+  auto tiny =
+      _mm256_cmp_ps(_abs_ps(x), _mm256_set1_ps(0.0004f), _CMP_LT_OQ);
+  auto c = _mm256_min_ps(_mm256_set1_ps(7.90531110f), x);
+  c = _mm256_max_ps(_mm256_set1_ps(-7.90531110f), c);
+  auto c2 = _mm256_mul_ps(c, c);
+  auto p = _mm256_set1_ps(-2.76076847742355e-16f);
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(2.00018790482477e-13f));
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(-8.60467152213735e-11f));
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(5.12229709037114e-08f));
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(1.48572235717979e-05f));
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(6.37261928875436e-04f));
+  p = _mm256_fmadd_ps(c2, p, _mm256_set1_ps(4.89352455891786e-03f));
+  p = _mm256_mul_ps(c, p);
+  auto q = _mm256_set1_ps(1.19825839466702e-06f);
+  q = _mm256_fmadd_ps(c2, q, _mm256_set1_ps(1.18534705686654e-04f));
+  q = _mm256_fmadd_ps(c2, q, _mm256_set1_ps(2.26843463243900e-03f));
+  q = _mm256_fmadd_ps(c2, q, _mm256_set1_ps(4.89352518554385e-03f));
+  return _mm256_blendv_ps(_mm256_div_ps(p, q), x, tiny);
+}
+
+template <>
+inline __m256 _tanh_ps<MathAccuracy::Accurate>(__m256 x) {
+  auto ax = _abs_ps(x);
+  auto z = _mm256_mul_ps(x, x);
+  auto p = _mm256_set1_ps(-5.70498872745e-3f);
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(2.06390887954e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-5.37397155531e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(1.33314422036e-1f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-3.33332819422e-1f));
+  auto small = _mm256_fmadd_ps(_mm256_mul_ps(p, z), x, x);
+  small = _mm256_or_ps(small, _sign_ps(x));
+  const __m256 one = _mm256_set1_ps(1.f);
+  auto e = _exp_ps<MathAccuracy::Accurate>(_mm256_add_ps(ax, ax));
+  auto large = _mm256_sub_ps(
+      one, _mm256_div_ps(_mm256_set1_ps(2.f), _mm256_add_ps(e, one)));
+  large = _mm256_or_ps(large, _sign_ps(x));
+  return _mm256_blendv_ps(
+      large, small, _mm256_cmp_ps(ax, _mm256_set1_ps(0.625f), _CMP_LT_OQ));
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m256 _erf_ps(__m256 x);
+
+template <>
+inline __m256 _erf_ps<MathAccuracy::Fast>(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  auto ax = _abs_ps(x);
+  auto t = _mm256_div_ps(
+      one, _mm256_fmadd_ps(ax, _mm256_set1_ps(0.3275911f), one));
+  auto p = _mm256_set1_ps(1.061405429f);
+  p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-1.453152027f));
+  p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(1.421413741f));
+  p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-0.284496736f));
+  p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.254829592f));
+  p = _mm256_mul_ps(p, t);
+  auto e = _exp_ps<MathAccuracy::Fast>(
+      _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(ax, ax)));
+  auto res = _mm256_fnmadd_ps(p, e, one);
+  return _mm256_or_ps(res, _sign_ps(x));
+}
+
+template <>
+inline __m256 _erf_ps<MathAccuracy::Accurate>(__m256 x) {
+  auto ax = _abs_ps(x);
+  auto s = _mm256_mul_ps(x, x);
+  auto p = _mm256_set1_ps(-5.96761703e-4f);
+  p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(4.99119423e-3f));
+  p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-2.67681349e-2f));
+  p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(1.12819925e-1f));
+  p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-3.76125336e-1f));
+  p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(1.28379166e-1f));
+  auto small = _mm256_fmadd_ps(p, x, x);
+  auto q = _mm256_fmadd_ps(
+      _mm256_set1_ps(-1.72853470e-5f), ax, _mm256_set1_ps(3.83197126e-4f));
+  auto u = _mm256_fmadd_ps(
+      _mm256_set1_ps(-3.88396438e-3f), ax, _mm256_set1_ps(2.42546219e-2f));
+  q = _mm256_fmadd_ps(q, s, u);
+  q = _mm256_fmadd_ps(q, ax, _mm256_set1_ps(-1.06777877e-1f));
+  q = _mm256_fmadd_ps(q, ax, _mm256_set1_ps(-6.34846687e-1f));
+  q = _mm256_fmadd_ps(q, ax, _mm256_set1_ps(-1.28717512e-1f));
+  q = _mm256_fmsub_ps(q, ax, ax);
+  auto large = _mm256_sub_ps(
+      _mm256_set1_ps(1.f), _exp_ps<MathAccuracy::Accurate>(q));
+  large = _mm256_or_ps(large, _sign_ps(x));
+  return _mm256_blendv_ps(
+      large,
+      small,
+      _mm256_cmp_ps(ax, _mm256_set1_ps(0.927734375f), _CMP_LE_OQ));
+}
+
+// 1 / (1 + exp(-x)), and exp(x) / (1 + exp(x)) for the accurate x < 0
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m256 _sigmoid_ps(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  if (acc == MathAccuracy::Accurate) {
+    auto e = _exp_ps<acc>(_mm256_or_ps(x, _mm256_set1_ps(-0.f)));
+    auto num = _mm256_blendv_ps(
+        one, e, _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_div_ps(num, _mm256_add_ps(one, e));
+  }
+  auto e = _exp_ps<acc>(_mm256_sub_ps(_mm256_setzero_ps(), x));
+  return _mm256_div_ps(one, _mm256_add_ps(one, e));
+}
+
+inline __m256 _math_loadu(const float* src) {
+  return _mm256_loadu_ps(src);
+}
+
+inline __m256 _math_loadu(const at::BFloat16* src) {
+  return cvt_bf16_to_fp32(_mm_loadu_si128((const __m128i*)src));
+}
+
+inline __m256 _math_loadu(const at::Half* src) {
+  return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)src));
+}
+
+inline void _math_storeu(float* dst, __m256 x) {
+  _mm256_storeu_ps(dst, x);
+}
+
+inline void _math_storeu(at::BFloat16* dst, __m256 x) {
+  _mm_storeu_si128((__m128i*)dst, cvt_fp32_to_bf16(x));
+}
+
+inline void _math_storeu(at::Half* dst, __m256 x) {
+  _mm_storeu_si128(
+      (__m128i*)dst,
+      _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+
+// The functions on the at::vec::Vectorized<float> of the kernels. Without
+// CPU_CAPABILITY_AVX2, e.g. for the AVX512 kernels built without
+// CPU_CAPABILITY_AVX512, Vectorized<float> is not an AVX2 vector and they fall
+// back to its own functions.
+#if defined(CPU_CAPABILITY_AVX2)
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_exp(const at::vec::Vectorized<float>& x) {
+  return _exp_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_log(const at::vec::Vectorized<float>& x) {
+  return _log_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_tanh(
+    const at::vec::Vectorized<float>& x) {
+  return _tanh_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_erf(const at::vec::Vectorized<float>& x) {
+  return _erf_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_sigmoid(
+    const at::vec::Vectorized<float>& x) {
+  return _sigmoid_ps<acc>(x);
+}
+
+#else
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_exp(const at::vec::Vectorized<float>& x) {
+  return x.exp();
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_log(const at::vec::Vectorized<float>& x) {
+  return x.log();
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_tanh(
+    const at::vec::Vectorized<float>& x) {
+  return x.tanh();
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_erf(const at::vec::Vectorized<float>& x) {
+  return x.erf();
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_sigmoid(
+    const at::vec::Vectorized<float>& x) {
+  return at::vec::Vectorized<float>(1.f) /
+      (at::vec::Vectorized<float>(1.f) + x.neg().exp());
+}
+
+#endif
+
+// out = fn(in) over len elements of float, bf16 or fp16, computed in fp32 by
+// the vector function fn, e.g. _tanh_ps<MathAccuracy::Fast>
+template <typename T, typename Fn>
+inline void unary_math_ker(T* out, const T* in, int64_t len, Fn fn) {
+  int64_t i = 0;
+  for (; i < len - 7; i += 8) {
+    _math_storeu(out + i, fn(_math_loadu(in + i)));
+  }
+  if (i < len) {
+    T buf[8] = {};
+    std::copy(in + i, in + len, buf);
+    _math_storeu(buf, fn(_math_loadu(buf)));
+    std::copy(buf, buf + len - i, out + i);
+  }
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
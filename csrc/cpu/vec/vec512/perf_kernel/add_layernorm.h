@@ -13,10 +13,10 @@ namespace torch_ipex {
 namespace cpu {
 namespace kernel {
 
-template <typename T>
+template <typename T, typename Tb = T>
 std::pair<float, float> _add_and_compute_mean_var(
     const T* a_ptr,
-    const T* b_ptr,
+    const Tb* b_ptr,
     const int& size,
     float* out) {
   // compute add and mean/var of the value after add
@@ -7,76 +7,13 @@
 #include <ATen/Parallel.h>
 #include <c10/util/SmallVector.h>
 #include <limits>
+#include "../vec512_math.h"
 #include "utils.h"
 
 namespace torch_ipex {
 namespace cpu {
 namespace kernel {
 
-inline __m512 _dil_exp_kernel(__m512 vec_src) {
-  static __m512 vec_factorial_1 =
-      _mm512_set1_ps(0.999999701f); // 1/factorial(1)
-  static __m512 vec_factorial_2 =
-      _mm512_set1_ps(0.499991506f); // 1/factorial(2)
-  static __m512 vec_factorial_3 =
-      _mm512_set1_ps(0.166676521f); // 1/factorial(3)
-  static __m512 vec_factorial_4 =
-      _mm512_set1_ps(0.0418978221f); // 1/factorial(4)
-  static __m512 vec_factorial_5 =
-      _mm512_set1_ps(0.00828929059f); // 1/factorial(5)
-  static __m512 vec_exp_log2ef =
-      (__m512)_mm512_set1_epi32(0x3fb8aa3b); // log2(e)
-  static __m512 vec_half = _mm512_set1_ps(0.5f);
-  static __m512 vec_one = _mm512_set1_ps(1.f);
-  static __m512 vec_zero = _mm512_set1_ps(0.f);
-  static __m512 vec_two = _mm512_set1_ps(2.f);
-  static __m512 vec_ln2f = (__m512)_mm512_set1_epi32(0x3f317218); // ln(2)
-  static __m512 vec_ln_flt_min = (__m512)_mm512_set1_epi32(0xc2aeac50);
-  static __m512 vec_ln_flt_max = (__m512)_mm512_set1_epi32(0x42b17218);
-  static __m512i vec_127 = _mm512_set1_epi32(0x0000007f);
-  static int n_mantissa_bits = 23;
-
-  // exp(x) =
-  // = exp(n * ln(2) + r) // divide x by ln(2) and get quot and rem
-  // = 2^n * exp(r) // simplify the exp(n*ln(2)) expression
-
-  auto less_ln_flt_min_mask =
-      _mm512_cmp_ps_mask(vec_src, vec_ln_flt_min, 1 /*_CMP_LT_OS*/);
-  vec_src = _mm512_min_ps(vec_src, vec_ln_flt_max);
-  vec_src = _mm512_max_ps(vec_src, vec_ln_flt_min);
-
-  // fx = floorf(x * log2ef + 0.5)
-  auto vec_fx = _mm512_fmadd_ps(vec_src, vec_exp_log2ef, vec_half);
-  auto vec_fx_i = _mm512_cvt_roundps_epi32(
-      vec_fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
-  vec_fx = _mm512_cvtepi32_ps(vec_fx_i);
-
-  // x = x - fx * ln2
-  auto vec_exp_poly = _mm512_fnmadd_ps(vec_fx, vec_ln2f, vec_src);
-
-  // compute polynomial
-  auto vec_res =
-      _mm512_fmadd_ps(vec_exp_poly, vec_factorial_5, vec_factorial_4);
-  vec_res = _mm512_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_3);
-  vec_res = _mm512_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_2);
-  vec_res = _mm512_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_1);
-  vec_res = _mm512_fmadd_ps(vec_exp_poly, vec_res, vec_one);
-
-  // compute 2^(n-1)
-  auto vec_exp_number = _mm512_sub_ps(vec_fx, vec_one);
-  auto vec_exp_number_i = _mm512_cvtps_epi32(vec_exp_number);
-  auto vec_two_pow_n_i = _mm512_add_epi32(vec_exp_number_i, vec_127);
-  vec_two_pow_n_i = _mm512_slli_epi32(vec_two_pow_n_i, n_mantissa_bits);
-  auto vec_two_pow_n = (__m512)vec_two_pow_n_i;
-  vec_two_pow_n =
-      _mm512_mask_blend_ps(less_ln_flt_min_mask, vec_two_pow_n, vec_zero);
-
-  // y = y * 2^n
-  vec_res = _mm512_mul_ps(vec_res, vec_two_pow_n);
-  vec_res = _mm512_mul_ps(vec_res, vec_two);
-  return vec_res;
-}
-
 /**
  * Previously vec_ps_min was set to std::numeric_limits<float>::min(),
  * the smallest positive number (FLT_MIN). This was wrong for ReduceMax
@@ -178,7 +115,7 @@ inline void _dil_exp_reduce_sum_fusion_kernel(
   for (; i <= size - 16; i += 16) {
     vec_a = _mm512_loadu_ps(a + i);
     vec_out = _mm512_sub_ps(vec_a, vec_max);
-    vec_out = _dil_exp_kernel(vec_out);
+    vec_out = _exp_ps(vec_out);
     vec_sum = _mm512_add_ps(vec_sum, vec_out);
     _mm512_storeu_ps(out + i, vec_out);
   }
@@ -187,7 +124,7 @@ inline void _dil_exp_reduce_sum_fusion_kernel(
     __mmask16 mask = (1 << (size - i)) - 1;
     auto vec_a = _mm512_mask_loadu_ps(vec_max, mask, a + i);
     auto vec_out = _mm512_sub_ps(vec_a, vec_max);
-    vec_out = _dil_exp_kernel(vec_out);
+    vec_out = _exp_ps(vec_out);
     vec_sum = _mm512_mask_add_ps(vec_sum, mask, vec_sum, vec_out);
     _mm512_mask_storeu_ps(out + i, mask, vec_out);
   }
@@ -285,6 +222,105 @@ inline void _dil_mul_reduce_max_fusion_kernel(
   max = _mm512_reduce_max_ps(vec_ps_min);
 }
 
+/**
+ * Online softmax for rows too long to stay in cache: the
+ * max pass + exp-sum pass + normalize pass over a temporary row are
+ * replaced by a single max + sum pass and a normalize pass that both
+ * recompute the logits from the inputs, so the row is never written out
+ * before the final result.
+ * logits(i, mask) returns the 16 logits starting at element i, lanes out
+ * of mask are ignored.
+ **/
+const int online_softmax_min_dim = 8192;
+
+/**
+ * Running max and sum of exp per lane, the sum is rescaled with
+ * exp(max_old - max_new) only when the max of a lane grows.
+ **/
+template <typename logits_fn>
+inline void _dil_online_max_sum_kernel(
+    const logits_fn& logits,
+    const int& size,
+    float& max,
+    float& sum) {
+  auto vec_max = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+  auto vec_sum = _mm512_setzero_ps();
+  int i = 0;
+  for (; i < size; i += 16) {
+    __mmask16 mask = i <= size - 16 ? 0xFFFF : (1 << (size - i)) - 1;
+    auto vec_x = logits(i, mask);
+    auto grow = _mm512_mask_cmp_ps_mask(mask, vec_x, vec_max, _CMP_GT_OQ);
+    if (grow) {
+      auto vec_max_new = _mm512_mask_max_ps(vec_max, grow, vec_x, vec_max);
+      auto vec_scale = _exp_ps(_mm512_sub_ps(vec_max, vec_max_new));
+      vec_sum = _mm512_mask_mul_ps(vec_sum, grow, vec_sum, vec_scale);
+      vec_max = vec_max_new;
+    }
+    auto vec_exp = _exp_ps(_mm512_sub_ps(vec_x, vec_max));
+    vec_sum = _mm512_mask_add_ps(vec_sum, mask, vec_sum, vec_exp);
+  }
+  // NOTE: _mm512_reduce_max_ps is sequence instruction
+  max = _mm512_reduce_max_ps(vec_max);
+  vec_sum = _mm512_mul_ps(
+      vec_sum,
+      _exp_ps(_mm512_sub_ps(vec_max, _mm512_set1_ps(max))));
+  sum = _mm512_reduce_add_ps(vec_sum);
+}
+
+/**
+ * out = exp(logits - max) / sum, with dropout applied when keep is given:
+ * elements of a false keep are zeroed and others scaled by keep_scale.
+ **/
+template <typename scalar_t, typename logits_fn>
+inline void _dil_online_normalization_kernel(
+    const logits_fn& logits,
+    const float& max,
+    const float& sum,
+    const int& size,
+    scalar_t* out,
+    const bool* keep = nullptr,
+    const float& keep_scale = 1.f) {
+  auto vec_max = _mm512_set1_ps(max);
+  auto vec_r_sum = _mm512_set1_ps(keep_scale / sum);
+  int i = 0;
+  for (; i < size; i += 16) {
+    __mmask16 mask = i <= size - 16 ? 0xFFFF : (1 << (size - i)) - 1;
+    auto vec_x = logits(i, mask);
+    auto vec_out = _mm512_mul_ps(
+        _exp_ps(_mm512_sub_ps(vec_x, vec_max)), vec_r_sum);
+    if (keep) {
+      auto vec_keep = _mm_maskz_loadu_epi8(mask, keep + i);
+      vec_out = _mm512_maskz_mov_ps(
+          _mm_test_epi8_mask(vec_keep, vec_keep), vec_out);
+    }
+    _mask_storeu(out + i, vec_out, mask);
+  }
+}
+
+/**
+ * out = a / sum, with dropout applied as in _dil_online_normalization_kernel
+ **/
+template <typename scalar_t>
+inline void _dil_normalization_dropout_kernel(
+    const float* a,
+    const float& sum,
+    const int& size,
+    const bool* keep,
+    const float& keep_scale,
+    scalar_t* out) {
+  auto vec_r_sum = _mm512_set1_ps(keep_scale / sum);
+  int i = 0;
+  for (; i < size; i += 16) {
+    __mmask16 mask = i <= size - 16 ? 0xFFFF : (1 << (size - i)) - 1;
+    auto vec_keep = _mm_maskz_loadu_epi8(mask, keep + i);
+    auto vec_out = _mm512_maskz_mul_ps(
+        _mm_test_epi8_mask(vec_keep, vec_keep),
+        _mm512_maskz_loadu_ps(mask, a + i),
+        vec_r_sum);
+    _mask_storeu(out + i, vec_out, mask);
+  }
+}
+
 inline void _init_mha_buffer_kernel(float* max, float* sum, const int& size) {
   auto vec_ps_min = _mm512_set1_ps(std::numeric_limits<float>::lowest());
   auto vec_zeros = _mm512_setzero_ps();
@@ -1,6 +1,4 @@
 #include "add_layernorm.h"
 #include "add_softmax.h"
-#include "add_swish.h"
-#include "concat_bn_relu.h"
 #include "rmsnorm.h"
 #include "update_batch.h"
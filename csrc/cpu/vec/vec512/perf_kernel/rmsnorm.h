@@ -55,6 +55,92 @@ void _compute_rmsnorm(
   }
 }
 
+// residual_out = a + b, returns the mean of residual_out^2. The rms is
+// computed from the stored (rounded) sum, the same as add followed by
+// RMSNorm.
+template <typename T, typename Tb = T, typename Tout = T>
+float _add_and_compute_mean_pow(
+    const T* a_ptr,
+    const Tb* b_ptr,
+    const int& size,
+    Tout* residual_out_ptr) {
+  auto vec_acc_pow = _mm512_set1_ps(0.0);
+  int i;
+  for (i = 0; i <= size - 16; i += 16) {
+    auto vec_add = _loadu(a_ptr + i) + _loadu(b_ptr + i);
+    _storeu(residual_out_ptr + i, vec_add);
+    vec_add = _loadu(residual_out_ptr + i);
+    vec_acc_pow = _mm512_fmadd_ps(vec_add, vec_add, vec_acc_pow);
+  }
+  if (i < size) {
+    __mmask16 mask = (1 << (size - i)) - 1;
+    auto vec_add =
+        _maskz_loadu(a_ptr + i, mask) + _maskz_loadu(b_ptr + i, mask);
+    _mask_storeu(residual_out_ptr + i, vec_add, mask);
+    vec_add = _maskz_loadu(residual_out_ptr + i, mask);
+    vec_acc_pow = _mm512_fmadd_ps(vec_add, vec_add, vec_acc_pow);
+  }
+  return _mm512_reduce_add_ps(vec_acc_pow) / static_cast<float>(size);
+}
+
+// out = a_ptr * rstd * gamma
+template <typename T, typename T1>
+void _rmsnorm_scale_kernel(
+    const T* a_ptr,
+    const int& size,
+    float rstd,
+    const T1* gamma_ptr,
+    T* out_ptr) {
+  auto vec_scale = _mm512_set1_ps(rstd);
+  int i;
+  for (i = 0; i <= size - 16; i += 16) {
+    auto vec_res = _loadu(a_ptr + i) * vec_scale;
+    if (gamma_ptr) {
+      vec_res = vec_res * _loadu(gamma_ptr + i);
+    }
+    _storeu(out_ptr + i, vec_res);
+  }
+  if (i < size) {
+    __mmask16 mask = (1 << (size - i)) - 1;
+    auto vec_res = _maskz_loadu(a_ptr + i, mask) * vec_scale;
+    if (gamma_ptr) {
+      vec_res = vec_res * _maskz_loadu(gamma_ptr + i, mask);
+    }
+    _mask_storeu(out_ptr + i, vec_res, mask);
+  }
+}
+
+// out = clamp(nearbyint(a_ptr * rstd * gamma / scale) + zero_point), the
+// per tensor affine quantization of the RMSNorm output, Q is int8_t or
+// uint8_t
+template <typename T, typename T1, typename Q>
+void _rmsnorm_quantize_kernel(
+    const T* a_ptr,
+    const int& size,
+    float rstd,
+    const T1* gamma_ptr,
+    float scale,
+    int32_t zero_point,
+    Q* out_ptr) {
+  auto vec_scale = _mm512_set1_ps(rstd / scale);
+  auto vec_zp = _mm512_set1_epi32(zero_point);
+  auto vec_qmin = _mm512_set1_epi32(std::numeric_limits<Q>::min());
+  auto vec_qmax = _mm512_set1_epi32(std::numeric_limits<Q>::max());
+  int i;
+  for (i = 0; i < size; i += 16) {
+    __mmask16 mask = size - i >= 16 ? __mmask16(0xFFFF)
+                                    : __mmask16((1 << (size - i)) - 1);
+    auto vec_res = _maskz_loadu(a_ptr + i, mask) * vec_scale;
+    if (gamma_ptr) {
+      vec_res = vec_res * _maskz_loadu(gamma_ptr + i, mask);
+    }
+    // round to nearest even as at::native::quantize_val
+    auto vec_q = _mm512_add_epi32(_mm512_cvtps_epi32(vec_res), vec_zp);
+    vec_q = _mm512_min_epi32(_mm512_max_epi32(vec_q, vec_qmin), vec_qmax);
+    _mm_mask_storeu_epi8(out_ptr + i, mask, _mm512_cvtepi32_epi8(vec_q));
+  }
+}
+
 } // namespace kernel
 } // namespace cpu
 } // namespace torch_ipex
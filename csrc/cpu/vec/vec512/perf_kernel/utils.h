@@ -36,6 +36,14 @@ inline __m512 _maskz_loadu(const at::BFloat16* data_base, __mmask16 mask) {
   return cvt_bf16_to_fp32(_mm256_maskz_loadu_epi16(mask, (__m256i*)data_base));
 }
 
+inline __m512 _loadu(const at::Half* data_base) {
+  return _mm512_cvtph_ps(_mm256_loadu_si256((__m256i*)data_base));
+}
+
+inline __m512 _maskz_loadu(const at::Half* data_base, __mmask16 mask) {
+  return _mm512_cvtph_ps(_mm256_maskz_loadu_epi16(mask, (__m256i*)data_base));
+}
+
 // below is for aligned data store
 inline void _store_data(float* data_base, __m512 a) {
   _mm512_storeu_ps(data_base, a);
@@ -76,3 +84,15 @@ inline void _mask_storeu(at::BFloat16* data_base, __m512 a, __mmask16 mask) {
   auto vec_bf16_out = cvt_fp32_to_bf16(a);
   _mm256_mask_storeu_epi16(data_base, mask, vec_bf16_out);
 }
+
+inline void _storeu(at::Half* data_base, __m512 a) {
+  auto vec_fp16_out =
+      _mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  _mm256_storeu_si256((__m256i*)data_base, vec_fp16_out);
+}
+
+inline void _mask_storeu(at::Half* data_base, __m512 a, __mmask16 mask) {
+  auto vec_fp16_out =
+      _mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  _mm256_mask_storeu_epi16(data_base, mask, vec_fp16_out);
+}
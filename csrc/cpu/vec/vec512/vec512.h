@@ -1,4 +1,8 @@
 #include "vec512_bfloat16.h"
+#include "vec512_copy_ker.h"
+#include "vec512_half.h"
 #include "vec512_int8.h"
+#include "vec512_math.h"
+#include "vec512_prefix_sum_ker.h"
 
 #include "perf_kernel/kernel.h"
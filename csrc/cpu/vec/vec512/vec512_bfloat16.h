@@ -127,6 +127,39 @@ unpack_float_bfloat16(const Vectorized<float>& a, const Vectorized<float>& b) {
   y1 = _mm512_permutexvar_epi64(idx, y1);
   return std::make_tuple(y0, y1);
 }
+
+// Rounds a to bf16 stochastically: the 16 random bits of noise are added to
+// the fp32 bits before the low half is dropped, so a is rounded up with the
+// probability of its distance to the bf16 below it. NaNs are kept.
+inline at::BFloat16 stochastic_round_float_bfloat16(float a, uint32_t noise) {
+  if (std::isnan(a)) {
+    return at::BFloat16(a);
+  }
+  uint32_t* ap = reinterpret_cast<uint32_t*>(&a);
+  return at::BFloat16(
+      static_cast<uint16_t>((*ap + (noise & 0xffff)) >> 16),
+      at::BFloat16::from_bits());
+}
+
+// a and b rounded to bf16 stochastically, noise_a and noise_b holding 16
+// random bits per lane. The rounded fp32 values are bf16 values, so their
+// conversion is exact, a vcvtneps2bf16 with AVX512-BF16.
+inline Vectorized<at::BFloat16> stochastic_round_float_bfloat16(
+    const Vectorized<float>& a,
+    const Vectorized<float>& b,
+    const Vectorized<int32_t>& noise_a,
+    const Vectorized<int32_t>& noise_b) {
+  __m512i mask = _mm512_set1_epi32(static_cast<int>(0xffff0000));
+  auto round = [&](const __m512& x, const __m512i& noise) {
+    __m512i y = _mm512_add_epi32(_mm512_castps_si512(x), noise);
+    __m512 rounded = _mm512_castsi512_ps(_mm512_and_si512(y, mask));
+    auto ordered = _mm512_cmp_ps_mask(x, x, _CMP_ORD_Q);
+    return _mm512_mask_blend_ps(ordered, x, rounded);
+  };
+  __m256i lo = cvt_fp32_to_bf16(round(__m512(a), __m512i(noise_a)));
+  __m256i hi = cvt_fp32_to_bf16(round(__m512(b), __m512i(noise_b)));
+  return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+}
 } // namespace CPU_CAPABILITY
 } // namespace vec
 } // namespace at
@@ -236,7 +269,7 @@ inline __attribute__((always_inline)) void add_ker(
   }
 
   if (i < len) {
-    auto mask = (1 << (len - i)) - 1;
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto inout1 = cvt_bf16_to_fp32(_mm256_maskz_loadu_epi16(mask, inout + i));
     auto in1 = cvt_bf16_to_fp32(_mm256_maskz_loadu_epi16(mask, in + i));
     inout1 = _mm512_add_ps(inout1, in1);
@@ -270,7 +303,7 @@ inline __attribute__((always_inline)) void add_ker(
   }
 
   if (i < len) {
-    auto mask = (1 << (len - i)) - 1;
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto out1 = _mm512_maskz_loadu_ps(mask, inout + i);
     auto in1 = _mm512_maskz_loadu_ps(mask, in + i);
     _mm512_mask_storeu_ps(inout + i, mask, _mm512_add_ps(out1, in1));
@@ -304,7 +337,7 @@ inline __attribute__((always_inline)) void add_ker(
   }
 
   if (i < len) {
-    auto mask = (1 << (len - i)) - 1;
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto in1 = cvt_bf16_to_fp32(_mm256_maskz_loadu_epi16(mask, in + i));
     auto inout1 = _mm512_maskz_loadu_ps(mask, inout + i);
     inout1 = _mm512_add_ps(inout1, in1);
@@ -340,7 +373,7 @@ static inline __attribute__((always_inline)) void move_ker_load_aligned(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto in0 = cvt_fp32_to_bf16(_mm512_maskz_load_ps(mask, in + i));
     _mm256_mask_storeu_epi16((__m256i*)(out + i), mask, in0);
   }
@@ -396,7 +429,7 @@ inline __attribute__((always_inline)) void move_ker(
   }
 
   if (i < len) {
-    auto mask = (1 << (len - i)) - 1;
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi16(mask, in + i);
     _mm512_mask_storeu_epi16(out + i, mask, in0);
   }
@@ -414,7 +447,7 @@ static inline __attribute__((always_inline)) void move_ker_load_aligned(
   }
 
   if (i < len) {
-    auto mask = (1 << (len - i)) - 1;
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi16(mask, in + i);
     _mm512_mask_storeu_epi16(out + i, mask, in0);
   }
@@ -466,7 +499,7 @@ static inline __attribute__((always_inline)) void zero_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask32 mask = (1u << (len - i)) - 1;
     _mm512_mask_storeu_epi16(out + i, mask, zero_512);
   }
 }
@@ -0,0 +1,108 @@
+#pragma once
+#include <ATen/cpu/vec/vec.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include <immintrin.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// Dtype agnostic copy of len elements of T, 64 bytes per step with a masked
+// tail.
+template <typename T>
+inline __attribute__((always_inline)) void copy_ker(
+    T* out,
+    const T* in,
+    int64_t len) {
+  auto dst = reinterpret_cast<char*>(out);
+  auto src = reinterpret_cast<const char*>(in);
+  int64_t size = len * sizeof(T);
+  int64_t i = 0;
+#pragma unroll(4)
+  for (; i < size - 63; i += 64) {
+    _mm512_storeu_si512(dst + i, _mm512_loadu_si512(src + i));
+  }
+
+  if (i < size) {
+    __mmask64 mask = (1ULL << (size - i)) - 1;
+    _mm512_mask_storeu_epi8(
+        dst + i, mask, _mm512_maskz_loadu_epi8(mask, src + i));
+  }
+}
+
+// copy_ker with non-temporal stores, for the outputs much bigger than the LLC
+// which are not read again soon. A masked head aligns out to 64 bytes.
+template <typename T>
+inline __attribute__((always_inline)) void stream_copy_ker(
+    T* out,
+    const T* in,
+    int64_t len) {
+  auto dst = reinterpret_cast<char*>(out);
+  auto src = reinterpret_cast<const char*>(in);
+  int64_t size = len * sizeof(T);
+  int64_t i = (64 - (reinterpret_cast<uintptr_t>(dst) & 63)) & 63;
+  i = std::min(i, size);
+  if (i > 0) {
+    __mmask64 mask = (1ULL << i) - 1;
+    _mm512_mask_storeu_epi8(dst, mask, _mm512_maskz_loadu_epi8(mask, src));
+  }
+  for (; i < size - 63; i += 64) {
+    _mm512_stream_si512(
+        reinterpret_cast<__m512i*>(dst + i), _mm512_loadu_si512(src + i));
+  }
+
+  if (i < size) {
+    __mmask64 mask = (1ULL << (size - i)) - 1;
+    _mm512_mask_storeu_epi8(
+        dst + i, mask, _mm512_maskz_loadu_epi8(mask, src + i));
+  }
+  _mm_sfence();
+}
+
+// Stores the vector with a non-temporal store when dst is 64 bytes aligned.
+// The caller issues _mm_sfence() after its last streaming store.
+template <typename T>
+inline __attribute__((always_inline)) void stream_storeu(
+    T* dst,
+    const at::vec::Vectorized<T>& v) {
+  static_assert(
+      sizeof(at::vec::Vectorized<T>) == 64, "expect a 512 bit vector");
+  if ((reinterpret_cast<uintptr_t>(dst) & 63) == 0) {
+    _mm512_stream_si512(
+        reinterpret_cast<__m512i*>(dst), _mm512_loadu_si512(&v));
+  } else {
+    v.store(dst);
+  }
+}
+
+// Stores the vector with stream_storeu when streaming, else with a regular
+// store
+template <typename T>
+inline __attribute__((always_inline)) void store_vec(
+    T* dst,
+    const at::vec::Vectorized<T>& v,
+    bool streaming) {
+  if (streaming) {
+    stream_storeu(dst, v);
+  } else {
+    v.store(dst);
+  }
+}
+
+// Rounds the bound of the chunk of a parallel loop over data up to the next
+// element at a 64 bytes aligned address, within end, so that the streaming
+// stores of every thread are aligned. The chunks stay adjacent as long as
+// each bound is rounded the same way by the two threads sharing it.
+template <typename T>
+inline int64_t align_chunk_bound(const T* data, int64_t index, int64_t end) {
+  auto addr = reinterpret_cast<uintptr_t>(data + index);
+  int64_t offset = ((64 - (addr & 63)) & 63) / sizeof(T);
+  return std::min(index + offset, end);
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
@@ -32,7 +32,7 @@ inline __attribute__((always_inline)) void zero_ker(int8_t* out, int64_t len) {
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask64 mask = (1ULL << (len - i)) - 1;
     _mm512_mask_storeu_epi8(out + i, mask, zero_512);
   }
 }
@@ -69,7 +69,7 @@ inline __attribute__((always_inline)) void move_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask32 mask = (1u << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi16(mask, in + i);
     _mm512_mask_storeu_epi16(out + i, mask, in0);
   }
@@ -88,7 +88,7 @@ inline __attribute__((always_inline)) void move_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask64 mask = (1ULL << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi8(mask, in + i);
     _mm512_mask_storeu_epi8(out + i, mask, in0);
   }
@@ -107,7 +107,7 @@ inline __attribute__((always_inline)) void move_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask64 mask = (1ULL << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi8(mask, in + i);
     _mm512_mask_storeu_epi8(out + i, mask, in0);
   }
@@ -126,7 +126,7 @@ inline __attribute__((always_inline)) void move_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask64 mask = (1ULL << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi8(mask, in + i);
     _mm512_mask_storeu_epi8(out + i, mask, in0);
   }
@@ -185,7 +185,7 @@ inline __attribute__((always_inline)) void add_ker(
   }
 
   if (i < len) {
-    auto mask = ((1 << (len - i)) - 1);
+    __mmask64 mask = (1ULL << (len - i)) - 1;
     auto in0 = _mm512_maskz_loadu_epi8(mask, in + i);
     auto out = _mm512_maskz_loadu_epi8(mask, inout + i);
     out = _mm512_adds_epi8(out, in0);
@@ -763,7 +763,7 @@ static inline __attribute__((always_inline)) int8_t _dot_s8s8_scale_s32s8(
     float scale) {
   int32_t c = 0;
   size_t i = 0;
-  for (; i < len - 127; i += 128) {
+  for (; i + 128 <= len; i += 128) {
     c += mul_and_sum_int8_128(a + i, b + i);
   }
   if ((len - i) > 63) {
@@ -899,6 +899,70 @@ static inline void scale_int32_and_store_int8_maskz_16(
   _mm_mask_storeu_epi8((void*)out, mask, out_i8);
 }
 
+/**
+ * dequantize one row-wise quantized uint8 row and accumulate it into "inout"
+ * inout[i] += in[i] * scale + bias
+ */
+static inline __attribute__((always_inline)) void rowwise_dequant_int8_add_ker(
+    float* inout,
+    const uint8_t* in,
+    float scale,
+    float bias,
+    int64_t len) {
+  auto vscale = _mm512_set1_ps(scale);
+  auto vbias = _mm512_set1_ps(bias);
+  int64_t i = 0;
+#pragma unroll(2)
+  for (i = 0; i < len - 15; i += 16) {
+    auto q = _mm512_cvtepi32_ps(
+        _mm512_cvtepu8_epi32(_mm_loadu_si128((__m128i*)(in + i))));
+    auto out = _mm512_loadu_ps(inout + i);
+    out = _mm512_add_ps(out, _mm512_fmadd_ps(q, vscale, vbias));
+    _mm512_storeu_ps(inout + i, out);
+  }
+
+  if (i < len) {
+    __mmask16 mask = (1 << (len - i)) - 1;
+    auto q = _mm512_cvtepi32_ps(
+        _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(mask, in + i)));
+    auto out = _mm512_maskz_loadu_ps(mask, inout + i);
+    out = _mm512_add_ps(out, _mm512_fmadd_ps(q, vscale, vbias));
+    _mm512_mask_storeu_ps(inout + i, mask, out);
+  }
+}
+
+/**
+ * dequantize one row-wise quantized int4 row (2 elements per byte, element 2k
+ * in the low nibble and element 2k + 1 in the high nibble) and accumulate it
+ * into "inout"
+ */
+static inline __attribute__((always_inline)) void rowwise_dequant_int4_add_ker(
+    float* inout,
+    const uint8_t* in,
+    float scale,
+    float bias,
+    int64_t len) {
+  auto vscale = _mm512_set1_ps(scale);
+  auto vbias = _mm512_set1_ps(bias);
+  auto low_mask = _mm_set1_epi8(0x0f);
+  int64_t i = 0;
+  for (i = 0; i < len - 15; i += 16) {
+    // 16 int4 elements are packed into 8 bytes
+    auto packed = _mm_loadl_epi64((__m128i*)(in + i / 2));
+    auto lo = _mm_and_si128(packed, low_mask);
+    auto hi = _mm_and_si128(_mm_srli_epi16(packed, 4), low_mask);
+    auto q = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_unpacklo_epi8(lo, hi)));
+    auto out = _mm512_loadu_ps(inout + i);
+    out = _mm512_add_ps(out, _mm512_fmadd_ps(q, vscale, vbias));
+    _mm512_storeu_ps(inout + i, out);
+  }
+
+  for (; i < len; i++) {
+    uint8_t q = (in[i / 2] >> ((i % 2) * 4)) & 0x0f;
+    inout[i] += q * scale + bias;
+  }
+}
+
 } // namespace kernel
 } // namespace cpu
 } // namespace torch_ipex
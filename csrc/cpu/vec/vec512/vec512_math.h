@@ -0,0 +1,317 @@
+#pragma once
+
+#include <ATen/cpu/vec/vec.h>
+
+#include <immintrin.h>
+
+#include <cstdint>
+#include <limits>
+
+#include "../math_accuracy.h"
+#include "perf_kernel/utils.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// exp(x) = 2^n * exp(r), n = round(x / ln2), |r| <= ln2 / 2
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m512 _exp_ps(__m512 x);
+
+template <>
+inline __m512 _exp_ps<MathAccuracy::Fast>(__m512 x) {
+  const __m512 vec_factorial_1 = _mm512_set1_ps(0.999999701f);
+  const __m512 vec_factorial_2 = _mm512_set1_ps(0.499991506f);
+  const __m512 vec_factorial_3 = _mm512_set1_ps(0.166676521f);
+  const __m512 vec_factorial_4 = _mm512_set1_ps(0.0418978221f);
+  const __m512 vec_factorial_5 = _mm512_set1_ps(0.00828929059f);
+  const __m512 vec_exp_log2ef = _mm512_set1_ps(1.44269502f); // log2(e)
+  const __m512 vec_half = _mm512_set1_ps(0.5f);
+  const __m512 vec_one = _mm512_set1_ps(1.f);
+  const __m512 vec_two = _mm512_set1_ps(2.f);
+  const __m512 vec_ln2f = _mm512_set1_ps(0.693147182f); // ln(2)
+  const __m512 vec_ln_flt_min = _mm512_set1_ps(-87.3365479f);
+  const __m512 vec_ln_flt_max = _mm512_set1_ps(88.7228394f);
+  const __m512i vec_127 = _mm512_set1_epi32(0x0000007f);
+
+  // the results below FLT_MIN flush to 0, NaN propagates through the
+  // clamping, min and max returning their second operand for NaN
+  auto less_ln_flt_min_mask =
+      _mm512_cmp_ps_mask(x, vec_ln_flt_min, _CMP_LT_OS);
+  x = _mm512_min_ps(vec_ln_flt_max, x);
+  x = _mm512_max_ps(vec_ln_flt_min, x);
+
+  // fx = floorf(x * log2ef + 0.5)
+  auto vec_fx = _mm512_fmadd_ps(x, vec_exp_log2ef, vec_half);
+  auto vec_fx_i = _mm512_cvt_roundps_epi32(
+      vec_fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  vec_fx = _mm512_cvtepi32_ps(vec_fx_i);
+
+  // r = x - fx * ln2
+  auto vec_r = _mm512_fnmadd_ps(vec_fx, vec_ln2f, x);
+
+  auto vec_res = _mm512_fmadd_ps(vec_r, vec_factorial_5, vec_factorial_4);
+  vec_res = _mm512_fmadd_ps(vec_r, vec_res, vec_factorial_3);
+  vec_res = _mm512_fmadd_ps(vec_r, vec_res, vec_factorial_2);
+  vec_res = _mm512_fmadd_ps(vec_r, vec_res, vec_factorial_1);
+  vec_res = _mm512_fmadd_ps(vec_r, vec_res, vec_one);
+
+  // 2^(n-1) * 2, 2^n overflowing for x close to ln(FLT_MAX)
+  auto vec_two_pow_n_i = _mm512_add_epi32(
+      _mm512_sub_epi32(vec_fx_i, _mm512_set1_epi32(1)), vec_127);
+  vec_two_pow_n_i = _mm512_slli_epi32(vec_two_pow_n_i, 23);
+  auto vec_two_pow_n = _mm512_castsi512_ps(vec_two_pow_n_i);
+  vec_two_pow_n = _mm512_mask_blend_ps(
+      less_ln_flt_min_mask, vec_two_pow_n, _mm512_setzero_ps());
+
+  vec_res = _mm512_mul_ps(vec_res, vec_two_pow_n);
+  return _mm512_mul_ps(vec_res, vec_two);
+}
+
+template <>
+inline __m512 _exp_ps<MathAccuracy::Accurate>(__m512 x) {
+  const __m512 log2e = _mm512_set1_ps(1.44269502f);
+  // ln2 split in a part exact in its product by n and the rest
+  const __m512 ln2_hi = _mm512_set1_ps(0.693359375f);
+  const __m512 ln2_lo = _mm512_set1_ps(-2.12194440e-4f);
+
+  // beyond the bounds the result is 0 or inf anyway
+  x = _mm512_min_ps(_mm512_set1_ps(89.f), x);
+  x = _mm512_max_ps(_mm512_set1_ps(-104.f), x);
+
+  auto n = _mm512_roundscale_ps(
+      _mm512_mul_ps(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  auto r = _mm512_fnmadd_ps(n, ln2_hi, x);
+  r = _mm512_fnmadd_ps(n, ln2_lo, r);
+
+  // exp(r) = 1 + r + r^2 * P(r), the minimax polynomial of Cephes expf
+  auto p = _mm512_set1_ps(1.9875691500e-4f);
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+  p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+  p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), r);
+  p = _mm512_add_ps(p, _mm512_set1_ps(1.f));
+
+  // 2^n scaling down to the denormals and up to inf
+  return _mm512_scalef_ps(p, n);
+}
+
+// log(x) = e * ln2 + log(m), x = m * 2^e, sqrt(1/2) <= m < sqrt(2)
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m512 _log_ps(__m512 x) {
+  const __m512 one = _mm512_set1_ps(1.f);
+  auto m = _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+  auto e = _mm512_getexp_ps(x);
+  auto above_sqrt2 =
+      _mm512_cmp_ps_mask(m, _mm512_set1_ps(1.41421356f), _CMP_GT_OQ);
+  m = _mm512_mask_mul_ps(m, above_sqrt2, m, _mm512_set1_ps(0.5f));
+  e = _mm512_mask_add_ps(e, above_sqrt2, e, one);
+
+  // log(1 + f) = f - f^2 / 2 + f^3 * P(f), the minimax polynomial of Cephes
+  // logf
+  auto f = _mm512_sub_ps(m, one);
+  auto z = _mm512_mul_ps(f, f);
+  auto p = _mm512_set1_ps(7.0376836292e-2f);
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(-1.1514610310e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(1.1676998740e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(-1.2420140846e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(1.4249322787e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(-1.6668057665e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(2.0000714765e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(-2.4999993993e-1f));
+  p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(3.3333331174e-1f));
+  auto y = _mm512_mul_ps(_mm512_mul_ps(p, f), z);
+  y = _mm512_fmadd_ps(e, _mm512_set1_ps(-2.12194440e-4f), y);
+  y = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), y);
+  auto res = _mm512_add_ps(f, y);
+  res = _mm512_fmadd_ps(e, _mm512_set1_ps(0.693359375f), res);
+
+  if (acc == MathAccuracy::Accurate) {
+    // log(+-0) = -inf, log(x < 0) = NaN, log(inf) = inf
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 inf =
+        _mm512_set1_ps(std::numeric_limits<float>::infinity());
+    res = _mm512_mask_blend_ps(
+        _mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ),
+        res,
+        _mm512_sub_ps(zero, inf));
+    res = _mm512_mask_blend_ps(
+        _mm512_cmp_ps_mask(x, zero, _CMP_LT_OQ),
+        res,
+        _mm512_set1_ps(std::numeric_limits<float>::quiet_NaN()));
+    res = _mm512_mask_blend_ps(
+        _mm512_cmp_ps_mask(x, inf, _CMP_EQ_OQ), res, inf);
+  }
+  return res;
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m512 _tanh_ps(__m512 x);
+
+template <>
+inline __m512 _tanh_ps<MathAccuracy::Fast>(__m512 x) {
+  // the [13/6] rational approximation of Eigen, tanh(x) = x for the tiny x
+  // and +-1 beyond the clamping bound in float precision
+  auto tiny = _mm512_cmp_ps_mask(
+      _mm512_abs_ps(x), _mm512_set1_ps(0.0004f), _CMP_LT_OQ);
+  auto c = _mm512_min_ps(_mm512_set1_ps(7.90531110f), x);
+  c = _mm512_max_ps(_mm512_set1_ps(-7.90531110f), c);
+  auto c2 = _mm512_mul_ps(c, c);
+  auto p = _mm512_set1_ps(-2.76076847742355e-16f);
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(2.00018790482477e-13f));
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(-8.60467152213735e-11f));
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(5.12229709037114e-08f));
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(1.48572235717979e-05f));
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(6.37261928875436e-04f));
+  p = _mm512_fmadd_ps(c2, p, _mm512_set1_ps(4.89352455891786e-03f));
+  p = _mm512_mul_ps(c, p);
+  auto q = _mm512_set1_ps(1.19825839466702e-06f);
+  q = _mm512_fmadd_ps(c2, q, _mm512_set1_ps(1.18534705686654e-04f));
+  q = _mm512_fmadd_ps(c2, q, _mm512_set1_ps(2.26843463243900e-03f));
+  q = _mm512_fmadd_ps(c2, q, _mm512_set1_ps(4.89352518554385e-03f));
+  return _mm512_mask_blend_ps(tiny, _mm512_div_ps(p, q), x);
+}
+
+template <>
+inline __m512 _tanh_ps<MathAccuracy::Accurate>(__m512 x) {
+  auto ax = _mm512_abs_ps(x);
+  // |x| < 0.625: x + x^3 * P(x^2), the minimax polynomial of Cephes tanhf
+  auto z = _mm512_mul_ps(x, x);
+  auto p = _mm512_set1_ps(-5.70498872745e-3f);
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(2.06390887954e-2f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-5.37397155531e-2f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(1.33314422036e-1f));
+  p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-3.33332819422e-1f));
+  auto small = _mm512_fmadd_ps(_mm512_mul_ps(p, z), x, x);
+  // tanh(-0) = -0, the sum above rounding it to +0
+  small = _mm512_or_ps(small, _mm512_and_ps(x, _mm512_set1_ps(-0.f)));
+  // else: sign(x) * (1 - 2 / (exp(2|x|) + 1))
+  const __m512 one = _mm512_set1_ps(1.f);
+  auto e = _exp_ps<MathAccuracy::Accurate>(_mm512_add_ps(ax, ax));
+  auto large = _mm512_sub_ps(
+      one, _mm512_div_ps(_mm512_set1_ps(2.f), _mm512_add_ps(e, one)));
+  large = _mm512_or_ps(large, _mm512_and_ps(x, _mm512_set1_ps(-0.f)));
+  return _mm512_mask_blend_ps(
+      _mm512_cmp_ps_mask(ax, _mm512_set1_ps(0.625f), _CMP_LT_OQ),
+      large,
+      small);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m512 _erf_ps(__m512 x);
+
+template <>
+inline __m512 _erf_ps<MathAccuracy::Fast>(__m512 x) {
+  // Abramowitz and Stegun 7.1.26, 1.5e-7 absolute error
+  const __m512 one = _mm512_set1_ps(1.f);
+  auto ax = _mm512_abs_ps(x);
+  auto t = _mm512_div_ps(
+      one, _mm512_fmadd_ps(ax, _mm512_set1_ps(0.3275911f), one));
+  auto p = _mm512_set1_ps(1.061405429f);
+  p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-1.453152027f));
+  p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(1.421413741f));
+  p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-0.284496736f));
+  p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(0.254829592f));
+  p = _mm512_mul_ps(p, t);
+  auto e = _exp_ps<MathAccuracy::Fast>(
+      _mm512_sub_ps(_mm512_setzero_ps(), _mm512_mul_ps(ax, ax)));
+  auto res = _mm512_fnmadd_ps(p, e, one);
+  return _mm512_or_ps(res, _mm512_and_ps(x, _mm512_set1_ps(-0.f)));
+}
+
+template <>
+inline __m512 _erf_ps<MathAccuracy::Accurate>(__m512 x) {
+  // the minimax approximations of erf by N. Juffa, about 1 ULP on both sides
+  // of |x| = 0.927734375
+  auto ax = _mm512_abs_ps(x);
+  auto s = _mm512_mul_ps(x, x);
+  // |x| < 0.927734375: x + x * P(x^2)
+  auto p = _mm512_set1_ps(-5.96761703e-4f);
+  p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(4.99119423e-3f));
+  p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(-2.67681349e-2f));
+  p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(1.12819925e-1f));
+  p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(-3.76125336e-1f));
+  p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(1.28379166e-1f));
+  auto small = _mm512_fmadd_ps(p, x, x);
+  // else: sign(x) * (1 - exp(|x| * Q(|x|) - |x|))
+  auto q = _mm512_fmadd_ps(
+      _mm512_set1_ps(-1.72853470e-5f), ax, _mm512_set1_ps(3.83197126e-4f));
+  auto u = _mm512_fmadd_ps(
+      _mm512_set1_ps(-3.88396438e-3f), ax, _mm512_set1_ps(2.42546219e-2f));
+  q = _mm512_fmadd_ps(q, s, u);
+  q = _mm512_fmadd_ps(q, ax, _mm512_set1_ps(-1.06777877e-1f));
+  q = _mm512_fmadd_ps(q, ax, _mm512_set1_ps(-6.34846687e-1f));
+  q = _mm512_fmadd_ps(q, ax, _mm512_set1_ps(-1.28717512e-1f));
+  q = _mm512_fmsub_ps(q, ax, ax);
+  auto large = _mm512_sub_ps(
+      _mm512_set1_ps(1.f), _exp_ps<MathAccuracy::Accurate>(q));
+  large = _mm512_or_ps(large, _mm512_and_ps(x, _mm512_set1_ps(-0.f)));
+  return _mm512_mask_blend_ps(
+      _mm512_cmp_ps_mask(ax, _mm512_set1_ps(0.927734375f), _CMP_LE_OQ),
+      large,
+      small);
+}
+
+// 1 / (1 + exp(-x)). The accurate one computes exp(x) / (1 + exp(x)) for
+// x < 0, exp(-x) overflowing before the result becomes denormal.
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline __m512 _sigmoid_ps(__m512 x) {
+  const __m512 one = _mm512_set1_ps(1.f);
+  if (acc == MathAccuracy::Accurate) {
+    auto e = _exp_ps<acc>(_mm512_or_ps(x, _mm512_set1_ps(-0.f)));
+    auto num = _mm512_mask_blend_ps(
+        _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), one, e);
+    return _mm512_div_ps(num, _mm512_add_ps(one, e));
+  }
+  auto e = _exp_ps<acc>(_mm512_sub_ps(_mm512_setzero_ps(), x));
+  return _mm512_div_ps(one, _mm512_add_ps(one, e));
+}
+
+// The functions on the at::vec::Vectorized<float> of the kernels
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_exp(const at::vec::Vectorized<float>& x) {
+  return _exp_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_log(const at::vec::Vectorized<float>& x) {
+  return _log_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_tanh(
+    const at::vec::Vectorized<float>& x) {
+  return _tanh_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_erf(const at::vec::Vectorized<float>& x) {
+  return _erf_ps<acc>(x);
+}
+
+template <MathAccuracy acc = MathAccuracy::Fast>
+inline at::vec::Vectorized<float> vec_sigmoid(
+    const at::vec::Vectorized<float>& x) {
+  return _sigmoid_ps<acc>(x);
+}
+
+// out = fn(in) over len elements of float, bf16 or fp16, computed in fp32 by
+// the vector function fn, e.g. _tanh_ps<MathAccuracy::Fast>
+template <typename T, typename Fn>
+inline void unary_math_ker(T* out, const T* in, int64_t len, Fn fn) {
+  int64_t i = 0;
+  for (; i < len - 15; i += 16) {
+    _storeu(out + i, fn(_loadu(in + i)));
+  }
+  if (i < len) {
+    __mmask16 mask = (1 << (len - i)) - 1;
+    _mask_storeu(out + i, fn(_maskz_loadu(in + i, mask)), mask);
+  }
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
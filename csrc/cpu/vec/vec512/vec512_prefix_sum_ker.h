@@ -0,0 +1,49 @@
+#pragma once
+
+#include <immintrin.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+template <>
+inline void prefix_sum<int64_t>(
+    const int64_t* src,
+    int64_t* dst,
+    int64_t init,
+    int64_t n) {
+  int64_t i;
+  __m512i offset = _mm512_set1_epi64(init);
+  // lane k takes lane k - s, and the first s lanes are zeroed
+  const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+  const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+  const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+  const __m512i last = _mm512_set1_epi64(7);
+  for (i = 0; i <= n - 8; i += 8) {
+    // a = {a0, a1, ..., a7}
+    __m512i a = _mm512_loadu_si512(src + i);
+    // x = {a0, a01, a12, ..., a67}
+    __m512i x =
+        _mm512_add_epi64(a, _mm512_maskz_permutexvar_epi64(0xFE, shift1, a));
+    // x = {a0, a01, a012, a0123, a1234, ..., a4567}
+    x = _mm512_add_epi64(
+        x, _mm512_maskz_permutexvar_epi64(0xFC, shift2, x));
+    // x = {a0, a01, ..., a01234567}
+    x = _mm512_add_epi64(
+        x, _mm512_maskz_permutexvar_epi64(0xF0, shift4, x));
+    __m512i y = _mm512_add_epi64(offset, x);
+    _mm512_storeu_si512(dst + i, y);
+
+    // broadcast offset
+    offset = _mm512_permutexvar_epi64(last, y);
+  }
+  int64_t offset_v = i == 0 ? init : dst[i - 1];
+  for (; i < n; i++) {
+    offset_v += src[i];
+    dst[i] = offset_v;
+  }
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
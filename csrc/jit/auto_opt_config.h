@@ -17,9 +17,77 @@ class TORCH_API AutoOptConfig {
     return jit_fuse_;
   }
 
+  // Off by default: grouping the linears of the attention projections would
+  // prevent the MHA fusions, which run later.
+  inline void set_jit_grouped_linear(bool jit_grouped_linear) {
+    jit_grouped_linear_ = jit_grouped_linear;
+  }
+
+  inline bool get_jit_grouped_linear() {
+    return jit_grouped_linear_;
+  }
+
+  // Off by default: plans the outputs of the prepacked linears of the graphs
+  // with static shapes into a per-run arena (PlanFrozenGraphMemory).
+  inline void set_jit_memory_plan(bool jit_memory_plan) {
+    jit_memory_plan_ = jit_memory_plan;
+  }
+
+  inline bool get_jit_memory_plan() {
+    return jit_memory_plan_;
+  }
+
+  // Off by default: has the IPEX ops producing the inputs of a cat write into
+  // their slice of its output (PlanCatOutputViews).
+  inline void set_jit_cat_views(bool jit_cat_views) {
+    jit_cat_views_ = jit_cat_views;
+  }
+
+  inline bool get_jit_cat_views() {
+    return jit_cat_views_;
+  }
+
+  // Off by default: folds the pointwise chains after the prepacked linears
+  // into ipex_prepack::linear_eltwise_chain_run (fuseLinearWithEltwiseChain).
+  inline void set_jit_eltwise_chain_fusion(bool jit_eltwise_chain_fusion) {
+    jit_eltwise_chain_fusion_ = jit_eltwise_chain_fusion;
+  }
+
+  inline bool get_jit_eltwise_chain_fusion() {
+    return jit_eltwise_chain_fusion_;
+  }
+
+  // Off by default: assigns the memory formats of the 4D activations of the
+  // graphs with static shapes by a minimum reorder cut (PropagateChannelsLast).
+  inline void set_jit_channels_last_propagation(
+      bool jit_channels_last_propagation) {
+    jit_channels_last_propagation_ = jit_channels_last_propagation;
+  }
+
+  inline bool get_jit_channels_last_propagation() {
+    return jit_channels_last_propagation_;
+  }
+
+  // Off by default: benchmarks the oneDNN and MKL sgemm kernels of each fp32
+  // linear on its shapes at freezing (SelectLinearBackends).
+  inline void set_jit_linear_backend_selection(
+      bool jit_linear_backend_selection) {
+    jit_linear_backend_selection_ = jit_linear_backend_selection;
+  }
+
+  inline bool get_jit_linear_backend_selection() {
+    return jit_linear_backend_selection_;
+  }
+
  private:
   AutoOptConfig()
       : jit_fuse_(true),
+        jit_grouped_linear_(false),
+        jit_memory_plan_(false),
+        jit_cat_views_(false),
+        jit_eltwise_chain_fusion_(false),
+        jit_channels_last_propagation_(false),
+        jit_linear_backend_selection_(false),
         calibration_step_(false),
         qscheme_(at::QScheme::PER_TENSOR_AFFINE) {}
 
@@ -28,6 +96,12 @@ class TORCH_API AutoOptConfig {
   AutoOptConfig& operator=(const AutoOptConfig&) = default;
 
   bool jit_fuse_;
+  bool jit_grouped_linear_;
+  bool jit_memory_plan_;
+  bool jit_cat_views_;
+  bool jit_eltwise_chain_fusion_;
+  bool jit_channels_last_propagation_;
+  bool jit_linear_backend_selection_;
   // the flag for one iteration of calibration step whether end or not.
   bool calibration_step_;
   at::QScheme qscheme_;
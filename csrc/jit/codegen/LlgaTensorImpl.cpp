@@ -81,6 +81,29 @@ at::Tensor LlgaTensorImpl::llga_to_aten_tensor(
   return aten_tensor;
 }
 
+at::Tensor LlgaTensorImpl::llga_to_dense(const at::Tensor& tensor) {
+  if (!tensor.is_mkldnn())
+    return tensor;
+  auto llgaImpl = static_cast<LlgaTensorImpl*>(tensor.unsafeGetTensorImpl());
+  auto desc = llgaImpl->desc();
+  // The partitions produce strided outputs, thus no reorder is needed
+  c10::Storage storage(llgaImpl->storage_);
+  auto aten_tensor = desc.is_quantized()
+      ? at::detail::make_tensor<at::QTensorImpl>(
+            std::move(storage),
+            c10::DispatchKeySet(c10::DispatchKey::QuantizedCPU),
+            llgaImpl->data_type_,
+            desc.get_quantizer())
+      : at::detail::make_tensor<TensorImpl>(
+            std::move(storage),
+            c10::DispatchKeySet(c10::DispatchKey::CPU),
+            llgaImpl->data_type_);
+  auto impl = aten_tensor.unsafeGetTensorImpl();
+  impl->set_storage_offset(llgaImpl->storage_offset_);
+  impl->set_sizes_and_strides(llgaImpl->sizes(), llgaImpl->strides());
+  return aten_tensor;
+}
+
 using data_type = dnnl::graph::logical_tensor::data_type;
 
 data_type LlgaTensorDesc::getLlgaDataType(at::ScalarType dt) const {
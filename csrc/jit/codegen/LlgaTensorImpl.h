@@ -230,6 +230,10 @@ struct TORCH_API LlgaTensorImpl : public c10::TensorImpl {
   static at::Tensor llga_to_aten_tensor(
       LlgaTensorImpl* llgaImpl,
       at::QuantizerPtr quantizer);
+  // The aten tensor (quantized with the quantizer of the desc if quantized)
+  // aliasing the storage of an LLGA tensor, which keeps its storage, the
+  // tensor itself if not an LLGA tensor
+  static at::Tensor llga_to_dense(const at::Tensor& tensor);
 
  private:
   LlgaTensorDesc desc_;
@@ -0,0 +1,194 @@
+#include "constant_cache.h"
+#include "kernel.h"
+#include "utils/memory_tracker.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+namespace {
+
+std::atomic<bool> shared_weight_cache_enabled{false};
+std::atomic<int64_t> shared_weight_cache_budget{0};
+
+struct SharedConstant {
+  c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl> tensor;
+  int64_t nbytes;
+};
+
+std::mutex shared_cache_mutex;
+// (node, dtype, sizes, content hash) -> the copies of that key
+std::unordered_map<std::string, std::vector<SharedConstant>> shared_constants;
+std::unordered_map<std::string, std::weak_ptr<LlgaCompiledPartition>>
+    shared_compilations;
+
+// FNV-1a of the bytes of t
+uint64_t content_hash(const at::Tensor& t) {
+  auto data = static_cast<const unsigned char*>(t.data_ptr());
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < t.nbytes(); i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string constant_key(const at::Tensor& t, int node) {
+  std::string key = std::to_string(node) + ":" + std::string(t.dtype().name());
+  for (auto d : t.sizes())
+    key += "," + std::to_string(d);
+  return key + ":" + std::to_string(content_hash(t));
+}
+
+// the bytes of the live shared constants, dropping the expired ones
+int64_t live_bytes() {
+  int64_t bytes = 0;
+  for (auto it = shared_constants.begin(); it != shared_constants.end();) {
+    auto& copies = it->second;
+    copies.erase(
+        std::remove_if(
+            copies.begin(),
+            copies.end(),
+            [](const SharedConstant& c) { return c.tensor.expired(); }),
+        copies.end());
+    if (copies.empty()) {
+      it = shared_constants.erase(it);
+      continue;
+    }
+    for (auto& c : copies)
+      bytes += c.nbytes;
+    ++it;
+  }
+  return bytes;
+}
+
+std::vector<int> cpu_nodes() {
+  std::vector<int> nodes;
+  for (int cpu = 0;; cpu++) {
+    auto path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL)
+      break;
+    int node = 0;
+    while (auto entry = readdir(dir)) {
+      if (strncmp(entry->d_name, "node", 4) == 0 &&
+          entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+        node = atoi(entry->d_name + 4);
+        break;
+      }
+    }
+    closedir(dir);
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+} // namespace
+
+bool is_llga_shared_weight_cache_enabled() {
+  return shared_weight_cache_enabled;
+}
+
+void set_llga_shared_weight_cache_enabled(bool new_enabled) {
+  shared_weight_cache_enabled = new_enabled;
+}
+
+void set_llga_shared_weight_cache_budget(int64_t bytes) {
+  TORCH_CHECK(bytes >= 0, "LLGA shared weight cache budget must be >= 0");
+  shared_weight_cache_budget = bytes;
+}
+
+int64_t get_llga_shared_weight_cache_budget() {
+  return shared_weight_cache_budget;
+}
+
+std::tuple<int64_t, int64_t, int64_t> get_llga_shared_weight_cache_stats() {
+  std::lock_guard<std::mutex> guard(shared_cache_mutex);
+  int64_t bytes = live_bytes();
+  int64_t constants = 0;
+  for (auto& entry : shared_constants)
+    constants += entry.second.size();
+  int64_t compilations = 0;
+  for (auto& entry : shared_compilations)
+    compilations += entry.second.expired() ? 0 : 1;
+  return std::make_tuple(bytes, constants, compilations);
+}
+
+void clear_llga_shared_weight_cache() {
+  std::lock_guard<std::mutex> guard(shared_cache_mutex);
+  shared_constants.clear();
+  shared_compilations.clear();
+}
+
+int current_numa_node() {
+  static std::vector<int> nodes = cpu_nodes();
+  int cpu = sched_getcpu();
+  if (cpu < 0 || cpu >= static_cast<int>(nodes.size()))
+    return 0;
+  return nodes[cpu];
+}
+
+at::Tensor share_constant(const at::Tensor& t) {
+  if (!is_llga_shared_weight_cache_enabled() || !t.is_contiguous() ||
+      t.is_mkldnn() || t.is_quantized())
+    return t;
+  auto key = constant_key(t, current_numa_node());
+  std::lock_guard<std::mutex> guard(shared_cache_mutex);
+  auto& copies = shared_constants[key];
+  for (auto& c : copies) {
+    auto impl = c.tensor.lock();
+    if (!impl)
+      continue;
+    at::Tensor shared(std::move(impl));
+    // the hash only selects the candidates
+    if (shared.sizes() == t.sizes() &&
+        memcmp(shared.data_ptr(), t.data_ptr(), t.nbytes()) == 0)
+      return shared;
+  }
+  int64_t budget = shared_weight_cache_budget;
+  if (budget > 0 && live_bytes() + (int64_t)t.nbytes() > budget)
+    return t;
+  // a single-threaded copy, for its pages to be first touched on this node
+  torch_ipex::utils::MemoryScope memory_scope("llga::shared_constants");
+  auto shared = at::empty(t.sizes(), t.options());
+  memcpy(shared.data_ptr(), t.data_ptr(), t.nbytes());
+  shared_constants[key].push_back(
+      {c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>(
+           shared.getIntrusivePtr()),
+       (int64_t)t.nbytes()});
+  return shared;
+}
+
+std::shared_ptr<LlgaCompiledPartition> find_shared_compilation(
+    const std::string& key) {
+  std::lock_guard<std::mutex> guard(shared_cache_mutex);
+  auto iter = shared_compilations.find(key);
+  if (iter == shared_compilations.end())
+    return nullptr;
+  auto compiled = iter->second.lock();
+  if (!compiled)
+    shared_compilations.erase(iter);
+  return compiled;
+}
+
+void register_shared_compilation(
+    const std::string& key,
+    const std::shared_ptr<LlgaCompiledPartition>& compiled) {
+  std::lock_guard<std::mutex> guard(shared_cache_mutex);
+  shared_compilations[key] = compiled;
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <memory>
+#include <string>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+struct LlgaCompiledPartition;
+
+// Process-wide sharing of the constant weights of the LLGA kernels, for the
+// copies of a model loaded in one process (one per stream or instance): the
+// kernels of equal subgraphs share their constant inputs, keyed by content,
+// and their compiled partitions, and with them the reordered (and quantized)
+// weights oneDNN graph caches per compiled partition. The shared copies are
+// per NUMA node, placed on the node of the thread which first needs them.
+TORCH_API bool is_llga_shared_weight_cache_enabled();
+
+TORCH_API void set_llga_shared_weight_cache_enabled(bool new_enabled);
+
+// The max bytes of the shared constant inputs, the next ones staying private
+// to their kernels (unlimited when 0, the default)
+TORCH_API void set_llga_shared_weight_cache_budget(int64_t bytes);
+
+TORCH_API int64_t get_llga_shared_weight_cache_budget();
+
+// The bytes and the number of the live shared constant inputs, and the
+// number of the live shared compiled partitions
+TORCH_API std::tuple<int64_t, int64_t, int64_t>
+get_llga_shared_weight_cache_stats();
+
+TORCH_API void clear_llga_shared_weight_cache();
+
+// The NUMA node of the CPU of the calling thread, 0 when unknown
+int current_numa_node();
+
+// The shared copy of the content of t on the current node, t itself when
+// disabled, over budget or not contiguous
+at::Tensor share_constant(const at::Tensor& t);
+
+// The live compiled partition shared under key, else nullptr
+std::shared_ptr<LlgaCompiledPartition> find_shared_compilation(
+    const std::string& key);
+
+void register_shared_compilation(
+    const std::string& key,
+    const std::shared_ptr<LlgaCompiledPartition>& compiled);
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -15,6 +15,11 @@ const std::string& LlgaGuardName() {
   return LlgaGuardName;
 }
 
+const std::string& LlgaToDenseName() {
+  static const std::string LlgaToDenseName = "ipex::LlgaToDense";
+  return LlgaToDenseName;
+}
+
 } // namespace onednn
 } // namespace fuser
 } // namespace jit
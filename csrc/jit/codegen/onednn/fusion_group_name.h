@@ -14,6 +14,9 @@ namespace onednn {
 // Symbol::fromQualString(LlgaGuardName())
 extern const std::string& LlgaFusionGroupName();
 extern const std::string& LlgaGuardName();
+// The conversion of the LLGA tensor of a partition output to an aten tensor,
+// for the users of the output other than partitions
+extern const std::string& LlgaToDenseName();
 
 } // namespace onednn
 } // namespace fuser
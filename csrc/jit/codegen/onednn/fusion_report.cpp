@@ -0,0 +1,108 @@
+#include "fusion_report.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+namespace {
+
+std::atomic<bool> fusion_report_enabled{false};
+
+std::mutex fusion_report_mutex;
+// by the debug name of the kernels
+std::map<std::string, LlgaPartitionReport> partition_reports;
+std::vector<LlgaUnfusedOp> unfused_ops;
+std::set<std::tuple<std::string, std::string, std::string>> unfused_keys;
+
+LlgaPartitionReport& partition_report(
+    const std::string& name,
+    const std::string& ops) {
+  auto& report = partition_reports[name];
+  if (report.name.empty()) {
+    report.name = name;
+    report.ops = ops;
+  }
+  return report;
+}
+
+} // namespace
+
+bool is_llga_fusion_report_enabled() {
+  return fusion_report_enabled;
+}
+
+void set_llga_fusion_report_enabled(bool new_enabled) {
+  fusion_report_enabled = new_enabled;
+}
+
+std::vector<LlgaPartitionReport> get_llga_partition_reports() {
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  std::vector<LlgaPartitionReport> reports;
+  for (auto& entry : partition_reports)
+    reports.push_back(entry.second);
+  return reports;
+}
+
+std::vector<LlgaUnfusedOp> get_llga_unfused_ops() {
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  return unfused_ops;
+}
+
+void reset_llga_fusion_report() {
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  partition_reports.clear();
+  unfused_ops.clear();
+  unfused_keys.clear();
+}
+
+void record_llga_unfused_op(const torch::jit::Node* node, std::string reason) {
+  if (!is_llga_fusion_report_enabled() || !node->kind().is_aten())
+    return;
+  std::string op = node->kind().toQualString();
+  std::string scope = node->scope() ? node->scope()->namesFromRoot() : "";
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  // the graph is partitioned again by the rewrites of the nested blocks
+  if (!unfused_keys.emplace(op, reason, scope).second)
+    return;
+  unfused_ops.push_back({op, std::move(reason), scope});
+}
+
+void record_llga_partition_compilation(
+    const std::string& name,
+    const std::string& ops,
+    double compile_ms) {
+  if (!is_llga_fusion_report_enabled())
+    return;
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  auto& report = partition_report(name, ops);
+  report.compilations++;
+  report.compile_ms += compile_ms;
+}
+
+void record_llga_partition_run(
+    const std::string& name,
+    const std::string& ops,
+    double run_ms,
+    int64_t input_bytes,
+    int64_t output_bytes) {
+  if (!is_llga_fusion_report_enabled())
+    return;
+  std::lock_guard<std::mutex> guard(fusion_report_mutex);
+  auto& report = partition_report(name, ops);
+  report.runs++;
+  report.run_ms += run_ms;
+  report.input_bytes += input_bytes;
+  report.output_bytes += output_bytes;
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
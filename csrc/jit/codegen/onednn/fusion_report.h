@@ -0,0 +1,64 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+// The fusion report: the partitions of the LLGA kernels with their runtime
+// stats, and the aten nodes left out of the partitions with the reason, as
+// recorded while enabled (disabled by default).
+TORCH_API bool is_llga_fusion_report_enabled();
+
+TORCH_API void set_llga_fusion_report_enabled(bool new_enabled);
+
+struct LlgaPartitionReport {
+  // the debug name and the aten ops of the kernel
+  std::string name;
+  std::string ops;
+  int64_t compilations = 0;
+  double compile_ms = 0;
+  // the calls executing a compiled partition
+  int64_t runs = 0;
+  double run_ms = 0;
+  // the bytes of the inputs (constants excluded) and outputs of the runs
+  int64_t input_bytes = 0;
+  int64_t output_bytes = 0;
+};
+
+struct LlgaUnfusedOp {
+  std::string op;
+  std::string reason;
+  // the module scope of the node, empty when unknown
+  std::string scope;
+};
+
+TORCH_API std::vector<LlgaPartitionReport> get_llga_partition_reports();
+
+TORCH_API std::vector<LlgaUnfusedOp> get_llga_unfused_ops();
+
+TORCH_API void reset_llga_fusion_report();
+
+// Records that node is not fused for reason, once per op, reason and scope
+void record_llga_unfused_op(const torch::jit::Node* node, std::string reason);
+
+void record_llga_partition_compilation(
+    const std::string& name,
+    const std::string& ops,
+    double compile_ms);
+
+void record_llga_partition_run(
+    const std::string& name,
+    const std::string& ops,
+    double run_ms,
+    int64_t input_bytes,
+    int64_t output_bytes);
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
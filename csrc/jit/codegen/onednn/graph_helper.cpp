@@ -1,11 +1,13 @@
 #include "graph_helper.h"
 #include "fusion_group_name.h"
+#include "fusion_report.h"
 #include "utils.h"
 
 #include "codegen/LlgaTensorImpl.h"
 #include "codegen/onednn/interface.h"
 
 #include <ATen/core/functional.h>
+#include <numeric>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 
@@ -70,10 +72,14 @@ Operator makeWildcardOp(Node* node) {
   return o;
 }
 
-#define REQ(cond)                                     \
-  if (!(cond)) {                                      \
-    GRAPH_DEBUG("Unsupported condition " #cond "\n"); \
-    return makeWildcardOp(node);                      \
+// Why createOperator last made a node a wildcard, for the fusion report
+static thread_local const char* wildcard_reason = nullptr;
+
+#define REQ(cond)                                      \
+  if (!(cond)) {                                       \
+    GRAPH_DEBUG("Unsupported condition " #cond "\n");  \
+    wildcard_reason = "unsupported condition: " #cond; \
+    return makeWildcardOp(node);                       \
   }
 
 Operator makeEltwiseOp(Node* node, opkind kind) {
@@ -319,6 +325,7 @@ Operator LlgaGraphHelper::createOperator(Node* node) const {
         .setOutput(0)
         .setAttr("axis", axis);
   } else if (nodeKind == Symbol::aten("cat")) {
+    wildcard_reason = "Concat is not supported yet";
     return makeWildcardOp(node); // TODO: remove once Concat is supported
 
     auto o = Operator(node, opkind::Concat);
@@ -454,6 +461,26 @@ Operator LlgaGraphHelper::createOperator(Node* node) const {
           .setOutput(0)
           .setAttr("order", toIValue(node->input(1))->toIntVector());
     }
+  } else if (nodeKind == Symbol::aten("transpose")) {
+    // The transposed keys of the attention, for matmul -> softmax -> matmul
+    // to be matched as a whole
+    REQ(aliasDb_->hasInputWriters(node) == false);
+    auto rank = getDimensions(node->input(0));
+    REQ(rank.has_value());
+    REQ(toIValue(node->input(1)) && toIValue(node->input(2)));
+    int64_t dim0 = Operator::Int(node, 1);
+    int64_t dim1 = Operator::Int(node, 2);
+    if (dim0 < 0)
+      dim0 += rank.value();
+    if (dim1 < 0)
+      dim1 += rank.value();
+    std::vector<int64_t> order(rank.value());
+    std::iota(order.begin(), order.end(), 0);
+    std::swap(order[dim0], order[dim1]);
+    return Operator(node, opkind::StaticTranspose)
+        .setInput(0)
+        .setOutput(0)
+        .setAttr("order", order);
   } else if (nodeKind == Symbol::aten("contiguous")) {
     // Contiguous should only be mapped to oneDNN Graph if the destination
     // memory-layout is different than the source memory-format
@@ -467,6 +494,7 @@ Operator LlgaGraphHelper::createOperator(Node* node) const {
   }
 
   GRAPH_DEBUG("Making ", nodeKind.toQualString(), " a wildcard");
+  wildcard_reason = "no mapping to a oneDNN graph op";
   return makeWildcardOp(node);
 }
 
@@ -557,13 +585,18 @@ LlgaGraphHelper::LlgaGraphHelper(
   // TODO: select nodes in top-level block for now
   for (auto* node : graph->block()->nodes()) {
     auto kindOfNode = node->kind();
+    wildcard_reason = nullptr;
     auto op = createLlgaOp(node);
+    if (wildcard_reason)
+      nodeRejections_[node] = wildcard_reason;
 
     try {
       g.add_op(op);
       GRAPH_DEBUG("  Added node ", kindOfNode.toQualString());
     } catch (std::exception& e) {
       GRAPH_DEBUG("The backend failed to add node ", kindOfNode.toQualString());
+      nodeRejections_[node] =
+          std::string("rejected by the backend: ") + e.what();
       g.add_op(makeWildcardOp(node).llgaOp());
     }
 
@@ -576,8 +609,12 @@ LlgaGraphHelper::LlgaGraphHelper(
   std::vector<dnnl::graph::partition> partitions = g.get_partitions(policy);
   // excluded unsupported Wildcard partitions
   for (size_t partId = 0; partId < partitions.size(); partId++) {
-    if (partitions[partId].is_supported() && shouldRewrite(partitions[partId]))
+    if (partitions[partId].is_supported() &&
+        shouldRewrite(partitions[partId])) {
       partitions_.push_back(partitions[partId]);
+    } else if (is_llga_fusion_report_enabled()) {
+      recordUnfusedPartition(partitions[partId]);
+    }
   }
 
   GRAPH_DEBUG("  Got #partitions: ", partitions_.size());
@@ -593,6 +630,21 @@ LlgaGraphHelper::LlgaGraphHelper(
   }
 }
 
+void LlgaGraphHelper::recordUnfusedPartition(
+    const dnnl::graph::partition& partition) const {
+  for (auto opId : partition.get_ops()) {
+    auto node = Operator::getNode(opId);
+    auto iter = nodeRejections_.find(node);
+    if (iter != nodeRejections_.end()) {
+      record_llga_unfused_op(node, iter->second);
+    } else if (!partition.is_supported()) {
+      record_llga_unfused_op(node, "not matched by any fusion pattern");
+    } else {
+      record_llga_unfused_op(node, "partition without quantization");
+    }
+  }
+}
+
 bool LlgaGraphHelper::isLlgaSubgraph(const Node* node) {
   return node->hasAttribute(attr::Subgraph) &&
       node->kind() == Symbol::fromQualString(LlgaFusionGroupName());
@@ -717,6 +769,8 @@ void LlgaGraphHelper::unmergeIfAnyNodeIsMissing(Node* subgraphNode) {
         " ops, but got ",
         actualOpNum,
         " ops.");
+    for (auto* node : subgraphNode->g(attr::Subgraph)->nodes())
+      record_llga_unfused_op(node, "partition split by the alias checks");
     SubgraphUtils::unmergeSubgraph(subgraphNode);
   }
 }
@@ -773,6 +827,15 @@ bool LlgaNodeWrapper::useOpaqueLayout(size_t offset) const {
   return n->is(attr::output_layouts)[offset] == OPAQUE_LAYOUT;
 }
 
+void LlgaNodeWrapper::setDynamicShape() {
+  n->i_(Symbol::attr("dynamic_shape"), 1);
+}
+
+bool LlgaNodeWrapper::useDynamicShape() const {
+  auto dynamic_shape = Symbol::attr("dynamic_shape");
+  return n->hasAttribute(dynamic_shape) && n->i(dynamic_shape) == 1;
+}
+
 } // namespace onednn
 } // namespace fuser
 } // namespace jit
@@ -83,12 +83,17 @@ class LlgaGraphHelper {
 
   bool isSingleQuantDequantTo(torch::jit::Node* node);
 
+  // Records the nodes of a partition left unfused in the fusion report
+  void recordUnfusedPartition(const dnnl::graph::partition& partition) const;
+
   std::unique_ptr<torch::jit::AliasDb> aliasDb_ = nullptr;
 
   OpPartitionMap opToOwningPartition_;
   std::vector<dnnl::graph::partition> partitions_;
   std::map<size_t, torch::jit::Value*>
       tensorIdToValue_; // map from tensorId to torch::jit::Value
+  // why the nodes mapped to wildcards were, for the fusion report
+  std::unordered_map<const torch::jit::Node*, std::string> nodeRejections_;
 };
 
 class LlgaNodeWrapper {
@@ -99,6 +104,10 @@ class LlgaNodeWrapper {
 
   bool useOpaqueLayout(size_t offset) const;
 
+  void setDynamicShape();
+
+  bool useDynamicShape() const;
+
   friend class LlgaGraphHelper;
 
  private:
@@ -1,5 +1,7 @@
 #include "guard_shape.h"
 #include "fusion_group_name.h"
+#include "graph_helper.h"
+#include "interface.h"
 
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
@@ -59,6 +61,10 @@ void insertTypeGuardForFusionGroup(
           ->create(kind, inputs_to_check, inputs_to_check.size() + 1)
           ->insertBefore(guarded_node);
   typecheck_node->tys_(attr::types, guard_types);
+  if (LlgaNodeWrapper(guarded_node).useDynamicShape() &&
+      get_llga_dynamic_dim_bound() > 0) {
+    typecheck_node->i_(attr::value, get_llga_dynamic_dim_bound());
+  }
   Value* typecheck_result = typecheck_node->output(inputs_to_check.size());
 
   std::unordered_map<Value*, Value*> typechecked_inputs;
@@ -113,6 +119,56 @@ void insertTypeGuardForFusionGroup(
   }
 }
 
+// The type of t without its sizes and strides, but its rank
+TensorTypePtr dropShape(const TensorTypePtr& t) {
+  auto rank = t->sizes().size();
+  if (!rank)
+    return t;
+  return TensorType::create(
+      t->scalarType(),
+      t->device(),
+      c10::SymbolicShape(*rank),
+      c10::VaryingShape<c10::Stride>(*rank),
+      t->requiresGrad());
+}
+
+// The type of t without its strides, the dims which varied during the
+// profiling runs (merged into unknown dims by the profiler) kept symbolic and
+// the others static
+TensorTypePtr keepStaticDims(const TensorTypePtr& t) {
+  auto rank = t->sizes().size();
+  if (!rank)
+    return t;
+  return TensorType::create(
+      t->scalarType(),
+      t->device(),
+      t->symbolic_sizes(),
+      c10::VaryingShape<c10::Stride>(*rank),
+      t->requiresGrad());
+}
+
+// Lets the kernel of a fusion group compile its partition for any input
+// shape: the dims of the values of the subgraph become unknown (their strides
+// are kept, which the layout decisions of the graph helper depend on), and
+// the guard of the group only checks the rank of its inputs.
+void relaxFusionGroupShapes(Node* fusion_group) {
+  auto subgraph = fusion_group->g(attr::Subgraph);
+  auto relax = [](Value* v) {
+    auto t = v->type()->cast<TensorType>();
+    if (!t || v->node()->kind() == prim::Constant)
+      return;
+    auto rank = t->sizes().size();
+    if (rank)
+      v->setType(t->withSymbolicShapes(c10::SymbolicShape(*rank)));
+  };
+  for (Value* input : subgraph->inputs())
+    relax(input);
+  for (Node* node : subgraph->nodes())
+    for (Value* output : node->outputs())
+      relax(output);
+  LlgaNodeWrapper(fusion_group).setDynamicShape();
+}
+
 //! [ Note -- prepareFusionGroupAndGuardOutputs implementation ]
 //! shamelessly copying code from NNC (tensorexpr_fuser)  with very little
 //! modification, original code at:
@@ -135,6 +191,14 @@ void prepareFusionGroupAndGuardOutputs(Block* block) {
     // refer to
     // `torch/csrc/jit/passes/tensorexpr_fuser.cpp:removeOutputsUsedOnlyInSize`
     // removeOutputsUsedOnlyInSize(fusion_group);
+    if (is_llga_dynamic_shape_enabled() || is_llga_symbolic_shape_enabled()) {
+      relaxFusionGroupShapes(fusion_group);
+      insertTypeGuardForFusionGroup(
+          fusion_group,
+          is_llga_dynamic_shape_enabled() ? dropShape : keepStaticDims,
+          Symbol::fromQualString(fuser::onednn::LlgaGuardName()));
+      continue;
+    }
     insertTypeGuardForFusionGroup(
         fusion_group,
         [](const TensorTypePtr& t) { return t; },
@@ -1,5 +1,7 @@
 #include "interface.h"
 #include <oneapi/dnnl/dnnl_graph.hpp>
+#include <algorithm>
+#include <mutex>
 #include "defer_size_check.h"
 #include "fusion_group_name.h"
 #include "graph_fuser.h"
@@ -31,7 +33,15 @@ namespace onednn {
 using namespace torch::jit;
 namespace {
 thread_local bool llga_fp32_bf16_enabled = false;
-}
+std::atomic<bool> llga_dynamic_shape_enabled{false};
+std::atomic<bool> llga_symbolic_shape_enabled{false};
+std::atomic<int64_t> llga_dynamic_dim_bound{0};
+std::atomic<bool> llga_async_compilation_enabled{false};
+std::atomic<int64_t> llga_compilation_cache_capacity{64};
+std::mutex llga_config_mutex;
+std::vector<int64_t> llga_shape_buckets;
+LlgaCompilationCacheStats llga_compilation_cache_stats;
+} // namespace
 
 bool is_llga_fp32_bf16_enabled() {
   return llga_fp32_bf16_enabled;
@@ -40,6 +50,92 @@ void set_llga_fp32_bf16_enabled(bool new_enabled) {
   llga_fp32_bf16_enabled = new_enabled;
 }
 
+bool is_llga_dynamic_shape_enabled() {
+  return llga_dynamic_shape_enabled;
+}
+
+void set_llga_dynamic_shape_enabled(bool new_enabled) {
+  llga_dynamic_shape_enabled = new_enabled;
+}
+
+bool is_llga_symbolic_shape_enabled() {
+  return llga_symbolic_shape_enabled;
+}
+
+void set_llga_symbolic_shape_enabled(bool new_enabled) {
+  llga_symbolic_shape_enabled = new_enabled;
+}
+
+void set_llga_dynamic_dim_bound(int64_t bound) {
+  TORCH_CHECK(
+      bound >= 0, "LLGA dynamic dim bound must not be negative, got ", bound);
+  llga_dynamic_dim_bound = bound;
+}
+
+int64_t get_llga_dynamic_dim_bound() {
+  return llga_dynamic_dim_bound;
+}
+
+bool is_llga_async_compilation_enabled() {
+  return llga_async_compilation_enabled;
+}
+
+void set_llga_async_compilation_enabled(bool new_enabled) {
+  llga_async_compilation_enabled = new_enabled;
+}
+
+void set_llga_shape_buckets(std::vector<int64_t> buckets) {
+  for (auto b : buckets)
+    TORCH_CHECK(b > 0, "LLGA shape buckets must be positive, got ", b);
+  std::sort(buckets.begin(), buckets.end());
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  llga_shape_buckets = buckets;
+}
+
+std::vector<int64_t> get_llga_shape_buckets() {
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  return llga_shape_buckets;
+}
+
+void set_llga_compilation_cache_capacity(int64_t capacity) {
+  TORCH_CHECK(
+      capacity > 0,
+      "LLGA compilation cache capacity must be positive, got ",
+      capacity);
+  llga_compilation_cache_capacity = capacity;
+}
+
+int64_t get_llga_compilation_cache_capacity() {
+  return llga_compilation_cache_capacity;
+}
+
+LlgaCompilationCacheStats get_llga_compilation_cache_stats() {
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  return llga_compilation_cache_stats;
+}
+
+void reset_llga_compilation_cache_stats() {
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  llga_compilation_cache_stats = LlgaCompilationCacheStats();
+}
+
+void record_llga_compilation(bool hit, bool evicted, double compile_ms) {
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  if (hit) {
+    llga_compilation_cache_stats.hits++;
+  } else {
+    llga_compilation_cache_stats.misses++;
+    llga_compilation_cache_stats.compile_ms += compile_ms;
+  }
+  if (evicted)
+    llga_compilation_cache_stats.evictions++;
+}
+
+void record_llga_fallback() {
+  std::lock_guard<std::mutex> guard(llga_config_mutex);
+  llga_compilation_cache_stats.fallbacks++;
+}
+
 void fuseGraph(std::shared_ptr<Graph>& g) {
   // Follow the process of the tensorexpr_fuser in profiling mode:
   // Remove prim::profile nodes and embed the profile info directly in the
@@ -142,6 +238,9 @@ Operation createLlgaGuardKernel(const Node* node) {
     GRAPH_DEBUG("Guarding node: ", node->kind().toQualString());
     std::vector<TypePtr> types = node->tys(attr::types);
     const auto num_inputs = types.size();
+    const int64_t dim_bound = node->hasAttribute(attr::value)
+        ? node->i(attr::value)
+        : 0;
 
     GRAPH_DEBUG("num_inputs to guard: ", num_inputs);
 
@@ -172,6 +271,24 @@ Operation createLlgaGuardKernel(const Node* node) {
         push(stack, IValue(false));
         return;
       }
+
+      // matchTensor only checks complete sizes: the static dims of the
+      // symbolic ones are checked here, and their symbolic dims bounded
+      auto sizes = guard_tensor_type->symbolic_sizes();
+      if (sizes.rank().has_value() && !sizes.isComplete()) {
+        bool matched = tensor.dim() == static_cast<int64_t>(*sizes.rank());
+        for (size_t d = 0; matched && d < *sizes.rank(); d++) {
+          auto dim = sizes[d];
+          matched = dim.is_static()
+              ? dim.static_size() == tensor.size(d)
+              : dim_bound == 0 || tensor.size(d) <= dim_bound;
+        }
+        if (!matched) {
+          GRAPH_DEBUG("input ", i, " dims check failed, return false");
+          push(stack, IValue(false));
+          return;
+        }
+      }
     }
 
     // TODO: check type and return the right flag
@@ -189,5 +306,22 @@ torch::jit::RegisterOperators LLGAGuardOp({
         AliasAnalysisKind::PURE_FUNCTION),
 });
 
+Operation createLlgaToDenseKernel(const Node* node) {
+  return [](Stack* stack) {
+    RECORD_FUNCTION(
+        fuser::onednn::LlgaToDenseName(), c10::ArrayRef<c10::IValue>());
+    auto tensor = pop(stack).toTensor();
+    push(stack, fuser::onednn::LlgaTensorImpl::llga_to_dense(tensor));
+  };
+}
+
+// The output aliases the input
+torch::jit::RegisterOperators LLGAToDenseOp({
+    torch::jit::Operator(
+        Symbol::fromQualString(fuser::onednn::LlgaToDenseName()),
+        createLlgaToDenseKernel,
+        AliasAnalysisKind::CONSERVATIVE),
+});
+
 } // namespace jit
 } // namespace torch_ipex
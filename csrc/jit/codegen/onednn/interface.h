@@ -24,6 +24,68 @@ TORCH_API void setLlgaWeightCacheEnabled(bool enabled);
 
 TORCH_API bool getLlgaWeightCacheEnabled();
 
+// Dynamic shapes: the LLGA fusion groups created while enabled are guarded on
+// the rank, dtype and device of their inputs only, and their kernels compile
+// a partition per input shape, kept in a per-kernel LRU cache.
+TORCH_API bool is_llga_dynamic_shape_enabled();
+
+TORCH_API void set_llga_dynamic_shape_enabled(bool new_enabled);
+
+// Symbolic shapes: the LLGA fusion groups created while enabled are, as the
+// dynamic shape ones, compiled per input shape, but their guards only relax
+// the dims which varied during the profiling runs (the batch or sequence
+// length): the other dims of their inputs stay checked.
+TORCH_API bool is_llga_symbolic_shape_enabled();
+
+TORCH_API void set_llga_symbolic_shape_enabled(bool new_enabled);
+
+// The bound of the dims relaxed by the guards (dynamic or symbolic shapes) of
+// the fusion groups created while set, the inputs with a larger dim running
+// the unfused subgraph. 0 (the default) for no bound.
+TORCH_API void set_llga_dynamic_dim_bound(int64_t bound);
+
+TORCH_API int64_t get_llga_dynamic_dim_bound();
+
+// The sizes the batch (dim 0) of the inputs of the dynamic shape kernels is
+// rounded up to, the inputs being padded with zeros and the outputs sliced
+// back, so that the batch sizes of a bucket share a compiled partition. Empty
+// (the default) to compile each batch size.
+TORCH_API void set_llga_shape_buckets(std::vector<int64_t> buckets);
+
+TORCH_API std::vector<int64_t> get_llga_shape_buckets();
+
+// The max compiled partitions cached per kernel (64 by default)
+TORCH_API void set_llga_compilation_cache_capacity(int64_t capacity);
+
+TORCH_API int64_t get_llga_compilation_cache_capacity();
+
+// Background compilations: on a miss, the partition is compiled on an
+// inter-op thread while the calls of its shape run the unfused subgraph, and
+// switch to the compiled partition once it is cached.
+TORCH_API bool is_llga_async_compilation_enabled();
+
+TORCH_API void set_llga_async_compilation_enabled(bool new_enabled);
+
+struct LlgaCompilationCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+  // the calls which ran the unfused subgraph, their compilation pending
+  int64_t fallbacks = 0;
+  // the time of the compilations of the misses
+  double compile_ms = 0;
+};
+
+TORCH_API LlgaCompilationCacheStats get_llga_compilation_cache_stats();
+
+TORCH_API void reset_llga_compilation_cache_stats();
+
+// Records a lookup of a compilation cache, compile_ms being the time of the
+// compilation on a miss
+void record_llga_compilation(bool hit, bool evicted, double compile_ms);
+
+void record_llga_fallback();
+
 } // namespace onednn
 } // namespace fuser
 
@@ -1,10 +1,17 @@
 #include <omp.h>
+#include <chrono>
+#include <sstream>
 
+#include "constant_cache.h"
+#include "fusion_report.h"
 #include "graph_helper.h"
+#include "interface.h"
 #include "kernel.h"
 #include "operator.h"
+#include "output_buffers.h"
 #include "runtime.h"
 
+#include <ATen/Parallel.h>
 #include <ATen/core/functional.h>
 #include <ATen/quantized/Quantizer.h>
 #include <torch/csrc/jit/jit_log.h>
@@ -39,6 +46,7 @@ LlgaKernel::LlgaKernel(const Node* fusionNode)
       "LLGA subgraph should contain only one partition");
   partition_ = partitions[0];
   nPartitionInputs_ = partition_.get_in_ports().size();
+  dynamicShape_ = LlgaNodeWrapper(fusionNode_).useDynamicShape();
   GRAPH_DEBUG("Initialized ", debugName(), "\n", graph_->toString());
 }
 
@@ -102,7 +110,7 @@ void LlgaKernel::initializeConstantInputs() {
       constantValues_.emplace_back(value);
 
       auto const_tensor = toIValue(value)->toTensor();
-      constantInputs_.emplace_back(const_tensor);
+      constantInputs_.emplace_back(share_constant(const_tensor));
     }
   }
 }
@@ -139,11 +147,71 @@ ArgSpecs LlgaKernel::initializeInputSpecs(const TensorArgs& inputs) {
   return inputSpecs;
 }
 
+ArgSpecs LlgaKernel::specializeInputSpecs(const TensorArgs& inputs) const {
+  auto inputSpecs = inputSpecs_;
+  // the constant inputs placed after the graph inputs keep their specs
+  for (size_t i = 0; i < runArgsIdx_.size(); i++) {
+    inputSpecs[i] = inputSpecs[i].supplementTensorInfo(inputs[runArgsIdx_[i]]);
+  }
+  return inputSpecs;
+}
+
+CompilationKey LlgaKernel::compilationKey(
+    const ArgSpecs& inputSpecs,
+    int n_thread) const {
+  CompilationKey key = {n_thread};
+  for (size_t i = 0; i < runArgsIdx_.size(); i++) {
+    auto& spec = inputSpecs[i];
+    key.push_back(static_cast<int64_t>(spec.dtype()));
+    key.push_back(static_cast<int64_t>(spec.layout_type()));
+    key.push_back(spec.sizes().size());
+    key.insert(key.end(), spec.sizes().begin(), spec.sizes().end());
+    if (spec.is_opaque()) {
+      key.push_back(spec.logical_tensor().get_layout_id());
+    } else if (spec.is_strided()) {
+      key.insert(key.end(), spec.strides().begin(), spec.strides().end());
+    }
+  }
+  return key;
+}
+
+int64_t LlgaKernel::batchBucket(const TensorArgs& inputs) const {
+  if (!dynamicShape_)
+    return 0;
+  auto buckets = get_llga_shape_buckets();
+  if (buckets.empty() || inputs.empty() || inputs[0].dim() == 0)
+    return 0;
+  // The outputs between partitions are opaque, they could not be sliced
+  for (size_t i = 0; i < nOutputs_; i++) {
+    if (useOpaqueLayout(i))
+      return 0;
+  }
+  for (auto& input : inputs) {
+    if (input.is_mkldnn() || input.is_quantized())
+      return 0;
+  }
+  auto batch = inputs[0].size(0);
+  auto bucket = std::lower_bound(buckets.begin(), buckets.end(), batch);
+  if (bucket == buckets.end() || *bucket == batch)
+    return 0;
+  return *bucket;
+}
+
 ArgSpecs LlgaKernel::initializeOutputSpecs() const {
   ArgSpecs outputSpecs;
   outputSpecs.reserve(nOutputs_);
   for (size_t i = 0; i < nOutputs_; i++) {
     auto spec = ArgSpec(graph_->outputs()[i]);
+    if (dynamicShape_) {
+      // the dims and strides are given by the compilation of each shape
+      std::vector<int64_t> unknown(spec.sizes().size(), DNNL_GRAPH_UNKNOWN_DIM);
+      spec = ArgSpec(
+          spec.tid(),
+          unknown,
+          unknown,
+          spec.dtype(),
+          dnnl::graph::logical_tensor::property_type::variable);
+    }
 
     if (spec.is_quantized())
       spec = getQuantizedSpec(spec, i);
@@ -155,15 +223,42 @@ ArgSpecs LlgaKernel::initializeOutputSpecs() const {
   return outputSpecs;
 }
 
+at::Tensor LlgaKernel::pooledOutput(
+    const ArgSpec& spec,
+    const c10::TensorOptions& opt,
+    bool opaque) {
+  auto storage = acquire_llga_output_storage(spec.storage_size());
+  if (opaque)
+    return at::detail::make_tensor<LlgaTensorImpl>(
+        std::move(storage), opt.dtype(), spec);
+  auto tensor = spec.is_quantized()
+      ? at::detail::make_tensor<at::QTensorImpl>(
+            std::move(storage),
+            c10::DispatchKeySet(c10::DispatchKey::QuantizedCPU),
+            opt.dtype(),
+            spec.get_quantizer())
+      : at::detail::make_tensor<c10::TensorImpl>(
+            std::move(storage),
+            c10::DispatchKeySet(c10::DispatchKey::CPU),
+            opt.dtype());
+  tensor.unsafeGetTensorImpl()->set_sizes_and_strides(
+      spec.sizes(), spec.strides());
+  return tensor;
+}
+
 std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
+    const LlgaCompiledPartition& compiled,
     const TensorArgs& inputs,
     TensorArgs& outputs) const {
+  auto& inputSpecs = compiled.inputSpecs;
+  auto& outputSpecs = compiled.outputSpecs;
+  auto& inplacePairs = compiled.inplacePairs;
   RECORD_FUNCTION(
       "LLGA_bridge::prepareRunArgs", c10::ArrayRef<c10::IValue>({}));
 
   RunArgs runInputs, runOutputs;
   for (size_t i = 0; i < runArgsIdx_.size(); i++) {
-    auto spec = inputSpecs_[i];
+    auto spec = inputSpecs[i];
     auto input = inputs[runArgsIdx_[i]];
     runInputs.push_back(
         {spec.logical_tensor(), Engine::getEngine(), input.data_ptr()});
@@ -171,7 +266,7 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   for (size_t i = 0; i < constantInputs_.size(); i++) {
     // constantInputSpecs are placed after graphInputSpecs
     auto constantInputSpecIdx = nGraphInputs_ + i;
-    auto constantInputSpec = inputSpecs_[constantInputSpecIdx];
+    auto constantInputSpec = inputSpecs[constantInputSpecIdx];
     runInputs.push_back(
         {constantInputSpec.logical_tensor(),
          Engine::getEngine(),
@@ -179,12 +274,12 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   }
 
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto spec = outputSpecs_[i];
+    auto spec = outputSpecs[i];
     auto opt = c10::TensorOptions(spec.aten_scalar_type()).device(device_);
 
     auto outputId = spec.tid();
-    auto iter = inplacePairs_.find(outputId);
-    if (iter != inplacePairs_.end()) {
+    auto iter = inplacePairs.find(outputId);
+    if (iter != inplacePairs.end()) {
       // output reuses one of input tensors
 #ifdef GRAPH_DEBUG_ENABLED
       GRAPH_DEBUG("Inplace computation");
@@ -222,6 +317,14 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
       outputs.push_back(inputTensor);
       runOutputs.push_back(
           {spec.logical_tensor(), Engine::getEngine(), inputTensor.data_ptr()});
+    } else if (is_llga_output_buffer_reuse_enabled()) {
+#ifdef GRAPH_DEBUG_ENABLED
+      GRAPH_DEBUG("Pooled output buffer");
+#endif
+      auto tensor = pooledOutput(spec, opt, useOpaqueLayout(i));
+      outputs.push_back(tensor);
+      runOutputs.push_back(
+          {spec.logical_tensor(), Engine::getEngine(), tensor.data_ptr()});
     } else if (useOpaqueLayout(i)) {
       // Wrap tensors between partitions with LlgaTensorImpl wrapper, so that we
       // can bypass guard-check, as strides would be different than those
@@ -261,17 +364,25 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   return std::make_tuple(runInputs, runOutputs);
 }
 
-compiled_partition LlgaKernel::compile(const partition& partition) {
-  auto inputs = fmap(inputSpecs_, toLogicalTensor);
-  auto outputs = fmap(outputSpecs_, toLogicalTensor);
-  auto compilation = partition.compile(inputs, outputs, Engine::getEngine());
+std::shared_ptr<LlgaCompiledPartition> LlgaKernel::compile(
+    const partition& partition,
+    const ArgSpecs& inputSpecs) {
+  auto compiled = std::make_shared<LlgaCompiledPartition>();
+  compiled->inputSpecs = inputSpecs;
+  compiled->outputSpecs = outputSpecs_;
+  auto& outputSpecs = compiled->outputSpecs;
+  auto inputs = fmap(inputSpecs, toLogicalTensor);
+  auto outputs = fmap(outputSpecs, toLogicalTensor);
+  compiled->compilation =
+      partition.compile(inputs, outputs, Engine::getEngine());
+  auto& compilation = compiled->compilation;
 
   // Since layouts of opaque outputs would be known after compilation,
   // we need to query them out from compilation and update outputSpecs
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto tid = outputSpecs_[i].tid();
-    outputSpecs_[i] =
-        outputSpecs_[i].update_desc(compilation.query_logical_tensor(tid));
+    auto tid = outputSpecs[i].tid();
+    outputSpecs[i] =
+        outputSpecs[i].update_desc(compilation.query_logical_tensor(tid));
   }
 
   // Build static mapping from output id to input offset
@@ -280,27 +391,118 @@ compiled_partition LlgaKernel::compile(const partition& partition) {
     size_t inputId = option.first;
     size_t outputId = option.second;
     auto inputSpecIter =
-        std::find_if(inputSpecs_.begin(), inputSpecs_.end(), [&](auto& spec) {
+        std::find_if(inputSpecs.begin(), inputSpecs.end(), [&](auto& spec) {
           return spec.tid() == inputId;
         });
-    TORCH_CHECK(inputSpecIter != inputSpecs_.end(), "In-place input not found");
-    auto inputOffset = inputSpecIter - inputSpecs_.begin();
-    inplacePairs_[outputId] = inputOffset;
+    TORCH_CHECK(inputSpecIter != inputSpecs.end(), "In-place input not found");
+    auto inputOffset = inputSpecIter - inputSpecs.begin();
+    compiled->inplacePairs[outputId] = inputOffset;
   }
 
-  return compilation;
+  return compiled;
+}
+
+std::shared_ptr<LlgaCompiledPartition> LlgaKernel::lookupCompilation(
+    const CompilationKey& key) {
+  std::lock_guard<std::mutex> guard(compilationsMutex_);
+  auto iter = compilationIndex_.find(key);
+  if (iter == compilationIndex_.end())
+    return nullptr;
+  compilations_.splice(compilations_.begin(), compilations_, iter->second);
+  record_llga_compilation(/* hit */ true, /* evicted */ false, 0);
+  return iter->second->second;
 }
 
-dnnl::graph::compiled_partition& LlgaKernel::compileAndCache(
+std::shared_ptr<LlgaCompiledPartition> LlgaKernel::compileAndCache(
     const dnnl::graph::partition& partition,
+    const ArgSpecs& inputSpecs,
+    const CompilationKey& key) {
+#ifdef GRAPH_DEBUG_ENABLED
+  GRAPH_DEBUG("Compiling partition for ", key[0], " threads");
+#endif
+  auto start = std::chrono::steady_clock::now();
+  // The kernels of equal subgraphs and constants share their compilations,
+  // and the constant weights oneDNN graph caches with them
+  std::shared_ptr<LlgaCompiledPartition> compiled;
+  std::string sharedKey;
+  if (is_llga_shared_weight_cache_enabled()) {
+    sharedKey = sharedCompilationKey_ + "|" +
+        std::to_string(current_numa_node()) + "|" + c10::Join(",", key);
+    compiled = find_shared_compilation(sharedKey);
+  }
+  if (!compiled) {
+    compiled = compile(partition, inputSpecs);
+    if (!sharedKey.empty())
+      register_shared_compilation(sharedKey, compiled);
+  }
+  std::chrono::duration<double, std::milli> compile_ms =
+      std::chrono::steady_clock::now() - start;
+  record_llga_partition_compilation(
+      debugName_, profileName_, compile_ms.count());
+
+  std::lock_guard<std::mutex> guard(compilationsMutex_);
+  // another thread may have compiled the same key meanwhile
+  auto iter = compilationIndex_.find(key);
+  if (iter != compilationIndex_.end()) {
+    record_llga_compilation(false, false, compile_ms.count());
+    return iter->second->second;
+  }
+  compilations_.emplace_front(key, compiled);
+  compilationIndex_[key] = compilations_.begin();
+  bool evicted = false;
+  while (compilations_.size() >
+         static_cast<size_t>(get_llga_compilation_cache_capacity())) {
+    compilationIndex_.erase(compilations_.back().first);
+    compilations_.pop_back();
+    evicted = true;
+  }
+  record_llga_compilation(false, evicted, compile_ms.count());
+  return compiled;
+}
+
+void LlgaKernel::compileInBackground(
+    const ArgSpecs& inputSpecs,
+    const CompilationKey& key,
     int n_thread) {
-  // index starts from 0 while min(omp_get_max_threads) = 1
-  int i_thread = n_thread - 1;
-  std::call_once(compilation_initialized_flags_[i_thread], [&]() {
-    GRAPH_DEBUG("Compiling partition for i_thread ", i_thread);
-    compilations_[i_thread] = compile(partition_);
+  {
+    std::lock_guard<std::mutex> guard(compilationsMutex_);
+    if (!pendingCompilations_.insert(key).second)
+      return;
+  }
+  // the task keeps the kernel alive until the compilation is cached
+  auto self = shared_from_this();
+  at::launch([self, inputSpecs, key, n_thread]() {
+    // a compilation is specific to the threads of the calls of its key
+    omp_set_num_threads(n_thread);
+    try {
+      self->compileAndCache(self->partition_, inputSpecs, key);
+    } catch (const std::exception& e) {
+      // the key stays pending, its calls keep running the fallback
+      TORCH_WARN(
+          "Background compilation of ",
+          self->debugName(),
+          " failed: ",
+          e.what());
+      return;
+    }
+    std::lock_guard<std::mutex> guard(self->compilationsMutex_);
+    self->pendingCompilations_.erase(key);
+  });
+}
+
+void LlgaKernel::runFallback(Stack& stack) {
+  std::call_once(fallback_initialized_flag_, [&]() {
+    fallbackCode_ =
+        std::make_unique<Code>(graph_->copy(), debugName_ + "_fallback");
   });
-  return compilations_[i_thread];
+  // The inputs from upstream partitions are LLGA tensors, which the aten
+  // operators of the subgraph do not take
+  for (size_t i = stack.size() - nGraphInputs_; i < stack.size(); i++) {
+    // aliasing, the other users of the input still read it
+    stack[i] = LlgaTensorImpl::llga_to_dense(stack[i].toTensor());
+  }
+  record_llga_fallback();
+  InterpreterState(*fallbackCode_).run(stack);
 }
 
 void LlgaKernel::run(Stack& stack) {
@@ -326,36 +528,89 @@ void LlgaKernel::run(Stack& stack) {
         GRAPH_DEBUG("Initializing output logical tensors");
 #endif
         outputSpecs_ = initializeOutputSpecs();
+        if (is_llga_shared_weight_cache_enabled()) {
+          std::stringstream ss;
+          ss << graph_->toString(/* print_source_locations */ false);
+          // the shared constants are equal by address, and the specs of the
+          // compilations are only valid for the same tensor ids
+          for (auto& constant : constantInputs_)
+            ss << constant.data_ptr() << ",";
+          for (auto& spec : inputSpecs_)
+            ss << spec.tid() << ",";
+          for (auto& spec : outputSpecs_)
+            ss << spec.tid() << ",";
+          sharedCompilationKey_ = ss.str();
+        }
       },
       inputs);
 
   TensorArgs outputs;
   RunArgs runInputs, runOutputs;
-  dnnl::graph::compiled_partition compilation;
-
   int n_thread = omp_get_max_threads();
-  if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
-#ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Cached compilation");
-#endif
-    compilation = compileAndCache(partition_, n_thread);
-  } else {
+
+  // Pad the batch of the inputs up to its bucket, the outputs of the bucket
+  // are sliced back after the execution
+  int64_t batch = 0;
+  int64_t bucket = batchBucket(inputs);
+  if (bucket > 0) {
+    batch = inputs[0].size(0);
+    for (auto& input : inputs) {
+      if (input.dim() == 0 || input.size(0) != batch)
+        continue;
+      auto padded_sizes = input.sizes().vec();
+      padded_sizes[0] = bucket;
+      auto padded = at::zeros(padded_sizes, input.options());
+      padded.narrow(0, 0, batch).copy_(input);
+      input = padded;
+    }
+  }
+
+  auto inputSpecs = specializeInputSpecs(inputs);
+  auto key = compilationKey(inputSpecs, n_thread);
+  auto compiled = lookupCompilation(key);
+  if (!compiled) {
+    if (is_llga_async_compilation_enabled()) {
 #ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Runtime compilation");
+      GRAPH_DEBUG("Background compilation, running the fallback");
 #endif
-    compilation = compile(partition_);
+      compileInBackground(inputSpecs, key, n_thread);
+      // the stack still holds the unpadded inputs
+      runFallback(stack);
+      return;
+    }
+    compiled = compileAndCache(partition_, inputSpecs, key);
   }
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Preparing runtime tensors");
 #endif
-  std::tie(runInputs, runOutputs) = prepareRunArgs(inputs, outputs);
+  std::tie(runInputs, runOutputs) = prepareRunArgs(*compiled, inputs, outputs);
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Executing partition");
 #endif
-  compilation.execute(Stream::getStream(), runInputs, runOutputs);
+  if (C10_UNLIKELY(is_llga_fusion_report_enabled())) {
+    auto start = std::chrono::steady_clock::now();
+    compiled->compilation.execute(Stream::getStream(), runInputs, runOutputs);
+    std::chrono::duration<double, std::milli> run_ms =
+        std::chrono::steady_clock::now() - start;
+    int64_t input_bytes = 0, output_bytes = 0;
+    for (auto& input : inputs)
+      input_bytes += input.nbytes();
+    for (auto& output : outputs)
+      output_bytes += output.nbytes();
+    record_llga_partition_run(
+        debugName_, profileName_, run_ms.count(), input_bytes, output_bytes);
+  } else {
+    compiled->compilation.execute(Stream::getStream(), runInputs, runOutputs);
+  }
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Partition executed");
 #endif
+  if (bucket > 0) {
+    for (auto& output : outputs) {
+      if (output.dim() > 0 && output.size(0) == bucket)
+        output = output.narrow(0, 0, batch);
+    }
+  }
   // Update the stack.
   drop(stack, nGraphInputs_);
   for (auto& o : outputs) {
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <unordered_map>
 #include "codegen/LlgaTensorImpl.h"
 #include "graph_helper.h"
@@ -21,9 +25,26 @@ using RunArg = dnnl::graph::tensor;
 using RunArgs = std::vector<RunArg>;
 using TensorArgs = std::vector<at::Tensor>;
 
-constexpr int MAX_COMPILATION_CACHE_SIZE = 1024;
+// A partition compiled for the input specs of a shape, with the output specs
+// and in-place pairs of the compilation
+struct LlgaCompiledPartition {
+  dnnl::graph::compiled_partition compilation;
+  ArgSpecs inputSpecs;
+  ArgSpecs outputSpecs;
+  std::unordered_map<size_t, size_t> inplacePairs; // output id -> input offset
+};
+
+// The omp_num_threads, then the dtype, layout and dims (and strides) of each
+// input of a compilation
+using CompilationKey = std::vector<int64_t>;
 
-class LlgaKernel {
+struct CompilationKeyHash {
+  size_t operator()(const CompilationKey& key) const {
+    return c10::get_hash(key);
+  }
+};
+
+class LlgaKernel : public std::enable_shared_from_this<LlgaKernel> {
  public:
   explicit LlgaKernel(const torch::jit::Node* fusionNode);
 
@@ -59,14 +80,47 @@ class LlgaKernel {
 
   ArgSpecs initializeOutputSpecs() const;
 
-  dnnl::graph::compiled_partition compile(
-      const dnnl::graph::partition& partition);
+  // The input specs of the shapes of inputs
+  ArgSpecs specializeInputSpecs(const TensorArgs& inputs) const;
+
+  CompilationKey compilationKey(const ArgSpecs& inputSpecs, int n_thread)
+      const;
 
-  dnnl::graph::compiled_partition& compileAndCache(
+  std::shared_ptr<LlgaCompiledPartition> compile(
       const dnnl::graph::partition& partition,
+      const ArgSpecs& inputSpecs);
+
+  // The cached compilation of the shapes of inputs, compiled on a miss
+  // The cached compilation of key, nullptr on a miss
+  std::shared_ptr<LlgaCompiledPartition> lookupCompilation(
+      const CompilationKey& key);
+
+  std::shared_ptr<LlgaCompiledPartition> compileAndCache(
+      const dnnl::graph::partition& partition,
+      const ArgSpecs& inputSpecs,
+      const CompilationKey& key);
+
+  // Compiles key on an inter-op thread, unless already pending
+  void compileInBackground(
+      const ArgSpecs& inputSpecs,
+      const CompilationKey& key,
       int n_thread);
 
+  // Runs the unfused subgraph on the inputs of the stack
+  void runFallback(torch::jit::Stack& stack);
+
+  // The bucket the batch of the inputs is padded to, 0 when not padded
+  int64_t batchBucket(const TensorArgs& inputs) const;
+
+  // An output of spec in a pooled buffer, wrapped with LlgaTensorImpl when
+  // opaque
+  static at::Tensor pooledOutput(
+      const ArgSpec& spec,
+      const c10::TensorOptions& opt,
+      bool opaque);
+
   std::tuple<RunArgs, RunArgs> prepareRunArgs(
+      const LlgaCompiledPartition& compiled,
       const TensorArgs& inputs,
       TensorArgs& outputs) const;
 
@@ -102,20 +156,36 @@ class LlgaKernel {
   // nPartitionInputs_ = nGraphInputs_ + constantInputs_.size() since Constant
   // inputs are copied to the inside of the subgraph
   int64_t nPartitionInputs_;
-  // We cache the compilation for each omp_num_threads
-  std::vector<dnnl::graph::compiled_partition> compilations_ =
-      std::vector<dnnl::graph::compiled_partition>(MAX_COMPILATION_CACHE_SIZE);
+  // Whether the fusion group was created for dynamic shapes (its guard only
+  // checks the rank of the inputs)
+  bool dynamicShape_ = false;
+  // The compilations by omp_num_threads and input shapes, the most recently
+  // used first
+  std::mutex compilationsMutex_;
+  std::list<std::pair<CompilationKey, std::shared_ptr<LlgaCompiledPartition>>>
+      compilations_;
+  std::unordered_map<
+      CompilationKey,
+      decltype(compilations_)::iterator,
+      CompilationKeyHash>
+      compilationIndex_;
+  // The keys compiling in the background, or which failed to
+  std::set<CompilationKey> pendingCompilations_;
+  // The subgraph and the addresses of the constants, for the compilations
+  // shared across kernels
+  std::string sharedCompilationKey_;
+  std::once_flag fallback_initialized_flag_;
+  std::unique_ptr<torch::jit::Code> fallbackCode_;
   std::set<size_t> initializedInputIds_;
   std::vector<torch::jit::Value*> constantValues_;
   TensorArgs constantInputs_;
+  // The specs of the shapes of the first run, which specializeInputSpecs
+  // updates from the inputs of the next ones
   ArgSpecs inputSpecs_;
   ArgSpecs outputSpecs_;
-  std::unordered_map<size_t, size_t> inplacePairs_; // output id -> input offset
   std::string debugName_;
   std::string profileName_;
   std::once_flag spec_initialized_flag_;
-  std::vector<std::once_flag> compilation_initialized_flags_ =
-      std::vector<std::once_flag>(MAX_COMPILATION_CACHE_SIZE);
 };
 
 } // namespace onednn
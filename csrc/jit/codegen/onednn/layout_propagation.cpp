@@ -1,5 +1,6 @@
 #include "layout_propagation.h"
 #include <torch/csrc/jit/jit_log.h>
+#include "fusion_group_name.h"
 #include "graph_helper.h"
 
 namespace torch_ipex {
@@ -12,12 +13,26 @@ using namespace torch::jit;
 bool couldSupportOpaqueLayout(Node* node) {
   switch (node->kind()) {
     case aten::size:
+    case aten::dim:
       return true;
     default:
-      return false;
+      return node->kind() == Symbol::fromQualString(LlgaToDenseName());
   }
 }
 
+// Redirects the uses of a partition output by the non-partition users to an
+// aten tensor aliasing it
+void insertToDense(Value* output, const std::vector<Use>& uses) {
+  auto graph = output->owningGraph();
+  auto dense = graph->create(Symbol::fromQualString(LlgaToDenseName()), 1);
+  dense->addInput(output);
+  dense->output()->setType(output->type());
+  dense->insertAfter(output->node());
+  for (auto& use : uses)
+    use.user->replaceInput(use.offset, dense->output());
+  GRAPH_DEBUG("Inserted ", LlgaToDenseName(), " for ", uses.size(), " uses");
+}
+
 void LayoutPropagation(Node* n) {
   if (!LlgaGraphHelper::isLlgaSubgraph(n))
     return;
@@ -33,19 +48,20 @@ void LayoutPropagation(Node* n) {
   for (auto input : n->inputs()) {
     auto prev = input->node();
     auto offset = input->offset();
-    if (LlgaGraphHelper::isLlgaSubgraph(prev)) {
-      bool useOpaqueLayout = true;
-      for (auto& use : input->uses()) {
-        if (!couldSupportOpaqueLayout(use.user) &&
-            !LlgaGraphHelper::isLlgaSubgraph(use.user)) {
-          useOpaqueLayout = false;
-          break;
-        }
-      }
-      if (useOpaqueLayout) {
-        LlgaNodeWrapper(prev).setOpaqueLayout(offset);
-      }
+    if (!LlgaGraphHelper::isLlgaSubgraph(prev) ||
+        LlgaNodeWrapper(prev).useOpaqueLayout(offset))
+      continue;
+    // The output is passed to the partitions as given by prev, in its layout,
+    // and converted once for all the other users
+    std::vector<Use> denseUses;
+    for (auto& use : input->uses()) {
+      if (!couldSupportOpaqueLayout(use.user) &&
+          !LlgaGraphHelper::isLlgaSubgraph(use.user))
+        denseUses.push_back(use);
     }
+    if (!denseUses.empty())
+      insertToDense(input, denseUses);
+    LlgaNodeWrapper(prev).setOpaqueLayout(offset);
   }
 }
 
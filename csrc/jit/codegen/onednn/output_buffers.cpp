@@ -0,0 +1,104 @@
+#include "output_buffers.h"
+
+#include <c10/core/CPUAllocator.h>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+namespace {
+
+// the buffers pooled per size, beyond which the outputs of the size are not
+// pooled (e.g. when the caller keeps the outputs of each run)
+constexpr size_t kMaxBuffersPerSize = 8;
+
+std::atomic<bool> output_buffer_reuse_enabled{false};
+std::atomic<int64_t> reused_outputs{0};
+std::atomic<int64_t> allocated_outputs{0};
+std::atomic<int64_t> pooled_bytes{0};
+// bumped by clear_llga_output_buffers
+std::atomic<int64_t> pool_generation{0};
+
+struct OutputBufferPool {
+  int64_t generation = 0;
+  std::unordered_map<size_t, std::vector<c10::Storage>> buffers;
+
+  void clear() {
+    for (auto& entry : buffers)
+      pooled_bytes -= entry.first * entry.second.size();
+    buffers.clear();
+  }
+
+  ~OutputBufferPool() {
+    clear();
+  }
+};
+
+OutputBufferPool& thread_pool() {
+  thread_local OutputBufferPool pool;
+  int64_t generation = pool_generation;
+  if (pool.generation != generation) {
+    pool.clear();
+    pool.generation = generation;
+  }
+  return pool;
+}
+
+c10::Storage new_storage(size_t nbytes) {
+  auto allocator = at::GetCPUAllocator();
+  return c10::Storage(c10::make_intrusive<c10::StorageImpl>(
+      c10::StorageImpl::use_byte_size_t(),
+      nbytes,
+      allocator->allocate(nbytes),
+      allocator,
+      /*resizable=*/true));
+}
+
+} // namespace
+
+bool is_llga_output_buffer_reuse_enabled() {
+  return output_buffer_reuse_enabled;
+}
+
+void set_llga_output_buffer_reuse_enabled(bool new_enabled) {
+  output_buffer_reuse_enabled = new_enabled;
+}
+
+std::tuple<int64_t, int64_t, int64_t> get_llga_output_buffer_stats() {
+  return std::make_tuple(
+      reused_outputs.load(), allocated_outputs.load(), pooled_bytes.load());
+}
+
+void clear_llga_output_buffers() {
+  pool_generation++;
+  reused_outputs = 0;
+  allocated_outputs = 0;
+}
+
+c10::Storage acquire_llga_output_storage(size_t nbytes) {
+  auto& buffers = thread_pool().buffers[nbytes];
+  for (auto& storage : buffers) {
+    // the pool holds the only reference, and a resize_ of a previous output
+    // may have reallocated it
+    if (storage.use_count() == 1 && storage.nbytes() == nbytes) {
+      reused_outputs++;
+      return storage;
+    }
+  }
+  allocated_outputs++;
+  auto storage = new_storage(nbytes);
+  if (buffers.size() < kMaxBuffersPerSize) {
+    buffers.push_back(storage);
+    pooled_bytes += nbytes;
+  }
+  return storage;
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <tuple>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+// Reuse of the output buffers of the LLGA kernels: the kernels run by a
+// thread allocate their outputs from the pool of the thread, keyed by byte
+// size, a buffer being reused by any kernel once no tensor references it,
+// i.e. once the output allocated in it is dead (disabled by default).
+TORCH_API bool is_llga_output_buffer_reuse_enabled();
+
+TORCH_API void set_llga_output_buffer_reuse_enabled(bool new_enabled);
+
+// The outputs allocated in a reused buffer and in a new one, and the bytes of
+// the pooled buffers of all the threads
+TORCH_API std::tuple<int64_t, int64_t, int64_t> get_llga_output_buffer_stats();
+
+// Releases the pooled buffers, the pool of each thread being cleared on its
+// next allocation
+TORCH_API void clear_llga_output_buffers();
+
+// A storage of nbytes no tensor references, from the pool of the calling
+// thread
+c10::Storage acquire_llga_output_storage(size_t nbytes);
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -64,8 +64,35 @@ void IpexQuantFusion(std::shared_ptr<torch::jit::Graph>& graph) {
       "aten::flatten",
       {"%start_dim, %end_dim"},
       {"%start_dim, %end_dim"});
+  // keep the int8 tensors of a transformer block quantized through the
+  // LayerNorm, softmax and GeLU that LLGA left between dequantize and quantize
+  auto layer_norm_patten = getIpexFusionInfo(
+      "aten::layer_norm",
+      "ipex::qlayer_norm",
+      {"%shape, %weight, %bias, %eps, %cudnn_enable"},
+      {"%shape, %weight, %bias, %eps, %r_scale, %r_zero_point, %r_dtype"});
+  auto softmax_patten = getIpexFusionInfo(
+      "aten::softmax",
+      "ipex::qsoftmax",
+      {"%dim, %dtype"},
+      {"%dim, %r_scale, %r_zero_point, %r_dtype"});
+  // the int8 softmax does not take an output dtype
+  softmax_patten.filters = {
+      [](const torch::jit::Match& match,
+         const std::unordered_map<std::string, torch::jit::Value*>& vmap) {
+        auto dtype = match.values_map.at(vmap.at("dtype"));
+        return dtype->type() == torch::jit::NoneType::get();
+      }};
+  auto gelu_patten = getIpexFusionInfo(
+      "aten::gelu",
+      "ipex::qgelu",
+      {"%approximate"},
+      {"%approximate, %r_scale, %r_zero_point, %r_dtype"});
   patterns.emplace_back(adaptive_avg_pool2d_patten);
   patterns.emplace_back(flatten_patten);
+  patterns.emplace_back(layer_norm_patten);
+  patterns.emplace_back(softmax_patten);
+  patterns.emplace_back(gelu_patten);
   for (const auto& info : patterns) {
     torch::jit::SubgraphRewriter rewriter;
     rewriter.RegisterRewritePattern(info.pattern, info.replacement);
@@ -76,7 +103,11 @@ void IpexQuantFusion(std::shared_ptr<torch::jit::Graph>& graph) {
       graph);
   graph_rewrite::replaceEmbeddingBagWithQEmbeddingBag(graph);
   GRAPH_DUMP(
-      "After replaceEmbeddingBagWithQEmbeddingBag. Before replaceInteractionWithQInteraction",
+      "After replaceEmbeddingBagWithQEmbeddingBag. Before replaceMergedEmbeddingBagWithQMergedEmbeddingBag",
+      graph);
+  graph_rewrite::replaceMergedEmbeddingBagWithQMergedEmbeddingBag(graph);
+  GRAPH_DUMP(
+      "After replaceMergedEmbeddingBagWithQMergedEmbeddingBag. Before replaceInteractionWithQInteraction",
       graph);
   graph_rewrite::replaceInteractionWithQInteraction(graph);
   GRAPH_DUMP(
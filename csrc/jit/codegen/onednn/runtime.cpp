@@ -13,7 +13,8 @@ engine& Engine::getEngine() {
 }
 
 stream& Stream::getStream() {
-  static stream cpu_stream{Engine::getEngine()};
+  // oneDNN streams are not meant to be shared across threads
+  thread_local stream cpu_stream{Engine::getEngine()};
   return cpu_stream;
 }
 
@@ -15,7 +15,9 @@ struct Engine {
 };
 
 struct Stream {
-  // CPU stream singleton
+  // CPU stream of the calling thread: the threads of the CPUPools (a
+  // TaskExecutor each) run their partitions on their own stream, with the
+  // OpenMP threads of the cores of their pool
   static dnnl::graph::stream& getStream();
   Stream(const Stream&) = delete;
   void operator=(const Stream&) = delete;
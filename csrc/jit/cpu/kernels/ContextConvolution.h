@@ -1,13 +1,80 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include "aten/DirectConv.h"
 
 #include <ideep.hpp>
 
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+
 namespace torch_ipex {
 namespace cpu {
 namespace detail {
 
+// LRU cache of the forward primitives created by a convolution context for
+// the input shapes and post-ops other than the ones given at prepack time,
+// so that dynamic shapes do not create primitives on every call.
+struct ConvPrimitiveCache final {
+  static constexpr int64_t kDefaultCapacity = 8;
+
+  struct Entry {
+    // the key: src desc, post-ops and number of threads of the primitive
+    ideep::tensor::desc src_desc;
+    ideep::attr_t attr;
+    int num_threads;
+    ideep::convolution_forward_params params;
+    ideep::convolution_forward::super primitive;
+  };
+
+  std::mutex mutex;
+  // most recently used first
+  std::list<std::shared_ptr<Entry>> entries;
+  int64_t capacity = kDefaultCapacity;
+  // post-ops of the last primitive created by a call, used for the warm-up
+  // since the fused ops pass theirs at run time only
+  c10::optional<ideep::attr_t> run_attr;
+  // calls served by a cached primitive, including the prepacked one, and
+  // calls creating a primitive
+  std::atomic<int64_t> hits{0};
+  std::atomic<int64_t> misses{0};
+};
+
+// Algorithm of the forward convolutions of a context without accumulation
+enum class ConvAlgorithm { DIRECT = 0, WINOGRAD, AUTO };
+
+// Winograd F(4x4, 3x3) primitives of a context, for the 3x3 stride 1 convs in
+// inference, each with the weight transformed once to its layout. In AUTO
+// mode the first call of an input shape times both algorithms and remembers
+// the faster one for the next calls.
+struct ConvWinogradState final {
+  enum Choice { UNTUNED = -1, DIRECT = 0, WINOGRAD = 1 };
+
+  struct Entry {
+    // the key: src desc, post-ops and number of threads of the primitive
+    ideep::tensor::desc src_desc;
+    ideep::attr_t attr;
+    int num_threads;
+    // false if oneDNN has no winograd implementation for the key
+    bool supported = false;
+    ideep::convolution_forward_params params;
+    ideep::convolution_forward::super primitive;
+    // at_weight_ at weight_version, in the weight layout of the primitive
+    ideep::tensor weight;
+    int64_t weight_version = 0;
+    std::atomic<int> choice{UNTUNED};
+  };
+
+  std::mutex mutex;
+  ConvAlgorithm algorithm = ConvAlgorithm::DIRECT;
+  // set once the context is trained
+  bool disabled = false;
+  // most recently used first, at most ConvPrimitiveCache::kDefaultCapacity
+  std::list<std::shared_ptr<Entry>> entries;
+};
+
 struct ContextConvolution final {
   ideep::tensor::desc original_desc_;
   ideep::tensor weight_packed_;
@@ -27,6 +94,15 @@ struct ContextConvolution final {
   bool weight_is_channels_last_;
   ideep::convolution_forward_params conv_params_;
   ideep::convolution_forward::super conv_desc_;
+  std::shared_ptr<ConvPrimitiveCache> primitive_cache_;
+  std::shared_ptr<ConvWinogradState> winograd_;
+  // weight of the direct kernels for the depthwise and small channels convs,
+  // valid while at_weight_ is at direct_weight_version_
+  c10::optional<DirectConvWeight> direct_weight_;
+  int64_t direct_weight_version_ = 0;
+  // set once the context is trained, the optimizers may update at_weight_
+  // without bumping its version
+  bool direct_weight_disabled_ = false;
 
   ContextConvolution() = delete;
 
@@ -54,7 +130,9 @@ struct ContextConvolution final {
         groups_(groups),
         weight_is_channels_last_(weight_is_channels_last),
         conv_params_(conv_params),
-        conv_desc_(conv_desc) {}
+        conv_desc_(conv_desc),
+        primitive_cache_(std::make_shared<ConvPrimitiveCache>()),
+        winograd_(std::make_shared<ConvWinogradState>()) {}
 
   ContextConvolution(ContextConvolution&&) = default;
   ContextConvolution& operator=(ContextConvolution&&) = default;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include "aten/SparseLinear.h"
 
 #include <ideep.hpp>
 
@@ -14,6 +15,13 @@ struct ContextLinear final {
   // at_weight is used for autograd and optimizer update
   at::Tensor at_weight_;
   c10::optional<at::Tensor> at_bias_;
+  // block-sparse copy of a sparse enough weight, valid while at_weight_ is at
+  // sparse_weight_version_
+  c10::optional<SparseLinearWeight> sparse_weight_;
+  int64_t sparse_weight_version_ = 0;
+  // set once the context is trained, the optimizers may update at_weight_
+  // without bumping its version
+  bool sparse_weight_disabled_ = false;
 
   ContextLinear() = delete;
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextLinearDynamicQuant final {
+  // packed int8 weight, see dynamic_quant_linear_pack_weight
+  at::Tensor at_weight_;
+  // [out_features] fp32 scales of the output channels
+  at::Tensor scales_;
+  // the scales and the int32 compensation of the weight, N padded to the
+  // packed weight
+  at::Tensor packed_scales_;
+  at::Tensor compensation_;
+  c10::optional<at::Tensor> at_bias_;
+  int64_t out_features_;
+  int64_t in_features_;
+
+  ContextLinearDynamicQuant() = delete;
+
+  ContextLinearDynamicQuant(
+      at::Tensor&& at_weight,
+      at::Tensor&& scales,
+      at::Tensor&& packed_scales,
+      at::Tensor&& compensation,
+      c10::optional<at::Tensor>&& bias,
+      int64_t out_features,
+      int64_t in_features)
+      : at_weight_(std::move(at_weight)),
+        scales_(std::move(scales)),
+        packed_scales_(std::move(packed_scales)),
+        compensation_(std::move(compensation)),
+        at_bias_(std::move(bias)),
+        out_features_(out_features),
+        in_features_(in_features) {}
+
+  ContextLinearDynamicQuant(ContextLinearDynamicQuant&&) = default;
+  ContextLinearDynamicQuant& operator=(ContextLinearDynamicQuant&&) = default;
+
+  ~ContextLinearDynamicQuant() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
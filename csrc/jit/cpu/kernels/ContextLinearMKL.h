@@ -3,6 +3,9 @@
 #include <ATen/Tensor.h>
 
 #include <ideep.hpp>
+#include <memory>
+#include <mutex>
+#include "utils/rcu.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -12,6 +15,19 @@ struct ContextLinearMKL final {
   at::Tensor at_weight_; // packed at weight
   at::Tensor ori_weight_; // non-packed at weight
   c10::optional<at::Tensor> at_bias_;
+  // The weight packed for the M other than sgemm_sizes_[0], packed from
+  // ori_weight_ on the first run of each M
+  std::shared_ptr<torch_ipex::utils::RcuMap<int64_t, at::Tensor>>
+      packed_variants_ = std::make_shared<
+          torch_ipex::utils::RcuMap<int64_t, at::Tensor>>();
+  // The weight packed for oneDNN from ori_weight_, on the first run the
+  // runtime kernel selection may run the oneDNN kernel for
+  struct DnnlWeight {
+    std::once_flag packed;
+    at::Tensor at_weight;
+    ideep::tensor weight;
+  };
+  std::shared_ptr<DnnlWeight> dnnl_weight_ = std::make_shared<DnnlWeight>();
 
   ContextLinearMKL() = delete;
 
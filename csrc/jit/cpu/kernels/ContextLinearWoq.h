@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextLinearWoq final {
+  // packed uint8 weight, see woq_linear_pack_weight
+  at::Tensor at_weight_;
+  // [out_features, num_groups] fp32 scales and zero points of the groups
+  at::Tensor scales_;
+  at::Tensor zero_points_;
+  // packed [N / block_n, num_groups, block_n] scales and -zp * scales
+  at::Tensor packed_scales_;
+  at::Tensor packed_zero_biases_;
+  c10::optional<at::Tensor> at_bias_;
+  int64_t bits_;
+  int64_t group_size_;
+  int64_t out_features_;
+  int64_t in_features_;
+
+  ContextLinearWoq() = delete;
+
+  ContextLinearWoq(
+      at::Tensor&& at_weight,
+      at::Tensor&& scales,
+      at::Tensor&& zero_points,
+      at::Tensor&& packed_scales,
+      at::Tensor&& packed_zero_biases,
+      c10::optional<at::Tensor>&& bias,
+      int64_t bits,
+      int64_t group_size,
+      int64_t out_features,
+      int64_t in_features)
+      : at_weight_(std::move(at_weight)),
+        scales_(std::move(scales)),
+        zero_points_(std::move(zero_points)),
+        packed_scales_(std::move(packed_scales)),
+        packed_zero_biases_(std::move(packed_zero_biases)),
+        at_bias_(std::move(bias)),
+        bits_(bits),
+        group_size_(group_size),
+        out_features_(out_features),
+        in_features_(in_features) {}
+
+  ContextLinearWoq(ContextLinearWoq&&) = default;
+  ContextLinearWoq& operator=(ContextLinearWoq&&) = default;
+
+  ~ContextLinearWoq() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -2,12 +2,18 @@
 #include <dnnl.hpp>
 #include <ideep.hpp>
 #include <ideep/utils.hpp>
+#include "PackedWeightRegistry.h"
 #include "aten/Conv.h"
+#include "aten/DirectConv.h"
+#include "aten/GroupNorm.h"
 #include "aten/ParamUtils.h"
 #include "aten/WeightPack.h"
 #include "aten/utils/utils.h"
 #include "ideep/IDeepConversions.h"
 
+#include <chrono>
+#include <limits>
+
 namespace torch_ipex {
 namespace cpu {
 namespace detail {
@@ -26,6 +32,44 @@ namespace convolution {
             torch_ipex::fpmath_mode));                              \
   }
 
+namespace {
+
+int64_t weight_version(const at::Tensor& weight) {
+  return weight.is_inference() ? 0 : weight._version();
+}
+
+// Whether the direct weight is up to date and the direct kernels fuse the
+// post-op of attr, for a small batch of channels last images of the weight
+// dtype, the other cases run with oneDNN
+bool use_direct_conv_kernel(
+    const ContextConvolution& context,
+    const at::Tensor& input,
+    const ideep::attr_t& attr,
+    DirectConvPostOp& post_op) {
+  if (!context.direct_weight_.has_value() ||
+      weight_version(context.at_weight_) != context.direct_weight_version_) {
+    return false;
+  }
+  auto dtype = context.at_weight_.scalar_type();
+  if (input.dim() != 4 || input.size(0) > direct_conv_max_batch ||
+      !input.is_contiguous(at::MemoryFormat::ChannelsLast) ||
+      input.scalar_type() != dtype) {
+    return false;
+  }
+  if (attr.has_same_postop_as(ideep::attr_t())) {
+    post_op = DirectConvPostOp::NONE;
+  } else if (attr.has_same_postop_as(ideep::attr_t::fuse_relu())) {
+    post_op = DirectConvPostOp::RELU;
+  } else if (attr.has_same_postop_as(ideep::attr_t::fuse_clamp(0.f, 6.f))) {
+    post_op = DirectConvPostOp::RELU6;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
 // follow check rules from
 // https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/Convolution.cpp
 static void check_shape_forward(
@@ -207,6 +251,130 @@ at::Tensor convolution_leaky_relu_run(
           .set_fpmath_mode(torch_ipex::fpmath_mode));
 }
 
+at::Tensor convolution_group_norm_silu_run(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& gn_weight,
+    const c10::optional<at::Tensor>& gn_bias,
+    double eps,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::convolution_group_norm_silu_run",
+      c10::ArrayRef<c10::IValue>({}));
+  auto activation = torch_ipex::cpu::group_norm_silu(
+      input, num_groups, gn_weight, gn_bias, eps);
+  return op_context->run(
+      activation, ideep::attr_t(torch_ipex::fpmath_mode));
+}
+
+namespace {
+
+// The kernel offset, in input pixels, of tap t of phase a of a nearest x2
+// upsampling, i.e. floor((a + t - padding) / 2)
+int64_t upsample_nearest_tap_offset(int64_t a, int64_t t, int64_t padding) {
+  int64_t x = a + t - padding;
+  return x >= 0 ? x / 2 : -((1 - x) / 2);
+}
+
+} // namespace
+
+c10::intrusive_ptr<ConvolutionOpContext>
+createConvolutionUpsampleNearestPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    std::vector<int64_t>&& stride,
+    std::vector<int64_t>&& padding,
+    std::vector<int64_t>&& dilation,
+    int64_t groups,
+    bool weight_is_channels_last,
+    std::vector<int64_t>&& input_size) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createConvolutionUpsampleNearestPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      weight.dim() == 4 && input_size.size() == 4,
+      "convolution_upsample_nearest expects a 2-D convolution");
+  auto stride_ = expand_param_if_needed(stride, "stride", 2);
+  auto padding_ = expand_param_if_needed(padding, "padding", 2);
+  auto dilation_ = expand_param_if_needed(dilation, "dilation", 2);
+  std::array<int64_t, 2> kernel = {weight.size(2), weight.size(3)};
+  for (int d = 0; d < 2; d++) {
+    TORCH_CHECK(
+        stride_[d] == 1 && dilation_[d] == 1 &&
+            2 * padding_[d] == kernel[d] - 1 && input_size[d + 2] % 2 == 0,
+        "convolution_upsample_nearest expects a convolution of stride 1 and "
+        "dilation 1 keeping the size of its upsampled input");
+  }
+
+  // the sub-pixel kernels over the low resolution input, the taps of phase
+  // (a, b) are summed into output channel 4 * oc + 2 * a + b
+  std::array<int64_t, 2> low_padding, low_kernel;
+  for (int d = 0; d < 2; d++) {
+    int64_t first = upsample_nearest_tap_offset(0, 0, padding_[d]);
+    int64_t last = upsample_nearest_tap_offset(1, kernel[d] - 1, padding_[d]);
+    low_padding[d] = -first;
+    low_kernel[d] = last - first + 1;
+  }
+  auto w = weight.to(at::kFloat);
+  auto sub_pixel_weight = at::zeros(
+      {weight.size(0), 2, 2, weight.size(1), low_kernel[0], low_kernel[1]},
+      w.options());
+  for (int64_t a = 0; a < 2; a++) {
+    for (int64_t b = 0; b < 2; b++) {
+      auto phase = sub_pixel_weight.select(1, a).select(1, b);
+      for (int64_t ty = 0; ty < kernel[0]; ty++) {
+        int64_t oy =
+            upsample_nearest_tap_offset(a, ty, padding_[0]) + low_padding[0];
+        for (int64_t tx = 0; tx < kernel[1]; tx++) {
+          int64_t ox =
+              upsample_nearest_tap_offset(b, tx, padding_[1]) + low_padding[1];
+          phase.select(2, oy).select(2, ox).add_(
+              w.select(2, ty).select(2, tx));
+        }
+      }
+    }
+  }
+  auto low_weight = sub_pixel_weight
+                        .view(
+                            {weight.size(0) * 4,
+                             weight.size(1),
+                             low_kernel[0],
+                             low_kernel[1]})
+                        .to(weight.scalar_type());
+  if (weight_is_channels_last) {
+    low_weight = low_weight.contiguous(at::MemoryFormat::ChannelsLast);
+  }
+  c10::optional<at::Tensor> low_bias;
+  if (bias.has_value() && bias->defined()) {
+    low_bias = bias->repeat_interleave(4);
+  }
+  std::vector<int64_t> low_input_size = {
+      input_size[0], input_size[1], input_size[2] / 2, input_size[3] / 2};
+  return IpexConvolutionOpContext::create_context(
+      std::move(low_weight),
+      std::move(low_bias),
+      {1, 1},
+      {low_padding[0], low_padding[1]},
+      {1, 1},
+      groups,
+      weight_is_channels_last,
+      std::move(low_input_size),
+      ideep::attr_t(torch_ipex::fpmath_mode));
+}
+
+at::Tensor convolution_upsample_nearest_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::convolution_upsample_nearest_run",
+      c10::ArrayRef<c10::IValue>({}));
+  auto phases =
+      op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode));
+  // output channel 4 * oc + 2 * a + b goes to pixel (2 * y + a, 2 * x + b),
+  // in the memory format of the phases
+  return at::pixel_shuffle(phases, 2);
+}
+
 at::Tensor convolution_hardtanh_run(
     const at::Tensor& input,
     at::Scalar lower_bound,
@@ -508,8 +676,9 @@ ContextConvolution create(
       dilation_expanded,
       groups);
 
-  bool weight_is_channels_last_ = weight_is_channels_last;
-  weight_is_channels_last_ =
+  // the weight is packed for channels last inputs when it is channels last
+  // or when the graph passes traced a channels last input
+  bool weight_is_channels_last_ = weight_is_channels_last ||
       weight.suggest_memory_format() == at::MemoryFormat::ChannelsLast ||
       weight.suggest_memory_format() == at::MemoryFormat::ChannelsLast3d;
 
@@ -592,22 +761,17 @@ ContextConvolution create(
   ideep::data_type dtype = w.get_data_type();
   auto expected_desc =
       ideep::tensor::desc(conv_params.pd.weights_desc(), groups);
-  auto at_weight = empty_aten_tensor_from_desc(expected_desc, weight.options());
+  TORCH_CHECK(
+      ideep::data_type::f32 == dtype || ideep::data_type::bf16 == dtype ||
+          ideep::data_type::f16 == dtype,
+      "Only support bfloat16, float16 and float for weight prepack of convolution");
+  // shared with the other contexts packing the same read-only weight
+  auto at_weight =
+      PackedWeightRegistry::get().get_or_pack(weight, w, expected_desc);
   ideep::tensor packed_weight;
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(expected_desc, at_weight.template data_ptr<float>());
-  } else if (ideep::data_type::bf16 == dtype) {
-    packed_weight.init(
-        expected_desc, at_weight.template data_ptr<c10::BFloat16>());
-  } else {
-    TORCH_CHECK(
-        ideep::data_type::f16 == dtype,
-        "Only support bfloat16, float16 and float for weight prepack of convolution");
-    packed_weight.init(expected_desc, at_weight.template data_ptr<c10::Half>());
-  }
-  packed_weight.feed_from(w);
+  packed_weight.init(expected_desc, at_weight.data_ptr());
 
-  return ContextConvolution{
+  auto context = ContextConvolution{
       std::move(ori_desc),
       std::move(packed_weight),
       std::move(mkldnn_bias),
@@ -620,6 +784,364 @@ ContextConvolution create(
       weight_is_channels_last_,
       conv_params,
       ideep::convolution_forward::super(conv_params.pd)};
+  // the direct kernels work in channels last only
+  if (weight_is_channels_last_ && input_size.size() == 4) {
+    context.direct_weight_ = pack_direct_conv_weight(weight_, groups);
+    context.direct_weight_version_ = weight_version(context.at_weight_);
+  }
+  return context;
+}
+
+void update_direct_weight(ContextConvolution& context) {
+  context.direct_weight_.reset();
+  if (context.direct_weight_disabled_ || !context.weight_is_channels_last_ ||
+      context.original_desc_.get_ndims() != 4) {
+    return;
+  }
+  auto weight = unpack(context, context.at_weight_);
+  context.direct_weight_ = pack_direct_conv_weight(weight, context.groups_);
+  context.direct_weight_version_ = weight_version(context.at_weight_);
+}
+
+static ideep::format_tag get_format_tag(int64_t dim, bool use_channels_last) {
+  if (dim == 3) {
+    return ideep::format_tag::nwc;
+  } else if (dim == 4) {
+    return use_channels_last ? ideep::format_tag::nhwc
+                             : ideep::format_tag::nchw;
+  }
+  return use_channels_last ? ideep::format_tag::ndhwc
+                           : ideep::format_tag::ncdhw;
+}
+
+static bool has_same_attr(const ideep::attr_t& a, const ideep::attr_t& b) {
+  return a.has_same_postop_as(b) && a.get_all_scales() == b.get_all_scales();
+}
+
+// Returns the primitive cached for (src_desc, attr, number of threads) or
+// creates and caches it, nullptr if the cache of the context is disabled.
+static std::shared_ptr<ConvPrimitiveCache::Entry> get_cached_primitive(
+    const ContextConvolution& context,
+    const ideep::tensor::desc& src_desc,
+    const ideep::attr_t& attr,
+    bool is_warm_up = false) {
+  auto& cache = *context.primitive_cache_;
+  int num_threads = omp_get_max_threads();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.capacity == 0) {
+      return nullptr;
+    }
+    for (auto it = cache.entries.begin(); it != cache.entries.end(); it++) {
+      if ((*it)->src_desc == src_desc && (*it)->num_threads == num_threads &&
+          has_same_attr(attr, (*it)->attr)) {
+        if (!is_warm_up) {
+          cache.hits++;
+        }
+        cache.entries.splice(cache.entries.begin(), cache.entries, it);
+        return cache.entries.front();
+      }
+    }
+  }
+
+  // not holding the lock while creating the primitive
+  auto input_sizes = src_desc.get_dims();
+  std::vector<int64_t> output_sizes = calc_conv_output_size(
+      input_sizes,
+      context.original_desc_.get_dims(),
+      context.padding_,
+      context.stride_,
+      context.dilation_);
+  auto format_tag =
+      get_format_tag(input_sizes.size(), src_desc.is_channels_last());
+  ideep::tensor src(src_desc);
+  ideep::tensor dst = ideep::tensor(
+      {output_sizes.begin(), output_sizes.end()},
+      src_desc.get_data_type(),
+      format_tag);
+  ideep::convolution_forward_params params;
+  if (context.bias_.is_empty()) {
+    ideep::convolution_forward::prepare(
+        params,
+        src,
+        context.weight_packed_,
+        {output_sizes.begin(), output_sizes.end()},
+        dst,
+        {context.stride_.begin(), context.stride_.end()},
+        {context.dilation_.begin(), context.dilation_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        context.groups_,
+        ideep::scale_t(),
+        ideep::scale_t(),
+        ideep::scale_t(),
+        attr,
+        ideep::algorithm::convolution_direct,
+        ideep::prop_kind::forward_inference);
+  } else {
+    ideep::convolution_forward::prepare(
+        params,
+        src,
+        context.weight_packed_,
+        context.bias_,
+        {output_sizes.begin(), output_sizes.end()},
+        dst,
+        {context.stride_.begin(), context.stride_.end()},
+        {context.dilation_.begin(), context.dilation_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        context.groups_,
+        ideep::scale_t(),
+        ideep::scale_t(),
+        ideep::scale_t(),
+        attr,
+        ideep::algorithm::convolution_direct,
+        ideep::prop_kind::forward_inference);
+  }
+  auto entry = std::make_shared<ConvPrimitiveCache::Entry>(
+      ConvPrimitiveCache::Entry{
+          src_desc,
+          attr,
+          num_threads,
+          params,
+          ideep::convolution_forward::super(params.pd)});
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (!is_warm_up) {
+    cache.misses++;
+    cache.run_attr = attr;
+  }
+  cache.entries.push_front(entry);
+  while (static_cast<int64_t>(cache.entries.size()) > cache.capacity) {
+    cache.entries.pop_back();
+  }
+  return entry;
+}
+
+// Runs the primitive on input_, which has the dims of its src desc, with the
+// weight in the layout of the primitive
+static void run_with_primitive(
+    const ContextConvolution& context,
+    const ideep::convolution_forward_params& params,
+    const ideep::convolution_forward::super& primitive,
+    const ideep::tensor& weight,
+    const at::Tensor& input_,
+    at::Tensor& output) {
+  const ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
+  ideep::tensor mkldnn_output = itensor_view_from_dense(output);
+  if (context.bias_.is_empty()) {
+    ideep::convolution_forward::compute(
+        params,
+        primitive,
+        mkldnn_input,
+        weight,
+        mkldnn_output);
+  } else {
+    ideep::convolution_forward::compute(
+        params,
+        primitive,
+        mkldnn_input,
+        weight,
+        context.bias_,
+        mkldnn_output);
+  }
+}
+
+// Runs the direct oneDNN convolution on input_, whose desc is src_desc
+static at::Tensor run_direct(
+    const ContextConvolution& context,
+    const at::Tensor& input_,
+    const ideep::tensor::desc& src_desc,
+    const ideep::attr_t& attr,
+    at::MemoryFormat memory_format) {
+  const ideep::convolution_forward_params* params = nullptr;
+  const ideep::convolution_forward::super* primitive = nullptr;
+  std::shared_ptr<ConvPrimitiveCache::Entry> entry;
+  if (input_.sizes().vec() == context.conv_params_.pd.src_desc().get_dims() &&
+      has_same_attr(attr, context.conv_params_.op_attr) &&
+      omp_get_max_threads() == context.conv_params_.pd_use_threads) {
+    context.primitive_cache_->hits++;
+    params = &context.conv_params_;
+    primitive = &context.conv_desc_;
+  } else {
+    entry = get_cached_primitive(context, src_desc, attr);
+    if (entry) {
+      params = &entry->params;
+      primitive = &entry->primitive;
+    }
+  }
+  if (params) {
+    auto output_sizes = params->pd.dst_desc().get_dims();
+    auto output = at::empty(
+        output_sizes,
+        input_.options().memory_format(input_.suggest_memory_format()));
+    if (input_.dim() == 3) {
+      std::vector<int64_t> output_strides = {
+          (output_sizes[1] * output_sizes[2]), 1, output_sizes[1]};
+      output =
+          at::empty_strided(output_sizes, output_strides, input_.options());
+    }
+    run_with_primitive(
+        context, *params, *primitive, context.weight_packed_, input_, output);
+    return output;
+  }
+  return convolution_kernel(
+      input_,
+      context.weight_packed_,
+      context.bias_,
+      context.stride_,
+      context.padding_,
+      context.dilation_,
+      context.groups_,
+      attr,
+      memory_format);
+}
+
+// Whether oneDNN may have a winograd implementation of the convolution
+static bool is_winograd_eligible(const ContextConvolution& context) {
+  auto dims = context.original_desc_.get_dims();
+  auto dtype = context.original_desc_.get_data_type();
+  auto is_one = [](int64_t v) { return v == 1; };
+  return dims.size() == 4 && dims[2] == 3 && dims[3] == 3 &&
+      context.groups_ == 1 &&
+      std::all_of(context.stride_.begin(), context.stride_.end(), is_one) &&
+      std::all_of(
+             context.dilation_.begin(), context.dilation_.end(), is_one) &&
+      (dtype == ideep::data_type::f32 || dtype == ideep::data_type::bf16);
+}
+
+// Returns the winograd primitive of (src_desc, attr, number of threads) or
+// creates it with its transformed weight, nullptr if the context runs direct
+// convolutions only or oneDNN has no winograd implementation for the key
+static std::shared_ptr<ConvWinogradState::Entry> get_winograd_primitive(
+    const ContextConvolution& context,
+    const ideep::tensor::desc& src_desc,
+    const ideep::attr_t& attr) {
+  auto& state = *context.winograd_;
+  int num_threads = omp_get_max_threads();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.algorithm == ConvAlgorithm::DIRECT || state.disabled ||
+      !is_winograd_eligible(context)) {
+    return nullptr;
+  }
+  int64_t version = weight_version(context.at_weight_);
+  for (auto it = state.entries.begin(); it != state.entries.end(); it++) {
+    auto& entry = *it;
+    if (entry->src_desc == src_desc && entry->num_threads == num_threads &&
+        has_same_attr(attr, entry->attr)) {
+      if (entry->supported && entry->weight_version != version) {
+        // the weight was updated in place
+        entry->weight.feed_from(context.weight_packed_);
+        entry->weight_version = version;
+      }
+      state.entries.splice(state.entries.begin(), state.entries, it);
+      return state.entries.front()->supported ? state.entries.front()
+                                              : nullptr;
+    }
+  }
+
+  auto entry = std::make_shared<ConvWinogradState::Entry>();
+  entry->src_desc = src_desc;
+  entry->attr = attr;
+  entry->num_threads = num_threads;
+  entry->choice.store(
+      state.algorithm == ConvAlgorithm::WINOGRAD
+          ? ConvWinogradState::WINOGRAD
+          : ConvWinogradState::UNTUNED);
+  auto input_sizes = src_desc.get_dims();
+  std::vector<int64_t> output_sizes = calc_conv_output_size(
+      input_sizes,
+      context.original_desc_.get_dims(),
+      context.padding_,
+      context.stride_,
+      context.dilation_);
+  ideep::tensor src(src_desc);
+  ideep::tensor dst = ideep::tensor(
+      {output_sizes.begin(), output_sizes.end()},
+      src_desc.get_data_type(),
+      get_format_tag(input_sizes.size(), src_desc.is_channels_last()));
+  try {
+    if (context.bias_.is_empty()) {
+      ideep::convolution_forward::prepare(
+          entry->params,
+          src,
+          context.weight_packed_,
+          {output_sizes.begin(), output_sizes.end()},
+          dst,
+          {context.stride_.begin(), context.stride_.end()},
+          {context.dilation_.begin(), context.dilation_.end()},
+          {context.padding_.begin(), context.padding_.end()},
+          {context.padding_.begin(), context.padding_.end()},
+          context.groups_,
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::scale_t(),
+          attr,
+          ideep::algorithm::convolution_winograd,
+          ideep::prop_kind::forward_inference);
+    } else {
+      ideep::convolution_forward::prepare(
+          entry->params,
+          src,
+          context.weight_packed_,
+          context.bias_,
+          {output_sizes.begin(), output_sizes.end()},
+          dst,
+          {context.stride_.begin(), context.stride_.end()},
+          {context.dilation_.begin(), context.dilation_.end()},
+          {context.padding_.begin(), context.padding_.end()},
+          {context.padding_.begin(), context.padding_.end()},
+          context.groups_,
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::scale_t(),
+          attr,
+          ideep::algorithm::convolution_winograd,
+          ideep::prop_kind::forward_inference);
+    }
+    entry->primitive = ideep::convolution_forward::super(entry->params.pd);
+    entry->weight.init(entry->params.pd.weights_desc());
+    entry->weight.feed_from(context.weight_packed_);
+    entry->weight_version = version;
+    entry->supported = true;
+  } catch (const dnnl::error&) {
+    // no winograd implementation on this ISA or for this dtype
+    entry->supported = false;
+  }
+  state.entries.push_front(entry);
+  while (static_cast<int64_t>(state.entries.size()) >
+         ConvPrimitiveCache::kDefaultCapacity) {
+    state.entries.pop_back();
+  }
+  return entry->supported ? entry : nullptr;
+}
+
+static at::Tensor run_winograd(
+    const ContextConvolution& context,
+    const ConvWinogradState::Entry& entry,
+    const at::Tensor& input_) {
+  auto output = at::empty(
+      entry.params.pd.dst_desc().get_dims(),
+      input_.options().memory_format(input_.suggest_memory_format()));
+  run_with_primitive(
+      context, entry.params, entry.primitive, entry.weight, input_, output);
+  return output;
+}
+
+// Best time of a few runs of f, after a warm-up run creating its buffers
+template <typename F>
+static double best_time_ms(F&& f) {
+  const int runs = 3;
+  f();
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < runs; i++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
 }
 
 at::Tensor run(
@@ -652,51 +1174,56 @@ at::Tensor run(
       context.dilation_,
       context.groups_);
 
-  if (input_.sizes().vec() == context.conv_params_.pd.src_desc().get_dims() &&
-      attr.has_same_postop_as(context.conv_params_.op_attr) &&
-      attr.get_all_scales() == context.conv_params_.op_attr.get_all_scales() &&
-      omp_get_max_threads() == context.conv_params_.pd_use_threads) {
-    auto output_sizes = context.conv_params_.pd.dst_desc().get_dims();
+  DirectConvPostOp post_op;
+  if (use_direct_conv_kernel(context, input_, attr, post_op)) {
     auto output = at::empty(
-        output_sizes,
-        input_.options().memory_format(input_.suggest_memory_format()));
-    if (input.dim() == 3) {
-      std::vector<int64_t> output_strides = {
-          (output_sizes[1] * output_sizes[2]), 1, output_sizes[1]};
-      output =
-          at::empty_strided(output_sizes, output_strides, input_.options());
-    }
+        calc_conv_output_size(
+            input_.sizes(),
+            context.original_desc_.get_dims(),
+            context.padding_,
+            context.stride_,
+            context.dilation_),
+        input_.options().memory_format(at::MemoryFormat::ChannelsLast));
+    direct_conv_kernel_output(
+        input_,
+        *context.direct_weight_,
+        context.at_bias_.has_value() ? *context.at_bias_ : at::Tensor(),
+        context.stride_,
+        context.padding_,
+        context.dilation_,
+        output,
+        post_op);
+    return output;
+  }
 
-    const ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
-    ideep::tensor mkldnn_output = itensor_view_from_dense(output);
-    if (context.bias_.is_empty()) {
-      ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          mkldnn_output);
-    } else {
-      ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          context.bias_,
-          mkldnn_output);
+  auto src_desc = ideep::tensor::desc(
+      input_.sizes().vec(),
+      get_mkldnn_dtype(input_.scalar_type()),
+      get_format_tag(input_.dim(), use_channels_last));
+  auto winograd = get_winograd_primitive(context, src_desc, attr);
+  if (winograd) {
+    int choice = winograd->choice.load();
+    if (choice == ConvWinogradState::WINOGRAD) {
+      return run_winograd(context, *winograd, input_);
+    } else if (choice == ConvWinogradState::UNTUNED) {
+      // the first call of the shape in AUTO mode, the output of the faster
+      // algorithm is returned
+      at::Tensor direct_output, winograd_output;
+      double direct_time = best_time_ms([&]() {
+        direct_output =
+            run_direct(context, input_, src_desc, attr, memory_format);
+      });
+      double winograd_time = best_time_ms([&]() {
+        winograd_output = run_winograd(context, *winograd, input_);
+      });
+      bool use_winograd = winograd_time < direct_time;
+      winograd->choice.store(
+          use_winograd ? ConvWinogradState::WINOGRAD
+                       : ConvWinogradState::DIRECT);
+      return use_winograd ? winograd_output : direct_output;
     }
-    return output;
   }
-  return convolution_kernel(
-      input_,
-      context.weight_packed_,
-      context.bias_,
-      context.stride_,
-      context.padding_,
-      context.dilation_,
-      context.groups_,
-      attr,
-      memory_format);
+  return run_direct(context, input_, src_desc, attr, memory_format);
 }
 
 at::Tensor& run(
@@ -745,25 +1272,31 @@ at::Tensor& run(
   if (input_.sizes().vec() == context.conv_params_.pd.src_desc().get_dims() &&
       attr == context.conv_params_.op_attr &&
       omp_get_max_threads() == context.conv_params_.pd_use_threads) {
-    const ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
-    ideep::tensor mkldnn_output = itensor_view_from_dense(accumu);
-
-    if (context.bias_.is_empty()) {
-      ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          mkldnn_output);
-    } else {
-      ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          context.bias_,
-          mkldnn_output);
-    }
+    context.primitive_cache_->hits++;
+    run_with_primitive(
+        context,
+        context.conv_params_,
+        context.conv_desc_,
+        context.weight_packed_,
+        input_,
+        accumu);
+    return accumu;
+  }
+  auto entry = get_cached_primitive(
+      context,
+      ideep::tensor::desc(
+          input_.sizes().vec(),
+          get_mkldnn_dtype(input_.scalar_type()),
+          get_format_tag(input_.dim(), use_channels_last)),
+      attr);
+  if (entry) {
+    run_with_primitive(
+        context,
+        entry->params,
+        entry->primitive,
+        context.weight_packed_,
+        input_,
+        accumu);
   } else {
     convolution_kernel_output(
         input_,
@@ -870,6 +1403,14 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> run_backward(
     const at::Tensor& input,
     const at::Tensor& grad_output,
     std::array<bool, 3> output_mask) {
+  context.direct_weight_.reset();
+  context.direct_weight_disabled_ = true;
+  {
+    // the winograd weights are not updated by the optimizers
+    std::lock_guard<std::mutex> lock(context.winograd_->mutex);
+    context.winograd_->disabled = true;
+    context.winograd_->entries.clear();
+  }
   return convolution_backward_kernel(
       input,
       grad_output,
@@ -884,6 +1425,100 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> run_backward(
       output_mask);
 }
 
+void warm_up(
+    const ContextConvolution& context,
+    const std::vector<std::vector<int64_t>>& input_sizes) {
+  ideep::attr_t attr = context.conv_params_.op_attr;
+  {
+    std::lock_guard<std::mutex> lock(context.primitive_cache_->mutex);
+    if (context.primitive_cache_->run_attr.has_value()) {
+      attr = context.primitive_cache_->run_attr.value();
+    }
+  }
+  for (const auto& sizes : input_sizes) {
+    check_shape_forward(
+        sizes,
+        context.weight_packed_.get_dims(),
+        context.at_bias_,
+        context.padding_,
+        context.stride_,
+        context.dilation_,
+        context.groups_);
+    auto src_desc = ideep::tensor::desc(
+        sizes,
+        context.original_desc_.get_data_type(),
+        get_format_tag(sizes.size(), context.weight_is_channels_last_));
+    get_cached_primitive(context, src_desc, attr, /* is_warm_up */ true);
+  }
+}
+
+void set_primitive_cache_capacity(
+    const ContextConvolution& context,
+    int64_t capacity) {
+  TORCH_CHECK(
+      capacity >= 0, "primitive cache capacity should be non-negative");
+  auto& cache = *context.primitive_cache_;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.capacity = capacity;
+  while (static_cast<int64_t>(cache.entries.size()) > cache.capacity) {
+    cache.entries.pop_back();
+  }
+}
+
+std::tuple<int64_t, int64_t, int64_t> get_primitive_cache_stats(
+    const ContextConvolution& context) {
+  auto& cache = *context.primitive_cache_;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return std::make_tuple(
+      cache.hits.load(),
+      cache.misses.load(),
+      static_cast<int64_t>(cache.entries.size()));
+}
+
+void set_algorithm(
+    const ContextConvolution& context,
+    ConvAlgorithm algorithm) {
+  {
+    std::lock_guard<std::mutex> lock(context.winograd_->mutex);
+    context.winograd_->algorithm = algorithm;
+    context.winograd_->entries.clear();
+  }
+  // transforms the weight for the prepacked input shape ahead of the calls
+  get_winograd_primitive(
+      context,
+      context.conv_params_.pd.src_desc(),
+      context.conv_params_.op_attr);
+}
+
+ConvAlgorithm get_algorithm(const ContextConvolution& context) {
+  std::lock_guard<std::mutex> lock(context.winograd_->mutex);
+  return context.winograd_->algorithm;
+}
+
+c10::optional<ConvAlgorithm> get_tuned_algorithm(
+    const ContextConvolution& context,
+    const std::vector<int64_t>& input_sizes) {
+  auto& state = *context.winograd_;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.algorithm == ConvAlgorithm::DIRECT || state.disabled) {
+    return c10::nullopt;
+  }
+  for (const auto& entry : state.entries) {
+    if (entry->src_desc.get_dims() != input_sizes) {
+      continue;
+    }
+    if (!entry->supported) {
+      return ConvAlgorithm::DIRECT;
+    }
+    int choice = entry->choice.load();
+    if (choice != ConvWinogradState::UNTUNED) {
+      return choice == ConvWinogradState::WINOGRAD ? ConvAlgorithm::WINOGRAD
+                                                   : ConvAlgorithm::DIRECT;
+    }
+  }
+  return c10::nullopt;
+}
+
 at::Tensor get_at_packed_weight(ContextConvolution& context) {
   return context.at_weight_;
 }
@@ -39,6 +39,29 @@ at::Tensor convolution_run(
     const at::Tensor& input,
     const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
+// The context of conv(upsample_nearest2d(input, scale 2)) prepacked over the
+// low resolution input, for a 2-D convolution of stride 1 and dilation 1
+// whose output keeps the size of its input. The taps of the kernel reading
+// the same input pixel are summed for each of the 4 phases of the output
+// (sub-pixel weights), into a convolution of 4x the output channels whose
+// outputs are shuffled into the phases by convolution_upsample_nearest_run,
+// so the upsampled input is never written. The arguments are those of the
+// convolution over the upsampled input.
+c10::intrusive_ptr<ConvolutionOpContext>
+createConvolutionUpsampleNearestPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    std::vector<int64_t>&& stride,
+    std::vector<int64_t>&& padding,
+    std::vector<int64_t>&& dilation,
+    int64_t groups,
+    bool weight_is_channels_last,
+    std::vector<int64_t>&& input_size);
+
+at::Tensor convolution_upsample_nearest_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(relu);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(sigmoid);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(swish);
@@ -58,6 +81,16 @@ at::Tensor convolution_leaky_relu_run(
     at::Scalar alpha,
     const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
+// conv(silu(group_norm(input))), the activation being written once as the
+// channels last input of the convolution
+at::Tensor convolution_group_norm_silu_run(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& gn_weight,
+    const c10::optional<at::Tensor>& gn_bias,
+    double eps,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
 at::Tensor convolution_hardtanh_run(
     const at::Tensor& input,
     at::Scalar lower_bound,
@@ -158,10 +191,43 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> run_backward(
     const at::Tensor& grad_output,
     std::array<bool, 3> output_mask);
 
+// Creates and caches the forward primitives of the given input sizes ahead of
+// the calls, with the post-ops of the last primitive created by a call
+void warm_up(
+    const ContextConvolution& context,
+    const std::vector<std::vector<int64_t>>& input_sizes);
+
+// Sets the number of primitives kept for the shapes other than the prepacked
+// one, 0 disables the cache
+void set_primitive_cache_capacity(
+    const ContextConvolution& context,
+    int64_t capacity);
+
+// Returns (hits, misses, number of cached primitives)
+std::tuple<int64_t, int64_t, int64_t> get_primitive_cache_stats(
+    const ContextConvolution& context);
+
+// Selects the algorithm of the inference calls, the winograd primitives being
+// created with their transformed weights on the first call of each shape, or
+// now for the prepacked one
+void set_algorithm(const ContextConvolution& context, ConvAlgorithm algorithm);
+
+ConvAlgorithm get_algorithm(const ContextConvolution& context);
+
+// Returns the algorithm run for the input sizes, nullopt if it is not chosen
+// yet or the context runs direct convolutions only
+c10::optional<ConvAlgorithm> get_tuned_algorithm(
+    const ContextConvolution& context,
+    const std::vector<int64_t>& input_sizes);
+
 // Return the n-D ATen weight which sharing same memory with the mkldnn packed
 // weight This n-D ATen weight will be used for autograd and optimizer update
 at::Tensor get_at_packed_weight(ContextConvolution& context);
 
+// Repack the weight of the direct kernels from at_weight_, after it was
+// updated
+void update_direct_weight(ContextConvolution& context);
+
 // Pack given tensor to same format with mkldnn packed weight
 at::Tensor pack(ContextConvolution& context, const at::Tensor& tensor);
 
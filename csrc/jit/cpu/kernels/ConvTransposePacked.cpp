@@ -272,13 +272,16 @@ ContextConvTranspose create(
       dilation_expanded,
       groups);
 
-  bool weight_is_channels_last_ = weight_is_channels_last;
-
-  weight_is_channels_last_ =
+  // the weight is packed for channels last inputs when it is channels last
+  // or when the graph passes traced a channels last input
+  bool weight_is_channels_last_ = weight_is_channels_last ||
       weight.suggest_memory_format() == at::MemoryFormat::ChannelsLast ||
       weight.suggest_memory_format() == at::MemoryFormat::ChannelsLast3d;
-  auto memory_format = weight_is_channels_last_ ? weight.suggest_memory_format()
-                                                : at::MemoryFormat::Contiguous;
+  auto memory_format = at::MemoryFormat::Contiguous;
+  if (weight_is_channels_last_) {
+    memory_format = weight.dim() == 4 ? at::MemoryFormat::ChannelsLast
+                                      : at::MemoryFormat::ChannelsLast3d;
+  }
   auto weight_ = weight.contiguous(memory_format);
 
   auto w = itensor_view_from_dense(weight_);
@@ -7,11 +7,15 @@
 #include <c10/util/Logging.h>
 #include <torch/csrc/autograd/function.h>
 
+#include <array>
 #include <limits>
+#include <memory>
+#include <unordered_map>
 
 #include <ideep.hpp>
 #include "Matmul.h"
 #include "ideep/IDeepConversions.h"
+#include "utils/rcu.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -231,15 +235,18 @@ static Tensor sumproduct_pair(
   // unsqueeze the dim of add_arg corresponding to the dim of einsum result
   // eg: the shape of result is [64,128,1024] while the shape of add_arg is
   // [1024] we should unsqueeze add_arg to [1,1,1024] to use oneDNN binary ops.
+  // add_arg is undefined for the contractions without post add.
   Tensor arg = add_arg;
   auto out_dims = dim - sum_dims_.size();
-  auto add_arg_dim = add_arg.dim();
+  auto add_arg_dim = add_arg.defined() ? add_arg.dim() : out_dims;
 
   for (int i = out_dims - 1; i >= 0; i--) {
     if (add_arg_dim-- <= 0)
       arg = arg.unsqueeze(0);
   }
-  arg = arg.permute(argpermutation);
+  if (arg.defined()) {
+    arg = arg.permute(argpermutation);
+  }
 
   // 1)expand the add_arg to the same shape in ro dims
   // 2)collapse the ro dims to use the oneDNN matmul, pls see the
@@ -250,7 +257,7 @@ static Tensor sumproduct_pair(
   //  they should have same dim order. B should also have the same dim order as
   //  the output for every dim, they should be same or to be 1 to make sure they
   //  can be broadcasted.
-  if (ro.size() > 1) {
+  if (ro.size() > 1 && arg.defined()) {
     auto arg_size = arg.sizes();
     std::vector<int64_t> expanded_size(out_dims, 1);
     for (int i = 0; i < out_dims - ro.size(); i++) {
@@ -335,7 +342,20 @@ static Tensor sumproduct_pair(
   // now we do the computation
   Tensor result;
   bool is_fallback_post_add = false;
-  if (is_add_broadcast_supported_by_onednn(left, right, arg)) {
+  if (!arg.defined()) {
+    // the strided (transposed) operands are read as is by oneDNN matmul
+    if (left.dim() == right.dim() && left.dim() >= 2 && left.dim() <= 4) {
+      result = bmm_impl(
+          left,
+          right,
+          at::Tensor(),
+          ideep::attr_t(torch_ipex::fpmath_mode),
+          {},
+          1.0f);
+    } else {
+      result = at::matmul(left, right);
+    }
+  } else if (is_add_broadcast_supported_by_onednn(left, right, arg)) {
     auto _input = arg.is_contiguous() ? arg : arg.contiguous();
     ideep::tensor onednn_input = itensor_view_from_dense(_input);
     auto op_attr = ideep::attr_t::fuse_binary(
@@ -727,22 +747,14 @@ einsum_prepare(
       unsqueezed_dim_info);
 }
 
-//! function: einsum_binary
-/*!
- * This function use oneDNN binary post-ops to do the einsum+binary fusion.
- *\param equation:  The subscripts for the Einstein summation.
- *more detials about equation can found:
- *https://pytorch.org/docs/stable/generated/torch.einsum.html
- *\param operands: The tensors to compute the Einstein summation of.
- *\param add_arg: the other input of binary ops.
- *\param alpha: the multiplier for other.
- */
-at::Tensor einsum_binary(
+namespace {
+
+// The einsum of two operands, with the post add of add_arg when defined
+Tensor einsum_pair(
     c10::string_view equation,
     const c10::List<at::Tensor>& operands,
     const at::Tensor& add_arg,
     const c10::Scalar& alpha) {
-  RECORD_FUNCTION("dil_einsum_binary", c10::ArrayRef<c10::IValue>({}));
   auto prepare_res = einsum_prepare(equation, operands);
   bool has_zero_size_dim = std::get<0>(prepare_res);
   auto out_size = std::get<1>(prepare_res);
@@ -754,7 +766,9 @@ at::Tensor einsum_binary(
   Tensor operand = permuted_operands[1];
   std::vector<bool> udi_result = unsqueezed_dim_info[0];
   std::vector<bool> udi_operand = unsqueezed_dim_info[1];
-  auto f_alpha = alpha.to<float>();
+  auto add = [&](const Tensor& t) {
+    return add_arg.defined() ? t + alpha.to<float>() * add_arg : t;
+  };
 
   // Fast path for when an operand has zero sized dim
   if (has_zero_size_dim) {
@@ -762,16 +776,14 @@ at::Tensor einsum_binary(
     for (const auto i : c10::irange(out_size)) {
       out_shape[i] = permuted_operands[dim_last_op[i]].size(i);
     }
-    return at::zeros(out_shape, result.options()) + f_alpha * add_arg;
+    return add(at::zeros(out_shape, result.options()));
   }
 
   // Multiply tensors and sum out dimensions in sum_dims
   if (sum_dims.empty()) {
-    result = result.mul(operand);
-    result = result + f_alpha * add_arg;
+    result = add(result.mul(operand));
   } else if (sum_dims.size() == result.sizes().size()) {
-    result = result.flatten().dot(operand.flatten());
-    result = result + f_alpha * add_arg;
+    result = add(result.flatten().dot(operand.flatten()));
   } else {
     result = sumproduct_pair(
         result,
@@ -787,5 +799,357 @@ at::Tensor einsum_binary(
   return result;
 }
 
+// The contraction order of an einsum of more than two operands: each step
+// contracts two of the operands, the intermediates being appended to them
+struct EinsumPlan {
+  std::vector<std::pair<size_t, size_t>> steps;
+  // the equation of the contraction of each step
+  std::vector<std::string> equations;
+};
+
+// The plans by equation and operand shapes, cleared when full
+constexpr size_t kMaxEinsumPlans = 1024;
+torch_ipex::utils::RcuMap<std::string, std::shared_ptr<const EinsumPlan>>
+    einsum_plans;
+
+// The orders of up to kMaxExhaustiveOperands operands are searched over all
+// the contraction trees, the larger einsums contract greedily
+constexpr size_t kMaxExhaustiveOperands = 10;
+
+using LabelSet = uint64_t;
+
+struct ContractionCost {
+  double flops = 0;
+  // the elements of the intermediates
+  double memory = 0;
+
+  bool operator<(const ContractionCost& other) const {
+    return flops < other.flops ||
+        (flops == other.flops && memory < other.memory);
+  }
+};
+
+class EinsumPlanner {
+ public:
+  EinsumPlanner(
+      std::vector<std::string> subscripts,
+      std::string output,
+      std::array<int64_t, 52> label_sizes)
+      : subscripts_(std::move(subscripts)),
+        output_(std::move(output)),
+        label_sizes_(label_sizes) {
+    for (const auto& s : subscripts_) {
+      operand_labels_.push_back(labels_of(s));
+    }
+    output_labels_ = labels_of(output_);
+  }
+
+  std::shared_ptr<const EinsumPlan> plan() {
+    auto plan = std::make_shared<EinsumPlan>();
+    size_t num_ops = subscripts_.size();
+    std::vector<std::string> subscripts = subscripts_;
+    if (num_ops <= kMaxExhaustiveOperands) {
+      uint32_t all = (1u << num_ops) - 1;
+      search(all);
+      emit(all, *plan, subscripts);
+    } else {
+      greedy(*plan, subscripts);
+    }
+    return plan;
+  }
+
+ private:
+  static LabelSet labels_of(const std::string& s) {
+    LabelSet labels = 0;
+    for (unsigned char c : s) {
+      labels |= LabelSet(1) << einsum_label_to_index(c);
+    }
+    return labels;
+  }
+
+  double numel(LabelSet labels) const {
+    double n = 1;
+    for (size_t i = 0; i < label_sizes_.size(); i++) {
+      if (labels & (LabelSet(1) << i)) {
+        n *= label_sizes_[i];
+      }
+    }
+    return n;
+  }
+
+  // The labels of the intermediate of the operands in ops: the ones of the
+  // other operands or the output
+  LabelSet kept_labels(uint32_t ops) const {
+    LabelSet inner = 0, outer = output_labels_;
+    for (size_t i = 0; i < operand_labels_.size(); i++) {
+      if (ops & (1u << i)) {
+        inner |= operand_labels_[i];
+      } else {
+        outer |= operand_labels_[i];
+      }
+    }
+    return inner & outer;
+  }
+
+  // The subscripts of the labels, in the order they appear in a then b
+  std::string subscripts_of(
+      LabelSet labels,
+      const std::string& a,
+      const std::string& b) const {
+    std::string res;
+    for (unsigned char c : a + b) {
+      auto bit = LabelSet(1) << einsum_label_to_index(c);
+      if ((labels & bit) && res.find(c) == std::string::npos) {
+        res.push_back(c);
+      }
+    }
+    return res;
+  }
+
+  // The least cost of the contraction of the operands in ops, and its split
+  ContractionCost search(uint32_t ops) {
+    auto found = best_.find(ops);
+    if (found != best_.end()) {
+      return found->second.first;
+    }
+    ContractionCost best;
+    uint32_t best_split = 0;
+    if (ops & (ops - 1)) {
+      best.flops = std::numeric_limits<double>::infinity();
+      // the splits of ops with its lowest operand on the left
+      uint32_t lowest = ops & (~ops + 1);
+      for (uint32_t left = (ops - 1) & ops; left; left = (left - 1) & ops) {
+        if (!(left & lowest)) {
+          continue;
+        }
+        uint32_t right = ops ^ left;
+        auto l = search(left);
+        auto r = search(right);
+        ContractionCost cost;
+        cost.flops =
+            l.flops + r.flops + numel(kept_labels(left) | kept_labels(right));
+        cost.memory = l.memory + r.memory + numel(kept_labels(ops));
+        if (cost < best) {
+          best = cost;
+          best_split = left;
+        }
+      }
+    }
+    best_[ops] = {best, best_split};
+    return best;
+  }
+
+  // Appends the steps contracting ops, returns the id of its result
+  size_t emit(
+      uint32_t ops,
+      EinsumPlan& plan,
+      std::vector<std::string>& subscripts) {
+    if (!(ops & (ops - 1))) {
+      size_t id = 0;
+      while (!(ops & (1u << id))) {
+        id++;
+      }
+      return id;
+    }
+    uint32_t left = best_[ops].second;
+    size_t l = emit(left, plan, subscripts);
+    size_t r = emit(ops ^ left, plan, subscripts);
+    add_step(l, r, kept_labels(ops), ops == all_ops(), plan, subscripts);
+    return subscripts.size() - 1;
+  }
+
+  void greedy(EinsumPlan& plan, std::vector<std::string>& subscripts) {
+    // the remaining operands with the original operands they contract
+    std::vector<std::pair<size_t, uint32_t>> remaining;
+    for (size_t i = 0; i < subscripts.size(); i++) {
+      remaining.emplace_back(i, 1u << i);
+    }
+    while (remaining.size() > 1) {
+      size_t best_i = 0, best_j = 1;
+      ContractionCost best;
+      best.flops = std::numeric_limits<double>::infinity();
+      for (size_t i = 0; i < remaining.size(); i++) {
+        for (size_t j = i + 1; j < remaining.size(); j++) {
+          auto ops = remaining[i].second | remaining[j].second;
+          ContractionCost cost;
+          cost.flops = numel(
+              kept_labels(remaining[i].second) |
+              kept_labels(remaining[j].second));
+          cost.memory = numel(kept_labels(ops));
+          if (cost < best) {
+            best = cost;
+            best_i = i;
+            best_j = j;
+          }
+        }
+      }
+      auto ops = remaining[best_i].second | remaining[best_j].second;
+      add_step(
+          remaining[best_i].first,
+          remaining[best_j].first,
+          kept_labels(ops),
+          ops == all_ops(),
+          plan,
+          subscripts);
+      remaining.erase(remaining.begin() + best_j);
+      remaining[best_i] = {subscripts.size() - 1, ops};
+    }
+  }
+
+  void add_step(
+      size_t l,
+      size_t r,
+      LabelSet kept,
+      bool last,
+      EinsumPlan& plan,
+      std::vector<std::string>& subscripts) {
+    auto result =
+        last ? output_ : subscripts_of(kept, subscripts[l], subscripts[r]);
+    plan.steps.emplace_back(l, r);
+    plan.equations.push_back(
+        subscripts[l] + "," + subscripts[r] + "->" + result);
+    subscripts.push_back(result);
+  }
+
+  uint32_t all_ops() const {
+    return (1u << subscripts_.size()) - 1;
+  }
+
+  std::vector<std::string> subscripts_;
+  std::string output_;
+  std::array<int64_t, 52> label_sizes_;
+  std::vector<LabelSet> operand_labels_;
+  LabelSet output_labels_;
+  std::unordered_map<uint32_t, std::pair<ContractionCost, uint32_t>> best_;
+};
+
+// The plan of the einsum, nullptr when it is not a contraction of 3 to 32
+// fp32 or bf16 operands with explicit output and single letter labels of
+// equal sizes (no ellipsis, broadcast or diagonal)
+std::shared_ptr<const EinsumPlan> einsum_plan(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands) {
+  const auto arrow_pos = equation.find("->");
+  if (arrow_pos == c10::string_view::npos || operands.size() < 3 ||
+      operands.size() > 32) {
+    return nullptr;
+  }
+  std::vector<std::string> subscripts(1);
+  for (unsigned char c : equation.substr(0, arrow_pos)) {
+    if (c == ',') {
+      subscripts.emplace_back();
+    } else if (einsum_check_label(c)) {
+      if (subscripts.back().find(c) != std::string::npos) {
+        return nullptr;
+      }
+      subscripts.back().push_back(c);
+    } else if (c != ' ') {
+      return nullptr;
+    }
+  }
+  std::string output;
+  for (unsigned char c : equation.substr(arrow_pos + 2)) {
+    if (einsum_check_label(c)) {
+      output.push_back(c);
+    } else if (c != ' ') {
+      return nullptr;
+    }
+  }
+  if (subscripts.size() != operands.size()) {
+    return nullptr;
+  }
+
+  std::string key(equation);
+  std::array<int64_t, 52> label_sizes;
+  label_sizes.fill(-1);
+  auto dtype = operands.get(0).scalar_type();
+  for (size_t i = 0; i < operands.size(); i++) {
+    const auto& t = operands.get(i);
+    if ((dtype != at::kFloat && dtype != at::kBFloat16) ||
+        t.scalar_type() != dtype ||
+        t.dim() != static_cast<int64_t>(subscripts[i].size())) {
+      return nullptr;
+    }
+    for (size_t j = 0; j < subscripts[i].size(); j++) {
+      auto& size = label_sizes[einsum_label_to_index(subscripts[i][j])];
+      if (size != -1 && size != t.size(j)) {
+        return nullptr;
+      }
+      size = t.size(j);
+      key += "," + std::to_string(size);
+    }
+    key += ";";
+  }
+  for (unsigned char c : output) {
+    if (label_sizes[einsum_label_to_index(c)] == -1) {
+      return nullptr;
+    }
+  }
+
+  std::shared_ptr<const EinsumPlan> plan;
+  if (einsum_plans.find(key, plan)) {
+    return plan;
+  }
+  plan = EinsumPlanner(subscripts, output, label_sizes).plan();
+  einsum_plans.update([&](auto& plans) {
+    if (plans.size() >= kMaxEinsumPlans) {
+      plans.clear();
+    }
+    plans.emplace(key, plan);
+  });
+  return plan;
+}
+
+} // namespace
+
+//! function: einsum_binary
+/*!
+ * This function use oneDNN binary post-ops to do the einsum+binary fusion.
+ *\param equation:  The subscripts for the Einstein summation.
+ *more detials about equation can found:
+ *https://pytorch.org/docs/stable/generated/torch.einsum.html
+ *\param operands: The tensors to compute the Einstein summation of.
+ *\param add_arg: the other input of binary ops.
+ *\param alpha: the multiplier for other.
+ */
+at::Tensor einsum_binary(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands,
+    const at::Tensor& add_arg,
+    const c10::Scalar& alpha) {
+  RECORD_FUNCTION("dil_einsum_binary", c10::ArrayRef<c10::IValue>({}));
+  return einsum_pair(equation, operands, add_arg, alpha);
+}
+
+//! function: einsum_contract
+/*!
+ * This function runs the einsum of more than two operands as the pairwise
+ * contractions of the order of the least FLOPs (then intermediate elements),
+ * planned once per equation and operand shapes, each contraction running as a
+ * oneDNN matmul reading the permuted operands without transposing them.
+ * The other einsums run with at::einsum.
+ *\param equation:  The subscripts for the Einstein summation.
+ *\param operands: The tensors to compute the Einstein summation of.
+ */
+at::Tensor einsum_contract(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands) {
+  RECORD_FUNCTION("dil_einsum_contract", c10::ArrayRef<c10::IValue>({}));
+  auto plan = einsum_plan(equation, operands);
+  if (!plan) {
+    return at::einsum(equation, operands.vec());
+  }
+  std::vector<Tensor> tensors = operands.vec();
+  for (size_t i = 0; i < plan->steps.size(); i++) {
+    c10::List<at::Tensor> pair(
+        {tensors[plan->steps[i].first], tensors[plan->steps[i].second]});
+    tensors.push_back(einsum_pair(plan->equations[i], pair, Tensor(), 1));
+    // release the contracted intermediates
+    tensors[plan->steps[i].first] = Tensor();
+    tensors[plan->steps[i].second] = Tensor();
+  }
+  return tensors.back();
+}
+
 } // namespace cpu
 } // namespace torch_ipex
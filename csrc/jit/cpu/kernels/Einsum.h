@@ -15,6 +15,7 @@ namespace jit {
 // So we fake some op namespaces to workaround that.
 namespace ipex {
 static auto einsum_binary = Symbol::fromQualString("ipex::einsum_binary");
+static auto einsum_contract = Symbol::fromQualString("ipex::einsum_contract");
 
 } // namespace ipex
 
@@ -30,6 +31,11 @@ at::Tensor einsum_binary(
     const at::Tensor& input,
     const c10::Scalar& alpha);
 
+// The einsum of more than two operands in the planned contraction order
+at::Tensor einsum_contract(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands);
+
 bool is_add_broadcast_supported_by_onednn(
     const at::Tensor& left,
     const at::Tensor& right,
@@ -0,0 +1,108 @@
+#include "LinearDynamicQuantPacked.h"
+#include "aten/LinearDynamicQuant.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace dynamic_quant_linear {
+
+c10::intrusive_ptr<DynamicQuantLinearOpContext>
+createDynamicQuantLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createDynamicQuantLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  auto quantized = dynamic_quant_linear_quantize_weight(weight);
+  return IpexDynamicQuantLinearOpContext::create_context(
+      std::move(std::get<0>(quantized)),
+      std::move(std::get<1>(quantized)),
+      std::move(bias));
+}
+
+c10::intrusive_ptr<DynamicQuantLinearOpContext>
+createDynamicQuantLinearPrePackOpContextQuantized(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    c10::optional<at::Tensor>&& bias) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createDynamicQuantLinearPrePackOpContextQuantized",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexDynamicQuantLinearOpContext::create_context(
+      std::move(qweight), std::move(scales), std::move(bias));
+}
+
+at::Tensor dynamic_quant_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<DynamicQuantLinearOpContext> op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::dynamic_quant_linear_run",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(input);
+}
+
+ContextLinearDynamicQuant create(
+    at::Tensor& qweight,
+    at::Tensor& scales,
+    const c10::optional<at::Tensor>& bias) {
+  TORCH_CHECK(
+      qweight.dim() == 2, "expect the 2-D quantized weight of a linear");
+  auto out_features = qweight.size(0);
+  auto in_features = qweight.size(1);
+  TORCH_CHECK(
+      scales.numel() == out_features || scales.numel() == 1,
+      "expect the scales of out_features or a per tensor scale");
+  if (bias.has_value()) {
+    TORCH_CHECK(bias->numel() == out_features, "expect bias of out_features");
+  }
+  auto scales_ =
+      scales.to(at::kFloat).reshape({-1}).expand({out_features}).contiguous();
+  auto packed_weight = dynamic_quant_linear_pack_weight(qweight.contiguous());
+  auto padded_features = packed_weight.size(0) * dq_block_n;
+  auto packed_scales =
+      at::constant_pad_nd(scales_, {0, padded_features - out_features}, 0);
+  auto compensation = dynamic_quant_linear_compensation(packed_weight);
+  return ContextLinearDynamicQuant{
+      std::move(packed_weight),
+      std::move(scales_),
+      std::move(packed_scales),
+      std::move(compensation),
+      bias.has_value() ? c10::make_optional(bias->to(at::kFloat).contiguous())
+                       : c10::nullopt,
+      out_features,
+      in_features,
+  };
+}
+
+at::Tensor run(ContextLinearDynamicQuant& context, const at::Tensor& input) {
+  TORCH_CHECK(
+      input.size(input.dim() - 1) == context.in_features_,
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  c10::MaybeOwned<at::Tensor> bias_maybe_owned =
+      at::borrow_from_optional_tensor(context.at_bias_);
+  const at::Tensor& bias = *bias_maybe_owned;
+  return dynamic_quant_linear_kernel(
+      input,
+      context.at_weight_,
+      context.compensation_,
+      context.packed_scales_,
+      bias,
+      context.out_features_);
+}
+
+at::Tensor unpack(ContextLinearDynamicQuant& context) {
+  return dynamic_quant_linear_unpack_weight(
+      context.at_weight_, context.out_features_, context.in_features_);
+}
+
+at::Tensor dequantize(ContextLinearDynamicQuant& context) {
+  return unpack(context).to(at::kFloat) * context.scales_.unsqueeze(-1);
+}
+
+} // namespace dynamic_quant_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextLinearDynamicQuant.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace dynamic_quant_linear {
+
+c10::intrusive_ptr<DynamicQuantLinearOpContext>
+createDynamicQuantLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias);
+
+c10::intrusive_ptr<DynamicQuantLinearOpContext>
+createDynamicQuantLinearPrePackOpContextQuantized(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    c10::optional<at::Tensor>&& bias);
+
+at::Tensor dynamic_quant_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<DynamicQuantLinearOpContext> op_context);
+
+// scales of [out_features], or a single per tensor scale
+ContextLinearDynamicQuant create(
+    at::Tensor& qweight,
+    at::Tensor& scales,
+    const c10::optional<at::Tensor>& bias);
+
+at::Tensor run(ContextLinearDynamicQuant& context, const at::Tensor& input);
+
+// Return the int8 weight of [out_features, in_features]
+at::Tensor unpack(ContextLinearDynamicQuant& context);
+
+// Return the dequantized fp32 weight of [out_features, in_features]
+at::Tensor dequantize(ContextLinearDynamicQuant& context);
+
+} // namespace dynamic_quant_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,8 +1,12 @@
 #include "LinearMKLPacked.h"
 #include <ideep.hpp>
+#include "aten/Linear.h"
 #include "aten/LinearMKL.h"
 #include "aten/WeightPack.h"
+#include "aten/utils/bf32_gemm.h"
 #include "ideep/IDeepConversions.h"
+#include "utils/kernel_selector.h"
+#include "utils/memory_tracker.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -54,6 +58,114 @@ ContextLinearMKL create(
   };
 }
 
+namespace {
+
+// The M the weight is packed for besides the one of the prepack, e.g. the
+// batch sizes of a model of variable batch, each costing a packed weight
+constexpr size_t kMaxPackedVariants = 8;
+
+// The weight packed for M rows, undefined if it is not packed for M: MKL
+// packs B for the M, N and K it computes, so the packed weight of each other
+// M is packed once on its first run and kept, up to kMaxPackedVariants of
+// them, the others running the non-packed sgemm
+at::Tensor get_packed_weight(ContextLinearMKL& context, int64_t M) {
+  if (M == context.sgemm_sizes_[0]) {
+    return context.at_weight_;
+  }
+  auto& variants = *context.packed_variants_;
+  at::Tensor packed;
+  if (variants.find(M, packed)) {
+    return packed;
+  }
+  if (M == 0 || variants.size() >= kMaxPackedVariants) {
+    return at::Tensor();
+  }
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::linear_mkl");
+  packed = mkl_sgemm_pack_weight(
+      M,
+      context.sgemm_sizes_[2],
+      context.sgemm_sizes_[1],
+      context.ori_weight_);
+  return variants.insert(M, packed);
+}
+
+// The kernels the runtime kernel selection picks the fp32 linear among
+enum LinearMKLKernel : int64_t {
+  kMKLPacked = 0,
+  kMKL = 1,
+  kDnnl = 2,
+  kNumKernels = 3,
+};
+
+// The weight packed for oneDNN, packed once from the non-packed weight
+const ideep::tensor& get_dnnl_weight(ContextLinearMKL& context) {
+  auto& dnnl_weight = *context.dnnl_weight_;
+  std::call_once(dnnl_weight.packed, [&]() {
+    torch_ipex::utils::MemoryScope memory_scope("weight_pack::linear_mkl");
+    auto packed_desc = ideep::inner_product_forward::expected_weights_desc(
+        {context.sgemm_sizes_[2], context.sgemm_sizes_[1]},
+        {context.sgemm_sizes_[0], context.sgemm_sizes_[1]},
+        /* weight dtype */ ideep::data_type::f32,
+        /* src dtype */ ideep::data_type::f32);
+    dnnl_weight.at_weight = empty_aten_tensor_from_desc(
+        packed_desc, context.ori_weight_.options());
+    dnnl_weight.weight.init(packed_desc, dnnl_weight.at_weight.data_ptr());
+    dnnl_weight.weight.feed_from(
+        itensor_view_from_dense(context.ori_weight_));
+  });
+  return dnnl_weight.weight;
+}
+
+// Runs the linear of the contiguous input into output. When the runtime
+// kernel selection is enabled, the kernel of each M, N, K and threads is the
+// fastest of the MKL packed, MKL and oneDNN kernels on its first runs.
+void run_output(
+    ContextLinearMKL& context,
+    const at::Tensor& input,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  int64_t K = context.sgemm_sizes_[1];
+  int64_t N = context.sgemm_sizes_[2];
+  int64_t M = input.numel() / K;
+  // The BF32 fpmath mode runs the non-packed weight in bf16.
+  if (use_bf32_gemm()) {
+    mkl_sgemm_kernel_output(input, context.ori_weight_, bias, output);
+    return;
+  }
+  auto packed_weight = get_packed_weight(context, M);
+  int64_t kernel = packed_weight.defined() ? kMKLPacked : kMKL;
+  c10::optional<torch_ipex::utils::KernelSelection> selection;
+  if (M > 0 && torch_ipex::utils::is_kernel_selection_enabled()) {
+    get_dnnl_weight(context);
+    selection.emplace(
+        torch_ipex::utils::kernel_selection_key("linear_mkl", {M, N, K}),
+        kNumKernels,
+        packed_weight.defined() ? ~0ull : ~(1ull << kMKLPacked));
+    kernel = selection->kernel();
+  }
+  // a loaded table may pick the packed weight of an M not packed here
+  if (kernel == kMKLPacked && !packed_weight.defined()) {
+    kernel = kMKL;
+  }
+  switch (kernel) {
+    case kMKLPacked:
+      mkl_prepack_sgemm_kernel_output(input, packed_weight, bias, N, output);
+      break;
+    case kDnnl:
+      linear_kernel_output(
+          input,
+          get_dnnl_weight(context),
+          bias,
+          output,
+          ideep::attr_t(torch_ipex::fpmath_mode));
+      break;
+    default:
+      mkl_sgemm_kernel_output(input, context.ori_weight_, bias, output);
+  }
+}
+
+} // namespace
+
 at::Tensor run(ContextLinearMKL& context, const at::Tensor& input) {
   int64_t K = input.size(input.dim() - 1);
   TORCH_CHECK(
@@ -63,16 +175,13 @@ at::Tensor run(ContextLinearMKL& context, const at::Tensor& input) {
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.at_bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  int64_t input_batch = (int64_t)(input_.numel() / K);
-
-  // Since MKL prepack API only accepts fixed M/N/K, a repack is required
-  // when M changes. To avoid frequently repacking the weights,
-  // it will fall back to the MKL cblas_sgemm kernel when M-dim is
-  // dynamically changed.
-  if (input_batch != context.sgemm_sizes_[0])
-    return mkl_sgemm_kernel(input_, context.ori_weight_, bias);
-  return mkl_prepack_sgemm_kernel(
-      input_, context.at_weight_, bias, context.sgemm_sizes_[2]);
+  auto input_size = input_.sizes();
+  std::vector<int64_t> output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(context.sgemm_sizes_[2]);
+  auto output = at::empty(output_size, input_.options());
+  output.set_requires_grad(input_.requires_grad());
+  run_output(context, input_, bias, output);
+  return output;
 }
 
 at::Tensor& run(
@@ -87,13 +196,7 @@ at::Tensor& run(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.at_bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  int64_t input_batch = (int64_t)(input_.numel() / K);
-  if (input_batch != context.sgemm_sizes_[0]) {
-    mkl_sgemm_kernel_output(input_, context.ori_weight_, bias, accumu);
-  } else {
-    mkl_prepack_sgemm_kernel_output(
-        input_, context.at_weight_, bias, context.sgemm_sizes_[2], accumu);
-  }
+  run_output(context, input_, bias, accumu);
   return accumu;
 }
 
@@ -1,14 +1,83 @@
 #include "LinearPacked.h"
 #include <ideep.hpp>
+#include "PackedWeightRegistry.h"
 #include "aten/Linear.h"
+#include "aten/LinearEpilogue.h"
+#include "aten/NormLinear.h"
+#include "aten/SparseLinear.h"
 #include "aten/WeightPack.h"
 #include "ideep/IDeepConversions.h"
+#include "runtime/ParallelContext.h"
 
 namespace torch_ipex {
 namespace cpu {
 namespace detail {
 namespace linear {
 
+namespace {
+
+int64_t weight_version(const at::Tensor& weight) {
+  return weight.is_inference() ? 0 : weight._version();
+}
+
+// Whether the block-sparse weight is up to date and the sparse kernel fuses
+// the post-op of attr, the other cases run with oneDNN
+bool use_sparse_linear_kernel(
+    const ContextLinear& context,
+    const at::Tensor& input,
+    const ideep::attr_t& attr,
+    SparseLinearPostOp& post_op) {
+  if (!context.sparse_weight_.has_value() ||
+      weight_version(context.at_weight_) != context.sparse_weight_version_) {
+    return false;
+  }
+  auto dtype = context.at_weight_.scalar_type();
+  if (input.scalar_type() != dtype ||
+      (context.at_bias_.has_value() &&
+       context.at_bias_->scalar_type() != dtype)) {
+    return false;
+  }
+  if (attr.has_same_postop_as(ideep::attr_t())) {
+    post_op = SparseLinearPostOp::NONE;
+  } else if (attr.has_same_postop_as(ideep::attr_t::fuse_relu())) {
+    post_op = SparseLinearPostOp::RELU;
+  } else if (attr.has_same_postop_as(ideep::attr_t::fuse_sigmoid())) {
+    post_op = SparseLinearPostOp::SIGMOID;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Whether out is the contiguous output of the shape of input, which the
+// sparse kernel does not write into
+bool is_planned_output(
+    const ContextLinear& context,
+    const at::Tensor& input,
+    const at::Tensor& out) {
+  if (context.sparse_weight_.has_value() || input.dim() == 0 ||
+      !out.is_contiguous() || out.scalar_type() != input.scalar_type()) {
+    return false;
+  }
+  auto output_size = input.sizes().vec();
+  output_size.back() = context.weight_packed_.get_dims()[0];
+  return out.sizes() == c10::IntArrayRef(output_size);
+}
+
+at::Tensor run_out(
+    const at::Tensor& input,
+    at::Tensor& out,
+    const c10::intrusive_ptr<LinearOpContext>& op_context,
+    const ideep::attr_t& attr) {
+  if (!is_planned_output(op_context->get_context(), input, out)) {
+    return op_context->run(input, attr);
+  }
+  op_context->run(input, out, attr);
+  return out;
+}
+
+} // namespace
+
 #define DEFINE_LINEAR_UNARY_ELTWISE_RUN(FUSED_OP)              \
   at::Tensor linear_##FUSED_OP##_run(                          \
       const at::Tensor& input,                                 \
@@ -42,6 +111,29 @@ at::Tensor linear_run(
   return op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode));
 }
 
+at::Tensor linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& out,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_run_out", c10::ArrayRef<c10::IValue>({}));
+  return run_out(
+      input, out, op_context, ideep::attr_t(torch_ipex::fpmath_mode));
+}
+
+at::Tensor linear_relu_run_out(
+    const at::Tensor& input,
+    at::Tensor& out,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_relu_run_out", c10::ArrayRef<c10::IValue>({}));
+  return run_out(
+      input,
+      out,
+      op_context,
+      ideep::attr_t::fuse_relu().set_fpmath_mode(torch_ipex::fpmath_mode));
+}
+
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(relu);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(sigmoid);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(swish);
@@ -139,6 +231,149 @@ at::Tensor linear_gelu_run(
           .set_fpmath_mode(torch_ipex::fpmath_mode));
 }
 
+ideep::attr_t eltwise_chain_attr(
+    c10::ArrayRef<int64_t> algorithms,
+    c10::ArrayRef<double> alphas,
+    c10::ArrayRef<double> betas) {
+  TORCH_CHECK(
+      algorithms.size() == alphas.size() && algorithms.size() == betas.size(),
+      "ipex::linear_eltwise_chain_run expects an alpha and a beta per post-op");
+  ideep::post_ops po;
+  for (size_t i = 0; i < algorithms.size(); i++) {
+    po.append_eltwise(
+        1.0,
+        static_cast<dnnl::algorithm>(algorithms[i]),
+        static_cast<float>(alphas[i]),
+        static_cast<float>(betas[i]));
+  }
+  ideep::attr_t attr(torch_ipex::fpmath_mode);
+  attr.set_post_ops(po);
+  return attr;
+}
+
+at::Tensor linear_eltwise_chain_run(
+    const at::Tensor& input,
+    c10::ArrayRef<int64_t> algorithms,
+    c10::ArrayRef<double> alphas,
+    c10::ArrayRef<double> betas,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_eltwise_chain_run",
+      c10::ArrayRef<c10::IValue>({}));
+  return op_context->run(input, eltwise_chain_attr(algorithms, alphas, betas));
+}
+
+at::Tensor linear_gate_run(
+    const at::Tensor& input,
+    int64_t activation,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_gate_run", c10::ArrayRef<c10::IValue>({}));
+  auto pre_act =
+      op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode))
+          .contiguous();
+  int64_t N = pre_act.size(-1) / 2;
+  TORCH_CHECK(
+      pre_act.size(-1) == 2 * N,
+      "ipex::linear_gate_run expects the concatenated gate and up projections");
+  auto output_size = pre_act.sizes().vec();
+  output_size.back() = N;
+  auto output = at::empty(output_size, pre_act.options());
+  auto output_ = output.view({-1, N});
+  /*
+  pointer to torch_ipex::cpu::linear_gate_kernel_impl(
+      pre_act, output, activation);
+  */
+  torch_ipex::cpu::linear_gate_kernel_stub(
+      at::kCPU, pre_act.view({-1, 2 * N}), output_, activation);
+  return output;
+}
+
+at::Tensor norm_linear_run(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& residual,
+    const c10::optional<at::Tensor>& gamma,
+    const c10::optional<at::Tensor>& beta,
+    int64_t norm,
+    double eps,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::norm_linear_run", c10::ArrayRef<c10::IValue>({}));
+  int64_t K = input.size(-1);
+  int64_t N = op_context->get_context().weight_packed_.get_dims()[0];
+  TORCH_CHECK(
+      K == op_context->get_context().weight_packed_.get_dims()[1],
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  auto x = input.contiguous().view({-1, K});
+  at::Tensor r;
+  if (norm == torch_ipex::cpu::AddLayerNormKind) {
+    TORCH_CHECK(
+        residual.has_value() && residual->scalar_type() == input.scalar_type(),
+        "ipex_prepack::norm_linear_run expects a residual of the input dtype");
+    r = residual->expand_as(input).contiguous().view({-1, K});
+  }
+  // the affine params are read in bfloat16 only along a bfloat16 input
+  auto param_dtype = input.scalar_type() == at::kBFloat16 &&
+          gamma.has_value() && gamma->scalar_type() == at::kBFloat16
+      ? at::kBFloat16
+      : at::kFloat;
+  auto affine_param = [&](const c10::optional<at::Tensor>& t) {
+    return t.has_value() ? t->contiguous().to(param_dtype) : at::Tensor();
+  };
+  auto gamma_ = affine_param(gamma);
+  auto beta_ = affine_param(beta);
+
+  auto output_size = input.sizes().vec();
+  output_size.back() = N;
+  auto output = at::empty(output_size, input.options());
+  int64_t M = x.size(0);
+  if (M == 0) {
+    return output;
+  }
+  auto output_ = output.view({-1, N});
+  // The rows are normalized and multiplied by chunks, a chunk of the
+  // normalized rows fitting in the L2 caches of the threads, so that the GEMM
+  // reads the scratch tile the prologue just wrote from cache. Decode shapes
+  // are a single chunk. The team is the CPUPool of the thread, so a stream of
+  // MultiStreamModule sizes the chunk for its own cores.
+  auto parallel_context = torch_ipex::runtime::get_parallel_context();
+  const int64_t min_chunk_m = 64;
+  int64_t row_bytes = K * input.element_size();
+  int64_t chunk_m = std::max(
+      min_chunk_m,
+      parallel_context.l2_bytes * parallel_context.num_threads /
+          std::max<int64_t>(row_bytes, 1));
+  chunk_m = std::min(chunk_m, M);
+  auto scratch = at::empty({chunk_m, K}, input.options());
+  auto attr = ideep::attr_t(torch_ipex::fpmath_mode);
+  for (int64_t m0 = 0; m0 < M; m0 += chunk_m) {
+    int64_t rows = std::min(chunk_m, M - m0);
+    auto tile = scratch.narrow(0, 0, rows);
+    // each thread normalizes its M-block of rows of the chunk
+    at::parallel_for(0, rows, 1, [&](int64_t begin, int64_t end) {
+      auto tile_rows = tile.narrow(0, begin, end - begin);
+      /*
+      pointer to torch_ipex::cpu::norm_rows_kernel_impl(
+          x, r, gamma_, beta_, norm, eps, m0 + begin, m0 + end, tile_rows);
+      */
+      torch_ipex::cpu::norm_rows_kernel_stub(
+          at::kCPU,
+          x,
+          r,
+          gamma_,
+          beta_,
+          norm,
+          eps,
+          m0 + begin,
+          m0 + end,
+          tile_rows);
+    });
+    auto output_rows = output_.narrow(0, m0, rows);
+    op_context->run(tile, output_rows, attr);
+  }
+  return output;
+}
+
 at::Tensor linear_add_run(
     const at::Tensor& input,
     at::Tensor& accumu,
@@ -183,30 +418,44 @@ ContextLinear create(
   if (batch_size.has_value()) {
     input_size = {batch_size.value(), in_features};
   }
-  auto packed_desc = ideep::inner_product_forward::expected_weights_desc(
-      {out_features, in_features},
-      input_size,
-      /* weight dtype */ dtype,
-      /* src dtype */ dtype);
-  auto at_weight = empty_aten_tensor_from_desc(packed_desc, weight.options());
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(packed_desc, at_weight.template data_ptr<float>());
-  } else if (ideep::data_type::bf16 == dtype) {
-    packed_weight.init(
-        packed_desc, at_weight.template data_ptr<c10::BFloat16>());
-  } else {
-    TORCH_CHECK(
-        ideep::data_type::f16 == dtype,
-        "Only support bfloat16, float16 and float for weight prepack of linear");
-    packed_weight.init(packed_desc, at_weight.template data_ptr<c10::Half>());
-  }
-  packed_weight.feed_from(w);
-  return ContextLinear{
+  // keep the plain layout read by the small M kernel when the sample input
+  // is within its range
+  auto packed_desc =
+      batch_size.has_value() && batch_size.value() <= linear_small_m
+      ? ideep::tensor::desc(
+            {out_features, in_features}, dtype, ideep::format_tag::ab)
+      : ideep::inner_product_forward::expected_weights_desc(
+            {out_features, in_features},
+            input_size,
+            /* weight dtype */ dtype,
+            /* src dtype */ dtype);
+  TORCH_CHECK(
+      ideep::data_type::f32 == dtype || ideep::data_type::bf16 == dtype ||
+          ideep::data_type::f16 == dtype,
+      "Only support bfloat16, float16 and float for weight prepack of linear");
+  // shared with the other contexts packing the same read-only weight
+  auto at_weight =
+      PackedWeightRegistry::get().get_or_pack(weight, w, packed_desc);
+  packed_weight.init(packed_desc, at_weight.data_ptr());
+  auto context = ContextLinear{
       std::move(ori_desc),
       std::move(packed_weight),
       std::move(at_weight),
       bias.has_value() ? c10::make_optional(*bias) : c10::nullopt,
   };
+  context.sparse_weight_ = pack_sparse_linear_weight(weight);
+  context.sparse_weight_version_ = weight_version(context.at_weight_);
+  return context;
+}
+
+void update_sparse_weight(ContextLinear& context) {
+  context.sparse_weight_.reset();
+  if (context.sparse_weight_disabled_) {
+    return;
+  }
+  auto weight = unpack(context, context.at_weight_);
+  context.sparse_weight_ = pack_sparse_linear_weight(weight);
+  context.sparse_weight_version_ = weight_version(context.at_weight_);
 }
 
 at::Tensor run(
@@ -220,6 +469,15 @@ at::Tensor run(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.at_bias_);
   const at::Tensor& bias = *bias_maybe_owned;
+  SparseLinearPostOp post_op;
+  if (use_sparse_linear_kernel(context, input_, attr, post_op)) {
+    auto output_size = input_.sizes().vec();
+    output_size.back() = context.sparse_weight_->out_features;
+    auto output = at::empty(output_size, input_.options());
+    sparse_linear_kernel_output(
+        input_, *context.sparse_weight_, bias, output, post_op);
+    return output;
+  }
   return linear_kernel(input_, context.weight_packed_, bias, attr);
 }
 
@@ -274,6 +532,8 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> run_backward(
     const at::Tensor& input,
     const at::Tensor& grad_output,
     std::array<bool, 3> output_mask) {
+  context.sparse_weight_.reset();
+  context.sparse_weight_disabled_ = true;
   return linear_backward_kernel(
       input,
       grad_output,
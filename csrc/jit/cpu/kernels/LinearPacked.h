@@ -37,6 +37,18 @@ DECLARE_LINEAR_UNARY_ELTWISE_RUN(round);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(sqrt);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(hardsigmoid);
 
+// linear_run and linear_relu_run writing into out, the buffer planned for
+// their output, unless out is not the contiguous output of the shape of input
+at::Tensor linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& out,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
+at::Tensor linear_relu_run_out(
+    const at::Tensor& input,
+    at::Tensor& out,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
 at::Tensor linear_leaky_relu_run(
     const at::Tensor& input,
     at::Scalar alpha,
@@ -65,6 +77,39 @@ at::Tensor linear_gelu_run(
     c10::string_view approximate,
     const c10::intrusive_ptr<LinearOpContext>& op_context);
 
+// linear_run with a chain of eltwise post-ops, applied in order: the
+// dnnl::algorithm (as int) of each post-op, with its alpha and beta
+at::Tensor linear_eltwise_chain_run(
+    const at::Tensor& input,
+    c10::ArrayRef<int64_t> algorithms,
+    c10::ArrayRef<double> alphas,
+    c10::ArrayRef<double> betas,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
+ideep::attr_t eltwise_chain_attr(
+    c10::ArrayRef<int64_t> algorithms,
+    c10::ArrayRef<double> alphas,
+    c10::ArrayRef<double> betas);
+
+// act(gate) * up of a gated MLP, op_context holding the weights of its gate
+// and up projections concatenated: activation is a LinearEpilogueAct
+at::Tensor linear_gate_run(
+    const at::Tensor& input,
+    int64_t activation,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
+// linear_run on the input normalized in its prologue, norm a NormLinearKind:
+// LayerNorm(input + residual) * gamma + beta or RMSNorm(input) * gamma. The
+// normalized input is only materialized a cache sized chunk at a time.
+at::Tensor norm_linear_run(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& residual,
+    const c10::optional<at::Tensor>& gamma,
+    const c10::optional<at::Tensor>& beta,
+    int64_t norm,
+    double eps,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
 at::Tensor linear_add_run(
     const at::Tensor& input,
     at::Tensor& accumu,
@@ -107,6 +152,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> run_backward(
     const at::Tensor& grad_output,
     std::array<bool, 3> output_mask);
 
+// Repack the block-sparse weight from at_weight_, after it was updated
+void update_sparse_weight(ContextLinear& context);
+
 // Pack given tensor to same format with mkldnn packed weight
 at::Tensor pack(ContextLinear& context, const at::Tensor& tensor);
 
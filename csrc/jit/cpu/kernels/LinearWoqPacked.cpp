@@ -0,0 +1,133 @@
+#include "LinearWoqPacked.h"
+#include "aten/LinearWoq.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createWoqLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  auto quantized = woq_linear_quantize_weight(weight, bits, group_size);
+  return IpexWoqLinearOpContext::create_context(
+      std::move(std::get<0>(quantized)),
+      std::move(std::get<1>(quantized)),
+      std::move(std::get<2>(quantized)),
+      std::move(bias),
+      bits,
+      group_size);
+}
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContextQuantized(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    at::Tensor&& zero_points,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createWoqLinearPrePackOpContextQuantized",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexWoqLinearOpContext::create_context(
+      std::move(qweight),
+      std::move(scales),
+      std::move(zero_points),
+      std::move(bias),
+      bits,
+      group_size);
+}
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<WoqLinearOpContext> op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::woq_linear_run", c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(input);
+}
+
+ContextLinearWoq create(
+    at::Tensor& qweight,
+    at::Tensor& scales,
+    at::Tensor& zero_points,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size) {
+  TORCH_CHECK(
+      qweight.dim() == 2, "expect the 2-D quantized weight of a linear");
+  auto out_features = qweight.size(0);
+  auto in_features = qweight.size(1);
+  if (group_size <= 0) {
+    group_size = in_features;
+  }
+  TORCH_CHECK(
+      in_features % group_size == 0 &&
+          scales.sizes() ==
+              c10::IntArrayRef({out_features, in_features / group_size}) &&
+          zero_points.sizes() == scales.sizes(),
+      "expect scales and zero points of [out_features, in_features / group_size]");
+  if (bias.has_value()) {
+    TORCH_CHECK(bias->numel() == out_features, "expect bias of out_features");
+  }
+  auto packed_weight = woq_linear_pack_weight(qweight.contiguous(), bits);
+  auto packed_params = woq_linear_pack_group_params(scales, zero_points);
+  return ContextLinearWoq{
+      std::move(packed_weight),
+      scales.to(at::kFloat).contiguous(),
+      zero_points.to(at::kFloat).contiguous(),
+      std::move(std::get<0>(packed_params)),
+      std::move(std::get<1>(packed_params)),
+      bias.has_value() ? c10::make_optional(bias->to(at::kFloat).contiguous())
+                       : c10::nullopt,
+      bits,
+      group_size,
+      out_features,
+      in_features,
+  };
+}
+
+at::Tensor run(ContextLinearWoq& context, const at::Tensor& input) {
+  TORCH_CHECK(
+      input.size(input.dim() - 1) == context.in_features_,
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  c10::MaybeOwned<at::Tensor> bias_maybe_owned =
+      at::borrow_from_optional_tensor(context.at_bias_);
+  const at::Tensor& bias = *bias_maybe_owned;
+  return woq_linear_kernel(
+      input,
+      context.at_weight_,
+      context.packed_scales_,
+      context.packed_zero_biases_,
+      bias,
+      context.bits_,
+      context.group_size_,
+      context.out_features_);
+}
+
+at::Tensor unpack(ContextLinearWoq& context) {
+  return woq_linear_unpack_weight(
+      context.at_weight_, context.bits_, context.out_features_);
+}
+
+at::Tensor dequantize(ContextLinearWoq& context) {
+  auto N = context.out_features_;
+  auto K = context.in_features_;
+  auto qweight =
+      unpack(context).to(at::kFloat).view({N, -1, context.group_size_});
+  return ((qweight - context.zero_points_.unsqueeze(-1)) *
+          context.scales_.unsqueeze(-1))
+      .view({N, K});
+}
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextLinearWoq.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size);
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContextQuantized(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    at::Tensor&& zero_points,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<WoqLinearOpContext> op_context);
+
+ContextLinearWoq create(
+    at::Tensor& qweight,
+    at::Tensor& scales,
+    at::Tensor& zero_points,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor run(ContextLinearWoq& context, const at::Tensor& input);
+
+// Return the quantized uint8 weight of [out_features, in_features]
+at::Tensor unpack(ContextLinearWoq& context);
+
+// Return the dequantized fp32 weight of [out_features, in_features]
+at::Tensor dequantize(ContextLinearWoq& context);
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
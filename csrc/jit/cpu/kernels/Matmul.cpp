@@ -10,6 +10,7 @@
 #include <limits>
 
 #include <ideep.hpp>
+#include "aten/SmallBmm.h"
 #include "ideep/IDeepConversions.h"
 #include "mkl.h"
 
@@ -117,7 +118,8 @@ void mkl_fp32_bmm_impl(
  *
  * Since the MKL BMM kernel cannot fuse any post-OP, for the cases 1. FP32 BMM
  * with any DNNL-defined post-OP, 2. BF16 BMM, the DNNL MATMUL primitive is
- * applied. For FP32 BMM with mul/div, the MKL BMM kernel is applied.
+ * applied. For FP32 BMM with mul/div, the MKL BMM kernel is applied, or the
+ * small BMM kernel of libxsmm for a large batch of small matrices.
  **/
 at::Tensor bmm_impl(
     const at::Tensor& tensor1,
@@ -205,7 +207,11 @@ at::Tensor bmm_impl(
     auto tensor2_ =
         check_tensor_layout(tensor2) ? tensor2 : tensor2.contiguous();
 
-    mkl_fp32_bmm_impl(tensor1_, tensor2_, output, dst_coeff);
+    // many small matrices, e.g. 10k of 32x64x32, are multiplied one by one
+    // on the threads by a libxsmm micro-kernel
+    if (!small_bmm(tensor1_, tensor2_, output, dst_coeff)) {
+      mkl_fp32_bmm_impl(tensor1_, tensor2_, output, dst_coeff);
+    }
   }
 
   return output;
@@ -0,0 +1,94 @@
+#include "MemoryPlan.h"
+
+#include <ATen/ATen.h>
+#include <ATen/record_function.h>
+#include <c10/util/Exception.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// the arenas kept per thread, e.g. for the planned graphs of a model
+constexpr size_t kMaxArenasPerThread = 4;
+
+bool is_free(const at::Tensor& arena) {
+  return arena.use_count() == 1 && arena.storage().use_count() == 1;
+}
+
+} // namespace
+
+at::Tensor memory_arena(int64_t nbytes) {
+  RECORD_FUNCTION("ipex::memory_arena", c10::ArrayRef<c10::IValue>({}));
+  thread_local std::vector<at::Tensor> arenas;
+  for (auto& arena : arenas) {
+    if (arena.numel() == nbytes && is_free(arena)) {
+      return arena;
+    }
+  }
+  auto arena = at::empty({nbytes}, at::TensorOptions().dtype(at::kByte));
+  if (arenas.size() < kMaxArenasPerThread) {
+    arenas.push_back(arena);
+    return arena;
+  }
+  // replace a free arena of another size
+  for (auto& cached : arenas) {
+    if (is_free(cached)) {
+      cached = arena;
+      break;
+    }
+  }
+  return arena;
+}
+
+at::Tensor arena_slice(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype) {
+  auto element_size = static_cast<int64_t>(c10::elementSize(dtype));
+  TORCH_CHECK(
+      offset % element_size == 0,
+      "arena_slice: the offset must be aligned to the element size");
+  return at::empty({0}, arena.options().dtype(dtype))
+      .set_(arena.storage(), offset / element_size, sizes, strides);
+}
+
+at::Tensor cat_views(
+    const at::Tensor& buffer,
+    at::TensorList outputs,
+    int64_t dim) {
+  RECORD_FUNCTION("ipex::cat_views", c10::ArrayRef<c10::IValue>({}));
+  int64_t size = 0;
+  for (const auto& output : outputs) {
+    bool fits = output.dim() == buffer.dim() &&
+        output.scalar_type() == buffer.scalar_type();
+    for (int64_t d = 0; fits && d < buffer.dim(); d++) {
+      fits = d == dim || output.size(d) == buffer.size(d);
+    }
+    if (!fits) {
+      return at::cat(outputs, dim);
+    }
+    size += output.size(dim);
+  }
+  if (size != buffer.size(dim)) {
+    return at::cat(outputs, dim);
+  }
+
+  int64_t start = 0;
+  for (const auto& output : outputs) {
+    auto slice = buffer.narrow(dim, start, output.size(dim));
+    if (output.data_ptr() != slice.data_ptr() ||
+        output.strides() != slice.strides()) {
+      slice.copy_(output);
+    }
+    start += output.size(dim);
+  }
+  return buffer;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
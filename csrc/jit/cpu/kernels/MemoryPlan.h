@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The uint8 arena of nbytes of the buffers planned by PlanFrozenGraphMemory,
+// reusing the arena of a previous run of the calling thread once no tensor
+// references it
+at::Tensor memory_arena(int64_t nbytes);
+
+// The tensor of sizes, strides and dtype at the byte offset of arena
+at::Tensor arena_slice(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype);
+
+// The output of a cat planned by PlanCatOutputViews: buffer, once each of
+// outputs which was not written into its slice along dim is copied into it, or
+// the cat of outputs when they don't fill buffer, e.g. for another shape
+at::Tensor cat_views(
+    const at::Tensor& buffer,
+    at::TensorList outputs,
+    int64_t dim);
+
+} // namespace cpu
+} // namespace torch_ipex
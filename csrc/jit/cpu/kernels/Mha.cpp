@@ -250,22 +250,26 @@ at::Tensor dil_sd_flash_mha(
  *  This kernel implements Flast attention on stable-diffusion models (from
  * Diffusers 0.12.1 and 0.13) for BF16 dtype, where qkv is splited; Note that
  * in 0.13, aten::scaled_dot_product_attention uses the scale of sqrt(headSize)
- * if no scale is provided for query, where we are following
+ * if no scale is provided for query, where we are following. It also serves
+ * aten::scaled_dot_product_attention with is_causal=True (e.g. GPT prefill),
+ * where the key blocks above the diagonal are skipped.
  */
 at::Tensor dil_sd_flash_mha(
     const at::Tensor& query,
     const at::Tensor& key,
     const at::Tensor& value,
     const at::IValue& scale,
-    const int64_t& num_head) {
+    const int64_t& num_head,
+    const bool is_causal) {
   RECORD_FUNCTION("dil_sd_flash_mha_v2", c10::ArrayRef<c10::IValue>({}));
   int64_t headSize = query.size(-1) / num_head;
   if (!scale.isNone()) {
     return sd_flash_mha(
-        query, key, value, num_head, headSize, scale.toDouble());
+        query, key, value, num_head, headSize, scale.toDouble(), is_causal);
   } else {
     auto scale_ = 1.f / sqrt(headSize);
-    return sd_flash_mha(query, key, value, num_head, headSize, scale_);
+    return sd_flash_mha(
+        query, key, value, num_head, headSize, scale_, is_causal);
   }
 }
 
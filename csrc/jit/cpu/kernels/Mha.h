@@ -86,7 +86,8 @@ at::Tensor dil_sd_flash_mha(
     const at::Tensor& key,
     const at::Tensor& value,
     const at::IValue& scale,
-    const int64_t& num_head);
+    const int64_t& num_head,
+    const bool is_causal = false);
 
 template <typename T>
 std::vector<at::Tensor> dil_mat_split(
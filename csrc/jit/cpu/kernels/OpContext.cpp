@@ -2,8 +2,13 @@
 #include <torch/all.h>
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
+#include "LinearDynamicQuantPacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
+#include "LinearWoqPacked.h"
+#include "PackedWeightRegistry.h"
+#include "ideep/IDeepConversions.h"
+#include "utils/memory_tracker.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -13,6 +18,8 @@ void load_from_ctx_template(T1* self, c10::intrusive_ptr<T2> other) {
   auto& other_ctx_ = other->get_context();
   auto loaded_weight = other_ctx_.at_weight_;
   auto loaded_bias = other_ctx_.at_bias_;
+  // the packed weight no longer matches the weight it was registered for
+  detail::PackedWeightRegistry::get().release(self->get_context().at_weight_);
   self->get_context().at_weight_.copy_(loaded_weight);
   if (loaded_bias.has_value()) {
     self->get_context().at_bias_.value().copy_(loaded_bias.value());
@@ -32,6 +39,14 @@ void load_from_ctx_template<IpexLinearMKLOpContext, MKLOpContext>(
     self->get_context().at_bias_.value().copy_(loaded_bias.value());
   }
   self->get_context().ori_weight_.copy_(other->get_context().ori_weight_);
+  // the weights packed for the other M are packed again from the new weight
+  self->get_context().packed_variants_->clear();
+  // and the weight packed for oneDNN is packed again in place
+  auto& dnnl_weight = *self->get_context().dnnl_weight_;
+  if (dnnl_weight.at_weight.defined()) {
+    dnnl_weight.weight.feed_from(
+        itensor_view_from_dense(self->get_context().ori_weight_));
+  }
   return;
 }
 c10::intrusive_ptr<ConvolutionOpContext> IpexConvolutionOpContext::
@@ -45,6 +60,7 @@ c10::intrusive_ptr<ConvolutionOpContext> IpexConvolutionOpContext::
         bool weight_is_channels_last,
         std::vector<int64_t>&& input_size,
         const ideep::attr_t& attr) {
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::conv");
   auto op_context = torch_ipex::cpu::detail::convolution::create(
       weight,
       bias,
@@ -79,6 +95,60 @@ int64_t ConvolutionOpContext::get_groups() {
   return this->get_context().groups_;
 }
 
+void ConvolutionOpContext::warm_up(
+    std::vector<std::vector<int64_t>> input_sizes) {
+  torch_ipex::cpu::detail::convolution::warm_up(
+      this->get_context(), input_sizes);
+}
+
+void ConvolutionOpContext::set_primitive_cache_capacity(int64_t capacity) {
+  torch_ipex::cpu::detail::convolution::set_primitive_cache_capacity(
+      this->get_context(), capacity);
+}
+
+std::tuple<int64_t, int64_t, int64_t> ConvolutionOpContext::
+    get_primitive_cache_stats() {
+  return torch_ipex::cpu::detail::convolution::get_primitive_cache_stats(
+      this->get_context());
+}
+
+void ConvolutionOpContext::set_algorithm(std::string algorithm) {
+  detail::ConvAlgorithm algo;
+  if (algorithm == "direct") {
+    algo = detail::ConvAlgorithm::DIRECT;
+  } else if (algorithm == "winograd") {
+    algo = detail::ConvAlgorithm::WINOGRAD;
+  } else {
+    TORCH_CHECK(
+        algorithm == "auto",
+        "convolution algorithm should be direct, winograd or auto, but got ",
+        algorithm);
+    algo = detail::ConvAlgorithm::AUTO;
+  }
+  torch_ipex::cpu::detail::convolution::set_algorithm(
+      this->get_context(), algo);
+}
+
+std::string ConvolutionOpContext::get_algorithm() {
+  auto algo =
+      torch_ipex::cpu::detail::convolution::get_algorithm(this->get_context());
+  if (algo == detail::ConvAlgorithm::WINOGRAD) {
+    return "winograd";
+  }
+  return algo == detail::ConvAlgorithm::AUTO ? "auto" : "direct";
+}
+
+std::string ConvolutionOpContext::get_tuned_algorithm(
+    std::vector<int64_t> input_sizes) {
+  auto algo = torch_ipex::cpu::detail::convolution::get_tuned_algorithm(
+      this->get_context(), input_sizes);
+  if (!algo.has_value()) {
+    return "";
+  }
+  return algo.value() == detail::ConvAlgorithm::WINOGRAD ? "winograd"
+                                                         : "direct";
+}
+
 at::Tensor IpexConvolutionOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
@@ -128,12 +198,14 @@ at::Tensor IpexConvolutionOpContext::get_data_handle() {
 void IpexConvolutionOpContext::load_from_ctx(
     c10::intrusive_ptr<ConvolutionOpContext> other) {
   load_from_ctx_template(this, other);
+  torch_ipex::cpu::detail::convolution::update_direct_weight(op_context_);
 }
 
 c10::intrusive_ptr<LinearOpContext> IpexLinearOpContext::create_context(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
     c10::optional<int64_t> batch_size) {
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::linear");
   auto op_context =
       torch_ipex::cpu::detail::linear::create(weight, bias, batch_size);
   return c10::make_intrusive<IpexLinearOpContext>(
@@ -187,6 +259,7 @@ at::Tensor IpexLinearOpContext::to_public(const at::Tensor& tensor) {
 void IpexLinearOpContext::load_from_ctx(
     c10::intrusive_ptr<LinearOpContext> other) {
   load_from_ctx_template(this, other);
+  torch_ipex::cpu::detail::linear::update_sparse_weight(op_context_);
 }
 
 c10::intrusive_ptr<ConvTransposeOpContext> IpexConvTransposeOpContext::
@@ -200,6 +273,7 @@ c10::intrusive_ptr<ConvTransposeOpContext> IpexConvTransposeOpContext::
         int64_t groups,
         bool weight_is_channels_last,
         std::vector<int64_t>&& input_size) {
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::conv_transpose");
   auto op_context = torch_ipex::cpu::detail::conv_transpose::create(
       weight,
       bias,
@@ -223,6 +297,7 @@ c10::intrusive_ptr<MKLOpContext> IpexLinearMKLOpContext::create_context(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
     c10::optional<int64_t> batch_size) {
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::linear_mkl");
   auto op_context =
       torch_ipex::cpu::detail::mkl_sgemm::create(weight, bias, batch_size);
   return c10::make_intrusive<IpexLinearMKLOpContext>(
@@ -274,6 +349,77 @@ void IpexLinearMKLOpContext::load_from_ctx(
   load_from_ctx_template(this, other);
 }
 
+c10::intrusive_ptr<WoqLinearOpContext> IpexWoqLinearOpContext::create_context(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    at::Tensor&& zero_points,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  torch_ipex::utils::MemoryScope memory_scope("weight_pack::linear_woq");
+  auto op_context = torch_ipex::cpu::detail::woq_linear::create(
+      qweight, scales, zero_points, bias, bits, group_size);
+  return c10::make_intrusive<IpexWoqLinearOpContext>(std::move(op_context));
+}
+
+at::Tensor IpexWoqLinearOpContext::get_data_handle() {
+  at::Tensor ptr = at::empty(1, at::kLong);
+  ptr[0] = reinterpret_cast<int64_t>(this);
+  return ptr;
+}
+
+at::Tensor IpexWoqLinearOpContext::run(const at::Tensor& input) {
+  return torch_ipex::cpu::detail::woq_linear::run(op_context_, input);
+}
+
+at::Tensor IpexWoqLinearOpContext::get_quantized_weight() {
+  return torch_ipex::cpu::detail::woq_linear::unpack(op_context_);
+}
+
+at::Tensor IpexWoqLinearOpContext::to_public() {
+  return torch_ipex::cpu::detail::woq_linear::dequantize(op_context_);
+}
+
+detail::ContextLinearWoq& IpexWoqLinearOpContext::get_context() {
+  return op_context_;
+}
+
+c10::intrusive_ptr<DynamicQuantLinearOpContext>
+IpexDynamicQuantLinearOpContext::create_context(
+    at::Tensor&& qweight,
+    at::Tensor&& scales,
+    c10::optional<at::Tensor>&& bias) {
+  torch_ipex::utils::MemoryScope memory_scope(
+      "weight_pack::linear_dynamic_quant");
+  auto op_context = torch_ipex::cpu::detail::dynamic_quant_linear::create(
+      qweight, scales, bias);
+  return c10::make_intrusive<IpexDynamicQuantLinearOpContext>(
+      std::move(op_context));
+}
+
+at::Tensor IpexDynamicQuantLinearOpContext::get_data_handle() {
+  at::Tensor ptr = at::empty(1, at::kLong);
+  ptr[0] = reinterpret_cast<int64_t>(this);
+  return ptr;
+}
+
+at::Tensor IpexDynamicQuantLinearOpContext::run(const at::Tensor& input) {
+  return torch_ipex::cpu::detail::dynamic_quant_linear::run(op_context_, input);
+}
+
+at::Tensor IpexDynamicQuantLinearOpContext::get_quantized_weight() {
+  return torch_ipex::cpu::detail::dynamic_quant_linear::unpack(op_context_);
+}
+
+at::Tensor IpexDynamicQuantLinearOpContext::to_public() {
+  return torch_ipex::cpu::detail::dynamic_quant_linear::dequantize(op_context_);
+}
+
+detail::ContextLinearDynamicQuant& IpexDynamicQuantLinearOpContext::
+    get_context() {
+  return op_context_;
+}
+
 at::Tensor IpexConvTransposeOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
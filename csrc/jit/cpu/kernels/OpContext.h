@@ -8,7 +8,10 @@
 #include "ContextConvTranspose.h"
 #include "ContextConvolution.h"
 #include "ContextLinear.h"
+#include "ContextLinearDynamicQuant.h"
 #include "ContextLinearMKL.h"
+#include "ContextLinearWoq.h"
+#include "PackedWeightRegistry.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -33,11 +36,25 @@ class ConvolutionOpContext : public torch::jit::CustomClassHolder {
 
  public:
   SerializationTypeConvolutionPrePack unpack() {
-    auto orig_weight_ = this->to_public(this->get_at_packed_weight());
     auto orig_bias_ = this->get_context().at_bias_;
     auto groups_ = this->get_context().groups_;
     auto weight_is_channels_last_ =
         this->get_context().weight_is_channels_last_;
+    at::Tensor orig_weight_;
+    auto& registry = detail::PackedWeightRegistry::get();
+    if (registry.is_serialization_enabled()) {
+      auto dims = this->get_context().original_desc_.get_dims();
+      auto memory_format = at::MemoryFormat::Contiguous;
+      if (weight_is_channels_last_ && dims.size() == 4) {
+        memory_format = at::MemoryFormat::ChannelsLast;
+      } else if (weight_is_channels_last_ && dims.size() == 5) {
+        memory_format = at::MemoryFormat::ChannelsLast3d;
+      }
+      orig_weight_ =
+          registry.serialize(this->get_at_packed_weight(), dims, memory_format);
+    } else {
+      orig_weight_ = this->to_public(this->get_at_packed_weight());
+    }
     return std::make_tuple(
         orig_weight_,
         orig_bias_,
@@ -82,6 +99,23 @@ class ConvolutionOpContext : public torch::jit::CustomClassHolder {
 
   int64_t get_groups();
 
+  // Prepares the forward primitives of a list of expected input sizes
+  void warm_up(std::vector<std::vector<int64_t>> input_sizes);
+
+  void set_primitive_cache_capacity(int64_t capacity);
+
+  // (hits, misses, size) of the primitive cache of the context
+  std::tuple<int64_t, int64_t, int64_t> get_primitive_cache_stats();
+
+  // "direct", "winograd" or "auto", which times both on the first inference
+  // call of each input shape and keeps the faster one
+  void set_algorithm(std::string algorithm);
+
+  std::string get_algorithm();
+
+  // The algorithm chosen for the input sizes, "" if none is chosen yet
+  std::string get_tuned_algorithm(std::vector<int64_t> input_sizes);
+
   virtual detail::ContextConvolution& get_context() = 0;
 
   virtual at::Tensor get_data_handle() = 0;
@@ -163,7 +197,13 @@ class LinearOpContext : public torch::jit::CustomClassHolder {
 
  public:
   SerializationTypeLinearPrePack unpack() {
-    auto orig_weight_ = this->to_public(this->get_at_packed_weight());
+    auto& registry = detail::PackedWeightRegistry::get();
+    auto orig_weight_ = registry.is_serialization_enabled()
+        ? registry.serialize(
+              this->get_at_packed_weight(),
+              this->get_context().original_desc_.get_dims(),
+              at::MemoryFormat::Contiguous)
+        : this->to_public(this->get_at_packed_weight());
     auto orig_bias_ = this->get_context().at_bias_;
     return std::make_tuple(orig_weight_, orig_bias_, batch_size_);
   }
@@ -335,6 +375,124 @@ class IpexLinearMKLOpContext final : public MKLOpContext {
   virtual void load_from_ctx(c10::intrusive_ptr<MKLOpContext> other) override;
 };
 
+// weight-only quantized linear op
+using SerializationTypeWoqLinearPrePack = std::tuple<
+    at::Tensor,
+    at::Tensor,
+    at::Tensor,
+    c10::optional<at::Tensor>,
+    int64_t,
+    int64_t>;
+
+class WoqLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  // (quantized uint8 weight [out_features, in_features], scales, zero
+  // points, bias, bits, group_size)
+  SerializationTypeWoqLinearPrePack unpack() {
+    auto& context = this->get_context();
+    return std::make_tuple(
+        this->get_quantized_weight(),
+        context.scales_,
+        context.zero_points_,
+        context.at_bias_,
+        context.bits_,
+        context.group_size_);
+  }
+
+  virtual at::Tensor get_data_handle() = 0;
+
+  virtual at::Tensor run(const at::Tensor& input) = 0;
+
+  // Unpack the packed weight to the quantized [out_features, in_features]
+  // uint8 weight
+  virtual at::Tensor get_quantized_weight() = 0;
+
+  // Return the dequantized fp32 weight of [out_features, in_features]
+  virtual at::Tensor to_public() = 0;
+
+  virtual detail::ContextLinearWoq& get_context() = 0;
+};
+
+class IpexWoqLinearOpContext final : public WoqLinearOpContext {
+ private:
+  detail::ContextLinearWoq op_context_;
+
+ public:
+  IpexWoqLinearOpContext(detail::ContextLinearWoq&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual at::Tensor get_data_handle() override;
+
+  virtual at::Tensor run(const at::Tensor& input) override;
+
+  virtual at::Tensor get_quantized_weight() override;
+
+  virtual at::Tensor to_public() override;
+
+  virtual detail::ContextLinearWoq& get_context() override;
+
+  static c10::intrusive_ptr<WoqLinearOpContext> create_context(
+      at::Tensor&& qweight,
+      at::Tensor&& scales,
+      at::Tensor&& zero_points,
+      c10::optional<at::Tensor>&& bias,
+      int64_t bits,
+      int64_t group_size);
+};
+
+// dynamic quantized linear op
+using SerializationTypeDynamicQuantLinearPrePack =
+    std::tuple<at::Tensor, at::Tensor, c10::optional<at::Tensor>>;
+
+class DynamicQuantLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  // (quantized int8 weight [out_features, in_features], scales, bias)
+  SerializationTypeDynamicQuantLinearPrePack unpack() {
+    auto& context = this->get_context();
+    return std::make_tuple(
+        this->get_quantized_weight(), context.scales_, context.at_bias_);
+  }
+
+  virtual at::Tensor get_data_handle() = 0;
+
+  virtual at::Tensor run(const at::Tensor& input) = 0;
+
+  // Unpack the packed weight to the quantized [out_features, in_features]
+  // int8 weight
+  virtual at::Tensor get_quantized_weight() = 0;
+
+  // Return the dequantized fp32 weight of [out_features, in_features]
+  virtual at::Tensor to_public() = 0;
+
+  virtual detail::ContextLinearDynamicQuant& get_context() = 0;
+};
+
+class IpexDynamicQuantLinearOpContext final
+    : public DynamicQuantLinearOpContext {
+ private:
+  detail::ContextLinearDynamicQuant op_context_;
+
+ public:
+  IpexDynamicQuantLinearOpContext(
+      detail::ContextLinearDynamicQuant&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual at::Tensor get_data_handle() override;
+
+  virtual at::Tensor run(const at::Tensor& input) override;
+
+  virtual at::Tensor get_quantized_weight() override;
+
+  virtual at::Tensor to_public() override;
+
+  virtual detail::ContextLinearDynamicQuant& get_context() override;
+
+  static c10::intrusive_ptr<DynamicQuantLinearOpContext> create_context(
+      at::Tensor&& qweight,
+      at::Tensor&& scales,
+      c10::optional<at::Tensor>&& bias);
+};
+
 // deconv op
 using SerializationTypeConvTransposePrePack = std::tuple<
     at::Tensor,
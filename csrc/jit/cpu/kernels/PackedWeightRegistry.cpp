@@ -0,0 +1,226 @@
+#include "PackedWeightRegistry.h"
+#include <ATen/core/grad_mode.h>
+#include <algorithm>
+#include <cstring>
+#include "dyndisp/DispatchStub.h"
+#include "ideep/IDeepConversions.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+namespace {
+
+// The serialized packed weight is followed by a header of
+// kSerializedHeaderSize int64, aligned to its size:
+//   [magic, format version, ISA, oneDNN version, packed bytes, 0, 0, 0]
+constexpr int64_t kSerializedMagic = 0x4b43415058455049; // "IPEXPACK"
+constexpr int64_t kSerializedVersion = 1;
+constexpr int64_t kSerializedHeaderSize = 8;
+constexpr int64_t kSerializedHeaderBytes =
+    kSerializedHeaderSize * sizeof(int64_t);
+
+int64_t get_onednn_version() {
+  auto version = dnnl_version();
+  return version->major * 10000 + version->minor * 100 + version->patch;
+}
+
+} // anonymous namespace
+
+PackedWeightRegistry& PackedWeightRegistry::get() {
+  static PackedWeightRegistry registry;
+  return registry;
+}
+
+bool PackedWeightRegistry::is_sharable(const at::Tensor& weight) {
+  // inference tensors have no version counter to detect in-place updates
+  return enabled_ && !weight.is_inference() &&
+      !(weight.requires_grad() && at::GradMode::is_enabled());
+}
+
+void PackedWeightRegistry::remove_expired(std::vector<Entry>& entries) {
+  entries.erase(
+      std::remove_if(
+          entries.begin(),
+          entries.end(),
+          [](const Entry& entry) {
+            return entry.source.expired() || entry.packed.expired();
+          }),
+      entries.end());
+}
+
+at::Tensor PackedWeightRegistry::find_serialized(
+    const at::Tensor& weight,
+    const ideep::tensor::desc& packed_desc) {
+  const auto& storage = weight.storage();
+  if (!storage || weight.storage_offset() != 0 ||
+      storage.nbytes() < weight.nbytes() + kSerializedHeaderBytes) {
+    return at::Tensor();
+  }
+  int64_t header[kSerializedHeaderSize];
+  std::memcpy(
+      header,
+      static_cast<const char*>(storage.data()) + storage.nbytes() -
+          kSerializedHeaderBytes,
+      kSerializedHeaderBytes);
+  if (header[0] != kSerializedMagic) {
+    return at::Tensor();
+  }
+  auto isa = static_cast<CPUCapability>(header[2]);
+  TORCH_CHECK(
+      header[1] == kSerializedVersion && isa == get_cpu_capability() &&
+          header[3] == get_onednn_version() &&
+          header[4] == static_cast<int64_t>(packed_desc.get_size()),
+      "The packed weight was serialized for ISA ",
+      CPUCapabilityToString(isa),
+      " and oneDNN ",
+      header[3],
+      ", it cannot be loaded on ISA ",
+      CPUCapabilityToString(get_cpu_capability()),
+      " and oneDNN ",
+      get_onednn_version(),
+      ". Save the model with ipex._C._set_serialize_packed_weight(False).");
+  auto shape = empty_aten_tensor_from_desc(
+      packed_desc, weight.options().device(at::kMeta));
+  return at::empty({0}, weight.options())
+      .set_(storage, 0, shape.sizes(), shape.strides());
+}
+
+at::Tensor PackedWeightRegistry::serialize(
+    const at::Tensor& packed_weight,
+    at::IntArrayRef public_sizes,
+    at::MemoryFormat memory_format) {
+  TORCH_CHECK(packed_weight.is_contiguous());
+  int64_t packed_nbytes = packed_weight.nbytes();
+  int64_t header_offset = (packed_nbytes + kSerializedHeaderBytes - 1) /
+      kSerializedHeaderBytes * kSerializedHeaderBytes;
+  auto buffer = at::empty(
+      {(header_offset + kSerializedHeaderBytes) /
+       static_cast<int64_t>(packed_weight.element_size())},
+      packed_weight.options());
+  auto buffer_data = static_cast<char*>(buffer.data_ptr());
+  std::memcpy(buffer_data, packed_weight.data_ptr(), packed_nbytes);
+  int64_t header[kSerializedHeaderSize] = {
+      kSerializedMagic,
+      kSerializedVersion,
+      static_cast<int64_t>(get_cpu_capability()),
+      get_onednn_version(),
+      packed_nbytes};
+  std::memcpy(buffer_data + header_offset, header, kSerializedHeaderBytes);
+  // the public strides keep the memory format of the weight, which the
+  // contexts read back on load
+  auto strides = at::empty(
+                     public_sizes,
+                     buffer.options().device(at::kMeta).memory_format(
+                         memory_format))
+                     .strides();
+  return buffer.as_strided(public_sizes, strides);
+}
+
+at::Tensor PackedWeightRegistry::get_or_pack(
+    const at::Tensor& weight,
+    const ideep::tensor& w,
+    const ideep::tensor::desc& packed_desc) {
+  auto pack = [&]() {
+    auto packed_weight =
+        empty_aten_tensor_from_desc(packed_desc, weight.options());
+    ideep::tensor packed;
+    packed.init(packed_desc, packed_weight.data_ptr());
+    packed.feed_from(w);
+    return packed_weight;
+  };
+  auto serialized = find_serialized(weight, packed_desc);
+  if (serialized.defined()) {
+    return serialized;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_sharable(weight)) {
+    return pack();
+  }
+
+  auto source_version =
+      weight.unsafeGetTensorImpl()->version_counter().current_version();
+  auto isa = static_cast<int>(get_cpu_capability());
+  auto& entries = entries_[weight.data_ptr()];
+  remove_expired(entries);
+  for (auto& entry : entries) {
+    // the source storage is alive, so the data pointer was not reused
+    if (entry.source.lock().get() == weight.storage().unsafeGetStorageImpl() &&
+        entry.source_offset == weight.storage_offset() &&
+        entry.source_sizes == weight.sizes().vec() &&
+        entry.source_strides == weight.strides().vec() &&
+        entry.source_version == source_version &&
+        entry.packed_desc == packed_desc && entry.isa == isa) {
+      return at::Tensor(entry.packed.lock());
+    }
+  }
+
+  auto packed_weight = pack();
+  entries.push_back(Entry{
+      c10::weak_intrusive_ptr<c10::StorageImpl>(
+          weight.storage().getIntrusivePtr()),
+      weight.storage_offset(),
+      weight.sizes().vec(),
+      weight.strides().vec(),
+      source_version,
+      packed_desc,
+      isa,
+      c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>(
+          packed_weight.getIntrusivePtr())});
+  return packed_weight;
+}
+
+void PackedWeightRegistry::release(const at::Tensor& packed_weight) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& item : entries_) {
+    auto& entries = item.second;
+    entries.erase(
+        std::remove_if(
+            entries.begin(),
+            entries.end(),
+            [&](const Entry& entry) {
+              return entry.packed.lock().get() ==
+                  packed_weight.unsafeGetTensorImpl();
+            }),
+        entries.end());
+  }
+}
+
+int64_t PackedWeightRegistry::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t size = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    remove_expired(it->second);
+    if (it->second.empty()) {
+      it = entries_.erase(it);
+    } else {
+      size += it->second.size();
+      it++;
+    }
+  }
+  return size;
+}
+
+void PackedWeightRegistry::set_enabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = enabled;
+}
+
+bool PackedWeightRegistry::is_enabled() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return enabled_;
+}
+
+void PackedWeightRegistry::set_serialization_enabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  serialization_enabled_ = enabled;
+}
+
+bool PackedWeightRegistry::is_serialization_enabled() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return serialization_enabled_;
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/macros/Export.h>
+#include <c10/util/intrusive_ptr.h>
+
+#include <ideep.hpp>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// Process-wide store of the prepacked weights of the linear and convolution
+// op contexts. Contexts packing the same read-only source weight into the
+// same desc on the same ISA, e.g. the replicas of a model traced or optimized
+// several times in one process, share a single packed buffer instead of
+// holding one copy each.
+//
+// Entries hold weak references only, a packed weight is freed with the last
+// context using it. A weight that requires grad while grad mode is enabled
+// is never shared, since its packed copy gets updated by the optimizer.
+class TORCH_API PackedWeightRegistry {
+ public:
+  static PackedWeightRegistry& get();
+
+  // Returns the packed weight serialized in place of weight or registered for
+  // (weight, packed_desc), or packs the ideep view `w` of weight into a new
+  // buffer of packed_desc and registers it.
+  at::Tensor get_or_pack(
+      const at::Tensor& weight,
+      const ideep::tensor& w,
+      const ideep::tensor::desc& packed_desc);
+
+  // Drops the entry of a packed weight about to be written in place, so that
+  // later lookups pack the source weight again.
+  void release(const at::Tensor& packed_weight);
+
+  // Returns a weight of public_sizes whose storage holds the packed weight
+  // and the ISA / desc metadata instead of the public data. It takes the
+  // place of the public weight in the serialized state of the op contexts,
+  // so that get_or_pack uses the loaded buffer as is instead of repacking.
+  // Such a state can only be loaded by the same build on the same ISA.
+  at::Tensor serialize(
+      const at::Tensor& packed_weight,
+      at::IntArrayRef public_sizes,
+      at::MemoryFormat memory_format);
+
+  // Number of packed weights alive in the registry
+  int64_t size();
+
+  void set_enabled(bool enabled);
+  bool is_enabled();
+
+  // Whether the op contexts serialize their packed weight, off by default
+  void set_serialization_enabled(bool enabled);
+  bool is_serialization_enabled();
+
+ private:
+  struct Entry {
+    c10::weak_intrusive_ptr<c10::StorageImpl> source;
+    int64_t source_offset;
+    std::vector<int64_t> source_sizes;
+    std::vector<int64_t> source_strides;
+    uint32_t source_version;
+    ideep::tensor::desc packed_desc;
+    int isa;
+    c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl> packed;
+  };
+
+  PackedWeightRegistry() = default;
+
+  bool is_sharable(const at::Tensor& weight);
+  void remove_expired(std::vector<Entry>& entries);
+  // The packed weight stored by serialize, undefined for a public weight
+  at::Tensor find_serialized(
+      const at::Tensor& weight,
+      const ideep::tensor::desc& packed_desc);
+
+  std::mutex mutex_;
+  bool enabled_ = true;
+  bool serialization_enabled_ = false;
+  // keyed by the data of the source weight
+  std::unordered_map<const void*, std::vector<Entry>> entries_;
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
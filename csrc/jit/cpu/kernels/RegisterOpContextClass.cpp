@@ -3,16 +3,23 @@
 
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
+#include "LinearDynamicQuantPacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
+#include "LinearWoqPacked.h"
 #include "OpContext.h"
 
 namespace torch_ipex {
 namespace cpu {
 using detail::conv_transpose::createConvTransposePrePackOpContext;
 using detail::convolution::createConvolutionPrePackOpContext;
+using detail::dynamic_quant_linear::createDynamicQuantLinearPrePackOpContext;
+using detail::dynamic_quant_linear::
+    createDynamicQuantLinearPrePackOpContextQuantized;
 using detail::linear::createLinearPrePackOpContext;
 using detail::mkl_sgemm::createLinearMKLPrePackOpContext;
+using detail::woq_linear::createWoqLinearPrePackOpContext;
+using detail::woq_linear::createWoqLinearPrePackOpContextQuantized;
 
 TORCH_LIBRARY(ipex_prepack, m) {
   m.class_<ConvolutionOpContext>("ConvolutionOpContext")
@@ -43,7 +50,23 @@ TORCH_LIBRARY(ipex_prepack, m) {
           &torch_ipex::cpu::ConvolutionOpContext::get_data_handle)
       .def(
           "load_from_ctx",
-          &torch_ipex::cpu::ConvolutionOpContext::load_from_ctx);
+          &torch_ipex::cpu::ConvolutionOpContext::load_from_ctx)
+      .def("warm_up", &torch_ipex::cpu::ConvolutionOpContext::warm_up)
+      .def(
+          "set_primitive_cache_capacity",
+          &torch_ipex::cpu::ConvolutionOpContext::set_primitive_cache_capacity)
+      .def(
+          "get_primitive_cache_stats",
+          &torch_ipex::cpu::ConvolutionOpContext::get_primitive_cache_stats)
+      .def(
+          "set_algorithm",
+          &torch_ipex::cpu::ConvolutionOpContext::set_algorithm)
+      .def(
+          "get_algorithm",
+          &torch_ipex::cpu::ConvolutionOpContext::get_algorithm)
+      .def(
+          "get_tuned_algorithm",
+          &torch_ipex::cpu::ConvolutionOpContext::get_tuned_algorithm);
   m.class_<LinearOpContext>("LinearOpContext")
       .def_pickle(
           [](const c10::intrusive_ptr<LinearOpContext>& op_context)
@@ -82,6 +105,51 @@ TORCH_LIBRARY(ipex_prepack, m) {
       .def("to_public", &torch_ipex::cpu::MKLOpContext::to_public)
       .def("get_data_handle", &torch_ipex::cpu::MKLOpContext::get_data_handle)
       .def("load_from_ctx", &torch_ipex::cpu::MKLOpContext::load_from_ctx);
+  m.class_<WoqLinearOpContext>("WoqLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<WoqLinearOpContext>& op_context)
+              -> SerializationTypeWoqLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeWoqLinearPrePack state)
+              -> c10::intrusive_ptr<WoqLinearOpContext> { // __setstate__
+            return createWoqLinearPrePackOpContextQuantized(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)),
+                std::move(std::get<3>(state)),
+                std::move(std::get<4>(state)),
+                std::move(std::get<5>(state)));
+          })
+      .def(
+          "get_quantized_weight",
+          &torch_ipex::cpu::WoqLinearOpContext::get_quantized_weight)
+      .def("to_public", &torch_ipex::cpu::WoqLinearOpContext::to_public)
+      .def(
+          "get_data_handle",
+          &torch_ipex::cpu::WoqLinearOpContext::get_data_handle);
+  m.class_<DynamicQuantLinearOpContext>("DynamicQuantLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<DynamicQuantLinearOpContext>& op_context)
+              -> SerializationTypeDynamicQuantLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeDynamicQuantLinearPrePack state)
+              -> c10::intrusive_ptr<DynamicQuantLinearOpContext> {
+            // __setstate__
+            return createDynamicQuantLinearPrePackOpContextQuantized(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)));
+          })
+      .def(
+          "get_quantized_weight",
+          &torch_ipex::cpu::DynamicQuantLinearOpContext::get_quantized_weight)
+      .def(
+          "to_public", &torch_ipex::cpu::DynamicQuantLinearOpContext::to_public)
+      .def(
+          "get_data_handle",
+          &torch_ipex::cpu::DynamicQuantLinearOpContext::get_data_handle);
   m.class_<ConvTransposeOpContext>("ConvTransposeOpContext")
       .def_pickle(
           [](const c10::intrusive_ptr<ConvTransposeOpContext>& op_context)
@@ -123,6 +191,20 @@ TORCH_LIBRARY(ipex_prepack, m) {
   m.def(
       "mkl_sgemm_prepack(Tensor W, Tensor? B, int? batch_size) "
       "-> __torch__.torch.classes.ipex_prepack.MKLOpContext");
+  m.def(
+      "woq_linear_prepack(Tensor W, Tensor? B, int bits, int group_size) "
+      "-> __torch__.torch.classes.ipex_prepack.WoqLinearOpContext");
+  m.def(
+      "woq_linear_prepack_quantized(Tensor qweight, Tensor scales, "
+      "Tensor zero_points, Tensor? B, int bits, int group_size) "
+      "-> __torch__.torch.classes.ipex_prepack.WoqLinearOpContext");
+  m.def(
+      "dynamic_quant_linear_prepack(Tensor W, Tensor? B) "
+      "-> __torch__.torch.classes.ipex_prepack.DynamicQuantLinearOpContext");
+  m.def(
+      "dynamic_quant_linear_prepack_quantized(Tensor qweight, Tensor scales, "
+      "Tensor? B) "
+      "-> __torch__.torch.classes.ipex_prepack.DynamicQuantLinearOpContext");
   m.def(
       "conv_transpose_prepack(Tensor W, Tensor? B, int[] stride, "
       "int[] padding, int[] output_padding, int groups, int[] dilation, "
@@ -134,6 +216,16 @@ TORCH_LIBRARY_IMPL(ipex_prepack, CPU, m) {
   m.impl("convolution_prepack", TORCH_FN(createConvolutionPrePackOpContext));
   m.impl("linear_prepack", TORCH_FN(createLinearPrePackOpContext));
   m.impl("mkl_sgemm_prepack", TORCH_FN(createLinearMKLPrePackOpContext));
+  m.impl("woq_linear_prepack", TORCH_FN(createWoqLinearPrePackOpContext));
+  m.impl(
+      "woq_linear_prepack_quantized",
+      TORCH_FN(createWoqLinearPrePackOpContextQuantized));
+  m.impl(
+      "dynamic_quant_linear_prepack",
+      TORCH_FN(createDynamicQuantLinearPrePackOpContext));
+  m.impl(
+      "dynamic_quant_linear_prepack_quantized",
+      TORCH_FN(createDynamicQuantLinearPrePackOpContextQuantized));
   m.impl(
       "conv_transpose_prepack", TORCH_FN(createConvTransposePrePackOpContext));
 }
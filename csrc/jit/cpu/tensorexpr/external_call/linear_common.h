@@ -56,6 +56,7 @@ typedef enum _LinearFusedOp {
   kLinearAdd,
   kLinearHardsigmoid,
   kLinearAddRelu,
+  kLinearEltwiseChain,
 } LinearFusedOp;
 
 static ideep::attr_t empty_attr;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ideep.hpp>
+#include <ideep/utils.hpp>
+
+#include "csrc/jit/cpu/kernels/LinearPacked.h"
+#include "linear_common.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace cpu {
+namespace tensorexpr {
+
+template <>
+struct LoweringFuncTrait<LinearFusedOp::kLinearEltwiseChain>
+    : public LinearCommonOperations {
+  DECLARE_LINEAR_FUNC_AND_RES(eltwise_chain)
+
+  /**
+   * @note This operator fuses linear and a chain of pointwise ops, as a
+   * oneDNN post-op chain.
+   *
+   * Its schema is  "ipex_prepack::linear_eltwise_chain_run(
+   *  Tensor input,
+   *  int[] algorithms,
+   *  float[] alphas,
+   *  float[] betas,
+   *  __torch__.torch.classes.ipex_prepack.LinearOpContext W_prepack) ->
+   * Tensor"
+   *
+   */
+
+  static std::vector<pytnnc::BufHandle> get_input_buf(
+      const std::vector<pytnnc::ArgValue>& inputs) {
+    std::vector<pytnnc::BufHandle> res = {};
+    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(inputs.size() == 5);
+    // The order is:
+    //     0: activator tensor
+    //     1: algorithms
+    //     2: alphas
+    //     3: betas
+    //     4: linear op context
+    constexpr int input_idx = 0; // input tensor
+    constexpr int ctx_idx = 4; // Linear context
+    res.push_back(c10::get<pytnnc::BufHandle>(inputs[input_idx]));
+    res.push_back(c10::get<pytnnc::BufHandle>(inputs[ctx_idx]));
+    return res;
+  }
+
+  static std::vector<pytnnc::ExprHandle> get_extra_args(
+      const std::vector<pytnnc::ArgValue>& inputs) {
+    constexpr int algorithms_idx = 1;
+    constexpr int alphas_idx = 2;
+    constexpr int betas_idx = 3;
+    const auto& algorithms = c10::get<pytnnc::IntList>(inputs[algorithms_idx]);
+    const auto& alphas = c10::get<pytnnc::DoubleList>(inputs[alphas_idx]);
+    const auto& betas = c10::get<pytnnc::DoubleList>(inputs[betas_idx]);
+    // The post-op count, then the algorithm, alpha and beta of each post-op
+    std::vector<pytnnc::ExprHandle> extra_args;
+    extra_args.push_back(static_cast<double>(algorithms.size()));
+    for (size_t i = 0; i < algorithms.size(); i++) {
+      extra_args.push_back(static_cast<double>(algorithms[i]));
+      extra_args.push_back(alphas[i]);
+      extra_args.push_back(betas[i]);
+    }
+    return extra_args;
+  }
+
+  static ideep::attr_t get_attr(int64_t* extra_args) {
+    auto args = (double*)extra_args;
+    const int64_t post_ops_num = static_cast<int64_t>(args[0]);
+    std::vector<int64_t> algorithms;
+    std::vector<double> alphas;
+    std::vector<double> betas;
+    for (int64_t i = 0; i < post_ops_num; i++) {
+      algorithms.push_back(static_cast<int64_t>(args[1 + 3 * i]));
+      alphas.push_back(args[2 + 3 * i]);
+      betas.push_back(args[3 + 3 * i]);
+    }
+    return torch_ipex::cpu::detail::linear::eltwise_chain_attr(
+        algorithms, alphas, betas);
+  }
+};
+
+} // namespace tensorexpr
+} // namespace cpu
+} // namespace jit
+} // namespace torch_ipex
@@ -4,6 +4,7 @@
 #include "linear_add.h"
 #include "linear_add_relu.h"
 #include "linear_clamp.h"
+#include "linear_eltwise_chain.h"
 #include "linear_elu.h"
 #include "linear_exp.h"
 #include "linear_gelu.h"
@@ -49,6 +50,7 @@ using LeakyReluTrait = LoweringFuncTrait<LinearFusedOp::kLinearLeakyRelu>;
 using AddTrait = LoweringFuncTrait<LinearFusedOp::kLinearAdd>;
 using HardsigmoidTrait = LoweringFuncTrait<LinearFusedOp::kLinearHardsigmoid>;
 using AddReluTrait = LoweringFuncTrait<LinearFusedOp::kLinearAddRelu>;
+using EltwiseChainTrait = LoweringFuncTrait<LinearFusedOp::kLinearEltwiseChain>;
 
 #define REG_NNC_OPERATOR(schema, trait)     \
   static NNCOperatorRegister schema##trait( \
@@ -78,4 +80,5 @@ REG_NNC_OPERATOR(kLinearLeakyReluSchema, LeakyReluTrait);
 REG_NNC_OPERATOR(kLinearAddSchema, AddTrait);
 REG_NNC_OPERATOR(kLinearHardsigmoidSchema, HardsigmoidTrait);
 REG_NNC_OPERATOR(kLinearAddReluSchema, AddReluTrait);
+REG_NNC_OPERATOR(kLinearEltwiseChainSchema, EltwiseChainTrait);
 } // namespace
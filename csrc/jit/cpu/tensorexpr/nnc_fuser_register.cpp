@@ -33,7 +33,8 @@ void registerCustomOp2NncFuser() {
        kLinearSqrtSchema,  kLinearSquareSchema,    kLinearTanhSchema,
        kLinearSiluSchema,  kLinearLogSchema,       kLinearRoundSchema,
        kLinearClampSchema, kLinearEluSchema,       kLinearGeluSchema,
-       kLinearPowSchema,   kLinearLeakyReluSchema, kLinearHardsigmoidSchema});
+       kLinearPowSchema,   kLinearLeakyReluSchema, kLinearHardsigmoidSchema,
+       kLinearEltwiseChainSchema});
 }
 
 } // namespace tensorexpr
@@ -91,6 +91,8 @@ const char kLinearHardsigmoidSchema[] =
     "ipex_prepack::linear_hardsigmoid_run(Tensor input, __torch__.torch.classes.ipex_prepack.LinearOpContext W_prepack) -> Tensor";
 const char kLinearAddReluSchema[] =
     "ipex_prepack::linear_add_relu_run(Tensor input, Tensor(a!) accumu, *, Scalar? alpha, __torch__.torch.classes.ipex_prepack.LinearOpContext W_prepack) -> Tensor(a!)";
+const char kLinearEltwiseChainSchema[] =
+    "ipex_prepack::linear_eltwise_chain_run(Tensor input, int[] algorithms, float[] alphas, float[] betas, __torch__.torch.classes.ipex_prepack.LinearOpContext W_prepack) -> Tensor";
 } // namespace tensorexpr
 } // namespace cpu
 } // namespace jit
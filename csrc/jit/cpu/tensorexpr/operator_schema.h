@@ -48,6 +48,7 @@ extern const char kLinearLeakyReluSchema[];
 extern const char kLinearAddSchema[];
 extern const char kLinearHardsigmoidSchema[];
 extern const char kLinearAddReluSchema[];
+extern const char kLinearEltwiseChainSchema[];
 
 } // namespace tensorexpr
 } // namespace cpu
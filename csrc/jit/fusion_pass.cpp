@@ -1,12 +1,17 @@
 #include "fusion_pass.h"
 #include <string>
+#include "auto_opt_config.h"
 #include "codegen/onednn/interface.h"
 #include "cpu/kernels/Matmul.h"
+#include "passes/channels_last_propagation.h"
 #include "passes/concat_linear.h"
 #include "passes/frozen_conv_folding.h"
 #include "passes/frozen_linear_folding.h"
 #include "passes/graph_rewrite.h"
 #include "passes/graph_rewrite_helper.h"
+#include "passes/grouped_linear.h"
+#include "passes/linear_backend_selection.h"
+#include "passes/memory_planner.h"
 #include "passes/prepack_folding.h"
 #include "passes/remove_redundant_aliases.h"
 
@@ -49,6 +54,8 @@ void ApplyInplaceOptimization(std::shared_ptr<Graph>& graph) {
   graph_rewrite::replaceAtenOpsWithIpexInplaceOps(graph);
   // try to replace aten ops with aten in-place ops
   graph_rewrite::replaceOpsWithAtenInplaceOps(graph);
+  // try to write the outputs of ipex fused ops into their dead inputs
+  graph_rewrite::replaceIpexOpsWithInplaceOps(graph);
 }
 
 void ReplaceInplaceOpsWitOutplaceOps(std::shared_ptr<Graph>& graph) {
@@ -81,6 +88,7 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
 
   // ipex einsum
   graph_rewrite::FusedEinsumPost(graph);
+  graph_rewrite::ReplaceEinsumWithEinsumContract(graph);
 
   // Fuse the scores calculation(dim + matmul + (add)? + softmax) for
   // Multi-Head-Attention
@@ -98,6 +106,10 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   // weights are constant. Conv weights will be unpacked in this step.
   graph_rewrite::replaceFrozenIPEXConvWithAtenConv(graph);
 
+  // Fuse operators as shuffle, before the convolution folding folds the
+  // shuffles into the weights of the convs around them
+  graph_rewrite::FuseShuffle(graph);
+
   // convolution folding
   graph_rewrite::FrozenConvFolding(graph);
 
@@ -106,15 +118,23 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   GRAPH_DUMP("After FrozenConvFolding.Before insertPrePackedConvOp", graph);
   graph_rewrite::insertPrePackedConvOp(graph);
 
+  // upsample_nearest2d + convolution, before the post-ops are fused
+  GRAPH_DUMP(
+      "After insertPrePackedConvOp.Before fuseUpsampleNearestConv", graph);
+  graph_rewrite::fuseUpsampleNearestConv(graph);
+
   // convolution fusion
   GRAPH_DUMP(
-      "After insertPrePackedConvOp.Before fuseConvWithEltwiseAdd", graph);
+      "After fuseUpsampleNearestConv.Before fuseConvWithEltwiseAdd", graph);
   graph_rewrite::fuseConvWithEltwiseAdd(graph);
   GRAPH_DUMP("After fuseConvWithEltwiseAdd.Before fuseConvAddRelu", graph);
   graph_rewrite::fuseConvAddRelu(graph);
   GRAPH_DUMP("After fuseConvAddRelu.Before fuseBottleneck", graph);
   graph_rewrite::fuseBottleneck(graph);
-  GRAPH_DUMP("After fuseBottleneck.", graph);
+  GRAPH_DUMP("After fuseBottleneck.Before fuseGroupNormSiLU", graph);
+  // group_norm + silu, and the prepacked convolution consuming it
+  graph_rewrite::fuseGroupNormSiLU(graph);
+  GRAPH_DUMP("After fuseGroupNormSiLU.", graph);
 
   // TODO: Record original aten nodes, while convert aten linear-> ipex linear,
   // will ignore these aten linear (if they are fp32 dtype). For BF16 dtype,
@@ -128,13 +148,25 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   torch_ipex::jit::FrozenConcatLinear(
       graph, aten_linear_recorder.get_records());
   graph_rewrite::FrozenLinearFolding(graph);
+  // run the small independent linears in a single parallel region
+  if (AutoOptConfig::singleton().get_jit_grouped_linear()) {
+    torch_ipex::jit::FrozenGroupedLinear(
+        graph, aten_linear_recorder.get_records());
+  }
 
   // linear fusion
   GRAPH_DUMP("After FrozenLinearFolding.Before insertPrePackedLinearOp", graph);
+  // benchmark the backends of each linear on its shapes
+  std::unordered_set<Node*> mkl_sgemm_linear;
+  if (AutoOptConfig::singleton().get_jit_linear_backend_selection()) {
+    mkl_sgemm_linear = torch_ipex::jit::SelectLinearBackends(
+        graph, aten_linear_recorder.get_records());
+  }
   graph_rewrite::insertPrePackedLinearOp(
       graph,
       aten_linear_recorder.get_records(),
-      aten_linear_recorder.use_mkl());
+      aten_linear_recorder.use_mkl(),
+      mkl_sgemm_linear);
   GRAPH_DUMP(
       "After insertPrePackedLinearOp.Before fuseLinearWithEltwise", graph);
   graph_rewrite::fuseLinearWithEltwise(graph);
@@ -142,11 +174,22 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   graph_rewrite::fuseLinearAddRelu(graph);
   GRAPH_DUMP("After fuseLinearAddRelu.", graph);
   graph_rewrite::FuseLinearSwishCustomized(graph);
+  graph_rewrite::fuseLinearGate(graph);
+  GRAPH_DUMP("After fuseLinearGate.", graph);
+  if (AutoOptConfig::singleton().get_jit_eltwise_chain_fusion()) {
+    graph_rewrite::fuseLinearWithEltwiseChain(graph);
+    GRAPH_DUMP("After fuseLinearWithEltwiseChain.", graph);
+  }
 
   // fuse rmsnorm
   graph_rewrite::FuseRMSNorm(graph);
+  // fuse rotate-half rotary position embedding
+  graph_rewrite::FuseRotaryEmbedding(graph);
   // fuse add+layernorm
   graph_rewrite::FuseAddLayerNorm(graph);
+  // fuse rmsnorm and add+layernorm into the linear after them
+  graph_rewrite::fuseNormLinear(graph);
+  GRAPH_DUMP("After fuseNormLinear.", graph);
 
   // deconvolution fusion
   GRAPH_DUMP(
@@ -161,16 +204,21 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   graph_rewrite::fuseConvTransposeAdd(graph);
   GRAPH_DUMP("After fuseConvTransposeAdd.", graph);
 
-  // fuse concat+bn+relu for the input float tensors with the same sizes
-  // and channelslast format
-  // hence the concat dim should be the channel
-  graph_rewrite::FuseConcatBnRelu(graph);
+  // fuse concat+bn(+activation) for the input float or bfloat16 tensors of
+  // a same layout, along any dim
+  graph_rewrite::FuseConcatBnEltwise(graph);
+
+  // write the channels-last 2D pools (and their relus) feeding a channel cat
+  // straight into the cat output
+  graph_rewrite::FusePoolCat(graph);
+
+  // eltwise(a + b) * c of broadcast operands, e.g. the squeeze and excitation
+  // gates, in one pass
+  graph_rewrite::FuseAddEltwiseMul(graph);
 
   // replace aten max_pool2d with ipex max_pool2d
   graph_rewrite::replaceAtenMaxPool2dWithIpexMaxPool2d(graph);
 
-  // Fuse operators as shuffle
-  graph_rewrite::FuseShuffle(graph);
   graph_rewrite::FuseMatmulDivOrMul(graph);
   // replace aten softmax with ipex softmax
   graph_rewrite::replaceAtenSoftmaxWithIpexSoftmax(graph);
@@ -252,6 +300,10 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
       "After RemoveProfileNodesAndSpecializeTypes. Before LLGA fusion pass",
       graph);
 
+  // fold the SmoothQuant scales before LLGA partitions the int8 graph
+  graph_rewrite::FoldFrozenSmoothQuantScales(graph);
+  GRAPH_DUMP("After FoldFrozenSmoothQuantScales.", graph);
+
   if (isQuantized(graph) || fuser::onednn::is_llga_fp32_bf16_enabled()) {
     RemoveRedundantAliases(graph);
     fuser::onednn::fuseGraph(graph);
@@ -271,6 +323,12 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
   IPEXFusionPass(graph);
   GRAPH_DUMP(
       "After IPEXFusionPass. Before RemoveTensorTypeSpecializations", graph);
+  // The assignment needs the static shapes and the final ops, and the TE
+  // fuser then specializes on the assigned formats
+  if (AutoOptConfig::singleton().get_jit_channels_last_propagation()) {
+    PropagateChannelsLast(graph);
+    GRAPH_DUMP("After PropagateChannelsLast.", graph);
+  }
   // TODO: workaround here to go throughput the TE fuser pass before
   // RemoveTensorTypeSpecializations since TE fuser needs the type
   // specializations
@@ -292,6 +350,13 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
   // Note: Since TE is with priority and it has not supported inplace op yet,
   //       we make inplace optimization after TE.
   ApplyInplaceOptimization(graph);
+  // The planning needs the static shapes, and the final ops and aliases
+  if (AutoOptConfig::singleton().get_jit_cat_views()) {
+    PlanCatOutputViews(graph);
+  }
+  if (AutoOptConfig::singleton().get_jit_memory_plan()) {
+    PlanFrozenGraphMemory(graph);
+  }
   RemoveTensorTypeSpecializations(graph);
   GRAPH_DUMP(
       "After RemoveTensorTypeSpecializations. End of optimization pass", graph);
@@ -0,0 +1,399 @@
+#include "channels_last_propagation.h"
+#include <c10/core/MemoryFormat.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using namespace torch::jit;
+
+// The ops with a channels last kernel, their output in the format of their
+// first input (a channels first input runs a slower kernel or is reordered)
+bool prefersChannelsLast(Node* n) {
+  static const std::unordered_set<std::string> ops = {
+      "aten::conv2d",
+      "aten::_convolution",
+      "aten::max_pool2d",
+      "ipex::max_pool2d",
+      "aten::avg_pool2d",
+      "aten::adaptive_avg_pool2d",
+      "aten::adaptive_max_pool2d",
+      "aten::batch_norm",
+      "ipex::batch_norm",
+      "aten::group_norm",
+      "ipex::group_norm_silu",
+      "aten::upsample_nearest2d",
+      "aten::upsample_bilinear2d",
+      "torchvision::roi_align",
+      "ipex::concat_bn_eltwise",
+      "ipex::pool_cat",
+  };
+  std::string kind = n->kind().toQualString();
+  if (ops.count(kind)) {
+    return true;
+  }
+  // the prepacked convolutions and their fused post-ops
+  const std::string prefix = "ipex_prepack::convolution_";
+  const std::string suffix = "_run";
+  return kind.size() > prefix.size() + suffix.size() &&
+      kind.compare(0, prefix.size(), prefix) == 0 &&
+      kind.compare(kind.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// The pointwise ops, their output in the format of their first input
+bool isPointwise(Node* n) {
+  static const std::unordered_set<std::string> ops = {
+      "aten::relu",
+      "aten::relu_",
+      "aten::sigmoid",
+      "aten::sigmoid_",
+      "aten::tanh",
+      "aten::tanh_",
+      "aten::silu",
+      "aten::silu_",
+      "aten::gelu",
+      "aten::hardswish",
+      "aten::hardswish_",
+      "aten::hardsigmoid",
+      "aten::hardsigmoid_",
+      "aten::leaky_relu",
+      "aten::leaky_relu_",
+      "aten::hardtanh",
+      "aten::hardtanh_",
+      "aten::elu",
+      "aten::clamp",
+      "aten::add",
+      "aten::add_",
+      "aten::sub",
+      "aten::mul",
+      "aten::mul_",
+      "aten::div",
+      "aten::dropout",
+      "aten::cat",
+  };
+  return ops.count(n->kind().toQualString()) > 0;
+}
+
+std::vector<int64_t> contiguousStrides(at::IntArrayRef sizes) {
+  std::vector<int64_t> strides(sizes.size(), 1);
+  for (int64_t i = static_cast<int64_t>(sizes.size()) - 2; i >= 0; i--) {
+    strides[i] = strides[i + 1] * std::max<int64_t>(sizes[i + 1], 1);
+  }
+  return strides;
+}
+
+std::vector<int64_t> formatStrides(at::IntArrayRef sizes, bool channels_last) {
+  return channels_last ? c10::get_channels_last_strides_2d(sizes)
+                       : contiguousStrides(sizes);
+}
+
+// A minimum s-t cut (Dinic)
+class MinCut {
+ public:
+  explicit MinCut(size_t nodes) : edges_(nodes), level_(nodes), next_(nodes) {}
+
+  void addEdge(size_t from, size_t to, int64_t cap) {
+    if (cap <= 0) {
+      return;
+    }
+    edges_[from].push_back({to, edges_[to].size(), cap});
+    edges_[to].push_back({from, edges_[from].size() - 1, 0});
+  }
+
+  // the nodes on the side of s
+  std::vector<bool> run(size_t s, size_t t) {
+    while (bfs(s, t)) {
+      std::fill(next_.begin(), next_.end(), 0);
+      while (dfs(s, t, std::numeric_limits<int64_t>::max()) > 0) {
+      }
+    }
+    std::vector<bool> source_side(edges_.size());
+    for (size_t i = 0; i < edges_.size(); i++) {
+      source_side[i] = level_[i] >= 0;
+    }
+    return source_side;
+  }
+
+ private:
+  struct Edge {
+    size_t to;
+    size_t rev;
+    int64_t cap;
+  };
+
+  bool bfs(size_t s, size_t t) {
+    std::fill(level_.begin(), level_.end(), -1);
+    std::queue<size_t> queue;
+    level_[s] = 0;
+    queue.push(s);
+    while (!queue.empty()) {
+      auto u = queue.front();
+      queue.pop();
+      for (auto& e : edges_[u]) {
+        if (e.cap > 0 && level_[e.to] < 0) {
+          level_[e.to] = level_[u] + 1;
+          queue.push(e.to);
+        }
+      }
+    }
+    return level_[t] >= 0;
+  }
+
+  int64_t dfs(size_t u, size_t t, int64_t flow) {
+    if (u == t) {
+      return flow;
+    }
+    for (; next_[u] < edges_[u].size(); next_[u]++) {
+      auto& e = edges_[u][next_[u]];
+      if (e.cap <= 0 || level_[e.to] != level_[u] + 1) {
+        continue;
+      }
+      auto pushed = dfs(e.to, t, std::min(flow, e.cap));
+      if (pushed > 0) {
+        e.cap -= pushed;
+        edges_[e.to][e.rev].cap += pushed;
+        return pushed;
+      }
+    }
+    return 0;
+  }
+
+  std::vector<std::vector<Edge>> edges_;
+  std::vector<int64_t> level_;
+  std::vector<size_t> next_;
+};
+
+class ChannelsLastPropagation {
+ public:
+  explicit ChannelsLastPropagation(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  bool run() {
+    for (auto* input : graph_->inputs()) {
+      addVariable(input);
+    }
+    for (auto* node : graph_->block()->nodes()) {
+      for (auto* output : node->outputs()) {
+        addVariable(output);
+      }
+    }
+    if (values_.empty()) {
+      return false;
+    }
+    // source side: channels last, sink side: channels first
+    source_ = values_.size();
+    sink_ = values_.size() + 1;
+    MinCut cut(values_.size() + 2);
+    buildCosts(cut);
+    auto source_side = cut.run(source_, sink_);
+    channels_last_.assign(source_side.begin(), source_side.end() - 2);
+    return rewrite();
+  }
+
+ private:
+  // how the format a value is produced in is known
+  struct Producer {
+    // the value of the format of the first input of a channels last or
+    // pointwise op, -1 for the other producers
+    int64_t follows = -1;
+    // the format of the profiled strides, none when unknown or ambiguous
+    c10::optional<bool> profiled;
+  };
+
+  void addVariable(Value* v) {
+    auto type = v->type()->cast<TensorType>();
+    if (!type || v->node()->kind() == prim::Constant) {
+      return;
+    }
+    auto sizes = type->sizes().concrete_sizes();
+    if (!sizes.has_value() || sizes->size() != 4) {
+      return;
+    }
+    int64_t numel = 1;
+    for (auto size : *sizes) {
+      numel *= size;
+    }
+    auto element_size =
+        type->scalarType().has_value() ? c10::elementSize(*type->scalarType())
+                                       : 4;
+    Producer producer;
+    auto strides = type->strides().concrete_sizes();
+    if (strides.has_value()) {
+      bool is_channels_last = *strides == formatStrides(*sizes, true);
+      bool is_contiguous = *strides == formatStrides(*sizes, false);
+      if (is_channels_last != is_contiguous) {
+        producer.profiled = is_channels_last;
+      }
+    }
+    index_[v] = values_.size();
+    values_.push_back(v);
+    bytes_.push_back(numel * element_size);
+    producers_.push_back(producer);
+  }
+
+  int64_t variable(Value* v) {
+    auto it = index_.find(v);
+    return it == index_.end() ? -1 : static_cast<int64_t>(it->second);
+  }
+
+  // The 4D activations read by n, the tensors of its list inputs included
+  std::vector<int64_t> layoutInputs(Node* n) {
+    std::vector<int64_t> inputs;
+    for (auto* input : n->inputs()) {
+      if (input->node()->kind() == prim::ListConstruct) {
+        for (auto* element : input->node()->inputs()) {
+          if (variable(element) >= 0) {
+            inputs.push_back(variable(element));
+          }
+        }
+      } else if (variable(input) >= 0) {
+        inputs.push_back(variable(input));
+      }
+    }
+    return inputs;
+  }
+
+  // cost * (format of a != format of b)
+  void addPair(MinCut& cut, int64_t a, int64_t b, int64_t cost) {
+    cut.addEdge(a, b, cost);
+    cut.addEdge(b, a, cost);
+  }
+
+  // cost * (format of v != channels_last)
+  void addUnary(MinCut& cut, int64_t v, bool channels_last, int64_t cost) {
+    if (channels_last) {
+      cut.addEdge(source_, v, cost);
+    } else {
+      cut.addEdge(v, sink_, cost);
+    }
+  }
+
+  void buildCosts(MinCut& cut) {
+    for (auto* node : graph_->block()->nodes()) {
+      if (node->kind() == prim::ListConstruct) {
+        continue;
+      }
+      auto inputs = layoutInputs(node);
+      bool prefers = prefersChannelsLast(node);
+      bool follows = (prefers || isPointwise(node)) && !inputs.empty();
+      for (auto* output : node->outputs()) {
+        auto out = variable(output);
+        if (out < 0) {
+          continue;
+        }
+        if (follows) {
+          // the output is produced in the format of the first input, and
+          // reordered if assigned the other one
+          producers_[out].follows = inputs[0];
+          addPair(cut, inputs[0], out, bytes_[out]);
+          for (size_t i = 1; i < inputs.size() && !prefers; i++) {
+            // a pointwise op reads its other inputs in the output format
+            auto in_type = values_[inputs[i]]->type()->expect<TensorType>();
+            auto out_type = output->type()->expect<TensorType>();
+            if (in_type->sizes() == out_type->sizes()) {
+              addPair(cut, inputs[i], out, bytes_[inputs[i]]);
+            }
+          }
+        } else if (producers_[out].profiled.has_value()) {
+          addUnary(cut, out, *producers_[out].profiled, bytes_[out]);
+        }
+      }
+      if (prefers) {
+        for (auto in : inputs) {
+          addUnary(cut, in, true, bytes_[in]);
+        }
+      } else if (!follows && node->kind() != prim::Return) {
+        // the other ops want channels first inputs
+        for (auto in : inputs) {
+          addUnary(cut, in, false, bytes_[in]);
+        }
+      }
+    }
+    for (auto* input : graph_->inputs()) {
+      auto in = variable(input);
+      if (in >= 0 && producers_[in].profiled.has_value()) {
+        addUnary(cut, in, *producers_[in].profiled, bytes_[in]);
+      }
+    }
+  }
+
+  // The format the value is produced in, none when not known
+  c10::optional<bool> producedFormat(size_t v) {
+    if (producers_[v].follows >= 0) {
+      return channels_last_[producers_[v].follows];
+    }
+    return producers_[v].profiled;
+  }
+
+  TypePtr formatType(Value* v, bool channels_last) {
+    auto type = v->type()->expect<TensorType>();
+    auto sizes = *type->sizes().concrete_sizes();
+    return type->withSizesStrides(sizes, formatStrides(sizes, channels_last));
+  }
+
+  bool rewrite() {
+    size_t reorders = 0;
+    // the formats are computed before the uses are rewired
+    std::vector<c10::optional<bool>> produced;
+    for (size_t v = 0; v < values_.size(); v++) {
+      produced.push_back(producedFormat(v));
+    }
+    for (size_t v = 0; v < values_.size(); v++) {
+      auto* value = values_[v];
+      bool channels_last = channels_last_[v];
+      if (producers_[v].follows >= 0 && producers_[v].profiled != produced[v]) {
+        value->setType(formatType(value, *produced[v]));
+      }
+      if (!produced[v].has_value() || *produced[v] == channels_last) {
+        continue;
+      }
+      Node* insert_before = value->node()->kind() == prim::Param
+          ? graph_->block()->nodes().front()
+          : value->node()->next();
+      WithInsertPoint guard(insert_before);
+      auto* reorder = graph_->insertNode(graph_->create(
+          aten::contiguous,
+          {value,
+           graph_->insertConstant(
+               channels_last ? c10::MemoryFormat::ChannelsLast
+                             : c10::MemoryFormat::Contiguous)}));
+      reorder->output()->setType(formatType(value, channels_last));
+      value->replaceAllUsesWith(reorder->output());
+      reorder->replaceInput(0, value);
+      reorders++;
+    }
+    GRAPH_DEBUG(
+        "Assigned the formats of ",
+        values_.size(),
+        " activations with ",
+        reorders,
+        " reorders");
+    return reorders > 0;
+  }
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<Value*> values_;
+  std::unordered_map<Value*, size_t> index_;
+  std::vector<int64_t> bytes_;
+  std::vector<Producer> producers_;
+  std::vector<bool> channels_last_;
+  size_t source_ = 0;
+  size_t sink_ = 0;
+};
+
+} // namespace
+
+bool PropagateChannelsLast(std::shared_ptr<Graph>& graph) {
+  return ChannelsLastPropagation(graph).run();
+}
+
+} // namespace jit
+} // namespace torch_ipex
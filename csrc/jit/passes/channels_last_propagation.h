@@ -0,0 +1,18 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Assigns a memory format to the 4D activations of the top-level block of a
+// graph with static shapes, minimizing the reorders: the ops with a channels
+// last kernel (conv, pools, norms, ROIAlign, ConcatBnEltwise) want channels
+// last inputs, the pointwise ops take the format of their input, and the other
+// ops want channels first ones. The format minimizing the bytes reordered is
+// given by a minimum cut, and aten::contiguous reorders are inserted where
+// the format a value is produced in differs from the assigned one.
+TORCH_API bool PropagateChannelsLast(std::shared_ptr<torch::jit::Graph>& graph);
+
+} // namespace jit
+} // namespace torch_ipex
@@ -1,6 +1,13 @@
 #pragma once
 
 #include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 
 namespace torch_ipex {
 namespace jit {
@@ -61,5 +68,64 @@ inline at::Tensor resizeConstantScalarOrTensorToShape(
   return ret_tensor;
 }
 
+// The key of the constant values vs, none when one of them is not a constant
+// the key supports; the tensors are identified by their TensorImpl.
+// The instances of a repeated block which share their weights, as the
+// layers sharing their parameters or the tied weights, have equal keys, for
+// their folding to be computed once and replayed for the other instances.
+inline c10::optional<std::string> constantsKey(
+    at::ArrayRef<torch::jit::Value*> vs) {
+  std::string key;
+  for (auto v : vs) {
+    auto ival = torch::jit::toIValue(v);
+    if (!ival.has_value()) {
+      return c10::nullopt;
+    }
+    if (ival->isTensor()) {
+      key += "T" +
+          std::to_string(reinterpret_cast<uintptr_t>(
+              ival->toTensor().unsafeGetTensorImpl()));
+    } else if (ival->isDouble()) {
+      uint64_t bits;
+      double d = ival->toDouble();
+      std::memcpy(&bits, &d, sizeof(bits));
+      key += "D" + std::to_string(bits);
+    } else if (ival->isInt()) {
+      key += "I" + std::to_string(ival->toInt());
+    } else if (ival->isBool()) {
+      key += ival->toBool() ? "B1" : "B0";
+    } else if (ival->isNone()) {
+      key += "N";
+    } else if (ival->isString()) {
+      key += "S" + std::to_string(ival->toStringRef().size()) + ":" +
+          ival->toStringRef();
+    } else if (ival->isIntList()) {
+      key += "L";
+      for (auto i : ival->toIntVector()) {
+        key += std::to_string(i) + ",";
+      }
+    } else {
+      return c10::nullopt;
+    }
+    key += ";";
+  }
+  return key;
+}
+
+// The key of the folding of op into producer: the kinds and the constant
+// inputs of both, the first input of each excluded
+inline c10::optional<std::string> foldingKey(
+    torch::jit::Node* producer,
+    torch::jit::Node* op) {
+  auto producer_key = constantsKey(producer->inputs().slice(1));
+  auto op_key = constantsKey(op->inputs().slice(1));
+  if (!producer_key.has_value() || !op_key.has_value()) {
+    return c10::nullopt;
+  }
+  return std::string(producer->kind().toQualString()) + "|" +
+      std::string(op->kind().toQualString()) + "|" + *producer_key + "|" +
+      *op_key;
+}
+
 } // namespace jit
 } // namespace torch_ipex
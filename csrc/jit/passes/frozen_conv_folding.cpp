@@ -1,5 +1,6 @@
 #include <ATen/Functions.h>
 #include <ATen/Utils.h>
+#include <algorithm>
 #include <c10/core/ScalarType.h>
 #include <c10/util/Exception.h>
 #include <c10/util/accumulate.h>
@@ -36,6 +37,8 @@ bool supportedConvNode(Node* n) {
 
 bool FoldFrozenConvBatchnorm(Block* b) {
   bool graph_modified = false;
+  // the folded weight and bias by folding key
+  std::unordered_map<std::string, std::tuple<Tensor, Tensor>> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenConvBatchnorm(block);
@@ -94,7 +97,14 @@ bool FoldFrozenConvBatchnorm(Block* b) {
       params.bn_eps = bn_eps;
       params.bn_w = bn_w;
       params.bn_b = bn_b;
-      std::tuple<Tensor, Tensor> out = computeUpdatedConvWeightAndBias(params);
+      auto key = foldingKey(conv, bn);
+      auto found = key ? folded.find(*key) : folded.end();
+      std::tuple<Tensor, Tensor> out = found != folded.end()
+          ? found->second
+          : computeUpdatedConvWeightAndBias(params);
+      if (key) {
+        folded.emplace(*key, out);
+      }
       WithInsertPoint guard(conv);
       auto fused_conv_w = b->owningGraph()->insertConstant(std::get<0>(out));
       auto fused_conv_b = b->owningGraph()->insertConstant(std::get<1>(out));
@@ -179,8 +189,37 @@ bool checkConvAndBroadcastingOpPreConditions(Node* conv, Node* op) {
   return true;
 }
 
+// Runs add_or_sub on the bias of conv, returns the folded bias
+Tensor foldConvAddOrSub(
+    Node* conv,
+    Node* add_or_sub,
+    const Tensor& weight_tensor) {
+  Tensor add_or_sub_tensor;
+  add_or_sub_tensor = resizeConstantScalarOrTensorToShape(
+      add_or_sub->inputs().at(1),
+      {weight_tensor.size(0)},
+      weight_tensor.options());
+  Tensor bias;
+  if (conv->namedInput("bias")->type() == NoneType::get()) {
+    bias = at::zeros_like(add_or_sub_tensor, weight_tensor.dtype());
+  } else {
+    bias = constant_as<Tensor>(conv->namedInput("bias")).value();
+  }
+
+  add_or_sub->replaceInputWith(
+      conv->output(), add_or_sub->owningGraph()->insertConstant(bias));
+  add_or_sub->replaceInput(
+      1, add_or_sub->owningGraph()->insertConstant(add_or_sub_tensor));
+
+  auto stack_out = runNodeIfInputsAreConstant(add_or_sub);
+  TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
+  return (*stack_out)[0].toTensor().to(bias.dtype());
+}
+
 bool FoldFrozenConvAddOrSub(Block* b) {
   bool graph_modified = false;
+  // the folded bias by folding key
+  std::unordered_map<std::string, Tensor> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenConvAddOrSub(block);
@@ -197,29 +236,18 @@ bool FoldFrozenConvAddOrSub(Block* b) {
       Tensor weight_tensor =
           constant_as<Tensor>(conv->namedInput("weight")).value();
 
-      Tensor add_or_sub_tensor;
-      add_or_sub_tensor = resizeConstantScalarOrTensorToShape(
-          add_or_sub->inputs().at(1),
-          {weight_tensor.size(0)},
-          weight_tensor.options());
-      Tensor bias;
-      if (conv->namedInput("bias")->type() == NoneType::get()) {
-        bias = at::zeros_like(add_or_sub_tensor, weight_tensor.dtype());
+      auto key = foldingKey(conv, add_or_sub);
+      auto found = key ? folded.find(*key) : folded.end();
+      WithInsertPoint guard(conv);
+      Tensor fuse_bias;
+      if (found != folded.end()) {
+        fuse_bias = found->second;
       } else {
-        bias = constant_as<Tensor>(conv->namedInput("bias")).value();
+        fuse_bias = foldConvAddOrSub(conv, add_or_sub, weight_tensor);
+        if (key) {
+          folded.emplace(*key, fuse_bias);
+        }
       }
-
-      WithInsertPoint guard(conv);
-
-      add_or_sub->replaceInputWith(
-          conv->output(), b->owningGraph()->insertConstant(bias));
-      add_or_sub->replaceInput(
-          1, b->owningGraph()->insertConstant(add_or_sub_tensor));
-
-      auto stack_out = runNodeIfInputsAreConstant(add_or_sub);
-      TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
-      Tensor fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
-
       auto fused_conv_b = b->owningGraph()->insertConstant(fuse_bias);
       auto conv_b_value = conv->namedInput("bias");
 
@@ -237,6 +265,8 @@ bool FoldFrozenConvAddOrSub(Block* b) {
 
 bool FoldFrozenConvMulOrDiv(Block* b) {
   bool graph_modified = false;
+  // the folded weight and bias by folding key
+  std::unordered_map<std::string, std::tuple<Tensor, Tensor>> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenConvMulOrDiv(block);
@@ -250,6 +280,27 @@ bool FoldFrozenConvMulOrDiv(Block* b) {
         continue;
       }
 
+      auto key = foldingKey(conv, mul_or_div);
+      auto found = key ? folded.find(*key) : folded.end();
+      if (found != folded.end()) {
+        WithInsertPoint guard(conv);
+        auto graph = b->owningGraph();
+        auto conv_weight_value = conv->namedInput("weight");
+        auto fused_weight = graph->insertConstant(std::get<0>(found->second));
+        fused_weight->setDebugName(
+            conv_weight_value->debugName() + "_fused_" +
+            mul_or_div->kind().toUnqualString());
+        conv->replaceInputWith(conv_weight_value, fused_weight);
+        if (std::get<1>(found->second).defined()) {
+          conv->replaceInputWith(
+              conv->namedInput("bias"),
+              graph->insertConstant(std::get<1>(found->second)));
+        }
+        mul_or_div->output()->replaceAllUsesWith(conv->output());
+        graph_modified = true;
+        continue;
+      }
+
       Tensor weight_tensor;
       weight_tensor = constant_as<Tensor>(conv->namedInput("weight")).value();
 
@@ -292,6 +343,7 @@ bool FoldFrozenConvMulOrDiv(Block* b) {
       mul_or_div->output()->replaceAllUsesWith(conv->output());
 
       // now fold with bias tensor
+      Tensor fuse_bias;
       if (conv->namedInput("bias")->type() != NoneType::get()) {
         Tensor bias = constant_as<Tensor>(conv->namedInput("bias")).value();
         // bias is of shape {channels_out}
@@ -304,7 +356,7 @@ bool FoldFrozenConvMulOrDiv(Block* b) {
 
         auto stack_out = runNodeIfInputsAreConstant(mul_or_div);
         TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
-        Tensor fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
+        fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
 
         auto fused_conv_bias = b->owningGraph()->insertConstant(fuse_bias);
         auto conv_b_value = conv->namedInput("bias");
@@ -314,6 +366,9 @@ bool FoldFrozenConvMulOrDiv(Block* b) {
             mul_or_div->kind().toUnqualString());
         conv->replaceInputWith(conv_b_value, fused_conv_bias);
       }
+      if (key) {
+        folded.emplace(*key, std::make_tuple(fuse_weight, fuse_bias));
+      }
       graph_modified = true;
       // DCE run after cleans up nodes
     }
@@ -321,6 +376,148 @@ bool FoldFrozenConvMulOrDiv(Block* b) {
   return graph_modified;
 }
 
+// The groups of an ipex::shuffle_2d of the channels of a 4d tensor, whose
+// output channel j * groups + i is the input channel i * (C / groups) + j, or
+// nullopt if the shuffle is of other dims or its groups are not constant
+c10::optional<int64_t> channelShuffleGroups(Node* shuffle) {
+  auto dim0 = constant_as<int64_t>(shuffle->input(2));
+  auto dim1 = constant_as<int64_t>(shuffle->input(3));
+  if (!dim0.has_value() || !dim1.has_value() ||
+      std::min(*dim0, *dim1) != 1 || std::max(*dim0, *dim1) != 2) {
+    return c10::nullopt;
+  }
+  // the view shape [n, groups, c // groups, h, w] is constant, or built from
+  // the sizes of the input and constant groups
+  Value* view_shape = shuffle->input(1);
+  if (auto shape = toIValue(view_shape)) {
+    auto shape_list = shape->toIntVector();
+    if (shape_list.size() == 5) {
+      return shape_list[1];
+    }
+  } else if (view_shape->node()->kind() == prim::ListConstruct) {
+    auto list = view_shape->node();
+    if (list->inputs().size() == 5) {
+      return constant_as<int64_t>(list->input(1));
+    }
+  }
+  return c10::nullopt;
+}
+
+// The input channel of each output channel of a channel shuffle
+Tensor channelShufflePermutation(int64_t channels, int64_t groups) {
+  return at::arange(channels).view({groups, channels / groups}).t().reshape(
+      {-1});
+}
+
+// A conv2d of constant parameters and a single group, whose weight channels
+// can be permuted freely
+bool supportedShuffleConvNode(Node* n) {
+  if (n->kind() != aten::conv2d || nonConstantParameters(n)) {
+    return false;
+  }
+  auto groups = constant_as<int64_t>(n->namedInput("groups"));
+  auto weight = constant_as<Tensor>(n->namedInput("weight"));
+  return groups.has_value() && *groups == 1 && weight.has_value() &&
+      weight->dim() == 4;
+}
+
+// The elementwise ops between a conv and a channel shuffle, which are
+// indifferent to the order of the channels
+bool supportedShuffleEltwiseNode(Node* n) {
+  return n->kind() == aten::relu || n->kind() == aten::hardtanh ||
+      n->kind() == aten::sigmoid || n->kind() == aten::silu ||
+      n->kind() == aten::gelu;
+}
+
+// Folds the channel shuffles of ShuffleNet into the constant weights of the
+// convs around them, so that no standalone shuffle pass over the activation
+// remains: shuffle(conv(x, W, b)), possibly through an elementwise op, is
+// conv(x, W[perm], b[perm]) with the output channels of the conv permuted, and
+// conv(shuffle(x), W) is conv(x, W') with W'[:, perm] = W, the input channels
+// of the conv permuted, when every use of the shuffle is such a conv.
+bool FoldFrozenConvShuffle(Block* b) {
+  bool graph_modified = false;
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      graph_modified |= FoldFrozenConvShuffle(block);
+    }
+
+    if (n->kind() != Symbol::fromQualString("ipex::shuffle_2d")) {
+      continue;
+    }
+    auto groups = channelShuffleGroups(n);
+    if (!groups.has_value() || *groups <= 0) {
+      continue;
+    }
+    Value* input = n->input(0);
+
+    // the producer conv writes its output channels shuffled
+    Node* producer = input->node();
+    Node* eltwise = nullptr;
+    if (supportedShuffleEltwiseNode(producer) && input->uses().size() == 1) {
+      eltwise = producer;
+      producer = eltwise->input(0)->node();
+    }
+    if (supportedShuffleConvNode(producer) &&
+        producer->output()->uses().size() == 1) {
+      auto weight = constant_as<Tensor>(producer->namedInput("weight")).value();
+      const int64_t channels = weight.size(0);
+      if (channels % *groups == 0) {
+        auto perm = channelShufflePermutation(channels, *groups);
+        WithInsertPoint guard(producer);
+        auto weight_value = producer->namedInput("weight");
+        auto shuffled_weight = b->owningGraph()->insertConstant(
+            weight.index_select(0, perm).contiguous());
+        shuffled_weight->setDebugName(
+            weight_value->debugName() + "_fused_shuffle");
+        producer->replaceInputWith(weight_value, shuffled_weight);
+        auto bias_value = producer->namedInput("bias");
+        if (bias_value->type() != NoneType::get()) {
+          auto bias = constant_as<Tensor>(bias_value).value();
+          producer->replaceInputWith(
+              bias_value,
+              b->owningGraph()->insertConstant(bias.index_select(0, perm)));
+        }
+        n->output()->replaceAllUsesWith(input);
+        graph_modified = true;
+        // DCE run after cleans up the shuffle
+        continue;
+      }
+    }
+
+    // the consumer convs read their input channels shuffled
+    auto uses = n->output()->uses();
+    bool foldable = !uses.empty();
+    for (const auto& use : uses) {
+      if (use.offset != 0 || !supportedShuffleConvNode(use.user)) {
+        foldable = false;
+        break;
+      }
+      auto weight = constant_as<Tensor>(use.user->namedInput("weight"));
+      foldable = foldable && weight->size(1) % *groups == 0;
+    }
+    if (!foldable) {
+      continue;
+    }
+    for (const auto& use : uses) {
+      Node* conv = use.user;
+      auto weight = constant_as<Tensor>(conv->namedInput("weight")).value();
+      auto perm = channelShufflePermutation(weight.size(1), *groups);
+      WithInsertPoint guard(conv);
+      auto weight_value = conv->namedInput("weight");
+      auto shuffled_weight = b->owningGraph()->insertConstant(
+          at::empty_like(weight, at::MemoryFormat::Contiguous)
+              .index_copy_(1, perm, weight));
+      shuffled_weight->setDebugName(
+          weight_value->debugName() + "_fused_shuffle");
+      conv->replaceInputWith(weight_value, shuffled_weight);
+      conv->replaceInput(0, input);
+    }
+    graph_modified = true;
+  }
+  return graph_modified;
+}
+
 bool FoldFrozenConvBatchnorm(std::shared_ptr<Graph>& graph) {
   bool graph_modified = FoldFrozenConvBatchnorm(graph->block());
   EliminateDeadCode(graph);
@@ -339,6 +536,12 @@ bool FoldFrozenConvMulOrDiv(std::shared_ptr<Graph>& graph) {
   return graph_modified;
 }
 
+bool FoldFrozenConvShuffle(std::shared_ptr<Graph>& graph) {
+  bool graph_modified = FoldFrozenConvShuffle(graph->block());
+  EliminateDeadCode(graph);
+  return graph_modified;
+}
+
 void FrozenConvFolding(std::shared_ptr<Graph>& graph) {
   // run a couple times to capture Conv -> Mul -> Add etc
   bool changed;
@@ -347,6 +550,7 @@ void FrozenConvFolding(std::shared_ptr<Graph>& graph) {
     changed |= FoldFrozenConvBatchnorm(graph);
     changed |= FoldFrozenConvAddOrSub(graph);
     changed |= FoldFrozenConvMulOrDiv(graph);
+    changed |= FoldFrozenConvShuffle(graph);
   } while (changed);
 }
 
@@ -21,6 +21,11 @@ bool FoldFrozenConvAddOrSub(std::shared_ptr<torch::jit::Graph>& graph);
 // This pass only works on Frozen Graphs; otherwise it is a No-Op.
 bool FoldFrozenConvMulOrDiv(std::shared_ptr<torch::jit::Graph>& graph);
 
+// Folds the channel shuffles (ipex::shuffle_2d) produced or consumed by
+// single group convolutions into the order of the conv weight channels.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+bool FoldFrozenConvShuffle(std::shared_ptr<torch::jit::Graph>& graph);
+
 // Call FoldFrozenConvAddOrSub and FoldFrozenConvMulOrDiv multiple times
 void FrozenConvFolding(std::shared_ptr<torch::jit::Graph>& graph);
 
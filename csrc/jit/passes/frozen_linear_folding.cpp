@@ -88,6 +88,8 @@ std::tuple<at::Tensor, at::Tensor> computeUpdatedLinearWeightAndBias(
 
 bool FoldFrozenLinearBatchnorm(Block* b) {
   bool graph_modified = false;
+  // the folded weight and bias by folding key
+  std::unordered_map<std::string, std::tuple<Tensor, Tensor>> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenLinearBatchnorm(block);
@@ -144,8 +146,14 @@ bool FoldFrozenLinearBatchnorm(Block* b) {
       params.bn_eps = bn_eps;
       params.bn_w = bn_w;
       params.bn_b = bn_b;
-      std::tuple<Tensor, Tensor> out =
-          computeUpdatedLinearWeightAndBias(params);
+      auto key = foldingKey(linear, bn);
+      auto found = key ? folded.find(*key) : folded.end();
+      std::tuple<Tensor, Tensor> out = found != folded.end()
+          ? found->second
+          : computeUpdatedLinearWeightAndBias(params);
+      if (key) {
+        folded.emplace(*key, out);
+      }
       WithInsertPoint guard(linear);
       auto fused_linear_w = b->owningGraph()->insertConstant(std::get<0>(out));
       auto fused_linear_b = b->owningGraph()->insertConstant(std::get<1>(out));
@@ -165,8 +173,37 @@ bool FoldFrozenLinearBatchnorm(Block* b) {
   return graph_modified;
 }
 
+// Runs add_or_sub on the bias of linear, returns the folded bias
+Tensor foldLinearAddOrSub(
+    Node* linear,
+    Node* add_or_sub,
+    const Tensor& weight_tensor) {
+  Tensor add_or_sub_tensor;
+  add_or_sub_tensor = resizeConstantScalarOrTensorToShape(
+      add_or_sub->inputs().at(1),
+      {weight_tensor.size(0)},
+      weight_tensor.options());
+  Tensor bias;
+  if (linear->namedInput("bias")->type() == NoneType::get()) {
+    bias = at::zeros_like(add_or_sub_tensor, weight_tensor.dtype());
+  } else {
+    bias = constant_as<Tensor>(linear->namedInput("bias")).value();
+  }
+
+  add_or_sub->replaceInputWith(
+      linear->output(), add_or_sub->owningGraph()->insertConstant(bias));
+  add_or_sub->replaceInput(
+      1, add_or_sub->owningGraph()->insertConstant(add_or_sub_tensor));
+
+  auto stack_out = runNodeIfInputsAreConstant(add_or_sub);
+  TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
+  return (*stack_out)[0].toTensor().to(bias.dtype());
+}
+
 bool FoldFrozenLinearAddOrSub(Block* b) {
   bool graph_modified = false;
+  // the folded bias by folding key
+  std::unordered_map<std::string, Tensor> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenLinearAddOrSub(block);
@@ -184,28 +221,18 @@ bool FoldFrozenLinearAddOrSub(Block* b) {
       Tensor weight_tensor =
           constant_as<Tensor>(linear->namedInput("weight")).value();
 
-      Tensor add_or_sub_tensor;
-      add_or_sub_tensor = resizeConstantScalarOrTensorToShape(
-          add_or_sub->inputs().at(1),
-          {weight_tensor.size(0)},
-          weight_tensor.options());
-      Tensor bias;
-      if (linear->namedInput("bias")->type() == NoneType::get()) {
-        bias = at::zeros_like(add_or_sub_tensor, weight_tensor.dtype());
+      auto key = foldingKey(linear, add_or_sub);
+      auto found = key ? folded.find(*key) : folded.end();
+      WithInsertPoint guard(linear);
+      Tensor fuse_bias;
+      if (found != folded.end()) {
+        fuse_bias = found->second;
       } else {
-        bias = constant_as<Tensor>(linear->namedInput("bias")).value();
+        fuse_bias = foldLinearAddOrSub(linear, add_or_sub, weight_tensor);
+        if (key) {
+          folded.emplace(*key, fuse_bias);
+        }
       }
-
-      WithInsertPoint guard(linear);
-
-      add_or_sub->replaceInputWith(
-          linear->output(), b->owningGraph()->insertConstant(bias));
-      add_or_sub->replaceInput(
-          1, b->owningGraph()->insertConstant(add_or_sub_tensor));
-
-      auto stack_out = runNodeIfInputsAreConstant(add_or_sub);
-      TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
-      Tensor fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
       auto fused_linear_b = b->owningGraph()->insertConstant(fuse_bias);
       auto linear_b_value = linear->namedInput("bias");
 
@@ -223,6 +250,8 @@ bool FoldFrozenLinearAddOrSub(Block* b) {
 
 bool FoldFrozenLinearMulOrDiv(Block* b) {
   bool graph_modified = false;
+  // the folded weight and bias by folding key
+  std::unordered_map<std::string, std::tuple<Tensor, Tensor>> folded;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       graph_modified |= FoldFrozenLinearMulOrDiv(block);
@@ -237,6 +266,27 @@ bool FoldFrozenLinearMulOrDiv(Block* b) {
         continue;
       }
 
+      auto key = foldingKey(linear, mul_or_div);
+      auto found = key ? folded.find(*key) : folded.end();
+      if (found != folded.end()) {
+        WithInsertPoint guard(linear);
+        auto graph = b->owningGraph();
+        auto linear_weight_value = linear->namedInput("weight");
+        auto fused_weight = graph->insertConstant(std::get<0>(found->second));
+        fused_weight->setDebugName(
+            linear_weight_value->debugName() + "_fused_" +
+            mul_or_div->kind().toUnqualString());
+        linear->replaceInputWith(linear_weight_value, fused_weight);
+        if (std::get<1>(found->second).defined()) {
+          linear->replaceInputWith(
+              linear->namedInput("bias"),
+              graph->insertConstant(std::get<1>(found->second)));
+        }
+        mul_or_div->output()->replaceAllUsesWith(linear->output());
+        graph_modified = true;
+        continue;
+      }
+
       c10::intrusive_ptr<LinearOpContext> linear_op_ctx;
 
       Tensor weight_tensor;
@@ -280,6 +330,7 @@ bool FoldFrozenLinearMulOrDiv(Block* b) {
       mul_or_div->output()->replaceAllUsesWith(linear->output());
 
       // now fold with bias tensor
+      Tensor fuse_bias;
       if (linear->namedInput("bias")->type() != NoneType::get()) {
         Tensor bias = constant_as<Tensor>(linear->namedInput("bias")).value();
         // bias is of shape {channels_out}
@@ -292,11 +343,14 @@ bool FoldFrozenLinearMulOrDiv(Block* b) {
 
         auto stack_out = runNodeIfInputsAreConstant(mul_or_div);
         TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
-        Tensor fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
+        fuse_bias = (*stack_out)[0].toTensor().to(bias.dtype());
         auto fused_linear_bias = b->owningGraph()->insertConstant(fuse_bias);
         auto linear_b_value = linear->namedInput("bias");
         linear->replaceInputWith(linear_b_value, fused_linear_bias);
       }
+      if (key) {
+        folded.emplace(*key, std::make_tuple(fuse_weight, fuse_bias));
+      }
       graph_modified = true;
       // DCE run after cleans up nodes
     }
@@ -304,6 +358,148 @@ bool FoldFrozenLinearMulOrDiv(Block* b) {
   return graph_modified;
 }
 
+// The per channel scale of a constant mul of v by a vector of channels, of
+// [channels] or [1, ..., 1, channels], reshaped to [channels]
+c10::optional<Tensor> channelScaleOfMul(Node* mul, Value* v, int64_t channels) {
+  if (mul->kind() != aten::mul || mul->inputs().size() != 2) {
+    return c10::nullopt;
+  }
+  auto other = mul->inputs().at(0) == v ? mul->inputs().at(1)
+                                        : mul->inputs().at(0);
+  if (other == v || other->node()->kind() != prim::Constant ||
+      !other->type()->cast<TensorType>()) {
+    return c10::nullopt;
+  }
+  auto scale = constant_as<Tensor>(other).value();
+  if (!scale.is_floating_point() || scale.dim() == 0 ||
+      scale.numel() != channels || scale.size(-1) != channels) {
+    return c10::nullopt;
+  }
+  // the scale must not broadcast v to more dims
+  if (scale.dim() > 1) {
+    auto v_dim = v->type()->expect<TensorType>()->dim();
+    if (!v_dim.has_value() || *v_dim < (size_t)scale.dim()) {
+      return c10::nullopt;
+    }
+  }
+  return scale.reshape({channels});
+}
+
+// The scale of the uses of v when all of them are muls by the same per
+// channel scale of dtype
+c10::optional<Tensor> commonChannelScale(
+    Value* v,
+    int64_t channels,
+    c10::ScalarType dtype) {
+  Tensor common;
+  for (const auto& use : v->uses()) {
+    auto scale = channelScaleOfMul(use.user, v, channels);
+    if (!scale.has_value() || scale->scalar_type() != dtype) {
+      return c10::nullopt;
+    }
+    if (!common.defined()) {
+      common = *scale;
+    } else if (!at::equal(common, *scale)) {
+      return c10::nullopt;
+    }
+  }
+  if (!common.defined()) {
+    return c10::nullopt;
+  }
+  return common;
+}
+
+bool FoldFrozenSmoothQuantScales(Block* b) {
+  bool graph_modified = false;
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      graph_modified |= FoldFrozenSmoothQuantScales(block);
+    }
+
+    // the producers of the activation and their constant per channel
+    // parameters scaled by the mul: the gamma and beta of a LayerNorm, the
+    // gamma of an RMSNorm (weight * x * rsqrt(...)) or the weight and bias
+    // of a Linear
+    Value* scaled_weight = nullptr;
+    Value* scaled_bias = nullptr;
+    bool per_output_row = false;
+    if (n->kind() == aten::layer_norm) {
+      if (nonConstantParameters(n) ||
+          n->namedInput("weight")->type() == NoneType::get()) {
+        continue;
+      }
+      scaled_weight = n->namedInput("weight");
+      if (n->namedInput("bias")->type() != NoneType::get()) {
+        scaled_bias = n->namedInput("bias");
+      }
+    } else if (n->kind() == aten::linear) {
+      if (nonConstantParameters(n)) {
+        continue;
+      }
+      scaled_weight = n->namedInput("weight");
+      if (n->namedInput("bias")->type() != NoneType::get()) {
+        scaled_bias = n->namedInput("bias");
+      }
+      per_output_row = true;
+    } else if (n->kind() == aten::mul && n->inputs().size() == 2) {
+      for (auto input : n->inputs()) {
+        if (input->node()->kind() == prim::Constant &&
+            input->type()->cast<TensorType>()) {
+          scaled_weight = input;
+        }
+      }
+      if (!scaled_weight ||
+          (n->inputs().at(0)->node()->kind() == prim::Constant &&
+           n->inputs().at(1)->node()->kind() == prim::Constant)) {
+        continue;
+      }
+    } else {
+      continue;
+    }
+
+    Tensor weight = constant_as<Tensor>(scaled_weight).value();
+    if (!weight.is_floating_point() ||
+        (per_output_row ? weight.dim() != 2 : weight.dim() != 1)) {
+      continue;
+    }
+    // LayerNorm and Linear keep the dtype of their input, the mul must not
+    // promote it
+    if (n->kind() != aten::mul) {
+      auto out_dtype = n->output()->type()->expect<TensorType>()->scalarType();
+      if (!out_dtype.has_value() || *out_dtype != weight.scalar_type()) {
+        continue;
+      }
+    }
+    int64_t channels = weight.size(0);
+    auto scale =
+        commonChannelScale(n->output(), channels, weight.scalar_type());
+    if (!scale.has_value()) {
+      continue;
+    }
+
+    WithInsertPoint guard(n);
+    auto graph = b->owningGraph();
+    auto fused_weight = graph->insertConstant(
+        per_output_row ? weight * scale->unsqueeze(-1) : weight * *scale);
+    fused_weight->setDebugName(scaled_weight->debugName() + "_fused_mul");
+    n->replaceInputWith(scaled_weight, fused_weight);
+    if (scaled_bias) {
+      Tensor bias = constant_as<Tensor>(scaled_bias).value();
+      auto fused_bias =
+          graph->insertConstant((bias * *scale).to(bias.scalar_type()));
+      fused_bias->setDebugName(scaled_bias->debugName() + "_fused_mul");
+      n->replaceInputWith(scaled_bias, fused_bias);
+    }
+    // the muls are left without uses for the DCE
+    auto uses = n->output()->uses();
+    for (const auto& use : uses) {
+      use.user->output()->replaceAllUsesWith(n->output());
+    }
+    graph_modified = true;
+  }
+  return graph_modified;
+}
+
 bool FoldFrozenLinearBatchnorm(std::shared_ptr<Graph>& graph) {
   bool graph_modified = FoldFrozenLinearBatchnorm(graph->block());
   EliminateDeadCode(graph);
@@ -322,6 +518,12 @@ bool FoldFrozenLinearMulOrDiv(std::shared_ptr<Graph>& graph) {
   return graph_modified;
 }
 
+bool FoldFrozenSmoothQuantScales(std::shared_ptr<Graph>& graph) {
+  bool graph_modified = FoldFrozenSmoothQuantScales(graph->block());
+  EliminateDeadCode(graph);
+  return graph_modified;
+}
+
 void FrozenLinearFolding(std::shared_ptr<Graph>& graph) {
   // run a couple times to capture Conv -> Mul -> Add etc
   bool changed;
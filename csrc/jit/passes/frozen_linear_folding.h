@@ -43,6 +43,14 @@ bool FoldFrozenLinearAddOrSub(std::shared_ptr<torch::jit::Graph>& graph);
 // This pass only works on Frozen Graphs; otherwise it is a No-Op.
 bool FoldFrozenLinearMulOrDiv(std::shared_ptr<torch::jit::Graph>& graph);
 
+// Folds the constant per channel scales of SmoothQuant, the mul of the
+// activation of a quantized linear by a vector of its input channels, into
+// the producer of the activation: the gamma and beta of a LayerNorm, the gamma
+// of an RMSNorm (a mul by a constant vector) or the weight and bias of a
+// Linear. All the uses of the activation must be muls by the same scales.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+bool FoldFrozenSmoothQuantScales(std::shared_ptr<torch::jit::Graph>& graph);
+
 // Call FoldFrozenLinearAddOrSub and FoldFrozenLinearMulOrDiv multiple times
 void FrozenLinearFolding(std::shared_ptr<torch::jit::Graph>& graph);
 
@@ -2,7 +2,12 @@
 #include "graph_rewrite_helper.h"
 #include "utils.h"
 
+#include "aten/PoolCat.h"
+
 #include <ATen/code_template.h>
+#include <functional>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <limits>
 #include <torch/csrc/jit/passes/remove_mutation.h>
 
 namespace torch_ipex {
@@ -211,6 +216,97 @@ void FuseRMSNorm(std::shared_ptr<Graph>& graph) {
   SubgraphRewriter rewriter_aten;
   rewriter_aten.RegisterRewritePattern(aten_RMSNorm, fused_RMSNorm);
   rewriter_aten.runOnGraph(graph);
+
+  // the residual add before RMSNorm in decoder layers, its output is also
+  // the residual of the next block
+  std::string add_RMSNorm = R"(
+      graph(%a, %b, %alpha:int, %weight, %eps:float):
+        %res = aten::add(%a, %b, %alpha)
+        %r = ipex::RMSNorm(%res, %weight, %eps)
+        return (%res, %r) )";
+  std::string fused_add_RMSNorm = R"(
+      graph(%a, %b, %alpha:int, %weight, %eps:float):
+        %res : Tensor, %r : Tensor = ipex::add_RMSNorm(%a, %b, %weight, %eps)
+        return (%res, %r) )";
+  auto filter_add_RMSNorm =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        const auto& match_vmap = match.values_map;
+        auto b = match_vmap.at(vmap.at("b"));
+        if (!b->type()->cast<TensorType>()) {
+          return false;
+        }
+        auto alpha = toIValue(match_vmap.at(vmap.at("alpha")));
+        return alpha.has_value() && alpha.value().isInt() &&
+            alpha.value().toInt() == 1;
+      };
+  SubgraphRewriter rewriter_add;
+  rewriter_add.RegisterRewritePattern(add_RMSNorm, fused_add_RMSNorm);
+  rewriter_add.runOnGraph(graph, filter_add_RMSNorm);
+}
+
+// x * cos + rotate_half(x) * sin, where rotate_half(x) = cat(-x2, x1) of
+// the halves x1 = x[..., :mid], x2 = x[..., mid:]. "mid" is usually computed
+// from the traced size, so the halves are checked by ipex::apply_rotary_emb
+// at runtime and only the constant parts of the slices are checked here.
+void FuseRotaryEmbedding(std::shared_ptr<Graph>& graph) {
+  std::string aten_rotary_emb = R"(
+      graph(%x, %cos, %sin, %dim1:int, %start1:int, %end1:int, %step1:int, %dim2:int, %start2:int, %end2:int, %step2:int, %cat_dim:int, %alpha:int):
+        %x1 = aten::slice(%x, %dim1, %start1, %end1, %step1)
+        %x2 = aten::slice(%x, %dim2, %start2, %end2, %step2)
+        %neg = aten::neg(%x2)
+        %list = prim::ListConstruct(%neg, %x1)
+        %rotated = aten::cat(%list, %cat_dim)
+        %a = aten::mul(%x, %cos)
+        %b = aten::mul(%rotated, %sin)
+        %r = aten::add(%a, %b, %alpha)
+        return (%r) )";
+  std::string fused_rotary_emb = R"(
+      graph(%x, %cos, %sin, %dim1:int, %start1:int, %end1:int, %step1:int, %dim2:int, %start2:int, %end2:int, %step2:int, %cat_dim:int, %alpha:int):
+        %r = ipex::apply_rotary_emb(%x, %cos, %sin, %dim1, %cat_dim, %end1, %start2)
+        return (%r) )";
+  auto filter_rotary_emb =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        const auto& match_vmap = match.values_map;
+        // the constant int of a pattern value, "none_value" for None (the
+        // omitted slice bounds)
+        auto const_int = [&](const std::string& name, int64_t none_value) {
+          auto value = toIValue(match_vmap.at(vmap.at(name)));
+          c10::optional<int64_t> result;
+          if (value.has_value() && value.value().isInt()) {
+            result = value.value().toInt();
+          } else if (value.has_value() && value.value().isNone()) {
+            result = none_value;
+          }
+          return result;
+        };
+        for (auto name : {"cos", "sin"}) {
+          if (!match_vmap.at(vmap.at(name))->type()->cast<TensorType>()) {
+            return false;
+          }
+        }
+        // mid is passed to the fused op
+        for (auto name : {"end1", "start2"}) {
+          auto type = match_vmap.at(vmap.at(name))->type();
+          if (type->kind() != TypeKind::IntType) {
+            return false;
+          }
+        }
+        const int64_t max_end = std::numeric_limits<int64_t>::max();
+        auto dim1 = const_int("dim1", -1);
+        auto dim2 = const_int("dim2", -1);
+        auto cat_dim = const_int("cat_dim", -1);
+        // x1 starts at 0 and x2 runs to the end of the dim
+        return dim1.has_value() && dim2 == dim1 && cat_dim.has_value() &&
+            const_int("start1", 0) == 0 &&
+            const_int("end2", max_end) == max_end &&
+            const_int("step1", 1) == 1 && const_int("step2", 1) == 1 &&
+            const_int("alpha", 1) == 1;
+      };
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(aten_rotary_emb, fused_rotary_emb);
+  rewriter.runOnGraph(graph, filter_rotary_emb);
 }
 
 void FuseAddLayerNorm(std::shared_ptr<Graph>& graph) {
@@ -678,6 +774,98 @@ void replaceEmbeddingBagWithQEmbeddingBag(std::shared_ptr<Graph>& graph) {
   rewriter_qembeddingbag.runOnGraph(graph);
 }
 
+// Replaces the merged embedding bag over dequantized qint8 tables, whose
+// pooled outputs are all quantized to qint8, with
+// torch_ipex::merged_embeddingbag_forward_int8, which requantizes the pooled
+// sums to the scales of the outputs. The dequantized outputs then feed
+// ipex::qinteraction (see replaceInteractionWithQInteraction).
+void replaceMergedEmbeddingBagWithQMergedEmbeddingBag(
+    std::shared_ptr<Graph>& graph) {
+  auto merged_embeddingbag =
+      Symbol::fromQualString("torch_ipex::merged_embeddingbag_forward");
+  auto merged_embeddingbag_int8 =
+      Symbol::fromQualString("torch_ipex::merged_embeddingbag_forward_int8");
+  std::vector<Node*> merged_nodes;
+  for (auto* n : graph->block()->nodes()) {
+    if (n->kind() == merged_embeddingbag) {
+      merged_nodes.push_back(n);
+    }
+  }
+  for (auto* n : merged_nodes) {
+    auto weights = n->input(2)->node();
+    if (weights->kind() != prim::ListConstruct ||
+        n->output()->uses().size() != 1 ||
+        n->output()->uses()[0].user->kind() != prim::ListUnpack) {
+      continue;
+    }
+    // the qint8 tables, per tensor quantized
+    std::vector<Value*> qweights;
+    for (auto input : weights->inputs()) {
+      auto dequantize = input->node();
+      if (dequantize->kind() != Symbol::aten("dequantize")) {
+        break;
+      }
+      auto qweight = toIValue(dequantize->input(0));
+      if (!qweight.has_value() || !qweight->isTensor() ||
+          qweight->toTensor().scalar_type() != at::kQInt8 ||
+          qweight->toTensor().qscheme() != at::kPerTensorAffine) {
+        break;
+      }
+      qweights.push_back(dequantize->input(0));
+    }
+    if (qweights.size() != weights->inputs().size()) {
+      continue;
+    }
+    // every pooled output quantized to qint8 with a constant scale and a zero
+    // point of 0
+    auto unpack = n->output()->uses()[0].user;
+    std::vector<Node*> quantizes;
+    std::vector<double> o_scales;
+    for (auto output : unpack->outputs()) {
+      if (output->uses().size() != 1) {
+        break;
+      }
+      auto quantize = output->uses()[0].user;
+      if (quantize->kind() != Symbol::aten("quantize_per_tensor") ||
+          quantize->inputs().size() != 4) {
+        break;
+      }
+      auto scale = toIValue(quantize->input(1));
+      auto zp = toIValue(quantize->input(2));
+      auto dtype = toIValue(quantize->input(3));
+      if (!scale.has_value() || !scale->isDouble() || !zp.has_value() ||
+          !zp->isInt() || zp->toInt() != 0 || !dtype.has_value() ||
+          !dtype->isInt() ||
+          dtype->toInt() != static_cast<int64_t>(at::kQInt8)) {
+        break;
+      }
+      quantizes.push_back(quantize);
+      o_scales.push_back(scale->toDouble());
+    }
+    if (quantizes.size() != unpack->outputs().size()) {
+      continue;
+    }
+
+    WithInsertPoint guard(n);
+    auto qweights_list =
+        graph->insertNode(graph->createList(TensorType::get(), qweights))
+            ->output();
+    auto qoutputs = graph->insert(
+        merged_embeddingbag_int8,
+        {n->input(0),
+         n->input(1),
+         qweights_list,
+         n->input(3),
+         graph->insertConstant(o_scales)});
+    auto qunpack =
+        graph->insertNode(graph->createListUnpack(qoutputs, quantizes.size()));
+    for (size_t i = 0; i < quantizes.size(); i++) {
+      quantizes[i]->output()->replaceAllUsesWith(qunpack->output(i));
+    }
+  }
+  EliminateDeadCode(graph);
+}
+
 void replaceInteractionWithQInteraction(std::shared_ptr<Graph>& graph) {
   std::vector<std::string> patterns;
   std::vector<std::string> replacements;
@@ -706,7 +894,7 @@ void replaceInteractionWithQInteraction(std::shared_ptr<Graph>& graph) {
           });
 
       if (!is_quantized)
-        return;
+        continue;
 
       std::string pattern = R"()";
       std::string replacement = R"()";
@@ -836,7 +1024,7 @@ void replaceLstmWithQLstm(std::shared_ptr<Graph>& graph) {
           });
 
       if (!maybe_quantized_lstm)
-        return;
+        continue;
 
       for (auto input : weights_ListConstructNode->inputs()) {
         if (input->node()->kind() == Symbol::aten("dequantize")) {
@@ -962,98 +1150,420 @@ void fuseBmmAdd(std::shared_ptr<Graph>& graph) {
   rewriter_add_v1.runOnGraph(graph, fusion_filter);
 }
 
-void FuseConcatBnRelu(std::shared_ptr<Graph>& graph) {
-  std::string aten_concat_bn_relu = R"(
-      graph(%input : Tensor[], %dim:int, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled):
+void FuseConcatBnEltwise(std::shared_ptr<Graph>& graph) {
+  auto aten_concat_bn_eltwise = at::jit::CodeTemplate(R"(
+      graph(%input : Tensor[], %dim:int, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled${eltwise_args}):
         %a = aten::cat(%input, %dim)
         %b = aten::batch_norm(%a, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled)
-        %c = aten::relu(%b)
-        return (%c) )";
-  std::string fused_concat_bn_relu = R"(
-      graph(%input : Tensor[], %dim:int, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled):
+        ${eltwise_op}
+        return (${output}) )");
+  auto fused_concat_bn_eltwise = at::jit::CodeTemplate(R"(
+      graph(%input : Tensor[], %dim:int, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled${eltwise_args}):
         %alpha: int = prim::Constant[value=1]()
         %u1 = aten::add(%running_var, %eps, %alpha)
         %u2 = aten::sqrt(%u1)
         %scale = aten::div(%weight, %u2)
         %u3 = aten::mul(%running_mean, %scale)
         %beta = aten::sub(%bias, %u3, %alpha)
-        %b = ipex::concat_bn_relu(%input, %scale, %beta, %weight, %bias, %running_mean, %running_var, %training, %momentum, %eps, %cudnn_enabled, %dim)
-        return (%b) )";
+        %eltwise: str = prim::Constant[value="${eltwise}"]()
+        %c = ipex::concat_bn_eltwise(%input, %scale, %beta, %dim, %eltwise)
+        return (%c) )");
 
+  // The inference BN of fp32 parameters after a cat of float or bfloat16
+  // tensors of a same layout, contiguous or channels last, along any dim
   auto fusion_filter = [](const Match& match,
                           const std::unordered_map<std::string, Value*>& vmap) {
-    Node* node = match.anchor;
     const auto& match_vmap = match.values_map;
-    // Check if the Concat Dimension is the channel
-    auto dim_ = torch_ipex::jit::graph_rewrite_helper::getIValue(
-                    "dim", match_vmap, vmap)
-                    .value();
-    if (!(dim_.isInt())) {
+    auto dim = graph_rewrite_helper::getIValue("dim", match_vmap, vmap);
+    auto training =
+        graph_rewrite_helper::getIValue("training", match_vmap, vmap);
+    if (!dim.has_value() || !dim->isInt() || !training.has_value() ||
+        !training->isBool() || training->toBool()) {
       return false;
     }
-    auto dim = dim_.toInt();
-    if (dim != 1) {
+    Node* list = match_vmap.at(vmap.at("input"))->node();
+    if (list->kind() != prim::ListConstruct || list->inputs().empty()) {
       return false;
     }
-    // Find the Concat node
-    auto n = node->input(0)->node()->input(0)->node();
-    TORCH_CHECK(n->kind() == aten::cat);
-
-    auto listConstruct = n->input(0)->node();
-    int64_t list_length = 0;
-    for (auto p : listConstruct->inputs()) {
-      list_length++;
-    }
-    // Check if the Concat list is not empty
-    TORCH_CHECK(list_length);
-
-    auto tensor1 = listConstruct->input(0)->type()->cast<TensorType>();
-    auto check_type_channelsize = [](c10::TensorType tensor) {
-      return (
-          (tensor.scalarType().value() == at::kFloat ||
-           tensor.scalarType().value() == at::kBFloat16) &&
-          tensor.sizes()[1].value() % 16 == 0 &&
-          utils::is_channelslast(tensor));
+    auto complete = [](const TensorTypePtr& t) {
+      return t && t->dim().has_value() && t->scalarType().has_value() &&
+          t->sizes().concrete_sizes().has_value() &&
+          t->strides().concrete_sizes().has_value();
     };
-    // Check if the dimension of the first tensor is either 4 or 5.
-    // Check if the data type, the size of Channels, and the memory format are
-    // float, mutiples of 16, and ChannelsLast(3d), respectively.
-    if (!(tensor1->dim().value() == 4 || tensor1->dim().value() == 5) ||
-        !check_type_channelsize(*tensor1)) {
+    auto first = list->input(0)->type()->cast<TensorType>();
+    if (!complete(first) || first->dim().value() < 2 ||
+        (first->scalarType().value() != at::kFloat &&
+         first->scalarType().value() != at::kBFloat16)) {
       return false;
     }
-    // Check the rest tensors
-    for (int64_t i = 1; i < list_length; ++i) {
-      auto tensori = listConstruct->input(i)->type()->cast<TensorType>();
-      // Check dimension, data type, channel size and memory format
-      if (!(tensor1->dim().value() == tensori->dim().value()) ||
-          !check_type_channelsize(*tensori)) {
+    const int64_t ndim = first->dim().value();
+    const int64_t cat_dim = at::maybe_wrap_dim(dim->toInt(), ndim);
+    const bool channels_last = utils::is_channelslast(*first);
+    auto first_sizes = first->sizes().concrete_sizes().value();
+    for (auto input : list->inputs()) {
+      auto t = input->type()->cast<TensorType>();
+      if (!complete(t) || t->dim().value() != ndim ||
+          t->scalarType() != first->scalarType() ||
+          (channels_last ? !utils::is_channelslast(*t)
+                         : !utils::is_contiguous(t))) {
         return false;
       }
-      // The channel sizes can be different, and check the other dim sizes.
-      for (int64_t j = 0; j < tensori->dim().value(); ++j) {
-        if (j != 1 &&
-            tensor1->sizes()[j].value() != tensori->sizes()[j].value()) {
+      auto sizes = t->sizes().concrete_sizes().value();
+      for (int64_t d = 0; d < ndim; ++d) {
+        if (d != cat_dim && sizes[d] != first_sizes[d]) {
           return false;
         }
       }
     }
-    // Check if the BN weights is fp32 datatype.
-    auto bn_node = node->input(0)->node();
-    if (bn_node->namedInput("weight")
-            ->type()
-            ->cast<TensorType>()
-            ->scalarType()
-            .value() != at::kFloat) {
-      return false;
+    // the BN parameters folded into the fp32 scale and shift
+    for (auto name : {"weight", "bias", "running_mean", "running_var"}) {
+      auto t = match_vmap.at(vmap.at(name))->type()->cast<TensorType>();
+      if (!t || t->scalarType() != at::kFloat) {
+        return false;
+      }
     }
     return true;
   };
 
-  SubgraphRewriter rewriter_concatbnrelu;
-  rewriter_concatbnrelu.RegisterRewritePattern(
-      aten_concat_bn_relu, fused_concat_bn_relu);
-  rewriter_concatbnrelu.runOnGraph(graph, fusion_filter);
+  // The fused activations, tried before the bare BN, and the check of their
+  // constant arguments %arg0 and %arg1
+  struct EltwisePattern {
+    std::string eltwise;
+    std::string args;
+    std::string op;
+    std::function<bool(const c10::IValue&, const c10::IValue&)> check;
+  };
+  auto any = [](const c10::IValue&, const c10::IValue&) { return true; };
+  auto is_relu6 = [](const c10::IValue& min, const c10::IValue& max) {
+    return min.isScalar() && max.isScalar() &&
+        min.toScalar().to<double>() == 0 && max.toScalar().to<double>() == 6;
+  };
+  auto is_approximate = [](const std::string& approximate) {
+    return [=](const c10::IValue& arg, const c10::IValue&) {
+      return arg.isString() && arg.toStringRef() == approximate;
+    };
+  };
+  std::vector<EltwisePattern> patterns = {
+      {"relu", "", "%c = aten::relu(%b)", any},
+      {"relu6", "", "%c = aten::relu6(%b)", any},
+      {"relu6",
+       ", %arg0, %arg1",
+       "%c = aten::hardtanh(%b, %arg0, %arg1)",
+       is_relu6},
+      {"silu", "", "%c = aten::silu(%b)", any},
+      {"gelu",
+       ", %arg0:str",
+       "%c = aten::gelu(%b, %arg0)",
+       is_approximate("none")},
+      {"gelu_tanh",
+       ", %arg0:str",
+       "%c = aten::gelu(%b, %arg0)",
+       is_approximate("tanh")},
+      {"none", "", "", any},
+  };
+  for (const auto& pattern : patterns) {
+    at::jit::TemplateEnv env;
+    env.s("eltwise", pattern.eltwise);
+    env.s("eltwise_args", pattern.args);
+    env.s("eltwise_op", pattern.op);
+    env.s("output", pattern.op.empty() ? "%b" : "%c");
+    auto eltwise_filter =
+        [&](const Match& match,
+            const std::unordered_map<std::string, Value*>& vmap) {
+          if (!fusion_filter(match, vmap)) {
+            return false;
+          }
+          c10::IValue args[2];
+          for (int i = 0; i < 2; ++i) {
+            const std::string name = "arg" + std::to_string(i);
+            if (!vmap.count(name)) {
+              continue;
+            }
+            auto arg = graph_rewrite_helper::getIValue(
+                name, match.values_map, vmap);
+            if (!arg.has_value()) {
+              return false;
+            }
+            args[i] = arg.value();
+          }
+          return pattern.check(args[0], args[1]);
+        };
+
+    SubgraphRewriter rewriter;
+    rewriter.RegisterRewritePattern(
+        aten_concat_bn_eltwise.format(env),
+        fused_concat_bn_eltwise.format(env));
+    rewriter.runOnGraph(graph, eltwise_filter);
+  }
+}
+
+// Fuses eltwise(a + b) * c, the gate of the squeeze and excitation blocks and
+// of the gated activations, into ipex::add_eltwise_mul, a single pass over the
+// broadcast operands instead of the add, the activation and the mul. The add
+// is optional, and c may be the sum itself, e.g. the swish (a + b) *
+// sigmoid(a + b).
+void FuseAddEltwiseMul(std::shared_ptr<Graph>& graph) {
+  auto aten_add_eltwise_mul = at::jit::CodeTemplate(R"(
+      graph(${inputs}${eltwise_args}):
+        ${add_op}
+        %e = ${eltwise_op}
+        %r = aten::mul(${mul_operands})
+        return (%r) )");
+  auto fused_add_eltwise_mul = at::jit::CodeTemplate(R"(
+      graph(${inputs}${eltwise_args}):
+        %none = prim::Constant()
+        %eltwise: str = prim::Constant[value="${eltwise}"]()
+        %r = ipex::add_eltwise_mul(${a}, ${b}, ${c}, %eltwise)
+        return (%r) )");
+
+  struct EltwisePattern {
+    std::string eltwise;
+    std::string args;
+    std::string op;
+    std::string approximate;
+  };
+  std::vector<EltwisePattern> eltwises = {
+      {"relu", "", "aten::relu(%s)", ""},
+      {"sigmoid", "", "aten::sigmoid(%s)", ""},
+      {"hardsigmoid", "", "aten::hardsigmoid(%s)", ""},
+      {"tanh", "", "aten::tanh(%s)", ""},
+      {"silu", "", "aten::silu(%s)", ""},
+      {"gelu", ", %approximate:str", "aten::gelu(%s, %approximate)", "none"},
+      {"gelu_tanh",
+       ", %approximate:str",
+       "aten::gelu(%s, %approximate)",
+       "tanh"},
+  };
+  // the operands of the mul, either order, by c or by the sum
+  std::vector<std::pair<std::string, bool>> muls = {
+      {"%e, %c", true}, {"%c, %e", true}, {"%s, %e", false}, {"%e, %s", false}};
+
+  for (const auto& eltwise : eltwises) {
+    for (bool with_add : {true, false}) {
+      for (const auto& mul : muls) {
+        const bool with_c = mul.second;
+        at::jit::TemplateEnv env;
+        std::string inputs = with_add ? "%a, %b, %alpha" : "%s";
+        if (with_c) {
+          inputs += ", %c";
+        }
+        env.s("inputs", inputs);
+        env.s("eltwise_args", eltwise.args);
+        env.s("add_op", with_add ? "%s = aten::add(%a, %b, %alpha)" : "");
+        env.s("eltwise_op", eltwise.op);
+        env.s("mul_operands", mul.first);
+        env.s("eltwise", eltwise.eltwise);
+        // without the add, the input of the activation is a
+        env.s("a", with_add ? "%a" : "%s");
+        env.s("b", with_add ? "%b" : "%none");
+        env.s("c", with_c ? "%c" : "%none");
+
+        auto filter = [&](const Match& match,
+                          const std::unordered_map<std::string, Value*>&
+                              vmap) {
+          const auto& match_vmap = match.values_map;
+          // tensor operands, not scalars promoting the type of the add
+          for (auto name : {"a", "b", "c", "s"}) {
+            if (vmap.count(name) &&
+                !match_vmap.at(vmap.at(name))->type()->cast<TensorType>()) {
+              return false;
+            }
+          }
+          if (with_add) {
+            auto alpha =
+                graph_rewrite_helper::getIValue("alpha", match_vmap, vmap);
+            if (!alpha.has_value() || !alpha->isScalar() ||
+                alpha->toScalar().to<double>() != 1) {
+              return false;
+            }
+          }
+          if (!eltwise.approximate.empty()) {
+            auto approximate = graph_rewrite_helper::getIValue(
+                "approximate", match_vmap, vmap);
+            if (!approximate.has_value() || !approximate->isString() ||
+                approximate->toStringRef() != eltwise.approximate) {
+              return false;
+            }
+          }
+          // the sum and the activation are not used out of the pattern
+          Value* sum = match_vmap.at(vmap.at("s"));
+          Value* act = match_vmap.at(vmap.at("e"));
+          const size_t sum_uses = with_c ? 1 : 2;
+          return act->uses().size() == 1 &&
+              (!with_add || sum->uses().size() == sum_uses);
+        };
+
+        SubgraphRewriter rewriter;
+        rewriter.RegisterRewritePattern(
+            aten_add_eltwise_mul.format(env),
+            fused_add_eltwise_mul.format(env));
+        rewriter.runOnGraph(graph, filter);
+      }
+    }
+  }
+}
+
+namespace {
+
+// The kind and sizes of the 2D pooling n with constant arguments, as the
+// pool_cat parameters of ../../cpu/aten/PoolCat.h, nullopt otherwise
+c10::optional<std::vector<int64_t>> poolCatParams(Node* n, bool relu) {
+  bool is_max = n->kind() == aten::max_pool2d;
+  if (!is_max && n->kind() != aten::avg_pool2d) {
+    return c10::nullopt;
+  }
+  for (size_t i = 1; i < n->inputs().size(); i++) {
+    if (!toIValue(n->input(i)).has_value()) {
+      return c10::nullopt;
+    }
+  }
+  auto input_type = n->input(0)->type()->cast<TensorType>();
+  if (!input_type || input_type->dim() != 4) {
+    return c10::nullopt;
+  }
+  // a single value applies to both dimensions
+  auto pair = [&](size_t i, std::vector<int64_t> empty) {
+    auto v = toIValue(n->input(i)).value().toIntVector();
+    if (v.empty()) {
+      v = empty;
+    }
+    return v.size() == 1 ? std::vector<int64_t>{v[0], v[0]} : v;
+  };
+  auto kernel = pair(1, {});
+  auto stride = pair(2, kernel);
+  auto padding = pair(3, {0, 0});
+  std::vector<int64_t> dilation = {1, 1};
+  bool ceil_mode = false, count_include_pad = false;
+  if (is_max) {
+    dilation = pair(4, {1, 1});
+    ceil_mode = toIValue(n->input(5)).value().toBool();
+  } else {
+    ceil_mode = toIValue(n->input(4)).value().toBool();
+    count_include_pad = toIValue(n->input(5)).value().toBool();
+    if (!toIValue(n->input(6)).value().isNone()) {
+      return c10::nullopt;
+    }
+  }
+  if (kernel.size() != 2 || stride.size() != 2 || padding.size() != 2 ||
+      dilation.size() != 2) {
+    return c10::nullopt;
+  }
+  return std::vector<int64_t>{
+      static_cast<int64_t>(
+          is_max ? cpu::PoolCatKind::MAX : cpu::PoolCatKind::AVG),
+      kernel[0],
+      kernel[1],
+      stride[0],
+      stride[1],
+      padding[0],
+      padding[1],
+      dilation[0],
+      dilation[1],
+      ceil_mode,
+      count_include_pad,
+      relu};
+}
+
+struct PoolCatFusion {
+  Node* cat;
+  std::vector<Value*> inputs;
+  std::vector<int64_t> params;
+  // the pools and relus feeding only the cat
+  std::vector<Node*> fused;
+};
+
+void collectPoolCat(
+    Block* b,
+    AliasDb& aliasDb,
+    std::vector<PoolCatFusion>& fusions) {
+  for (Node* node : b->nodes()) {
+    for (Block* subblock : node->blocks()) {
+      collectPoolCat(subblock, aliasDb, fusions);
+    }
+    if (node->kind() != aten::cat) {
+      continue;
+    }
+    auto list = node->input(0)->node();
+    auto dim = toIValue(node->input(1));
+    if (list->kind() != prim::ListConstruct ||
+        node->input(0)->uses().size() != 1 || !dim.has_value() ||
+        (dim->toInt() != 1 && dim->toInt() != -3)) {
+      continue;
+    }
+    PoolCatFusion fusion{node, {}, {}, {}};
+    c10::optional<at::ScalarType> dtype;
+    bool fusible = true, pooled = false;
+    for (Value* v : list->inputs()) {
+      auto type = v->type()->cast<TensorType>();
+      if (!type || type->dim() != 4 || !type->scalarType().has_value() ||
+          !type->isComplete() || !utils::is_channelslast(*type) ||
+          (type->scalarType() != at::kFloat &&
+           type->scalarType() != at::kBFloat16) ||
+          (dtype.has_value() && type->scalarType() != dtype)) {
+        fusible = false;
+        break;
+      }
+      dtype = type->scalarType();
+      Node* n = v->node();
+      bool relu = n->kind() == aten::relu || n->kind() == aten::relu_;
+      if (relu && v->uses().size() != 1) {
+        fusion.inputs.push_back(v);
+        std::vector<int64_t> copy(cpu::pool_cat_num_params, 0);
+        fusion.params.insert(fusion.params.end(), copy.begin(), copy.end());
+        continue;
+      }
+      Value* pool_output = relu ? n->input(0) : v;
+      auto params = poolCatParams(pool_output->node(), relu);
+      // the pooled tensor is read at the cat, it must not be written before
+      if (params.has_value() && pool_output->uses().size() == 1 &&
+          !aliasDb.hasWriters(pool_output->node()->input(0))) {
+        pooled = true;
+        fusion.inputs.push_back(pool_output->node()->input(0));
+        fusion.params.insert(
+            fusion.params.end(), params->begin(), params->end());
+        fusion.fused.push_back(pool_output->node());
+        if (relu) {
+          fusion.fused.push_back(n);
+        }
+      } else {
+        fusion.inputs.push_back(v);
+        std::vector<int64_t> copy(cpu::pool_cat_num_params, 0);
+        fusion.params.insert(fusion.params.end(), copy.begin(), copy.end());
+      }
+    }
+    if (fusible && pooled) {
+      fusions.push_back(std::move(fusion));
+    }
+  }
+}
+
+} // namespace
+
+void FusePoolCat(std::shared_ptr<Graph>& graph) {
+  std::vector<PoolCatFusion> fusions;
+  {
+    AliasDb aliasDb(graph);
+    collectPoolCat(graph->block(), aliasDb, fusions);
+  }
+  for (auto& fusion : fusions) {
+    Node* cat = fusion.cat;
+    Node* list = cat->input(0)->node();
+    WithInsertPoint guard(cat);
+    auto inputs =
+        graph->insertNode(graph->createList(TensorType::get(), fusion.inputs));
+    auto params = graph->insertConstant(IValue(fusion.params));
+    auto pool_cat = graph->insertNode(graph->create(
+        Symbol::fromQualString("ipex::pool_cat"),
+        {inputs->output(), params}));
+    pool_cat->output()->setType(cat->output()->type());
+    cat->output()->replaceAllUsesWith(pool_cat->output());
+    cat->destroy();
+    list->destroy();
+    // the relus come after their pools
+    for (auto it = fusion.fused.rbegin(); it != fusion.fused.rend(); ++it) {
+      (*it)->destroy();
+    }
+  }
 }
 
 void FuseLinearSwishCustomized(std::shared_ptr<Graph>& graph) {
@@ -25,6 +25,9 @@ void replaceAtenOpsWithIpexInplaceOps(
     std::shared_ptr<torch::jit::Graph>& graph);
 void replaceInplaceOpsWithOutplaceOps(
     std::shared_ptr<torch::jit::Graph>& graph);
+// Replaces the ipex fused ops (add_layernorm, RMSNorm) with their in-place
+// variants when their first input is dead after them
+void replaceIpexOpsWithInplaceOps(std::shared_ptr<torch::jit::Graph>& graph);
 void replaceAtenSoftmaxWithIpexSoftmax(
     std::shared_ptr<torch::jit::Graph>& graph);
 void replaceAtenBatchNormWithIpexBatchNorm(
@@ -33,6 +36,8 @@ void replaceAtenLayerNormWithIpexLayerNorm(
     std::shared_ptr<torch::jit::Graph>& graph);
 void replaceEmbeddingBagWithQEmbeddingBag(
     std::shared_ptr<torch::jit::Graph>& graph);
+void replaceMergedEmbeddingBagWithQMergedEmbeddingBag(
+    std::shared_ptr<torch::jit::Graph>& graph);
 void replaceInteractionWithQInteraction(
     std::shared_ptr<torch::jit::Graph>& graph);
 void preprocessSizeForQLstm(std::shared_ptr<torch::jit::Graph>& graph);
@@ -48,28 +53,48 @@ void insertPrePackedConvOp(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvWithEltwiseAdd(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvAddRelu(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseBottleneck(std::shared_ptr<torch::jit::Graph>& graph);
+void fuseGroupNormSiLU(std::shared_ptr<torch::jit::Graph>& graph);
+// Fuses a nearest x2 upsampling into the prepacked convolution reading it,
+// prepacked over the low resolution input with sub-pixel weights
+void fuseUpsampleNearestConv(std::shared_ptr<torch::jit::Graph>& graph);
 
 void RecordAtenLinearNodes(
     std::shared_ptr<torch::jit::Graph>& graph,
     std::unordered_set<torch::jit::Node*>& aten_linear,
     bool& use_mkl_sgemm);
+// The linears of mkl_sgemm_linear (SelectLinearBackends) are prepacked into
+// the MKL sgemm even when use_mkl_sgemm is not set
 void insertPrePackedLinearOp(
     std::shared_ptr<torch::jit::Graph>& graph,
     std::unordered_set<torch::jit::Node*>& aten_linear,
-    const bool& use_mkl_sgemm);
+    const bool& use_mkl_sgemm,
+    const std::unordered_set<torch::jit::Node*>& mkl_sgemm_linear = {});
 void fuseLinearWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseLinearAddRelu(std::shared_ptr<torch::jit::Graph>& graph);
+// Folds the pointwise ops with constant operands (scale, shift, clamp and
+// the activations) chained after a linear into its oneDNN post-op chain
+void fuseLinearWithEltwiseChain(std::shared_ptr<torch::jit::Graph>& graph);
+// Fuses the gate of the gated MLPs (SwiGLU, GeGLU), act(gate) * up, into the
+// linear their gate and up projections were concatenated into
+void fuseLinearGate(std::shared_ptr<torch::jit::Graph>& graph);
+// Fuses ipex::RMSNorm and ipex::add_layernorm into the prologue of the
+// prepacked linear reading their output
+void fuseNormLinear(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FuseRMSNorm(std::shared_ptr<torch::jit::Graph>& graph);
+void FuseRotaryEmbedding(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseAddLayerNorm(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseMatmulDivOrMul(std::shared_ptr<torch::jit::Graph>& graph);
-void FuseConcatBnRelu(std::shared_ptr<torch::jit::Graph>& graph);
+void FuseConcatBnEltwise(std::shared_ptr<torch::jit::Graph>& graph);
+void FusePoolCat(std::shared_ptr<torch::jit::Graph>& graph);
+void FuseAddEltwiseMul(std::shared_ptr<torch::jit::Graph>& graph);
 
 void insertPrePackedConvTransposeOp(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvTransposeWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvTransposeAdd(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FusedEinsumPost(std::shared_ptr<torch::jit::Graph>& graph);
+void ReplaceEinsumWithEinsumContract(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FusedTransFreeMha(std::shared_ptr<torch::jit::Graph>& graph);
 } // namespace graph_rewrite
@@ -1,4 +1,5 @@
 #include <ideep.hpp>
+#include "aten/ParamUtils.h"
 #include "aten/WeightPack.h"
 #include "cpu/kernels/OpContext.h"
 #include "graph_rewrite.h"
@@ -130,6 +131,10 @@ void insertPrePackedConvOp(Block* b) {
               weight_tensor.is_contiguous(at::MemoryFormat::ChannelsLast) ||
               weight_tensor.is_contiguous(at::MemoryFormat::ChannelsLast3d);
         }
+        // a channels last input, e.g. NDHWC video frames, is not reordered
+        // even though the weights are contiguous
+        w_is_channels_last = w_is_channels_last ||
+            utils::has_channelslast_type(n->inputs().at(0));
         IValue weight_is_channels_last_value(w_is_channels_last);
 
         auto weight_is_channels_last =
@@ -501,6 +506,132 @@ void fuseBottleneck(std::shared_ptr<Graph>& graph) {
   rewriter_v2.runOnGraph(graph, filter_v2);
 }
 
+void fuseGroupNormSiLU(std::shared_ptr<Graph>& graph) {
+  std::array<std::string, 2> silu_operators = {"silu", "silu_"};
+
+  auto group_norm_silu_conv_rstring = at::jit::CodeTemplate(R"(
+    graph(%input, %groups:int, %weight, %bias, %eps:float, %cudnn_enabled:bool, %packed_weight):
+        %x = aten::group_norm(%input, %groups, %weight, %bias, %eps, %cudnn_enabled)
+        %y = aten::${silu}(%x)
+        %res = ipex_prepack::convolution_run(%y, %packed_weight)
+        return (%res))");
+  std::string group_norm_silu_conv_fused = R"(
+    graph(%input, %groups:int, %weight, %bias, %eps:float, %cudnn_enabled:bool, %packed_weight):
+        %res = ipex_prepack::convolution_group_norm_silu_run(%input, %groups, %weight, %bias, %eps, %packed_weight)
+        return (%res))";
+
+  auto group_norm_silu_rstring = at::jit::CodeTemplate(R"(
+    graph(%input, %groups:int, %weight, %bias, %eps:float, %cudnn_enabled:bool):
+        %x = aten::group_norm(%input, %groups, %weight, %bias, %eps, %cudnn_enabled)
+        %res = aten::${silu}(%x)
+        return (%res))");
+  std::string group_norm_silu_fused = R"(
+    graph(%input, %groups:int, %weight, %bias, %eps:float, %cudnn_enabled:bool):
+        %res = ipex::group_norm_silu(%input, %groups, %weight, %bias, %eps)
+        return (%res))";
+
+  // The fused kernels read and write channels last 4D float or bfloat16
+  // activations, the layout the convolutions of the UNets expect
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    auto input_type =
+        match.values_map.at(vmap.at("input"))->type()->cast<TensorType>();
+    if (!input_type || !input_type->isComplete() ||
+        input_type->dim() != 4 ||
+        (input_type->scalarType() != at::kFloat &&
+         input_type->scalarType() != at::kBFloat16)) {
+      return false;
+    }
+    return utils::is_channelslast(*input_type);
+  };
+
+  for (const auto& silu : silu_operators) {
+    at::jit::TemplateEnv env;
+    env.s("silu", silu);
+    SubgraphRewriter rewriter_conv, rewriter;
+    rewriter_conv.RegisterRewritePattern(
+        group_norm_silu_conv_rstring.format(env), group_norm_silu_conv_fused);
+    rewriter_conv.runOnGraph(graph, filter);
+    rewriter.RegisterRewritePattern(
+        group_norm_silu_rstring.format(env), group_norm_silu_fused);
+    rewriter.runOnGraph(graph, filter);
+  }
+}
+
+void fuseUpsampleNearestConv(std::shared_ptr<Graph>& graph) {
+  // upsample_nearest2d.vec and upsample_nearest2d
+  std::array<std::string, 2> upsample_args = {
+      "%output_size, %scale_factors", "%output_size, %scales_h, %scales_w"};
+
+  auto upsample_conv_rstring = at::jit::CodeTemplate(R"(
+    graph(%input, ${upsample_args}, %weight, %bias, %stride:int[], %padding:int[], %dilation:int[], %groups:int, %weight_is_channels_last:bool, %input_size:int[]):
+        %x = aten::upsample_nearest2d(%input, ${upsample_args})
+        %packed_weight : __torch__.torch.classes.ipex_prepack.ConvolutionOpContext = ipex_prepack::convolution_prepack(%weight, %bias, %stride, %padding, %dilation, %groups, %weight_is_channels_last, %input_size)
+        %res = ipex_prepack::convolution_run(%x, %packed_weight)
+        return (%res))");
+  auto upsample_conv_fused_rstring = at::jit::CodeTemplate(R"(
+    graph(%input, ${upsample_args}, %weight, %bias, %stride:int[], %padding:int[], %dilation:int[], %groups:int, %weight_is_channels_last:bool, %input_size:int[]):
+        %packed_weight : __torch__.torch.classes.ipex_prepack.ConvolutionOpContext = ipex_prepack::convolution_upsample_nearest_prepack(%weight, %bias, %stride, %padding, %dilation, %groups, %weight_is_channels_last, %input_size)
+        %res = ipex_prepack::convolution_upsample_nearest_run(%input, %packed_weight)
+        return (%res))");
+
+  // An exact x2 upsampling of a channels last 4D float or bfloat16 input,
+  // read by a 2-D convolution of stride 1 and dilation 1 keeping its size
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    auto input_type =
+        match.values_map.at(vmap.at("input"))->type()->cast<TensorType>();
+    auto x_type =
+        match.values_map.at(vmap.at("x"))->type()->cast<TensorType>();
+    if (!input_type || !x_type || !input_type->isComplete() ||
+        !x_type->isComplete() || input_type->dim() != 4 ||
+        (input_type->scalarType() != at::kFloat &&
+         input_type->scalarType() != at::kBFloat16) ||
+        !utils::is_channelslast(*input_type)) {
+      return false;
+    }
+    auto input_sizes = input_type->sizes().concrete_sizes().value();
+    auto x_sizes = x_type->sizes().concrete_sizes().value();
+    if (x_sizes[2] != 2 * input_sizes[2] || x_sizes[3] != 2 * input_sizes[3]) {
+      return false;
+    }
+    auto weight = toIValue(match.values_map.at(vmap.at("weight")));
+    auto stride = toIValue(match.values_map.at(vmap.at("stride")));
+    auto padding = toIValue(match.values_map.at(vmap.at("padding")));
+    auto dilation = toIValue(match.values_map.at(vmap.at("dilation")));
+    if (!weight.has_value() || !weight->isTensor() || !stride.has_value() ||
+        !padding.has_value() || !dilation.has_value()) {
+      return false;
+    }
+    auto kernel = weight->toTensor().sizes();
+    if (kernel.size() != 4) {
+      return false;
+    }
+    auto stride_ = expand_param_if_needed(stride->toIntVector(), "stride", 2);
+    auto padding_ =
+        expand_param_if_needed(padding->toIntVector(), "padding", 2);
+    auto dilation_ =
+        expand_param_if_needed(dilation->toIntVector(), "dilation", 2);
+    for (int d = 0; d < 2; d++) {
+      if (stride_[d] != 1 || dilation_[d] != 1 ||
+          2 * padding_[d] != kernel[d + 2] - 1) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (const auto& args : upsample_args) {
+    at::jit::TemplateEnv env;
+    env.s("upsample_args", args);
+    SubgraphRewriter rewriter;
+    rewriter.RegisterRewritePattern(
+        upsample_conv_rstring.format(env),
+        upsample_conv_fused_rstring.format(env));
+    rewriter.runOnGraph(graph, filter);
+  }
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
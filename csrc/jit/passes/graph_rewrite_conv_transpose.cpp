@@ -92,6 +92,10 @@ void insertPrePackedConvTransposeOpForATen(Block* b) {
             weight_tensor.is_contiguous(at::MemoryFormat::ChannelsLast) ||
             weight_tensor.is_contiguous(at::MemoryFormat::ChannelsLast3d);
       }
+      // a channels last input, e.g. NDHWC video frames, is not reordered
+      // even though the weights are contiguous
+      w_is_channels_last = w_is_channels_last ||
+          utils::has_channelslast_type(n->inputs().at(0));
       IValue weight_is_channels_last_value(w_is_channels_last);
       auto weight_is_channels_last =
           graph->insertConstant(weight_is_channels_last_value);
@@ -133,7 +137,7 @@ void mayRePackConvTransposeOpForIpex(Block* b) {
     for (Block* block : n->blocks()) {
       mayRePackConvTransposeOpForIpex(block);
     }
-    // TODO: add conv_transpose3d
+    // torch_ipex::conv_transpose covers conv_transpose2d and 3d
     if (n->kind() == Symbol::fromQualString("torch_ipex::conv_transpose")) {
       WithInsertPoint guard(n);
       auto graph = n->owningGraph();
@@ -48,6 +48,34 @@ void FusedEinsumPost(std::shared_ptr<Graph>& graph) {
   rewriter_einsum_binary.runOnGraph(graph, ipex_einsum_filter);
 }
 
+void ReplaceEinsumWithEinsumContract(std::shared_ptr<Graph>& graph) {
+  std::string aten_einsum = R"(
+     graph(%equation, %inputs, %path):
+        %res = aten::einsum(%equation, %inputs, %path)
+        return (%res))";
+  std::string ipex_einsum_contract = R"(
+    graph(%equation, %inputs, %path):
+        %res = ipex::einsum_contract(%equation, %inputs)
+        return (%res))";
+  // more than two operands without a contraction path given by the user
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    const auto& match_vmap = match.values_map;
+    auto equation = torch_ipex::jit::graph_rewrite_helper::getIValue(
+        "equation", match_vmap, vmap);
+    auto path = torch_ipex::jit::graph_rewrite_helper::getIValue(
+        "path", match_vmap, vmap);
+    if (!equation.has_value() || !path.has_value() || !path->isNone()) {
+      return false;
+    }
+    auto eq = equation->toStringView();
+    return std::count(eq.begin(), eq.end(), ',') + 1 > 2;
+  };
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(aten_einsum, ipex_einsum_contract);
+  rewriter.runOnGraph(graph, filter);
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
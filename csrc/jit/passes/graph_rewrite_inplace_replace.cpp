@@ -356,6 +356,65 @@ void replaceInplaceOpsWithOutplaceOps(std::shared_ptr<Graph>& graph) {
   replaceInplaceOpsWithOutplaceOps(graph, graph->block());
 }
 
+// The ipex fused ops with a variant writing its output into its first input
+std::unordered_map<std::string, std::string> ipex_inplace_ops_mapping = {
+    {"ipex::add_layernorm", "ipex::add_layernorm_"},
+    {"ipex::RMSNorm", "ipex::RMSNorm_"}};
+
+// Whether node can write its output into v: an intermediate value with the
+// sizes, dtype and (contiguous) layout of the output, dead after node
+bool canOverwriteWithOutput(AliasDb* aliasDb, Node* node, Value* v) {
+  if (v->uses().size() != 1 || v->node()->kind() == prim::Constant) {
+    return false;
+  }
+  auto v_type = v->type()->cast<TensorType>();
+  auto output_type = node->output()->type()->cast<TensorType>();
+  if (!v_type || !output_type || !utils::is_contiguous(v_type)) {
+    return false;
+  }
+  auto v_sizes = v_type->sizes().concrete_sizes();
+  auto output_sizes = output_type->sizes().concrete_sizes();
+  if (!v_sizes.has_value() || !output_sizes.has_value() ||
+      v_sizes.value() != output_sizes.value()) {
+    return false;
+  }
+  if (!v_type->scalarType().has_value() ||
+      v_type->scalarType() != output_type->scalarType()) {
+    return false;
+  }
+  if (aliasDb->mayContainAlias(node->owningGraph()->outputs(), v) ||
+      maybeAliveAfterNode(aliasDb, node, v, node->output())) {
+    return false;
+  }
+  return !hasSideEffectOrAlias(v, aliasDb);
+}
+
+void replaceIpexOpsWithInplaceOps(std::shared_ptr<Graph>& graph) {
+  // the nodes of the sub-blocks are not checked, the liveness is only known
+  // on the top-level block
+  for (auto i = graph->block()->nodes().begin();
+       i != graph->block()->nodes().end();) {
+    Node* n = *i;
+    i++;
+    auto mapping = ipex_inplace_ops_mapping.find(n->kind().toQualString());
+    if (mapping == ipex_inplace_ops_mapping.end()) {
+      continue;
+    }
+    // always get the latest aliasdb
+    std::unique_ptr<AliasDb> aliasdb = std::make_unique<AliasDb>(graph);
+    if (!canOverwriteWithOutput(aliasdb.get(), n, n->input(0))) {
+      continue;
+    }
+    Node* new_node =
+        graph->create(Symbol::fromQualString(mapping->second), n->inputs(), 1);
+    new_node->copyMetadata(n);
+    new_node->insertBefore(n);
+    new_node->output()->setType(n->output()->type());
+    n->output()->replaceAllUsesWith(new_node->output());
+    n->destroy();
+  }
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
@@ -1,5 +1,8 @@
 #include <ATen/code_template.h>
 #include <ideep.hpp>
+#include <limits>
+#include "aten/LinearEpilogue.h"
+#include "aten/NormLinear.h"
 #include "passes/utils.h"
 
 #include "graph_rewrite.h"
@@ -96,10 +99,12 @@ void replaceFrozenIPEXLinearWithAtenLinear(
 void insertPrePackedLinearOp(
     Block* b,
     std::unordered_set<Node*>& aten_linear,
-    const bool& use_mkl_sgemm) {
+    const bool& use_mkl_sgemm,
+    const std::unordered_set<Node*>& mkl_sgemm_linear) {
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
-      insertPrePackedLinearOp(block, aten_linear, use_mkl_sgemm);
+      insertPrePackedLinearOp(
+          block, aten_linear, use_mkl_sgemm, mkl_sgemm_linear);
     }
     if (n->kind() != aten::linear)
       continue;
@@ -142,7 +147,7 @@ void insertPrePackedLinearOp(
     // the check since its graph element is not initialized. Details please
     // refer to
     // https://github.com/pytorch/pytorch/blob/master/torch/csrc/jit/ir/alias_analysis.cpp#L1956
-    auto use_mkl_sgemm_ = use_mkl_sgemm &&
+    auto use_mkl_sgemm_ = (use_mkl_sgemm || mkl_sgemm_linear.count(n)) &&
         weight_dtype_option.value() != at::ScalarType::BFloat16;
     auto prepack_node = graph->create(
         use_mkl_sgemm_
@@ -177,8 +182,10 @@ void insertPrePackedLinearOp(
 void insertPrePackedLinearOp(
     std::shared_ptr<Graph>& graph,
     std::unordered_set<Node*>& aten_linear,
-    const bool& use_mkl_sgemm) {
-  insertPrePackedLinearOp(graph->block(), aten_linear, use_mkl_sgemm);
+    const bool& use_mkl_sgemm,
+    const std::unordered_set<Node*>& mkl_sgemm_linear) {
+  insertPrePackedLinearOp(
+      graph->block(), aten_linear, use_mkl_sgemm, mkl_sgemm_linear);
 }
 
 void RecordAtenLinearNodes(
@@ -369,6 +376,396 @@ void fuseLinearAddRelu(std::shared_ptr<Graph>& graph) {
   rewriter_add_relu.runOnGraph(graph);
 }
 
+namespace {
+
+// The linears of fused unary post-ops starting an eltwise chain
+const std::unordered_map<std::string, dnnl::algorithm>& chain_start_ops() {
+  static const std::unordered_map<std::string, dnnl::algorithm> ops{
+      {"ipex_prepack::linear_relu_run", dnnl::algorithm::eltwise_relu},
+      {"ipex_prepack::linear_sigmoid_run", dnnl::algorithm::eltwise_logistic},
+      {"ipex_prepack::linear_tanh_run", dnnl::algorithm::eltwise_tanh},
+      {"ipex_prepack::linear_swish_run", dnnl::algorithm::eltwise_swish},
+  };
+  return ops;
+}
+
+// The pointwise ops of a single input appended as is
+const std::unordered_map<std::string, dnnl::algorithm>& chain_unary_ops() {
+  static const std::unordered_map<std::string, dnnl::algorithm> ops{
+      {"aten::relu", dnnl::algorithm::eltwise_relu},
+      {"aten::sigmoid", dnnl::algorithm::eltwise_logistic},
+      {"aten::tanh", dnnl::algorithm::eltwise_tanh},
+      {"aten::silu", dnnl::algorithm::eltwise_swish},
+      {"aten::abs", dnnl::algorithm::eltwise_abs},
+      {"aten::exp", dnnl::algorithm::eltwise_exp},
+      {"aten::sqrt", dnnl::algorithm::eltwise_sqrt},
+      {"aten::square", dnnl::algorithm::eltwise_square},
+      {"aten::log", dnnl::algorithm::eltwise_log},
+      {"aten::round", dnnl::algorithm::eltwise_round},
+  };
+  return ops;
+}
+
+struct EltwisePostOp {
+  dnnl::algorithm algorithm;
+  double alpha;
+  double beta;
+};
+
+// The value of a constant number or 0-dim tensor
+c10::optional<double> constant_scalar(Value* v) {
+  auto ival = toIValue(v);
+  if (!ival.has_value()) {
+    return c10::nullopt;
+  }
+  if (ival->isInt() || ival->isDouble()) {
+    return ival->toScalar().to<double>();
+  }
+  if (ival->isTensor() && ival->toTensor().dim() == 0 &&
+      !ival->toTensor().is_complex()) {
+    return ival->toTensor().item<double>();
+  }
+  return c10::nullopt;
+}
+
+// The post-op of n, for the constant other operands of n
+c10::optional<EltwisePostOp> eltwise_post_op(Node* n) {
+  auto unary = chain_unary_ops().find(n->kind().toQualString());
+  if (unary != chain_unary_ops().end()) {
+    if (n->inputs().size() != 1) {
+      return c10::nullopt;
+    }
+    // swish(x) = x * sigmoid(alpha * x)
+    double alpha = unary->second == dnnl::algorithm::eltwise_swish ? 1 : 0;
+    return EltwisePostOp{unary->second, alpha, 0};
+  }
+  if (n->matches("aten::mul(Tensor self, Scalar other) -> Tensor") ||
+      n->matches("aten::mul(Tensor self, Tensor other) -> Tensor")) {
+    if (auto scale = constant_scalar(n->input(1))) {
+      return EltwisePostOp{dnnl::algorithm::eltwise_linear, *scale, 0};
+    }
+  } else if (
+      n->matches("aten::div(Tensor self, Scalar other) -> Tensor") ||
+      n->matches("aten::div(Tensor self, Tensor other) -> Tensor")) {
+    auto divisor = constant_scalar(n->input(1));
+    if (divisor.has_value() && *divisor != 0) {
+      return EltwisePostOp{dnnl::algorithm::eltwise_linear, 1 / *divisor, 0};
+    }
+  } else if (
+      n->matches(
+          "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor") ||
+      n->matches(
+          "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor") ||
+      n->matches(
+          "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor") ||
+      n->matches(
+          "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor")) {
+    auto other = constant_scalar(n->input(1));
+    auto alpha = constant_scalar(n->input(2));
+    if (other.has_value() && alpha.has_value()) {
+      double shift = *other * *alpha;
+      if (n->kind() == aten::sub) {
+        shift = -shift;
+      }
+      return EltwisePostOp{dnnl::algorithm::eltwise_linear, 1, shift};
+    }
+  } else if (
+      n->matches("aten::clamp(Tensor self, Scalar? min=None, "
+                 "Scalar? max=None) -> Tensor") ||
+      n->matches("aten::hardtanh(Tensor self, Scalar min_val=-1, "
+                 "Scalar max_val=1) -> Tensor")) {
+    auto min = toIValue(n->input(1));
+    auto max = toIValue(n->input(2));
+    if (!min.has_value() || !max.has_value()) {
+      return c10::nullopt;
+    }
+    double lower = min->isNone() ? std::numeric_limits<float>::lowest()
+                                 : min->toScalar().to<double>();
+    double upper = max->isNone() ? std::numeric_limits<float>::max()
+                                 : max->toScalar().to<double>();
+    return EltwisePostOp{dnnl::algorithm::eltwise_clip, lower, upper};
+  } else if (n->matches("aten::leaky_relu(Tensor self, "
+                        "Scalar negative_slope=0.01) -> Tensor")) {
+    if (auto slope = constant_scalar(n->input(1))) {
+      return EltwisePostOp{dnnl::algorithm::eltwise_relu, *slope, 0};
+    }
+  }
+  return c10::nullopt;
+}
+
+bool same_scalar_type(Value* a, Value* b) {
+  auto a_type = a->type()->cast<TensorType>();
+  auto b_type = b->type()->cast<TensorType>();
+  if (!a_type || !b_type) {
+    return false;
+  }
+  // not known before the profiled types are in the graph
+  if (!a_type->scalarType().has_value() || !b_type->scalarType().has_value()) {
+    return true;
+  }
+  return *a_type->scalarType() == *b_type->scalarType();
+}
+
+void collectEltwiseChainStarts(Block* b, std::vector<Node*>& starts) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      collectEltwiseChainStarts(block, starts);
+    }
+    if (n->kind() == Symbol::fromQualString("ipex_prepack::linear_run") ||
+        chain_start_ops().count(n->kind().toQualString())) {
+      starts.push_back(n);
+    }
+  }
+}
+
+} // namespace
+
+void fuseLinearWithEltwiseChain(std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> starts;
+  collectEltwiseChainStarts(graph->block(), starts);
+  for (Node* linear : starts) {
+    std::vector<int64_t> algorithms;
+    std::vector<double> alphas;
+    std::vector<double> betas;
+    auto start = chain_start_ops().find(linear->kind().toQualString());
+    if (start != chain_start_ops().end()) {
+      algorithms.push_back(static_cast<int64_t>(start->second));
+      alphas.push_back(start->second == dnnl::algorithm::eltwise_swish ? 1 : 0);
+      betas.push_back(0);
+    }
+    // The chain stops at the first value used by another node, which then
+    // reads the output of the fused linear
+    std::vector<Node*> chain;
+    Value* v = linear->output();
+    while (v->uses().size() == 1) {
+      auto use = v->uses()[0];
+      if (use.offset != 0 || use.user->owningBlock() != linear->owningBlock() ||
+          !same_scalar_type(v, use.user->output())) {
+        break;
+      }
+      auto post_op = eltwise_post_op(use.user);
+      if (!post_op.has_value()) {
+        break;
+      }
+      algorithms.push_back(static_cast<int64_t>(post_op->algorithm));
+      alphas.push_back(post_op->alpha);
+      betas.push_back(post_op->beta);
+      chain.push_back(use.user);
+      v = use.user->output();
+    }
+    if (chain.empty()) {
+      continue;
+    }
+
+    WithInsertPoint guard(chain.back());
+    Node* fused = graph->create(
+        Symbol::fromQualString("ipex_prepack::linear_eltwise_chain_run"),
+        {linear->input(0),
+         graph->insertConstant(algorithms),
+         graph->insertConstant(alphas),
+         graph->insertConstant(betas),
+         linear->input(1)});
+    fused->insertBefore(chain.back());
+    fused->output()->copyMetadata(chain.back()->output());
+    chain.back()->output()->replaceAllUsesWith(fused->output());
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      (*it)->destroy();
+    }
+    linear->destroy();
+  }
+  EliminateDeadCode(graph);
+}
+
+namespace {
+
+// The activation of the gate of a gated MLP, as a LinearEpilogueAct
+c10::optional<int64_t> gate_activation(Node* act) {
+  if (act->kind() == aten::silu) {
+    return SiLU;
+  }
+  if (act->kind() != aten::gelu) {
+    return c10::nullopt;
+  }
+  auto approximate = toIValue(act->input(1));
+  if (!approximate.has_value() || !approximate->isString()) {
+    return c10::nullopt;
+  }
+  if (approximate->toStringRef() == "none") {
+    return GeLU;
+  }
+  if (approximate->toStringRef() == "tanh") {
+    return GeLUTanh;
+  }
+  return c10::nullopt;
+}
+
+struct LinearGate {
+  Node* linear;
+  Node* split;
+  Node* unpack;
+  Node* act;
+  Node* mul;
+  int64_t activation;
+  // whether the gate is the first half of the linear output
+  bool gate_first;
+};
+
+// act(gate) * up, gate and up the halves of the output of the linear the
+// gate and up projections were concatenated into by FrozenConcatLinear
+c10::optional<LinearGate> matchLinearGate(Node* mul) {
+  if (mul->kind() != aten::mul) {
+    return c10::nullopt;
+  }
+  for (size_t i = 0; i < 2; i++) {
+    Node* act = mul->input(i)->node();
+    Value* up = mul->input(1 - i);
+    auto activation = gate_activation(act);
+    if (!activation.has_value() || act->output()->uses().size() != 1) {
+      continue;
+    }
+    Value* gate = act->input(0);
+    Node* unpack = gate->node();
+    if (unpack->kind() != prim::ListUnpack || up->node() != unpack ||
+        gate == up || gate->uses().size() != 1 || up->uses().size() != 1) {
+      continue;
+    }
+    Node* split = unpack->input(0)->node();
+    bool is_split = split->kind() == aten::split_with_sizes ||
+        split->kind() == Symbol::fromQualString("ipex::split_tensor");
+    if (!is_split || split->output()->uses().size() != 1) {
+      continue;
+    }
+    auto sizes = toIValue(split->input(1));
+    if (!sizes.has_value() || !sizes->isIntList() ||
+        sizes->toIntVector().size() != 2 ||
+        sizes->toIntVector()[0] != sizes->toIntVector()[1]) {
+      continue;
+    }
+    if (split->kind() == aten::split_with_sizes &&
+        constant_as<int64_t>(split->input(2)).value_or(0) != -1) {
+      continue;
+    }
+    Node* linear = split->input(0)->node();
+    if (linear->kind() != Symbol::fromQualString("ipex_prepack::linear_run") ||
+        linear->output()->uses().size() != 1) {
+      continue;
+    }
+    Node* prepack = linear->input(1)->node();
+    if (prepack->kind() !=
+            Symbol::fromQualString("ipex_prepack::linear_prepack") ||
+        prepack->output()->uses().size() != 1 ||
+        !constant_as<at::Tensor>(prepack->input(0)).has_value()) {
+      continue;
+    }
+    return LinearGate{
+        linear, split, unpack, act, mul, *activation, gate->offset() == 0};
+  }
+  return c10::nullopt;
+}
+
+void collectLinearGates(Block* b, std::vector<LinearGate>& gates) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      collectLinearGates(block, gates);
+    }
+    auto gate = matchLinearGate(n);
+    if (gate.has_value()) {
+      gates.push_back(*gate);
+    }
+  }
+}
+
+// The halves of t along dim 0 swapped
+at::Tensor swapHalves(const at::Tensor& t) {
+  auto halves = t.chunk(2, 0);
+  return at::cat({halves[1], halves[0]}, 0);
+}
+
+} // namespace
+
+void fuseLinearGate(std::shared_ptr<Graph>& graph) {
+  std::vector<LinearGate> gates;
+  collectLinearGates(graph->block(), gates);
+  for (auto& gate : gates) {
+    Node* prepack = gate.linear->input(1)->node();
+    if (!gate.gate_first) {
+      // the kernel reads the gate from the first half
+      WithInsertPoint guard(prepack);
+      auto weight = constant_as<at::Tensor>(prepack->input(0)).value();
+      prepack->replaceInput(0, graph->insertConstant(swapHalves(weight)));
+      auto bias = constant_as<at::Tensor>(prepack->input(1));
+      if (bias.has_value()) {
+        prepack->replaceInput(1, graph->insertConstant(swapHalves(*bias)));
+      }
+    }
+    WithInsertPoint guard(gate.mul);
+    Node* fused = graph->create(
+        Symbol::fromQualString("ipex_prepack::linear_gate_run"),
+        {gate.linear->input(0),
+         graph->insertConstant(gate.activation),
+         gate.linear->input(1)});
+    fused->insertBefore(gate.mul);
+    fused->output()->copyMetadata(gate.mul->output());
+    gate.mul->output()->replaceAllUsesWith(fused->output());
+    gate.mul->destroy();
+    gate.act->destroy();
+    gate.unpack->destroy();
+    gate.split->destroy();
+    gate.linear->destroy();
+  }
+  EliminateDeadCode(graph);
+}
+
+void fuseNormLinear(std::shared_ptr<Graph>& graph) {
+  std::string rmsnorm_linear = R"(
+    graph(%input, %weight, %eps:float, %packed_weight):
+        %x = ipex::RMSNorm(%input, %weight, %eps)
+        %res = ipex_prepack::linear_run(%x, %packed_weight)
+        return (%res))";
+  std::string rmsnorm_linear_fused = R"(
+    graph(%input, %weight, %eps:float, %packed_weight):
+        %none = prim::Constant()
+        %norm : int = prim::Constant[value=1]()
+        %res = ipex_prepack::norm_linear_run(%input, %none, %weight, %none, %norm, %eps, %packed_weight)
+        return (%res))";
+
+  std::string add_layernorm_linear = R"(
+    graph(%a, %b, %alpha:int, %shape:int[], %w, %bias, %eps:float, %cudnn_enable:bool, %packed_weight):
+        %x = ipex::add_layernorm(%a, %b, %alpha, %shape, %w, %bias, %eps, %cudnn_enable)
+        %res = ipex_prepack::linear_run(%x, %packed_weight)
+        return (%res))";
+  std::string add_layernorm_linear_fused = R"(
+    graph(%a, %b, %alpha:int, %shape:int[], %w, %bias, %eps:float, %cudnn_enable:bool, %packed_weight):
+        %norm : int = prim::Constant[value=0]()
+        %res = ipex_prepack::norm_linear_run(%a, %b, %w, %bias, %norm, %eps, %packed_weight)
+        return (%res))";
+
+  // the prologue normalizes the last dim, from a + b, of the same dtype
+  auto filter_add_layernorm_linear =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        const auto& match_vmap = match.values_map;
+        auto a_type = match_vmap.at(vmap.at("a"))->type()->cast<TensorType>();
+        auto b_type = match_vmap.at(vmap.at("b"))->type()->cast<TensorType>();
+        if (!a_type || !b_type || !a_type->scalarType().has_value() ||
+            a_type->scalarType() != b_type->scalarType()) {
+          return false;
+        }
+        auto alpha = toIValue(match_vmap.at(vmap.at("alpha")));
+        auto shape = toIValue(match_vmap.at(vmap.at("shape")));
+        return alpha.has_value() && alpha->isInt() && alpha->toInt() == 1 &&
+            shape.has_value() && shape->isIntList() &&
+            shape->toIntVector().size() == 1;
+      };
+
+  SubgraphRewriter rewriter_rmsnorm, rewriter_add_layernorm;
+  rewriter_rmsnorm.RegisterRewritePattern(rmsnorm_linear, rmsnorm_linear_fused);
+  rewriter_add_layernorm.RegisterRewritePattern(
+      add_layernorm_linear, add_layernorm_linear_fused);
+  rewriter_rmsnorm.runOnGraph(graph);
+  rewriter_add_layernorm.runOnGraph(graph, filter_add_layernorm_linear);
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
@@ -17,10 +17,9 @@ auto bert_flash_mha_filter =
       auto permute_sizes =
           toIValue(graph_rewrite_helper::getValue("permute", match_vmap, vmap))
               ->toIntVector();
-      auto qkv = torch_ipex::jit::graph_rewrite_helper::getValue(
-                     "qkv", match_vmap, vmap)
-                     ->type()
-                     ->cast<TensorType>();
+      auto qkv_value = torch_ipex::jit::graph_rewrite_helper::getValue(
+          "qkv", match_vmap, vmap);
+      auto qkv = qkv_value->type()->cast<TensorType>();
       auto trans_a =
           toIValue(graph_rewrite_helper::getValue("trans_a", match_vmap, vmap))
               ->toInt();
@@ -28,10 +27,22 @@ auto bert_flash_mha_filter =
           toIValue(graph_rewrite_helper::getValue("trans_b", match_vmap, vmap))
               ->toInt();
       std::vector<int64_t> permute_ref = {0, 2, 1, 3};
-      if (permute_sizes != permute_ref || !(trans_a == -1 && trans_b == -2) ||
-          qkv->scalarType().value() != at::kBFloat16) {
+      if (permute_sizes != permute_ref || !(trans_a == -1 && trans_b == -2)) {
         return false;
       }
+      if (qkv->scalarType().value() != at::kBFloat16) {
+        // A dequantized qkv whose output is only requantized is fused here
+        // and then run as ipex::bert_flash_mha_int8.
+        auto output = torch_ipex::jit::graph_rewrite_helper::getValue(
+            "context_layer", match_vmap, vmap);
+        if (qkv->scalarType().value() != at::kFloat ||
+            qkv_value->node()->kind() != Symbol::aten("dequantize") ||
+            qkv_value->uses().size() != 1 || output->uses().size() != 1 ||
+            output->uses()[0].user->kind() !=
+                Symbol::aten("quantize_per_tensor")) {
+          return false;
+        }
+      }
       // Checking the dtype as None
       auto dtype_value = torch_ipex::jit::graph_rewrite_helper::getIValue(
           "dtype", match_vmap, vmap);
@@ -168,6 +179,67 @@ auto sd_flash_mha_filter_v4 =
       return true;
     };
 
+auto group_norm_transpose_filter =
+    [](const Match& match,
+       const std::unordered_map<std::string, Value*>& vmap) {
+      const auto& match_vmap = match.values_map;
+      auto one =
+          toIValue(graph_rewrite_helper::getValue("one", match_vmap, vmap))
+              ->toInt();
+      auto two =
+          toIValue(graph_rewrite_helper::getValue("two", match_vmap, vmap))
+              ->toInt();
+      return one == 1 && two == 2;
+    };
+
+auto group_norm_permute_filter =
+    [](const Match& match,
+       const std::unordered_map<std::string, Value*>& vmap) {
+      const auto& match_vmap = match.values_map;
+      auto permutelist = toIValue(graph_rewrite_helper::getValue(
+                                      "permutelist", match_vmap, vmap))
+                             ->toIntVector();
+      std::vector<int64_t> permute_ref = {0, 2, 3, 1};
+      return permutelist == permute_ref;
+    };
+
+auto causal_flash_mha_filter =
+    [](const Match& match,
+       const std::unordered_map<std::string, Value*>& vmap) {
+      const auto& match_vmap = match.values_map;
+      auto one =
+          toIValue(graph_rewrite_helper::getValue("one", match_vmap, vmap))
+              ->toInt();
+      auto two =
+          toIValue(graph_rewrite_helper::getValue("two", match_vmap, vmap))
+              ->toInt();
+      auto neg_one =
+          toIValue(graph_rewrite_helper::getValue("neg_one", match_vmap, vmap))
+              ->toInt();
+      auto query0 = torch_ipex::jit::graph_rewrite_helper::getValue(
+                        "query0", match_vmap, vmap)
+                        ->type()
+                        ->cast<TensorType>();
+      auto attn_mask = torch_ipex::jit::graph_rewrite_helper::getIValue(
+          "attn_mask", match_vmap, vmap);
+      auto dropout = torch_ipex::jit::graph_rewrite_helper::getIValue(
+          "dropout", match_vmap, vmap);
+      auto is_causal = torch_ipex::jit::graph_rewrite_helper::getIValue(
+          "is_causal", match_vmap, vmap);
+      if (!(one == 1 && two == 2 && neg_one == -1) ||
+          !query0->scalarType().has_value() ||
+          query0->scalarType().value() != at::kBFloat16) {
+        return false;
+      }
+      // only the causal mask without dropout is fused
+      if (!attn_mask.has_value() || !attn_mask.value().isNone() ||
+          !dropout.has_value() || dropout.value().toDouble() != 0 ||
+          !is_causal.has_value() || !is_causal.value().toBool()) {
+        return false;
+      }
+      return true;
+    };
+
 auto vit_mha_fusion_filter =
     [](const Match& match,
        const std::unordered_map<std::string, Value*>& vmap) {
@@ -357,6 +429,22 @@ void FusedTransFreeMha(std::shared_ptr<Graph>& graph) {
       bert_mha_pattern, bert_flash_mha_pattern);
   bert_mha_fusion.runOnGraph(graph, bert_flash_mha_filter);
 
+  // The int8 BERT MHA reads the quantized qkv and writes the quantized output.
+  std::string bert_flash_mha_dequant = R"(
+      graph(%qkv_quant, %relative_qk, %one_p, %scale, %trans_a, %dtype, %num_head, %head_dim, %r_scale, %r_zero_point, %r_dtype):
+        %qkv = aten::dequantize(%qkv_quant)
+        %output = ipex::bert_flash_mha(%qkv, %relative_qk, %one_p, %scale, %trans_a, %dtype, %num_head, %head_dim)
+        %r_quant = aten::quantize_per_tensor(%output, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+  std::string bert_flash_mha_int8 = R"(
+      graph(%qkv_quant, %relative_qk, %one_p, %scale, %trans_a, %dtype, %num_head, %head_dim, %r_scale, %r_zero_point, %r_dtype):
+        %r_quant = ipex::bert_flash_mha_int8(%qkv_quant, %relative_qk, %scale, %num_head, %head_dim, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+  SubgraphRewriter bert_mha_int8_fusion;
+  bert_mha_int8_fusion.RegisterRewritePattern(
+      bert_flash_mha_dequant, bert_flash_mha_int8);
+  bert_mha_int8_fusion.runOnGraph(graph);
+
   /**
    * Diffusers 0.12.1 uses aten::baddbmm / softmax / bmm to formulate
    * the MHA structure, while Diffusers 0.13.0 uses
@@ -504,6 +592,78 @@ void FusedTransFreeMha(std::shared_ptr<Graph>& graph) {
       sd_mha_pattern_v4, sd_fused_mha_pattern_v4);
   sd_mha_fusion_v4.runOnGraph(graph, sd_flash_mha_filter_v4);
 
+  // Causal MHA (e.g. GPT prefill) from aten::scaled_dot_product_attention
+  // with is_causal=True, the flash kernel skips the masked key blocks.
+  std::string causal_mha_graph = R"(
+      graph(%query0: Tensor, %key0: Tensor, %value0: Tensor, %one, %two, %neg_one, %num_head, %batchsize, %headsize, %hiddensize, %attn_mask, %dropout, %is_causal, %scale): )";
+
+  std::string causal_mha_main = R"(
+        %viewlist = prim::ListConstruct(%batchsize, %neg_one, %num_head, %headsize)
+        %query1 = aten::view(%query0, %viewlist)
+        %query2 = aten::transpose(%query1, %one, %two)
+        %key1 = aten::view(%key0, %viewlist)
+        %key2 = aten::transpose(%key1, %one, %two)
+        %value1 = aten::view(%value0, %viewlist)
+        %value2 = aten::transpose(%value1, %one, %two)
+        %hidden_states = aten::scaled_dot_product_attention(%query2, %key2, %value2, %attn_mask, %dropout, %is_causal, %scale)
+        %out0 = aten::transpose(%hidden_states, %one, %two)
+        %reshapelist = prim::ListConstruct(%batchsize, %neg_one, %hiddensize)
+        %output = aten::reshape(%out0, %reshapelist)
+        return (%output) )";
+
+  std::string causal_fused_mha_main = R"(
+        %output = ipex::sd_flash_mha(%query0, %key0, %value0, %scale, %num_head, %is_causal)
+        return (%output) )";
+
+  SubgraphRewriter causal_mha_fusion;
+  causal_mha_fusion.RegisterRewritePattern(
+      causal_mha_graph + causal_mha_main,
+      causal_mha_graph + causal_fused_mha_main);
+  causal_mha_fusion.runOnGraph(graph, causal_flash_mha_filter);
+
+  // Prologue of the SD attention blocks: the GroupNorm output is permuted to
+  // [B, HW, C] before the QKV linear, either by view + transpose (VAE
+  // AttentionBlock) or by permute + reshape (UNet Transformer2DModel). The
+  // fused GroupNorm writes [B, HW, C] directly instead of the NCHW output
+  // and its permuted copy.
+  std::string group_norm_graph = R"(
+      graph(%input: Tensor, %groups: int, %weight, %bias, %eps: float, %cudnn: bool, %viewlist: int[], %one: int, %two: int): )";
+
+  std::string group_norm_transpose_main = R"(
+        %gn = aten::group_norm(%input, %groups, %weight, %bias, %eps, %cudnn)
+        %hidden_states0 = aten::view(%gn, %viewlist)
+        %hidden_states = aten::transpose(%hidden_states0, %one, %two)
+        return (%hidden_states) )";
+
+  std::string fused_group_norm_transpose_main = R"(
+        %hidden_states = ipex::group_norm_transpose(%input, %groups, %weight, %bias, %eps, %viewlist)
+        return (%hidden_states) )";
+
+  std::string group_norm_permute_graph = R"(
+      graph(%input: Tensor, %groups: int, %weight, %bias, %eps: float, %cudnn: bool, %permutelist: int[], %reshapelist: int[]): )";
+
+  std::string group_norm_permute_main = R"(
+        %gn = aten::group_norm(%input, %groups, %weight, %bias, %eps, %cudnn)
+        %hidden_states0 = aten::permute(%gn, %permutelist)
+        %hidden_states = aten::reshape(%hidden_states0, %reshapelist)
+        return (%hidden_states) )";
+
+  // [B, H, W, C] and [B, HW, C] share the same contiguous data
+  std::string fused_group_norm_permute_main = R"(
+        %hidden_states0 = ipex::group_norm_transpose(%input, %groups, %weight, %bias, %eps)
+        %hidden_states = aten::reshape(%hidden_states0, %reshapelist)
+        return (%hidden_states) )";
+
+  SubgraphRewriter group_norm_transpose_fusion, group_norm_permute_fusion;
+  group_norm_transpose_fusion.RegisterRewritePattern(
+      group_norm_graph + group_norm_transpose_main,
+      group_norm_graph + fused_group_norm_transpose_main);
+  group_norm_transpose_fusion.runOnGraph(graph, group_norm_transpose_filter);
+  group_norm_permute_fusion.RegisterRewritePattern(
+      group_norm_permute_graph + group_norm_permute_main,
+      group_norm_permute_graph + fused_group_norm_permute_main);
+  group_norm_permute_fusion.runOnGraph(graph, group_norm_permute_filter);
+
   auto bmm_pattern = R"(
     graph(%batch1, %batch2):
         %res = aten::matmul(%batch1, %batch2)
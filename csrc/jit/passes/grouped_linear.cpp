@@ -0,0 +1,200 @@
+#include "grouped_linear.h"
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <unordered_set>
+#include <vector>
+
+#include "folding_common_utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using Tensor = at::Tensor;
+using namespace torch::jit;
+
+// Linears of more multiply-adds are left to the prepacked oneDNN linear, whose
+// own parallel region is worth its barrier.
+const int64_t kGroupedLinearMaxMacs = 1 << 22;
+
+class GroupLinearLayers {
+ public:
+  explicit GroupLinearLayers(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)), aliasDb_(graph_) {}
+
+  bool run(std::unordered_set<Node*>& aten_linear) {
+    std::vector<std::vector<Node*>> groups;
+    collectGroups(graph_->block(), groups);
+    // the graph is only modified once the groups of all the blocks are formed,
+    // the moves of collectGroups keeping the alias db valid
+    bool graph_modified = false;
+    for (auto& group : groups) {
+      if (group.size() > 1) {
+        mergeLinearLayers(group, aten_linear);
+        graph_modified = true;
+      }
+    }
+    return graph_modified;
+  }
+
+ private:
+  bool isCandidate(Node* n) {
+    if (n->kind() != aten::linear || nonConstantParameters(n)) {
+      return false;
+    }
+    auto weight = constant_as<Tensor>(n->namedInput("weight"));
+    if (!weight.has_value() || weight->dim() != 2 ||
+        (weight->scalar_type() != at::kFloat &&
+         weight->scalar_type() != at::kBFloat16)) {
+      return false;
+    }
+    auto bias_value = n->namedInput("bias");
+    if (bias_value->type() != NoneType::get()) {
+      auto bias = constant_as<Tensor>(bias_value);
+      if (!bias.has_value() || bias->scalar_type() != weight->scalar_type()) {
+        return false;
+      }
+    }
+    auto input_type = n->inputs().at(0)->type()->cast<TensorType>();
+    if (!input_type || input_type->scalarType() != weight->scalar_type()) {
+      return false;
+    }
+    auto input_size = input_type->sizes().concrete_sizes();
+    if (!input_size.has_value() || input_size->empty()) {
+      return false;
+    }
+    int64_t macs = weight->size(0);
+    for (auto size : input_size.value()) {
+      macs *= size;
+    }
+    return macs > 0 && macs <= kGroupedLinearMaxMacs;
+  }
+
+  // Whether n depends on a node of nodes within its block
+  bool dependsOn(Node* n, const std::unordered_set<Node*>& nodes) {
+    std::vector<Node*> stack = {n};
+    std::unordered_set<Node*> visited;
+    while (!stack.empty()) {
+      Node* node = stack.back();
+      stack.pop_back();
+      for (Value* input : node->inputs()) {
+        Node* producer = input->node();
+        if (producer->owningBlock() != n->owningBlock() ||
+            !visited.insert(producer).second) {
+          continue;
+        }
+        if (nodes.count(producer)) {
+          return true;
+        }
+        stack.push_back(producer);
+      }
+    }
+    return false;
+  }
+
+  // Greedily adds each candidate to the first group of its dtype it is
+  // independent of, moving it right before the first linear of the group.
+  void collectGroups(Block* b, std::vector<std::vector<Node*>>& groups) {
+    for (auto node : b->nodes()) {
+      for (Block* subblock : node->blocks()) {
+        collectGroups(subblock, groups);
+      }
+    }
+
+    std::vector<Node*> candidates;
+    for (Node* n : b->nodes()) {
+      if (isCandidate(n)) {
+        candidates.push_back(n);
+      }
+    }
+    size_t first_group = groups.size();
+    for (Node* n : candidates) {
+      auto dtype = n->inputs().at(0)->type()->cast<TensorType>()->scalarType();
+      bool grouped = false;
+      for (size_t i = first_group; i < groups.size() && !grouped; i++) {
+        Node* base = groups[i][0];
+        if (base->inputs().at(0)->type()->cast<TensorType>()->scalarType() !=
+            dtype) {
+          continue;
+        }
+        // n must not depend on its group, nor move the grouped linears after
+        // base along with its inputs
+        std::unordered_set<Node*> blocking(groups[i].begin(), groups[i].end());
+        for (size_t j = first_group; j < groups.size(); j++) {
+          for (Node* member : groups[j]) {
+            if (base->isBefore(member)) {
+              blocking.insert(member);
+            }
+          }
+        }
+        if (dependsOn(n, blocking) ||
+            !aliasDb_.moveBeforeTopologicallyValid(n, base)) {
+          continue;
+        }
+        groups[i].push_back(n);
+        grouped = true;
+      }
+      if (!grouped) {
+        groups.push_back({n});
+      }
+    }
+  }
+
+  // The linears of the group other than the first one were moved right
+  // before it, the grouped op takes the place of the first one.
+  void mergeLinearLayers(
+      std::vector<Node*>& group,
+      std::unordered_set<Node*>& aten_linear) {
+    Node* base_node = group[0];
+    WithInsertPoint guard(base_node);
+    std::vector<Value*> inputs, weights, biases;
+    for (Node* n : group) {
+      inputs.push_back(n->inputs().at(0));
+      weights.push_back(n->namedInput("weight"));
+      biases.push_back(n->namedInput("bias"));
+    }
+    auto inputs_list =
+        graph_->insertNode(graph_->createList(TensorType::get(), inputs));
+    auto weights_list =
+        graph_->insertNode(graph_->createList(TensorType::get(), weights));
+    auto biases_list = graph_->insertNode(
+        graph_->createList(OptionalType::ofTensor(), biases));
+    auto grouped_linear = graph_->insertNode(graph_->create(
+        Symbol::fromQualString("torch_ipex::grouped_linear"),
+        {inputs_list->output(),
+         weights_list->output(),
+         biases_list->output()}));
+    grouped_linear->output(0)->setType(ListType::ofTensors());
+    auto list_unpack = graph_->insertNode(graph_->create(
+        prim::ListUnpack, {grouped_linear->output(0)}, group.size()));
+
+    for (size_t i = 0; i < group.size(); i++) {
+      list_unpack->output(i)->setType(
+          group[i]->output(0)->type()->expect<TensorType>());
+      group[i]->output(0)->replaceAllUsesWith(list_unpack->output(i));
+      aten_linear.erase(group[i]);
+      group[i]->destroy();
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  AliasDb aliasDb_;
+};
+
+} // namespace
+
+TORCH_API bool FrozenGroupedLinear(
+    std::shared_ptr<Graph>& graph,
+    std::unordered_set<Node*>& aten_linear) {
+  GroupLinearLayers groupLayers(graph);
+  GRAPH_DUMP("Before FrozenGroupedLinear", graph);
+  bool changed = groupLayers.run(aten_linear);
+  if (changed) {
+    GRAPH_DUMP("After FrozenGroupedLinear", graph);
+  }
+  return changed;
+}
+
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Runs the small independent linear ops on different inputs of a block, with
+// constant weights, in a single torch_ipex::grouped_linear op.
+TORCH_API bool FrozenGroupedLinear(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    std::unordered_set<torch::jit::Node*>& aten_linear);
+
+} // namespace jit
+} // namespace torch_ipex
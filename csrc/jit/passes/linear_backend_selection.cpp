@@ -0,0 +1,134 @@
+#include "linear_backend_selection.h"
+#include <ATen/Parallel.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <ideep.hpp>
+#include "cpu/kernels/LinearMKLPacked.h"
+#include "cpu/kernels/LinearPacked.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using namespace torch::jit;
+using namespace torch_ipex::cpu;
+
+constexpr int kWarmupRuns = 3;
+constexpr int kTimedRuns = 10;
+
+// The fastest of the timed runs of fn, in seconds, after the warmup runs
+template <typename Fn>
+double benchmark(Fn&& fn) {
+  for (int i = 0; i < kWarmupRuns; i++) {
+    fn();
+  }
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < kTimedRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+// Whether the MKL packed sgemm runs the linear n faster than the oneDNN
+// packed weight, none when n is not a fp32 linear of static shapes with a
+// constant weight and bias
+c10::optional<bool> fasterWithMklSgemm(
+    Node* n,
+    std::unordered_map<std::string, bool>& selected) {
+  auto input_type = n->input(0)->type()->cast<TensorType>();
+  auto weight = constant_as<at::Tensor>(n->input(1));
+  auto bias_ival = toIValue(n->input(2));
+  if (!input_type || !weight.has_value() || !bias_ival.has_value()) {
+    return c10::nullopt;
+  }
+  auto input_size = input_type->sizes().concrete_sizes();
+  if (!input_size.has_value() || input_size->size() < 2 ||
+      weight->dim() != 2 || weight->scalar_type() != at::kFloat ||
+      input_type->scalarType() != at::kFloat) {
+    return c10::nullopt;
+  }
+  c10::optional<at::Tensor> bias;
+  if (bias_ival->isTensor()) {
+    bias = bias_ival->toTensor();
+  }
+
+  // the key of the shapes, the same shapes running the same kernels
+  std::string key;
+  for (auto s : *input_size) {
+    key += std::to_string(s) + ",";
+  }
+  key += "|" + std::to_string(weight->size(0)) + "," +
+      std::to_string(weight->size(1)) + (bias.has_value() ? "|b" : "|");
+  auto it = selected.find(key);
+  if (it != selected.end()) {
+    return it->second;
+  }
+
+  int64_t batch_size = c10::multiply_integers(*input_size) /
+      input_size->back();
+  auto input = at::rand(*input_size, weight->options());
+  auto onednn_ctx = detail::linear::createLinearPrePackOpContext(
+      at::Tensor(*weight), c10::optional<at::Tensor>(bias), batch_size);
+  auto mkl_ctx = detail::mkl_sgemm::createLinearMKLPrePackOpContext(
+      at::Tensor(*weight), c10::optional<at::Tensor>(bias), batch_size);
+  auto onednn_time =
+      benchmark([&]() { onednn_ctx->run(input, ideep::attr_t()); });
+  auto mkl_time = benchmark([&]() { mkl_ctx->run(input); });
+  GRAPH_DEBUG(
+      "linear ",
+      key,
+      " at ",
+      at::get_num_threads(),
+      " threads: oneDNN ",
+      onednn_time,
+      "s, MKL sgemm ",
+      mkl_time,
+      "s");
+  return selected[key] = mkl_time < onednn_time;
+}
+
+void SelectLinearBackends(
+    Block* b,
+    const std::unordered_set<Node*>& aten_linear,
+    std::unordered_map<std::string, bool>& selected,
+    std::unordered_set<Node*>& mkl_sgemm_linear) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      SelectLinearBackends(block, aten_linear, selected, mkl_sgemm_linear);
+    }
+    // the fp32 aten linears recorded are left to aten, not prepacked
+    if (n->kind() != aten::linear || aten_linear.count(n)) {
+      continue;
+    }
+    auto faster = fasterWithMklSgemm(n, selected);
+    if (faster.has_value() && *faster) {
+      mkl_sgemm_linear.insert(n);
+    }
+  }
+}
+
+} // namespace
+
+std::unordered_set<Node*> SelectLinearBackends(
+    std::shared_ptr<Graph>& graph,
+    const std::unordered_set<Node*>& aten_linear) {
+  std::unordered_map<std::string, bool> selected;
+  std::unordered_set<Node*> mkl_sgemm_linear;
+  SelectLinearBackends(
+      graph->block(), aten_linear, selected, mkl_sgemm_linear);
+  return mkl_sgemm_linear;
+}
+
+} // namespace jit
+} // namespace torch_ipex
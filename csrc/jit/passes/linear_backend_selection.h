@@ -0,0 +1,21 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <unordered_set>
+
+namespace torch_ipex {
+namespace jit {
+
+// Benchmarks the fp32 linears to be prepacked, with constant weights and
+// static shapes, on their own shapes and at the current number of threads,
+// with the oneDNN packed weight and the MKL packed sgemm, and returns the
+// linears the MKL sgemm is faster for; insertPrePackedLinearOp prepacks them
+// into ipex_prepack::mkl_sgemm_run, the choice recorded in the frozen graph.
+// The linears of the same shapes are benchmarked once.
+TORCH_API std::unordered_set<torch::jit::Node*> SelectLinearBackends(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    const std::unordered_set<torch::jit::Node*>& aten_linear);
+
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,345 @@
+#include "memory_planner.h"
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using namespace torch::jit;
+
+constexpr int64_t kArenaAlignment = 64;
+
+struct OutVariant {
+  Symbol kind;
+  // the index of the out argument in the inputs of the variant
+  size_t out_index;
+};
+
+// the ops writing into a planned buffer, by the op they replace
+const std::unordered_map<Symbol, OutVariant>& outVariants() {
+  static const std::unordered_map<Symbol, OutVariant> variants = {
+      {Symbol::fromQualString("ipex_prepack::linear_run"),
+       {Symbol::fromQualString("ipex_prepack::linear_run_out"), 1}},
+      {Symbol::fromQualString("ipex_prepack::linear_relu_run"),
+       {Symbol::fromQualString("ipex_prepack::linear_relu_run_out"), 1}},
+      {Symbol::fromQualString("torch_ipex::embedding_bag"),
+       {Symbol::fromQualString("torch_ipex::embedding_bag_out"), 5}},
+  };
+  return variants;
+}
+
+// Replaces node by its out variant writing into out, at the insertion point
+Node* insertOutVariant(Graph& graph, Node* node, Value* out) {
+  const auto& variant = outVariants().at(node->kind());
+  std::vector<Value*> inputs(node->inputs().begin(), node->inputs().end());
+  inputs.insert(inputs.begin() + variant.out_index, out);
+  auto* planned = graph.insertNode(graph.create(variant.kind, inputs));
+  planned->output()->setType(out->type());
+  node->output()->replaceAllUsesWith(planned->output());
+  node->destroy();
+  return planned;
+}
+
+struct PlannedBuffer {
+  Node* node;
+  int64_t nbytes;
+  // the first and last top-level nodes the output is live at
+  size_t begin;
+  size_t end;
+  int64_t offset = 0;
+};
+
+// The bytes spanned by a CPU tensor of a complete type, 0 when unknown
+int64_t staticNbytes(const Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type || !type->isComplete() || !type->device()->is_cpu()) {
+    return 0;
+  }
+  auto sizes = *type->sizes().concrete_sizes();
+  auto strides = *type->strides().concrete_sizes();
+  int64_t extent = 1;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] == 0) {
+      return 0;
+    }
+    extent += (sizes[i] - 1) * strides[i];
+  }
+  return extent * c10::elementSize(*type->scalarType());
+}
+
+int64_t alignUp(int64_t nbytes) {
+  return (nbytes + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+class MemoryPlanner {
+ public:
+  explicit MemoryPlanner(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)), aliasDb_(graph_) {
+    size_t index = 0;
+    for (auto* node : graph_->block()->nodes()) {
+      nodeIndex_[node] = index++;
+    }
+    collectValues(graph_->block());
+  }
+
+  bool run() {
+    std::vector<PlannedBuffer> buffers;
+    for (auto* node : graph_->block()->nodes()) {
+      if (!outVariants().count(node->kind()) || node->outputs().size() != 1) {
+        continue;
+      }
+      auto nbytes = staticNbytes(node->output());
+      size_t end = 0;
+      if (nbytes == 0 || !liveRange(node, end)) {
+        continue;
+      }
+      buffers.push_back({node, alignUp(nbytes), nodeIndex_[node], end});
+    }
+    if (buffers.empty()) {
+      return false;
+    }
+    auto arena_bytes = assignOffsets(buffers);
+    GRAPH_DEBUG(
+        "Planning ", buffers.size(), " outputs in ", arena_bytes, " bytes");
+    rewrite(buffers, arena_bytes);
+    return true;
+  }
+
+ private:
+  void collectValues(Block* block) {
+    for (auto* node : block->nodes()) {
+      for (auto* output : node->outputs()) {
+        if (output->type()->kind() != TypeKind::NoneType) {
+          values_.push_back(output);
+        }
+      }
+      for (auto* sub : node->blocks()) {
+        collectValues(sub);
+      }
+    }
+  }
+
+  // The index of the top-level node containing n
+  size_t topLevelIndex(Node* n) {
+    while (n->owningBlock() != graph_->block()) {
+      n = n->owningBlock()->owningNode();
+    }
+    return nodeIndex_.at(n);
+  }
+
+  // The last top-level node using the output of node or a value aliasing it,
+  // false when one of them is an output of the graph
+  bool liveRange(Node* node, size_t& end) {
+    auto* output = node->output();
+    end = nodeIndex_[node];
+    for (auto* value : values_) {
+      if (value != output && !aliasDb_.mayContainAlias(output, value)) {
+        continue;
+      }
+      for (auto& use : value->uses()) {
+        if (use.user == graph_->return_node()) {
+          return false;
+        }
+        end = std::max(end, topLevelIndex(use.user));
+      }
+    }
+    return true;
+  }
+
+  // Places the largest buffers first, each at the lowest offset free during
+  // its live range, and returns the bytes of the arena
+  int64_t assignOffsets(std::vector<PlannedBuffer>& buffers) {
+    std::vector<PlannedBuffer*> order;
+    for (auto& buffer : buffers) {
+      order.push_back(&buffer);
+    }
+    std::stable_sort(
+        order.begin(), order.end(), [](PlannedBuffer* a, PlannedBuffer* b) {
+          return a->nbytes > b->nbytes;
+        });
+    int64_t arena_bytes = 0;
+    std::vector<PlannedBuffer*> placed;
+    for (auto* buffer : order) {
+      std::vector<PlannedBuffer*> live;
+      for (auto* other : placed) {
+        if (other->begin <= buffer->end && buffer->begin <= other->end) {
+          live.push_back(other);
+        }
+      }
+      std::sort(
+          live.begin(), live.end(), [](PlannedBuffer* a, PlannedBuffer* b) {
+            return a->offset < b->offset;
+          });
+      int64_t offset = 0;
+      for (auto* other : live) {
+        if (offset + buffer->nbytes <= other->offset) {
+          break;
+        }
+        offset = std::max(offset, other->offset + other->nbytes);
+      }
+      buffer->offset = offset;
+      arena_bytes = std::max(arena_bytes, offset + buffer->nbytes);
+      placed.push_back(buffer);
+    }
+    return arena_bytes;
+  }
+
+  void rewrite(std::vector<PlannedBuffer>& buffers, int64_t arena_bytes) {
+    Value* arena = nullptr;
+    {
+      WithInsertPoint guard(graph_->block()->nodes().front());
+      auto* arena_node = graph_->insertNode(graph_->create(
+          Symbol::fromQualString("ipex::memory_arena"),
+          {graph_->insertConstant(arena_bytes)}));
+      arena = arena_node->output()->setType(TensorType::get());
+    }
+    for (auto& buffer : buffers) {
+      auto* node = buffer.node;
+      auto type = node->output()->type()->expect<TensorType>();
+      WithInsertPoint guard(node);
+      auto* slice = graph_->insertNode(graph_->create(
+          Symbol::fromQualString("ipex::arena_slice"),
+          {arena,
+           graph_->insertConstant(buffer.offset),
+           graph_->insertConstant(*type->sizes().concrete_sizes()),
+           graph_->insertConstant(*type->strides().concrete_sizes()),
+           graph_->insertConstant(*type->scalarType())}));
+      slice->output()->setType(type);
+      insertOutVariant(*graph_, node, slice->output());
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  AliasDb aliasDb_;
+  std::unordered_map<Node*, size_t> nodeIndex_;
+  // the outputs of the nodes of all the blocks
+  std::vector<Value*> values_;
+};
+
+void collectCats(Block* block, std::vector<Node*>& cats) {
+  for (auto* node : block->nodes()) {
+    for (auto* sub : node->blocks()) {
+      collectCats(sub, cats);
+    }
+    if (node->kind() == aten::cat) {
+      cats.push_back(node);
+    }
+  }
+}
+
+// Allocates the output of cat before the ops with an out variant producing its
+// inputs, which write into their slice of it, and replaces cat by
+// ipex::cat_views copying the other inputs into their slices
+bool planCatViews(Graph& graph, Node* cat) {
+  auto* list = cat->input(0)->node();
+  auto dim = toIValue(cat->input(1));
+  if (list->kind() != prim::ListConstruct ||
+      cat->input(0)->uses().size() != 1 || !dim.has_value() ||
+      staticNbytes(cat->output()) == 0) {
+    return false;
+  }
+  auto type = cat->output()->type()->expect<TensorType>();
+  auto sizes = *type->sizes().concrete_sizes();
+  auto strides = *type->strides().concrete_sizes();
+  int64_t cat_dim = c10::maybe_wrap_dim(dim->toInt(), sizes.size());
+
+  // the output written into the cat is not read by another op
+  auto writesIntoCat = [&](Value* input) {
+    auto* node = input->node();
+    return outVariants().count(node->kind()) && node->outputs().size() == 1 &&
+        input->uses().size() == 1 && node->owningBlock() == cat->owningBlock();
+  };
+  std::vector<int64_t> starts;
+  int64_t start = 0;
+  Node* first = nullptr;
+  for (auto* input : list->inputs()) {
+    auto input_type = input->type()->cast<TensorType>();
+    if (!input_type || !input_type->isComplete() ||
+        *input_type->dim() != sizes.size() ||
+        input_type->scalarType() != type->scalarType()) {
+      return false;
+    }
+    starts.push_back(start);
+    start += (*input_type->sizes().concrete_sizes())[cat_dim];
+    if (writesIntoCat(input) && (!first || input->node()->isBefore(first))) {
+      first = input->node();
+    }
+  }
+  if (!first || start != sizes[cat_dim]) {
+    return false;
+  }
+
+  Value* buffer = nullptr;
+  {
+    WithInsertPoint guard(first);
+    auto* none = graph.insertConstant(IValue());
+    auto* empty = graph.insertNode(graph.create(
+        aten::empty_strided,
+        {graph.insertConstant(sizes),
+         graph.insertConstant(strides),
+         graph.insertConstant(*type->scalarType()),
+         none,
+         none,
+         none}));
+    buffer = empty->output()->setType(type);
+  }
+  for (size_t i = 0; i < list->inputs().size(); i++) {
+    auto* input = list->input(i);
+    if (!writesIntoCat(input)) {
+      continue;
+    }
+    auto* node = input->node();
+    auto input_type = input->type()->expect<TensorType>();
+    auto input_sizes = *input_type->sizes().concrete_sizes();
+    WithInsertPoint guard(node);
+    auto* view = graph.insertNode(graph.create(
+        aten::slice,
+        {buffer,
+         graph.insertConstant(cat_dim),
+         graph.insertConstant(starts[i]),
+         graph.insertConstant(starts[i] + input_sizes[cat_dim]),
+         graph.insertConstant(1)}));
+    view->output()->setType(
+        input_type->withSizesStrides(input_sizes, strides));
+    insertOutVariant(graph, node, view->output());
+  }
+
+  WithInsertPoint guard(cat);
+  auto* cat_views = graph.insertNode(graph.create(
+      Symbol::fromQualString("ipex::cat_views"),
+      {buffer, cat->input(0), graph.insertConstant(cat_dim)}));
+  cat_views->output()->setType(type);
+  cat->output()->replaceAllUsesWith(cat_views->output());
+  cat->destroy();
+  return true;
+}
+
+} // namespace
+
+bool PlanCatOutputViews(std::shared_ptr<Graph>& graph) {
+  GRAPH_DUMP("Before PlanCatOutputViews", graph);
+  std::vector<Node*> cats;
+  collectCats(graph->block(), cats);
+  bool planned = false;
+  for (auto* cat : cats) {
+    planned |= planCatViews(*graph, cat);
+  }
+  GRAPH_DUMP("After PlanCatOutputViews", graph);
+  return planned;
+}
+
+bool PlanFrozenGraphMemory(std::shared_ptr<Graph>& graph) {
+  GRAPH_DUMP("Before PlanFrozenGraphMemory", graph);
+  bool planned = MemoryPlanner(graph).run();
+  GRAPH_DUMP("After PlanFrozenGraphMemory", graph);
+  return planned;
+}
+
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Plans the outputs of the IPEX ops with an out variant (the prepacked
+// linears) of a graph with static shapes into a single arena: the outputs of
+// the top-level block which are neither outputs of the graph nor aliased
+// beyond it are given offsets by their liveness, two outputs sharing bytes
+// only when they are never live at once, and the ops write into their slice
+// of the arena, which is allocated once per run and reused across the runs of
+// a thread.
+TORCH_API bool PlanFrozenGraphMemory(std::shared_ptr<torch::jit::Graph>& graph);
+
+// Plans the outputs of the IPEX ops with an out variant which are only
+// concatenated, e.g. the embedding bags of DLRM, as views of the output of the
+// cat with static shapes: the output is allocated first, each op writes into
+// its slice and the cat becomes ipex::cat_views, which only copies the inputs
+// not written in place, e.g. by the other ops or when an op could not write
+// into a strided slice.
+TORCH_API bool PlanCatOutputViews(std::shared_ptr<torch::jit::Graph>& graph);
+
+} // namespace jit
+} // namespace torch_ipex
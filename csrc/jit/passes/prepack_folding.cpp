@@ -1,5 +1,6 @@
 #include <torch/csrc/jit/passes/constant_propagation.h>
 #include "cpu/kernels/OpContext.h"
+#include "folding_common_utils.h"
 
 #include "prepack_folding.h"
 
@@ -45,11 +46,24 @@ void PrePackingOpsFolder(Block* b) {
   };
 
   std::unordered_set<Node*> nodes_to_delete;
+  // the packed weights by the kind and the constant inputs of the prepack op,
+  // for the prepacks of the shared weights to be run once
+  std::unordered_map<std::string, Value*> packed_weights;
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
       PrePackingOpsFolder(block);
     }
     if (is_foldable_op(n)) {
+      auto key = constantsKey(n->inputs());
+      if (key) {
+        *key = std::string(n->kind().toQualString()) + "|" + *key;
+        auto found = packed_weights.find(*key);
+        if (found != packed_weights.end()) {
+          n->output(0)->replaceAllUsesWith(found->second);
+          nodes_to_delete.insert(n);
+          continue;
+        }
+      }
       auto optional_outputs = torch::jit::runNodeIfInputsAreConstant(n);
       if (optional_outputs) {
         auto outputs = optional_outputs.value();
@@ -66,6 +80,9 @@ void PrePackingOpsFolder(Block* b) {
         Value* packed_weight = graph->insertConstant(weak_class_obj)
                                    ->setType(n->output(0)->type());
         prepack_op_value->replaceAllUsesWith(packed_weight);
+        if (key) {
+          packed_weights.emplace(*key, packed_weight);
+        }
         nodes_to_delete.insert(n);
       }
     }
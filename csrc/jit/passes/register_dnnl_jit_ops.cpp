@@ -4,8 +4,14 @@
 #include <torch/csrc/jit/runtime/operator.h>
 
 #include "aten/AddLayerNorm.h"
-#include "aten/ConcatBnRelu.h"
+#include "aten/AddSwish.h"
+#include "aten/ConcatBnEltwise.h"
+#include "aten/GroupNorm.h"
+#include "aten/MultiHeadAttention.h"
+#include "aten/PoolCat.h"
+#include "aten/QuantizedNormActivation.h"
 #include "aten/RMSNorm.h"
+#include "aten/RotaryPositionEmbedding.h"
 #include "cpu/kernels/ConvPacked.h"
 #include "cpu/kernels/ConvTransposePacked.h"
 #include "cpu/kernels/Einsum.h"
@@ -16,6 +22,7 @@
 #include "cpu/kernels/LinearSwishCustomized.h"
 #include "cpu/kernels/Matmul.h"
 #include "cpu/kernels/MaxPool2D.h"
+#include "cpu/kernels/MemoryPlan.h"
 #include "cpu/kernels/Mha.h"
 #include "cpu/kernels/OpContext.h"
 #include "cpu/kernels/RNN.h"
@@ -162,6 +169,27 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                      \
       aliasAnalysisFromSchema())
 
+#define CreateLinearUnaryPostOpRunOut(FUSED_OP)                    \
+  Operator(                                                        \
+      "ipex_prepack::linear_" #FUSED_OP                            \
+      "_out(Tensor input, Tensor(a!) out, "                        \
+      "__torch__.torch.classes.ipex_prepack.LinearOpContext "      \
+      "W_prepack) -> Tensor(a!)",                                  \
+      [](const Node* node) -> Operation {                          \
+        return [](Stack* stack) {                                  \
+          auto output = (std::move(peek(stack, 1, 3))).toTensor(); \
+          auto result = linear_##FUSED_OP##_out(                   \
+              (std::move(peek(stack, 0, 3))).toTensor(),           \
+              output,                                              \
+              (std::move(peek(stack, 2, 3)))                       \
+                  .toCustomClass<LinearOpContext>());              \
+          drop(stack, 3);                                          \
+          torch::jit::pack(stack, std::move(result));              \
+          return 0;                                                \
+        };                                                         \
+      },                                                           \
+      aliasAnalysisFromSchema())
+
 #define CreateConvTransposeUnaryPostOpRun(FUSED_OP)                  \
   Operator(                                                          \
       "ipex_prepack::conv_transpose_" #FUSED_OP                      \
@@ -416,6 +444,64 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::convolution_group_norm_silu_run(Tensor input, "
+        "int num_groups, Tensor? gn_weight, Tensor? gn_bias, float eps, "
+        "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = convolution_group_norm_silu_run(
+                (std::move(peek(stack, 0, 6))).toTensor(),
+                (std::move(peek(stack, 1, 6))).toInt(),
+                toOptionalTensor(std::move(peek(stack, 2, 6))),
+                toOptionalTensor(std::move(peek(stack, 3, 6))),
+                (std::move(peek(stack, 4, 6))).toDouble(),
+                (std::move(peek(stack, 5, 6)))
+                    .toCustomClass<ConvolutionOpContext>());
+            drop(stack, 6);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::convolution_upsample_nearest_prepack(" CONV_PREPACK_ARGS
+        ") -> __torch__.torch.classes.ipex_prepack.ConvolutionOpContext",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = createConvolutionUpsampleNearestPrePackOpContext(
+                std::move((std::move(peek(stack, 0, 8))).toTensor()),
+                std::move(
+                    (std::move(peek(stack, 1, 8))).toOptional<at::Tensor>()),
+                std::move((std::move(peek(stack, 2, 8))).toIntVector()),
+                std::move((std::move(peek(stack, 3, 8))).toIntVector()),
+                std::move((std::move(peek(stack, 4, 8))).toIntVector()),
+                (std::move(peek(stack, 5, 8))).toInt(),
+                (std::move(peek(stack, 6, 8))).toBool(),
+                std::move((std::move(peek(stack, 7, 8))).toIntVector()));
+            drop(stack, 8);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::convolution_upsample_nearest_run(Tensor input, "
+        "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = convolution_upsample_nearest_run(
+                (std::move(peek(stack, 0, 2))).toTensor(),
+                (std::move(peek(stack, 1, 2)))
+                    .toCustomClass<ConvolutionOpContext>());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex_prepack::convolution_pow_run(Tensor input, Scalar exponent, "
         "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext "
@@ -514,6 +600,8 @@ torch::jit::RegisterOperators op({
     CreateLinearUnaryPostOpRun(round_run),
     CreateLinearUnaryPostOpRun(sqrt_run),
     CreateLinearUnaryPostOpRun(hardsigmoid_run),
+    CreateLinearUnaryPostOpRunOut(run),
+    CreateLinearUnaryPostOpRunOut(relu_run),
 
     Operator(
         "ipex_prepack::linear_leaky_relu_run(Tensor input, Scalar alpha, "
@@ -605,6 +693,65 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::linear_eltwise_chain_run(Tensor input, "
+        "int[] algorithms, float[] alphas, float[] betas, "
+        "__torch__.torch.classes.ipex_prepack.LinearOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = linear_eltwise_chain_run(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toIntVector(),
+                (std::move(peek(stack, 2, 5))).toDoubleVector(),
+                (std::move(peek(stack, 3, 5))).toDoubleVector(),
+                (std::move(peek(stack, 4, 5)))
+                    .toCustomClass<LinearOpContext>());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::linear_gate_run(Tensor input, int activation, "
+        "__torch__.torch.classes.ipex_prepack.LinearOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = linear_gate_run(
+                (std::move(peek(stack, 0, 3))).toTensor(),
+                (std::move(peek(stack, 1, 3))).toInt(),
+                (std::move(peek(stack, 2, 3)))
+                    .toCustomClass<LinearOpContext>());
+            drop(stack, 3);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::norm_linear_run(Tensor input, Tensor? residual, "
+        "Tensor? gamma, Tensor? beta, int norm, float eps, "
+        "__torch__.torch.classes.ipex_prepack.LinearOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = norm_linear_run(
+                (std::move(peek(stack, 0, 7))).toTensor(),
+                (std::move(peek(stack, 1, 7))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 2, 7))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 3, 7))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 4, 7))).toInt(),
+                (std::move(peek(stack, 5, 7))).toDouble(),
+                (std::move(peek(stack, 6, 7)))
+                    .toCustomClass<LinearOpContext>());
+            drop(stack, 7);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex_prepack::linear_add_run(Tensor input, Tensor(a!) accumu, *, "
         "Scalar? alpha, "
@@ -1200,6 +1347,25 @@ torch::jit::RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex::bert_flash_mha_int8(Tensor qkv, Tensor rel_qk, "
+        "Scalar dim_per_head, int head_num, int head_size, float o_scale, "
+        "int o_zp, ScalarType o_dtype) -> Tensor",
+        [](Stack& stack) {
+          auto result = bert_flash_mha_int8(
+              peek(stack, 0, 8).toTensor(),
+              peek(stack, 1, 8).toTensor(),
+              peek(stack, 3, 8).toInt(),
+              peek(stack, 4, 8).toInt(),
+              peek(stack, 2, 8).toScalar().to<double>(),
+              peek(stack, 5, 8).toDouble(),
+              peek(stack, 6, 8).toInt(),
+              peek(stack, 7, 8).toScalarType());
+          drop(stack, 8);
+          torch::jit::pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::sd_flash_mha(Tensor qkv, int[] list, "
         "float ? scale, int head_num) -> Tensor",
@@ -1229,6 +1395,68 @@ torch::jit::RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex::sd_flash_mha(Tensor query, Tensor key, Tensor value, "
+        "float ? scale, int head_num, bool is_causal) -> Tensor",
+        [](Stack& stack) {
+          auto result = dil_sd_flash_mha(
+              peek(stack, 0, 6).toTensor(),
+              peek(stack, 1, 6).toTensor(),
+              peek(stack, 2, 6).toTensor(),
+              peek(stack, 3, 6),
+              peek(stack, 4, 6).toInt(),
+              peek(stack, 5, 6).toBool());
+          drop(stack, 6);
+          torch::jit::pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
+    Operator(
+        "ipex::group_norm_transpose(Tensor input, int num_groups, "
+        "Tensor? weight, Tensor? bias, float eps) -> Tensor",
+        [](Stack& stack) {
+          auto result = torch_ipex::cpu::group_norm_transpose(
+              peek(stack, 0, 5).toTensor(),
+              peek(stack, 1, 5).toInt(),
+              toOptionalTensor(peek(stack, 2, 5)),
+              toOptionalTensor(peek(stack, 3, 5)),
+              peek(stack, 4, 5).toDouble());
+          drop(stack, 5);
+          torch::jit::pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
+    Operator(
+        "ipex::group_norm_silu(Tensor input, int num_groups, "
+        "Tensor? weight, Tensor? bias, float eps) -> Tensor",
+        [](Stack& stack) {
+          auto result = torch_ipex::cpu::group_norm_silu(
+              peek(stack, 0, 5).toTensor(),
+              peek(stack, 1, 5).toInt(),
+              toOptionalTensor(peek(stack, 2, 5)),
+              toOptionalTensor(peek(stack, 3, 5)),
+              peek(stack, 4, 5).toDouble());
+          drop(stack, 5);
+          torch::jit::pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
+    Operator(
+        "ipex::group_norm_transpose(Tensor input, int num_groups, "
+        "Tensor? weight, Tensor? bias, float eps, int[] size) -> Tensor",
+        [](Stack& stack) {
+          auto result = torch_ipex::cpu::group_norm_view_transpose(
+              peek(stack, 0, 6).toTensor(),
+              peek(stack, 1, 6).toInt(),
+              toOptionalTensor(peek(stack, 2, 6)),
+              toOptionalTensor(peek(stack, 3, 6)),
+              peek(stack, 4, 6).toDouble(),
+              peek(stack, 5, 6).toIntVector());
+          drop(stack, 6);
+          torch::jit::pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::split_tensor(Tensor mat, int[] list) -> Tensor[]",
         [](Stack& stack) {
@@ -1402,6 +1630,112 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::RMSNorm_(Tensor(a!) a, Tensor b, float eps) -> Tensor(a!)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            // here the return value (Tensor) is alias of the input "a"
+            auto output = (peek(stack, 0, 3)).toTensor();
+            auto result = dil_RMSNorm_(
+                output,
+                (std::move(peek(stack, 1, 3))).toTensor(),
+                (std::move(peek(stack, 2, 3))).toDouble());
+            drop(stack, 3);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::apply_rotary_emb(Tensor x, Tensor cos, Tensor sin, int dim, "
+        "int cat_dim, int x1_end, int x2_start) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = dil_apply_rotary_emb(
+                (std::move(peek(stack, 0, 7))).toTensor(),
+                (std::move(peek(stack, 1, 7))).toTensor(),
+                (std::move(peek(stack, 2, 7))).toTensor(),
+                (std::move(peek(stack, 3, 7))).toInt(),
+                (std::move(peek(stack, 4, 7))).toInt(),
+                (std::move(peek(stack, 5, 7))).toInt(),
+                (std::move(peek(stack, 6, 7))).toInt());
+            drop(stack, 7);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::add_RMSNorm(Tensor a, Tensor b, Tensor weight, float eps) -> "
+        "(Tensor, Tensor)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = dil_add_RMSNorm(
+                (std::move(peek(stack, 0, 4))).toTensor(),
+                (std::move(peek(stack, 1, 4))).toTensor(),
+                (std::move(peek(stack, 2, 4))).toTensor(),
+                (std::move(peek(stack, 3, 4))).toDouble());
+            drop(stack, 4);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::qlayer_norm(Tensor input, int[] normalized_shape, Tensor? "
+        "weight, Tensor? bias, float eps, float o_scale, int o_zp, "
+        "ScalarType o_dtype) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = qlayer_norm(
+                (std::move(peek(stack, 0, 8))).toTensor(),
+                (std::move(peek(stack, 1, 8))).toIntVector(),
+                (std::move(peek(stack, 2, 8))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 3, 8))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 4, 8))).toDouble(),
+                (std::move(peek(stack, 5, 8))).toDouble(),
+                (std::move(peek(stack, 6, 8))).toInt(),
+                (std::move(peek(stack, 7, 8))).toScalarType());
+            drop(stack, 8);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::qsoftmax(Tensor input, int dim, float o_scale, int o_zp, "
+        "ScalarType o_dtype) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = qsoftmax(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toInt(),
+                (std::move(peek(stack, 2, 5))).toDouble(),
+                (std::move(peek(stack, 3, 5))).toInt(),
+                (std::move(peek(stack, 4, 5))).toScalarType());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::qgelu(Tensor input, str approximate, float o_scale, int o_zp, "
+        "ScalarType o_dtype) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = qgelu(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toStringRef(),
+                (std::move(peek(stack, 2, 5))).toDouble(),
+                (std::move(peek(stack, 3, 5))).toInt(),
+                (std::move(peek(stack, 4, 5))).toScalarType());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex::add_layernorm(Tensor a, Tensor b, int alpha, int[] "
         "normalized_shape, Tensor ? "
@@ -1425,25 +1759,69 @@ torch::jit::RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
     Operator(
-        "ipex::concat_bn_relu(Tensor[] a, Tensor bn_scale, Tensor bn_beta, "
-        "Tensor? weight, Tensor? bias, Tensor? running_mean, Tensor? running_var, bool training, float momentum, float eps, bool cudnn_enabled, int dim) -> "
-        "Tensor",
+        "ipex::add_layernorm_(Tensor(a!) a, Tensor b, int alpha, int[] "
+        "normalized_shape, Tensor ? weight_opt, Tensor ? bias_opt, float eps, "
+        "bool cuda_enable) -> Tensor(a!)",
         [](const Node* node) -> Operation {
           return [](Stack* stack) {
-            auto result = ConcatBnRelu(
-                (std::move(peek(stack, 0, 12))).toTensorList(),
-                (std::move(peek(stack, 1, 12))).toTensor(),
-                (std::move(peek(stack, 2, 12))).toTensor(),
-                toOptionalTensor(std::move(peek(stack, 3, 12))),
-                toOptionalTensor(std::move(peek(stack, 4, 12))),
-                toOptionalTensor(std::move(peek(stack, 5, 12))),
-                toOptionalTensor(std::move(peek(stack, 6, 12))),
-                (std::move(peek(stack, 7, 12))).toBool(),
-                (std::move(peek(stack, 8, 12))).toDouble(),
-                (std::move(peek(stack, 9, 12))).toDouble(),
-                (std::move(peek(stack, 10, 12))).toBool(),
-                (std::move(peek(stack, 11, 12))).toInt());
-            drop(stack, 12);
+            // here the return value (Tensor) is alias of the input "a"
+            auto output = (peek(stack, 0, 8)).toTensor();
+            auto result = dil_add_layernorm_(
+                output,
+                (std::move(peek(stack, 1, 8))).toTensor(),
+                (std::move(peek(stack, 2, 8))).toInt(),
+                (std::move(peek(stack, 3, 8))).toIntVector(),
+                toOptionalTensor(std::move(peek(stack, 4, 8))),
+                toOptionalTensor(std::move(peek(stack, 5, 8))),
+                (std::move(peek(stack, 6, 8))).toDouble(),
+                (std::move(peek(stack, 7, 8))).toBool());
+            drop(stack, 8);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::concat_bn_eltwise(Tensor[] a, Tensor bn_scale, Tensor bn_beta, "
+        "int dim, str eltwise) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = concat_bn_eltwise(
+                (std::move(peek(stack, 0, 5))).toTensorList(),
+                (std::move(peek(stack, 1, 5))).toTensor(),
+                (std::move(peek(stack, 2, 5))).toTensor(),
+                (std::move(peek(stack, 3, 5))).toInt(),
+                (std::move(peek(stack, 4, 5))).toStringView());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::add_eltwise_mul(Tensor a, Tensor? b, Tensor? c, str eltwise) "
+        "-> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = add_eltwise_mul(
+                (std::move(peek(stack, 0, 4))).toTensor(),
+                (std::move(peek(stack, 1, 4))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 2, 4))).toOptional<at::Tensor>(),
+                (std::move(peek(stack, 3, 4))).toStringView());
+            drop(stack, 4);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::pool_cat(Tensor[] inputs, int[] pool_params) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = pool_cat(
+                (std::move(peek(stack, 0, 2))).toTensorList(),
+                (std::move(peek(stack, 1, 2))).toIntVector());
+            drop(stack, 2);
             torch::jit::pack(stack, std::move(result));
             return 0;
           };
@@ -1494,6 +1872,19 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::einsum_contract(str equation, Tensor[] tensors) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = einsum_contract(
+                (std::move(peek(stack, 0, 2))).toStringView(),
+                (std::move(peek(stack, 1, 2))).toTensorList());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex::max_pool2d(Tensor input, int[2] kernel_size, int[2] stride, "
         "int[2] padding, int[2] dilation, bool ceil_mode) -> Tensor",
@@ -1512,6 +1903,50 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::memory_arena(int nbytes) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result =
+                memory_arena((std::move(peek(stack, 0, 1))).toInt());
+            drop(stack, 1);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::arena_slice(Tensor(a) arena, int offset, int[] sizes, "
+        "int[] strides, ScalarType dtype) -> Tensor(a)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = arena_slice(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toInt(),
+                (std::move(peek(stack, 2, 5))).toIntVector(),
+                (std::move(peek(stack, 3, 5))).toIntVector(),
+                (std::move(peek(stack, 4, 5))).toScalarType());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::cat_views(Tensor(a) buffer, Tensor[] outputs, int dim) -> "
+        "Tensor(a)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = cat_views(
+                (std::move(peek(stack, 0, 3))).toTensor(),
+                (std::move(peek(stack, 1, 3))).toTensorVector(),
+                (std::move(peek(stack, 2, 3))).toInt());
+            drop(stack, 3);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 });
 
 } // namespace jit
@@ -161,6 +161,15 @@ bool is_channelslast(c10::TensorType tensor) {
       c10::is_channels_last_strides_3d(sizes, strides));
 }
 
+bool has_channelslast_type(const torch::jit::Value* value) {
+  auto type = value->type()->cast<c10::TensorType>();
+  if (!type || !type->sizes().concrete_sizes().has_value() ||
+      !type->strides().concrete_sizes().has_value()) {
+    return false;
+  }
+  return is_channelslast(*type);
+}
+
 // Check if the memory format of the tensor is Contiguous
 bool is_contiguous(c10::TensorTypePtr tensor) {
   if (!tensor->sizes().concrete_sizes().has_value()) {
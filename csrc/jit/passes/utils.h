@@ -28,6 +28,8 @@ supported_non_unary_post_op_fusion_set();
 
 // Check if the memory format of the tensor is ChannelsLast(3d)
 bool is_channelslast(c10::TensorType tensor);
+// Check if the value is a tensor whose complete type is ChannelsLast(3d)
+bool has_channelslast_type(const torch::jit::Value* value);
 // Check if the memory format of the tensor is Contiguous
 bool is_contiguous(c10::TensorTypePtr tensor);
 // Check if the target IValue is a scalar or a 0-dim scalar tensor
@@ -0,0 +1,34 @@
+#include <intel_extension_for_pytorch/runtime/InferenceSession.h>
+#include <torch/script.h>
+#include <iostream>
+#include <memory>
+
+int main(int argc, const char* argv[]) {
+  torch_ipex::runtime::InferenceOptions options;
+  // warm up the shape served, so that the first request runs the optimized
+  // graph
+  options.warmup_inputs = {{torch::rand({1, 3, 224, 224})}};
+  // 2 streams on half of the cores each, which needs IOMP to be preloaded
+  options.num_streams = torch_ipex::runtime::is_runtime_ext_enabled() ? 2 : 1;
+
+  std::unique_ptr<torch_ipex::runtime::InferenceSession> session;
+  try {
+    session = std::make_unique<torch_ipex::runtime::InferenceSession>(
+        argv[1], options);
+  } catch (const c10::Error& e) {
+    std::cerr << "error loading the model\n" << e.what();
+    return -1;
+  }
+
+  std::vector<c10::intrusive_ptr<c10::ivalue::Future>> requests;
+  for (int i = 0; i < 4; i++) {
+    requests.push_back(session->submit({torch::rand({1, 3, 224, 224})}));
+  }
+  for (auto& request : requests) {
+    request->waitAndThrow();
+    at::Tensor output = request->value().toTensor();
+    std::cout << output.slice(/*dim=*/1, /*start=*/0, /*end=*/5) << std::endl;
+  }
+
+  return 0;
+}
@@ -32,8 +32,16 @@ from . import tpp
 
 
 from .utils.verbose import verbose
+from .utils.op_stats import op_stats
+from .utils.parallel_stats import parallel_stats
+from .utils.memory_profiler import memory_profiler
+from .utils.checkpoint import save_checkpoint, load_checkpoint
+from .utils import perf_baseline
 from .frontend import optimize, compile, enable_auto_channels_last, disable_auto_channels_last, enable_onednn_fusion, set_fp32_math_mode, get_fp32_math_mode, FP32MathMode, fast_bert
-from .cpu._auto_kernel_selection import _enable_dnnl, _disable_dnnl, _using_dnnl
+from .cpu._auto_kernel_selection import _enable_dnnl, _disable_dnnl, _using_dnnl, _get_kernel_selection_table, \
+    _save_kernel_selection_table, _load_kernel_selection_table, _reset_kernel_selection
+from .cpu.hypertune.knobs import apply_knobs as _apply_hypertune_knobs
+_apply_hypertune_knobs()
 
 # for xpu
 import intel_extension_for_pytorch.xpu
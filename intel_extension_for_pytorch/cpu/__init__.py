@@ -1,3 +1,5 @@
 from . import runtime
 from . import autocast
 from . import auto_ipex
+from . import dispatch
+from . import comm
@@ -1,3 +1,7 @@
+import json
+
+import intel_extension_for_pytorch._C as core
+
 _use_dnnl = False
 
 def _enable_dnnl():
@@ -10,4 +14,41 @@ def _disable_dnnl():
 
 def _using_dnnl():
     global _use_dnnl
-    return _use_dnnl
\ No newline at end of file
+    return _use_dnnl
+
+# The runtime kernel selection of the fp32 linear of the MKL contexts: the first ``trials`` runs of each
+# of the MKL packed, MKL and oneDNN kernels are timed for each new (M, N, K, threads) and the fastest one
+# is locked in for it. The table of the locked in kernels maps the keys "linear_mkl:M,N,K:threads" to the
+# kernels (0 for MKL packed, 1 for MKL and 2 for oneDNN), and may be saved by a tuning run and loaded by
+# the deployments on the same machine, so that they run the tuned kernels without timing them again.
+
+def _enable_runtime_kernel_selection(trials=None):
+    if trials is not None:
+        assert trials >= 1, "the runtime kernel selection needs at least one trial"
+        core._set_kernel_selection_trials(trials)
+    core._set_kernel_selection_enabled(True)
+
+def _disable_runtime_kernel_selection():
+    core._set_kernel_selection_enabled(False)
+
+def _using_runtime_kernel_selection():
+    return core._is_kernel_selection_enabled()
+
+def _get_kernel_selection_table():
+    return dict(core._get_kernel_selection_table())
+
+def _save_kernel_selection_table(path):
+    with open(path, 'w') as f:
+        json.dump(_get_kernel_selection_table(), f, indent=2, sort_keys=True)
+
+def _load_kernel_selection_table(table):
+    r"""
+    Locks in the kernels of ``table``, a dict of the keys to the kernels or the path of a saved table.
+    """
+    if not isinstance(table, dict):
+        with open(table) as f:
+            table = json.load(f)
+    core._load_kernel_selection_table([(str(k), int(v)) for k, v in table.items()])
+
+def _reset_kernel_selection():
+    core._reset_kernel_selection()
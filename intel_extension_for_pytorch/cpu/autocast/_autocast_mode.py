@@ -99,8 +99,13 @@ class _autocast(autocast_cpu):
 
     def __exit__(self, *args):
         # Drop the cache when we exit to a nesting level that's outside any instance of autocast.
+        # The persistent cache keeps the casts of the live weights for the next iterations, a
+        # cast being redone when its weight was written since.
         if torch.autocast_decrement_nesting() == 0:
-            core.clear_autocast_cache()
+            if core.is_autocast_cache_persistent():
+                core.prune_autocast_cache()
+            else:
+                core.clear_autocast_cache()
             torch.clear_autocast_cache()
         torch.set_autocast_cpu_enabled(self.prev)
         core.set_autocast_dtype(self.prev_fast_dtype)
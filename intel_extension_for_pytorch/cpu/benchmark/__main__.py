@@ -0,0 +1,116 @@
+from argparse import ArgumentParser
+import json
+import os
+import platform
+import resource
+import time
+import torch
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.cpu.runtime.multi_stream import _MultiStreamBenchmarkModule
+from intel_extension_for_pytorch.cpu.hypertune.knobs import get_num_streams
+from .models import MODELS, DEFAULT_SEQ_LEN
+
+r"""
+The end to end benchmark of the reference models: the model is optimized by ipex.optimize at the given precision,
+traced and frozen, then run ``--num-streams`` instances in the process on the same input, each on its own cores, as
+_MultiStreamBenchmarkModule does. The throughput, the p50/p90/p99 latencies of an iteration and the peak resident
+memory are reported as JSON. Several processes are run with the launcher, each writing its own report, e.g.
+
+    ipexrun --ninstances 4 -m intel_extension_for_pytorch.cpu.benchmark --model resnet50 --output resnet50_{pid}.json
+
+Under ``ipexrun --calibrate``, the batch size is the one of the calibration run and the p50 latency is printed for
+the launcher.
+"""
+
+def percentile(sorted_values, p):
+    # the nearest rank percentile
+    return sorted_values[min(len(sorted_values) - 1, max(0, int(round(p / 100. * len(sorted_values))) - 1))]
+
+def optimize(model, inputs, precision, jit):
+    if precision == 'int8':
+        from intel_extension_for_pytorch.quantization import prepare, convert
+        prepared = prepare(model, ipex.quantization.default_static_qconfig, example_inputs=inputs, inplace=False)
+        with torch.no_grad():
+            prepared(*inputs)
+        model = convert(prepared)
+        dtype = None
+    else:
+        dtype = {'fp32': None, 'bf16': torch.bfloat16, 'fp16': torch.half}[precision]
+        model = ipex.optimize(model, dtype=dtype)
+    if jit:
+        with torch.no_grad(), torch.cpu.amp.autocast(enabled=dtype is not None, dtype=dtype):
+            model = torch.jit.freeze(torch.jit.trace(model, inputs, check_trace=False, strict=False))
+    return model, dtype
+
+def run(args):
+    torch.manual_seed(0)
+    if 'IPEX_CALIBRATION_BATCH_SIZE' in os.environ:
+        args.batch_size = int(os.environ['IPEX_CALIBRATION_BATCH_SIZE'])
+    seq_len = args.seq_len or DEFAULT_SEQ_LEN.get(args.model, 0)
+    model, inputs = MODELS[args.model](args.batch_size, seq_len)
+    model, dtype = optimize(model, inputs, args.precision, args.jit)
+    if args.num_streams > 1:
+        model = _MultiStreamBenchmarkModule(model, num_streams=args.num_streams)
+
+    latencies = []
+    with torch.no_grad(), torch.cpu.amp.autocast(enabled=dtype is not None, dtype=dtype):
+        for i in range(args.warmup + args.iterations):
+            start = time.perf_counter()
+            model(*inputs)
+            if i >= args.warmup:
+                latencies.append((time.perf_counter() - start) * 1e3)
+
+    latencies.sort()
+    total_s = sum(latencies) / 1e3
+    return {
+        'model': args.model,
+        'precision': args.precision,
+        'batch_size': args.batch_size,
+        'seq_len': seq_len,
+        'num_streams': args.num_streams,
+        'threads': torch.get_num_threads(),
+        'jit': args.jit,
+        'iterations': args.iterations,
+        # each iteration runs a batch on each stream
+        'throughput': args.iterations * args.batch_size * args.num_streams / total_s,
+        'p50_ms': percentile(latencies, 50),
+        'p90_ms': percentile(latencies, 90),
+        'p99_ms': percentile(latencies, 99),
+        # ru_maxrss is in KB on Linux
+        'peak_rss_mb': resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.,
+        'torch': torch.__version__,
+        'ipex': ipex.__version__,
+        'isa': ipex._C._get_current_isa_level(),
+        'host': platform.node(),
+    }
+
+def parse_args():
+    parser = ArgumentParser(description='End to end benchmark of the reference models')
+    parser.add_argument('--model', choices=sorted(MODELS.keys()), required=True)
+    parser.add_argument('--precision', choices=['fp32', 'bf16', 'fp16', 'int8'], default='fp32')
+    parser.add_argument('--batch-size', '--batch_size', type=int, default=1)
+    parser.add_argument('--seq-len', '--seq_len', type=int, default=0,
+                        help='the sequence length of bert-large, rnnt and llm, their own default if 0')
+    parser.add_argument('--num-streams', '--num_streams', type=int, default=get_num_streams(1),
+                        help='the instances run in the process, which needs the runtime extension if > 1, '
+                             'the one of the hypertune trial by default')
+    parser.add_argument('--warmup', type=int, default=20)
+    parser.add_argument('--iterations', type=int, default=200)
+    parser.add_argument('--no-jit', '--no_jit', dest='jit', action='store_false',
+                        help='run the model in eager mode instead of tracing and freezing it')
+    parser.add_argument('--output', default='', help='the JSON report, {pid} being replaced by the process id for the instances of the launcher')
+    return parser.parse_args()
+
+def main():
+    args = parse_args()
+    report = run(args)
+    print(json.dumps(report, indent=2))
+    if 'IPEX_CALIBRATION_BATCH_SIZE' in os.environ:
+        print("@hypertune {'name': 'latency'}")
+        print(report['p50_ms'])
+    if args.output and 'IPEX_CALIBRATION_RUN' not in os.environ:
+        with open(args.output.format(pid=os.getpid()), 'w') as f:
+            json.dump(report, f, indent=2)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,92 @@
+import torch
+import torch.nn as nn
+import intel_extension_for_pytorch as ipex
+
+r"""
+The reference models of the benchmark, with random weights so that nothing is downloaded. Each builder takes the
+batch size and the sequence length (ignored by the models without one) and returns the model in eval mode and an
+example input tuple.
+"""
+
+def resnet50(batch_size, seq_len):
+    import torchvision
+    model = torchvision.models.resnet50().eval()
+    x = torch.randn(batch_size, 3, 224, 224).contiguous(memory_format=torch.channels_last)
+    return model.to(memory_format=torch.channels_last), (x,)
+
+def bert_large(batch_size, seq_len):
+    import transformers
+    config = transformers.BertConfig(hidden_size=1024, num_hidden_layers=24, num_attention_heads=16,
+                                     intermediate_size=4096, torchscript=True)
+    model = transformers.BertModel(config).eval()
+    input_ids = torch.randint(config.vocab_size, (batch_size, seq_len))
+    attention_mask = torch.ones(batch_size, seq_len, dtype=torch.int64)
+    return model, (input_ids, attention_mask)
+
+class _DLRM(nn.Module):
+    # the MLPerf DLRM on Criteo Terabyte, with smaller tables
+    def __init__(self, num_tables=26, num_rows=100000, dim=128):
+        super(_DLRM, self).__init__()
+        self.bot_mlp = nn.Sequential(nn.Linear(13, 512), nn.ReLU(), nn.Linear(512, 256), nn.ReLU(),
+                                     nn.Linear(256, dim), nn.ReLU())
+        self.embs = nn.ModuleList([nn.EmbeddingBag(num_rows, dim, mode='sum') for _ in range(num_tables)])
+        num_features = num_tables + 1
+        self.top_mlp = nn.Sequential(nn.Linear(dim + num_features * (num_features - 1) // 2, 1024), nn.ReLU(),
+                                     nn.Linear(1024, 1024), nn.ReLU(), nn.Linear(1024, 512), nn.ReLU(),
+                                     nn.Linear(512, 256), nn.ReLU(), nn.Linear(256, 1))
+
+    def forward(self, dense, indices, offsets):
+        x = self.bot_mlp(dense)
+        ly = [emb(indices[i], offsets[i]) for i, emb in enumerate(self.embs)]
+        return torch.sigmoid(self.top_mlp(ipex.nn.functional.interaction(x, *ly)))
+
+def dlrm(batch_size, seq_len):
+    model = _DLRM().eval()
+    dense = torch.randn(batch_size, 13)
+    indices = torch.randint(100000, (26, batch_size))
+    offsets = torch.arange(batch_size).expand(26, batch_size).contiguous()
+    return model, (dense, indices, offsets)
+
+class _RNNT(nn.Module):
+    # the MLPerf RNN-T encoder, prediction and joint networks, one step of the greedy decoding per frame
+    def __init__(self, num_features=240, hidden=1024, vocab=29):
+        super(_RNNT, self).__init__()
+        self.encoder = nn.LSTM(num_features, hidden, num_layers=5)
+        self.embed = nn.Embedding(vocab, 320)
+        self.prediction = nn.LSTM(320, 320, num_layers=2)
+        self.joint = nn.Sequential(nn.Linear(hidden + 320, 512), nn.ReLU(), nn.Linear(512, vocab))
+
+    def forward(self, x, labels):
+        f, _ = self.encoder(x)
+        g, _ = self.prediction(self.embed(labels))
+        return self.joint(torch.cat([f, g.expand(f.size(0), -1, -1)], -1))
+
+def rnnt(batch_size, seq_len):
+    model = _RNNT().eval()
+    x = torch.randn(seq_len, batch_size, 240)
+    labels = torch.zeros(1, batch_size, dtype=torch.int64)
+    return model, (x, labels)
+
+def llm(batch_size, seq_len):
+    # the first token latency of a 1.3B decoder of the OPT shape
+    import transformers
+    config = transformers.OPTConfig(hidden_size=2048, num_hidden_layers=24, num_attention_heads=32,
+                                    ffn_dim=8192, torchscript=True, use_cache=False)
+    model = transformers.OPTForCausalLM(config).eval()
+    input_ids = torch.randint(config.vocab_size, (batch_size, seq_len))
+    return model, (input_ids,)
+
+MODELS = {
+    'resnet50': resnet50,
+    'bert-large': bert_large,
+    'dlrm': dlrm,
+    'rnnt': rnnt,
+    'llm': llm,
+}
+
+# the sequence lengths of the models with one
+DEFAULT_SEQ_LEN = {
+    'bert-large': 384,
+    'rnnt': 500,
+    'llm': 32,
+}
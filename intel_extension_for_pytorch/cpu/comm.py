@@ -0,0 +1,92 @@
+import os
+import socket
+
+import torch
+import intel_extension_for_pytorch._C as core
+
+# the global ranks of the group of init_shm_allreduce, whose allreduces only go through the shared memory
+_shm_group_ranks = None
+
+def _group_ranks(group):
+    import torch.distributed as dist
+    if group is None or group is dist.group.WORLD:
+        return list(range(dist.get_world_size()))
+    return sorted(dist.get_process_group_ranks(group))
+
+def init_shm_allreduce(group=None):
+    r"""
+    Enables the shared memory allreduce of the ranks of ``group`` (the default process group if None), which must
+    all run on this host, e.g. a rank per socket of tensor parallel inference.
+
+    The ranks sum their tensors through a POSIX shared memory segment (``/dev/shm``) instead of oneCCL / gloo: each
+    rank copies its tensor into its buffer of the segment and spins on the flags of the other ranks, then sums the
+    buffers with vectorized fp32 / bf16 kernels. This saves the latency of the library for the small allreduces of
+    every decode step. Once enabled, the allreduces of ``_IPEXLinearAllreduce``, ``DynamicQuantizedLinearAllreduce``
+    and of the ``perform_allreduce`` of the TPP ``DistLamb`` optimizer go through :func:`all_reduce`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        import intel_extension_for_pytorch as ipex
+        torch.distributed.init_process_group(backend='ccl')
+        ipex.cpu.comm.init_shm_allreduce()
+        x = torch.ones(16)
+        ipex.cpu.comm.all_reduce(x)
+
+    The shared memory allreduce only sums over the ranks of ``group``: the allreduces of another group, e.g. of the
+    default group once it is enabled for a node-local tensor parallel group, still go through ``torch.distributed``.
+
+    Args:
+        group (ProcessGroup): The process group of the ranks, called by all its ranks.
+    """
+    import torch.distributed as dist
+    global _shm_group_ranks
+    rank = dist.get_rank(group)
+    world_size = dist.get_world_size(group)
+    hosts = [None] * world_size
+    dist.all_gather_object(hosts, socket.gethostname(), group=group)
+    if len(set(hosts)) != 1:
+        raise RuntimeError("init_shm_allreduce: the ranks run on several hosts {}".format(sorted(set(hosts))))
+    # the name of the segment, unique to the group of rank 0
+    names = ["ipex_shm_allreduce_{}_{}".format(os.getpid(), id(group))]
+    dist.broadcast_object_list(names, src=dist.get_global_rank(group, 0) if group is not None else 0, group=group)
+    name = names[0]
+    if rank == 0:
+        core._shm_all_reduce_unlink(name)
+    dist.barrier(group)
+    core._shm_all_reduce_init(name, rank, world_size)
+    dist.barrier(group)
+    # the mappings of the ranks stay valid, the segment being freed by the exit of the last rank
+    if rank == 0:
+        core._shm_all_reduce_unlink(name)
+    _shm_group_ranks = _group_ranks(group)
+
+def is_shm_allreduce_initialized():
+    r"""
+    Returns whether :func:`init_shm_allreduce` has been called.
+    """
+    return core._is_shm_all_reduce_initialized()
+
+def is_shm_allreduce_group(group=None):
+    r"""
+    Returns whether the allreduces of ``group`` (the default process group if None) go through the shared memory,
+    i.e. :func:`init_shm_allreduce` has been called for a group of the same ranks.
+    """
+    return is_shm_allreduce_initialized() and _shm_group_ranks is not None and \
+        _shm_group_ranks == _group_ranks(group)
+
+def all_reduce(tensor, group=None):
+    r"""
+    Sums the tensor over the ranks of ``group`` in place, through the shared memory allreduce of
+    :func:`init_shm_allreduce` for the contiguous fp32 and bf16 tensors when it is enabled for the ranks of ``group``,
+    and through ``torch.distributed.all_reduce`` otherwise.
+
+    Args:
+        tensor (torch.Tensor): The tensor to sum.
+        group (ProcessGroup): The process group of the ranks, the default process group if None.
+    """
+    if tensor.is_contiguous() and tensor.dtype in (torch.float, torch.bfloat16) and is_shm_allreduce_group(group):
+        return torch.ops.torch_ipex.shm_all_reduce_(tensor)
+    import torch.distributed as dist
+    dist.all_reduce(tensor, group=group)
+    return tensor
@@ -0,0 +1,175 @@
+import time
+import contextlib
+import intel_extension_for_pytorch as ipex
+
+r"""
+Per kernel ISA selection. Every kernel of Intel® Extension for PyTorch* with
+versions for several ISA levels is dispatched by a stub, which runs the
+version of the highest ISA level supported by the CPU (or the one set by
+ATEN_CPU_CAPABILITY) by default. A stub can be set to the version of another
+ISA level apart from the others, e.g. AVX512 for a kernel whose AMX version
+is slower on the shapes of a model. The environment variable
+IPEX_DISPATCH_STUB_ISA sets them at load time, e.g.
+IPEX_DISPATCH_STUB_ISA="merged_embeddingbag_forward_cpu_kernel_stub=avx512".
+"""
+
+def list_stubs():
+    r"""
+    Returns the names of the kernel dispatch stubs.
+    """
+    return ipex._C._get_dispatch_stub_names()
+
+def get_stub_isa_levels(stub):
+    r"""
+    Returns the ISA levels, e.g. ``["default", "avx2", "avx512"]``, the stub
+    has a kernel of, up to the ones the CPU and the binary support.
+
+    Args:
+        stub (str): The name of the stub.
+    """
+    return [isa.lower() for isa in ipex._C._get_dispatch_stub_isa_levels(stub)]
+
+def get_stub_isa_level(stub):
+    r"""
+    Returns the ISA level the stub dispatches to.
+
+    Args:
+        stub (str): The name of the stub.
+    """
+    return ipex._C._get_dispatch_stub_isa_level(stub).lower()
+
+def get_stub_binary_isa_levels(stub):
+    r"""
+    Returns the ISA levels the binary has a kernel of the stub for, whatever
+    the CPU.
+
+    Args:
+        stub (str): The name of the stub.
+    """
+    return [isa.lower() for isa in ipex._C._get_dispatch_stub_binary_isa_levels(stub)]
+
+def get_stub_kernel_isa_level(stub):
+    r"""
+    Returns the ISA level of the kernel the stub runs. It is below
+    ``get_stub_isa_level(stub)`` when the stub has no kernel of that level and
+    falls back to its AVX2 kernel.
+
+    Args:
+        stub (str): The name of the stub.
+    """
+    return ipex._C._get_dispatch_stub_kernel_isa_level(stub).lower()
+
+def coverage_report():
+    r"""
+    Returns the kernel coverage of the binary on this CPU, to find the
+    kernels missing a build for the ISA level of the CPU, e.g. the ones
+    running their AVX2 kernel on an AMX machine.
+
+    Returns:
+        A list of dicts, one per stub, of its ``name``, the ``binary`` ISA
+        levels it has a kernel of, the ``isa`` level it dispatches to, the
+        ``kernel`` ISA level it actually runs and whether that kernel is
+        ``missing``.
+
+    Examples:
+
+        >>> [r['name'] for r in ipex.cpu.dispatch.coverage_report() if r['missing']]
+        []
+    """
+    report = []
+    for stub in list_stubs():
+        isa = get_stub_isa_level(stub)
+        kernel = get_stub_kernel_isa_level(stub)
+        report.append({
+            'name': stub,
+            'binary': get_stub_binary_isa_levels(stub),
+            'isa': isa,
+            'kernel': kernel,
+            'missing': kernel != isa,
+        })
+    return report
+
+def print_coverage_report():
+    r"""
+    Prints the kernel coverage of the binary on this CPU, one line per stub.
+    """
+    print(ipex._C._get_dispatch_stub_coverage_report(), end='')
+
+def set_stub_isa_level(stub, isa):
+    r"""
+    Dispatches the stub to its kernel of the ISA level ``isa`` from the next
+    call on. The other stubs keep their ISA level. Don't change it while the
+    stub is called by other threads.
+
+    Args:
+        stub (str): The name of the stub.
+        isa (str): One of ``get_stub_isa_levels(stub)``.
+    """
+    ipex._C._set_dispatch_stub_isa_level(stub, isa.lower())
+
+def reset_stub_isa_level(stub):
+    r"""
+    Dispatches the stub to the ISA level of the other stubs again.
+
+    Args:
+        stub (str): The name of the stub.
+    """
+    ipex._C._reset_dispatch_stub_isa_level(stub)
+
+@contextlib.contextmanager
+def stub_isa_level(stub, isa):
+    r"""
+    Context manager dispatching the stub to its kernel of the ISA level
+    ``isa`` inside the scope.
+
+    Args:
+        stub (str): The name of the stub.
+        isa (str): One of ``get_stub_isa_levels(stub)``.
+
+    Examples:
+
+        >>> with ipex.cpu.dispatch.stub_isa_level("merged_embeddingbag_forward_cpu_kernel_stub", "avx512"):
+        >>>     y = model(x)
+    """
+    previous = get_stub_isa_level(stub) if ipex._C._is_dispatch_stub_isa_level_set(stub) else None
+    set_stub_isa_level(stub, isa)
+    try:
+        yield
+    finally:
+        if previous is None:
+            reset_stub_isa_level(stub)
+        else:
+            set_stub_isa_level(stub, previous)
+
+def benchmark_stub(stub, fn, *args, warmup=10, iters=100, **kwargs):
+    r"""
+    Times ``fn(*args, **kwargs)`` with the stub dispatched to each of its ISA
+    levels, for A/B comparison of the kernels of a stub on the inputs of a
+    model, e.g. to find the shapes the AMX kernel is slower for.
+
+    Args:
+        stub (str): The name of the stub.
+        fn (callable): The function calling the stub, e.g. the op or the
+            module it dispatches from.
+        warmup (int): The calls before timing, for each ISA level.
+        iters (int): The timed calls, for each ISA level.
+
+    Returns:
+        A dict of the ISA levels to the average time of a call in ms.
+
+    Examples:
+
+        >>> emb = ipex.nn.modules.MergedEmbeddingBag.from_embeddingbag_list(embs)
+        >>> ipex.cpu.dispatch.benchmark_stub("merged_embeddingbag_forward_cpu_kernel_stub", emb, inputs)
+        {'default': 1.92, 'avx2': 0.61, 'avx512': 0.35, 'amx': 0.42}
+    """
+    times = {}
+    for isa in get_stub_isa_levels(stub):
+        with stub_isa_level(stub, isa):
+            for _ in range(warmup):
+                fn(*args, **kwargs)
+            start = time.perf_counter()
+            for _ in range(iters):
+                fn(*args, **kwargs)
+            times[isa] = (time.perf_counter() - start) * 1000 / iters
+    return times
@@ -10,7 +10,7 @@ from ..strategy import STRATEGIES
 from intel_extension_for_pytorch.cpu.launch import CPUPoolList
 
 #### tuning ####
-tuning_default = {'strategy': 'grid','max_trials': 100}
+tuning_default = {'strategy': 'grid','max_trials': 100, 'early_stopping': 0}
 
 def _valid_strategy(data):
     data = data.lower()
@@ -19,7 +19,9 @@ def _valid_strategy(data):
 
 tuning_schema = Schema({
                         Optional('strategy', default='grid'): And(str, Use(_valid_strategy)),
-                        Optional('max_trials', default=100): int
+                        Optional('max_trials', default=100): int,
+                        # stop after early_stopping trials in a row without a better configuration, 0 to disable
+                        Optional('early_stopping', default=0): And(int, lambda s: s >= 0)
                         })
 
 ### output_dir ###
@@ -97,9 +99,43 @@ launcher_schema = Schema({
                           Optional('malloc', default=['pt', 'tc', 'je']): And(list, lambda s: all(isinstance(i, str) for i in s))
                           })
 
+#### ipex ####
+
+# default values if not tuning, None keeps the IPEX default
+ipex_hyperparam_default_val = {'llga': [None],
+                               'fp32_math_mode': [None],
+                               'use_mkl_sgemm': [None],
+                               'auto_channels_last': [None],
+                               'weight_cache': [None],
+                               'num_streams': [None]
+                               }
+
+# default search spaces if not user-specified
+ipex_hyperparam_default_search_space = {'hp': ['llga', 'fp32_math_mode', 'use_mkl_sgemm', 'auto_channels_last', 'weight_cache', 'num_streams'],
+                                        'llga': [True, False],
+                                        'fp32_math_mode': ['fp32', 'bf32'],
+                                        'use_mkl_sgemm': [True, False],
+                                        'auto_channels_last': [True, False],
+                                        'weight_cache': [True, False],
+                                        'num_streams': [1, 2, 4]
+                                        }
+
+ipex_schema = Schema({
+                      'hp': And(list, lambda s: all(isinstance(i, str) for i in s)),
+                      Optional('llga', default=[True, False]): And(list, lambda s: all(isinstance(i, bool) for i in s)),
+                      Optional('fp32_math_mode', default=['fp32', 'bf32']): And(list, lambda s: all(i in ['fp32', 'tf32', 'bf32'] for i in s)),
+                      Optional('use_mkl_sgemm', default=[True, False]): And(list, lambda s: all(isinstance(i, bool) for i in s)),
+                      Optional('auto_channels_last', default=[True, False]): And(list, lambda s: all(isinstance(i, bool) for i in s)),
+                      Optional('weight_cache', default=[True, False]): And(list, lambda s: all(isinstance(i, bool) for i in s)),
+                      Optional('num_streams', default=[1, 2, 4]): And(list, lambda s: all(isinstance(i, int) and i >= 1 for i in s))
+                      })
+
 hyperparams_default = {'launcher': launcher_hyperparam_default_search_space}
+hyperparams_search_space = {'launcher': launcher_hyperparam_default_search_space,
+                            'ipex': ipex_hyperparam_default_search_space}
 hyperparams_schema = Schema({
                             Optional('launcher'): launcher_schema,
+                            Optional('ipex'): ipex_schema,
                             })
 
 schema = Schema({
@@ -136,13 +172,17 @@ class Conf(object):
             raise RuntimeError('The yaml file format is not correct. Please refer to document.')
 
     def _convert_conf(self, src, dst):
-        hyperparam_default_val = {'launcher': launcher_hyperparam_default_val}
+        hyperparam_default_val = {'launcher': launcher_hyperparam_default_val, 'ipex': ipex_hyperparam_default_val}
 
         for k in dst:
             if k == 'hyperparams':
+                # the groups which are not tuned by default, e.g. {ipex}
+                for tune_x in src['hyperparams']:
+                    if tune_x not in dst['hyperparams']:
+                        dst['hyperparams'][tune_x] = hyperparams_schema.validate({tune_x: copy.deepcopy(hyperparams_search_space[tune_x])})[tune_x]
                 dst_hps = set(dst['hyperparams'])
                 for tune_x in dst_hps:
-                    # case 1: tune {launcher}
+                    # case 1: tune {launcher, ipex}
                     if tune_x in src['hyperparams']:
                         for hp in dst['hyperparams'][tune_x]['hp']:
                             # case 1.1: not tune hp, use hp default val
@@ -151,7 +191,7 @@ class Conf(object):
                             # case 1.2: tune hp, use default or user defined search space
                             else:
                               dst['hyperparams'][tune_x][hp] = src['hyperparams'][tune_x][hp]
-                    # case 2: not tune {launcher}
+                    # case 2: not tune {launcher, ipex}
                     else:
                       del dst['hyperparams'][tune_x]
 
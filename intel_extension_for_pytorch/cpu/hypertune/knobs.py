@@ -0,0 +1,46 @@
+import json
+import os
+
+r"""
+The in-process IPEX knobs tuned by hypertune. The objective passes the knobs of a trial to the program as JSON in the
+``IPEX_HYPERTUNE_KNOBS`` environment variable, and they are applied when ``intel_extension_for_pytorch`` is imported,
+so that the program needs no change. A knob which is not tuned is absent and keeps the IPEX default.
+"""
+
+HYPERTUNE_KNOBS_ENV = 'IPEX_HYPERTUNE_KNOBS'
+
+def get_knobs():
+    return json.loads(os.environ.get(HYPERTUNE_KNOBS_ENV, '{}'))
+
+def apply_knobs():
+    knobs = get_knobs()
+    if not knobs:
+        return
+    import intel_extension_for_pytorch._C as core
+    from ...frontend import enable_onednn_fusion, enable_auto_channels_last, disable_auto_channels_last, \
+        set_fp32_math_mode, FP32MathMode
+    from .._auto_kernel_selection import _enable_dnnl, _disable_dnnl
+
+    if knobs.get('llga') is not None:
+        enable_onednn_fusion(knobs['llga'])
+    if knobs.get('fp32_math_mode') is not None:
+        set_fp32_math_mode(FP32MathMode[knobs['fp32_math_mode'].upper()])
+    if knobs.get('use_mkl_sgemm') is not None:
+        if knobs['use_mkl_sgemm']:
+            _disable_dnnl()
+        else:
+            _enable_dnnl()
+    if knobs.get('auto_channels_last') is not None:
+        if knobs['auto_channels_last']:
+            enable_auto_channels_last()
+        else:
+            disable_auto_channels_last()
+    if knobs.get('weight_cache') is not None:
+        core._jit_set_llga_weight_cache_enabled(knobs['weight_cache'])
+
+def get_num_streams(default=1):
+    r"""
+    The stream count of the trial, for the programs running the model on several streams, ``default`` if not tuned.
+    """
+    num_streams = get_knobs().get('num_streams')
+    return default if num_streams is None else num_streams
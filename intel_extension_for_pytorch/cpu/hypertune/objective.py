@@ -1,12 +1,16 @@
 #reference: https://github.com/intel/neural-compressor/blob/15477100cef756e430c8ef8ef79729f0c80c8ce6/neural_compressor/objective.py
+import json
+import os
 import subprocess
 import sys
+from .knobs import HYPERTUNE_KNOBS_ENV
 
 class MultiObjective(object):
-    def __init__(self, program, program_args, tune_launcher):
+    def __init__(self, program, program_args, tune_launcher, ipex_hyperparams=()):
         self.program = program
         self.program_args = program_args
         self.tune_launcher = tune_launcher
+        self.ipex_hyperparams = ipex_hyperparams
 
     def evaluate(self, cfg):
         cmd = ['ipexrun']
@@ -18,7 +22,12 @@ class MultiObjective(object):
         cmd += [self.program]
         cmd += self.program_args
 
-        r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        env = os.environ.copy()
+        knobs = self.decode_ipex_cfg(cfg)
+        if knobs:
+            env[HYPERTUNE_KNOBS_ENV] = json.dumps(knobs)
+
+        r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, env=env)
 
         # todo: r.returncode != 0
 
@@ -88,6 +97,10 @@ class MultiObjective(object):
 
         return launcher_args
 
+    def decode_ipex_cfg(self, cfg):
+        # the knobs applied by the program when importing intel_extension_for_pytorch, see knobs.py
+        return {hp: cfg[hp] for hp in self.ipex_hyperparams if cfg[hp] is not None}
+
     def extract_usr_objectives(self, output):
         HYPERTUNE_TOKEN = '@hypertune'
         output = output.strip().splitlines()
@@ -0,0 +1,71 @@
+import itertools
+import math
+import numpy as np
+from .strategy import strategy_registry, TuneStrategy
+
+@strategy_registry
+class BayesianTuneStrategy(TuneStrategy):
+    r"""
+    Bayesian optimization of the first objective: a Gaussian process with an RBF kernel is fit on the configurations
+    tried so far, and the untried configuration of the largest expected improvement is tried next. The first
+    configurations are random, and each hyperparameter is encoded in [0, 1] by the rank of its value in its search
+    space, numbers being sorted.
+    """
+    num_random_trials = 5
+    # the untried configurations scored per trial, sampled when the search space is larger
+    max_candidates = 2000
+    length_scale = 0.3
+    noise = 1e-4
+
+    def __init__(self, conf):
+        super().__init__(conf)
+        self.combinations = list(itertools.product(*(self.hyperparam2searchspace[hp] for hp in self.hyperparams)))
+        self.encoded = np.array([self._encode(cfg) for cfg in self.combinations]).reshape(len(self.combinations), -1)
+        self.higher_is_better = self.usr_objectives[0]['higher_is_better'] if self.usr_objectives else False
+
+    def _encode(self, cfg):
+        x = []
+        for hp, val in zip(self.hyperparams, cfg):
+            space = self.hyperparam2searchspace[hp]
+            if all(isinstance(v, (int, float)) and not isinstance(v, bool) for v in space):
+                space = sorted(space)
+            x.append(space.index(val) / max(len(space) - 1, 1))
+        return x
+
+    def _kernel(self, a, b):
+        d2 = ((a[:, None, :] - b[None, :, :]) ** 2).sum(-1)
+        return np.exp(-0.5 * d2 / self.length_scale ** 2)
+
+    def _expected_improvement(self, tried, y, candidates):
+        # y is minimized, normalized to a zero mean and a unit variance
+        y = (y - y.mean()) / (y.std() + 1e-12)
+        x = self.encoded[tried]
+        k = self._kernel(x, x) + self.noise * np.eye(len(tried))
+        k_inv = np.linalg.inv(k)
+        k_s = self._kernel(self.encoded[candidates], x)
+        mu = k_s @ k_inv @ y
+        sigma = np.sqrt(np.clip(1. - np.einsum('ij,jk,ik->i', k_s, k_inv, k_s), 1e-12, None))
+        z = (y.min() - mu) / sigma
+        cdf = 0.5 * (1. + np.vectorize(math.erf)(z / math.sqrt(2.)))
+        pdf = np.exp(-0.5 * z ** 2) / math.sqrt(2. * math.pi)
+        return (y.min() - mu) * cdf + sigma * pdf
+
+    def next_tune_cfg(self):
+        untried = set(range(len(self.combinations)))
+        tried = []
+        while len(untried) > 0:
+            if len(tried) < self.num_random_trials:
+                idx = np.random.choice(list(untried))
+            else:
+                candidates = list(untried)
+                if len(candidates) > self.max_candidates:
+                    candidates = list(np.random.choice(candidates, self.max_candidates, replace=False))
+                # the trials yielded so far were evaluated before resuming
+                y = np.array([result[0] for _, result in self.tune_history], dtype=np.float64)
+                if self.higher_is_better:
+                    y = -y
+                idx = candidates[int(np.argmax(self._expected_improvement(tried, y, candidates)))]
+            untried.remove(idx)
+            tried.append(idx)
+            yield dict(zip(self.hyperparams, self.combinations[idx]))
+        return
@@ -25,6 +25,7 @@ class TuneStrategy(object):
         self.usr_objectives = conf.usr_objectives
 
         self.max_trials = conf.execution_conf.tuning.max_trials
+        self.early_stopping = conf.execution_conf.tuning.early_stopping
 
         #### hyperparams ####
         self.hyperparam2searchspace = OrderedDict()
@@ -33,9 +34,10 @@ class TuneStrategy(object):
                 self.hyperparam2searchspace[hp] = self.conf.hyperparams[k][hp]
         self.hyperparams = list(self.hyperparam2searchspace.keys())
         tune_launcher = 'launcher' in self.conf.hyperparams
+        ipex_hyperparams = self.conf.hyperparams['ipex']['hp'] if 'ipex' in self.conf.hyperparams else []
 
         #### objective ####
-        self.multiobjective = MultiObjective(self.program, self.program_args, tune_launcher)
+        self.multiobjective = MultiObjective(self.program, self.program_args, tune_launcher, ipex_hyperparams)
 
         #### output ####
         output_name = "record.csv"
@@ -46,6 +48,10 @@ class TuneStrategy(object):
 
         self.best_tune_result = None
         self.best_tune_cfg = None
+        # the trials in a row without a better configuration
+        self.trials_without_improvement = 0
+        # the (tune_cfg, tune_result) of each trial, for the strategies learning from the previous trials
+        self.tune_history = []
 
 
     @abstractmethod
@@ -66,6 +72,7 @@ class TuneStrategy(object):
             click.secho(f"{tune_cfg}", fg='blue')
 
             curr_tune_result = self.multiobjective.evaluate(tune_cfg)
+            self.tune_history.append((tune_cfg, curr_tune_result))
 
             self._update_best_tune_result(curr_tune_result, tune_cfg)
             self._record_tune_result(curr_tune_result, tune_cfg)
@@ -75,11 +82,12 @@ class TuneStrategy(object):
             if need_stop:
                 # case 1: accuracy goal is met
                 # case 2: timeout reached (objective goal not met)
+                # case 3: no better configuration for early_stopping trials (objective goal not met)
                 self._print_best_result()
                 return
 
         # finished traversal
-        # case 3: finished traversal (objective goal not met)
+        # case 4: finished traversal (objective goal not met)
         click.secho("\nFinished traversing the entire search space, but didn't find configuration meeting the objective goal", fg='red')
         self._print_best_result()
         return
@@ -95,11 +103,15 @@ class TuneStrategy(object):
             # initial baseline
             self.best_tune_result = curr_tune_result
             self.best_tune_cfg = curr_tune_cfg
+            self.trials_without_improvement = 0
         else:
             # multi objective
             if all([self._compare(higher_is_better, curr_val, best_val) for higher_is_better, curr_val, best_val in zip([objective['higher_is_better'] for objective in self.usr_objectives], curr_tune_result, self.best_tune_result)]):
                 self.best_tune_result = curr_tune_result
                 self.best_tune_cfg = curr_tune_cfg
+                self.trials_without_improvement = 0
+            else:
+                self.trials_without_improvement += 1
 
     def _record_tune_result(self, curr_tune_result, curr_tune_cfg):
         for objective, val in zip(self.usr_objectives, curr_tune_result):
@@ -120,6 +132,9 @@ class TuneStrategy(object):
         elif trials_count == self.max_trials:
             click.secho("\nMax trials is reached, but didn't find configuration meeting the objective goal.", fg='red')
             return True
+        elif self.early_stopping > 0 and self.trials_without_improvement >= self.early_stopping:
+            click.secho(f"\nNo better configuration in the last {self.early_stopping} trials, stopping early.", fg='red')
+            return True
         return False
 
     def _print_best_result(self):
@@ -0,0 +1,67 @@
+import os
+import json
+
+class CalibrationConf(object):
+    '''
+    Configuration of the calibration sweep in the layout of the hypertune Conf, so that the hypertune
+    strategies traverse the search space of the launcher
+    '''
+    def __init__(self, search_space, strategy, max_trials, output_dir, program, program_args, latency_slo=0):
+        from intel_extension_for_pytorch.cpu.hypertune.conf.dotdict import DotDict
+        hyperparams = {'hp': list(search_space.keys())}
+        hyperparams.update(search_space)
+        self.execution_conf = DotDict({
+                'tuning': {'strategy': strategy, 'max_trials': max_trials},
+                'hyperparams': {'calibration': hyperparams},
+                'output_dir': output_dir,
+                })
+        self.program = program
+        self.program_args = program_args
+        self.usr_objectives = [
+                {'name': 'latency', 'higher_is_better': False, 'target_val': latency_slo if latency_slo > 0 else -float('inf')},
+                {'name': 'throughput', 'higher_is_better': True, 'target_val': float('inf')},
+                ]
+
+def pareto_front(trials):
+    '''
+    The trials that no other trial beats on both latency and throughput, in order of latency
+    '''
+    front = []
+    for t in trials:
+        dominated = False
+        for o in trials:
+            if o['latency'] <= t['latency'] and o['throughput'] >= t['throughput'] and \
+               (o['latency'] < t['latency'] or o['throughput'] > t['throughput']):
+                dominated = True
+                break
+        if not dominated:
+            front.append(t)
+    front.sort(key=lambda t: t['latency'])
+    return front
+
+def select_config(trials, latency_slo=0):
+    '''
+    Select the trial of the highest throughput on the Pareto front whose latency is within the latency SLO in ms.
+    Without SLO (latency_slo <= 0) every trial meets it. If none meets it, the trial of the lowest latency is
+    selected. Returns the selected trial, the Pareto front and whether the selected trial meets the SLO.
+    '''
+    assert len(trials) > 0, 'No calibration trial succeeded.'
+    front = pareto_front(trials)
+    feasible = [t for t in front if latency_slo <= 0 or t['latency'] <= latency_slo]
+    if len(feasible) > 0:
+        return max(feasible, key=lambda t: t['throughput']), front, True
+    return front[0], front, False
+
+def save_calibration_record(path, trials, front, best, latency_slo, slo_met):
+    dirname = os.path.dirname(path)
+    if dirname != '' and not os.path.exists(dirname):
+        os.makedirs(dirname)
+    record = {
+            'latency_slo': latency_slo,
+            'slo_met': slo_met,
+            'best': best,
+            'pareto': front,
+            'trials': trials,
+            }
+    with open(path, 'w') as f:
+        json.dump(record, f, indent=2)
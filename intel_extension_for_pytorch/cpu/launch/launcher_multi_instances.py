@@ -1,8 +1,10 @@
 import sys
 import subprocess
 import os
+import tempfile
 import intel_extension_for_pytorch.cpu.auto_ipex as auto_ipex
 from .launcher_base import Launcher
+from .calibration import CalibrationConf, select_config, save_calibration_record
 
 class MultiInstancesLauncher(Launcher):
     '''
@@ -78,6 +80,64 @@ class MultiInstancesLauncher(Launcher):
             help='Enable benchmark config. JeMalloc\'s MALLOC_CONF has been tuned for low latency. Recommend to use this for benchmarking purpose; for other use cases, this MALLOC_CONF may cause Out-of-Memory crash.',
         )
 
+        group = parser.add_argument_group('Calibration Arguments')
+        group.add_argument(
+            '--calibrate',
+            action='store_true',
+            default=False,
+            help='Run a short calibration sweep of instances x cores per instance x batch size before launching, and launch with the configuration of the highest throughput within --latency-slo. The program reads the batch size from the environment variable IPEX_CALIBRATION_BATCH_SIZE, and prints "@hypertune {\'name\': \'latency\'}" followed by its latency of a batch in ms. IPEX_CALIBRATION_RUN is set to 1 in the calibration runs.',
+        )
+        group.add_argument(
+            '--latency-slo',
+            '--latency_slo',
+            default=0,
+            type=float,
+            help='Latency SLO in ms of the calibration. The slowest instance of a configuration must meet it. 0 means no SLO.',
+        )
+        group.add_argument(
+            '--calibrate-ninstances',
+            '--calibrate_ninstances',
+            default='0',
+            type=str,
+            help='Numbers of instances to calibrate, in format of "n,n,..." or "n-n,...". 0 fills all the cores with instances.',
+        )
+        group.add_argument(
+            '--calibrate-ncores-per-instance',
+            '--calibrate_ncores_per_instance',
+            default='',
+            type=str,
+            help='Numbers of cores per instance to calibrate, in format of "n,n,..." or "n-n,...". By default the powers of 2 up to all the cores and all the cores.',
+        )
+        group.add_argument(
+            '--calibrate-batch-sizes',
+            '--calibrate_batch_sizes',
+            default='1,4,16',
+            type=str,
+            help='Batch sizes to calibrate, in format of "n,n,..." or "n-n,...".',
+        )
+        group.add_argument(
+            '--calibrate-strategy',
+            '--calibrate_strategy',
+            default='grid',
+            type=str,
+            choices=['grid', 'random'],
+            help='The hypertune strategy traversing the calibration search space.',
+        )
+        group.add_argument(
+            '--calibrate-max-trials',
+            '--calibrate_max_trials',
+            default=100,
+            type=int,
+            help='Maximum number of calibration trials.',
+        )
+        group.add_argument(
+            '--calibration-record',
+            '--calibration_record',
+            default='',
+            type=str,
+            help='JSON file recording the calibration trials, their Pareto front and the selected configuration. By default calibration.json in --log-dir, or in the current directory.',
+        )
+
     def is_command_available(self, cmd):
         is_available = False
         try:
@@ -100,7 +160,7 @@ class MultiInstancesLauncher(Launcher):
         tm_local = self.set_lib_bin_from_list(multi_task_manager, tm_bin_name, 'multi-task manager', self.tm_supported, self.is_command_available, skip_list)
         return tm_local
 
-    def execution_command_builder(self, args, omp_runtime, task_mgr, environ, cpu_pools, index):
+    def execution_command_builder(self, args, omp_runtime, task_mgr, environ, cpu_pools, index, stdout=None):
         assert index > -1 and index <= len(cpu_pools), 'Designated instance index for constructing execution commands is out of range.'
         cmd = []
         environ_local = environ
@@ -146,9 +206,150 @@ class MultiInstancesLauncher(Launcher):
         self.verbose('info', f'cmd: {cmd_s}')
         if len(set([c.node for c in pool])) > 1:
             self.verbose('warning', f'Cross NUMA nodes execution detected: cores [{cores_list_local}] are on different NUMA nodes [{nodes_list_local}]')
-        process = subprocess.Popen(cmd_s, env=environ_local, shell=True)
+        stderr = None if stdout is None else subprocess.STDOUT
+        process = subprocess.Popen(cmd_s, env=environ_local, shell=True, stdout=stdout, stderr=stderr)
         return {'process': process, 'cmd': cmd_s}
 
+    def set_environ(self, args):
+        '''
+        Set the memory allocator, the OpenMP runtime and the multi-task manager for the pools on demand
+        '''
+        preset_ld_preload = os.environ.get('LD_PRELOAD', '')
+        is_iomp_set = 'libiomp5.so' in preset_ld_preload
+        is_kmp_affinity_set = True if 'KMP_AFFINITY' in os.environ else False
+        set_kmp_affinity = True
+        # When using all cores on all nodes, including logical cores, setting KMP_AFFINITY disables logical cores. Thus, KMP_AFFINITY should not be set.
+        if args.use_logical_cores and len(set([c for p in self.cpuinfo.pools_ondemand for c in p])) == len(self.cpuinfo.pool_all):
+            assert not is_kmp_affinity_set, f'Environment variable "KMP_AFFINITY" is detected. Please unset it when using all cores.'
+            set_kmp_affinity = False
+
+        self.set_memory_allocator(args.memory_allocator, args.benchmark)
+        omp_runtime = self.set_omp_runtime(args.omp_runtime, set_kmp_affinity)
+        self.add_env('OMP_NUM_THREADS', str(args.ncores_per_instance))
+
+        skip_list = []
+        if is_iomp_set and is_kmp_affinity_set:
+            skip_list.append('numactl')
+        task_mgr = self.set_multi_task_manager(args.multi_task_manager, skip_list=skip_list)
+        return omp_runtime, task_mgr
+
+    def run_calibration_trial(self, args, strategy, cfg, cores_list, nodes_list):
+        '''
+        Run all the instances of a calibration configuration at once. Returns the latency of the slowest
+        instance and the throughput of all of them, or None if the configuration doesn't fit the cores or
+        an instance fails.
+        '''
+        try:
+            self.cpuinfo.gen_pools_ondemand(
+                    ninstances = cfg['ninstances'],
+                    ncores_per_instance = cfg['ncores_per_instance'],
+                    use_logical_cores = args.use_logical_cores,
+                    use_e_cores = args.use_e_cores,
+                    skip_cross_node_cores = args.skip_cross_node_cores,
+                    nodes_list = nodes_list,
+                    cores_list = cores_list
+                    )
+        except AssertionError as e:
+            self.verbose('warning', f'Skip calibration configuration {cfg}: {e}')
+            return None
+        args.ninstances = len(self.cpuinfo.pools_ondemand)
+        args.ncores_per_instance = len(self.cpuinfo.pools_ondemand[0])
+        omp_runtime, task_mgr = self.set_environ(args)
+        self.environ_set['IPEX_CALIBRATION_BATCH_SIZE'] = str(cfg['batch_size'])
+        self.environ_set['IPEX_CALIBRATION_RUN'] = '1'
+
+        processes = []
+        for i in range(args.ninstances):
+            output = tempfile.TemporaryFile()
+            process = self.execution_command_builder(
+                    args = args,
+                    omp_runtime = omp_runtime,
+                    task_mgr = task_mgr,
+                    environ = self.environ_set,
+                    cpu_pools = self.cpuinfo.pools_ondemand,
+                    index = i,
+                    stdout = output)
+            process['output'] = output
+            processes.append(process)
+        latencies = []
+        for process in processes:
+            process['process'].wait()
+            process['output'].seek(0)
+            output = str(process['output'].read(), 'utf-8')
+            process['output'].close()
+            if process['process'].returncode != 0:
+                self.verbose('warning', f'Calibration run failed: {process["cmd"]}')
+                return None
+            objectives = strategy.multiobjective.extract_usr_objectives(output)
+            if len(objectives) == 0:
+                raise RuntimeError(f'The latency of {args.program} is not found. Print "@hypertune {{\'name\': \'latency\'}}" followed by the latency of a batch in ms for the calibration.')
+            latencies.append(objectives[0])
+        latency = max(latencies)
+        throughput = sum([cfg['batch_size'] * 1000.0 / l for l in latencies])
+        return {'ninstances': args.ninstances,
+                'ncores_per_instance': args.ncores_per_instance,
+                'batch_size': cfg['batch_size'],
+                'latency': latency,
+                'throughput': throughput}
+
+    def calibrate(self, args, cores_list, nodes_list):
+        '''
+        Sweep instances x cores per instance x batch size with a hypertune strategy, record the Pareto front of
+        latency and throughput, and set args to the configuration of the highest throughput within the latency SLO
+        '''
+        from intel_extension_for_pytorch.cpu.hypertune.strategy import STRATEGIES
+
+        self.cpuinfo.gen_pools_ondemand(
+                ninstances = 1,
+                use_logical_cores = args.use_logical_cores,
+                use_e_cores = args.use_e_cores,
+                skip_cross_node_cores = args.skip_cross_node_cores,
+                nodes_list = nodes_list,
+                cores_list = cores_list
+                )
+        ncores = len(self.cpuinfo.pools_ondemand[0])
+        ncores_per_instance = sorted(self.parse_list_argument(args.calibrate_ncores_per_instance))
+        if len(ncores_per_instance) == 0:
+            ncores_per_instance = [n for n in [2 ** i for i in range(ncores.bit_length())] if n < ncores] + [ncores]
+        search_space = {
+                'ninstances': sorted(self.parse_list_argument(args.calibrate_ninstances)),
+                'ncores_per_instance': ncores_per_instance,
+                'batch_size': sorted(self.parse_list_argument(args.calibrate_batch_sizes)),
+                }
+        for k, v in search_space.items():
+            assert len(v) > 0, f'Calibration search space of {k} is empty.'
+        output_dir = args.log_dir if args.log_dir else os.getcwd()
+        conf = CalibrationConf(search_space, args.calibrate_strategy, args.calibrate_max_trials, output_dir, args.program, args.program_args, args.latency_slo)
+        strategy = STRATEGIES[args.calibrate_strategy](conf)
+
+        trials = []
+        ntrials = 0
+        for cfg in strategy.next_tune_cfg():
+            if ntrials == args.calibrate_max_trials:
+                break
+            ntrials += 1
+            self.verbose('info', f'Calibration trial {ntrials}: {cfg}')
+            trial = self.run_calibration_trial(args, strategy, cfg, cores_list, nodes_list)
+            if trial is None:
+                continue
+            self.verbose('info', f'Calibration trial {ntrials}: latency {trial["latency"]:.3f} ms, throughput {trial["throughput"]:.3f} samples/s')
+            strategy.tune_result_record.writerow([trial[k] for k in search_space] + [trial['latency'], trial['throughput']])
+            trials.append(trial)
+        if len(trials) == 0:
+            raise RuntimeError('No calibration configuration ran successfully.')
+
+        best, front, slo_met = select_config(trials, args.latency_slo)
+        record = args.calibration_record if args.calibration_record else os.path.join(output_dir, 'calibration.json')
+        save_calibration_record(record, trials, front, best, args.latency_slo, slo_met)
+        if not slo_met:
+            self.verbose('warning', f'No calibrated configuration meets the latency SLO {args.latency_slo} ms. Use the one of the lowest latency.')
+        self.verbose('info', f'Calibrated configuration: {best}, recorded in {record}')
+
+        args.ninstances = best['ninstances']
+        args.ncores_per_instance = best['ncores_per_instance']
+        self.environ_set['IPEX_CALIBRATION_BATCH_SIZE'] = str(best['batch_size'])
+        del self.environ_set['IPEX_CALIBRATION_RUN']
+
     def launch(self, args):
         if args.latency_mode and args.throughput_mode:
             raise RuntimeError('Argument latency_mode and throughput_mode cannot be set at the same time.')
@@ -168,6 +369,11 @@ class MultiInstancesLauncher(Launcher):
         cores_list = self.parse_list_argument(args.cores_list)
         nodes_list = self.parse_list_argument(args.nodes_list)
 
+        if args.calibrate:
+            if args.latency_mode or args.throughput_mode:
+                raise RuntimeError('Argument calibrate cannot be set with latency_mode or throughput_mode.')
+            self.calibrate(args, cores_list, nodes_list)
+
         self.cpuinfo.gen_pools_ondemand(
                 ninstances = args.ninstances,
                 ncores_per_instance = args.ncores_per_instance,
@@ -180,23 +386,7 @@ class MultiInstancesLauncher(Launcher):
         args.ninstances = len(self.cpuinfo.pools_ondemand)
         args.ncores_per_instance = len(self.cpuinfo.pools_ondemand[0])
 
-        preset_ld_preload = os.environ.get('LD_PRELOAD', '')
-        is_iomp_set = 'libiomp5.so' in preset_ld_preload
-        is_kmp_affinity_set = True if 'KMP_AFFINITY' in os.environ else False
-        set_kmp_affinity = True
-        # When using all cores on all nodes, including logical cores, setting KMP_AFFINITY disables logical cores. Thus, KMP_AFFINITY should not be set.
-        if args.use_logical_cores and len(set([c for p in self.cpuinfo.pools_ondemand for c in p])) == len(self.cpuinfo.pool_all):
-            assert not is_kmp_affinity_set, f'Environment variable "KMP_AFFINITY" is detected. Please unset it when using all cores.'
-            set_kmp_affinity = False
-
-        self.set_memory_allocator(args.memory_allocator, args.benchmark)
-        omp_runtime = self.set_omp_runtime(args.omp_runtime, set_kmp_affinity)
-        self.add_env('OMP_NUM_THREADS', str(args.ncores_per_instance))
-
-        skip_list = []
-        if is_iomp_set and is_kmp_affinity_set:
-            skip_list.append('numactl')
-        task_mgr = self.set_multi_task_manager(args.multi_task_manager, skip_list=skip_list)
+        omp_runtime, task_mgr = self.set_environ(args)
 
         # Set environment variables for multi-instance execution
         for k,v in self.environ_set.items():
@@ -1,4 +1,4 @@
-from .task import Task
+from .task import Task, BatchedTask, PipelineTask, CPUPoolController
 from .cpupool import pin, CPUPool, is_runtime_ext_enabled
 from .multi_stream import MultiStreamModule, get_default_num_streams, \
                         MultiStreamModuleHint, _MultiStreamBenchmarkModule
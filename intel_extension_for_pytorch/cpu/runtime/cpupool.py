@@ -5,21 +5,41 @@ import numpy as np
 import intel_extension_for_pytorch as ipex
 from .runtime_utils import get_core_list_of_node_id
 
+# The values of torch_ipex::runtime::CoreType
+_core_types = {None: 0, "performance": 1, "efficient": 2}
+
 class CPUPool(object):
     r"""
     An abstraction of a pool of CPU cores used for intra-op parallelism.
 
+    The pool knows the numa nodes of its cores. While it is pinned, e.g. with
+    ``ipex.cpu.runtime.pin`` or in the threads of a Task, the large CPU
+    allocations, including the ones of IPEX ops and prepacked weights, are
+    bound to these nodes: preferred for a single node and interleaved
+    otherwise. A pool covering all the numa nodes of the system keeps the
+    first-touch placement.
+
     Args:
         core_ids (list): A list of CPU cores' ids used for intra-op parallelism.
         node_id (int): A numa node id with all CPU cores on the numa node.
             ``node_id`` doesn't work if ``core_ids`` is set.
+        core_type (str): Selects the cores of a hybrid CPU by type,
+            "performance" or "efficient". The default value is None, which
+            keeps all the cores. The cores of a non-hybrid CPU are
+            "performance" cores.
+        physical_cores_only (bool): Keeps the first SMT thread of each
+            physical core only. The default value is False.
+        llc_id (int): Keeps the cores sharing the last level cache ``llc_id``,
+            e.g. a sub-NUMA cluster. The default value is None, which keeps
+            all the cores.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.CPUPool: Generated
         intel_extension_for_pytorch.cpu.runtime.CPUPool object.
     """
 
-    def __init__(self, core_ids: list = None, node_id: int = None):
+    def __init__(self, core_ids: list = None, node_id: int = None, core_type: str = None,
+                 physical_cores_only: bool = False, llc_id: int = None):
         if core_ids is not None:
             if node_id is not None:
                 warnings.warn("Both of core_ids and node_id are inputed. core_ids will be used with priority.")
@@ -37,10 +57,19 @@ class CPUPool(object):
             # The cores available for current process will change with external numactl cmd.
             self.core_ids = ipex._C.get_process_available_cores()
 
-        self.cpu_pool = ipex._C.CPUPool(self.core_ids)
+        if core_type is None and not physical_cores_only and llc_id is None:
+            self.cpu_pool = ipex._C.CPUPool(self.core_ids)
+        else:
+            assert core_type in _core_types, "Input of core_type must be None, \"performance\" or \"efficient\""
+            self.cpu_pool = ipex._C.CPUPool(self.core_ids,
+                                            _core_types[core_type],
+                                            physical_cores_only,
+                                            -1 if llc_id is None else llc_id)
         # The actual core ids inside CPUPool may be updated in creation of ipex._C.CPUPool.
         # Since ipex._C.CPUPool will filter out core ids which not available for current process.
         self.core_ids = self.cpu_pool.get_core_list()
+        # The numa nodes of the core ids, the memory allocated while the pool is pinned is bound to them.
+        self.node_ids = self.cpu_pool.get_numa_node_ids()
 
 class pin(object):
     r"""
@@ -5,6 +5,7 @@ import intel_extension_for_pytorch._C as core
 from .cpupool import CPUPool
 from .task import Task
 import copy
+import queue
 import warnings
 
 class MultiStreamModuleHint(object):
@@ -38,7 +39,17 @@ default_multi_stream_module_concat_hint = MultiStreamModuleHint(0)
 def get_default_num_streams(cpu_pool):
     # One core per stream usually brings better overall throughput than other configurations.
     # Therefore, we heuristically make one core per stream the default here.
-    return cpu_pool.core_ids.__len__()
+    # The SMT siblings of a physical core share its execution units, they count as one core.
+    return set(topology.physical_core_id for topology in core.get_cores_topology(cpu_pool.core_ids)).__len__()
+
+def _group_cores_by_physical_core(core_ids):
+    # Put the SMT siblings next to each other, so that the streams get whole physical cores
+    physical_core_ids = {topology.core_id: topology.physical_core_id
+                         for topology in core.get_cores_topology(core_ids)}
+    first_index = {}
+    for i, core_id in enumerate(core_ids):
+        first_index.setdefault(physical_core_ids[core_id], i)
+    return sorted(core_ids, key=lambda core_id: first_index[physical_core_ids[core_id]])
 
 class MultiStreamModule(nn.Module):
     r"""
@@ -48,7 +59,9 @@ class MultiStreamModule(nn.Module):
     the cores will be allocated equally to each stream. If the number of cores
     inside ``cpu_pool`` is not divisible by ``num_streams`` with remainder N,
     one extra core will be allocated to the first N streams. We suggest to set
-    the ``num_streams`` as divisor of core number inside ``cpu_pool``.
+    the ``num_streams`` as divisor of core number inside ``cpu_pool``. The SMT
+    siblings of a physical core are allocated to the same stream, and "AUTO"
+    selects one stream per physical core.
 
     If the inputs' batchsize is larger than and divisible by ``num_streams``,
     the batchsize will be allocated equally to each stream. If batchsize is not
@@ -60,6 +73,13 @@ class MultiStreamModule(nn.Module):
     as "AUTO", we suggest to set inputs' batchsize larger than and divisible by
     number of cores.
 
+    When the cost of the slices differs, e.g. with variable sequence lengths or
+    early-exit models, the slowest stream sets the latency of a static split.
+    With ``micro_batch_size`` set, the inputs are split into micro-batches of
+    that size instead, put in a queue shared by the streams. Each stream takes
+    the next micro-batch from the queue whenever it is idle, and the outputs
+    are put back in the order of the micro-batches.
+
     Args:
         model (torch.jit.ScriptModule or torch.nn.Module): The input model.
         num_streams (Union[int, str]): Number of instances (int) or "AUTO" (str). "AUTO" means the stream number
@@ -77,6 +97,11 @@ class MultiStreamModule(nn.Module):
             how to split the inputs.
         output_concat_hint (MultiStreamModuleHint): Hint to MultiStreamModule about
             how to concat the outputs.
+        micro_batch_size (Optional[int]): The size of the micro-batches the
+            streams take from their shared queue. The default value is None,
+            which splits the inputs statically between the streams. With
+            ``concat_output`` False, the output is the list of the output of
+            each micro-batch.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.MultiStreamModule: Generated
@@ -90,7 +115,8 @@ class MultiStreamModule(nn.Module):
                 cpu_pool: CPUPool = CPUPool(),
                 concat_output: bool = True,
                 input_split_hint: MultiStreamModuleHint = default_multi_stream_module_split_hint,
-                output_concat_hint: MultiStreamModuleHint = default_multi_stream_module_concat_hint):
+                output_concat_hint: MultiStreamModuleHint = default_multi_stream_module_concat_hint,
+                micro_batch_size: Optional[int] = None):
         super(MultiStreamModule, self).__init__()
         assert type(cpu_pool) is CPUPool, "Input of cpu_pool must be provided with type of ipex.cpu.runtime.CPUPool"
         if not isinstance(model, torch.jit.ScriptModule):
@@ -112,15 +138,23 @@ class MultiStreamModule(nn.Module):
             self.num_streams = self.core_list.__len__()
             warnings.warn("The number of streams is larger than number of cores. The number of streams changes to {}.".format(self.num_streams))
 
+        assert micro_batch_size is None or (isinstance(micro_batch_size, int) and micro_batch_size > 0), \
+            "Input of micro_batch_size must be None or a positive int"
+        self.micro_batch_size = micro_batch_size
+
         if self.num_streams == 1:
             # Sync execution path if num_stream is 1.
             self.model = model
         else:
             self.cores_per_instance = self.core_list.__len__() // self.num_streams
             num_stream_allocated_extra_core = self.core_list.__len__() % self.num_streams
+            stream_core_list = _group_cores_by_physical_core(self.core_list)
             self.tasks = []
             start_core_list_idx = 0
             end_core_list_idx = 0
+            if self.micro_batch_size is not None:
+                # Each stream runs a loop taking the micro-batches from the shared queue
+                self.model = model
             for j in range(self.num_streams):
                 if j < num_stream_allocated_extra_core:
                     # If the core number is not divisible by stream number,
@@ -128,7 +162,11 @@ class MultiStreamModule(nn.Module):
                     end_core_list_idx += (self.cores_per_instance + 1)
                 else:
                     end_core_list_idx += self.cores_per_instance
-                self.tasks.append(Task(model, CPUPool(self.core_list[start_core_list_idx:end_core_list_idx])))
+                stream_cpu_pool = CPUPool(stream_core_list[start_core_list_idx:end_core_list_idx])
+                if self.micro_batch_size is not None:
+                    self.tasks.append(Task(self._run_micro_batches, stream_cpu_pool))
+                else:
+                    self.tasks.append(Task(model, stream_cpu_pool))
                 start_core_list_idx = end_core_list_idx
         self.concat_output = concat_output
         self.input_split_hint = input_split_hint
@@ -177,14 +215,18 @@ class MultiStreamModule(nn.Module):
     def init_forward_status(self, split_size, stream_id):
         # This function should be invoke only once at each forward
         self.split_size = split_size
+        # In the work-stealing mode, the inputs are split into micro-batches, which
+        # take the place of the streams below
+        num_splits = self.num_streams if self.micro_batch_size is None else \
+            max(-(-self.split_size // self.micro_batch_size), 1)
         # Ensure each instance has input offload
-        self.batch_per_instance = self.split_size // self.num_streams
+        self.batch_per_instance = self.split_size // num_splits
         if self.batch_per_instance >= 1:
             # The input batchsize larger or equal to num_streams.
-            self.used_num_streams = self.num_streams
+            self.used_num_streams = num_splits
             # If input batchsize larger than num_streams and not divisible,
             # the first remainder streams will have (mini_batch + 1) input size.
-            self.instance_need_extra_input = self.split_size % self.num_streams
+            self.instance_need_extra_input = self.split_size % num_splits
         else:
             # The input batchsize less than num_streams,
             # only the first batchsize stream will have mini_batch(1) input.
@@ -259,6 +301,10 @@ class MultiStreamModule(nn.Module):
                                         stream_id = 0)
         # After we get the self.used_num_streams then we can
         # decide the inputs for the left of used_num_streams
+        while self.args_streams_input.__len__() < self.used_num_streams:
+            # The micro-batches may outnumber the streams
+            self.args_streams_input.append(copy.deepcopy(self.input_split_hint.args))
+            self.kwargs_streams_input.append(copy.deepcopy(self.input_split_hint.kwargs))
         for stream_id in range(1, self.used_num_streams):
             # Update the split idx for current stream
             self.update_split_idx(stream_id)
@@ -364,6 +410,16 @@ class MultiStreamModule(nn.Module):
         else:
             return return_obj
 
+    def _run_micro_batches(self, micro_batches, micro_batch_outputs):
+        # Runs on a stream: take the next micro-batch from the shared queue until it is empty
+        while True:
+            try:
+                micro_batch_id = micro_batches.get_nowait()
+            except queue.Empty:
+                return None
+            micro_batch_outputs[micro_batch_id] = self.model(*(self.args_streams_input[micro_batch_id]),
+                                                             **(self.kwargs_streams_input[micro_batch_id]))
+
     def forward(self, *args, **kwargs):
         # Reset the forward status to default value which mainly contains information
         # to split inputs. They will init afterwards for each forward call.
@@ -381,6 +437,23 @@ class MultiStreamModule(nn.Module):
 
         results_raw_future = []
         results_raw = []
+        if self.micro_batch_size is not None:
+            # Here used_num_streams is the number of micro-batches
+            micro_batches = queue.SimpleQueue()
+            for micro_batch_id in range(self.used_num_streams):
+                micro_batches.put(micro_batch_id)
+            micro_batch_outputs = [None] * self.used_num_streams
+            for stream_id in range(min(self.num_streams, self.used_num_streams)):
+                results_raw_future.append(self.tasks[stream_id](micro_batches, micro_batch_outputs))
+            for future in results_raw_future:
+                future.get()
+            # Put the outputs back in the order of the micro-batches
+            for micro_batch_id in range(self.used_num_streams):
+                self._generate_outputs([micro_batch_outputs[micro_batch_id]], micro_batch_id)\
+                                    if self.concat_output else\
+                                    results_raw.append(micro_batch_outputs[micro_batch_id])
+            return self._concat_output_for_each_stream() if self.concat_output else results_raw
+
         for stream_id in range(self.used_num_streams):
             results_raw_future.append(self.tasks[stream_id](*(self.args_streams_input[stream_id]), **(self.kwargs_streams_input[stream_id])))
 
@@ -427,6 +500,7 @@ class _MultiStreamBenchmarkModule(nn.Module):
         else:
             self.cores_per_instance = self.core_list.__len__() // self.num_streams
             num_stream_allocated_extra_core = self.core_list.__len__() % self.num_streams
+            stream_core_list = _group_cores_by_physical_core(self.core_list)
             self.tasks = []
             start_core_list_idx = 0
             end_core_list_idx = 0
@@ -437,7 +511,7 @@ class _MultiStreamBenchmarkModule(nn.Module):
                     end_core_list_idx += (self.cores_per_instance + 1)
                 else:
                     end_core_list_idx += self.cores_per_instance
-                self.tasks.append(Task(model, CPUPool(self.core_list[start_core_list_idx:end_core_list_idx])))
+                self.tasks.append(Task(model, CPUPool(stream_core_list[start_core_list_idx:end_core_list_idx])))
                 start_core_list_idx = end_core_list_idx
 
     def forward(self, *args, **kwargs):
@@ -1,5 +1,6 @@
 import torch
 import functools
+import threading
 import warnings
 import numpy as np
 import intel_extension_for_pytorch as ipex
@@ -36,3 +37,185 @@ class Task(object):
     def run_sync(self, *args, **kwargs):
         # sync execution
         return self._task.run_sync(*args, **kwargs)
+
+    def resize(self, cpu_pool: CPUPool):
+        r"""
+        Moves the Task to the cores of ``cpu_pool``. The calls already queued
+        finish on the previous cores and the next ones run on the new cores
+        with an OMP team of the new size. It doesn't wait for the queue.
+
+        Args:
+            cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): The
+                new CPUPool of the Task.
+        """
+        assert type(cpu_pool) is CPUPool
+        self.cpu_pool = cpu_pool
+        self._task.resize(self.cpu_pool.cpu_pool)
+
+    def queue_depth(self):
+        # The calls submitted and not finished yet
+        return self._task.get_num_pending_tasks()
+
+class CPUPoolController(object):
+    r"""
+    A controller sharing a set of CPU cores between Tasks according to their
+    load. Each rebalance gives every Task ``min_cores`` cores, and splits the
+    rest in proportion to the queue depth of the Tasks plus one, so the idle
+    Tasks give their cores to the busy ones. The Tasks get contiguous slices
+    of ``core_ids`` and only the ones whose slice changes are resized.
+
+    Args:
+        tasks (list): The intel_extension_for_pytorch.cpu.runtime.Task
+            objects sharing the cores.
+        core_ids (list): The CPU cores' ids shared by the Tasks. The default
+            value is None, which shares the cores of the CPUPools of the Tasks.
+        min_cores (int): The minimum number of cores of each Task.
+
+    Returns:
+        intel_extension_for_pytorch.cpu.runtime.CPUPoolController: Generated
+        intel_extension_for_pytorch.cpu.runtime.CPUPoolController object.
+    """
+
+    def __init__(self, tasks: list, core_ids: list = None, min_cores: int = 1):
+        assert tasks.__len__() > 0 and all(type(task) is Task for task in tasks), \
+            "Input of tasks must be a list of ipex.cpu.runtime.Task"
+        self.tasks = tasks
+        if core_ids is None:
+            core_ids = sorted(set(core_id for task in tasks for core_id in task.cpu_pool.core_ids))
+        self.core_ids = list(core_ids)
+        assert min_cores >= 1 and self.core_ids.__len__() >= min_cores * tasks.__len__(), \
+            "The cores are not enough for min_cores cores of each Task"
+        self.min_cores = min_cores
+        self._stop_event = None
+        self._thread = None
+
+    def _get_num_cores(self, queue_depths):
+        # min_cores each, plus the largest remainder split of the rest by weight
+        num_spare_cores = self.core_ids.__len__() - self.min_cores * self.tasks.__len__()
+        weights = [depth + 1 for depth in queue_depths]
+        shares = [num_spare_cores * weight / sum(weights) for weight in weights]
+        num_cores = [self.min_cores + int(share) for share in shares]
+        remainders = sorted(range(shares.__len__()), key=lambda i: int(shares[i]) - shares[i])
+        for i in remainders[:self.core_ids.__len__() - sum(num_cores)]:
+            num_cores[i] += 1
+        return num_cores
+
+    def rebalance(self):
+        r"""
+        Reads the queue depth of the Tasks and resizes them.
+
+        Returns:
+            list: The CPU cores' ids of each Task.
+        """
+        num_cores = self._get_num_cores([task.queue_depth() for task in self.tasks])
+        start = 0
+        for task, task_num_cores in zip(self.tasks, num_cores):
+            core_ids = self.core_ids[start:start + task_num_cores]
+            start += task_num_cores
+            if task.cpu_pool.core_ids != core_ids:
+                task.resize(CPUPool(core_ids))
+        return [task.cpu_pool.core_ids for task in self.tasks]
+
+    def start(self, interval_ms: int = 100):
+        r"""
+        Rebalances the cores every ``interval_ms`` milliseconds in a
+        background thread, until ``stop``.
+        """
+        assert self._thread is None, "The CPUPoolController is already started"
+        self._stop_event = threading.Event()
+
+        def run():
+            while not self._stop_event.wait(interval_ms / 1000.0):
+                self.rebalance()
+
+        self._thread = threading.Thread(target=run, daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        if self._thread is not None:
+            self._stop_event.set()
+            self._thread.join()
+            self._thread = None
+
+class PipelineTask(object):
+    r"""
+    A model split into TorchScript stages running in a pipeline, each stage
+    on its own CPUPool, e.g. one per socket, so that no stage reads memory
+    across sockets. The tensor inputs of a call are split along dim 0 into
+    micro-batches of ``micro_batch_size``. Each stage passes the output of a
+    micro-batch to the next one, a tensor or the elements of a tuple becoming
+    its inputs, while it runs the next micro-batch. The outputs of the last
+    stage are concatenated along dim 0.
+
+    Args:
+        stages (list): The torch.jit.ScriptModule of each stage, in order.
+        cpu_pools (list): The intel_extension_for_pytorch.cpu.runtime.CPUPool
+            of each stage.
+        micro_batch_size (int): The size of dim 0 of the micro-batches.
+        max_in_flight (int): The maximum number of micro-batches queued at a
+            stage. A full stage holds back the stages before it.
+
+    Returns:
+        intel_extension_for_pytorch.cpu.runtime.PipelineTask: Generated
+        intel_extension_for_pytorch.cpu.runtime.PipelineTask object.
+    """
+
+    def __init__(self, stages: list, cpu_pools: list, micro_batch_size: int, max_in_flight: int = 4):
+        assert stages.__len__() == cpu_pools.__len__(), "Input of cpu_pools must have a CPUPool per stage"
+        assert all(type(cpu_pool) is CPUPool for cpu_pool in cpu_pools)
+        assert all(isinstance(stage, torch.jit.ScriptModule) for stage in stages), \
+            "PipelineTask only supports torch.jit.ScriptModule stages"
+        self.cpu_pools = cpu_pools
+        self._task = ipex._C.PipelineTaskModule([stage._c for stage in stages],
+                                                [cpu_pool.cpu_pool for cpu_pool in cpu_pools],
+                                                micro_batch_size,
+                                                max_in_flight)
+
+    def __call__(self, *args):
+        # async execution through the stages
+        return self._task.run_async(*args)
+
+    def run_sync(self, *args):
+        # sync execution
+        return self._task.run_sync(*args)
+
+class BatchedTask(object):
+    r"""
+    A dynamic batcher of a TorchScript module, scheduled asynchronously.
+    The requests are submitted one by one and coalesced until their batch
+    reaches ``max_batch`` or ``max_delay_us`` passed since the first request
+    of the batch. Their tensor inputs are concatenated along dim 0 and the
+    batch runs on ``cpu_pool``, and the output tensors (or the tensors of an
+    output tuple or list) are split back along dim 0 into the result of each
+    request.
+
+    Args:
+        module (torch.jit.ScriptModule): The input module, taking tensors
+            batched along dim 0.
+        cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): An
+            intel_extension_for_pytorch.cpu.runtime.CPUPool object, contains
+            all CPU cores used to run the batches.
+        max_batch (int): The maximum size of dim 0 of a batch. A larger
+            request runs alone.
+        max_delay_us (int): The maximum time a request waits for the other
+            requests of its batch, in microseconds.
+
+    Returns:
+        intel_extension_for_pytorch.cpu.runtime.BatchedTask: Generated
+        intel_extension_for_pytorch.cpu.runtime.BatchedTask object.
+    """
+
+    def __init__(self, module, cpu_pool: CPUPool, max_batch: int, max_delay_us: int = 1000):
+        self.cpu_pool = cpu_pool
+        assert type(self.cpu_pool) is CPUPool
+        assert isinstance(module, torch.jit.ScriptModule), \
+            "BatchedTask only supports torch.jit.ScriptModule"
+        self._task = ipex._C.BatchedTaskModule(module._c, self.cpu_pool.cpu_pool, max_batch, max_delay_us)
+
+    def __call__(self, *args):
+        # async execution, batched with the other requests
+        return self._task.run_async(*args)
+
+    def run_sync(self, *args):
+        # sync execution
+        return self._task.run_sync(*args)
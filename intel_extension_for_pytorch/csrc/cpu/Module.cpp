@@ -1,7 +1,10 @@
 #include "Module.h"
 
+#include "constant_cache.h"
+#include "fusion_report.h"
 #include "interface.h"
 #include "isa_help.h"
+#include "output_buffers.h"
 #include "version.h"
 
 #include <c10/core/Device.h>
@@ -22,9 +25,14 @@
 #include <vector>
 
 #include "jit/auto_opt_config.h"
+#include "jit/cpu/kernels/PackedWeightRegistry.h"
 #include "jit/cpu/tensorexpr/nnc_fuser_register.h"
 #include "utils/fpmath_mode.h"
+#include "utils/kernel_selector.h"
+#include "utils/memory_tracker.h"
 #include "utils/onednn_utils.h"
+#include "utils/op_stats.h"
+#include "utils/parallel_stats.h"
 
 #include <c10/core/DeviceType.h>
 #include <torch/csrc/Exceptions.h>
@@ -34,7 +42,13 @@
 #include "autocast/autocast_mode.h"
 
 #include "TaskModule.h"
+#include "aten/DirectConv.h"
 #include "aten/EmbeddingBag.h"
+#include "aten/ShmAllReduce.h"
+#include "aten/SparseLinear.h"
+#include "aten/utils/amx_tile.h"
+#include "aten/utils/embedding_lookup.h"
+#include "aten/utils/streaming_store.h"
 #include "runtime/CPUPool.h"
 #include "runtime/TaskExecutor.h"
 #include "toolkit/sklearn.h"
@@ -84,7 +98,160 @@ void InitIpexModuleBindings(py::module m) {
     return get_highest_binary_support_isa_level();
   });
 
+  m.def("_get_dispatch_stub_names", []() {
+    return torch_ipex::cpu::get_dispatch_stub_names();
+  });
+
+  m.def("_get_dispatch_stub_isa_levels", [](const std::string& name) {
+    using namespace torch_ipex::cpu;
+    std::vector<std::string> isa_levels;
+    for (auto isa : get_dispatch_stub_isa_levels(name)) {
+      isa_levels.emplace_back(CPUCapabilityToString(isa));
+    }
+    return isa_levels;
+  });
+
+  m.def("_get_dispatch_stub_isa_level", [](const std::string& name) {
+    using namespace torch_ipex::cpu;
+    return std::string(CPUCapabilityToString(get_dispatch_stub_isa_level(name)));
+  });
+
+  m.def("_get_dispatch_stub_binary_isa_levels", [](const std::string& name) {
+    using namespace torch_ipex::cpu;
+    std::vector<std::string> isa_levels;
+    for (auto isa : get_dispatch_stub_binary_isa_levels(name)) {
+      isa_levels.emplace_back(CPUCapabilityToString(isa));
+    }
+    return isa_levels;
+  });
+
+  m.def("_get_dispatch_stub_kernel_isa_level", [](const std::string& name) {
+    using namespace torch_ipex::cpu;
+    return std::string(
+        CPUCapabilityToString(get_dispatch_stub_kernel_isa_level(name)));
+  });
+
+  m.def("_get_dispatch_stub_coverage_report", []() {
+    return torch_ipex::cpu::get_dispatch_stub_coverage_report();
+  });
+
+  m.def("_is_dispatch_stub_isa_level_set", [](const std::string& name) {
+    return torch_ipex::cpu::is_dispatch_stub_isa_level_set(name);
+  });
+
+  m.def(
+      "_set_dispatch_stub_isa_level",
+      [](const std::string& name, const std::string& isa_name) {
+        using namespace torch_ipex::cpu;
+        CPUCapability isa;
+        TORCH_CHECK(
+            CPUCapabilityFromString(isa_name, isa),
+            "Unknown ISA level ",
+            isa_name);
+        set_dispatch_stub_isa_level(name, isa);
+      });
+
+  m.def("_reset_dispatch_stub_isa_level", [](const std::string& name) {
+    torch_ipex::cpu::reset_dispatch_stub_isa_level(name);
+  });
+
   m.def("mkldnn_set_verbose", &torch_ipex::utils::onednn_set_verbose);
+  m.def(
+      "_set_op_stats_sample_rate",
+      &torch_ipex::utils::set_op_stats_sample_rate);
+  m.def(
+      "_get_op_stats_sample_rate",
+      &torch_ipex::utils::get_op_stats_sample_rate);
+  m.def("_get_op_stats", []() {
+    py::list ops;
+    for (auto& stats : torch_ipex::utils::get_op_stats()) {
+      py::dict d;
+      d["name"] = stats.name;
+      d["calls"] = stats.calls;
+      d["samples"] = stats.samples;
+      d["sampled_ms"] = stats.sampled_ms;
+      d["sampled_bytes"] = stats.sampled_bytes;
+      d["sampled_flops"] = stats.sampled_flops;
+      d["max_threads"] = stats.max_threads;
+      ops.append(d);
+    }
+    return ops;
+  });
+  m.def("_reset_op_stats", &torch_ipex::utils::reset_op_stats);
+  m.def(
+      "_set_kernel_selection_enabled",
+      &torch_ipex::utils::set_kernel_selection_enabled);
+  m.def(
+      "_is_kernel_selection_enabled",
+      &torch_ipex::utils::is_kernel_selection_enabled);
+  m.def(
+      "_set_kernel_selection_trials",
+      &torch_ipex::utils::set_kernel_selection_trials);
+  m.def(
+      "_get_kernel_selection_trials",
+      &torch_ipex::utils::get_kernel_selection_trials);
+  m.def(
+      "_get_kernel_selection_table",
+      &torch_ipex::utils::get_kernel_selection_table);
+  m.def(
+      "_load_kernel_selection_table",
+      &torch_ipex::utils::load_kernel_selection_table);
+  m.def("_reset_kernel_selection", &torch_ipex::utils::reset_kernel_selection);
+  m.def(
+      "_set_parallel_stats_enabled",
+      &torch_ipex::utils::set_parallel_stats_enabled);
+  m.def(
+      "_is_parallel_stats_enabled",
+      &torch_ipex::utils::is_parallel_stats_enabled);
+  m.def("_get_parallel_stats", []() {
+    py::list ops;
+    for (auto& stats : torch_ipex::utils::get_parallel_stats()) {
+      py::dict d;
+      d["op"] = stats.op;
+      d["cpu_pool"] = stats.cpu_pool;
+      d["regions"] = stats.regions;
+      d["max_threads"] = stats.max_threads;
+      d["wall_ms"] = stats.wall_ms;
+      d["busy_ms"] = stats.busy_ms;
+      d["max_busy_ms"] = stats.max_busy_ms;
+      d["barrier_wait_ms"] = stats.barrier_wait_ms;
+      d["worst_imbalance"] = stats.worst_imbalance;
+      ops.append(d);
+    }
+    return ops;
+  });
+  m.def("_reset_parallel_stats", &torch_ipex::utils::reset_parallel_stats);
+  m.def(
+      "_set_memory_tracking_enabled",
+      &torch_ipex::utils::set_memory_tracking_enabled);
+  m.def(
+      "_is_memory_tracking_enabled",
+      &torch_ipex::utils::is_memory_tracking_enabled);
+  m.def("_get_memory_stats", []() {
+    py::list tags;
+    for (auto& stats : torch_ipex::utils::get_memory_tag_stats()) {
+      py::dict d;
+      d["tag"] = stats.tag;
+      d["current_bytes"] = stats.current_bytes;
+      d["peak_bytes"] = stats.peak_bytes;
+      d["allocated_bytes"] = stats.allocated_bytes;
+      d["allocations"] = stats.allocations;
+      tags.append(d);
+    }
+    auto totals = torch_ipex::utils::get_memory_totals();
+    py::dict d;
+    d["current_bytes"] = totals.first;
+    d["peak_bytes"] = totals.second;
+    d["tags"] = tags;
+    return d;
+  });
+  m.def("_reset_memory_stats", &torch_ipex::utils::reset_memory_stats);
+  m.def("_set_memory_tag", &torch_ipex::utils::set_thread_memory_tag);
+  m.def("_shm_all_reduce_init", &torch_ipex::cpu::shm_all_reduce_init);
+  m.def("_shm_all_reduce_unlink", &torch_ipex::cpu::shm_all_reduce_unlink);
+  m.def(
+      "_is_shm_all_reduce_initialized",
+      &torch_ipex::cpu::is_shm_all_reduce_initialized);
   m.def("onednn_has_bf16_support", []() {
     return torch_ipex::utils::onednn_has_bf16_type_support();
   });
@@ -105,6 +272,13 @@ void InitIpexModuleBindings(py::module m) {
     torch_ipex::autocast::set_autocast_dtype(target_dtype);
   });
   m.def("clear_autocast_cache", &torch_ipex::autocast::clear_autocast_cache);
+  m.def("prune_autocast_cache", &torch_ipex::autocast::prune_autocast_cache);
+  m.def(
+      "is_autocast_cache_persistent",
+      &torch_ipex::autocast::is_autocast_cache_persistent);
+  m.def(
+      "set_autocast_cache_persistent",
+      &torch_ipex::autocast::set_autocast_cache_persistent);
 
   m.def("set_fp32_math_mode", [](FP32MathMode mode) {
     torch_ipex::setFP32MathModeCpu(mode);
@@ -130,6 +304,135 @@ void InitIpexModuleBindings(py::module m) {
   m.def(
       "_jit_llga_weight_cache_enabled",
       &torch_ipex::jit::fuser::onednn::getLlgaWeightCacheEnabled);
+  m.def(
+      "_jit_set_llga_dynamic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_dynamic_shape_enabled);
+  m.def(
+      "_jit_llga_dynamic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_dynamic_shape_enabled);
+  m.def(
+      "_jit_set_llga_symbolic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_symbolic_shape_enabled);
+  m.def(
+      "_jit_llga_symbolic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_symbolic_shape_enabled);
+  m.def(
+      "_jit_set_llga_dynamic_dim_bound",
+      &torch_ipex::jit::fuser::onednn::set_llga_dynamic_dim_bound);
+  m.def(
+      "_jit_llga_dynamic_dim_bound",
+      &torch_ipex::jit::fuser::onednn::get_llga_dynamic_dim_bound);
+  m.def(
+      "_jit_set_llga_async_compilation_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_async_compilation_enabled);
+  m.def(
+      "_jit_llga_async_compilation_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_async_compilation_enabled);
+  m.def(
+      "_jit_set_llga_shape_buckets",
+      &torch_ipex::jit::fuser::onednn::set_llga_shape_buckets);
+  m.def(
+      "_jit_llga_shape_buckets",
+      &torch_ipex::jit::fuser::onednn::get_llga_shape_buckets);
+  m.def(
+      "_jit_set_llga_compilation_cache_capacity",
+      &torch_ipex::jit::fuser::onednn::set_llga_compilation_cache_capacity);
+  m.def(
+      "_jit_llga_compilation_cache_capacity",
+      &torch_ipex::jit::fuser::onednn::get_llga_compilation_cache_capacity);
+  m.def("_jit_llga_compilation_cache_stats", []() {
+    auto stats =
+        torch_ipex::jit::fuser::onednn::get_llga_compilation_cache_stats();
+    py::dict d;
+    d["hits"] = stats.hits;
+    d["misses"] = stats.misses;
+    d["evictions"] = stats.evictions;
+    d["fallbacks"] = stats.fallbacks;
+    d["compile_ms"] = stats.compile_ms;
+    return d;
+  });
+  m.def(
+      "_jit_reset_llga_compilation_cache_stats",
+      &torch_ipex::jit::fuser::onednn::reset_llga_compilation_cache_stats);
+  m.def(
+      "_jit_set_llga_shared_weight_cache_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_shared_weight_cache_enabled);
+  m.def(
+      "_jit_llga_shared_weight_cache_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_shared_weight_cache_enabled);
+  m.def(
+      "_jit_set_llga_shared_weight_cache_budget",
+      &torch_ipex::jit::fuser::onednn::set_llga_shared_weight_cache_budget);
+  m.def(
+      "_jit_llga_shared_weight_cache_budget",
+      &torch_ipex::jit::fuser::onednn::get_llga_shared_weight_cache_budget);
+  m.def("_jit_llga_shared_weight_cache_stats", []() {
+    auto stats =
+        torch_ipex::jit::fuser::onednn::get_llga_shared_weight_cache_stats();
+    py::dict d;
+    d["bytes"] = std::get<0>(stats);
+    d["constants"] = std::get<1>(stats);
+    d["compilations"] = std::get<2>(stats);
+    return d;
+  });
+  m.def(
+      "_jit_clear_llga_shared_weight_cache",
+      &torch_ipex::jit::fuser::onednn::clear_llga_shared_weight_cache);
+  m.def(
+      "_jit_set_llga_fusion_report_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_fusion_report_enabled);
+  m.def(
+      "_jit_llga_fusion_report_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_fusion_report_enabled);
+  m.def("_jit_llga_fusion_report", []() {
+    py::list partitions;
+    for (auto& report :
+         torch_ipex::jit::fuser::onednn::get_llga_partition_reports()) {
+      py::dict p;
+      p["name"] = report.name;
+      p["ops"] = report.ops;
+      p["compilations"] = report.compilations;
+      p["compile_ms"] = report.compile_ms;
+      p["runs"] = report.runs;
+      p["run_ms"] = report.run_ms;
+      p["input_bytes"] = report.input_bytes;
+      p["output_bytes"] = report.output_bytes;
+      partitions.append(p);
+    }
+    py::list unfused;
+    for (auto& op : torch_ipex::jit::fuser::onednn::get_llga_unfused_ops()) {
+      py::dict u;
+      u["op"] = op.op;
+      u["reason"] = op.reason;
+      u["scope"] = op.scope;
+      unfused.append(u);
+    }
+    py::dict d;
+    d["partitions"] = partitions;
+    d["unfused"] = unfused;
+    return d;
+  });
+  m.def(
+      "_jit_reset_llga_fusion_report",
+      &torch_ipex::jit::fuser::onednn::reset_llga_fusion_report);
+  m.def(
+      "_jit_set_llga_output_buffer_reuse_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_output_buffer_reuse_enabled);
+  m.def(
+      "_jit_llga_output_buffer_reuse_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_output_buffer_reuse_enabled);
+  m.def("_jit_llga_output_buffer_stats", []() {
+    auto stats =
+        torch_ipex::jit::fuser::onednn::get_llga_output_buffer_stats();
+    py::dict d;
+    d["reused"] = std::get<0>(stats);
+    d["allocated"] = std::get<1>(stats);
+    d["pooled_bytes"] = std::get<2>(stats);
+    return d;
+  });
+  m.def(
+      "_jit_clear_llga_output_buffers",
+      &torch_ipex::jit::fuser::onednn::clear_llga_output_buffers);
 
   m.def("enable_jit_opt", []() {
     AutoOptConfig::singleton().set_jit_fuse(true);
@@ -140,6 +443,77 @@ void InitIpexModuleBindings(py::module m) {
   m.def("get_jit_opt", []() {
     return AutoOptConfig::singleton().get_jit_fuse();
   });
+  m.def("_jit_set_grouped_linear_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_grouped_linear(enabled);
+  });
+  m.def("_jit_grouped_linear_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_grouped_linear();
+  });
+  m.def("_jit_set_memory_plan_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_memory_plan(enabled);
+  });
+  m.def("_jit_memory_plan_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_memory_plan();
+  });
+  m.def("_jit_set_cat_views_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_cat_views(enabled);
+  });
+  m.def("_jit_cat_views_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_cat_views();
+  });
+  m.def("_jit_set_eltwise_chain_fusion_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_eltwise_chain_fusion(enabled);
+  });
+  m.def("_jit_eltwise_chain_fusion_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_eltwise_chain_fusion();
+  });
+  m.def("_jit_set_channels_last_propagation_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_channels_last_propagation(enabled);
+  });
+  m.def("_jit_channels_last_propagation_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_channels_last_propagation();
+  });
+  m.def("_jit_set_linear_backend_selection_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_jit_linear_backend_selection(enabled);
+  });
+  m.def("_jit_linear_backend_selection_enabled", []() {
+    return AutoOptConfig::singleton().get_jit_linear_backend_selection();
+  });
+
+  // packed weights shared by the op contexts of the same read-only weight
+  m.def("_set_packed_weight_sharing_enabled", [](bool enabled) {
+    torch_ipex::cpu::detail::PackedWeightRegistry::get().set_enabled(enabled);
+  });
+  m.def("_packed_weight_sharing_enabled", []() {
+    return torch_ipex::cpu::detail::PackedWeightRegistry::get().is_enabled();
+  });
+  m.def("_packed_weight_registry_size", []() {
+    return torch_ipex::cpu::detail::PackedWeightRegistry::get().size();
+  });
+  // serialize the packed weights instead of the public ones, loaded without
+  // repacking by the same build on the same ISA
+  m.def("_set_serialize_packed_weight", [](bool enabled) {
+    torch_ipex::cpu::detail::PackedWeightRegistry::get()
+        .set_serialization_enabled(enabled);
+  });
+  m.def("_serialize_packed_weight_enabled", []() {
+    return torch_ipex::cpu::detail::PackedWeightRegistry::get()
+        .is_serialization_enabled();
+  });
+  // block-sparse packing of the sparse linear weights by the op contexts
+  m.def("_set_sparse_linear_enabled", [](bool enabled) {
+    torch_ipex::cpu::set_sparse_linear_enabled(enabled);
+  });
+  m.def("_sparse_linear_enabled", []() {
+    return torch_ipex::cpu::is_sparse_linear_enabled();
+  });
+  // direct kernels of the depthwise and small channels convs
+  m.def("_set_direct_conv_enabled", [](bool enabled) {
+    torch_ipex::cpu::set_direct_conv_enabled(enabled);
+  });
+  m.def("_direct_conv_enabled", []() {
+    return torch_ipex::cpu::is_direct_conv_enabled();
+  });
 
   // BF32
   py::enum_<FP32MathMode>(m, "FP32MathMode")
@@ -162,8 +536,23 @@ void InitIpexModuleBindings(py::module m) {
         return std::make_shared<torch_ipex::runtime::CPUPool>(
             py::cast<std::vector<int32_t>>(core_list));
       }))
-      .def("get_core_list", [](torch_ipex::runtime::CPUPool& self) {
-        return self.get_cpu_core_list();
+      .def(py::init([](const py::list& core_list,
+                       int core_type,
+                       bool physical_cores_only,
+                       int32_t llc_id) {
+        return std::make_shared<torch_ipex::runtime::CPUPool>(
+            py::cast<std::vector<int32_t>>(core_list),
+            static_cast<torch_ipex::runtime::CoreType>(core_type),
+            physical_cores_only,
+            llc_id);
+      }))
+      .def(
+          "get_core_list",
+          [](torch_ipex::runtime::CPUPool& self) {
+            return self.get_cpu_core_list();
+          })
+      .def("get_numa_node_ids", [](torch_ipex::runtime::CPUPool& self) {
+        return self.get_numa_node_ids();
       });
 
   py::class_<
@@ -197,11 +586,79 @@ void InitIpexModuleBindings(py::module m) {
             // Depending on this being ScriptModule of nn.Module we will release
             // the GIL or not further down in the stack
             return self.run_async(std::move(args), std::move(kwargs));
+          })
+      .def(
+          "resize",
+          [](torch_ipex::runtime::TaskModule& self,
+             std::shared_ptr<torch_ipex::runtime::CPUPool> cpu_pool) {
+            self.resize((*cpu_pool));
+          })
+      .def(
+          "get_num_pending_tasks",
+          &torch_ipex::runtime::TaskModule::get_num_pending_tasks);
+
+  py::class_<
+      torch_ipex::runtime::BatchedTaskModule,
+      std::shared_ptr<torch_ipex::runtime::BatchedTaskModule>>(
+      m, "BatchedTaskModule")
+      .def(py::init([](const torch::jit::Module& module,
+                       std::shared_ptr<torch_ipex::runtime::CPUPool> cpu_pool,
+                       int64_t max_batch,
+                       int64_t max_delay_us) {
+        return std::make_shared<torch_ipex::runtime::BatchedTaskModule>(
+            module, (*cpu_pool), max_batch, max_delay_us);
+      }))
+      .def(
+          "run_sync",
+          [](torch_ipex::runtime::BatchedTaskModule& self, py::args& args) {
+            return self.run_sync(std::move(args));
+          })
+      .def(
+          "run_async",
+          [](torch_ipex::runtime::BatchedTaskModule& self, py::args& args) {
+            return self.run_async(std::move(args));
           });
 
+  py::class_<
+      torch_ipex::runtime::PipelineTaskModule,
+      std::shared_ptr<torch_ipex::runtime::PipelineTaskModule>>(
+      m, "PipelineTaskModule")
+      .def(py::init(
+          [](const std::vector<torch::jit::Module>& stages,
+             const std::vector<std::shared_ptr<torch_ipex::runtime::CPUPool>>&
+                 cpu_pools,
+             int64_t micro_batch_size,
+             int64_t max_in_flight) {
+            return std::make_shared<torch_ipex::runtime::PipelineTaskModule>(
+                stages, cpu_pools, micro_batch_size, max_in_flight);
+          }))
+      .def(
+          "run_sync",
+          [](torch_ipex::runtime::PipelineTaskModule& self, py::args& args) {
+            return self.run_sync(std::move(args));
+          })
+      .def(
+          "run_async",
+          [](torch_ipex::runtime::PipelineTaskModule& self, py::args& args) {
+            return self.run_async(std::move(args));
+          });
+
+  py::class_<torch_ipex::runtime::CoreTopology>(m, "CoreTopology")
+      .def_readonly("core_id", &torch_ipex::runtime::CoreTopology::core_id)
+      .def_readonly(
+          "physical_core_id",
+          &torch_ipex::runtime::CoreTopology::physical_core_id)
+      .def_property_readonly(
+          "core_type",
+          [](const torch_ipex::runtime::CoreTopology& self) {
+            return static_cast<int>(self.core_type);
+          })
+      .def_readonly("llc_id", &torch_ipex::runtime::CoreTopology::llc_id);
+
   m.def(
       "get_process_available_cores",
       &torch_ipex::runtime::get_process_available_cores);
+  m.def("get_cores_topology", &torch_ipex::runtime::get_cores_topology);
   m.def("is_runtime_ext_enabled", &torch_ipex::runtime::is_runtime_ext_enabled);
   m.def("init_runtime_ext", &torch_ipex::runtime::init_runtime_ext);
   m.def(
@@ -227,18 +684,68 @@ void InitIpexModuleBindings(py::module m) {
         return;
       });
 
+  // embedding lookup
+  m.def(
+      "set_embedding_prefetch_distance",
+      &torch_ipex::cpu::set_embedding_prefetch_distance);
+  m.def(
+      "get_embedding_prefetch_distance",
+      &torch_ipex::cpu::get_embedding_prefetch_distance);
+
+  // streaming stores of the memory bound kernels
+  m.def(
+      "set_streaming_store_threshold",
+      &torch_ipex::cpu::set_streaming_store_threshold);
+  m.def(
+      "get_streaming_store_threshold",
+      &torch_ipex::cpu::get_streaming_store_threshold);
+
+  // per thread AMX tile configuration cache
+  m.def(
+      "set_amx_tile_lazy_release", &torch_ipex::cpu::set_amx_tile_lazy_release);
+  m.def(
+      "get_amx_tile_lazy_release", &torch_ipex::cpu::get_amx_tile_lazy_release);
+  m.def(
+      "get_amx_tile_config_requests",
+      &torch_ipex::cpu::get_amx_tile_config_requests);
+  m.def(
+      "get_amx_tile_config_loads", &torch_ipex::cpu::get_amx_tile_config_loads);
+  m.def(
+      "reset_amx_tile_config_counters",
+      &torch_ipex::cpu::reset_amx_tile_config_counters);
+
   m.def("roc_auc_score", &toolkit::roc_auc_score);
   m.def("roc_auc_score_all", &toolkit::roc_auc_score_all);
+  py::class_<toolkit::RocAucAccumulator>(m, "RocAucAccumulator")
+      .def(py::init<int64_t>(), py::arg("num_bins") = 0)
+      .def("update", &toolkit::RocAucAccumulator::update)
+      .def("compute", &toolkit::RocAucAccumulator::compute)
+      .def("reset", &toolkit::RocAucAccumulator::reset);
 
   // libxsmm
   m.def("xsmm_manual_seed", &torch_ipex::tpp::xsmm_manual_seed);
   m.def("init_libxsmm", &torch_ipex::tpp::init_libxsmm);
 
+  // tpp timers
+  m.def("tpp_debug_timer_names", &torch_ipex::tpp::get_debug_timer_names);
+  m.def(
+      "tpp_debug_timers",
+      &torch_ipex::tpp::get_debug_timers,
+      py::arg("passes") = false);
+  m.def("tpp_reset_debug_timers", &torch_ipex::tpp::reset_debug_timers);
+  m.def(
+      "tpp_set_profiler_events", &torch_ipex::tpp::set_tpp_profiler_events);
+
+  // tpp sparse update RTM counters
+  m.def("tpp_rtm_stats", &torch_ipex::tpp::get_rtm_stats);
+  m.def("tpp_reset_rtm_stats", &torch_ipex::tpp::reset_rtm_stats);
+
   // tpp-for-optimizer
   m.def("tpp_dense_sparse_add_", &torch_ipex::tpp::dense_sparse_add_);
   m.def("tpp_bf16_split_add_", &torch_ipex::tpp::bf16_split_add_);
   m.def("tpp_fused_adamw", &torch_ipex::tpp::fused_adamw);
   m.def("tpp_fused_split_adamw", &torch_ipex::tpp::fused_split_adamw);
+  m.def("tpp_grad_norm", &torch_ipex::tpp::grad_norm);
   m.def("tpp_clip_grad_norm", &torch_ipex::tpp::clip_grad_norm);
   m.def("tpp_fused_lamb", &torch_ipex::tpp::fused_lamb);
   m.def("tpp_fused_lamb_v2", &torch_ipex::tpp::fused_lamb_v2);
@@ -1,5 +1,7 @@
 #include "TaskModule.h"
 
+#include <numeric>
+
 namespace torch_ipex {
 namespace runtime {
 
@@ -26,7 +28,9 @@ TaskModule::TaskModule(
     const torch_ipex::runtime::CPUPool& cpu_pool,
     bool traced_module)
     : script_module_(script_module) {
-  this->task_executor = std::make_shared<TaskExecutor>(cpu_pool);
+  this->script_task =
+      std::make_unique<ScriptModuleTask>(this->script_module_, cpu_pool);
+  this->task_executor = this->script_task->get_task_executor();
   this->script_module_initialized_ = true;
 }
 
@@ -55,44 +59,29 @@ std::unique_ptr<FutureTensor> TaskModule::run_async(
   // thread
   auto grad_mode = at::GradMode::is_enabled();
   if (this->script_module_initialized_) {
+    // The stack is converted from the Python objects under the GIL, the
+    // module runs on the worker without it
+    auto& function = script_module_.get_method("forward").function();
+    std::vector<at::IValue> stack = torch::jit::createStackForSchema(
+        function.getSchema(),
+        std::move(args),
+        // NOLINTNEXTLINE(performance-move-const-arg)
+        std::move(kwargs),
+        script_module_._ivalue());
+
+    auto promise = std::make_shared<std::promise<c10::IValue>>();
+    future_tensor_result->script_module_initialized_ = true;
+    future_tensor_result->future_script_tensor = promise->get_future();
     {
       pybind11::gil_scoped_release no_gil_guard;
-      auto& function = script_module_.get_method("forward").function();
-      std::vector<at::IValue> stack = torch::jit::createStackForSchema(
-          function.getSchema(),
-          std::move(args),
-          // NOLINTNEXTLINE(performance-move-const-arg)
-          std::move(kwargs),
-          script_module_._ivalue());
-
-      typedef std::function<c10::IValue(std::vector<at::IValue>)>
-          SubmitFunctionType;
-      typedef decltype(SubmitFunctionType()(stack)) return_type;
-      auto task = std::make_shared<std::packaged_task<return_type()>>(std::bind(
-          std::forward<SubmitFunctionType>(
-              [&](std::vector<at::IValue> stack) -> c10::IValue {
-                return function(std::move(stack));
-              }),
-          std::forward<std::vector<at::IValue>>(stack)));
-
-      future_tensor_result->script_module_initialized_ = true;
-      future_tensor_result->future_script_tensor = task->get_future();
-
-      {
-        std::unique_lock<std::mutex> lock(this->task_executor->get_mutex());
-        // submit task to a stopping the pool is not allowed
-        if (this->task_executor->is_stop())
-          throw std::runtime_error(
-              "submit TaskModule(py::object) on stopped ThreadPool");
-        this->task_executor->get_tasks().emplace([task, grad_mode]() {
-          // set the thread local status, such as the grad mode before
-          // execuating the status
-          at::GradMode::set_enabled(grad_mode);
-          // execuate the task
-          (*task)();
-        });
-      }
-      this->task_executor->get_condition().notify_one();
+      auto future = this->script_task->run_stack_async(std::move(stack));
+      future->addCallback([promise](c10::ivalue::Future& future) {
+        if (future.hasError()) {
+          promise->set_exception(future.exception_ptr());
+        } else {
+          promise->set_value(future.value());
+        }
+      });
     }
   } else {
     CHECK(this->module_initialized_);
@@ -113,20 +102,17 @@ std::unique_ptr<FutureTensor> TaskModule::run_async(
     future_tensor_result->future_tensor = task->get_future();
 
     {
-      std::unique_lock<std::mutex> lock(this->task_executor->get_mutex());
-      // submit task to a stopping the pool is not allowed
-      if (this->task_executor->is_stop())
-        throw std::runtime_error(
-            "submit TaskModule(py::object) on stopped ThreadPool");
-      this->task_executor->get_tasks().emplace([task, grad_mode]() {
-        // set the thread local status, such as the grad mode before execuating
-        // the status
+      // submit waits for a free slot when the queue is full, which the worker
+      // only frees by taking the GIL for the tasks ahead
+      pybind11::gil_scoped_release no_gil_guard;
+      this->task_executor->submit([task, grad_mode]() {
+        // set the thread local status, such as the grad mode before
+        // execuating the status
         at::GradMode::set_enabled(grad_mode);
         // execuate the task
         (*task)();
       });
     }
-    this->task_executor->get_condition().notify_one();
   }
   return future_tensor_result;
 }
@@ -138,5 +124,387 @@ py::object TaskModule::run_sync(py::args&& args, py::kwargs&& kwargs) {
   return future_tensor_result->get();
 }
 
+void TaskModule::resize(const torch_ipex::runtime::CPUPool& cpu_pool) {
+  // The TaskExecutor switches at the task boundary, without waiting here for
+  // the tasks in the queue
+  this->task_executor->resize(cpu_pool);
+}
+
+int64_t TaskModule::get_num_pending_tasks() const {
+  return this->task_executor->get_num_pending_tasks();
+}
+
+BatchedTaskModule::BatchedTaskModule(
+    const torch::jit::Module& script_module,
+    const torch_ipex::runtime::CPUPool& cpu_pool,
+    int64_t max_batch,
+    int64_t max_delay_us)
+    : script_module_(script_module),
+      max_batch(max_batch),
+      max_delay(max_delay_us) {
+  TORCH_CHECK(max_batch > 0, "BatchedTaskModule expects a positive max_batch");
+  TORCH_CHECK(
+      max_delay_us >= 0,
+      "BatchedTaskModule expects a non-negative max_delay_us");
+  this->task_executor = std::make_shared<TaskExecutor>(cpu_pool);
+  this->batcher = std::thread([this] { this->run_batcher(); });
+}
+
+BatchedTaskModule::~BatchedTaskModule() {
+  pybind11::gil_scoped_release no_gil_guard;
+  {
+    std::lock_guard<std::mutex> lock(this->batcher_mutex);
+    this->stop = true;
+  }
+  this->batcher_condition.notify_one();
+  this->batcher.join();
+  // run the batches submitted by the batcher
+  this->task_executor->stop_executor();
+}
+
+std::unique_ptr<FutureTensor> BatchedTaskModule::run_async(py::args&& args) {
+  TORCH_CHECK(args.size() > 0, "BatchedTaskModule expects tensor inputs");
+  auto request = std::make_shared<Request>();
+  for (auto& arg : args) {
+    TORCH_CHECK(
+        THPVariable_Check(arg.ptr()),
+        "BatchedTaskModule only takes tensor inputs");
+    request->inputs.push_back(py::cast<at::Tensor>(arg));
+  }
+  const auto& input = request->inputs[0];
+  TORCH_CHECK(
+      input.dim() > 0, "BatchedTaskModule expects inputs batched along dim 0");
+  request->batch_size = input.size(0);
+  for (const auto& t : request->inputs) {
+    TORCH_CHECK(
+        t.dim() > 0 && t.size(0) == request->batch_size,
+        "BatchedTaskModule expects inputs of the same size of dim 0");
+  }
+  request->grad_mode = at::GradMode::is_enabled();
+  request->arrival = std::chrono::steady_clock::now();
+
+  // FutureTensor is going to return
+  std::unique_ptr<FutureTensor> future_tensor_result =
+      std::make_unique<FutureTensor>();
+  future_tensor_result->script_module_initialized_ = true;
+  future_tensor_result->future_script_tensor = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(this->batcher_mutex);
+    // submit task to a stopping batcher is not allowed
+    if (this->stop)
+      throw std::runtime_error("submit BatchedTaskModule on stopped batcher");
+    this->requests.push_back(std::move(request));
+  }
+  this->batcher_condition.notify_one();
+  return future_tensor_result;
+}
+
+py::object BatchedTaskModule::run_sync(py::args&& args) {
+  std::unique_ptr<FutureTensor> future_tensor_result =
+      this->run_async(std::move(args));
+  return future_tensor_result->get();
+}
+
+void BatchedTaskModule::run_batcher() {
+  while (true) {
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(this->batcher_mutex);
+      this->batcher_condition.wait(
+          lock, [this] { return this->stop || !this->requests.empty(); });
+      if (this->requests.empty()) {
+        // stopped, and the pending requests are flushed
+        return;
+      }
+      // the requests batched together share their grad mode
+      bool grad_mode = this->requests.front()->grad_mode;
+      auto is_full = [&, this] {
+        int64_t rows = 0;
+        for (const auto& request : this->requests) {
+          if (request->grad_mode != grad_mode) {
+            return true;
+          }
+          rows += request->batch_size;
+          if (rows >= this->max_batch) {
+            return true;
+          }
+        }
+        return false;
+      };
+      auto deadline = this->requests.front()->arrival + this->max_delay;
+      this->batcher_condition.wait_until(
+          lock, deadline, [&, this] { return this->stop || is_full(); });
+
+      int64_t rows = 0;
+      while (!this->requests.empty()) {
+        auto& request = this->requests.front();
+        if (!batch.empty() &&
+            (rows + request->batch_size > this->max_batch ||
+             request->grad_mode != grad_mode)) {
+          break;
+        }
+        rows += request->batch_size;
+        batch.push_back(std::move(request));
+        this->requests.pop_front();
+      }
+    }
+    auto batch_ptr = std::make_shared<Batch>(std::move(batch));
+    this->task_executor->submit(
+        [this, batch_ptr]() { this->run_batch(*batch_ptr); });
+  }
+}
+
+void BatchedTaskModule::run_batch(Batch& batch) {
+  std::vector<c10::IValue> results(batch.size());
+  try {
+    at::GradMode::set_enabled(batch[0]->grad_mode);
+    std::vector<int64_t> batch_sizes;
+    for (const auto& request : batch) {
+      batch_sizes.push_back(request->batch_size);
+      TORCH_CHECK(
+          request->inputs.size() == batch[0]->inputs.size(),
+          "BatchedTaskModule expects the same number of inputs per request");
+    }
+    int64_t rows = std::accumulate(
+        batch_sizes.begin(), batch_sizes.end(), static_cast<int64_t>(0));
+
+    std::vector<c10::IValue> inputs;
+    for (size_t i = 0; i < batch[0]->inputs.size(); i++) {
+      std::vector<at::Tensor> tensors;
+      for (const auto& request : batch) {
+        tensors.push_back(request->inputs[i]);
+      }
+      inputs.emplace_back(
+          tensors.size() == 1 ? tensors[0] : at::cat(tensors, 0));
+    }
+    auto output = this->script_module_.forward(std::move(inputs));
+
+    auto split = [&](const at::Tensor& t) {
+      TORCH_CHECK(
+          t.dim() > 0 && t.size(0) == rows,
+          "BatchedTaskModule expects outputs batched along dim 0");
+      return t.split_with_sizes(batch_sizes, 0);
+    };
+    if (output.isTensor()) {
+      auto parts = split(output.toTensor());
+      for (size_t j = 0; j < batch.size(); j++) {
+        results[j] = parts[j];
+      }
+    } else if (output.isTuple() || output.isTensorList()) {
+      std::vector<std::vector<at::Tensor>> elements(batch.size());
+      auto tensors = output.isTuple()
+          ? c10::fmap(
+                output.toTupleRef().elements(),
+                [](const c10::IValue& v) {
+                  TORCH_CHECK(
+                      v.isTensor(),
+                      "BatchedTaskModule expects tensor outputs");
+                  return v.toTensor();
+                })
+          : output.toTensorVector();
+      for (const auto& t : tensors) {
+        auto parts = split(t);
+        for (size_t j = 0; j < batch.size(); j++) {
+          elements[j].push_back(parts[j]);
+        }
+      }
+      for (size_t j = 0; j < batch.size(); j++) {
+        if (output.isTuple()) {
+          results[j] = c10::ivalue::Tuple::create(
+              c10::fmap(elements[j], [](const at::Tensor& t) {
+                return c10::IValue(t);
+              }));
+        } else {
+          results[j] = c10::List<at::Tensor>(elements[j]);
+        }
+      }
+    } else {
+      TORCH_CHECK(
+          false,
+          "BatchedTaskModule expects a tensor, or a tuple or list of tensors "
+          "output");
+    }
+  } catch (...) {
+    for (auto& request : batch) {
+      request->promise.set_exception(std::current_exception());
+    }
+    return;
+  }
+  for (size_t j = 0; j < batch.size(); j++) {
+    batch[j]->promise.set_value(std::move(results[j]));
+  }
+}
+
+PipelineTaskModule::PipelineTaskModule(
+    const std::vector<torch::jit::Module>& stages,
+    const std::vector<std::shared_ptr<torch_ipex::runtime::CPUPool>>&
+        cpu_pools,
+    int64_t micro_batch_size,
+    int64_t max_in_flight)
+    : stages(stages), cpu_pools(cpu_pools), micro_batch_size(micro_batch_size) {
+  TORCH_CHECK(
+      stages.size() > 0 && stages.size() == cpu_pools.size(),
+      "PipelineTaskModule expects one CPUPool per stage");
+  TORCH_CHECK(
+      micro_batch_size > 0,
+      "PipelineTaskModule expects a positive micro_batch_size");
+  TORCH_CHECK(
+      max_in_flight > 0, "PipelineTaskModule expects a positive max_in_flight");
+  for (const auto& cpu_pool : this->cpu_pools) {
+    this->task_executors.push_back(
+        std::make_shared<TaskExecutor>(*cpu_pool, max_in_flight));
+  }
+}
+
+PipelineTaskModule::~PipelineTaskModule() {
+  pybind11::gil_scoped_release no_gil_guard;
+  // a stage drains into the next one, which is still running
+  for (auto& task_executor : this->task_executors) {
+    task_executor->stop_executor();
+  }
+}
+
+std::unique_ptr<FutureTensor> PipelineTaskModule::run_async(py::args&& args) {
+  TORCH_CHECK(args.size() > 0, "PipelineTaskModule expects tensor inputs");
+  std::vector<at::Tensor> inputs;
+  for (auto& arg : args) {
+    TORCH_CHECK(
+        THPVariable_Check(arg.ptr()),
+        "PipelineTaskModule only takes tensor inputs");
+    inputs.push_back(py::cast<at::Tensor>(arg));
+  }
+  TORCH_CHECK(
+      inputs[0].dim() > 0,
+      "PipelineTaskModule expects inputs batched along dim 0");
+  int64_t batch_size = inputs[0].size(0);
+  for (const auto& t : inputs) {
+    TORCH_CHECK(
+        t.dim() > 0 && t.size(0) == batch_size,
+        "PipelineTaskModule expects inputs of the same size of dim 0");
+  }
+  int64_t num_micro_batches = std::max(
+      (batch_size + this->micro_batch_size - 1) / this->micro_batch_size,
+      static_cast<int64_t>(1));
+
+  auto request = std::make_shared<Request>();
+  request->outputs.resize(num_micro_batches);
+  request->num_remaining_micro_batches.store(num_micro_batches);
+  request->grad_mode = at::GradMode::is_enabled();
+
+  // FutureTensor is going to return
+  std::unique_ptr<FutureTensor> future_tensor_result =
+      std::make_unique<FutureTensor>();
+  future_tensor_result->script_module_initialized_ = true;
+  future_tensor_result->future_script_tensor = request->promise.get_future();
+
+  std::vector<std::shared_ptr<MicroBatch>> micro_batches(num_micro_batches);
+  for (int64_t i = 0; i < num_micro_batches; i++) {
+    micro_batches[i] = std::make_shared<MicroBatch>();
+    micro_batches[i]->request = request;
+    micro_batches[i]->index = i;
+  }
+  for (const auto& t : inputs) {
+    auto parts = t.split(this->micro_batch_size, 0);
+    for (int64_t i = 0; i < num_micro_batches; i++) {
+      micro_batches[i]->inputs.emplace_back(
+          parts.empty() ? t : std::move(parts[i]));
+    }
+  }
+  {
+    // the first stage may be full
+    pybind11::gil_scoped_release no_gil_guard;
+    for (auto& micro_batch : micro_batches) {
+      this->submit_stage(0, std::move(micro_batch));
+    }
+  }
+  return future_tensor_result;
+}
+
+py::object PipelineTaskModule::run_sync(py::args&& args) {
+  std::unique_ptr<FutureTensor> future_tensor_result =
+      this->run_async(std::move(args));
+  return future_tensor_result->get();
+}
+
+void PipelineTaskModule::submit_stage(
+    size_t stage,
+    std::shared_ptr<MicroBatch> micro_batch) {
+  // waits for a free slot when the stage holds max_in_flight micro-batches
+  this->task_executors[stage]->submit(
+      [this, stage, micro_batch]() { this->run_stage(stage, micro_batch); });
+}
+
+void PipelineTaskModule::run_stage(
+    size_t stage,
+    std::shared_ptr<MicroBatch> micro_batch) {
+  auto& request = *micro_batch->request;
+  if (request.failed.load()) {
+    // another micro-batch of the request failed
+    return;
+  }
+  try {
+    at::GradMode::set_enabled(request.grad_mode);
+    auto output = this->stages[stage].forward(std::move(micro_batch->inputs));
+    if (stage + 1 < this->stages.size()) {
+      if (output.isTuple()) {
+        micro_batch->inputs = output.toTupleRef().elements().vec();
+      } else {
+        micro_batch->inputs = {std::move(output)};
+      }
+      this->submit_stage(stage + 1, std::move(micro_batch));
+      return;
+    }
+    request.outputs[micro_batch->index] = std::move(output);
+    if (request.num_remaining_micro_batches.fetch_sub(1) != 1) {
+      return;
+    }
+
+    // the last micro-batch of the request
+    auto concat = [&](const std::function<at::Tensor(const c10::IValue&)>&
+                          get_tensor) {
+      std::vector<at::Tensor> tensors;
+      for (const auto& output : request.outputs) {
+        tensors.push_back(get_tensor(output));
+      }
+      return tensors.size() == 1 ? tensors[0] : at::cat(tensors, 0);
+    };
+    const auto& first = request.outputs[0];
+    c10::IValue result;
+    if (first.isTensor()) {
+      result = concat([](const c10::IValue& v) { return v.toTensor(); });
+    } else if (first.isTuple() || first.isTensorList()) {
+      size_t num_elements = first.isTuple()
+          ? first.toTupleRef().elements().size()
+          : first.toTensorVector().size();
+      std::vector<at::Tensor> elements;
+      for (size_t j = 0; j < num_elements; j++) {
+        elements.push_back(concat([&](const c10::IValue& v) {
+          auto element =
+              v.isTuple() ? v.toTupleRef().elements()[j] : v.toTensorVector()[j];
+          TORCH_CHECK(
+              element.isTensor(), "PipelineTaskModule expects tensor outputs");
+          return element.toTensor();
+        }));
+      }
+      if (first.isTuple()) {
+        result = c10::ivalue::Tuple::create(c10::fmap(
+            elements, [](const at::Tensor& t) { return c10::IValue(t); }));
+      } else {
+        result = c10::List<at::Tensor>(elements);
+      }
+    } else {
+      TORCH_CHECK(
+          false,
+          "PipelineTaskModule expects a tensor, or a tuple or list of tensors "
+          "output");
+    }
+    request.promise.set_value(std::move(result));
+  } catch (...) {
+    if (!request.failed.exchange(true)) {
+      request.promise.set_exception(std::current_exception());
+    }
+  }
+}
+
 } // namespace runtime
 } // namespace torch_ipex
@@ -1,17 +1,23 @@
 #pragma once
 
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <ATen/core/ivalue.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
 #include <torch/csrc/utils/pybind.h>
+#include "ScriptModuleTask.h"
 #include "TaskExecutor.h"
 
 namespace torch_ipex {
@@ -46,9 +52,15 @@ class TORCH_API TaskModule {
   std::unique_ptr<FutureTensor> run_async(
       py::args&& args,
       py::kwargs&& kwargs); /*async execution in threadpool*/
+  // Moves the tasks submitted from now on to the cores of cpu_pool
+  void resize(const torch_ipex::runtime::CPUPool& cpu_pool);
+  // The queue depth of the TaskExecutor, including the running task
+  int64_t get_num_pending_tasks() const;
+
  private:
-  // Script module input
+  // Script module input, run by the C++ ScriptModuleTask
   torch::jit::Module script_module_;
+  std::unique_ptr<ScriptModuleTask> script_task;
   bool script_module_initialized_{false};
   // Module input
   py::object module_;
@@ -60,5 +72,116 @@ class TORCH_API TaskModule {
   py::kwargs kwargs;
 };
 
+/*
+ BatchedTaskModule is a dynamic batcher for a script module. The requests are
+ submitted one by one and coalesced until their batch reaches max_batch or
+ max_delay_us passed since the first one of the batch. Their tensor inputs are
+ concatenated along dim 0 and the batch runs on the TaskExecutor of the
+ CPUPool. The output tensors, or the tensors of an output tuple or list, are
+ split back along dim 0 into the FutureTensor of each request. The batcher
+ thread keeps coalescing the next batch while the TaskExecutor runs the
+ previous one.
+*/
+class TORCH_API BatchedTaskModule {
+ public:
+  explicit BatchedTaskModule(
+      const torch::jit::Module& module,
+      const torch_ipex::runtime::CPUPool& cpu_pool,
+      int64_t max_batch,
+      int64_t max_delay_us);
+  BatchedTaskModule(const BatchedTaskModule& task_module) = delete;
+  BatchedTaskModule(BatchedTaskModule&& task_module) = delete;
+  BatchedTaskModule& operator=(const BatchedTaskModule& task_module) = delete;
+  BatchedTaskModule& operator=(BatchedTaskModule&& task_module) = delete;
+  // Flushes the pending requests before stopping
+  ~BatchedTaskModule();
+  py::object run_sync(py::args&& args); /*sync execution*/
+  std::unique_ptr<FutureTensor> run_async(
+      py::args&& args); /*async execution, batched with the other requests*/
+
+ private:
+  struct Request {
+    std::vector<at::Tensor> inputs;
+    // the size of dim 0 of the inputs
+    int64_t batch_size;
+    bool grad_mode;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<c10::IValue> promise;
+  };
+  using Batch = std::vector<std::shared_ptr<Request>>;
+
+  void run_batcher();
+  void run_batch(Batch& batch);
+
+  torch::jit::Module script_module_;
+  int64_t max_batch;
+  std::chrono::microseconds max_delay;
+
+  // TaskExecutor
+  std::shared_ptr<TaskExecutor> task_executor;
+
+  // Synchronization of the pending requests with the batcher thread
+  std::deque<std::shared_ptr<Request>> requests;
+  bool stop{false};
+  std::mutex batcher_mutex;
+  std::condition_variable batcher_condition;
+  std::thread batcher;
+};
+
+/*
+ PipelineTaskModule runs a model split into script module stages, each stage
+ on the TaskExecutor of its own CPUPool, e.g. one per socket. The tensor
+ inputs of a request are split along dim 0 into micro-batches which flow
+ through the stages: the worker of a stage submits the output of a
+ micro-batch to the next stage, a tensor or the elements of a tuple becoming
+ its inputs. The queue of each stage holds at most max_in_flight
+ micro-batches, so a slow stage holds back the stages before it. The outputs
+ of the last stage are concatenated along dim 0 into the FutureTensor of the
+ request.
+*/
+class TORCH_API PipelineTaskModule {
+ public:
+  explicit PipelineTaskModule(
+      const std::vector<torch::jit::Module>& stages,
+      const std::vector<std::shared_ptr<torch_ipex::runtime::CPUPool>>&
+          cpu_pools,
+      int64_t micro_batch_size,
+      int64_t max_in_flight);
+  PipelineTaskModule(const PipelineTaskModule& task_module) = delete;
+  PipelineTaskModule(PipelineTaskModule&& task_module) = delete;
+  PipelineTaskModule& operator=(const PipelineTaskModule& task_module) =
+      delete;
+  PipelineTaskModule& operator=(PipelineTaskModule&& task_module) = delete;
+  // Flushes the micro-batches in the stages before stopping
+  ~PipelineTaskModule();
+  py::object run_sync(py::args&& args); /*sync execution*/
+  std::unique_ptr<FutureTensor> run_async(
+      py::args&& args); /*async execution through the stages*/
+
+ private:
+  struct Request {
+    // the output of the last stage of each micro-batch
+    std::vector<c10::IValue> outputs;
+    std::atomic<int64_t> num_remaining_micro_batches;
+    std::atomic<bool> failed{false};
+    bool grad_mode;
+    std::promise<c10::IValue> promise;
+  };
+  struct MicroBatch {
+    std::shared_ptr<Request> request;
+    size_t index;
+    std::vector<c10::IValue> inputs;
+  };
+
+  void submit_stage(size_t stage, std::shared_ptr<MicroBatch> micro_batch);
+  void run_stage(size_t stage, std::shared_ptr<MicroBatch> micro_batch);
+
+  std::vector<torch::jit::Module> stages;
+  // The TaskExecutors refer to their CPUPool
+  std::vector<std::shared_ptr<torch_ipex::runtime::CPUPool>> cpu_pools;
+  int64_t micro_batch_size;
+  std::vector<std::shared_ptr<TaskExecutor>> task_executors;
+};
+
 } // namespace runtime
 } // namespace torch_ipex
@@ -1,23 +1,26 @@
 import copy
+import hashlib
+import os
 import sys
+import tempfile
+import types
 import pkg_resources
 
 import torch
 import torch._dynamo
 import torch.fx.experimental.optimization as optimization
-from torch._dynamo.backends.common import fake_tensor_unsupported
 from torch.jit._trace import TracerWarning
-from torch.utils._mode_utils import no_dispatch
-from torch._subclasses import FakeTensor
 import warnings
 
 from .nn import utils
-from .optim._optimizer_utils import optimizer_fusion, IPEX_FUSED_OPTIMIZER_LIST_CPU, IPEX_FUSED_OPTIMIZER_LIST_XPU
+from .optim._optimizer_utils import optimizer_fusion, param_arena, IPEX_FUSED_OPTIMIZER_LIST_CPU, IPEX_FUSED_OPTIMIZER_LIST_XPU
 import intel_extension_for_pytorch._C as core
 from intel_extension_for_pytorch.utils.channels_last_1d import to_channels_last_1d
 from intel_extension_for_pytorch.utils.linear_bn_folding import linear_bn_fuse
+from intel_extension_for_pytorch.utils.memory_profiler import memory_scope
 from enum import IntEnum
-from intel_extension_for_pytorch.cpu._auto_kernel_selection import _enable_dnnl, _disable_dnnl
+from intel_extension_for_pytorch.cpu._auto_kernel_selection import _enable_dnnl, _disable_dnnl, \
+    _enable_runtime_kernel_selection, _disable_runtime_kernel_selection
 import intel_extension_for_pytorch._C as torch_ipex_cpp
 try:
     from . import tpp
@@ -112,8 +115,13 @@ class _Properties(object):
         # optimizer opt conig
         self.split_master_weight_for_bf16 = None
         self.fuse_update_step = None
+        self.contiguous_param_arena = None
+        self.optimizer_state_8bit = None
+        self.stochastic_rounding_for_bf16 = None
         self.auto_kernel_selection = None
         self.graph_mode = None
+        self.fuse_tpp_mlp = None
+        self.fuse_add_layernorm = None
 
 # O0 properties
 class _O0:
@@ -126,8 +134,13 @@ class _O0:
         properties.optimize_lstm = False
         properties.split_master_weight_for_bf16 = False
         properties.fuse_update_step = False
+        properties.contiguous_param_arena = False
+        properties.optimizer_state_8bit = False
+        properties.stochastic_rounding_for_bf16 = False
         properties.auto_kernel_selection = False
         properties.graph_mode = False
+        properties.fuse_tpp_mlp = False
+        properties.fuse_add_layernorm = False
         return properties
 
 
@@ -142,8 +155,13 @@ class _O1:
         properties.optimize_lstm = True
         properties.split_master_weight_for_bf16 = True
         properties.fuse_update_step = True
+        properties.contiguous_param_arena = False
+        properties.optimizer_state_8bit = False
+        properties.stochastic_rounding_for_bf16 = False
         properties.auto_kernel_selection = False
         properties.graph_mode = False
+        properties.fuse_tpp_mlp = False
+        properties.fuse_add_layernorm = False
         return properties
 
 opt_levels = {"O0": _O0(),
@@ -155,6 +173,44 @@ class RunMethods(IntEnum):
     EagerInfer = 3
     EagerTrain = 4
 
+def _graph_cache_key(model, dtype, input, kwargs):
+    # the frozen graph depends on the weights, the input signature, the versions and the ISA it was traced with
+    from ._version import __version__
+    h = hashlib.sha256()
+    h.update(repr((__version__, torch.__version__, core._get_current_isa_level(), str(dtype),
+                   type(model).__module__, type(model).__qualname__, sorted(kwargs.keys()))).encode())
+    for name, t in model.state_dict().items():
+        h.update(repr((name, tuple(t.shape), str(t.dtype))).encode())
+        if t.device.type == 'cpu' and t.layout == torch.strided and not t.is_quantized:
+            h.update(t.detach().contiguous().view(-1).view(torch.uint8).numpy().tobytes())
+    for x in list(input) + [kwargs[k] for k in sorted(kwargs.keys())]:
+        if isinstance(x, torch.Tensor):
+            h.update(repr((tuple(x.shape), str(x.dtype), x.stride())).encode())
+        else:
+            h.update(repr(x).encode())
+    return h.hexdigest()
+
+def _graph_cache_path(key, suffix):
+    # the cache is enabled by IPEX_GRAPH_CACHE_DIR
+    cache_dir = os.environ.get('IPEX_GRAPH_CACHE_DIR')
+    if not cache_dir:
+        return None
+    return os.path.join(cache_dir, key + suffix)
+
+def _graph_cache_save(path, save):
+    # written to a temporary file and renamed, so that concurrent processes never load a partial file
+    tmp = None
+    try:
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path))
+        os.close(fd)
+        save(tmp)
+        os.replace(tmp, path)
+    except Exception:
+        warnings.warn("Failed to save the graph to the cache " + path)
+        if tmp is not None and os.path.exists(tmp):
+            os.remove(tmp)
+
 class GraphCapture(object):
 
     def __init__(self, model, train, dtype, weights_prepack):
@@ -167,15 +223,12 @@ class GraphCapture(object):
 
     def __call__(self, func):
 
-        @fake_tensor_unsupported
         def compiler(gm: torch.fx.GraphModule, example_inputs: List[torch.Tensor]):
+            from .utils._fx_lowering import lower_to_ipex
             try:
-                with torch.no_grad():
-                    traced_model = torch.jit.trace(gm.eval(), example_inputs)
-                    traced_model = torch.jit.freeze(traced_model)
-                return traced_model
+                return lower_to_ipex(gm)
             except Exception:
-                warnings.warn("JIT trace failed during the 'compiler' process.")
+                warnings.warn("Lowering to IPEX ops failed during the 'compiler' process.")
                 return gm
 
         @functools.wraps(func)
@@ -201,7 +254,28 @@ class GraphCapture(object):
                             self.method = RunMethods.EagerTrain
                             return func(*input, **kwargs)
                         else:
+                            cache_key = None
+                            if os.environ.get('IPEX_GRAPH_CACHE_DIR'):
+                                try:
+                                    cache_key = _graph_cache_key(self.model, self.dtype, input, kwargs)
+                                except Exception:
+                                    cache_key = None
+                            jit_path = _graph_cache_path(cache_key, '.pt') if cache_key else None
+                            dynamo_path = _graph_cache_path(cache_key, '.dynamo') if cache_key else None
+                            if jit_path and os.path.exists(jit_path):
+                                try:
+                                    cached_model = torch.jit.load(jit_path).eval()
+                                    output = cached_model(*input, **kwargs)
+                                    self.model = cached_model
+                                    self.method = RunMethods.JIT
+                                    logging.debug("load graph from the cache " + jit_path)
+                                    return output
+                                except Exception:
+                                    warnings.warn("Failed to load the graph from the cache " + jit_path)
                             try:
+                                if dynamo_path and os.path.exists(dynamo_path):
+                                    # JIT trace already failed on this model and inputs.
+                                    raise RuntimeError("JIT trace skipped by the cache " + dynamo_path)
                                 # Try JIT trace.
                                 # Tracing only records operations done when the given function is run on the given tensors.
                                 # Therefore, the returned ScriptModule will always run the same traced graph on any input.
@@ -214,11 +288,15 @@ class GraphCapture(object):
                                     traced_model = torch.jit.trace(self.model.eval(), input).eval()
                                     traced_model = torch.jit.freeze(traced_model)
                                     output = traced_model(*input, **kwargs)
+                                    if jit_path:
+                                        _graph_cache_save(jit_path, lambda f: torch.jit.save(traced_model, f))
                                     self.model = traced_model
                                     self.method = RunMethods.JIT
                                     logging.debug("generate graph by JIT trace.")
                                     return output
                             except:
+                                if dynamo_path and not os.path.exists(dynamo_path):
+                                    _graph_cache_save(dynamo_path, lambda f: open(f, 'w').close())
                                 try:
                                     # JIT trace failed, try torchdynamo with JIT trace backend.
                                     torch._dynamo.reset()
@@ -249,9 +327,16 @@ def optimize(
     optimize_lstm=None,
     split_master_weight_for_bf16=None,
     fuse_update_step=None,
+    contiguous_param_arena=None,
+    optimizer_state_8bit=None,
+    stochastic_rounding_for_bf16=None,
+    optimizer_step_cpu_pool=None,
     auto_kernel_selection=None,
     sample_input=None,
-    graph_mode=None
+    graph_mode=None,
+    fuse_tpp_mlp=None,
+    fuse_add_layernorm=None,
+    checkpoint=None
 ):
     r"""
     Apply optimizations at Python frontend to the given model (nn.Module), as
@@ -311,8 +396,10 @@ def optimize(
             on the graph. This only works for inference model. The default value
             is ``None``. Explicitly setting this knob overwrites the configuration
             set by ``level`` knob.
-        optimize_lstm (bool): Whether to replace ``nn.LSTM`` with ``IPEX LSTM``
-            which takes advantage of oneDNN kernels to get better performance.
+        optimize_lstm (bool): Whether to replace ``nn.LSTM`` and ``nn.GRU``
+            with ``IPEX LSTM`` and ``IPEX GRU``, including the bidirectional
+            ones and the LSTMs with projections, which take advantage of
+            oneDNN kernels to get better performance.
             The default value is ``None``. Explicitly setting this knob
             overwrites the configuration set by ``level`` knob.
         split_master_weight_for_bf16 (bool): Whether to split master weights
@@ -325,6 +412,46 @@ def optimize(
             which have better performance. It doesn't support all optimizers.
             The default value is ``None``. Explicitly setting this knob
             overwrites the configuration set by ``level`` knob.
+        contiguous_param_arena (bool) [experimental]: Whether to allocate the
+            parameters, gradients and optimizer states of the optimizer in
+            contiguous 64B aligned arenas, the tensors being views into them.
+            The optimizer step then streams through a few buffers and the
+            gradients can be allreduced without bucketing copies by
+            ``optimizer.param_arena.all_reduce_grads()``. The prepacked weights
+            stay out of the arenas, and ``zero_grad`` zeroes the arena gradients
+            in place even with ``set_to_none``. Only works for CPU training. The
+            default value is ``None``, meaning ``False`` for both levels.
+        optimizer_state_8bit (bool) [experimental]: Whether the fused steps of
+            ``torch.optim.Adam`` and ``torch.optim.AdamW`` store the moments in
+            8 bits, with one fp32 scale per block of 256 elements, which cuts
+            the memory of the optimizer states by about 4x. The moments are
+            dequantized and requantized inside the fused step. ``amsgrad`` is
+            unsupported. Requires ``fuse_update_step`` and only works for CPU
+            training. The default value is ``None``, meaning ``False`` for both
+            levels.
+        stochastic_rounding_for_bf16 (bool) [experimental]: Whether to train
+            with pure BF16 parameters, without the trail of
+            ``split_master_weight_for_bf16`` nor FP32 master weights. The fused
+            update steps compute in FP32 and round the updated parameters to
+            BF16 stochastically, which keeps the small updates on average and
+            halves the parameter memory and update traffic of split master
+            weights. The rounding noise is drawn from the default CPU generator.
+            Requires ``fuse_update_step`` and one of the SGD, Adagrad, Adam,
+            Lamb, Lars and Adafactor optimizers, and only works for BF16
+            training on CPU. The default value is ``None``, meaning ``False``
+            for both levels.
+        optimizer_step_cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool)
+            [experimental]: The cores to run the fused update steps on while
+            backward runs. If given, the step of each parameter is dispatched
+            to them as soon as its gradient is accumulated and the gradient is
+            freed right after, which hides most of the optimizer time and
+            lowers the peak memory of the gradients. ``optimizer.step()`` then
+            waits for the steps of the last backward, so the gradients can not
+            be accumulated over several backwards nor clipped or unscaled
+            before the step. Requires ``fuse_update_step`` and the runtime
+            extension, and only works for CPU training without
+            ``contiguous_param_arena``. The default value is ``None``, meaning
+            the steps run in ``optimizer.step()``.
         sample_input (tuple or torch.Tensor): Whether to feed sample input data to ipex.optimize. The shape of
             input data will impact the block format of packed weight. If not feed a sample
             input, Intel® Extension for PyTorch* will pack the weight per some predefined heuristics.
@@ -335,10 +462,45 @@ def optimize(
             is False. Intel® Extension for PyTorch* will try to optimize the
             kernel selection for better performance if this knob is set to
             ``True``. You might get better performance at the cost of extra memory usage.
+            If set to ``'runtime'``, the fp32 inference linears keep the MKL packed weights
+            and time the MKL packed, MKL and oneDNN kernels on the first runs of each new
+            input shape and thread count, locking in the fastest one for it. The locked in
+            kernels may be saved with ``ipex._save_kernel_selection_table`` and loaded by the
+            deployments with ``ipex._load_kernel_selection_table``.
             The default value is ``None``. Explicitly setting this knob overwrites the
             configuration set by ``level`` knob.
         graph_mode: (bool) [experimental]: It will automatically apply a combination of methods
             to generate graph or multiple subgraphs if True. The default value is ``False``.
+            When the environment variable ``IPEX_GRAPH_CACHE_DIR`` is set, the frozen TorchScript
+            graphs are saved in that directory, keyed by the weights, the input signature, the
+            versions and the ISA, and loaded instead of traced by the next processes.
+        fuse_tpp_mlp (bool) [experimental]: Whether to replace the ``nn.Linear`` +
+            ``nn.GELU`` and ``nn.Linear`` (+ ``nn.Dropout``) + ``nn.LayerNorm``
+            runs of the ``nn.Sequential`` of the model with the TPP fused dense
+            blocks of ``intel_extension_for_pytorch.tpp.fused_mlp``, whose
+            features must be multiples of 16. The fused blocks keep the
+            parameters of the replaced modules in FP32 and run in BF16 with
+            ``dtype=torch.bfloat16`` or under autocast, so that their
+            parameters are not cast nor prepacked. Only works for CPU
+            training. The default value is ``None``, meaning ``False`` for
+            both levels.
+        fuse_add_layernorm (bool) [experimental]: Whether to trace the model
+            with FX and run its tensor add + ``nn.LayerNorm`` (or
+            ``F.layer_norm``) as a fused op, whose backward computes the grads
+            of the sum, the weight and the bias in a single pass. The model is
+            kept as is if it can't be traced. Only works for CPU training. The
+            default value is ``None``, meaning ``False`` for both levels.
+        checkpoint (str or dict) [experimental]: The checkpoint of the
+            weights of an inference model built without them, e.g. on the
+            meta device: a directory saved by ``ipex.save_checkpoint``, a file
+            saved by ``torch.save``, which is memory mapped, or a state dict.
+            The params are read from the mapped checkpoint and converted to
+            ``dtype`` and prepacked module by module, so that the fp32 model,
+            its copy and the packed weights are never all in memory: the peak
+            memory is about the optimized model. The model is optimized
+            inplace, without ``conv_bn_folding``, ``linear_bn_folding`` nor
+            ``sample_input``. Only works for CPU inference. The default value
+            is ``None``, meaning the weights of the model are optimized.
 
     Returns:
         Model and optimizer (if given) modified according to the ``level`` knob
@@ -406,7 +568,7 @@ def optimize(
 
     # auto model channels_last memory format conversion
     # TODO: for xpu, the auto channels last is temp disabled
-    if auto_channels_last and device_type == 'cpu':
+    if auto_channels_last and device_type == 'cpu' and checkpoint is None:
         _convert_convNd_weight_memory_format(model)
 
     if level is not None:
@@ -425,13 +587,48 @@ def optimize(
         opt_properties.split_master_weight_for_bf16 = split_master_weight_for_bf16
     if fuse_update_step is not None:
         opt_properties.fuse_update_step = fuse_update_step
+    if contiguous_param_arena is not None:
+        opt_properties.contiguous_param_arena = contiguous_param_arena
+    if optimizer_state_8bit is not None:
+        opt_properties.optimizer_state_8bit = optimizer_state_8bit
+    if stochastic_rounding_for_bf16 is not None:
+        opt_properties.stochastic_rounding_for_bf16 = stochastic_rounding_for_bf16
     if auto_kernel_selection is not None:
         opt_properties.auto_kernel_selection = auto_kernel_selection
     if graph_mode is not None:
         opt_properties.graph_mode = graph_mode
+    if fuse_tpp_mlp is not None:
+        opt_properties.fuse_tpp_mlp = fuse_tpp_mlp
+    if fuse_add_layernorm is not None:
+        opt_properties.fuse_add_layernorm = fuse_add_layernorm
+
+    if opt_properties.optimizer_state_8bit and (
+            device_type != 'cpu' or not opt_properties.fuse_update_step or
+            type(optimizer) not in [torch.optim.Adam, torch.optim.AdamW]):
+        warnings.warn("The 8-bit optimizer states only support the fused update step of " +
+            "torch.optim.Adam and torch.optim.AdamW on CPU, so disable them.")
+        opt_properties.optimizer_state_8bit = False
+
+    if opt_properties.stochastic_rounding_for_bf16 and (
+            device_type != 'cpu' or dtype is not torch.bfloat16 or not model.training or
+            not opt_properties.fuse_update_step or opt_properties.optimizer_state_8bit or
+            type(optimizer) not in IPEX_FUSED_OPTIMIZER_LIST_CPU):
+        warnings.warn("The stochastic rounding only supports the fused update steps of SGD, Adagrad, Adam, " +
+            "Lamb, Lars and Adafactor for bf16 training on CPU, without 8-bit optimizer states, so disable it.")
+        opt_properties.stochastic_rounding_for_bf16 = False
+
+    if optimizer_step_cpu_pool is not None and (
+            device_type != 'cpu' or not model.training or not opt_properties.fuse_update_step or
+            opt_properties.contiguous_param_arena):
+        warnings.warn("Overlapping the optimizer step with backward only supports the fused update steps " +
+            "of CPU training without contiguous param arena, so disable it.")
+        optimizer_step_cpu_pool = None
 
     _disable_dnnl()
-    if opt_properties.auto_kernel_selection:
+    _disable_runtime_kernel_selection()
+    if opt_properties.auto_kernel_selection == 'runtime':
+        _enable_runtime_kernel_selection()
+    elif opt_properties.auto_kernel_selection:
         _enable_dnnl()
 
     # when on xpu, some features are not supported
@@ -443,6 +640,9 @@ def optimize(
             warnings.warn("For XPU device, the split master weight is unsupported for now, so temp to disable it.")
             # TODO: for xpu, the split master weight will be supported soon
             opt_properties.split_master_weight_for_bf16 = False
+        if opt_properties.contiguous_param_arena:
+            warnings.warn("For XPU device, the contiguous param arena is unsupported, so disable it.")
+            opt_properties.contiguous_param_arena = False
         if opt_properties.graph_mode:
             warnings.warn("For XPU, the Out-of-Box (OOB) solution for inference is to trace model outside of the " +
                 "ipex.optimize, so temp to disable the graph mode.")
@@ -459,12 +659,41 @@ def optimize(
             opt_properties.weights_prepack = False
             sample_input = None
 
+    if checkpoint is not None:
+        assert device_type == 'cpu' and not model.training, \
+            "The checkpoint of ipex.optimize only works for CPU inference"
+        if opt_properties.conv_bn_folding or opt_properties.linear_bn_folding or sample_input is not None:
+            warnings.warn("The conv/linear BatchNorm folding and the sample input are disabled " +
+                "when the model is loaded from a checkpoint.")
+        opt_properties.conv_bn_folding = False
+        opt_properties.linear_bn_folding = False
+        sample_input = None
+        # no copy of the model of meta tensors, whose tensors are replaced by the loaded ones
+        inplace = True
+
     if inplace:
         optimized_model = model
         optimized_optimizer = optimizer
     else:
         optimized_model, optimized_optimizer = _copy_model_and_optimizer(model, optimizer)
 
+    if opt_properties.weights_prepack and device_type == 'cpu':
+        if dtype == torch.bfloat16:
+            assert core.onednn_has_bf16_support(), \
+                    "BF16 weight prepack needs the cpu support avx512bw, avx512vl and avx512dq, " + \
+                    "please set dtype to torch.float or set weights_prepack to False."
+        if dtype == torch.half:
+            assert core.onednn_has_fp16_support(), \
+                    "FP16 weight prepack needs the cpu support avx512_core_fp16, " + \
+                    "please set dtype to torch.float or set weights_prepack to False."
+
+    if checkpoint is not None:
+        with memory_scope('optimize::load_checkpoint'):
+            optimized_model = utils._lazy_load.load_and_prepack(
+                optimized_model, checkpoint, dtype, opt_properties.weights_prepack)
+        if auto_channels_last and not opt_properties.weights_prepack:
+            _convert_convNd_weight_memory_format(optimized_model)
+
     if sample_input is not None:
         if isinstance(sample_input, torch.Tensor):
             sample_input = (sample_input,)
@@ -483,11 +712,21 @@ def optimize(
                 warnings.warn("Linear BatchNorm folding failed during the optimize process.")
         if opt_properties.replace_dropout_with_identity:
             utils._model_convert.replace_dropout_with_identity(optimized_model)
-        if dtype == torch.bfloat16:
+        # the params loaded from a checkpoint are converted and prepacked already
+        if dtype == torch.bfloat16 and checkpoint is None:
             optimized_model = utils._model_convert.convert_module_data_type(optimized_model, torch.bfloat16)
-        if dtype == torch.half:
+        if dtype == torch.half and checkpoint is None:
             optimized_model = utils._model_convert.convert_module_data_type(optimized_model, torch.half)
 
+    if opt_properties.fuse_tpp_mlp and model.training and device_type == 'cpu':
+        # the fused blocks keep the params, the optimizer is unchanged
+        tpp.fused_mlp.fuse_mlp(optimized_model)
+    if opt_properties.fuse_add_layernorm and model.training and device_type == 'cpu':
+        from .utils._fx_lowering import lower_add_layer_norm_for_training
+        try:
+            optimized_model = lower_add_layer_norm_for_training(optimized_model)
+        except Exception:
+            warnings.warn("Failed to trace the model with FX, add + LayerNorm is not fused.")
     if opt_properties.optimize_lstm:
         utils._model_convert.replace_lstm_with_ipex_lstm(optimized_model, optimized_optimizer)
     if model.training and opt_properties.split_master_weight_for_bf16 and dtype is torch.bfloat16:
@@ -498,7 +737,8 @@ def optimize(
                 "have reset split_master_weight_for_bf16 flag to False. " +
                 "If you want to use split_master_weight_for_bf16. " +
                 "Please set both split_master_weight_for_bf16 and fuse_update_step to True.")
-        elif type(optimizer) not in IPEX_FUSED_OPTIMIZER_LIST_CPU and device_type == 'cpu':
+        elif type(optimizer) not in IPEX_FUSED_OPTIMIZER_LIST_CPU and device_type == 'cpu' and \
+                not opt_properties.optimizer_state_8bit:
             opt_properties.split_master_weight_for_bf16 = False
             opt_properties.fuse_update_step = False
             warnings.warn(
@@ -516,30 +756,30 @@ def optimize(
     if hasattr(optimized_optimizer, 'params_attr'):
         params_attr = optimized_optimizer.params_attr
     if dtype == torch.bfloat16 and model.training:
-        optimized_model, optimized_optimizer, params_attr = utils._weight_cast.weight_dtype_convert_with_ipex(
-            optimized_model, optimized_optimizer, params_attr, opt_properties.split_master_weight_for_bf16, convert_dtype=torch.bfloat16)
+        with memory_scope('optimizer::master_weights'):
+            optimized_model, optimized_optimizer, params_attr = utils._weight_cast.weight_dtype_convert_with_ipex(
+                optimized_model, optimized_optimizer, params_attr,
+                opt_properties.split_master_weight_for_bf16 or opt_properties.stochastic_rounding_for_bf16,
+                convert_dtype=torch.bfloat16, stochastic_rounding=opt_properties.stochastic_rounding_for_bf16)
     if dtype == torch.half and model.training:
         assert device_type != 'xpu', "For now, XPU device does not support model training with half precision."
-        optimized_model, optimized_optimizer, params_attr = utils._weight_cast.weight_dtype_convert_with_ipex(
-            optimized_model, optimized_optimizer, params_attr, False, convert_dtype=torch.half)
+        with memory_scope('optimizer::master_weights'):
+            optimized_model, optimized_optimizer, params_attr = utils._weight_cast.weight_dtype_convert_with_ipex(
+                optimized_model, optimized_optimizer, params_attr, False, convert_dtype=torch.half)
     # Since TorchDynamo cannot handle custom operations yet, for the case of inference graph mode,
     # the weights prepacking here is temporarily cancelled, and it will be completed on the graph.
     if opt_properties.weights_prepack:
         if device_type == 'cpu':
-            if dtype == torch.bfloat16:
-                assert core.onednn_has_bf16_support(), \
-                        "BF16 weight prepack needs the cpu support avx512bw, avx512vl and avx512dq, " + \
-                        "please set dtype to torch.float or set weights_prepack to False."
-            if dtype == torch.half:
-                assert core.onednn_has_fp16_support(), \
-                        "FP16 weight prepack needs the cpu support avx512_core_fp16, " + \
-                        "please set dtype to torch.float or set weights_prepack to False."
-            optimized_model, optimized_optimizer, params_attr = utils._weight_prepack.weight_prepack_with_ipex(
-                optimized_model, optimized_optimizer, params_attr, inplace,  'cpu')
+            if checkpoint is None:
+                optimized_model, optimized_optimizer, params_attr = utils._weight_prepack.weight_prepack_with_ipex(
+                    optimized_model, optimized_optimizer, params_attr, inplace,  'cpu')
             torch._dynamo.allow_in_graph(utils._weight_prepack._IPEXConv2d)
+            torch._dynamo.allow_in_graph(utils._weight_prepack._IPEXConv3d)
             torch._dynamo.allow_in_graph(utils._weight_prepack._IPEXConvTranspose2d)
+            torch._dynamo.allow_in_graph(utils._weight_prepack._IPEXConvTranspose3d)
             torch._dynamo.allow_in_graph(utils._weight_prepack._IPEXLinear)
             torch._dynamo.allow_in_graph(utils._model_convert._LSTM)
+            torch._dynamo.allow_in_graph(utils._model_convert._GRU)
         else:
             assert device_type == 'xpu', "Unknown device type, only support device CPU and XPU"
             optimized_model, optimized_optimizer, params_attr = utils._weight_prepack.weight_prepack_with_ipex(
@@ -557,54 +797,28 @@ def optimize(
     # with an optimizer
     if opt_properties.fuse_update_step:
         optimized_optimizer = optimizer_fusion(
-            optimized_optimizer, opt_properties.split_master_weight_for_bf16)
+            optimized_optimizer, opt_properties.split_master_weight_for_bf16,
+            state_8bit=opt_properties.optimizer_state_8bit, overlap_cpu_pool=optimizer_step_cpu_pool)
+    if opt_properties.contiguous_param_arena:
+        optimized_optimizer = param_arena(optimized_optimizer)
     return optimized_model, optimized_optimizer
 
-def defake(x):
-    if not isinstance(x, FakeTensor):
-        return x
-    if x._has_symbolic_sizes_strides:
-        size = [
-            s.node.shape_env.size_hint(s.node.expr)
-            if isinstance(s, torch.SymInt)
-            else s
-            for s in x.size()
-        ]
-        stride = [
-            s.node.shape_env.size_hint(s.node.expr)
-            if isinstance(s, torch.SymInt)
-            else s
-            for s in x.stride()
-        ]
-    else:
-        size = x.size()
-        stride = x.stride()
-    y = torch.empty_strided(
-        size,
-        stride,
-        dtype=x.dtype,
-        device=x.device,
-        requires_grad=x.requires_grad,
-    )
-    y.zero_()
-    return y
-
 def compile(
     model: torch.fx.GraphModule,
     example_inputs: List[torch.Tensor],
     mode: Union[str, None] = None,
     options: Optional[Dict[str, Union[str, builtins.int, builtins.bool]]] = None
 ) -> Callable:
-
+    r"""
+    The ``torch.compile`` backend of IPEX for inference: the nodes of the FX graph are lowered to IPEX ops (prepacked
+    linear and conv modules, add + LayerNorm, flash attention) without tracing it again, so its symbolic shapes stay
+    symbolic and a new input shape doesn't compile again. The nodes without an IPEX lowering run as they are.
+    """
+    from .utils._fx_lowering import lower_to_ipex
     try:
-        with no_dispatch():
-            real_inputs = list(map(defake, example_inputs))
-            with torch.no_grad():
-                traced_model = torch.jit.trace(model.eval(), real_inputs)
-                traced_model = torch.jit.freeze(traced_model)
-            return traced_model
+        return lower_to_ipex(model)
     except Exception:
-        warnings.warn("JIT trace failed during the IPEX compile process.")
+        warnings.warn("Lowering to IPEX ops failed during the IPEX compile process.")
         return model
 
 def enable_onednn_fusion(enabled):
@@ -757,10 +971,14 @@ def fast_bert(model, dtype=torch.float, optimizer=None, unpad=False):
         >>> model.eval()
         >>> optimized_model = ipex.tpp_bert(model, dtype=torch.bfloat16)
         >>> # running evaluation step.
+        >>> # or the requests of variable lengths, packed without padding.
+        >>> outputs, pooled_output = optimized_model.varlen_forward([input_ids_0, input_ids_1])
         >>> # bfloat16 training case.
         >>> optimizer = ...
         >>> model.train()
         >>> optimized_model, optimized_optimizer = ipex.fast_bert(model, dtype=torch.bfloat16, optimizer=optimizer, unpad=True, seed=args.seed)
+        >>> # or the activations of the layers kept, compressed or recomputed to fit a budget in bytes.
+        >>> optimized_model.plan_activation_policy(budget, input_ids, attention_mask=attention_mask)
         >>> # running training step.
 
     """
@@ -810,7 +1028,11 @@ def fast_bert(model, dtype=torch.float, optimizer=None, unpad=False):
     new_model.load_state_dict(model.state_dict())#copy the original params into the tpp module
     tpp.block(new_model)#get block format weights/bias
     if optimizer is None:
+        #batched inference of requests of variable lengths without padding them
+        new_model.varlen_forward = types.MethodType(tpp.fused_bert.varlen_forward, new_model)
         return new_model
+    #the activations saved for backward by the layers, from a memory budget
+    new_model.plan_activation_policy = types.MethodType(tpp.fused_bert.plan_activation_policy, new_model)
     #replace the original pytorch/transformer optimizer with tpp optimizer for SGD/AdamW
     #keep the original optimizer state and replace the params with the blocked tpp params
     param_pair = {}
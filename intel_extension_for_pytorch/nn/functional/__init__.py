@@ -1,2 +1,3 @@
 from .interaction import interaction, InteractionFunc
+from .bce_with_logits_head import bce_with_logits_head, BCEWithLogitsHeadFunc
 from . import _embeddingbag, _tensor_method, _roi_align
@@ -19,6 +19,22 @@ def _embedding_bag_fast_path_sum(
         return False
     return True
 
+def _embedding_bag_fast_path_pooling(
+    weights: Tensor,
+    mode: int = 0,
+    scale_grad_by_freq: bool = False,
+    per_sample_weights: Optional[Tensor] = None,
+    padding_idx: Optional[int] = None
+) -> bool:
+    # weighted sum (mode 0) and max (mode 2) pooling
+    if mode not in (0, 2) or scale_grad_by_freq or padding_idx is not None:
+        return False
+    if weights.stride(1) != 1 or weights.dtype not in (torch.float, torch.bfloat16):
+        return False
+    if per_sample_weights is not None and (mode != 0 or per_sample_weights.dtype != weights.dtype):
+        return False
+    return True
+
 torch_embedding_bag = torch.embedding_bag
 
 def _embeddingbag(
@@ -39,6 +55,12 @@ def _embeddingbag(
         # torch.embedding_bag expected 4 Tensor returned
         # here we only return 1 tensor since the other three tensors are not needed in our fast path
         ret = (ret, torch.empty(0), torch.empty(0), torch.empty(0))
+    elif _embedding_bag_fast_path_pooling(
+        weights, mode, scale_grad_by_freq, per_sample_weights, padding_idx
+    ):
+        ret = torch.ops.torch_ipex.embedding_bag_pooling(
+            weights, indices, offsets, per_sample_weights, mode, sparse, include_last_offset)
+        ret = (ret, torch.empty(0), torch.empty(0), torch.empty(0))
     else:
         warnings.warn('Fallback to torch.embedding bag')
         ret = torch_embedding_bag(weights, indices, offsets, scale_grad_by_freq, mode, sparse, per_sample_weights, include_last_offset, padding_idx)
@@ -102,3 +102,43 @@ def roi_align(
                                            output_size[0], output_size[1],
                                            sampling_ratio, aligned)
 
+
+def multi_level_roi_align(
+    features: List[Tensor],
+    boxes: Union[Tensor, List[Tensor]],
+    output_size: BroadcastingList2[int],
+    spatial_scales: List[float],
+    sampling_ratio: int = -1,
+    aligned: bool = False,
+    canonical_scale: int = 224,
+    canonical_level: int = 4,
+) -> Tensor:
+    """
+    Performs RoI Align over the levels of a feature pyramid, as the ``MultiScaleRoIAlign`` of torchvision.
+    Each box is assigned to a level with the heuristic of the Feature Pyramid Networks paper,
+    ``floor(canonical_level + log2(sqrt(area) / canonical_scale))`` clamped to the available levels,
+    and all the boxes are pooled in one parallel region, with channels last support and a matching backward.
+
+    Args:
+        features (List[Tensor[N, C, H_l, W_l]]): the feature maps of consecutive pyramid levels, from
+            the finest to the coarsest.
+        boxes (Tensor[K, 5] or List[Tensor[L, 4]]): the box coordinates, see :func:`roi_align`.
+        output_size (int or Tuple[int, int]): the size of the output after the pooling, as (height, width).
+        spatial_scales (List[float]): the scale of each feature level, e.g. ``[1/4, 1/8, 1/16, 1/32]``.
+        sampling_ratio (int): see :func:`roi_align`. Default: -1
+        aligned (bool): see :func:`roi_align`. Default: False
+        canonical_scale (int): the box size mapped to ``canonical_level``. Default: 224
+        canonical_level (int): the level of the boxes of ``canonical_scale``. Default: 4
+
+    Returns:
+        Tensor[K, C, output_size[0], output_size[1]]: The pooled RoIs, in the order of the boxes.
+    """
+    _check_roi_boxes_shape(boxes)
+    rois = boxes
+    output_size = _pair(output_size)
+    if not isinstance(rois, torch.Tensor):
+        rois = _convert_boxes_to_roi_format(rois)
+    return torch.ops.torch_ipex.MultiLevelROIAlign_forward(features, rois, spatial_scales,
+                                                     output_size[0], output_size[1],
+                                                     sampling_ratio, aligned,
+                                                     canonical_scale, canonical_level)
@@ -0,0 +1,43 @@
+import torch
+from torch.autograd import Function
+
+def bce_with_logits_head(input, weight, bias, target):
+    r"""
+    The training head of DLRM: the mean binary cross entropy with logits of the
+    last top MLP layer, i.e.
+    ``binary_cross_entropy_with_logits(linear(input, weight, bias).view(-1), target)``.
+
+    The logit GEMV, the numerically stable loss and its mean are computed in a
+    single parallel pass over the batch, and the backward scatters the gradient
+    of every logit into the gradients of the input, the weight and the bias in
+    a single pass as well, without materializing the sigmoid of the logits.
+
+    Args:
+        input (Tensor): the input of the last layer, of shape :math:`(B, K)`
+        weight (Tensor): the weight of the last ``torch.nn.Linear(K, 1)``, of
+            shape :math:`(1, K)`, in the dtype of ``input`` (float or bfloat16)
+        bias (Tensor or None): the bias of the last layer, of shape :math:`(1)`
+        target (Tensor): the click labels, of shape :math:`(B)` or :math:`(B, 1)`
+
+    Returns:
+        The scalar mean loss, in the dtype of ``input``.
+    """
+
+    if torch.is_grad_enabled():
+        return BCEWithLogitsHeadFunc.apply(input, weight, bias, target)
+    return torch.ops.torch_ipex.bce_with_logits_head_forward(input, weight, bias, target)[0]
+
+class BCEWithLogitsHeadFunc(Function):
+    @staticmethod
+    def forward(ctx, input, weight, bias, target):
+        loss, logits = torch.ops.torch_ipex.bce_with_logits_head_forward(input, weight, bias, target)
+        ctx.bias_defined = bias is not None
+        ctx.save_for_backward(input, weight, target, logits)
+        return loss
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        input, weight, target, logits = ctx.saved_tensors
+        grad_input, grad_weight, grad_bias = torch.ops.torch_ipex.bce_with_logits_head_backward(
+            grad_out, input, weight, target, logits, ctx.bias_defined)
+        return grad_input, grad_weight, grad_bias if ctx.bias_defined else None, None
@@ -1,5 +1,15 @@
 from .frozen_batch_norm import FrozenBatchNorm2d
 from . import _roi_align
 from .merged_embeddingbag import MergedEmbeddingBagWithSGD
+from .merged_embeddingbag import MergedEmbeddingBagWithAdagrad
+from .merged_embeddingbag import MergedEmbeddingBagWithAdam
 from .merged_embeddingbag import MergedEmbeddingBag
+from .merged_embeddingbag import QuantizedMergedEmbeddingBag
+from .merged_embeddingbag import CompositionalMergedEmbeddingBag
+from .distributed_merged_embeddingbag import DistributedMergedEmbeddingBagWithSGD
 from .linear_fuse_eltwise import IPEXLinearEltwise
+from .linear_fuse_eltwise import IPEXLinearEpilogue
+from .weight_only_quantization import WeightOnlyQuantizedLinear
+from .streaming_lstm import StreamingLSTM
+from .streaming_conv1d import StreamingConv1d
+from .kv_cache import BeamKVCache
@@ -36,3 +36,38 @@ class RoIAlign(nn.Module):
         tmpstr += ', aligned=' + str(self.aligned)
         tmpstr += ')'
         return tmpstr
+
+class MultiLevelRoIAlign(nn.Module):
+    """
+    See :func:`multi_level_roi_align`.
+    """
+    def __init__(
+        self,
+        output_size: BroadcastingList2[int],
+        spatial_scales: List[float],
+        sampling_ratio: int,
+        aligned: bool = False,
+        canonical_scale: int = 224,
+        canonical_level: int = 4,
+    ):
+        super(MultiLevelRoIAlign, self).__init__()
+        self.output_size = output_size
+        self.spatial_scales = spatial_scales
+        self.sampling_ratio = sampling_ratio
+        self.aligned = aligned
+        self.canonical_scale = canonical_scale
+        self.canonical_level = canonical_level
+
+    def forward(self, features: List[Tensor], rois: Tensor) -> Tensor:
+        return F._roi_align.multi_level_roi_align(features, rois, self.output_size, self.spatial_scales,
+                                                  self.sampling_ratio, self.aligned,
+                                                  self.canonical_scale, self.canonical_level)
+
+    def __repr__(self) -> str:
+        tmpstr = self.__class__.__name__ + '('
+        tmpstr += 'output_size=' + str(self.output_size)
+        tmpstr += ', spatial_scales=' + str(self.spatial_scales)
+        tmpstr += ', sampling_ratio=' + str(self.sampling_ratio)
+        tmpstr += ', aligned=' + str(self.aligned)
+        tmpstr += ')'
+        return tmpstr
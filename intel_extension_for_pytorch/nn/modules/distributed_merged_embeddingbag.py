@@ -0,0 +1,259 @@
+import torch
+import torch.distributed as dist
+from torch import Tensor, nn
+from torch.autograd import Function
+from typing import List, Optional
+from .merged_embeddingbag import MergedEmbeddingBagWithSGD, EmbeddingSpec
+
+def shard_tables_by_cost(
+    embedding_specs: List[EmbeddingSpec],
+    world_size: int
+) -> List[int]:
+    r"""
+    Greedily place tables on ranks, largest (num_of_features x feature_size) first, each on the rank with the least
+    placed cost so far. Returns the owner rank of every table.
+    """
+    table_to_rank = [0] * len(embedding_specs)
+    loads = [0] * world_size
+    order = sorted(
+        range(len(embedding_specs)),
+        key=lambda t: embedding_specs[t].num_of_features * embedding_specs[t].feature_size,
+        reverse=True)
+    for t in order:
+        rank = loads.index(min(loads))
+        table_to_rank[t] = rank
+        loads[rank] += embedding_specs[t].num_of_features * embedding_specs[t].feature_size
+    return table_to_rank
+
+def _all_to_all(output, input, output_split_sizes, input_split_sizes, group, async_op=False):
+    if dist.get_world_size(group) == 1:
+        # a single rank has nothing to exchange
+        output.copy_(input)
+        return None
+    return dist.all_to_all_single(
+        output, input, output_split_sizes, input_split_sizes, group=group, async_op=async_op)
+
+class EmbeddingAllToAllRequest(object):
+    r"""
+    Handle of the pooled output exchange launched by `DistributedMergedEmbeddingBagWithSGD.forward_async`.
+    `wait()` returns the pooled outputs of all tables for the local batch.
+    """
+    def __init__(self, output_split_sizes, input_split_sizes, group):
+        self.output_split_sizes = output_split_sizes
+        self.input_split_sizes = input_split_sizes
+        self.group = group
+        self.work = None
+        self.output = None
+        self.unpack = None
+
+    def wait(self) -> List[Tensor]:
+        return self.unpack(_AllToAllWait.apply(self, self.output))
+
+class _AllToAllStart(Function):
+    @staticmethod
+    def forward(ctx, req, input):
+        ctx.req = req
+        output = input.new_empty(sum(req.output_split_sizes))
+        req.work = _all_to_all(
+            output, input, req.output_split_sizes, req.input_split_sizes, req.group, async_op=True)
+        return output
+
+    @staticmethod
+    def backward(ctx, grad_output):
+        req = ctx.req
+        grad_output = grad_output.contiguous()
+        grad_input = grad_output.new_empty(sum(req.input_split_sizes))
+        # the reversed exchange sends the grads back to the owner of each table
+        _all_to_all(grad_input, grad_output, req.input_split_sizes, req.output_split_sizes, req.group)
+        return None, grad_input
+
+class _AllToAllWait(Function):
+    @staticmethod
+    def forward(ctx, req, output):
+        if req.work is not None:
+            req.work.wait()
+            req.work = None
+        return output.view_as(output)
+
+    @staticmethod
+    def backward(ctx, grad_output):
+        return None, grad_output
+
+class DistributedMergedEmbeddingBagWithSGD(nn.Module):
+    r"""
+    Model parallel `MergedEmbeddingBagWithSGD`: tables are sharded across the ranks of `process_group`, every rank
+    runs the fused lookup/backward/SGD update only for the tables it owns.
+
+    Every rank feeds the indices of all tables for its local batch (the batch size must be the same on all ranks):
+
+        1). input exchange: indices of each table are sent to its owner rank with all-to-all.
+
+        2). each rank runs `MergedEmbeddingBagWithSGD` over the global batch of its tables.
+
+        3). output exchange: pooled outputs are sent back with all-to-all, so every rank gets the outputs of all tables
+        for its local batch. In backward, grads of the pooled outputs travel the reversed way.
+
+    `forward_async` returns once the output exchange is launched, so the exchange can overlap with other compute:
+
+        >>> EmbLists = torch.nn.Modulist(emb1, emb2, emb3, ..., emb_m)
+        >>> dist_emb = DistributedMergedEmbeddingBagWithSGD.from_embeddingbag_list(EmbLists, lr=lr)
+        >>> req = dist_emb.forward_async(inputs)
+        >>> dense_out = bottom_mlp(dense_inputs)
+        >>> emb_outputs = req.wait()
+        >>> out = interaction(dense_out, emb_outputs)
+
+    All tables should share the same dtype, the exchange is done with a single buffer. With the oneCCL bindings for
+    Pytorch, use the "ccl" backend for `process_group`.
+    """
+    embedding_specs: List[EmbeddingSpec]
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        lr: float = 0.01,
+        weight_decay: float = 0,
+        process_group: Optional[dist.ProcessGroup] = None,
+        table_to_rank: Optional[List[int]] = None
+    ):
+        super(DistributedMergedEmbeddingBagWithSGD, self).__init__()
+        assert dist.is_initialized(), "DistributedMergedEmbeddingBagWithSGD needs torch.distributed to be initialized"
+        dtypes = set(spec.dtype for spec in embedding_specs)
+        assert len(dtypes) == 1, "DistributedMergedEmbeddingBagWithSGD expects all tables have the same dtype"
+        self._dtype = dtypes.pop()
+        self.process_group = process_group
+        self.rank = dist.get_rank(process_group)
+        self.world_size = dist.get_world_size(process_group)
+        self.n_tables = len(embedding_specs)
+        self.feature_sizes = [spec.feature_size for spec in embedding_specs]
+        if table_to_rank is None:
+            table_to_rank = shard_tables_by_cost(embedding_specs, self.world_size)
+        assert len(table_to_rank) == self.n_tables and all(0 <= r < self.world_size for r in table_to_rank)
+        self.table_to_rank = table_to_rank
+        self.rank_tables = [[t for t in range(self.n_tables) if table_to_rank[t] == r] for r in range(self.world_size)]
+        self.local_tables = self.rank_tables[self.rank]
+        self.local_emb = None
+        if self.local_tables:
+            self.local_emb = MergedEmbeddingBagWithSGD(
+                [embedding_specs[t] for t in self.local_tables], lr, weight_decay)
+
+    @staticmethod
+    def _lengths(indices, offsets, include_last_offset):
+        if indices.dim() == 2:
+            return torch.full((indices.size(0),), indices.size(1), dtype=torch.int64), indices.reshape(-1)
+        if include_last_offset:
+            return offsets[1:] - offsets[:-1], indices
+        ends = torch.cat([offsets[1:], torch.tensor([indices.numel()], dtype=offsets.dtype)])
+        return ends - offsets, indices
+
+    def _exchange_indices(self, input):
+        indices, offsets, include_last_offsets = input
+        assert len(indices) == self.n_tables
+        lengths = []
+        flat_indices = []
+        for t in range(self.n_tables):
+            length, index = self._lengths(indices[t], offsets[t], include_last_offsets[t])
+            lengths.append(length.to(torch.int64))
+            flat_indices.append(index.to(torch.int64))
+        batch_size = lengths[0].numel()
+        assert all(length.numel() == batch_size for length in lengths), "expect the same batch size for all tables"
+
+        # send lengths/indices of the tables owned by rank r, table by table
+        send_lengths = torch.cat(
+            [lengths[t] for r in range(self.world_size) for t in self.rank_tables[r]] + [torch.empty(0, dtype=torch.int64)])
+        send_indices = torch.cat(
+            [flat_indices[t] for r in range(self.world_size) for t in self.rank_tables[r]] + [torch.empty(0, dtype=torch.int64)])
+        n_local = len(self.local_tables)
+        recv_lengths = send_lengths.new_empty(self.world_size * n_local * batch_size)
+        _all_to_all(
+            recv_lengths, send_lengths,
+            [n_local * batch_size] * self.world_size,
+            [len(tables) * batch_size for tables in self.rank_tables],
+            self.process_group)
+        send_counts = [sum(flat_indices[t].numel() for t in tables) for tables in self.rank_tables]
+        recv_lengths = recv_lengths.view(self.world_size, n_local, batch_size)
+        recv_counts = recv_lengths.sum(dim=(1, 2)).tolist()
+        recv_indices = send_indices.new_empty(sum(recv_counts))
+        _all_to_all(recv_indices, send_indices, recv_counts, send_counts, self.process_group)
+
+        # regroup into per local table inputs over the global batch (world_size x batch_size)
+        table_counts = recv_lengths.sum(dim=2)
+        chunks = torch.split(recv_indices, table_counts.reshape(-1).tolist())
+        local_indices = []
+        local_offsets = []
+        for j in range(n_local):
+            local_indices.append(torch.cat([chunks[s * n_local + j] for s in range(self.world_size)]))
+            table_lengths = recv_lengths[:, j, :].reshape(-1)
+            local_offsets.append(torch.cat([table_lengths.new_zeros(1), torch.cumsum(table_lengths, 0)[:-1]]))
+        return batch_size, (local_indices, local_offsets, [False] * n_local)
+
+    def forward_async(self, input) -> EmbeddingAllToAllRequest:
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets) for all tables of the local batch
+        Returns:
+            EmbeddingAllToAllRequest, whose `wait()` returns List[Tensor] of shape `(batch_size, feature_size)` which
+            length = num of tables.
+        """
+        batch_size, local_input = self._exchange_indices(input)
+        if self.local_emb is not None:
+            local_outputs = self.local_emb(local_input)
+            if torch.is_tensor(local_outputs):
+                local_outputs = [local_outputs]
+            # pack per destination rank: [local table, local batch of the rank, feature]
+            send = torch.cat([
+                local_outputs[j][s * batch_size:(s + 1) * batch_size].reshape(-1)
+                for s in range(self.world_size) for j in range(len(self.local_tables))])
+        else:
+            # ranks without tables still take part in the exchange, in backward as well: the empty send requires
+            # grad so that the reversed exchange of `_AllToAllStart.backward` runs on this rank too
+            send = torch.empty(0, dtype=self._dtype, requires_grad=torch.is_grad_enabled())
+        local_dim = sum(self.feature_sizes[t] for t in self.local_tables)
+        input_split_sizes = [batch_size * local_dim] * self.world_size
+        output_split_sizes = [batch_size * sum(self.feature_sizes[t] for t in tables) for tables in self.rank_tables]
+        req = EmbeddingAllToAllRequest(output_split_sizes, input_split_sizes, self.process_group)
+        req.output = _AllToAllStart.apply(req, send)
+
+        def unpack(recv):
+            outputs = [None] * self.n_tables
+            chunks = torch.split(
+                recv, [batch_size * self.feature_sizes[t] for tables in self.rank_tables for t in tables])
+            order = [t for tables in self.rank_tables for t in tables]
+            for t, chunk in zip(order, chunks):
+                outputs[t] = chunk.view(batch_size, self.feature_sizes[t])
+            return outputs
+        req.unpack = unpack
+        return req
+
+    def forward(self, input) -> List[Tensor]:
+        return self.forward_async(input).wait()
+
+    def to_bfloat16_train(self):
+        r"""
+        Cast the local tables to bf16 (with the trail part for split SGD), all ranks should call it.
+        """
+        if self.local_emb is not None:
+            self.local_emb.to_bfloat16_train()
+        self._dtype = torch.bfloat16
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        lr: float = 0.01,
+        weight_decay: float = 0,
+        process_group: Optional[dist.ProcessGroup] = None,
+        table_to_rank: Optional[List[int]] = None
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse
+                ))
+        return cls(embedding_specs, lr, weight_decay, process_group, table_to_rank)
@@ -0,0 +1,76 @@
+import torch
+import intel_extension_for_pytorch as ipex  # noqa F401
+
+class BeamKVCache(object):
+    r"""
+    The KV cache of an attention layer for beam search generation, preallocated
+    for ``max_len`` tokens and never copied. The key/value of the tokens of a
+    step are appended in place, and the beams are reordered by an indirection
+    table of ``[max_len, num_seqs]`` cache rows, the decode attention
+    (``torch.ops.torch_ipex.beam_attention_decode``) reading the key/value of
+    every token from the row of the beam it descends from. A step thus costs
+    the reorder of ``seq_len * num_seqs`` indices instead of an
+    ``index_select`` of the whole cache of every layer.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        cache = ipex.nn.modules.BeamKVCache(batch * num_beams, max_len, num_kv_heads, head_size)
+        cache.append(prompt_key, prompt_value)
+        for step in range(max_new_tokens):
+            ...
+            cache.reorder(beam_idx)
+            cache.append(key, value)
+            out = cache.attention(query, scale)
+
+    Args:
+        num_seqs (int): the sequences of the batch, i.e. batch size times beams.
+        max_len (int): the most tokens of a sequence, prompt included.
+        num_kv_heads (int): the key/value heads, which may be less than the
+            query heads (MQA/GQA).
+        head_size (int): the size of a head.
+        dtype (torch.dtype): ``torch.float`` or ``torch.bfloat16``.
+    """
+
+    def __init__(self, num_seqs, max_len, num_kv_heads, head_size, dtype=torch.float):
+        self.num_seqs = num_seqs
+        self.max_len = max_len
+        self.key_cache = torch.zeros(max_len, num_seqs, num_kv_heads, head_size, dtype=dtype)
+        self.value_cache = torch.zeros_like(self.key_cache)
+        self.beam_table = torch.zeros(max_len, num_seqs, dtype=torch.long)
+        self.seq_len = 0
+
+    def reset(self):
+        r"""Starts new sequences, keeping the buffers."""
+        self.seq_len = 0
+
+    def append(self, key, value):
+        r"""
+        Writes the key/value ``[num_seqs, num_tokens, num_kv_heads, head_size]``
+        of the new tokens of the sequences, e.g. of the prompt or of a step,
+        after their cached tokens.
+        """
+        num_tokens = key.size(1)
+        assert key.size(0) == self.num_seqs and key.shape == value.shape
+        assert self.seq_len + num_tokens <= self.max_len, "BeamKVCache: the sequences exceed max_len"
+        end = self.seq_len + num_tokens
+        self.key_cache[self.seq_len:end].copy_(key.transpose(0, 1))
+        self.value_cache[self.seq_len:end].copy_(value.transpose(0, 1))
+        self.beam_table[self.seq_len:end].copy_(torch.arange(self.num_seqs).expand(num_tokens, -1))
+        self.seq_len = end
+
+    def reorder(self, beam_idx):
+        r"""
+        Reorders the beams: sequence ``s`` continues the sequence
+        ``beam_idx[s]``, as by the ``_reorder_cache`` of beam search.
+        """
+        self.beam_table[:self.seq_len] = self.beam_table[:self.seq_len].index_select(1, beam_idx.to(torch.long))
+
+    def attention(self, query, scale):
+        r"""
+        Returns the attention ``[num_seqs, num_heads, head_size]`` of the query
+        ``[num_seqs, num_heads, head_size]`` of the last token of every
+        sequence against its cached tokens.
+        """
+        return torch.ops.torch_ipex.beam_attention_decode(
+            query, self.key_cache, self.value_cache, self.beam_table, self.seq_len, scale)
@@ -7,20 +7,71 @@ class EltwiseType(enum.IntEnum):
     NotFused = 0
     ReLU = 1
     Sigmoid = 2
+    Tanh = 3
+    SiLU = 4
+    GeLUTanh = 5
 
 class IPEXLinearEltwise(torch.nn.Module):
+    r"""
+    Fuses ``act(linear(x))`` of an ipex optimized linear. ``'relu'``, ``'sigmoid'`` and ``'tanh'`` are fused into the
+    linear and save their output for backward, the input of the next layer. ``'silu'`` and ``'gelu_tanh'`` save the
+    linear output, and are applied and differentiated by fused vectorized kernels.
+    """
 
     def __init__(self, ipex_linear_module, eltwise='relu'):
         super(IPEXLinearEltwise, self).__init__()
         assert isinstance(ipex_linear_module, _IPEXLinear)
+        eltwises = {
+            'relu': EltwiseType.ReLU,
+            'sigmoid': EltwiseType.Sigmoid,
+            'tanh': EltwiseType.Tanh,
+            'silu': EltwiseType.SiLU,
+            'gelu_tanh': EltwiseType.GeLUTanh,
+        }
+        assert eltwise in eltwises
         self.m = ipex_linear_module
         self.out_features = ipex_linear_module.out_features
-        if eltwise == 'relu':
-            self.eltwise = EltwiseType.ReLU
-        else:
-            assert eltwise == 'sigmoid'
-            self.eltwise = EltwiseType.Sigmoid
+        self.eltwise = eltwises[eltwise]
 
     def forward(self, x):
         return torch.ops.torch_ipex.ipex_linear_eltwise(
             x, self.m.weight, self.m.bias, self.eltwise, self.m.ctx.get_data_handle(), self.out_features)
+
+class EpilogueActType(enum.IntEnum):
+    NoAct = 0
+    GeLU = 1
+    GeLUTanh = 2
+    SiLU = 3
+
+class IPEXLinearEpilogue(torch.nn.Module):
+    r"""
+    Fuses ``dropout(act(linear(x)), p) + residual`` of an ipex optimized linear
+    into one epilogue pass, in training keeping only the linear output and a
+    dropout bitmask for backward.
+
+    Args:
+        ipex_linear_module: the linear module returned by ipex.optimize.
+        activation (str): ``'none'``, ``'gelu'``, ``'gelu_tanh'`` or ``'silu'``.
+        p (float): the dropout probability, applied in training mode only.
+    """
+
+    def __init__(self, ipex_linear_module, activation='gelu', p=0.0):
+        super(IPEXLinearEpilogue, self).__init__()
+        assert isinstance(ipex_linear_module, _IPEXLinear)
+        activations = {
+            'none': EpilogueActType.NoAct,
+            'gelu': EpilogueActType.GeLU,
+            'gelu_tanh': EpilogueActType.GeLUTanh,
+            'silu': EpilogueActType.SiLU,
+        }
+        assert activation in activations
+        assert 0 <= p <= 1
+        self.m = ipex_linear_module
+        self.out_features = ipex_linear_module.out_features
+        self.activation = activations[activation]
+        self.p = p
+
+    def forward(self, x, residual=None):
+        return torch.ops.torch_ipex.ipex_linear_epilogue(
+            x, self.m.weight, self.m.bias, residual, self.activation, self.p, self.training,
+            self.m.ctx.get_data_handle(), self.out_features)
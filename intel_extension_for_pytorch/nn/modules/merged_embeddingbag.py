@@ -1,19 +1,49 @@
 import torch
 from torch import Tensor, nn
 from torch.autograd import Function
-from typing import List, Optional, NamedTuple
+from typing import List, Optional, NamedTuple, Tuple, Union
 from itertools import accumulate
 import enum
 
 class PoolingMode(enum.IntEnum):
     SUM = 0
     MEAN = 1
+    MAX = 2
+
+class CompositionalMode(enum.IntEnum):
+    QUOTIENT_REMAINDER = 0
+    HASHED = 1
+
+class CompositionalCombine(enum.IntEnum):
+    MUL = 0
+    ADD = 1
 
 class SGDArgs(NamedTuple):
     bf16_trail: List[Optional[torch.Tensor]]
     weight_decay: float
     lr: float
 
+class AdagradArgs(NamedTuple):
+    bf16_trail: List[Optional[torch.Tensor]]
+    hessian: List[torch.Tensor]
+    eps: float
+    weight_decay: float
+    lr: float
+    rowwise: bool
+
+class AdamArgs(NamedTuple):
+    bf16_trail: List[Optional[torch.Tensor]]
+    exp_avg: List[torch.Tensor]
+    exp_avg_sq: List[torch.Tensor]
+    # the number of steps taken, a tensor so that backward can count them
+    step: torch.Tensor
+    beta1: float
+    beta2: float
+    eps: float
+    weight_decay: float
+    lr: float
+    lamb: bool
+
 class EmbeddingSpec(NamedTuple):
     num_of_features: int
     feature_size: int
@@ -22,19 +52,36 @@ class EmbeddingSpec(NamedTuple):
     weight: Optional[torch.Tensor]
     sparse: bool
 
+def _merged_embeddingbag_forward(
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    weights,
+    dedup
+):
+    # returns (outputs, dedup_mapping), dedup_mapping is reused by backward to build the CSC
+    if dedup:
+        return torch.ops.torch_ipex.merged_embeddingbag_forward_dedup(
+            indices, offsets, weights, pooling_modes, indices_with_row_offsets, row_offsets)
+    return torch.ops.torch_ipex.merged_embeddingbag_forward(indices, offsets, weights, pooling_modes), []
+
 def merged_embeddingbag(
     indices,
     offsets,
     indices_with_row_offsets,
     row_offsets,
     pooling_modes,
-    *weights
+    *weights,
+    dedup=False
 ):
     if torch.is_grad_enabled():
         return MergedEmbeddingBagFunc.apply(
-            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, *weights
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, *weights
         )
-    return torch.ops.torch_ipex.merged_embeddingbag_forward(indices, offsets, weights, pooling_modes)
+    return _merged_embeddingbag_forward(
+        indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup)[0]
 
 def merged_embeddingbag_sgd(
     indices,
@@ -43,13 +90,80 @@ def merged_embeddingbag_sgd(
     row_offsets,
     pooling_modes,
     sgd_args,
-    *weights
+    *weights,
+    dedup=False
 ):
     if torch.is_grad_enabled():
         return MergedEmbeddingBagSGDFunc.apply(
-            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, sgd_args, *weights
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, sgd_args, *weights
         )
-    return torch.ops.torch_ipex.merged_embeddingbag_forward(indices, offsets, weights, pooling_modes)
+    return _merged_embeddingbag_forward(
+        indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup)[0]
+
+def merged_embeddingbag_sgd_with_interaction(
+    dense,
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    sgd_args,
+    *weights,
+    dedup=False
+):
+    return MergedEmbeddingBagSGDInteractionFunc.apply(
+        dense, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, sgd_args, *weights
+    )
+
+def merged_embeddingbag_adagrad(
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    adagrad_args,
+    *weights,
+    dedup=False
+):
+    if torch.is_grad_enabled():
+        return MergedEmbeddingBagAdagradFunc.apply(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, adagrad_args, *weights
+        )
+    return _merged_embeddingbag_forward(
+        indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup)[0]
+
+def merged_embeddingbag_adam(
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    adam_args,
+    *weights,
+    dedup=False
+):
+    if torch.is_grad_enabled():
+        return MergedEmbeddingBagAdamFunc.apply(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, adam_args, *weights
+        )
+    return _merged_embeddingbag_forward(
+        indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup)[0]
+
+def merged_embeddingbag_compositional(
+    indices,
+    offsets,
+    pooling_modes,
+    num_components,
+    mode,
+    combine,
+    *weights
+):
+    if torch.is_grad_enabled():
+        return MergedEmbeddingBagCompositionalFunc.apply(
+            indices, offsets, pooling_modes, num_components, mode, combine, *weights
+        )
+    return torch.ops.torch_ipex.merged_embeddingbag_forward_compositional(
+        indices, offsets, weights, pooling_modes, num_components, mode, combine)
 
 class MergedEmbeddingBagFunc(Function):
     @staticmethod
@@ -57,9 +171,9 @@ class MergedEmbeddingBagFunc(Function):
         return args
 
     @staticmethod
-    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, *weights):
-        output = torch.ops.torch_ipex.merged_embeddingbag_forward(
-            indices, offsets, weights, pooling_modes
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, *weights):
+        output, ctx.dedup_mapping = _merged_embeddingbag_forward(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup
         )
         ctx.offsets = offsets
         ctx.weights = weights
@@ -77,22 +191,50 @@ class MergedEmbeddingBagFunc(Function):
         pooling_modes = ctx.pooling_modes
         grad_list = torch.ops.torch_ipex.merged_embeddingbag_backward_cpu(
             grad_out, offsets, weights, indices_with_row_offsets,
-            row_offsets, pooling_modes)
+            row_offsets, pooling_modes, ctx.dedup_mapping)
         n_tables = len(weights)
-        output = [None for i in range(5)]
+        output = [None for i in range(6)]
         for grad in grad_list:
              output.append(grad)
         return MergedEmbeddingBagFunc.unpack(*output)
 
+class MergedEmbeddingBagCompositionalFunc(Function):
+    @staticmethod
+    def unpack(*args):
+        return args
+
+    @staticmethod
+    def forward(ctx, indices, offsets, pooling_modes, num_components, mode, combine, *weights):
+        output = torch.ops.torch_ipex.merged_embeddingbag_forward_compositional(
+            indices, offsets, weights, pooling_modes, num_components, mode, combine)
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.pooling_modes = pooling_modes
+        ctx.num_components = num_components
+        ctx.mode = mode
+        ctx.combine = combine
+        return MergedEmbeddingBagCompositionalFunc.unpack(*output)
+
+    @staticmethod
+    def backward(ctx, *grad_out):
+        grad_list = torch.ops.torch_ipex.merged_embeddingbag_backward_compositional(
+            grad_out, ctx.indices, ctx.offsets, ctx.weights, ctx.pooling_modes,
+            ctx.num_components, ctx.mode, ctx.combine)
+        output = [None for i in range(6)]
+        for grad in grad_list:
+            output.append(grad)
+        return MergedEmbeddingBagCompositionalFunc.unpack(*output)
+
 class MergedEmbeddingBagSGDFunc(Function):
     @staticmethod
     def unpack(*args):
         return args
 
     @staticmethod
-    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, sgd_args, *weights):
-        output = torch.ops.torch_ipex.merged_embeddingbag_forward(
-            indices, offsets, weights, pooling_modes
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, sgd_args, *weights):
+        output, ctx.dedup_mapping = _merged_embeddingbag_forward(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup
         )
         ctx.indices = indices
         ctx.offsets = offsets
@@ -118,11 +260,108 @@ class MergedEmbeddingBagSGDFunc(Function):
         torch.ops.torch_ipex.merged_embeddingbag_backward_sgd(
             grad_out, indices, offsets, weights, indices_with_row_offsets,
             row_offsets, pooling_modes,
-            bf16_trail, weight_decay, lr)
+            bf16_trail, weight_decay, lr, ctx.dedup_mapping)
         n_tables = len(weights)
-        output = [None for i in range(n_tables + 6)]
+        output = [None for i in range(n_tables + 7)]
         return MergedEmbeddingBagSGDFunc.unpack(*output)
 
+class MergedEmbeddingBagSGDInteractionFunc(Function):
+    r"""
+    ``interaction(dense, *merged_embeddingbag_sgd(...))`` whose backward computes the grads of the embeddings of each
+    sample and updates the tables from them in one op, the grads of the embeddings being never returned to autograd.
+    """
+    @staticmethod
+    def forward(ctx, dense, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, sgd_args,
+                *weights):
+        output, ctx.dedup_mapping = _merged_embeddingbag_forward(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup
+        )
+        input = [dense.contiguous()] + list(output)
+        ctx.save_for_backward(*input)
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.indices_with_row_offsets = indices_with_row_offsets
+        ctx.row_offsets = row_offsets
+        ctx.pooling_modes = pooling_modes
+        ctx.sgd_args = sgd_args
+        return torch.ops.torch_ipex.interaction_forward(input)
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        sgd_args = ctx.sgd_args
+        grad_dense = torch.ops.torch_ipex.interaction_backward_merged_embeddingbag_sgd(
+            grad_out.contiguous(), list(ctx.saved_tensors), ctx.indices, ctx.offsets, ctx.weights,
+            ctx.indices_with_row_offsets, ctx.row_offsets, ctx.pooling_modes,
+            sgd_args.bf16_trail, sgd_args.weight_decay, sgd_args.lr, ctx.dedup_mapping)
+        n_tables = len(ctx.weights)
+        return (grad_dense,) + tuple(None for i in range(n_tables + 7))
+
+class MergedEmbeddingBagAdagradFunc(Function):
+    @staticmethod
+    def unpack(*args):
+        return args
+
+    @staticmethod
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, adagrad_args, *weights):
+        output, ctx.dedup_mapping = _merged_embeddingbag_forward(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup
+        )
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.indices_with_row_offsets = indices_with_row_offsets
+        ctx.row_offsets = row_offsets
+        ctx.pooling_modes = pooling_modes
+        ctx.adagrad_args = adagrad_args
+        return MergedEmbeddingBagAdagradFunc.unpack(*output)
+
+    @staticmethod
+    def backward(ctx, *grad_out):
+        adagrad_args = ctx.adagrad_args
+        torch.ops.torch_ipex.merged_embeddingbag_backward_adagrad(
+            grad_out, ctx.indices, ctx.offsets, ctx.weights, ctx.indices_with_row_offsets,
+            ctx.row_offsets, ctx.pooling_modes,
+            adagrad_args.hessian, adagrad_args.bf16_trail,
+            adagrad_args.eps, adagrad_args.weight_decay, adagrad_args.lr, adagrad_args.rowwise,
+            ctx.dedup_mapping)
+        n_tables = len(ctx.weights)
+        output = [None for i in range(n_tables + 7)]
+        return MergedEmbeddingBagAdagradFunc.unpack(*output)
+
+class MergedEmbeddingBagAdamFunc(Function):
+    @staticmethod
+    def unpack(*args):
+        return args
+
+    @staticmethod
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, dedup, adam_args, *weights):
+        output, ctx.dedup_mapping = _merged_embeddingbag_forward(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, weights, dedup
+        )
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.indices_with_row_offsets = indices_with_row_offsets
+        ctx.row_offsets = row_offsets
+        ctx.pooling_modes = pooling_modes
+        ctx.adam_args = adam_args
+        return MergedEmbeddingBagAdamFunc.unpack(*output)
+
+    @staticmethod
+    def backward(ctx, *grad_out):
+        adam_args = ctx.adam_args
+        adam_args.step.add_(1)
+        torch.ops.torch_ipex.merged_embeddingbag_backward_adam(
+            grad_out, ctx.indices, ctx.offsets, ctx.weights, ctx.indices_with_row_offsets,
+            ctx.row_offsets, ctx.pooling_modes,
+            adam_args.exp_avg, adam_args.exp_avg_sq, adam_args.bf16_trail, adam_args.step.item(),
+            adam_args.beta1, adam_args.beta2, adam_args.eps, adam_args.weight_decay, adam_args.lr,
+            adam_args.lamb, ctx.dedup_mapping)
+        n_tables = len(ctx.weights)
+        output = [None for i in range(n_tables + 7)]
+        return MergedEmbeddingBagAdamFunc.unpack(*output)
+
 class MergedEmbeddingBag(nn.Module):
     r"""
     Merge multiple Pytorch `EmbeddingBag <https://pytorch.org/docs/stable/generated/torch.nn.EmbeddingBag.html
@@ -160,6 +399,7 @@ class MergedEmbeddingBag(nn.Module):
     A `linearize_indices_and_offsets` step is introduced to merge indices/offsets together. Consider that `EmbeddingBag`
     objects are usually the first layer of a model, the `linearize_indices_and_offsets` step can be considered as "data
     preprocess" and can be done offline. See usage of the `linearize_indices_and_offsets` in `MergedEmbeddingBagWithSGD`.
+    `prefetch_linearized_inputs` runs it on a dedicated `CPUPool` one batch ahead of the training loop.
 
     Now `MergedEmbeddingBagWithSGD` is the only option running with an optimizer. We plan to add more optimizer support
     in the future. Visit `MergedEmbeddingBagWithSGD` for introduction of `MergedEmbeddingBagWith[Optimizer]`.
@@ -199,6 +439,8 @@ class MergedEmbeddingBag(nn.Module):
             "row_offsets",
             torch.tensor([0] + list(accumulate(row_offsets)), dtype=torch.int64),
         )
+        self.hot_row_cache = None
+        self.dedup = False
 
     @classmethod
     def from_embeddingbag_list(
@@ -229,6 +471,48 @@ class MergedEmbeddingBag(nn.Module):
                 s += '\n'
         return s
 
+    def enable_hot_row_cache(
+        self,
+        sample_indices: List[Tensor],
+        num_hot_rows: int
+    ):
+        r"""
+        Copy the `num_hot_rows` most frequent rows of each table, counted over `sample_indices` (one 1-D/2-D
+        indices tensor per table, e.g. collected from a few inference batches), into compact buffers found
+        through a small hash index. Inference lookups (no grad) read hot rows from these buffers, which are
+        allocated by the calling thread and so are local to its NUMA node.
+
+        The cached rows are copies: call this again (or `disable_hot_row_cache`) after weights are updated.
+        """
+        assert self.n_tables == len(sample_indices), "expected {} but got {} indices".format(
+            self.n_tables, len(sample_indices))
+        cache_rows = []
+        cache_hash_index = []
+        for weight, indices in zip(self.weights, sample_indices):
+            uniq, counts = torch.unique(indices.reshape(-1), return_counts=True)
+            k = min(num_hot_rows, uniq.numel())
+            hot_indices = uniq[torch.topk(counts, k).indices].contiguous()
+            rows, hash_index = torch.ops.torch_ipex.build_embedding_hot_row_cache(
+                weight.detach(), hot_indices)
+            cache_rows.append(rows)
+            cache_hash_index.append(hash_index)
+        self.hot_row_cache = (cache_rows, cache_hash_index)
+
+    def disable_hot_row_cache(self):
+        self.hot_row_cache = None
+
+    def enable_dedup_lookup(self):
+        r"""
+        Deduplicate the indices of each table before the lookup: every distinct row is gathered once into a
+        compact buffer and the bags are pooled from it, which saves memory traffic when batches repeat the same
+        indices. In training, the unique/inverse mapping is kept for backward so the CSC of the indices is built
+        without sorting them again.
+        """
+        self.dedup = True
+
+    def disable_dedup_lookup(self):
+        self.dedup = False
+
     def linearize_indices_and_offsets(
         self,
         indices: List[Tensor],
@@ -245,49 +529,44 @@ class MergedEmbeddingBag(nn.Module):
         https://github.com/pytorch/pytorch/blob/master/torch/nn/modules/sparse.py#L355-L382
         """
         # TODO: support per_sample_weights in forward
-        def get_batch_size(indice, offset, include_last_offset):
-            if indice.dim() == 2:
-                assert offset is None, "offset should be None if indice is 2-D tensor, https://github.com/pytorch/pytorch/blob/master/torch/nn/modules/sparse.py#L355-L382"
-                batch_size = indice.shape[0]
-            else:
-                batch_size = offset.numel()
-                if include_last_offset:
-                    batch_size -= 1
-            return batch_size
-
         assert self.n_tables == len(indices), "expected {} but got {} indices".format(self.n_tables, len(indices))
         assert self.n_tables == len(offsets), "expected {} but got {} offsets".format(self.n_tables, len(offsets))
         assert self.n_tables == len(include_last_offsets), "expected {} but got {} include_last_offsets".format(
             self.n_tables, len(include_last_offsets))
+        # one parallel pass over the indices of all the tables, and one over their bags
+        return torch.ops.torch_ipex.merged_embeddingbag_linearize(
+            indices, offsets, [bool(include_last) for include_last in include_last_offsets], self.row_offsets)
 
-        batch_size = get_batch_size(indices[0], offsets[0], include_last_offsets[0])
-        assert all(
-            batch_size == get_batch_size(idx, offset, include_last) for idx, offset, include_last in zip(indices, offsets, include_last_offsets)
-        ), r"MergedEmbeddingBag only support input with same batch size"
-        n_indices = sum([t.numel() for t in indices])
-        n_offsets = batch_size * self.n_tables + 1  # include last offset
-        merged_indices = torch.empty(n_indices, dtype=torch.int64)
-        merged_indices_with_row_offsets = torch.empty(n_indices, dtype=torch.int64)  # used for sort together
-        merged_offsets = torch.empty(n_offsets, dtype=torch.int64)
-        idx_start = 0
-        offset_start = 0
-        for i in range(self.n_tables):
-            n_indice = indices[i].numel()
-            merged_indices[idx_start: idx_start + n_indice].copy_(indices[i].view(-1))
-            merged_indices_with_row_offsets[idx_start: idx_start + n_indice].copy_(indices[i].view(-1) + self.row_offsets[i])
-            if indices[i].dim() == 2:
-                bag_size = indices[i].shape[1]
-                offset = torch.arange(0, indices[i].numel(), bag_size)
-            else:
-                offset = offsets[i][:-1] if include_last_offsets[i] else offsets[i]
-            assert offset.numel() == batch_size
-            merged_offsets[offset_start : offset_start + batch_size].copy_(offset + idx_start)
-            idx_start += n_indice
-            offset_start += batch_size
-        assert idx_start == n_indices
-        assert offset_start == n_offsets - 1
-        merged_offsets[-1] = n_indices
-        return (merged_indices, merged_offsets, merged_indices_with_row_offsets)
+    def prefetch_linearized_inputs(self, batches, cpu_pool, sparse_input_index=1):
+        r"""
+        Yields the batches of ``batches`` with their sparse input linearized by `linearize_indices_and_offsets` on
+        the cores of ``cpu_pool``, e.g. a few cores kept out of the OMP threads of the training loop, one batch ahead:
+        the inputs of the next batch are linearized while the current step runs. Pass the sparse input of a batch
+        with ``need_linearize_indices_and_offsets=torch.BoolTensor([False])``.
+
+        Args:
+            batches (Iterable[Tuple]): the batches, e.g. a DataLoader, whose element ``sparse_input_index`` is the
+                (indices, offsets, include_last_offsets) of the tables.
+            cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): the cores linearizing the inputs.
+            sparse_input_index (int): the index of the sparse input in a batch.
+        """
+        from ...cpu.runtime import Task
+        task = Task(self.linearize_indices_and_offsets, cpu_pool)
+
+        def linearized(batch, future):
+            batch = list(batch)
+            batch[sparse_input_index] = future.get()
+            return tuple(batch)
+
+        pending = None
+        for batch in batches:
+            # a Task keeps the arguments of the call it runs, so the previous batch is waited for first
+            ready = linearized(*pending) if pending is not None else None
+            pending = (batch, task(*batch[sparse_input_index]))
+            if ready is not None:
+                yield ready
+        if pending is not None:
+            yield linearized(*pending)
 
     def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
         r"""
@@ -303,9 +582,286 @@ class MergedEmbeddingBag(nn.Module):
             indices, offsets, indices_with_row_offsets = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
         else:
             indices, offsets, indices_with_row_offsets = input
+        if self.hot_row_cache is not None and not torch.is_grad_enabled():
+            cache_rows, cache_hash_index = self.hot_row_cache
+            return torch.ops.torch_ipex.merged_embeddingbag_forward_with_hot_row_cache(
+                indices, offsets, list(self.weights), self.pooling_modes, cache_rows, cache_hash_index)
         return merged_embeddingbag(
             indices, offsets, indices_with_row_offsets, self.row_offsets,
-            self.pooling_modes, *self.weights
+            self.pooling_modes, *self.weights, dedup=self.dedup
+        )
+
+    def forward_with_interaction(self, dense, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Inference only fused version of `ipex.nn.functional.interaction(dense, *self(input))`. Each sample pools its
+        embeddings into a small cache-resident tile and the "dot" interaction runs on that tile, so the pooled outputs
+        are not written out. All tables and `dense` should share dtype (float or bfloat16) and feature size.
+
+        Args:
+            dense (Tensor): dense feature of shape `(batch_size, feature_size)`
+            input (Tuple[Tensor]): same as `forward`
+        Returns:
+            Tensor of shape `(batch_size, feature_size + (num of tables + 1) * num of tables / 2)`
+        """
+        assert not torch.is_grad_enabled(), "forward_with_interaction only support inference, please run it under no_grad"
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, _ = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, _ = input
+        return torch.ops.torch_ipex.merged_embeddingbag_interaction_forward(
+            dense.contiguous(), indices, offsets, list(self.weights), self.pooling_modes)
+
+
+def rowwise_quantize_embedding_weight(weight, bit_rate=8):
+    r"""
+    Quantize a 2-D embedding weight row by row. Each output row is laid out as
+    ``[q_0, ..., q_{D-1}, scale, bias]`` where ``scale`` and ``bias`` are fp32 values stored
+    as 4 raw bytes each, and the dequantized value is ``q * scale + bias``. With ``bit_rate=4``
+    two elements share one byte (element 2k in the low nibble).
+    """
+    assert bit_rate in (8, 4), "row-wise quantization only support bit rate 8 or 4"
+    assert weight.dim() == 2, "row-wise quantization expects a 2-D embedding weight"
+    weight = weight.detach().float()
+    num_rows, feature_size = weight.shape
+    assert bit_rate == 8 or feature_size % 2 == 0, "int4 row-wise quantization requires an even feature size"
+    qmax = (1 << bit_rate) - 1
+    w_min = weight.min(dim=1, keepdim=True)[0]
+    w_max = weight.max(dim=1, keepdim=True)[0]
+    scale = (w_max - w_min) / qmax
+    scale = torch.where(scale > 0, scale, torch.ones_like(scale))
+    q = torch.clamp(torch.round((weight - w_min) / scale), 0, qmax).to(torch.uint8)
+    if bit_rate == 4:
+        q = q[:, 0::2] | (q[:, 1::2] << 4)
+    scale_bias = torch.cat([scale, w_min], dim=1).contiguous().view(torch.uint8)
+    return torch.cat([q, scale_bias], dim=1).contiguous()
+
+class QuantizedMergedEmbeddingBag(MergedEmbeddingBag):
+    r"""
+    Inference only `MergedEmbeddingBag` with row-wise INT8/INT4 quantized tables.
+
+    Every table is stored as a uint8 tensor where each row carries its own fp32 scale and bias (see
+    `rowwise_quantize_embedding_weight`). Rows are dequantized inside the pooling loop and accumulated
+    in fp32, so the bytes read per lookup drop to roughly 1/4 (INT8) or 1/8 (INT4) of fp32 tables.
+
+        >>> EmbLists = torch.nn.Modulist(emb1, emb2, emb3, ..., emb_m)
+        >>> merged_emb = QuantizedMergedEmbeddingBag.from_embeddingbag_list(EmbLists, bit_rate=4)
+        >>> outputs = merged_emb(inputs)
+
+    Outputs of quantized tables are fp32.
+
+    `bit_rate` can also be given per table, where 0 keeps the table in its float dtype (and its output in that
+    dtype). Tables of different feature sizes and dtypes are then looked up by one op, which splits the bags across
+    threads by their cost (rows x feature size) instead of by count:
+
+        >>> merged_emb = QuantizedMergedEmbeddingBag.from_embeddingbag_list(EmbLists, bit_rate=[8, 0, 4, ...])
+    """
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        bit_rate: Union[int, List[int]] = 8
+    ):
+        super(QuantizedMergedEmbeddingBag, self).__init__(embedding_specs)
+        if isinstance(bit_rate, int):
+            bit_rate = [bit_rate for i in range(self.n_tables)]
+        assert len(bit_rate) == self.n_tables, "expect one bit rate per table"
+        assert all(b in (0, 4, 8) for b in bit_rate), "bit rate should be 0 (not quantized), 4 or 8"
+        self.bit_rates = list(bit_rate)
+        self.qweights = [
+            w.detach() if b == 0 else rowwise_quantize_embedding_weight(w, b)
+            for w, b in zip(self.weights, self.bit_rates)
+        ]
+        # float tables are not needed after quantization
+        self.weights = torch.nn.ParameterList()
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        bit_rate: Union[int, List[int]] = 8
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse
+                ))
+        return cls(embedding_specs, bit_rate)
+
+    def extra_repr(self) -> str:
+        s = 'number of tables={}\n'.format(self.n_tables)
+        for i in range(self.n_tables):
+            s += "table{}: {}, {}, {}".format(
+                i, self.qweights[i].shape[0], self.pooling_modes[i],
+                self.qweights[i].dtype if self.bit_rates[i] == 0 else "int{}".format(self.bit_rates[i]))
+            if i != self.n_tables - 1:
+                s += '\n'
+        return s
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets(if not merged)/indices_with_row_offsets(if merged))
+            need_linearize_indices_and_offsets: indicate whether input need to be linearized
+        Returns:
+            List[Tensor] output shape of `(batch_size, feature_size)` which length = num of tables, fp32 for
+            quantized tables.
+        """
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, indices_with_row_offsets = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, indices_with_row_offsets = input
+        if 0 in self.bit_rates:
+            return torch.ops.torch_ipex.merged_embeddingbag_forward_mixed(
+                indices, offsets, self.qweights, self.pooling_modes, self.bit_rates
+            )
+        return torch.ops.torch_ipex.merged_embeddingbag_forward_rowwise_quantized(
+            indices, offsets, self.qweights, self.pooling_modes, self.bit_rates
+        )
+
+
+class CompositionalMergedEmbeddingBag(MergedEmbeddingBag):
+    r"""
+    `MergedEmbeddingBag` over compositional embeddings: every row of a logical table is combined element-wise
+    (``combine='mul'`` or ``'add'``) from one row of each of its smaller component tables, so a table of N rows
+    only stores the rows of its components, e.g. about 2 * sqrt(N) rows for 2 components.
+
+    ``mode='quotient_remainder'`` reads the components at the digits of the index in the mixed radix of the
+    component sizes, e.g. ``index // m`` and ``index % m`` for components of ``ceil(N / m)`` and ``m`` rows (see
+    `quotient_remainder_rows`), so that two different indices never read the same rows of all the components.
+    ``mode='hashed'`` reads component k at ``hash_k(index) % rows_k``.
+
+        >>> rows = [CompositionalMergedEmbeddingBag.quotient_remainder_rows(n, 1000) for n in num_of_features]
+        >>> merged_emb = CompositionalMergedEmbeddingBag.from_embeddingbag_list(EmbLists, rows)
+        >>> outputs = merged_emb(inputs)
+
+    The lookup and the combine run inside one pooling loop, and the backward accumulates the grads of the
+    component rows over a CSC of the rows read by the indices. A table given a single component is a plain table.
+
+    Args:
+        embedding_specs (List[EmbeddingSpec]): the logical tables, `weight` is only used by single component tables.
+        component_rows (List[List[int]]): the number of rows of each component of each table.
+        mode (str): ``'quotient_remainder'`` or ``'hashed'``.
+        combine (str): ``'mul'`` or ``'add'``.
+    """
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        component_rows: List[List[int]],
+        mode: str = 'quotient_remainder',
+        combine: str = 'mul'
+    ):
+        # the logical tables are not allocated, so MergedEmbeddingBag.__init__ is skipped
+        super(MergedEmbeddingBag, self).__init__()
+        assert len(component_rows) == len(embedding_specs), "expect the component rows of every table"
+        assert mode in ('quotient_remainder', 'hashed'), "mode should be quotient_remainder or hashed"
+        assert combine in ('mul', 'add'), "combine should be mul or add"
+        self.mode = CompositionalMode.QUOTIENT_REMAINDER if mode == 'quotient_remainder' else CompositionalMode.HASHED
+        self.combine = CompositionalCombine.MUL if combine == 'mul' else CompositionalCombine.ADD
+        self.n_tables = len(embedding_specs)
+        self.pooling_modes = []
+        self.num_components = []
+        self.alldense = True
+        self.weights = torch.nn.ParameterList()
+        row_offsets = []
+        for emb, rows in zip(embedding_specs, component_rows):
+            num_of_features, feature_size, pooling_mode, dtype, weight, sparse = emb
+            assert not sparse, "CompositionalMergedEmbeddingBag only support dense gradient"
+            row_offsets.append(num_of_features)
+            if pooling_mode == 'sum':
+                self.pooling_modes.append(PoolingMode.SUM)
+            elif pooling_mode == 'mean':
+                self.pooling_modes.append(PoolingMode.MEAN)
+            else:
+                assert False, r"CompositionalMergedEmbeddingBag only support EmbeddingBag with model sum or mean"
+            assert len(rows) > 0, "a table needs at least one component"
+            capacity = 1
+            for r in rows:
+                capacity *= r
+            assert self.mode == CompositionalMode.HASHED or capacity >= num_of_features, \
+                "the quotient-remainder components of a table should have at least as many combinations as its rows"
+            self.num_components.append(len(rows))
+            for r in rows:
+                if len(rows) == 1 and weight is not None:
+                    component = weight
+                else:
+                    bound = (1.0 / r) ** 0.5
+                    component = torch.empty((r, feature_size), dtype=dtype).uniform_(-bound, bound)
+                self.weights.append(nn.Parameter(component))
+
+        self.register_buffer(
+            "row_offsets",
+            torch.tensor([0] + list(accumulate(row_offsets)), dtype=torch.int64),
+        )
+        self.hot_row_cache = None
+        self.dedup = False
+
+    @staticmethod
+    def quotient_remainder_rows(num_of_features: int, num_collisions: int):
+        r"""
+        The component rows of the quotient-remainder trick for a table of `num_of_features` rows, where each row
+        of the quotient component is shared by `num_collisions` indices.
+        """
+        return [(num_of_features + num_collisions - 1) // num_collisions, num_collisions]
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        component_rows: List[List[int]],
+        mode: str = 'quotient_remainder',
+        combine: str = 'mul'
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse
+                ))
+        return cls(embedding_specs, component_rows, mode, combine)
+
+    def extra_repr(self) -> str:
+        s = 'number of tables={}, mode={}, combine={}\n'.format(self.n_tables, self.mode.name, self.combine.name)
+        c = 0
+        for i in range(self.n_tables):
+            rows = [self.weights[c + k].shape[0] for k in range(self.num_components[i])]
+            s += "table{}: {}, {}, {}, {}, {}".format(
+                i, self.row_offsets[i + 1] - self.row_offsets[i], rows, self.weights[c].shape[1],
+                self.pooling_modes[i], self.weights[c].dtype)
+            c += self.num_components[i]
+            if i != self.n_tables - 1:
+                s += '\n'
+        return s
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets(if not merged)/indices_with_row_offsets(if merged))
+            need_linearize_indices_and_offsets: indicate whether input need to be linearized
+        Returns:
+            List[Tensor] output shape of `(batch_size, feature_size)` which length = num of tables.
+        """
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, _ = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, _ = input
+        return merged_embeddingbag_compositional(
+            indices, offsets, self.pooling_modes, self.num_components, int(self.mode), int(self.combine),
+            *self.weights
         )
 
 
@@ -415,7 +971,34 @@ class MergedEmbeddingBagWithSGD(MergedEmbeddingBag):
             indices, offsets, indices_with_row_offsets = input
         return merged_embeddingbag_sgd(
             indices, offsets, indices_with_row_offsets, self.row_offsets,
-            self.pooling_modes, self.sgd_args, *self.weights
+            self.pooling_modes, self.sgd_args, *self.weights, dedup=self.dedup
+        )
+
+    def forward_with_interaction(self, dense, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Fused version of `ipex.nn.functional.interaction(dense, *self(input))`. In training, the backward computes the
+        grads of the pooled embeddings of each sample from the grad of the interaction and updates the tables from
+        them in the same op, instead of returning them to autograd and reading them back, and only `dense` gets a
+        grad. All tables and `dense` should share feature size, the tables being float or bfloat16. Without grad,
+        it runs the inference fused op of `MergedEmbeddingBag`.
+
+        Args:
+            dense (Tensor): dense feature of shape `(batch_size, feature_size)`
+            input (Tuple[Tensor]): same as `forward`
+        Returns:
+            Tensor of shape `(batch_size, feature_size + (num of tables + 1) * num of tables / 2)`
+        """
+        if not torch.is_grad_enabled():
+            return super(MergedEmbeddingBagWithSGD, self).forward_with_interaction(
+                dense, input, need_linearize_indices_and_offsets)
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, indices_with_row_offsets = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, indices_with_row_offsets = input
+        return merged_embeddingbag_sgd_with_interaction(
+            dense, indices, offsets, indices_with_row_offsets, self.row_offsets,
+            self.pooling_modes, self.sgd_args, *self.weights, dedup=self.dedup
         )
 
     @classmethod
@@ -438,3 +1021,257 @@ class MergedEmbeddingBagWithSGD(MergedEmbeddingBag):
                     sparse=emb.sparse
                 ))
         return cls(embedding_specs, lr, weight_decay)
+
+
+class MergedEmbeddingBagWithAdagrad(MergedEmbeddingBag):
+    r"""
+    `MergedEmbeddingBag` with a fused Adagrad (or row-wise Adagrad) update. Like `MergedEmbeddingBagWithSGD`,
+    backward does not return gradients: the accumulated squared gradients (`hessian`) and the weights are updated
+    inside the same CSC traversal that reduces the output gradients, so no dense gradient is written.
+
+        >>> EmbLists = torch.nn.Modulist(emb1, emb2, emb3, ..., emb_m)
+        >>> merged_emb = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(EmbLists, lr=lr, rowwise=True)
+        >>> outputs = merged_emb(inputs)
+        >>> outputs.backward(grads)
+
+    With `rowwise=True` a single accumulator is kept for every row (the mean of the squared gradients over the
+    row), which shrinks the optimizer state from `num_rows x feature_size` to `num_rows`.
+    """
+    embedding_specs: List[EmbeddingSpec]
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        lr: float = 0.01,
+        eps: float = 1e-10,
+        weight_decay: float = 0,
+        initial_accumulator_value: float = 0,
+        rowwise: bool = False
+    ):
+        super(MergedEmbeddingBagWithAdagrad, self).__init__(embedding_specs)
+        if lr < 0.0:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if eps < 0.0:
+            raise ValueError("Invalid epsilon value: {}".format(eps))
+        if weight_decay < 0.0:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        if initial_accumulator_value < 0.0:
+            raise ValueError("Invalid initial accumulator value: {}".format(initial_accumulator_value))
+        bf16_trail = []
+        hessian = []
+        for i in range(self.n_tables):
+            weight = self.weights[i]
+            if weight.dtype == torch.bfloat16:
+                bf16_trail.append(torch.zeros_like(weight, dtype=torch.bfloat16))
+            else:
+                bf16_trail.append(torch.empty(0, dtype=torch.bfloat16))
+            hessian.append(self._init_hessian(weight, initial_accumulator_value, rowwise))
+        self.adagrad_args = AdagradArgs(
+            bf16_trail=bf16_trail,
+            hessian=hessian,
+            eps=eps,
+            weight_decay=weight_decay,
+            lr=lr,
+            rowwise=rowwise
+        )
+
+    @staticmethod
+    def _init_hessian(weight, initial_accumulator_value, rowwise):
+        # hessian is kept in the accumulate dtype of the table
+        dtype = torch.double if weight.dtype == torch.double else torch.float
+        shape = weight.shape[0:1] if rowwise else weight.shape
+        return torch.full(shape, initial_accumulator_value, dtype=dtype)
+
+    def to_bfloat16_train(self):
+        r"""
+        Cast weight to bf16 and it's trail part for training
+        """
+        trails = []
+        hessian = []
+        for i in range(len(self.weights)):
+            if self.weights[i].dtype == torch.float:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i])
+            elif self.weights[i].dtype == torch.bfloat16:
+                bf16_w = self.weights[i]
+                trail = torch.zeros_like(bf16_w, dtype=torch.bfloat16)
+            elif self.weights[i].dtype == torch.double:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i].float())
+            else:
+                assert False, r"MergedEmbeddingBag only support dtypes with bfloat, float and double"
+            trails.append(trail)
+            hessian.append(self.adagrad_args.hessian[i].float())
+            self.weights[i] = torch.nn.Parameter(bf16_w)
+        self.adagrad_args = self.adagrad_args._replace(bf16_trail=trails, hessian=hessian)
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets(if not merged)/indices_with_row_offsets(if merged))
+            need_linearize_indices_and_offsets: indicate whether input need to be linearized
+        Returns:
+            List[Tensor] output shape of `(batch_size, feature_size)` which length = num of tables.
+        """
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, indices_with_row_offsets = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, indices_with_row_offsets = input
+        return merged_embeddingbag_adagrad(
+            indices, offsets, indices_with_row_offsets, self.row_offsets,
+            self.pooling_modes, self.adagrad_args, *self.weights, dedup=self.dedup
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        lr: float = 0.01,
+        eps: float = 1e-10,
+        weight_decay: float = 0,
+        initial_accumulator_value: float = 0,
+        rowwise: bool = False
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse
+                ))
+        return cls(embedding_specs, lr, eps, weight_decay, initial_accumulator_value, rowwise)
+
+
+class MergedEmbeddingBagWithAdam(MergedEmbeddingBag):
+    r"""
+    `MergedEmbeddingBag` with a fused sparse Adam (or LAMB) update. Like `MergedEmbeddingBagWithSGD`, backward does
+    not return gradients: the rows looked up by the batch and their moments are updated inside the same CSC traversal
+    that reduces the output gradients, instead of coalescing a sparse gradient and updating it through several ops.
+
+        >>> EmbLists = torch.nn.Modulist(emb1, emb2, emb3, ..., emb_m)
+        >>> merged_emb = MergedEmbeddingBagWithAdam.from_embeddingbag_list(EmbLists, lr=lr)
+        >>> outputs = merged_emb(inputs)
+        >>> outputs.backward(grads)
+
+    As in `torch.optim.SparseAdam`, the moments of the rows not looked up are not decayed and the bias corrections
+    use the number of backwards. With `lamb=True` the weight decay is added to the Adam step, which is scaled by the
+    trust ratio of its row, the ratio of the norms of the row and of its step.
+    """
+    embedding_specs: List[EmbeddingSpec]
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        lr: float = 1e-3,
+        betas: Tuple[float, float] = (0.9, 0.999),
+        eps: float = 1e-8,
+        weight_decay: float = 0,
+        lamb: bool = False
+    ):
+        super(MergedEmbeddingBagWithAdam, self).__init__(embedding_specs)
+        if lr < 0.0:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if eps < 0.0:
+            raise ValueError("Invalid epsilon value: {}".format(eps))
+        if not 0.0 <= betas[0] < 1.0 or not 0.0 <= betas[1] < 1.0:
+            raise ValueError("Invalid beta parameters: {}".format(betas))
+        if weight_decay < 0.0:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        bf16_trail = []
+        exp_avg = []
+        exp_avg_sq = []
+        for i in range(self.n_tables):
+            weight = self.weights[i]
+            if weight.dtype == torch.bfloat16:
+                bf16_trail.append(torch.zeros_like(weight, dtype=torch.bfloat16))
+            else:
+                bf16_trail.append(torch.empty(0, dtype=torch.bfloat16))
+            exp_avg.append(self._init_moment(weight))
+            exp_avg_sq.append(self._init_moment(weight))
+        self.adam_args = AdamArgs(
+            bf16_trail=bf16_trail,
+            exp_avg=exp_avg,
+            exp_avg_sq=exp_avg_sq,
+            step=torch.zeros(1, dtype=torch.long),
+            beta1=betas[0],
+            beta2=betas[1],
+            eps=eps,
+            weight_decay=weight_decay,
+            lr=lr,
+            lamb=lamb
+        )
+
+    @staticmethod
+    def _init_moment(weight):
+        # the moments are kept in the accumulate dtype of the table
+        dtype = torch.double if weight.dtype == torch.double else torch.float
+        return torch.zeros(weight.shape, dtype=dtype)
+
+    def to_bfloat16_train(self):
+        r"""
+        Cast weight to bf16 and it's trail part for training
+        """
+        trails = []
+        exp_avg = []
+        exp_avg_sq = []
+        for i in range(len(self.weights)):
+            if self.weights[i].dtype == torch.float:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i])
+            elif self.weights[i].dtype == torch.bfloat16:
+                bf16_w = self.weights[i]
+                trail = torch.zeros_like(bf16_w, dtype=torch.bfloat16)
+            elif self.weights[i].dtype == torch.double:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i].float())
+            else:
+                assert False, r"MergedEmbeddingBag only support dtypes with bfloat, float and double"
+            trails.append(trail)
+            exp_avg.append(self.adam_args.exp_avg[i].float())
+            exp_avg_sq.append(self.adam_args.exp_avg_sq[i].float())
+            self.weights[i] = torch.nn.Parameter(bf16_w)
+        self.adam_args = self.adam_args._replace(bf16_trail=trails, exp_avg=exp_avg, exp_avg_sq=exp_avg_sq)
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets(if not merged)/indices_with_row_offsets(if merged))
+            need_linearize_indices_and_offsets: indicate whether input need to be linearized
+        Returns:
+            List[Tensor] output shape of `(batch_size, feature_size)` which length = num of tables.
+        """
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, indices_with_row_offsets = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, indices_with_row_offsets = input
+        return merged_embeddingbag_adam(
+            indices, offsets, indices_with_row_offsets, self.row_offsets,
+            self.pooling_modes, self.adam_args, *self.weights, dedup=self.dedup
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        lr: float = 1e-3,
+        betas: Tuple[float, float] = (0.9, 0.999),
+        eps: float = 1e-8,
+        weight_decay: float = 0,
+        lamb: bool = False
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse
+                ))
+        return cls(embedding_specs, lr, betas, eps, weight_decay, lamb)
@@ -0,0 +1,44 @@
+import torch
+import intel_extension_for_pytorch as ipex  # noqa F401
+
+class StreamingConv1d(torch.nn.Module):
+    r"""
+    Runs a ``torch.nn.Conv1d`` causally on consecutive chunks of a stream in
+    inference, i.e. as the conv1d of the whole stream left padded with
+    ``(kernel_size - 1) * dilation`` zeros. The weight is prepacked once into
+    a convolution context, and the last frames of the stream the next outputs
+    read are kept in ``state``, so that each call only takes the new frames of
+    the chunk and computes the outputs of the windows ending in it.
+
+    Args:
+        conv (torch.nn.Conv1d): the module whose weight is packed. Its padding
+            is replaced by the causal left padding of the stream.
+    """
+
+    def __init__(self, conv):
+        super(StreamingConv1d, self).__init__()
+        assert isinstance(conv, torch.nn.Conv1d)
+        assert conv.padding_mode == 'zeros', "StreamingConv1d only supports the zeros padding mode"
+        self.weight_size = list(conv.weight.size())
+        bias = conv.bias.detach().clone() if conv.bias is not None else None
+        self.ctx = torch.ops.ipex_prepack.convolution_prepack(
+            conv.weight.detach().clone(), bias, list(conv.stride), [0],
+            list(conv.dilation), conv.groups, False, [])
+        self.state = None
+
+    def reset_state(self):
+        r"""Starts a new stream, left padded with zeros."""
+        self.state = None
+
+    def forward(self, x):
+        r"""
+        Returns the outputs of the chunk ``x`` of shape ``[B, C, T]``, which
+        may be fewer than ``T`` with a stride of more than 1. The frames read by
+        the next outputs are kept in ``state`` for the next chunk.
+        """
+        with torch.no_grad():
+            if self.state is not None and self.state.size(0) != x.size(0):
+                self.state = None
+            output, self.state = torch.ops.torch_ipex.streaming_conv1d(
+                x, self.state, self.ctx.get_data_handle(), self.weight_size)
+            return output
@@ -0,0 +1,77 @@
+import torch
+import intel_extension_for_pytorch as ipex  # noqa F401
+
+class StreamingLSTM(torch.nn.Module):
+    r"""
+    Runs a unidirectional ``torch.nn.LSTM`` on consecutive chunks of a stream
+    in inference, carrying the hidden and cell states from one call to the
+    next. The recurrent weights are packed once for the persistent LSTM kernel,
+    which runs the steps of a chunk in one parallel region with the gates
+    computed in registers.
+
+    Args:
+        lstm (torch.nn.LSTM): the module whose weights are packed.
+        cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): the cores
+            running the kernel, so that each core keeps its blocks of the
+            recurrent weights in cache across calls. The current cores are used
+            if it is ``None``.
+    """
+
+    def __init__(self, lstm, cpu_pool=None):
+        super(StreamingLSTM, self).__init__()
+        assert isinstance(lstm, torch.nn.LSTM)
+        assert not lstm.bidirectional, "StreamingLSTM only supports unidirectional LSTMs"
+        assert lstm.proj_size == 0, "StreamingLSTM does not support projections"
+        self.num_layers = lstm.num_layers
+        self.hidden_size = lstm.hidden_size
+        self.batch_first = lstm.batch_first
+        self.cpu_pool = cpu_pool
+        for layer in range(self.num_layers):
+            weight_ih = getattr(lstm, 'weight_ih_l%d' % layer).detach()
+            weight_hh = getattr(lstm, 'weight_hh_l%d' % layer).detach()
+            bias = None
+            if lstm.bias:
+                bias = getattr(lstm, 'bias_ih_l%d' % layer).detach() + \
+                    getattr(lstm, 'bias_hh_l%d' % layer).detach()
+            self.register_buffer('weight_ih_l%d' % layer, weight_ih.clone())
+            self.register_buffer('packed_weight_hh_l%d' % layer,
+                                 torch.ops.torch_ipex.streaming_lstm_pack(weight_hh))
+            self.register_buffer('bias_l%d' % layer, bias)
+        self.state = None
+
+    def reset_state(self):
+        r"""Starts a new stream from zero states."""
+        self.state = None
+
+    def _forward(self, x):
+        if self.batch_first:
+            x = x.transpose(0, 1)
+        batch = x.size(1)
+        if self.state is None or self.state[0].size(1) != batch:
+            zeros = torch.zeros(self.num_layers, batch, self.hidden_size, dtype=x.dtype)
+            self.state = (zeros, zeros.clone())
+        hy, cy = [], []
+        for layer in range(self.num_layers):
+            x, h, c = torch.ops.torch_ipex.streaming_lstm_layer(
+                x,
+                getattr(self, 'weight_ih_l%d' % layer),
+                getattr(self, 'bias_l%d' % layer),
+                getattr(self, 'packed_weight_hh_l%d' % layer),
+                self.state[0][layer],
+                self.state[1][layer])
+            hy.append(h)
+            cy.append(c)
+        self.state = (torch.stack(hy), torch.stack(cy))
+        return x.transpose(0, 1) if self.batch_first else x
+
+    def forward(self, x):
+        r"""
+        Returns the output of the chunk ``x`` of shape ``[T, B, input_size]``,
+        or ``[B, T, input_size]`` if the LSTM is batch first. The states of the
+        last step are kept in ``state`` for the next chunk.
+        """
+        with torch.no_grad():
+            if self.cpu_pool is None:
+                return self._forward(x)
+            with ipex.cpu.runtime.pin(self.cpu_pool):
+                return self._forward(x)
@@ -0,0 +1,60 @@
+import torch
+from torch import nn
+import intel_extension_for_pytorch as ipex  # noqa F401
+
+class WeightOnlyQuantizedLinear(nn.Module):
+    r"""
+    Linear with weight-only quantization for memory bound inference (e.g. LLM decoding): the weight is quantized
+    to int4/int8 asymmetrically, with one fp32 scale and zero point per group of `group_size` input channels, while
+    the activation stays in fp32/bf16. The weight is kept in a prepacked layout and dequantized inside the GEMM
+    kernel, the output has the dtype of the input.
+
+    Args:
+        qweight (Tensor): uint8 quantized weight of shape `(out_features, in_features)`, in [0, 2^bits - 1]
+        scales (Tensor): fp32 scales of shape `(out_features, in_features / group_size)`
+        zero_points (Tensor): zero points of the same shape as `scales`
+        bias (Tensor, optional): bias of shape `(out_features)`
+        bits (int): 4 or 8
+        group_size (int): the number of input channels sharing a scale, `-1` for per output channel
+
+    Examples::
+
+        >>> linear = torch.nn.Linear(4096, 4096)
+        >>> woq_linear = WeightOnlyQuantizedLinear.from_float(linear, bits=4, group_size=128)
+        >>> y = woq_linear(x)
+    """
+    def __init__(self, qweight, scales, zero_points, bias=None, bits=4, group_size=-1):
+        super(WeightOnlyQuantizedLinear, self).__init__()
+        assert bits in (4, 8), "WeightOnlyQuantizedLinear supports 4 or 8 bits"
+        self.out_features, self.in_features = qweight.shape
+        self.bits = bits
+        self.group_size = group_size
+        self.ctx = torch.ops.ipex_prepack.woq_linear_prepack_quantized(
+            qweight, scales, zero_points, bias, bits, group_size)
+
+    @classmethod
+    def from_float(cls, mod, bits=4, group_size=-1):
+        r"""
+        Quantize the weight of a `torch.nn.Linear`.
+        """
+        assert isinstance(mod, nn.Linear), "WeightOnlyQuantizedLinear.from_float expects a torch.nn.Linear"
+        woq_linear = cls.__new__(cls)
+        nn.Module.__init__(woq_linear)
+        woq_linear.out_features = mod.out_features
+        woq_linear.in_features = mod.in_features
+        woq_linear.bits = bits
+        woq_linear.group_size = group_size
+        bias = mod.bias.detach().float() if mod.bias is not None else None
+        woq_linear.ctx = torch.ops.ipex_prepack.woq_linear_prepack(
+            mod.weight.detach().float(), bias, bits, group_size)
+        return woq_linear
+
+    def dequantized_weight(self):
+        return self.ctx.to_public()
+
+    def extra_repr(self):
+        return 'in_features={}, out_features={}, bits={}, group_size={}'.format(
+            self.in_features, self.out_features, self.bits, self.group_size)
+
+    def forward(self, x):
+        return torch.ops.torch_ipex.ipex_woq_linear(x, self.ctx.get_data_handle())
@@ -1 +1 @@
-from . import _model_convert, _weight_cast, _weight_prepack
+from . import _model_convert, _weight_cast, _weight_prepack, _lazy_load
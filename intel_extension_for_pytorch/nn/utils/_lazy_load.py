@@ -0,0 +1,73 @@
+import os
+import warnings
+
+import torch
+
+from ._model_convert import convert_module_data_type
+from ._weight_prepack import weight_prepack_with_ipex
+from ...utils.checkpoint import _INDEX_FILE, _load_checkpoint_tensors
+
+def _open_checkpoint(checkpoint):
+    r"""
+    Returns the state dict of the checkpoint, whose tensors are read from disk lazily: a directory saved by
+    ``ipex.save_checkpoint``, a file saved by ``torch.save`` that is memory mapped, or a state dict.
+    """
+    if isinstance(checkpoint, dict):
+        return checkpoint
+    if os.path.isdir(checkpoint) and os.path.exists(os.path.join(checkpoint, _INDEX_FILE)):
+        return _load_checkpoint_tensors(checkpoint)
+    try:
+        return torch.load(checkpoint, map_location='cpu', mmap=True)
+    except TypeError:
+        warnings.warn("torch.load doesn't support mmap, the checkpoint is loaded into memory at once.")
+        return torch.load(checkpoint, map_location='cpu')
+
+def load_and_prepack(model, checkpoint, dtype=None, weights_prepack=True):
+    r"""
+    Materializes the params and buffers of the model, e.g. built on the meta device, from the checkpoint, and
+    converts them to dtype and prepacks them module by module, the children first. A module reads its tensors from
+    the mapped checkpoint, and its converted or packed tensors are allocated before the next module is read, so the
+    peak memory is the converted model plus one module instead of the fp32 model, its copy and the packed weights.
+    The tied params stay tied. Only for inference.
+    """
+    state_dict = _open_checkpoint(checkpoint)
+    loaded = {}
+
+    def load_tensor(key, meta):
+        if key not in state_dict:
+            raise RuntimeError(f"The checkpoint misses the key {key} of the model.")
+        tensor = state_dict[key]
+        if tensor.shape != meta.shape:
+            raise RuntimeError(
+                f"The shape {list(tensor.shape)} of {key} in the checkpoint mismatches {list(meta.shape)} of the model.")
+        return tensor
+
+    def materialize(module, prefix):
+        for name, child in module.named_children():
+            setattr(module, name, materialize(child, prefix + name + '.'))
+        has_params = False
+        for name, param in module._parameters.items():
+            if param is None:
+                continue
+            has_params = True
+            if param not in loaded:
+                loaded[param] = torch.nn.Parameter(load_tensor(prefix + name, param), requires_grad=False)
+            module._parameters[name] = loaded[param]
+        for name, buf in module._buffers.items():
+            if buf is None:
+                continue
+            if name in module._non_persistent_buffers_set:
+                if buf.is_meta:
+                    raise RuntimeError(f"The non persistent buffer {prefix + name} can't be loaded from the checkpoint.")
+                continue
+            module._buffers[name] = load_tensor(prefix + name, buf)
+        if not has_params:
+            return module
+        if dtype in [torch.bfloat16, torch.half]:
+            convert_module_data_type(module, dtype, recurse=False)
+        if weights_prepack:
+            module = weight_prepack_with_ipex(module, None, {}, True, 'cpu')[0]
+        return module
+
+    with torch.no_grad():
+        return materialize(model, '')
@@ -14,13 +14,15 @@ class _LSTM(torch.nn.LSTM):
         super().__init__(*args, **kwargs)
 
     # port from torch/nn/modules/rnn.py
-    # replace the _VF.lstm with torch.ops.torch_ipex.lstm when the input is not PackedSequence
+    # replace the _VF.lstm with torch.ops.torch_ipex.ipex_lstm, or torch.ops.torch_ipex.ipex_lstm_packed
+    # running the timesteps on the unfinished sequences only when the input is a PackedSequence
     def forward(self, input, hx=None):  # noqa: F811
         orig_input = input
         # xxx: isinstance check needs to be in conditional for TorchScript to compile
         if isinstance(orig_input, PackedSequence):
-            # fallback to PyTorch LSTM since PackedSequence unsupported in oneDNN
-            return super(_LSTM, self).forward(input, hx)
+            input, batch_sizes, sorted_indices, unsorted_indices = input
+            max_batch_size = batch_sizes[0]
+            max_batch_size = int(max_batch_size)
         else:
             batch_sizes = None
             max_batch_size = input.size(0) if self.batch_first else input.size(1)
@@ -43,13 +45,46 @@ class _LSTM(torch.nn.LSTM):
             hx = self.permute_hidden(hx, sorted_indices)
 
         self.check_forward_args(input, hx, batch_sizes)
-        result = torch.ops.torch_ipex.ipex_lstm(input, hx, self._flat_weights, self.bias, self.num_layers,
-                        self.dropout, self.training, self.bidirectional, self.batch_first)
+        if batch_sizes is None:
+            result = torch.ops.torch_ipex.ipex_lstm(input, hx, self._flat_weights, self.bias, self.num_layers,
+                            self.dropout, self.training, self.bidirectional, self.batch_first)
+        else:
+            result = torch.ops.torch_ipex.ipex_lstm_packed(input, batch_sizes, hx, self._flat_weights, self.bias,
+                            self.num_layers, self.dropout, self.training, self.bidirectional)
         output = result[0]
         hidden = result[1:]
 
+        if isinstance(orig_input, PackedSequence):
+            output_packed = PackedSequence(output, batch_sizes, sorted_indices, unsorted_indices)
+            return output_packed, self.permute_hidden(hidden, unsorted_indices)
         return output, self.permute_hidden(hidden, unsorted_indices)
 
+class _GRU(torch.nn.GRU):
+    # Swaps torch.nn.GRU with the ipex counterpart running the oneDNN
+    # linear-before-reset GRU in inference, like _LSTM.
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+
+    # port from torch/nn/modules/rnn.py
+    def forward(self, input, hx=None):  # noqa: F811
+        if isinstance(input, PackedSequence):
+            # fallback to PyTorch GRU since PackedSequence unsupported in oneDNN
+            return super(_GRU, self).forward(input, hx)
+        is_batched = input.dim() == 3
+        if not is_batched:
+            return super(_GRU, self).forward(input, hx)
+        max_batch_size = input.size(0) if self.batch_first else input.size(1)
+        if hx is None:
+            num_directions = 2 if self.bidirectional else 1
+            hx = torch.zeros(self.num_layers * num_directions,
+                             max_batch_size, self.hidden_size,
+                             dtype=input.dtype, device=input.device)
+
+        self.check_forward_args(input, hx, None)
+        output, hidden = torch.ops.torch_ipex.ipex_gru(input, hx, self._flat_weights, self.bias, self.num_layers,
+                                                       self.dropout, self.training, self.bidirectional, self.batch_first)
+        return output, hidden
+
 def replace_params_in_optimizer(optimizer, param_dict):
     if optimizer is None:
         return
@@ -62,10 +97,23 @@ def replace_params_in_optimizer(optimizer, param_dict):
                     optimizer.state[new_param] = optimizer.state.pop(p)
 
 def replace_lstm_with_ipex_lstm(model, optimizer):
-    # replace lstm with ipex lstm during inference
-    # does not support the case where model itself is torch.nn.LSTM
+    # replace lstm and gru with ipex lstm and gru during inference
+    # does not support the case where model itself is torch.nn.LSTM or torch.nn.GRU
     for child_name, child in model.named_children():
-        if isinstance(child, torch.nn.LSTM):
+        if isinstance(child, torch.nn.GRU):
+            assert hasattr(child, "weight_ih_l0"), "torch.nn.GRU should have weight_ih_l0"
+            ipex_gru = _GRU(child.input_size, child.hidden_size,
+                child.num_layers, child.bias, child.batch_first,
+                child.dropout, child.bidirectional,
+                device=child.weight_ih_l0.device, dtype=child.weight_ih_l0.dtype)
+            ipex_gru.__dict__ = copy.deepcopy(child.__dict__)
+            setattr(model, child_name, ipex_gru)
+            param_dict = {}
+            original_params = dict(child.named_parameters())
+            for name, para in ipex_gru.named_parameters():
+                param_dict.update({original_params[name] : para})
+            replace_params_in_optimizer(optimizer, param_dict)
+        elif isinstance(child, torch.nn.LSTM):
             assert hasattr(child, "weight_ih_l0"), "torch.nn.LSTM should have weight_ih_l0"
             ipex_lstm = _LSTM(child.input_size, child.hidden_size,
                 child.num_layers, child.bias, child.batch_first,
@@ -107,8 +155,9 @@ def _save_to_state_dict(self, destination, prefix, keep_vars):
         origin_param = param_dict[p]
         setattr(self, p, origin_param)
 
-def convert_module_data_type(module, dtype):
+def convert_module_data_type(module, dtype, recurse=True):
     # convert weights(bias) of module to dtype to reduce dtype reorder
+    # the converted params are allocated in dtype only, without an fp32 clone
     assert dtype in [torch.bfloat16, torch.float16], "module convert only support bf16 and fp16"
     module_convert_list_bf16 = [torch.nn.Conv2d,
                            torch.nn.Conv3d,
@@ -116,7 +165,8 @@ def convert_module_data_type(module, dtype):
                            torch.nn.ConvTranspose3d,
                            torch.nn.Linear,
                            torch.nn.Embedding,
-                           torch.nn.LSTM]
+                           torch.nn.LSTM,
+                           torch.nn.GRU]
 
     module_convert_list_fp16 = [torch.nn.Conv1d,
                                 torch.nn.Conv2d,
@@ -130,12 +180,12 @@ def convert_module_data_type(module, dtype):
     for module_cls in module_convert_lists[dtype]:
         if isinstance(module, module_cls):
             setattr(module, '_save_to_state_dict', types.MethodType(_save_to_state_dict, module))
-            if module_cls is torch.nn.LSTM:
+            if module_cls is torch.nn.LSTM or module_cls is torch.nn.GRU:
                 for name, param in module.named_parameters():
                     ori_data = getattr(getattr(module, name), "data")
                     ori_data_dtype = ori_data.dtype
                     if ori_data_dtype == torch.float or ori_data_dtype == torch.bfloat16:
-                        casted_data = ori_data.detach().clone().to(dtype)
+                        casted_data = ori_data.detach().to(dtype, copy=True)
                         setattr(getattr(module, name), "data", casted_data)
                     else:
                         warnings.warn(f"WARNING: Can't convert model's parameters dtyep from {ori_data_dtype} to {dtype}")
@@ -144,14 +194,15 @@ def convert_module_data_type(module, dtype):
                 ori_data_dtype = module.weight.dtype
                 # Assume weight and bias have same dtype, only need check weight dtype here.
                 if ori_data_dtype == torch.float or ori_data_dtype == torch.bfloat16 or ori_data_dtype == torch.half:
-                    weight_data = module.weight.detach().clone().to(dtype)
+                    weight_data = module.weight.detach().to(dtype, copy=True)
                     module.weight.data = weight_data
                     if hasattr(module, 'bias') and module.bias is not None:
-                        bias_data = module.bias.detach().clone().to(dtype)
+                        bias_data = module.bias.detach().to(dtype, copy=True)
                         module.bias.data = bias_data
                 else:
                     warnings.warn(f"WARNING: Can't convert model's parameters dtype from {ori_data_dtype} to {dtype}")
             break
-    for child in module.children():
-        convert_module_data_type(child, dtype)
+    if recurse:
+        for child in module.children():
+            convert_module_data_type(child, dtype)
     return module
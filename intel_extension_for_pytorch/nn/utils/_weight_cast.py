@@ -2,7 +2,7 @@ import torch
 import torch.nn as nn
 from intel_extension_for_pytorch.optim import _optimizer_utils, _lamb
 import types
-from ._model_convert import _LSTM
+from ._model_convert import _LSTM, _GRU
 from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBag as MergedEmbeddingBag
 
 # IPEX does not cast all module parameters for acc reason, such as BN
@@ -19,6 +19,7 @@ IPEX_WEIGHT_CAST_MODULE_BF16 = {
     torch.nn.EmbeddingBag,
     torch.nn.Embedding,
     _LSTM,
+    _GRU,
     MergedEmbeddingBag,
 }
 
@@ -50,6 +51,10 @@ def _save_to_state_dict(self, destination, prefix, keep_vars):
                 getattr(self, 'master_' + name),
                 requires_grad=temp.requires_grad)
             setattr(self, name, temp_para)
+        elif para.dtype == torch.bfloat16:
+            # pure bf16 params, updated with stochastic rounding
+            temp_para = torch.nn.Parameter(para.float(), requires_grad=temp.requires_grad)
+            setattr(self, name, temp_para)
     super(type(self), self)._save_to_state_dict(destination, prefix, keep_vars)
     for p in param_dict:
         origin_param = param_dict[p]
@@ -68,17 +73,28 @@ def _load_from_state_dict(self, state_dict, prefix, local_metadata, strict,
                     getattr(self, 'master_' + name).copy_(fp32_param)
                     getattr(self, name).copy_(fp32_param.bfloat16())
                 elif hasattr(self, name + '_trail'):
-                    top, bot = torch.ops.torch_ipex.split_float_bfloat16(fp32_param)
-                    getattr(self, name).copy_(top)
-                    getattr(self, name + '_trail').copy_(bot)
+                    # split into the param and the trail, without the transient halves
+                    torch.ops.torch_ipex.split_float_bfloat16.out(
+                        fp32_param.float(), top=getattr(self, name).data, bot=getattr(self, name + '_trail'))
+                else:
+                    getattr(self, name).copy_(fp32_param)
 
-def weight_dtype_convert_with_ipex(module, optimizer, params_attr, master_weight_split, convert_dtype=torch.bfloat16):
+def weight_dtype_convert_with_ipex(module, optimizer, params_attr, master_weight_split, convert_dtype=torch.bfloat16,
+                                   stochastic_rounding=False):
+    r"""
+    With stochastic_rounding, the params are casted to pure bf16 params, without
+    trail or master weight, whose fused update steps round stochastically.
+    """
     assert convert_dtype in [torch.bfloat16, torch.float16], "weight convert only support bf16 and fp16"
+    assert not stochastic_rounding or (master_weight_split and convert_dtype == torch.bfloat16), \
+        "stochastic rounding is only supported for bf16 params updated like split master weights"
     def cast_attr(m, attr, master_weight_split, params_attr, optimizer):
         # cast weight/bias for BF16 or FP16 dtype
         float_param = getattr(m, attr)
         params_attr[float_param] = {}
-        if master_weight_split:
+        if stochastic_rounding:
+            setattr(m, attr, nn.Parameter(float_param.detach().bfloat16(), requires_grad=float_param.requires_grad))
+        elif master_weight_split:
             if not hasattr(m, attr + '_trail'):
                 assert convert_dtype == torch.bfloat16, "master_weight_split is only support for bf16 now"
                 top_half, bot_half = torch.ops.torch_ipex.split_float_bfloat16(float_param.data)
@@ -7,6 +7,7 @@ import logging
 import os
 
 from intel_extension_for_pytorch import optim, frontend
+from intel_extension_for_pytorch.cpu import comm
 from intel_extension_for_pytorch.cpu._auto_kernel_selection import _using_dnnl
 import intel_extension_for_pytorch._C as core
 
@@ -41,11 +42,55 @@ if may_import_deepspeed_modules() is not None:
             assert group is not None
             comm.all_reduce(self, group=group, op=op, async_op=False)
         return self 
+    def _all_reduce_async(self):
+        # the sum of the tensor over the ranks, as by torch.ops.deepspeed_comm.all_reduce, returning the work handle
+        world_size = int(os.environ['WORLD_SIZE'])
+        if os.environ.get("PREFER_DEEPSPEED_COMM"):
+            return comm.all_reduce(self, async_op=True)
+        group = c10d._find_or_create_pg_by_ranks_and_tag("", list(range(world_size)), world_size)
+        assert group is not None
+        return comm.all_reduce(self, group=group, op=dist.ReduceOp.SUM, async_op=True)
     ds_comm = torch.library.Library("deepspeed_comm", "DEF")
     ds_comm.define("all_reduce(Tensor self, str reduceOp, str tag, int[] ranks, int group_size) -> Tensor")
     ds_comm_lib_cpu = torch.library.Library("deepspeed_comm", "IMPL", "CPU") 
     ds_comm_lib_cpu.impl("all_reduce", _all_reduce) 
 
+# The chunks of the rows of the output of a tensor-parallel linear, whose GEMMs are pipelined with the allreduces of
+# the previous chunks, and the fewest rows of a chunk, below which the allreduce of the whole output is not split
+_LINEAR_ALLREDUCE_CHUNKS = int(os.environ.get("IPEX_LINEAR_ALLREDUCE_CHUNKS", "4"))
+_LINEAR_ALLREDUCE_MIN_CHUNK_ROWS = 32
+
+def _linear_allreduce(x, gemm, out_features):
+    r"""
+    Computes gemm(x) and sums it over the ranks of the tensor parallel group. The rows of the flattened input are
+    split into chunks, the allreduce of the output of a chunk being started asynchronously while the GEMM of the
+    next chunk computes, so that the communication is mostly hidden behind the compute. The blocking
+    ``torch.ops.deepspeed_comm.all_reduce`` of the whole output is used under tracing, and for the inputs of too few
+    rows, e.g. of the next token generation. These allreduces sum over all the ranks, and so, once
+    ``ipex.cpu.comm.init_shm_allreduce`` is called for the default process group, the whole output is summed by the
+    shared memory allreduce instead, whose reduction runs on the cores and can't be overlapped.
+    """
+    rows = x.numel() // x.size(-1) if x.dim() > 0 and x.size(-1) > 0 else 0
+    chunks = min(_LINEAR_ALLREDUCE_CHUNKS, rows // _LINEAR_ALLREDUCE_MIN_CHUNK_ROWS)
+    shm = comm.is_shm_allreduce_group()
+    if shm or torch.jit.is_tracing() or torch.jit.is_scripting() or chunks < 2:
+        output = gemm(x)
+        if shm and output.is_contiguous() and output.dtype in (torch.float, torch.bfloat16):
+            return torch.ops.torch_ipex.shm_all_reduce_(output)
+        world_size = int(os.environ['WORLD_SIZE'])
+        torch.ops.deepspeed_comm.all_reduce(output, 'sum', "", list(torch.arange(world_size)), world_size)
+        return output
+    outputs = []
+    works = []
+    for chunk in x.reshape(rows, x.size(-1)).chunk(chunks):
+        output = gemm(chunk)
+        outputs.append(output)
+        works.append(_all_reduce_async(output))
+    for work in works:
+        if work is not None:
+            work.wait()
+    return torch.cat(outputs).view(*x.shape[:-1], out_features)
+
 def _save_weight_bias_to_state_dict(self, destination, prefix):
     if self.bias is not None:
         if hasattr(self, 'master_bias'):
@@ -285,13 +330,21 @@ class _IPEXLinearAllreduce(_IPEXLinear):
         self.mp_group = dense_module.mp_group
 
     def post_ipex_gemm(self, output):
-        if self.mp_group is not None:
-            torch.ops.deepspeed_comm.all_reduce(output, 'sum', "", list(torch.arange(int(os.environ['WORLD_SIZE']))), int(os.environ['WORLD_SIZE']))
-
         if self.module_bias is not None:
             output += self.module_bias
         return output
 
+    def forward(self, x):
+        if self.mp_group is None:
+            return super(_IPEXLinearAllreduce, self).forward(x)
+        if self.use_dnnl:
+            gemm = lambda x: torch.ops.torch_ipex.ipex_linear(
+                x, self.weight, self.bias, self.ctx.get_data_handle(), self.out_features)
+        else:
+            gemm = lambda x: torch.ops.torch_ipex.ipex_MKLSGEMM(
+                x, self.weight, self.bias, self.ctx.get_data_handle(), self.out_features)
+        return self.post_ipex_gemm(_linear_allreduce(x, gemm, self.out_features))
+
 class _IPEXConvTransposeNd(nn.Module):
     __constants__ = ['stride', 'padding', 'dilation', 'groups',
                      'out_channels', 'kernel_size', 'output_padding']
@@ -577,7 +630,7 @@ def record_input_shape_for_prepack(module, sample_input):
             self.input_shape = input[0].shape
 
     def register_hook_function(module):
-        if type(module) in [torch.nn.Linear, torch.nn.Conv1d, torch.nn.Conv2d, torch.nn.Conv3d, torch.nn.ConvTranspose2d]:
+        if type(module) in [torch.nn.Linear, torch.nn.Conv1d, torch.nn.Conv2d, torch.nn.Conv3d, torch.nn.ConvTranspose2d, torch.nn.ConvTranspose3d]:
             module.register_forward_pre_hook(hook_function)
 
     def register_hook_function_rec(module):
@@ -1 +1 @@
-
+from ._sharded import ShardedOptimizer
@@ -0,0 +1,133 @@
+import torch
+from ._functional import _adafactor_impl, _adafactor_init_state
+
+
+class Adafactor(torch.optim.Optimizer):
+    r"""Implements Adafactor algorithm.
+    It has been proposed in `Adafactor: Adaptive Learning Rates with Sublinear
+    Memory Cost`_. The second moments of a param of at least 2 dims are
+    factored in running averages of its rows and of its columns over its last
+    two dims. As the optimizer sees the params, the weights of
+    ``ipex.optimize`` are to be kept in their original shapes with
+    ``weights_prepack=False``.
+    Args:
+        params (iterable): iterable of parameters to optimize or dicts defining
+            parameter groups
+        lr (float, optional): external learning rate, the relative step size
+            ``min(1e-2, 1 / sqrt(step))`` is used if ``None`` (default: None)
+        eps (Tuple[float, float], optional): regularization constants of the
+            squared grad and of the param scale (default: (1e-30, 1e-3))
+        clip_threshold (float, optional): threshold of the root mean square of
+            the final update (default: 1.0)
+        decay_rate (float, optional): coefficient of the running averages of
+            the squared grad, beta2 being ``1 - step ** decay_rate``
+            (default: -0.8)
+        beta1 (float, optional): coefficient of the running average of the
+            update, no first moments are kept if ``None`` (default: None)
+        weight_decay (float, optional): weight decay (default: 0)
+        scale_parameter (boolean, optional): whether to scale the step size by
+            the root mean square of the param (default: True)
+        relative_step (boolean, optional): whether to use the relative step
+            size instead of lr (default: True)
+        warmup_init (boolean, optional): whether the relative step size warms
+            up as ``1e-6 * step`` (default: False)
+        fused (boolean, optional): whether to use fused kernel to accelerate
+            (default: False)
+    .. _Adafactor: Adaptive Learning Rates with Sublinear Memory Cost:
+        https://arxiv.org/abs/1804.04235
+    """
+
+    def __init__(self, params, lr=None, eps=(1e-30, 1e-3), clip_threshold=1.0,
+                 decay_rate=-0.8, beta1=None, weight_decay=0.0, scale_parameter=True,
+                 relative_step=True, warmup_init=False, fused=False):
+        if lr is not None and relative_step:
+            raise ValueError("Cannot combine manual lr and relative_step options")
+        if lr is None and not relative_step:
+            raise ValueError("Expect a lr without relative_step")
+        if warmup_init and not relative_step:
+            raise ValueError("warmup_init requires relative_step")
+        if lr is not None and not 0.0 <= lr:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if beta1 is not None and not 0.0 <= beta1 < 1.0:
+            raise ValueError("Invalid beta1 value: {}".format(beta1))
+        if not 0.0 < clip_threshold:
+            raise ValueError("Invalid clip_threshold value: {}".format(clip_threshold))
+        if not 0.0 <= weight_decay:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        defaults = dict(lr=lr, eps=eps, clip_threshold=clip_threshold,
+                        decay_rate=decay_rate, beta1=beta1, weight_decay=weight_decay,
+                        scale_parameter=scale_parameter, relative_step=relative_step,
+                        warmup_init=warmup_init, fused=fused)
+        super(Adafactor, self).__init__(params, defaults)
+        self.params_attr = {}
+        self.fused = fused
+
+    def __setstate__(self, state):
+        super(Adafactor, self).__setstate__(state)
+
+    @torch.no_grad()
+    def step(self, closure=None):
+        """Performs a single optimization step.
+        Args:
+            closure (callable, optional): A closure that reevaluates the model
+                and returns the loss.
+        """
+        loss = None
+        if closure is not None:
+            with torch.enable_grad():
+                loss = closure()
+
+        for group in self.param_groups:
+            params_with_grad = []
+            grads = []
+            exp_avgs = []
+            exp_avg_sq_rows = []
+            exp_avg_sq_cols = []
+            exp_avg_sqs = []
+            state_steps = []
+
+            for p in group['params']:
+                grad = p.grad
+                if grad is not None:
+                    params_with_grad.append(p)
+                    if grad.is_sparse:
+                        raise RuntimeError('Adafactor does not support sparse gradients')
+                    if grad.device != torch.device('cpu'):
+                        raise RuntimeError('Adafactor supports only CPU device')
+                    grads.append(grad)
+
+                    state = self.state[p]
+                    # Lazy state initialization
+                    if len(state) == 0:
+                        _adafactor_init_state(state, p, group['beta1'])
+
+                    exp_avgs.append(state['exp_avg'])
+                    exp_avg_sq_rows.append(state['exp_avg_sq_row'])
+                    exp_avg_sq_cols.append(state['exp_avg_sq_col'])
+                    exp_avg_sqs.append(state['exp_avg_sq'])
+
+                    # update the steps for each param group update
+                    state['step'] += 1
+                    # record the step after step update
+                    state_steps.append(state['step'])
+
+            eps1, eps2 = group['eps']
+            _adafactor_impl(
+                params_with_grad,
+                grads,
+                exp_avgs,
+                exp_avg_sq_rows,
+                exp_avg_sq_cols,
+                exp_avg_sqs,
+                state_steps,
+                group['lr'],
+                group['beta1'],
+                group['decay_rate'],
+                eps1,
+                eps2,
+                group['clip_threshold'],
+                group['weight_decay'],
+                group['scale_parameter'],
+                group['relative_step'],
+                group['warmup_init'])
+        return loss
@@ -28,6 +28,40 @@ def get_param2(param, params_attr):
             param2 = params_attr[param]['bf16_param']
     return param2
 
+def _grad_scaler_inv_scale(self, grad_scaler):
+    r"""
+    The factor the fused steps of a step by grad_scaler multiply the grads by,
+    or None if the grads have infs/NaNs and the step is skipped. The scaled
+    grads of all the params are checked in one pass which doesn't write them,
+    the result being recorded for grad_scaler.update(), and are unscaled by the
+    fused steps as they read them instead of in place beforehand.
+    """
+    if grad_scaler is None:
+        return 1.0
+    # the stages of the GradScaler of IPEX or of PyTorch
+    optimizer_state = grad_scaler._per_optimizer_states[id(self)]
+    grads = []
+    if optimizer_state["stage"].name == "READY":
+        for group in self.param_groups:
+            for p in group['params']:
+                grad = get_bf16_grad(p, self.params_attr) if is_master_weight(p, self.params_attr) else p.grad
+                if grad is not None:
+                    grads.append(grad._values() if grad.is_sparse else grad)
+        if any(grad.dtype not in [torch.float, torch.bfloat16, torch.double] for grad in grads):
+            grad_scaler.unscale_(self)
+    if optimizer_state["stage"].name == "UNSCALED":
+        # the grads are unscaled already, e.g. to be clipped
+        found_inf = sum(v.item() for v in optimizer_state["found_inf_per_device"].values())
+        return None if found_inf else 1.0
+    found_inf = torch.ops.torch_ipex.non_finite_check_foreach(grads)
+    scale = grad_scaler._scale
+    optimizer_state["found_inf_per_device"] = {
+        scale.device: torch.full((1,), float(found_inf), dtype=torch.float32, device=scale.device)}
+    if found_inf:
+        return None
+    # FP32 division can be imprecise for certain compile options, so we carry out the reciprocal in FP64.
+    return scale.double().reciprocal().float().item()
+
 def _make_sparse(grad, grad_indices, values):
     size = grad.size()
     if grad_indices.numel() == 0 or values.numel() == 0:
@@ -97,7 +131,6 @@ def _single_tensor_adagrad(params: List[Tensor],
                 param = torch.view_as_complex(param)
                 state_sum = torch.view_as_complex(state_sum)
 
-# keep this function here if enable fused_foreach_adagrad_later
 def _multi_tensor_adagrad(params: List[Tensor],
                           params2: List[Tensor],
                           grads: List[Tensor],
@@ -119,19 +152,34 @@ def _multi_tensor_adagrad(params: List[Tensor],
     if maximize:
         grads = torch._foreach_neg(grads)
 
-    _single_tensor_adagrad(params,
-                            params2,
-                            grads,
-                            state_sums,
-                            state_steps,
-                            lr=lr,
-                            weight_decay=weight_decay,
-                            lr_decay=lr_decay,
-                            eps=eps,
-                            has_sparse_grad=has_sparse_grad,
-                            maximize=False,
-                            fused=fused)
-    return
+    if has_sparse_grad or any(torch.is_complex(p) for p in params):
+        _single_tensor_adagrad(params,
+                                params2,
+                                grads,
+                                state_sums,
+                                state_steps,
+                                lr=lr,
+                                weight_decay=weight_decay,
+                                lr_decay=lr_decay,
+                                eps=eps,
+                                has_sparse_grad=has_sparse_grad,
+                                maximize=False,
+                                fused=fused)
+        return
+
+    # update steps, the params are updated in a single parallel region
+    torch._foreach_add_(state_steps, 1)
+    steps = [step_t.item() for step_t in state_steps]
+    torch.ops.torch_ipex.adagrad_fused_step_foreach(
+        params,
+        grads,
+        state_sums,
+        params2,
+        steps,
+        lr,
+        weight_decay,
+        lr_decay,
+        eps)
 
 def adagrad(params: List[Tensor],
             params2: List[Tensor],
@@ -274,7 +322,8 @@ def _single_tensor_sgd(params: List[Tensor],
                       nesterov: bool,
                       maximize: bool,
                       has_sparse_grad: bool,
-                      fused: bool):
+                      fused: bool,
+                      inv_grad_scale: float = 1.0):
     for i, param in enumerate(params):
         grad = grads[i] if not maximize else -grads[i]
         if not grad.is_sparse:
@@ -287,7 +336,8 @@ def _single_tensor_sgd(params: List[Tensor],
                 lr,
                 weight_decay,
                 dampening,
-                nesterov)
+                nesterov,
+                inv_grad_scale)
             continue
 
         if (
@@ -298,10 +348,12 @@ def _single_tensor_sgd(params: List[Tensor],
             momentum == 0
         ):
             # packed_add can support sparse tensor
-            torch.ops.torch_ipex.packed_add(param, params2[i], grad, -lr)
+            torch.ops.torch_ipex.packed_add(param, params2[i], grad, -lr * inv_grad_scale)
         else:
             # no special optimize for other non fused case, fall back to naive implementation
             grad = grad.to(param.dtype)
+            if inv_grad_scale != 1.0:
+                grad = grad * inv_grad_scale
             momentum_buffer_list[i] = _sgd_non_fused_micro_step(
                 param,
                 grad,
@@ -313,7 +365,6 @@ def _single_tensor_sgd(params: List[Tensor],
                 nesterov
             )
 
-# keep this function here if enable fused_foreach_sgd_later
 def _multi_tensor_sgd(params: List[Tensor],
                       params2: List[Tensor],
                       grads: List[Tensor],
@@ -326,23 +377,45 @@ def _multi_tensor_sgd(params: List[Tensor],
                       nesterov: bool,
                       maximize: bool,
                       has_sparse_grad: bool,
-                      fused: bool):
+                      fused: bool,
+                      inv_grad_scale: float = 1.0):
 
     if len(params) == 0:
         return
 
-    _single_tensor_sgd(params,
-                        params2,
-                        grads,
-                        momentum_buffer_list,
-                        weight_decay=weight_decay,
-                        momentum=momentum,
-                        lr=lr,
-                        dampening=dampening,
-                        nesterov=nesterov,
-                        maximize=maximize,
-                        has_sparse_grad=has_sparse_grad,
-                        fused=fused)
+    if has_sparse_grad:
+        _single_tensor_sgd(params,
+                            params2,
+                            grads,
+                            momentum_buffer_list,
+                            weight_decay=weight_decay,
+                            momentum=momentum,
+                            lr=lr,
+                            dampening=dampening,
+                            nesterov=nesterov,
+                            maximize=maximize,
+                            has_sparse_grad=has_sparse_grad,
+                            fused=fused,
+                            inv_grad_scale=inv_grad_scale)
+        return
+
+    if maximize:
+        grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
+
+    # the params are updated in a single parallel region
+    bufs = torch.ops.torch_ipex.sgd_fused_step_foreach(
+        params,
+        grads,
+        momentum_buffer_list,
+        params2,
+        momentum,
+        lr,
+        weight_decay,
+        dampening,
+        nesterov,
+        inv_grad_scale)
+    for i, buf in enumerate(bufs):
+        momentum_buffer_list[i] = buf
 
 def sgd(params: List[Tensor],
         params2: List[Tensor],
@@ -359,10 +432,12 @@ def sgd(params: List[Tensor],
         dampening: float,
         nesterov: bool,
         maximize: bool,
-        fused: bool):
+        fused: bool,
+        inv_grad_scale: float = 1.0):
     r"""Functional API that performs SGD algorithm computation.
 
-    See :class:`~torch.optim.SGD` for details.
+    See :class:`~torch.optim.SGD` for details. The grads are multiplied by
+    inv_grad_scale, e.g. the inverse scale of a GradScaler.
     """
 
     if foreach is None:
@@ -388,21 +463,28 @@ def sgd(params: List[Tensor],
          nesterov=nesterov,
          has_sparse_grad=has_sparse_grad,
          maximize=maximize,
-         fused=fused)
+         fused=fused,
+         inv_grad_scale=inv_grad_scale)
 
 @torch.no_grad()
-def sgd_step(self, closure=None):
+def sgd_step(self, closure=None, grad_scaler=None):
     """Performs a single optimization step.
 
     Args:
         closure (callable, optional): A closure that reevaluates the model
             and returns the loss.
+        grad_scaler (GradScaler, optional): The GradScaler stepping the
+            optimizer, whose scaled grads are checked and unscaled by the step.
     """
     loss = None
     if closure is not None:
         with torch.enable_grad():
             loss = closure()
 
+    inv_grad_scale = _grad_scaler_inv_scale(self, grad_scaler)
+    if inv_grad_scale is None:
+        return loss
+
     for group in self.param_groups:
         params_with_grad = []
         params2 = []
@@ -439,7 +521,8 @@ def sgd_step(self, closure=None):
             maximize=group['maximize'],
             has_sparse_grad=has_sparse_grad,
             foreach=group['foreach'],
-            fused=self.fused)
+            fused=self.fused,
+            inv_grad_scale=inv_grad_scale)
 
         # update momentum_buffers in state
         for p, momentum_buffer in zip(params_with_grad, momentum_buffer_list):
@@ -460,6 +543,7 @@ def _lamb_fused_impl(
     lr: float,
     weight_decay: float,
     eps: float,
+    inv_grad_scale: float = 1.0,
 ):
 
     r"""Functional API that performs Lamb algorithm computation.
@@ -484,7 +568,8 @@ def _lamb_fused_impl(
             beta2,
             lr,
             weight_decay,
-            eps)
+            eps,
+            inv_grad_scale)
 
 def _lamb_impl(
     params: List[Tensor],
@@ -525,17 +610,23 @@ def _lamb_impl(
         param.add_(adam_step, alpha=-lr * true_ratio)
 
 @torch.no_grad()
-def lamb_step(self, closure=None):
+def lamb_step(self, closure=None, grad_scaler=None):
     """Performs a single optimization step.
     Args:
         closure (callable, optional): A closure that reevaluates the model
             and returns the loss.
+        grad_scaler (GradScaler, optional): The GradScaler stepping the
+            optimizer, whose scaled grads are checked and unscaled by the step.
     """
     loss = None
     if closure is not None:
         with torch.enable_grad():
             loss = closure()
 
+    inv_grad_scale = _grad_scaler_inv_scale(self, grad_scaler)
+    if inv_grad_scale is None:
+        return loss
+
     for group in self.param_groups:
         params_with_grad = []
         grads = []
@@ -582,22 +673,29 @@ def lamb_step(self, closure=None):
             beta2,
             group['lr'],
             group['weight_decay'],
-            group['eps'])
+            group['eps'],
+            inv_grad_scale)
     return loss
 
 @torch.no_grad()
-def adam_step(self, closure=None):
+def adam_step(self, closure=None, grad_scaler=None):
     """Performs a single optimization step.
 
     Args:
         closure (callable, optional): A closure that reevaluates the model
             and returns the loss.
+        grad_scaler (GradScaler, optional): The GradScaler stepping the
+            optimizer, whose scaled grads are checked and unscaled by the step.
     """
     loss = None
     if closure is not None:
         with torch.enable_grad():
             loss = closure()
 
+    inv_grad_scale = _grad_scaler_inv_scale(self, grad_scaler)
+    if inv_grad_scale is None:
+        return loss
+
     for group in self.param_groups:
         params_with_grad = []
         params2 = []
@@ -654,7 +752,8 @@ def adam_step(self, closure=None):
                 weight_decay=group['weight_decay'],
                 eps=group['eps'],
                 maximize=group['maximize'],
-                foreach=group['foreach'])
+                foreach=group['foreach'],
+                inv_grad_scale=inv_grad_scale)
 
     return loss
 
@@ -676,9 +775,11 @@ def adam(params: List[Tensor],
         lr: float,
         weight_decay: float,
         eps: float,
-        maximize: bool):
+        maximize: bool,
+        inv_grad_scale: float = 1.0):
     r"""Functional API that performs Adam algorithm computation.
-    See :class:`~torch.optim.Adam` for details.
+    See :class:`~torch.optim.Adam` for details. The grads are multiplied by
+    inv_grad_scale, e.g. the inverse scale of a GradScaler.
     """
 
     if not all([isinstance(t, torch.Tensor) for t in state_steps]):
@@ -709,7 +810,8 @@ def adam(params: List[Tensor],
             lr=lr,
             weight_decay=weight_decay,
             eps=eps,
-            maximize=maximize)
+            maximize=maximize,
+            inv_grad_scale=inv_grad_scale)
 
 
 def _single_tensor_adam(params: List[Tensor],
@@ -726,7 +828,8 @@ def _single_tensor_adam(params: List[Tensor],
                     lr: float,
                     weight_decay: float,
                     eps: float,
-                    maximize: bool):
+                    maximize: bool,
+                    inv_grad_scale: float = 1.0):
 
     for i, param in enumerate(params):
 
@@ -756,7 +859,8 @@ def _single_tensor_adam(params: List[Tensor],
             beta2,
             lr,
             weight_decay,
-            eps)
+            eps,
+            inv_grad_scale)
 
 def _multi_tensor_adam(params: List[Tensor],
                     params2: List[Tensor],
@@ -772,7 +876,8 @@ def _multi_tensor_adam(params: List[Tensor],
                     lr: float,
                     weight_decay: float,
                     eps: float,
-                    maximize: bool):
+                    maximize: bool,
+                    inv_grad_scale: float = 1.0):
 
     if len(params) == 0:
         return
@@ -780,22 +885,26 @@ def _multi_tensor_adam(params: List[Tensor],
     if maximize:
         grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
 
-    _single_tensor_adam(
+    if not amsgrad:
+        max_exp_avg_sqs = [torch.Tensor() for _ in params]
+    # update steps, the params are updated in a single parallel region
+    torch._foreach_add_(state_steps, 1)
+    steps = [step_t.item() for step_t in state_steps]
+    torch.ops.torch_ipex.adam_fused_step_foreach(
         params,
-        params2,
-        grads,
         exp_avgs,
         exp_avg_sqs,
         max_exp_avg_sqs,
-        state_steps,
-        amsgrad=amsgrad,
-        beta1=beta1,
-        beta2=beta2,
-        lr=lr,
-        weight_decay=weight_decay,
-        eps=eps,
-        maximize=False
-    )
+        grads,
+        params2,
+        amsgrad,
+        steps,
+        beta1,
+        beta2,
+        lr,
+        weight_decay,
+        eps,
+        inv_grad_scale)
 
 def adamw(params: List[Tensor],
           params2: List[Tensor],
@@ -1014,3 +1123,289 @@ def adamw_step(self, closure=None):
               foreach=group['foreach'])
 
     return loss
+
+# Elements of a block of the 8-bit Adam moments, adam_8bit_block_size of the
+# adam_fused_step_8bit kernel
+ADAM_8BIT_BLOCK_SIZE = 256
+
+@torch.no_grad()
+def adam_8bit_step(self, closure=None):
+    """Performs a single optimization step of Adam or AdamW, the moments being
+    stored in 8 bits per element with one fp32 scale per block of
+    ADAM_8BIT_BLOCK_SIZE elements.
+
+    Args:
+        closure (callable, optional): A closure that reevaluates the model
+            and returns the loss.
+    """
+    loss = None
+    if closure is not None:
+        with torch.enable_grad():
+            loss = closure()
+
+    decoupled_weight_decay = isinstance(self, torch.optim.AdamW)
+    for group in self.param_groups:
+        if group['amsgrad']:
+            raise RuntimeError('The 8-bit optimizer states do not support amsgrad')
+        beta1, beta2 = group['betas']
+
+        for p in group['params']:
+            grad = get_bf16_grad(p, self.params_attr) if is_master_weight(p, self.params_attr) else p.grad
+            if grad is None:
+                continue
+            if grad.is_sparse:
+                raise RuntimeError('Adam does not support sparse gradients, please consider SparseAdam instead')
+            if group.get('maximize', False):
+                grad = -grad
+
+            state = self.state[p]
+            # Lazy state initialization
+            if len(state) == 0:
+                num_blocks = (p.numel() + ADAM_8BIT_BLOCK_SIZE - 1) // ADAM_8BIT_BLOCK_SIZE
+                state['step'] = torch.tensor(0.)
+                # The 8-bit codes of the moments and the max of each block
+                state['exp_avg'] = torch.zeros(p.numel(), dtype=torch.int8)
+                state['exp_avg_scale'] = torch.zeros(num_blocks)
+                state['exp_avg_sq'] = torch.zeros(p.numel(), dtype=torch.uint8)
+                state['exp_avg_sq_scale'] = torch.zeros(num_blocks)
+
+            state['step'] += 1
+            torch.ops.torch_ipex.adam_fused_step_8bit(
+                p,
+                state['exp_avg'],
+                state['exp_avg_scale'],
+                state['exp_avg_sq'],
+                state['exp_avg_sq_scale'],
+                grad,
+                get_param2(p, self.params_attr),
+                state['step'].item(),
+                beta1,
+                beta2,
+                group['lr'],
+                group['weight_decay'],
+                group['eps'],
+                decoupled_weight_decay)
+
+    return loss
+
+def _lars_impl(
+    params: List[Tensor],
+    grads: List[Tensor],
+    momentum_buffers: List[Tensor],
+    momentum: float,
+    lr: float,
+    weight_decay: float,
+    trust_coefficient: float,
+    eps: float,
+    adaptation: bool,
+):
+    r"""Functional API that performs LARS algorithm computation.
+    """
+    for i, param in enumerate(params):
+        grad = grads[i].to(momentum_buffers[i].dtype)
+        trust_ratio = 1.0
+        if adaptation:
+            param_norm = param.norm(p=2)
+            grad_norm = grad.norm(p=2)
+            if param_norm > 0 and grad_norm > 0:
+                trust_ratio = trust_coefficient * param_norm / (grad_norm + weight_decay * param_norm + eps)
+        grad = grad.add(param, alpha=weight_decay)
+        momentum_buffers[i].mul_(momentum).add_(grad.mul_(trust_ratio), alpha=lr)
+        param.sub_(momentum_buffers[i])
+
+@torch.no_grad()
+def lars_step(self, closure=None):
+    """Performs a single optimization step.
+    Args:
+        closure (callable, optional): A closure that reevaluates the model
+            and returns the loss.
+    """
+    loss = None
+    if closure is not None:
+        with torch.enable_grad():
+            loss = closure()
+
+    for group in self.param_groups:
+        for p in group['params']:
+            grad = get_bf16_grad(p, self.params_attr) if is_master_weight(p, self.params_attr) else p.grad
+            if grad is None:
+                continue
+            if grad.is_sparse:
+                raise RuntimeError('Lars does not support sparse gradients')
+            if grad.device != torch.device('cpu'):
+                raise RuntimeError('Lars supports only CPU device')
+
+            state = self.state[p]
+            # Lazy state initialization
+            if len(state) == 0:
+                buffer_dtype = p.dtype if p.dtype is torch.float64 else torch.float
+                state['momentum_buffer'] = torch.zeros(p.shape, dtype=buffer_dtype)
+
+            if p.dtype is torch.float64:
+                # the fused kernel computes in fp32
+                _lars_impl(
+                    [p],
+                    [grad],
+                    [state['momentum_buffer']],
+                    group['momentum'],
+                    group['lr'],
+                    group['weight_decay'],
+                    group['trust_coefficient'],
+                    group['eps'],
+                    group['adaptation'])
+                continue
+            torch.ops.torch_ipex.lars_fused_step(
+                p,
+                state['momentum_buffer'],
+                grad,
+                get_param2(p, self.params_attr),
+                group['momentum'],
+                group['lr'],
+                group['weight_decay'],
+                group['trust_coefficient'],
+                group['eps'],
+                group['adaptation'])
+    return loss
+
+def _adafactor_step_size(lr, step, relative_step, warmup_init):
+    # the relative step size rho, before the scaling by the RMS of the param
+    if not relative_step:
+        return lr
+    min_step = 1e-6 * step if warmup_init else 1e-2
+    return min(min_step, 1.0 / step ** 0.5)
+
+def _adafactor_init_state(state, p, beta1):
+    buffer_dtype = p.dtype if p.dtype is torch.float64 else torch.float
+    state['step'] = 0
+    # the empty states are the ones the param does not need
+    state['exp_avg'] = torch.zeros(p.shape, dtype=buffer_dtype) if beta1 is not None else torch.Tensor()
+    if p.dim() >= 2:
+        state['exp_avg_sq_row'] = torch.zeros(p.shape[:-1], dtype=buffer_dtype)
+        state['exp_avg_sq_col'] = torch.zeros(p.shape[:-2] + p.shape[-1:], dtype=buffer_dtype)
+        state['exp_avg_sq'] = torch.Tensor()
+    else:
+        state['exp_avg_sq_row'] = torch.Tensor()
+        state['exp_avg_sq_col'] = torch.Tensor()
+        state['exp_avg_sq'] = torch.zeros(p.shape, dtype=buffer_dtype)
+
+def _adafactor_impl(
+    params: List[Tensor],
+    grads: List[Tensor],
+    exp_avgs: List[Tensor],
+    exp_avg_sq_rows: List[Tensor],
+    exp_avg_sq_cols: List[Tensor],
+    exp_avg_sqs: List[Tensor],
+    state_steps: List[int],
+    lr: Optional[float],
+    beta1: Optional[float],
+    decay_rate: float,
+    eps1: float,
+    eps2: float,
+    clip_threshold: float,
+    weight_decay: float,
+    scale_parameter: bool,
+    relative_step: bool,
+    warmup_init: bool,
+):
+    r"""Functional API that performs Adafactor algorithm computation.
+    """
+    for i, param in enumerate(params):
+        step = state_steps[i]
+        alpha = _adafactor_step_size(lr, step, relative_step, warmup_init)
+        if scale_parameter:
+            alpha *= max(eps2, param.norm(p=2).item() / param.numel() ** 0.5)
+        beta2t = 1.0 - step ** decay_rate
+
+        grad = grads[i].to(param.dtype if param.dtype is torch.float64 else torch.float)
+        update = grad * grad + eps1
+        if exp_avg_sq_rows[i].numel() > 0:
+            exp_avg_sq_row = exp_avg_sq_rows[i]
+            exp_avg_sq_col = exp_avg_sq_cols[i]
+            exp_avg_sq_row.mul_(beta2t).add_(update.mean(dim=-1), alpha=1.0 - beta2t)
+            exp_avg_sq_col.mul_(beta2t).add_(update.mean(dim=-2), alpha=1.0 - beta2t)
+            row_factor = (exp_avg_sq_row / exp_avg_sq_row.mean(dim=-1, keepdim=True)).rsqrt_().unsqueeze(-1)
+            col_factor = exp_avg_sq_col.unsqueeze(-2).rsqrt()
+            update = grad * row_factor * col_factor
+        else:
+            exp_avg_sq = exp_avg_sqs[i]
+            exp_avg_sq.mul_(beta2t).add_(update, alpha=1.0 - beta2t)
+            update = exp_avg_sq.rsqrt().mul_(grad)
+
+        update.div_((update.norm(p=2) / update.numel() ** 0.5 / clip_threshold).clamp_(min=1.0))
+        update.mul_(alpha)
+        if exp_avgs[i].numel() > 0:
+            exp_avgs[i].mul_(beta1).add_(update, alpha=1 - beta1)
+            update = exp_avgs[i]
+
+        if weight_decay != 0:
+            param.mul_(1 - weight_decay * alpha)
+        param.sub_(update)
+
+@torch.no_grad()
+def adafactor_step(self, closure=None):
+    """Performs a single optimization step.
+    Args:
+        closure (callable, optional): A closure that reevaluates the model
+            and returns the loss.
+    """
+    loss = None
+    if closure is not None:
+        with torch.enable_grad():
+            loss = closure()
+
+    for group in self.param_groups:
+        eps1, eps2 = group['eps']
+        for p in group['params']:
+            grad = get_bf16_grad(p, self.params_attr) if is_master_weight(p, self.params_attr) else p.grad
+            if grad is None:
+                continue
+            if grad.is_sparse:
+                raise RuntimeError('Adafactor does not support sparse gradients')
+            if grad.device != torch.device('cpu'):
+                raise RuntimeError('Adafactor supports only CPU device')
+
+            state = self.state[p]
+            # Lazy state initialization
+            if len(state) == 0:
+                _adafactor_init_state(state, p, group['beta1'])
+            state['step'] += 1
+
+            if p.dtype is torch.float64:
+                # the fused kernel computes in fp32
+                _adafactor_impl(
+                    [p],
+                    [grad],
+                    [state['exp_avg']],
+                    [state['exp_avg_sq_row']],
+                    [state['exp_avg_sq_col']],
+                    [state['exp_avg_sq']],
+                    [state['step']],
+                    group['lr'],
+                    group['beta1'],
+                    group['decay_rate'],
+                    eps1,
+                    eps2,
+                    group['clip_threshold'],
+                    group['weight_decay'],
+                    group['scale_parameter'],
+                    group['relative_step'],
+                    group['warmup_init'])
+                continue
+            step = state['step']
+            torch.ops.torch_ipex.adafactor_fused_step(
+                p,
+                state['exp_avg'],
+                state['exp_avg_sq_row'],
+                state['exp_avg_sq_col'],
+                state['exp_avg_sq'],
+                grad,
+                get_param2(p, self.params_attr),
+                _adafactor_step_size(group['lr'], step, group['relative_step'], group['warmup_init']),
+                group['beta1'] if group['beta1'] is not None else 0.0,
+                1.0 - step ** group['decay_rate'],
+                eps1,
+                eps2,
+                group['clip_threshold'],
+                group['weight_decay'],
+                group['scale_parameter'])
+    return loss
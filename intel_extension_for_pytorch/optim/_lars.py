@@ -0,0 +1,97 @@
+import torch
+from ._functional import _lars_impl
+
+
+class Lars(torch.optim.Optimizer):
+    r"""Implements LARS algorithm.
+    It has been proposed in `Large Batch Training of Convolutional Networks`_.
+    The update of a param is scaled by its trust ratio
+    ``trust_coefficient * ||param|| / (||grad|| + weight_decay * ||param|| + eps)``
+    before the momentum.
+    Args:
+        params (iterable): iterable of parameters to optimize or dicts defining
+            parameter groups
+        lr (float, optional): learning rate (default: 0.1)
+        momentum (float, optional): momentum factor (default: 0.9)
+        weight_decay (float, optional): weight decay (L2 penalty) (default: 0)
+        trust_coefficient (float, optional): the trust coefficient eta of the
+            trust ratio (default: 0.001)
+        eps (float, optional): term added to the denominator of the trust
+            ratio to improve numerical stability (default: 1e-8)
+        adaptation (boolean, optional): whether to scale the update by the
+            trust ratio, SGD with momentum if not, e.g. for the biases and the
+            norm layers (default: True)
+        fused (boolean, optional): whether to use fused kernel to accelerate
+            (default: False)
+    .. _Large Batch Training of Convolutional Networks:
+        https://arxiv.org/abs/1708.03888
+    """
+
+    def __init__(self, params, lr=0.1, momentum=0.9, weight_decay=0,
+                 trust_coefficient=0.001, eps=1e-8, adaptation=True, fused=False):
+        if not 0.0 <= lr:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if not 0.0 <= momentum:
+            raise ValueError("Invalid momentum value: {}".format(momentum))
+        if not 0.0 <= weight_decay:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        if not 0.0 <= trust_coefficient:
+            raise ValueError("Invalid trust_coefficient value: {}".format(trust_coefficient))
+        if not 0.0 <= eps:
+            raise ValueError("Invalid epsilon value: {}".format(eps))
+        defaults = dict(lr=lr, momentum=momentum, weight_decay=weight_decay,
+                        trust_coefficient=trust_coefficient, eps=eps,
+                        adaptation=adaptation, fused=fused)
+        super(Lars, self).__init__(params, defaults)
+        self.params_attr = {}
+        self.fused = fused
+
+    def __setstate__(self, state):
+        super(Lars, self).__setstate__(state)
+
+    @torch.no_grad()
+    def step(self, closure=None):
+        """Performs a single optimization step.
+        Args:
+            closure (callable, optional): A closure that reevaluates the model
+                and returns the loss.
+        """
+        loss = None
+        if closure is not None:
+            with torch.enable_grad():
+                loss = closure()
+
+        for group in self.param_groups:
+            params_with_grad = []
+            grads = []
+            momentum_buffers = []
+
+            for p in group['params']:
+                grad = p.grad
+                if grad is not None:
+                    params_with_grad.append(p)
+                    if grad.is_sparse:
+                        raise RuntimeError('Lars does not support sparse gradients')
+                    if grad.device != torch.device('cpu'):
+                        raise RuntimeError('Lars supports only CPU device')
+                    grads.append(grad)
+
+                    state = self.state[p]
+                    # Lazy state initialization
+                    if len(state) == 0:
+                        buffer_dtype = p.dtype if p.dtype is torch.float64 else torch.float
+                        state['momentum_buffer'] = torch.zeros(p.shape, dtype=buffer_dtype)
+
+                    momentum_buffers.append(state['momentum_buffer'])
+
+            _lars_impl(
+                params_with_grad,
+                grads,
+                momentum_buffers,
+                group['momentum'],
+                group['lr'],
+                group['weight_decay'],
+                group['trust_coefficient'],
+                group['eps'],
+                group['adaptation'])
+        return loss
@@ -4,9 +4,12 @@ import types
 import warnings
 from copy import deepcopy
 from itertools import chain
-from collections import defaultdict
-from ._functional import sgd_step, adagrad_step, lamb_step, adam_step, adamw_step
+from collections import defaultdict, deque
+from ._functional import sgd_step, adagrad_step, lamb_step, adam_step, adamw_step, adam_8bit_step, \
+    lars_step, adafactor_step
 from ._lamb import Lamb
+from ._lars import Lars
+from ._adafactor import Adafactor
 from ..nn import utils
 
 IPEX_FUSED_OPTIMIZER_LIST_CPU = [
@@ -14,6 +17,8 @@ IPEX_FUSED_OPTIMIZER_LIST_CPU = [
     torch.optim.Adagrad,
     torch.optim.Adam,
     Lamb,
+    Lars,
+    Adafactor,
 ]
 
 IPEX_FUSED_OPTIMIZER_LIST_XPU = [
@@ -26,6 +31,8 @@ OPTIMIZER_FUSED_STEP_MAPPING_CPU = {
     torch.optim.Adagrad: adagrad_step,
     torch.optim.Adam: adam_step,
     Lamb: lamb_step,
+    Lars: lars_step,
+    Adafactor: adafactor_step,
 }
 
 # TODO: For align frontend and pass build, the xpu code is temp commented
@@ -329,21 +336,277 @@ def patch_state_dict(optimizer):
         setattr(optimizer, '_original_state_dict', optimizer.state_dict)
         setattr(optimizer, 'state_dict', types.MethodType(get_optimizer_unpacked_state_dict, optimizer))
 
-def optimizer_fusion(optimizer, master_weight_split, is_xpu=False):
+def optimizer_fusion(optimizer, master_weight_split, is_xpu=False, state_8bit=False, overlap_cpu_pool=None):
     r"""
-    Patch "step" method to choose IPEX optimized fused update kernel.
+    Patch "step" method to choose IPEX optimized fused update kernel. With
+    state_8bit, Adam and AdamW store their moments in 8 bits. With an
+    overlap_cpu_pool, the fused steps overlap with backward, see
+    overlap_step_with_backward.
     """
     setattr(optimizer, 'fused', True)
     if not hasattr(optimizer, 'params_attr'):
         setattr(optimizer, 'params_attr', {})
     try:
-        if not is_xpu:
+        if state_8bit:
+            assert type(optimizer) in [torch.optim.Adam, torch.optim.AdamW]
+            step = adam_8bit_step
+        elif not is_xpu:
             step = OPTIMIZER_FUSED_STEP_MAPPING_CPU[type(optimizer)]
         else:
             step = OPTIMIZER_FUSED_STEP_MAPPING_XPU[type(optimizer)]
         if not hasattr(optimizer, '_original_step'):
             setattr(optimizer, '_original_step', optimizer.step)
         setattr(optimizer, 'step', types.MethodType(step, optimizer))
+        fp16_master_weight = any('fp16_param' in attr for attr in optimizer.params_attr.values())
+        if not is_xpu and not fp16_master_weight and overlap_cpu_pool is None and \
+                step in [sgd_step, adam_step, lamb_step]:
+            # stepped by a GradScaler, the step checks the scaled grads for infs/NaNs and unscales them itself
+            setattr(optimizer, '_step_supports_amp_scaling', True)
+        if overlap_cpu_pool is not None:
+            assert not is_xpu, "overlapping the step with backward is only supported on CPU"
+            overlap_step_with_backward(optimizer, step, overlap_cpu_pool)
     except KeyError:
         warnings.warn("Does not suport fused step for " + str(type(optimizer)) + ", will use non-fused step")
     return optimizer
+
+class _SingleParamOptimizer(object):
+    r"""
+    The view of an optimizer the fused steps take to update a single param of
+    a param group, sharing the states of the optimizer.
+    """
+    def __init__(self, optimizer, group, param):
+        self.param_groups = [dict(group, params=[param])]
+        self.state = optimizer.state
+        self.params_attr = optimizer.params_attr
+        self.fused = optimizer.fused
+
+class _OverlapStep(object):
+    r"""
+    The callable run by the CPUPool task of the overlapped steps. The task
+    executor runs its calls one at a time in submission order, so a call steps
+    the param of the oldest pending submission, and frees its grad.
+    """
+    def __init__(self, optimizer, step):
+        self.optimizer = optimizer
+        self.step = step
+        self.pending = deque()
+
+    def submit(self, group, param, grad_holder):
+        self.pending.append((group, param, grad_holder))
+        return self.optimizer._overlap_task()
+
+    def __call__(self):
+        group, param, grad_holder = self.pending.popleft()
+        self.step(_SingleParamOptimizer(self.optimizer, group, param))
+        grad_holder.grad = None
+
+def overlap_step_with_backward(optimizer, step, cpu_pool):
+    r"""
+    Run the fused step of each param on the cores of cpu_pool as soon as its
+    grad is accumulated by backward, through post accumulate grad hooks, and
+    free the grad right after, instead of stepping all the params after
+    backward. This hides most of the optimizer time behind the backward of the
+    earlier layers and the grads are not all held at the same time.
+
+    Patch "step" to wait for the steps submitted during backward, so that
+    "optimizer.step()" stays the synchronization point of the training loop.
+    The params are thus updated once per backward: grad accumulation over
+    several backwards and grad clipping or unscaling before the step are
+    unsupported.
+    """
+    from ..cpu.runtime import Task
+    overlap = _OverlapStep(optimizer, step)
+    setattr(optimizer, '_overlap_task', Task(overlap, cpu_pool))
+    setattr(optimizer, '_overlap_futures', [])
+    handles = []
+    for group in optimizer.param_groups:
+        for p in group['params']:
+            if not p.requires_grad:
+                continue
+            # the grads of master weights are on the low precision params
+            attr = optimizer.params_attr.get(p, {})
+            grad_holder = attr.get('bf16_param', attr.get('fp16_param', p))
+            def hook(grad_holder, group=group, p=p):
+                optimizer._overlap_futures.append(overlap.submit(group, p, grad_holder))
+            handles.append(grad_holder.register_post_accumulate_grad_hook(hook))
+    setattr(optimizer, '_overlap_hook_handles', handles)
+
+    def overlapped_step(self, closure=None):
+        loss = None
+        if closure is not None:
+            with torch.enable_grad():
+                loss = closure()
+        futures, self._overlap_futures = self._overlap_futures, []
+        for f in futures:
+            f.get()
+        return loss
+
+    setattr(optimizer, 'step', types.MethodType(overlapped_step, optimizer))
+
+# Byte alignment of the tensors in a param arena, the CPU allocator returns
+# 64B aligned buffers, so a 64B aligned offset is a 64B aligned address.
+ARENA_ALIGNMENT = 64
+
+# The optimizers whose fused foreach steps stream through the arenas
+ARENA_FOREACH_OPTIMIZER_LIST = [
+    torch.optim.SGD,
+    torch.optim.Adagrad,
+    torch.optim.Adam,
+]
+
+def _arena_offsets(tensors):
+    r"""
+    The offsets of the tensors in their arena, and the size of the arena.
+    """
+    align = max(ARENA_ALIGNMENT // tensors[0].element_size(), 1)
+    offsets, size = [], 0
+    for t in tensors:
+        size = (size + align - 1) // align * align
+        offsets.append(size)
+        size += t.numel()
+    return offsets, size
+
+def _move_to_arena(tensors, size=None):
+    r"""
+    Copy the tensors of the same dtype and device into one contiguous buffer,
+    each of them starting at an ARENA_ALIGNMENT bytes offset, and make them views
+    of the buffer. The padding is zero, so the fused steps keep it zero and can
+    run over the whole buffer. The buffer can be padded to size. Return the
+    buffer.
+    """
+    offsets, min_size = _arena_offsets(tensors)
+    size = min_size if size is None else size
+    assert size >= min_size
+    arena = torch.zeros(size, dtype=tensors[0].dtype, device=tensors[0].device)
+    for t, offset in zip(tensors, offsets):
+        view = arena[offset:offset + t.numel()].view(t.shape)
+        view.copy_(t.data)
+        t.data = view
+    return arena
+
+def _group_by_dtype(tensors):
+    groups = defaultdict(list)
+    for t in tensors:
+        groups[(t.dtype, t.device)].append(t)
+    return groups.values()
+
+class _ParamArena(object):
+    r"""
+    Contiguous buffers holding the parameters, the gradients and the optimizer
+    states of an optimizer, one buffer per kind and dtype. The tensors keep
+    their identity and become views into the buffers, so that the optimizer
+    steps stream through consecutive memory and the gradients can be allreduced
+    as a few buffers instead of one call or bucketing copy per parameter.
+
+    The prepacked weights are owned by their op contexts and stay out of the
+    arenas, as do the sparse and non contiguous parameters. The states are moved
+    after the first step, which creates them.
+    """
+    def __init__(self, optimizer):
+        params_attr = getattr(optimizer, 'params_attr', {})
+        self.params = []
+        self.grad_holders = []
+        self.grads = []
+        seen = set()
+        for group in optimizer.param_groups:
+            for p in group['params']:
+                attr = params_attr.get(p, {})
+                if id(p) in seen or 'op' in attr or 'ctx' in attr or \
+                        p.is_sparse or not p.is_contiguous():
+                    continue
+                seen.add(id(p))
+                self.params.append(p)
+                # the grads of master weights are on the low precision params
+                self.grad_holders.append(
+                    attr.get('bf16_param', attr.get('fp16_param', p)))
+
+        self.buffers = defaultdict(list)
+        if not self.params:
+            self.states_moved = True
+            return
+        low_precision = [h for p, h in zip(self.params, self.grad_holders) if h is not p]
+        trails = [params_attr[p]['trail'] for p in self.params if 'trail' in params_attr.get(p, {})]
+        for kind, tensors in (('param', self.params), ('low_precision', low_precision), ('trail', trails)):
+            for same_dtype in _group_by_dtype(tensors):
+                self.buffers[kind].append(_move_to_arena(same_dtype))
+
+        self.grads = []
+        for h in self.grad_holders:
+            if h.grad is None or h.grad.is_sparse:
+                h.grad = torch.zeros_like(h)
+            self.grads.append(h.grad)
+        for same_dtype in _group_by_dtype(self.grads):
+            self.buffers['grad'].append(_move_to_arena(same_dtype))
+        self.states_moved = False
+
+    def move_states(self, optimizer):
+        r"""
+        Move the states of the arena params into their own buffers, once every
+        param has its states.
+        """
+        if self.states_moved:
+            return
+        states = defaultdict(list)
+        for p in self.params:
+            if p not in optimizer.state:
+                return
+            for key, value in optimizer.state[p].items():
+                if key != 'step' and isinstance(value, torch.Tensor) and \
+                        value.shape == p.shape and not value.is_sparse:
+                    states[key].append(value.contiguous())
+        for key, tensors in states.items():
+            if len(tensors) != len(self.params):
+                continue
+            for p, t in zip(self.params, tensors):
+                optimizer.state[p][key] = t
+            for same_dtype in _group_by_dtype(tensors):
+                self.buffers['state.' + key].append(_move_to_arena(same_dtype))
+        self.states_moved = True
+
+    def zero_grad(self):
+        for buf in self.buffers['grad']:
+            buf.zero_()
+
+    def all_reduce_grads(self, group=None):
+        r"""
+        Average the gradients of the arena params over the processes of the
+        group, one allreduce per gradient buffer. It replaces DDP's bucketed
+        allreduce for these params.
+        """
+        world_size = torch.distributed.get_world_size(group)
+        for buf in self.buffers['grad']:
+            torch.distributed.all_reduce(buf, group=group)
+            buf.div_(world_size)
+
+def param_arena(optimizer):
+    r"""
+    Allocate the parameters, gradients and states of the optimizer in
+    contiguous arenas (see _ParamArena), available as
+    ``optimizer.param_arena``. Patch "zero_grad" to zero the arena gradients in
+    place, the set_to_none gradients of the arena params would leave the arena,
+    and "step" to move the states into the arenas after the first step.
+    """
+    arena = _ParamArena(optimizer)
+    setattr(optimizer, 'param_arena', arena)
+    if type(optimizer) in ARENA_FOREACH_OPTIMIZER_LIST:
+        for group in optimizer.param_groups:
+            group['foreach'] = True
+
+    zero_grad = optimizer.zero_grad
+    def arena_zero_grad(self, set_to_none: bool = False):
+        for h in arena.grad_holders:
+            h.grad = None
+        zero_grad(set_to_none)
+        arena.zero_grad()
+        for h, grad in zip(arena.grad_holders, arena.grads):
+            h.grad = grad
+
+    step = optimizer.step
+    def arena_step(self, closure=None):
+        loss = step(closure)
+        arena.move_states(self)
+        return loss
+
+    setattr(optimizer, 'zero_grad', types.MethodType(arena_zero_grad, optimizer))
+    setattr(optimizer, 'step', types.MethodType(arena_step, optimizer))
+    return optimizer
@@ -0,0 +1,179 @@
+import torch
+import torch.distributed as dist
+from typing import Optional
+from ._optimizer_utils import optimizer_fusion, _SingleParamOptimizer, _arena_offsets, _move_to_arena, \
+    _group_by_dtype, OPTIMIZER_FUSED_STEP_MAPPING_CPU
+
+# The optimizers whose fused steps are element-wise, so that a flat range of
+# the params can be stepped apart from the rest. Lamb normalizes per param.
+SHARDED_OPTIMIZER_LIST = [
+    torch.optim.SGD,
+    torch.optim.Adagrad,
+    torch.optim.Adam,
+]
+
+def _reduce_scatter(output, input, group, async_op=False):
+    if dist.get_world_size(group) == 1:
+        # keep the single rank case usable with backends without reduce_scatter (e.g. gloo)
+        output.copy_(input)
+        return None
+    return dist.reduce_scatter_tensor(output, input, group=group, async_op=async_op)
+
+def _all_gather(output, input, group, async_op=False):
+    if dist.get_world_size(group) == 1:
+        output.copy_(input)
+        return None
+    return dist.all_gather_into_tensor(output, input, group=group, async_op=async_op)
+
+class _ShardedBucket(object):
+    r"""
+    A range of the flat params and grads of a param group, of a multiple of the
+    world size elements. A rank owns the fp32 master weights and the states of
+    the world_size-th part of the range at its rank, its shard.
+    """
+    def __init__(self, params, grads, rank, world_size):
+        self.params = params
+        self.grads = grads
+        shard_size = params.numel() // world_size
+        shard = slice(rank * shard_size, (rank + 1) * shard_size)
+        self.master = params[shard].float().clone()
+        if params.dtype == torch.float:
+            # the master shard is gathered as is
+            self.low_precision = None
+            self.master.grad = torch.zeros_like(self.master)
+        else:
+            # the fused steps write the low precision copy of the master shard,
+            # which is gathered, and take its grad
+            self.low_precision = params[shard].clone()
+            self.low_precision.grad = torch.zeros_like(self.low_precision)
+
+    def grad_shard(self):
+        return self.master.grad if self.low_precision is None else self.low_precision.grad
+
+    def param_shard(self):
+        return self.master if self.low_precision is None else self.low_precision
+
+class ShardedOptimizer(object):
+    r"""
+    Shard the fp32 master weights and the states of an optimizer over the ranks
+    of a process group, like ZeRO stage 1 and 2, so that the memory of the
+    states drops by the world size.
+
+    The params of each param group are moved into flat buffers, cut in buckets
+    of about ``bucket_size`` elements. A rank keeps the fp32 master weights and
+    the states of its shard of every bucket only. ``step`` reduce-scatters the
+    grads of the buckets, runs the fused step kernels on the local shards as
+    soon as their grads arrive, and all-gathers the updated params of the
+    model dtype (e.g. bf16) into the flat buffers, the collectives of the next
+    buckets running while a bucket is updated. Use oneCCL, the ``ccl`` backend
+    of ``oneccl_bindings_for_pytorch``, for multi-node CPU training.
+
+    The wrapped optimizer must be one of ``torch.optim.SGD``,
+    ``torch.optim.Adagrad`` and ``torch.optim.Adam`` over contiguous dense
+    params, so it replaces the optimizer of ``ipex.optimize`` and needs
+    ``weights_prepack=False``. The model is expected to be in its training
+    dtype, bf16 params being trained with fp32 master weight shards. The grads
+    are views into the flat grad buffers, which ``zero_grad`` zeroes in place.
+    ``self.optimizer``, the optimizer of the local master shards, takes the LR
+    schedulers and ``state_dict`` saves the states of the local shards only.
+
+    Args:
+        optimizer (torch.optim.Optimizer): The optimizer of the model params.
+        process_group (torch.distributed.ProcessGroup): The ranks to shard
+            over, the default group if ``None``.
+        bucket_size (int): The number of elements of the buckets.
+    """
+    def __init__(
+        self,
+        optimizer: torch.optim.Optimizer,
+        process_group: Optional[dist.ProcessGroup] = None,
+        bucket_size: int = 1 << 22
+    ):
+        assert dist.is_initialized(), "ShardedOptimizer needs torch.distributed to be initialized"
+        assert type(optimizer) in SHARDED_OPTIMIZER_LIST, \
+            "ShardedOptimizer does not support " + str(type(optimizer))
+        self.process_group = process_group
+        self.rank = dist.get_rank(process_group)
+        self.world_size = dist.get_world_size(process_group)
+        self.buckets = []
+        self.grad_buffers = []
+        master_groups = []
+        for group in optimizer.param_groups:
+            params = [p for p in group['params'] if p.requires_grad]
+            for p in params:
+                assert p.device.type == 'cpu' and p.is_contiguous() and not p.is_sparse, \
+                    "ShardedOptimizer only supports contiguous dense CPU params"
+            buckets = []
+            for same_dtype in _group_by_dtype(params):
+                buckets += self._make_buckets(same_dtype, bucket_size)
+            self.buckets += buckets
+            master_group = {k: v for k, v in group.items() if k != 'params'}
+            master_group['params'] = [b.master for b in buckets]
+            master_groups.append((master_group, buckets))
+
+        self.optimizer = type(optimizer)([g for g, _ in master_groups], **optimizer.defaults)
+        optimizer_fusion(self.optimizer, False)
+        for b in self.buckets:
+            if b.low_precision is not None:
+                self.optimizer.params_attr[b.master] = {'bf16_param': b.low_precision}
+        self.fused_step = OPTIMIZER_FUSED_STEP_MAPPING_CPU[type(optimizer)]
+        self.bucket_groups = [(g, b) for (_, buckets), g in zip(master_groups, self.optimizer.param_groups)
+            for b in buckets]
+
+    def _make_buckets(self, params, bucket_size):
+        _, size = _arena_offsets(params)
+        world_size = self.world_size
+        # buckets of a multiple of the world size elements, at least 64B each
+        # on every rank
+        bucket_size = min(bucket_size, size)
+        align = max(64 // params[0].element_size(), 1) * world_size
+        bucket_size = (bucket_size + align - 1) // align * align
+        num_buckets = (size + bucket_size - 1) // bucket_size
+        flat_params = _move_to_arena(params, num_buckets * bucket_size)
+        flat_grads = torch.zeros_like(flat_params)
+        self.grad_buffers.append(flat_grads)
+        offsets, _ = _arena_offsets(params)
+        for p, offset in zip(params, offsets):
+            p.grad = flat_grads[offset:offset + p.numel()].view(p.shape)
+        return [
+            _ShardedBucket(
+                flat_params[i * bucket_size:(i + 1) * bucket_size],
+                flat_grads[i * bucket_size:(i + 1) * bucket_size],
+                self.rank, world_size)
+            for i in range(num_buckets)
+        ]
+
+    @property
+    def param_groups(self):
+        return self.optimizer.param_groups
+
+    def zero_grad(self, set_to_none: bool = False):
+        # the grads stay in the flat buffers
+        for buf in self.grad_buffers:
+            buf.zero_()
+
+    @torch.no_grad()
+    def step(self, closure=None):
+        loss = None
+        if closure is not None:
+            with torch.enable_grad():
+                loss = closure()
+        group = self.process_group
+        reduces = [_reduce_scatter(b.grad_shard(), b.grads, group, async_op=True) for b in self.buckets]
+        gathers = []
+        for (param_group, b), work in zip(self.bucket_groups, reduces):
+            if work is not None:
+                work.wait()
+            b.grad_shard().div_(self.world_size)
+            self.fused_step(_SingleParamOptimizer(self.optimizer, param_group, b.master))
+            gathers.append(_all_gather(b.params, b.param_shard(), group, async_op=True))
+        for work in gathers:
+            if work is not None:
+                work.wait()
+        return loss
+
+    def state_dict(self):
+        return self.optimizer.state_dict()
+
+    def load_state_dict(self, state_dict):
+        self.optimizer.load_state_dict(state_dict)
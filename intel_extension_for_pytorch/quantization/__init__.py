@@ -7,3 +7,5 @@ from ._qconfig import (
     get_smooth_quant_qconfig_mapping,
 )
 from ._autotune import autotune
+from ._deploy import save, load
+from ._weight_only_quantization import weight_only_quantize
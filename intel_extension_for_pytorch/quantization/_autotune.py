@@ -1,64 +1,296 @@
-import sys
-import subprocess
+import os
 import copy
+import json
 import time
-from . import default_static_qconfig, prepare
+import tempfile
+import warnings
+import multiprocessing
+import torch
+from torch.ao.quantization import HistogramObserver, PlaceholderObserver
+import intel_extension_for_pytorch._C as core
+from ..cpu.runtime import CPUPool, pin, is_runtime_ext_enabled
+from ..cpu.runtime.runtime_utils import get_num_nodes
+from ._quantize import convert
+from ._quantize_utils import copy_prepared_model
+from ._utils import attach_scale_zp_values_to_model
+from ._recipe import latency_profiled_ops, profile_int8_bf16_latency
 
 
-def autotune(prepared_model, calib_dataloader, eval_func, sampling_sizes=[100], accuracy_criterion={'relative': 0.01}, tuning_time=0):
+_quantized_dtypes = [str(torch.quint8), str(torch.qint8)]
+
+def _get_example_inputs(calib_dataloader):
+    # the dataloader yields either inputs or (inputs, labels)
+    for batch in calib_dataloader:
+        if isinstance(batch, (tuple, list)) and len(batch) == 2:
+            batch = batch[0]
+        if isinstance(batch, (torch.Tensor, dict)):
+            return (batch,)
+        return tuple(batch)
+    assert False, "The calib_dataloader of autotune should not be empty"
+
+def _calibrate(model, calib_dataloader, sampling_size):
+    batch_size = getattr(calib_dataloader, 'batch_size', None) or 1
+    num_samples = 0
+    with torch.no_grad():
+        for batch in calib_dataloader:
+            if isinstance(batch, (tuple, list)) and len(batch) == 2:
+                batch = batch[0]
+            if isinstance(batch, (torch.Tensor, dict)):
+                batch = (batch,)
+            model(*batch)
+            num_samples += batch_size
+            if num_samples >= sampling_size:
+                break
+
+def _collect_minmax_qparams(model):
+    r"""
+    Computes the min/max qparams of the histogram observers of the activations,
+    from the statistics of the calibration already done.
+    """
+    qparams = {}
+    for k, qstate in model._fqn_to_auto_quant_state_map.items():
+        layer_qparams = {}
+        for tensor_id, observer in qstate.tensor_id_to_observer.items():
+            if isinstance(observer, HistogramObserver) and observer.min_val.numel() > 0:
+                scale, zp = observer._calculate_qparams(observer.min_val, observer.max_val)
+                layer_qparams[int(tensor_id)] = (scale.tolist(), zp.tolist())
+        qparams[k] = layer_qparams
+    return qparams
+
+def _get_quantized_ops(qconf):
+    ops = []
+    for k, layer_info in qconf.items():
+        for i, q_op_info in layer_info["q_op_infos"].items():
+            if any(len(t) > 0 and t["inf_dtype"] in _quantized_dtypes for t in q_op_info["input_tensor_infos"]):
+                ops.append((k, i))
+    return ops
+
+def _make_candidate(qconf, minmax_qparams, fallback_ops):
+    r"""
+    Returns the qconf_summary of a candidate from the one of the calibration: the activations use
+    the min/max qparams if minmax_qparams is given, and the ops of fallback_ops run in FP32.
+    """
+    qconf = copy.deepcopy(qconf)
+
+    def _set_qparams(tensor_info, layer_qparams):
+        if len(tensor_info) > 0 and "scale" in tensor_info and tensor_info["id"] in layer_qparams:
+            tensor_info["scale"], tensor_info["zero_point"] = layer_qparams[tensor_info["id"]]
+
+    if minmax_qparams is not None:
+        for k, layer_info in qconf.items():
+            for q_op_info in layer_info["q_op_infos"].values():
+                for tensor_info in q_op_info["input_tensor_infos"] + q_op_info["output_tensor_infos"]:
+                    _set_qparams(tensor_info, minmax_qparams[k])
+            for tensor_info in layer_info["layer_output_infos"]:
+                _set_qparams(tensor_info, minmax_qparams[k])
+    for k, i in fallback_ops:
+        q_op_info = qconf[k]["q_op_infos"][i]
+        for tensor_info in q_op_info["input_tensor_infos"]:
+            if len(tensor_info) > 0 and tensor_info["inf_dtype"] in _quantized_dtypes:
+                tensor_info["inf_dtype"] = tensor_info["orig_dtype"]
+                tensor_info["force_dtype"] = tensor_info["orig_dtype"]
+        for tensor_info in q_op_info["weight_tensor_infos"]:
+            if len(tensor_info) > 0:
+                tensor_info["inf_dtype"] = tensor_info["orig_dtype"]
+    return qconf
+
+def _get_latency_fallback_ops(prepared_model, qconf, quantized_ops, example_inputs):
+    r"""
+    Returns the quantized modules which run faster in BF16 than in INT8 on the current host, profiled
+    with the inputs they get from the example inputs.
+    """
+    model = copy_prepared_model(prepared_model)
+    modules = dict(model.named_modules())
+    module_inputs = {}
+    hooks = []
+    for op in quantized_ops:
+        q_op_info = qconf[op[0]]["q_op_infos"][op[1]]
+        if q_op_info["op_type_is_module"] and q_op_info["op_type"] in latency_profiled_ops and \
+                q_op_info["fqn"] in modules:
+            def _record_inputs(module, inputs, op=op):
+                module_inputs.setdefault(op, (module, tuple(inputs)))
+            hooks.append(modules[q_op_info["fqn"]].register_forward_pre_hook(_record_inputs))
+    with torch.no_grad():
+        model(*example_inputs)
+    for hook in hooks:
+        hook.remove()
+    fallback_ops = []
+    for op, (module, inputs) in module_inputs.items():
+        int8_latency, bf16_latency = profile_int8_bf16_latency(module, inputs, prepared_model.q_config)
+        if bf16_latency < int8_latency:
+            fallback_ops.append(op)
+    return fallback_ops
+
+def _run_trial(model, qconf_summary, bf16, example_inputs, eval_func):
+    trial_model = copy_prepared_model(model)
+    trial_model.load_qconf_summary(qconf_summary=qconf_summary)
+    # the ops falling back run in BF16 for a mixed INT8/BF16 recipe
+    with torch.cpu.amp.autocast(enabled=bf16), torch.no_grad():
+        converted_model = convert(trial_model)
+        traced_model = torch.jit.trace(converted_model, example_inputs, check_trace=False)
+        traced_model = torch.jit.freeze(traced_model)
+        return eval_func(traced_model)
+
+def _trial_worker(core_ids, results, idx, model, trial, example_inputs, eval_func):
+    try:
+        cpu_pool = CPUPool(core_ids)
+        torch.set_num_threads(len(cpu_pool.core_ids))
+        if is_runtime_ext_enabled():
+            with pin(cpu_pool):
+                accuracy = _run_trial(model, *trial, example_inputs, eval_func)
+        else:
+            os.sched_setaffinity(0, cpu_pool.core_ids)
+            accuracy = _run_trial(model, *trial, example_inputs, eval_func)
+        results.put((idx, float(accuracy), None))
+    except Exception as e:
+        results.put((idx, None, repr(e)))
+
+def _evaluate(model, trials, example_inputs, eval_func, core_partitions):
+    r"""
+    Evaluates the trials of (qconf_summary, bf16), each one in a process forked from the calibrated model
+    and pinned to one of the core partitions.
+    """
+    if len(core_partitions) == 1:
+        return [float(_run_trial(model, *trial, example_inputs, eval_func)) for trial in trials]
+    context = multiprocessing.get_context('fork')
+    results = context.Queue()
+    accuracies = [None] * len(trials)
+    for begin in range(0, len(trials), len(core_partitions)):
+        workers = []
+        for idx, core_ids in zip(range(begin, len(trials)), core_partitions):
+            worker = context.Process(target=_trial_worker,
+                                     args=(core_ids, results, idx, model, trials[idx], example_inputs, eval_func))
+            worker.start()
+            workers.append(worker)
+        for _ in workers:
+            idx, accuracy, error = results.get()
+            assert error is None, "The evaluation of a tuning candidate failed: " + error
+            accuracies[idx] = accuracy
+        for worker in workers:
+            worker.join()
+    return accuracies
+
+def autotune(prepared_model, calib_dataloader, eval_func, sampling_sizes=[100], accuracy_criterion={'relative': 0.01},
+             tuning_time=0, num_workers=None, mixed_bf16=False):
     r"""
     Automatic accuracy-driven tuning helps users quickly find out the advanced recipe for INT8 inference.
 
+    The calibration runs once, the statistics of its observers are cached and the qparams of the candidate
+    recipes are computed from them offline: the histogram or the min/max qparams of the activations, and the
+    quantized ops falling back to FP32 one by one, then the most sensitive ones together. The candidates are
+    evaluated in parallel, each one in a process pinned to a CPUPool partition of the cores of the host.
+
+    With ``mixed_bf16``, the recipe runs the ops falling back in BF16, and the quantizable modules are profiled
+    on the host first: the ones faster in BF16 than in INT8, once the quantization of their inputs and the
+    dequantization of their outputs are counted, fall back in all the candidates.
+
     Args:
         prepared_model (torch.nn.Module): the FP32 prepared model returned from ipex.quantization.prepare.
         calib_dataloader (generator): set a dataloader for calibration.
         eval_func (function): set a evaluation function. This function takes "model" as input parameter
             executes entire evaluation process with self contained metrics,
             and returns an accuracy value which is a scalar number. The higher the better.
-        sampling_sizes (list): a list of sample sizes used in calibration, where the tuning algorithm would explore from.
-            The default value is ``[100]``.
+        sampling_sizes (list): a list of sample sizes used in calibration, the calibration runs once with the
+            largest one. The default value is ``[100]``.
         accuracy_criterion ({accuracy_criterion_type(str, 'relative' or 'absolute') : accuracy_criterion_value(float)}):
             set the maximum allowed accuracy loss, either relative or absolute. The default value is ``{'relative': 0.01}``.
         tuning_time (seconds): tuning timeout. The default value is ``0`` which means early stop.
+        num_workers (int): the number of candidates evaluated in parallel, the cores available for the current
+            process being split evenly between them. The default value is ``None``, which uses one worker per socket.
+        mixed_bf16 (bool): select INT8 or BF16 for each quantizable module from its latency on the host, the
+            ops falling back running in BF16 under autocast. The default value is ``False``.
 
     Returns:
-        FP32 tuned model (torch.nn.Module)
+        FP32 tuned model (torch.nn.Module), to be converted under ``torch.cpu.amp.autocast()`` with ``mixed_bf16``.
     """
-    try:
-        import neural_compressor
-    except ImportError:
-        try:
-            subprocess.check_call([sys.executable, '-m', 'pip', 'install', 'neural_compressor==1.14.1'])
-            import neural_compressor
-        except:
-            assert False, "Unable to import neural_compressor from the local environment."
-    from neural_compressor import config
-    from neural_compressor.experimental import Quantization, common
-    from neural_compressor.adaptor.torch_utils.util import auto_copy
-    from neural_compressor.adaptor.pytorch import get_example_inputs
-
-    config.quantization.backend = 'pytorch_ipex'
-    config.quantization.approach = 'post_training_static_quant'
-    config.quantization.device = 'cpu'
-    config.quantization.use_bf16 = False
-    config.quantization.calibration_sampling_size = sampling_sizes
-    if accuracy_criterion.get('relative'):
-        config.quantization.accuracy_criterion.relative = accuracy_criterion.get('relative')
-    if accuracy_criterion.get('absolute'):
-        config.quantization.accuracy_criterion.absolute = accuracy_criterion.get('absolute')
-    config.quantization.timeout = tuning_time
-    quantizer = Quantization(config)
-    fp32_model = auto_copy(prepared_model)
-    quantizer.model = common.Model(fp32_model)
-    quantizer.calib_dataloader = calib_dataloader
-    quantizer.eval_func = eval_func
-    q_model = quantizer.fit()
-    dirname_str = './saved_tuning_results_'+time.strftime("%Y%m%d_%H%M%S")
-    q_model.save(dirname_str)
-
-    # This is a workaround for the bug that the auto_copy function will change its input prepared_model.
-    qconfig = default_static_qconfig
-    new_prepared_model = prepare(fp32_model, qconfig, example_inputs=get_example_inputs(calib_dataloader), inplace=True)
-    new_prepared_model.load_qconf_summary(qconf_summary=dirname_str+'/best_configure.json')
+    assert hasattr(prepared_model, '_fqn_to_auto_quant_state_map') and \
+        not isinstance(prepared_model.q_config.activation(), PlaceholderObserver), \
+        "autotune only supports the static quantization of a model prepared by ipex.quantization.prepare"
+    start_time = time.time()
+    if num_workers is None:
+        num_workers = get_num_nodes()
+    core_ids = core.get_process_available_cores()
+    num_workers = max(1, min(num_workers, len(core_ids)))
+    cores_per_worker = len(core_ids) // num_workers
+    core_partitions = [core_ids[i * cores_per_worker:(i + 1) * cores_per_worker] for i in range(num_workers)]
+
+    # calibrate once, the qparams of the candidates all come from these statistics
+    model = copy_prepared_model(prepared_model)
+    _calibrate(model, calib_dataloader, max(sampling_sizes))
+    minmax_qparams = _collect_minmax_qparams(model)
+    attach_scale_zp_values_to_model(model)
+    example_inputs = _get_example_inputs(calib_dataloader)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        calib_qconf_summary = os.path.join(tmpdir, 'calib_configure.json')
+        model.save_qconf_summary(qconf_summary=calib_qconf_summary)
+        with open(calib_qconf_summary, 'r') as f:
+            calib_qconf = json.load(f)
+        quantized_ops = _get_quantized_ops(calib_qconf)
+        latency_fallback_ops = []
+        if mixed_bf16:
+            latency_fallback_ops = _get_latency_fallback_ops(prepared_model, calib_qconf, quantized_ops, example_inputs)
+            quantized_ops = [op for op in quantized_ops if op not in latency_fallback_ops]
+
+        def _evaluate_candidates(candidates):
+            trials = []
+            for act_qparams, fallback_ops, bf16 in candidates:
+                qconf_summary = os.path.join(tmpdir, 'candidate_%d.json' % len(os.listdir(tmpdir)))
+                with open(qconf_summary, 'w') as fp:
+                    json.dump(_make_candidate(calib_qconf, act_qparams, latency_fallback_ops + fallback_ops), fp, indent=4)
+                trials.append((qconf_summary, bf16))
+            return [q for q, _ in trials], _evaluate(model, trials, example_inputs, eval_func, core_partitions)
+
+        # the FP32 baseline and the recipes with the histogram and the min/max qparams
+        candidates = [(None, quantized_ops, False), (None, [], mixed_bf16), (minmax_qparams, [], mixed_bf16)]
+        qconf_summaries, accuracies = _evaluate_candidates(candidates)
+        baseline = accuracies[0]
+        if accuracy_criterion.get('absolute') is not None:
+            target = baseline - accuracy_criterion.get('absolute')
+        else:
+            target = baseline * (1 - accuracy_criterion.get('relative', 0.01))
+        best = max([1, 2], key=lambda i: accuracies[i])
+        best_qconf_summary, best_accuracy = qconf_summaries[best], accuracies[best]
+
+        def _done():
+            if best_accuracy >= target and tuning_time == 0:
+                return True
+            return tuning_time > 0 and time.time() - start_time > tuning_time
+
+        if not _done() and len(quantized_ops) > 0:
+            # the sensitivity of each op, falling back alone
+            act_qparams = candidates[best][0]
+            single_qconf_summaries, single_accuracies = _evaluate_candidates(
+                [(act_qparams, [op], mixed_bf16) for op in quantized_ops])
+            for qconf_summary, accuracy in zip(single_qconf_summaries, single_accuracies):
+                if accuracy > best_accuracy:
+                    best_qconf_summary, best_accuracy = qconf_summary, accuracy
+            ranked_ops = [op for _, op in sorted(zip(single_accuracies, quantized_ops),
+                                                 key=lambda x: x[0], reverse=True)]
+            # the most sensitive ops falling back together, a batch of workers at a time
+            num_fallbacks = 2
+            while not _done() and num_fallbacks <= len(ranked_ops):
+                nums = range(num_fallbacks, min(num_fallbacks + num_workers, len(ranked_ops) + 1))
+                fallback_qconf_summaries, fallback_accuracies = _evaluate_candidates(
+                    [(act_qparams, ranked_ops[:n], mixed_bf16) for n in nums])
+                for qconf_summary, accuracy in zip(fallback_qconf_summaries, fallback_accuracies):
+                    if accuracy > best_accuracy:
+                        best_qconf_summary, best_accuracy = qconf_summary, accuracy
+                        # on early stop, the first one meeting the target keeps the most ops in INT8
+                        if best_accuracy >= target and tuning_time == 0:
+                            break
+                num_fallbacks += len(nums)
+
+        if best_accuracy < target:
+            warnings.warn("IPEX quantization: autotune could not meet the accuracy criterion, "
+                          "returning the recipe with the best accuracy {} (FP32 {})".format(best_accuracy, baseline))
+        dirname_str = './saved_tuning_results_'+time.strftime("%Y%m%d_%H%M%S")
+        os.makedirs(dirname_str, exist_ok=True)
+        with open(best_qconf_summary, 'r') as f:
+            best_qconf = json.load(f)
+        with open(dirname_str + '/best_configure.json', 'w') as fp:
+            json.dump(best_qconf, fp, indent=4)
 
+    new_prepared_model = copy_prepared_model(prepared_model)
+    new_prepared_model.load_qconf_summary(qconf_summary=dirname_str + '/best_configure.json')
     return new_prepared_model
@@ -0,0 +1,94 @@
+import json
+
+import torch
+
+import intel_extension_for_pytorch._C as core
+
+# the extra file of the saved module recording its warm-up inputs
+WARMUP_FILE = "ipex_llga_warmup.json"
+
+
+def _input_spec(x):
+    if isinstance(x, torch.Tensor):
+        channels_last = (
+            x.dim() == 4
+            and not x.is_contiguous()
+            and x.is_contiguous(memory_format=torch.channels_last)
+        )
+        return {
+            "shape": list(x.shape),
+            "dtype": str(x.dtype).replace("torch.", ""),
+            "channels_last": channels_last,
+        }
+    if isinstance(x, (tuple, list)):
+        return [_input_spec(i) for i in x]
+    raise TypeError("Unsupported warm-up input type: {}".format(type(x)))
+
+
+def _make_input(spec):
+    if isinstance(spec, list):
+        return tuple(_make_input(s) for s in spec)
+    x = torch.zeros(spec["shape"], dtype=getattr(torch, spec["dtype"]))
+    if spec["channels_last"]:
+        x = x.to(memory_format=torch.channels_last)
+    return x
+
+
+def save(model, f, warmup_inputs):
+    r"""
+    Saves a traced (and frozen) quantized model with the shapes of
+    warmup_inputs, a list of the example inputs (a tuple each) of the shapes
+    to serve, and the LLGA dynamic shape settings, for load to compile the
+    LLGA partitions of these shapes ahead of the first request.
+
+    Args:
+        model (torch.jit.ScriptModule): The traced model.
+        f: A file name or file-like object, as torch.jit.save.
+        warmup_inputs (list): The example inputs of each shape to warm up.
+    """
+    assert isinstance(
+        model, torch.jit.ScriptModule
+    ), "IPEX quantization: save takes a traced model"
+    specs = []
+    for inputs in warmup_inputs:
+        if isinstance(inputs, torch.Tensor):
+            inputs = (inputs,)
+        specs.append(_input_spec(list(inputs)))
+    warmup = {
+        "inputs": specs,
+        "dynamic_shape": core._jit_llga_dynamic_shape_enabled(),
+        "symbolic_shape": core._jit_llga_symbolic_shape_enabled(),
+        "dynamic_dim_bound": core._jit_llga_dynamic_dim_bound(),
+        "shape_buckets": core._jit_llga_shape_buckets(),
+    }
+    torch.jit.save(model, f, _extra_files={WARMUP_FILE: json.dumps(warmup)})
+
+
+def load(f, warmup=True):
+    r"""
+    Loads a model saved by save and, when warmup, runs it on zero inputs of the
+    recorded shapes (restoring the LLGA dynamic shape settings of the save),
+    enough times for the profiling executor to optimize its graph and for the
+    LLGA partitions of each shape to be compiled, so that the first request
+    runs the compiled partitions.
+
+    Returns:
+        torch.jit.ScriptModule
+    """
+    extra_files = {WARMUP_FILE: ""}
+    model = torch.jit.load(f, _extra_files=extra_files)
+    if not warmup or not extra_files[WARMUP_FILE]:
+        return model
+    config = json.loads(extra_files[WARMUP_FILE])
+    core._jit_set_llga_dynamic_shape_enabled(config["dynamic_shape"])
+    core._jit_set_llga_symbolic_shape_enabled(config.get("symbolic_shape", False))
+    core._jit_set_llga_dynamic_dim_bound(config.get("dynamic_dim_bound", 0))
+    core._jit_set_llga_shape_buckets(config["shape_buckets"])
+    # the profiled runs, then the run optimizing the graph and compiling
+    runs = torch._C._jit_get_num_profiled_runs() + 1
+    with torch.no_grad():
+        for spec in config["inputs"]:
+            inputs = _make_input(spec)
+            for _ in range(runs):
+                model(*inputs)
+    return model
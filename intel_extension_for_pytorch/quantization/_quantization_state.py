@@ -63,6 +63,9 @@ class AutoQuantizationState(torch.nn.Module):
         self.weight_tensor_id_to_smooth_quant_scaling_factor: Dict[int, torch.Tensor] = {}
         self.idx_to_smooth_quant_scaling_factor: Dict[str, torch.Tensor] = {}
         self.idx_to_weight_updated_for_smooth_quant: set[str] = set()
+        # int8 weights quantized once from their calibrated scale and zero
+        # point, shared by all the calls of the converted model
+        self.idx_to_quantized_weight: Dict[str, torch.Tensor] = {}
 
     def get_extra_state(self):
         return {"tensor_id_to_scale_zp": self.tensor_id_to_scale_zp}
@@ -343,6 +346,23 @@ class AutoQuantizationState(torch.nn.Module):
         args = iterate_and_apply_convert(args, arg_quant_infos, any_arg_quant_or_dequant_needed, op)
         return op, args, kwargs
 
+    def _get_quantized_weight(self, key, get_weight, scale, zp, ch_axis, dtype):
+        """
+        Returns the quantized weight of `key`, quantizing `get_weight()` only
+        at the first call after convert. The autocast path quantizes the bf16
+        rounded weight, so it gets its own entry.
+        """
+        if torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16:
+            key = key + '_bf16'
+        if key not in self.idx_to_quantized_weight:
+            weight = get_weight()
+            if scale.numel() > 1:
+                qweight = torch.quantize_per_channel(weight, scale, zp, ch_axis, dtype)
+            else:
+                qweight = torch.quantize_per_tensor(weight, scale.item(), zp.item(), dtype)
+            self.idx_to_quantized_weight[key] = qweight
+        return self.idx_to_quantized_weight[key]
+
     def op_weight_convert_before_hook(
         self,
         op: Callable,
@@ -360,32 +380,30 @@ class AutoQuantizationState(torch.nn.Module):
             quant_info = arg_quant_infos[tensor_arg_idx]
             if quant_info is not None and any_arg_quant_or_dequant_needed[tensor_arg_idx]:
                 scale, zp, dtype = quant_info
-                weight = op.weight
                 ch_axis = 0
                 if type(op) in [torch.nn.ConvTranspose2d, torch.nn.ConvTranspose3d]:
                     ch_axis = 1
+                wei_key = str(self.idx) + '_0'
                 if torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16:
-                    if weight.dtype == torch.float32:
-                        weight = weight.to(torch.bfloat16)
-                    weight  = weight.to(torch.float32)
-                    if scale.numel() > 1:
-                        arg = torch.quantize_per_channel(weight, scale, zp, ch_axis, dtype)
-                    else:
-                        arg = torch.quantize_per_tensor(weight, scale.item(), zp.item(), dtype)
+                    def get_weight():
+                        weight = op.weight
+                        if weight.dtype == torch.float32:
+                            weight = weight.to(torch.bfloat16)
+                        return weight.to(torch.float32)
+                    arg = self._get_quantized_weight(wei_key, get_weight, scale, zp, ch_axis, dtype)
                     arg = arg.dequantize()
                     arg = arg.to(torch.bfloat16)
                 else:
-                    # Update weight of nn.Linear for SmoothQuant
-                    wei_key = str(self.idx) + '_0'
-                    if wei_key in self.idx_to_smooth_quant_scaling_factor:
-                        wei_scaling_factors = \
-                            self.idx_to_smooth_quant_scaling_factor[wei_key]
-                        if wei_scaling_factors is not None:
-                            weight = torch.mul(weight, wei_scaling_factors)
-                    if scale.numel() > 1:
-                        arg = torch.quantize_per_channel(weight, scale, zp, ch_axis, dtype)
-                    else:
-                        arg = torch.quantize_per_tensor(weight, scale.item(), zp.item(), dtype)
+                    def get_weight():
+                        weight = op.weight
+                        # Update weight of nn.Linear for SmoothQuant
+                        if wei_key in self.idx_to_smooth_quant_scaling_factor:
+                            wei_scaling_factors = \
+                                self.idx_to_smooth_quant_scaling_factor[wei_key]
+                            if wei_scaling_factors is not None:
+                                weight = torch.mul(weight, wei_scaling_factors)
+                        return weight
+                    arg = self._get_quantized_weight(wei_key, get_weight, scale, zp, ch_axis, dtype)
                     arg = arg.dequantize()
                 new_args.append(arg)
             else:
@@ -395,16 +413,18 @@ class AutoQuantizationState(torch.nn.Module):
             quant_info = arg_quant_infos[tensor_arg_idx]
             if quant_info is not None and any_arg_quant_or_dequant_needed[tensor_arg_idx]:
                 scale, zp, dtype = quant_info
-                weight = op.weight
+                wei_key = str(self.idx) + '_0'
                 if torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16:
-                    if weight.dtype == torch.float32:
-                        weight = weight.to(torch.bfloat16)
-                    weight  = weight.to(torch.float32)
-                    arg = torch.quantize_per_tensor(weight, scale.item(), zp.item(), dtype)
+                    def get_weight():
+                        weight = op.weight
+                        if weight.dtype == torch.float32:
+                            weight = weight.to(torch.bfloat16)
+                        return weight.to(torch.float32)
+                    arg = self._get_quantized_weight(wei_key, get_weight, scale, zp, 0, dtype)
                     arg = arg.dequantize()
                     arg = arg.to(torch.bfloat16)
                 else:
-                    arg = torch.quantize_per_tensor(op.weight, scale.item(), zp.item(), dtype)
+                    arg = self._get_quantized_weight(wei_key, lambda: op.weight, scale, zp, 0, dtype)
                     arg = arg.dequantize()
                 new_args.append(arg)
             else:
@@ -419,31 +439,19 @@ class AutoQuantizationState(torch.nn.Module):
                     w_hh =  weights[tensor_arg_idx + 1]
                     w_ih_scale, w_ih_zp, w_ih_dtype = quant_info
                     w_hh_scale, w_hh_zp, w_hh_dtype = arg_quant_infos[tensor_arg_idx + 1]
-                    if torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16:
-                        weight_if_bf16 = w_ih.dtype == torch.bfloat16
-                        if weight_if_bf16:
-                            w_ih  = w_ih.to(torch.float32)
-                            w_hh  = w_hh.to(torch.float32)
-                        if w_ih_scale.numel() > 1:
-                            w_ih = torch.quantize_per_channel(w_ih, w_ih_scale, w_ih_zp, 0, w_ih_dtype)
-                            w_hh = torch.quantize_per_channel(w_hh, w_hh_scale, w_hh_zp, 0, w_hh_dtype)
-                        else:
-                            w_ih = torch.quantize_per_tensor(w_ih, w_ih_scale.item(), w_ih_zp.item(), w_ih_dtype)
-                            w_hh = torch.quantize_per_tensor(w_hh, w_hh_scale.item(), w_hh_zp.item(), w_hh_dtype)
-                        w_ih = w_ih.dequantize()
-                        w_hh = w_hh.dequantize()
-                        if weight_if_bf16:
-                            w_ih  = w_ih.to(torch.bfloat16)
-                            w_hh  = w_hh.to(torch.bfloat16)
-                    else:
-                        if w_ih_scale.numel() > 1:
-                            w_ih = torch.quantize_per_channel(w_ih, w_ih_scale, w_ih_zp, 0, w_ih_dtype)
-                            w_hh = torch.quantize_per_channel(w_hh, w_hh_scale, w_hh_zp, 0, w_hh_dtype)
-                        else:
-                            w_ih = torch.quantize_per_tensor(w_ih, w_ih_scale, w_ih_zp, w_ih_dtype)
-                            w_hh = torch.quantize_per_tensor(w_hh, w_hh_scale, w_hh_zp, w_hh_dtype)
-                        w_ih = w_ih.dequantize()
-                        w_hh = w_hh.dequantize()
+                    weight_if_bf16 = torch.is_autocast_cpu_enabled() and \
+                        core.get_autocast_dtype() == torch.bfloat16 and w_ih.dtype == torch.bfloat16
+                    w_ih_key = str(self.idx) + '_' + str(tensor_arg_idx)
+                    w_hh_key = str(self.idx) + '_' + str(tensor_arg_idx + 1)
+                    w_ih = self._get_quantized_weight(
+                        w_ih_key, lambda: w_ih.to(torch.float32) if weight_if_bf16 else w_ih,
+                        w_ih_scale, w_ih_zp, 0, w_ih_dtype).dequantize()
+                    w_hh = self._get_quantized_weight(
+                        w_hh_key, lambda: w_hh.to(torch.float32) if weight_if_bf16 else w_hh,
+                        w_hh_scale, w_hh_zp, 0, w_hh_dtype).dequantize()
+                    if weight_if_bf16:
+                        w_ih  = w_ih.to(torch.bfloat16)
+                        w_hh  = w_hh.to(torch.bfloat16)
                     new_args.append(w_ih)
                     new_args.append(w_hh)
                     if op.bias:
@@ -32,7 +32,11 @@ functions_supported_by_quantization =set([
     F.relu,
     #torch.sigmoid,  # TODO
     #F.sigmoid,  # TODO
-    #F.gelu, # TODO
+    F.gelu,
+    F.layer_norm,
+    F.softmax,
+    torch.softmax,
+    torch.Tensor.softmax,
     F.linear,
     torch._C._nn.linear,
     torch.matmul,
@@ -63,7 +67,9 @@ module_types_supported_by_quantization = set([
     torch.nn.AdaptiveAvgPool3d,
     torch.nn.ReLU,
     #torch.nn.Sigmoid,  # TODO
-    #torch.nn.GELU,     # TODO
+    torch.nn.GELU,
+    torch.nn.LayerNorm,
+    torch.nn.Softmax,
     torch.nn.EmbeddingBag,
     torch.nn.Flatten,
     torch.nn.LSTM,
@@ -236,6 +242,9 @@ def get_input_observed_arg_idxs(
         return [0, 1]
     elif op_type in embedding_op:
         return [1]
+    elif op_type == str(F.layer_norm):
+        # the weight and bias of LayerNorm stay in fp32
+        return [0]
     # None means "observe all Tensor args"
     return None
 
@@ -14,7 +14,7 @@ from torch.ao.quantization.quantization_mappings import get_default_dynamic_quan
 
 import intel_extension_for_pytorch._C as core
 from intel_extension_for_pytorch.utils.linear_bn_folding import linear_bn_fuse
-from intel_extension_for_pytorch.nn.utils._weight_prepack import may_import_deepspeed_modules
+from intel_extension_for_pytorch.nn.utils._weight_prepack import may_import_deepspeed_modules, _linear_allreduce
 from ._quantize_utils import auto_prepare, auto_convert, copy_prepared_model
 from .. import nn
 
@@ -132,8 +132,39 @@ class _IPEXDynamicQuantizedLinear(nnqd.Linear):
         qweight = _quantize_weight(mod.weight.float(), weight_observer)
         
         qlinear = cls._init_cls(mod, dtype, qweight)
+        qlinear._init_ctx(qweight)
         return qlinear         
 
+    def _init_ctx(self, qweight):
+        # Prepack the symmetric int8 weight for the native dynamic quantized
+        # linear, which quantizes the activation per token inside the op.
+        # Asymmetric weights keep the torch.ops.quantized path.
+        self.ctx = None
+        qscheme = qweight.qscheme()
+        if qscheme in [torch.per_tensor_affine, torch.per_tensor_symmetric]:
+            if qweight.q_zero_point() != 0:
+                return
+            scales = torch.tensor([qweight.q_scale()], dtype=torch.float)
+        elif qscheme in [torch.per_channel_affine, torch.per_channel_symmetric]:
+            if qweight.q_per_channel_axis() != 0 or \
+                    torch.any(qweight.q_per_channel_zero_points() != 0):
+                return
+            scales = qweight.q_per_channel_scales().float()
+        else:
+            return
+        _, bias = self._weight_bias()
+        self.ctx = torch.ops.ipex_prepack.dynamic_quant_linear_prepack_quantized(
+            qweight.int_repr(), scales, bias)
+
+    def _dynamic_quant_linear(self, x):
+        return torch.ops.torch_ipex.ipex_dynamic_quant_linear(
+            x, self.ctx.get_data_handle())
+
+    def forward(self, x):
+        if getattr(self, 'ctx', None) is not None:
+            return self._dynamic_quant_linear(x)
+        return super().forward(x)
+
 class DynamicQuantizedLinearLayer(_IPEXDynamicQuantizedLinear):
     @classmethod
     def _init_cls(cls, mod, dtype, qweight):
@@ -178,8 +209,10 @@ class DynamicQuantizedLinearAllreduce(_IPEXDynamicQuantizedLinear):
         self.mp_group = mp_group
         self.original_bias = bias_value
 
-    def forward(self, x):
-        if self._packed_params.dtype == torch.qint8:
+    def _gemm(self, x):
+        if getattr(self, 'ctx', None) is not None:
+            Y = self._dynamic_quant_linear(x)
+        elif self._packed_params.dtype == torch.qint8:
             if self.version is None or self.version < 4:
                 Y = torch.ops.quantized.linear_dynamic(
                     x, self._packed_params._packed_params)
@@ -191,14 +224,18 @@ class DynamicQuantizedLinearAllreduce(_IPEXDynamicQuantizedLinear):
                 x, self._packed_params._packed_params)
         else:
             raise RuntimeError('Unsupported dtype on dynamic quantized linear!')
-        output = Y.to(x.dtype)
+        return Y.to(x.dtype)
 
+    def forward(self, x):
         if self.mp_group is not None:
-            torch.ops.deepspeed_comm.all_reduce(output, 'sum', "", list(torch.arange(int(os.environ['WORLD_SIZE']))), int(os.environ['WORLD_SIZE']))
+            # the GEMMs of chunks of the rows pipelined with their allreduces
+            output = _linear_allreduce(x, self._gemm, self.out_features)
+        else:
+            output = self._gemm(x)
 
         if self.original_bias is not None:
             output += self.original_bias
-        return output        
+        return output
 
     def __repr__(self):
         return 'DynamicQuantizedLinearAllreduce()'
@@ -221,11 +258,15 @@ def convert(
     assert isinstance(model, torch.nn.Module), "Only support nn.Module convert for quantization path"
     assert hasattr(model, 'q_config'), "Please do prepare the model before doing convert"
 
+    # The weights are quantized from their calibrated scales once at the first
+    # call of the converted model, the fp32 ones are only read. They are shared
+    # with the prepared model unless the autocast path below recasts them.
+    autocast_bf16 = torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16
     if inplace:
         convert_model = model
     else:
         try:
-            convert_model = copy_prepared_model(model)
+            convert_model = copy_prepared_model(model, share_parameters=not autocast_bf16)
         except:
             assert False, "The model's copy is failed, please try set inplace to True to do the convert"
 
@@ -258,7 +299,7 @@ def convert(
     # Convert linear, conv, and Embedding's weight dtype when use autocast,
     # which will reduce the dtype conversion.
     # TODO: check whether can be removed or not?
-    if torch.is_autocast_cpu_enabled() and core.get_autocast_dtype() == torch.bfloat16:
+    if autocast_bf16:
         convert_model = nn.utils._model_convert.convert_module_data_type(convert_model, torch.bfloat16)
 
     convert_model = auto_convert(convert_model)
@@ -383,8 +383,11 @@ def auto_prepare(
         model(*example_inputs)
     return model
 
-def copy_prepared_model(model):
-    copied_model = copy.deepcopy(model)
+def copy_prepared_model(model, share_parameters=False):
+    # With share_parameters, the copy reuses the parameters of the prepared
+    # model rather than duplicating them, for copies which only read them.
+    memo = {id(p): p for p in model.parameters()} if share_parameters else None
+    copied_model = copy.deepcopy(model, memo)
     copied_model.q_config = model.q_config
     if isinstance(copied_model.q_config.activation(), PlaceholderObserver):
         return copied_model
@@ -1,5 +1,7 @@
+import copy
 import json
 import os
+import time
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
@@ -9,7 +11,7 @@ from ._utils import ParentNode, set_node_output_quantized
 
 add_inplace_ops = [str(torch.Tensor.add_)]
 add_ops = [str(torch.add), str(torch.Tensor.add)]
-elt_wise_q_ops = [str(torch.Tensor.relu), str(torch.relu), str(F.relu), str(nn.ReLU)]
+elt_wise_q_ops = [str(torch.Tensor.relu), str(torch.relu), str(F.relu), str(nn.ReLU), str(F.gelu), str(nn.GELU)]
 elt_wise_noq_ops = [str(torch.relu_), str(torch.sigmoid_), str(nn.ReLU), str(torch.Tensor.relu_), str(torch.Tensor.sigmoid_), \
     str(torch.nn.Hardtanh), str(F.hardtanh), str(F.hardtanh_),str(torch.nn.ELU), str(F.elu), str(F.elu_), \
         str(nn.SiLU), str(F.silu), str(torch.Tensor.sigmoid), str(torch.sigmoid), str(F.sigmoid), str(nn.Sigmoid), str(F.gelu), str(nn.GELU)]
@@ -75,6 +77,35 @@ def _default_recipe_init(nodes):
                     if tensor_info is not None:
                         tensor_info.inf_dtype = tensor_info.orig_dtype
 
+# The quantizable modules whose INT8 and BF16 latency can be profiled alone.
+latency_profiled_ops = [str(nn.Linear), str(nn.Conv2d), str(nn.Conv3d)]
+
+def _measure_latency(model, inputs, warmup=3, iters=10):
+    with torch.no_grad():
+        for _ in range(warmup):
+            model(*inputs)
+        start = time.perf_counter()
+        for _ in range(iters):
+            model(*inputs)
+    return (time.perf_counter() - start) / iters
+
+def profile_int8_bf16_latency(module, inputs, qconfig):
+    r"""
+    This function is about measure the latency of a quantizable module with its given inputs on the current host,
+    in INT8 including the quantization of its inputs and the dequantization of its output, and in BF16 under autocast.
+    Returns a tuple of (INT8 latency, BF16 latency) in seconds.
+    """
+    from ._quantize import prepare, convert
+    with torch.no_grad():
+        prepared_model = prepare(nn.Sequential(copy.deepcopy(module)).eval(), qconfig,
+                                 example_inputs=inputs, inplace=True, bn_folding=False)
+        prepared_model(*inputs)
+        int8_model = torch.jit.freeze(torch.jit.trace(convert(prepared_model, inplace=True), inputs))
+        with torch.cpu.amp.autocast():
+            bf16_model = torch.jit.freeze(torch.jit.trace(copy.deepcopy(module).eval(), inputs))
+            bf16_latency = _measure_latency(bf16_model, inputs)
+    return _measure_latency(int8_model, inputs), bf16_latency
+
 #TODO: making fusion pattern check more general.
 def _find_fused_node_with_cur_elt_wise(node, ops):
     r"""
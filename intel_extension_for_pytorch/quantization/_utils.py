@@ -53,13 +53,19 @@ int8_int8_ops = set([
     str(torch.flatten),
     str(torch.Tensor.flatten),
     str(torch.nn.Flatten),
+    str(F.gelu),
+    str(nn.GELU),
+    str(F.layer_norm),
+    str(nn.LayerNorm),
+    str(F.softmax),
+    str(torch.softmax),
+    str(torch.Tensor.softmax),
+    str(nn.Softmax),
     # the following op will be supported at next step.
     #str(torch.Tensor.sigmoid),
     #str(torch.sigmoid),
     #str(F.sigmoid),
     #str(nn.Sigmoid),
-    #str(F.gelu),
-    #str(nn.GELU),
     # ipex customer op
     str(interaction),
     str(torch.ops.torch_ipex.interaction_forward),
@@ -260,6 +266,8 @@ def attach_op_convert_info_to_model(
     """
     if hasattr(module, '_auto_quant_state'):
         qstate: AutoQuantizationState = module._auto_quant_state  # type: ignore[assignment]
+        # the weights are requantized from the scales of this convert
+        qstate.idx_to_quantized_weight.clear()
         for _, seen_q_op_info in qstate.idx_to_seen_q_op_infos.items():
             qstate.idx_to_op_convert_info[seen_q_op_info.idx] = \
                 qstate.calculate_op_convert_info(seen_q_op_info)
@@ -0,0 +1,186 @@
+import copy
+import warnings
+import weakref
+import torch
+from ..nn.modules import WeightOnlyQuantizedLinear
+
+
+def _quantize_params(w, bits):
+    # asymmetric qparams of each row of w, as WeightOnlyQuantizedLinear.from_float
+    qmax = 2 ** bits - 1
+    w_min = w.min(-1)[0].clamp(max=0)
+    w_max = w.max(-1)[0].clamp(min=0)
+    scales = (w_max - w_min) / qmax
+    scales[scales == 0] = 1
+    zero_points = torch.round(-w_min / scales).clamp(0, qmax)
+    return scales, zero_points
+
+
+class _HessianCollector(object):
+    r"""
+    Accumulates H = X^T X of the inputs X of the linears during the calibration. The linears reading the same input
+    tensor in a row (e.g. the query, key and value projections) share the H of the first one.
+    """
+    def __init__(self, linears):
+        self.hessians = {}
+        self.num_samples = {}
+        self.owner = {}
+        self.last_input = None
+        self.last_linear = None
+        self.handles = [linear.register_forward_pre_hook(self._hook) for linear in linears]
+
+    def _hook(self, linear, inputs):
+        x = inputs[0]
+        if linear not in self.owner:
+            last = self.last_input() if self.last_input is not None else None
+            self.owner[linear] = self.owner[self.last_linear] if last is x else linear
+        self.last_input = weakref.ref(x)
+        self.last_linear = linear
+        if self.owner[linear] is not linear:
+            return
+        x = x.detach().reshape(-1, x.size(-1)).float()
+        if linear not in self.hessians:
+            self.hessians[linear] = torch.zeros(x.size(-1), x.size(-1))
+            self.num_samples[linear] = 0
+        self.hessians[linear].addmm_(x.t(), x)
+        self.num_samples[linear] += x.size(0)
+
+    def get(self, linear):
+        owner = self.owner.get(linear)
+        if owner is None or owner not in self.hessians:
+            return None
+        return self.hessians[owner] / max(self.num_samples[owner], 1)
+
+    def remove(self):
+        for handle in self.handles:
+            handle.remove()
+
+
+def _gptq_quantize(weight, H, bits, group_size, damp_percent, block_size):
+    r"""
+    GPTQ (https://arxiv.org/abs/2210.17323): the columns are quantized in order, the error of each one being
+    compensated on the columns not quantized yet through the inverse Hessian of the inputs. The updates of a block
+    of columns are rank-1, the ones of the following columns a GEMM per block.
+    """
+    W = weight.detach().float().clone()
+    N, K = W.shape
+    H = H.clone()
+    dead = torch.diag(H) == 0
+    H[dead, dead] = 1
+    W[:, dead] = 0
+    H.diagonal().add_(damp_percent * torch.mean(torch.diag(H)))
+    Hinv = torch.linalg.cholesky(torch.cholesky_inverse(torch.linalg.cholesky(H)), upper=True)
+
+    qmax = 2 ** bits - 1
+    Q = torch.zeros(N, K, dtype=torch.uint8)
+    scales = torch.zeros(N, K // group_size)
+    zero_points = torch.zeros(N, K // group_size)
+    # blocks of whole groups, so the qparams of a group are found on its updated columns
+    block_size = max(block_size // group_size, 1) * group_size if group_size < K else block_size
+    for i1 in range(0, K, block_size):
+        i2 = min(i1 + block_size, K)
+        W1 = W[:, i1:i2]
+        Hinv1 = Hinv[i1:i2, i1:i2]
+        Err1 = torch.zeros_like(W1)
+        for i in range(i2 - i1):
+            col = i1 + i
+            if col % group_size == 0:
+                g = col // group_size
+                scales[:, g], zero_points[:, g] = _quantize_params(W[:, col:col + group_size], bits)
+            scale = scales[:, col // group_size]
+            zp = zero_points[:, col // group_size]
+            w = W1[:, i]
+            q = (torch.round(w / scale) + zp).clamp(0, qmax)
+            Q[:, col] = q.to(torch.uint8)
+            err = (w - (q - zp) * scale) / Hinv1[i, i]
+            W1[:, i:].sub_(torch.outer(err, Hinv1[i, i:]))
+            Err1[:, i] = err
+        W[:, i2:].sub_(torch.matmul(Err1, Hinv[i1:i2, i2:]))
+    return Q, scales, zero_points
+
+
+def _rtn_quantize(weight, bits, group_size):
+    N, K = weight.shape
+    w = weight.detach().float().view(N, K // group_size, group_size)
+    scales, zero_points = _quantize_params(w, bits)
+    q = (torch.round(w / scales.unsqueeze(-1)) + zero_points.unsqueeze(-1)).clamp(0, 2 ** bits - 1)
+    return q.to(torch.uint8).view(N, K), scales, zero_points
+
+
+def _set_module(model, name, module):
+    parent_name, _, child_name = name.rpartition('.')
+    parent = model.get_submodule(parent_name) if parent_name else model
+    setattr(parent, child_name, module)
+
+
+def weight_only_quantize(model, calib_dataloader=None, bits=4, group_size=128, algorithm='gptq', sampling_size=128,
+                         damp_percent=0.01, block_size=128, exclude_modules=None, inplace=False):
+    r"""
+    Weight-only quantization of the ``torch.nn.Linear`` of a model: their weights are quantized to int4/int8 with one
+    scale and zero point per group of ``group_size`` input channels, and the linears are swapped for
+    :class:`intel_extension_for_pytorch.nn.modules.WeightOnlyQuantizedLinear`, while the activations stay in fp32/bf16.
+
+    With ``algorithm='gptq'``, the calibration runs once to accumulate the Hessians ``X^T X`` of the inputs of all the
+    linears, then each weight is quantized column by column, the quantization error of a column being compensated on
+    the next ones as in GPTQ. The linears reading the same input share one Hessian, which costs
+    ``4 * in_features ** 2`` bytes. ``algorithm='rtn'`` rounds each weight to the nearest without calibration.
+
+    Args:
+        model (torch.nn.Module): the FP32 model to quantize.
+        calib_dataloader (iterable): the calibration inputs of ``gptq``, yielding either inputs or (inputs, labels).
+        bits (int): 4 or 8. The default value is ``4``.
+        group_size (int): the number of input channels sharing a scale, ``-1`` for per output channel.
+            The linears whose in_features are not a multiple of it are kept in FP32. The default value is ``128``.
+        algorithm (str): ``'gptq'`` or ``'rtn'``. The default value is ``'gptq'``.
+        sampling_size (int): the number of calibration samples. The default value is ``128``.
+        damp_percent (float): the dampening of the Hessian, relative to the mean of its diagonal.
+            The default value is ``0.01``.
+        block_size (int): the number of columns whose errors are compensated on the next columns by one GEMM.
+            The default value is ``128``.
+        exclude_modules (list): the names of the linears to keep in FP32, e.g. ``['lm_head']``.
+        inplace (bool): quantize the given model in-place if True. The default value is ``False``.
+
+    Returns:
+        torch.nn.Module
+    """
+    assert bits in (4, 8), "weight_only_quantize supports 4 or 8 bits"
+    assert algorithm in ('gptq', 'rtn'), "weight_only_quantize supports the gptq and rtn algorithms"
+    assert algorithm == 'rtn' or calib_dataloader is not None, "gptq needs a calib_dataloader"
+    if not inplace:
+        model = copy.deepcopy(model)
+    exclude_modules = exclude_modules or []
+    linears = {}
+    for name, m in model.named_modules():
+        if type(m) is not torch.nn.Linear or name in exclude_modules:
+            continue
+        if group_size > 0 and m.in_features % group_size != 0:
+            warnings.warn(f"weight_only_quantize: {name} is kept in FP32, its in_features {m.in_features} "
+                          f"are not a multiple of the group_size {group_size}")
+            continue
+        linears[name] = m
+
+    collector = None
+    if algorithm == 'gptq':
+        from ._autotune import _calibrate
+        collector = _HessianCollector(linears.values())
+        try:
+            _calibrate(model, calib_dataloader, sampling_size)
+        finally:
+            collector.remove()
+
+    with torch.no_grad():
+        for name, m in linears.items():
+            K = m.in_features
+            m_group_size = group_size if group_size > 0 else K
+            H = collector.get(m) if collector is not None else None
+            if H is None:
+                qweight, scales, zero_points = _rtn_quantize(m.weight, bits, m_group_size)
+            else:
+                qweight, scales, zero_points = _gptq_quantize(
+                    m.weight, H, bits, m_group_size, damp_percent, block_size)
+            bias = m.bias.detach().float() if m.bias is not None else None
+            _set_module(model, name, WeightOnlyQuantizedLinear(
+                qweight, scales, zero_points, bias, bits, group_size))
+            # release the fp32 weight as soon as its int8 one is packed
+            m.weight = None
+    return model
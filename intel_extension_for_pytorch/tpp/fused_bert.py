@@ -11,6 +11,8 @@ from .utils.blocked_layout import (
     get_blocking_signature,
 )
 import time
+import warnings
+import weakref
 from contextlib import contextmanager
 try:
     from transformers.modeling_utils import apply_chunking_to_forward
@@ -21,6 +23,11 @@ USE_BF16_PARAMS = True
 layer_use_bf16 = False
 unpad = True
 print_cou = 0
+FP8_DTYPES = (torch.float8_e4m3fn, torch.float8_e5m2)
+# What the fused layers save of their activations for backward: all of them,
+# the float ones in a smaller dtype, or their inputs only, the others being
+# computed again by the forward kernels before the backward kernels
+ACTIVATION_POLICIES = ("keep", "compress", "recompute")
 
 
 def print_grad_hook(var, name):
@@ -36,6 +43,57 @@ def print_grad_hook(var, name):
     var.grad_fn.register_hook(register_grad)
 
 
+def _compress_activation(t, dtype):
+    if (
+        dtype is None
+        or not t.is_floating_point()
+        or t.numel() == 0
+        or t.element_size() <= torch.empty([], dtype=dtype).element_size()
+    ):
+        return t, None
+    if dtype in FP8_DTYPES:
+        # a per-tensor scale to the range of the fp8 dtype
+        scale = t.abs().max().float().clamp(min=1e-12) / torch.finfo(dtype).max
+        return (t.float() / scale).to(dtype), scale
+    return t.to(dtype), None
+
+
+def save_activations(ctx, tensors, activations, compress_dtype):
+    r"""
+    Saves the tensors for backward, the activations (their indices) of a float
+    dtype larger than compress_dtype being saved in compress_dtype, or kept
+    with a compress_dtype of None. A tensor saved twice is compressed once.
+    The dropout masks of the fused kernels are bitmasks already.
+    """
+    tensors = list(tensors)
+    ctx.compressed = {}
+    ctx.aliases = {}
+    first = {}
+    for i in activations:
+        t = tensors[i]
+        if id(t) in first:
+            ctx.aliases[i] = first[id(t)]
+            tensors[i] = tensors[first[id(t)]]
+            continue
+        first[id(t)] = i
+        c, scale = _compress_activation(t, compress_dtype)
+        if c is not t:
+            ctx.compressed[i] = (t.dtype, scale)
+            tensors[i] = c
+    ctx.save_for_backward(*tensors)
+
+
+def saved_activations(ctx):
+    r"""The tensors saved by save_activations, decompressed."""
+    tensors = list(ctx.saved_tensors)
+    for i, (dtype, scale) in ctx.compressed.items():
+        t = tensors[i]
+        tensors[i] = t.to(dtype) if scale is None else (t.float() * scale).to(dtype)
+    for i, j in ctx.aliases.items():
+        tensors[i] = tensors[j]
+    return tensors
+
+
 def generate_mask(attention_mask):
     assert not attention_mask is None, "attention_mask is None"
     B, _, _, S = attention_mask.shape
@@ -56,7 +114,25 @@ def generate_mask(attention_mask):
     seq_offsets = seq_offsets.cumsum(dim=0)
     seq_sqr_offsets = seq_sqr_offsets.cumsum(dim=0)
     return msk, attention_mask, seq_offsets, seq_sqr_offsets
-   
+
+
+def generate_packed_mask(seq_lens, S2):
+    r"""
+    The masks of the sequences of seq_lens tokens packed into a single stream,
+    each one padded to a multiple of S2 tokens only: the index of the real
+    tokens in the stream, the attention mask of the stream and the offsets of
+    the sequences in blocks of S2 tokens (as generate_mask).
+    """
+    nnz = [(l + S2 - 1) // S2 * S2 for l in seq_lens]
+    seq_offsets = torch.tensor([0] + [n // S2 for n in nnz], dtype=torch.long)
+    starts = (seq_offsets.cumsum(dim=0)[:-1] * S2).tolist()
+    idx = torch.cat([torch.arange(l) + s for l, s in zip(seq_lens, starts)])
+    attention_mask = torch.full([sum(nnz)], -10000.0)
+    attention_mask[idx] = 0.0
+    seq_sqr_offsets = (seq_offsets * seq_offsets).cumsum(dim=0)
+    seq_offsets = seq_offsets.cumsum(dim=0)
+    return idx, attention_mask, seq_offsets, seq_sqr_offsets
+
 
 
 class PadInput(torch.autograd.Function):
@@ -144,7 +220,7 @@ class DummyLayerNorm(BlockedModule, torch.nn.LayerNorm):
 
 class BertSelfAttentionFunction(torch.autograd.Function):
     @staticmethod
-    def forward(ctx, p, training, need_attention_output, *inputs):
+    def forward(ctx, p, training, need_attention_output, policy, compress_dtype, *inputs):
         # print("FWD Called")
         # print("BSAFWD:", [t.shape if isinstance(t, torch.Tensor) else t for t in inputs[6:]])
         (
@@ -160,22 +236,32 @@ class BertSelfAttentionFunction(torch.autograd.Function):
             ap_dp_mask,
         ) = torch.ops.torch_ipex.fused_self_attention_fwd_unpad(p, inputs, training)
         (qw, qb, kw, kb, vw, vb, hs, am, hm, ehs, eam, offs, offs2) = inputs
-        ctx.save_for_backward(
-            qw,
-            kw,
-            vw,
-            hs_t,
-            hm,
-            ehs_t,
-            ql_t,
-            kl_tv,
-            vl_tv,
-            ap,
-            apd_t,
-            ap_dp_mask,
-            offs,
-            offs2,
-        )
+        # without dropout, the activations are computed again as they were
+        ctx.recompute = policy == "recompute" and p == 0 and hm.numel() == 0
+        if ctx.recompute:
+            ctx.save_for_backward(*inputs)
+        else:
+            save_activations(
+                ctx,
+                [
+                    qw,
+                    kw,
+                    vw,
+                    hs_t,
+                    hm,
+                    ehs_t,
+                    ql_t,
+                    kl_tv,
+                    vl_tv,
+                    ap,
+                    apd_t,
+                    ap_dp_mask,
+                    offs,
+                    offs2,
+                ],
+                [3, 5, 6, 7, 8, 9, 10] if policy != "keep" else [],
+                compress_dtype,
+            )
         ctx.p = p
         # stop = False
         # for i, t in enumerate([context_layer, attention_probs_out, hs_t, ehs_t, ql_t, kl_tv, vl_tv, ap, apd_t, ap_dp_mask]):
@@ -197,8 +283,40 @@ class BertSelfAttentionFunction(torch.autograd.Function):
         inputs += [g.contiguous() for g in grad_outs]
         if len(inputs) == 1:
             inputs.append(inputs[0].new_empty(0))
-        inputs += ctx.saved_tensors
         p = ctx.p
+        if ctx.recompute:
+            fwd_inputs = list(ctx.saved_tensors)
+            (qw, qb, kw, kb, vw, vb, hs, am, hm, ehs, eam, offs, offs2) = fwd_inputs
+            (
+                _,
+                _,
+                hs_t,
+                ehs_t,
+                ql_t,
+                kl_tv,
+                vl_tv,
+                ap,
+                apd_t,
+                ap_dp_mask,
+            ) = torch.ops.torch_ipex.fused_self_attention_fwd_unpad(p, fwd_inputs, True)
+            inputs += [
+                qw,
+                kw,
+                vw,
+                hs_t,
+                hm,
+                ehs_t,
+                ql_t,
+                kl_tv,
+                vl_tv,
+                ap,
+                apd_t,
+                ap_dp_mask,
+                offs,
+                offs2,
+            ]
+        else:
+            inputs += saved_activations(ctx)
         (
             dqw,
             dqb,
@@ -215,6 +333,8 @@ class BertSelfAttentionFunction(torch.autograd.Function):
         # print("Returning from BWD")
         # print("DHS:", dhs.view([-1])[:4])
         return (
+            None,
+            None,
             None,
             None,
             None,
@@ -305,6 +425,8 @@ class BertSelfAttention(BlockedModule):
             self.key.bias.set_blocking_param((None, None, torch.bfloat16))
             self.value.bias.set_blocking_param((None, None, torch.bfloat16))
         self.use_bf16 = layer_use_bf16
+        self.activation_policy = "keep"
+        self.activation_compress_dtype = torch.bfloat16
 
         # self.dropout = nn.Dropout(config.attention_probs_dropout_prob)
 
@@ -404,8 +526,14 @@ class BertSelfAttention(BlockedModule):
             inputs = [
                 i.to(torch.bfloat16) if i.is_floating_point() else i for i in inputs
             ]
+        policy = self.activation_policy if self.training else "keep"
         outputs = BertSelfAttentionFunction.apply(
-            p, self.training, output_attentions, *inputs
+            p,
+            self.training,
+            output_attentions,
+            policy,
+            self.activation_compress_dtype,
+            *inputs
         )
         # outputs = BertSelfAttentionFunction.apply(p, self.training, True, *inputs)
         context_layer = outputs[0]
@@ -431,23 +559,53 @@ class BertSelfAttention(BlockedModule):
 
 class BertOutputBaseFunction(torch.autograd.Function):
     @staticmethod
-    def forward(ctx, p, eps, training, *inputs):
+    def forward(ctx, p, eps, training, wt_scale, policy, compress_dtype, *inputs):
         (inp, inp2, wt, bias, gamma, beta) = inputs
         # print("A")
         outputs = torch.ops.torch_ipex.fused_dense_dropout_layernorm_fwd_unpad(
-            p, eps, inputs, training
+            p, eps, inputs, training, wt_scale
         )
         # print("B")
         (out, dout, mean, var, dp_mask) = outputs
-        ctx.save_for_backward(inp, wt, gamma, mean, var, dout, dp_mask)
+        # without dropout, the activations are computed again as they were
+        ctx.recompute = policy == "recompute" and p == 0
+        if ctx.recompute:
+            ctx.save_for_backward(*inputs)
+        else:
+            save_activations(
+                ctx,
+                [inp, wt, gamma, mean, var, dout, dp_mask],
+                [0, 5] if policy != "keep" else [],
+                compress_dtype,
+            )
         # print("C")
         ctx.p = p
+        ctx.eps = eps
+        ctx.wt_scale = wt_scale
         return out
 
     @staticmethod
     def backward(ctx, *grad_outs):
         inputs = list(grad_outs)
-        inputs += ctx.saved_tensors
+        if ctx.recompute:
+            fwd_inputs = list(ctx.saved_tensors)
+            (inp, inp2, wt, bias, gamma, beta) = fwd_inputs
+            (
+                _,
+                dout,
+                mean,
+                var,
+                dp_mask,
+            ) = torch.ops.torch_ipex.fused_dense_dropout_layernorm_fwd_unpad(
+                ctx.p, ctx.eps, fwd_inputs, True, ctx.wt_scale
+            )
+            inputs += [inp, wt, gamma, mean, var, dout, dp_mask]
+        else:
+            inputs += saved_activations(ctx)
+        fp8_wt = inputs[2].dtype in FP8_DTYPES
+        if fp8_wt:
+            # the fp8 weights are frozen, dequantized for the grad of the input
+            inputs[2] = inputs[2].to(inputs[1].dtype) * ctx.wt_scale
         (
             grad_inp,
             grad_inp2,
@@ -457,12 +615,15 @@ class BertOutputBaseFunction(torch.autograd.Function):
             grad_beta,
         ) = torch.ops.torch_ipex.fused_dense_dropout_layernorm_bwd_unpad(ctx.p, inputs)
         return (
+            None,
+            None,
+            None,
             None,
             None,
             None,
             grad_inp,
             grad_inp2,
-            grad_wt,
+            None if fp8_wt else grad_wt,
             grad_bias,
             grad_gamma,
             grad_beta,
@@ -496,6 +657,8 @@ class BertOutputBase(BlockedModule):
             self.LayerNorm.weight.set_blocking_param((None, None, torch.bfloat16))
             self.LayerNorm.bias.set_blocking_param((None, None, torch.bfloat16))
         self.use_bf16 = layer_use_bf16
+        self.activation_policy = "keep"
+        self.activation_compress_dtype = torch.bfloat16
         # print(f"config.hidden_size = {config.hidden_size}, ifm = {ifm}, p = {config.hidden_dropout_prob}, eps = {config.layer_norm_eps}")
 
     def maybe_block_params(self):
@@ -518,10 +681,13 @@ class BertOutputBase(BlockedModule):
             [None, self.attention_head_size],
         )
 
+        weight, wt_scale = self.dense.weight, 1.0
+        if hasattr(self.dense, "fp8_weight"):
+            weight, wt_scale = self.dense.fp8_weight, self.dense.fp8_scale
         inputs = [
             hidden_states,
             input_tensor,
-            self.dense.weight,
+            weight,
             self.dense.bias,
             self.LayerNorm.weight,
             self.LayerNorm.bias,
@@ -529,10 +695,20 @@ class BertOutputBase(BlockedModule):
         p = self.hidden_dropout_prob if self.training else 0.0
         if self.use_bf16:
             inputs = [
-                i.to(torch.bfloat16) if i.is_floating_point() else i for i in inputs
+                i.to(torch.bfloat16)
+                if i.is_floating_point() and i.dtype not in FP8_DTYPES
+                else i
+                for i in inputs
             ]
+        policy = self.activation_policy if self.training else "keep"
         ret = BertOutputBaseFunction.apply(
-            p, self.layer_norm_eps, self.training, *inputs
+            p,
+            self.layer_norm_eps,
+            self.training,
+            wt_scale,
+            policy,
+            self.activation_compress_dtype,
+            *inputs
         )
         # ret = ret.to(hidden_states.dtype)
         ret = BlockedTensor(ret, self.blocked_input_signature, orig_hidden_states.dtype)
@@ -555,23 +731,62 @@ class BertOutput(BertOutputBase):
 
 class BertIntermediateFunction(torch.autograd.Function):
     @staticmethod
-    def forward(ctx, input, weight, bias, act, training):
+    def forward(
+        ctx,
+        input,
+        weight,
+        bias,
+        act,
+        training,
+        wt_scale=1.0,
+        policy="keep",
+        compress_dtype=None,
+    ):
         # assert act == "gelu_new", "%s activation type is not supported" % act
         gelu_in, output = torch.ops.torch_ipex.fused_dense_gelu_fwd_unpad(
-            input, weight, bias, training
+            input, weight, bias, training, wt_scale
         )
-        ctx.save_for_backward(input, weight, gelu_in)
+        ctx.recompute = policy == "recompute"
+        if ctx.recompute:
+            ctx.save_for_backward(input, weight, bias)
+        else:
+            save_activations(
+                ctx,
+                [input, weight, gelu_in],
+                [0, 2] if policy != "keep" else [],
+                compress_dtype,
+            )
         ctx.act = act
+        ctx.wt_scale = wt_scale
         return output
 
     @staticmethod
     def backward(ctx, grad_out):
-        (input, weight, gelu_in) = ctx.saved_tensors
+        if ctx.recompute:
+            (input, weight, bias) = ctx.saved_tensors
+            gelu_in, _ = torch.ops.torch_ipex.fused_dense_gelu_fwd_unpad(
+                input, weight, bias, True, ctx.wt_scale
+            )
+        else:
+            (input, weight, gelu_in) = saved_activations(ctx)
         grad_out = grad_out.contiguous()
+        fp8_wt = weight.dtype in FP8_DTYPES
+        if fp8_wt:
+            # the fp8 weights are frozen, dequantized for the grad of the input
+            weight = weight.to(input.dtype) * ctx.wt_scale
         grad_inp, grad_wt, grad_bias = torch.ops.torch_ipex.fused_dense_gelu_bwd_unpad(
             grad_out, gelu_in, input, weight
         )
-        return (grad_inp, grad_wt, grad_bias, None, None)
+        return (
+            grad_inp,
+            None if fp8_wt else grad_wt,
+            grad_bias,
+            None,
+            None,
+            None,
+            None,
+            None,
+        )
 
 
 class BertIntermediate(BlockedModule):
@@ -599,6 +814,8 @@ class BertIntermediate(BlockedModule):
             self.dense.bias.set_blocking_param((None, None, torch.bfloat16))
 
         self.use_bf16 = True if layer_use_bf16 else False
+        self.activation_policy = "keep"
+        self.activation_compress_dtype = torch.bfloat16
         # if isinstance(config.hidden_act, str):
         #     self.intermediate_act_fn = ACT2FN[config.hidden_act]
         # else:
@@ -616,12 +833,26 @@ class BertIntermediate(BlockedModule):
             self.blocked_input_signature,
             [None, self.attention_head_size],
         )
-        inputs = [hidden_states, self.dense.weight, self.dense.bias]
+        weight, wt_scale = self.dense.weight, 1.0
+        if hasattr(self.dense, "fp8_weight"):
+            weight, wt_scale = self.dense.fp8_weight, self.dense.fp8_scale
+        inputs = [hidden_states, weight, self.dense.bias]
         if self.use_bf16:
             inputs = [
-                i.to(torch.bfloat16) if i.is_floating_point() else i for i in inputs
+                i.to(torch.bfloat16)
+                if i.is_floating_point() and i.dtype not in FP8_DTYPES
+                else i
+                for i in inputs
             ]
-        ret = BertIntermediateFunction.apply(*inputs, self.hidden_act, self.training)
+        policy = self.activation_policy if self.training else "keep"
+        ret = BertIntermediateFunction.apply(
+            *inputs,
+            self.hidden_act,
+            self.training,
+            wt_scale,
+            policy,
+            self.activation_compress_dtype
+        )
         # ret = ret.to(hidden_states.dtype)
         hidden_states = BlockedTensor(
             ret, self.blocked_input_signature, orig_hidden_states.dtype
@@ -678,6 +909,58 @@ class BertEmbeddingsFunction(torch.autograd.Function):
         return (None, None, None, None, None) + grad_inps
 
 
+def fused_embedding_layernorm(
+    input_ids,
+    word_embeddings,
+    layer_norm,
+    head_size,
+    position_ids=None,
+    position_embeddings=None,
+    token_type_ids=None,
+    token_type_embeddings=None,
+    pad_id=-1,
+    bf16_out=False,
+):
+    r"""
+    Inference of layer_norm(word + position + token type embeddings) of the
+    [B][S] ids, for the encoders which share the embedding front of BERT but
+    not its modules. The position and token type embeddings are optional (the
+    positions default to 0..S-1, the token types to 0) and the word embeddings
+    of pad_id are skipped. The output is [B][S][hidden], in bf16 when bf16_out
+    else in the dtype of layer_norm.
+    """
+    B, S = input_ids.shape
+    S1, S2 = BlockedModule.default_blocking_factors(S)
+    hidden = word_embeddings.weight.shape[1]
+    empty = torch.Tensor().to(layer_norm.weight.dtype)
+
+    def ids(t):
+        if t is None:
+            return torch.LongTensor()
+        return t.expand(B, S).contiguous().view(B, S1, S2)
+
+    def weight(m):
+        return empty if m is None else m.weight
+
+    inputs = [
+        ids(input_ids),
+        ids(position_ids),
+        ids(token_type_ids),
+        empty,
+        layer_norm.weight,
+        layer_norm.bias,
+        word_embeddings.weight,
+        weight(position_embeddings),
+        weight(token_type_embeddings),
+    ]
+    with torch.no_grad():
+        out = torch.ops.torch_ipex.fused_embedding_layernorm_fwd_infer(
+            layer_norm.eps, head_size, pad_id, inputs, bf16_out
+        )
+    # [B][S1][N][S2][H] -> [B][S][NH]
+    return out.permute(0, 1, 3, 2, 4).reshape(B, S, hidden)
+
+
 class BertEmbeddings(BlockedModule):
     """Construct the embeddings from word, position and token_type embeddings."""
 
@@ -784,14 +1067,23 @@ class BertEmbeddings(BlockedModule):
                 i.to(torch.bfloat16) if i.is_floating_point() else i for i in inputs
             ]
         inputs += emb_weighs
-        embeddings = BertEmbeddingsFunction.apply(
-            self.training,
-            p,
-            self.layer_norm_eps,
-            self.attention_head_size,
-            self.pad_token_id,
-            *inputs,
-        )
+        if not self.training and not torch.is_grad_enabled():
+            # no dropout rng and no statistics saved for the backward
+            embeddings = torch.ops.torch_ipex.fused_embedding_layernorm_fwd_infer(
+                self.layer_norm_eps,
+                self.attention_head_size,
+                self.pad_token_id,
+                inputs,
+            )
+        else:
+            embeddings = BertEmbeddingsFunction.apply(
+                self.training,
+                p,
+                self.layer_norm_eps,
+                self.attention_head_size,
+                self.pad_token_id,
+                *inputs,
+            )
         # embeddings = BlockedTensor(embeddings, self.blocked_embed_signature, torch.bfloat16 if self.use_bf16 else torch.float)
         embeddings = BlockedTensor(
             embeddings, self.blocked_embed_signature, torch.float
@@ -971,9 +1263,8 @@ class BertEncoder(nn.Module):
         self.layer = nn.ModuleList(
             [BertLayer(config) for _ in range(config.num_hidden_layers)]
         )
-        # self.blocked_input_signature = get_blocking_signature(
-        #    "SF", "SFSF"
-        # )
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+        self.blocked_embed_signature = get_blocking_signature("BSF", "BSFSF")
 
     def forward(
         self,
@@ -995,14 +1286,39 @@ class BertEncoder(nn.Module):
         )
 
         next_decoder_cache = () if use_cache else None
-        if hasattr(hidden_states, "unblocked_tensor"):
-            hidden_states = hidden_states.unblocked_tensor()
-        padded_shape = hidden_states.shape
-        # print_grad_hook(hidden_states, 'BertEncoder:hidden_states')
         msk, attention_mask, seq_offsets, seq_sqr_offsets = generate_mask(
             attention_mask
         )
-        hidden_states = UnpadInput.apply(hidden_states, msk)
+        # the blocks of S2 tokens of the embeddings are unpadded as a whole
+        # (the sequences are padded to multiples of S2), so that they flow
+        # blocked into the layers, the encoder output unblocked once
+        blocked_msk = None
+        if (
+            isinstance(hidden_states, BlockedTensor)
+            and hidden_states.get_signature() == self.blocked_embed_signature
+        ):
+            B, S1, N, S2, H = hidden_states.blocked_tensor().shape
+            if msk.shape[1] == S1 * S2 and [S1, S2] == (
+                BlockedModule.default_blocking_factors(S1 * S2)
+            ):
+                blocked_msk = msk.view(B * S1, S2)[:, 0].contiguous()
+        if blocked_msk is not None:
+            plain_dtype = hidden_states.get_plain_dtype()
+            padded_shape = hidden_states.blocked_tensor().shape
+            hidden_states = BlockedTensor(
+                UnpadInput.apply(
+                    hidden_states.blocked_tensor().view(B * S1, N, S2, H),
+                    blocked_msk,
+                ),
+                self.blocked_input_signature,
+                plain_dtype,
+            )
+        else:
+            if hasattr(hidden_states, "unblocked_tensor"):
+                hidden_states = hidden_states.unblocked_tensor()
+            padded_shape = hidden_states.shape
+            hidden_states = UnpadInput.apply(hidden_states, msk)
+        # print_grad_hook(hidden_states, 'BertEncoder:hidden_states')
 
         for i, layer_module in enumerate(self.layer):
             if output_hidden_states:
@@ -1060,9 +1376,22 @@ class BertEncoder(nn.Module):
         if output_hidden_states:
             all_hidden_states = all_hidden_states + (hidden_states,)
 
-        if hasattr(hidden_states, "unblocked_tensor"):
-            hidden_states = hidden_states.unblocked_tensor()
-        hidden_states = PadInput.apply(hidden_states, msk, padded_shape)
+        if blocked_msk is not None:
+            hidden_states = BlockedTensor(
+                PadInput.apply(
+                    BlockedModule.get_blocked_tensor(
+                        hidden_states, self.blocked_input_signature, [S2, H]
+                    ),
+                    blocked_msk,
+                    [B * S1, N, S2, H],
+                ).view(padded_shape),
+                self.blocked_embed_signature,
+                plain_dtype,
+            ).unblocked_tensor()
+        else:
+            if hasattr(hidden_states, "unblocked_tensor"):
+                hidden_states = hidden_states.unblocked_tensor()
+            hidden_states = PadInput.apply(hidden_states, msk, padded_shape)
         # print_grad_hook(hidden_states, 'BertEncoder:hidden_states')
 
         if not return_dict:
@@ -1085,6 +1414,32 @@ class BertEncoder(nn.Module):
             cross_attentions=all_cross_attentions,
         )
 
+    def forward_packed(
+        self, hidden_states, attention_mask, seq_offsets, seq_sqr_offsets, S2
+    ):
+        r"""
+        Inference over the packed stream of generate_packed_mask, the
+        hidden_states [T, H] blocked by S2 tokens, without any padded tensor.
+        """
+        assert not self.training, "forward_packed is inference only"
+        signature = get_blocking_signature("SF", "SFSF")
+        head_size = self.config.hidden_size // self.config.num_attention_heads
+        hidden_states = BlockedTensor(
+            BlockedModule.get_blocked_tensor(
+                hidden_states, signature, [S2, head_size]
+            ),
+            signature,
+            hidden_states.dtype,
+        )
+        for layer_module in self.layer:
+            hidden_states = layer_module(
+                hidden_states,
+                attention_mask,
+                seq_offsets=seq_offsets,
+                seq_sqr_offsets=seq_sqr_offsets,
+            )[0]
+        return hidden_states.unblocked_tensor()
+
 
 class BertPooler(nn.Module):
     def __init__(self, config):
@@ -1167,3 +1522,176 @@ def block(model):
     for m in model.modules():
         if hasattr(m, "maybe_block_params"):
             m.maybe_block_params()
+
+
+def quantize_fp8_weights(model, dtype=torch.float8_e4m3fn):
+    r"""
+    Quantizes the weights of the fused dense layers (BertIntermediate,
+    BertSelfOutput and BertOutput) of a bf16 model to fp8 with a per-tensor
+    scale. The fused kernels read the fp8 weights in place of the params,
+    half the bytes of bf16, and the params get no gradient from them.
+    """
+    assert dtype in FP8_DTYPES, "dtype should be one of %s" % (FP8_DTYPES,)
+    for m in model.modules():
+        if isinstance(m, (BertIntermediate, BertOutputBase)):
+            assert (
+                m.use_bf16 and USE_BF16_PARAMS
+            ), "fp8 weights need the bf16 layers and params"
+            m.maybe_block_params()
+            weight = m.dense.weight.data.float()
+            scale = weight.abs().max().clamp(min=1e-12) / torch.finfo(dtype).max
+            # the bf16 blocked (VNNI) layout of the weight is kept in fp8
+            m.dense.register_buffer(
+                "fp8_weight", (weight / scale).to(dtype), persistent=False
+            )
+            m.dense.fp8_scale = scale.item()
+
+
+def set_activation_policy(model, policy, compress_dtype=torch.bfloat16):
+    r"""
+    Sets what the fused modules of every BertLayer of the model save of their
+    activations for backward, policy being one of ACTIVATION_POLICIES or a
+    list of one per layer:
+
+    - "keep": all the activations, as by default.
+    - "compress": the float activations larger than compress_dtype are saved
+      in compress_dtype, e.g. torch.bfloat16 for fp32 training or
+      torch.float8_e5m2 (with a per-tensor scale) for bf16 training, and
+      restored before the backward kernels.
+    - "recompute": the inputs only, the activations being computed again by
+      the forward kernels before the backward kernels. The random dropout
+      masks can't be computed again, so the self attention and the output
+      layers with dropout fall back to "compress".
+    """
+    layers = [m for m in model.modules() if isinstance(m, BertLayer)]
+    policies = policy if isinstance(policy, (list, tuple)) else [policy] * len(layers)
+    assert len(policies) == len(layers), "%d policies for %d layers" % (
+        len(policies),
+        len(layers),
+    )
+    for layer, policy in zip(layers, policies):
+        assert policy in ACTIVATION_POLICIES, "unknown policy %s" % policy
+        for m in layer.modules():
+            if isinstance(m, (BertSelfAttention, BertOutputBase, BertIntermediate)):
+                m.activation_policy = policy
+                m.activation_compress_dtype = compress_dtype
+
+
+def plan_activation_policy(model, budget, *args, compress_dtype=torch.bfloat16, **kwargs):
+    r"""
+    Chooses the activation policy of every BertLayer of the training model so
+    that the activations saved for backward by model(*args, **kwargs) fit in
+    budget bytes, sets it with set_activation_policy and returns it. The
+    activations of a layer are measured for every policy by a forward that
+    doesn't keep them. The layers are compressed first, which costs a cast,
+    then recomputed, which costs their forward again, until the budget is met.
+    """
+    assert model.training, "the activation policy is for training"
+    layers = [m for m in model.modules() if isinstance(m, BertLayer)]
+    # the bytes saved by every layer, and by the rest of the model last
+    sizes = {}
+    current = [len(layers)]
+
+    def enter(idx):
+        def hook(module, inputs):
+            current[0] = idx
+
+        return hook
+
+    def leave(module, inputs, outputs):
+        current[0] = len(layers)
+
+    handles = []
+    for idx, layer in enumerate(layers):
+        handles.append(layer.register_forward_pre_hook(enter(idx)))
+        handles.append(layer.register_forward_hook(leave))
+    try:
+        for policy in ACTIVATION_POLICIES:
+            set_activation_policy(model, policy, compress_dtype)
+            saved = [0] * (len(layers) + 1)
+            # a storage saved twice is counted once, while it is alive
+            storages = {}
+
+            def pack(t):
+                if isinstance(t, torch.nn.Parameter):
+                    return None
+                storage = t.untyped_storage()
+                seen = storages.get(storage.data_ptr())
+                if seen is None or seen() is None:
+                    storages[storage.data_ptr()] = weakref.ref(t)
+                    saved[current[0]] += storage.nbytes()
+                # nothing is kept, there is no backward
+                return None
+
+            with torch.enable_grad(), torch.autograd.graph.saved_tensors_hooks(
+                pack, lambda t: t
+            ):
+                model(*args, **kwargs)
+            sizes[policy] = saved
+    finally:
+        for handle in handles:
+            handle.remove()
+
+    policies = ["keep"] * len(layers)
+    total = sum(sizes["keep"])
+    for policy in ACTIVATION_POLICIES[1:]:
+        for idx in range(len(layers)):
+            if total <= budget:
+                break
+            gain = sizes[policies[idx]][idx] - sizes[policy][idx]
+            if gain > 0:
+                total -= gain
+                policies[idx] = policy
+    if total > budget:
+        warnings.warn(
+            "The activations of %d bytes exceed the budget of %d bytes with all the layers recomputed"
+            % (total, budget)
+        )
+    set_activation_policy(model, policies, compress_dtype)
+    return policies
+
+
+def varlen_forward(model, input_ids, token_type_ids=None, block_size=32):
+    r"""
+    Inference of a batch of requests of variable lengths, input_ids (and
+    token_type_ids) being lists of 1D LongTensors. The requests are packed into
+    a single token stream, each one padded to a multiple of block_size tokens
+    only rather than all of them to the longest one, so that the fused kernels
+    run over the real tokens of the batch. block_size is the S2 blocking of
+    the kernels, which must be even with bf16.
+
+    Returns the last hidden states of the requests, a [len, hidden_size] tensor
+    each, and the pooled output [batch, hidden_size] (None without pooler).
+    """
+    bert = model.bert if hasattr(model, "bert") else model
+    assert isinstance(bert.encoder, BertEncoder), "not a fast_bert model"
+    assert not bert.training, "varlen_forward is inference only"
+    seq_lens = [ids.numel() for ids in input_ids]
+    if token_type_ids is None:
+        token_type_ids = [torch.zeros_like(ids) for ids in input_ids]
+    idx, attention_mask, seq_offsets, seq_sqr_offsets = generate_packed_mask(
+        seq_lens, block_size
+    )
+    T = attention_mask.numel()
+    packed_ids = torch.full([T], bert.config.pad_token_id, dtype=torch.long)
+    packed_ids[idx] = torch.cat([ids.view(-1) for ids in input_ids])
+    packed_types = torch.zeros([T], dtype=torch.long)
+    packed_types[idx] = torch.cat([t.view(-1) for t in token_type_ids])
+    position_ids = torch.zeros([T], dtype=torch.long)
+    position_ids[idx] = torch.cat([torch.arange(l) for l in seq_lens])
+    with torch.no_grad():
+        hidden_states = bert.embeddings(
+            input_ids=packed_ids.view(1, T),
+            token_type_ids=packed_types.view(1, T),
+            position_ids=position_ids.view(1, T),
+        )
+        hidden_states = hidden_states.unblocked_tensor().view(T, -1)
+        hidden_states = bert.encoder.forward_packed(
+            hidden_states, attention_mask, seq_offsets, seq_sqr_offsets, block_size
+        )
+        outputs = list(hidden_states[idx].split(seq_lens))
+        pooled_output = None
+        if getattr(bert, "pooler", None) is not None:
+            first_tokens = torch.stack([o[0] for o in outputs]).unsqueeze(1)
+            pooled_output = bert.pooler(first_tokens)
+    return outputs, pooled_output
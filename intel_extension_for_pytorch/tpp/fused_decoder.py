@@ -0,0 +1,400 @@
+import torch
+from torch import nn
+from .utils.blocked_layout import (
+    BlockedParameter,
+    BlockedModule,
+    BlockedTensor,
+    get_blocking_signature,
+)
+from .fused_bert import DummyLinear, PadInput, UnpadInput, generate_mask
+
+r"""
+Decoder-only (GPT / LLaMA style) transformer blocks on the TPP fused kernels:
+RMSNorm, causal self-attention with rotary embedding and SwiGLU MLP, on the
+blocked and unpadded layout of fused_bert. The params follow the names of the
+HuggingFace LLaMA decoder, so that its state_dict can be loaded.
+"""
+
+USE_BF16_PARAMS = True
+layer_use_bf16 = False
+
+
+def _set_weight_blocking(weight, head_size):
+    weight.set_blocking_param(([head_size, head_size], [0, 2, 3, 1],))
+    if layer_use_bf16 == True and USE_BF16_PARAMS:
+        weight.set_blocking_param(
+            (
+                [head_size, [head_size // 2, 2]],
+                [0, 2, 3, 1, 4],
+                torch.bfloat16,
+            )
+        )
+
+
+class RMSNormFunction(torch.autograd.Function):
+    @staticmethod
+    def forward(ctx, eps, input, weight):
+        out, rstd = torch.ops.torch_ipex.fused_rmsnorm_fwd_unpad(eps, input, weight)
+        ctx.save_for_backward(input, weight, rstd)
+        return out
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        (input, weight, rstd) = ctx.saved_tensors
+        grad_out = grad_out.contiguous()
+        grad_inp, grad_wt = torch.ops.torch_ipex.fused_rmsnorm_bwd_unpad(
+            grad_out, input, weight, rstd
+        )
+        return (None, grad_inp, grad_wt)
+
+
+class CausalSelfAttentionFunction(torch.autograd.Function):
+    @staticmethod
+    def forward(ctx, p, training, *inputs):
+        (
+            context_layer,
+            attention_probs_out,
+            hs_t,
+            ehs_t,
+            ql_t,
+            kl_tv,
+            vl_tv,
+            ap,
+            apd_t,
+            ap_dp_mask,
+        ) = torch.ops.torch_ipex.fused_causal_self_attention_fwd_unpad(p, inputs, training)
+        (qw, qb, kw, kb, vw, vb, hs, am, hm, ehs, eam, offs, offs2, cos, sin) = inputs
+        ctx.save_for_backward(
+            qw,
+            kw,
+            vw,
+            hs_t,
+            hm,
+            ehs_t,
+            ql_t,
+            kl_tv,
+            vl_tv,
+            ap,
+            apd_t,
+            ap_dp_mask,
+            offs,
+            offs2,
+            cos,
+            sin,
+        )
+        ctx.p = p
+        return context_layer
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        # the backward is the one of the BERT self-attention, the masked
+        # probabilities being zero
+        inputs = [grad_out.contiguous(), grad_out.new_empty(0)]
+        inputs += ctx.saved_tensors
+        (
+            dqw,
+            dqb,
+            dkw,
+            dkb,
+            dvw,
+            dvb,
+            dhs,
+            dehs,
+        ) = torch.ops.torch_ipex.fused_self_attention_bwd_unpad(ctx.p, inputs)
+        return (None, None, dqw, None, dkw, None, dvw, None, dhs) + (None,) * 8
+
+
+class DenseResidualFunction(torch.autograd.Function):
+    @staticmethod
+    def forward(ctx, input, residual, weight):
+        out = torch.ops.torch_ipex.fused_dense_residual_fwd_unpad(input, residual, weight)
+        ctx.save_for_backward(input, weight)
+        return out
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        (input, weight) = ctx.saved_tensors
+        grad_out = grad_out.contiguous()
+        grad_inp, grad_wt = torch.ops.torch_ipex.fused_dense_residual_bwd_unpad(
+            grad_out, input, weight
+        )
+        return (grad_inp, grad_out, grad_wt)
+
+
+class SwiGLUFunction(torch.autograd.Function):
+    @staticmethod
+    def forward(ctx, input, wt_gate, wt_up):
+        out, gate, up = torch.ops.torch_ipex.fused_dense_swiglu_fwd_unpad(
+            input, wt_gate, wt_up
+        )
+        ctx.save_for_backward(input, wt_gate, wt_up, gate, up)
+        return out
+
+    @staticmethod
+    def backward(ctx, grad_out):
+        (input, wt_gate, wt_up, gate, up) = ctx.saved_tensors
+        grad_out = grad_out.contiguous()
+        grad_inp, grad_wt_gate, grad_wt_up = torch.ops.torch_ipex.fused_dense_swiglu_bwd_unpad(
+            grad_out, gate, up, input, wt_gate, wt_up
+        )
+        return (grad_inp, grad_wt_gate, grad_wt_up)
+
+
+class RMSNorm(BlockedModule):
+    def __init__(self, config):
+        super().__init__()
+        self.weight = BlockedParameter(torch.ones(config.hidden_size))
+        self.variance_epsilon = config.rms_norm_eps
+        self.attention_head_size = config.hidden_size // config.num_attention_heads
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+        if layer_use_bf16 == True and USE_BF16_PARAMS:
+            self.weight.set_blocking_param((None, None, torch.bfloat16))
+        self.use_bf16 = layer_use_bf16
+
+    def maybe_block_params(self):
+        self.weight.block()
+
+    def forward(self, hidden_states):
+        self.maybe_block_params()
+        orig_hidden_states = hidden_states
+        hidden_states = self.get_blocked_tensor(
+            hidden_states,
+            self.blocked_input_signature,
+            [None, self.attention_head_size],
+        )
+        inputs = [hidden_states, self.weight]
+        if self.use_bf16:
+            inputs = [i.to(torch.bfloat16) for i in inputs]
+        ret = RMSNormFunction.apply(self.variance_epsilon, *inputs)
+        return BlockedTensor(ret, self.blocked_input_signature, orig_hidden_states.dtype)
+
+
+class DecoderSelfAttention(BlockedModule):
+    r"""Causal self-attention with rotary embedding, the output projection
+    adding the residual"""
+
+    def __init__(self, config):
+        super().__init__()
+        if config.hidden_size % config.num_attention_heads != 0:
+            raise ValueError(
+                "The hidden size (%d) is not a multiple of the number of attention "
+                "heads (%d)" % (config.hidden_size, config.num_attention_heads)
+            )
+        self.num_attention_heads = config.num_attention_heads  # N
+        self.attention_head_size = config.hidden_size // config.num_attention_heads  # H
+        self.all_head_size = self.num_attention_heads * self.attention_head_size  # NH
+        self.attention_dropout = getattr(config, "attention_dropout", 0.0)
+
+        self.q_proj = DummyLinear(config.hidden_size, self.all_head_size, bias=False)
+        self.k_proj = DummyLinear(config.hidden_size, self.all_head_size, bias=False)
+        self.v_proj = DummyLinear(config.hidden_size, self.all_head_size, bias=False)
+        self.o_proj = DummyLinear(self.all_head_size, config.hidden_size, bias=False)
+        for proj in [self.q_proj, self.k_proj, self.v_proj, self.o_proj]:
+            _set_weight_blocking(proj.weight, self.attention_head_size)
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+        self.use_bf16 = layer_use_bf16
+
+    def maybe_block_params(self):
+        self.q_proj.weight.block()
+        self.k_proj.weight.block()
+        self.v_proj.weight.block()
+        self.o_proj.weight.block()
+
+    def forward(
+        self,
+        hidden_states,
+        residual,
+        attention_mask,
+        seq_offsets,
+        seq_sqr_offsets,
+        cos,
+        sin,
+    ):
+        self.maybe_block_params()
+        orig_hidden_states = hidden_states
+        hidden_states = self.get_blocked_tensor(
+            hidden_states,
+            self.blocked_input_signature,
+            [None, self.attention_head_size],
+        )
+        residual = self.get_blocked_tensor(
+            residual,
+            self.blocked_input_signature,
+            [None, self.attention_head_size],
+        )
+        # the fused kernel has the biases of BERT, zero here
+        bias = hidden_states.new_zeros(self.all_head_size)
+        inputs = [
+            self.q_proj.weight,
+            bias,
+            self.k_proj.weight,
+            bias,
+            self.v_proj.weight,
+            bias,
+            hidden_states,
+            attention_mask.contiguous(),
+            torch.Tensor(),
+            torch.Tensor(),
+            torch.Tensor(),
+            seq_offsets,
+            seq_sqr_offsets,
+        ]
+        p = self.attention_dropout if self.training else 0.0
+        if self.use_bf16:
+            inputs = [
+                i.to(torch.bfloat16) if i.is_floating_point() else i for i in inputs
+            ]
+        # the rotary embedding stays in fp32
+        context_layer = CausalSelfAttentionFunction.apply(
+            p, self.training, *inputs, cos, sin
+        )
+        inputs = [context_layer, residual, self.o_proj.weight]
+        if self.use_bf16:
+            inputs = [i.to(torch.bfloat16) for i in inputs]
+        ret = DenseResidualFunction.apply(*inputs)
+        return BlockedTensor(ret, self.blocked_input_signature, orig_hidden_states.dtype)
+
+
+class DecoderMLP(BlockedModule):
+    r"""SwiGLU MLP, down_proj(silu(gate_proj(x)) * up_proj(x)) + residual"""
+
+    def __init__(self, config):
+        super().__init__()
+        self.attention_head_size = config.hidden_size // config.num_attention_heads
+        assert config.intermediate_size % self.attention_head_size == 0, (
+            "The intermediate size (%d) is not a multiple of the head size (%d)"
+            % (config.intermediate_size, self.attention_head_size)
+        )
+        self.gate_proj = DummyLinear(config.hidden_size, config.intermediate_size, bias=False)
+        self.up_proj = DummyLinear(config.hidden_size, config.intermediate_size, bias=False)
+        self.down_proj = DummyLinear(config.intermediate_size, config.hidden_size, bias=False)
+        for proj in [self.gate_proj, self.up_proj, self.down_proj]:
+            _set_weight_blocking(proj.weight, self.attention_head_size)
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+        self.use_bf16 = layer_use_bf16
+
+    def maybe_block_params(self):
+        self.gate_proj.weight.block()
+        self.up_proj.weight.block()
+        self.down_proj.weight.block()
+
+    def forward(self, hidden_states, residual):
+        self.maybe_block_params()
+        orig_hidden_states = hidden_states
+        hidden_states = self.get_blocked_tensor(
+            hidden_states,
+            self.blocked_input_signature,
+            [None, self.attention_head_size],
+        )
+        residual = self.get_blocked_tensor(
+            residual,
+            self.blocked_input_signature,
+            [None, self.attention_head_size],
+        )
+        inputs = [hidden_states, self.gate_proj.weight, self.up_proj.weight]
+        if self.use_bf16:
+            inputs = [i.to(torch.bfloat16) for i in inputs]
+        intermediate = SwiGLUFunction.apply(*inputs)
+        inputs = [intermediate, residual, self.down_proj.weight]
+        if self.use_bf16:
+            inputs = [i.to(torch.bfloat16) for i in inputs]
+        ret = DenseResidualFunction.apply(*inputs)
+        return BlockedTensor(ret, self.blocked_input_signature, orig_hidden_states.dtype)
+
+
+class DecoderLayer(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.self_attn = DecoderSelfAttention(config)
+        self.mlp = DecoderMLP(config)
+        self.input_layernorm = RMSNorm(config)
+        self.post_attention_layernorm = RMSNorm(config)
+
+    def forward(
+        self,
+        hidden_states,
+        attention_mask,
+        seq_offsets,
+        seq_sqr_offsets,
+        cos,
+        sin,
+    ):
+        hidden_states = self.self_attn(
+            self.input_layernorm(hidden_states),
+            hidden_states,
+            attention_mask,
+            seq_offsets,
+            seq_sqr_offsets,
+            cos,
+            sin,
+        )
+        return self.mlp(self.post_attention_layernorm(hidden_states), hidden_states)
+
+
+class Decoder(nn.Module):
+    r"""
+    The decoder layers and the final norm of a LLaMA style model, from the
+    embeddings of the tokens to the last hidden states.
+
+    Args:
+        config: The model config, with hidden_size, num_attention_heads,
+            intermediate_size, num_hidden_layers, rms_norm_eps and optionally
+            rope_theta (10000) and attention_dropout (0).
+    """
+
+    def __init__(self, config):
+        super().__init__()
+        self.config = config
+        self.layers = nn.ModuleList(
+            [DecoderLayer(config) for _ in range(config.num_hidden_layers)]
+        )
+        self.norm = RMSNorm(config)
+        self.attention_head_size = config.hidden_size // config.num_attention_heads
+        rope_theta = getattr(config, "rope_theta", 10000.0)
+        inv_freq = 1.0 / (
+            rope_theta
+            ** (torch.arange(0, self.attention_head_size, 2).float() / self.attention_head_size)
+        )
+        self.register_buffer("inv_freq", inv_freq, persistent=False)
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+
+    def forward(self, hidden_states, attention_mask):
+        r"""
+        hidden_states: [B][S][hidden_size] embeddings of the tokens
+        attention_mask: [B][1][1][S] additive mask of the padding at the end of
+            the sequences, 0 for the tokens and -10000 for the padding
+        """
+        B, S, _ = hidden_states.shape
+        padded_shape = hidden_states.shape
+        msk, attention_mask, seq_offsets, seq_sqr_offsets = generate_mask(
+            attention_mask
+        )
+        hidden_states = UnpadInput.apply(hidden_states, msk)
+        # block the unpadded tokens by the blocks of generate_mask
+        _, S2 = BlockedModule.default_blocking_factors(S)
+        position_ids = torch.arange(S).expand([B, -1])[msk]
+        freqs = torch.outer(position_ids.float(), self.inv_freq)
+        emb = torch.cat([freqs, freqs], dim=-1).view([-1, S2, self.attention_head_size])
+        cos = emb.cos().contiguous()
+        sin = emb.sin().contiguous()
+        orig_dtype = hidden_states.dtype
+        hidden_states = BlockedTensor(
+            BlockedModule.get_blocked_tensor(
+                hidden_states,
+                self.blocked_input_signature,
+                [S2, self.attention_head_size],
+            ),
+            self.blocked_input_signature,
+            orig_dtype,
+        )
+        for layer in self.layers:
+            hidden_states = layer(
+                hidden_states,
+                attention_mask,
+                seq_offsets,
+                seq_sqr_offsets,
+                cos,
+                sin,
+            )
+        hidden_states = self.norm(hidden_states).unblocked_tensor()
+        return PadInput.apply(hidden_states, msk, padded_shape)
@@ -0,0 +1,189 @@
+import torch
+from torch import nn
+import torch.nn.functional as F
+from .fused_bert import BertIntermediateFunction, BertOutputBaseFunction
+
+r"""
+The TPP fused dense kernels of fused_bert for any MLP: the Linear + GELU and
+Linear (+ Dropout) + LayerNorm runs of the nn.Sequential of a model are swapped
+for fused blocks by fuse_mlp. The fused blocks keep the params of the modules
+they replace (and their state_dict keys), in the plain layout, and block them
+on the fly, so that the optimizer of the model is unchanged.
+"""
+
+BLOCK_SIZES = [64, 32, 16]
+# the tokens are padded to a multiple of S2 for the blocked layout
+S2 = 32
+
+
+def block_size(linear):
+    r"""The block size of the features of linear, None if unsupported"""
+    for bs in BLOCK_SIZES:
+        if linear.in_features % bs == 0 and linear.out_features % bs == 0:
+            return bs
+    return None
+
+
+def _compute_dtype(input):
+    if torch.is_autocast_cpu_enabled():
+        if torch.get_autocast_cpu_dtype() == torch.bfloat16:
+            return torch.bfloat16
+    return torch.bfloat16 if input.dtype == torch.bfloat16 else torch.float
+
+
+def _block_weight(weight, bs, dtype):
+    Nk, Nc = weight.shape[0] // bs, weight.shape[1] // bs
+    weight = weight.to(dtype)
+    if dtype == torch.bfloat16:
+        # VNNI [Nk][Nc][Hc/2][Hk][2]
+        return (
+            weight.view(Nk, bs, Nc, bs // 2, 2).permute(0, 2, 3, 1, 4).contiguous()
+        )
+    return weight.view(Nk, bs, Nc, bs).permute(0, 2, 3, 1).contiguous()
+
+
+def _block_input(input, bs, dtype):
+    # [..., K] -> [S1][Nc][S2][Hc], the tokens padded with zeros
+    K = input.shape[-1]
+    input = input.reshape(-1, K).to(dtype)
+    T = input.shape[0]
+    input = F.pad(input, (0, 0, 0, (S2 - T % S2) % S2))
+    return input.view(-1, S2, K // bs, bs).permute(0, 2, 1, 3).contiguous(), T
+
+
+def _unblock_output(output, T, shape):
+    S1, Nk, _, Hk = output.shape
+    output = output.permute(0, 2, 1, 3).reshape(S1 * S2, Nk * Hk)
+    return output[:T].view(list(shape[:-1]) + [Nk * Hk])
+
+
+class FusedAway(nn.Module):
+    r"""
+    Identity in place of a module fused into a previous one, keeping its params
+    """
+
+    def __init__(self, module):
+        super().__init__()
+        for name, param in module.named_parameters(recurse=False):
+            self.register_parameter(name, param)
+
+    def forward(self, input):
+        return input
+
+
+class FusedDenseGELU(nn.Module):
+    r"""gelu(linear(input)) of the params of linear"""
+
+    def __init__(self, linear):
+        super().__init__()
+        self.block_size = block_size(linear)
+        assert self.block_size is not None, "unsupported features %d -> %d" % (
+            linear.in_features,
+            linear.out_features,
+        )
+        self.weight = linear.weight
+        self.bias = linear.bias
+
+    def forward(self, input):
+        dtype = _compute_dtype(input)
+        bs = self.block_size
+        inp, T = _block_input(input, bs, dtype)
+        bias = self.bias
+        if bias is None:
+            bias = self.weight.new_zeros(self.weight.shape[0])
+        ret = BertIntermediateFunction.apply(
+            inp,
+            _block_weight(self.weight, bs, dtype),
+            bias.to(dtype),
+            "gelu",
+            self.training,
+            1.0,
+        )
+        return _unblock_output(ret, T, input.shape)
+
+
+class FusedDenseDropoutLayerNorm(nn.Module):
+    r"""
+    layer_norm(dropout(linear(input))) of the params of linear and layer_norm,
+    which stay in the module of layer_norm (a FusedAway once fused)
+    """
+
+    def __init__(self, linear, p, layer_norm):
+        super().__init__()
+        self.block_size = block_size(linear)
+        assert self.block_size is not None, "unsupported features %d -> %d" % (
+            linear.in_features,
+            linear.out_features,
+        )
+        self.weight = linear.weight
+        self.bias = linear.bias
+        self.p = p
+        self.eps = layer_norm.eps
+        # not registered, the params belong to the module of layer_norm
+        self.layer_norm_params = (layer_norm.weight, layer_norm.bias)
+
+    def forward(self, input):
+        dtype = _compute_dtype(input)
+        bs = self.block_size
+        inp, T = _block_input(input, bs, dtype)
+        gamma, beta = self.layer_norm_params
+        bias = self.bias
+        if bias is None:
+            bias = self.weight.new_zeros(self.weight.shape[0])
+        inputs = [
+            inp,
+            # no residual
+            torch.Tensor().to(dtype),
+            _block_weight(self.weight, bs, dtype),
+            bias.to(dtype),
+            gamma.to(dtype),
+            beta.to(dtype),
+        ]
+        p = self.p if self.training else 0.0
+        ret = BertOutputBaseFunction.apply(p, self.eps, self.training, 1.0, "keep", None, *inputs)
+        return _unblock_output(ret, T, input.shape)
+
+
+def _fusable_layer_norm(module, linear):
+    return (
+        type(module) is nn.LayerNorm
+        and module.elementwise_affine
+        and tuple(module.normalized_shape) == (linear.out_features,)
+    )
+
+
+def fuse_mlp(model):
+    r"""
+    Swaps the nn.Linear + nn.GELU and nn.Linear (+ nn.Dropout) + nn.LayerNorm
+    runs of the nn.Sequential of model for the fused blocks, in place. The
+    fused away modules are replaced by FusedAway, with their params.
+    """
+    sequentials = [m for m in model.modules() if isinstance(m, nn.Sequential)]
+    for seq in sequentials:
+        children = list(seq._modules.items())
+        i = 0
+        while i < len(children):
+            name, linear = children[i]
+            if type(linear) is not nn.Linear or block_size(linear) is None:
+                i += 1
+                continue
+            j = i + 1
+            nxt = children[j][1] if j < len(children) else None
+            if type(nxt) is nn.GELU and getattr(nxt, "approximate", "none") == "none":
+                seq._modules[name] = FusedDenseGELU(linear)
+                seq._modules[children[j][0]] = FusedAway(nxt)
+                i = j + 1
+                continue
+            p = 0.0
+            if type(nxt) is nn.Dropout:
+                p = nxt.p
+                j += 1
+            if j < len(children) and _fusable_layer_norm(children[j][1], linear):
+                layer_norm = children[j][1]
+                seq._modules[name] = FusedDenseDropoutLayerNorm(linear, p, layer_norm)
+                for k in range(i + 1, j + 1):
+                    seq._modules[children[k][0]] = FusedAway(children[k][1])
+                i = j + 1
+                continue
+            i += 1
+    return model
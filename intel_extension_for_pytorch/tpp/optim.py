@@ -4,6 +4,7 @@ import torch
 from torch.optim import Optimizer
 from torch.optim.optimizer import required
 import intel_extension_for_pytorch._C as ipex_cpp
+from intel_extension_for_pytorch.cpu import comm
 
 
 class SGD(Optimizer):
@@ -117,6 +118,10 @@ class AdamW(Optimizer):
             Decoupled weight decay to apply.
         correct_bias (:obj:`bool`, `optional`, defaults to `True`):
             Whether ot not to correct bias in Adam (for instance, in Bert TF repository they use :obj:`False`).
+        max_grad_norm (:obj:`float`, `optional`, defaults to `None`):
+            Clip the gradients to this global 2-norm inside the step, the clip coefficient being applied
+            by the fused update instead of a separate pass over the gradients. The norm of the step is
+            kept in ``grad_norm``.
     """
 
     def __init__(
@@ -127,6 +132,7 @@ class AdamW(Optimizer):
         eps: float = 1e-6,
         weight_decay: float = 0.0,
         correct_bias: bool = True,
+        max_grad_norm: float = None,
     ):
         if lr < 0.0:
             raise ValueError("Invalid learning rate: {} - should be >= 0.0".format(lr))
@@ -147,6 +153,8 @@ class AdamW(Optimizer):
             weight_decay=weight_decay,
             correct_bias=correct_bias,
         )
+        self.max_grad_norm = max_grad_norm
+        self.grad_norm = None
         super().__init__(params, defaults)
 
     def step(self, closure: Callable = None):
@@ -160,6 +168,12 @@ class AdamW(Optimizer):
         if closure is not None:
             loss = closure()
 
+        grad_scale = 1.0
+        if self.max_grad_norm is not None:
+            grads = [p.grad.data.contiguous() for group in self.param_groups
+                     for p in group["params"] if p.grad is not None]
+            self.grad_norm, grad_scale = _fused_clip_scale(grads, self.max_grad_norm)
+
         for group in self.param_groups:
             for p in group["params"]:
                 if p.grad is None:
@@ -239,6 +253,7 @@ class AdamW(Optimizer):
                         group["lr"],
                         group["weight_decay"],
                         group["eps"],
+                        grad_scale,
                     )
                 else:
                     ipex_cpp.tpp_fused_adamw(
@@ -252,6 +267,7 @@ class AdamW(Optimizer):
                         group["lr"],
                         group["weight_decay"],
                         group["eps"],
+                        grad_scale,
                     )
                     if hasattr(torch, "bfloat8") and p.data.dtype == torch.bfloat8:
                         p.data.copy_(state["master_copy"].to(torch.bfloat8))
@@ -259,6 +275,15 @@ class AdamW(Optimizer):
         return loss
 
 
+def _fused_clip_scale(grads, max_grad_norm):
+    r"""Returns the global 2-norm of the grads, in one parallel reduction pass,
+    and the clip coefficient the fused steps apply to the grads on the fly, so
+    that the grads are read once more by the update only.
+    """
+    total_norm = ipex_cpp.tpp_grad_norm(grads)
+    return torch.tensor(total_norm), min(1.0, max_grad_norm / (total_norm + 1e-6))
+
+
 def clip_grad_norm_(parameters, max_norm, norm_type=2, grad_list=False):
     r"""Clips gradient norm of an iterable of parameters.
 
@@ -493,6 +518,10 @@ class DistLamb(Optimizer):
         weight_decay (float, optional): weight decay (L2 penalty) (default: 0)
         adam (bool, optional): always use trust ratio = 1, which turns this into
             Adam. Useful for comparison purposes.
+        max_grad_norm (float, optional): clip the gradients to this global
+            2-norm inside the step, the clip coefficient being applied by the
+            fused update instead of a separate pass over the gradients. The
+            norm of the step is kept in ``grad_norm`` (default: None)
 
     .. _Large Batch Optimization for Deep Learning: Training BERT in 76 minutes:
         https://arxiv.org/abs/1904.00962
@@ -510,6 +539,7 @@ class DistLamb(Optimizer):
         block_size=1024,
         perform_allreduce=False,
         fused_param_norm=True,
+        max_grad_norm=None,
     ):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
@@ -529,6 +559,8 @@ class DistLamb(Optimizer):
             and torch.distributed.get_world_size() > 1
         )
         self.fused_param_norm = fused_param_norm
+        self.max_grad_norm = max_grad_norm
+        self.grad_norm = None
         self._acc_steps = 0
         self._one_time_setup_done = False
         super(DistLamb, self).__init__(params, defaults)
@@ -643,7 +675,7 @@ class DistLamb(Optimizer):
             for fp in self.flat_params:
                 fp._flat_g.div_(world_size)
                 # if torch.distributed.get_rank() == 0: print(f"{fp._flat_g.dtype} - {fp._flat_g.shape}")
-                torch.distributed.all_reduce(fp._flat_g)
+                comm.all_reduce(fp._flat_g)
                 # splts = fp._flat_g.split(2*1024*1024)
                 # for s in splts:
                 #    torch.distributed.all_reduce(s)
@@ -651,7 +683,7 @@ class DistLamb(Optimizer):
             for group in self.param_groups:
                 for p in group["params"]:
                     p.grad.data.div_(world_size)
-                    torch.distributed.all_reduce(p.grad.data)
+                    comm.all_reduce(p.grad.data)
 
     def acc_and_zero_grad(self):
         self._one_time_setup()
@@ -703,6 +735,11 @@ class DistLamb(Optimizer):
         if self.perform_allreduce:
             self.sync_grads()
 
+        grad_scale = 1.0
+        if self.max_grad_norm is not None:
+            self.grad_norm, grad_scale = _fused_clip_scale(
+                [fp._flat_g for fp in self.flat_params], self.max_grad_norm)
+
         for ii, fp in enumerate(self.flat_params):
             group = fp.group
             beta1, beta2 = group["betas"]
@@ -729,6 +766,7 @@ class DistLamb(Optimizer):
                 fp.block_size,
                 self._step,
                 self.fused_param_norm,
+                grad_scale,
             )
             # if weight_decay > 0.0 and torch.distributed.get_rank() < 2: print(f"wn: {fp._weight_norms[:5].sqrt()}  un: {fp._update_norms[:5].sqrt()}")
             # if weight_decay > 0.0: print(f"XXX {self._step:3d} NORM {ii}: wn: {fp._weight_norms[0].sqrt().item():.10f}  un: {fp._update_norms[0].sqrt().item():.10f}")
@@ -0,0 +1,102 @@
+from contextlib import contextmanager
+import intel_extension_for_pytorch._C as ipex_cpp
+
+r"""
+The per-thread TPP timers of the fused kernels, by scope (the RECORD_SCOPE of
+the kernels, e.g. "i_gemm") or by pass (FWD, BWD, ...) and by TPP type
+(BRGEMM, XPOSE, SOFTMAX, LYR_NRM, ...), with the BRGEMM flops and the operand
+bytes of the TPPs which report them.
+"""
+
+
+def get_timers(passes=False):
+    r"""
+    The timers of the scopes (or of the passes) as a list of dicts:
+        name: the scope
+        time: the time of the scope on the master thread, in seconds
+        threads: per thread, the seconds by TPP type
+        flops: per thread, the BRGEMM flops
+        bytes: per thread, the operand bytes by TPP type
+    """
+    names = ipex_cpp.tpp_debug_timer_names()
+    timers = []
+    for name, time, times, flops, nbytes in ipex_cpp.tpp_debug_timers(passes):
+        timers.append(
+            {
+                "name": name,
+                "time": time,
+                "threads": [dict(zip(names, t)) for t in times],
+                "flops": flops,
+                "bytes": [dict(zip(names, b)) for b in nbytes],
+            }
+        )
+    return timers
+
+
+def reset_timers():
+    ipex_cpp.tpp_reset_debug_timers()
+
+
+def timer_table(passes=False):
+    r"""
+    A row per scope and TPP type which ran: the max and the mean over the
+    threads of its time, the thread imbalance (max / mean), and its GFLOPS and
+    GB/s on the slowest thread.
+    """
+    rows = []
+    for scope in get_timers(passes):
+        threads = scope["threads"]
+        for timer in threads[0]:
+            times = [t[timer] for t in threads]
+            max_time = max(times)
+            if max_time <= 0:
+                continue
+            mean_time = sum(times) / len(times)
+            flops = sum(scope["flops"]) if timer == "BRGEMM" else 0
+            nbytes = sum(b[timer] for b in scope["bytes"])
+            rows.append(
+                {
+                    "scope": scope["name"],
+                    "timer": timer,
+                    "max_time": max_time,
+                    "mean_time": mean_time,
+                    "imbalance": max_time / mean_time,
+                    "gflops": flops / max_time / 1e9,
+                    "gbps": nbytes / max_time / 1e9,
+                }
+            )
+    return rows
+
+
+def print_timers(passes=False):
+    print(
+        "%-16s %-10s %12s %12s %9s %10s %10s"
+        % ("scope", "timer", "max (ms)", "mean (ms)", "imbalance", "GFLOPS", "GB/s")
+    )
+    for row in timer_table(passes):
+        print(
+            "%-16s %-10s %12.3f %12.3f %9.2f %10.1f %10.1f"
+            % (
+                row["scope"],
+                row["timer"],
+                row["max_time"] * 1e3,
+                row["mean_time"] * 1e3,
+                row["imbalance"],
+                row["gflops"],
+                row["gbps"],
+            )
+        )
+
+
+@contextmanager
+def profiler_events(enabled=True):
+    r"""
+    Records the TPP calls as PyTorch profiler events, named by their TPP type,
+    on the threads the profiler records. The fused kernels are recorded by
+    their scopes in any case.
+    """
+    ipex_cpp.tpp_set_profiler_events(enabled)
+    try:
+        yield
+    finally:
+        ipex_cpp.tpp_set_profiler_events(False)
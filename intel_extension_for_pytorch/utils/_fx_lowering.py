@@ -0,0 +1,121 @@
+import math
+import operator
+import torch
+import torch.fx
+import torch.nn as nn
+import torch.nn.functional as F
+import torch.fx.experimental.optimization as optimization
+from ..nn.utils._weight_prepack import weight_prepack_with_ipex
+
+
+def _ipex_flash_attention(query, key, value, is_causal=False, scale=None):
+    if query.dim() != 4 or key.dim() != 4 or value.dim() != 4:
+        return F.scaled_dot_product_attention(query, key, value, is_causal=is_causal, scale=scale)
+    if scale is None:
+        scale = 1.0 / math.sqrt(query.size(-1))
+    out = torch.ops.torch_ipex.flash_attention(query, key, value, scale, is_causal)
+    return out.to(query.dtype)
+
+
+def _get_args(node, names, defaults):
+    args = {name: defaults.get(name) for name in names}
+    args.update(zip(names, node.args))
+    args.update(node.kwargs)
+    return args
+
+
+def _is_tensor_add(node):
+    return node.op == 'call_function' and node.target in (operator.add, torch.add) and len(node.args) == 2 and \
+        all(isinstance(arg, torch.fx.Node) for arg in node.args) and not node.kwargs and len(node.users) == 1
+
+
+def _add_layer_norm_node(gm, training, a, b, normalized_shape, weight, bias, eps):
+    if training:
+        # the autograd op of the fused backward
+        return gm.graph.call_function(torch.ops.torch_ipex.add_layernorm, (
+            a, b, normalized_shape, weight, bias, eps))
+    return gm.graph.call_function(torch.ops.ipex.add_layernorm, (
+        a, b, 1, normalized_shape, weight, bias, eps, False))
+
+
+def _lower_add_layer_norm(gm, training=False):
+    # add + LayerNorm -> ipex::add_layernorm, or torch_ipex::add_layernorm for training, which fall back to the two
+    # ops for the shapes they can't fuse
+    for node in list(gm.graph.nodes):
+        if node.op == 'call_module' and type(gm.get_submodule(node.target)) is nn.LayerNorm:
+            ln = gm.get_submodule(node.target)
+            add = node.args[0]
+            if len(node.args) != 1 or not _is_tensor_add(add):
+                continue
+            with gm.graph.inserting_before(node):
+                weight = gm.graph.get_attr(node.target + '.weight') if ln.weight is not None else None
+                bias = gm.graph.get_attr(node.target + '.bias') if ln.bias is not None else None
+                fused = _add_layer_norm_node(
+                    gm, training, add.args[0], add.args[1], list(ln.normalized_shape), weight, bias, ln.eps)
+        elif node.op == 'call_function' and node.target is F.layer_norm:
+            args = _get_args(node, ['input', 'normalized_shape', 'weight', 'bias', 'eps'], {'eps': 1e-5})
+            add = args['input']
+            if not _is_tensor_add(add) or isinstance(args['normalized_shape'], torch.fx.Node):
+                continue
+            with gm.graph.inserting_before(node):
+                fused = _add_layer_norm_node(
+                    gm, training, add.args[0], add.args[1], list(args['normalized_shape']), args['weight'],
+                    args['bias'], args['eps'])
+        else:
+            continue
+        node.replace_all_uses_with(fused)
+        gm.graph.erase_node(node)
+        gm.graph.erase_node(add)
+
+
+def _lower_sdpa(gm):
+    # scaled_dot_product_attention without mask nor dropout -> the flash attention of IPEX
+    for node in list(gm.graph.nodes):
+        if node.op != 'call_function' or node.target is not F.scaled_dot_product_attention:
+            continue
+        args = _get_args(node, ['query', 'key', 'value', 'attn_mask', 'dropout_p', 'is_causal', 'scale'],
+                         {'dropout_p': 0.0, 'is_causal': False})
+        if args['attn_mask'] is not None or args['dropout_p'] != 0.0 or isinstance(args['is_causal'], torch.fx.Node):
+            continue
+        with gm.graph.inserting_before(node):
+            fused = gm.graph.call_function(_ipex_flash_attention, (
+                args['query'], args['key'], args['value'], args['is_causal'], args['scale']))
+        node.replace_all_uses_with(fused)
+        gm.graph.erase_node(node)
+
+
+def lower_to_ipex(gm: torch.fx.GraphModule) -> torch.fx.GraphModule:
+    r"""
+    Lowers the nodes of an FX graph to IPEX ops for inference, in place:
+        - Conv + BatchNorm modules are folded.
+        - Linear and Conv modules are swapped for their prepacked IPEX modules, unless autocast is enabled.
+        - add + LayerNorm runs as ipex::add_layernorm.
+        - scaled_dot_product_attention without mask nor dropout runs as the flash attention of IPEX.
+    The graph is not traced again, so its symbolic shapes stay symbolic and any new input shape runs without
+    compiling again.
+    """
+    gm = gm.eval()
+    try:
+        gm = optimization.fuse(gm, inplace=True, no_trace=True)
+    except Exception:
+        pass
+    if not torch.is_autocast_cpu_enabled():
+        gm, _, _ = weight_prepack_with_ipex(gm, None, {})
+    _lower_add_layer_norm(gm)
+    _lower_sdpa(gm)
+    gm.graph.lint()
+    gm.recompile()
+    return gm
+
+
+def lower_add_layer_norm_for_training(model: torch.nn.Module) -> torch.fx.GraphModule:
+    r"""
+    Traces a training model with FX and runs its add + LayerNorm as torch_ipex::add_layernorm, whose backward
+    computes the grads of the sum and the weights in a single pass over the rows. The modules and parameters of the
+    model are shared by the returned GraphModule, so the optimizer of the model is unchanged.
+    """
+    gm = torch.fx.symbolic_trace(model)
+    _lower_add_layer_norm(gm, training=True)
+    gm.graph.lint()
+    gm.recompile()
+    return gm
@@ -0,0 +1,145 @@
+import math
+import os
+from collections import OrderedDict
+
+import torch
+
+_INDEX_FILE = 'index.pt'
+_DATA_FILE = 'tensors.bin'
+# the offsets of the tensors in the data file, aligned for the vector stores of the converters
+_ALIGNMENT = 64
+
+def _element_size(dtype):
+    return torch.empty((), dtype=dtype).element_size()
+
+def _tensor_view(data, offset, dtype, shape):
+    nbytes = math.prod(shape) * _element_size(dtype)
+    return data[offset:offset + nbytes].view(dtype).view(shape)
+
+def _module_state(module, prefix):
+    r"""
+    Yields the (key, tensor, trail) of the state saved by the ``_save_to_state_dict`` of the module, trail being the
+    bottom half of a bf16 param split from its fp32 master weight, or None. The state of the weight cast modules
+    is read from their params, trails and master weights, instead of the fp32 params their ``_save_to_state_dict``
+    materializes.
+    """
+    if hasattr(module, 'master_weight_split') and not hasattr(module, 'ctx'):
+        for name, param in module._parameters.items():
+            if param is None:
+                continue
+            if hasattr(module, name + '_trail'):
+                yield prefix + name, param.detach(), getattr(module, name + '_trail')
+            elif hasattr(module, 'master_' + name):
+                yield prefix + name, getattr(module, 'master_' + name).detach(), None
+            else:
+                yield prefix + name, param.detach(), None
+        for name, buf in module._buffers.items():
+            if buf is not None and name not in module._non_persistent_buffers_set:
+                yield prefix + name, buf.detach(), None
+    else:
+        state = OrderedDict()
+        module._save_to_state_dict(state, prefix, False)
+        for key, value in state.items():
+            yield key, value, None
+
+def save_checkpoint(model, path, chunk_numel=1 << 22):
+    r"""
+    Saves the state dict of the model into the directory ``path``, the fp32 values of the bf16 params being
+    converted while they are written to disk.
+
+    ``model.state_dict()`` of a model optimized by ``ipex.optimize`` for bf16 training materializes the fp32 value of
+    every split bf16 param, doubling the params in memory for the time of the save. Instead, the fp32 tensors are
+    written into a memory mapped file, the split params being converted with
+    ``torch.ops.torch_ipex.cat_bfloat16_float.out`` by chunks of ``chunk_numel`` elements written in place, and the
+    master weights and the other tensors being copied into it. The directory holds an ``index.pt`` of the keys, dtypes,
+    shapes and offsets of the tensors and the ``tensors.bin`` of their data. The checkpoint is read back by
+    :func:`load_checkpoint`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        import intel_extension_for_pytorch as ipex
+        model, optimizer = ipex.optimize(model, optimizer=optimizer, dtype=torch.bfloat16)
+        ...
+        ipex.save_checkpoint(model, 'checkpoint')
+        ipex.load_checkpoint(model, 'checkpoint')
+
+    Args:
+        model (torch.nn.Module): The model to save.
+        path (str): The directory of the checkpoint, created if it doesn't exist.
+        chunk_numel (int): The elements of a split param converted and written at a time.
+    """
+    entries = []
+    tensors = OrderedDict()
+    objects = OrderedDict()
+    nbytes = 0
+    for name, module in model.named_modules():
+        prefix = name + '.' if name else ''
+        for key, value, trail in _module_state(module, prefix):
+            if not isinstance(value, torch.Tensor):
+                objects[key] = value
+                continue
+            # the bf16 params are saved in fp32, as by their _save_to_state_dict
+            cast = trail is not None or (value.dtype == torch.bfloat16 and hasattr(module, 'master_weight_split'))
+            dtype = torch.float if cast else value.dtype
+            offset = (nbytes + _ALIGNMENT - 1) // _ALIGNMENT * _ALIGNMENT
+            tensors[key] = (offset, dtype, list(value.shape))
+            entries.append((key, value, trail))
+            nbytes = offset + value.numel() * _element_size(dtype)
+
+    os.makedirs(path, exist_ok=True)
+    data_file = os.path.join(path, _DATA_FILE)
+    with open(data_file, 'wb') as f:
+        f.truncate(nbytes)
+    if nbytes > 0:
+        data = torch.from_file(data_file, shared=True, size=nbytes, dtype=torch.uint8)
+        with torch.no_grad():
+            for key, value, trail in entries:
+                out = _tensor_view(data, *tensors[key])
+                if trail is None:
+                    out.copy_(value)
+                elif value.is_contiguous() and trail.is_contiguous():
+                    top, bot, flat_out = value.view(-1), trail.view(-1), out.view(-1)
+                    for begin in range(0, flat_out.numel(), chunk_numel):
+                        end = min(begin + chunk_numel, flat_out.numel())
+                        torch.ops.torch_ipex.cat_bfloat16_float.out(
+                            top[begin:end], bot[begin:end], out=flat_out[begin:end])
+                else:
+                    # e.g. a channels last param, converted at once in the order of the file
+                    torch.ops.torch_ipex.cat_bfloat16_float.out(value, trail, out=out)
+        del data
+    torch.save({'version': 1, 'nbytes': nbytes, 'tensors': tensors, 'objects': objects},
+               os.path.join(path, _INDEX_FILE))
+
+def load_checkpoint(model, path, strict=True):
+    r"""
+    Loads the checkpoint saved by :func:`save_checkpoint` into the model, and returns the missing and unexpected keys
+    of ``model.load_state_dict``.
+
+    The tensors are views of the memory mapped ``tensors.bin``, read as they are loaded: the split bf16 params are
+    split from them into the params and their trails with ``torch.ops.torch_ipex.split_float_bfloat16.out``, and the
+    other tensors are copied from them, without a full copy of the state dict in memory.
+
+    Args:
+        model (torch.nn.Module): The model to load the checkpoint into.
+        path (str): The directory of the checkpoint.
+        strict (bool): Whether the keys of the checkpoint must match the keys of the model.
+    """
+    return model.load_state_dict(_load_checkpoint_tensors(path), strict=strict)
+
+def _load_checkpoint_tensors(path):
+    r"""
+    Returns the state dict of the checkpoint saved by :func:`save_checkpoint`, whose tensors are views of the
+    memory mapped ``tensors.bin``: their pages are read from disk when the tensors are first read.
+    """
+    index = torch.load(os.path.join(path, _INDEX_FILE))
+    state_dict = OrderedDict()
+    if index['nbytes'] > 0:
+        data = torch.from_file(os.path.join(path, _DATA_FILE), shared=False, size=index['nbytes'], dtype=torch.uint8)
+        for key, (offset, dtype, shape) in index['tensors'].items():
+            state_dict[key] = _tensor_view(data, offset, dtype, shape)
+    else:
+        for key, (_, dtype, shape) in index['tensors'].items():
+            state_dict[key] = torch.empty(shape, dtype=dtype)
+    state_dict.update(index['objects'])
+    return state_dict
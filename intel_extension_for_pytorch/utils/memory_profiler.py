@@ -0,0 +1,61 @@
+import intel_extension_for_pytorch._C as core
+
+class memory_profiler(object):
+    """
+    Memory footprint of the IPEX subsystems
+
+    While enabled, the CPU allocations are tagged by the subsystem or the op
+    allocating them, e.g. ``weight_pack::linear`` for the packed weights of
+    the linear layers, ``llga::shared_constants`` for the constants shared by
+    the oneDNN Graph partitions, ``tpp::<op>`` for the TPP ops and
+    ``optimizer::master_weights`` for the master weights and trails of the
+    low precision training. The other allocations are ``untagged``. The
+    allocations are accounted until they are freed, and the peaks since
+    entering the profiler are reported.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        import intel_extension_for_pytorch as ipex
+        with ipex.memory_profiler() as prof:
+            model = ipex.optimize(model)
+            model(data)
+        print(prof.report()['peak_bytes'])
+        for tag in prof.report()['tags']:
+            print(tag['tag'], tag['current_bytes'], tag['peak_bytes'])
+
+    :meta public:
+    """
+    def __enter__(self):
+        self.prev_enabled = core._is_memory_tracking_enabled()
+        core._reset_memory_stats()
+        core._set_memory_tracking_enabled(True)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        core._set_memory_tracking_enabled(self.prev_enabled)
+
+    @staticmethod
+    def report():
+        r"""
+        Returns the ``current_bytes`` and the ``peak_bytes`` of the tracked allocations and their ``tags``, the top
+        allocators first: the ``current_bytes``, ``peak_bytes``, ``allocated_bytes`` and ``allocations`` of each tag.
+        """
+        stats = core._get_memory_stats()
+        stats['tags'] = sorted(stats['tags'], key=lambda tag: tag['peak_bytes'], reverse=True)
+        return stats
+
+class memory_scope(object):
+    r"""
+    Tags the allocations of the calling thread in its scope for the memory profiler, the ops tagging their own
+    allocations inside.
+    """
+    def __init__(self, tag):
+        self.tag = tag
+
+    def __enter__(self):
+        self.prev_tag = core._set_memory_tag(self.tag)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        core._set_memory_tag(self.prev_tag)
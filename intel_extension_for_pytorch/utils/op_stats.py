@@ -0,0 +1,62 @@
+import intel_extension_for_pytorch._C as core
+
+class op_stats(object):
+    """
+    Runtime stats of the IPEX ops
+
+    The IPEX kernels (MergedEmbeddingBag, Interaction, flash attention,
+    RMSNorm, NMS and the fused optimizer steps) time one call out of every
+    ``sample_rate`` calls of each op and thread, with the bytes it moves and
+    the FLOPs it computes. The other calls only bump a counter, so that a
+    ``sample_rate`` of 100 or more is cheap enough to be left on. The ops still
+    show up in the PyTorch profiler through their record functions.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        import intel_extension_for_pytorch as ipex
+        with ipex.op_stats(sample_rate=100) as stats:
+            model(data)
+        for op in stats.report():
+            print(op['name'], op['avg_us'], op['gbps'], op['gflops'])
+
+    Args:
+        sample_rate (int): one call out of ``sample_rate`` is timed. The default value is ``1``.
+
+    :meta public:
+    """
+    def __init__(self, sample_rate=1):
+        assert sample_rate >= 1, "op_stats: the sample_rate must be >= 1"
+        self.sample_rate = sample_rate
+
+    def __enter__(self):
+        self.prev_sample_rate = core._get_op_stats_sample_rate()
+        core._reset_op_stats()
+        core._set_op_stats_sample_rate(self.sample_rate)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        core._set_op_stats_sample_rate(self.prev_sample_rate)
+
+    @staticmethod
+    def report():
+        r"""
+        Returns the stats of each op recorded so far, sorted by the estimated total time: the estimated ``calls``,
+        the ``samples``, the estimated ``total_ms``, the ``avg_us`` of a call, the bandwidth ``gbps`` and the
+        throughput ``gflops`` of the sampled calls, and the ``max_threads`` they ran with.
+        """
+        ops = []
+        for stats in core._get_op_stats():
+            samples = max(stats['samples'], 1)
+            seconds = max(stats['sampled_ms'], 1e-9) / 1e3
+            ops.append({
+                'name': stats['name'],
+                'calls': stats['calls'],
+                'samples': stats['samples'],
+                'total_ms': stats['sampled_ms'] * stats['calls'] / samples,
+                'avg_us': stats['sampled_ms'] * 1e3 / samples,
+                'gbps': stats['sampled_bytes'] / seconds / 1e9,
+                'gflops': stats['sampled_flops'] / seconds / 1e9,
+                'max_threads': stats['max_threads'],
+            })
+        return sorted(ops, key=lambda op: op['total_ms'], reverse=True)
@@ -0,0 +1,58 @@
+import intel_extension_for_pytorch._C as core
+
+class parallel_stats(object):
+    """
+    Thread imbalance of the parallel regions of the IPEX ops
+
+    The OpenMP parallel regions of the IPEX kernels (GroupNorm and
+    EmbeddingBag) measure the busy time of each of their threads, to tell the
+    ops whose static partitioning leaves threads waiting at the barrier for
+    a straggler, e.g. a thread sharing its core with an SMT sibling or a
+    noisy neighbor. These ops are the candidates for a dynamic schedule. The
+    regions are accounted by op and by the cores of the ``CPUPool`` their
+    thread is pinned to, so that the streams of the runtime extension are
+    reported apart.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        import intel_extension_for_pytorch as ipex
+        with ipex.parallel_stats() as stats:
+            model(data)
+        for op in stats.report():
+            print(op['op'], op['cpu_pool'], op['imbalance'], op['barrier_wait_ms'])
+
+    :meta public:
+    """
+    def __enter__(self):
+        self.prev_enabled = core._is_parallel_stats_enabled()
+        core._reset_parallel_stats()
+        core._set_parallel_stats_enabled(True)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        core._set_parallel_stats_enabled(self.prev_enabled)
+
+    @staticmethod
+    def report():
+        r"""
+        Returns the stats of each op and ``cpu_pool`` recorded so far, sorted by the time waited at the barriers: the
+        parallel ``regions``, the ``max_threads`` they ran on, their ``wall_ms``, the ``busy_ms`` of their threads, the
+        ``barrier_wait_ms`` of the threads for the slowest one of each region, the ``imbalance`` as the slowest over
+        the mean busy time of the threads weighted by the regions time, and the ``worst_imbalance`` of a region.
+        """
+        ops = []
+        for stats in core._get_parallel_stats():
+            busy_ms = max(stats['busy_ms'], 1e-9)
+            ops.append({
+                'op': stats['op'],
+                'cpu_pool': stats['cpu_pool'],
+                'regions': stats['regions'],
+                'max_threads': stats['max_threads'],
+                'wall_ms': stats['wall_ms'],
+                'busy_ms': stats['busy_ms'],
+                'barrier_wait_ms': stats['barrier_wait_ms'],
+                'imbalance': (stats['busy_ms'] + stats['barrier_wait_ms']) / busy_ms,
+                'worst_imbalance': stats['worst_imbalance'],
+            })
+        return sorted(ops, key=lambda op: op['barrier_wait_ms'], reverse=True)
@@ -0,0 +1,136 @@
+import json
+import os
+import sys
+import time
+import torch
+import intel_extension_for_pytorch._C as core
+
+r"""
+Performance baselines of the IPEX ops, to detect the regressions of an upgrade. A run records the op timings of
+``ipex.op_stats`` (or of the PyTorch profiler) with the fingerprint of the host as a JSON line appended to a log, and
+two runs are compared op by op:
+
+.. highlight:: python
+.. code-block:: python
+
+    import intel_extension_for_pytorch as ipex
+    with ipex.op_stats(sample_rate=10) as stats:
+        model(data)
+    ipex.utils.perf_baseline.record('baseline.jsonl', stats.report(), name='resnet50')
+
+and after the upgrade, with the log of the new run::
+
+    python -m intel_extension_for_pytorch.utils.perf_baseline baseline.jsonl new.jsonl --name resnet50
+
+which prints the ops slower by more than ``--threshold`` and exits with 1 if there is any.
+"""
+
+def host_fingerprint():
+    r"""
+    The host fields the op timings depend on: the ISA levels of the CPU and of the kernels, the cores, the threads,
+    the fp32 math mode and the versions.
+    """
+    from .._version import __version__
+    return {
+        'hostname': os.uname().nodename,
+        'cpu_isa': core._get_highest_cpu_support_isa_level(),
+        'isa': core._get_current_isa_level(),
+        'onednn_isa': core._get_current_onednn_isa_level(),
+        'cores': os.cpu_count(),
+        'threads': torch.get_num_threads(),
+        'fp32_math_mode': core.get_fp32_math_mode().name,
+        'torch': torch.__version__,
+        'ipex': __version__,
+    }
+
+def from_profiler(prof):
+    r"""
+    The ops of a ``torch.profiler.profile`` run, in the format of ``op_stats.report()``.
+    """
+    return [{
+        'name': event.key,
+        'calls': event.count,
+        'total_ms': event.cpu_time_total / 1e3,
+        'avg_us': event.cpu_time_total / max(event.count, 1),
+    } for event in prof.key_averages()]
+
+def record(path, ops, name=''):
+    r"""
+    Appends a run of the ``ops`` to the log at ``path``, a list of dicts with the ``name``, the ``calls`` and the
+    ``avg_us`` of each op, as returned by ``op_stats.report()``. Returns the record.
+    """
+    entry = {
+        'name': name,
+        'time': time.strftime('%Y-%m-%dT%H:%M:%S'),
+        'host': host_fingerprint(),
+        'ops': {op['name']: {'calls': op['calls'], 'avg_us': op['avg_us']} for op in ops},
+    }
+    with open(path, 'a') as f:
+        f.write(json.dumps(entry) + '\n')
+    return entry
+
+def load(path, name=None):
+    r"""
+    The last run recorded in the log at ``path``, of the given ``name`` if not None.
+    """
+    entry = None
+    with open(path) as f:
+        for line in f:
+            if line.strip():
+                run = json.loads(line)
+                if name is None or run['name'] == name:
+                    entry = run
+    assert entry is not None, f'perf_baseline: no run {name or ""} in {path}'
+    return entry
+
+def compare(baseline, run, threshold=0.1, min_us=1.):
+    r"""
+    Compares two runs returned by :func:`record` or :func:`load`. Returns a dict with the ``regressions``, the ops
+    of ``run`` slower than in ``baseline`` by more than ``threshold`` (a ratio), sorted by their slowdown, the
+    ``improvements`` faster by more than ``threshold``, the ops ``missing`` from ``run`` and the ``host_changes``,
+    the fields of the host fingerprint which differ. The ops faster than ``min_us`` in both runs are skipped, their
+    timings being noise.
+    """
+    regressions, improvements = [], []
+    for op, new in run['ops'].items():
+        old = baseline['ops'].get(op)
+        if old is None or max(old['avg_us'], new['avg_us']) < min_us:
+            continue
+        ratio = new['avg_us'] / max(old['avg_us'], 1e-9)
+        diff = {'name': op, 'baseline_us': old['avg_us'], 'us': new['avg_us'], 'ratio': ratio}
+        if ratio > 1 + threshold:
+            regressions.append(diff)
+        elif ratio < 1 / (1 + threshold):
+            improvements.append(diff)
+    host_changes = {k: (v, run['host'].get(k)) for k, v in baseline['host'].items()
+                    if k != 'hostname' and run['host'].get(k) != v}
+    return {
+        'regressions': sorted(regressions, key=lambda d: d['ratio'], reverse=True),
+        'improvements': sorted(improvements, key=lambda d: d['ratio']),
+        'missing': sorted(set(baseline['ops']) - set(run['ops'])),
+        'host_changes': host_changes,
+    }
+
+def main(argv=None):
+    from argparse import ArgumentParser
+    parser = ArgumentParser(description='Flags the op regressions between two runs of the IPEX perf baselines')
+    parser.add_argument('baseline', help='the log of the baseline run')
+    parser.add_argument('run', help='the log of the new run')
+    parser.add_argument('--name', default=None, help='the name of the runs to compare, the last ones if not given')
+    parser.add_argument('--threshold', type=float, default=0.1, help='the slowdown ratio flagged, 0.1 by default')
+    parser.add_argument('--min-us', '--min_us', type=float, default=1., help='the ops faster are skipped')
+    args = parser.parse_args(argv)
+
+    result = compare(load(args.baseline, args.name), load(args.run, args.name), args.threshold, args.min_us)
+    for k, (old, new) in result['host_changes'].items():
+        print(f'host {k}: {old} -> {new}')
+    for op in result['missing']:
+        print(f'missing {op}')
+    for d in result['improvements']:
+        print(f'improved {d["name"]}: {d["baseline_us"]:.2f} -> {d["us"]:.2f} us ({d["ratio"]:.2f}x)')
+    for d in result['regressions']:
+        print(f'REGRESSED {d["name"]}: {d["baseline_us"]:.2f} -> {d["us"]:.2f} us ({d["ratio"]:.2f}x)')
+    return 1 if result['regressions'] else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -200,12 +200,11 @@ class AutocastCPUTestLists(object):
         ]
         self.nn_fp16 = [
         ]
-        self.torch_fp16_fp32 = [
-            ("relu", mat0_fp16),
+        # run in fp16 if the CPU supports it natively, in fp32 otherwise
+        self.torch_fp16_if_supported = [
             ("conv1d", conv_args_fp16[0]),
             ("conv2d", conv_args_fp16[1]),
             ("conv3d", conv_args_fp16[2]),
-            ("conv_tbc", conv_args_fp16[0] + bias_fp16),
             ("_convolution", conv_args_fp32[1] + bias_fp16 + ((1, 1), (0, 0), (1, 1), False,
                                                               (0, 0), 1, False, True, True)),
             ("bmm", (torch.randn((n, n, n), device=dev, dtype=torch.float16),
@@ -221,6 +220,13 @@ class AutocastCPUTestLists(object):
             ("conv_transpose1d", conv_args_fp16[0]),
             ("conv_transpose2d", conv_args_fp16[1]),
             ("conv_transpose3d", conv_args_fp16[2]),
+        ]
+        self.nn_fp16_if_supported = [
+            ("linear", mat0_fp16 + mat1_fp16),
+        ]
+        self.torch_fp16_fp32 = [
+            ("relu", mat0_fp16),
+            ("conv_tbc", conv_args_fp16[0] + bias_fp16),
             ("group_norm", (torch.randn((4, 8, 10, 10), device=dev, dtype=torch.float16),
                             4, torch.randn(8, device=dev, dtype=torch.float16),
                             torch.randn(8, device=dev, dtype=torch.float16), 1e-5, True)),
@@ -238,7 +244,6 @@ class AutocastCPUTestLists(object):
         ]
         self.nn_fp16_fp32 = [
             ("mish", mat0_fp16),
-            ("linear", mat0_fp16 + mat1_fp16),
             ("avg_pool2d", dummy_fp16[2], {"kernel_size": (3, 2), "stride": (1, 1)}),
             ("avg_pool3d", dummy_fp16[3], {"kernel_size": (3, 3, 3), "stride": (1, 1, 1)}),
             ("gelu", mat0_fp16),
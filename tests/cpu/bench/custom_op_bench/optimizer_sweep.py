@@ -0,0 +1,187 @@
+import torch
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.optim._optimizer_utils import optimizer_fusion, IPEX_FUSED_OPTIMIZER_LIST_CPU
+import argparse
+import itertools
+import json
+import platform
+import random
+import statistics
+import time
+
+r"""
+Sweep the fused optimizer steps over the number of params, the distribution of
+the param sizes, the param dtype and the number of threads, and report the
+achieved memory bandwidth against the STREAM triad bandwidth of the same
+number of threads.
+
+The traffic of a step is its minimum one: the params, their trails and the
+optimizer states read and written once and the grads read once. The steps with
+extra passes over the params (e.g. the norms of Lamb and Lars) or that are
+compute bound reach a lower fraction of the roofline.
+"""
+
+OPTIMIZERS = {
+    torch.optim.SGD: lambda params, foreach: torch.optim.SGD(params, lr=0.1, momentum=0.9, foreach=foreach),
+    torch.optim.Adagrad: lambda params, foreach: torch.optim.Adagrad(params, lr=0.1, foreach=foreach),
+    torch.optim.Adam: lambda params, foreach: torch.optim.Adam(params, lr=0.1, foreach=foreach),
+    ipex.optim._lamb.Lamb: lambda params, foreach: ipex.optim._lamb.Lamb(params, lr=0.1),
+    ipex.optim._lars.Lars: lambda params, foreach: ipex.optim._lars.Lars(params, lr=0.1),
+    ipex.optim._adafactor.Adafactor: lambda params, foreach: ipex.optim._adafactor.Adafactor(params),
+}
+assert all(opt in OPTIMIZERS for opt in IPEX_FUSED_OPTIMIZER_LIST_CPU), "a fused optimizer is not benchmarked"
+
+# bf16-split: bf16 params with the trails of split_master_weight_for_bf16
+# bf16: pure bf16 params updated with stochastic rounding
+DTYPES = ['fp32', 'bf16-split', 'bf16']
+
+def param_sizes(numel, distribution, seed=0):
+    r"""
+    The sizes of the params of numel elements in total:
+    small: params of 4K elements, e.g. biases and norm layers
+    large: params of 4M elements, e.g. the weights of large linear layers
+    mixed: log-uniform sizes between 64 and 4M elements, as in most models
+    """
+    if distribution == 'small':
+        size = min(4096, numel)
+        return [size] * (numel // size)
+    if distribution == 'large':
+        size = min(4 * 1024 * 1024, numel)
+        return [size] * (numel // size)
+    rng = random.Random(seed)
+    sizes = []
+    while numel >= 64:
+        size = min(int(2 ** rng.uniform(6, 22)), numel)
+        sizes.append(size)
+        numel -= size
+    return sizes
+
+def make_optimizer(opt, sizes, dtype, foreach):
+    params = []
+    params_attr = {}
+    for size in sizes:
+        # 2D params, so that Adafactor factors them
+        rows = 64 if size % 64 == 0 else 1
+        param = torch.nn.Parameter(torch.randn(rows, size // rows))
+        param.grad = torch.randn(rows, size // rows)
+        if dtype != 'fp32':
+            top, trail = torch.ops.torch_ipex.split_float_bfloat16(param.data)
+            param.data = top
+            param.grad = param.grad.bfloat16()
+            if dtype == 'bf16-split':
+                params_attr[param] = {'trail': trail}
+        params.append(param)
+    optimizer = OPTIMIZERS[opt](params, foreach)
+    optimizer.params_attr = params_attr
+    optimizer_fusion(optimizer, dtype == 'bf16-split')
+    return optimizer
+
+def step_bytes(optimizer):
+    r"""
+    The minimum traffic of a step, the states being created by the first one
+    """
+    total = 0
+    for group in optimizer.param_groups:
+        for p in group['params']:
+            total += p.numel() * p.element_size() * 3  # read and write param, read grad
+            if p in optimizer.params_attr:
+                trail = optimizer.params_attr[p]['trail']
+                total += trail.numel() * trail.element_size() * 2
+            for value in optimizer.state[p].values():
+                if isinstance(value, torch.Tensor) and value.numel() > 1:
+                    total += value.numel() * value.element_size() * 2
+    return total
+
+def time_steps(optimizer, warmup, iters):
+    for _ in range(warmup):
+        optimizer.step()
+    times = []
+    for _ in range(iters):
+        start = time.perf_counter()
+        optimizer.step()
+        times.append(time.perf_counter() - start)
+    return statistics.median(times)
+
+def stream_triad(numel, iters=10):
+    r"""
+    The STREAM triad bandwidth a = b + s * c in GB/s, the best of iters
+    """
+    a = torch.zeros(numel)
+    b = torch.ones(numel)
+    c = torch.ones(numel)
+    best = float('inf')
+    for _ in range(iters):
+        start = time.perf_counter()
+        torch.add(b, c, alpha=3.0, out=a)
+        best = min(best, time.perf_counter() - start)
+    return 3 * numel * a.element_size() / best / 1e9
+
+def run():
+    parser = argparse.ArgumentParser(description="sweep benchmark of the ipex fused optimizer steps")
+    names = {opt.__name__.lower(): opt for opt in OPTIMIZERS}
+    parser.add_argument("--optimizer", type=str, nargs='+', choices=list(names), default=list(names))
+    parser.add_argument("--numel", type=int, nargs='+', default=[1 << 20, 1 << 24, 1 << 26],
+                        help="the numbers of elements of all the params")
+    parser.add_argument("--distribution", type=str, nargs='+', choices=['small', 'large', 'mixed'],
+                        default=['small', 'large', 'mixed'])
+    parser.add_argument("--dtype", type=str, nargs='+', choices=DTYPES, default=DTYPES)
+    parser.add_argument("--threads", type=int, nargs='+', default=[torch.get_num_threads()])
+    parser.add_argument("--foreach", action='store_true',
+                        help="use the multi-tensor steps of the optimizers that have them")
+    parser.add_argument("--stream-numel", type=int, default=1 << 26,
+                        help="the number of fp32 elements of the STREAM arrays, a few times the LLC")
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--output", type=str, default=None, help="the JSON file of the results, stdout if None")
+    args = parser.parse_args()
+
+    roofline = {}
+    for threads in args.threads:
+        torch.set_num_threads(threads)
+        roofline[threads] = stream_triad(args.stream_numel)
+
+    results = []
+    for name, numel, distribution, dtype in itertools.product(args.optimizer, args.numel, args.distribution, args.dtype):
+        sizes = param_sizes(numel, distribution)
+        if not sizes:
+            continue
+        optimizer = make_optimizer(names[name], sizes, dtype, args.foreach)
+        for threads in args.threads:
+            torch.set_num_threads(threads)
+            elapsed = time_steps(optimizer, args.warmup, args.iters)
+            num_bytes = step_bytes(optimizer)
+            gbps = num_bytes / elapsed / 1e9
+            results.append({
+                'optimizer': name,
+                'numel': sum(sizes),
+                'num_params': len(sizes),
+                'distribution': distribution,
+                'dtype': dtype,
+                'threads': threads,
+                'foreach': args.foreach,
+                'time_ms': elapsed * 1e3,
+                'bytes': num_bytes,
+                'gbps': gbps,
+                'roofline_gbps': roofline[threads],
+                'roofline_fraction': gbps / roofline[threads],
+            })
+            print("{:<10} {:>9} elements in {:>5} {:<5} params, {:<10} {:>3} threads: {:8.3f} ms, {:7.1f} GB/s, "
+                  "{:5.1%} of STREAM".format(name, sum(sizes), len(sizes), distribution, dtype, threads,
+                                             elapsed * 1e3, gbps, gbps / roofline[threads]))
+        del optimizer
+
+    report = {
+        'machine': platform.processor() or platform.machine(),
+        'torch_version': torch.__version__,
+        'ipex_version': ipex.__version__,
+        'stream_triad_gbps': {str(k): v for k, v in roofline.items()},
+        'results': results,
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        print(json.dumps(report, indent=2))
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,118 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import json
+import math
+import os
+import platform
+import statistics
+import time
+
+r"""
+Sweep the kernels that size their partitioning for the team of the calling
+thread (flash attention, paged decode attention and the fused norm + linear)
+over the size of the CPUPool they run in, e.g. the cores of a stream of
+MultiStreamModule, and report the throughput per core.
+
+The teams up to IPEX_SMALL_TEAM_THREADS threads (8 by default) use the
+strategies tuned for few threads. Run the sweep a second time with
+IPEX_SMALL_TEAM_THREADS=0 for the baseline of the full socket partitioning.
+"""
+
+def flash_attention(batch, dtype):
+    heads, seq_len, head_size = 16, 1024, 64
+    query, key, value = [torch.randn(batch, heads, seq_len, head_size).to(dtype) for _ in range(3)]
+    scale = 1.0 / math.sqrt(head_size)
+    return lambda: torch.ops.torch_ipex.flash_attention(query, key, value, scale, True)
+
+def paged_attention_decode(batch, dtype):
+    num_heads, num_kv_heads, head_size, block_size, context_len = 32, 8, 128, 16, 4096
+    max_blocks = context_len // block_size
+    key_cache = torch.randn(batch * max_blocks, block_size, num_kv_heads, head_size).to(dtype)
+    value_cache = torch.randn_like(key_cache)
+    block_tables = torch.randperm(batch * max_blocks).view(batch, max_blocks).to(torch.int32)
+    context_lens = torch.full((batch,), context_len, dtype=torch.int32)
+    query = torch.randn(batch, num_heads, head_size).to(dtype)
+    scale = 1.0 / math.sqrt(head_size)
+    return lambda: torch.ops.torch_ipex.paged_attention_decode(
+        query, key_cache, value_cache, block_tables, context_lens, scale)
+
+def norm_linear(batch, dtype):
+    hidden_size = 4096
+    model = torch.nn.Sequential(torch.nn.LayerNorm(hidden_size), torch.nn.Linear(hidden_size, hidden_size)).eval()
+    x = torch.randn(batch, 128, hidden_size).to(dtype)
+    with torch.no_grad(), torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+        model = ipex.optimize(model, dtype=dtype)
+        model = torch.jit.freeze(torch.jit.trace(model, x))
+    def run():
+        with torch.no_grad():
+            return model(x)
+    return run
+
+OPS = {
+    'flash_attention': flash_attention,
+    'paged_attention_decode': paged_attention_decode,
+    'norm_linear': norm_linear,
+}
+
+def time_op(run, warmup, iters):
+    for _ in range(warmup):
+        run()
+    times = []
+    for _ in range(iters):
+        start = time.perf_counter()
+        run()
+        times.append(time.perf_counter() - start)
+    return statistics.median(times)
+
+def run():
+    parser = argparse.ArgumentParser(description="sweep benchmark of the ipex kernels over the stream size")
+    parser.add_argument("--op", type=str, nargs='+', choices=list(OPS), default=list(OPS))
+    parser.add_argument("--cores", type=int, nargs='+', default=[1, 2, 4, 8],
+                        help="the numbers of cores of the CPUPool of the stream")
+    parser.add_argument("--batch-size", type=int, default=1, help="the batch size of a stream")
+    parser.add_argument("--bf16", action='store_true')
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iters", type=int, default=20)
+    parser.add_argument("--output", type=str, default=None, help="the JSON file of the results, stdout if None")
+    args = parser.parse_args()
+    assert ipex.cpu.runtime.is_runtime_ext_enabled(), \
+        "the sweep pins the cores of the streams, preload libiomp5.so with the launcher"
+
+    dtype = torch.bfloat16 if args.bf16 else torch.float
+    node_cores = ipex.cpu.runtime.CPUPool(node_id=0, physical_cores_only=True).core_ids
+    results = []
+    for name in args.op:
+        run_op = OPS[name](args.batch_size, dtype)
+        for cores in args.cores:
+            if cores > len(node_cores):
+                continue
+            cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=node_cores[:cores])
+            with ipex.cpu.runtime.pin(cpu_pool):
+                elapsed = time_op(run_op, args.warmup, args.iters)
+            results.append({
+                'op': name,
+                'cores': cores,
+                'batch_size': args.batch_size,
+                'dtype': str(dtype),
+                'time_ms': elapsed * 1e3,
+                'throughput_per_core': args.batch_size / elapsed / cores,
+            })
+            print("{:<24} {:>3} cores: {:8.3f} ms, {:8.2f} samples/s per core".format(
+                name, cores, elapsed * 1e3, args.batch_size / elapsed / cores))
+
+    report = {
+        'machine': platform.processor() or platform.machine(),
+        'torch_version': torch.__version__,
+        'ipex_version': ipex.__version__,
+        'small_team_threads': os.environ.get('IPEX_SMALL_TEAM_THREADS', '8'),
+        'results': results,
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        print(json.dumps(report, indent=2))
+
+if __name__ == "__main__":
+    run()
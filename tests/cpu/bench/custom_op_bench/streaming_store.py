@@ -0,0 +1,126 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import json
+import platform
+import statistics
+import time
+
+r"""
+Sweep the memory bound kernels which write their outputs with non-temporal
+stores above the streaming store threshold (cat, index_select, the bf16/fp32
+converters and the fused SGD and Adam steps) over the size of their outputs,
+with the streaming stores and with the regular stores, and report the achieved
+bandwidth of both.
+
+The traffic of a kernel is its minimum one: its inputs read once and its
+outputs written once. The regular stores also read the lines of the outputs
+they write (read for ownership), which the streaming stores don't, so the
+gain is expected for the outputs much bigger than the LLC only.
+"""
+
+def cat(numel):
+    x = torch.randn(numel // 2)
+    return lambda: torch.cat([x, x]), 2 * numel * 4
+
+def index_select(numel):
+    rows = 4096
+    x = torch.randn(rows, numel // rows)
+    indices = torch.randperm(rows)
+    return lambda: x.index_select(0, indices), 2 * numel * 4
+
+def split_float_bfloat16(numel):
+    x = torch.randn(numel)
+    return lambda: torch.ops.torch_ipex.split_float_bfloat16(x), numel * (4 + 2 + 2)
+
+def cat_bfloat16_float(numel):
+    top, bottom = torch.ops.torch_ipex.split_float_bfloat16(torch.randn(numel))
+    return lambda: torch.ops.torch_ipex.cat_bfloat16_float(top, bottom), numel * (2 + 2 + 4)
+
+def sgd_step(numel):
+    param, grad, momentum_buf = [torch.randn(numel) for _ in range(3)]
+    trail = torch.Tensor()
+    # reads the param, the grad and the momentum buffer, writes the param and
+    # the momentum buffer
+    return lambda: torch.ops.torch_ipex.sgd_fused_step(
+        param, grad, momentum_buf, trail, 0.9, 0.01, 0.0, 0.0, False), numel * 4 * 5
+
+def adam_step(numel):
+    param, grad, exp_avg, exp_avg_sq = [torch.randn(numel).abs() for _ in range(4)]
+    empty = torch.Tensor()
+    # reads the param, the grad and the moments, writes the param and the
+    # moments
+    return lambda: torch.ops.torch_ipex.adam_fused_step(
+        param, exp_avg, exp_avg_sq, empty, grad, empty, False, 1, 0.9, 0.999, 0.01, 0.0, 1e-8), numel * 4 * 7
+
+OPS = {
+    'cat': cat,
+    'index_select': index_select,
+    'split_float_bfloat16': split_float_bfloat16,
+    'cat_bfloat16_float': cat_bfloat16_float,
+    'sgd_step': sgd_step,
+    'adam_step': adam_step,
+}
+
+def time_op(run, warmup, iters):
+    for _ in range(warmup):
+        run()
+    times = []
+    for _ in range(iters):
+        start = time.perf_counter()
+        run()
+        times.append(time.perf_counter() - start)
+    return statistics.median(times)
+
+def run():
+    parser = argparse.ArgumentParser(description="sweep benchmark of the streaming stores of the ipex kernels")
+    parser.add_argument("--op", type=str, nargs='+', choices=list(OPS), default=list(OPS))
+    parser.add_argument("--numel", type=int, nargs='+', default=[2 ** 20, 2 ** 23, 2 ** 26, 2 ** 28],
+                        help="the numbers of elements of the outputs")
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--output", type=str, default=None, help="the JSON file of the results, stdout if None")
+    args = parser.parse_args()
+
+    default_threshold = ipex._C.get_streaming_store_threshold()
+    results = []
+    try:
+        for name in args.op:
+            for numel in args.numel:
+                run_op, traffic = OPS[name](numel)
+                bandwidth = {}
+                # 1: every output streamed, 0: no output streamed
+                for mode, threshold in [('streaming', 1), ('regular', 0)]:
+                    ipex._C.set_streaming_store_threshold(threshold)
+                    elapsed = time_op(run_op, args.warmup, args.iters)
+                    bandwidth[mode] = traffic / elapsed / 1e9
+                results.append({
+                    'op': name,
+                    'numel': numel,
+                    'traffic_bytes': traffic,
+                    'streaming_gbps': bandwidth['streaming'],
+                    'regular_gbps': bandwidth['regular'],
+                    'speedup': bandwidth['streaming'] / bandwidth['regular'],
+                })
+                print("{:<22} {:>10} elements: streaming {:8.2f} GB/s, regular {:8.2f} GB/s, {:5.2f}x".format(
+                    name, numel, bandwidth['streaming'], bandwidth['regular'],
+                    bandwidth['streaming'] / bandwidth['regular']))
+    finally:
+        ipex._C.set_streaming_store_threshold(default_threshold)
+
+    report = {
+        'machine': platform.processor() or platform.machine(),
+        'torch_version': torch.__version__,
+        'ipex_version': ipex.__version__,
+        'threads': torch.get_num_threads(),
+        'default_threshold_bytes': default_threshold,
+        'results': results,
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        print(json.dumps(report, indent=2))
+
+if __name__ == "__main__":
+    run()
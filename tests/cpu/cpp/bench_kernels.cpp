@@ -0,0 +1,249 @@
+// The microbenchmarks of the IPEX kernels: each case is timed for each ISA
+// level its dispatch stub has a kernel of on this CPU and each thread count,
+// and the results are printed as JSON, to track the kernels across releases.
+//
+//   ipex_cpp_bench [--threads 1,28,56] [--filter interaction]
+//                  [--min-time-ms 200] [--output bench.json]
+//
+// The ops are called through the dispatcher, as from Python, the bytes and
+// FLOPs of a case being its minimum traffic and its math.
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <torch/torch.h>
+#include "csrc/cpu/dyndisp/DispatchStub.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace torch_ipex::cpu;
+
+namespace {
+
+struct BenchCase {
+  std::string op;
+  // the dispatch stub whose ISA level is swept
+  std::string stub;
+  std::string shape;
+  std::function<torch::jit::Stack()> make_inputs;
+  int64_t bytes;
+  int64_t flops;
+};
+
+std::vector<BenchCase> bench_cases() {
+  std::vector<BenchCase> cases;
+  // DLRM: the bottom MLP output and 26 sparse features
+  for (int64_t batch : {128, 2048}) {
+    for (auto dtype : {at::kFloat, at::kBFloat16}) {
+      int64_t n = 27, dim = 128;
+      std::ostringstream shape;
+      shape << "B" << batch << "xF" << n << "xD" << dim << "_" << dtype;
+      cases.push_back(
+          {"torch_ipex::interaction_forward",
+           "interaction_forward_kernel_stub",
+           shape.str(),
+           [=]() {
+             std::vector<at::Tensor> input;
+             for (int64_t i = 0; i < n; i++)
+               input.push_back(at::randn({batch, dim}).to(dtype));
+             return torch::jit::Stack{input};
+           },
+           batch * n * dim * at::elementSize(dtype) * 2,
+           batch * n * (n - 1) * dim});
+    }
+  }
+  // 26 tables of 100K rows, one or 20 indices per bag
+  for (int64_t pooling : {1, 20}) {
+    int64_t tables = 26, rows = 100000, dim = 128, batch = 2048;
+    std::ostringstream shape;
+    shape << "T" << tables << "xR" << rows << "xD" << dim << "_B" << batch
+          << "xP" << pooling;
+    cases.push_back(
+        {"torch_ipex::merged_embeddingbag_forward",
+         "merged_embeddingbag_forward_cpu_kernel_stub",
+         shape.str(),
+         [=]() {
+           std::vector<at::Tensor> weights;
+           for (int64_t t = 0; t < tables; t++)
+             weights.push_back(at::randn({rows, dim}));
+           int64_t n = tables * batch * pooling;
+           auto indices = at::randint(rows, {n}, at::kLong);
+           // the last offset included
+           auto offsets = at::arange(0, n + 1, pooling);
+           std::vector<int64_t> modes(tables, 0);
+           return torch::jit::Stack{indices, offsets, weights, modes};
+         },
+         tables * batch * (pooling * (dim * 4 + 8) + dim * 4),
+         tables * batch * pooling * dim});
+  }
+  // query, key and value of [B, N, L, H]
+  for (auto& bnlh : std::vector<std::vector<int64_t>>{
+           {1, 32, 1024, 128}, {8, 16, 384, 64}}) {
+    for (bool causal : {false, true}) {
+      std::ostringstream shape;
+      shape << "B" << bnlh[0] << "xN" << bnlh[1] << "xL" << bnlh[2] << "xH"
+            << bnlh[3] << (causal ? "_causal" : "");
+      int64_t numel = bnlh[0] * bnlh[1] * bnlh[2] * bnlh[3];
+      cases.push_back(
+          {"torch_ipex::flash_attention",
+           "flash_attention_forward_kernel_stub",
+           shape.str(),
+           [=]() {
+             auto q = at::randn(bnlh).to(at::kBFloat16);
+             auto k = at::randn(bnlh).to(at::kBFloat16);
+             auto v = at::randn(bnlh).to(at::kBFloat16);
+             double scale = 1. / std::sqrt(static_cast<double>(bnlh[3]));
+             return torch::jit::Stack{q, k, v, scale, causal};
+           },
+           numel * 2 * 4,
+           4 * numel * bnlh[2] / (causal ? 2 : 1)});
+    }
+  }
+  for (int64_t tokens : {1, 2048}) {
+    int64_t hidden = 4096;
+    std::ostringstream shape;
+    shape << "M" << tokens << "xN" << hidden << "_bf16";
+    cases.push_back(
+        {"torch_ipex::add_rmsnorm",
+         "add_rmsnorm_kernel_stub",
+         shape.str(),
+         [=]() {
+           auto input = at::randn({tokens, hidden}).to(at::kBFloat16);
+           auto residual = at::randn({tokens, hidden}).to(at::kBFloat16);
+           auto weight = at::randn({hidden});
+           return torch::jit::Stack{input, residual, weight, 1e-6};
+         },
+         tokens * hidden * 2 * 4 + hidden * 4,
+         tokens * hidden * 5});
+  }
+  for (int64_t numel : {int64_t(1) << 16, int64_t(1) << 24}) {
+    std::ostringstream shape;
+    shape << "N" << numel << "_fp32";
+    cases.push_back(
+        {"torch_ipex::adam_fused_step",
+         "adam_fused_step_kernel_stub",
+         shape.str(),
+         [=]() {
+           auto param = at::randn({numel});
+           return torch::jit::Stack{
+               param,
+               at::zeros({numel}),
+               at::zeros({numel}),
+               at::empty({0}),
+               at::randn({numel}),
+               at::empty({0}),
+               false,
+               1.,
+               0.9,
+               0.999,
+               1e-3,
+               0.,
+               1e-8};
+         },
+         numel * 4 * 7,
+         numel * 12});
+  }
+  return cases;
+}
+
+struct Options {
+  std::vector<int> threads;
+  std::string filter;
+  double min_time_ms = 200;
+  std::string output;
+};
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i], value = argv[i + 1];
+    if (key == "--threads") {
+      std::stringstream ss(value);
+      std::string t;
+      while (std::getline(ss, t, ','))
+        options.threads.push_back(std::stoi(t));
+    } else if (key == "--filter") {
+      options.filter = value;
+    } else if (key == "--min-time-ms") {
+      options.min_time_ms = std::stod(value);
+    } else if (key == "--output") {
+      options.output = value;
+    } else {
+      TORCH_CHECK(false, "unknown option ", key);
+    }
+  }
+  if (options.threads.empty())
+    options.threads.push_back(at::get_num_threads());
+  return options;
+}
+
+// The median time of a call in us, over at least 5 calls and min_time_ms
+double time_call(
+    const c10::OperatorHandle& op,
+    const torch::jit::Stack& inputs,
+    double min_time_ms) {
+  using clock = std::chrono::steady_clock;
+  std::vector<double> times;
+  double total_ms = 0;
+  for (int i = 0; i < 3 || times.size() < 5 || total_ms < min_time_ms; i++) {
+    auto stack = inputs;
+    auto start = clock::now();
+    op.callBoxed(&stack);
+    double ms =
+        std::chrono::duration<double, std::milli>(clock::now() - start)
+            .count();
+    // the first 3 calls warm up the caches and the kernels
+    if (i >= 3) {
+      times.push_back(ms);
+      total_ms += ms;
+    }
+  }
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2] * 1e3;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  auto options = parse_options(argc, argv);
+  std::ostringstream json;
+  json << "[";
+  bool first = true;
+  for (auto& bench : bench_cases()) {
+    if (bench.op.find(options.filter) == std::string::npos &&
+        bench.shape.find(options.filter) == std::string::npos)
+      continue;
+    auto op =
+        c10::Dispatcher::singleton().findSchemaOrThrow(bench.op.c_str(), "");
+    auto inputs = bench.make_inputs();
+    for (auto isa : get_dispatch_stub_isa_levels(bench.stub)) {
+      set_dispatch_stub_isa_level(bench.stub, isa);
+      for (int threads : options.threads) {
+        at::set_num_threads(threads);
+        double us = time_call(op, inputs, options.min_time_ms);
+        std::ostringstream result;
+        result << "{\"op\": \"" << bench.op << "\", \"shape\": \""
+               << bench.shape << "\", \"isa\": \""
+               << CPUCapabilityToString(isa) << "\", \"threads\": " << threads
+               << ", \"us\": " << us
+               << ", \"gbps\": " << bench.bytes / us / 1e3
+               << ", \"gflops\": " << bench.flops / us / 1e3 << "}";
+        std::cerr << result.str() << std::endl;
+        json << (first ? "\n  " : ",\n  ") << result.str();
+        first = false;
+      }
+    }
+    reset_dispatch_stub_isa_level(bench.stub);
+  }
+  json << "\n]\n";
+  if (options.output.empty()) {
+    std::cout << json.str();
+  } else {
+    std::ofstream(options.output) << json.str();
+  }
+  return 0;
+}
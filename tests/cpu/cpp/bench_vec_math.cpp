@@ -0,0 +1,179 @@
+// The microbenchmark of the vectorized math functions of vec512_math.h and
+// vec256_math.h: each function is timed at each accuracy on each ISA level of
+// this CPU, against the scalar libm, over a buffer resident in L1, and the
+// results are printed as JSON in ns per element, on a single thread.
+//
+//   ipex_cpp_bench_vec_math [--filter tanh] [--len 4096]
+//                           [--min-time-ms 200] [--output bench.json]
+#include "csrc/cpu/isa/cpu_feature.hpp"
+#include "vec_math_fns.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace torch_ipex::cpu;
+
+namespace {
+
+struct Options {
+  std::string filter;
+  int64_t len = 4096;
+  double min_time_ms = 200;
+  std::string output;
+};
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i], value = argv[i + 1];
+    if (key == "--filter") {
+      options.filter = value;
+    } else if (key == "--len") {
+      options.len = std::stoll(value);
+    } else if (key == "--min-time-ms") {
+      options.min_time_ms = std::stod(value);
+    } else if (key == "--output") {
+      options.output = value;
+    } else {
+      throw std::invalid_argument("unknown option " + key);
+    }
+  }
+  return options;
+}
+
+// The scalar libm functions, as the kernels called them per element
+template <float (*fn)(float)>
+void libm_fn(float* out, const float* in, int64_t len) {
+  for (int64_t i = 0; i < len; i++) {
+    out[i] = fn(in[i]);
+  }
+}
+
+float libm_exp(float x) {
+  return std::exp(x);
+}
+
+float libm_log(float x) {
+  return std::log(x);
+}
+
+float libm_tanh(float x) {
+  return std::tanh(x);
+}
+
+float libm_erf(float x) {
+  return std::erf(x);
+}
+
+float libm_sigmoid(float x) {
+  return 1.f / (1.f + std::exp(-x));
+}
+
+std::vector<vec_math::MathFn> libm_math_fns() {
+  return {
+      {"exp", libm_fn<libm_exp>, libm_fn<libm_exp>},
+      {"log", libm_fn<libm_log>, libm_fn<libm_log>},
+      {"tanh", libm_fn<libm_tanh>, libm_fn<libm_tanh>},
+      {"erf", libm_fn<libm_erf>, libm_fn<libm_erf>},
+      {"sigmoid", libm_fn<libm_sigmoid>, libm_fn<libm_sigmoid>},
+  };
+}
+
+// The median time of a call in ns per element, over at least 5 calls and
+// min_time_ms
+double time_fn(
+    vec_math::ArrayFn fn,
+    float* out,
+    const float* in,
+    int64_t len,
+    double min_time_ms) {
+  using clock = std::chrono::steady_clock;
+  std::vector<double> times;
+  double total_ms = 0;
+  for (int i = 0; i < 3 || times.size() < 5 || total_ms < min_time_ms; i++) {
+    auto start = clock::now();
+    fn(out, in, len);
+    double ms =
+        std::chrono::duration<double, std::milli>(clock::now() - start)
+            .count();
+    // the first 3 calls warm up the caches
+    if (i >= 3) {
+      times.push_back(ms);
+      total_ms += ms;
+    }
+  }
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2] * 1e6 / len;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  auto options = parse_options(argc, argv);
+  // the inputs of the activations, and positive ones for log
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-4.f, 4.f);
+  std::uniform_real_distribution<float> positive(1e-3f, 1e3f);
+  std::vector<float> in(options.len), in_log(options.len), out(options.len);
+  for (int64_t i = 0; i < options.len; i++) {
+    in[i] = dist(gen);
+    in_log[i] = positive(gen);
+  }
+
+  std::vector<std::pair<std::string, std::vector<vec_math::MathFn>>> isas;
+  if (CPUFeature::get_instance().isa_level_avx512_core()) {
+    isas.push_back({"avx512", vec_math::avx512_math_fns()});
+  }
+  if (CPUFeature::get_instance().isa_level_avx2()) {
+    isas.push_back({"avx2", vec_math::avx2_math_fns()});
+  }
+  isas.push_back({"libm", libm_math_fns()});
+
+  std::ostringstream json;
+  json << "[";
+  bool first = true;
+  for (auto& isa : isas) {
+    for (auto& fn : isa.second) {
+      if (std::string(fn.name).find(options.filter) == std::string::npos)
+        continue;
+      const float* x =
+          std::string(fn.name) == "log" ? in_log.data() : in.data();
+      for (bool accurate : {false, true}) {
+        // libm has a single accuracy
+        if (accurate && isa.first == "libm")
+          continue;
+        double ns = time_fn(
+            accurate ? fn.accurate : fn.fast,
+            out.data(),
+            x,
+            options.len,
+            options.min_time_ms);
+        std::ostringstream result;
+        result << "{\"fn\": \"" << fn.name << "\", \"isa\": \"" << isa.first
+               << "\", \"accuracy\": \""
+               << (isa.first == "libm" ? "libm"
+                                       : (accurate ? "accurate" : "fast"))
+               << "\", \"len\": " << options.len
+               << ", \"ns_per_element\": " << ns << "}";
+        std::cerr << result.str() << std::endl;
+        json << (first ? "\n  " : ",\n  ") << result.str();
+        first = false;
+      }
+    }
+  }
+  json << "\n]\n";
+  if (options.output.empty()) {
+    std::cout << json.str();
+  } else {
+    std::ofstream(options.output) << json.str();
+  }
+  return 0;
+}
@@ -40,21 +40,29 @@ TEST(TestDynDispAndIsaAPI, TestIsaRegs) {
 
 TEST(TestDynDispAndIsaAPI, TestIsaLevels) {
   CPUFeature::get_instance().isa_level_amx();
+  CPUFeature::get_instance().isa_level_amx_fp16();
   CPUFeature::get_instance().isa_level_avx2();
   CPUFeature::get_instance().isa_level_avx2_vnni();
   CPUFeature::get_instance().isa_level_avx512_core();
   CPUFeature::get_instance().isa_level_avx512_vnni();
   CPUFeature::get_instance().isa_level_avx512_bf16();
+  CPUFeature::get_instance().isa_level_avx512_fp16();
+  CPUFeature::get_instance().isa_level_avx10_1();
+  CPUFeature::get_instance().isa_level_avx10_2();
 }
 
 TEST(TestDynDispAndIsaAPI, TestDynDispFunc) {
   ASSERT_STRING_EQ(CPUCapabilityToString(CPUCapability::AMX), "AMX");
+  ASSERT_STRING_EQ(
+      CPUCapabilityToString(CPUCapability::AMX_FP16), "AMX_FP16");
   ASSERT_STRING_EQ(CPUCapabilityToString(CPUCapability::AVX2), "AVX2");
   ASSERT_STRING_EQ(
       CPUCapabilityToString(CPUCapability::AVX2_VNNI), "AVX2_VNNI");
   ASSERT_STRING_EQ(CPUCapabilityToString(CPUCapability::AVX512), "AVX512");
   ASSERT_STRING_EQ(
       CPUCapabilityToString(CPUCapability::AVX512_BF16), "AVX512_BF16");
+  ASSERT_STRING_EQ(
+      CPUCapabilityToString(CPUCapability::AVX512_FP16), "AVX512_FP16");
   ASSERT_STRING_EQ(
       CPUCapabilityToString(CPUCapability::AVX512_VNNI), "AVX512_VNNI");
   ASSERT_STRING_EQ(CPUCapabilityToString(CPUCapability::DEFAULT), "DEFAULT");
@@ -0,0 +1,174 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "csrc/cpu/utils/rcu.h"
+#include "gtest/gtest.h"
+
+using torch_ipex::utils::EpochDomain;
+using torch_ipex::utils::RcuMap;
+
+namespace {
+
+// Blocks the calling thread until the flag is set
+void wait_for(const std::atomic<bool>& flag) {
+  while (!flag.load()) {
+    std::this_thread::yield();
+  }
+}
+
+std::string value_of(int key) {
+  // long enough not to fit in the small string buffer, so that a read of a
+  // freed snapshot reads freed memory
+  return "value of the key " + std::to_string(key) + " of the rcu map";
+}
+
+} // namespace
+
+TEST(TestRcu, TestFindInsertErase) {
+  RcuMap<int, std::string> map;
+  std::string value;
+  EXPECT_FALSE(map.find(1, value));
+  EXPECT_EQ(map.insert(1, value_of(1)), value_of(1));
+  // an insert of a present key keeps the value of the map
+  EXPECT_EQ(map.insert(1, value_of(2)), value_of(1));
+  ASSERT_TRUE(map.find(1, value));
+  EXPECT_EQ(value, value_of(1));
+  EXPECT_EQ(map.size(), 1u);
+  map.erase(1);
+  EXPECT_FALSE(map.find(1, value));
+  EXPECT_EQ(map.size(), 0u);
+}
+
+TEST(TestRcu, TestConcurrentFindInsertErase) {
+  constexpr int kKeys = 64;
+  constexpr int kReaders = 4;
+  constexpr int kRounds = 200;
+  RcuMap<int, std::string> map;
+  // the even keys are never erased
+  for (int key = 0; key < kKeys; key += 2) {
+    map.insert(key, value_of(key));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < kReaders; t++) {
+    readers.emplace_back([&]() {
+      std::string value;
+      while (!done.load()) {
+        for (int key = 0; key < kKeys; key++) {
+          bool found = map.find(key, value);
+          if ((key % 2 == 0 && !found) || (found && value != value_of(key))) {
+            errors++;
+          }
+        }
+        map.for_each([&](const int& key, const std::string& value) {
+          if (value != value_of(key)) {
+            errors++;
+          }
+        });
+      }
+    });
+  }
+
+  for (int round = 0; round < kRounds; round++) {
+    for (int key = 1; key < kKeys; key += 2) {
+      map.insert(key, value_of(key));
+    }
+    for (int key = 1; key < kKeys; key += 2) {
+      map.erase(key);
+    }
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(map.size(), static_cast<size_t>(kKeys / 2));
+}
+
+TEST(TestRcu, TestRetiredReclaimedAfterReadersLeave) {
+  auto& domain = EpochDomain::global();
+  std::atomic<bool> reading{false};
+  std::atomic<bool> leave{false};
+  std::thread reader([&]() {
+    EpochDomain::ReadGuard guard;
+    reading = true;
+    wait_for(leave);
+  });
+  wait_for(reading);
+
+  // the reader may have read the snapshot retired while it reads
+  std::atomic<bool> deleted{false};
+  domain.retire([&]() { deleted = true; });
+  domain.reclaim();
+  EXPECT_FALSE(deleted.load());
+
+  // a reader entering after the retire cannot see it
+  {
+    EpochDomain::ReadGuard guard;
+    domain.reclaim();
+    EXPECT_FALSE(deleted.load());
+  }
+
+  leave = true;
+  reader.join();
+  domain.reclaim();
+  EXPECT_TRUE(deleted.load());
+}
+
+TEST(TestRcu, TestNestedReadGuards) {
+  auto& domain = EpochDomain::global();
+  std::atomic<bool> deleted{false};
+  {
+    EpochDomain::ReadGuard outer;
+    {
+      EpochDomain::ReadGuard inner;
+    }
+    // leaving the inner guard does not end the read of the outer one
+    std::thread writer([&]() { domain.retire([&]() { deleted = true; }); });
+    writer.join();
+    domain.reclaim();
+    EXPECT_FALSE(deleted.load());
+    {
+      EpochDomain::ReadGuard inner;
+      domain.reclaim();
+      EXPECT_FALSE(deleted.load());
+    }
+  }
+  domain.reclaim();
+  EXPECT_TRUE(deleted.load());
+}
+
+TEST(TestRcu, TestReplacedSnapshotKeptForReader) {
+  // a value whose deletion with its snapshot is observable
+  RcuMap<int, std::shared_ptr<int>> map;
+  auto value = std::make_shared<int>(42);
+  std::weak_ptr<int> observer = value;
+  map.insert(0, value);
+  value.reset();
+
+  std::atomic<bool> reading{false};
+  std::atomic<bool> leave{false};
+  std::thread reader([&]() {
+    EpochDomain::ReadGuard guard;
+    std::shared_ptr<int> found;
+    map.find(0, found);
+    found.reset();
+    reading = true;
+    wait_for(leave);
+  });
+  wait_for(reading);
+
+  // the erase unlinks the snapshot holding the value, which the reader may
+  // still be reading
+  map.erase(0);
+  EXPECT_FALSE(observer.expired());
+
+  leave = true;
+  reader.join();
+  EpochDomain::global().reclaim();
+  EXPECT_TRUE(observer.expired());
+}
@@ -1,5 +1,7 @@
 #include <torch/torch.h>
 #include "csrc/cpu/runtime/CPUPool.h"
+#include "csrc/cpu/runtime/InferenceSession.h"
+#include "csrc/cpu/runtime/ScriptModuleTask.h"
 #include "csrc/cpu/runtime/Task.h"
 #include "csrc/cpu/runtime/TaskExecutor.h"
 #include "gtest/gtest.h"
@@ -47,6 +49,34 @@ TEST(TestRuntimeAPI, TestMainThreadCoreBindWithCPUPool) {
   auto res_ = at::softmax(input_tensor, -1);
 }
 
+TEST(TestRuntimeAPI, TestCPUPoolNumaNodeBinding) {
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    GTEST_SKIP()
+        << "Skip TestRuntimeAPI::TestCPUPoolNumaNodeBinding. Didn't preload IOMP.";
+  }
+  at::Tensor input_tensor = at::rand({1024, 1024});
+  auto res_ref = at::softmax(input_tensor, -1);
+  std::vector<int32_t> cpu_core_list({0});
+  torch_ipex::runtime::CPUPool cpu_pool(cpu_core_list);
+  std::vector<int32_t> numa_node_ids = cpu_pool.get_numa_node_ids();
+  ASSERT_EQ(
+      numa_node_ids,
+      torch_ipex::runtime::get_numa_node_ids_of_cores(cpu_core_list));
+  std::vector<int32_t> previous_numa_node_ids =
+      torch_ipex::runtime::get_thread_numa_node_ids();
+  {
+    torch_ipex::runtime::WithCPUPool with_cpu_pool(std::move(cpu_pool));
+    if (numa_node_ids.size() < torch_ipex::runtime::get_num_numa_nodes()) {
+      // The pool covers part of the nodes only
+      ASSERT_EQ(torch_ipex::runtime::get_thread_numa_node_ids(), numa_node_ids);
+    }
+    auto res = at::softmax(input_tensor, -1);
+    ASSERT_VARIABLE_EQ(res, res_ref);
+  }
+  ASSERT_EQ(
+      torch_ipex::runtime::get_thread_numa_node_ids(), previous_numa_node_ids);
+}
+
 TEST(TestRuntimeTaskAPI, TestTaskAPINativeTorchOperation) {
   if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
     GTEST_SKIP()
@@ -430,3 +460,162 @@ TEST(TestRuntimeTaskAPI, TestTaskAPISameTasksMultiTensorInputs) {
   ASSERT_VARIABLE_EQ(res, res_ref);
   ASSERT_VARIABLE_EQ(res2, res_ref2);
 }
+
+TEST(TestRuntimeTaskAPI, TestTaskQueueMultiProducer) {
+  // A small queue, the producers wait for the consumer to free the slots
+  torch_ipex::runtime::TaskQueue task_queue(4);
+  ASSERT_EQ(task_queue.capacity(), 4);
+  const int64_t num_producers = 4;
+  const int64_t tasks_per_producer = 1000;
+  std::vector<int64_t> sums(num_producers, 0);
+  std::vector<std::thread> producers;
+  for (int64_t p = 0; p < num_producers; p++) {
+    producers.emplace_back([&, p]() {
+      for (int64_t i = 0; i < tasks_per_producer; i++) {
+        while (!task_queue.try_push([&sums, p, i]() { sums[p] += i; })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  int64_t consumed = 0;
+  while (consumed < num_producers * tasks_per_producer) {
+    if (task_queue.pop()) {
+      consumed++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ASSERT_TRUE(task_queue.empty());
+  for (int64_t p = 0; p < num_producers; p++) {
+    ASSERT_EQ(sums[p], tasks_per_producer * (tasks_per_producer - 1) / 2);
+  }
+}
+
+TEST(TestRuntimeTaskAPI, TestTaskAPIMultiThreadSubmit) {
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    GTEST_SKIP()
+        << "Skip TestRuntimeTaskAPI::TestTaskAPIMultiThreadSubmit. Didn't preload IOMP.";
+  }
+  std::vector<int32_t> cpu_core_list({0});
+  torch_ipex::runtime::CPUPool cpu_pool(cpu_core_list);
+  // A small queue, the submits wait for the worker to free the slots
+  std::shared_ptr<torch_ipex::runtime::TaskExecutor> task_executor =
+      std::make_shared<torch_ipex::runtime::TaskExecutor>(cpu_pool, 2);
+
+  at::Tensor input_tensor = at::rand({10, 100});
+  auto res_ref = at::softmax(input_tensor, -1);
+  torch_ipex::runtime::
+      Task<at::Tensor (*)(const at::Tensor&), const at::Tensor&>
+          task(taskfunction_const_lvalue_reference, task_executor);
+
+  const int64_t num_threads = 4;
+  const int64_t tasks_per_thread = 50;
+  std::vector<std::vector<at::Tensor>> results(num_threads);
+  std::vector<std::thread> submitters;
+  for (int64_t t = 0; t < num_threads; t++) {
+    submitters.emplace_back([&, t]() {
+      std::vector<std::future<at::Tensor>> futures;
+      for (int64_t i = 0; i < tasks_per_thread; i++) {
+        futures.push_back(task(input_tensor));
+      }
+      for (auto& future : futures) {
+        results[t].push_back(future.get());
+      }
+    });
+  }
+  for (auto& submitter : submitters) {
+    submitter.join();
+  }
+  for (auto& thread_results : results) {
+    ASSERT_EQ(thread_results.size(), tasks_per_thread);
+    for (auto& res : thread_results) {
+      ASSERT_VARIABLE_EQ(res, res_ref);
+    }
+  }
+  // submit task to a stopped executor is not allowed
+  task_executor->stop_executor();
+  ASSERT_THROW(task(input_tensor), std::runtime_error);
+}
+
+TEST(TestRuntimeTaskAPI, TestScriptModuleTaskAPI) {
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    GTEST_SKIP()
+        << "Skip TestRuntimeTaskAPI::TestScriptModuleTaskAPI. Didn't preload IOMP.";
+  }
+  torch::jit::Module script_module("m");
+  script_module.define(R"(
+    def forward(self, x, y: int = 1):
+        if y < 0:
+            raise RuntimeError("negative y")
+        return x.softmax(-1) + y
+  )");
+  std::vector<int32_t> cpu_core_list({0});
+  torch_ipex::runtime::CPUPool cpu_pool(cpu_core_list);
+  torch_ipex::runtime::ScriptModuleTask task(script_module, cpu_pool);
+
+  at::Tensor input_tensor = at::rand({10, 100});
+  auto res_ref = at::softmax(input_tensor, -1) + 1;
+  // Sync API
+  ASSERT_VARIABLE_EQ(task.run_sync({input_tensor}).toTensor(), res_ref);
+  // Async API with the default and the keyword arguments
+  auto future = task.run_async({input_tensor});
+  auto future_kwargs = task.run_async({input_tensor}, {{"y", 2}});
+  future->wait();
+  ASSERT_VARIABLE_EQ(future->value().toTensor(), res_ref);
+  future_kwargs->wait();
+  ASSERT_VARIABLE_EQ(future_kwargs->value().toTensor(), res_ref + 1);
+  // Callbacks run with the output or the error
+  std::promise<at::Tensor> callback_output;
+  task.run_async({input_tensor})
+      ->addCallback([&](c10::ivalue::Future& future) {
+        callback_output.set_value(future.value().toTensor());
+      });
+  ASSERT_VARIABLE_EQ(callback_output.get_future().get(), res_ref);
+  auto future_error = task.run_async({input_tensor, -1});
+  future_error->wait();
+  ASSERT_TRUE(future_error->hasError());
+  // The inputs are checked on the calling thread
+  ASSERT_ANY_THROW(task.run_async({}));
+}
+
+TEST(TestRuntimeTaskAPI, TestInferenceSessionAPI) {
+  torch::jit::Module script_module("m");
+  script_module.register_parameter("weight", at::rand({64, 32}), false);
+  script_module.define(R"(
+    def forward(self, x):
+        return torch.matmul(x, self.weight).relu()
+  )");
+  at::Tensor input_tensor = at::rand({8, 64});
+  auto res_ref =
+      at::matmul(input_tensor, script_module.attr("weight").toTensor()).relu();
+
+  torch_ipex::runtime::InferenceOptions options;
+  options.warmup_inputs = {{input_tensor}};
+  // The streams need IOMP, a single stream runs on the calling thread
+  bool multi_streams = torch_ipex::runtime::is_runtime_ext_enabled() &&
+      torch_ipex::runtime::get_process_available_cores().size() >= 2;
+  options.num_streams = multi_streams ? 2 : 1;
+  torch_ipex::runtime::InferenceSession session(script_module, options);
+  ASSERT_EQ(session.num_streams(), options.num_streams);
+  // frozen
+  ASSERT_FALSE(session.module().hasattr("training"));
+
+  ASSERT_VARIABLE_EQ(session.run({input_tensor}).toTensor(), res_ref);
+  std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+  for (int i = 0; i < 8; i++) {
+    futures.push_back(session.submit({input_tensor}));
+  }
+  for (auto& future : futures) {
+    future->waitAndThrow();
+    ASSERT_VARIABLE_EQ(future->value().toTensor(), res_ref);
+    ASSERT_FALSE(future->value().toTensor().requires_grad());
+  }
+  // The errors are set on the futures
+  auto future_error = session.submit({at::rand({8, 3})});
+  future_error->wait();
+  ASSERT_TRUE(future_error->hasError());
+}
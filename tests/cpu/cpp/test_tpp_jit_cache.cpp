@@ -0,0 +1,56 @@
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "csrc/cpu/tpp/jit_compile.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const char* kJitSource = "extern \"C\" int jit_cache_answer() { return 42; }\n";
+
+std::vector<std::string> list_shared_objects(const std::string& dir) {
+  std::vector<std::string> names;
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL)
+    return names;
+  while (auto entry = readdir(d)) {
+    std::string name = entry->d_name;
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, ".so") == 0)
+      names.push_back(name);
+  }
+  closedir(d);
+  return names;
+}
+
+} // namespace
+
+TEST(TestTppJitCache, TestSecondCallHitsCache) {
+  char dir[] = "/tmp/ipex_tpp_jit_test_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  setenv("TPP_JIT_CACHE", "1", 1);
+  setenv("TPP_JIT_CACHE_DIR", dir, 1);
+  unsetenv("TPP_JIT_CXX");
+
+  using answer_fn = int (*)();
+  auto first = (answer_fn)torch_ipex::tpp::jit_from_str(
+      kJitSource, " -O2 ", "jit_cache_answer");
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first(), 42);
+  auto cached = list_shared_objects(dir);
+  ASSERT_EQ(cached.size(), 1u);
+
+  // a compiler which always fails: the second call can only load the cached
+  // shared object
+  setenv("TPP_JIT_CXX", "false", 1);
+  auto second = (answer_fn)torch_ipex::tpp::jit_from_str(
+      kJitSource, " -O2 ", "jit_cache_answer");
+  unsetenv("TPP_JIT_CXX");
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second(), 42);
+  EXPECT_EQ(list_shared_objects(dir), cached);
+
+  unlink((std::string(dir) + "/" + cached[0]).c_str());
+  rmdir(dir);
+}
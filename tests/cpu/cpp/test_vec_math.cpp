@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "csrc/cpu/isa/cpu_feature.hpp"
+#include "gtest/gtest.h"
+#include "vec_math_fns.h"
+
+using namespace torch_ipex::cpu;
+using vec_math::MathFn;
+
+namespace {
+
+const float kInf = std::numeric_limits<float>::infinity();
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+// The bounds of the functions, as documented in math_accuracy.h
+struct MathBound {
+  // the correctly rounded result, from the double precision libm
+  double (*ref)(double);
+  // the inputs over which the ULP bounds hold, the results of fast being
+  // above 2 * FLT_MIN
+  float accurate_lo;
+  float fast_lo;
+  float fast_hi;
+  double accurate_ulp;
+  // the fast ULP bound, or the absolute one for erf
+  double fast_ulp;
+  double fast_abs;
+};
+
+const std::map<std::string, MathBound>& math_bounds() {
+  // ln(2 * FLT_MIN) and ln(FLT_MAX)
+  const float ln_2_flt_min = -86.6433945f;
+  const float ln_flt_max = 88.7228394f;
+  static const std::map<std::string, MathBound> bounds = {
+      {"exp",
+       {[](double x) { return std::exp(x); },
+        -FLT_MAX,
+        ln_2_flt_min,
+        ln_flt_max,
+        1.5,
+        6.0,
+        0.0}},
+      {"log",
+       {[](double x) { return std::log(x); },
+        std::numeric_limits<float>::denorm_min(),
+        FLT_MIN,
+        FLT_MAX,
+        1.5,
+        6.0,
+        0.0}},
+      {"tanh",
+       {[](double x) { return std::tanh(x); },
+        -FLT_MAX,
+        -FLT_MAX,
+        FLT_MAX,
+        2.5,
+        6.0,
+        0.0}},
+      {"erf",
+       {[](double x) { return std::erf(x); },
+        -FLT_MAX,
+        -FLT_MAX,
+        FLT_MAX,
+        1.5,
+        0.0,
+        6e-7}},
+      {"sigmoid",
+       {[](double x) { return 1.0 / (1.0 + std::exp(-x)); },
+        -FLT_MAX,
+        ln_2_flt_min,
+        FLT_MAX,
+        2.5,
+        6.0,
+        0.0}},
+  };
+  return bounds;
+}
+
+// The error of got in the ULPs of ref, those of the denormals being the
+// smallest denormal
+double ulp_error(float got, double ref) {
+  if (std::isnan(ref) || std::isinf(static_cast<float>(ref)) ||
+      std::isnan(got) || std::isinf(got)) {
+    return got == static_cast<float>(ref) ||
+            (std::isnan(got) && std::isnan(ref))
+        ? 0.0
+        : std::numeric_limits<double>::infinity();
+  }
+  double ulp = std::fabs(ref) < FLT_MIN
+      ? std::ldexp(1.0, -149)
+      : std::ldexp(1.0, std::ilogb(ref) - 23);
+  return std::fabs(got - ref) / ulp;
+}
+
+// The bits of the float as an integer of the order of the floats
+int64_t float_order(float x) {
+  int32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits < 0 ? int64_t(INT32_MIN) - bits : bits;
+}
+
+float order_float(int64_t order) {
+  int32_t bits = order < 0 ? int32_t(int64_t(INT32_MIN) - order) : order;
+  float x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+// About count floats of [lo, hi], as many in each binade, and hi
+std::vector<float> float_range(float lo, float hi, int64_t count) {
+  const int64_t begin = float_order(lo), end = float_order(hi);
+  const int64_t step = std::max<int64_t>(1, (end - begin) / count);
+  std::vector<float> values;
+  for (int64_t order = begin; order < end; order += step) {
+    values.push_back(order_float(order));
+  }
+  values.push_back(hi);
+  return values;
+}
+
+// The largest error of fn over the floats of [lo, hi], in ULPs or absolute
+void expect_bound(
+    const char* isa,
+    const char* name,
+    vec_math::ArrayFn fn,
+    double (*ref)(double),
+    float lo,
+    float hi,
+    double max_ulp,
+    double max_abs) {
+  auto in = float_range(lo, hi, 1 << 22);
+  std::vector<float> out(in.size());
+  fn(out.data(), in.data(), in.size());
+  double worst = 0.0;
+  float worst_x = 0.f;
+  for (size_t i = 0; i < in.size(); i++) {
+    const double expected = ref(in[i]);
+    const double error = max_ulp > 0.0 ? ulp_error(out[i], expected)
+                                       : std::fabs(out[i] - expected);
+    if (!(error <= worst)) {
+      worst = error;
+      worst_x = in[i];
+    }
+  }
+  EXPECT_LE(worst, max_ulp > 0.0 ? max_ulp : max_abs)
+      << isa << " " << name << " at " << worst_x;
+}
+
+void expect_value(
+    const char* isa,
+    const char* name,
+    vec_math::ArrayFn fn,
+    float x,
+    float expected) {
+  float got = 0.f;
+  fn(&got, &x, 1);
+  if (std::isnan(expected)) {
+    EXPECT_TRUE(std::isnan(got)) << isa << " " << name << "(" << x << ")";
+  } else {
+    EXPECT_TRUE(
+        got == expected && std::signbit(got) == std::signbit(expected))
+        << isa << " " << name << "(" << x << ") = " << got << ", expected "
+        << expected;
+  }
+}
+
+void check_accurate_bounds(const char* isa, const std::vector<MathFn>& fns) {
+  for (const auto& fn : fns) {
+    const auto& bound = math_bounds().at(fn.name);
+    expect_bound(
+        isa,
+        fn.name,
+        fn.accurate,
+        bound.ref,
+        bound.accurate_lo,
+        FLT_MAX,
+        bound.accurate_ulp,
+        0.0);
+  }
+}
+
+void check_fast_bounds(const char* isa, const std::vector<MathFn>& fns) {
+  for (const auto& fn : fns) {
+    const auto& bound = math_bounds().at(fn.name);
+    expect_bound(
+        isa,
+        fn.name,
+        fn.fast,
+        bound.ref,
+        bound.fast_lo,
+        bound.fast_hi,
+        bound.fast_ulp,
+        bound.fast_abs);
+  }
+}
+
+void check_special_values(const char* isa, const std::vector<MathFn>& fns) {
+  // the results of libm, exactly
+  const std::map<std::string, std::vector<std::pair<float, float>>> values = {
+      {"exp",
+       {{0.f, 1.f},
+        {-0.f, 1.f},
+        {kInf, kInf},
+        {-kInf, 0.f},
+        {89.f, kInf},
+        {1e10f, kInf},
+        {-1e10f, 0.f}}},
+      {"log",
+       {{1.f, 0.f},
+        {0.f, -kInf},
+        {-0.f, -kInf},
+        {kInf, kInf},
+        {-1.f, kNaN},
+        {-kInf, kNaN},
+        {-std::numeric_limits<float>::denorm_min(), kNaN}}},
+      {"tanh",
+       {{0.f, 0.f},
+        {-0.f, -0.f},
+        {kInf, 1.f},
+        {-kInf, -1.f},
+        {20.f, 1.f},
+        {-20.f, -1.f}}},
+      {"erf",
+       {{0.f, 0.f},
+        {-0.f, -0.f},
+        {kInf, 1.f},
+        {-kInf, -1.f},
+        {10.f, 1.f},
+        {-10.f, -1.f}}},
+      {"sigmoid",
+       {{0.f, 0.5f},
+        {-0.f, 0.5f},
+        {kInf, 1.f},
+        {-kInf, 0.f},
+        {-1e10f, 0.f}}},
+  };
+  for (const auto& fn : fns) {
+    for (const auto& value : values.at(fn.name)) {
+      expect_value(isa, fn.name, fn.accurate, value.first, value.second);
+    }
+    // NaN propagates through both
+    expect_value(isa, fn.name, fn.accurate, kNaN, kNaN);
+    expect_value(isa, fn.name, fn.fast, kNaN, kNaN);
+  }
+  // the fast exp flushes the results below 2 * FLT_MIN
+  expect_value(isa, "exp", fns[0].fast, -100.f, 0.f);
+  expect_value(isa, "exp", fns[0].fast, -kInf, 0.f);
+}
+
+// The elements past len are not written, and those before it are those of a
+// whole vector
+void check_tails(const char* isa, const std::vector<MathFn>& fns) {
+  const float sentinel = -12345.f;
+  for (const auto& fn : fns) {
+    auto in = float_range(0.5f, 2.f, 64);
+    std::vector<float> ref(in.size());
+    fn.accurate(ref.data(), in.data(), in.size());
+    for (int64_t len = 1; len <= 33; len++) {
+      std::vector<float> out(len + 16, sentinel);
+      fn.accurate(out.data(), in.data(), len);
+      for (int64_t i = 0; i < len + 16; i++) {
+        EXPECT_EQ(out[i], i < len ? ref[i] : sentinel)
+            << isa << " " << fn.name << " of " << len << " elements at " << i;
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST(TestVecMath, TestAvx512AccurateBounds) {
+  if (!CPUFeature::get_instance().isa_level_avx512_core()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx512AccurateBounds. No AVX512.";
+  }
+  check_accurate_bounds("avx512", vec_math::avx512_math_fns());
+}
+
+TEST(TestVecMath, TestAvx512FastBounds) {
+  if (!CPUFeature::get_instance().isa_level_avx512_core()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx512FastBounds. No AVX512.";
+  }
+  check_fast_bounds("avx512", vec_math::avx512_math_fns());
+}
+
+TEST(TestVecMath, TestAvx512SpecialValues) {
+  if (!CPUFeature::get_instance().isa_level_avx512_core()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx512SpecialValues. No AVX512.";
+  }
+  check_special_values("avx512", vec_math::avx512_math_fns());
+  check_tails("avx512", vec_math::avx512_math_fns());
+}
+
+TEST(TestVecMath, TestAvx2AccurateBounds) {
+  if (!CPUFeature::get_instance().isa_level_avx2()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx2AccurateBounds. No AVX2.";
+  }
+  check_accurate_bounds("avx2", vec_math::avx2_math_fns());
+}
+
+TEST(TestVecMath, TestAvx2FastBounds) {
+  if (!CPUFeature::get_instance().isa_level_avx2()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx2FastBounds. No AVX2.";
+  }
+  check_fast_bounds("avx2", vec_math::avx2_math_fns());
+}
+
+TEST(TestVecMath, TestAvx2SpecialValues) {
+  if (!CPUFeature::get_instance().isa_level_avx2()) {
+    GTEST_SKIP() << "Skip TestVecMath::TestAvx2SpecialValues. No AVX2.";
+  }
+  check_special_values("avx2", vec_math::avx2_math_fns());
+  check_tails("avx2", vec_math::avx2_math_fns());
+}
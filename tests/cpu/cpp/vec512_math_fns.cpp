@@ -0,0 +1,50 @@
+// Built with the AVX512 flags of the kernels, see CMakeLists.txt
+#include "csrc/cpu/vec/vec.h"
+#include "vec_math_fns.h"
+
+using namespace torch_ipex::cpu::kernel;
+
+namespace vec_math {
+
+namespace {
+
+template <MathAccuracy acc>
+void exp_fn(float* out, const float* in, int64_t len) {
+  unary_math_ker(out, in, len, [](__m512 x) { return _exp_ps<acc>(x); });
+}
+
+template <MathAccuracy acc>
+void log_fn(float* out, const float* in, int64_t len) {
+  unary_math_ker(out, in, len, [](__m512 x) { return _log_ps<acc>(x); });
+}
+
+template <MathAccuracy acc>
+void tanh_fn(float* out, const float* in, int64_t len) {
+  unary_math_ker(out, in, len, [](__m512 x) { return _tanh_ps<acc>(x); });
+}
+
+template <MathAccuracy acc>
+void erf_fn(float* out, const float* in, int64_t len) {
+  unary_math_ker(out, in, len, [](__m512 x) { return _erf_ps<acc>(x); });
+}
+
+template <MathAccuracy acc>
+void sigmoid_fn(float* out, const float* in, int64_t len) {
+  unary_math_ker(out, in, len, [](__m512 x) { return _sigmoid_ps<acc>(x); });
+}
+
+} // namespace
+
+std::vector<MathFn> avx512_math_fns() {
+  return {
+      {"exp", exp_fn<MathAccuracy::Fast>, exp_fn<MathAccuracy::Accurate>},
+      {"log", log_fn<MathAccuracy::Fast>, log_fn<MathAccuracy::Accurate>},
+      {"tanh", tanh_fn<MathAccuracy::Fast>, tanh_fn<MathAccuracy::Accurate>},
+      {"erf", erf_fn<MathAccuracy::Fast>, erf_fn<MathAccuracy::Accurate>},
+      {"sigmoid",
+       sigmoid_fn<MathAccuracy::Fast>,
+       sigmoid_fn<MathAccuracy::Accurate>},
+  };
+}
+
+} // namespace vec_math
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The functions of vec512_math.h and vec256_math.h over float arrays, through
+// their unary_math_ker. Each ISA is built in a file of its own with the flags
+// of its kernels, so the tests and the benchmark call them by pointer.
+namespace vec_math {
+
+using ArrayFn = void (*)(float* out, const float* in, int64_t len);
+
+struct MathFn {
+  const char* name;
+  ArrayFn fast;
+  ArrayFn accurate;
+};
+
+// exp, log, tanh, erf and sigmoid, in this order
+std::vector<MathFn> avx512_math_fns();
+std::vector<MathFn> avx2_math_fns();
+
+} // namespace vec_math
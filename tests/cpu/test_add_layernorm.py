@@ -46,5 +46,68 @@ class AddLayerNormTester(TestCase):
                     # and causes mismatch with eager mode.
                     self.assertEqual(y1_bf16, y2_bf16, prec=5e-2)
 
+    def _run_add_layernorm_backward(self, fn, a, b, weight, bias, grad):
+        a = a.clone().requires_grad_()
+        b = b.clone().requires_grad_()
+        weight = weight.clone().requires_grad_()
+        bias = bias.clone().requires_grad_()
+        y = fn(a, b, weight, bias)
+        y.backward(grad)
+        return y, a.grad, b.grad, weight.grad, bias.grad
+
+    def test_add_layernorm_backward(self):
+        for dtype, prec in [(torch.float, 1e-4), (torch.bfloat16, 5e-2)]:
+            for input_size in [[4, 16], [2, 3, 35], [2, 5, 64]]:
+                size = input_size[-1]
+                a = torch.randn(input_size).to(dtype)
+                b = torch.randn(input_size).to(dtype)
+                grad = torch.randn(input_size).to(dtype)
+                # the weights of the bf16 inputs may be fp32
+                for weight_dtype in set([dtype, torch.float]):
+                    weight = torch.randn(size).to(weight_dtype)
+                    bias = torch.randn(size).to(weight_dtype)
+                    ref = self._run_add_layernorm_backward(
+                        lambda a, b, w, c: torch.nn.functional.layer_norm(
+                            (a.float() + b.float()), [size], w.float(), c.float()).to(dtype),
+                        a, b, weight, bias, grad)
+                    res = self._run_add_layernorm_backward(
+                        lambda a, b, w, c: torch.ops.torch_ipex.add_layernorm(a, b, [size], w, c, 1e-5),
+                        a, b, weight, bias, grad)
+                    for r, x in zip(ref, res):
+                        self.assertEqual(r.dtype, x.dtype)
+                        self.assertEqual(r.float(), x.float(), prec=prec)
+
+    def test_add_layernorm_backward_without_weight(self):
+        a = torch.randn(3, 10, requires_grad=True)
+        b = torch.randn(3, 10)
+        y = torch.ops.torch_ipex.add_layernorm(a, b, [10])
+        y.sum().backward()
+        a_ref = a.detach().clone().requires_grad_()
+        y_ref = torch.nn.functional.layer_norm(a_ref + b, [10])
+        y_ref.sum().backward()
+        self.assertEqual(y, y_ref)
+        self.assertEqual(a.grad, a_ref.grad)
+
+    def test_optimize_fuse_add_layernorm(self):
+        model = add_layernorm(16).train()
+        ref_model = add_layernorm(16).train()
+        ref_model.load_state_dict(model.state_dict())
+        optimizer = torch.optim.SGD(model.parameters(), lr=0.1)
+        opt_model, _ = ipex.optimize(model, optimizer=optimizer, level='O0', fuse_add_layernorm=True)
+        self.assertTrue(isinstance(opt_model, torch.fx.GraphModule))
+        self.assertTrue(any(
+            node.target is torch.ops.torch_ipex.add_layernorm for node in opt_model.graph.nodes))
+        a = torch.randn(4, 8, 16)
+        b = torch.randn(4, 8, 16)
+        y = opt_model(a, b)
+        y_ref = ref_model(a, b)
+        self.assertEqual(y, y_ref, prec=1e-5)
+        y.sum().backward()
+        y_ref.sum().backward()
+        self.assertEqual(
+            opt_model.layer_norm.weight.grad, ref_model.layer_norm.weight.grad, prec=1e-4)
+        self.assertEqual(
+            opt_model.layer_norm.bias.grad, ref_model.layer_norm.bias.grad, prec=1e-4)
+
 if __name__ == '__main__':
     test = unittest.main()
\ No newline at end of file
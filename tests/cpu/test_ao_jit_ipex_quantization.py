@@ -215,6 +215,40 @@ class TestIpexOps(JitLlgaTestCase):
         self.assertEqual(ori_out, out)
         self.assertGraphContainsExactly(graph, 'quantized::add', 1)
 
+    def test_norm_activation_int8(self):
+        class M(nn.Module):
+            def __init__(self, op):
+                super(M, self).__init__()
+                self.op = op
+
+            def forward(self, x):
+                out = self.op(torch.dequantize(x))
+                return torch.quantize_per_tensor(out, 0.05, 128, torch.quint8)
+
+        ln = nn.LayerNorm(64)
+        ln.weight.data.uniform_(0.5, 1.5)
+        ln.bias.data.uniform_(-0.5, 0.5)
+        for op, q_op in [
+                (ln, 'ipex::qlayer_norm'),
+                (nn.LayerNorm(64, elementwise_affine=False), 'ipex::qlayer_norm'),
+                (nn.Softmax(dim=-1), 'ipex::qsoftmax'),
+                (nn.Softmax(dim=1), 'ipex::qsoftmax'),
+                (nn.GELU(), 'ipex::qgelu'),
+                (nn.GELU(approximate='tanh'), 'ipex::qgelu')]:
+            for dtype, zp in [(torch.quint8, 128), (torch.qint8, 0)]:
+                m = M(op).eval()
+                x = torch.quantize_per_tensor(torch.randn(4, 8, 64) * 2, 0.04, zp, dtype)
+                with torch.no_grad():
+                    traced_model = torch.jit.trace(m, x)
+                    traced_model = torch.jit.freeze(traced_model)
+                    traced_model(x)
+                    graph = traced_model.graph_for(x)
+                    ori_out = m(x)
+                    out = traced_model(x)
+                # one step of the output scale for the rounding of the int8 kernels
+                self.assertEqual(ori_out.dequantize(), out.dequantize(), atol=0.05, rtol=0)
+                self.assertGraphContainsExactly(graph, q_op, 1)
+
     # This test case will be enabled after LSTM int8->fp32 works
     def test_lstm(self):
         class M(nn.Module):
@@ -308,6 +342,72 @@ class TestIpexOps(JitLlgaTestCase):
         self.assertGraphContainsExactly(graph, 'ipex::quantized_lstm', 1)        
         self.assertGraphContainsExactly(graph, 'aten::lstm', 0)        
 
+    def test_stacked_lstm(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.lstm1 = nn.LSTM(input_size=64, hidden_size=128, num_layers=1)
+                self.lstm2 = nn.LSTM(input_size=128, hidden_size=128, num_layers=1)
+
+            def forward(self, input):
+                x, _ = self.lstm1(input)
+                x, _ = self.lstm2(x)
+                return x
+
+        # each LSTM runs the int8 kernel on the int8 output of the previous one
+        model = M().eval()
+        seq = torch.randn(24, 1, 64)
+        graph = self.checkQuantizeTrace(model, [seq], atol=3e-2, rtol=1e-1)
+        self.assertGraphContainsExactly(graph, 'ipex::quantized_lstm', 2)
+        self.assertGraphContainsExactly(graph, 'aten::lstm', 0)
+
+    def test_lstm_qconfig(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.lstm = nn.LSTM(input_size=32, hidden_size=64, num_layers=2, bias=True)
+
+            def forward(self, x):
+                x, _ = self.lstm(x)
+                return x
+
+        per_tensor_weight_observer = MinMaxObserver.with_args(dtype=torch.qint8, qscheme=torch.per_tensor_symmetric)
+        # per channel and per tensor weights, asymmetric quint8 and symmetric qint8 activations
+        qconfigs = static_qconfig + [
+            QConfig(activation = MinMaxObserver.with_args(qscheme=torch.per_tensor_affine, dtype=torch.quint8),
+                    weight = per_tensor_weight_observer),
+            QConfig(activation = MinMaxObserver.with_args(qscheme=torch.per_tensor_symmetric, dtype=torch.qint8),
+                    weight = per_tensor_weight_observer)]
+        model = M().eval()
+        seq = torch.randn(24, 2, 32)
+        for qconfig in qconfigs:
+            graph = self.checkQuantizeTrace(model, [seq], atol=3e-2, rtol=1e-1, qconfig=qconfig)
+            self.assertGraphContainsExactly(graph, 'ipex::quantized_lstm', 1)
+            self.assertGraphContainsExactly(graph, 'aten::lstm', 0)
+
+    def test_embeddingbag_linear_interaction_int8(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(128, 128)
+                self.emb = nn.EmbeddingBag(10, 128, mode='sum', sparse=True)
+
+            def forward(self, dense, input, offsets):
+                x = self.linear(dense).relu()
+                y = self.emb(input, offsets)
+                return ipex.nn.functional.interaction(x, y)
+
+        # the int8 outputs of the LLGA partition and of the embedding bag feed
+        # the int8 interaction
+        m = M().eval()
+        dense = torch.randn(8, 128) * 0.1
+        input = torch.LongTensor([1, 2, 4, 5, 4, 3, 2, 9])
+        offsets = torch.LongTensor([0, 1, 2, 3, 4, 5, 6, 7])
+        graph = self.checkQuantizeTrace(m, [dense, input, offsets], atol=1e-2, qconfig=static_qconfig[1])
+        self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+        self.assertGraphContainsExactly(graph, 'ipex::qembedding_bag', 1)
+        self.assertGraphContainsExactly(graph, 'ipex::qinteraction', 1)
+
 class TestIpexQuantizationConvertAPI(JitLlgaTestCase):
     def test_inplace_preapre(self):
         class M(nn.Module):
@@ -356,6 +456,33 @@ class TestIpexQuantizationConvertAPI(JitLlgaTestCase):
                         print("model should not change")
                         assert(0)
 
+    def test_convert_weight_cache(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(128, 64)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        x = torch.rand(4, 128)
+        prepared_model = ipex.quantization.prepare(M().eval(), static_qconfig[0], example_inputs=x)
+        prepared_model(x)
+        converted_model = ipex.quantization.convert(prepared_model)
+        # the fp32 weights of the prepared model are shared, not copied
+        self.assertEqual(prepared_model.linear.weight.data_ptr(), converted_model.linear.weight.data_ptr())
+        with torch.no_grad():
+            y = converted_model(x)
+            qstate = converted_model._auto_quant_state
+            self.assertEqual(len(qstate.idx_to_quantized_weight), 1)
+            qweight = next(iter(qstate.idx_to_quantized_weight.values()))
+            self.assertEqual(qweight.dtype, torch.qint8)
+            # the later calls reuse the weight quantized at the first one
+            self.assertEqual(converted_model(x), y)
+            self.assertTrue(next(iter(qstate.idx_to_quantized_weight.values())) is qweight)
+            traced_model = torch.jit.freeze(torch.jit.trace(converted_model, x))
+            self.assertEqual(traced_model(x), y, atol=1e-2, rtol=1e-2)
+
     def test_qconf_summary_save_load(self):
         class M(nn.Module):
             def __init__(self):
@@ -457,6 +584,43 @@ class TestIpexQuantizationConvertAPI(JitLlgaTestCase):
         out = converted_model(x)
         print(out.__format__('.4f'))
 
+    def test_autotune(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv = nn.Conv2d(3, 16, 3, padding=1)
+                self.linear = nn.Linear(16, 8)
+
+            def forward(self, x):
+                x = F.relu(self.conv(x))
+                return self.linear(x.mean((2, 3)))
+
+        m = M().eval()
+        calib_dataloader = [torch.randn(2, 3, 8, 8) for _ in range(4)]
+        x = torch.randn(8, 3, 8, 8)
+        with torch.no_grad():
+            y_ref = m(x)
+
+        def eval_func(model):
+            with torch.no_grad():
+                return 1 / (1 + F.mse_loss(model(x), y_ref).item())
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            cwd = os.getcwd()
+            os.chdir(tmpdir)
+            try:
+                for num_workers, mixed_bf16 in [(1, False), (2, False), (1, True)]:
+                    prepared_model = ipex.quantization.prepare(m, static_qconfig[3], example_inputs=x)
+                    tuned_model = ipex.quantization.autotune(prepared_model, calib_dataloader, eval_func,
+                                                             sampling_sizes=[8], accuracy_criterion={'absolute': 0.5},
+                                                             num_workers=num_workers, mixed_bf16=mixed_bf16)
+                    with torch.cpu.amp.autocast(enabled=mixed_bf16), torch.no_grad():
+                        converted_model = ipex.quantization.convert(tuned_model)
+                        traced_model = torch.jit.freeze(torch.jit.trace(converted_model, x))
+                        self.assertGreaterEqual(eval_func(traced_model), eval_func(m) - 0.5)
+            finally:
+                os.chdir(cwd)
+
 
 class TestRemoveMutate(JitLlgaTestCase):
     def test_mutated_value_alive_after_inplace_op(self):
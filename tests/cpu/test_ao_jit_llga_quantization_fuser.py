@@ -1,9 +1,15 @@
 import unittest
+import copy
 import itertools
+import json
+import os
+import tempfile
+import time
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
-from test_ao_jit_llga_utils import JitLlgaTestCase, run_tests, LLGA_FUSION_GROUP, get_eltwise_fn
+from test_ao_jit_llga_utils import JitLlgaTestCase, run_tests, LLGA_FUSION_GROUP, get_eltwise_fn, \
+    default_static_qconfig
 from torch.testing._internal.common_utils import TEST_SCIPY
 from torch.quantization.quantize_fx import prepare_fx, convert_fx
 from torch.ao.quantization.quantize_fx import convert_to_reference_fx, prepare_qat_fx
@@ -1517,6 +1523,36 @@ class TestFusionPattern(JitLlgaTestCase):
         self.assertFused(graph, ['aten::matmul', 'aten::dequantize', 'aten::div', 'aten::add'])
         self.checkPatterns(graph, patterns)
 
+    def test_attention_int8_fp32(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.num_attention_heads = 16
+                self.attention_head_size = 4
+
+            def transpose_for_scores(self, x):
+                new_x_shape = x.size()[:-1] + (self.num_attention_heads, self.attention_head_size)
+                return x.view(*new_x_shape).permute(0, 2, 1, 3)
+
+            def forward(self, q, k, v, mask):
+                q = self.transpose_for_scores(q)
+                k = self.transpose_for_scores(k)
+                v = self.transpose_for_scores(v)
+                s = torch.matmul(q, k.transpose(-1, -2)) / 2.0
+                s = torch.softmax(s + mask, -1)
+                return torch.matmul(s, v)
+
+        m = M()
+        q = torch.randn(2, 3, 64)
+        k = torch.randn(2, 3, 64)
+        v = torch.randn(2, 3, 64)
+        mask = torch.randn(2, 1, 1, 3)
+
+        # the softmax output is quantized for the second matmul, the whole
+        # attention is lowered to oneDNN graph
+        graph = self.checkQuantizeTrace(m, [q, k, v, mask], atol=2e-1)
+        self.assertFused(graph, ['aten::matmul', 'aten::div', 'aten::add', 'aten::softmax'])
+
    
     @unittest.skip("Graph Compiler unit-test")
     def test_mha_pattern_int8_fp32(self):
@@ -1873,6 +1909,169 @@ class TestShapeFallback(JitLlgaTestCase):
             graph2 = self.checkQuantizeTrace(conv_add, input, atol=1e-2)
             self.assertGraphContainsExactly(graph2, 'aten::quantize_per_tensor', 1)
 
+    def test_linear_dynamic_shape(self):
+        m = nn.Sequential(nn.Linear(28, 64), nn.ReLU())
+        x = torch.rand(8, 28)
+        ipex._C._jit_set_llga_dynamic_shape_enabled(True)
+        ipex._C._jit_set_llga_shape_buckets([4, 16])
+        try:
+            graph, traced_model, fp32_model = self.prepareModel(m, [x])
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+            ipex._C._jit_reset_llga_compilation_cache_stats()
+            with torch.no_grad():
+                # 3 and 4 share the bucket of 4, 5 and 16 the bucket of 16
+                # compiled for the batch of 8 of the warm up
+                for batch in [3, 4, 5, 16, 3]:
+                    x_var = torch.rand(batch, 28)
+                    y = fp32_model(x_var)
+                    y_llga = traced_model(x_var)
+                    self.assertEqual(y_llga.shape, y.shape)
+                    self.assertEqual(y, y_llga, atol=1e-1, rtol=1e-2)
+            stats = ipex._C._jit_llga_compilation_cache_stats()
+            self.assertEqual(stats["misses"], 1)
+            self.assertEqual(stats["hits"], 4)
+            self.assertGreater(stats["compile_ms"], 0)
+        finally:
+            ipex._C._jit_set_llga_dynamic_shape_enabled(False)
+            ipex._C._jit_set_llga_shape_buckets([])
+
+    def test_linear_symbolic_shape(self):
+        m = nn.Sequential(nn.Linear(28, 64), nn.ReLU()).eval()
+        fp32_model = copy.deepcopy(m)
+        x = torch.rand(8, 28)
+        profiled_runs = torch._C._jit_get_num_profiled_runs()
+        torch._C._jit_set_num_profiled_runs(2)
+        ipex._C._jit_set_llga_symbolic_shape_enabled(True)
+        ipex._C._jit_set_llga_dynamic_dim_bound(16)
+        try:
+            with torch.no_grad():
+                model = ipex.quantization.prepare(m, default_static_qconfig, x, inplace=True)
+                model(x)
+                model = ipex.quantization.convert(model)
+                traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                # the batch varies during the profiling runs, the features not
+                for batch in [8, 4]:
+                    traced_model(torch.rand(batch, 28))
+                ipex._C._jit_reset_llga_compilation_cache_stats()
+                for batch in [3, 16]:
+                    x_var = torch.rand(batch, 28)
+                    self.assertEqual(fp32_model(x_var), traced_model(x_var), atol=1e-1, rtol=1e-2)
+                graph = traced_model.graph_for(x_var)
+                self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+                stats = ipex._C._jit_llga_compilation_cache_stats()
+                self.assertEqual(stats["misses"], 2)
+                # a batch over the bound of the symbolic dim runs the unfused subgraph
+                x_var = torch.rand(32, 28)
+                self.assertEqual(fp32_model(x_var), traced_model(x_var), atol=1e-1, rtol=1e-2)
+                self.assertEqual(ipex._C._jit_llga_compilation_cache_stats()["misses"], 2)
+        finally:
+            torch._C._jit_set_num_profiled_runs(profiled_runs)
+            ipex._C._jit_set_llga_symbolic_shape_enabled(False)
+            ipex._C._jit_set_llga_dynamic_dim_bound(0)
+
+    def test_linear_async_compilation(self):
+        m = nn.Sequential(nn.Linear(28, 64), nn.ReLU())
+        x = torch.rand(8, 28)
+        ipex._C._jit_set_llga_dynamic_shape_enabled(True)
+        try:
+            graph, traced_model, fp32_model = self.prepareModel(m, [x])
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+            ipex._C._jit_set_llga_async_compilation_enabled(True)
+            ipex._C._jit_reset_llga_compilation_cache_stats()
+            x_var = torch.rand(5, 28)
+            with torch.no_grad():
+                y = fp32_model(x_var)
+                # the new shape runs the unfused subgraph while compiling
+                self.assertEqual(y, traced_model(x_var), atol=1e-1, rtol=1e-2)
+                stats = ipex._C._jit_llga_compilation_cache_stats()
+                self.assertEqual(stats["fallbacks"], 1)
+                for _ in range(1000):
+                    if ipex._C._jit_llga_compilation_cache_stats()["misses"] == 1:
+                        break
+                    time.sleep(0.01)
+                self.assertEqual(y, traced_model(x_var), atol=1e-1, rtol=1e-2)
+            stats = ipex._C._jit_llga_compilation_cache_stats()
+            self.assertEqual(stats["misses"], 1)
+            self.assertEqual(stats["hits"], 1)
+        finally:
+            ipex._C._jit_set_llga_async_compilation_enabled(False)
+            ipex._C._jit_set_llga_dynamic_shape_enabled(False)
+
+    def test_save_load_warmup(self):
+        m = nn.Sequential(nn.Linear(28, 64), nn.ReLU())
+        x = torch.rand(8, 28)
+        x_var = torch.rand(3, 28)
+        graph, traced_model, fp32_model = self.prepareModel(m, [x])
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "model.pt")
+            ipex.quantization.save(traced_model, path, warmup_inputs=[(x,), (x_var,)])
+            ipex._C._jit_reset_llga_compilation_cache_stats()
+            loaded = ipex.quantization.load(path)
+            # the partitions of both shapes are compiled at load
+            stats = ipex._C._jit_llga_compilation_cache_stats()
+            self.assertGreater(stats["misses"], 0)
+            ipex._C._jit_reset_llga_compilation_cache_stats()
+            with torch.no_grad():
+                for inputs in [x, x_var]:
+                    self.assertEqual(fp32_model(inputs), loaded(inputs), atol=1e-1, rtol=1e-2)
+            stats = ipex._C._jit_llga_compilation_cache_stats()
+            self.assertEqual(stats["misses"], 0)
+
+    def test_shared_weight_cache(self):
+        m = nn.Sequential(nn.Linear(28, 64), nn.ReLU())
+        x = torch.rand(8, 28)
+        ipex._C._jit_set_llga_shared_weight_cache_enabled(True)
+        ipex._C._jit_clear_llga_shared_weight_cache()
+        try:
+            graph, traced_model, fp32_model = self.prepareModel(m, [x])
+            with tempfile.TemporaryDirectory() as tmp:
+                path = os.path.join(tmp, "model.pt")
+                traced_model.save(path)
+                copies = [torch.jit.load(path) for _ in range(2)]
+            with torch.no_grad():
+                y = fp32_model(x)
+                for copy in copies:
+                    for _ in range(3):
+                        y_llga = copy(x)
+                    self.assertEqual(y, y_llga, atol=1e-1, rtol=1e-2)
+            stats = ipex._C._jit_llga_shared_weight_cache_stats()
+            # one compilation for the traced model and its copies
+            self.assertEqual(stats["compilations"], 1)
+            self.assertGreater(stats["bytes"], 0)
+        finally:
+            ipex._C._jit_set_llga_shared_weight_cache_enabled(False)
+            ipex._C._jit_clear_llga_shared_weight_cache()
+
+    def test_fusion_report(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(28, 64)
+
+            def forward(self, x):
+                return torch.cumsum(torch.relu(self.linear(x)), 1)
+
+        x = torch.rand(8, 28)
+        ipex._C._jit_set_llga_fusion_report_enabled(True)
+        ipex._C._jit_reset_llga_fusion_report()
+        try:
+            graph, traced_model, fp32_model = self.prepareModel(M(), [x])
+            with torch.no_grad():
+                traced_model(x)
+            report = ipex._C._jit_llga_fusion_report()
+            json.dumps(report)
+            partition = [p for p in report["partitions"] if "linear" in p["ops"]][0]
+            self.assertGreater(partition["compilations"], 0)
+            self.assertGreater(partition["runs"], 0)
+            self.assertGreater(partition["input_bytes"], 0)
+            self.assertGreater(partition["output_bytes"], 0)
+            self.assertIn(
+                ("aten::cumsum", "no mapping to a oneDNN graph op"),
+                [(op["op"], op["reason"]) for op in report["unfused"]])
+        finally:
+            ipex._C._jit_set_llga_fusion_report_enabled(False)
+            ipex._C._jit_reset_llga_fusion_report()
+
 class TestModel(JitLlgaTestCase):
     @skipIfNoTorchVision
     def _test_vision(self, model_name):
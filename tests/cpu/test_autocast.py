@@ -96,6 +96,38 @@ class TestFunction(TestCase):
                 out_autocast = _conv(_in_cpu)
             self.assertEqual(out_autocast.dtype, torch.float)
 
+    def test_persistent_cache(self):
+        # the casts of the weights kept across the autocast regions are redone
+        # once the weights are written, in place or by the fused optimizer steps
+        torch.manual_seed(0)
+        x = torch.randn(4, 16)
+        linear = torch.nn.Linear(16, 8)
+        grad = torch.randn_like(linear.weight)
+        trail = torch.Tensor()
+        default_persistent = core.is_autocast_cache_persistent()
+        try:
+            results = []
+            for persistent in [True, False]:
+                core.set_autocast_cache_persistent(persistent)
+                model = copy.deepcopy(linear)
+                outputs = []
+                with torch.no_grad():
+                    for i in range(4):
+                        with torch.cpu.amp.autocast(enabled=True, dtype=torch.bfloat16):
+                            outputs.append(model(x))
+                        if i == 1:
+                            model.weight.add_(1)
+                        elif i == 2:
+                            torch.ops.torch_ipex.sgd_fused_step(
+                                model.weight, grad, None, trail, 0.0, 0.5, 0.0, 0.0, False)
+                results.append(outputs)
+            self.assertEqual(results[0], results[1])
+            self.assertNotEqual(results[0][1], results[0][2])
+            self.assertNotEqual(results[0][2], results[0][3])
+        finally:
+            core.set_autocast_cache_persistent(default_persistent)
+            core.clear_autocast_cache()
+
 class TestAutocastWithJit(TestCase):
     def setUp(self):
         super(TestAutocastWithJit, self).setUp()
@@ -801,6 +833,18 @@ class TestAutocastOperations(TestCase):
             op, args, maybe_kwargs = self.args_maybe_kwargs(op_with_args)
             self._run_autocast_outofplace(op, args, torch.float32, autocast_type=torch.float16, module=torch._C._nn, add_kwargs=maybe_kwargs)
 
+    def test_autocast_torch_fp16_if_supported(self):
+        run_as_type = torch.float16 if core.onednn_has_fp16_support() else torch.float32
+        for op_with_args in self.autocast_lists.torch_fp16_if_supported:
+            op, args, maybe_kwargs = self.args_maybe_kwargs(op_with_args)
+            self._run_autocast_outofplace(op, args, run_as_type, autocast_type=torch.float16, add_kwargs=maybe_kwargs)
+
+    def test_autocast_nn_fp16_if_supported(self):
+        run_as_type = torch.float16 if core.onednn_has_fp16_support() else torch.float32
+        for op_with_args in self.autocast_lists.nn_fp16_if_supported:
+            op, args, maybe_kwargs = self.args_maybe_kwargs(op_with_args)
+            self._run_autocast_outofplace(op, args, run_as_type, autocast_type=torch.float16, module=torch._C._nn, add_kwargs=maybe_kwargs)
+
     def test_autocast_torch_fp16_fp32_multi_output(self):
         for op_with_args in self.autocast_lists.torch_fp16_fp32_multi_output:
             op, args, maybe_kwargs = self.args_maybe_kwargs(op_with_args)
@@ -0,0 +1,42 @@
+import unittest
+import itertools
+import torch
+import torch.nn.functional as F
+import intel_extension_for_pytorch as ipex
+from common_utils import TestCase
+
+class TestBCEWithLogitsHead(TestCase):
+    def test_bce_with_logits_head(self):
+        # a batch of a partial task and a feature size with a vector tail
+        for dtype, bias, batch, feature_size in itertools.product(
+                [torch.float, torch.bfloat16], [True, False], [1, 37, 2048], [127, 256]):
+            linear = torch.nn.Linear(feature_size, 1, bias=bias).to(dtype)
+            x = torch.randn(batch, feature_size).to(dtype)
+            # large logits check the stable log-sigmoid
+            x[0] *= 100
+            target = torch.randint(0, 2, (batch,)).float()
+
+            x1 = x.clone().requires_grad_()
+            ref = F.binary_cross_entropy_with_logits(linear(x1).float().view(-1), target)
+            ref.backward()
+            ref_grads = [x1.grad] + [p.grad.clone() for p in linear.parameters()]
+            linear.zero_grad()
+
+            x2 = x.clone().requires_grad_()
+            loss = ipex.nn.functional.bce_with_logits_head(x2, linear.weight, linear.bias, target)
+            self.assertEqual(loss.dtype, dtype)
+            loss.backward()
+            grads = [x2.grad] + [p.grad for p in linear.parameters()]
+
+            prec = 1e-5 if dtype == torch.float else 2e-2
+            self.assertEqual(loss.float(), ref.to(dtype).float(), rtol=prec, atol=prec)
+            for grad, ref_grad in zip(grads, ref_grads):
+                self.assertEqual(grad.dtype, ref_grad.dtype)
+                self.assertEqual(grad, ref_grad, rtol=prec, atol=prec)
+
+            with torch.no_grad():
+                loss = ipex.nn.functional.bce_with_logits_head(x, linear.weight, linear.bias, target.view(-1, 1))
+            self.assertEqual(loss.float(), ref.to(dtype).float(), rtol=prec, atol=prec)
+
+if __name__ == '__main__':
+    test = unittest.main()
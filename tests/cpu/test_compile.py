@@ -19,6 +19,18 @@ class Conv_Bn_Relu(nn.Module):
     def forward(self, x):
         return F.relu(self.bn(self.conv(x)))
 
+class Attention_Add_LayerNorm(nn.Module):
+    def __init__(self):
+        super(Attention_Add_LayerNorm, self).__init__()
+        self.qkv = nn.Linear(64, 192)
+        self.norm = nn.LayerNorm(64)
+
+    def forward(self, x):
+        b, s = x.size(0), x.size(1)
+        qkv = self.qkv(x).view(b, s, 3, 4, 16).permute(2, 0, 3, 1, 4)
+        attn = F.scaled_dot_product_attention(qkv[0], qkv[1], qkv[2], is_causal=True)
+        return self.norm(attn.transpose(1, 2).reshape(b, s, 64) + x)
+
 class TestCompile(TestCase):
     def test_inference(self):
         model_ = Conv_Bn_Relu().to(memory_format=torch.channels_last).eval()
@@ -37,6 +49,20 @@ class TestCompile(TestCase):
                 y2 = compiled_model(x)
             self.assertEqual(y1, y2)
             self.assertTrue(y2.dtype == dtype)
+
+    def test_lowering_dynamic_shapes(self):
+        model = Attention_Add_LayerNorm().eval()
+        with torch.no_grad():
+            fx_model = torch.fx.symbolic_trace(copy.deepcopy(model))
+            compiled_model = ipex.compile(fx_model, [torch.randn(2, 8, 64)])
+            targets = [n.target for n in compiled_model.graph.nodes]
+            self.assertTrue(torch.ops.ipex.add_layernorm in targets)
+            self.assertFalse(F.scaled_dot_product_attention in targets)
+            self.assertTrue(isinstance(compiled_model.qkv, ipex.nn.utils._weight_prepack._IPEXLinear))
+            # new sequence lengths run the same lowered graph
+            for s in [8, 13, 70]:
+                x = torch.randn(2, s, 64)
+                self.assertEqual(compiled_model(x), model(x), prec=1e-4)
             
             
 if __name__ == '__main__':
@@ -207,6 +207,34 @@ class CPUOPsTester(TestCase):
             self.assertEqual(y6, y_ref)
             self.assertEqual(x6.grad, x_ref.grad) 
 
+    def test_batch_norm_channels_last_training(self):
+        # the single pass Welford kernels against the contiguous ATen path
+        for dim, size in [(2, [4, 35, 17, 19]), (3, [2, 35, 9, 7, 11])]:
+            memory_format = torch.channels_last if dim == 2 else torch.channels_last_3d
+            for dtype in [torch.float32, torch.bfloat16]:
+                m = bn_m[dim](35)
+                m.weight.data.uniform_(0.5, 1.5)
+                m.bias.data.uniform_(-0.5, 0.5)
+                ref_m = copy.deepcopy(m)
+                x = torch.randn(size) * 3 + 1
+                ref_x = x.clone().requires_grad_()
+                x = x.to(dtype).to(memory_format=memory_format).requires_grad_()
+                y = m(x)
+                ref_y = ref_m(ref_x)
+                grad = torch.randn(size)
+                y.backward(grad.to(dtype).to(memory_format=memory_format))
+                ref_y.backward(grad)
+                prec = 1e-4 if dtype == torch.float32 else 0.05
+                self.assertTrue(y.dtype == dtype)
+                self.assertTrue(y.is_contiguous(memory_format=memory_format))
+                self.assertEqual(y.float(), ref_y, prec=prec * 4)
+                self.assertEqual(m.running_mean, ref_m.running_mean, prec=prec)
+                self.assertEqual(m.running_var, ref_m.running_var, prec=prec * 4)
+                self.assertTrue(x.grad.is_contiguous(memory_format=memory_format))
+                self.assertEqual(x.grad.float(), ref_x.grad, prec=prec * 4)
+                self.assertEqual(m.weight.grad, ref_m.weight.grad, prec=prec * 100)
+                self.assertEqual(m.bias.grad, ref_m.bias.grad, prec=prec * 100)
+
     # Keep this UT temporarily to make sure the OP behavior in PyTorch is as expected.
     def test_adaptive_avg_pool2d(self):
         m = nn.AdaptiveAvgPool2d((5,7))
@@ -579,6 +607,39 @@ class CPUOPsTester(TestCase):
                 helper(self, (2, 9, 7, 200, 15), 3, torch.channels_last_3d, dtype, is_mixed)
                 helper(self, (2, 60, 7, 200, 15), 3, torch.channels_last_3d, dtype, is_mixed)
 
+    def test_groupnorm_backward_small_batch(self):
+        # at a batch of 1-2 the rows are split into spatial blocks whose partials are summed
+        def ref_group_norm(x, groups, weight, bias):
+            n, c = x.shape[:2]
+            xg = x.reshape(n, groups, -1)
+            y = (xg - xg.mean(-1, keepdim=True)) / torch.sqrt(xg.var(-1, unbiased=False, keepdim=True) + 1e-5)
+            shape = [1, c] + [1] * (x.dim() - 2)
+            return y.reshape(x.shape) * weight.view(shape) + bias.view(shape)
+
+        num_threads = torch.get_num_threads()
+        torch.set_num_threads(max(num_threads, 8))
+        try:
+            for size, memory_format, dtype in itertools.product(
+                    [(1, 4, 96, 97), (2, 2, 70, 130)], [torch.contiguous_format, torch.channels_last],
+                    [torch.float, torch.bfloat16]):
+                gn = nn.GroupNorm(2, size[1])
+                gn.weight.data.uniform_()
+                gn.bias.data.uniform_()
+                x = torch.randn(size).to(dtype).contiguous(memory_format=memory_format).requires_grad_()
+                grad = torch.randn(size).to(dtype).contiguous(memory_format=memory_format)
+                gn(x).backward(grad)
+
+                ref_x = x.detach().double().requires_grad_()
+                ref_w = gn.weight.detach().double().requires_grad_()
+                ref_b = gn.bias.detach().double().requires_grad_()
+                ref_group_norm(ref_x, 2, ref_w, ref_b).backward(grad.double())
+                prec = 1e-4 if dtype == torch.float else 2e-2
+                self.assertEqual(x.grad.double(), ref_x.grad, rtol=prec, atol=prec)
+                self.assertEqual(gn.weight.grad.double(), ref_w.grad, rtol=prec, atol=prec * size[2])
+                self.assertEqual(gn.bias.grad.double(), ref_b.grad, rtol=prec, atol=prec * size[2])
+        finally:
+            torch.set_num_threads(num_threads)
+
     def test_groupnorm_nwc(self):
         size = (4, 20, 20)
         channels = size[1]
@@ -628,6 +689,28 @@ class CPUOPsTester(TestCase):
         self.assertTrue(x_bf16.grad.dtype == torch.bfloat16)
         self.assertEqual(x_bf16.grad, x2.grad, prec=prec)
 
+    def test_group_norm_silu(self):
+        # large spatial sizes split the moments of a sample in partials
+        shapes = [(2, 64, 8, 8), (1, 320, 64, 64), (3, 96, 5, 7)]
+        for shape, dtype, use_weight in itertools.product(shapes, [torch.float32, torch.bfloat16], [True, False]):
+            x = (torch.randn(shape) * 3 + 1).to(dtype)
+            weight = torch.randn(shape[1]) if use_weight else None
+            bias = torch.randn(shape[1]) if use_weight else None
+            ref = F.silu(F.group_norm(x.float(), 32, weight, bias, 1e-6))
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                out = torch.ops.torch_ipex.group_norm_silu(
+                    x.to(memory_format=memory_format), 32, weight, bias, 1e-6)
+                self.assertEqual(out.dtype, dtype)
+                self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+                self.assertEqual(out.float(), ref, prec=0.05 if dtype == torch.bfloat16 else 1e-4)
+        # bfloat16 input and parameters
+        x = torch.randn(2, 64, 8, 8, dtype=torch.bfloat16)
+        weight = torch.randn(64, dtype=torch.bfloat16)
+        bias = torch.randn(64, dtype=torch.bfloat16)
+        self.assertEqual(
+            torch.ops.torch_ipex.group_norm_silu(x, 32, weight, bias, 1e-5),
+            F.silu(F.group_norm(x, 32, weight, bias, 1e-5)), prec=0.05)
+
     def test_avg_pool2d(self):
         def helper(self, m, x):
             x1 = x.clone().detach().requires_grad_()
@@ -850,6 +933,37 @@ class CPUOPsTester(TestCase):
         y6 = torch.arange(0, 0.5, 0.5).to(torch.float16).add(x6.unsqueeze(-1)).sum(-1).transpose(0, 1)
         self.assertEqual(y5, y6)
 
+    def test_reduce_multi_axis(self):
+        # the sum, mean and var of the [M, R, N] reduction engine against the double reference
+        x = torch.randn(4, 64, 17, 19)
+        cases = [
+            (x, (1, 2, 3)),
+            (x, (2, 3)),
+            (x, (1, 2)),
+            (x, (0,)),
+            (x, (0, 1, 2, 3)),
+            (x.contiguous(memory_format=torch.channels_last), (2, 3)),
+            (x.contiguous(memory_format=torch.channels_last), (-1, -2, 0)),
+            (torch.randn(2, 1, 3000), (2,)),
+            (torch.randn(1, 5000, 3), (1,)),
+            # not planned, falling back
+            (x.transpose(1, 3), (1,)),
+            (x, (1, 3)),
+        ]
+        for input, dim in cases:
+            ref = input.double()
+            for dtype in [torch.float32, torch.bfloat16]:
+                prec = 1e-4 if dtype == torch.float32 else 2e-2
+                for keepdim in [True, False]:
+                    y = input.to(dtype)
+                    self.assertEqual(y.sum(dim, keepdim=keepdim), ref.to(dtype).double().sum(dim, keepdim=keepdim).to(dtype), prec=prec * 100)
+                    self.assertEqual(y.mean(dim, keepdim=keepdim), ref.to(dtype).double().mean(dim, keepdim=keepdim).to(dtype), prec=prec)
+                    self.assertEqual(y.var(dim, keepdim=keepdim), ref.to(dtype).double().var(dim, keepdim=keepdim).to(dtype), prec=prec)
+                    self.assertEqual(y.var(dim, correction=0, keepdim=keepdim), ref.to(dtype).double().var(dim, correction=0, keepdim=keepdim).to(dtype), prec=prec)
+                self.assertEqual(input.to(torch.bfloat16).mean(dim, dtype=torch.float32), ref.to(torch.bfloat16).double().mean(dim).float(), prec=1e-4)
+        # the variance of a single element is nan, as in ATen
+        self.assertTrue(torch.randn(3, 1).var(1).isnan().all())
+
     def test_matmul(self):
         def helper(a, b, c, op):
             dtypes = [torch.float32, torch.bfloat16]
@@ -960,6 +1074,58 @@ class CPUOPsTester(TestCase):
                 y1_5 = torch.index_select(x1_5, dim, indices, out=torch.empty(0))
                 self.assertTrue(y1_5.dtype == torch.float32)
 
+    def test_index_select_values(self):
+        # the contiguous fast path for the integer, bool and float16 types
+        indices = torch.tensor([3, 0, 7, 7, 1])
+        for datatype in [torch.float16, torch.int64, torch.int32, torch.int8, torch.uint8, torch.bool]:
+            for size in [[10, 33], [10, 1000, 3], [10, 300000]]:
+                x = torch.randint(0, 2 if datatype == torch.bool else 100, size).to(datatype)
+                for dim in range(len(size)):
+                    y = x.index_select(dim, indices % size[dim])
+                    ref = x.transpose(0, dim)[indices % size[dim]].transpose(0, dim)
+                    self.assertEqual(y, ref)
+
+    def test_index_select_strided(self):
+        # the gathers of the rows and columns of a column-sliced table
+        table = torch.randn(100, 64)[:, 16:48]
+        indices = torch.tensor([5, 99, 0, 5, 42])
+        self.assertEqual(table.index_select(0, indices), table.contiguous()[indices])
+        self.assertEqual(table.index_select(1, indices % 32), table.contiguous()[:, indices % 32])
+
+    def test_index_add_scatter_add(self):
+        for datatype in [torch.float32, torch.double, torch.bfloat16]:
+            for index_type in [torch.int32, torch.int64]:
+                for dim, size in itertools.product([0, 1], [[10, 33], [7, 10, 1500]]):
+                    # duplicated indices
+                    index = torch.randint(0, size[dim], (50,), dtype=index_type)
+                    source_size = list(size)
+                    source_size[dim] = 50
+                    x = torch.randn(size)
+                    source = torch.randn(source_size)
+                    ref = x.double().index_add(dim, index.long(), source.double(), alpha=2)
+                    y = x.to(datatype).index_add(dim, index, source.to(datatype), alpha=2)
+                    self.assertEqual(y.double(), ref, atol=5e-2 if datatype == torch.bfloat16 else 1e-5, rtol=1e-2)
+        with self.assertRaises(IndexError):
+            torch.zeros(4, 3).index_add_(0, torch.tensor([4]), torch.ones(1, 3))
+
+        # the index of the edges of a graph expanded to their features
+        edges = torch.randint(0, 20, (300,))
+        feature = torch.randn(300, 64)
+        y = torch.zeros(20, 64).scatter_add(0, edges.unsqueeze(1).expand_as(feature), feature)
+        self.assertEqual(y, torch.zeros(20, 64).index_add(0, edges, feature))
+
+    def test_embedding_dense_backward(self):
+        for datatype in [torch.float32, torch.bfloat16]:
+            for padding_idx in [None, 3]:
+                weight = torch.randn(10, 16, dtype=datatype, requires_grad=True)
+                indices = torch.randint(0, 10, (4, 25))
+                grad = torch.randn(4, 25, 16)
+                torch.nn.functional.embedding(indices, weight, padding_idx=padding_idx).backward(grad.to(datatype))
+                ref = torch.zeros(10, 16).index_put_((indices.reshape(-1),), grad.reshape(-1, 16), accumulate=True)
+                if padding_idx is not None:
+                    ref[padding_idx] = 0
+                self.assertEqual(weight.grad.float(), ref, atol=5e-2 if datatype == torch.bfloat16 else 1e-5, rtol=1e-2)
+
     def test_cat(self):
         for datatype in [torch.float32, torch.double, torch.bfloat16]:
             for dim, size in itertools.product([0, 1], [[2, 1], [2, 2], [5, 10]]):
@@ -1040,6 +1206,67 @@ class CPUOPsTester(TestCase):
             self.assertTrue(y7.size() == torch.Size([8, 2]))
             self.assertTrue(y7.dtype == datatype)
 
+    def test_cat_values(self):
+        # the contiguous fast path for the integer, bool and float16 types, with
+        # masked tails and long copies
+        for datatype in [torch.float16, torch.int64, torch.int32, torch.int8, torch.uint8, torch.bool]:
+            for size in [[3, 1], [5, 67], [2, 600000]]:
+                x = torch.randint(0, 2 if datatype == torch.bool else 100, size).to(datatype)
+                z = torch.randint(0, 2 if datatype == torch.bool else 100, size).to(datatype)
+                for dim in [0, 1]:
+                    y = torch.cat([x, z], dim)
+                    self.assertEqual(y.dtype, datatype)
+                    self.assertEqual(y.narrow(dim, 0, size[dim]), x)
+                    self.assertEqual(y.narrow(dim, size[dim], size[dim]), z)
+
+    def test_streaming_store(self):
+        # the memory bound kernels with the streaming stores of every size, on
+        # outputs and inputs not aligned to a cache line, give the results of
+        # the regular stores
+        default_threshold = ipex._C.get_streaming_store_threshold()
+        try:
+            results = []
+            for threshold in [1, 0]:
+                ipex._C.set_streaming_store_threshold(threshold)
+                torch.manual_seed(0)
+                x = torch.randn(64 * 1024 + 5)[5:].view(64, 1024)
+                z = torch.randn(64, 1030)
+                indices = torch.randint(0, 64, (100,))
+                top, bottom = torch.ops.torch_ipex.split_float_bfloat16(x)
+                results.append([
+                    torch.cat([x, z], 1), torch.cat([x, x], 0), x.index_select(0, indices),
+                    x.index_select(1, indices), top, bottom, torch.ops.torch_ipex.cat_bfloat16_float(top, bottom)])
+            self.assertEqual(results[0], results[1])
+            self.assertEqual(results[0][6], x)
+        finally:
+            ipex._C.set_streaming_store_threshold(default_threshold)
+
+    def test_amx_tile_config_cache(self):
+        # with the lazy release, the bf16 interaction configures the tiles of
+        # the single thread once over the repeated calls, and gives the results
+        # of the eager release
+        default_lazy = ipex._C.get_amx_tile_lazy_release()
+        num_threads = torch.get_num_threads()
+        try:
+            torch.set_num_threads(1)
+            torch.manual_seed(0)
+            x = [torch.randn(32, 128).bfloat16() for _ in range(27)]
+            results = []
+            for lazy in [True, False]:
+                ipex._C.set_amx_tile_lazy_release(lazy)
+                ipex.nn.functional.interaction(*x)
+                ipex._C.reset_amx_tile_config_counters()
+                results.append([ipex.nn.functional.interaction(*x) for _ in range(3)])
+                requests = ipex._C.get_amx_tile_config_requests()
+                loads = ipex._C.get_amx_tile_config_loads()
+                # 0 requests when the kernel doesn't run on AMX
+                if requests > 0:
+                    self.assertEqual(loads, 0 if lazy else requests)
+            self.assertEqual(results[0], results[1])
+        finally:
+            ipex._C.set_amx_tile_lazy_release(default_lazy)
+            torch.set_num_threads(num_threads)
+
 
 if __name__ == '__main__':
     test = unittest.main()
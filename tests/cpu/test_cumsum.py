@@ -15,6 +15,10 @@ class TestCumSum(TestCase):
             torch.ops.torch_ipex.cumsum_(x, 1)
             self.assertEqual(res1, x)
 
+        # the vectorized prefix sum of int64 with a scalar tail
+        x = torch.randint(-1000, 1000, (3, 1027), dtype=torch.long)
+        self.assertEqual(torch.ops.torch_ipex.cumsum(x, 1), x.numpy().cumsum(1))
+
         a = torch.tensor([[True, False, True],
                           [False, False, False],
                           [True, True, True]])
@@ -56,5 +60,34 @@ class TestCumSum(TestCase):
         # Check that output maintained correct shape
         self.assertEqual(raw_tensor.shape, raw_tensor.grad.shape)
 
+    def test_scan(self):
+        # the scans along the inner dims and along the long rows cut in chunks by the up-sweep and down-sweep
+        shapes = [((2, 1 << 20), 1), ((1 << 20,), 0), ((3, 5000, 7), 1), ((4, 300, 513), 1), ((9000, 2), 0), ((6, 7, 8), -3)]
+        for shape, dim in shapes:
+            x = torch.randn(shape)
+            for dtype in [torch.float, torch.double, torch.bfloat16]:
+                y = x.to(dtype)
+                # the rounding errors grow as the square root of the scanned elements
+                scale = y.size(dim) ** 0.5
+                prec = 1e-1 if dtype == torch.bfloat16 else 1e-5
+                self.assertEqual(torch.ops.torch_ipex.cumsum(y, dim), y.double().cumsum(dim).to(dtype), prec=prec * scale * 10)
+                self.assertEqual(torch.ops.torch_ipex.logcumsumexp(y, dim), y.double().logcumsumexp(dim).to(dtype), prec=prec * scale)
+                # the products of values around 1, so that they neither overflow nor vanish
+                z = (1 + y / 1000).to(dtype)
+                self.assertEqual(torch.ops.torch_ipex.cumprod(z, dim), z.double().cumprod(dim).to(dtype), prec=prec * scale)
+            x = torch.randint(-3, 4, shape)
+            self.assertEqual(torch.ops.torch_ipex.cumsum(x, dim), x.cumsum(dim))
+            self.assertEqual(torch.ops.torch_ipex.cumprod(x.clamp(1, 1), dim), x.clamp(1, 1).cumprod(dim))
+
+        # the infinities and nans of logcumsumexp
+        x = torch.tensor([float('-inf'), float('-inf'), 0., float('inf'), float('nan'), 1.])
+        self.assertEqual(torch.ops.torch_ipex.logcumsumexp(x, 0), torch.logcumsumexp(x, 0))
+        # non contiguous inputs and the backward fall back to ATen
+        x = torch.randn(64, 32).t()
+        self.assertEqual(torch.ops.torch_ipex.cumprod(x, 1), torch.cumprod(x, 1))
+        x.requires_grad_()
+        torch.ops.torch_ipex.logcumsumexp(x, 0).sum().backward()
+        self.assertEqual(x.grad.shape, x.shape)
+
 if __name__ == '__main__':
     test = unittest.main()
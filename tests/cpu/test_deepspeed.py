@@ -1,5 +1,6 @@
 import sys
 import os
+import copy
 import unittest
 
 import torch
@@ -93,6 +94,27 @@ class DeepspeedTester(TestCase):
             self.assertEqual(y, jit_res)
             self.assertEqual(y, optimized)
 
+    def test_linear_allreduce_chunked(self):
+        deepspeed_modules = may_import_deepspeed_modules()
+        if deepspeed_modules is not None:
+            # enough rows for the GEMMs of the chunks to be pipelined with their allreduces
+            x = torch.randn(4, 64, 4)
+            m_linear = DeepSpeedTestM().eval()
+            y = m_linear(x)
+            m_linear_quant = copy.deepcopy(m_linear)
+
+            ds_model = self._get_ds_model(m_linear)
+            optimized = ipex.optimize(ds_model.eval(), inplace=True)
+            self.assertTrue(module_found(optimized, _IPEXLinearAllreduce))
+            self.assertEqual(y, optimized(x))
+
+            dynamic_qconfig = ipex.quantization.default_dynamic_qconfig
+            ds_model = self._get_ds_model(m_linear_quant)
+            prepared_model = prepare(ds_model, dynamic_qconfig, example_inputs=(x), inplace=True, bn_folding=False)
+            converted = convert(prepared_model, inplace=True)
+            self.assertTrue(module_found(converted, DynamicQuantizedLinearAllreduce))
+            self.assertEqual(y, converted(x), atol=0.005, rtol=1.3e-6)
+
     def test_dynamic_quantization(self):
         deepspeed_modules = may_import_deepspeed_modules()
         if deepspeed_modules is not None:
@@ -0,0 +1,79 @@
+import unittest
+import io
+import torch
+from torch import nn
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.quantization._quantize import DynamicQuantizedLinearLayer
+from common_utils import TestCase
+
+def dynamic_quant_linear_ref(x, qweight, scales, bias):
+    # activation quantized to uint8 per token, int8 weight per output channel
+    x = x.float()
+    x_min = x.min(-1, keepdim=True)[0].clamp(max=0)
+    x_max = x.max(-1, keepdim=True)[0].clamp(min=0)
+    x_scales = (x_max - x_min) / 255
+    x_scales[x_scales == 0] = 1
+    zero_points = torch.round(-x_min / x_scales).clamp(0, 255)
+    xq = (torch.round(x / x_scales) + zero_points).clamp(0, 255)
+    w = qweight.float() * scales.unsqueeze(-1)
+    y = torch.matmul((xq - zero_points) * x_scales, w.t())
+    return y + bias if bias is not None else y
+
+class DynamicQuantLinearTester(TestCase):
+    def test_dynamic_quant_linear(self):
+        # N of a partial block, K not a multiple of 4, decoding and prefill M
+        for M, N, K, dtype, has_bias in [
+                (1, 50, 128, torch.float, True),
+                (7, 64, 30, torch.float, False),
+                (40, 130, 64, torch.float, True),
+                (5, 64, 66, torch.bfloat16, True),
+                (33, 24, 64, torch.bfloat16, False)]:
+            weight = torch.randn(N, K)
+            bias = torch.randn(N) if has_bias else None
+            ctx = torch.ops.ipex_prepack.dynamic_quant_linear_prepack(weight, bias)
+            qweight = ctx.get_quantized_weight()
+            self.assertEqual(qweight.dtype, torch.int8)
+            scales = weight.abs().max(-1)[0] / 127
+            self.assertEqual(ctx.to_public(), qweight.float() * scales.unsqueeze(-1))
+            self.assertEqual(ctx.to_public(), weight, prec=scales.max().item())
+
+            x = torch.randn(2, M, K).to(dtype)
+            y = torch.ops.torch_ipex.ipex_dynamic_quant_linear(x, ctx.get_data_handle())
+            y_ref = dynamic_quant_linear_ref(x, qweight, scales, bias)
+            self.assertEqual(y.dtype, dtype)
+            self.assertEqual(y.float(), y_ref, prec=5e-2 if dtype == torch.bfloat16 else 1e-3)
+
+    def test_dynamic_quant_linear_layer(self):
+        linear = nn.Linear(64, 48)
+        linear.qconfig = torch.ao.quantization.default_dynamic_qconfig
+        qlinear = DynamicQuantizedLinearLayer.from_float(linear)
+        self.assertTrue(qlinear.ctx is not None)
+        qweight = qlinear.weight()
+        scales = torch.tensor([qweight.q_scale()], dtype=torch.float).expand(48)
+        x = torch.randn(3, 64)
+        y_ref = dynamic_quant_linear_ref(x, qweight.int_repr(), scales, linear.bias.detach())
+        self.assertEqual(qlinear(x), y_ref, prec=1e-3)
+
+    def test_dynamic_quant_linear_pickle(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.ctx = torch.ops.ipex_prepack.dynamic_quant_linear_prepack(
+                    torch.randn(48, 64), torch.randn(48))
+
+            def forward(self, x):
+                return torch.ops.torch_ipex.ipex_dynamic_quant_linear(
+                    x, self.ctx.get_data_handle())
+
+        m = M()
+        x = torch.randn(3, 64)
+        # the prepacked context is serialized through its quantized weight
+        scripted = torch.jit.script(m)
+        buffer = io.BytesIO()
+        torch.jit.save(scripted, buffer)
+        buffer.seek(0)
+        loaded = torch.jit.load(buffer)
+        self.assertEqual(loaded(x), m(x))
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -4,7 +4,7 @@ import subprocess
 
 import intel_extension_for_pytorch._C as core
 
-supported_isa_set = ["default", "avx2", "avx2_vnni", "avx512", "avx512_vnni", "avx512_bf16", "amx"]
+supported_isa_set = ["default", "avx2", "avx2_vnni", "avx512", "avx512_vnni", "avx512_bf16", "avx512_fp16", "amx", "amx_fp16"]
 
 def get_isa_val(isa_name):
     if isa_name == "default":
@@ -19,8 +19,12 @@ def get_isa_val(isa_name):
         return 4
     elif isa_name == "avx512_bf16":
         return 5
-    elif isa_name == "amx":
+    elif isa_name == "avx512_fp16":
         return 6
+    elif isa_name == "amx":
+        return 7
+    elif isa_name == "amx_fp16":
+        return 8
     else:
         return 100
 
@@ -90,5 +94,49 @@ class TestDynDisp(unittest.TestCase):
           cur_ipex_isa_1 = str(out[-1], 'utf-8').strip()
           self.assertTrue(cur_ipex_isa == cur_ipex_isa_1)
 
+    def test_stub_isa_level(self):
+        import intel_extension_for_pytorch as ipex
+        # the stub of _get_current_isa_level returns the ISA level of its kernel
+        stub = 'get_current_isa_level_kernel_stub'
+        self.assertTrue(stub in ipex.cpu.dispatch.list_stubs())
+        cur_isa = get_currnet_isa_level()
+        isa_levels = ipex.cpu.dispatch.get_stub_isa_levels(stub)
+        self.assertTrue(cur_isa in isa_levels)
+        for isa in isa_levels:
+            with ipex.cpu.dispatch.stub_isa_level(stub, isa):
+                self.assertEqual(get_currnet_isa_level(), isa)
+                self.assertEqual(ipex.cpu.dispatch.get_stub_isa_level(stub), isa)
+                # the other stubs keep their ISA level
+                self.assertEqual(ipex.cpu.dispatch.get_stub_isa_level('merged_embeddingbag_forward_cpu_kernel_stub'), cur_isa)
+            self.assertEqual(get_currnet_isa_level(), cur_isa)
+        times = ipex.cpu.dispatch.benchmark_stub(stub, get_currnet_isa_level, warmup=1, iters=2)
+        self.assertEqual(list(times.keys()), isa_levels)
+        with self.assertRaises(RuntimeError):
+            ipex.cpu.dispatch.set_stub_isa_level('not_a_stub', 'avx2')
+
+    def test_stub_coverage_report(self):
+        import intel_extension_for_pytorch as ipex
+        report = {r['name']: r for r in ipex.cpu.dispatch.coverage_report()}
+        self.assertEqual(sorted(report.keys()), sorted(ipex.cpu.dispatch.list_stubs()))
+        # the kernels of the stub of _get_current_isa_level are built for every
+        # ISA level of the binary
+        stub = report['get_current_isa_level_kernel_stub']
+        cur_isa = get_currnet_isa_level()
+        self.assertEqual(stub['isa'], cur_isa)
+        self.assertEqual(stub['kernel'], cur_isa)
+        self.assertFalse(stub['missing'])
+        self.assertTrue(set(ipex.cpu.dispatch.get_stub_isa_levels(stub['name'])) <= set(stub['binary']))
+        self.assertTrue(get_highest_binary_support_isa_level() in stub['binary'])
+        for r in report.values():
+            self.assertEqual(r['missing'], r['kernel'] != r['isa'])
+        self.assertTrue('get_current_isa_level_kernel_stub:' in ipex._C._get_dispatch_stub_coverage_report())
+
+    def test_stub_isa_level_env(self):
+        command = 'IPEX_DISPATCH_STUB_ISA=get_current_isa_level_kernel_stub=avx2 python -c "import torch; import intel_extension_for_pytorch._C as core; print(core._get_current_isa_level().lower())" '
+        with subprocess.Popen(command, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT) as p:
+          out = p.stdout.readlines()
+          cur_ipex_isa = str(out[-1], 'utf-8').strip()
+          self.assertEqual(cur_ipex_isa, 'avx2')
+
 if __name__ == '__main__':
     unittest.main()
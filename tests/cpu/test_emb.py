@@ -95,6 +95,28 @@ class TestEMB(TestCase):
             include_last_offset, sparse = options
             self._test_emb(mode='sum', sparse=sparse, include_last_offset=include_last_offset)
 
+    def test_emb_pooling_fast_path(self):
+        # max pooling, dense grad only
+        for include_last_offset in [True, False]:
+            self._test_emb(mode='max', sparse=False, include_last_offset=include_last_offset)
+        # weighted sum, also check the grad of per_sample_weights
+        for dtype, sparse in itertools.product([torch.float, torch.bfloat16], [True, False]):
+            aten_emb = nn.EmbeddingBag(10, 33, mode='sum', sparse=sparse).to(dtype)
+            ipex_emb = copy.deepcopy(aten_emb)
+            input = torch.LongTensor([1, 2, 4, 5, 4, 3, 2, 9])
+            offsets = torch.LongTensor([0, 4])
+            aten_psw = torch.rand(8).to(dtype).requires_grad_()
+            ipex_psw = aten_psw.detach().clone().requires_grad_()
+            torch.embedding_bag = aten_emb_fn
+            aten_out = aten_emb(input, offsets, aten_psw)
+            aten_out.sum().backward()
+            torch.embedding_bag = ipex_emb_fn
+            ipex_out = ipex_emb(input, offsets, ipex_psw)
+            ipex_out.sum().backward()
+            self.assertEqual(aten_out, ipex_out)
+            self.assertEqual(aten_psw.grad, ipex_psw.grad)
+            self.assertEqual(aten_emb.weight.grad.to_dense(), ipex_emb.weight.grad.to_dense())
+
     def test_emb_jit_scriptable(self):
         emb = nn.EmbeddingBag(10, 3, mode='sum', sparse=True)
         input = torch.LongTensor([1,2,4,5,4,3,2,9])
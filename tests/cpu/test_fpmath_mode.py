@@ -92,5 +92,22 @@ class TestFPMathCases(TestCase):
                         num4 = num4 + 1
             assert num1 > 0 and num2 > 0 and num3 > 0 and num4 > 0, 'The implicit FP32 to BF16 data type conversion failed to enable.'
 
+    @fpmath_mode_env
+    def test_fpmath_bf32_mkl_sgemm(self):
+        if not ipex._C._get_highest_cpu_support_isa_level().lower() in ["avx512_bf16", "avx512_fp16", "amx", "amx_fp16"]:
+            return
+        x = torch.randn(5, 64)
+        weight = torch.randn(32, 64)
+        bias = torch.randn(32)
+        ctx = torch.ops.ipex_prepack.mkl_sgemm_prepack(weight, bias, 5)
+        packed_weight = ctx.get_weight()
+        # the MKL linear rounds its inputs to bf16 in the BF32 mode only
+        x_bf16, weight_bf16 = x.bfloat16().float(), weight.bfloat16().float()
+        for mode, ref in [(ipex.FP32MathMode.FP32, torch.nn.functional.linear(x, weight, bias)),
+                          (ipex.FP32MathMode.BF32, torch.nn.functional.linear(x_bf16, weight_bf16, bias))]:
+            ipex.set_fp32_math_mode(mode=mode, device="cpu")
+            y = torch.ops.torch_ipex.ipex_MKLSGEMM(x, packed_weight, bias, ctx.get_data_handle(), 32)
+            self.assertEqual(y, ref, rtol=1e-4, atol=1e-4)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -93,6 +93,31 @@ class TestGraphCapture(TestCase):
                 y2 = model(x)
         self.assertEqual(y1, y2)
 
+    def test_inference_graph_mode_cache(self):
+        model = Conv_Bn_Relu().to(memory_format=torch.channels_last).eval()
+        x = torch.randn(3, 6, 10, 10).to(memory_format=torch.channels_last)
+        y1 = model(x)
+        with tempfile.TemporaryDirectory() as tmp:
+            os.environ['IPEX_GRAPH_CACHE_DIR'] = tmp
+            try:
+                with torch.no_grad():
+                    y2 = ipex.optimize(model, graph_mode=True)(x)
+                    cached = [f for f in os.listdir(tmp) if f.endswith('.pt')]
+                    self.assertEqual(len(cached), 1)
+                    # the second model loads the graph of the first one
+                    mtime = os.path.getmtime(os.path.join(tmp, cached[0]))
+                    y3 = ipex.optimize(model, graph_mode=True)(x)
+                    self.assertEqual(os.listdir(tmp), cached)
+                    self.assertEqual(os.path.getmtime(os.path.join(tmp, cached[0])), mtime)
+                    # other weights miss the cache
+                    model.conv.weight.data.add_(1)
+                    ipex.optimize(model, graph_mode=True)(x)
+                    self.assertEqual(len([f for f in os.listdir(tmp) if f.endswith('.pt')]), 2)
+            finally:
+                del os.environ['IPEX_GRAPH_CACHE_DIR']
+        self.assertEqual(y1, y2)
+        self.assertEqual(y1, y3)
+
     def test_inference_graph_mode_jit_autocast(self):
         model = Conv_Bn_Relu().to(memory_format=torch.channels_last).eval()
         x = torch.randn(3, 6, 10, 10).to(memory_format=torch.channels_last)
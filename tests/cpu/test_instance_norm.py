@@ -114,6 +114,30 @@ class InstanceNormTester(TestCase):
                 self.assertTrue(x2.grad.is_contiguous(memory_format=memory_format))
                 self.assertEqual(x2.grad, x1.grad)
 
+    def test_instance_norm_backward_small_batch(self):
+        # at a batch of 1 the rows of the backward are split into spatial blocks
+        num_threads = torch.get_num_threads()
+        torch.set_num_threads(max(num_threads, 8))
+        try:
+            for dim, spatial in [(2, [96, 97]), (3, [9, 40, 41])]:
+                batch, channel = 1, 4
+                m = inst_m[dim](channel, affine=True)
+                m.weight.data.uniform_()
+                m1 = bn_m[dim](batch * channel, affine=True)
+                m1.weight.data.copy_(m.weight.data.repeat(batch))
+
+                input = torch.randn([batch, channel] + spatial)
+                grad = torch.randn([batch, channel] + spatial)
+                x = input.clone().detach().requires_grad_()
+                x1 = input.clone().detach().requires_grad_()
+                m(x).backward(grad)
+                m1(x1.reshape([1, batch * channel] + spatial)).reshape_as(x1).backward(grad)
+                self.assertEqual(x.grad, x1.grad, rtol=1e-4, atol=1e-4)
+                self.assertEqual(m.weight.grad, m1.weight.grad, rtol=1e-4, atol=1e-3)
+                self.assertEqual(m.bias.grad, m1.bias.grad, rtol=1e-4, atol=1e-3)
+        finally:
+            torch.set_num_threads(num_threads)
+
 
 if __name__ == '__main__':
     test = unittest.main()
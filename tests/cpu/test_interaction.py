@@ -49,5 +49,18 @@ class TestInteractionCases(TestCase):
             for i in range(0, 26):
                 torch.testing.assert_allclose(ly1[i].grad, ly2[i].grad, rtol=0.005, atol=0.1)
 
+    def test_interaction_mixed_dtypes(self):
+        # the bf16 embeddings are converted to fp32 on load, as the fp32
+        # interaction of their casts
+        x = torch.randn([256, 128])
+        ly = [torch.randn([256, 128]).bfloat16() for _ in range(26)]
+        A = ipex.nn.functional.interaction(x, *ly)
+        B = ipex.nn.functional.interaction(x, *[V.float() for V in ly])
+        self.assertEqual(A.dtype, torch.float)
+        self.assertEqual(A, B)
+        with torch.cpu.amp.autocast():
+            C = ipex.nn.functional.interaction(x, *ly)
+        self.assertEqual(C, B)
+
 if __name__ == '__main__':
     test = unittest.main()
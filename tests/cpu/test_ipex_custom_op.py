@@ -1,6 +1,7 @@
 import torch
 import intel_extension_for_pytorch as ipex
 import unittest
+import itertools
 from common_utils import TestCase
 
 class TestCustomOp(TestCase):
@@ -26,6 +27,40 @@ class TestCustomOp(TestCase):
         ipex_result = torch.ops.torch_ipex.add_softmax_(a, b) 
         self.assertEqual(orig_result, ipex_result)
 
+    def test_add_softmax_long_row(self):
+        # rows of at least 8192 elements go to the online softmax kernels
+        for dim in [8192, 8200]:
+            a = torch.randn(3, dim) * 10
+            b = torch.randn(dim)
+            orig_result = a.add(b).softmax(-1)
+            ipex_result = torch.ops.torch_ipex.add_softmax_(a.clone(), b)
+            self.assertEqual(orig_result, ipex_result)
+
+    def test_div_add_softmax_dropout(self):
+        for dim, dtype in itertools.product([40, 8200], [torch.float, torch.bfloat16]):
+            a = (torch.randn(2, 3, dim) * 10).to(dtype)
+            b = torch.randn(2, 1, dim).to(dtype)
+            ref = (a.float() / 8 + b.float()).softmax(-1)
+            prec = 1e-2 if dtype == torch.bfloat16 else 1e-5
+            out, keep = torch.ops.torch_ipex.div_add_softmax_dropout(a, b, 8, 0.0)
+            self.assertTrue(keep.all())
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out.float(), ref, rtol=prec, atol=prec)
+            out, keep = torch.ops.torch_ipex.div_add_softmax_dropout(a, b, 8, 0.25)
+            self.assertEqual(keep.dtype, torch.bool)
+            self.assertEqual(out.float(), ref * keep / 0.75, rtol=prec, atol=prec)
+
+    def test_div_add_softmax_mixed_dtypes(self):
+        # a bf16 score with a fp32 mask is converted on load, without a cast
+        for dim, (a_dtype, b_dtype) in itertools.product(
+                [40, 8200], [(torch.bfloat16, torch.float), (torch.float, torch.bfloat16)]):
+            a = (torch.randn(2, 3, dim) * 10).to(a_dtype)
+            b = torch.randn(2, 1, dim).to(b_dtype)
+            ref = (a.float() / 8 + b.float()).softmax(-1)
+            out, keep = torch.ops.torch_ipex.div_add_softmax_dropout(a, b, 8, 0.0)
+            self.assertEqual(out.dtype, torch.float)
+            self.assertEqual(out, ref, rtol=1e-5, atol=1e-5)
+
     def test_inference_mode(self):
         class DemoModel(torch.nn.Module):
             def __init__(self):
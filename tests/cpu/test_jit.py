@@ -806,6 +806,19 @@ class NotChannelShuffle(nn.Module):
         x = x.view(batchsize, -1, width, height)
         return x
 
+class ConvChannelShuffleConv(nn.Module):
+    def __init__(self, groups, conv2_groups=1):
+        super(ConvChannelShuffleConv, self).__init__()
+        self.conv1 = nn.Conv2d(16, 16, 1)
+        self.shuffle = ChannelShuffle_with_Dynamic_Shape(groups)
+        self.conv2 = nn.Conv2d(16, 32, 3, groups=conv2_groups)
+
+    def forward(self, x):
+        # the shuffle of the first conv is folded into its output channels,
+        # the one before the second into its input channels
+        x = self.shuffle(torch.relu(self.conv1(x)))
+        return self.conv2(self.shuffle(torch.sigmoid(x) + x))
+
 class MatmulDivOutplaceOutModifiedByOtherOP_v1(nn.Module):
     def __init__(self, div_scalar=False, with_out=True):
         super(MatmulDivOutplaceOutModifiedByOtherOP_v1, self).__init__()
@@ -1100,6 +1113,32 @@ class ConcatBnRelu(torch.nn.Module):
         x = self.bn(x)
         return self.relu(x)
 
+class ConcatBnEltwise(torch.nn.Module):
+    def __init__(self, dim, cat_dim, in_channels, eltwise, **kwargs):
+        super(ConcatBnEltwise, self).__init__()
+        self.bn = bn_module[dim](in_channels)
+        self.eltwise = eltwise
+        self.cat_dim = cat_dim
+    def forward(self, x1, x2, x3):
+        x = torch.cat((x1, x2, x3), dim = self.cat_dim)
+        return self.eltwise(self.bn(x))
+
+class AddEltwiseMul(torch.nn.Module):
+    def __init__(self, kind, eltwise):
+        super(AddEltwiseMul, self).__init__()
+        self.kind = kind
+        self.eltwise = eltwise
+        self.bias = torch.nn.Parameter(torch.randn(8, 1, 1))
+
+    def forward(self, x, y):
+        if self.kind == 'se':
+            # squeeze and excitation gate of a [N, C, 1, 1] scale
+            return x * self.eltwise(y.mean((2, 3), keepdim=True) + self.bias)
+        if self.kind == 'gate':
+            return self.eltwise(x + y) * y
+        s = x + self.bias
+        return s * self.eltwise(s)
+
 class ConcatBnReluV2(torch.nn.Module):
     def __init__(self, dim, cat_dim, in_channels, **kwargs):
         super(ConcatBnReluV2, self).__init__()
@@ -1124,6 +1163,33 @@ class ConcatBnReluV3(torch.nn.Module):
         x += 2
         return y + x
 
+class GroupNormSiLUConv(torch.nn.Module):
+    def __init__(self, channels, inplace, **kwargs):
+        super(GroupNormSiLUConv, self).__init__()
+        self.norm = torch.nn.GroupNorm(32, channels, eps=1e-6)
+        self.silu = torch.nn.SiLU(inplace=inplace)
+        self.conv = torch.nn.Conv2d(channels, channels, 3, padding=1)
+    def forward(self, x):
+        return self.conv(self.silu(self.norm(x)))
+
+class UpsampleConv(torch.nn.Module):
+    def __init__(self, in_channels, out_channels, kernel_size, groups, **kwargs):
+        super(UpsampleConv, self).__init__()
+        self.conv = torch.nn.Conv2d(in_channels, out_channels, kernel_size, padding=kernel_size // 2, groups=groups)
+    def forward(self, x):
+        return self.conv(F.interpolate(x, scale_factor=2.0, mode='nearest'))
+
+class PoolCat(torch.nn.Module):
+    def __init__(self, in_channels, **kwargs):
+        super(PoolCat, self).__init__()
+        self.conv = torch.nn.Conv2d(in_channels, 16, 3, stride=2, padding=1)
+        self.pool = torch.nn.MaxPool2d(3, stride=2, padding=1)
+    def forward(self, x):
+        a = self.conv(x)
+        b = self.pool(x)
+        c = F.relu(F.avg_pool2d(x, 3, stride=2, padding=1, count_include_pad=False))
+        return torch.cat((a, b, c), dim=1)
+
 class ModMultLinear(nn.Module):
     def __init__(self, w1_dim, w2_dim):
          super(ModMultLinear, self).__init__()
@@ -1154,6 +1220,15 @@ class ModMultLinearWithOrWithoutBias(nn.Module):
          res4 = self.linear4(x)
          return res1, res2, res3, res4
 
+class ModLinearTowers(nn.Module):
+    def __init__(self):
+         super(ModLinearTowers, self).__init__()
+         self.tower1 = nn.Sequential(nn.Linear(16, 32), nn.ReLU(), nn.Linear(32, 8))
+         self.tower2 = nn.Sequential(nn.Linear(24, 40), nn.ReLU(), nn.Linear(40, 8, bias=False))
+
+    def forward(self, x1, x2):
+         return self.tower1(x1) + self.tower2(x2)
+
 class LinearSwishNaive(nn.Module):
     def __init__(self, in_feature, out_feature):
         super(LinearSwishNaive, self).__init__()
@@ -1224,6 +1299,13 @@ class EinsumAddInplaceV1(nn.Module):
     def forward(self, input1, input2, bias):
         return bias.add_(torch.einsum(self.equation, input1, input2))
 
+class EinsumMultiOperands(nn.Module):
+    def __init__(self, equation):
+        super(EinsumMultiOperands, self).__init__()
+        self.equation = equation
+    def forward(self, *operands):
+        return torch.einsum(self.equation, *operands)
+
 class AddMulDiv(nn.Module):
     def __init__(self):
         super(AddMulDiv, self).__init__()
@@ -1519,6 +1601,224 @@ class Tester(TestCase):
             linear_count_ori_v1 = check_op_count(graph_opt_v1, ["ipex_prepack::linear_run"])
             self.assertEqual(linear_count_ori_v1, 2)
 
+    def test_grouped_linear(self):
+        x1 = torch.rand(8, 16)
+        x2 = torch.rand(4, 2, 24)
+        linears = [nn.Linear(16, 32), nn.Linear(24, 9, bias=False), nn.Linear(24, 65)]
+        inputs = [x1, x2, x2]
+        res = torch.ops.torch_ipex.grouped_linear(
+            inputs, [l.weight.detach() for l in linears], [None if l.bias is None else l.bias.detach() for l in linears])
+        for y, l, x in zip(res, linears, inputs):
+            self.assertEqual(y, l(x))
+
+        # the linears of both levels of the towers are grouped
+        model = ipex.optimize(ModLinearTowers().eval(), dtype=torch.float32)
+        x2 = torch.rand(8, 24)
+        ipex._C._jit_set_grouped_linear_enabled(True)
+        try:
+            with torch.no_grad():
+                ref = model(x1, x2)
+                model_jit = torch.jit.freeze(torch.jit.trace(model, (x1, x2)))
+                model_jit(x1, x2)
+                self.assertEqual(model_jit(x1, x2), ref)
+                graph = model_jit.graph_for(x1, x2)
+                kinds = [n.kind() for n in graph.nodes()]
+                self.assertEqual(kinds.count('torch_ipex::grouped_linear'), 2)
+                self.assertFalse('aten::linear' in kinds)
+        finally:
+            ipex._C._jit_set_grouped_linear_enabled(False)
+
+    def test_memory_plan(self):
+        model = nn.Sequential(
+            nn.Linear(32, 64), nn.Linear(64, 64), nn.Linear(64, 64), nn.Linear(64, 16))
+        model = ipex.optimize(model.eval(), dtype=torch.float32)
+        x = torch.rand(8, 32)
+        ipex._C._jit_set_memory_plan_enabled(True)
+        try:
+            with torch.no_grad():
+                ref = model(x)
+                model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                model_jit(x)
+                for _ in range(3):
+                    self.assertEqual(model_jit(x), ref)
+                graph = model_jit.graph_for(x)
+                kinds = [n.kind() for n in graph.nodes()]
+                # the intermediate outputs share an arena, not the graph output
+                self.assertEqual(kinds.count('ipex::memory_arena'), 1)
+                self.assertEqual(kinds.count('ipex_prepack::linear_run_out'), 3)
+                self.assertEqual(kinds.count('ipex_prepack::linear_run'), 1)
+                # the linears of the other shapes do not write into the arena
+                x2 = torch.rand(4, 32)
+                self.assertEqual(model_jit(x2), model(x2))
+        finally:
+            ipex._C._jit_set_memory_plan_enabled(False)
+
+    def test_cat_views(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.bottom = nn.Linear(16, 8)
+                self.top = nn.Linear(16, 8)
+                self.weights = nn.ParameterList([nn.Parameter(torch.rand(10, 8)) for _ in range(3)])
+
+            def forward(self, x, indices, offsets):
+                # DLRM-style: the bags are written into their columns, the linear into its rows
+                bags = [torch.ops.torch_ipex.embedding_bag(w, indices, offsets, False, False) for w in self.weights]
+                y = torch.cat([self.bottom(x)] + bags, dim=1)
+                return torch.cat([self.top(x), self.bottom(x)], dim=0), y
+
+        model = ipex.optimize(M().eval(), dtype=torch.float32)
+        x = torch.rand(4, 16)
+        indices = torch.tensor([1, 2, 4, 5, 4, 3, 2, 9])
+        offsets = torch.tensor([0, 1, 4, 6])
+        ipex._C._jit_set_cat_views_enabled(True)
+        try:
+            with torch.no_grad():
+                ref = model(x, indices, offsets)
+                model_jit = torch.jit.freeze(torch.jit.trace(model, (x, indices, offsets)))
+                model_jit(x, indices, offsets)
+                for _ in range(3):
+                    self.assertEqual(model_jit(x, indices, offsets), ref)
+                graph = model_jit.graph_for(x, indices, offsets)
+                kinds = [n.kind() for n in graph.nodes()]
+                self.assertEqual(kinds.count('ipex::cat_views'), 2)
+                self.assertEqual(kinds.count('torch_ipex::embedding_bag_out'), 3)
+                self.assertFalse('aten::cat' in kinds)
+                # the other shapes fall back to a copy
+                x2, offsets2 = torch.rand(3, 16), torch.tensor([0, 1, 4])
+                self.assertEqual(model_jit(x2, indices, offsets2), model(x2, indices, offsets2))
+
+                # the bags are written into a strided slice
+                out = torch.zeros(4, 24)
+                w = model.weights[0]
+                result = torch.ops.torch_ipex.embedding_bag_out(w, indices, offsets, False, False, out[:, 8:16])
+                self.assertEqual(result, torch.ops.torch_ipex.embedding_bag(w, indices, offsets, False, False))
+                self.assertEqual(out[:, 8:16], result)
+                self.assertEqual(out[:, :8].abs().sum(), 0)
+        finally:
+            ipex._C._jit_set_cat_views_enabled(False)
+
+    def test_linear_eltwise_chain(self):
+        class LinearChain(nn.Module):
+            def __init__(self):
+                super(LinearChain, self).__init__()
+                self.linear = nn.Linear(32, 64)
+
+            def forward(self, x):
+                return torch.clamp(torch.relu(self.linear(x)) * 2.0 + 1.0, 0, 3)
+
+        class LinearChainMultiUse(nn.Module):
+            def __init__(self):
+                super(LinearChainMultiUse, self).__init__()
+                self.linear = nn.Linear(32, 64)
+
+            def forward(self, x):
+                y = self.linear(x) / 4.0
+                return torch.sigmoid(y) - 0.5, y
+
+        x = torch.rand(8, 32)
+        ipex._C._jit_set_eltwise_chain_fusion_enabled(True)
+        try:
+            for base_model, use_te in itertools.product(
+                    [LinearChain(), LinearChainMultiUse()], [False, True]):
+                with self._texpr_enable(use_te), torch.no_grad():
+                    model = ipex.optimize(base_model.eval(), dtype=torch.float32)
+                    ref = model(x)
+                    model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                    for _ in range(3):
+                        self.assertEqual(model_jit(x), ref)
+                    # the nodes of the TE fusion groups are in their subgraphs
+                    graph = str(model_jit.graph_for(x))
+                    self.assertIn('ipex_prepack::linear_eltwise_chain_run', graph)
+                    self.assertNotIn('aten::clamp', graph)
+        finally:
+            ipex._C._jit_set_eltwise_chain_fusion_enabled(False)
+
+    def test_shared_weights_folding(self):
+        class SharedLinear(nn.Module):
+            def __init__(self):
+                super(SharedLinear, self).__init__()
+                self.linear = nn.Linear(32, 32)
+
+            def forward(self, x):
+                for _ in range(3):
+                    x = torch.relu(self.linear(x) * 2.0)
+                return x
+
+        x = torch.rand(8, 32)
+        with self._texpr_enable(False), torch.no_grad():
+            model = SharedLinear().eval()
+            ref = model(x)
+            model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+            for _ in range(3):
+                self.assertEqual(model_jit(x), ref)
+            # the repeated layers share their folded and prepacked weight
+            graph = model_jit.graph_for(x)
+            linears = [n for n in graph.nodes()
+                       if n.kind().startswith('ipex_prepack::linear')]
+            self.assertEqual(len(linears), 3)
+            self.assertEqual(
+                len({n.inputsAt(n.inputsSize() - 1).unique() for n in linears}), 1)
+            self.assertNotIn('aten::mul', str(graph))
+
+    def test_channels_last_propagation(self):
+        class ConvPadConv(nn.Module):
+            def __init__(self):
+                super(ConvPadConv, self).__init__()
+                self.conv1 = nn.Conv2d(16, 32, 3)
+                self.conv2 = nn.Conv2d(32, 32, 3)
+                self.pool = nn.MaxPool2d(2)
+
+            def forward(self, x):
+                y = torch.relu(self.conv1(x))
+                y = F.pad(y, (1, 1, 1, 1)) + 1.0
+                return self.pool(self.conv2(y)).flatten(1)
+
+        ipex._C._jit_set_channels_last_propagation_enabled(True)
+        self.assertTrue(ipex._C._jit_channels_last_propagation_enabled())
+        try:
+            formats = [torch.contiguous_format, torch.channels_last]
+            for memory_format, use_te in itertools.product(
+                    formats, [False, True]):
+                x = torch.rand(2, 16, 20, 20).to(memory_format=memory_format)
+                with self._texpr_enable(use_te), torch.no_grad():
+                    model = ConvPadConv().eval()
+                    ref = model(x)
+                    model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                    for _ in range(3):
+                        self.assertEqual(model_jit(x), ref)
+        finally:
+            ipex._C._jit_set_channels_last_propagation_enabled(False)
+
+    def test_linear_gate(self):
+        class GatedMLP(nn.Module):
+            def __init__(self, act, up_first):
+                super(GatedMLP, self).__init__()
+                self.gate = nn.Linear(32, 64)
+                self.up = nn.Linear(32, 64)
+                self.act = act
+                self.up_first = up_first
+
+            def forward(self, x):
+                if self.up_first:
+                    up = self.up(x)
+                    return up * self.act(self.gate(x))
+                return self.act(self.gate(x)) * self.up(x)
+
+        x = torch.rand(8, 32)
+        acts = [nn.SiLU(), nn.GELU(), nn.GELU(approximate='tanh')]
+        for act, up_first, use_te in itertools.product(
+                acts, [False, True], [False, True]):
+            with self._texpr_enable(use_te), torch.no_grad():
+                model = GatedMLP(act, up_first).eval()
+                ref = model(x)
+                model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                for _ in range(3):
+                    self.assertEqual(model_jit(x), ref)
+                graph = str(model_jit.graph_for(x))
+                self.assertIn('ipex_prepack::linear_gate_run', graph)
+                self.assertNotIn('aten::mul', graph)
+
     def test_add_layernorm(self):
         for dim in [768, 100]:
             with torch.no_grad():
@@ -1605,6 +1905,67 @@ class Tester(TestCase):
                 torch._C._jit_set_texpr_fuser_enabled(pre_te_enable_status)
                 self.assertTrue(any(n.kind() == node for n in trace_graph.nodes()))
 
+    def test_add_layernorm_inplace(self):
+        dim = 768
+        a = torch.randn(4, 16, dim)
+        b = torch.randn(4, 16, dim)
+        c = torch.randn(4, 16, dim)
+        inputs = [t.clone() for t in (a, b, c)]
+        with self._texpr_enable(False), torch.no_grad():
+            # a + b is dead after the add_layernorm, which writes into it
+            model = AddLayerNorm_v1(dim).eval()
+            jit_model = torch.jit.freeze(torch.jit.trace(model, (a, b, c)))
+            for _ in range(3):
+                self.assertEqual(jit_model(a, b, c), model(a, b, c))
+            graph = str(jit_model.graph_for(a, b, c))
+            self.assertIn('ipex::add_layernorm_', graph)
+            # the graph inputs are not overwritten
+            for t, ref in zip((a, b, c), inputs):
+                self.assertEqual(t, ref)
+            model = AddLayerNorm(dim).eval()
+            jit_model = torch.jit.freeze(torch.jit.trace(model, (a, b)))
+            for _ in range(3):
+                self.assertEqual(jit_model(a, b), model(a, b))
+            graph = str(jit_model.graph_for(a, b))
+            self.assertNotIn('ipex::add_layernorm_', graph)
+            self.assertEqual(a, inputs[0])
+
+    def test_norm_linear(self):
+        class AddLayerNormLinear(nn.Module):
+            def __init__(self, dim):
+                super(AddLayerNormLinear, self).__init__()
+                self.layernorm = nn.LayerNorm(dim)
+                self.linear = nn.Linear(dim, 64)
+
+            def forward(self, x, y):
+                return self.linear(self.layernorm(x + y))
+
+        class RMSNormLinear(nn.Module):
+            def __init__(self, dim):
+                super(RMSNormLinear, self).__init__()
+                self.weight = nn.Parameter(torch.rand(dim))
+                self.linear = nn.Linear(dim, 64, bias=False)
+
+            def forward(self, x):
+                variance = x.pow(2).mean(-1, keepdim=True)
+                x = x * torch.rsqrt(variance + 1e-6)
+                return self.linear(self.weight * x)
+
+        # a decode shape, and one normalized and multiplied by several chunks
+        for dim, shape in itertools.product([100, 768], [[1, 1], [4, 2048]]):
+            x = torch.randn(shape + [dim])
+            y = torch.randn(shape + [dim])
+            for model, inputs in [(AddLayerNormLinear(dim), (x, y)), (RMSNormLinear(dim), (x,))]:
+                with self._texpr_enable(False), torch.no_grad():
+                    model = model.eval()
+                    ref = model(*inputs)
+                    jit_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+                    for _ in range(3):
+                        self.assertEqual(jit_model(*inputs), ref, prec=1e-4)
+                    graph = str(jit_model.graph_for(*inputs))
+                    self.assertIn('ipex_prepack::norm_linear_run', graph)
+                    self.assertNotIn('ipex_prepack::linear_run', graph)
+
     def test_concat_bn_relu(self):
         batch_size = 3
         image_size = 16
@@ -1649,16 +2010,110 @@ class Tester(TestCase):
                     self.assertEqual(tresult.dtype, dtype)
                     if use_channels_last:
                         self.assertTrue(tresult.is_contiguous(memory_format=suggest_memory_format))
-                    if use_channels_last and a1.size(1) % 16 == 0 and a2.size(1) % 16 == 0 and a3.size(1) % 16 == 0:
-                        self.assertTrue(any(n.kind() == "ipex::concat_bn_relu" for n in trace_graph.nodes()))
-                    else:
-                        self.assertTrue(all(n.kind() != "ipex::concat_bn_relu" for n in trace_graph.nodes()))
+                    self.assertTrue(any(n.kind() == "ipex::concat_bn_eltwise" for n in trace_graph.nodes()))
 
             model = ipex.optimize(model3, dtype=dtype, level = level)
             trace_model = torch.jit.trace(model, (a[0], a[1], a[2])).eval()
             trace_model = torch.jit.freeze(trace_model)
             trace_graph = trace_model.graph_for(a[0], a[1], a[2])
-            self.assertTrue(any(n.kind() != "ipex::concat_bn_relu" for n in trace_graph.nodes()))
+            self.assertTrue(any(n.kind() != "ipex::concat_bn_eltwise" for n in trace_graph.nodes()))
+
+    def test_concat_bn_eltwise(self):
+        eltwises = [torch.nn.ReLU6(), torch.nn.SiLU(), torch.nn.GELU(), torch.nn.GELU(approximate='tanh'), torch.nn.Identity()]
+        options = itertools.product(eltwises, [1, 2], [torch.float32, torch.bfloat16], [True, False])
+        for eltwise, cat_dim, dtype, use_channels_last in options:
+            channels = [8, 24, 3] if cat_dim == 1 else [16, 16, 16]
+            heights = [5, 7, 2] if cat_dim == 2 else [6, 6, 6]
+            a = [torch.randn(2, c, h, 9, dtype=dtype) for c, h in zip(channels, heights)]
+            if use_channels_last:
+                a = [x.to(memory_format=torch.channels_last) for x in a]
+            model = ConcatBnEltwise(2, cat_dim, sum(channels) if cat_dim == 1 else 16, eltwise).eval()
+            model.bn.running_mean.uniform_(-1, 1)
+            model.bn.running_var.uniform_(0.5, 2)
+            model = ipex.optimize(model, dtype=dtype, level='O1')
+            with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16), torch.no_grad():
+                result = model(*a)
+                trace_model = torch.jit.freeze(torch.jit.trace(model, tuple(a)).eval())
+                trace_model(*a)
+                tresult = trace_model(*a)
+                trace_graph = trace_model.graph_for(*a)
+            self.assertEqual(result, tresult, prec=5e-2 if dtype == torch.bfloat16 else 1e-5)
+            self.assertEqual(tresult.dtype, dtype)
+            self.assertTrue(any(n.kind() == "ipex::concat_bn_eltwise" for n in trace_graph.nodes()))
+
+    def test_add_eltwise_mul(self):
+        eltwises = [torch.nn.ReLU(), torch.nn.Sigmoid(), torch.nn.Hardsigmoid(), torch.nn.Tanh(), torch.nn.SiLU(),
+                    torch.nn.GELU(), torch.nn.GELU(approximate='tanh')]
+        options = itertools.product(eltwises, ['se', 'gate', 'swish'], [torch.float32, torch.bfloat16], [True, False])
+        for eltwise, kind, dtype, use_channels_last in options:
+            x = torch.randn(2, 8, 6, 5, dtype=dtype)
+            y = torch.randn(2, 8, 6, 5, dtype=dtype)
+            if use_channels_last:
+                x = x.to(memory_format=torch.channels_last)
+            model = AddEltwiseMul(kind, eltwise).eval().to(dtype)
+            with torch.no_grad():
+                result = model(x, y)
+                trace_model = torch.jit.freeze(torch.jit.trace(model, (x, y)).eval())
+                trace_model(x, y)
+                tresult = trace_model(x, y)
+                trace_graph = trace_model.graph_for(x, y)
+            self.assertEqual(result, tresult, prec=5e-2 if dtype == torch.bfloat16 else 1e-5)
+            self.assertEqual(tresult.dtype, dtype)
+            self.assertTrue(any(n.kind() == "ipex::add_eltwise_mul" for n in trace_graph.nodes()))
+
+    def test_group_norm_silu_conv(self):
+        for dtype, inplace in itertools.product([torch.float32, torch.bfloat16], [True, False]):
+            x = torch.randn(2, 64, 16, 16).to(memory_format=torch.channels_last)
+            model = GroupNormSiLUConv(64, inplace).eval().to(memory_format=torch.channels_last)
+            model = ipex.optimize(model, dtype=dtype)
+            x = x.to(dtype)
+            with torch.no_grad():
+                result = model(x)
+                trace_model = torch.jit.freeze(torch.jit.trace(model, x).eval())
+                trace_model(x)
+                tresult = trace_model(x)
+                trace_graph = trace_model.graph_for(x)
+            self.assertEqual(result, tresult, prec=0.1 if dtype == torch.bfloat16 else None)
+            self.assertTrue(tresult.is_contiguous(memory_format=torch.channels_last))
+            self.assertTrue(any(n.kind() == "ipex_prepack::convolution_group_norm_silu_run" for n in trace_graph.nodes()))
+
+    def test_upsample_nearest_conv(self):
+        options = itertools.product([1, 3, 5], [1, 4], [torch.float32, torch.bfloat16])
+        for kernel_size, groups, dtype in options:
+            x = torch.randn(2, 8, 7, 10).to(memory_format=torch.channels_last)
+            model = UpsampleConv(8, 12, kernel_size, groups).eval().to(memory_format=torch.channels_last)
+            model = ipex.optimize(model, dtype=dtype)
+            x = x.to(dtype)
+            with torch.no_grad():
+                result = model(x)
+                trace_model = torch.jit.freeze(torch.jit.trace(model, x).eval())
+                trace_model(x)
+                tresult = trace_model(x)
+                trace_graph = trace_model.graph_for(x)
+            self.assertEqual(result, tresult, prec=0.1 if dtype == torch.bfloat16 else None)
+            self.assertTrue(tresult.is_contiguous(memory_format=torch.channels_last))
+            self.assertTrue(any(n.kind() == "ipex_prepack::convolution_upsample_nearest_run" for n in trace_graph.nodes()))
+            self.assertFalse(any(n.kind() == "aten::upsample_nearest2d" for n in trace_graph.nodes()))
+
+    def test_pool_cat(self):
+        options = itertools.product([7, 32], [16, 15], [torch.float32, torch.bfloat16], [True, False])
+        for in_channels, image_size, dtype, use_channels_last in options:
+            x = torch.randn(2, in_channels, image_size, image_size).to(dtype)
+            model = PoolCat(in_channels).eval()
+            if use_channels_last:
+                x = x.to(memory_format=torch.channels_last)
+                model = model.to(memory_format=torch.channels_last)
+            model = ipex.optimize(model, dtype=dtype)
+            with torch.no_grad():
+                result = model(x)
+                trace_model = torch.jit.freeze(torch.jit.trace(model, x).eval())
+                trace_model(x)
+                tresult = trace_model(x)
+                trace_graph = trace_model.graph_for(x)
+            self.assertEqual(result, tresult, prec=0.02 if dtype == torch.bfloat16 else None)
+            self.assertEqual(tresult.dtype, dtype)
+            has_pool_cat = any(n.kind() == "ipex::pool_cat" for n in trace_graph.nodes())
+            self.assertEqual(has_pool_cat, use_channels_last)
 
     def test_mha_scores_calculation(self):
         def _check_match_mha(trace_model, mat1, mat2, bias, node = "ipex::mha_scores_calc"):
@@ -3066,6 +3521,31 @@ class Tester(TestCase):
                 #     kind_not_in_graph="ipex_prepack::conv_transpose_prepack",
                 #     prec=prec)
 
+    def test_conv3d_channels_last_3d_input(self):
+        # only the NDHWC input is channels last, the prepacked weights are
+        # planned for it and the fused outputs stay channels last
+        x = torch.randn(2, 3, 6, 8, 8).to(memory_format=torch.channels_last_3d)
+        modules = [
+            (ConvEltwise(torch.relu, 3, 3, 8, 3, 8), "ipex_prepack::convolution_relu_run"),
+            (ConvEltwise(torch.sigmoid, 3, 3, 8, 3, 8), "ipex_prepack::convolution_sigmoid_run"),
+            (ConvTransposeEltwise(torch.relu, 3, 3, 8, 3, 8), "ipex_prepack::conv_transpose_relu_run"),
+            (ConvTransposeEltwise(torch.sigmoid, 3, 3, 8, 3, 8), "ipex_prepack::conv_transpose_sigmoid_run"),
+            (ConvTransposeSigmoidMul(torch.mul, 3, 3, 8, 3, 8), "ipex_prepack::conv_transpose_swish_run"),
+            (ConvTransposeSumAccumuOnRight(3, lambda a, b, kwargs: torch.add(a, b), 3, 8, 3, 8),
+             "ipex_prepack::conv_transpose_add_run"),
+        ]
+        for m, kind in modules:
+            m = m.eval()
+            with torch.no_grad():
+                ref = m(x)
+                traced = torch.jit.freeze(torch.jit.trace(m, x))
+                traced(x)
+                y = traced(x)
+                graph = traced.graph_for(x)
+            self.assertTrue(any(n.kind() == kind for n in graph.nodes()))
+            self.assertTrue(y.is_contiguous(memory_format=torch.channels_last_3d))
+            self.assertEqual(ref, y)
+
     def test_linear_fp32_with_dynamic_input(self):
         x1 = torch.rand(512, 64)
         x2 = torch.rand(15, 64)
@@ -3128,6 +3608,37 @@ class Tester(TestCase):
                     # level is O0 (weights_prepack is False), we will use mkl linear
                     self.assertTrue(any(n.kind() == 'aten::linear' for n in trace_graph.nodes()))
 
+    def test_linear_backend_selection(self):
+        class TwoLinears(nn.Module):
+            def __init__(self):
+                super(TwoLinears, self).__init__()
+                self.linear1 = nn.Linear(64, 256)
+                self.linear2 = nn.Linear(256, 16, bias=False)
+
+            def forward(self, x):
+                return self.linear2(self.linear1(x))
+
+        ipex._C._jit_set_linear_backend_selection_enabled(True)
+        self.assertTrue(ipex._C._jit_linear_backend_selection_enabled())
+        try:
+            for batch in [1, 64]:
+                x = torch.rand(batch, 64)
+                model = TwoLinears().eval()
+                ref = model(x)
+                model = ipex.optimize(model, dtype=torch.float32, auto_kernel_selection=True)
+                with torch.no_grad():
+                    traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                    for _ in range(3):
+                        y = traced_model(x)
+                    trace_graph = traced_model.graph_for(x)
+                self.assertEqual(y, ref, prec=1e-5)
+                # each linear is prepacked into the backend selected for it
+                linears = [n.kind() for n in trace_graph.nodes()
+                           if n.kind() in ['ipex_prepack::linear_run', 'ipex_prepack::mkl_sgemm_run']]
+                self.assertEqual(len(linears), 2)
+        finally:
+            ipex._C._jit_set_linear_backend_selection_enabled(False)
+
     def test_linear_auto_kernel_selection_bf16(self):
         x = torch.rand(32, 3)
         options = itertools.product(['O0', 'O1'], [True, False])
@@ -3453,6 +3964,17 @@ class Tester(TestCase):
             torch.rand(10, 16, 50, 60),
             kind_not_in_graph="ipex::shuffle_2d")
 
+    def test_conv_channel_shuffle_folding(self):
+        self._test_output(
+            ConvChannelShuffleConv(4),
+            torch.rand(2, 16, 20, 20),
+            kind_not_in_graph="ipex::shuffle_2d")
+        # a grouped conv mixes the shuffled channels across its groups
+        self._test_output(
+            ConvChannelShuffleConv(4, conv2_groups=2),
+            torch.rand(2, 16, 20, 20),
+            kind_in_graph="ipex::shuffle_2d")
+
 
     def test_jit_function(self):
         #test hool trace and script can works for function
@@ -3606,6 +4128,20 @@ class Tester(TestCase):
                 kind_in_graph=None,
                 kind_not_in_graph="ipex::matmul_div")
 
+    def test_small_bmm(self):
+        # a batch of many small matrices, multiplied by the libxsmm kernel
+        x = torch.randn(4 * torch.get_num_threads() * 32, 16, 24)
+        self._test_output(
+            MatmulDivOutplace(div_scalar=True, with_out=False),
+            x,
+            kind_in_graph="ipex::matmul_div",
+            kind_not_in_graph=None)
+        self._test_output(
+            MatmulDivOutplace(div_scalar=True, with_out=True),
+            x,
+            kind_in_graph="ipex::matmul_div",
+            kind_not_in_graph=None)
+
     def test_transposed_matmuldiv(self):
         x1 = [torch.randn(53, 23, 27, 25),
               torch.randn(53, 27, 23, 25).transpose(1, 2),
@@ -3910,6 +4446,39 @@ class Tester(TestCase):
         _test_fp32(model_from_vit_alphafold2_v3, input1, input2, bias)
 
 
+    def test_einsum_contract(self):
+        cases = [
+            # contracting the last two operands first saves most of the FLOPs
+            ("ab,bc,cd->ad", [(64, 512), (512, 512), (512, 8)]),
+            ("bij,bjk,bkl,bl->bi", [(2, 16, 32), (2, 32, 64), (2, 64, 8), (2, 8)]),
+            ("ij,jk,kl->li", [(16, 8), (8, 32), (32, 4)]),
+            ("ab,cd,bd->ac", [(8, 16), (4, 32), (16, 32)]),
+        ]
+        for (equation, shapes), dtype in itertools.product(cases, [torch.float32, torch.bfloat16]):
+            # positive, for the bf16 results to be within a relative tolerance
+            operands = [torch.rand(s).to(dtype) for s in shapes]
+            model = EinsumMultiOperands(equation).eval()
+            with torch.no_grad():
+                ref = torch.einsum(equation, *[t.float() for t in operands])
+                tr_model = torch.jit.freeze(torch.jit.trace(model, operands))
+                tr_model(*operands)
+                tr_model(*operands)
+                trace_graph = tr_model.graph_for(*operands)
+                res = tr_model(*operands)
+                self.assertTrue(any(n.kind() == "ipex::einsum_contract" for n in trace_graph.nodes()))
+                self.assertEqual(res.dtype, dtype)
+                rtol = 1e-4 if dtype == torch.float32 else 4e-2
+                self.assertTrue(torch.allclose(res.float(), ref, rtol=rtol))
+
+        # the einsums of two operands keep their own paths
+        model = EinsumMultiOperands("ab,bc->ac").eval()
+        operands = [torch.randn(8, 16), torch.randn(16, 4)]
+        with torch.no_grad():
+            tr_model = torch.jit.freeze(torch.jit.trace(model, operands))
+            tr_model(*operands)
+            trace_graph = tr_model.graph_for(*operands)
+            self.assertFalse(any(n.kind() == "ipex::einsum_contract" for n in trace_graph.nodes()))
+
     def test_ipex_softmax(self):
         self._test_output(
             AtenSoftmaxRepalce(),
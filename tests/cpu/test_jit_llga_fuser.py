@@ -788,6 +788,64 @@ class TestFusionPattern(JitLlgaTestCase):
         self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
         self.assertFused(graph, ['aten::_convolution', 'aten::relu'])
 
+    @llga_fp32_bf16_test_env
+    def test_output_with_unfused_users(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv1 = nn.Conv2d(32, 32, 3, padding=1, bias=True)
+                self.conv2 = nn.Conv2d(32, 32, 3, padding=1, bias=True)
+                self.adaptive_avg_pool_2d = nn.AdaptiveAvgPool2d((5, 7))
+
+            def forward(self, x):
+                x = self.conv1(x)
+                y = self.conv2(x)
+                return self.adaptive_avg_pool_2d(x), y
+
+        # The output of conv1 is used by the partition of conv2 and by the
+        # unsupported adaptive_avg_pool2d, which reads it through LlgaToDense
+        m = M()
+        x = torch.rand(1, 32, 28, 28)
+        graph, _ = self.checkTrace(m, [x])
+        self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
+        self.assertGraphContainsExactly(graph, 'ipex::LlgaToDense', 1)
+
+    @llga_fp32_bf16_test_env
+    def test_output_buffer_reuse(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv1 = nn.Conv2d(32, 32, 3, padding=1, bias=True)
+                self.conv2 = nn.Conv2d(32, 32, 3, padding=1, bias=True)
+
+            def forward(self, x):
+                x = self.conv1(x)
+                x = torch.cumsum(x, dim=1)
+                return self.conv2(x)
+
+        enabled = ipex._C._jit_llga_output_buffer_reuse_enabled()
+        ipex._C._jit_set_llga_output_buffer_reuse_enabled(True)
+        try:
+            ipex._C._jit_clear_llga_output_buffers()
+            m = M().eval()
+            x = torch.rand(1, 32, 28, 28)
+            graph, traced = self.checkTrace(m, [x])
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
+            with torch.no_grad():
+                ref = m(x)
+                # the buffers of the outputs of the previous runs are reused,
+                # those of the kept outputs are not
+                outputs = [traced(x) for _ in range(3)]
+            for y in outputs:
+                self.assertEqual(y, ref)
+            stats = ipex._C._jit_llga_output_buffer_stats()
+            self.assertGreater(stats["reused"], 0)
+            self.assertGreater(stats["pooled_bytes"], 0)
+            ipex._C._jit_clear_llga_output_buffers()
+            self.assertEqual(ipex._C._jit_llga_output_buffer_stats()["reused"], 0)
+        finally:
+            ipex._C._jit_set_llga_output_buffer_reuse_enabled(enabled)
+
 
 class TestAPI(JitLlgaTestCase):
     def test_weight_cache_api(self):
@@ -157,6 +157,28 @@ class TestLauncher(TestCase):
             r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
             self.assertEqual(r.returncode, 0)
 
+    def test_calibration_config_selection(self):
+        from intel_extension_for_pytorch.cpu.launch.calibration import pareto_front, select_config
+        trials = [
+            {'ninstances': 14, 'ncores_per_instance': 4, 'batch_size': 1, 'latency': 10.0, 'throughput': 1400.0},
+            {'ninstances': 14, 'ncores_per_instance': 4, 'batch_size': 4, 'latency': 30.0, 'throughput': 1870.0},
+            {'ninstances': 7, 'ncores_per_instance': 8, 'batch_size': 4, 'latency': 20.0, 'throughput': 1400.0},
+            {'ninstances': 7, 'ncores_per_instance': 8, 'batch_size': 1, 'latency': 8.0, 'throughput': 875.0},
+            {'ninstances': 2, 'ncores_per_instance': 28, 'batch_size': 16, 'latency': 40.0, 'throughput': 800.0},
+        ]
+        # dominated: 7x8 bs4 by 14x4 bs1, 2x28 bs16 by 14x4 bs4
+        front = pareto_front(trials)
+        self.assertEqual([t['latency'] for t in front], [8.0, 10.0, 30.0])
+        best, _, slo_met = select_config(trials, latency_slo=25)
+        self.assertTrue(slo_met)
+        self.assertEqual((best['ninstances'], best['batch_size']), (14, 1))
+        best, _, slo_met = select_config(trials)
+        self.assertEqual((best['ninstances'], best['batch_size']), (14, 4))
+        # no configuration meets the SLO, the lowest latency one
+        best, _, slo_met = select_config(trials, latency_slo=5)
+        self.assertFalse(slo_met)
+        self.assertEqual(best['latency'], 8.0)
+
     def verify_affinity(self, pools, ground_truth):
         self.assertEqual(len(pools), ground_truth['ninstances'])
         self.assertEqual(len(pools[0]), ground_truth['ncores_per_instance'])
@@ -1,4 +1,5 @@
 import unittest
+import itertools
 import torch
 import intel_extension_for_pytorch as ipex
 from torch.testing._internal.common_utils import TestCase
@@ -44,5 +45,83 @@ class TestLinearFuseEltwise(TestCase):
             self.assertEqual(out, ref_out)
             self.assertEqual(x1.grad, x2.grad)
 
+    def test_linear_fuse_eltwise_dst_and_src(self):
+        acts = {
+            'tanh': torch.tanh,
+            'silu': torch.nn.functional.silu,
+            'gelu_tanh': lambda x: torch.nn.functional.gelu(x, approximate='tanh'),
+        }
+        for dtype, (act, ref_act) in itertools.product([torch.float, torch.bfloat16], acts.items()):
+            linear = torch.nn.Linear(40, 37)
+            opt = torch.optim.SGD(linear.parameters(), lr=0.01)
+            ipex_linear, _ = ipex.optimize(linear, optimizer=opt, dtype=dtype)
+            fused = ipex.nn.modules.IPEXLinearEltwise(ipex_linear, act)
+            x1 = torch.randn(2, 6, 40).requires_grad_()
+            x2 = x1.detach().clone().requires_grad_()
+            with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16)):
+                ref = ref_act(ipex_linear(x1))
+                out = fused(x2)
+            ref.sum().backward()
+            out.sum().backward()
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-5
+            self.assertEqual(out.float(), ref.float(), rtol=prec, atol=prec)
+            self.assertEqual(x2.grad, x1.grad, rtol=prec, atol=prec)
+            with torch.no_grad(), torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16)):
+                self.assertEqual(fused(x2).float(), ref.float(), rtol=prec, atol=prec)
+
+    def test_linear_epilogue(self):
+        acts = {
+            'none': lambda x: x,
+            'gelu': torch.nn.functional.gelu,
+            'gelu_tanh': lambda x: torch.nn.functional.gelu(x, approximate='tanh'),
+            'silu': torch.nn.functional.silu,
+        }
+        for dtype, (act, ref_act), with_residual in itertools.product(
+                [torch.float, torch.bfloat16], acts.items(), [True, False]):
+            linear = torch.nn.Linear(40, 37)
+            opt = torch.optim.SGD(linear.parameters(), lr=0.01)
+            ipex_linear, _ = ipex.optimize(copy.deepcopy(linear), optimizer=opt, dtype=dtype)
+            fused = ipex.nn.modules.IPEXLinearEpilogue(ipex_linear, act, p=0.0)
+            x1 = torch.randn(6, 40).requires_grad_()
+            x2 = x1.detach().clone().requires_grad_()
+            r1 = torch.randn(6, 37).requires_grad_()
+            r2 = r1.detach().clone().requires_grad_()
+            with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16)):
+                ref = ref_act(ipex_linear(x1))
+                if with_residual:
+                    ref = ref + r1
+                out = fused(x2, r2 if with_residual else None)
+            ref.sum().backward()
+            out.sum().backward()
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-5
+            self.assertEqual(out.float(), ref.float(), rtol=prec, atol=prec)
+            self.assertEqual(x2.grad, x1.grad, rtol=prec, atol=prec)
+            if with_residual:
+                self.assertEqual(r2.grad, r1.grad)
+
+        # dropout: one bit per element drawn from the default generator
+        linear = torch.nn.Linear(64, 100)
+        opt = torch.optim.SGD(linear.parameters(), lr=0.01)
+        ipex_linear, _ = ipex.optimize(linear, optimizer=opt)
+        fused = ipex.nn.modules.IPEXLinearEpilogue(ipex_linear, 'gelu', p=0.3).train()
+        x = torch.randn(32, 64).requires_grad_()
+        residual = torch.randn(32, 100)
+        torch.manual_seed(0)
+        out = fused(x, residual)
+        torch.manual_seed(0)
+        self.assertEqual(fused(x, residual), out)
+        keep = (out - residual) != 0
+        self.assertTrue(abs(1 - keep.float().mean().item() - 0.3) < 0.05)
+        out.sum().backward()
+        x_ref = x.detach().clone().requires_grad_()
+        ref = torch.nn.functional.gelu(ipex_linear(x_ref)) * keep / 0.7 + residual
+        self.assertEqual(out, ref)
+        ref.sum().backward()
+        self.assertEqual(x.grad, x_ref.grad)
+        # eval mode drops nothing
+        fused.eval()
+        with torch.no_grad():
+            self.assertEqual(fused(x, residual), torch.nn.functional.gelu(ipex_linear(x)) + residual)
+
 if __name__ == '__main__':
     test = unittest.main()
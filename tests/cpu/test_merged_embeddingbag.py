@@ -2,9 +2,16 @@ import torch
 import torch.nn as nn
 import unittest
 import copy
+import intel_extension_for_pytorch as ipex
 from torch.testing._internal.common_utils import TestCase
 from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBagWithSGD as MergedEmbeddingBagWithSGD
 from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBag
+from intel_extension_for_pytorch.nn.modules import QuantizedMergedEmbeddingBag
+from intel_extension_for_pytorch.nn.modules import CompositionalMergedEmbeddingBag
+from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBagWithAdagrad
+from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBagWithAdam
+from intel_extension_for_pytorch.nn.modules import DistributedMergedEmbeddingBagWithSGD
+from intel_extension_for_pytorch.nn.modules.distributed_merged_embeddingbag import shard_tables_by_cost
 
 class TestMergedEmbeddingBagWithSGD(TestCase):
 
@@ -112,6 +119,19 @@ class TestMergedEmbeddingBagWithSGD(TestCase):
             ref_updated_weight = weights[table_id][logical_indice] - default_lr * grad
             self.assertEqual(updated_weights[table_id][logical_indice], ref_updated_weight)
 
+    def test_training_with_dedup_lookup(self):
+        ref_model = copy.deepcopy(self.merged)
+        model = copy.deepcopy(self.merged)
+        model.enable_dedup_lookup()
+        with torch.no_grad():
+            self.assertEqual(model(self.expected_input, torch.BoolTensor([False])), ref_model(self.expected_input, torch.BoolTensor([False])))
+        outputs = model(self.expected_input, torch.BoolTensor([False]))
+        ref_outputs = ref_model(self.expected_input, torch.BoolTensor([False]))
+        self.assertEqual(outputs, ref_outputs)
+        sum(out.sum() for out in outputs).backward()
+        sum(out.sum() for out in ref_outputs).backward()
+        self.assertEqual(model.weights, ref_model.weights)
+
     def test_training_with_weight_decay(self):
         import bench.custom_op_bench.optimizer
         sgd = bench.custom_op_bench.optimizer.non_fused_sgd
@@ -156,6 +176,41 @@ class TestMergedEmbeddingBagWithSGD(TestCase):
         self.assertEqual(w2, self.table2.weight)
         self.assertEqual(torch.zeros_like(w2, dtype=torch.bfloat16), model.sgd_args.bf16_trail[2])
 
+    def test_training_with_interaction(self):
+        tables = [
+            nn.EmbeddingBag(100, 16, mode='mean'),
+            nn.EmbeddingBag(50, 16, mode='sum'),
+            nn.EmbeddingBag(1000, 16, mode='sum', include_last_offset=True),
+        ]
+        input = [
+            [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]),
+             torch.LongTensor([10, 15, 999])],
+            [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 3])],
+            [t.include_last_offset for t in tables]
+        ]
+        for dtype in [torch.float, torch.bfloat16]:
+            model = MergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(tables), lr=0.1)
+            ref_model = MergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(tables), lr=0.1)
+            if dtype == torch.bfloat16:
+                model.to_bfloat16_train()
+                ref_model.to_bfloat16_train()
+            dense = torch.randn(3, 16).to(dtype).requires_grad_()
+            ref_dense = dense.detach().clone().requires_grad_()
+            out = model.forward_with_interaction(dense, input)
+            ref_out = ipex.nn.functional.interaction(ref_dense, *ref_model(input))
+            prec = 1e-2 if dtype == torch.bfloat16 else 1e-5
+            self.assertEqual(out, ref_out, rtol=prec, atol=prec)
+            grad = torch.randn(out.shape).to(out.dtype)
+            out.backward(grad)
+            ref_out.backward(grad)
+            self.assertEqual(dense.grad, ref_dense.grad, rtol=prec, atol=prec)
+            for w, ref_w, trail, ref_trail in zip(
+                    model.weights, ref_model.weights, model.sgd_args.bf16_trail, ref_model.sgd_args.bf16_trail):
+                if dtype == torch.bfloat16:
+                    w = torch.ops.torch_ipex.cat_bfloat16_float(w, trail)
+                    ref_w = torch.ops.torch_ipex.cat_bfloat16_float(ref_w, ref_trail)
+                self.assertEqual(w, ref_w, rtol=prec, atol=prec)
+
 class TestMergedEmbedding(TestCase):
 
     table0 = nn.EmbeddingBag(100, 16, mode='mean', sparse=False).double()
@@ -196,6 +251,24 @@ class TestMergedEmbedding(TestCase):
         merged_indices, merged_offsets, merged_indices_with_row_offsets = self.merged.linearize_indices_and_offsets(*self.input)
         self.assertEqual(self.merged.linearize_indices_and_offsets(*self.input), self.expected_input)
         self.assertEqual(self.merged(self.expected_input, torch.BoolTensor([False])), self.merged2(self.input))
+        # int32 inputs
+        input = [
+            [t.int() for t in self.input[0]],
+            [t.int() if t is not None else None for t in self.input[1]],
+            self.input[2]
+        ]
+        self.assertEqual(self.merged.linearize_indices_and_offsets(*input), self.expected_input)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_prefetch_linearized_inputs(self):
+        cpu_pool = ipex.cpu.runtime.CPUPool([0])
+        batches = [(torch.randn(3, 16), self.input, i) for i in range(4)]
+        prefetched = list(self.merged.prefetch_linearized_inputs(batches, cpu_pool))
+        self.assertEqual(len(prefetched), len(batches))
+        for i, (dense, sparse, label) in enumerate(prefetched):
+            self.assertEqual(dense, batches[i][0])
+            self.assertEqual(sparse, self.expected_input)
+            self.assertEqual(label, i)
 
     def _test_inference_only(self, model):
         with torch.no_grad():
@@ -248,6 +321,434 @@ class TestMergedEmbedding(TestCase):
         self.assertEqual(self.table1.weight.grad, model.weights[1].grad)
         self.assertEqual(self.table2.weight.grad, model.weights[2].grad)
 
+    def test_training_reuse_csr2csc_workspace(self):
+        # csr2csc buffers persist across backward calls, run a large batch
+        # (parallel radix sort) followed by a smaller one
+        table0 = nn.EmbeddingBag(70000, 4, mode='mean')
+        table1 = nn.EmbeddingBag(300, 8, mode='sum')
+        for batch_size in [4096, 16]:
+            model = MergedEmbeddingBag.from_embeddingbag_list([table0, table1])
+            ref_tables = copy.deepcopy([table0, table1])
+            indices = [torch.randint(0, t.num_embeddings, (batch_size * 3,)) for t in ref_tables]
+            offsets = [torch.arange(0, batch_size * 3, 3) for _ in ref_tables]
+            outputs = model((indices, offsets, [False, False]))
+            sum(o.sum() for o in outputs).backward()
+            for i, t in enumerate(ref_tables):
+                t(indices[i], offsets[i]).sum().backward()
+                self.assertEqual(t.weight.grad, model.weights[i].grad)
+
+    def test_forward_with_interaction(self):
+        tables = [
+            nn.EmbeddingBag(100, 16, mode='mean'),
+            nn.EmbeddingBag(50, 16, mode='sum'),
+            nn.EmbeddingBag(1000, 16, mode='sum', include_last_offset=True),
+        ]
+        input = [
+            [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]), torch.LongTensor([10, 15, 999])],
+            [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 3])],
+            [t.include_last_offset for t in tables]
+        ]
+        dense = torch.randn(3, 16)
+        for dtype in [torch.float, torch.bfloat16]:
+            model = MergedEmbeddingBag.from_embeddingbag_list(copy.deepcopy(tables)).to(dtype)
+            with torch.no_grad():
+                ref = ipex.nn.functional.interaction(dense.to(dtype), *model(input))
+                out = model.forward_with_interaction(dense.to(dtype), input)
+            # the fused op keeps pooled rows in fp32
+            self.assertEqual(out, ref, rtol=1e-2 if dtype == torch.bfloat16 else 1e-5, atol=1e-2 if dtype == torch.bfloat16 else 1e-5)
+
+    def test_forward_with_qinteraction(self):
+        weights = [torch.randn(100, 128), torch.randn(50, 128)]
+        qweights = [torch.quantize_per_tensor(w, 0.05, 0, torch.qint8) for w in weights]
+        dense = torch.quantize_per_tensor(torch.randn(4, 128), 0.05, 0, torch.qint8)
+        # one index per bag, as quantized DLRM does
+        indices = torch.LongTensor([1, 5, 7, 99, 0, 1, 2, 3])
+        offsets = torch.arange(9)
+        out = torch.ops.torch_ipex.merged_embeddingbag_qinteraction_forward(dense, indices, offsets, qweights, 0.5)
+        pooled = [qweights[t].dequantize()[indices[4 * t:4 * t + 4]] for t in range(2)]
+        ref = ipex.nn.functional.interaction(dense.dequantize(), *pooled)
+        self.assertEqual(out.dequantize(), torch.quantize_per_tensor(ref, 0.5, 0, torch.qint8).dequantize(), rtol=0, atol=0.5)
+
+    def test_forward_int8(self):
+        weights = [torch.randn(100, 16), torch.randn(50, 80)]
+        qweights = [torch.quantize_per_tensor(w, 0.05, 0, torch.qint8) for w in weights]
+        # 3 bags per table, an empty bag, the sum and the mean of several rows
+        indices = torch.LongTensor([1, 5, 7, 99, 0, 1, 2, 3, 4])
+        offsets = torch.LongTensor([0, 1, 4, 4, 5, 7, 9])
+        pooling_modes = [0, 1]
+        o_scales = [0.05, 0.1]
+        outs = torch.ops.torch_ipex.merged_embeddingbag_forward_int8(
+            indices, offsets, qweights, pooling_modes, o_scales)
+        for t in range(2):
+            ref = torch.nn.functional.embedding_bag(
+                indices[offsets[3 * t]:offsets[3 * t + 3]], qweights[t].dequantize(),
+                offsets[3 * t:3 * t + 3] - offsets[3 * t], mode=['sum', 'mean'][t])
+            self.assertEqual(outs[t].dtype, torch.qint8)
+            self.assertEqual(outs[t].q_scale(), o_scales[t])
+            # the pooled sums are not saturated in the scale of the table
+            self.assertEqual(outs[t].dequantize(), ref.clamp(-128 * o_scales[t], 127 * o_scales[t]),
+                             rtol=0, atol=o_scales[t] / 2 + 1e-6)
+
+    def test_hot_row_cache_and_prefetch(self):
+        model = copy.deepcopy(self.merged)
+        with torch.no_grad():
+            ref_outputs = model(self.expected_input, torch.BoolTensor([False]))
+            model.enable_hot_row_cache(self.input[0], num_hot_rows=2)
+            default_distance = ipex._C.get_embedding_prefetch_distance()
+            for distance in [0, 1, 3, default_distance]:
+                ipex._C.set_embedding_prefetch_distance(distance)
+                outputs = model(self.expected_input, torch.BoolTensor([False]))
+                self.assertEqual(outputs, ref_outputs)
+            ipex._C.set_embedding_prefetch_distance(default_distance)
+            # hot rows are copies, updated weights need a rebuilt cache
+            model.weights[1][30] += 1
+            model.enable_hot_row_cache(self.input[0], num_hot_rows=2)
+            outputs = model(self.expected_input, torch.BoolTensor([False]))
+            model.disable_hot_row_cache()
+            self.assertEqual(outputs, model(self.expected_input, torch.BoolTensor([False])))
+
+class TestQuantizedMergedEmbedding(TestCase):
+
+    table0 = nn.EmbeddingBag(100, 16, mode='mean')
+    table1 = nn.EmbeddingBag(50, 33, mode='sum')
+    table2 = nn.EmbeddingBag(1000, 128, mode='sum', include_last_offset=True)
+    input = [
+        [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]), torch.LongTensor([10, 15, 999])],
+        [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 3])],
+        [table0.include_last_offset, table1.include_last_offset, table2.include_last_offset]
+    ]
+
+    def _dequantize(self, qweight, bit_rate, feature_size):
+        scale_bias = qweight[:, -8:].contiguous().view(torch.float)
+        q = qweight[:, :-8]
+        if bit_rate == 4:
+            q = torch.stack([q & 0x0f, q >> 4], dim=2).view(q.shape[0], -1)
+        return q[:, :feature_size].float() * scale_bias[:, 0:1] + scale_bias[:, 1:2]
+
+    def _test_quantized(self, table_ids, bit_rate):
+        tables = [[self.table0, self.table1, self.table2][i] for i in table_ids]
+        input = [[inp[i] for i in table_ids] for inp in self.input]
+        model = QuantizedMergedEmbeddingBag.from_embeddingbag_list(tables, bit_rate=bit_rate)
+        with torch.no_grad():
+            outputs = model(input)
+            for i, table in enumerate(tables):
+                ref_weight = self._dequantize(model.qweights[i], bit_rate, table.weight.shape[1])
+                ref_out = torch.nn.functional.embedding_bag(
+                    input[0][i], ref_weight, input[1][i], mode=table.mode,
+                    include_last_offset=table.include_last_offset)
+                self.assertEqual(outputs[i].dtype, torch.float)
+                self.assertEqual(outputs[i], ref_out)
+                # quantization error is bounded by the row-wise scale
+                fp32_out = table(input[0][i], input[1][i])
+                self.assertEqual(outputs[i], fp32_out, rtol=0, atol=0.5 if bit_rate == 4 else 0.05)
+
+    def test_int8(self):
+        self._test_quantized([0, 1, 2], 8)
+
+    def test_int4(self):
+        # int4 requires even feature size
+        self._test_quantized([0, 2], 4)
+
+    def test_mixed_tables(self):
+        # int8, fp32, bf16 and int4 tables of different feature sizes in one lookup
+        table3 = nn.EmbeddingBag(60, 24, mode='sum').to(torch.bfloat16)
+        tables = [self.table0, self.table1, table3, self.table2]
+        input = [
+            self.input[0][:2] + [torch.LongTensor([1, 59, 7, 7])] + self.input[0][2:],
+            self.input[1][:2] + [torch.LongTensor([0, 1, 1])] + self.input[1][2:],
+            self.input[2][:2] + [False] + self.input[2][2:],
+        ]
+        bit_rates = [8, 0, 0, 4]
+        model = QuantizedMergedEmbeddingBag.from_embeddingbag_list(tables, bit_rate=bit_rates)
+        with torch.no_grad():
+            outputs = model(input)
+            for i, table in enumerate(tables):
+                ref_weight = table.weight
+                if bit_rates[i] != 0:
+                    ref_weight = self._dequantize(model.qweights[i], bit_rates[i], table.weight.shape[1])
+                ref_out = torch.nn.functional.embedding_bag(
+                    input[0][i], ref_weight, input[1][i], mode=table.mode,
+                    include_last_offset=table.include_last_offset)
+                self.assertEqual(outputs[i].dtype, ref_out.dtype)
+                self.assertEqual(outputs[i], ref_out)
+
+
+class TestCompositionalMergedEmbedding(TestCase):
+
+    table0 = nn.EmbeddingBag(100, 16, mode='mean')
+    table1 = nn.EmbeddingBag(50, 16, mode='sum')
+    table2 = nn.EmbeddingBag(1000, 32, mode='sum', include_last_offset=True)
+    input = [
+        [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]), torch.LongTensor([10, 15, 999, 11])],
+        [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 4])],
+        [table0.include_last_offset, table1.include_last_offset, table2.include_last_offset]
+    ]
+    component_rows = [[10, 10], [50], [8, 5, 25]]
+
+    def _component_rows(self, indices, k, rows, component_rows, mode):
+        if mode == 'quotient_remainder':
+            divisor = 1
+            for r in component_rows[k + 1:]:
+                divisor *= r
+            return indices // divisor % rows
+        mask = (1 << 64) - 1
+        seed = (k * 0x9E3779B97F4A7C15) & mask
+        out = []
+        for i in indices.reshape(-1).tolist():
+            h = ((i ^ seed) * 0xBF58476D1CE4E5B9) & mask
+            h ^= h >> 31
+            out.append(h % rows)
+        return torch.LongTensor(out).reshape(indices.shape)
+
+    def _test_compositional(self, mode, combine, dtype=torch.float):
+        tables = [copy.deepcopy(t).to(dtype) for t in [self.table0, self.table1, self.table2]]
+        model = CompositionalMergedEmbeddingBag.from_embeddingbag_list(tables, self.component_rows, mode, combine)
+        ref_weights = [w.detach().clone().requires_grad_() for w in model.weights]
+        outputs = model(self.input)
+        c = 0
+        ref_outputs = []
+        for i, table in enumerate(tables):
+            rows = self.component_rows[i]
+            indices = self.input[0][i]
+            # the rows of the logical table read by the indices, combined by autograd ops
+            emb = None
+            for k, r in enumerate(rows):
+                component = ref_weights[c + k][self._component_rows(indices, k, r, rows, mode)]
+                emb = component if emb is None else (emb * component if combine == 'mul' else emb + component)
+            c += len(rows)
+            positions = torch.arange(indices.numel()).reshape(indices.shape)
+            ref_outputs.append(torch.nn.functional.embedding_bag(
+                positions, emb.reshape(indices.numel(), -1), self.input[1][i], mode=table.mode,
+                include_last_offset=table.include_last_offset))
+        tol = 1e-2 if dtype == torch.bfloat16 else 1e-5
+        for out, ref_out in zip(outputs, ref_outputs):
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out, ref_out, rtol=tol, atol=tol)
+        sum([out.float().sum() for out in outputs]).backward()
+        sum([out.float().sum() for out in ref_outputs]).backward()
+        for w, ref_w in zip(model.weights, ref_weights):
+            self.assertEqual(w.grad, ref_w.grad, rtol=tol, atol=tol)
+        with torch.no_grad():
+            for out, ref_out in zip(model(self.input), ref_outputs):
+                self.assertEqual(out, ref_out, rtol=tol, atol=tol)
+
+    def test_quotient_remainder(self):
+        for combine in ['mul', 'add']:
+            self._test_compositional('quotient_remainder', combine)
+        self._test_compositional('quotient_remainder', 'mul', torch.bfloat16)
+
+    def test_hashed(self):
+        for combine in ['mul', 'add']:
+            self._test_compositional('hashed', combine)
+
+    def test_quotient_remainder_rows(self):
+        self.assertEqual(CompositionalMergedEmbeddingBag.quotient_remainder_rows(1000, 30), [34, 30])
+
+
+class TestMergedEmbeddingBagWithAdagrad(TestCase):
+    table0 = nn.EmbeddingBag(100, 16, mode='mean')
+    table1 = nn.EmbeddingBag(50, 33, mode='sum')
+    input = [
+        [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([0, 30, 21, 15, 30, 11, 30])],
+        [torch.LongTensor([0, 1, 3]), torch.LongTensor([0, 2, 3])],
+        [False, False]
+    ]
+
+    def _reference_grads(self):
+        grads = []
+        for i, table in enumerate([self.table0, self.table1]):
+            ref = copy.deepcopy(table)
+            ref(self.input[0][i], self.input[1][i]).sum().backward()
+            grads.append(ref.weight.grad)
+        return grads
+
+    def _test_training(self, rowwise, weight_decay):
+        lr, eps, init_acc = 0.1, 1e-10, 0.1
+        model = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(
+            [self.table0, self.table1],
+            lr=lr, eps=eps, weight_decay=weight_decay,
+            initial_accumulator_value=init_acc, rowwise=rowwise
+        )
+        outputs = model(self.input)
+        (outputs[0].sum() + outputs[1].sum()).backward()
+        for i, grad in enumerate(self._reference_grads()):
+            weight = [self.table0, self.table1][i].weight.detach()
+            touched = grad.abs().sum(dim=1) != 0
+            grad = grad + weight * weight_decay
+            if rowwise:
+                hessian = init_acc + (grad * grad).mean(dim=1, keepdim=True)
+            else:
+                hessian = init_acc + grad * grad
+            ref_weight = weight - lr * grad / (hessian.sqrt() + eps)
+            # rows not looked up are not updated in sparse Adagrad
+            ref_weight[~touched] = weight[~touched]
+            self.assertEqual(model.weights[i], ref_weight)
+            self.assertEqual(model.adagrad_args.hessian[i][touched], hessian[touched].reshape(model.adagrad_args.hessian[i][touched].shape))
+
+    def test_adagrad(self):
+        self._test_training(rowwise=False, weight_decay=0)
+        self._test_training(rowwise=False, weight_decay=0.1)
+
+    def test_rowwise_adagrad(self):
+        self._test_training(rowwise=True, weight_decay=0)
+        self._test_training(rowwise=True, weight_decay=0.1)
+
+    def test_rowwise_hessian_shape(self):
+        model = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list([self.table0, self.table1], rowwise=True)
+        self.assertEqual(model.adagrad_args.hessian[0].shape, torch.Size([100]))
+        self.assertEqual(model.adagrad_args.hessian[1].shape, torch.Size([50]))
+
+
+def _run_distributed_with_empty_rank(rank, world_size, init_file, tables, input):
+    import datetime
+    import torch.distributed as dist
+    # a collective left alone by a rank fails instead of hanging the test
+    dist.init_process_group(
+        'gloo', init_method='file://' + init_file, rank=rank, world_size=world_size,
+        timeout=datetime.timedelta(seconds=60))
+    try:
+        ref = MergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(tables))
+        model = DistributedMergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(tables))
+        assert model.local_emb is None if rank == world_size - 1 else model.local_emb is not None
+        ref_outputs = ref(input)
+        outputs = model.forward_async(input).wait()
+        for output, ref_output in zip(outputs, ref_outputs):
+            torch.testing.assert_close(output, ref_output)
+        # every rank feeds the same batch, the owners see it world_size times
+        (world_size * sum(o.sum() for o in ref_outputs)).backward()
+        sum(o.sum() for o in outputs).backward()
+        if model.local_emb is not None:
+            for t, w in zip(model.local_tables, model.local_emb.weights):
+                torch.testing.assert_close(w, ref.weights[t])
+        dist.barrier()
+    finally:
+        dist.destroy_process_group()
+
+class TestDistributedMergedEmbeddingBagWithSGD(TestCase):
+    table0 = nn.EmbeddingBag(100, 16, mode='mean')
+    table1 = nn.EmbeddingBag(50, 32, mode='sum')
+    table2 = nn.EmbeddingBag(1000, 8, mode='sum', include_last_offset=True)
+    tables = [table0, table1, table2]
+    input = [
+        [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]), torch.LongTensor([10, 15, 999])],
+        [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 3])],
+        [table0.include_last_offset, table1.include_last_offset, table2.include_last_offset]
+    ]
+
+    def test_shard_tables_by_cost(self):
+        model = MergedEmbeddingBagWithSGD.from_embeddingbag_list(self.tables)
+        specs = [(w.shape[0], w.shape[1], 'sum', w.dtype, None, False) for w in model.weights]
+        specs = [ipex.nn.modules.merged_embeddingbag.EmbeddingSpec(*spec) for spec in specs]
+        # costs are 1600, 1600, 8000
+        self.assertEqual(shard_tables_by_cost(specs, 2), [1, 1, 0])
+        self.assertEqual(shard_tables_by_cost(specs, 1), [0, 0, 0])
+
+    def test_single_rank(self):
+        import torch.distributed as dist
+        import tempfile
+        with tempfile.NamedTemporaryFile() as f:
+            dist.init_process_group('gloo', init_method='file://' + f.name, rank=0, world_size=1)
+            try:
+                # weights are shared with the source tables, give each model its own copy
+                ref = MergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(self.tables))
+                model = DistributedMergedEmbeddingBagWithSGD.from_embeddingbag_list(copy.deepcopy(self.tables))
+                ref_outputs = ref(self.input)
+                req = model.forward_async(self.input)
+                outputs = req.wait()
+                self.assertEqual(outputs, list(ref_outputs))
+                sum(o.sum() for o in ref_outputs).backward()
+                sum(o.sum() for o in outputs).backward()
+                for t, w in zip(model.local_tables, model.local_emb.weights):
+                    self.assertEqual(w, ref.weights[t])
+            finally:
+                dist.destroy_process_group()
+
+    def test_rank_without_tables(self):
+        # 3 tables on 4 ranks leave the last rank empty, which must still join the backward exchange
+        import tempfile
+        import torch.multiprocessing as mp
+        world_size = 4
+        self.assertEqual(sorted(shard_tables_by_cost(
+            [ipex.nn.modules.merged_embeddingbag.EmbeddingSpec(
+                t.weight.shape[0], t.weight.shape[1], t.mode, t.weight.dtype, None, False) for t in self.tables],
+            world_size)), [0, 1, 2])
+        with tempfile.NamedTemporaryFile() as f:
+            mp.spawn(
+                _run_distributed_with_empty_rank,
+                args=(world_size, f.name, self.tables, self.input),
+                nprocs=world_size, join=True)
+
+
+class TestMergedEmbeddingBagWithAdam(TestCase):
+    table0 = nn.EmbeddingBag(100, 16, mode='mean')
+    table1 = nn.EmbeddingBag(50, 33, mode='sum')
+    input = [
+        [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([0, 30, 21, 15, 30, 11, 30])],
+        [torch.LongTensor([0, 1, 3]), torch.LongTensor([0, 2, 3])],
+        [False, False]
+    ]
+
+    def _reference_grads(self):
+        # the grads of the summed outputs do not depend on the weights
+        grads = []
+        for i, table in enumerate([self.table0, self.table1]):
+            ref = copy.deepcopy(table)
+            ref(self.input[0][i], self.input[1][i]).sum().backward()
+            grads.append(ref.weight.grad)
+        return grads
+
+    def _test_training(self, lamb, weight_decay, bf16=False):
+        lr, beta1, beta2, eps = 0.01, 0.9, 0.999, 1e-8
+        model = MergedEmbeddingBagWithAdam.from_embeddingbag_list(
+            [self.table0, self.table1], lr=lr, betas=(beta1, beta2), eps=eps, weight_decay=weight_decay, lamb=lamb)
+        if bf16:
+            model.to_bfloat16_train()
+        steps = 2
+        for _ in range(steps):
+            outputs = model(self.input)
+            (outputs[0].sum() + outputs[1].sum()).backward()
+        self.assertEqual(model.adam_args.step.item(), steps)
+        for i, grad in enumerate(self._reference_grads()):
+            # the split bf16 weights keep the fp32 weights
+            weight = [self.table0, self.table1][i].weight.detach().clone()
+            touched = grad.abs().sum(dim=1) != 0
+            exp_avg = torch.zeros_like(weight)
+            exp_avg_sq = torch.zeros_like(weight)
+            for step in range(1, steps + 1):
+                g = grad if lamb else grad + weight * weight_decay
+                exp_avg = exp_avg * beta1 + g * (1 - beta1)
+                exp_avg_sq = exp_avg_sq * beta2 + g * g * (1 - beta2)
+                update = (exp_avg / (1 - beta1 ** step)) / ((exp_avg_sq / (1 - beta2 ** step)).sqrt() + eps)
+                ratio = 1
+                if lamb:
+                    update = update + weight * weight_decay
+                    ratio = weight.norm(dim=1, keepdim=True) / update.norm(dim=1, keepdim=True)
+                new_weight = weight - lr * ratio * update
+                # rows not looked up are not updated in sparse Adam
+                weight = torch.where(touched.unsqueeze(1), new_weight, weight)
+            exp_avg[~touched] = 0
+            exp_avg_sq[~touched] = 0
+            if bf16:
+                model_weight = torch.ops.torch_ipex.cat_bfloat16_float(
+                    model.weights[i].data, model.adam_args.bf16_trail[i])
+            else:
+                model_weight = model.weights[i]
+            # the bf16 output grads are rounded
+            tol = dict(atol=1e-4, rtol=1e-2) if bf16 else {}
+            self.assertEqual(model_weight, weight, **tol)
+            self.assertEqual(model.adam_args.exp_avg[i], exp_avg, **tol)
+            self.assertEqual(model.adam_args.exp_avg_sq[i], exp_avg_sq, **tol)
+
+    def test_adam(self):
+        self._test_training(lamb=False, weight_decay=0)
+        self._test_training(lamb=False, weight_decay=0.1)
+        self._test_training(lamb=False, weight_decay=0.1, bf16=True)
+
+    def test_lamb(self):
+        self._test_training(lamb=True, weight_decay=0)
+        self._test_training(lamb=True, weight_decay=0.1)
+        self._test_training(lamb=True, weight_decay=0.1, bf16=True)
+
 
 if __name__ == '__main__':
     test = unittest.main()
@@ -220,6 +220,48 @@ class SD_MHA_Model_scale_v4(nn.Module):
         output = hidden_states.to(query.dtype)
         return output
 
+# GPT-style causal self attention
+class Causal_MHA_Model(nn.Module):
+    def __init__(self, num_heads, hiddensize):
+        super(Causal_MHA_Model, self).__init__()
+        self.heads = num_heads
+        self.query = nn.Linear(hiddensize, hiddensize, bias=True)
+        self.key = nn.Linear(hiddensize, hiddensize, bias=True)
+        self.value = nn.Linear(hiddensize, hiddensize, bias=True)
+
+    def forward(self, x):
+        query = self.query(x)
+        key = self.key(x)
+        value = self.value(x)
+        batch_size, sequence_length, inner_dim = x.shape
+        head_dim = inner_dim // self.heads
+        query = query.view(batch_size, -1, self.heads, head_dim).transpose(1, 2)
+        key = key.view(batch_size, -1, self.heads, head_dim).transpose(1, 2)
+        value = value.view(batch_size, -1, self.heads, head_dim).transpose(1, 2)
+        hidden_states = F.scaled_dot_product_attention(
+            query, key, value, attn_mask=None, dropout_p=0.0, is_causal=True
+        )
+        return hidden_states.transpose(1, 2).reshape(batch_size, -1, self.heads * head_dim)
+
+#(SD attention blocks, GroupNorm and permute to [B, HW, C] before the QKV linear)
+class SD_GroupNorm_MHA_Model(nn.Module):
+    def __init__(self, num_heads, channels, permute=False):
+        super(SD_GroupNorm_MHA_Model, self).__init__()
+        self.permute = permute
+        self.group_norm = nn.GroupNorm(32, channels, eps=1e-6)
+        self.mha = SD_MHA_Model_v3(num_heads, channels, channels)
+
+    def forward(self, x):
+        batch, channel, height, width = x.shape
+        hidden_states = self.group_norm(x)
+        if self.permute:
+            # UNet Transformer2DModel
+            hidden_states = hidden_states.permute(0, 2, 3, 1).reshape(batch, height * width, channel)
+        else:
+            # VAE AttentionBlock
+            hidden_states = hidden_states.view(batch, channel, height * width).transpose(1, 2)
+        return self.mha(hidden_states)
+
 #(Fake Diffusers Model - Fall back to ipex::mha_scores_calc)
 class Fake_SD_MHA_Model(nn.Module):
     def __init__(self, dim_per_head, softmax_dim=-1):
@@ -340,7 +382,7 @@ head_dims = [64, 96, 17]
 # Since the input values are very large for the BMM and SoftMax, the resulting accumulations of MHA
 # result will also be large, thus the tolerance value should be set to 1.5e-0 for such case.
 class TransFreeMHATester(TestCase):
-    def sd_mha_bf16_common(self, model, mat1, mat2=None):
+    def sd_mha_bf16_common(self, model, mat1, mat2=None, fused_kinds=("ipex::sd_flash_mha",)):
         for neg_FLT_MIN in [True, False]:
             sd_mha_model = copy.deepcopy(model)
             if mat2 is not None:
@@ -358,7 +400,8 @@ class TransFreeMHATester(TestCase):
                 self.assertEqual(mha_ref, mha_jit, prec=1.5e-0 if neg_FLT_MIN else 1e-2)
 
                 mha_graph = mha_ipex.graph_for(*inputs)
-                self.assertTrue(any(n.kind() == "ipex::sd_flash_mha" for n in mha_graph.nodes()))
+                for kind in fused_kinds:
+                    self.assertTrue(any(n.kind() == kind for n in mha_graph.nodes()))
 
     def test_sd_mha_bf16_v1(self):
         mat = torch.randn(2, 4096, 320)
@@ -393,6 +436,70 @@ class TransFreeMHATester(TestCase):
         sd_mha_model = SD_MHA_Model_scale_v4(8, 320, 320, 0.11).eval()
         self.sd_mha_bf16_common(sd_mha_model, mat1, mat2)
 
+    def test_causal_mha_bf16(self):
+        # 1100 tokens: several query and key blocks, the blocks above the diagonal are skipped
+        mat = torch.randn(2, 1100, 256)
+        causal_mha_model = Causal_MHA_Model(4, 256).eval()
+        self.sd_mha_bf16_common(causal_mha_model, mat)
+
+    def test_sd_group_norm_mha_bf16(self):
+        mat = torch.randn(2, 320, 32, 32)
+        for permute in [False, True]:
+            model = SD_GroupNorm_MHA_Model(8, 320, permute).eval()
+            self.sd_mha_bf16_common(model, mat, fused_kinds=("ipex::group_norm_transpose", "ipex::sd_flash_mha"))
+
+    def test_group_norm_transpose(self):
+        # partial transpose tiles, channels last and 3-D input, mixed bf16 input / fp32 weight
+        for shape, dtype, memory_format in [
+                ((2, 320, 17, 19), torch.float, torch.contiguous_format),
+                ((2, 320, 17, 19), torch.float, torch.channels_last),
+                ((2, 96, 70), torch.float, torch.contiguous_format),
+                ((2, 320, 17, 19), torch.bfloat16, torch.contiguous_format),
+                ((2, 320, 17, 19), torch.bfloat16, torch.channels_last)]:
+            x = torch.randn(shape).to(dtype).to(memory_format=memory_format)
+            weight = torch.randn(shape[1])
+            bias = torch.randn(shape[1])
+            ref = F.group_norm(x.float(), 32, weight, bias, 1e-6).view(shape[0], shape[1], -1).transpose(1, 2)
+            out = torch.ops.torch_ipex.group_norm_transpose(x, 32, weight, bias, 1e-6)
+            self.assertTrue(out.is_contiguous())
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out.float(), ref, prec=2e-2 if dtype == torch.bfloat16 else 1e-5)
+        x = torch.randn(2, 64, 8, 8)
+        self.assertEqual(
+            torch.ops.torch_ipex.group_norm_transpose(x, 32, None, None, 1e-5),
+            F.group_norm(x, 32).view(2, 64, -1).transpose(1, 2))
+
+    def _test_flash_mha_varlen_bf16(self, num_kv_head):
+        num_head, head_size = 4, 64
+        hidden = num_head * head_size
+        seqlens = [1, 300, 700, 64]
+        cu_seqlens = torch.tensor([0] + seqlens).cumsum(0)
+        total = int(cu_seqlens[-1])
+        query = torch.randn(total, hidden).to(torch.bfloat16)
+        key = torch.randn(total, num_kv_head * head_size).to(torch.bfloat16)
+        value = torch.randn(total, num_kv_head * head_size).to(torch.bfloat16)
+        scale = 1.0 / math.sqrt(head_size)
+        for is_causal in [False, True]:
+            out = torch.ops.torch_ipex.flash_mha_varlen(
+                query, key, value, cu_seqlens, cu_seqlens, num_head, scale, is_causal)
+            for i, seqlen in enumerate(seqlens):
+                rows = slice(int(cu_seqlens[i]), int(cu_seqlens[i + 1]))
+                q = query[rows].float().view(seqlen, num_head, head_size).transpose(0, 1)
+                k, v = [
+                    t[rows].float().view(seqlen, num_kv_head, head_size).transpose(0, 1)
+                    .repeat_interleave(num_head // num_kv_head, dim=0) for t in (key, value)]
+                ref = F.scaled_dot_product_attention(q, k, v, is_causal=is_causal)
+                ref = ref.transpose(0, 1).reshape(seqlen, hidden)
+                self.assertEqual(out[rows].float(), ref, prec=2e-2)
+
+    def test_flash_mha_varlen_bf16(self):
+        self._test_flash_mha_varlen_bf16(num_kv_head=4)
+
+    def test_flash_mha_varlen_gqa_bf16(self):
+        # GQA and MQA
+        self._test_flash_mha_varlen_bf16(num_kv_head=2)
+        self._test_flash_mha_varlen_bf16(num_kv_head=1)
+
     def test_fake_sd_mha_bf16(self):
         mat1 = (torch.randn(1, 2, 64, 64) + 20).to(torch.bfloat16)
         mat2 = (torch.randn(1, 2, 64, 64) - 20).to(torch.bfloat16)
@@ -651,5 +758,163 @@ class TransFreeMHATester(TestCase):
             for i in range(7):
                 self.assertEqual(fake_mha_ref[i], fake_mha_jit[i], prec=1e-5)
 
+    def test_bert_flash_mha_int8(self):
+        # sequence lengths of a partial query block and of several key blocks
+        for seqlen, qkv_dtype, o_dtype in [
+                (50, torch.quint8, torch.qint8),
+                (200, torch.qint8, torch.quint8)]:
+            num_head, head_size = 4, 32
+            hidden = num_head * head_size
+            qkv = torch.randn(2, seqlen, 3 * hidden)
+            zp = 128 if qkv_dtype == torch.quint8 else 0
+            qkv_q = torch.quantize_per_tensor(qkv, 0.05, zp, qkv_dtype)
+            mask = torch.zeros(2, seqlen)
+            mask[:, ::7] = -10000
+            o_scale = 0.02
+            o_zp = 0 if o_dtype == torch.qint8 else 128
+            out = torch.ops.torch_ipex.bert_flash_mha_int8(
+                qkv_q, mask, num_head, head_size, math.sqrt(head_size), o_scale, o_zp, o_dtype)
+            self.assertEqual(out.dtype, o_dtype)
+            self.assertEqual(out.shape, (2, seqlen, num_head, head_size))
+
+            q, k, v = [t.reshape(2, seqlen, num_head, head_size).transpose(1, 2)
+                       for t in qkv_q.dequantize().split(hidden, -1)]
+            scores = torch.matmul(q, k.transpose(-1, -2)) / math.sqrt(head_size) + mask[:, None, None, :]
+            ref = torch.matmul(scores.softmax(-1), v).transpose(1, 2)
+            self.assertEqual(out.dequantize(), ref, prec=o_scale + 1e-2)
+
+class PagedAttentionTester(TestCase):
+    def _ref_decode(self, query, key_cache, value_cache, block_tables, context_lens, scale):
+        num_heads, block_size, num_kv_heads = query.size(1), key_cache.size(1), key_cache.size(2)
+        outs = []
+        for s in range(query.size(0)):
+            ctx_len = int(context_lens[s])
+            blocks = block_tables[s, :(ctx_len + block_size - 1) // block_size]
+            k = key_cache[blocks].reshape(-1, num_kv_heads, key_cache.size(3))[:ctx_len].float()
+            v = value_cache[blocks].reshape(-1, num_kv_heads, value_cache.size(3))[:ctx_len].float()
+            k = k.repeat_interleave(num_heads // num_kv_heads, dim=1)
+            v = v.repeat_interleave(num_heads // num_kv_heads, dim=1)
+            attn = torch.einsum("hd,thd->ht", query[s].float(), k) * scale
+            outs.append(torch.einsum("ht,thd->hd", attn.softmax(-1), v))
+        return torch.stack(outs).to(query.dtype)
+
+    def _test_decode(self, dtype, num_heads, num_kv_heads, head_size=64, block_size=16):
+        # context lengths cross the 512 tokens partitions and a partial block
+        context_lens = torch.tensor([1, 37, 600, 1100], dtype=torch.int32)
+        num_seqs = context_lens.numel()
+        max_blocks = (int(context_lens.max()) + block_size - 1) // block_size
+        num_blocks = num_seqs * max_blocks + 3
+        key_cache = torch.randn(num_blocks, block_size, num_kv_heads, head_size).to(dtype)
+        value_cache = torch.randn(num_blocks, block_size, num_kv_heads, head_size).to(dtype)
+        # sequences share one block pool in shuffled order
+        block_tables = torch.randperm(num_blocks)[:num_seqs * max_blocks].view(num_seqs, max_blocks).to(torch.int32)
+        query = torch.randn(num_seqs, num_heads, head_size).to(dtype)
+        scale = 1.0 / math.sqrt(head_size)
+        out = torch.ops.torch_ipex.paged_attention_decode(
+            query, key_cache, value_cache, block_tables, context_lens, scale)
+        ref = self._ref_decode(query, key_cache, value_cache, block_tables, context_lens, scale)
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out, ref, prec=2e-2 if dtype == torch.bfloat16 else 1e-5)
+
+    def test_paged_attention_decode(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            self._test_decode(dtype, num_heads=8, num_kv_heads=8)
+            # GQA and MQA
+            self._test_decode(dtype, num_heads=8, num_kv_heads=2)
+            self._test_decode(dtype, num_heads=8, num_kv_heads=1)
+
+    def test_paged_attention_update_cache(self):
+        block_size, num_kv_heads, head_size = 4, 2, 32
+        key_cache = torch.zeros(6, block_size, num_kv_heads, head_size)
+        value_cache = torch.zeros(6, block_size, num_kv_heads, head_size)
+        key = torch.randn(3, num_kv_heads, head_size)
+        value = torch.randn(3, num_kv_heads, head_size)
+        slot_mapping = torch.tensor([9, -1, 22])
+        torch.ops.torch_ipex.paged_attention_update_cache(key, value, key_cache, value_cache, slot_mapping)
+        flat_k = key_cache.view(-1, num_kv_heads, head_size)
+        flat_v = value_cache.view(-1, num_kv_heads, head_size)
+        self.assertEqual(flat_k[9], key[0])
+        self.assertEqual(flat_v[22], value[2])
+        self.assertEqual(flat_k.abs().sum(dim=(1, 2)).nonzero().view(-1), torch.tensor([9, 22]))
+
+    def _test_beam_kv_cache(self, dtype, num_heads, num_kv_heads, head_size=64):
+        num_seqs, prompt_len, steps = 6, 5, 4
+        scale = 1.0 / math.sqrt(head_size)
+        cache = ipex.nn.modules.BeamKVCache(num_seqs, prompt_len + steps, num_kv_heads, head_size, dtype=dtype)
+        # the reference cache is reordered by index_select of the beams
+        ref_k = torch.randn(num_seqs, prompt_len, num_kv_heads, head_size).to(dtype)
+        ref_v = torch.randn(num_seqs, prompt_len, num_kv_heads, head_size).to(dtype)
+        cache.append(ref_k, ref_v)
+        for step in range(steps):
+            beam_idx = torch.randint(0, num_seqs, (num_seqs,))
+            cache.reorder(beam_idx)
+            ref_k, ref_v = ref_k.index_select(0, beam_idx), ref_v.index_select(0, beam_idx)
+            k = torch.randn(num_seqs, 1, num_kv_heads, head_size).to(dtype)
+            v = torch.randn(num_seqs, 1, num_kv_heads, head_size).to(dtype)
+            cache.append(k, v)
+            ref_k, ref_v = torch.cat([ref_k, k], dim=1), torch.cat([ref_v, v], dim=1)
+            query = torch.randn(num_seqs, num_heads, head_size).to(dtype)
+            out = cache.attention(query, scale)
+            # a block per token of the reference cache
+            seq_len = ref_k.size(1)
+            block_tables = torch.arange(num_seqs * seq_len).view(num_seqs, seq_len)
+            context_lens = torch.full((num_seqs,), seq_len)
+            ref = self._ref_decode(
+                query, ref_k.reshape(-1, 1, num_kv_heads, head_size), ref_v.reshape(-1, 1, num_kv_heads, head_size),
+                block_tables, context_lens, scale)
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out, ref, prec=2e-2 if dtype == torch.bfloat16 else 1e-5)
+
+    def test_beam_kv_cache(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            self._test_beam_kv_cache(dtype, num_heads=8, num_kv_heads=8)
+            self._test_beam_kv_cache(dtype, num_heads=8, num_kv_heads=2)
+
+class FlashAttentionTester(TestCase):
+    def _test_flash_attention(self, dtype, q_len, kv_len, is_causal):
+        batch, heads, head_size = 2, 3, 64
+        scale = 1.0 / math.sqrt(head_size)
+        query = torch.randn(batch, heads, q_len, head_size).to(dtype).requires_grad_()
+        key = torch.randn(batch, heads, kv_len, head_size).to(dtype).requires_grad_()
+        value = torch.randn(batch, heads, kv_len, head_size).to(dtype).requires_grad_()
+        q_ref, k_ref, v_ref = [t.detach().float().requires_grad_() for t in (query, key, value)]
+        attn = torch.matmul(q_ref, k_ref.transpose(-1, -2)) * scale
+        if is_causal:
+            # the query rows are aligned to the last key rows
+            mask = torch.ones(q_len, kv_len, dtype=torch.bool).triu(kv_len - q_len + 1)
+            attn = attn.masked_fill(mask, float("-inf"))
+        ref = torch.matmul(attn.softmax(-1), v_ref)
+        out = torch.ops.torch_ipex.flash_attention(query, key, value, scale, is_causal)
+        grad = torch.randn_like(ref)
+        ref.backward(grad)
+        out.backward(grad.to(dtype))
+        prec = 3e-2 if dtype == torch.bfloat16 else 1e-4
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out.float(), ref, prec=prec)
+        self.assertEqual(query.grad.float(), q_ref.grad, prec=prec)
+        self.assertEqual(key.grad.float(), k_ref.grad, prec=prec)
+        self.assertEqual(value.grad.float(), v_ref.grad, prec=prec)
+
+    def test_flash_attention_fp32(self):
+        # lengths not multiple of the 64 x 128 tiles
+        for q_len, kv_len in [(100, 100), (70, 300)]:
+            for is_causal in [False, True]:
+                self._test_flash_attention(torch.float, q_len, kv_len, is_causal)
+
+    def test_flash_attention_bf16(self):
+        for is_causal in [False, True]:
+            self._test_flash_attention(torch.bfloat16, 130, 130, is_causal)
+
+    def test_flash_attention_no_grad(self):
+        query = torch.randn(1, 2, 16, 32)
+        key = torch.randn(1, 2, 16, 32)
+        value = torch.randn(1, 2, 16, 32)
+        with torch.no_grad():
+            out = torch.ops.torch_ipex.flash_attention(query, key, value, 0.5, True)
+        mask = torch.ones(16, 16, dtype=torch.bool).triu(1)
+        attn = (torch.matmul(query, key.transpose(-1, -2)) * 0.5).masked_fill(mask, float("-inf"))
+        ref = torch.matmul(attn.softmax(-1), value)
+        self.assertEqual(out, ref, prec=1e-5)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -0,0 +1,48 @@
+import unittest
+import torch
+import intel_extension_for_pytorch as ipex  # noqa F401
+from common_utils import TestCase
+
+def moe_linear_ref(x, topk_ids, topk_weights, weight, bias):
+    out = torch.zeros(x.shape[:-1] + (weight.size(1),))
+    x = x.reshape(-1, x.size(-1)).float()
+    out = out.view(-1, weight.size(1))
+    for t in range(x.size(0)):
+        for e, gate in zip(topk_ids[t].tolist(), topk_weights[t].tolist()):
+            y = torch.matmul(x[t], weight[e].float().t())
+            if bias is not None:
+                y = y + bias[e].float()
+            out[t] += gate * y
+    return out
+
+class MoETester(TestCase):
+    def test_moe_linear(self):
+        # unevenly loaded and unused experts, partial tiles of N and K
+        for T, E, topk, N, K, with_bias, dtype in [
+                (1, 4, 2, 64, 128, True, torch.float),
+                (37, 8, 2, 130, 96, True, torch.float),
+                (64, 6, 1, 48, 35, False, torch.float),
+                (40, 8, 2, 96, 64, True, torch.bfloat16)]:
+            x = torch.randn(T, K).to(dtype)
+            weight = torch.randn(E, N, K).to(dtype)
+            bias = torch.randn(E, N).to(dtype) if with_bias else None
+            logits = torch.randn(T, E)
+            # skew the routing towards the first experts
+            logits[:, :2] += 2
+            topk_weights, topk_ids = torch.softmax(logits, -1).topk(topk, -1)
+            y = torch.ops.torch_ipex.moe_linear(x, topk_ids, topk_weights, weight, bias)
+            self.assertEqual(y.dtype, dtype)
+            y_ref = moe_linear_ref(x, topk_ids, topk_weights, weight, bias)
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-4
+            self.assertEqual(y.float(), y_ref, rtol=prec, atol=prec)
+
+    def test_moe_linear_3d_input(self):
+        x = torch.randn(2, 5, 32)
+        weight = torch.randn(4, 16, 32)
+        topk_weights, topk_ids = torch.rand(10, 4).topk(2, -1)
+        y = torch.ops.torch_ipex.moe_linear(x, topk_ids.int(), topk_weights, weight, None)
+        self.assertEqual(y.shape, (2, 5, 16))
+        self.assertEqual(y, moe_linear_ref(x, topk_ids, topk_weights, weight, None), rtol=1e-4, atol=1e-4)
+
+if __name__ == '__main__':
+    test = unittest.main()
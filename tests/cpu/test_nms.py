@@ -12,6 +12,7 @@ def nms(dets, scores, threshold, sorted=False):
 batch_score_nms = torch.ops.torch_ipex.batch_score_nms
 parallel_scale_back_batch = torch.ops.torch_ipex.parallel_scale_back_batch
 rpn_nms = torch.ops.torch_ipex.rpn_nms
+detection_postprocess = torch.ops.torch_ipex.detection_postprocess
 box_head_nms = torch.ops.torch_ipex.box_head_nms
 
 def get_rand_seed():
@@ -186,6 +187,76 @@ class TestNMS(TestCase):
         self.assertEqual(output2_raw_double, output2_raw)
         self.assertTrue(output2_raw_double[0].dtype == torch.float64)
 
+    def test_batch_nms_large_class(self):
+        # classes of more candidates than nms_bitmask_large_class are
+        # suppressed after the others, splitting the bitmask across threads
+        torch.manual_seed(get_rand_seed() % (2 ** 32))
+        batch_size = 2
+        number_boxes = 1500
+        criteria = 0.5
+        max_output = 1200
+        xy = torch.rand(batch_size, number_boxes, 2)
+        wh = torch.rand(batch_size, number_boxes, 2) * 0.2
+        bboxes = torch.cat([xy, xy + wh], dim=-1)
+        probs = torch.rand(batch_size, number_boxes, 3) * 0.9 + 0.1
+        for dtype in (torch.float32, torch.float64):
+            output = batch_score_nms(bboxes.to(dtype), probs.to(dtype), criteria, max_output)
+            idx = 0
+            for bs in range(batch_size):
+                expected_scores = []
+                for label in range(1, probs.size(2)):
+                    score, order = probs[bs, :, label].to(dtype).topk(max_output)
+                    dets = bboxes[bs].to(dtype)[order]
+                    iou = calc_iou_tensor(dets, dets)
+                    removed = torch.zeros(dets.size(0), dtype=torch.bool)
+                    keep = []
+                    for i in range(dets.size(0)):
+                        if not removed[i]:
+                            keep.append(i)
+                            removed |= iou[i] >= criteria
+                    expected_scores.append(score[keep])
+                expected_scores = torch.cat(expected_scores).sort()[0][-max_output:]
+                length = output[3][bs]
+                self.assertEqual(output[2][idx:idx + length], expected_scores)
+                idx += length
+
+    def test_detection_postprocess(self):
+        scale_xy = 0.1
+        scale_wh = 0.2
+        criteria = 0.50
+        max_output = 200
+        predicted_loc = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_ploc.pt")) # sizes: [1, 15130, 4]
+        predicted_score = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_plabel.pt")) # sizes: [1, 15130, 81]
+        dboxes_xywh = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_dboxes_xywh.pt"))
+        bboxes, probs = parallel_scale_back_batch(predicted_loc, predicted_score, dboxes_xywh, scale_xy, scale_wh)
+        expected = batch_score_nms(bboxes, probs, criteria, max_output)
+        output = detection_postprocess(predicted_loc, predicted_score, dboxes_xywh, scale_xy, scale_wh,
+                                       0.05, criteria, max_output, max_output, False, 0)
+        self.assertEqual(output[3], expected[3])
+        self.assertTrue(torch.allclose(output[0], expected[0], rtol=1e-4, atol=1e-4))
+        self.assertEqual(output[1], expected[1])
+        self.assertTrue(torch.allclose(output[2], expected[2], rtol=1e-4, atol=1e-4))
+
+        # sigmoid scores without background, as in RetinaNet
+        output = detection_postprocess(predicted_loc, predicted_score, dboxes_xywh, scale_xy, scale_wh,
+                                       0.3, criteria, 100, max_output, True, -1)
+        sigmoid_probs = torch.cat([torch.zeros_like(probs[:, :, :1]), predicted_score.sigmoid()], dim=-1)
+        for label in range(predicted_score.size(2)):
+            score = sigmoid_probs[0, :, label + 1]
+            mask = score > 0.3
+            if mask.sum() > 100:
+                mask &= score >= score.topk(100)[0][-1]
+            sigmoid_probs[0, ~mask, label + 1] = 0
+        expected = batch_score_nms(bboxes, sigmoid_probs, criteria, max_output)
+        self.assertEqual(output[3], expected[3])
+        self.assertEqual(output[1], expected[1] - 1)
+        self.assertTrue(torch.allclose(output[2], expected[2], rtol=1e-4, atol=1e-4))
+
+        with torch.cpu.amp.autocast():
+            output = detection_postprocess(predicted_loc.bfloat16(), predicted_score.bfloat16(), dboxes_xywh,
+                                           scale_xy, scale_wh, 0.05, criteria, max_output, max_output, False, 0)
+            self.assertTrue(output[0].dtype == torch.float32)
+
     def test_jit_trace_batch_nms(self):
         class Batch_NMS(nn.Module):
             def __init__(self, criteria, max_output):
@@ -91,6 +91,15 @@ class TestOptimizers(TestCase):
                 weight_decay=weight_decay, fused=fused)
             self._test_update(M, lamb, dtype, split_master_weight_for_bf16, set_to_none, fused)
 
+    def test_lars(self):
+        M = TestModule()
+        options = itertools.product([True, False], [True, False], [torch.float, torch.bfloat16], [0, 0.9], [0, 0.1], [True, False], [True, False])
+        for set_to_none, split_master_weight_for_bf16, dtype, momentum, weight_decay, adaptation, fused in options:
+            lars = ipex.optim._lars.Lars(
+                M.parameters(), lr=0.1, momentum=momentum, weight_decay=weight_decay,
+                adaptation=adaptation, fused=fused)
+            self._test_update(M, lars, dtype, split_master_weight_for_bf16, set_to_none, fused)
+
     def test_adam(self):
         M = TestModule()
         options = itertools.product([True, False], [True, False], [True, False], [torch.float, torch.bfloat16], [(0.1, 0.111), (0.9, 0.999)], [1e-8], [0, 0.1], [True, False], [True, False], [True, False])
@@ -195,6 +204,121 @@ class TestFusedSteps(TestCase):
         self.assertEqual(exp_avg, exp_avg2)
         self.assertEqual(exp_avg_sq, exp_avg_sq2)
 
+    def test_lars_step(self):
+        fused = torch.ops.torch_ipex.lars_fused_step
+        non_fused = ipex.optim._functional._lars_impl
+        momentum, learning_rate, weight_decay, trust_coefficient, eps = 0.9, 0.1, 0.01, 0.001, 1e-8
+
+        for adaptation in [True, False]:
+            # a partial last block
+            param = torch.randn(37, 65)
+            grad = torch.randn(37, 65)
+            buf = torch.randn(37, 65)
+            trail = torch.Tensor()
+
+            # fused bf16 params (master weight split)
+            param2, trail2 = torch.ops.torch_ipex.split_float_bfloat16(param)
+            grad2 = grad.bfloat16()
+            buf2 = buf.clone()
+
+            # fused bf16 params (master weight)
+            param3 = param.clone()
+            grad3 = grad.bfloat16()
+            buf3 = buf.clone()
+            bf16_param = param3.bfloat16()
+
+            # non-fused fp32 params
+            param4 = param.clone()
+            buf4 = buf.clone()
+
+            # fused and non-contiguous fp32 args
+            param5 = param.clone().t().contiguous().t()
+            grad5 = grad.clone().t().contiguous().t()
+            buf5 = buf.clone().t().contiguous().t()
+
+            args = (momentum, learning_rate, weight_decay, trust_coefficient, eps, adaptation)
+            fused(param, buf, grad, trail, *args)
+            fused(param2, buf2, grad2, trail2, *args)
+            fused(param3, buf3, grad3, bf16_param, *args)
+            non_fused([param4], [grad.clone()], [buf4], *args)
+            fused(param5, buf5, grad5, trail, *args)
+
+            # compare fused and non-fused
+            self.assertEqual(param, param4)
+            self.assertEqual(buf, buf4)
+            # compare fused fp32 and fused bf16
+            self.assertEqual(param, torch.ops.torch_ipex.cat_bfloat16_float(param2, trail2), rtol=1e-4, atol=1e-2)
+            self.assertEqual(buf, buf2, rtol=1e-4, atol=1e-2)
+            # compare split vs non-split
+            self.assertEqual(param3, torch.ops.torch_ipex.cat_bfloat16_float(param2, trail2), rtol=1e-4, atol=1e-2)
+            # make sure bf16_param are updated
+            self.assertEqual(bf16_param, param3.bfloat16())
+            # compare fused contiguous and fused non-contiguous()
+            self.assertEqual(param, param5)
+            self.assertEqual(buf, buf5)
+
+    def test_adafactor_step(self):
+        fused = torch.ops.torch_ipex.adafactor_fused_step
+        non_fused = ipex.optim._functional._adafactor_impl
+        init_state = ipex.optim._functional._adafactor_init_state
+        eps1, eps2, clip_threshold, decay_rate, weight_decay = 1e-30, 1e-3, 1.0, -0.8, 0.01
+
+        # factored, batched and not factored params, with partial last blocks
+        options = itertools.product([(37, 65), (3, 17, 1100), (1500,)], [None, 0.9], [True, False])
+        for shape, beta1, scale_parameter in options:
+            param = torch.randn(shape)
+            param2, trail2 = torch.ops.torch_ipex.split_float_bfloat16(param)
+            param3 = param.clone()
+            states = [{} for _ in range(3)]
+            for state in states:
+                init_state(state, param, beta1)
+            for step in range(1, 4):
+                grad = torch.randn(shape)
+                lr = ipex.optim._functional._adafactor_step_size(None, step, True, False)
+                args = (lr, 0.0 if beta1 is None else beta1, 1.0 - step ** decay_rate, eps1, eps2,
+                        clip_threshold, weight_decay, scale_parameter)
+                for p, g, t, state in [(param, grad, torch.Tensor(), states[0]), (param2, grad.bfloat16(), trail2, states[1])]:
+                    fused(p, state['exp_avg'], state['exp_avg_sq_row'], state['exp_avg_sq_col'], state['exp_avg_sq'],
+                          g, t, *args)
+                non_fused(
+                    [param3], [grad], [states[2]['exp_avg']], [states[2]['exp_avg_sq_row']],
+                    [states[2]['exp_avg_sq_col']], [states[2]['exp_avg_sq']], [step], None, beta1, decay_rate,
+                    eps1, eps2, clip_threshold, weight_decay, scale_parameter, True, False)
+
+            # compare fused and non-fused
+            self.assertEqual(param, param3, rtol=1e-4, atol=1e-5)
+            for key in states[0]:
+                self.assertEqual(states[0][key], states[2][key], rtol=1e-4, atol=1e-5)
+            # compare fused fp32 and fused bf16
+            self.assertEqual(param, torch.ops.torch_ipex.cat_bfloat16_float(param2, trail2), rtol=1e-3, atol=1e-3)
+
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = torch.nn.Linear(64, 48)
+                self.input = (torch.randn(4, 64),)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        # the fused step of ipex.optimize against the optimizer
+        for dtype in [torch.float, torch.bfloat16]:
+            model = M().train()
+            optimizer = ipex.optim._adafactor.Adafactor(model.parameters(), beta1=0.9, weight_decay=0.01)
+            ipex_model, ipex_optimizer = ipex.optimize(
+                copy.deepcopy(model), dtype=dtype, optimizer=copy.deepcopy(optimizer), weights_prepack=False)
+            for _ in range(3):
+                optimizer.zero_grad()
+                model(*model.input).sum().backward()
+                optimizer.step()
+                with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16, dtype=dtype):
+                    y = ipex_model(*model.input).sum()
+                ipex_optimizer.zero_grad()
+                y.backward()
+                ipex_optimizer.step()
+            atol = 1e-5 if dtype == torch.float else 1e-2
+            self.assertEqual(model.linear.weight, ipex_model.linear.weight.float(), atol=atol, rtol=1e-2)
+
     def test_adam_step(self):
         fused = torch.ops.torch_ipex.adam_fused_step
         non_fused = bench.custom_op_bench.optimizer.non_fused_adam
@@ -456,6 +580,28 @@ class TestFusedSteps(TestCase):
         # compare fp32 vs bf16 fused
         self.assertEqual(param, param2.float(), rtol=1e-4, atol=1e-1)
 
+    def test_streaming_store_step(self):
+        # the fp32 steps with the streaming stores of every size, on params not
+        # aligned to a cache line, give the results of the regular stores
+        default_threshold = ipex._C.get_streaming_store_threshold()
+        try:
+            for threshold in [1, 0]:
+                ipex._C.set_streaming_store_threshold(threshold)
+                torch.manual_seed(0)
+                states = [torch.randn(100003 + 3).abs()[3:] for _ in range(5)]
+                param, grad, momentum_buf, exp_avg, exp_avg_sq = states
+                adam_param = param.clone()
+                torch.ops.torch_ipex.sgd_fused_step(
+                    param, grad, momentum_buf, torch.Tensor(), 0.5, 0.1, 0.3, 0.5, True)
+                torch.ops.torch_ipex.adam_fused_step(
+                    adam_param, exp_avg, exp_avg_sq, torch.Tensor(), grad, torch.Tensor(),
+                    False, 10, 0.8, 0.9, 0.1, 0.3, 0.001)
+                if threshold == 1:
+                    streamed = [param, momentum_buf, adam_param, exp_avg, exp_avg_sq]
+            self.assertEqual(streamed, [param, momentum_buf, adam_param, exp_avg, exp_avg_sq])
+        finally:
+            ipex._C.set_streaming_store_threshold(default_threshold)
+
     def test_packed_add(self):
         # contiguous case
         # fp32 args
@@ -488,6 +634,412 @@ class TestFusedSteps(TestCase):
         grad2 = base_grad.bfloat16()[10:20, 10:20]
         self._test_packed_add(param, grad, param2, trail, grad2)
 
+    def test_fused_step_foreach(self):
+        # many small params and one param of several chunks, split bf16 params
+        # and master weights, compared with the single tensor steps
+        sizes = [(7,), (31, 33), (1,), (5, 3, 2), (128, 1024)] * 3
+        lr, weight_decay, eps = 0.1, 0.3, 1e-8
+
+        def make(split):
+            params, params2, grads = [], [], []
+            torch.manual_seed(0)
+            for size in sizes:
+                param = torch.randn(size)
+                grad = torch.randn(size)
+                if split:
+                    param, trail = torch.ops.torch_ipex.split_float_bfloat16(param)
+                    grad = grad.bfloat16()
+                else:
+                    trail = torch.Tensor()
+                params.append(param)
+                params2.append(trail)
+                grads.append(grad)
+            return params, params2, grads
+
+        for split in [False, True]:
+            # adam
+            for amsgrad in [False, True]:
+                states = []
+                for _ in range(2):
+                    params, params2, grads = make(split)
+                    exp_avgs = [torch.rand(p.shape) for p in params]
+                    exp_avg_sqs = [torch.rand(p.shape) for p in params]
+                    max_exp_avg_sqs = [e.clone() if amsgrad else torch.Tensor() for e in exp_avg_sqs]
+                    states.append((params, params2, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs))
+                params, params2, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs = states[0]
+                for i in range(len(sizes)):
+                    torch.ops.torch_ipex.adam_fused_step(
+                        params[i], exp_avgs[i], exp_avg_sqs[i], max_exp_avg_sqs[i], grads[i], params2[i],
+                        amsgrad, i + 1, 0.9, 0.999, lr, weight_decay, eps)
+                params_, params2_, grads_, exp_avgs_, exp_avg_sqs_, max_exp_avg_sqs_ = states[1]
+                torch.ops.torch_ipex.adam_fused_step_foreach(
+                    params_, exp_avgs_, exp_avg_sqs_, max_exp_avg_sqs_, grads_, params2_,
+                    amsgrad, [i + 1.0 for i in range(len(sizes))], 0.9, 0.999, lr, weight_decay, eps)
+                self.assertEqual(params, params_)
+                self.assertEqual(params2, params2_)
+                self.assertEqual(exp_avgs, exp_avgs_)
+                self.assertEqual(exp_avg_sqs, exp_avg_sqs_)
+                self.assertEqual(max_exp_avg_sqs, max_exp_avg_sqs_)
+
+            # sgd, the momentum buffers of the first step are created
+            params, params2, grads = make(split)
+            params_, params2_, grads_ = make(split)
+            bufs = [None] * len(sizes)
+            for _ in range(2):
+                for i in range(len(sizes)):
+                    bufs[i] = torch.ops.torch_ipex.sgd_fused_step(
+                        params[i], grads[i], bufs[i], params2[i], 0.5, lr, weight_decay, 0.5, True)
+            bufs_ = [None] * len(sizes)
+            for _ in range(2):
+                bufs_ = torch.ops.torch_ipex.sgd_fused_step_foreach(
+                    params_, grads_, bufs_, params2_, 0.5, lr, weight_decay, 0.5, True)
+            self.assertEqual(params, params_)
+            self.assertEqual(params2, params2_)
+            self.assertEqual(bufs, list(bufs_))
+
+            # adagrad
+            params, params2, grads = make(split)
+            params_, params2_, grads_ = make(split)
+            state_sums = [torch.zeros(p.shape) for p in params]
+            state_sums_ = [torch.zeros(p.shape) for p in params]
+            for i in range(len(sizes)):
+                torch.ops.torch_ipex.adagrad_fused_step(
+                    params[i], grads[i], state_sums[i], params2[i], i + 1, lr, weight_decay, 0.1, eps)
+            torch.ops.torch_ipex.adagrad_fused_step_foreach(
+                params_, grads_, state_sums_, params2_, [i + 1.0 for i in range(len(sizes))],
+                lr, weight_decay, 0.1, eps)
+            self.assertEqual(params, params_)
+            self.assertEqual(params2, params2_)
+            self.assertEqual(state_sums, state_sums_)
+
+    def test_contiguous_param_arena(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.layers = torch.nn.Sequential(
+                    *[torch.nn.Sequential(torch.nn.Linear(16, 16), torch.nn.LayerNorm(16)) for _ in range(8)])
+                self.input = (torch.randn(4, 16),)
+
+            def forward(self, x):
+                return self.layers(x)
+
+        options = itertools.product([torch.float, torch.bfloat16], [True, False], ['sgd', 'adam', 'adagrad'])
+        for dtype, split_master_weight_for_bf16, opt in options:
+            model = M().train()
+            if opt == 'sgd':
+                optimizer = torch.optim.SGD(model.parameters(), lr=0.1, momentum=0.9, weight_decay=1e-4)
+            elif opt == 'adam':
+                optimizer = torch.optim.Adam(model.parameters(), lr=0.01, amsgrad=True)
+            else:
+                optimizer = torch.optim.Adagrad(model.parameters(), lr=0.1)
+            models, optimizers = [], []
+            for arena in [False, True]:
+                ipex_model, ipex_optimizer = ipex.optimize(
+                    copy.deepcopy(model), dtype=dtype, optimizer=copy.deepcopy(optimizer), weights_prepack=False,
+                    split_master_weight_for_bf16=split_master_weight_for_bf16, contiguous_param_arena=arena)
+                for _ in range(3):
+                    with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16, dtype=dtype):
+                        y = ipex_model(*model.input).sum()
+                    ipex_optimizer.zero_grad(set_to_none=True)
+                    y.backward()
+                    ipex_optimizer.step()
+                models.append(ipex_model)
+                optimizers.append(ipex_optimizer)
+            self.assertEqual(models[0].state_dict(), models[1].state_dict())
+            # all the params, grads and states are 64B aligned views of the arenas
+            arena = optimizers[1].param_arena
+            self.assertEqual(len(arena.params), len(list(model.parameters())))
+            self.assertTrue(arena.states_moved)
+            for tensors, kind in [(arena.params, 'param'), (arena.grads, 'grad')]:
+                # one buffer per dtype, the LayerNorm params are not casted
+                storages = [buf.untyped_storage().data_ptr() for buf in arena.buffers[kind]]
+                for t in tensors:
+                    self.assertIn(t.untyped_storage().data_ptr(), storages)
+                    self.assertEqual(t.data_ptr() % 64, 0)
+
+    def test_adam_8bit_step(self):
+        block_size = ipex.optim._functional.ADAM_8BIT_BLOCK_SIZE
+        lr, beta1, beta2, weight_decay, eps = 1e-3, 0.9, 0.999, 0.01, 1e-8
+        # a partial last block and params of a small range in a block
+        for numel, decoupled in itertools.product([1000, 3 * block_size], [False, True]):
+            param = torch.randn(numel)
+            param[:block_size // 2] *= 1e-3
+            param_ = param.clone()
+            exp_avg, exp_avg_sq = torch.zeros(numel), torch.zeros(numel)
+            num_blocks = (numel + block_size - 1) // block_size
+            exp_avg_q, exp_avg_sq_q = torch.zeros(numel, dtype=torch.int8), torch.zeros(numel, dtype=torch.uint8)
+            exp_avg_scale, exp_avg_sq_scale = torch.zeros(num_blocks), torch.zeros(num_blocks)
+            for step in range(1, 6):
+                grad = torch.randn(numel)
+                grad[:block_size // 2] *= 1e-3
+                if decoupled:
+                    param.mul_(1 - lr * weight_decay)
+                    torch.ops.torch_ipex.adam_fused_step(
+                        param, exp_avg, exp_avg_sq, torch.Tensor(), grad, torch.Tensor(),
+                        False, step, beta1, beta2, lr, 0., eps)
+                else:
+                    torch.ops.torch_ipex.adam_fused_step(
+                        param, exp_avg, exp_avg_sq, torch.Tensor(), grad, torch.Tensor(),
+                        False, step, beta1, beta2, lr, weight_decay, eps)
+                torch.ops.torch_ipex.adam_fused_step_8bit(
+                    param_, exp_avg_q, exp_avg_scale, exp_avg_sq_q, exp_avg_sq_scale, grad, torch.Tensor(),
+                    step, beta1, beta2, lr, weight_decay, eps, decoupled)
+            # the params moved by at most 5 * lr
+            self.assertEqual(param, param_, atol=5e-4, rtol=0)
+            # the scales are the block maxima of the moments
+            exp_avg_max = torch.stack([b.abs().max() for b in exp_avg.split(block_size)])
+            exp_avg_sq_max = torch.stack([b.max() for b in exp_avg_sq.split(block_size)])
+            self.assertEqual(exp_avg_scale, exp_avg_max, atol=0, rtol=0.1)
+            self.assertEqual(exp_avg_sq_scale, exp_avg_sq_max, atol=0, rtol=0.1)
+
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = torch.nn.Linear(64, 64)
+                self.input = (torch.randn(4, 64),)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        for opt, dtype in itertools.product([torch.optim.Adam, torch.optim.AdamW], [torch.float, torch.bfloat16]):
+            model = M().train()
+            optimizer = opt(model.parameters(), lr=1e-3)
+            models = []
+            for state_8bit in [False, True]:
+                ipex_model, ipex_optimizer = ipex.optimize(
+                    copy.deepcopy(model), dtype=dtype, optimizer=copy.deepcopy(optimizer),
+                    optimizer_state_8bit=state_8bit)
+                for _ in range(3):
+                    with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16, dtype=dtype):
+                        y = ipex_model(*model.input).sum()
+                    ipex_optimizer.zero_grad()
+                    y.backward()
+                    ipex_optimizer.step()
+                models.append(ipex_model)
+            for state in ipex_optimizer.state.values():
+                self.assertEqual(state['exp_avg'].dtype, torch.int8)
+                self.assertEqual(state['exp_avg_sq'].dtype, torch.uint8)
+            self.assertEqual(models[0].linear.weight, models[1].linear.weight, atol=2e-3, rtol=0)
+
+    def test_stochastic_rounding_step(self):
+        # updates far below half a bf16 ulp of the params are kept on average
+        param = torch.ones(8192, dtype=torch.bfloat16)
+        grad = torch.full_like(param, 1e-4)
+        torch.manual_seed(0)
+        for _ in range(100):
+            torch.ops.torch_ipex.sgd_fused_step(param, grad, None, torch.Tensor(), 0., 1., 0., 0., False)
+        self.assertEqual(param.float().mean().item(), 1 - 100 * grad[0].item(), atol=1e-3, rtol=0)
+        # the noise is drawn from the default CPU generator
+        params = []
+        for _ in range(2):
+            torch.manual_seed(0)
+            p = torch.ones(1000, dtype=torch.bfloat16)
+            torch.ops.torch_ipex.sgd_fused_step(p, grad[:1000], None, torch.Tensor(), 0., 1., 0., 0., False)
+            params.append(p)
+        self.assertEqual(params[0], params[1])
+
+        # a pure bf16 step rounds the fp32 step to one of its two bf16 neighbours
+        for shape in [(1000,), (31, 33)]:
+            param, grad = torch.randn(shape), torch.randn(shape)
+            exp_avg, exp_avg_sq = torch.randn(shape).abs(), torch.randn(shape).abs()
+            param_bf16, grad_bf16 = param.bfloat16(), grad.bfloat16()
+            param, grad = param_bf16.float(), grad_bf16.float()
+            steps = {
+                'sgd': lambda p, g, t: torch.ops.torch_ipex.sgd_fused_step(p, g, None, t, 0., 0.1, 0.01, 0., False),
+                'adagrad': lambda p, g, t: torch.ops.torch_ipex.adagrad_fused_step(
+                    p, g, exp_avg_sq.clone(), t, 1, 0.1, 0.01, 0., 1e-10),
+                'adam': lambda p, g, t: torch.ops.torch_ipex.adam_fused_step(
+                    p, exp_avg.clone(), exp_avg_sq.clone(), torch.Tensor(), g, t, False, 1, 0.9, 0.999, 0.1, 0.01,
+                    1e-8),
+                'lamb': lambda p, g, t: torch.ops.torch_ipex.lamb_fused_step(
+                    p, exp_avg.clone(), exp_avg_sq.clone(), g, t, 1, 0.9, 0.999, 0.1, 0.01, 1e-6),
+            }
+            for name, step in steps.items():
+                ref, p = param.clone(), param_bf16.clone()
+                step(ref, grad, torch.Tensor())
+                step(p, grad_bf16, torch.Tensor())
+                diff = (p.float() - ref).abs()
+                self.assertTrue((diff <= ref.abs() * 2 ** -7 + 1e-30).all(), name)
+
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = torch.nn.Linear(64, 64)
+                self.input = (torch.randn(4, 64),)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        for opt in [torch.optim.SGD, torch.optim.Adam]:
+            model = M().train()
+            optimizer = opt(model.parameters(), lr=1e-2)
+            ipex_model, ipex_optimizer = ipex.optimize(
+                model, dtype=torch.bfloat16, optimizer=optimizer, weights_prepack=False,
+                stochastic_rounding_for_bf16=True)
+            for p in ipex_optimizer.param_groups[0]['params']:
+                self.assertEqual(p.dtype, torch.bfloat16)
+                self.assertNotIn('trail', ipex_optimizer.params_attr.get(p, {}))
+            for _ in range(3):
+                with torch.cpu.amp.autocast():
+                    y = ipex_model(*model.input).sum()
+                ipex_optimizer.zero_grad()
+                y.backward()
+                ipex_optimizer.step()
+            # float params are saved for resuming
+            self.assertEqual(ipex_model.state_dict()['linear.weight'].dtype, torch.float)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_overlap_step_with_backward(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.layers = torch.nn.Sequential(
+                    torch.nn.Linear(64, 128), torch.nn.ReLU(), torch.nn.Linear(128, 128), torch.nn.ReLU(),
+                    torch.nn.Linear(128, 10))
+                self.input = (torch.randn(8, 64),)
+
+            def forward(self, x):
+                return self.layers(x)
+
+        cpu_pool = ipex.cpu.runtime.CPUPool([0])
+        optimizers = [
+            lambda params: torch.optim.SGD(params, lr=0.1, momentum=0.9, weight_decay=0.01),
+            lambda params: torch.optim.Adam(params, lr=0.01, weight_decay=0.01),
+            lambda params: ipex.optim._lamb.Lamb(params, lr=0.01, weight_decay=0.01),
+        ]
+        for make_optimizer, dtype in itertools.product(optimizers, [torch.float, torch.bfloat16]):
+            model = M().train()
+            results = []
+            for pool in [None, cpu_pool]:
+                m = copy.deepcopy(model)
+                ipex_model, ipex_optimizer = ipex.optimize(
+                    m, dtype=dtype, optimizer=make_optimizer(m.parameters()), fuse_update_step=True,
+                    optimizer_step_cpu_pool=pool)
+                for _ in range(3):
+                    ipex_optimizer.zero_grad()
+                    with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+                        y = ipex_model(*model.input).sum()
+                    y.backward()
+                    ipex_optimizer.step()
+                    if pool is not None:
+                        # the grads are freed by the overlapped steps
+                        for p in ipex_optimizer.param_groups[0]['params']:
+                            self.assertIsNone(p.grad)
+                results.append(ipex_model(*model.input))
+            self.assertEqual(results[0], results[1])
+
+    def test_grad_scaler_fused_step(self):
+        tensors = [torch.randn(100), torch.randn(70000).bfloat16(), torch.randn(3, 5).double()]
+        self.assertFalse(torch.ops.torch_ipex.non_finite_check_foreach(tensors))
+        for i, value in itertools.product(range(len(tensors)), [float('inf'), float('-inf'), float('nan')]):
+            t = [x.clone() for x in tensors]
+            t[i].view(-1)[-1] = value
+            self.assertTrue(torch.ops.torch_ipex.non_finite_check_foreach(t))
+
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = torch.nn.Linear(64, 64)
+                self.input = (torch.randn(4, 64),)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        optimizers = [
+            lambda params: torch.optim.SGD(params, lr=0.1, momentum=0.9, weight_decay=0.01),
+            lambda params: torch.optim.SGD(params, lr=0.1, momentum=0.9, foreach=True),
+            lambda params: torch.optim.Adam(params, lr=0.01, weight_decay=0.01),
+            lambda params: torch.optim.Adam(params, lr=0.01, foreach=True),
+            lambda params: ipex.optim._lamb.Lamb(params, lr=0.01, weight_decay=0.01),
+        ]
+        for make_optimizer, dtype in itertools.product(optimizers, [torch.float, torch.bfloat16]):
+            model = M().train()
+            models, optimizers = [], []
+            for _ in range(2):
+                m = copy.deepcopy(model)
+                ipex_model, ipex_optimizer = ipex.optimize(
+                    m, dtype=dtype, optimizer=make_optimizer(m.parameters()), weights_prepack=False)
+                models.append(ipex_model)
+                optimizers.append(ipex_optimizer)
+            self.assertTrue(optimizers[0]._step_supports_amp_scaling)
+            # the scale is a power of 2, so the steps on the scaled grads are the steps on the grads
+            scaler = torch.cpu.amp.GradScaler(init_scale=2. ** 10)
+            for _ in range(3):
+                for i, (ipex_model, ipex_optimizer) in enumerate(zip(models, optimizers)):
+                    ipex_optimizer.zero_grad()
+                    with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+                        y = ipex_model(*model.input).sum()
+                    if i == 0:
+                        scaler.scale(y).backward()
+                        scaler.step(ipex_optimizer)
+                        scaler.update()
+                    else:
+                        y.backward()
+                        ipex_optimizer.step()
+            self.assertEqual(models[0].linear.weight, models[1].linear.weight)
+            # the grads are unscaled by the steps, not in place, the fp32 Lamb step reusing them as its workspace
+            if not isinstance(optimizers[0], ipex.optim._lamb.Lamb) or dtype == torch.bfloat16:
+                self.assertEqual(models[0].linear.weight.grad, models[1].linear.weight.grad * 2 ** 10)
+
+            # an overflow skips the step and backs off the scale
+            weight = models[0].linear.weight.clone()
+            optimizers[0].zero_grad()
+            with torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+                y = models[0](*model.input).sum() * float('inf')
+            scaler.scale(y).backward()
+            scaler.step(optimizers[0])
+            scaler.update()
+            self.assertEqual(models[0].linear.weight, weight)
+            self.assertEqual(scaler.get_scale(), 2. ** 9)
+
+    def test_sharded_optimizer(self):
+        import torch.distributed as dist
+        import tempfile
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.layers = torch.nn.Sequential(
+                    torch.nn.Linear(64, 128), torch.nn.ReLU(), torch.nn.Linear(128, 10))
+                self.input = (torch.randn(8, 64),)
+
+            def forward(self, x):
+                return self.layers(x)
+
+        optimizers = [
+            lambda params: torch.optim.SGD(params, lr=0.1, momentum=0.9, weight_decay=0.01),
+            lambda params: torch.optim.Adagrad(params, lr=0.1, weight_decay=0.01),
+            lambda params: torch.optim.Adam(params, lr=0.01, weight_decay=0.01),
+        ]
+        with tempfile.NamedTemporaryFile() as f:
+            dist.init_process_group('gloo', init_method='file://' + f.name, rank=0, world_size=1)
+            try:
+                for make_optimizer, bucket_size in itertools.product(optimizers, [1000, 1 << 22]):
+                    model = M().train()
+                    ref_model = copy.deepcopy(model)
+                    ref_optimizer = make_optimizer(ref_model.parameters())
+                    sharded = ipex.optim.ShardedOptimizer(make_optimizer(model.parameters()), bucket_size=bucket_size)
+                    # small buckets cut the params in several buckets
+                    self.assertEqual(len(sharded.buckets) > 1, bucket_size == 1000)
+                    for _ in range(3):
+                        for m, opt in [(ref_model, ref_optimizer), (model, sharded)]:
+                            opt.zero_grad()
+                            m(*model.input).sum().backward()
+                            opt.step()
+                    for p, ref_p in zip(model.parameters(), ref_model.parameters()):
+                        self.assertEqual(p, ref_p, atol=1e-5, rtol=1.3e-6)
+
+                    # bf16 params are gathered from the fp32 master shards
+                    model = M().train().bfloat16()
+                    sharded = ipex.optim.ShardedOptimizer(make_optimizer(model.parameters()), bucket_size=bucket_size)
+                    for _ in range(2):
+                        sharded.zero_grad()
+                        model(model.input[0].bfloat16()).sum().backward()
+                        sharded.step()
+                    for b in sharded.buckets:
+                        self.assertEqual(b.params, b.master.bfloat16())
+            finally:
+                dist.destroy_process_group()
+
 class TestPatchedMethod(TestCase):
 
     def test_zero_grad(self):
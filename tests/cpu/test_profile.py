@@ -1,5 +1,6 @@
 import unittest
 from common_utils import TestCase
+import json
 import os
 import subprocess
 
@@ -15,6 +16,90 @@ class TestProfiler(TestCase):
                     num = num + 1
         assert num == 2 , 'IPEX op profiling info not found.'
 
+    def test_op_stats(self):
+        import torch
+        import intel_extension_for_pytorch as ipex
+        x = [torch.randn(32, 16) for _ in range(4)]
+        torch.ops.torch_ipex.interaction_forward(x)
+        with ipex.op_stats(sample_rate=4) as stats:
+            for _ in range(8):
+                torch.ops.torch_ipex.interaction_forward(x)
+        torch.ops.torch_ipex.interaction_forward(x)
+        op = [op for op in stats.report() if op['name'] == 'torch_ipex::interaction_forward']
+        self.assertEqual(len(op), 1)
+        self.assertEqual(op[0]['calls'], 8)
+        self.assertEqual(op[0]['samples'], 2)
+        self.assertTrue(op[0]['gflops'] > 0 and op[0]['gbps'] > 0)
+        self.assertTrue(op[0]['max_threads'] >= 1)
+        self.assertEqual(ipex._C._get_op_stats_sample_rate(), 0)
+
+    def test_parallel_stats(self):
+        import torch
+        import intel_extension_for_pytorch as ipex
+        x = torch.randn(4, 64, 32, 32)
+        gn = torch.nn.GroupNorm(8, 64)
+        with ipex.parallel_stats() as stats:
+            for _ in range(4):
+                gn(x)
+        gn(x)
+        op = [op for op in stats.report() if op['op'] == 'group_norm']
+        self.assertEqual(len(op), 1)
+        self.assertEqual(op[0]['cpu_pool'], 'default')
+        self.assertTrue(op[0]['regions'] >= 4)
+        self.assertTrue(1 <= op[0]['max_threads'] <= torch.get_num_threads())
+        self.assertTrue(op[0]['busy_ms'] > 0 and op[0]['barrier_wait_ms'] >= 0)
+        self.assertTrue(op[0]['worst_imbalance'] >= op[0]['imbalance'] >= 1)
+        self.assertFalse(ipex._C._is_parallel_stats_enabled())
+
+    def test_memory_profiler(self):
+        import torch
+        import intel_extension_for_pytorch as ipex
+        model = torch.nn.Sequential(torch.nn.Linear(256, 512)).eval()
+        with ipex.memory_profiler() as prof:
+            model = ipex.optimize(model)
+            x = torch.randn(8, 256)
+        report = prof.report()
+        # the linear weights are packed for MKL or oneDNN
+        tag = [tag for tag in report['tags'] if tag['tag'].startswith('weight_pack::linear')]
+        self.assertEqual(len(tag), 1)
+        self.assertTrue(tag[0]['peak_bytes'] >= 256 * 512 * 4)
+        self.assertTrue(tag[0]['allocations'] >= 1)
+        self.assertTrue(report['peak_bytes'] >= tag[0]['peak_bytes'])
+        self.assertTrue(report['peak_bytes'] >= report['current_bytes'])
+        self.assertFalse(ipex._C._is_memory_tracking_enabled())
+        # the freed tensors are no longer accounted
+        current = ipex.memory_profiler.report()['current_bytes']
+        del x
+        self.assertEqual(ipex.memory_profiler.report()['current_bytes'], current - 8 * 256 * 4)
+
+    def test_perf_baseline(self):
+        import tempfile
+        import torch
+        import intel_extension_for_pytorch as ipex
+        from intel_extension_for_pytorch.utils import perf_baseline
+        x = [torch.randn(128, 64) for _ in range(8)]
+        with ipex.op_stats() as stats:
+            for _ in range(4):
+                torch.ops.torch_ipex.interaction_forward(x)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'baseline.jsonl')
+            baseline = perf_baseline.record(path, stats.report(), name='interaction')
+            perf_baseline.record(path, [], name='other')
+            self.assertEqual(perf_baseline.load(path, 'interaction'), baseline)
+            self.assertEqual(baseline['host']['isa'], ipex._C._get_current_isa_level())
+            self.assertEqual(baseline['host']['fp32_math_mode'], 'FP32')
+            self.assertEqual(perf_baseline.compare(baseline, baseline)['regressions'], [])
+            # the same run twice slower
+            run = dict(baseline, ops={op: dict(v, avg_us=v['avg_us'] * 2 + 1) for op, v in baseline['ops'].items()})
+            result = perf_baseline.compare(baseline, run, threshold=0.5)
+            self.assertEqual([d['name'] for d in result['regressions']], ['torch_ipex::interaction_forward'])
+            self.assertEqual(result['host_changes'], {})
+            new_path = os.path.join(tmp, 'new.jsonl')
+            with open(new_path, 'w') as f:
+                json.dump(run, f)
+            self.assertEqual(perf_baseline.main([path, new_path, '--name', 'interaction', '--threshold', '0.5']), 1)
+            self.assertEqual(perf_baseline.main([path, path, '--name', 'interaction']), 0)
+
 
 if __name__ == '__main__':
     test = unittest.main()
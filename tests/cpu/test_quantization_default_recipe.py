@@ -252,6 +252,41 @@ class TestDefaultRecipe(JitLlgaTestCase):
         result_ref = traced_model(new_x)
         assert torch.allclose(result_sq, result_ref)
 
+    def test_smooth_quant_folding(self):
+        class Mod(nn.Module):
+            def __init__(self) -> None:
+                super().__init__()
+                self.norm = nn.LayerNorm(16)
+                self.dense = nn.Linear(16, 8)
+
+            def forward(self, x):
+                return self.dense(self.norm(x))
+
+        def count_mul(graph):
+            count = 0
+            for node in graph.nodes():
+                if node.kind() == "aten::mul":
+                    count += 1
+                if node.kind() == LLGA_FUSION_GROUP:
+                    count += count_mul(node.g('Subgraph'))
+            return count
+
+        x = torch.randn(4, 16) * torch.arange(1, 17)
+        m = Mod().eval()
+        qconfig_mapping = ipex.quantization.get_smooth_quant_qconfig_mapping(alpha=0.5)
+        prepared_model = ipex.quantization.prepare(m, qconfig_mapping, example_inputs=x, inplace=False)
+        prepared_model(x)
+        converted_model = ipex.quantization.convert(prepared_model)
+        with torch.no_grad():
+            ref = converted_model(x)
+            traced_model = torch.jit.trace(converted_model, x)
+            traced_model = torch.jit.freeze(traced_model)
+            for _ in range(3):
+                y = traced_model(x)
+        # the scales of the activation are folded into the LayerNorm
+        self.assertEqual(count_mul(traced_model.graph_for(x)), 0)
+        self.assertEqual(y, ref, prec=0.1)
+
     def test_smooth_quant_save_load_qconf_summary(self):
         class Mod(nn.Module):
             def __init__(self):
@@ -15,6 +15,15 @@ class RMSNorm(nn.Module):
         hidden_states = hidden_states * torch.rsqrt(variance + self.variance_epsilon)
         return self.weight * hidden_states
 
+class AddRMSNorm(nn.Module):
+    def __init__(self, hidden_size, eps=1e-6):
+        super().__init__()
+        self.norm = RMSNorm(hidden_size, eps)
+
+    def forward(self, hidden_states, residual):
+        residual = hidden_states + residual
+        return residual, self.norm(residual)
+
 class RMSNormTester(TestCase):
     def test_RMSNorm(self):
         for dim in [2,3,4,5]:
@@ -34,5 +43,70 @@ class RMSNormTester(TestCase):
                 self.assertEqual(y1_fp32, y2_fp32)
                 self.assertTrue(any(n.kind() == "ipex::RMSNorm" for n in rmsnorm_graph.nodes()))
 
+    def _ref_add_rmsnorm(self, x, residual, weight, eps):
+        res = x + residual
+        variance = res.float().pow(2).mean(-1, keepdim=True)
+        return res, (weight.float() * res.float() * torch.rsqrt(variance + eps))
+
+    def test_add_rmsnorm(self):
+        # 4096 is a multiple of the vector width and 100 has a tail
+        for hidden_size in [4096, 100]:
+            # the float16 weight takes the native fp16 kernel on AVX512_FP16
+            for dtype, weight_dtype in [(torch.float, torch.float), (torch.bfloat16, torch.float),
+                                        (torch.float16, torch.float), (torch.float16, torch.float16)]:
+                x = torch.randn(5, 3, hidden_size).to(dtype)
+                residual = torch.randn(5, 3, hidden_size).to(dtype)
+                weight = torch.randn(hidden_size).to(weight_dtype)
+                res, out = torch.ops.torch_ipex.add_rmsnorm(x, residual, weight, 1e-6)
+                ref_res, ref_out = self._ref_add_rmsnorm(x, residual, weight, 1e-6)
+                self.assertEqual(res, ref_res)
+                self.assertEqual(out.dtype, dtype)
+                self.assertEqual(out.float(), ref_out, prec=5e-2 if dtype != torch.float else 1e-5)
+
+    def test_add_rmsnorm_mixed_dtypes(self):
+        # fp32 and bf16 input and residual are added in fp32 without casts
+        for hidden_size in [4096, 100]:
+            for dtype, residual_dtype, weight_dtype in [
+                    (torch.bfloat16, torch.float, torch.float), (torch.float, torch.bfloat16, torch.float),
+                    (torch.bfloat16, torch.float, torch.bfloat16)]:
+                x = torch.randn(5, 3, hidden_size).to(dtype)
+                residual = torch.randn(5, 3, hidden_size).to(residual_dtype)
+                weight = torch.randn(hidden_size).to(weight_dtype)
+                res, out = torch.ops.torch_ipex.add_rmsnorm(x, residual, weight, 1e-6)
+                ref_res, ref_out = self._ref_add_rmsnorm(x, residual, weight, 1e-6)
+                self.assertEqual(res.dtype, torch.float)
+                self.assertEqual(res, ref_res)
+                self.assertEqual(out.dtype, torch.float)
+                self.assertEqual(out, ref_out, prec=1e-5)
+
+    def test_add_rmsnorm_quantize(self):
+        hidden_size = 100
+        x = torch.randn(7, hidden_size)
+        residual = torch.randn(7, hidden_size)
+        weight = torch.randn(hidden_size)
+        for dtype, zero_point in [(torch.quint8, 128), (torch.qint8, 0)]:
+            res, q = torch.ops.torch_ipex.add_rmsnorm_quantize(
+                x, residual, weight, 1e-6, 0.05, zero_point, dtype)
+            ref_res, ref_out = self._ref_add_rmsnorm(x, residual, weight, 1e-6)
+            ref_q = torch.quantize_per_tensor(ref_out, 0.05, zero_point, dtype)
+            self.assertEqual(res, ref_res)
+            self.assertEqual(q.dtype, dtype)
+            # allow 1 ulp of the quantized value for the rounding ties
+            self.assertTrue((q.int_repr().int() - ref_q.int_repr().int()).abs().max() <= 1)
+
+    def test_add_rmsnorm_fusion(self):
+        model = AddRMSNorm(64).eval()
+        x = torch.randn(2, 8, 64)
+        residual = torch.randn(2, 8, 64)
+        with torch.no_grad():
+            trace_model = torch.jit.freeze(torch.jit.trace(model, (x, residual)))
+            for _ in range(2):
+                res, out = trace_model(x, residual)
+            ref_res, ref_out = model(x, residual)
+            graph = trace_model.graph_for(x, residual)
+        self.assertEqual(res, ref_res)
+        self.assertEqual(out, ref_out)
+        self.assertTrue(any(n.kind() == "ipex::add_RMSNorm" for n in graph.nodes()))
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -171,5 +171,55 @@ class TestRNNTEmbedding(TestCase):
 
             self.assertEqual(y_embed_org, y_embed)
 
+class TestRNNTGreedyDecode(TestCase):
+    def _greedy_decode_org(self, x, out_lens, embedding, lstm, joint_enc, joint_pred, joint_fc, blank_id, max_symbols):
+        # the reference decodes each sample alone
+        labels = []
+        for b in range(x.size(1)):
+            hidden = None
+            label = None
+            sample_labels = []
+            for t in range(out_lens[b]):
+                f = joint_enc(x[t, b])
+                symbols_added = 0
+                while symbols_added < max_symbols:
+                    y = torch.zeros(1, 1, embedding.embedding_dim) if label is None else embedding(torch.tensor([[label]]))
+                    g, hidden_prime = lstm(y.transpose(0, 1), hidden)
+                    k = joint_fc(torch.relu(f + joint_pred(g[0, 0]))).argmax().item()
+                    if k == blank_id:
+                        break
+                    sample_labels.append(k)
+                    label = k
+                    hidden = hidden_prime
+                    symbols_added += 1
+            labels.append(sample_labels)
+        return labels
+
+    def test_rnnt_greedy_decode(self):
+        _SOS = -1
+        vocab_size = 29
+        blank_id = vocab_size - 1
+        pred_n_hidden = 32
+        embedding = torch.nn.Embedding(vocab_size - 1, pred_n_hidden)
+        lstm = torch.nn.LSTM(pred_n_hidden, pred_n_hidden, num_layers=2)
+        joint_enc = torch.nn.Linear(48, 24)
+        joint_pred = torch.nn.Linear(pred_n_hidden, 24)
+        joint_fc = torch.nn.Linear(24, vocab_size)
+        lstm_params = []
+        for layer in range(lstm.num_layers):
+            lstm_params += [getattr(lstm, name % layer) for name in ['weight_ih_l%d', 'weight_hh_l%d', 'bias_ih_l%d', 'bias_hh_l%d']]
+        for batch_size, max_symbols in product([1, 5], [1, 3]):
+            x = torch.randn(12, batch_size, 48)
+            out_lens = torch.tensor([12 - 2 * i for i in range(batch_size)], dtype=torch.int32)
+            with torch.no_grad():
+                labels_org = self._greedy_decode_org(
+                    x, out_lens, embedding, lstm, joint_enc, joint_pred, joint_fc, blank_id, max_symbols)
+                label_tensor, label_col = torch.ops.torch_ipex.rnnt_greedy_decode(
+                    x, out_lens, embedding.weight, lstm_params,
+                    joint_enc.weight, joint_enc.bias, joint_pred.weight, joint_pred.bias,
+                    joint_fc.weight, joint_fc.bias, blank_id, max_symbols, _SOS)
+            labels = [label_tensor[i, 1:label_col[i] + 1].tolist() for i in range(batch_size)]
+            self.assertEqual(labels, labels_org)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -220,6 +220,43 @@ class RoIAlignTester(TestCase):
             self.assertTrue(x4.grad.dtype == torch.bfloat16)
             self.assertTrue(torch.allclose(gt_x.grad.to(x4.dtype), x4.grad, rtol=1e-5, atol=1e-5))
 
+    def test_multi_level_roialign(self):
+        spatial_scales = [1 / 4, 1 / 8, 1 / 16, 1 / 32]
+        batch_size = 2
+        n_channels = 70
+        features = [torch.rand(batch_size, n_channels, 128 // 2 ** l, 96 // 2 ** l) for l in range(4)]
+        xy = torch.rand(40, 2) * 300
+        wh = torch.rand(40, 2) * 400 + 1
+        rois = torch.cat([torch.randint(0, batch_size, (40, 1)).float(), xy, xy + wh], dim=1)
+        pool_h, pool_w = 7, 7
+
+        # the FPN level assignment of torchvision's LevelMapper
+        area = (rois[:, 3] - rois[:, 1]) * (rois[:, 4] - rois[:, 2])
+        levels = torch.floor(4 + torch.log2(area.sqrt() / 224) + 1e-6).clamp(2, 5).long() - 2
+
+        def reference(features, rois):
+            out = torch.zeros(rois.size(0), n_channels, pool_h, pool_w, dtype=features[0].dtype)
+            for l, scale in enumerate(spatial_scales):
+                idx = torch.nonzero(levels == l).squeeze(1)
+                out[idx] = fn(features[l], rois[idx], pool_h, pool_w, spatial_scale=scale, sampling_ratio=2)
+            return out
+
+        for dtype, channels_last in itertools.product([torch.float32, torch.bfloat16], [False, True]):
+            memory_format = torch.channels_last if channels_last else torch.contiguous_format
+            x1 = [f.clone().to(dtype).to(memory_format=memory_format).requires_grad_() for f in features]
+            x2 = [f.clone().to(dtype).to(memory_format=memory_format).requires_grad_() for f in features]
+            rois_ = rois.to(dtype) if dtype == torch.float32 else rois
+            y1 = reference(x1, rois_)
+            y2 = ipex.nn.modules._roi_align.MultiLevelRoIAlign((pool_h, pool_w), spatial_scales, 2)(x2, rois_)
+            self.assertEqual(y1, y2)
+            if channels_last:
+                self.assertTrue(y2.is_contiguous(memory_format=torch.channels_last))
+            grad = torch.rand_like(y1)
+            y1.backward(grad)
+            y2.backward(grad)
+            for g1, g2 in zip(x1, x2):
+                self.assertEqual(g1.grad, g2.grad)
+
     @skipIfNoTorchVision
     def test_torchvision_roialign_torchcompile(self):
         pool_size = 5
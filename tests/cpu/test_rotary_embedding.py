@@ -0,0 +1,73 @@
+import unittest
+import torch
+from torch import nn
+import intel_extension_for_pytorch as ipex
+from common_utils import TestCase
+
+def rotate_half(x):
+    x1 = x[..., : x.shape[-1] // 2]
+    x2 = x[..., x.shape[-1] // 2 :]
+    return torch.cat((-x2, x1), dim=-1)
+
+def rotary_tables(positions, rotary_dim, base=10000):
+    inv_freq = 1.0 / (base ** (torch.arange(0, rotary_dim, 2).float() / rotary_dim))
+    freqs = torch.outer(positions.float(), inv_freq)
+    emb = torch.cat((freqs, freqs), dim=-1)
+    return emb.cos(), emb.sin()
+
+class RotaryEmbedding(nn.Module):
+    def forward(self, q, k, cos, sin):
+        q_embed = (q * cos) + (rotate_half(q) * sin)
+        k_embed = (k * cos) + (rotate_half(k) * sin)
+        return q_embed, k_embed
+
+class RotaryEmbeddingTester(TestCase):
+    def _test_qkv(self, dtype, num_heads, num_kv_heads, head_size, rotary_dim):
+        batch, seq = 2, 5
+        qkv = torch.randn(batch, seq, (num_heads + 2 * num_kv_heads) * head_size).to(dtype)
+        position_ids = torch.arange(seq).repeat(batch, 1) + torch.tensor([[0], [3000]])
+        cos, sin = rotary_tables(position_ids, rotary_dim)
+        cos, sin = cos.unsqueeze(2), sin.unsqueeze(2)
+        ref = qkv.float().view(batch, seq, -1, head_size).clone()
+        rot = ref[:, :, :num_heads + num_kv_heads, :rotary_dim]
+        ref[:, :, :num_heads + num_kv_heads, :rotary_dim] = rot * cos + rotate_half(rot) * sin
+        out = torch.ops.torch_ipex.rotary_embedding_qkv(
+            qkv, position_ids, num_heads, num_kv_heads, head_size, rotary_dim)
+        # in place
+        self.assertEqual(out.data_ptr(), qkv.data_ptr())
+        self.assertEqual(qkv.float(), ref.view_as(qkv), prec=3e-2 if dtype == torch.bfloat16 else 1e-4)
+
+    def test_rotary_embedding_qkv(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            self._test_qkv(dtype, num_heads=4, num_kv_heads=4, head_size=64, rotary_dim=64)
+            # GQA with partial rotary dims (rotary_dim / 2 has a tail)
+            self._test_qkv(dtype, num_heads=4, num_kv_heads=2, head_size=64, rotary_dim=40)
+
+    def test_apply_rotary_emb(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            x = torch.randn(2, 3, 7, 64).to(dtype)
+            cos, sin = rotary_tables(torch.arange(7), 64)
+            cos, sin = cos[None, None].to(dtype), sin[None, None].to(dtype)
+            out = torch.ops.torch_ipex.apply_rotary_emb(x, cos, sin)
+            ref = x.float() * cos.float() + rotate_half(x.float()) * sin.float()
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out.float(), ref, prec=3e-2 if dtype == torch.bfloat16 else 1e-5)
+
+    def test_rotary_emb_fusion(self):
+        model = RotaryEmbedding().eval()
+        q = torch.randn(2, 4, 7, 64)
+        k = torch.randn(2, 2, 7, 64)
+        cos, sin = rotary_tables(torch.arange(7), 64)
+        cos, sin = cos[None, None], sin[None, None]
+        with torch.no_grad():
+            trace_model = torch.jit.freeze(torch.jit.trace(model, (q, k, cos, sin)))
+            for _ in range(2):
+                q_embed, k_embed = trace_model(q, k, cos, sin)
+            ref_q, ref_k = model(q, k, cos, sin)
+            graph = trace_model.graph_for(q, k, cos, sin)
+        self.assertEqual(q_embed, ref_q)
+        self.assertEqual(k_embed, ref_k)
+        self.assertEqual(sum(n.kind() == "ipex::apply_rotary_emb" for n in graph.nodes()), 2)
+
+if __name__ == '__main__':
+    test = unittest.main()
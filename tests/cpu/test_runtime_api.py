@@ -80,6 +80,36 @@ class TestCPUPool(TestCase):
         cpu_pool = ipex.cpu.runtime.CPUPool(core_list)
         self.assertEqual(cpu_pool.cpu_pool.get_core_list(), core_list)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_cpupool_core_topology(self):
+        core_list = ipex.cpu.runtime.get_core_list_of_node_id(0)
+        topology = ipex._C.get_cores_topology(core_list)
+        physical_core_list = [core.core_id for core in topology if core.core_id == core.physical_core_id]
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_list, physical_cores_only=True)
+        self.assertEqual(cpu_pool.core_ids, physical_core_list)
+        performance_core_list = [core.core_id for core in topology if core.core_type == 1]
+        if performance_core_list:
+            cpu_pool = ipex.cpu.runtime.CPUPool(core_list, core_type="performance")
+            self.assertEqual(cpu_pool.core_ids, performance_core_list)
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_list, llc_id=topology[0].llc_id)
+        self.assertEqual(cpu_pool.core_ids, [core.core_id for core in topology if core.llc_id == topology[0].llc_id])
+        # One stream per physical core
+        self.assertEqual(ipex.cpu.runtime.get_default_num_streams(ipex.cpu.runtime.CPUPool(core_list)),
+                         set(core.physical_core_id for core in topology).__len__())
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_cpupool_numa_node_ids(self):
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0)
+        self.assertEqual(cpu_pool.node_ids, [0])
+        # The allocations bound to the nodes of the pool
+        x = torch.rand(1024, 1024)
+        with ipex.cpu.runtime.pin(cpu_pool):
+            y = x + 1
+            w = torch.empty(1024, 1024).copy_(x)
+        self.assertEqual(y, x + 1)
+        self.assertEqual(w, x)
+
 class TestCoreBinding(TestCase):
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     @runtime_thread_affinity_test_env
@@ -142,6 +172,21 @@ class TestRuntimeAPI(TestCase):
         y_runtime = y_runtime_future.get()
         self.assertEqual(y, y_runtime)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_task_async_api_imperative_model_full_queue(self):
+        # more tasks in flight than the 1024 slots of the task queue, the submits
+        # past a full queue wait for the worker, which needs the GIL to run them
+        model = torch.nn.Linear(16, 16).eval()
+        x = torch.rand(4, 16)
+        y = model(x)
+
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0)
+        task = ipex.cpu.runtime.Task(model, cpu_pool)
+        y_runtime_futures = [task(x) for _ in range(3 * 1024)]
+        for y_runtime_future in y_runtime_futures:
+            self.assertEqual(y, y_runtime_future.get())
+
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     @runtime_thread_affinity_test_env
     def test_task_sync_api_imperative_model(self):
@@ -180,6 +225,53 @@ class TestRuntimeAPI(TestCase):
         y_runtime = y_runtime_future.get()
         self.assertEqual(y, y_runtime)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_task_resize(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(64, 64, 3, 3)
+        traced_model = torch.jit.trace(model, x)
+        y = model(x)
+
+        core_list = ipex.cpu.runtime.get_core_list_of_node_id(0)
+        task = ipex.cpu.runtime.Task(traced_model, ipex.cpu.runtime.CPUPool(core_list[:1]))
+        futures = [task(x) for _ in range(4)]
+        # The queued calls finish on the previous core
+        task.resize(ipex.cpu.runtime.CPUPool(core_list))
+        futures += [task(x) for _ in range(4)]
+        for future in futures:
+            self.assertEqual(y, future.get())
+        self.assertEqual(task.cpu_pool.core_ids, core_list)
+        self.assertEqual(task.queue_depth(), 0)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_cpupool_controller(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(64, 64, 3, 3)
+        traced_model = torch.jit.trace(model, x)
+        y = model(x)
+
+        core_list = ipex.cpu.runtime.get_core_list_of_node_id(0)
+        if core_list.__len__() < 2:
+            self.skipTest("Need at least 2 cores")
+        busy_task = ipex.cpu.runtime.Task(traced_model, ipex.cpu.runtime.CPUPool(core_list[:1]))
+        idle_task = ipex.cpu.runtime.Task(traced_model, ipex.cpu.runtime.CPUPool(core_list[1:]))
+        controller = ipex.cpu.runtime.CPUPoolController([busy_task, idle_task], core_list)
+        futures = [busy_task(x) for _ in range(16)]
+        core_lists = controller.rebalance()
+        # All the cores are shared and each Task keeps at least one
+        self.assertEqual(core_lists[0] + core_lists[1], core_list)
+        self.assertGreaterEqual(core_lists[1].__len__(), 1)
+        for future in futures:
+            self.assertEqual(y, future.get())
+        # The idle Tasks get an even share back
+        core_lists = controller.rebalance()
+        self.assertLessEqual(abs(core_lists[0].__len__() - core_lists[1].__len__()), 1)
+        self.assertEqual(y, idle_task.run_sync(x))
+
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     @runtime_thread_affinity_test_env
     def test_task_copy(self):
@@ -204,6 +296,47 @@ class TestRuntimeAPI(TestCase):
         self.assertEqual(y, y_runtime)
         self.assertEqual(y, y_runtime2)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_batched_task(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(64, 64, 3, 3)
+        traced_model = torch.jit.trace(model, x)
+        # requests of different batch sizes
+        inputs = [torch.rand(bs, 64, 3, 3) for bs in [1, 3, 2, 8, 1, 5]]
+        y = [model(input) for input in inputs]
+
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0)
+        for max_batch, max_delay_us in [(1, 0), (4, 100000), (64, 100000)]:
+            task = ipex.cpu.runtime.BatchedTask(traced_model, cpu_pool, max_batch, max_delay_us)
+            futures = [task(input) for input in inputs]
+            for y_ref, future in zip(y, futures):
+                self.assertEqual(y_ref, future.get())
+            self.assertEqual(y[0], task.run_sync(inputs[0]))
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_pipeline_task(self):
+        model = SimpleNet_v2()
+        model.eval()
+        x = torch.rand(10, 3, 16, 16)
+        y = model(x)
+        # Split the model into 2 stages
+        stage1 = torch.jit.trace(model.conv, x)
+        stage2 = torch.jit.trace(nn.Sequential(model.conv2, nn.Flatten()), stage1(x))
+
+        core_list = ipex.cpu.runtime.get_core_list_of_node_id(0)
+        num_stage1_cores = max(core_list.__len__() // 2, 1)
+        cpu_pools = [ipex.cpu.runtime.CPUPool(core_list[:num_stage1_cores]),
+                     ipex.cpu.runtime.CPUPool(core_list[num_stage1_cores:] or core_list)]
+        for micro_batch_size, max_in_flight in [(1, 1), (3, 2), (16, 4)]:
+            task = ipex.cpu.runtime.PipelineTask([stage1, stage2], cpu_pools, micro_batch_size, max_in_flight)
+            futures = [task(x) for _ in range(3)]
+            for future in futures:
+                self.assertEqual(y, future.get())
+            self.assertEqual(y, task.run_sync(x))
+
 class TestMultiStreamModule(TestCase):
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     @runtime_thread_affinity_test_env
@@ -223,6 +356,37 @@ class TestMultiStreamModule(TestCase):
         y_runtime = multi_stream_model(x)
         self.assertEqual(y, y_runtime)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_multi_stream_module_work_stealing(self):
+        model = SimpleNet()
+        model.eval()
+        batch_size = ipex.cpu.runtime.get_core_list_of_node_id(0).__len__() * 2 + 1
+        x = torch.rand(batch_size, 64, 3, 3)
+        traced_model = torch.jit.trace(model, x)
+
+        # Calculate the reference result
+        y = model(x)
+
+        # Create MultiStreamModule taking micro-batches from a shared queue
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0)
+        for micro_batch_size in [1, 3, batch_size + 1]:
+            multi_stream_model = ipex.cpu.runtime.MultiStreamModule(traced_model,
+                                                                    num_streams=2,
+                                                                    cpu_pool=cpu_pool,
+                                                                    micro_batch_size=micro_batch_size)
+            y_runtime = multi_stream_model(x)
+            self.assertEqual(y, y_runtime)
+
+            multi_stream_model = ipex.cpu.runtime.MultiStreamModule(traced_model,
+                                                                    num_streams=2,
+                                                                    cpu_pool=cpu_pool,
+                                                                    concat_output=False,
+                                                                    micro_batch_size=micro_batch_size)
+            y_runtime = multi_stream_model(x)
+            self.assertEqual(len(y_runtime), -(-batch_size // micro_batch_size))
+            self.assertEqual(y, torch.cat(y_runtime))
+
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     @runtime_thread_affinity_test_env
     def test_multi_stream_module_with_dict_return_type(self):
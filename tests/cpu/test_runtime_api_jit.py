@@ -467,6 +467,26 @@ class TestLLGARuntimeAPI(JitLlgaTestCase):
             self.assertEqual(y, torch.cat(y_runtime2))
             self.assertEqual(y_runtime2.__len__(), batch_size)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @runtime_thread_affinity_test_env
+    def test_concurrent_streams_int8_jit_model(self):
+        with torch.no_grad():
+            model = SimpleNet_v2()
+            model.eval()
+            num_streams = 2
+            x = torch.rand(num_streams, 3, 16, 16).contiguous(memory_format=torch.channels_last)
+
+            # Calculate the reference result
+            graph, m_llga, m_cpu = self.prepareModel(model, [x])
+            y = m_llga(x)
+
+            # The streams run their partitions concurrently, each on its own
+            # oneDNN stream and cores
+            cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+            multi_stream_model = ipex.cpu.runtime.MultiStreamModule(m_llga, num_streams=num_streams, cpu_pool=cpu_pool)
+            for _ in range(10):
+                self.assertEqual(y, multi_stream_model(x))
+
 class TestMultiStreamModuleHint(JitTestCase):
     def init_set_up(self):
         # Create Multi Stream Module without concat output
@@ -0,0 +1,59 @@
+import unittest
+import torch
+import intel_extension_for_pytorch as ipex  # noqa F401
+from common_utils import TestCase
+
+class SamplingHeadTester(TestCase):
+    def _inputs(self, dtype, batch=3, hidden_size=72, vocab=3001):
+        # a vocab of several tiles and a partial one, and a hidden size with a vector tail
+        hidden = torch.randn(batch, hidden_size).to(dtype)
+        weight = torch.randn(vocab, hidden_size).to(dtype)
+        bias = torch.randn(vocab)
+        logits = torch.nn.functional.linear(hidden.float(), weight.float(), bias)
+        return hidden, weight, bias, logits
+
+    def test_greedy(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            hidden, weight, bias, logits = self._inputs(dtype)
+            for top_k in [0, 1, 50]:
+                tokens = torch.ops.torch_ipex.sampling_head(hidden, weight, bias, 0.0, top_k, 1.0)
+                self.assertEqual(tokens, logits.argmax(-1))
+            # a top_p of 0 keeps the top token only
+            tokens = torch.ops.torch_ipex.sampling_head(hidden, weight, bias, 1.0, 40, 0.0)
+            self.assertEqual(tokens, logits.argmax(-1))
+
+    def test_top_k_top_p(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            hidden, weight, bias, logits = self._inputs(dtype)
+            top_k, top_p, temperature = 20, 0.8, 0.7
+            sorted_logits, sorted_indices = logits.topk(top_k, -1)
+            probs = (sorted_logits / temperature).softmax(-1)
+            kept = (probs.cumsum(-1) - probs) < top_p
+            for _ in range(20):
+                tokens = torch.ops.torch_ipex.sampling_head(hidden, weight, bias, temperature, top_k, top_p)
+                self.assertEqual(tokens.shape, torch.Size([hidden.size(0)]))
+                for r in range(hidden.size(0)):
+                    self.assertTrue(int(tokens[r]) in sorted_indices[r][kept[r]].tolist())
+            # the full vocab, by the aten ops
+            tokens = torch.ops.torch_ipex.sampling_head(hidden, weight, bias, 1.0, 0, 0.5)
+            sorted_logits, sorted_indices = logits.sort(-1, descending=True)
+            probs = sorted_logits.softmax(-1)
+            kept = (probs.cumsum(-1) - probs) < 0.5
+            for r in range(hidden.size(0)):
+                self.assertTrue(int(tokens[r]) in sorted_indices[r][kept[r]].tolist())
+
+    def test_distribution(self):
+        hidden, weight, bias, logits = self._inputs(torch.float, batch=1, vocab=600)
+        top_k = 4
+        sorted_logits, sorted_indices = logits.topk(top_k, -1)
+        probs = sorted_logits.softmax(-1)[0]
+        torch.manual_seed(0)
+        counts = torch.zeros(top_k)
+        num_samples = 4000
+        for _ in range(num_samples):
+            token = int(torch.ops.torch_ipex.sampling_head(hidden, weight, bias, 1.0, top_k, 1.0))
+            counts[sorted_indices[0].tolist().index(token)] += 1
+        self.assertEqual(counts / num_samples, probs, atol=0.03, rtol=0)
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -0,0 +1,81 @@
+import os
+import unittest
+
+import torch
+import torch.multiprocessing as mp
+import intel_extension_for_pytorch as ipex
+import intel_extension_for_pytorch._C as core
+from common_utils import TestCase
+
+WORLD_SIZE = 2
+# the sizes of a partial vector, and of several slices of the buffers of the ranks
+SIZES = [1, 31, 4096, 600000]
+
+def _rank_tensor(rank, numel, dtype):
+    return (torch.arange(numel, dtype=torch.float) % 17 + rank * 0.5).to(dtype)
+
+def _run_rank(rank, name, results):
+    core._shm_all_reduce_init(name, rank, WORLD_SIZE)
+    for dtype in (torch.float, torch.bfloat16):
+        for numel in SIZES:
+            x = _rank_tensor(rank, numel, dtype)
+            torch.ops.torch_ipex.shm_all_reduce_(x)
+            results[(rank, dtype, numel)] = x
+
+def _run_subgroup_rank(rank, world_size, init_file):
+    import torch.distributed as dist
+    dist.init_process_group('gloo', init_method='file://' + init_file, rank=rank, world_size=world_size)
+    try:
+        # the shared memory allreduce of node-local pairs, e.g. of tensor parallel groups
+        pairs = [dist.new_group([r, r + 1]) for r in range(0, world_size, 2)]
+        pair = pairs[rank // 2]
+        ipex.cpu.comm.init_shm_allreduce(pair)
+        assert ipex.cpu.comm.is_shm_allreduce_group(pair)
+        assert not ipex.cpu.comm.is_shm_allreduce_group()
+        x = torch.full((64,), float(rank + 1))
+        ipex.cpu.comm.all_reduce(x, group=pair)
+        torch.testing.assert_close(x, torch.full((64,), float(rank // 2 * 4 + 3)))
+        # the allreduces of the default group still sum over all the ranks
+        x = torch.full((64,), float(rank + 1))
+        ipex.cpu.comm.all_reduce(x)
+        torch.testing.assert_close(x, torch.full((64,), float(world_size * (world_size + 1) // 2)))
+        dist.barrier()
+    finally:
+        dist.destroy_process_group()
+
+class ShmAllReduceTester(TestCase):
+    def test_shm_all_reduce(self):
+        name = 'ipex_test_shm_allreduce_{}'.format(os.getpid())
+        core._shm_all_reduce_unlink(name)
+        ctx = mp.get_context('spawn')
+        manager = ctx.Manager()
+        results = manager.dict()
+        procs = [ctx.Process(target=_run_rank, args=(rank, name, results)) for rank in range(WORLD_SIZE)]
+        for p in procs:
+            p.start()
+        for p in procs:
+            p.join()
+        core._shm_all_reduce_unlink(name)
+        for p in procs:
+            self.assertEqual(p.exitcode, 0)
+        for dtype in (torch.float, torch.bfloat16):
+            for numel in SIZES:
+                ref = sum(_rank_tensor(rank, numel, dtype).float() for rank in range(WORLD_SIZE))
+                for rank in range(WORLD_SIZE):
+                    # the ranks sum in the same order and get the same bits
+                    self.assertEqual(results[(rank, dtype, numel)], results[(0, dtype, numel)], rtol=0, atol=0)
+                    self.assertEqual(results[(rank, dtype, numel)].float(), ref.to(dtype).float())
+
+    def test_all_reduce_other_group(self):
+        import tempfile
+        world_size = 4
+        with tempfile.NamedTemporaryFile() as f:
+            mp.spawn(_run_subgroup_rank, args=(world_size, f.name), nprocs=world_size, join=True)
+
+    def test_all_reduce_not_initialized(self):
+        if not ipex.cpu.comm.is_shm_allreduce_initialized():
+            with self.assertRaises(RuntimeError):
+                torch.ops.torch_ipex.shm_all_reduce_(torch.ones(4))
+
+if __name__ == '__main__':
+    test = unittest.main()
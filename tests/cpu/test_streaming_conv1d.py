@@ -0,0 +1,27 @@
+import unittest
+import itertools
+import torch
+import torch.nn.functional as F
+import intel_extension_for_pytorch as ipex
+from torch.testing._internal.common_utils import TestCase
+
+class TestStreamingConv1d(TestCase):
+
+    def test_streaming_conv1d(self):
+        for kernel_size, stride, dilation, groups, bias, batch in itertools.product(
+                [1, 3, 5], [1, 2], [1, 2], [1, 4], [True, False], [1, 3]):
+            conv = torch.nn.Conv1d(8, 12, kernel_size, stride=stride, dilation=dilation, groups=groups, bias=bias).eval()
+            streaming = ipex.nn.modules.StreamingConv1d(conv)
+            x = torch.randn(batch, 8, 23)
+            with torch.no_grad():
+                ref = F.conv1d(F.pad(x, ((kernel_size - 1) * dilation, 0)), conv.weight, conv.bias,
+                               stride=stride, dilation=dilation, groups=groups)
+            # the frames of the overlap are carried across the chunks of the stream
+            chunks = x.split([4, 1, 7, 11], dim=2)
+            out = torch.cat([streaming(chunk) for chunk in chunks], dim=2)
+            self.assertEqual(out, ref, rtol=1e-5, atol=1e-5)
+            streaming.reset_state()
+            self.assertEqual(streaming(x), ref, rtol=1e-5, atol=1e-5)
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -0,0 +1,46 @@
+import unittest
+import itertools
+import torch
+import intel_extension_for_pytorch as ipex
+from torch.testing._internal.common_utils import TestCase
+
+class TestStreamingLSTM(TestCase):
+
+    def test_streaming_lstm(self):
+        # hidden sizes below, at and above the packed block of 16 units
+        for hidden_size, batch, bias, batch_first in itertools.product(
+                [7, 16, 40], [1, 3, 5], [True, False], [True, False]):
+            lstm = torch.nn.LSTM(12, hidden_size, num_layers=2, bias=bias, batch_first=batch_first).eval()
+            streaming = ipex.nn.modules.StreamingLSTM(lstm)
+            x = torch.randn(batch, 9, 12) if batch_first else torch.randn(9, batch, 12)
+            with torch.no_grad():
+                ref, (hy, cy) = lstm(x)
+            # the states are carried across the chunks of the stream
+            chunks = x.split([4, 1, 4], dim=1 if batch_first else 0)
+            out = torch.cat([streaming(chunk) for chunk in chunks], dim=1 if batch_first else 0)
+            self.assertEqual(out, ref)
+            self.assertEqual(streaming.state[0], hy)
+            self.assertEqual(streaming.state[1], cy)
+            streaming.reset_state()
+            self.assertEqual(streaming(x), ref)
+
+    def test_streaming_lstm_bf16(self):
+        lstm = torch.nn.LSTM(16, 32).eval()
+        streaming = ipex.nn.modules.StreamingLSTM(lstm.to(torch.bfloat16))
+        x = torch.randn(6, 2, 16)
+        with torch.no_grad():
+            ref, _ = lstm.float()(x)
+        self.assertEqual(streaming(x.bfloat16()).float(), ref, rtol=2e-2, atol=2e-2)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_streaming_lstm_cpu_pool(self):
+        lstm = torch.nn.LSTM(8, 24).eval()
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0)
+        streaming = ipex.nn.modules.StreamingLSTM(lstm, cpu_pool=cpu_pool)
+        x = torch.randn(5, 2, 8)
+        with torch.no_grad():
+            ref, _ = lstm(x)
+        self.assertEqual(streaming(x), ref)
+
+if __name__ == '__main__':
+    test = unittest.main()
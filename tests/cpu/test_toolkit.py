@@ -17,3 +17,27 @@ class ToolkitTester(TestCase) :
         self.assertEqual(roc_auc_st, roc_auc_mt)
         self.assertEqual(roc_auc_st, roc_auc_mt_2)
         self.assertEqual(accuracy_st, accuracy_mt)
+
+    def test_streaming_roc_auc_score(self):
+        targets = np.random.randint(0, 2, size=10000)
+        # round to get ties within a chunk and across chunks, keep away from 0/1 for log loss
+        scores = torch.rand(10000).mul(98).round().add(1).div(100)
+        roc_auc_st = sklearn.metrics.roc_auc_score(targets, scores.numpy())
+        accuracy_st = sklearn.metrics.accuracy_score(y_true=targets, y_pred=np.round(scores.numpy()))
+        _, log_loss_all, _ = ipex._C.roc_auc_score_all(torch.Tensor(targets), scores)
+        exact = ipex._C.RocAucAccumulator()
+        # one bin for each distinct score, then binning is exact
+        binned = ipex._C.RocAucAccumulator(101)
+        coarse = ipex._C.RocAucAccumulator(8)
+        for chunk in range(0, 10000, 3000):
+            for acc in [exact, binned, coarse]:
+                acc.update(torch.Tensor(targets[chunk:chunk + 3000]), scores[chunk:chunk + 3000])
+        roc_auc, log_loss, accuracy = exact.compute()
+        self.assertEqual(roc_auc_st, roc_auc)
+        self.assertEqual(accuracy_st, accuracy)
+        self.assertEqual(log_loss_all, log_loss)
+        self.assertEqual(roc_auc_st, binned.compute()[0])
+        self.assertEqual(roc_auc_st, coarse.compute()[0], atol=0.05, rtol=0)
+        exact.reset()
+        exact.update(torch.Tensor(targets), scores)
+        self.assertEqual(roc_auc_st, exact.compute()[0])
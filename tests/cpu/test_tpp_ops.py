@@ -39,6 +39,87 @@ class Config():
         torch.manual_seed(seed)
         torch_ipex_cpp.xsmm_manual_seed(seed)
 
+class DecoderConfig():
+    def __init__(self):
+        self.hidden_size = 1024
+        self.intermediate_size = 2816
+        self.num_attention_heads = 16
+        self.num_hidden_layers = 1
+        self.rms_norm_eps = 1e-6
+        self.rope_theta = 10000.0
+
+class RefRMSNorm(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.weight = nn.Parameter(torch.ones(config.hidden_size))
+        self.eps = config.rms_norm_eps
+
+    def forward(self, x):
+        return x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + self.eps) * self.weight
+
+class RefDecoderMLP(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.gate_proj = nn.Linear(config.hidden_size, config.intermediate_size, bias=False)
+        self.up_proj = nn.Linear(config.hidden_size, config.intermediate_size, bias=False)
+        self.down_proj = nn.Linear(config.intermediate_size, config.hidden_size, bias=False)
+
+    def forward(self, x, residual):
+        return self.down_proj(F.silu(self.gate_proj(x)) * self.up_proj(x)) + residual
+
+class RefDecoderSelfAttention(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.N = config.num_attention_heads
+        self.H = config.hidden_size // self.N
+        self.q_proj = nn.Linear(config.hidden_size, config.hidden_size, bias=False)
+        self.k_proj = nn.Linear(config.hidden_size, config.hidden_size, bias=False)
+        self.v_proj = nn.Linear(config.hidden_size, config.hidden_size, bias=False)
+        self.o_proj = nn.Linear(config.hidden_size, config.hidden_size, bias=False)
+
+    def _rotate(self, x, cos, sin):
+        x1, x2 = x.chunk(2, dim=-1)
+        return x * cos + torch.cat([-x2, x1], dim=-1) * sin
+
+    def forward(self, x, residual, attention_mask, cos, sin):
+        B, S, _ = x.shape
+        q, k, v = [p(x).view(B, S, self.N, self.H).transpose(1, 2)
+                   for p in [self.q_proj, self.k_proj, self.v_proj]]
+        q = self._rotate(q, cos, sin)
+        k = self._rotate(k, cos, sin)
+        scores = torch.matmul(q, k.transpose(-1, -2)) / (self.H ** 0.5)
+        causal = torch.full([S, S], -10000.0).triu(1)
+        probs = torch.softmax(scores + attention_mask + causal, dim=-1)
+        ctx = torch.matmul(probs, v).transpose(1, 2).reshape(B, S, -1)
+        return self.o_proj(ctx) + residual
+
+class RefDecoderLayer(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.self_attn = RefDecoderSelfAttention(config)
+        self.mlp = RefDecoderMLP(config)
+        self.input_layernorm = RefRMSNorm(config)
+        self.post_attention_layernorm = RefRMSNorm(config)
+
+    def forward(self, x, attention_mask, cos, sin):
+        x = self.self_attn(self.input_layernorm(x), x, attention_mask, cos, sin)
+        return self.mlp(self.post_attention_layernorm(x), x)
+
+class RefDecoder(nn.Module):
+    def __init__(self, config):
+        super().__init__()
+        self.layers = nn.ModuleList([RefDecoderLayer(config) for _ in range(config.num_hidden_layers)])
+        self.norm = RefRMSNorm(config)
+        H = config.hidden_size // config.num_attention_heads
+        self.inv_freq = 1.0 / (config.rope_theta ** (torch.arange(0, H, 2).float() / H))
+
+    def forward(self, x, attention_mask):
+        freqs = torch.outer(torch.arange(x.shape[1]).float(), self.inv_freq)
+        emb = torch.cat([freqs, freqs], dim=-1)
+        for layer in self.layers:
+            x = layer(x, attention_mask, emb.cos(), emb.sin())
+        return self.norm(x)
+
 class TPPOPsTester(TestCase):
     def setUp(self):
         self.config = Config()
@@ -90,6 +171,36 @@ class TPPOPsTester(TestCase):
         tpp_res = tpp_embs(input_ids, token_type_ids).unblocked_tensor()
         self.assertEqual(hf_res,tpp_res)
 
+    def test_tpp_bert_embeddings_inference(self):
+        hf_embs = transformers.models.bert.modeling_bert.BertEmbeddings(self.config)
+        tpp_embs = ipex.tpp.fused_bert.BertEmbeddings(self.config)
+        tpp_embs.load_state_dict(hf_embs.state_dict())
+        hf_embs.eval()
+        tpp_embs.eval()
+        input_ids = torch.randint(100, 3000, (4,384)).to(torch.long)
+        token_type_ids = torch.randint(0, 2, (4,384)).to(torch.long)
+        with torch.no_grad():
+            hf_res = hf_embs(input_ids, token_type_ids)
+            tpp_res = tpp_embs(input_ids, token_type_ids).unblocked_tensor()
+        self.assertEqual(hf_res, tpp_res)
+        # the generic op, without the BERT modules, and its bf16 output
+        res = ipex.tpp.fused_bert.fused_embedding_layernorm(
+            input_ids, hf_embs.word_embeddings, hf_embs.LayerNorm,
+            self.config.hidden_size // self.config.num_attention_heads,
+            position_embeddings=hf_embs.position_embeddings,
+            token_type_ids=token_type_ids,
+            token_type_embeddings=hf_embs.token_type_embeddings)
+        self.assertEqual(hf_res, res)
+        res = ipex.tpp.fused_bert.fused_embedding_layernorm(
+            input_ids, hf_embs.word_embeddings, hf_embs.LayerNorm,
+            self.config.hidden_size // self.config.num_attention_heads,
+            position_embeddings=hf_embs.position_embeddings,
+            token_type_ids=token_type_ids,
+            token_type_embeddings=hf_embs.token_type_embeddings,
+            bf16_out=True)
+        self.assertEqual(res.dtype, torch.bfloat16)
+        self.assertEqual(hf_res, res.float(), prec=0.02)
+
     def test_tpp_bert_self_attention(self):
         ipex.tpp.fused_bert.unpad = False
         hf_self_att = transformers.models.bert.modeling_bert.BertSelfAttention(self.config)
@@ -131,5 +242,186 @@ class TPPOPsTester(TestCase):
         self.assertEqual(hf_res, tpp_res, prec=0.001)    
         self._test_backward(hf_res, tpp_res, hf_intermediate, tpp_intermediate, prec=0.01)
 
+    def test_tpp_timers(self):
+        from intel_extension_for_pytorch.tpp.utils import timing
+        tpp_intermediate = ipex.tpp.fused_bert.BertIntermediate(self.config)
+        hidden_states = torch.randn(self.batch * self.max_seq_len, self.config.hidden_size)
+        timing.reset_timers()
+        tpp_intermediate(hidden_states)
+        scope = [t for t in timing.get_timers() if t["name"] == "i_gemm"][0]
+        M = self.batch * self.max_seq_len
+        self.assertEqual(sum(scope["flops"]), 2 * M * self.config.hidden_size * self.config.intermediate_size)
+        self.assertTrue(sum(b["BRGEMM"] for b in scope["bytes"]) > 0)
+        rows = [r for r in timing.timer_table() if r["scope"] == "i_gemm" and r["timer"] == "BRGEMM"]
+        self.assertEqual(len(rows), 1)
+        self.assertTrue(rows[0]["imbalance"] >= 1.0)
+        timing.reset_timers()
+        scope = [t for t in timing.get_timers() if t["name"] == "i_gemm"][0]
+        self.assertEqual(sum(scope["flops"]), 0)
+
+    def test_tpp_bert_intermediate_fp8(self):
+        ipex.tpp.fused_bert.layer_use_bf16 = True
+        try:
+            tpp_intermediate = ipex.tpp.fused_bert.BertIntermediate(self.config)
+        finally:
+            ipex.tpp.fused_bert.layer_use_bf16 = False
+        hf_intermediate = transformers.models.bert.modeling_bert.BertIntermediate(self.config)
+        tpp_intermediate.load_state_dict(hf_intermediate.state_dict())
+        for dtype in ipex.tpp.fused_bert.FP8_DTYPES:
+            ipex.tpp.fused_bert.quantize_fp8_weights(tpp_intermediate, dtype)
+            # the reference holds the weights rounded by the per-tensor fp8 scale
+            ref_intermediate = copy.deepcopy(hf_intermediate)
+            weight = ref_intermediate.dense.weight.data.bfloat16().float()
+            scale = weight.abs().max() / torch.finfo(dtype).max
+            ref_intermediate.dense.weight.data = (weight / scale).to(dtype).float() * scale
+            hidden_states = torch.randn(self.batch, self.max_seq_len, self.config.hidden_size).bfloat16()
+            ref_res = ref_intermediate(hidden_states.float())
+            tpp_res = tpp_intermediate(hidden_states.view(self.batch * self.max_seq_len, self.config.hidden_size))\
+                .unblocked_tensor().view(self.batch, self.max_seq_len, -1)
+            self.assertEqual(ref_res, tpp_res.float(), prec=0.05)
+
+    def test_tpp_decoder_mlp(self):
+        config = DecoderConfig()
+        ref_mlp = RefDecoderMLP(config)
+        tpp_mlp = ipex.tpp.fused_decoder.DecoderMLP(config)
+        tpp_mlp.load_state_dict(ref_mlp.state_dict())
+        hidden_states = torch.randn(self.batch, self.max_seq_len, config.hidden_size)
+        residual = torch.randn(self.batch, self.max_seq_len, config.hidden_size)
+        ref_res = ref_mlp(hidden_states, residual)
+        tpp_res = tpp_mlp(hidden_states.view(self.batch * self.max_seq_len, config.hidden_size), \
+            residual.view(self.batch * self.max_seq_len, config.hidden_size))\
+            .unblocked_tensor().view(self.batch, self.max_seq_len, -1)
+        self.assertEqual(ref_res, tpp_res, prec=0.001)
+        self._test_backward(ref_res, tpp_res, ref_mlp, tpp_mlp, prec=0.01)
+
+    def test_tpp_decoder(self):
+        # one layer covers the rmsnorm, the causal attention with rope and the mlp
+        ipex.tpp.fused_bert.unpad = True
+        config = DecoderConfig()
+        ref_decoder = RefDecoder(config)
+        tpp_decoder = ipex.tpp.fused_decoder.Decoder(config)
+        tpp_decoder.load_state_dict(ref_decoder.state_dict())
+        hidden_states = torch.randn(self.batch, self.max_seq_len, config.hidden_size)
+        ref_res = ref_decoder(hidden_states, self.attention_mask)
+        tpp_res = tpp_decoder(hidden_states, self.attention_mask)
+        # the padding tokens differ, the causal mask keeps them out of the others
+        valid = (self.attention_mask.view(self.batch, self.max_seq_len, 1) == 0).float()
+        self.assertEqual(ref_res * valid, tpp_res * valid, prec=0.002)
+        self._test_backward(ref_res * valid, tpp_res * valid, ref_decoder, tpp_decoder, prec=0.01)
+
+    def test_tpp_bert_model_blocked_unpad(self):
+        # the blocked embeddings are unpadded by blocks into the layers
+        config = transformers.BertConfig(hidden_size=256, num_hidden_layers=2, num_attention_heads=4,
+                                         intermediate_size=1024, hidden_dropout_prob=0,
+                                         attention_probs_dropout_prob=0)
+        hf_model = transformers.BertModel(config).train()
+        tpp_model, _ = ipex.fast_bert(hf_model, dtype=torch.float, unpad=True,
+                                      optimizer=torch.optim.SGD(hf_model.parameters(), lr=0.1))
+        input_ids = torch.randint(100, 3000, (4, 128))
+        attention_mask = torch.zeros(4, 128, dtype=torch.long)
+        for b, n in enumerate([128, 70, 33, 5]):
+            attention_mask[b][:n] = 1
+        valid = attention_mask.unsqueeze(-1).float()
+        hf_res = hf_model(input_ids, attention_mask=attention_mask).last_hidden_state * valid
+        tpp_res = tpp_model(input_ids, attention_mask=attention_mask).last_hidden_state * valid
+        self.assertEqual(hf_res, tpp_res, prec=0.001)
+        hf_res.sum().backward()
+        tpp_res.sum().backward()
+        self.assertEqual(hf_model.embeddings.word_embeddings.weight.grad,
+                         tpp_model.embeddings.word_embeddings.weight.grad, prec=0.005)
+
+    def test_tpp_bert_activation_policy(self):
+        config = transformers.BertConfig(hidden_size=256, num_hidden_layers=2, num_attention_heads=4,
+                                         intermediate_size=1024, hidden_dropout_prob=0,
+                                         attention_probs_dropout_prob=0)
+        hf_model = transformers.BertModel(config).train()
+        input_ids = torch.randint(100, 3000, (4, 128))
+        attention_mask = torch.ones(4, 128, dtype=torch.long)
+        attention_mask[1][70:] = 0
+        grads = {}
+        for policy, prec in [("keep", 0), ("recompute", 0.0001), ("compress", 0.02)]:
+            tpp_model, _ = ipex.fast_bert(copy.deepcopy(hf_model), dtype=torch.float,
+                                          optimizer=torch.optim.SGD(hf_model.parameters(), lr=0.1))
+            ipex.tpp.fused_bert.set_activation_policy(tpp_model, policy)
+            tpp_model(input_ids, attention_mask=attention_mask).last_hidden_state.sum().backward()
+            grads[policy] = [p.grad.clone() for p in tpp_model.parameters() if p.grad is not None]
+            for grad, ref in zip(grads[policy], grads["keep"]):
+                self.assertEqual(grad, ref, prec=prec)
+        # all the layers are recomputed for a budget too small, and kept for a large one
+        policies = tpp_model.plan_activation_policy(1, input_ids, attention_mask=attention_mask)
+        self.assertEqual(policies, ["recompute"] * config.num_hidden_layers)
+        policies = tpp_model.plan_activation_policy(1 << 40, input_ids, attention_mask=attention_mask)
+        self.assertEqual(policies, ["keep"] * config.num_hidden_layers)
+
+    def test_tpp_bert_varlen_inference(self):
+        # the packed requests match each request run alone by the hf model
+        config = transformers.BertConfig(hidden_size=256, num_hidden_layers=2, num_attention_heads=4,
+                                         intermediate_size=1024, hidden_dropout_prob=0,
+                                         attention_probs_dropout_prob=0)
+        hf_model = transformers.BertModel(config).eval()
+        tpp_model = ipex.fast_bert(hf_model, dtype=torch.float)
+        input_ids = [torch.randint(100, 3000, (n,)) for n in [7, 32, 45, 128]]
+        outputs, pooled_output = tpp_model.varlen_forward(input_ids)
+        for i, ids in enumerate(input_ids):
+            hf_res = hf_model(ids.unsqueeze(0))
+            self.assertEqual(hf_res.last_hidden_state[0], outputs[i], prec=0.001)
+            self.assertEqual(hf_res.pooler_output[0], pooled_output[i], prec=0.001)
+
+    def test_tpp_fused_mlp(self):
+        # the tokens (150) are not a multiple of the block, the fused blocks pad them
+        mlp = nn.Sequential(nn.Linear(256, 1024), nn.GELU(), nn.Linear(1024, 256),
+                            nn.Dropout(0.0), nn.LayerNorm(256))
+        tpp_mlp = ipex.tpp.fused_mlp.fuse_mlp(copy.deepcopy(mlp))
+        self.assertTrue(isinstance(tpp_mlp[0], ipex.tpp.fused_mlp.FusedDenseGELU))
+        self.assertTrue(isinstance(tpp_mlp[2], ipex.tpp.fused_mlp.FusedDenseDropoutLayerNorm))
+        self.assertEqual(list(mlp.state_dict().keys()), list(tpp_mlp.state_dict().keys()))
+        x = torch.randn(3, 50, 256)
+        ref_res = mlp(x)
+        tpp_res = tpp_mlp(x)
+        self.assertEqual(ref_res, tpp_res, prec=0.001)
+        ref_res.sum().backward()
+        tpp_res.sum().backward()
+        # the params stay plain
+        for param_ref, param_tpp in zip(mlp.parameters(), tpp_mlp.parameters()):
+            self.assertEqual(param_ref.grad, param_tpp.grad, prec=0.005)
+        # swapped by ipex.optimize for training, with the same params
+        model = copy.deepcopy(mlp).train()
+        optimizer = torch.optim.SGD(model.parameters(), lr=0.1)
+        model, optimizer = ipex.optimize(model, optimizer=optimizer, fuse_tpp_mlp=True)
+        self.assertTrue(isinstance(model[0], ipex.tpp.fused_mlp.FusedDenseGELU))
+        self.assertEqual(set(model.parameters()), set(optimizer.param_groups[0]['params']))
+
+    def test_tpp_dense_sparse_add(self):
+        # the repeated rows collide with RTM (when available) and in the partial rows
+        dense = torch.randn(64, 32)
+        indices = torch.randint(0, 4, (1000,))
+        values = torch.randn(1000, 32)
+        sparse = torch.sparse_coo_tensor(indices.unsqueeze(0), values, (64, 32))
+        ref = dense.index_add(0, indices, values, alpha=0.5)
+        torch_ipex_cpp.tpp_reset_rtm_stats()
+        torch_ipex_cpp.tpp_dense_sparse_add_(dense, sparse, 0.5)
+        self.assertEqual(ref, dense, prec=0.0001)
+        stats = torch_ipex_cpp.tpp_rtm_stats()
+        # attempts >= calls
+        self.assertGreaterEqual(stats[0], stats[3])
+
+    def test_tpp_adamw_fused_clip(self):
+        # clipping inside the fused step matches clip_grad_norm_ and then the step
+        params = [torch.randn(n) for n in [7, 64, 1000, 4097]]
+        grads = [torch.randn(p.shape) * 10 for p in params]
+        params_ = [p.clone() for p in params]
+        opt = ipex.tpp.optim.AdamW(params, lr=0.01, weight_decay=0.01)
+        opt_ = ipex.tpp.optim.AdamW(params_, lr=0.01, weight_decay=0.01, max_grad_norm=1.0)
+        for _ in range(2):
+            for p, p_, g in zip(params, params_, grads):
+                p.grad = g.clone()
+                p_.grad = g.clone()
+            norm = ipex.tpp.optim.clip_grad_norm_(params, 1.0)
+            opt.step()
+            opt_.step()
+            self.assertEqual(norm, opt_.grad_norm, prec=1e-4)
+        for p, p_ in zip(params, params_):
+            self.assertEqual(p, p_, prec=1e-5)
+
 if __name__ == '__main__':
     test = unittest.main()
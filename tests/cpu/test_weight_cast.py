@@ -1,5 +1,6 @@
 import unittest
 import copy
+import tempfile
 
 import torch
 import intel_extension_for_pytorch as ipex
@@ -116,5 +117,41 @@ class TestWeightCastCases(TestCase):
                     ipex_opt_state = opt.state_dict()
                     self.assertEqual(ipex_opt_state['state'], origin_opt_state['state'])
 
+    def test_split_converter_out(self):
+        x = torch.randn(17, 33)
+        top, bot = torch.ops.torch_ipex.split_float_bfloat16(x)
+        # the out variants write into the given, possibly strided, tensors
+        top_out = torch.empty(33, 17, dtype=torch.bfloat16).t()
+        bot_out = torch.empty(17, 33, dtype=torch.bfloat16)
+        torch.ops.torch_ipex.split_float_bfloat16.out(x, top=top_out, bot=bot_out)
+        self.assertEqual(top_out, top)
+        self.assertEqual(bot_out, bot)
+        out = torch.empty(33, 17).t()
+        torch.ops.torch_ipex.cat_bfloat16_float.out(top_out, bot_out, out=out)
+        self.assertEqual(out, x)
+
+    def test_streaming_checkpoint(self):
+        M = TestModule()
+        for split_master_weight_for_bf16 in [True, False]:
+            model = copy.deepcopy(M)
+            optimizer = SGD(model.parameters(), lr=0.01)
+            model, _, _ = cast(model, optimizer, {}, split_master_weight_for_bf16, torch.bfloat16)
+            state = model.state_dict()
+            with tempfile.TemporaryDirectory() as path:
+                # small chunks to convert a param over several chunks
+                ipex.save_checkpoint(model, path, chunk_numel=7)
+                loaded = copy.deepcopy(M)
+                loaded, _, _ = cast(loaded, SGD(loaded.parameters(), lr=0.01), {}, split_master_weight_for_bf16,
+                                    torch.bfloat16)
+                with torch.no_grad():
+                    for p in loaded.parameters():
+                        p.zero_()
+                ipex.load_checkpoint(loaded, path)
+            loaded_state = loaded.state_dict()
+            self.assertEqual(list(state.keys()), list(loaded_state.keys()))
+            for key in state:
+                self.assertEqual(state[key].dtype, loaded_state[key].dtype)
+                self.assertEqual(state[key], loaded_state[key])
+
 if __name__ == '__main__':
     test = unittest.main()
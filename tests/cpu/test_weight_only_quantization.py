@@ -0,0 +1,104 @@
+import unittest
+import io
+import torch
+from torch import nn
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.nn.modules import WeightOnlyQuantizedLinear
+from common_utils import TestCase
+
+def quantize_ref(weight, bits, group_size):
+    N, K = weight.shape
+    if group_size <= 0:
+        group_size = K
+    w = weight.view(N, K // group_size, group_size)
+    qmax = 2 ** bits - 1
+    w_min = w.min(-1)[0].clamp(max=0)
+    w_max = w.max(-1)[0].clamp(min=0)
+    scales = (w_max - w_min) / qmax
+    scales[scales == 0] = 1
+    zero_points = torch.round(-w_min / scales).clamp(0, qmax)
+    q = (torch.round(w / scales.unsqueeze(-1)) + zero_points.unsqueeze(-1)).clamp(0, qmax)
+    dequantized = (q - zero_points.unsqueeze(-1)) * scales.unsqueeze(-1)
+    return q.to(torch.uint8).view(N, K), scales, zero_points, dequantized.view(N, K)
+
+class WeightOnlyQuantizationTester(TestCase):
+    def test_woq_linear(self):
+        # N of a partial block, int4/int8, decoding and prefill M
+        for bits, group_size, M, N, K, dtype in [
+                (4, 32, 1, 50, 128, torch.float),
+                (4, -1, 40, 50, 128, torch.float),
+                (8, 64, 3, 64, 128, torch.float),
+                (8, 32, 40, 130, 64, torch.float),
+                (4, 32, 5, 64, 64, torch.bfloat16),
+                (4, 32, 33, 64, 64, torch.bfloat16)]:
+            linear = nn.Linear(K, N)
+            woq_linear = WeightOnlyQuantizedLinear.from_float(linear, bits, group_size)
+            _, _, _, w_ref = quantize_ref(linear.weight.detach(), bits, group_size)
+            self.assertEqual(woq_linear.dequantized_weight(), w_ref, prec=1e-5)
+
+            x = torch.randn(2, M, K).to(dtype)
+            y = woq_linear(x)
+            y_ref = nn.functional.linear(x.float(), w_ref, linear.bias.detach())
+            self.assertEqual(y.dtype, dtype)
+            self.assertEqual(y.float(), y_ref, prec=5e-2 if dtype == torch.bfloat16 else 1e-4)
+
+    def test_woq_linear_quantized_weight(self):
+        bits, group_size = 4, 16
+        weight = torch.randn(24, 64)
+        qweight, scales, zero_points, w_ref = quantize_ref(weight, bits, group_size)
+        woq_linear = WeightOnlyQuantizedLinear(qweight, scales, zero_points, None, bits, group_size)
+        self.assertEqual(woq_linear.ctx.get_quantized_weight(), qweight)
+        x = torch.randn(4, 64)
+        self.assertEqual(woq_linear(x), torch.matmul(x, w_ref.t()), prec=1e-4)
+
+    def test_woq_linear_pickle(self):
+        linear = nn.Linear(64, 48)
+        woq_linear = WeightOnlyQuantizedLinear.from_float(linear, 4, 32)
+        x = torch.randn(3, 64)
+        # the prepacked context is serialized through its quantized weight
+        scripted = torch.jit.script(woq_linear)
+        buffer = io.BytesIO()
+        torch.jit.save(scripted, buffer)
+        buffer.seek(0)
+        loaded = torch.jit.load(buffer)
+        self.assertEqual(loaded(x), woq_linear(x))
+
+    def test_weight_only_quantize(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.q = nn.Linear(64, 64)
+                self.k = nn.Linear(64, 64)
+                self.fc = nn.Linear(64, 128)
+                self.lm_head = nn.Linear(128, 32)
+
+            def forward(self, x):
+                x = self.q(x) + self.k(x)
+                return self.lm_head(self.fc(x).relu())
+
+        # activations of a few outlier channels, as in LLMs
+        x = torch.randn(16, 8, 64)
+        x[..., :4] *= 20
+        calib_dataloader = [x[i:i + 4] for i in range(0, 16, 4)]
+        m = M().eval()
+        with torch.no_grad():
+            y_ref = m(x)
+            errors = {}
+            for algorithm in ['rtn', 'gptq']:
+                qm = ipex.quantization.weight_only_quantize(
+                    m, calib_dataloader, bits=4, group_size=32, algorithm=algorithm, exclude_modules=['lm_head'])
+                self.assertTrue(isinstance(qm.q, WeightOnlyQuantizedLinear))
+                self.assertTrue(isinstance(qm.fc, WeightOnlyQuantizedLinear))
+                self.assertTrue(type(qm.lm_head) is nn.Linear)
+                # rtn quantizes each weight as from_float
+                if algorithm == 'rtn':
+                    self.assertEqual(qm.fc.dequantized_weight(),
+                                     quantize_ref(m.fc.weight, 4, 32)[3], prec=1e-5)
+                errors[algorithm] = (qm(x) - y_ref).pow(2).mean()
+            # the error compensation of gptq reduces the error on the outputs
+            self.assertTrue(errors['gptq'] < errors['rtn'])
+        # the model is not changed without inplace
+        self.assertTrue(type(m.fc) is nn.Linear)
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -1,9 +1,11 @@
 import unittest
 import itertools
 import copy
+import io
 import os
 import time
 import sys
+import tempfile
 from intel_extension_for_pytorch.utils.channels_last_1d import to_channels_last_1d, is_contiguous_channels_last_1d
 
 try:
@@ -382,6 +384,77 @@ class TestPrepackCases(TestCase):
     def test_conv3d_nc11(self):
         self._test_conv_nc11_base(dim=3)
 
+    def test_conv2d_direct_kernel(self):
+        # depthwise and small channels convs of channels last models run the direct kernels
+        class M(torch.nn.Module):
+            def __init__(self, in_channels, out_channels, kernel_size, stride, padding, dilation, groups, bias):
+                super(M, self).__init__()
+                self.conv = torch.nn.Conv2d(
+                    in_channels, out_channels, kernel_size, stride=stride, padding=padding,
+                    dilation=dilation, groups=groups, bias=bias)
+                self.relu6 = torch.nn.ReLU6()
+
+            def forward(self, x):
+                return self.relu6(self.conv(x))
+
+        test_dtypes = [torch.float]
+        if core.onednn_has_bf16_support():
+            test_dtypes.append(torch.bfloat16)
+        convs = [
+            # depthwise
+            (32, 32, 3, 1, 1, 1, 32),
+            (20, 20, 5, 2, 2, 1, 20),
+            (24, 24, 3, 1, 2, 2, 24),
+            # first layers
+            (3, 16, 3, 2, 1, 1, 1),
+            (3, 24, 7, 2, 3, 1, 1),
+            (1, 8, 3, 1, 0, 1, 1),
+        ]
+        options = itertools.product(convs, [True, False], [1, 2], test_dtypes)
+        for (in_c, out_c, k, stride, padding, dilation, groups), bias, batch, dtype in options:
+            model = M(in_c, out_c, k, stride, padding, dilation, groups, bias).eval()
+            model = model.to(memory_format=torch.channels_last)
+            x = torch.randn(batch, in_c, 17, 23).to(memory_format=torch.channels_last)
+            ipex_model = ipex.optimize(copy.deepcopy(model), dtype=dtype, level='O1')
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-5
+            with torch.no_grad():
+                y1 = model(x)
+                with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16), dtype=dtype):
+                    y2 = ipex_model(x)
+                    # conv + relu6 fused into the op context
+                    traced = torch.jit.freeze(torch.jit.trace(ipex_model, x))
+                    traced(x)
+                    y3 = traced(x)
+            self.assertTrue(y3.is_contiguous(memory_format=torch.channels_last))
+            self.assertEqual(y1, y2.float(), rtol=prec, atol=prec)
+            self.assertEqual(y1, y3.float(), rtol=prec, atol=prec)
+
+        conv = torch.nn.Conv2d(16, 16, 3, padding=1, groups=16).to(memory_format=torch.channels_last)
+        x = torch.randn(1, 16, 9, 9).to(memory_format=torch.channels_last)
+
+        def run(ctx, weight):
+            return torch.ops.torch_ipex.convolution_forward(
+                x, weight, conv.bias, ctx.get_data_handle(), conv.weight.size(), conv.padding,
+                conv.stride, conv.dilation, True)
+
+        with torch.no_grad():
+            ctx = torch.ops.ipex_prepack.convolution_prepack(
+                conv.weight, conv.bias, conv.stride, conv.padding, conv.dilation, conv.groups, True, [])
+            weight = ctx.get_weight()
+            self.assertEqual(run(ctx, weight), conv(x))
+            # an in-place update of the packed weight falls back to oneDNN
+            weight.copy_(ctx.pack(torch.randn(16, 1, 3, 3).to(memory_format=torch.channels_last)))
+            self.assertEqual(
+                run(ctx, weight), torch.nn.functional.conv2d(x, ctx.to_public(weight), conv.bias, padding=1, groups=16))
+            ipex._C._set_direct_conv_enabled(False)
+            try:
+                self.assertFalse(ipex._C._direct_conv_enabled())
+                ctx = torch.ops.ipex_prepack.convolution_prepack(
+                    conv.weight, conv.bias, conv.stride, conv.padding, conv.dilation, conv.groups, True, [])
+            finally:
+                ipex._C._set_direct_conv_enabled(True)
+            self.assertEqual(run(ctx, ctx.get_weight()), conv(x))
+
     def _test_conv_serialization_base(self, dim):
         channels_last = torch.channels_last if dim ==2 else torch.channels_last_3d
         optimizer_options = [Lamb, Adadelta, Adagrad, Adam, AdamW, Adamax, ASGD, RMSprop, Rprop, SGD]
@@ -636,6 +709,243 @@ class TestPrepackCases(TestCase):
                 y2 = ipex_model(x2)
             self.assertEqual(y1, y2.float(), rtol=1e-2, atol=1e-3)
 
+    def test_linear_small_m_inference(self):
+        # a sample input of at most 8 rows keeps the weight plain for the small M kernel,
+        # larger inputs fall back to oneDNN on the same weight
+        test_dtypes = [torch.float]
+        if core.onednn_has_bf16_support():
+            test_dtypes.append(torch.bfloat16)
+        options = itertools.product([True, False], [1, 8], [1, 3, 8, 20], [(96, 40), (35, 77)], test_dtypes)
+        for bias, sample_m, m, (in_features, out_features), dtype in options:
+            model = torch.nn.Sequential(torch.nn.Linear(in_features, out_features, bias=bias)).eval()
+            sample_x = torch.randn(sample_m, in_features)
+            ipex_model = ipex.optimize(
+                copy.deepcopy(model), dtype=dtype, level='O1', auto_kernel_selection=True, sample_input=sample_x)
+            x = torch.randn(m, in_features)
+            with torch.no_grad():
+                y1 = model(x)
+                with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16), dtype=dtype):
+                    y2 = ipex_model(x)
+                    y3 = ipex_model(x.view(1, m, in_features))
+            self.assertEqual(y2.dtype, dtype)
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-5
+            self.assertEqual(y1, y2.float(), rtol=prec, atol=prec)
+            self.assertEqual(y2, y3.view(m, out_features))
+
+    def test_linear_mkl_variable_batch(self):
+        # the MKL weight is packed for each batch size on its first run, up to 8 of them besides the prepacked one
+        weight = torch.randn(32, 64)
+        bias = torch.randn(32)
+        ctx = torch.ops.ipex_prepack.mkl_sgemm_prepack(weight, bias, 4)
+        packed_weight = ctx.get_weight()
+        for m in [4, 1, 7, 33, 7, 1] + list(range(100, 112)):
+            x = torch.randn(m, 64)
+            for _ in range(2):
+                y = torch.ops.torch_ipex.ipex_MKLSGEMM(x, packed_weight, bias, ctx.get_data_handle(), 32)
+                self.assertEqual(y, torch.nn.functional.linear(x, weight, bias), rtol=1e-4, atol=1e-4)
+
+    def test_linear_mkl_runtime_kernel_selection(self):
+        # each candidate of each new shape is timed twice before the fastest one is locked in
+        model = torch.nn.Sequential(torch.nn.Linear(64, 32)).eval()
+        ipex._reset_kernel_selection()
+        ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float32, level='O1', auto_kernel_selection='runtime')
+        self.assertFalse(ipex._using_dnnl())
+        core._set_kernel_selection_trials(2)
+        try:
+            with torch.no_grad():
+                for m in [1, 4, 33]:
+                    x = torch.randn(m, 64)
+                    for _ in range(8):
+                        self.assertEqual(ipex_model(x), model(x), rtol=1e-4, atol=1e-4)
+            table = ipex._get_kernel_selection_table()
+            self.assertEqual(len(table), 3)
+            self.assertTrue(all(k.startswith('linear_mkl:') and v in [0, 1, 2] for k, v in table.items()))
+            # the saved table is locked in again without any trial
+            with tempfile.TemporaryDirectory() as tmp:
+                path = os.path.join(tmp, 'kernel_selection.json')
+                ipex._save_kernel_selection_table(path)
+                ipex._reset_kernel_selection()
+                self.assertEqual(ipex._get_kernel_selection_table(), {})
+                ipex._load_kernel_selection_table(path)
+            self.assertEqual(ipex._get_kernel_selection_table(), table)
+            with torch.no_grad():
+                x = torch.randn(4, 64)
+                self.assertEqual(ipex_model(x), model(x), rtol=1e-4, atol=1e-4)
+        finally:
+            core._set_kernel_selection_trials(3)
+            core._set_kernel_selection_enabled(False)
+            ipex._reset_kernel_selection()
+
+    def test_linear_sparse_weight(self):
+        # weights with most of their 16x1 blocks zero run the block-sparse kernel
+        def block_pruned_linear(in_features, out_features):
+            linear = torch.nn.Linear(in_features, out_features)
+            num_blocks = (out_features + 15) // 16
+            keep = torch.rand(num_blocks, in_features) < 0.25
+            mask = keep.repeat_interleave(16, dim=0)[:out_features]
+            with torch.no_grad():
+                linear.weight.mul_(mask)
+            return linear
+
+        test_dtypes = [torch.float]
+        if core.onednn_has_bf16_support():
+            test_dtypes.append(torch.bfloat16)
+        options = itertools.product([(96, 40), (130, 77)], [1, 5, 70], test_dtypes)
+        for (in_features, out_features), m, dtype in options:
+            model = torch.nn.Sequential(block_pruned_linear(in_features, out_features), torch.nn.ReLU()).eval()
+            ipex_model = ipex.optimize(copy.deepcopy(model), dtype=dtype, level='O1')
+            x = torch.randn(2, m, in_features)
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-5
+            with torch.no_grad():
+                y1 = model(x)
+                with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16), dtype=dtype):
+                    y2 = ipex_model(x)
+                    # linear + relu fused into the op context
+                    traced = torch.jit.freeze(torch.jit.trace(ipex_model, x))
+                    traced(x)
+                    y3 = traced(x)
+            self.assertEqual(y1, y2.float(), rtol=prec, atol=prec)
+            self.assertEqual(y1, y3.float(), rtol=prec, atol=prec)
+
+        linear = block_pruned_linear(64, 48)
+        x = torch.randn(4, 64)
+
+        def run(ctx, weight):
+            return torch.ops.torch_ipex.ipex_linear(x, weight, linear.bias, ctx.get_data_handle(), 48)
+
+        with torch.no_grad():
+            ctx = torch.ops.ipex_prepack.linear_prepack(linear.weight, linear.bias, None)
+            weight = ctx.get_weight()
+            self.assertEqual(run(ctx, weight), linear(x))
+            # an in-place update of the packed weight falls back to the dense kernel
+            weight.copy_(ctx.pack(torch.randn(48, 64)))
+            self.assertEqual(run(ctx, weight), torch.nn.functional.linear(x, ctx.to_public(weight), linear.bias))
+            ipex._C._set_sparse_linear_enabled(False)
+            try:
+                self.assertFalse(ipex._C._sparse_linear_enabled())
+                ctx = torch.ops.ipex_prepack.linear_prepack(linear.weight, linear.bias, None)
+            finally:
+                ipex._C._set_sparse_linear_enabled(True)
+            self.assertEqual(run(ctx, ctx.get_weight()), linear(x))
+
+    def test_shared_packed_weight(self):
+        # op contexts packing the same read-only weight share one packed buffer
+        registry_size = ipex._C._packed_weight_registry_size()
+        linear = torch.nn.Linear(64, 48)
+        conv = torch.nn.Conv2d(16, 32, 3)
+
+        def linear_ctx():
+            return torch.ops.ipex_prepack.linear_prepack(linear.weight, linear.bias, None)
+
+        def conv_ctx():
+            return torch.ops.ipex_prepack.convolution_prepack(
+                conv.weight, conv.bias, conv.stride, conv.padding, conv.dilation, conv.groups, False, [])
+
+        for create_ctx in [linear_ctx, conv_ctx]:
+            with torch.no_grad():
+                ctx1, ctx2 = create_ctx(), create_ctx()
+            self.assertEqual(ctx1.get_weight().data_ptr(), ctx2.get_weight().data_ptr())
+            # a trainable weight keeps its own packed copy
+            ctx3 = create_ctx()
+            self.assertNotEqual(ctx1.get_weight().data_ptr(), ctx3.get_weight().data_ptr())
+
+        with torch.no_grad():
+            ctx1 = linear_ctx()
+            # an in-place update of the source weight is packed again
+            linear.weight.add_(1)
+            ctx2 = linear_ctx()
+            self.assertNotEqual(ctx1.get_weight().data_ptr(), ctx2.get_weight().data_ptr())
+            self.assertEqual(ctx2.to_public(ctx2.get_weight()), linear.weight)
+            ipex._C._set_packed_weight_sharing_enabled(False)
+            try:
+                ctx3 = linear_ctx()
+            finally:
+                ipex._C._set_packed_weight_sharing_enabled(True)
+            self.assertNotEqual(ctx2.get_weight().data_ptr(), ctx3.get_weight().data_ptr())
+        # packed weights are released with their last context
+        del ctx1, ctx2, ctx3
+        self.assertEqual(ipex._C._packed_weight_registry_size(), registry_size)
+
+    def test_serialize_packed_weight(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv = torch.nn.Conv2d(3, 16, 3)
+                self.linear = torch.nn.Linear(16, 24)
+
+            def forward(self, x):
+                return self.linear(self.conv(x).permute(0, 2, 3, 1))
+
+        x = torch.randn(2, 3, 10, 10)
+        for memory_format in [torch.contiguous_format, torch.channels_last]:
+            model = M().eval().to(memory_format=memory_format)
+            ipex_model = ipex.optimize(model, dtype=torch.float32, level='O1')
+            with torch.no_grad():
+                traced = torch.jit.freeze(torch.jit.trace(ipex_model, x))
+                traced(x)
+                ref = traced(x)
+            # the archive carries the packed weights, loaded without repacking
+            ipex._C._set_serialize_packed_weight(True)
+            try:
+                buffer = io.BytesIO()
+                torch.jit.save(traced, buffer)
+            finally:
+                ipex._C._set_serialize_packed_weight(False)
+            buffer.seek(0)
+            loaded = torch.jit.load(buffer)
+            with torch.no_grad():
+                self.assertEqual(loaded(x), ref)
+                self.assertEqual(loaded(x), model(x))
+
+    def test_conv_primitive_cache(self):
+        model = torch.nn.Sequential(torch.nn.Conv2d(3, 8, 3, padding=1)).eval()
+        ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float32, level='O1')
+        ctx = ipex_model[0].ctx
+        shapes = [[1, 3, 16, 16], [2, 3, 20, 12], [4, 3, 9, 9]]
+        # the warm-up creates the primitives without counting misses
+        ctx.warm_up(shapes)
+        hits, misses, size = ctx.get_primitive_cache_stats()
+        self.assertEqual(size, len(shapes))
+        with torch.no_grad():
+            for shape in shapes * 2:
+                x = torch.randn(shape)
+                self.assertEqual(ipex_model(x), model(x))
+        self.assertEqual(ctx.get_primitive_cache_stats(), (hits + 2 * len(shapes), misses, len(shapes)))
+        # the least recently used primitives are evicted
+        ctx.set_primitive_cache_capacity(2)
+        self.assertEqual(ctx.get_primitive_cache_stats()[2], 2)
+        with torch.no_grad():
+            x = torch.randn(1, 3, 7, 11)
+            self.assertEqual(ipex_model(x), model(x))
+        self.assertEqual(ctx.get_primitive_cache_stats(), (hits + 2 * len(shapes), misses + 1, 2))
+        # without the cache, shapes other than the prepacked one run the fallback path
+        ctx.set_primitive_cache_capacity(0)
+        with torch.no_grad():
+            self.assertEqual(ipex_model(x), model(x))
+        self.assertEqual(ctx.get_primitive_cache_stats(), (hits + 2 * len(shapes), misses + 1, 0))
+
+    def test_conv_winograd(self):
+        model = torch.nn.Sequential(torch.nn.Conv2d(16, 32, 3, padding=1)).eval()
+        ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float32, level='O1')
+        ctx = ipex_model[0].ctx
+        self.assertEqual(ctx.get_algorithm(), 'direct')
+        x = torch.randn(2, 16, 24, 24)
+        with torch.no_grad():
+            ref = model(x)
+            ctx.set_algorithm('winograd')
+            self.assertEqual(ctx.get_algorithm(), 'winograd')
+            # the winograd transforms round differently from the direct convolution
+            self.assertEqual(ipex_model(x), ref, rtol=1e-3, atol=1e-3)
+            ctx.set_algorithm('auto')
+            self.assertEqual(ctx.get_tuned_algorithm(list(x.shape)), '')
+            for _ in range(2):
+                self.assertEqual(ipex_model(x), ref, rtol=1e-3, atol=1e-3)
+            self.assertIn(ctx.get_tuned_algorithm(list(x.shape)), ('direct', 'winograd'))
+            ctx.set_algorithm('direct')
+            self.assertEqual(ipex_model(x), ref)
+        with self.assertRaises(RuntimeError):
+            ctx.set_algorithm('fft')
+
     @unittest.skipIf(not core.onednn_has_bf16_support(), "ipex linear bf16 is not supported on this CPU device")
     def test_linear_unpack(self):
         class L(torch.nn.Module):
@@ -1206,6 +1516,127 @@ class TestPrepackCases(TestCase):
     def test_lstm_training(self):
         self._test_lstm(inference=False)
 
+    def test_lstm_packed_sequence(self):
+        # the timesteps of a PackedSequence run on the unfinished sequences only, in forward and backward
+        class Lstm(torch.nn.Module):
+            def __init__(self, num_layers, bidirectional, bias):
+                super(Lstm, self).__init__()
+                self.lstm = torch.nn.LSTM(input_size=3, hidden_size=6, num_layers=num_layers, bidirectional=bidirectional, bias=bias)
+
+            def forward(self, x, h=None):
+                return self.lstm(x, h)
+
+        lengths = torch.tensor([7, 2, 5, 5, 1])
+        for num_layers, bidirectional, bias, empty_state in itertools.product([1, 2], [False, True], [False, True], [False, True]):
+            num_directions = 2 if bidirectional else 1
+            origin_model = Lstm(num_layers, bidirectional, bias).train()
+            ipex_model = copy.deepcopy(origin_model)
+            ipex_model, _ = ipex.optimize(ipex_model, dtype=torch.float, optimizer=SGD(ipex_model.parameters(), lr=0.01), level='O1')
+            self.assertTrue(isinstance(ipex_model.lstm, ipex.nn.utils._model_convert._LSTM))
+            x = torch.randn(7, 5, 3)
+            h = torch.randn(num_layers * num_directions, 5, 6)
+            c = torch.randn(num_layers * num_directions, 5, 6)
+            results = []
+            for m in [origin_model, ipex_model]:
+                x_ = x.clone().requires_grad_()
+                packed = torch.nn.utils.rnn.pack_padded_sequence(x_, lengths, enforce_sorted=False)
+                y, (hy, cy) = m(packed) if empty_state else m(packed, (h, c))
+                y, _ = torch.nn.utils.rnn.pad_packed_sequence(y)
+                (y.sum() + hy.sum() + cy.sum()).backward()
+                results.append((y, hy, cy, x_.grad, [p.grad for p in m.parameters()]))
+            for origin, ipex_result in zip(results[0][:4], results[1][:4]):
+                self.assertEqual(origin, ipex_result, rtol=1e-5, atol=1e-5)
+            for origin_grad, ipex_grad in zip(results[0][4], results[1][4]):
+                self.assertEqual(origin_grad, ipex_grad, rtol=1e-5, atol=1e-5)
+            with torch.no_grad():
+                packed = torch.nn.utils.rnn.pack_padded_sequence(x, lengths, enforce_sorted=False)
+                y_origin, hy_origin = origin_model.eval()(packed)
+                y_ipex, hy_ipex = ipex_model.eval()(packed)
+            self.assertEqual(y_origin.data, y_ipex.data, rtol=1e-5, atol=1e-5)
+            self.assertEqual(hy_origin, hy_ipex, rtol=1e-5, atol=1e-5)
+
+    def test_gru_inference(self):
+        class Gru(torch.nn.Module):
+            def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, batch_first):
+                super(Gru, self).__init__()
+                self.gru = torch.nn.GRU(input_size=input_size, hidden_size=hidden_size, num_layers=num_layers, bidirectional=bidirectional, bias=bias, batch_first=batch_first)
+
+            def forward(self, x, h=None):
+                return self.gru(x, h)
+
+        rand_seed = int(get_rand_seed())
+        print("{} rand sed: {}".format(sys._getframe().f_code.co_name, rand_seed))
+        torch.manual_seed(rand_seed)
+
+        input_size = 4
+        hidden_size = 8
+        batch_size = 2
+        seq_len = 3
+        for num_layers, bidirectional, bias, empty_state, batch_first in itertools.product(
+                [1, 2], [False, True], [False, True], [False, True], [False, True]):
+            num_directions = 2 if bidirectional else 1
+            if batch_first:
+                x = torch.randn(batch_size, seq_len, input_size)
+            else:
+                x = torch.randn(seq_len, batch_size, input_size)
+            h = torch.randn(num_layers * num_directions, batch_size, hidden_size)
+            model = Gru(input_size, hidden_size, num_layers, bidirectional, bias, batch_first).eval()
+
+            test_dtypes = [torch.float]
+            if core.onednn_has_bf16_support():
+                test_dtypes.append(torch.bfloat16)
+            for dtype in test_dtypes:
+                rtol = 1e-5
+                atol = 1e-5
+                if dtype == torch.bfloat16:
+                    rtol = 2e-2
+                    atol = 3e-2
+                origin_model = copy.deepcopy(model).to(dtype=dtype).float().eval()
+                x_ = x.to(dtype=dtype).float()
+                h_ = h.to(dtype=dtype).float()
+                ipex_model = ipex.optimize(copy.deepcopy(origin_model), dtype=dtype, level='O1')
+                self.assertTrue(isinstance(ipex_model.gru, ipex.nn.utils._model_convert._GRU))
+                with torch.no_grad():
+                    args = (x_,) if empty_state else (x_, h_)
+                    y_origin, hy_origin = origin_model(*args)
+                    with torch.cpu.amp.autocast(enabled=True, dtype=dtype):
+                        y_ipex, hy_ipex = ipex_model(*args)
+                        traced_model = torch.jit.trace(ipex_model, args)
+                        y_traced, hy_traced = traced_model(*args)
+                self.assertEqual(y_origin, y_ipex.float(), rtol=rtol, atol=atol)
+                self.assertEqual(hy_origin, hy_ipex.float(), rtol=rtol, atol=atol)
+                self.assertEqual(y_ipex, y_traced)
+                self.assertEqual(hy_ipex, hy_traced)
+
+    def test_lstm_projection_inference(self):
+        class Lstm(torch.nn.Module):
+            def __init__(self, num_layers, bidirectional, bias, batch_first):
+                super(Lstm, self).__init__()
+                self.lstm = torch.nn.LSTM(input_size=4, hidden_size=8, num_layers=num_layers, bias=bias, batch_first=batch_first, bidirectional=bidirectional, proj_size=3)
+
+            def forward(self, x, h=None):
+                return self.lstm(x, h)
+
+        rand_seed = int(get_rand_seed())
+        print("{} rand sed: {}".format(sys._getframe().f_code.co_name, rand_seed))
+        torch.manual_seed(rand_seed)
+
+        for num_layers, bidirectional, bias, empty_state, batch_first in itertools.product(
+                [1, 2], [False, True], [False, True], [False, True], [False, True]):
+            num_directions = 2 if bidirectional else 1
+            x = torch.randn(2, 3, 4) if batch_first else torch.randn(3, 2, 4)
+            h = torch.randn(num_layers * num_directions, 2, 3)
+            c = torch.randn(num_layers * num_directions, 2, 8)
+            model = Lstm(num_layers, bidirectional, bias, batch_first).eval()
+            ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float, level='O1')
+            with torch.no_grad():
+                args = (x,) if empty_state else (x, (h, c))
+                y_origin, hy_origin = model(*args)
+                y_ipex, hy_ipex = ipex_model(*args)
+            self.assertEqual(y_origin, y_ipex, rtol=1e-5, atol=1e-5)
+            self.assertEqual(hy_origin[0], hy_ipex[0], rtol=1e-5, atol=1e-5)
+            self.assertEqual(hy_origin[1], hy_ipex[1], rtol=1e-5, atol=1e-5)
+
     def test_lstm_serialization(self):
         class Lstm(torch.nn.Module):
             def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, dropout, batch_first):
@@ -1375,6 +1806,43 @@ class TestPrepackCases(TestCase):
             os.remove('origin_checkpoint.pth')
             os.remove('ipex_checkpoint.pth')
 
+    def test_optimize_from_checkpoint(self):
+        class Model(torch.nn.Module):
+            def __init__(self):
+                super(Model, self).__init__()
+                self.conv = torch.nn.Conv2d(3, 8, 3)
+                self.norm = torch.nn.LayerNorm(8)
+                self.blocks = torch.nn.Sequential(torch.nn.Linear(8, 16), torch.nn.ReLU(), torch.nn.Linear(16, 8))
+
+            def forward(self, x):
+                x = self.conv(x).permute(0, 2, 3, 1)
+                return self.blocks(self.norm(x))
+
+        model = Model().eval()
+        x = torch.randn(2, 3, 10, 10)
+        dtypes = [torch.float]
+        if core.onednn_has_bf16_support():
+            dtypes.append(torch.bfloat16)
+        with tempfile.TemporaryDirectory() as path:
+            pt_file = os.path.join(path, 'model.pt')
+            torch.save(model.state_dict(), pt_file)
+            ipex.save_checkpoint(model, os.path.join(path, 'ipex'))
+            for dtype, checkpoint in itertools.product(dtypes, [pt_file, os.path.join(path, 'ipex')]):
+                ref_model = ipex.optimize(copy.deepcopy(model), dtype=dtype)
+                with torch.device('meta'):
+                    meta_model = Model().eval()
+                ipex_model = ipex.optimize(meta_model, dtype=dtype, checkpoint=checkpoint)
+                self.assertTrue(ipex_model is meta_model)
+                self.assertTrue(module_found(ipex_model, torch.nn.LayerNorm))
+                self.assertFalse(module_found(ipex_model, torch.nn.Linear))
+                self.assertFalse(any(p.is_meta for p in ipex_model.parameters()))
+                with torch.no_grad(), torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+                    self.assertEqual(ipex_model(x), ref_model(x))
+        with torch.device('meta'):
+            meta_model = Model().eval()
+        with self.assertRaisesRegex(RuntimeError, "misses the key"):
+            ipex.optimize(meta_model, checkpoint={'conv.weight': model.conv.weight})
+
 if __name__ == '__main__':
     torch.manual_seed(2020)
     test = unittest.main()